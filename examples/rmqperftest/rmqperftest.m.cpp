@@ -100,6 +100,13 @@ int main(int argc, char* argv[])
             balcl::TypeInfo(&args.testRunDuration),
             balcl::OccurrenceInfo(args.testRunDuration),
         },
+        {
+            "latency-report-interval",
+            "latency-report-interval",
+            "Seconds between latency reports (0==only at the end)",
+            balcl::TypeInfo(&args.latencyReportInterval),
+            balcl::OccurrenceInfo(args.latencyReportInterval),
+        },
         {
             "auto-delete",
             "auto-delete",
@@ -182,10 +189,45 @@ int main(int argc, char* argv[])
             balcl::TypeInfo(&args.producer.publishingInterval),
             balcl::OccurrenceInfo(args.producer.publishingInterval),
         },
+        {
+            "r|rate",
+            "rate",
+            "Aggregate producer rate limit in messages per second "
+            "(0==unlimited). Sends are scheduled open-loop across all "
+            "producers, and latencies are measured from when each message "
+            "was due to be sent, so that they include any time spent "
+            "falling behind.",
+            balcl::TypeInfo(&args.producer.producerRateLimit),
+            balcl::OccurrenceInfo(args.producer.producerRateLimit),
+        },
+        {
+            "rate-sweep-to",
+            "rate-sweep-to",
+            "Raise the rate from `--rate` in steps of `--rate-sweep-step` up "
+            "to this rate, then report the highest rate sustained before "
+            "delivery fell behind or latency climbed (0==no sweep)",
+            balcl::TypeInfo(&args.producer.rateSweepTo),
+            balcl::OccurrenceInfo(args.producer.rateSweepTo),
+        },
+        {
+            "rate-sweep-step",
+            "rate-sweep-step",
+            "Messages per second added at each step of the rate sweep",
+            balcl::TypeInfo(&args.producer.rateSweepStep),
+            balcl::OccurrenceInfo(args.producer.rateSweepStep),
+        },
+        {
+            "rate-sweep-step-duration",
+            "rate-sweep-step-duration",
+            "Seconds spent at each rate of the sweep",
+            balcl::TypeInfo(&args.producer.rateSweepStepDuration),
+            balcl::OccurrenceInfo(args.producer.rateSweepStepDuration),
+        },
         {
             "s|size",
             "size",
-            "Message size in bytes",
+            "Message size in bytes. The first 8 bytes carry the send "
+            "timestamp used to measure latency.",
             balcl::TypeInfo(&args.producer.messageSize),
             balcl::OccurrenceInfo(args.producer.messageSize),
         },
@@ -203,6 +245,15 @@ int main(int argc, char* argv[])
             balcl::TypeInfo(&args.consumer.prefetch),
             balcl::OccurrenceInfo(args.consumer.prefetch),
         },
+        {
+            "consumer-slow-start",
+            "consumer-slow-start",
+            "Start consumers with this prefetch count after each (re)connect, "
+            "doubling it as messages are acked up to the qos. Default is 0, "
+            "no slow start",
+            balcl::TypeInfo(&args.consumer.consumerSlowStart),
+            balcl::OccurrenceInfo(args.consumer.consumerSlowStart),
+        },
         {
             "R|consumer-rate",
             "consumer-rate",
@@ -241,6 +292,23 @@ int main(int argc, char* argv[])
             balcl::TypeInfo(&args.producer.messageFlag),
             balcl::OccurrenceInfo(args.producer.messageFlag),
         },
+        {
+            "connections",
+            "connections",
+            "Scale mode: spread producers and consumers round-robin over this "
+            "many connections, and report per-connection fairness, event "
+            "loop utilization, CPU per message and memory per connection "
+            "(0==a connection per producer or consumer)",
+            balcl::TypeInfo(&args.numConnections),
+            balcl::OccurrenceInfo(args.numConnections),
+        },
+        {
+            "event-loops",
+            "event-loops",
+            "Event loop threads the connections are sharded across",
+            balcl::TypeInfo(&args.eventLoopThreads),
+            balcl::OccurrenceInfo(args.eventLoopThreads),
+        },
         {
             "log-level",
             "log-level",
@@ -252,7 +320,8 @@ int main(int argc, char* argv[])
     balcl::CommandLine cmdLine(specTable);
 
     // parse command-line options; if failure, print usage
-    if (cmdLine.parse(argc, argv)) {
+    if (cmdLine.parse(argc, argv) || args.numConnections < 0 ||
+        args.eventLoopThreads < 1) {
         cmdLine.printUsage();
         return 1;
     }
@@ -51,6 +51,10 @@ struct ProducerArgs {
     , producerMessageCount(-1)
     , routingKey()
     , publishingInterval(0.0)
+    , producerRateLimit(0.0)
+    , rateSweepTo(0.0)
+    , rateSweepStep(0.0)
+    , rateSweepStepDuration(10)
     , messageSize(10)
     , messageFlag("")
     , numProducers(1)
@@ -61,13 +65,16 @@ struct ProducerArgs {
     int producerMessageCount;
     bsl::string routingKey;
     double publishingInterval;
+    double producerRateLimit; // aggregate messages per second, open-loop
+    double rateSweepTo;       // raise the rate up to this, 0 for no sweep
+    double rateSweepStep;
+    int rateSweepStepDuration; // seconds
     int messageSize;
     bsl::string messageFlag;
     int numProducers;
 
     // TODO bsl::string messageContentType;
     // TODO double producerRandomStartDelay = 0.0;
-    // TODO int producerRateLimit = 0;
 };
 
 struct ConsumerArgs {
@@ -77,6 +84,7 @@ struct ConsumerArgs {
     , consumerRateLimit(0)
     , numConsumers(1)
     , consumerArgs("")
+    , consumerSlowStart(0)
     {
     }
 
@@ -86,8 +94,8 @@ struct ConsumerArgs {
     int numConsumers;
     bsl::string
         consumerArgs; // expected comma separated "key=value, key=value, ..."
+    int consumerSlowStart; // initial prefetch after (re)connect, 0 for none
 
-    // TODO bool consumerSlowStart = false;
     // TODO int consumerLatencyUSec  = 0;
     // TODO bool nackRequeueMsg      = false;
 };
@@ -97,16 +105,20 @@ struct PerfTestArgs {
     : testId()
     , uri("amqp://localhost/")
     , testRunDuration(0)
+    , latencyReportInterval(1)
     , topology()
     , consumer()
     , producer()
     , shuffleConnectionEndpoints(false)
+    , numConnections(0)
+    , eventLoopThreads(1)
     {
     }
 
     bsl::string testId;
     bsl::string uri;
     int testRunDuration;
+    int latencyReportInterval; // seconds, 0 reports only at the end
 
     TopologyArgs topology;
 
@@ -114,6 +126,11 @@ struct PerfTestArgs {
     ProducerArgs producer;
 
     bool shuffleConnectionEndpoints;
+
+    // Scale mode: producers and consumers spread round-robin over this many
+    // connections, 0 for a connection each
+    int numConnections;
+    int eventLoopThreads;
 };
 
 } // namespace rmqperftest
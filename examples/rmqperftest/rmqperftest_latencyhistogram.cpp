@@ -0,0 +1,168 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqperftest_latencyhistogram.h>
+
+#include <bslmt_lockguard.h>
+
+#include <bsl_algorithm.h>
+
+namespace BloombergLP {
+namespace rmqperftest {
+namespace {
+
+// Values below this are counted exactly
+const bsl::int64_t k_LINEAR_BUCKETS = 128;
+// Buckets per power of two above k_LINEAR_BUCKETS
+const int k_SUB_BUCKET_BITS = 6;
+const bsl::int64_t k_SUB_BUCKETS = 1 << k_SUB_BUCKET_BITS;
+const int k_MAX_SHIFT = 40;
+
+const bsl::int64_t k_MAX_VALUE = (k_LINEAR_BUCKETS << k_MAX_SHIFT) - 1;
+const bsl::size_t k_BUCKETS = k_LINEAR_BUCKETS + k_MAX_SHIFT * k_SUB_BUCKETS;
+
+bsl::size_t bucketFor(bsl::int64_t usec)
+{
+    usec = bsl::min(bsl::max(usec, bsl::int64_t(0)), k_MAX_VALUE);
+    if (usec < k_LINEAR_BUCKETS) {
+        return static_cast<bsl::size_t>(usec);
+    }
+
+    // Shift `usec` down until it falls in [k_SUB_BUCKETS, 2*k_SUB_BUCKETS)
+    int shift = 1;
+    while ((usec >> shift) >= 2 * k_SUB_BUCKETS) {
+        ++shift;
+    }
+    return static_cast<bsl::size_t>(k_LINEAR_BUCKETS +
+                                    (shift - 1) * k_SUB_BUCKETS +
+                                    ((usec >> shift) - k_SUB_BUCKETS));
+}
+
+/// Return the highest value counted in `bucket`
+bsl::int64_t valueOf(bsl::size_t bucket)
+{
+    const bsl::int64_t index = static_cast<bsl::int64_t>(bucket);
+    if (index < k_LINEAR_BUCKETS) {
+        return index;
+    }
+
+    const int shift =
+        static_cast<int>((index - k_LINEAR_BUCKETS) / k_SUB_BUCKETS) + 1;
+    const bsl::int64_t sub =
+        (index - k_LINEAR_BUCKETS) % k_SUB_BUCKETS + k_SUB_BUCKETS;
+    return ((sub + 1) << shift) - 1;
+}
+
+} // namespace
+
+LatencyHistogram::LatencyHistogram()
+: d_mutex()
+, d_counts(k_BUCKETS, 0)
+, d_count(0)
+, d_max(0)
+{
+}
+
+void LatencyHistogram::record(bsl::int64_t usec)
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    recordLocked(usec);
+}
+
+void LatencyHistogram::recordLocked(bsl::int64_t usec)
+{
+    ++d_counts[bucketFor(usec)];
+    ++d_count;
+    d_max = bsl::max(d_max, bsl::min(usec, k_MAX_VALUE));
+}
+
+void LatencyHistogram::takeInterval(LatencyHistogram* interval)
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    bslmt::LockGuard<bslmt::Mutex> intervalGuard(&interval->d_mutex);
+
+    interval->d_counts.swap(d_counts);
+    interval->d_count = d_count;
+    interval->d_max   = d_max;
+
+    bsl::fill(d_counts.begin(), d_counts.end(), 0);
+    d_count = 0;
+    d_max   = 0;
+}
+
+void LatencyHistogram::reset()
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    bsl::fill(d_counts.begin(), d_counts.end(), 0);
+    d_count = 0;
+    d_max   = 0;
+}
+
+void LatencyHistogram::add(const LatencyHistogram& other)
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    bslmt::LockGuard<bslmt::Mutex> otherGuard(&other.d_mutex);
+
+    for (bsl::size_t i = 0; i < k_BUCKETS; ++i) {
+        d_counts[i] += other.d_counts[i];
+    }
+    d_count += other.d_count;
+    d_max = bsl::max(d_max, other.d_max);
+}
+
+bsl::uint64_t LatencyHistogram::count() const
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    return d_count;
+}
+
+bsl::int64_t LatencyHistogram::max() const
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    return d_max;
+}
+
+bsl::int64_t LatencyHistogram::valueAtPercentile(double percentile) const
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    if (d_count == 0) {
+        return 0;
+    }
+
+    // The rank of the value reported, counting from 1
+    bsl::uint64_t rank = static_cast<bsl::uint64_t>(
+        percentile / 100.0 * static_cast<double>(d_count) + 0.5);
+    rank = bsl::max(rank, bsl::uint64_t(1));
+
+    bsl::uint64_t seen = 0;
+    for (bsl::size_t i = 0; i < k_BUCKETS; ++i) {
+        seen += d_counts[i];
+        if (seen >= rank) {
+            // The top of the bucket may lie above anything recorded in it
+            return bsl::min(valueOf(i), d_max);
+        }
+    }
+    return d_max;
+}
+
+void LatencyHistogram::print(bsl::ostream& os) const
+{
+    os << "count " << count() << ", p50 " << valueAtPercentile(50.0)
+       << "us, p99 " << valueAtPercentile(99.0) << "us, p99.9 "
+       << valueAtPercentile(99.9) << "us, max " << max() << "us";
+}
+
+} // namespace rmqperftest
+} // namespace BloombergLP
@@ -0,0 +1,78 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQPERFTEST_LATENCYHISTOGRAM
+#define INCLUDED_RMQPERFTEST_LATENCYHISTOGRAM
+
+#include <bslmt_mutex.h>
+
+#include <bsl_cstdint.h>
+#include <bsl_ostream.h>
+#include <bsl_vector.h>
+
+namespace BloombergLP {
+namespace rmqperftest {
+
+/// \brief Log-linear (HDR style) histogram of latencies in microseconds
+///
+/// Values below 128us are counted exactly; above that each power of two is
+/// split into 64 buckets, so a reported value is within 1.6% of the latency
+/// recorded. Values beyond the top bucket (about 2^40us) are clamped.
+///
+/// Thread safe.
+class LatencyHistogram {
+  public:
+    LatencyHistogram();
+
+    /// Count one latency of `usec` microseconds
+    void record(bsl::int64_t usec);
+
+    /// Replace the counts in `interval` with the ones recorded here, and
+    /// start counting again from empty
+    void takeInterval(LatencyHistogram* interval);
+
+    /// Add the counts recorded in `other` to this histogram
+    void add(const LatencyHistogram& other);
+
+    /// Discard every count recorded
+    void reset();
+
+    /// Print count, p50, p99, p99.9 and max
+    void print(bsl::ostream& os) const;
+
+    bsl::uint64_t count() const;
+
+    /// Return the value at or below which `percentile` percent of the
+    /// recorded latencies fall, 0 if none were recorded
+    bsl::int64_t valueAtPercentile(double percentile) const;
+
+    bsl::int64_t max() const;
+
+  private:
+    LatencyHistogram(const LatencyHistogram&);
+    LatencyHistogram& operator=(const LatencyHistogram&);
+
+    void recordLocked(bsl::int64_t usec);
+
+    mutable bslmt::Mutex d_mutex;
+    bsl::vector<bsl::uint64_t> d_counts;
+    bsl::uint64_t d_count;
+    bsl::int64_t d_max;
+};
+
+} // namespace rmqperftest
+} // namespace BloombergLP
+
+#endif
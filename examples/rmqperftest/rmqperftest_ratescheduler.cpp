@@ -0,0 +1,90 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqperftest_ratescheduler.h>
+
+#include <bslmt_lockguard.h>
+#include <bslmt_threadutil.h>
+#include <bsls_systemclocktype.h>
+#include <bsls_systemtime.h>
+
+namespace BloombergLP {
+namespace rmqperftest {
+namespace {
+
+// Sleeping on the condition overshoots by up to the scheduler's tick, so
+// stop sleeping this long before a slot is due and yield for the rest
+const bsls::TimeInterval k_SPIN_MARGIN(0, 200 * 1000);
+
+bsls::TimeInterval now()
+{
+    return bsls::SystemTime::nowMonotonicClock();
+}
+
+} // namespace
+
+RateScheduler::RateScheduler(double ratePerSecond)
+: d_mutex()
+, d_stopCondition(bsls::SystemClockType::e_MONOTONIC)
+, d_interval(1.0 / ratePerSecond)
+, d_next(now())
+, d_stopped(false)
+{
+}
+
+bool RateScheduler::acquire(bsls::TimeInterval* due)
+{
+    {
+        bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+        *due   = d_next;
+        d_next = d_next + d_interval;
+
+        while (!d_stopped && now() < *due - k_SPIN_MARGIN) {
+            d_stopCondition.timedWait(&d_mutex, *due - k_SPIN_MARGIN);
+        }
+
+        if (d_stopped) {
+            return false;
+        }
+    }
+
+    while (now() < *due) {
+        bslmt::ThreadUtil::yield();
+    }
+    return true;
+}
+
+void RateScheduler::setRate(double ratePerSecond)
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    d_interval = bsls::TimeInterval(1.0 / ratePerSecond);
+    d_next     = now();
+}
+
+void RateScheduler::stop()
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    d_stopped = true;
+    d_stopCondition.broadcast();
+}
+
+bool RateScheduler::stopped() const
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    return d_stopped;
+}
+
+} // namespace rmqperftest
+} // namespace BloombergLP
@@ -0,0 +1,71 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQPERFTEST_RATESCHEDULER
+#define INCLUDED_RMQPERFTEST_RATESCHEDULER
+
+#include <bslmt_condition.h>
+#include <bslmt_mutex.h>
+#include <bsls_timeinterval.h>
+
+namespace BloombergLP {
+namespace rmqperftest {
+
+/// \brief Open-loop pacing of sends shared by several producer threads
+///
+/// Hands out send slots at a fixed aggregate rate, like a token bucket whose
+/// tokens are never discarded: slots are scheduled from the start time
+/// rather than from the previous send, so a thread which falls behind (e.g.
+/// blocked waiting for confirms) sends its overdue slots back to back instead
+/// of lowering the rate.
+///
+/// Waits on a monotonic condition until shortly before a slot is due, then
+/// yields until it is, to pace well below a millisecond.
+///
+/// Thread safe.
+class RateScheduler {
+  public:
+    /// Schedule `ratePerSecond` slots a second, starting now
+    explicit RateScheduler(double ratePerSecond);
+
+    /// Block until the next slot is due, and load the monotonic time it was
+    /// due at into `due`. Return false, without waiting, once `stop` was
+    /// called.
+    bool acquire(bsls::TimeInterval* due);
+
+    /// Schedule `ratePerSecond` slots a second from now on, dropping any
+    /// overdue slots
+    void setRate(double ratePerSecond);
+
+    /// Wake up and fail every current and future `acquire`
+    void stop();
+
+    bool stopped() const;
+
+  private:
+    RateScheduler(const RateScheduler&);
+    RateScheduler& operator=(const RateScheduler&);
+
+    mutable bslmt::Mutex d_mutex;
+    bslmt::Condition d_stopCondition;
+    bsls::TimeInterval d_interval;
+    bsls::TimeInterval d_next;
+    bool d_stopped;
+};
+
+} // namespace rmqperftest
+} // namespace BloombergLP
+
+#endif
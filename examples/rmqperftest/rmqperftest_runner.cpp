@@ -14,7 +14,10 @@
 // limitations under the License.
 
 #include <rmqperftest_consumerargs.h>
+#include <rmqperftest_latencyhistogram.h>
+#include <rmqperftest_ratescheduler.h>
 #include <rmqperftest_runner.h>
+#include <rmqperftest_scalestats.h>
 
 #include <rmqa_connectionstring.h>
 #include <rmqa_consumer.h>
@@ -24,8 +27,15 @@
 #include <rmqt_exchange.h>
 #include <rmqt_vhostinfo.h>
 
+#include <bdlf_bind.h>
+#include <bslmt_threadgroup.h>
+#include <bslmt_threadutil.h>
+#include <bsls_atomic.h>
+#include <bsls_systemtime.h>
+
 #include <bsl_algorithm.h>
 #include <bsl_cstdint.h>
+#include <bsl_cstring.h>
 #include <bsl_iostream.h>
 #include <bsl_iterator.h>
 #include <bsl_list.h>
@@ -44,14 +54,38 @@ namespace {
 typedef bsl::pair<bsl::shared_ptr<rmqa::Producer>, bsl::string>
     ProducerRoutingKeyPair;
 
+// Each payload starts with the monotonic time, in microseconds, at which it
+// was due to be sent
+const bsl::size_t k_TIMESTAMP_SIZE = sizeof(bsl::int64_t);
+
+bsl::int64_t nowUsec()
+{
+    return bsls::SystemTime::nowMonotonicClock().totalMicroseconds();
+}
+
+void recordLatency(LatencyHistogram& latencies, const rmqt::Message& message)
+{
+    if (message.payloadSize() < k_TIMESTAMP_SIZE) {
+        return;
+    }
+
+    bsl::int64_t sentUsec;
+    bsl::memcpy(&sentUsec, message.payload(), k_TIMESTAMP_SIZE);
+    latencies.record(nowUsec() - sentUsec);
+}
+
 class ConsumerCallback {
   public:
     ConsumerCallback(const ConsumerArgs& args,
-                     const bsl::shared_ptr<bsls::AtomicBool>& finished)
+                     const bsl::shared_ptr<bsls::AtomicBool>& finished,
+                     const bsl::shared_ptr<LatencyHistogram>& latencies,
+                     bsls::AtomicUint64* consumed)
     : d_args(args)
     , d_finished(finished)
     , d_remainingCount(bsl::make_shared<bsls::AtomicUint64>())
     , d_limitCount()
+    , d_latencies(latencies)
+    , d_consumed(consumed)
     {
         if (d_args.consumerMessageCount > 0) {
             d_limitCount      = true;
@@ -70,7 +104,9 @@ class ConsumerCallback {
                 *d_remainingCount -= 1;
             }
         }
+        recordLatency(*d_latencies, guard.message());
         guard.ack();
+        ++*d_consumed;
     }
 
   private:
@@ -78,17 +114,180 @@ class ConsumerCallback {
     bsl::shared_ptr<bsls::AtomicBool> d_finished;
     bsl::shared_ptr<bsls::AtomicUint64> d_remainingCount;
     bool d_limitCount;
+    bsl::shared_ptr<LatencyHistogram> d_latencies;
+    bsls::AtomicUint64* d_consumed;
 };
 
 class ConfirmCallback {
   public:
-    ConfirmCallback() {}
+    ConfirmCallback(const bsl::shared_ptr<LatencyHistogram>& latencies,
+                    bsls::AtomicUint64* confirmed)
+    : d_latencies(latencies)
+    , d_confirmed(confirmed)
+    {
+    }
 
-    void operator()(const rmqt::Message&,
+    void operator()(const rmqt::Message& message,
                     const bsl::string&,
-                    const rmqt::ConfirmResponse&){};
+                    const rmqt::ConfirmResponse&)
+    {
+        recordLatency(*d_latencies, message);
+        ++*d_confirmed;
+    }
+
+  private:
+    bsl::shared_ptr<LatencyHistogram> d_latencies;
+    bsls::AtomicUint64* d_confirmed;
+};
+
+/// Gathers the latencies the callbacks record into `live()` for each
+/// report, each step of a rate sweep, and the whole test
+class LatencyRecorder {
+  public:
+    explicit LatencyRecorder(const char* name)
+    : d_name(name)
+    , d_live(bsl::make_shared<LatencyHistogram>())
+    , d_report()
+    , d_step()
+    , d_total()
+    {
+    }
+
+    const bsl::shared_ptr<LatencyHistogram>& live() const { return d_live; }
+
+    /// Move the latencies recorded since the last call out of `live()`
+    void collect()
+    {
+        LatencyHistogram interval;
+        d_live->takeInterval(&interval);
+        d_report.add(interval);
+        d_step.add(interval);
+        d_total.add(interval);
+    }
+
+    /// Print, and start again, the latencies since the last report
+    void printReport()
+    {
+        collect();
+        bsl::cout << d_name << " latency: ";
+        d_report.print(bsl::cout);
+        bsl::cout << bsl::endl;
+        d_report.reset();
+    }
+
+    void printTotal()
+    {
+        collect();
+        bsl::cout << d_name << " latency over the whole test: ";
+        d_total.print(bsl::cout);
+        bsl::cout << bsl::endl;
+    }
+
+    /// Latencies collected since the current sweep step began
+    LatencyHistogram& step() { return d_step; }
+
+  private:
+    LatencyRecorder(const LatencyRecorder&);
+    LatencyRecorder& operator=(const LatencyRecorder&);
+
+    const char* d_name;
+    bsl::shared_ptr<LatencyHistogram> d_live;
+    LatencyHistogram d_report;
+    LatencyHistogram d_step;
+    LatencyHistogram d_total;
+};
+
+/// Return a message of the configured size, stamped with `dueUsec`
+rmqt::Message makeMessage(const ProducerArgs& args, bsl::int64_t dueUsec)
+{
+    bsl::shared_ptr<bsl::vector<uint8_t> > payload =
+        bsl::make_shared<bsl::vector<uint8_t> >(
+            std::max(args.messageSize, static_cast<int>(k_TIMESTAMP_SIZE)),
+            'a');
+    bsl::memcpy(payload->data(), &dueUsec, k_TIMESTAMP_SIZE);
+
+    rmqt::Message msg(payload);
+    if (args.messageFlag == "persistent") {
+        msg.updateDeliveryMode(rmqt::DeliveryMode::PERSISTENT);
+    }
+    else {
+        msg.updateDeliveryMode(rmqt::DeliveryMode::NON_PERSISTENT);
+    }
+    return msg;
+}
+
+// How long an open-loop publisher blocks in `send` before checking whether
+// the test has stopped
+const bsls::TimeInterval k_SEND_TIMEOUT(1, 0);
+
+/// Publish on `producer` in the slots `scheduler` hands out, until it is
+/// stopped or `remaining` (shared by every publisher) runs out. A negative
+/// `remaining` never runs out.
+void publishOpenLoop(RateScheduler* scheduler,
+                     ProducerRoutingKeyPair producer,
+                     const ProducerArgs& args,
+                     bsl::shared_ptr<LatencyHistogram> confirmLatencies,
+                     bsls::AtomicUint64* confirmed,
+                     bsls::AtomicInt64* remaining,
+                     bsls::AtomicInt* running)
+{
+    bsls::TimeInterval due;
+    while (scheduler->acquire(&due)) {
+        if (remaining->load() >= 0 && remaining->subtract(1) < 0) {
+            break;
+        }
+
+        const rmqt::Message msg = makeMessage(args, due.totalMicroseconds());
+        while (producer.first->send(msg,
+                                    producer.second,
+                                    ConfirmCallback(confirmLatencies,
+                                                    confirmed),
+                                    k_SEND_TIMEOUT) ==
+                   rmqp::Producer::TIMEOUT &&
+               !scheduler->stopped()) {
+        }
+    }
+    --(*running);
+}
+
+struct SweepStep {
+    double rate;
+    double delivered; // messages per second
+    bsl::int64_t p99; // microseconds
 };
 
+// A sweep step is past the knee once it delivers less than this fraction of
+// its rate, or its p99 latency exceeds the first step's by this factor
+const double k_KNEE_MIN_DELIVERED = 0.95;
+const double k_KNEE_LATENCY_FACTOR = 2.0;
+
+void reportKnee(const bsl::vector<SweepStep>& steps)
+{
+    if (steps.empty()) {
+        return;
+    }
+
+    const SweepStep* knee = 0;
+    for (bsl::vector<SweepStep>::const_iterator it = steps.begin();
+         it != steps.end();
+         ++it) {
+        if (it->delivered < k_KNEE_MIN_DELIVERED * it->rate ||
+            it->p99 > k_KNEE_LATENCY_FACTOR * steps.front().p99) {
+            break;
+        }
+        knee = &*it;
+    }
+
+    if (!knee) {
+        bsl::cout << "Rate sweep saturated at its first rate of "
+                  << steps.front().rate << " msg/s" << bsl::endl;
+    }
+    else {
+        bsl::cout << "Rate sweep knee at " << knee->rate << " msg/s (p99 "
+                  << knee->p99 << "us)" << bsl::endl;
+    }
+}
+
 bsl::string_view queueNameOrRoutingKey(bsl::string_view routingKey,
                                        bsl::string_view queueName)
 {
@@ -100,8 +299,16 @@ bsl::string_view queueNameOrRoutingKey(bsl::string_view routingKey,
     }
 }
 
-void finalizeProducers(bsl::vector<ProducerRoutingKeyPair>& producers)
+void finalizeProducers(bsl::vector<ProducerRoutingKeyPair>& producers,
+                       bslmt::ThreadGroup& publishers,
+                       bsl::shared_ptr<RateScheduler>& scheduler)
 {
+    if (scheduler) {
+        scheduler->stop();
+        publishers.joinAll();
+        scheduler.reset();
+    }
+
     bsl::cout << producers.size() << " producers finished, exiting producers"
               << bsl::endl;
     for (bsl::vector<ProducerRoutingKeyPair>::iterator it = producers.begin();
@@ -116,8 +323,26 @@ void finalizeProducers(bsl::vector<ProducerRoutingKeyPair>& producers)
 
 int Runner::run(const PerfTestArgs& args)
 {
+    // In scale mode clients share connections, and the event loops report
+    // how busy they are
+    const bool scale = args.numConnections > 0;
+    const int numConnections =
+        scale ? args.numConnections
+              : std::max(args.producer.numProducers,
+                         args.consumer.numConsumers);
+
+    // Outlives the context, whose callbacks count into it
+    ScaleStats scaleStats(numConnections);
+
     rmqa::RabbitContextOptions options;
     options.setShuffleConnectionEndpoints(args.shuffleConnectionEndpoints);
+    options.setEventLoopThreads(args.eventLoopThreads);
+    bsl::shared_ptr<EventLoopUtilization> utilization;
+    if (scale) {
+        utilization = bsl::make_shared<EventLoopUtilization>();
+        options.setMetricPublisher(utilization);
+        options.setEventLoopMetrics(true);
+    }
     rmqa::RabbitContext rabbit(options);
 
     bsl::optional<rmqt::VHostInfo> vhostInfo =
@@ -128,11 +353,11 @@ int Runner::run(const PerfTestArgs& args)
         return 1;
     }
 
+    scaleStats.connectionsStarting();
+
     bsl::vector<bsl::shared_ptr<rmqa::VHost> > connections;
 
-    for (int i = 0;
-         i < std::max(args.producer.numProducers, args.consumer.numConsumers);
-         i++) {
+    for (int i = 0; i < numConnections; i++) {
         connections.push_back(
             rabbit.createVHostConnection(args.testId, *vhostInfo));
 
@@ -196,12 +421,13 @@ int Runner::run(const PerfTestArgs& args)
 
     // Create producer
     bsl::vector<ProducerRoutingKeyPair> producers;
+    bsl::vector<bsls::AtomicUint64*> producerConfirms;
     {
         bsl::vector<rmqt::QueueHandle>::const_iterator queues;
         queues = v_queues.begin();
         for (int i = 0; i < args.producer.numProducers; i++) {
             rmqt::Result<rmqa::Producer> producerResult =
-                connections[i]->createProducer(
+                connections[i % numConnections]->createProducer(
                     topology, exch, args.producer.maxOutstandingConfirms);
 
             if (!producerResult) {
@@ -213,6 +439,8 @@ int Runner::run(const PerfTestArgs& args)
                 producerResult.value(),
                 bsl::string(queueNameOrRoutingKey(args.producer.routingKey,
                                                   queues->lock()->name()))));
+            producerConfirms.push_back(
+                scaleStats.confirmed(i % numConnections));
 
             queues++;
             if (queues == v_queues.end()) {
@@ -221,6 +449,9 @@ int Runner::run(const PerfTestArgs& args)
         }
     }
 
+    LatencyRecorder consumeLatencies("Consume");
+    LatencyRecorder confirmLatencies("Confirm");
+
     // Pair of <consumer, consumerFinished flag>
     typedef bsl::pair<bsl::shared_ptr<rmqa::Consumer>,
                       bsl::shared_ptr<bsls::AtomicBool> >
@@ -237,6 +468,8 @@ int Runner::run(const PerfTestArgs& args)
         consumerConfig.setConsumerTag(args.testId + " consumer " +
                                       bsl::to_string(i));
         consumerConfig.setPrefetchCount(args.consumer.prefetch);
+        consumerConfig.setSlowStartPrefetchCount(
+            static_cast<uint16_t>(args.consumer.consumerSlowStart));
         bsl::optional<long long> priority =
             findPriorityValue(args.consumer.consumerArgs);
         if (priority) {
@@ -249,10 +482,13 @@ int Runner::run(const PerfTestArgs& args)
             bsl::make_shared<bsls::AtomicBool>(false);
 
         rmqt::Result<rmqa::Consumer> consumerResult =
-            connections[i]->createConsumer(
+            connections[i % numConnections]->createConsumer(
                 topology,
                 *queues,
-                ConsumerCallback(args.consumer, consumerFinishedFlag),
+                ConsumerCallback(args.consumer,
+                                 consumerFinishedFlag,
+                                 consumeLatencies.live(),
+                                 scaleStats.consumed(i % numConnections)),
                 consumerConfig);
 
         if (!consumerResult) {
@@ -271,10 +507,67 @@ int Runner::run(const PerfTestArgs& args)
         }
     }
 
+    scaleStats.connectionsReady();
+
     const bsls::TimeInterval startTime = bsls::SystemTime::nowMonotonicClock();
 
-    bsls::TimeInterval nextPublish =
-        startTime + bsls::TimeInterval(args.producer.publishingInterval, 0);
+    const bsls::TimeInterval publishingInterval(
+        args.producer.publishingInterval);
+
+    // With a target rate, messages are stamped with when they were due to be
+    // sent rather than when they were, so that a stall (e.g. waiting for
+    // confirms) shows up in the latency of every message it delayed instead
+    // of only the one it held up (coordinated omission)
+    const bool targetRate = publishingInterval > bsls::TimeInterval();
+
+    bsls::TimeInterval nextPublish = startTime + publishingInterval;
+
+    const bsls::TimeInterval reportInterval(args.latencyReportInterval, 0);
+    bsls::TimeInterval nextReport = startTime + reportInterval;
+
+    // With a rate limit every producer publishes from its own thread, in
+    // slots handed out by a shared scheduler
+    bsl::shared_ptr<RateScheduler> scheduler;
+    bslmt::ThreadGroup publishers;
+    bsls::AtomicInt publishersRunning(0);
+    bsls::AtomicInt64 remainingMessages(
+        args.producer.producerMessageCount > 0
+            ? static_cast<bsls::Types::Int64>(
+                  args.producer.producerMessageCount) *
+                  args.producer.numProducers
+            : -1);
+
+    double rate = args.producer.producerRateLimit;
+    const bool sweeping = rate > 0 && args.producer.rateSweepTo > 0;
+    if (sweeping && args.producer.rateSweepStep <= 0) {
+        bsl::cerr << "`--rate-sweep-step` must be positive to sweep the rate"
+                  << "\n";
+        return 1;
+    }
+    const bsls::TimeInterval sweepStepDuration(
+        args.producer.rateSweepStepDuration, 0);
+    bsls::TimeInterval nextSweepStep = startTime + sweepStepDuration;
+    bsl::vector<SweepStep> sweepSteps;
+
+    // The sweep judges throughput by what reaches the consumers, if any
+    LatencyRecorder& sweepLatencies =
+        args.consumer.numConsumers > 0 ? consumeLatencies : confirmLatencies;
+
+    if (rate > 0) {
+        scheduler = bsl::make_shared<RateScheduler>(rate);
+        for (bsl::size_t i = 0; i < producers.size(); ++i) {
+            ++publishersRunning;
+            publishers.addThread(
+                bdlf::BindUtil::bind(&publishOpenLoop,
+                                     scheduler.get(),
+                                     producers[i],
+                                     args.producer,
+                                     confirmLatencies.live(),
+                                     producerConfirms[i],
+                                     &remainingMessages,
+                                     &publishersRunning));
+        }
+    }
 
     size_t producerMessagesSent = 0;
 
@@ -287,6 +580,18 @@ int Runner::run(const PerfTestArgs& args)
             break;
         }
 
+        if (args.latencyReportInterval > 0 && currentTime >= nextReport) {
+            consumeLatencies.printReport();
+            confirmLatencies.printReport();
+            if (scale) {
+                scaleStats.printReport(bsl::cout);
+                bsl::cout << "\n";
+                utilization->print(bsl::cout);
+                bsl::cout << bsl::endl;
+            }
+            nextReport = nextReport + reportInterval;
+        }
+
         for (bsl::list<ConsumerAndExitFlag>::iterator it = consumers.begin();
              it != consumers.end();) {
             if (*(it->second)) {
@@ -298,29 +603,59 @@ int Runner::run(const PerfTestArgs& args)
             }
         }
 
+        if (scheduler) {
+            if (sweeping && currentTime >= nextSweepStep) {
+                sweepLatencies.collect();
+
+                SweepStep step;
+                step.rate      = rate;
+                step.delivered = sweepLatencies.step().count() /
+                                 sweepStepDuration.totalSecondsAsDouble();
+                step.p99 = sweepLatencies.step().valueAtPercentile(99.0);
+                sweepSteps.push_back(step);
+                sweepLatencies.step().reset();
+
+                bsl::cout << "Rate sweep step at " << step.rate
+                          << " msg/s: delivered " << step.delivered
+                          << " msg/s, p99 " << step.p99 << "us" << bsl::endl;
+
+                rate += args.producer.rateSweepStep;
+                if (rate > args.producer.rateSweepTo) {
+                    reportKnee(sweepSteps);
+                    finalizeProducers(producers, publishers, scheduler);
+                }
+                else {
+                    scheduler->setRate(rate);
+                    nextSweepStep = currentTime + sweepStepDuration;
+                }
+            }
+
+            if (scheduler && publishersRunning == 0) {
+                finalizeProducers(producers, publishers, scheduler);
+            }
+
+            bslmt::ThreadUtil::microSleep(10 * 1000);
+            continue;
+        }
+
         // Sleep until the next publish
         const int64_t usSleep = (nextPublish - currentTime).totalMicroseconds();
         usleep(std::max(usSleep, (int64_t)0));
 
-        nextPublish = nextPublish +
-                      bsls::TimeInterval(args.producer.publishingInterval, 0);
-
-        if (producers.size() > 0) {
-            rmqt::Message msg(bsl::make_shared<bsl::vector<uint8_t> >(
-                args.producer.messageSize, 'a'));
+        const bsl::int64_t dueUsec =
+            targetRate ? nextPublish.totalMicroseconds() : nowUsec();
 
-            if (args.producer.messageFlag == "persistent") {
-                msg.updateDeliveryMode(rmqt::DeliveryMode::PERSISTENT);
-            }
-            else {
-                msg.updateDeliveryMode(rmqt::DeliveryMode::NON_PERSISTENT);
-            }
+        nextPublish = nextPublish + publishingInterval;
 
-            for (bsl::vector<ProducerRoutingKeyPair>::iterator it =
-                     producers.begin();
-                 it != producers.end();
-                 ++it) {
-                it->first->send(msg, it->second, ConfirmCallback());
+        if (producers.size() > 0) {
+            const rmqt::Message msg = makeMessage(args.producer, dueUsec);
+
+            for (bsl::size_t i = 0; i < producers.size(); ++i) {
+                producers[i].first->send(
+                    msg,
+                    producers[i].second,
+                    ConfirmCallback(confirmLatencies.live(),
+                                    producerConfirms[i]));
             }
 
             producerMessagesSent += 1;
@@ -328,7 +663,7 @@ int Runner::run(const PerfTestArgs& args)
             if ((int)producerMessagesSent >=
                 args.producer.producerMessageCount) {
 
-                finalizeProducers(producers);
+                finalizeProducers(producers, publishers, scheduler);
             }
         }
     }
@@ -338,6 +673,25 @@ int Runner::run(const PerfTestArgs& args)
         << (bsls::SystemTime::nowMonotonicClock() - startTime).totalSeconds()
         << " seconds" << bsl::endl;
 
+    if (scheduler) {
+        // Stopped by the test duration
+        if (sweeping) {
+            reportKnee(sweepSteps);
+        }
+        finalizeProducers(producers, publishers, scheduler);
+    }
+
+    consumeLatencies.printReport();
+    confirmLatencies.printReport();
+    consumeLatencies.printTotal();
+    confirmLatencies.printTotal();
+    if (scale) {
+        scaleStats.printTotal(bsl::cout);
+        bsl::cout << "\n";
+        utilization->print(bsl::cout);
+        bsl::cout << bsl::endl;
+    }
+
     return 0;
 }
 
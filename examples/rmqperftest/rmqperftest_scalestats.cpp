@@ -0,0 +1,241 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqperftest_scalestats.h>
+
+#include <bslmt_lockguard.h>
+#include <bsls_systemtime.h>
+
+#include <bsl_algorithm.h>
+#include <bsl_fstream.h>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace BloombergLP {
+namespace rmqperftest {
+namespace {
+
+/// Process CPU time (user and system) in microseconds
+bsls::Types::Int64 cpuMicroseconds()
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000LL +
+           usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+/// Resident memory in bytes: the current size where /proc is available,
+/// otherwise the peak
+bsls::Types::Int64 residentBytes()
+{
+    bsl::ifstream statm("/proc/self/statm");
+    bsls::Types::Int64 size     = 0;
+    bsls::Types::Int64 resident = 0;
+    if (statm >> size >> resident) {
+        return resident * sysconf(_SC_PAGESIZE);
+    }
+
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return usage.ru_maxrss;
+#else
+    return usage.ru_maxrss * 1024LL;
+#endif
+}
+
+/// Print the spread of `counts` across connections, with Jain's fairness
+/// index: 1 when every connection moved the same number of messages, 1/n
+/// when one connection moved them all
+void printFairness(bsl::ostream& os, const bsl::vector<bsl::uint64_t>& counts)
+{
+    if (counts.empty()) {
+        return;
+    }
+
+    double sum        = 0;
+    double sumSquares = 0;
+    for (bsl::size_t i = 0; i < counts.size(); ++i) {
+        const double count = static_cast<double>(counts[i]);
+        sum += count;
+        sumSquares += count * count;
+    }
+
+    os << "min " << *bsl::min_element(counts.begin(), counts.end())
+       << ", mean " << sum / counts.size() << ", max "
+       << *bsl::max_element(counts.begin(), counts.end()) << " msgs, "
+       << "fairness "
+       << (sumSquares > 0 ? sum * sum / (counts.size() * sumSquares) : 1.0);
+}
+
+} // namespace
+
+EventLoopUtilization::EventLoopUtilization()
+: d_mutex()
+, d_handlerNs()
+, d_lastPrint(bsls::SystemTime::nowMonotonicClock())
+{
+}
+
+void EventLoopUtilization::print(bsl::ostream& os)
+{
+    bsl::map<bsl::string, double> handlerNs;
+    bsls::TimeInterval elapsed;
+    {
+        bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+        handlerNs.swap(d_handlerNs);
+
+        const bsls::TimeInterval now = bsls::SystemTime::nowMonotonicClock();
+        elapsed                      = now - d_lastPrint;
+        d_lastPrint                  = now;
+    }
+
+    const double elapsedNs = static_cast<double>(elapsed.totalNanoseconds());
+    os << "Event loop utilization:";
+    for (bsl::map<bsl::string, double>::const_iterator it = handlerNs.begin();
+         it != handlerNs.end();
+         ++it) {
+        os << " loop " << it->first << " "
+           << (elapsedNs > 0 ? 100 * it->second / elapsedNs : 0) << "%";
+    }
+    if (handlerNs.empty()) {
+        os << " none published yet";
+    }
+}
+
+void EventLoopUtilization::publishGauge(
+    const bsl::string&,
+    double,
+    const bsl::vector<bsl::pair<bsl::string, bsl::string> >&)
+{
+}
+
+void EventLoopUtilization::publishCounter(
+    const bsl::string& name,
+    double value,
+    const bsl::vector<bsl::pair<bsl::string, bsl::string> >& tags)
+{
+    if (name != "event_loop_handler_ns") {
+        return;
+    }
+
+    for (bsl::vector<bsl::pair<bsl::string, bsl::string> >::const_iterator
+             it = tags.begin();
+         it != tags.end();
+         ++it) {
+        if (it->first == "event_loop") {
+            bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+            d_handlerNs[it->second] += value;
+            return;
+        }
+    }
+}
+
+void EventLoopUtilization::publishSummary(
+    const bsl::string&,
+    double,
+    const bsl::vector<bsl::pair<bsl::string, bsl::string> >&)
+{
+}
+
+void EventLoopUtilization::publishDistribution(
+    const bsl::string&,
+    double,
+    const bsl::vector<bsl::pair<bsl::string, bsl::string> >&)
+{
+}
+
+ScaleStats::ScaleStats(bsl::size_t connections)
+: d_confirmed()
+, d_consumed()
+, d_lastReport(connections)
+, d_rssBefore(0)
+, d_rssReady(0)
+, d_cpuStart(0)
+{
+    for (bsl::size_t i = 0; i < connections; ++i) {
+        d_confirmed.push_back(bsl::make_shared<bsls::AtomicUint64>(0));
+        d_consumed.push_back(bsl::make_shared<bsls::AtomicUint64>(0));
+    }
+}
+
+bsls::AtomicUint64* ScaleStats::confirmed(bsl::size_t connection)
+{
+    return d_confirmed[connection].get();
+}
+
+bsls::AtomicUint64* ScaleStats::consumed(bsl::size_t connection)
+{
+    return d_consumed[connection].get();
+}
+
+void ScaleStats::connectionsStarting() { d_rssBefore = residentBytes(); }
+
+void ScaleStats::connectionsReady()
+{
+    d_rssReady = residentBytes();
+    d_cpuStart = cpuMicroseconds();
+}
+
+bsl::vector<bsl::uint64_t> ScaleStats::totals() const
+{
+    bsl::vector<bsl::uint64_t> totals(d_confirmed.size());
+    for (bsl::size_t i = 0; i < totals.size(); ++i) {
+        totals[i] = d_confirmed[i]->load() + d_consumed[i]->load();
+    }
+    return totals;
+}
+
+void ScaleStats::printReport(bsl::ostream& os)
+{
+    const bsl::vector<bsl::uint64_t> current = totals();
+    bsl::vector<bsl::uint64_t> interval(current.size());
+    for (bsl::size_t i = 0; i < current.size(); ++i) {
+        interval[i] = current[i] - d_lastReport[i];
+    }
+    d_lastReport = current;
+
+    os << "Per connection: ";
+    printFairness(os, interval);
+}
+
+void ScaleStats::printTotal(bsl::ostream& os)
+{
+    const bsl::vector<bsl::uint64_t> current = totals();
+    bsl::uint64_t messages                   = 0;
+    for (bsl::size_t i = 0; i < current.size(); ++i) {
+        messages += current[i];
+    }
+
+    os << "Per connection over the whole test: ";
+    printFairness(os, current);
+    os << "\nCPU per message (confirmed or consumed): "
+       << (messages ? static_cast<double>(cpuMicroseconds() - d_cpuStart) /
+                          messages
+                    : 0)
+       << "us\nResident memory per connection: "
+       << (current.empty() ? 0
+                           : static_cast<double>(d_rssReady - d_rssBefore) /
+                                 current.size() / 1024)
+       << "KiB";
+}
+
+} // namespace rmqperftest
+} // namespace BloombergLP
@@ -0,0 +1,135 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQPERFTEST_SCALESTATS
+#define INCLUDED_RMQPERFTEST_SCALESTATS
+
+#include <rmqp_metricpublisher.h>
+
+#include <bslmt_mutex.h>
+#include <bsls_atomic.h>
+#include <bsls_keyword.h>
+#include <bsls_timeinterval.h>
+#include <bsls_types.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_map.h>
+#include <bsl_memory.h>
+#include <bsl_ostream.h>
+#include <bsl_string.h>
+#include <bsl_utility.h>
+#include <bsl_vector.h>
+
+namespace BloombergLP {
+namespace rmqperftest {
+
+/// \brief Sums the `event_loop_handler_ns` counters published with
+/// `RabbitContextOptions::setEventLoopMetrics`, to tell how busy each event
+/// loop thread is. Ignores every other metric.
+///
+/// Thread safe.
+class EventLoopUtilization : public rmqp::MetricPublisher {
+  public:
+    EventLoopUtilization();
+
+    /// Print the fraction of the time since the last call each event loop
+    /// spent running handlers
+    void print(bsl::ostream& os);
+
+    void publishGauge(
+        const bsl::string& name,
+        double value,
+        const bsl::vector<bsl::pair<bsl::string, bsl::string> >& tags)
+        BSLS_KEYWORD_OVERRIDE;
+
+    void publishCounter(
+        const bsl::string& name,
+        double value,
+        const bsl::vector<bsl::pair<bsl::string, bsl::string> >& tags)
+        BSLS_KEYWORD_OVERRIDE;
+
+    void publishSummary(
+        const bsl::string& name,
+        double value,
+        const bsl::vector<bsl::pair<bsl::string, bsl::string> >& tags)
+        BSLS_KEYWORD_OVERRIDE;
+
+    void publishDistribution(
+        const bsl::string& name,
+        double value,
+        const bsl::vector<bsl::pair<bsl::string, bsl::string> >& tags)
+        BSLS_KEYWORD_OVERRIDE;
+
+  private:
+    EventLoopUtilization(const EventLoopUtilization&);
+    EventLoopUtilization& operator=(const EventLoopUtilization&);
+
+    bslmt::Mutex d_mutex;
+
+    /// Handler nanoseconds per event loop since the last `print`
+    bsl::map<bsl::string, double> d_handlerNs;
+    bsls::TimeInterval d_lastPrint;
+};
+
+/// \brief What a scale run costs, and how evenly its connections share the
+/// broker: messages confirmed and consumed per connection, CPU time per
+/// message and resident memory per connection
+///
+/// Counting is thread safe. The other methods are called from the thread
+/// running the test.
+class ScaleStats {
+  public:
+    explicit ScaleStats(bsl::size_t connections);
+
+    /// Counter of the messages confirmed on `connection`
+    bsls::AtomicUint64* confirmed(bsl::size_t connection);
+
+    /// Counter of the messages consumed on `connection`
+    bsls::AtomicUint64* consumed(bsl::size_t connection);
+
+    /// Record the resident memory before the connections are created
+    void connectionsStarting();
+
+    /// Record the resident memory once every producer and consumer is
+    /// ready, and start measuring CPU time from now
+    void connectionsReady();
+
+    /// Print per-connection fairness of the messages counted since the last
+    /// report
+    void printReport(bsl::ostream& os);
+
+    /// Print fairness over the whole test, CPU time per message and
+    /// resident memory per connection
+    void printTotal(bsl::ostream& os);
+
+  private:
+    ScaleStats(const ScaleStats&);
+    ScaleStats& operator=(const ScaleStats&);
+
+    /// Messages confirmed and consumed on each connection
+    bsl::vector<bsl::uint64_t> totals() const;
+
+    bsl::vector<bsl::shared_ptr<bsls::AtomicUint64> > d_confirmed;
+    bsl::vector<bsl::shared_ptr<bsls::AtomicUint64> > d_consumed;
+    bsl::vector<bsl::uint64_t> d_lastReport;
+    bsls::Types::Int64 d_rssBefore;
+    bsls::Types::Int64 d_rssReady;
+    bsls::Types::Int64 d_cpuStart;
+};
+
+} // namespace rmqperftest
+} // namespace BloombergLP
+
+#endif
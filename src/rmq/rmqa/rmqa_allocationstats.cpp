@@ -0,0 +1,60 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_allocationstats.h>
+
+#include <bsls_assert.h>
+
+namespace BloombergLP {
+namespace rmqa {
+
+AllocationStats::AllocationStats(bslma::Allocator* upstream)
+: d_rmqio(upstream)
+, d_rmqamqp(upstream)
+{
+}
+
+bslma::Allocator* AllocationStats::allocator(Subsystem subsystem)
+{
+    BSLS_ASSERT(subsystem < NUM_SUBSYSTEMS);
+    return subsystem == RMQIO ? &d_rmqio : &d_rmqamqp;
+}
+
+AllocationStats::Counts AllocationStats::counts(Subsystem subsystem) const
+{
+    BSLS_ASSERT(subsystem < NUM_SUBSYSTEMS);
+    const rmqio::CountingAllocator& allocator =
+        subsystem == RMQIO ? d_rmqio : d_rmqamqp;
+
+    Counts counts;
+    counts.allocations = allocator.allocations();
+    counts.bytes       = allocator.bytesAllocated();
+    return counts;
+}
+
+const char* AllocationStats::toString(Subsystem subsystem)
+{
+    switch (subsystem) {
+        case RMQIO:
+            return "rmqio";
+        case RMQAMQP:
+            return "rmqamqp";
+        default:
+            return "unknown";
+    }
+}
+
+} // namespace rmqa
+} // namespace BloombergLP
@@ -0,0 +1,90 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQA_ALLOCATIONSTATS
+#define INCLUDED_RMQA_ALLOCATIONSTATS
+
+#include <rmqio_countingallocator.h>
+
+#include <bslma_allocator.h>
+#include <bsls_keyword.h>
+#include <bsls_types.h>
+
+//@PURPOSE: Count a RabbitContext's per-message allocations by subsystem
+//
+//@CLASSES:
+//  rmqa::AllocationStats: Counting allocators handed to a RabbitContext
+
+namespace BloombergLP {
+namespace rmqa {
+
+/// \brief Counts the allocations a RabbitContext makes per message, by the
+/// subsystem making them
+///
+/// Opt-in instrumentation for benchmarks, see
+/// `RabbitContextOptions::setAllocationStats`. Dividing the growth in counts
+/// over a run by the messages published or consumed gives the allocations
+/// and bytes per message, which is how changes to pooling and zero-copy
+/// paths are validated.
+///
+/// `RMQIO` counts the blocks socket reads are decoded from. `RMQAMQP` counts
+/// each connection's pool of outgoing frames and the payloads of the
+/// messages it assembles. The allocations the rmqa producers and consumers
+/// make for each message go through the default allocator; install a
+/// counting default allocator (e.g. an `rmqio::CountingAllocator`) as well
+/// to measure them, and subtract the counts here if it is also the upstream.
+///
+/// Thread safe.
+
+class AllocationStats {
+  public:
+    enum Subsystem { RMQIO = 0, RMQAMQP, NUM_SUBSYSTEMS };
+
+    struct Counts {
+        bsls::Types::Int64 allocations;
+        bsls::Types::Int64 bytes;
+
+        Counts()
+        : allocations(0)
+        , bytes(0)
+        {
+        }
+    };
+
+    /// Count allocations forwarded to `upstream`, or the default allocator
+    /// if 0
+    explicit AllocationStats(bslma::Allocator* upstream = 0);
+
+    /// Return the allocator `subsystem` allocates from
+    bslma::Allocator* allocator(Subsystem subsystem);
+
+    /// Return the allocations `subsystem` has made so far
+    Counts counts(Subsystem subsystem) const;
+
+    /// Return the lower case name of `subsystem`, e.g. "rmqio"
+    static const char* toString(Subsystem subsystem);
+
+  private:
+    AllocationStats(const AllocationStats&) BSLS_KEYWORD_DELETED;
+    AllocationStats& operator=(const AllocationStats&) BSLS_KEYWORD_DELETED;
+
+    rmqio::CountingAllocator d_rmqio;
+    rmqio::CountingAllocator d_rmqamqp;
+};
+
+} // namespace rmqa
+} // namespace BloombergLP
+
+#endif
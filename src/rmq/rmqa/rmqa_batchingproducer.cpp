@@ -0,0 +1,418 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_batchingproducer.h>
+
+#include <rmqa_messagebatchutil.h>
+
+#include <rmqio_eventloop.h>
+#include <rmqt_confirmresponse.h>
+#include <rmqt_properties.h>
+
+#include <ball_log.h>
+#include <bdlf_bind.h>
+#include <bsls_systemtime.h>
+
+#include <bsl_algorithm.h>
+
+namespace BloombergLP {
+namespace rmqa {
+namespace {
+
+BALL_LOG_SET_NAMESPACE_CATEGORY("RMQA.BATCHINGPRODUCER")
+
+typedef BatchingProducer::Batch Batch;
+typedef BatchingProducer::SharedState SharedState;
+
+// Message ids are packed as AMQP short strings
+const bsl::size_t k_MAX_MESSAGE_ID = 255;
+
+/// Releases a semaphore acquired as a lock when it goes out of scope
+class HeldLock {
+  public:
+    explicit HeldLock(bslmt::TimedSemaphore& lock)
+    : d_lock(lock)
+    {
+    }
+
+    ~HeldLock() { d_lock.post(); }
+
+  private:
+    HeldLock(const HeldLock&) BSLS_KEYWORD_DELETED;
+    HeldLock& operator=(const HeldLock&) BSLS_KEYWORD_DELETED;
+
+    bslmt::TimedSemaphore& d_lock;
+};
+
+/// Wait up to `timeout` (forever if 0) for `lock`. Return false on timeout
+bool acquire(bslmt::TimedSemaphore& lock, const bsls::TimeInterval& timeout)
+{
+    if (timeout.totalNanoseconds() == 0) {
+        lock.wait();
+        return true;
+    }
+    return lock.timedWait(bsls::SystemTime::nowRealtimeClock() + timeout) ==
+           0;
+}
+
+bool batchable(const rmqt::Message& message,
+               rmqt::Mandatory::Value mandatoryFlag)
+{
+    return mandatoryFlag == rmqt::Mandatory::RETURN_UNROUTABLE &&
+           message.messageId().size() <= k_MAX_MESSAGE_ID;
+}
+
+/// Invoked with the container's confirm: confirm each message it held
+void confirmBatch(const bsl::shared_ptr<const Batch>& batch,
+                  const rmqt::Message&,
+                  const bsl::string&,
+                  const rmqt::ConfirmResponse& confirmResponse)
+{
+    for (bsl::size_t i = 0; i < batch->messages.size(); ++i) {
+        if (batch->confirmCallbacks[i]) {
+            batch->confirmCallbacks[i](
+                batch->messages[i], batch->routingKey, confirmResponse);
+        }
+    }
+}
+
+/// Send the pending messages through the wrapped producer, waiting up to
+/// `timeout` if `wait`. The lock must be held
+rmqp::Producer::SendStatus sendPending(SharedState& state,
+                                       bool wait,
+                                       const bsls::TimeInterval& timeout)
+{
+    const Batch& batch = *state.pending;
+    if (batch.messages.empty()) {
+        return rmqp::Producer::SENDING;
+    }
+
+    rmqt::Message message;
+    rmqp::Producer::ConfirmationCallback confirmCallback;
+    if (batch.messages.size() == 1) {
+        // Not worth a container
+        message         = batch.messages.front();
+        confirmCallback = batch.confirmCallbacks.front();
+    }
+    else {
+        message         = MessageBatchUtil::pack(batch.messages);
+        confirmCallback = bdlf::BindUtil::bind(
+            &confirmBatch,
+            bsl::shared_ptr<const Batch>(state.pending),
+            bdlf::PlaceHolders::_1,
+            bdlf::PlaceHolders::_2,
+            bdlf::PlaceHolders::_3);
+    }
+
+    const rmqp::Producer::SendStatus status =
+        wait ? state.producer->send(message,
+                                    batch.routingKey,
+                                    rmqt::Mandatory::RETURN_UNROUTABLE,
+                                    confirmCallback,
+                                    timeout)
+             : state.producer->trySend(
+                   message, batch.routingKey, confirmCallback);
+
+    if (status == rmqp::Producer::SENDING) {
+        state.pending = bsl::make_shared<Batch>();
+    }
+    return status;
+}
+
+/// Start the linger timer, unless it is already running. The lock must be
+/// held
+void armTimer(SharedState& state)
+{
+    if (state.timerArmed) {
+        return;
+    }
+    state.timerArmed = true;
+    state.eventLoop.post(bdlf::BindUtil::bind(
+        &rmqio::Timer::reset, state.timer, state.maxLinger));
+}
+
+void sendLingering(const bsl::shared_ptr<SharedState>& state)
+{
+    if (state->lock.tryWait() != 0) {
+        // A sender holds the lock: check again once it has had its turn
+        state->eventLoop.post(bdlf::BindUtil::bind(
+            &rmqio::Timer::reset, state->timer, state->maxLinger));
+        return;
+    }
+
+    HeldLock held(state->lock);
+    state->timerArmed = false;
+
+    if (sendPending(*state, false, bsls::TimeInterval()) !=
+        rmqp::Producer::SENDING) {
+        BALL_LOG_DEBUG << "No room to send " << state->pending->messages.size()
+                       << " batched message(s), trying again in "
+                       << state->maxLinger;
+        armTimer(*state);
+    }
+}
+
+void onLingerTimer(const bsl::weak_ptr<SharedState>& weakState,
+                   rmqio::Timer::InterruptReason reason)
+{
+    bsl::shared_ptr<SharedState> state = weakState.lock();
+    if (reason != rmqio::Timer::EXPIRE || !state) {
+        return;
+    }
+
+    // Sending may call application callbacks, so keep it off the event loop
+    int rc = state->threadPool.enqueueJob(
+        bdlf::BindUtil::bind(&sendLingering, state));
+    if (rc != 0) {
+        BALL_LOG_ERROR << "Couldn't enqueue thread pool job to send batched "
+                          "messages (return code "
+                       << rc << ")";
+    }
+}
+
+} // namespace
+
+BatchingProducer::BatchingProducer(
+    const bsl::shared_ptr<rmqp::Producer>& producer,
+    bsl::size_t maxMessages,
+    bsl::size_t maxBytes,
+    const bsls::TimeInterval& maxLinger,
+    bdlmt::ThreadPool& threadPool,
+    rmqio::EventLoop& eventLoop)
+: d_sharedState(new SharedState(producer,
+                               bsl::max(maxMessages, bsl::size_t(1)),
+                               maxBytes,
+                               maxLinger,
+                               threadPool,
+                               eventLoop))
+{
+    d_sharedState->timer = eventLoop.timerFactory()->createWithCallback(
+        bdlf::BindUtil::bind(&onLingerTimer,
+                             bsl::weak_ptr<SharedState>(d_sharedState),
+                             bdlf::PlaceHolders::_1));
+}
+
+BatchingProducer::~BatchingProducer()
+{
+    {
+        d_sharedState->lock.wait();
+        HeldLock held(d_sharedState->lock);
+
+        const bsl::size_t count = d_sharedState->pending->messages.size();
+        if (sendPending(*d_sharedState, false, bsls::TimeInterval()) !=
+            rmqp::Producer::SENDING) {
+            BALL_LOG_WARN << "Dropping " << count
+                          << " batched message(s) which were never sent";
+        }
+    }
+
+    d_sharedState->eventLoop.post(
+        bdlf::BindUtil::bind(&rmqio::Timer::cancel, d_sharedState->timer));
+}
+
+rmqp::Producer::SendStatus BatchingProducer::send(
+    const rmqt::Message& message,
+    const bsl::string& routingKey,
+    const rmqp::Producer::ConfirmationCallback& confirmCallback,
+    const bsls::TimeInterval& timeout)
+{
+    return send(message,
+                routingKey,
+                rmqt::Mandatory::RETURN_UNROUTABLE,
+                confirmCallback,
+                timeout);
+}
+
+rmqp::Producer::SendStatus BatchingProducer::send(
+    const rmqt::Message& message,
+    const bsl::string& routingKey,
+    rmqt::Mandatory::Value mandatoryFlag,
+    const rmqp::Producer::ConfirmationCallback& confirmCallback,
+    const bsls::TimeInterval& timeout)
+{
+    if (batchable(message, mandatoryFlag)) {
+        return hold(message, routingKey, confirmCallback, timeout, true);
+    }
+
+    if (!acquire(d_sharedState->lock, timeout)) {
+        return rmqp::Producer::TIMEOUT;
+    }
+    HeldLock held(d_sharedState->lock);
+
+    const rmqp::Producer::SendStatus status =
+        sendPending(*d_sharedState, true, timeout);
+    if (status != rmqp::Producer::SENDING) {
+        return status;
+    }
+    return d_sharedState->producer->send(
+        message, routingKey, mandatoryFlag, confirmCallback, timeout);
+}
+
+rmqp::Producer::SendStatus BatchingProducer::trySend(
+    const rmqt::Message& message,
+    const bsl::string& routingKey,
+    const rmqp::Producer::ConfirmationCallback& confirmCallback)
+{
+    if (batchable(message, rmqt::Mandatory::RETURN_UNROUTABLE)) {
+        return hold(
+            message, routingKey, confirmCallback, bsls::TimeInterval(), false);
+    }
+
+    if (d_sharedState->lock.tryWait() != 0) {
+        return rmqp::Producer::INFLIGHT_LIMIT;
+    }
+    HeldLock held(d_sharedState->lock);
+
+    const rmqp::Producer::SendStatus status =
+        sendPending(*d_sharedState, false, bsls::TimeInterval());
+    if (status != rmqp::Producer::SENDING) {
+        return status;
+    }
+    return d_sharedState->producer->trySend(
+        message, routingKey, confirmCallback);
+}
+
+void BatchingProducer::setWritableCallback(
+    const rmqp::Producer::WritableCallback& callback,
+    bsl::size_t minimumCredits)
+{
+    d_sharedState->producer->setWritableCallback(callback, minimumCredits);
+}
+
+bsl::size_t BatchingProducer::availableCredits() const
+{
+    return d_sharedState->producer->availableCredits();
+}
+
+void BatchingProducer::setWriteWeight(unsigned weight)
+{
+    d_sharedState->producer->setWriteWeight(weight);
+}
+
+rmqp::Producer::SendStatus BatchingProducer::sendBatch(
+    const bsl::vector<rmqt::Message>& messages,
+    const bsl::string& routingKey,
+    const rmqp::Producer::ConfirmationCallback& confirmCallback,
+    const bsls::TimeInterval& timeout)
+{
+    if (!acquire(d_sharedState->lock, timeout)) {
+        return rmqp::Producer::TIMEOUT;
+    }
+    HeldLock held(d_sharedState->lock);
+
+    const rmqp::Producer::SendStatus status =
+        sendPending(*d_sharedState, true, timeout);
+    if (status != rmqp::Producer::SENDING) {
+        return status;
+    }
+    return d_sharedState->producer->sendBatch(
+        messages, routingKey, confirmCallback, timeout);
+}
+
+rmqt::Result<rmqp::MessageSink> BatchingProducer::openStream(
+    const rmqt::Message& message,
+    bsl::size_t bodySize,
+    const bsl::string& routingKey,
+    const rmqp::Producer::ConfirmationCallback& confirmCallback,
+    const bsls::TimeInterval& timeout)
+{
+    if (!acquire(d_sharedState->lock, timeout)) {
+        return rmqt::Result<rmqp::MessageSink>(
+            "Timed out sending batched messages", rmqp::Producer::TIMEOUT);
+    }
+    HeldLock held(d_sharedState->lock);
+
+    const rmqp::Producer::SendStatus status =
+        sendPending(*d_sharedState, true, timeout);
+    if (status != rmqp::Producer::SENDING) {
+        return rmqt::Result<rmqp::MessageSink>(
+            "Timed out sending batched messages", status);
+    }
+    return d_sharedState->producer->openStream(
+        message, bodySize, routingKey, confirmCallback, timeout);
+}
+
+rmqt::Future<> BatchingProducer::updateTopologyAsync(
+    const rmqt::TopologyUpdate& topologyUpdate)
+{
+    return d_sharedState->producer->updateTopologyAsync(topologyUpdate);
+}
+
+rmqt::Result<>
+BatchingProducer::waitForConfirms(const bsls::TimeInterval& timeout)
+{
+    {
+        if (!acquire(d_sharedState->lock, timeout)) {
+            return rmqt::Result<>("TIMED OUT", rmqt::TIMEOUT);
+        }
+        HeldLock held(d_sharedState->lock);
+
+        if (sendPending(*d_sharedState, true, timeout) !=
+            rmqp::Producer::SENDING) {
+            return rmqt::Result<>("TIMED OUT", rmqt::TIMEOUT);
+        }
+    }
+    return d_sharedState->producer->waitForConfirms(timeout);
+}
+
+rmqp::Producer::SendStatus BatchingProducer::hold(
+    const rmqt::Message& message,
+    const bsl::string& routingKey,
+    const rmqp::Producer::ConfirmationCallback& confirmCallback,
+    const bsls::TimeInterval& timeout,
+    bool wait)
+{
+    SharedState& state = *d_sharedState;
+    if (wait ? !acquire(state.lock, timeout) : state.lock.tryWait() != 0) {
+        return wait ? rmqp::Producer::TIMEOUT
+                    : rmqp::Producer::INFLIGHT_LIMIT;
+    }
+    HeldLock held(state.lock);
+
+    const Batch& pending = *state.pending;
+    if (!pending.messages.empty() &&
+        (pending.routingKey != routingKey ||
+         pending.messages.size() >= state.maxMessages ||
+         (state.maxBytes &&
+          pending.bytes + message.payloadSize() > state.maxBytes))) {
+        const rmqp::Producer::SendStatus status =
+            sendPending(state, wait, timeout);
+        if (status != rmqp::Producer::SENDING) {
+            return status;
+        }
+    }
+
+    Batch& batch = *state.pending;
+    if (batch.messages.empty()) {
+        batch.routingKey = routingKey;
+    }
+    batch.messages.push_back(message);
+    batch.confirmCallbacks.push_back(confirmCallback);
+    batch.bytes += message.payloadSize();
+
+    if (batch.messages.size() >= state.maxMessages ||
+        (state.maxBytes && batch.bytes >= state.maxBytes)) {
+        // Without room the next send, or the linger timer, sends it
+        sendPending(state, false, bsls::TimeInterval());
+    }
+
+    if (!state.pending->messages.empty()) {
+        armTimer(state);
+    }
+    return rmqp::Producer::SENDING;
+}
+
+} // namespace rmqa
+} // namespace BloombergLP
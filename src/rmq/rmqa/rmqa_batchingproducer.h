@@ -0,0 +1,205 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQA_BATCHINGPRODUCER
+#define INCLUDED_RMQA_BATCHINGPRODUCER
+
+#include <rmqio_timer.h>
+#include <rmqp_messagesink.h>
+#include <rmqp_producer.h>
+#include <rmqt_future.h>
+#include <rmqt_message.h>
+#include <rmqt_result.h>
+#include <rmqt_topologyupdate.h>
+
+#include <bdlmt_threadpool.h>
+#include <bslmt_timedsemaphore.h>
+#include <bsls_keyword.h>
+#include <bsls_timeinterval.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_memory.h>
+#include <bsl_string.h>
+#include <bsl_vector.h>
+
+//@PURPOSE: Pack small messages into batch containers before publishing them
+//
+//@CLASSES:
+//  rmqa::BatchingProducer: an rmqp::Producer publishing batch containers
+//  through another producer
+
+namespace BloombergLP {
+namespace rmqio {
+class EventLoop;
+}
+namespace rmqa {
+
+/// \brief An rmqp::Producer which sends many small messages as one
+///
+/// The broker's cost is mostly per message, not per byte. Messages sent to
+/// the same routing key are held until `maxMessages` of them, or
+/// `maxBytes` of payload, have been sent, or the oldest has waited for
+/// `maxLinger`, and are then published through the wrapped producer as a
+/// single batch container (see `MessageBatchUtil`). Consumers unpack
+/// containers and deliver the messages one by one.
+///
+/// Each message's confirm callback is invoked, with the message, once the
+/// container holding it is confirmed. A held message counts against the
+/// wrapped producer's unconfirmed message limit only once its container is
+/// sent. `send` blocks (up to its timeout) only when the container it
+/// completes cannot be sent yet. Messages sent with
+/// `DISCARD_UNROUTABLE`, or with a message id too long to pack, are
+/// published on their own, after whatever is held.
+///
+/// Messages still held when the producer is destroyed are sent if the
+/// wrapped producer has room, and dropped otherwise.
+
+class BatchingProducer : public rmqp::Producer {
+  public:
+    // CREATORS
+    /// Batch messages sent through `producer`. A `maxBytes` of 0 does not
+    /// limit the payload of a container.
+    BatchingProducer(const bsl::shared_ptr<rmqp::Producer>& producer,
+                     bsl::size_t maxMessages,
+                     bsl::size_t maxBytes,
+                     const bsls::TimeInterval& maxLinger,
+                     bdlmt::ThreadPool& threadPool,
+                     rmqio::EventLoop& eventLoop);
+
+    ~BatchingProducer() BSLS_KEYWORD_OVERRIDE;
+
+    SendStatus send(const rmqt::Message& message,
+                    const bsl::string& routingKey,
+                    const rmqp::Producer::ConfirmationCallback& confirmCallback,
+                    const bsls::TimeInterval& timeout) BSLS_KEYWORD_OVERRIDE;
+
+    SendStatus send(const rmqt::Message& message,
+                    const bsl::string& routingKey,
+                    rmqt::Mandatory::Value mandatoryFlag,
+                    const rmqp::Producer::ConfirmationCallback& confirmCallback,
+                    const bsls::TimeInterval& timeout) BSLS_KEYWORD_OVERRIDE;
+
+    /// Hold `message` without blocking. Returns INFLIGHT_LIMIT if another
+    /// thread is sending, or if the container `message` would join is full
+    /// and the wrapped producer has no room for it.
+    SendStatus
+    trySend(const rmqt::Message& message,
+            const bsl::string& routingKey,
+            const rmqp::Producer::ConfirmationCallback& confirmCallback)
+        BSLS_KEYWORD_OVERRIDE;
+
+    void setWritableCallback(const rmqp::Producer::WritableCallback& callback,
+                             bsl::size_t minimumCredits) BSLS_KEYWORD_OVERRIDE;
+
+    bsl::size_t availableCredits() const BSLS_KEYWORD_OVERRIDE;
+
+    void setWriteWeight(unsigned weight) BSLS_KEYWORD_OVERRIDE;
+
+    /// Send whatever is held, then `messages` as they are
+    SendStatus
+    sendBatch(const bsl::vector<rmqt::Message>& messages,
+              const bsl::string& routingKey,
+              const rmqp::Producer::ConfirmationCallback& confirmCallback,
+              const bsls::TimeInterval& timeout) BSLS_KEYWORD_OVERRIDE;
+
+    /// Send whatever is held, then open the stream
+    rmqt::Result<rmqp::MessageSink>
+    openStream(const rmqt::Message& message,
+               bsl::size_t bodySize,
+               const bsl::string& routingKey,
+               const rmqp::Producer::ConfirmationCallback& confirmCallback,
+               const bsls::TimeInterval& timeout) BSLS_KEYWORD_OVERRIDE;
+
+    rmqt::Future<> updateTopologyAsync(
+        const rmqt::TopologyUpdate& topologyUpdate) BSLS_KEYWORD_OVERRIDE;
+
+    /// Send whatever is held, then wait for every confirm
+    rmqt::Result<>
+    waitForConfirms(const bsls::TimeInterval& timeout = bsls::TimeInterval(0))
+        BSLS_KEYWORD_OVERRIDE;
+
+    /// Messages held for the next container
+    struct Batch {
+        Batch()
+        : messages()
+        , confirmCallbacks()
+        , routingKey()
+        , bytes(0)
+        {
+        }
+
+        bsl::vector<rmqt::Message> messages;
+        bsl::vector<rmqp::Producer::ConfirmationCallback> confirmCallbacks;
+        bsl::string routingKey;
+        bsl::size_t bytes;
+    };
+
+    /// State shared with the linger timer, which may outlive the producer
+    struct SharedState {
+        SharedState(const bsl::shared_ptr<rmqp::Producer>& _producer,
+                    bsl::size_t _maxMessages,
+                    bsl::size_t _maxBytes,
+                    const bsls::TimeInterval& _maxLinger,
+                    bdlmt::ThreadPool& _threadPool,
+                    rmqio::EventLoop& _eventLoop)
+        : producer(_producer)
+        , maxMessages(_maxMessages)
+        , maxBytes(_maxBytes)
+        , maxLinger(_maxLinger)
+        , threadPool(_threadPool)
+        , eventLoop(_eventLoop)
+        , timer()
+        , lock(1)
+        , pending(bsl::make_shared<Batch>())
+        , timerArmed(false)
+        {
+        }
+
+        const bsl::shared_ptr<rmqp::Producer> producer;
+        const bsl::size_t maxMessages;
+        const bsl::size_t maxBytes;
+        const bsls::TimeInterval maxLinger;
+        bdlmt::ThreadPool& threadPool;
+        rmqio::EventLoop& eventLoop;
+        bsl::shared_ptr<rmqio::Timer> timer;
+
+        // Held while sending through `producer`, so that containers keep
+        // the order of their messages. `pending` and `timerArmed` can only
+        // be accessed while it is held
+        bslmt::TimedSemaphore lock;
+        bsl::shared_ptr<Batch> pending;
+        bool timerArmed;
+    };
+
+  private:
+    BatchingProducer(const BatchingProducer&) BSLS_KEYWORD_DELETED;
+    BatchingProducer& operator=(const BatchingProducer&) BSLS_KEYWORD_DELETED;
+
+    /// Add `message` to the pending container, sending the container first
+    /// if `message` does not fit in it. Waits up to `timeout` for the
+    /// wrapped producer if `wait`, otherwise returns INFLIGHT_LIMIT.
+    SendStatus hold(const rmqt::Message& message,
+                    const bsl::string& routingKey,
+                    const rmqp::Producer::ConfirmationCallback& confirmCallback,
+                    const bsls::TimeInterval& timeout,
+                    bool wait);
+
+    bsl::shared_ptr<SharedState> d_sharedState;
+}; // class BatchingProducer
+
+} // namespace rmqa
+} // namespace BloombergLP
+
+#endif // ! INCLUDED_RMQA_BATCHINGPRODUCER
@@ -15,10 +15,17 @@
 
 #include <rmqa_connectionimpl.h>
 
+#include <rmqa_batchingproducer.h>
 #include <rmqa_consumer.h>
 #include <rmqa_consumerimpl.h>
+#include <rmqa_lazyproducer.h>
 #include <rmqa_producer.h>
 #include <rmqa_producerimpl.h>
+#include <rmqa_redeliveryfilter.h>
+#include <rmqa_rpcclientimpl.h>
+#include <rmqa_sharedreceivechannel.h>
+#include <rmqa_sharedsendchannel.h>
+#include <rmqa_unconfirmedproducer.h>
 
 #include <rmqamqp_channel.h>
 #include <rmqamqp_connection.h>
@@ -28,8 +35,9 @@
 #include <rmqio_backofflevelretrystrategy.h>
 #include <rmqio_timer.h>
 
-#include <rmqt_consumerackbatch.h>
+#include <rmqt_consumerackqueue.h>
 #include <rmqt_consumerconfig.h>
+#include <rmqt_log.h>
 #include <rmqt_properties.h>
 #include <rmqt_result.h>
 
@@ -70,25 +78,223 @@ createRetryHandler(const bsl::shared_ptr<rmqio::TimerFactory>& timerFactory,
         bsl::make_shared<rmqio::BackoffLevelRetryStrategy>());
 }
 
+void configureDispatch(
+    ConsumerImpl& consumer,
+    const rmqt::ConsumerConfig& consumerConfig,
+    bdlmt::ThreadPool& threadPool,
+    const ConsumerImpl::Factory& consumerFactory)
+{
+    const bsl::shared_ptr<WorkStealingExecutor>& workStealingExecutor =
+        consumerFactory.workStealingExecutor();
+
+    if (consumerConfig.noAck()) {
+        consumer.setNoAck();
+    }
+    if (consumerConfig.preFilter()) {
+        consumer.setPreFilter(consumerConfig.preFilter(),
+                              consumerConfig.rejectFiltered());
+    }
+    if (consumerConfig.redeliveryFilterCapacity() && !consumerConfig.noAck()) {
+        consumer.setRedeliveryFilter(bsl::make_shared<RedeliveryFilter>(
+            consumerConfig.redeliveryFilterCapacity(),
+            consumerConfig.redeliveryFilterWindow(),
+            consumerConfig.redeliveryKey()));
+    }
+    if (consumerConfig.staleMessagePolicy() !=
+        rmqt::StaleMessagePolicy::DELIVER) {
+        consumer.setStaleMessagePolicy(consumerConfig.staleMessagePolicy(),
+                                       consumerConfig.deadlineHeader());
+    }
+    if (consumerConfig.dispatch() == rmqt::ConsumerDispatch::EVENT_LOOP ||
+        (consumerConfig.dispatch() == rmqt::ConsumerDispatch::THREADPOOL &&
+         consumerFactory.inlineDispatchByDefault() &&
+         !consumerConfig.threadpool())) {
+        consumer.setInlineDispatch();
+        return;
+    }
+    if (consumerConfig.dispatch() == rmqt::ConsumerDispatch::PRIORITY) {
+        consumer.setPriorityDispatch();
+        return;
+    }
+    if (consumerConfig.dispatch() == rmqt::ConsumerDispatch::WORK_STEALING ||
+        (consumerConfig.dispatch() == rmqt::ConsumerDispatch::THREADPOOL &&
+         consumerFactory.workStealingByDefault())) {
+        // A consumer given its own threadpool runs its callbacks there
+        if (workStealingExecutor && !consumerConfig.threadpool()) {
+            consumer.setWorkStealingDispatch(workStealingExecutor);
+        }
+        else if (!workStealingExecutor) {
+            BALL_LOG_WARN << "No work-stealing executor configured, "
+                          << consumerConfig.consumerTag()
+                          << " dispatches to the threadpool";
+        }
+        return;
+    }
+    if (consumerConfig.dispatch() != rmqt::ConsumerDispatch::ORDERED &&
+        consumerConfig.dispatch() != rmqt::ConsumerDispatch::PARTITIONED) {
+        return;
+    }
+
+    // Room for two prefetch windows before callers spill into the overflow
+    const bsl::size_t wanted = bsl::max<bsl::size_t>(
+        64, 2 * static_cast<bsl::size_t>(consumerConfig.prefetchCount()));
+    bsl::size_t capacity = 1;
+    while (capacity < wanted) {
+        capacity <<= 1;
+    }
+
+    if (consumerConfig.dispatch() == rmqt::ConsumerDispatch::ORDERED) {
+        consumer.setOrderedDispatch(capacity);
+        return;
+    }
+
+    const bsl::size_t partitions =
+        consumerConfig.partitions()
+            ? consumerConfig.partitions()
+            : static_cast<bsl::size_t>(threadPool.maxThreads());
+    consumer.setPartitionedDispatch(
+        partitions, capacity, consumerConfig.partitionKey());
+}
+
+bsl::shared_ptr<ConsumerImpl> makeConsumer(
+    const rmqt::QueueHandle& queue,
+    const bsl::shared_ptr<rmqp::Consumer::ConsumerFunc>& onMessage,
+    const rmqt::ConsumerConfig& consumerConfig,
+    rmqio::EventLoop& eventLoop,
+    bdlmt::ThreadPool& threadPool,
+    const bsl::shared_ptr<rmqt::ConsumerAckQueue>& ackQueue,
+    const bsl::shared_ptr<rmqa::ConsumerImpl::Factory>& consumerFactory,
+    const bsl::shared_ptr<ReadBackpressure>& readBackpressure,
+    const bsl::shared_ptr<rmqamqp::ReceiveChannel>& receiveChannel)
+{
+    bsl::shared_ptr<ConsumerImpl> consumer(
+        consumerFactory->create(receiveChannel,
+                                queue,
+                                onMessage,
+                                consumerConfig.consumerTag(),
+                                bsl::ref(threadPool),
+                                bsl::ref(eventLoop),
+                                ackQueue));
+    configureDispatch(*consumer,
+                      consumerConfig,
+                      threadPool,
+                      *consumerFactory);
+    consumer->setMessageCodecs(consumerFactory->messageCodecs());
+    consumer->setDeliveryLatencyMetric(
+        consumerFactory->deliveryLatencyMetric());
+    consumer->setReadBackpressure(readBackpressure);
+    return consumer;
+}
+
+rmqt::Result<rmqp::Consumer>
+startConsumer(const bsl::shared_ptr<ConsumerImpl>& consumer)
+{
+    rmqt::Result<> result = consumer->start();
+    return result ? rmqt::Result<rmqp::Consumer>(consumer)
+                  : rmqt::Result<rmqp::Consumer>(result.error(),
+                                                 result.returnCode());
+}
+
 rmqt::Result<rmqp::Consumer> setupConsumer(
     const rmqt::QueueHandle& queue,
     const bsl::shared_ptr<rmqp::Consumer::ConsumerFunc>& onMessage,
-    const bsl::string& consumerTag,
+    const rmqt::ConsumerConfig& consumerConfig,
+    rmqio::EventLoop& eventLoop,
+    bdlmt::ThreadPool& threadPool,
+    const bsl::shared_ptr<rmqt::ConsumerAckQueue>& ackQueue,
+    const bsl::shared_ptr<rmqa::ConsumerImpl::Factory>& consumerFactory,
+    const bsl::shared_ptr<ReadBackpressure>& readBackpressure,
+    const rmqt::Topology& topology,
+    const bsl::shared_ptr<SharedReceiveChannel::Registry>& sharedChannels,
+    const rmqt::Result<rmqamqp::ReceiveChannel>& receiveChannel)
+{
+    if (!receiveChannel) {
+        return rmqt::Result<rmqp::Consumer>(receiveChannel.error(),
+                                            receiveChannel.returnCode());
+    }
+
+    bsl::shared_ptr<ConsumerImpl> consumer(
+        makeConsumer(queue,
+                     onMessage,
+                     consumerConfig,
+                     eventLoop,
+                     threadPool,
+                     ackQueue,
+                     consumerFactory,
+                     readBackpressure,
+                     receiveChannel.value()));
+
+    if (consumerFactory->channelSharing()) {
+        bsl::shared_ptr<SharedReceiveChannel> sharedChannel =
+            SharedReceiveChannel::make(receiveChannel.value(),
+                                       topology,
+                                       consumerConfig,
+                                       ackQueue,
+                                       eventLoop);
+        consumer->shareChannel(sharedChannel);
+        sharedChannels->add(sharedChannel);
+    }
+    return startConsumer(consumer);
+}
+
+/// Create a consumer consuming on the existing `sharedChannel`
+rmqt::Future<rmqp::Consumer> joinSharedReceiveChannel(
+    const rmqt::QueueHandle& queue,
+    const bsl::shared_ptr<rmqp::Consumer::ConsumerFunc>& onMessage,
+    const rmqt::ConsumerConfig& consumerConfig,
+    rmqio::EventLoop& eventLoop,
+    bdlmt::ThreadPool& threadPool,
+    const bsl::shared_ptr<rmqa::ConsumerImpl::Factory>& consumerFactory,
+    const bsl::shared_ptr<ReadBackpressure>& readBackpressure,
+    const bsl::shared_ptr<SharedReceiveChannel>& sharedChannel)
+{
+    bsl::shared_ptr<ConsumerImpl> consumer(
+        makeConsumer(queue,
+                     onMessage,
+                     consumerConfig,
+                     eventLoop,
+                     threadPool,
+                     sharedChannel->ackQueue(),
+                     consumerFactory,
+                     readBackpressure,
+                     sharedChannel->channel()));
+    consumer->shareChannel(sharedChannel);
+    return rmqt::Future<rmqp::Consumer>(startConsumer(consumer));
+}
+
+rmqt::Result<rmqp::Consumer> setupBatchConsumer(
+    const rmqt::QueueHandle& queue,
+    const bsl::shared_ptr<rmqp::Consumer::BatchConsumerFunc>& onBatch,
+    const rmqt::ConsumerConfig& consumerConfig,
     rmqio::EventLoop& eventLoop,
     bdlmt::ThreadPool& threadPool,
     const bsl::shared_ptr<rmqt::ConsumerAckQueue>& ackQueue,
     const bsl::shared_ptr<rmqa::ConsumerImpl::Factory>& consumerFactory,
+    const bsl::shared_ptr<ReadBackpressure>& readBackpressure,
     const rmqt::Result<rmqamqp::ReceiveChannel>& receiveChannel)
 {
     if (receiveChannel) {
-        bsl::shared_ptr<ConsumerImpl> consumer(
-            consumerFactory->create(receiveChannel.value(),
-                                    queue,
-                                    onMessage,
-                                    consumerTag,
-                                    bsl::ref(threadPool),
-                                    bsl::ref(eventLoop),
-                                    ackQueue));
+        bsl::shared_ptr<ConsumerImpl> consumer(consumerFactory->create(
+            receiveChannel.value(),
+            queue,
+            bsl::shared_ptr<rmqp::Consumer::ConsumerFunc>(),
+            consumerConfig.consumerTag(),
+            bsl::ref(threadPool),
+            bsl::ref(eventLoop),
+            ackQueue));
+        consumer->setBatchConsumer(onBatch,
+                                   consumerConfig.maxBatchSize()
+                                       ? consumerConfig.maxBatchSize()
+                                       : consumerConfig.prefetchCount(),
+                                   consumerConfig.maxBatchLinger());
+        configureDispatch(*consumer,
+                          consumerConfig,
+                          threadPool,
+                          *consumerFactory);
+        consumer->setMessageCodecs(consumerFactory->messageCodecs());
+        consumer->setDeliveryLatencyMetric(
+            consumerFactory->deliveryLatencyMetric());
+        consumer->setReadBackpressure(readBackpressure);
         rmqt::Result<> result = consumer->start();
         return result ? rmqt::Result<rmqp::Consumer>(consumer)
                       : rmqt::Result<rmqp::Consumer>(result.error(),
@@ -98,22 +304,150 @@ rmqt::Result<rmqp::Consumer> setupConsumer(
                                         receiveChannel.returnCode());
 }
 
+bsl::shared_ptr<ProducerImpl> makeProducer(
+    uint16_t maxOutstandingConfirms,
+    const rmqt::ExchangeHandle& exchange,
+    rmqio::EventLoop& eventLoop,
+    bdlmt::ThreadPool& threadPool,
+    const bsl::shared_ptr<rmqa::ProducerImpl::Factory>& producerFactory,
+    const bsl::shared_ptr<rmqamqp::SendChannel>& sendChannel)
+{
+    bsl::shared_ptr<ProducerImpl> producer(
+        producerFactory->create(maxOutstandingConfirms,
+                                exchange,
+                                sendChannel,
+                                bsl::ref(threadPool),
+                                bsl::ref(eventLoop)));
+    if (producerFactory->compressionCodec()) {
+        producer->setCompression(producerFactory->compressionCodec(),
+                                 producerFactory->compressionMinimumSize());
+    }
+    producer->setSendTimestamps(producerFactory->sendTimestamps());
+    const bsl::shared_ptr<PublishSpool> spool =
+        producerFactory->createPublishSpool();
+    if (spool) {
+        producer->setPublishSpool(spool);
+    }
+    if (producerFactory->memoryBudget()) {
+        producer->setMemoryBudget(producerFactory->memoryBudget());
+    }
+    const bsl::shared_ptr<rmqamqp::RateLimiter> rateLimiter =
+        producerFactory->createRateLimiter();
+    if (rateLimiter) {
+        producer->setRateLimiter(rateLimiter);
+    }
+    if (sendChannel->publishGate()) {
+        producer->setPublishGate(sendChannel->publishGate());
+    }
+    return producer;
+}
+
+/// Wrap `producer` in a `BatchingProducer` if `producerFactory` batches
+bsl::shared_ptr<rmqp::Producer> withBatching(
+    const bsl::shared_ptr<ProducerImpl>& producer,
+    const rmqa::ProducerImpl::Factory& producerFactory,
+    rmqio::EventLoop& eventLoop,
+    bdlmt::ThreadPool& threadPool)
+{
+    if (producerFactory.batchMaxMessages() <= 1) {
+        return producer;
+    }
+    return bsl::shared_ptr<rmqp::Producer>(
+        new BatchingProducer(producer,
+                             producerFactory.batchMaxMessages(),
+                             producerFactory.batchMaxBytes(),
+                             producerFactory.batchMaxLinger(),
+                             threadPool,
+                             eventLoop));
+}
+
 rmqt::Result<rmqp::Producer> setupProducer(
     uint16_t maxOutstandingConfirms,
     const rmqt::ExchangeHandle& exchange,
     rmqio::EventLoop& eventLoop,
     bdlmt::ThreadPool& threadPool,
     const bsl::shared_ptr<rmqa::ProducerImpl::Factory>& producerFactory,
+    const rmqt::Topology& topology,
+    const bsl::shared_ptr<SharedSendChannel::Registry>& sharedChannels,
     const rmqt::Result<rmqamqp::SendChannel>& sendChannel)
 {
-    return sendChannel ? rmqt::Result<rmqp::Producer>(
-                             producerFactory->create(maxOutstandingConfirms,
-                                                     exchange,
-                                                     sendChannel.value(),
-                                                     bsl::ref(threadPool),
-                                                     bsl::ref(eventLoop)))
-                       : rmqt::Result<rmqp::Producer>(sendChannel.error(),
-                                                      sendChannel.returnCode());
+    if (!sendChannel) {
+        return rmqt::Result<rmqp::Producer>(sendChannel.error(),
+                                            sendChannel.returnCode());
+    }
+
+    bsl::shared_ptr<ProducerImpl> producer(makeProducer(maxOutstandingConfirms,
+                                                        exchange,
+                                                        eventLoop,
+                                                        threadPool,
+                                                        producerFactory,
+                                                        sendChannel.value()));
+
+    bsl::shared_ptr<rmqt::Exchange> exchangePtr = exchange.lock();
+    if (producerFactory->channelSharing() && exchangePtr) {
+        bsl::shared_ptr<SharedSendChannel> sharedChannel =
+            SharedSendChannel::make(
+                sendChannel.value(), *exchangePtr, topology, eventLoop);
+        producer->shareChannel(sharedChannel);
+        sharedChannels->add(sharedChannel);
+    }
+    return rmqt::Result<rmqp::Producer>(
+        withBatching(producer, *producerFactory, eventLoop, threadPool));
+}
+
+rmqt::Result<rmqp::Producer> setupUnconfirmedProducer(
+    uint16_t maxUnwrittenMessages,
+    rmqio::EventLoop& eventLoop,
+    bdlmt::ThreadPool& threadPool,
+    const rmqt::Result<rmqamqp::SendChannel>& sendChannel)
+{
+    if (!sendChannel) {
+        return rmqt::Result<rmqp::Producer>(sendChannel.error(),
+                                            sendChannel.returnCode());
+    }
+    bsl::shared_ptr<rmqp::Producer> producer(new UnconfirmedProducer(
+        maxUnwrittenMessages, sendChannel.value(), threadPool, eventLoop));
+    return rmqt::Result<rmqp::Producer>(producer);
+}
+
+rmqt::Result<rmqp::RpcClient>
+setupRpcClient(const bsl::string& exchange,
+               rmqio::EventLoop& eventLoop,
+               const rmqt::Result<rmqamqp::ReceiveChannel>& receiveChannel)
+{
+    if (!receiveChannel) {
+        return rmqt::Result<rmqp::RpcClient>(receiveChannel.error(),
+                                             receiveChannel.returnCode());
+    }
+
+    bsl::shared_ptr<RpcClientImpl> client = bsl::make_shared<RpcClientImpl>(
+        receiveChannel.value(), exchange, bsl::ref(eventLoop));
+
+    rmqt::Result<> result = client->start();
+    return result ? rmqt::Result<rmqp::RpcClient>(client)
+                  : rmqt::Result<rmqp::RpcClient>(result.error(),
+                                                  result.returnCode());
+}
+
+/// Create a producer publishing on the existing `sharedChannel`
+rmqt::Future<rmqp::Producer> joinSharedChannel(
+    uint16_t maxOutstandingConfirms,
+    const rmqt::ExchangeHandle& exchange,
+    rmqio::EventLoop& eventLoop,
+    bdlmt::ThreadPool& threadPool,
+    const bsl::shared_ptr<rmqa::ProducerImpl::Factory>& producerFactory,
+    const bsl::shared_ptr<SharedSendChannel>& sharedChannel)
+{
+    bsl::shared_ptr<ProducerImpl> producer(
+        makeProducer(maxOutstandingConfirms,
+                     exchange,
+                     eventLoop,
+                     threadPool,
+                     producerFactory,
+                     sharedChannel->channel()));
+    producer->shareChannel(sharedChannel);
+    return rmqt::Future<rmqp::Producer>(rmqt::Result<rmqp::Producer>(
+        withBatching(producer, *producerFactory, eventLoop, threadPool)));
 }
 
 bool DoesExist(const bsl::shared_ptr<rmqt::Exchange>& element,
@@ -121,6 +455,81 @@ bool DoesExist(const bsl::shared_ptr<rmqt::Exchange>& element,
 {
     return *element == *exchange;
 }
+
+/// Return an error if a producer cannot publish to `exchange` with
+/// `topology`
+rmqt::Result<> checkProducerExchange(
+    const rmqt::Topology& topology,
+    const bsl::shared_ptr<rmqt::Exchange>& exchange)
+{
+    if (!exchange) {
+        BALL_LOG_ERROR << "Exchange passed to createProducer was destructed. "
+                          "Caused by topology update?";
+        return rmqt::Result<>("Exchange is not valid");
+    }
+
+    const rmqt::Topology::ExchangeVec::const_iterator it = bsl::find_if(
+        topology.exchanges.cbegin(),
+        topology.exchanges.cend(),
+        bdlf::BindUtil::bind(
+            &DoesExist, bdlf::PlaceHolders::_1, bsl::ref(exchange)));
+
+    if (it == topology.exchanges.cend()) {
+        BALL_LOG_ERROR << "Passed Exchange " << exchange->name()
+                       << " does not exist in the passed topology";
+        return rmqt::Result<>("Exchange does not exist in the topology");
+    }
+    return rmqt::Result<>();
+}
+
+/// Return the part of `topology` declared by a producer to `exchange`
+rmqt::Topology producerTopology(const rmqt::Topology& topology,
+                                const rmqt::Exchange& exchange)
+{
+    if (topology.declareMode == rmqt::Topology::DECLARE_ALL) {
+        return topology;
+    }
+
+    rmqt::Topology result;
+    result.declareMode = topology.declareMode;
+    if (topology.declareMode == rmqt::Topology::VERIFY_USED &&
+        !exchange.isDefault()) {
+        result.exchanges.push_back(
+            bsl::make_shared<rmqt::Exchange>(exchange.name(), true));
+    }
+    return result;
+}
+
+/// Return an error if `consumerConfig` asks for something the broker
+/// refuses
+rmqt::Result<> checkConsumerConfig(const rmqt::ConsumerConfig& consumerConfig)
+{
+    if (consumerConfig.streamOffset() && consumerConfig.noAck()) {
+        return rmqt::Result<>("Stream queues cannot be consumed without acks");
+    }
+    return rmqt::Result<>();
+}
+
+/// Return the part of `topology` declared by a consumer from `queue`
+rmqt::Topology consumerTopology(const rmqt::Topology& topology,
+                                const bsl::shared_ptr<rmqt::Queue>& queue)
+{
+    if (topology.declareMode == rmqt::Topology::DECLARE_ALL || !queue) {
+        return topology;
+    }
+
+    rmqt::Topology result;
+    result.declareMode = topology.declareMode;
+    if (topology.declareMode == rmqt::Topology::VERIFY_USED) {
+        // A server-named queue only exists once it is declared
+        result.queues.push_back(
+            queue->name().empty()
+                ? queue
+                : bsl::make_shared<rmqt::Queue>(queue->name(), true));
+    }
+    return result;
+}
+
 void noopTimerHandler(rmqio::Timer::InterruptReason) {}
 
 void cancelCloseTimer(const bsl::weak_ptr<rmqio::Timer>& weakTimer)
@@ -140,7 +549,7 @@ void gracefulCloseTimeout(const bsl::shared_ptr<rmqio::Timer>& timer,
                 // live longer than this callback
 
     if (reason == rmqio::Timer::CANCEL) {
-        BALL_LOG_TRACE << "Connection gracefully closed to broker: "
+        RMQT_LOG_TRACE << "Connection gracefully closed to broker: "
                        << conn->connectionDebugName();
     }
     else {
@@ -151,6 +560,32 @@ void gracefulCloseTimeout(const bsl::shared_ptr<rmqio::Timer>& timer,
     timer->resetCallback(&noopTimerHandler);
 }
 const static uint16_t GRACEFUL_CLOSE_TIMEOUT_SEC = 5;
+
+/// Consumer jobs are queued from the event loop thread, so reads are paused
+/// there directly
+void pauseReads(const bsl::weak_ptr<rmqamqp::Connection>& weakConn)
+{
+    bsl::shared_ptr<rmqamqp::Connection> conn = weakConn.lock();
+    if (conn) {
+        conn->pauseReads();
+    }
+}
+
+void resumeReadsOnLoop(const bsl::weak_ptr<rmqamqp::Connection>& weakConn)
+{
+    bsl::shared_ptr<rmqamqp::Connection> conn = weakConn.lock();
+    if (conn) {
+        conn->resumeReads();
+    }
+}
+
+/// Consumer jobs finish on threadpool threads. Posting keeps the resume
+/// behind the pause it undoes.
+void resumeReads(rmqio::EventLoop& eventLoop,
+                 const bsl::weak_ptr<rmqamqp::Connection>& weakConn)
+{
+    eventLoop.post(bdlf::BindUtil::bind(&resumeReadsOnLoop, weakConn));
+}
 } // namespace
 
 ConnectionImpl::ConnectionImpl(
@@ -172,7 +607,19 @@ ConnectionImpl::ConnectionImpl(
 , d_endpoint(endpoint)
 , d_consumerFactory(consumerFactory)
 , d_producerFactory(producerFactory)
+, d_sharedChannels(bsl::make_shared<SharedSendChannel::Registry>())
+, d_sharedReceiveChannels(
+      bsl::make_shared<SharedReceiveChannel::Registry>())
+, d_readBackpressure(consumerFactory ? consumerFactory->newReadBackpressure()
+                                     : bsl::shared_ptr<ReadBackpressure>())
 {
+    if (d_readBackpressure) {
+        const bsl::weak_ptr<rmqamqp::Connection> weakConn(d_connection);
+        d_readBackpressure->setCallbacks(
+            bdlf::BindUtil::bind(&pauseReads, weakConn),
+            bdlf::BindUtil::bind(
+                &resumeReads, bsl::ref(d_eventLoop), weakConn));
+    }
 }
 
 void ConnectionImpl::close() { doClose(); }
@@ -180,7 +627,7 @@ void ConnectionImpl::close() { doClose(); }
 void ConnectionImpl::doClose()
 {
     if (d_connection) {
-        BALL_LOG_TRACE << "Setting up graceful close timer for connection: "
+        RMQT_LOG_TRACE << "Setting up graceful close timer for connection: "
                        << d_connection->connectionDebugName();
 
         // Setup a timer object, and trigger this to execute in a few seconds
@@ -266,25 +713,46 @@ ConnectionImpl::createProducerAsync(const rmqt::Topology& topology,
             rmqt::Result<rmqp::Producer>("close() has been called"));
     }
 
-    if (!exchange) {
-        BALL_LOG_ERROR << "Exchange passed to createProducer was destructed. "
-                          "Caused by topology update?";
+    const rmqt::Result<> exchangeCheck =
+        checkProducerExchange(topology, exchange);
+    if (!exchangeCheck) {
         return rmqt::Future<rmqp::Producer>(
-            rmqt::Result<rmqp::Producer>("Exchange is not valid"));
+            rmqt::Result<rmqp::Producer>(exchangeCheck.error()));
     }
 
-    const rmqt::Topology::ExchangeVec::const_iterator it = bsl::find_if(
-        topology.exchanges.cbegin(),
-        topology.exchanges.cend(),
-        bdlf::BindUtil::bind(
-            &DoesExist, bdlf::PlaceHolders::_1, bsl::ref(exchange)));
-
-    if (it == topology.exchanges.cend()) {
-        BALL_LOG_ERROR << "Passed Exchange " << exchange->name()
-                       << " does not exist in the passed topology";
+    if (d_producerFactory->lazyOpen()) {
+        return makeLazyProducer(
+            topology, exchangeHandle, maxOutstandingConfirms, true);
+    }
+    return openProducerAsync(topology, exchangeHandle, maxOutstandingConfirms);
+}
 
+rmqt::Future<rmqp::Producer>
+ConnectionImpl::openProducerAsync(const rmqt::Topology& topology,
+                                  rmqt::ExchangeHandle exchangeHandle,
+                                  uint16_t maxOutstandingConfirms)
+{
+    bsl::shared_ptr<rmqt::Exchange> exchange = exchangeHandle.lock();
+    if (!d_connection || !exchange) {
         return rmqt::Future<rmqp::Producer>(rmqt::Result<rmqp::Producer>(
-            "Exchange does not exist in the topology"));
+            "Connection closed or exchange released before the producer "
+            "was opened"));
+    }
+
+    if (d_producerFactory->channelSharing()) {
+        bsl::shared_ptr<SharedSendChannel> sharedChannel =
+            d_sharedChannels->find(*exchange, topology);
+        if (sharedChannel) {
+            return rmqt::FutureUtil::flatten<rmqp::Producer>(
+                d_eventLoop.postF<rmqt::Future<rmqp::Producer> >(
+                    bdlf::BindUtil::bind(&joinSharedChannel,
+                                         maxOutstandingConfirms,
+                                         exchangeHandle,
+                                         bsl::ref(d_eventLoop),
+                                         bsl::ref(d_threadPool),
+                                         d_producerFactory,
+                                         sharedChannel)));
+        }
     }
 
     rmqt::Future<rmqamqp::SendChannel> sendChannelFuture(
@@ -293,12 +761,13 @@ ConnectionImpl::createProducerAsync(const rmqt::Topology& topology,
                 bdlf::BindUtil::bind(
                     &rmqamqp::Connection::createTopologySyncedSendChannel,
                     d_connection,
-                    topology,
+                    producerTopology(topology, *exchange),
                     exchange,
                     createRetryHandler(d_eventLoop.timerFactory(),
                                        bsl::ref(d_onError),
                                        bsl::ref(d_onSuccess),
-                                       d_tunables)))));
+                                       d_tunables),
+                    rmqt::PublisherConfirms::ON))));
 
     return sendChannelFuture.then<rmqp::Producer>(
         bdlf::BindUtil::bind(&setupProducer,
@@ -307,6 +776,148 @@ ConnectionImpl::createProducerAsync(const rmqt::Topology& topology,
                              bsl::ref(d_eventLoop),
                              bsl::ref(d_threadPool),
                              d_producerFactory,
+                             topology,
+                             d_sharedChannels,
+                             bdlf::PlaceHolders::_1));
+}
+
+rmqt::Future<rmqp::Producer> ConnectionImpl::createUnconfirmedProducerAsync(
+    const rmqt::Topology& topology,
+    rmqt::ExchangeHandle exchangeHandle,
+    uint16_t maxUnwrittenMessages)
+{
+    bsl::shared_ptr<rmqt::Exchange> exchange = exchangeHandle.lock();
+
+    if (!d_connection) {
+        BALL_LOG_ERROR << "close() has been called";
+        return rmqt::Future<rmqp::Producer>(
+            rmqt::Result<rmqp::Producer>("close() has been called"));
+    }
+
+    const rmqt::Result<> exchangeCheck =
+        checkProducerExchange(topology, exchange);
+    if (!exchangeCheck) {
+        return rmqt::Future<rmqp::Producer>(
+            rmqt::Result<rmqp::Producer>(exchangeCheck.error()));
+    }
+
+    if (d_producerFactory->lazyOpen()) {
+        return makeLazyProducer(
+            topology, exchangeHandle, maxUnwrittenMessages, false);
+    }
+    return openUnconfirmedProducerAsync(
+        topology, exchangeHandle, maxUnwrittenMessages);
+}
+
+rmqt::Future<rmqp::Producer> ConnectionImpl::openUnconfirmedProducerAsync(
+    const rmqt::Topology& topology,
+    rmqt::ExchangeHandle exchangeHandle,
+    uint16_t maxUnwrittenMessages)
+{
+    bsl::shared_ptr<rmqt::Exchange> exchange = exchangeHandle.lock();
+    if (!d_connection || !exchange) {
+        return rmqt::Future<rmqp::Producer>(rmqt::Result<rmqp::Producer>(
+            "Connection closed or exchange released before the producer "
+            "was opened"));
+    }
+
+    // Unconfirmed producers never share a channel: there are no confirms to
+    // route back, and sharing would put confirm.select on the channel
+    rmqt::Future<rmqamqp::SendChannel> sendChannelFuture(
+        rmqt::FutureUtil::flatten<rmqamqp::SendChannel>(
+            d_eventLoop.postF<rmqt::Future<rmqamqp::SendChannel> >(
+                bdlf::BindUtil::bind(
+                    &rmqamqp::Connection::createTopologySyncedSendChannel,
+                    d_connection,
+                    producerTopology(topology, *exchange),
+                    exchange,
+                    createRetryHandler(d_eventLoop.timerFactory(),
+                                       bsl::ref(d_onError),
+                                       bsl::ref(d_onSuccess),
+                                       d_tunables),
+                    rmqt::PublisherConfirms::OFF))));
+
+    return sendChannelFuture.then<rmqp::Producer>(
+        bdlf::BindUtil::bind(&setupUnconfirmedProducer,
+                             maxUnwrittenMessages,
+                             bsl::ref(d_eventLoop),
+                             bsl::ref(d_threadPool),
+                             bdlf::PlaceHolders::_1));
+}
+
+rmqt::Future<rmqp::Producer>
+ConnectionImpl::makeLazyProducer(const rmqt::Topology& topology,
+                                 rmqt::ExchangeHandle exchangeHandle,
+                                 uint16_t limit,
+                                 bool confirms)
+{
+    const LazyProducer::Opener opener =
+        bdlf::BindUtil::bind(&ConnectionImpl::openLazily,
+                             bsl::weak_ptr<ConnectionImpl>(shared_from_this()),
+                             topology,
+                             exchangeHandle,
+                             limit,
+                             confirms);
+    return rmqt::Future<rmqp::Producer>(
+        rmqt::Result<rmqp::Producer>(bsl::shared_ptr<rmqp::Producer>(
+            new LazyProducer(opener,
+                             limit,
+                             confirms,
+                             d_producerFactory->idleClose(),
+                             d_threadPool,
+                             d_eventLoop))));
+}
+
+rmqt::Future<rmqp::Producer>
+ConnectionImpl::openLazily(const bsl::weak_ptr<ConnectionImpl>& weakSelf,
+                           const rmqt::Topology& topology,
+                           rmqt::ExchangeHandle exchangeHandle,
+                           uint16_t limit,
+                           bool confirms)
+{
+    bsl::shared_ptr<ConnectionImpl> self = weakSelf.lock();
+    if (!self) {
+        return rmqt::Future<rmqp::Producer>(
+            rmqt::Result<rmqp::Producer>("Connection destroyed"));
+    }
+    return confirms ? self->openProducerAsync(topology, exchangeHandle, limit)
+                    : self->openUnconfirmedProducerAsync(
+                          topology, exchangeHandle, limit);
+}
+
+rmqt::Future<rmqp::RpcClient>
+ConnectionImpl::createRpcClientAsync(const rmqt::Topology& topology,
+                                     rmqt::ExchangeHandle exchangeHandle)
+{
+    bsl::shared_ptr<rmqt::Exchange> exchange = exchangeHandle.lock();
+
+    if (!d_connection) {
+        BALL_LOG_ERROR << "close() has been called";
+        return rmqt::Future<rmqp::RpcClient>(
+            rmqt::Result<rmqp::RpcClient>("close() has been called"));
+    }
+
+    const rmqt::Result<> exchangeCheck =
+        checkProducerExchange(topology, exchange);
+    if (!exchangeCheck) {
+        return rmqt::Future<rmqp::RpcClient>(
+            rmqt::Result<rmqp::RpcClient>(exchangeCheck.error()));
+    }
+
+    // Direct reply-to needs the requests published on the channel consuming
+    // the replies, and the replies consumed without acks
+    rmqt::ConsumerConfig replyConfig;
+    replyConfig.setNoAck();
+
+    rmqt::Future<rmqamqp::ReceiveChannel> receiveChannelFuture =
+        createReceiveChannel(producerTopology(topology, *exchange),
+                             replyConfig,
+                             bsl::make_shared<rmqt::ConsumerAckQueue>());
+
+    return receiveChannelFuture.then<rmqp::RpcClient>(
+        bdlf::BindUtil::bind(&setupRpcClient,
+                             exchange->name(),
+                             bsl::ref(d_eventLoop),
                              bdlf::PlaceHolders::_1));
 }
 
@@ -324,39 +935,123 @@ rmqt::Future<rmqp::Consumer> ConnectionImpl::createConsumerAsync(
             rmqt::Result<rmqp::Consumer>("close() has been called"));
     }
 
+    const rmqt::Result<> configCheck = checkConsumerConfig(consumerConfig);
+    if (!configCheck) {
+        return rmqt::Future<rmqp::Consumer>(
+            rmqt::Result<rmqp::Consumer>(configCheck.error()));
+    }
+
     bsl::shared_ptr<rmqp::Consumer::ConsumerFunc> consumerFn =
         bsl::make_shared<rmqp::Consumer::ConsumerFunc>(onMessage);
 
+    bdlmt::ThreadPool& threadPool = consumerConfig.threadpool()
+                                        ? *consumerConfig.threadpool()
+                                        : d_threadPool;
+
+    if (d_consumerFactory->channelSharing()) {
+        bsl::shared_ptr<SharedReceiveChannel> sharedChannel =
+            d_sharedReceiveChannels->find(topology, consumerConfig);
+        if (sharedChannel) {
+            return rmqt::FutureUtil::flatten<rmqp::Consumer>(
+                d_eventLoop.postF<rmqt::Future<rmqp::Consumer> >(
+                    bdlf::BindUtil::bind(&joinSharedReceiveChannel,
+                                         queue,
+                                         consumerFn,
+                                         consumerConfig,
+                                         bsl::ref(d_eventLoop),
+                                         bsl::ref(threadPool),
+                                         d_consumerFactory,
+                                         d_readBackpressure,
+                                         sharedChannel)));
+        }
+    }
+
     bsl::shared_ptr<rmqt::ConsumerAckQueue> ackQueue =
         bsl::make_shared<rmqt::ConsumerAckQueue>();
 
-    rmqt::Future<rmqamqp::ReceiveChannel> receiveChannelFuture(
-        rmqt::FutureUtil::flatten<rmqamqp::ReceiveChannel>(
-            d_eventLoop.postF<rmqt::Future<rmqamqp::ReceiveChannel> >(
-                bdlf::BindUtil::bind(
-                    &rmqamqp::Connection::createTopologySyncedReceiveChannel,
-                    d_connection,
-                    topology,
-                    consumerConfig,
-                    createRetryHandler(d_eventLoop.timerFactory(),
-                                       bsl::ref(d_onError),
-                                       bsl::ref(d_onSuccess),
-                                       d_tunables),
-                    ackQueue))));
+    rmqt::Future<rmqamqp::ReceiveChannel> receiveChannelFuture =
+        createReceiveChannel(consumerTopology(topology, queue.lock()),
+                             consumerConfig,
+                             ackQueue);
+
+    return receiveChannelFuture.then<rmqp::Consumer>(
+        bdlf::BindUtil::bind(&setupConsumer,
+                             queue,
+                             consumerFn,
+                             consumerConfig,
+                             bsl::ref(d_eventLoop),
+                             bsl::ref(threadPool),
+                             ackQueue,
+                             d_consumerFactory,
+                             d_readBackpressure,
+                             topology,
+                             d_sharedReceiveChannels,
+                             bdlf::PlaceHolders::_1));
+}
+
+rmqt::Future<rmqp::Consumer> ConnectionImpl::createBatchConsumerAsync(
+    const rmqt::Topology& topology,
+    rmqt::QueueHandle queue,
+    const rmqp::Consumer::BatchConsumerFunc& onBatch,
+    const rmqt::ConsumerConfig& consumerConfig)
+{
+    if (!d_connection) {
+        BALL_LOG_ERROR << "close() has been called";
+
+        return rmqt::Future<rmqp::Consumer>(
+            rmqt::Result<rmqp::Consumer>("close() has been called"));
+    }
+
+    const rmqt::Result<> configCheck = checkConsumerConfig(consumerConfig);
+    if (!configCheck) {
+        return rmqt::Future<rmqp::Consumer>(
+            rmqt::Result<rmqp::Consumer>(configCheck.error()));
+    }
+
+    bsl::shared_ptr<rmqp::Consumer::BatchConsumerFunc> batchFn =
+        bsl::make_shared<rmqp::Consumer::BatchConsumerFunc>(onBatch);
+
+    bsl::shared_ptr<rmqt::ConsumerAckQueue> ackQueue =
+        bsl::make_shared<rmqt::ConsumerAckQueue>();
+
+    rmqt::Future<rmqamqp::ReceiveChannel> receiveChannelFuture =
+        createReceiveChannel(consumerTopology(topology, queue.lock()),
+                             consumerConfig,
+                             ackQueue);
 
     return receiveChannelFuture.then<rmqp::Consumer>(bdlf::BindUtil::bind(
-        &setupConsumer,
+        &setupBatchConsumer,
         queue,
-        consumerFn,
-        consumerConfig.consumerTag(),
+        batchFn,
+        consumerConfig,
         bsl::ref(d_eventLoop),
         consumerConfig.threadpool() ? bsl::ref(*consumerConfig.threadpool())
                                     : bsl::ref(d_threadPool),
         ackQueue,
         d_consumerFactory,
+        d_readBackpressure,
         bdlf::PlaceHolders::_1));
 }
 
+rmqt::Future<rmqamqp::ReceiveChannel> ConnectionImpl::createReceiveChannel(
+    const rmqt::Topology& topology,
+    const rmqt::ConsumerConfig& consumerConfig,
+    const bsl::shared_ptr<rmqt::ConsumerAckQueue>& ackQueue)
+{
+    return rmqt::FutureUtil::flatten<rmqamqp::ReceiveChannel>(
+        d_eventLoop.postF<rmqt::Future<rmqamqp::ReceiveChannel> >(
+            bdlf::BindUtil::bind(
+                &rmqamqp::Connection::createTopologySyncedReceiveChannel,
+                d_connection,
+                topology,
+                consumerConfig,
+                createRetryHandler(d_eventLoop.timerFactory(),
+                                   bsl::ref(d_onError),
+                                   bsl::ref(d_onSuccess),
+                                   d_tunables),
+                ackQueue)));
+}
+
 ConnectionImpl::~ConnectionImpl() { doClose(); }
 
 } // namespace rmqa
@@ -20,6 +20,8 @@
 #include <rmqa_consumer.h>
 #include <rmqa_consumerimpl.h>
 #include <rmqa_producerimpl.h>
+#include <rmqa_sharedreceivechannel.h>
+#include <rmqa_sharedsendchannel.h>
 
 #include <rmqamqp_connection.h>
 
@@ -84,12 +86,27 @@ class ConnectionImpl : public rmqp::Connection,
                         rmqt::ExchangeHandle exchange,
                         uint16_t maxOutstandingConfirms) BSLS_KEYWORD_OVERRIDE;
 
+    rmqt::Future<rmqp::Producer> createUnconfirmedProducerAsync(
+        const rmqt::Topology& topology,
+        rmqt::ExchangeHandle exchange,
+        uint16_t maxUnwrittenMessages) BSLS_KEYWORD_OVERRIDE;
+
+    rmqt::Future<rmqp::RpcClient>
+    createRpcClientAsync(const rmqt::Topology& topology,
+                         rmqt::ExchangeHandle exchange) BSLS_KEYWORD_OVERRIDE;
+
     rmqt::Future<rmqp::Consumer> createConsumerAsync(
         const rmqt::Topology& topology,
         rmqt::QueueHandle queue,
         const rmqp::Consumer::ConsumerFunc& onMessage,
         const rmqt::ConsumerConfig& consumerConfig) BSLS_KEYWORD_OVERRIDE;
 
+    rmqt::Future<rmqp::Consumer> createBatchConsumerAsync(
+        const rmqt::Topology& topology,
+        rmqt::QueueHandle queue,
+        const rmqp::Consumer::BatchConsumerFunc& onBatch,
+        const rmqt::ConsumerConfig& consumerConfig) BSLS_KEYWORD_OVERRIDE;
+
     ~ConnectionImpl() BSLS_KEYWORD_OVERRIDE;
 
   private:
@@ -109,6 +126,41 @@ class ConnectionImpl : public rmqp::Connection,
 
     void closeImpl();
 
+    /// Open a producer's channel now, for `createProducerAsync`
+    rmqt::Future<rmqp::Producer>
+    openProducerAsync(const rmqt::Topology& topology,
+                      rmqt::ExchangeHandle exchangeHandle,
+                      uint16_t maxOutstandingConfirms);
+
+    /// Open an unconfirmed producer's channel now, for
+    /// `createUnconfirmedProducerAsync`
+    rmqt::Future<rmqp::Producer>
+    openUnconfirmedProducerAsync(const rmqt::Topology& topology,
+                                 rmqt::ExchangeHandle exchangeHandle,
+                                 uint16_t maxUnwrittenMessages);
+
+    /// Return a `LazyProducer` opening producers with `limit` unconfirmed
+    /// (or, unless `confirms`, unwritten) messages on demand
+    rmqt::Future<rmqp::Producer>
+    makeLazyProducer(const rmqt::Topology& topology,
+                     rmqt::ExchangeHandle exchangeHandle,
+                     uint16_t limit,
+                     bool confirms);
+
+    /// Open the producer a `LazyProducer` wraps, unless the connection has
+    /// gone
+    static rmqt::Future<rmqp::Producer>
+    openLazily(const bsl::weak_ptr<ConnectionImpl>& weakSelf,
+               const rmqt::Topology& topology,
+               rmqt::ExchangeHandle exchangeHandle,
+               uint16_t limit,
+               bool confirms);
+
+    rmqt::Future<rmqamqp::ReceiveChannel> createReceiveChannel(
+        const rmqt::Topology& topology,
+        const rmqt::ConsumerConfig& consumerConfig,
+        const bsl::shared_ptr<rmqt::ConsumerAckQueue>& ackQueue);
+
     rmqt::Tunables d_tunables;
     bsl::shared_ptr<rmqamqp::Connection> d_connection;
     bdlmt::ThreadPool& d_threadPool;
@@ -119,6 +171,10 @@ class ConnectionImpl : public rmqp::Connection,
     ///< Held for logging
     bsl::shared_ptr<rmqa::ConsumerImpl::Factory> d_consumerFactory;
     bsl::shared_ptr<rmqa::ProducerImpl::Factory> d_producerFactory;
+    bsl::shared_ptr<SharedSendChannel::Registry> d_sharedChannels;
+    bsl::shared_ptr<SharedReceiveChannel::Registry> d_sharedReceiveChannels;
+    ///< Shared by this connection's consumers, null unless configured
+    bsl::shared_ptr<ReadBackpressure> d_readBackpressure;
 };
 
 } // namespace rmqa
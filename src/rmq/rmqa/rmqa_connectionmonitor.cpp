@@ -17,13 +17,20 @@
 
 #include <rmqamqp_channelcontainer.h>
 #include <rmqamqp_channelmap.h>
+#include <rmqamqp_metrics.h>
+#include <rmqamqp_receivechannel.h>
+#include <rmqio_coarseclock.h>
+
+#include <rmqt_log.h>
 
 #include <ball_log.h>
+#include <bdlf_bind.h>
 
 #include <bsl_algorithm.h>
 #include <bsl_list.h>
 #include <bsl_map.h>
 #include <bsl_memory.h>
+#include <bsl_string.h>
 #include <bsl_utility.h>
 #include <bsl_vector.h>
 
@@ -37,7 +44,7 @@ void reportHungMessage(
     const rmqamqp::MessageStore<rmqt::Message>::Entry& message)
 {
     const bdlt::DatetimeInterval age =
-        bdlt::CurrentTime::utc() - message.second.second;
+        rmqio::CoarseClock::utc() - message.second.second;
 
     BALL_LOG_WARN << "Hung message detected. Consumer message processing time "
                      "exceeds timeout specified in "
@@ -57,6 +64,12 @@ ConnectionMonitor::ConnectionMonitor(
     const bsls::TimeInterval& messageProcessingTimeout,
     const HungMessageCallback& callback /* = HungMessageCallback() */)
 : d_messageProcessingTimeout(messageProcessingTimeout)
+, d_callback()
+, d_ackDeadline()
+, d_ackDeadlineCallback()
+, d_connections()
+, d_metricPublisher()
+, d_channelMetrics(false)
 {
     if (callback) {
         d_callback = callback;
@@ -72,19 +85,53 @@ void ConnectionMonitor::addConnection(
     d_connections.push_back(connection);
 }
 
-void ConnectionMonitor::processHungMessages(
-    const rmqamqp::MessageStore<rmqt::Message>::MessageList& hungMessages)
+void ConnectionMonitor::onHungMessage(
+    uint64_t deliveryTag,
+    const bsl::pair<rmqt::Message, bdlt::Datetime>& message) const
+{
+    d_callback(
+        rmqamqp::MessageStore<rmqt::Message>::Entry(deliveryTag, message));
+}
+
+void ConnectionMonitor::setAckDeadline(
+    const bsls::TimeInterval& deadline,
+    const AckDeadlineCallback& callback /* = AckDeadlineCallback() */)
 {
-    bsl::for_each(hungMessages.begin(), hungMessages.end(), d_callback);
+    d_ackDeadline         = deadline;
+    d_ackDeadlineCallback = callback;
+}
+
+bool ConnectionMonitor::shouldRequeue(
+    const rmqamqp::MessageStore<rmqt::Message>::Entry& message) const
+{
+    const bdlt::DatetimeInterval age =
+        rmqio::CoarseClock::utc() - message.second.second;
+    return d_ackDeadlineCallback(
+        message.second.first,
+        bsls::TimeInterval(age.totalSecondsAsDouble()));
 }
 
 void ConnectionMonitor::run()
 {
-    bdlt::Datetime cutoffTime =
-        bdlt::CurrentTime::utc() - d_messageProcessingTimeout;
-    BALL_LOG_DEBUG << "Cleaning up expired connections";
+    const bdlt::Datetime now = rmqio::CoarseClock::utc();
+    bdlt::Datetime cutoffTime = now - d_messageProcessingTimeout;
+    rmqamqp::ReceiveChannel::ExpiryFilter expiryFilter;
+    if (d_ackDeadlineCallback) {
+        expiryFilter = bdlf::BindUtil::bind(
+            &ConnectionMonitor::shouldRequeue, this, bdlf::PlaceHolders::_1);
+    }
+    const rmqamqp::MessageStore<rmqt::Message>::MessageVisitor visitor =
+        bdlf::BindUtil::bind(&ConnectionMonitor::onHungMessage,
+                             this,
+                             bdlf::PlaceHolders::_1,
+                             bdlf::PlaceHolders::_2);
+    RMQT_LOG_DEBUG << "Cleaning up expired connections";
     // Remove expired connections
     d_connections.remove_if(&connectionDestructed);
+
+    // Hung messages of each vhost, for the `hung_messages` gauge
+    bsl::map<bsl::string, bsl::size_t> hungPerVHost;
+
     for (bsl::list<bsl::weak_ptr<rmqamqp::ChannelContainer> >::iterator conn =
              d_connections.begin();
          conn != d_connections.end();
@@ -97,18 +144,46 @@ void ConnectionMonitor::run()
                      receiveChannelMap.cbegin();
                  it != receiveChannelMap.cend();
                  ++it) {
-                BALL_LOG_DEBUG
-                    << "Checking for hung messages older than "
-                    << d_messageProcessingTimeout.totalSecondsAsDouble()
-                    << " seconds, for receive channel: " << it->first;
-                processHungMessages(
-                    it->second->getMessagesOlderThan(cutoffTime));
+                if (d_ackDeadline) {
+                    it->second->requeueMessagesOlderThan(
+                        now - d_ackDeadline.value(), expiryFilter);
+                }
+                const bsl::size_t hung =
+                    it->second->visitNewlyHungMessages(cutoffTime, visitor);
+                if (d_metricPublisher) {
+                    hungPerVHost[it->second->vhostName()] += hung;
+                }
+                if (d_channelMetrics) {
+                    it->second->publishChannelMetrics();
+                }
+            }
+
+            if (d_channelMetrics) {
+                const rmqamqp::ChannelMap::SendChannelMap& sendChannelMap =
+                    connection->channelMap().getSendChannels();
+                for (rmqamqp::ChannelMap::SendChannelMap::const_iterator it =
+                         sendChannelMap.cbegin();
+                     it != sendChannelMap.cend();
+                     ++it) {
+                    it->second->publishChannelMetrics();
+                }
             }
         }
         else {
             BALL_LOG_ERROR << "Unexpected destructed connection";
         }
     }
+
+    for (bsl::map<bsl::string, bsl::size_t>::const_iterator it =
+             hungPerVHost.begin();
+         it != hungPerVHost.end();
+         ++it) {
+        bsl::vector<bsl::pair<bsl::string, bsl::string> > tags;
+        tags.push_back(bsl::make_pair(
+            bsl::string(rmqamqp::Metrics::VHOST_TAG), it->first));
+        d_metricPublisher->publishGauge(
+            "hung_messages", static_cast<double>(it->second), tags);
+    }
 }
 
 bsl::shared_ptr<ConnectionMonitor::AliveConnectionInfo>
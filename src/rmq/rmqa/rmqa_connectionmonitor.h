@@ -21,14 +21,17 @@
 #include <rmqamqp_connectionmonitor.h>
 #include <rmqamqp_messagestore.h>
 #include <rmqio_task.h>
+#include <rmqp_metricpublisher.h>
 #include <rmqt_future.h>
 #include <rmqt_message.h>
 
 #include <bsl_functional.h>
+#include <bdlt_datetime.h>
 #include <bsls_timeinterval.h>
 
 #include <bsl_list.h>
 #include <bsl_memory.h>
+#include <bsl_optional.h>
 #include <bsl_utility.h>
 #include <bsl_vector.h>
 
@@ -42,6 +45,12 @@ class ConnectionMonitor : public rmqamqp::ConnectionMonitor,
         const rmqamqp::MessageStore<rmqt::Message>::Entry&)>
         HungMessageCallback;
 
+    /// Called with each delivery past the ack deadline and its age. Return
+    /// true to requeue it, false to leave it with the consumer.
+    typedef bsl::function<bool(const rmqt::Message& message,
+                               const bsls::TimeInterval& age)>
+        AckDeadlineCallback;
+
     explicit ConnectionMonitor(
         const bsls::TimeInterval& messageProcessingTimeout,
         const HungMessageCallback& callback = HungMessageCallback());
@@ -50,6 +59,28 @@ class ConnectionMonitor : public rmqamqp::ConnectionMonitor,
     addConnection(const bsl::weak_ptr<rmqamqp::ChannelContainer>& connection)
         BSLS_KEYWORD_OVERRIDE;
 
+    /// Publish the number of hung messages of each vhost as the
+    /// `hung_messages` gauge each time the monitor runs
+    void
+    setMetricPublisher(const bsl::shared_ptr<rmqp::MetricPublisher>& metrics)
+    {
+        d_metricPublisher = metrics;
+    }
+
+    /// Have every channel publish its gauges each time the monitor runs,
+    /// see `rmqamqp::Channel::publishChannelMetrics`
+    void setChannelMetrics(bool enabled) { d_channelMetrics = enabled; }
+
+    /// Requeue, each time the monitor runs, the deliveries left unacked for
+    /// longer than `deadline`, or those `callback` returns true for, see
+    /// `rmqamqp::ReceiveChannel::requeueMessagesOlderThan`
+    void setAckDeadline(
+        const bsls::TimeInterval& deadline,
+        const AckDeadlineCallback& callback = AckDeadlineCallback());
+
+    /// Report the messages which have become hung since the last run. Each
+    /// receive channel resumes from where its last check stopped, so a run
+    /// visits only newly hung messages, whatever the number in flight.
     void run() BSLS_KEYWORD_OVERRIDE;
 
     struct AliveConnectionInfo {
@@ -64,11 +95,18 @@ class ConnectionMonitor : public rmqamqp::ConnectionMonitor,
     bsl::shared_ptr<AliveConnectionInfo> fetchAliveConnectionInfo();
 
   private:
-    void processHungMessages(
-        const rmqamqp::MessageStore<rmqt::Message>::MessageList& hungMessages);
+    void onHungMessage(
+        uint64_t deliveryTag,
+        const bsl::pair<rmqt::Message, bdlt::Datetime>& message) const;
+    bool shouldRequeue(
+        const rmqamqp::MessageStore<rmqt::Message>::Entry& message) const;
     bsls::TimeInterval d_messageProcessingTimeout;
     HungMessageCallback d_callback;
+    bsl::optional<bsls::TimeInterval> d_ackDeadline;
+    AckDeadlineCallback d_ackDeadlineCallback;
     bsl::list<bsl::weak_ptr<rmqamqp::ChannelContainer> > d_connections;
+    bsl::shared_ptr<rmqp::MetricPublisher> d_metricPublisher;
+    bool d_channelMetrics;
 };
 
 } // namespace rmqa
@@ -28,6 +28,60 @@
 
 namespace BloombergLP {
 namespace rmqa {
+namespace {
+
+/// Parse `port` into `result`, returning false if it is not a valid port
+bool parsePort(uint16_t* result, bsl::string_view port)
+{
+    try {
+        int portNum = bsl::stoi(bsl::string(port));
+
+        if (portNum <= 0 || portNum > bsl::numeric_limits<uint16_t>::max()) {
+            return false;
+        }
+
+        *result = static_cast<uint16_t>(portNum);
+    }
+    catch (const bsl::invalid_argument&) {
+        return false;
+    }
+    catch (const bsl::out_of_range&) {
+        return false;
+    }
+    return true;
+}
+
+/// Parse the comma separated `host[:port]` entries of `spec` into `hosts`,
+/// using `defaultPort` for those without one
+bool parseHosts(rmqt::Endpoint::HostList* hosts,
+                bsl::string_view spec,
+                bsl::string_view defaultPort)
+{
+    bsl::size_t begin = 0;
+    while (begin <= spec.size()) {
+        bsl::size_t end = spec.find(',', begin);
+        if (end == bsl::string_view::npos) {
+            end = spec.size();
+        }
+        const bsl::string_view entry = spec.substr(begin, end - begin);
+        const bsl::size_t colon      = entry.rfind(':');
+        const bsl::string_view host  = entry.substr(0, colon);
+        const bsl::string_view port  = colon == bsl::string_view::npos
+                                           ? defaultPort
+                                           : entry.substr(colon + 1);
+
+        uint16_t portNum16 = 0;
+        if (host.empty() || !parsePort(&portNum16, port)) {
+            return false;
+        }
+        hosts->push_back(rmqt::Endpoint::Host(bsl::string(host), portNum16));
+
+        begin = end + 1;
+    }
+    return true;
+}
+
+} // namespace
 
 bsl::optional<rmqt::VHostInfo> ConnectionString::parse(bsl::string_view uri)
 {
@@ -47,30 +101,33 @@ bsl::optional<rmqt::VHostInfo> ConnectionString::parse(bsl::string_view uri)
         return bsl::optional<rmqt::VHostInfo>();
     }
 
-    if (port == "") {
-        port = scheme == "amqp" ? "5672" : "5671";
-    }
+    const bsl::string_view defaultPort = scheme == "amqp" ? "5672" : "5671";
 
-    uint16_t portNum16 = 0;
-    try {
-        int portNum = bsl::stoi(bsl::string(port));
+    // parseParts splits "host1:port1,host2:port2" at the last ':', so
+    // rejoin the pieces to find every host
+    const bsl::string_view hostSpec(
+        hostname.data(),
+        port.empty() ? hostname.size()
+                     : static_cast<bsl::size_t>(port.data() + port.size() -
+                                                hostname.data()));
 
-        if (portNum <= 0 || portNum > bsl::numeric_limits<uint16_t>::max()) {
+    bsl::shared_ptr<rmqt::Endpoint> endpoint;
+    if (hostSpec.find(',') != bsl::string_view::npos) {
+        rmqt::Endpoint::HostList hosts;
+        if (!parseHosts(&hosts, hostSpec, defaultPort)) {
             return bsl::optional<rmqt::VHostInfo>();
         }
-
-        portNum16 = static_cast<uint16_t>(portNum);
+        endpoint = bsl::make_shared<rmqt::SimpleEndpoint>(hosts, vhost);
     }
-    catch (const bsl::invalid_argument&) {
-        return bsl::optional<rmqt::VHostInfo>();
-    }
-    catch (const bsl::out_of_range&) {
-        return bsl::optional<rmqt::VHostInfo>();
+    else {
+        uint16_t portNum16 = 0;
+        if (!parsePort(&portNum16, port.empty() ? defaultPort : port)) {
+            return bsl::optional<rmqt::VHostInfo>();
+        }
+        endpoint =
+            bsl::make_shared<rmqt::SimpleEndpoint>(hostname, vhost, portNum16);
     }
 
-    bsl::shared_ptr<rmqt::Endpoint> endpoint =
-        bsl::make_shared<rmqt::SimpleEndpoint>(hostname, vhost, portNum16);
-
     bsl::shared_ptr<rmqt::Credentials> credentials =
         bsl::make_shared<rmqt::PlainCredentials>(username, password);
 
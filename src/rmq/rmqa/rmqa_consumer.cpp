@@ -61,6 +61,26 @@ Consumer::updateTopology(const rmqa::TopologyUpdate& topologyUpdate,
     return result;
 }
 
+rmqt::Result<> Consumer::nackAllOutstanding(bool requeue,
+                                            const bsls::TimeInterval& timeout)
+{
+    rmqt::Future<> future = d_impl->nackAllOutstanding(requeue);
+    if (timeout.totalNanoseconds() == 0) {
+        return future.blockResult();
+    }
+    return future.waitResult(timeout);
+}
+
+rmqt::Result<> Consumer::ackThrough(const rmqt::Envelope& envelope,
+                                    const bsls::TimeInterval& timeout)
+{
+    rmqt::Future<> future = d_impl->ackThrough(envelope);
+    if (timeout.totalNanoseconds() == 0) {
+        return future.blockResult();
+    }
+    return future.waitResult(timeout);
+}
+
 Consumer::~Consumer() {}
 } // namespace rmqa
 } // namespace BloombergLP
@@ -22,6 +22,7 @@
 
 #include <rmqp_consumer.h>
 #include <rmqp_topologyupdate.h>
+#include <rmqt_envelope.h>
 #include <rmqt_future.h>
 #include <rmqt_message.h>
 #include <rmqt_result.h>
@@ -80,6 +81,27 @@ class Consumer {
     updateTopology(const rmqa::TopologyUpdate& topologyUpdate,
                    const bsls::TimeInterval& timeout = bsls::TimeInterval(0));
 
+    /// \brief Negatively acknowledges every delivered message not yet
+    /// acked, with a single basic.nack where possible. Acks sent for those
+    /// messages afterwards are ignored.
+    /// \param requeue  Whether the broker requeues the messages
+    /// \param timeout  How long to wait for the nack to be queued. If
+    /// timeout is 0, the method will wait indefinitely.
+    rmqt::Result<> nackAllOutstanding(
+        bool requeue                     = true,
+        const bsls::TimeInterval& timeout = bsls::TimeInterval(0));
+
+    /// \brief Acknowledges the message delivered with `envelope` and every
+    /// earlier message not acked yet, with a single basic.ack where
+    /// possible. Acks and nacks sent for those messages afterwards are
+    /// ignored, so their `MessageGuard`s may simply be dropped.
+    /// \param envelope The envelope of the latest message to ack
+    /// \param timeout  How long to wait for the ack to be queued. If
+    /// timeout is 0, the method will wait indefinitely.
+    rmqt::Result<>
+    ackThrough(const rmqt::Envelope& envelope,
+               const bsls::TimeInterval& timeout = bsls::TimeInterval(0));
+
     class Factory;
     // Internal implementation used by Connection.
 
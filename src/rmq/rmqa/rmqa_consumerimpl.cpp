@@ -15,21 +15,38 @@
 
 #include <rmqa_consumerimpl.h>
 
+#include <rmqa_messagebatchutil.h>
 #include <rmqa_messageguard.h>
+#include <rmqa_sendtimeutil.h>
+#include <rmqa_sharedreceivechannel.h>
+#include <rmqamqp_metricaggregator.h>
 #include <rmqamqp_receivechannel.h>
+#include <rmqio_coarseclock.h>
 #include <rmqio_eventloop.h>
+#include <rmqio_pipelineclock.h>
 #include <rmqp_consumer.h>
 #include <rmqp_messageguard.h>
 #include <rmqt_envelope.h>
+#include <rmqt_fieldvalue.h>
+#include <rmqt_log.h>
+#include <rmqt_probe.h>
 #include <rmqt_queue.h>
 #include <rmqt_result.h>
 #include <rmqt_topologyupdate.h>
 
 #include <ball_log.h>
 #include <bdlf_bind.h>
+#include <bdlt_currenttime.h>
+#include <bdlt_datetime.h>
+#include <bdlt_epochutil.h>
 #include <bslmt_lockguard.h>
 #include <bslmt_mutex.h>
+#include <bsls_systemtime.h>
+#include <bsls_timeutil.h>
 
+#include <bsl_algorithm.h>
+#include <bsl_cstdlib.h>
+#include <bsl_functional.h>
 #include <bsl_memory.h>
 #include <bsl_string.h>
 
@@ -38,10 +55,150 @@ namespace rmqa {
 namespace {
 BALL_LOG_SET_NAMESPACE_CATEGORY("RMQA.CONSUMERIMPL")
 
+// Inline callbacks taking longer than this risk missed heartbeats
+const bsls::Types::Int64 k_INLINE_CALLBACK_WARN_NANOS = 10 * 1000 * 1000;
+
+/// Load into `deadline` when `message` stops being worth processing: its
+/// timestamp plus its expiration, or else the value of `deadlineHeader`.
+/// Return false if it has neither.
+bool findDeadline(bdlt::Datetime* deadline,
+                  const bsl::string& deadlineHeader,
+                  const rmqt::Message& message)
+{
+    const rmqt::Properties& properties = message.properties();
+    if (!properties.timestamp.isNull() && !properties.expiration.isNull()) {
+        const bsl::string& expiration = properties.expiration.value();
+        char* end                     = 0;
+        bsls::Types::Int64 ttlMillis =
+            bsl::strtoll(expiration.c_str(), &end, 10);
+        if (!expiration.empty() && *end == '\0' && ttlMillis >= 0) {
+            *deadline = properties.timestamp.value();
+            deadline->addMilliseconds(ttlMillis);
+            return true;
+        }
+    }
+
+    rmqt::FieldValue value;
+    if (deadlineHeader.empty() || !message.findHeader(&value, deadlineHeader)) {
+        return false;
+    }
+    if (value.is<bdlt::Datetime>()) {
+        *deadline = value.the<bdlt::Datetime>();
+        return true;
+    }
+    if (value.is<int64_t>()) {
+        *deadline = bdlt::EpochUtil::epoch();
+        deadline->addMilliseconds(value.the<int64_t>());
+        return true;
+    }
+    return false;
+}
+
+bool isBeforeDeadline(const bsl::string& deadlineHeader,
+                      const rmqt::Message& message,
+                      const rmqt::Envelope&)
+{
+    bdlt::Datetime deadline;
+    return !findDeadline(&deadline, deadlineHeader, message) ||
+           bdlt::CurrentTime::utc() < deadline;
+}
+
+void recordDeliveryLatency(
+    const rmqamqp::MetricAggregator::Distribution& metric,
+    const rmqamqp::ReceiveChannel::MessageCallback& onMessage,
+    const rmqt::Message& message,
+    const rmqt::Envelope& envelope)
+{
+    double seconds;
+    if (SendTimeUtil::elapsed(&seconds, message, rmqio::CoarseClock::utc())) {
+        metric.record(seconds);
+    }
+    onMessage(message, envelope);
+}
+
+/// Remembers `key` in `filter` if `ack` acks the message, before passing
+/// it on to `ackCallback`
+void rememberAcked(const bsl::shared_ptr<RedeliveryFilter>& filter,
+                   const bsl::string& key,
+                   const MessageGuard::MessageGuardCallback& ackCallback,
+                   const rmqt::ConsumerAck& ack)
+{
+    if (ack.type() == rmqt::ConsumerAck::ACK) {
+        filter->insert(key, bsls::SystemTime::nowMonotonicClock());
+    }
+    ackCallback(ack);
+}
+
+/// Combines the acks of the messages unpacked from a batch container into
+/// one ack for the container, sent once every message is resolved
+class ContainerAck {
+  public:
+    ContainerAck(bsl::size_t count,
+                 const rmqt::Envelope& envelope,
+                 const MessageGuard::MessageGuardCallback& ackCallback)
+    : d_mutex()
+    , d_remaining(count)
+    , d_type(rmqt::ConsumerAck::ACK)
+    , d_envelope(envelope)
+    , d_ackCallback(ackCallback)
+    {
+    }
+
+    void resolve(const rmqt::ConsumerAck& ack)
+    {
+        rmqt::ConsumerAck::Type type;
+        {
+            bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+            // REQUEUE wins over REJECT, which wins over ACK
+            d_type = bsl::max(d_type, ack.type());
+            if (--d_remaining) {
+                return;
+            }
+            type = d_type;
+        }
+        d_ackCallback(rmqt::ConsumerAck(d_envelope, type));
+    }
+
+  private:
+    bslmt::Mutex d_mutex;
+    bsl::size_t d_remaining;
+    rmqt::ConsumerAck::Type d_type;
+    rmqt::Envelope d_envelope;
+    MessageGuard::MessageGuardCallback d_ackCallback;
+};
+
+
 } // namespace
 
+ConsumerImpl::Factory::Factory()
+: d_messageCodecs()
+, d_readBackpressureHighJobs(0)
+, d_readBackpressureLowJobs(0)
+, d_readBackpressureHighBytes(0)
+, d_readBackpressureLowBytes(0)
+, d_channelSharing(false)
+, d_deliveryLatencyMetric(false)
+, d_workStealingExecutor()
+, d_workStealingByDefault(false)
+, d_inlineDispatchByDefault(false)
+{
+}
+
 ConsumerImpl::Factory::~Factory() {}
 
+bsl::shared_ptr<ReadBackpressure>
+ConsumerImpl::Factory::newReadBackpressure() const
+{
+    if (!d_readBackpressureHighJobs && !d_readBackpressureHighBytes) {
+        return bsl::shared_ptr<ReadBackpressure>();
+    }
+
+    return bsl::make_shared<ReadBackpressure>(d_readBackpressureHighJobs,
+                                              d_readBackpressureLowJobs,
+                                              d_readBackpressureHighBytes,
+                                              d_readBackpressureLowBytes);
+}
+
 bsl::shared_ptr<ConsumerImpl> ConsumerImpl::Factory::create(
     const bsl::shared_ptr<rmqamqp::ReceiveChannel>& channel,
     rmqt::QueueHandle queue,
@@ -77,14 +234,35 @@ ConsumerImpl::ConsumerImpl(
 , d_threadPool(threadPool)
 , d_eventLoop(eventLoop)
 , d_ackQueue(ackQueue)
-, d_ackBatch()
-, d_ackMessageMutex()
 , d_channel(channel)
 , d_guardFactory(guardFactory)
+, d_guardAllocator()
 , d_onNewAckBatch(
       bdlf::BindUtil::bind(&rmqamqp::ReceiveChannel::consumeAckBatchFromQueue,
                            d_channel))
 , d_messageGuardCb()
+, d_onBatch()
+, d_maxBatchSize(0)
+, d_maxBatchLinger()
+, d_batch()
+, d_lingerTimer()
+, d_serialExecutor()
+, d_partitions()
+, d_partitionKey()
+, d_inlineDispatch(false)
+, d_priorityQueue()
+, d_workStealingExecutor()
+, d_workStealingLane()
+, d_noAck(false)
+, d_preFilter()
+, d_rejectFiltered(false)
+, d_staleMessagePolicy(rmqt::StaleMessagePolicy::DELIVER)
+, d_deadlineHeader()
+, d_redeliveryFilter()
+, d_deliveryLatencyMetric(false)
+, d_messageCodecs()
+, d_readBackpressure()
+, d_sharedChannel()
 {
 }
 
@@ -93,24 +271,328 @@ ConsumerImpl::~ConsumerImpl()
     BALL_LOG_INFO << "Consumer shutting down: " << d_channel->inFlight()
                   << " messages in flight";
 
+    if (d_sharedChannel) {
+        // The other consumers keep the channel open, it closes once the
+        // last of them releases it
+        d_eventLoop.post(
+            bdlf::BindUtil::bind(&rmqamqp::ReceiveChannel::releaseConsumer,
+                                 d_channel,
+                                 d_consumerTag));
+        return;
+    }
+
     d_eventLoop.post(
         bdlf::BindUtil::bind(&rmqamqp::Channel::gracefulClose, d_channel));
 }
 
+void ConsumerImpl::shareChannel(
+    const bsl::shared_ptr<SharedReceiveChannel>& sharedChannel)
+{
+    d_sharedChannel = sharedChannel;
+}
+
+void ConsumerImpl::setBatchConsumer(
+    const bsl::shared_ptr<BatchConsumerFunc>& onBatch,
+    bsl::size_t maxBatchSize,
+    const bsls::TimeInterval& maxLinger)
+{
+    d_onBatch        = onBatch;
+    d_maxBatchSize   = bsl::max(maxBatchSize, bsl::size_t(1));
+    d_maxBatchLinger = maxLinger;
+
+    if (d_maxBatchLinger > bsls::TimeInterval()) {
+        d_lingerTimer = d_eventLoop.timerFactory()->createWithCallback(
+            bdlf::BindUtil::bind(&ConsumerImpl::onLingerTimer,
+                                 weak_from_this(),
+                                 bdlf::PlaceHolders::_1));
+    }
+}
+
+void ConsumerImpl::setOrderedDispatch(bsl::size_t queueCapacity)
+{
+    d_serialExecutor = bsl::make_shared<SerialExecutor>(
+        bsl::ref(d_threadPool), queueCapacity);
+}
+
+void ConsumerImpl::setPartitionedDispatch(
+    bsl::size_t partitions,
+    bsl::size_t queueCapacity,
+    const rmqt::ConsumerConfig::PartitionKeyFunc& partitionKey)
+{
+    d_partitions.clear();
+    for (bsl::size_t i = 0; i < bsl::max(partitions, bsl::size_t(1)); ++i) {
+        d_partitions.push_back(bsl::make_shared<SerialExecutor>(
+            bsl::ref(d_threadPool), queueCapacity));
+    }
+    d_partitionKey   = partitionKey;
+    d_serialExecutor = d_partitions.front();
+}
+
+void ConsumerImpl::setInlineDispatch() { d_inlineDispatch = true; }
+
+void ConsumerImpl::setWorkStealingDispatch(
+    const bsl::shared_ptr<WorkStealingExecutor>& executor)
+{
+    d_workStealingExecutor = executor;
+    // Callbacks may run on every worker, as on a multi-threaded pool
+    d_workStealingLane = executor->createLane(executor->maxWorkers());
+}
+
+void ConsumerImpl::setPriorityDispatch()
+{
+    d_priorityQueue = bsl::make_shared<PriorityDispatchQueue>();
+}
+
+void ConsumerImpl::setNoAck() { d_noAck = true; }
+
+void ConsumerImpl::setPreFilter(
+    const rmqt::ConsumerConfig::PreFilterFunc& preFilter,
+    bool rejectFiltered)
+{
+    d_preFilter      = preFilter;
+    d_rejectFiltered = rejectFiltered;
+}
+
+void ConsumerImpl::setStaleMessagePolicy(
+    rmqt::StaleMessagePolicy::Value policy,
+    const bsl::string& deadlineHeader)
+{
+    d_staleMessagePolicy = policy;
+    d_deadlineHeader     = deadlineHeader;
+}
+
+void ConsumerImpl::setRedeliveryFilter(
+    const bsl::shared_ptr<RedeliveryFilter>& filter)
+{
+    d_redeliveryFilter = filter;
+}
+
+void ConsumerImpl::setDeliveryLatencyMetric(bool enabled)
+{
+    d_deliveryLatencyMetric = enabled;
+}
+
+void ConsumerImpl::setMessageCodecs(const MessageCodecUtil::Codecs& codecs)
+{
+    d_messageCodecs = codecs;
+}
+
+void ConsumerImpl::setReadBackpressure(
+    const bsl::shared_ptr<ReadBackpressure>& backpressure)
+{
+    d_readBackpressure = backpressure;
+}
+
+bsl::function<void()> ConsumerImpl::countedJob(
+    const bsl::function<void()>& job,
+    const bsl::shared_ptr<ReadBackpressure>& backpressure,
+    bsl::size_t bytes)
+{
+    if (!backpressure) {
+        return job;
+    }
+
+    backpressure->add(1, bytes);
+    return bdlf::BindUtil::bind(&runCountedJob, job, backpressure, bytes);
+}
+
+void ConsumerImpl::runCountedJob(
+    const bsl::function<void()>& job,
+    const bsl::shared_ptr<ReadBackpressure>& backpressure,
+    bsl::size_t bytes)
+{
+    job();
+    backpressure->remove(1, bytes);
+}
+
+rmqt::Message ConsumerImpl::decompressed(const rmqt::Message& message) const
+{
+    rmqt::Message result(message);
+    if (!d_messageCodecs.empty() &&
+        MessageCodecUtil::decompress(&result, d_messageCodecs) != 0) {
+        BALL_LOG_ERROR << "Delivering message " << message.guid()
+                       << " to " << d_consumerTag << " still compressed";
+    }
+    return result;
+}
+
+void ConsumerImpl::createGuards(Guards* guards,
+                                const rmqt::Message& message,
+                                const rmqt::Envelope& envelope)
+{
+    RMQT_PROBE2(
+        delivery_dispatched, envelope.deliveryTag(), message.payloadSize());
+
+    const rmqt::Message delivered = decompressed(message);
+
+    // Keyed by the message as received, as the redeliveries are checked
+    MessageGuard::MessageGuardCallback guardCb = d_messageGuardCb;
+    if (d_redeliveryFilter && guardCb) {
+        guardCb = bdlf::BindUtil::bind(&rememberAcked,
+                                       d_redeliveryFilter,
+                                       d_redeliveryFilter->key(message,
+                                                               envelope),
+                                       d_messageGuardCb,
+                                       bdlf::PlaceHolders::_1);
+    }
+
+    bsl::vector<rmqt::Message> unpacked;
+    if (MessageBatchUtil::isBatch(delivered) &&
+        MessageBatchUtil::unpack(&unpacked, delivered) != 0) {
+        BALL_LOG_ERROR << "Delivering malformed batch container "
+                       << delivered.guid() << " to " << d_consumerTag
+                       << " as it is";
+        unpacked.clear();
+    }
+
+    if (unpacked.empty()) {
+        guards->emplace_back(d_guardFactory->create(
+            delivered, envelope, guardCb, this, &d_guardAllocator));
+        return;
+    }
+
+    MessageGuard::MessageGuardCallback ackCallback;
+    if (guardCb) {
+        ackCallback = bdlf::BindUtil::bind(
+            &ContainerAck::resolve,
+            bsl::make_shared<ContainerAck>(
+                unpacked.size(), envelope, guardCb),
+            bdlf::PlaceHolders::_1);
+    }
+
+    for (bsl::vector<rmqt::Message>::const_iterator it = unpacked.begin();
+         it != unpacked.end();
+         ++it) {
+        guards->emplace_back(d_guardFactory->create(
+            *it, envelope, ackCallback, this, &d_guardAllocator));
+    }
+}
+
 rmqt::Result<> ConsumerImpl::start()
 {
+    rmqamqp::ReceiveChannel::MessageCallback onMessage;
+    if (d_onBatch) {
+        onMessage = bdlf::BindUtil::bind(&ConsumerImpl::handleBatchMessage,
+                                         weak_from_this(),
+                                         bdlf::PlaceHolders::_1,
+                                         bdlf::PlaceHolders::_2);
+    }
+    else if (d_inlineDispatch) {
+        onMessage = bdlf::BindUtil::bind(&ConsumerImpl::handleInlineMessage,
+                                         weak_from_this(),
+                                         bdlf::PlaceHolders::_1,
+                                         bdlf::PlaceHolders::_2);
+    }
+    else if (!d_partitions.empty()) {
+        onMessage =
+            bdlf::BindUtil::bind(&ConsumerImpl::handlePartitionedMessage,
+                                 weak_from_this(),
+                                 bdlf::PlaceHolders::_1,
+                                 bdlf::PlaceHolders::_2);
+    }
+    else if (d_workStealingLane) {
+        onMessage =
+            bdlf::BindUtil::bind(&ConsumerImpl::handleWorkStealingMessage,
+                                 weak_from_this(),
+                                 d_workStealingExecutor,
+                                 d_workStealingLane,
+                                 d_readBackpressure,
+                                 bdlf::PlaceHolders::_1,
+                                 bdlf::PlaceHolders::_2);
+    }
+    else if (d_priorityQueue) {
+        onMessage = bdlf::BindUtil::bind(&ConsumerImpl::handlePriorityMessage,
+                                         weak_from_this(),
+                                         bsl::ref(d_threadPool),
+                                         d_priorityQueue,
+                                         d_readBackpressure,
+                                         bdlf::PlaceHolders::_1,
+                                         bdlf::PlaceHolders::_2);
+    }
+    else if (d_serialExecutor) {
+        onMessage = bdlf::BindUtil::bind(&ConsumerImpl::handleOrderedMessage,
+                                         weak_from_this(),
+                                         d_serialExecutor,
+                                         d_readBackpressure,
+                                         bdlf::PlaceHolders::_1,
+                                         bdlf::PlaceHolders::_2);
+    }
+    else {
+        onMessage = bdlf::BindUtil::bind(&ConsumerImpl::handleMessage,
+                                         weak_from_this(),
+                                         bsl::ref(d_threadPool),
+                                         d_readBackpressure,
+                                         bdlf::PlaceHolders::_1,
+                                         bdlf::PlaceHolders::_2);
+    }
+
+    if (d_preFilter) {
+        onMessage = bdlf::BindUtil::bind(&ConsumerImpl::filterMessage,
+                                         weak_from_this(),
+                                         d_preFilter,
+                                         d_rejectFiltered
+                                             ? rmqt::ConsumerAck::REJECT
+                                             : rmqt::ConsumerAck::ACK,
+                                         onMessage,
+                                         bdlf::PlaceHolders::_1,
+                                         bdlf::PlaceHolders::_2);
+    }
+
+    if (d_redeliveryFilter) {
+        rmqt::ConsumerConfig::PreFilterFunc isUnprocessed =
+            bdlf::BindUtil::bind(&RedeliveryFilter::isUnprocessed,
+                                 d_redeliveryFilter,
+                                 bdlf::PlaceHolders::_1,
+                                 bdlf::PlaceHolders::_2);
+        onMessage = bdlf::BindUtil::bind(&ConsumerImpl::filterMessage,
+                                         weak_from_this(),
+                                         isUnprocessed,
+                                         rmqt::ConsumerAck::ACK,
+                                         onMessage,
+                                         bdlf::PlaceHolders::_1,
+                                         bdlf::PlaceHolders::_2);
+    }
+
+    // Checked ahead of the pre-filter: a stale message is worthless anyway
+    if (d_staleMessagePolicy != rmqt::StaleMessagePolicy::DELIVER) {
+        rmqt::ConsumerConfig::PreFilterFunc isFresh =
+            bdlf::BindUtil::bind(&isBeforeDeadline,
+                                 d_deadlineHeader,
+                                 bdlf::PlaceHolders::_1,
+                                 bdlf::PlaceHolders::_2);
+        onMessage = bdlf::BindUtil::bind(
+            &ConsumerImpl::filterMessage,
+            weak_from_this(),
+            isFresh,
+            d_staleMessagePolicy == rmqt::StaleMessagePolicy::DEAD_LETTER
+                ? rmqt::ConsumerAck::REJECT
+                : rmqt::ConsumerAck::ACK,
+            onMessage,
+            bdlf::PlaceHolders::_1,
+            bdlf::PlaceHolders::_2);
+    }
+
+    // Outermost, so messages settled by the filters above are measured too
+    bsl::shared_ptr<rmqt::Queue> queue = d_queue.lock();
+    if (d_deliveryLatencyMetric && queue) {
+        onMessage = bdlf::BindUtil::bind(
+            &recordDeliveryLatency,
+            d_channel->deliveryLatencyMetric(queue->name()),
+            onMessage,
+            bdlf::PlaceHolders::_1,
+            bdlf::PlaceHolders::_2);
+    }
+
     rmqt::Result<> result =
-        d_channel->consume(d_queue,
-                           bdlf::BindUtil::bind(&ConsumerImpl::handleMessage,
-                                                weak_from_this(),
-                                                bsl::ref(d_threadPool),
-                                                bdlf::PlaceHolders::_1,
-                                                bdlf::PlaceHolders::_2),
-                           d_consumerTag);
-
-    d_messageGuardCb = bdlf::BindUtil::bind(&ConsumerImpl::messageGuardCb,
-                                            weak_from_this(),
-                                            bdlf::PlaceHolders::_1);
+        d_channel->consume(d_queue, onMessage, d_consumerTag);
+
+    // Left empty without acks, which makes the guards' ack/nack no-ops
+    if (!d_noAck) {
+        d_messageGuardCb =
+            bdlf::BindUtil::bind(&ConsumerImpl::messageGuardCb,
+                                 weak_from_this(),
+                                 bdlf::PlaceHolders::_1);
+    }
 
     return result;
 }
@@ -118,34 +600,368 @@ rmqt::Result<> ConsumerImpl::start()
 void ConsumerImpl::handleMessage(
     const bsl::weak_ptr<ConsumerImpl>& consumerWeakPtr,
     bdlmt::ThreadPool& threadPool,
+    const bsl::shared_ptr<ReadBackpressure>& backpressure,
     const rmqt::Message& message,
     const rmqt::Envelope& envelope)
 {
     using bdlf::PlaceHolders::_1;
 
-    int rc = threadPool.enqueueJob(bdlf::BindUtil::bind(
-        &threadPoolHandleMessage, consumerWeakPtr, message, envelope));
+    int rc = threadPool.enqueueJob(
+        countedJob(bdlf::BindUtil::bind(&threadPoolHandleMessage,
+                                        consumerWeakPtr,
+                                        message,
+                                        envelope,
+                                        rmqio::PipelineClock::now()),
+                   backpressure,
+                   message.payloadSize()));
+
+    if (rc != 0) {
+        if (backpressure) {
+            backpressure->remove(1, message.payloadSize());
+        }
+        BALL_LOG_ERROR << "Couldn't enqueue thread pool job for message "
+                       << message.guid() << " (return code " << rc
+                       << "). This message will NEVER be delivered to the "
+                          "application and won't ever be acknowledged.";
+    }
+}
+
+void ConsumerImpl::filterMessage(
+    const bsl::weak_ptr<ConsumerImpl>& consumerWeakPtr,
+    const rmqt::ConsumerConfig::PreFilterFunc& preFilter,
+    rmqt::ConsumerAck::Type settleAs,
+    const rmqamqp::ReceiveChannel::MessageCallback& onMessage,
+    const rmqt::Message& message,
+    const rmqt::Envelope& envelope)
+{
+    if (preFilter(message, envelope)) {
+        onMessage(message, envelope);
+        return;
+    }
+
+    bsl::shared_ptr<ConsumerImpl> consumer = consumerWeakPtr.lock();
+    if (!consumer || consumer->d_noAck) {
+        return;
+    }
+
+    RMQT_LOG_TRACE << "Filtered out: " << message << " " << envelope;
+
+    // Queued with the callbacks' acks, so that a run of filtered messages
+    // goes out as one multiple ack
+    consumer->ackMessage(rmqt::ConsumerAck(envelope, settleAs));
+}
+
+void ConsumerImpl::handleInlineMessage(
+    const bsl::weak_ptr<ConsumerImpl>& consumerWeakPtr,
+    const rmqt::Message& message,
+    const rmqt::Envelope& envelope)
+{
+    bsl::shared_ptr<ConsumerImpl> consumer = consumerWeakPtr.lock();
+
+    if (!consumer) {
+        BALL_LOG_WARN << "Ignoring new message as Consumer is shutting down: "
+                      << message << " " << envelope;
+        return;
+    }
+
+    const bsls::Types::Int64 start = bsls::TimeUtil::getTimer();
+    threadPoolHandleMessage(consumerWeakPtr, message, envelope, 0);
+    consumer->recordInlineCallbackTime(start);
+}
+
+void ConsumerImpl::recordInlineCallbackTime(bsls::Types::Int64 startNanos)
+{
+    const bsls::Types::Int64 elapsed =
+        bsls::TimeUtil::getTimer() - startNanos;
+
+    d_channel->publishInlineCallbackTime(
+        static_cast<double>(elapsed) / (1000 * 1000 * 1000));
+
+    if (elapsed > k_INLINE_CALLBACK_WARN_NANOS) {
+        BALL_LOG_WARN << "Inline consumer callback for " << d_consumerTag
+                      << " blocked the event loop for " << elapsed / 1000
+                      << "us. Use threadpool dispatch for slow handlers.";
+    }
+}
+
+void ConsumerImpl::handleOrderedMessage(
+    const bsl::weak_ptr<ConsumerImpl>& consumerWeakPtr,
+    const bsl::shared_ptr<SerialExecutor>& executor,
+    const bsl::shared_ptr<ReadBackpressure>& backpressure,
+    const rmqt::Message& message,
+    const rmqt::Envelope& envelope)
+{
+    // A job the executor fails to schedule stays queued, so stays counted
+    int rc = executor->submit(
+        countedJob(bdlf::BindUtil::bind(&threadPoolHandleMessage,
+                                        consumerWeakPtr,
+                                        message,
+                                        envelope,
+                                        rmqio::PipelineClock::now()),
+                   backpressure,
+                   message.payloadSize()));
 
     if (rc != 0) {
+        BALL_LOG_ERROR << "Couldn't enqueue thread pool job to deliver message "
+                       << message.guid() << " (return code " << rc
+                       << "). It stays queued until the next delivery.";
+    }
+}
+
+void ConsumerImpl::handlePriorityMessage(
+    const bsl::weak_ptr<ConsumerImpl>& consumerWeakPtr,
+    bdlmt::ThreadPool& threadPool,
+    const bsl::shared_ptr<PriorityDispatchQueue>& queue,
+    const bsl::shared_ptr<ReadBackpressure>& backpressure,
+    const rmqt::Message& message,
+    const rmqt::Envelope& envelope)
+{
+    queue->push(message, envelope);
+
+    // One job per message, so every message is taken by some job. Counted
+    // by this message's size: the job may deliver another, but the totals
+    // balance.
+    int rc = threadPool.enqueueJob(
+        countedJob(bdlf::BindUtil::bind(&threadPoolHandlePriorityMessage,
+                                        consumerWeakPtr,
+                                        queue,
+                                        rmqio::PipelineClock::now()),
+                   backpressure,
+                   message.payloadSize()));
+
+    if (rc != 0) {
+        if (backpressure) {
+            backpressure->remove(1, message.payloadSize());
+        }
         BALL_LOG_ERROR << "Couldn't enqueue thread pool job for message "
+                       << message.guid() << " (return code " << rc
+                       << "). One waiting message will NEVER be delivered to "
+                          "the application and won't ever be acknowledged.";
+    }
+}
+
+void ConsumerImpl::threadPoolHandlePriorityMessage(
+    const bsl::weak_ptr<ConsumerImpl>& consumerWeakPtr,
+    const bsl::shared_ptr<PriorityDispatchQueue>& queue,
+    bsls::Types::Int64 dispatchedAt)
+{
+    const bsl::optional<PriorityDispatchQueue::Delivery> delivery =
+        queue->pop();
+    if (delivery) {
+        threadPoolHandleMessage(consumerWeakPtr,
+                                delivery->first,
+                                delivery->second,
+                                dispatchedAt);
+    }
+}
+
+void ConsumerImpl::handleWorkStealingMessage(
+    const bsl::weak_ptr<ConsumerImpl>& consumerWeakPtr,
+    const bsl::shared_ptr<WorkStealingExecutor>& executor,
+    const bsl::shared_ptr<WorkStealingExecutor::Lane>& lane,
+    const bsl::shared_ptr<ReadBackpressure>& backpressure,
+    const rmqt::Message& message,
+    const rmqt::Envelope& envelope)
+{
+    int rc = executor->submit(
+        lane,
+        countedJob(bdlf::BindUtil::bind(&threadPoolHandleMessage,
+                                        consumerWeakPtr,
+                                        message,
+                                        envelope,
+                                        rmqio::PipelineClock::now()),
+                   backpressure,
+                   message.payloadSize()));
+
+    if (rc != 0) {
+        if (backpressure) {
+            backpressure->remove(1, message.payloadSize());
+        }
+        BALL_LOG_ERROR << "Couldn't submit work-stealing job for message "
                        << message.guid() << " (return code " << rc
                        << "). This message will NEVER be delivered to the "
                           "application and won't ever be acknowledged.";
     }
 }
 
+void ConsumerImpl::handlePartitionedMessage(
+    const bsl::weak_ptr<ConsumerImpl>& consumerWeakPtr,
+    const rmqt::Message& message,
+    const rmqt::Envelope& envelope)
+{
+    bsl::shared_ptr<ConsumerImpl> consumer = consumerWeakPtr.lock();
+
+    if (!consumer) {
+        BALL_LOG_WARN << "Ignoring new message as Consumer is shutting down: "
+                      << message << " " << envelope;
+        return;
+    }
+
+    const bsl::size_t hash =
+        consumer->d_partitionKey
+            ? bsl::hash<bsl::string>()(
+                  consumer->d_partitionKey(message, envelope))
+            : bsl::hash<bsl::string>()(envelope.routingKey());
+
+    handleOrderedMessage(
+        consumerWeakPtr,
+        consumer->d_partitions[hash % consumer->d_partitions.size()],
+        consumer->d_readBackpressure,
+        message,
+        envelope);
+}
+
+void ConsumerImpl::handleBatchMessage(
+    const bsl::weak_ptr<ConsumerImpl>& consumerWeakPtr,
+    const rmqt::Message& message,
+    const rmqt::Envelope& envelope)
+{
+    bsl::shared_ptr<ConsumerImpl> consumer = consumerWeakPtr.lock();
+
+    if (!consumer) {
+        BALL_LOG_WARN << "Ignoring new message as Consumer is shutting down: "
+                      << message << " " << envelope;
+        return;
+    }
+
+    if (!consumer->d_batch) {
+        consumer->d_batch = bsl::make_shared<Batch>();
+        consumer->d_batch->reserve(consumer->d_maxBatchSize);
+
+        if (consumer->d_lingerTimer) {
+            consumer->d_lingerTimer->reset(consumer->d_maxBatchLinger);
+        }
+        else {
+            // Runs after the handlers for the rest of this read
+            consumer->d_eventLoop.post(
+                bdlf::BindUtil::bind(&ConsumerImpl::flushBatchCb,
+                                     consumerWeakPtr));
+        }
+    }
+
+    consumer->d_batch->push_back(bsl::make_pair(message, envelope));
+
+    if (consumer->d_batch->size() >= consumer->d_maxBatchSize) {
+        consumer->flushBatch();
+    }
+}
+
+void ConsumerImpl::flushBatchCb(const bsl::weak_ptr<ConsumerImpl>& consumerPtr)
+{
+    bsl::shared_ptr<ConsumerImpl> consumer = consumerPtr.lock();
+    if (consumer) {
+        consumer->flushBatch();
+    }
+}
+
+void ConsumerImpl::onLingerTimer(
+    const bsl::weak_ptr<ConsumerImpl>& consumerPtr,
+    rmqio::Timer::InterruptReason reason)
+{
+    if (reason == rmqio::Timer::EXPIRE) {
+        flushBatchCb(consumerPtr);
+    }
+}
+
+void ConsumerImpl::flushBatch()
+{
+    if (!d_batch) {
+        return;
+    }
+
+    bsl::shared_ptr<Batch> batch;
+    batch.swap(d_batch);
+
+    if (d_lingerTimer) {
+        // Don't let this batch's timer cut the next one short
+        d_lingerTimer->cancel();
+    }
+
+    if (d_inlineDispatch) {
+        const bsls::Types::Int64 start = bsls::TimeUtil::getTimer();
+        threadPoolHandleBatch(weak_from_this(), batch);
+        recordInlineCallbackTime(start);
+        return;
+    }
+
+    bsl::size_t bytes = 0;
+    for (Batch::const_iterator it = batch->begin(); it != batch->end(); ++it) {
+        bytes += it->first.payloadSize();
+    }
+
+    const bsl::function<void()> job =
+        countedJob(bdlf::BindUtil::bind(
+                       &threadPoolHandleBatch, weak_from_this(), batch),
+                   d_readBackpressure,
+                   bytes);
+    int rc = d_serialExecutor ? d_serialExecutor->submit(job)
+             : d_workStealingLane
+                 ? d_workStealingExecutor->submit(d_workStealingLane, job)
+                 : d_threadPool.enqueueJob(job);
+
+    if (rc != 0 && !d_serialExecutor) {
+        if (d_readBackpressure) {
+            d_readBackpressure->remove(1, bytes);
+        }
+        BALL_LOG_ERROR << "Couldn't enqueue thread pool job for a batch of "
+                       << batch->size() << " messages (return code " << rc
+                       << "). These messages will NEVER be delivered to the "
+                          "application and won't ever be acknowledged.";
+    }
+}
+
 rmqt::Future<> ConsumerImpl::cancel()
 {
+    if (d_sharedChannel) {
+        return rmqt::FutureUtil::flatten<void>(
+            d_eventLoop.postF<rmqt::Future<> >(
+                bdlf::BindUtil::bind(&rmqamqp::ReceiveChannel::cancelConsumer,
+                                     d_channel,
+                                     d_consumerTag)));
+    }
     return rmqt::FutureUtil::flatten<void>(d_eventLoop.postF<rmqt::Future<> >(
         bdlf::BindUtil::bind(&rmqamqp::ReceiveChannel::cancel, d_channel)));
 }
 
 rmqt::Future<> ConsumerImpl::drain()
 {
+    if (d_sharedChannel) {
+        return rmqt::FutureUtil::flatten<void>(
+            d_eventLoop.postF<rmqt::Future<> >(
+                bdlf::BindUtil::bind(&rmqamqp::ReceiveChannel::drainConsumer,
+                                     d_channel,
+                                     d_consumerTag)));
+    }
     return rmqt::FutureUtil::flatten<void>(d_eventLoop.postF<rmqt::Future<> >(
         bdlf::BindUtil::bind(&rmqamqp::ReceiveChannel::drain, d_channel)));
 }
 
+rmqt::Future<> ConsumerImpl::nackAllOutstanding(bool requeue)
+{
+    if (d_sharedChannel) {
+        return rmqt::FutureUtil::flatten<void>(
+            d_eventLoop.postF<rmqt::Future<> >(bdlf::BindUtil::bind(
+                &rmqamqp::ReceiveChannel::nackConsumerDeliveries,
+                d_channel,
+                d_consumerTag,
+                requeue)));
+    }
+    return rmqt::FutureUtil::flatten<void>(
+        d_eventLoop.postF<rmqt::Future<> >(
+            bdlf::BindUtil::bind(&rmqamqp::ReceiveChannel::nackAllOutstanding,
+                                 d_channel,
+                                 requeue)));
+}
+
+rmqt::Future<> ConsumerImpl::ackThrough(const rmqt::Envelope& envelope)
+{
+    return rmqt::FutureUtil::flatten<void>(
+        d_eventLoop.postF<rmqt::Future<> >(
+            bdlf::BindUtil::bind(&rmqamqp::ReceiveChannel::ackThrough,
+                                 d_channel,
+                                 envelope)));
+}
+
 rmqt::Result<> ConsumerImpl::cancelAndDrain(const bsls::TimeInterval& timeout)
 {
     bsl::function<rmqt::Future<>()> fn =
@@ -168,24 +984,32 @@ ConsumerImpl::updateTopologyAsync(const rmqt::TopologyUpdate& topologyUpdate)
 void ConsumerImpl::ackMessage(const rmqt::ConsumerAck& ack)
 {
     // this method is executed by consumer threadpool workers and needs to be
-    // thread-safe
-    bslmt::LockGuard<bslmt::Mutex> guard(&d_ackMessageMutex);
-
-    if (!d_ackBatch || !d_ackBatch->addAck(ack)) {
-        d_ackBatch = bsl::make_shared<rmqt::ConsumerAckBatch>();
-        if (!d_ackBatch->addAck(ack)) {
-            BALL_LOG_ERROR << "Newly-created consumer ack batch already locked "
-                           << ack.envelope().deliveryTag();
+    // thread-safe. Only the first ack since the last drain posts one.
+    if (d_ackQueue->push(ack)) {
+        const bsls::Types::Int64 queuedAt = rmqio::PipelineClock::now();
+        if (queuedAt) {
+            d_eventLoop.post(bdlf::BindUtil::bind(
+                &consumeTimedAckBatch, d_channel, queuedAt));
+        }
+        else {
+            d_eventLoop.post(d_onNewAckBatch);
         }
-        d_ackQueue->pushBack(d_ackBatch);
-        d_eventLoop.post(d_onNewAckBatch);
     }
 }
 
+void ConsumerImpl::consumeTimedAckBatch(
+    const bsl::shared_ptr<rmqamqp::ReceiveChannel>& channel,
+    bsls::Types::Int64 queuedAt)
+{
+    channel->recordPipelineStage(rmqamqp::PipelineStage::ACK_QUEUE, queuedAt);
+    channel->consumeAckBatchFromQueue();
+}
+
 void ConsumerImpl::threadPoolHandleMessage(
     const bsl::weak_ptr<ConsumerImpl>& consumerWeakPtr,
     const rmqt::Message& message,
-    const rmqt::Envelope& envelope)
+    const rmqt::Envelope& envelope,
+    bsls::Types::Int64 dispatchedAt)
 {
     bsl::shared_ptr<ConsumerImpl> consumer = consumerWeakPtr.lock();
 
@@ -195,17 +1019,78 @@ void ConsumerImpl::threadPoolHandleMessage(
         return;
     }
 
-    using bdlf::PlaceHolders::_1;
+    // More than one guard if the message is a batch container
+    Guards guards(&consumer->d_guardAllocator);
+    consumer->createGuards(&guards, message, envelope);
+
+    const rmqamqp::ReceiveChannel& channel = *consumer->d_channel;
+    const bsls::Types::Int64 callbackStart = rmqio::PipelineClock::now();
+    channel.recordPipelineStage(rmqamqp::PipelineStage::DISPATCH,
+                                dispatchedAt);
+
+    // Feeds the adaptive prefetch count, when enabled
+    const bool timed = consumer->d_ackQueue->callbackTimingEnabled();
+
+    for (Guards::iterator it = guards.begin(); it != guards.end(); ++it) {
+        rmqa::MessageGuard& guard = **it;
+        RMQT_LOG_DEBUG << "Delivering: " << guard << " to client";
+
+        const bsls::Types::Int64 start =
+            timed ? bsls::TimeUtil::getTimer() : 0;
+
+        (*consumer->d_onMessage)(guard);
+
+        if (timed) {
+            consumer->d_ackQueue->recordCallbackTime(
+                bsls::TimeUtil::getTimer() - start);
+        }
 
-    bslma::ManagedPtr<rmqa::MessageGuard> guard(
-        consumer->d_guardFactory->create(
-            message, envelope, consumer->d_messageGuardCb, consumer.ptr()));
+        RMQT_LOG_DEBUG << "Processed: " << guard << " from client";
+    }
+    channel.recordPipelineStage(rmqamqp::PipelineStage::CALLBACK,
+                                callbackStart);
+}
+
+void ConsumerImpl::threadPoolHandleBatch(
+    const bsl::weak_ptr<ConsumerImpl>& consumerWeakPtr,
+    const bsl::shared_ptr<Batch>& batch)
+{
+    bsl::shared_ptr<ConsumerImpl> consumer = consumerWeakPtr.lock();
 
-    BALL_LOG_DEBUG << "Delivering: " << *guard << " to client";
+    if (!consumer) {
+        BALL_LOG_WARN << "Ignoring batch of " << batch->size()
+                      << " messages as Consumer is shutting down";
+        return;
+    }
 
-    (*consumer->d_onMessage)(*guard);
+    // Guards nack anything left unresolved when they go out of scope, after
+    // the callback returns
+    Guards guards(&consumer->d_guardAllocator);
+    guards.reserve(batch->size());
+
+    for (Batch::const_iterator it = batch->begin(); it != batch->end(); ++it) {
+        consumer->createGuards(&guards, it->first, it->second);
+    }
+
+    bsl::vector<rmqp::MessageGuard*> span;
+    span.reserve(guards.size());
+    for (Guards::iterator it = guards.begin(); it != guards.end(); ++it) {
+        span.push_back(it->get());
+    }
+
+    RMQT_LOG_DEBUG << "Delivering batch of " << span.size() << " to client";
+
+    const bool timed = consumer->d_ackQueue->callbackTimingEnabled();
+    const bsls::Types::Int64 start = timed ? bsls::TimeUtil::getTimer() : 0;
+
+    (*consumer->d_onBatch)(span);
+
+    if (timed) {
+        consumer->d_ackQueue->recordCallbackTime(
+            bsls::TimeUtil::getTimer() - start, span.size());
+    }
 
-    BALL_LOG_DEBUG << "Processed: " << *guard << " from client";
+    RMQT_LOG_DEBUG << "Processed batch of " << span.size() << " from client";
 }
 
 void ConsumerImpl::messageGuardCb(
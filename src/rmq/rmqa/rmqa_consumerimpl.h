@@ -16,25 +16,37 @@
 #ifndef INCLUDED_RMQA_CONSUMERIMPL
 #define INCLUDED_RMQA_CONSUMERIMPL
 
+#include <rmqa_messagecodecutil.h>
 #include <rmqa_messageguard.h>
+#include <rmqa_prioritydispatchqueue.h>
+#include <rmqa_readbackpressure.h>
+#include <rmqa_redeliveryfilter.h>
+#include <rmqa_serialexecutor.h>
+#include <rmqa_workstealingexecutor.h>
 
 #include <rmqio_eventloop.h>
+#include <rmqio_timer.h>
 #include <rmqp_consumer.h>
-#include <rmqt_consumerackbatch.h>
+#include <rmqt_consumerackqueue.h>
+#include <rmqt_consumerconfig.h>
 #include <rmqt_endpoint.h>
 #include <rmqt_envelope.h>
 #include <rmqt_message.h>
 #include <rmqt_queue.h>
 #include <rmqt_result.h>
 
+#include <bdlma_concurrentmultipoolallocator.h>
 #include <bdlmt_threadpool.h>
-#include <bslmt_lockguard.h>
-#include <bslmt_mutex.h>
+#include <bslma_managedptr.h>
 #include <bsls_keyword.h>
+#include <bsls_timeinterval.h>
+#include <bsls_types.h>
 
 #include <bsl_functional.h>
 #include <bsl_memory.h>
 #include <bsl_string.h>
+#include <bsl_utility.h>
+#include <bsl_vector.h>
 
 //@PURPOSE: Provide a RabbitMQ Async Consumer API
 //
@@ -48,12 +60,14 @@ class ReceiveChannel;
 }
 
 namespace rmqa {
+class SharedReceiveChannel;
 
 class ConsumerImpl : public rmqp::Consumer,
                      public bsl::enable_shared_from_this<ConsumerImpl> {
   public:
     class Factory {
       public:
+        Factory();
         virtual ~Factory();
         virtual bsl::shared_ptr<ConsumerImpl>
         create(const bsl::shared_ptr<rmqamqp::ReceiveChannel>& channel,
@@ -63,6 +77,103 @@ class ConsumerImpl : public rmqp::Consumer,
                bdlmt::ThreadPool& threadPool,
                rmqio::EventLoop& eventLoop,
                const bsl::shared_ptr<rmqt::ConsumerAckQueue>& ackQueue) const;
+
+        /// Codecs the consumers created from this factory decompress with,
+        /// see `ConsumerImpl::setMessageCodecs`
+        void setMessageCodecs(const MessageCodecUtil::Codecs& codecs)
+        {
+            d_messageCodecs = codecs;
+        }
+
+        const MessageCodecUtil::Codecs& messageCodecs() const
+        {
+            return d_messageCodecs;
+        }
+
+        /// Pause reads on a connection once its consumers have `highJobs`
+        /// jobs, or jobs carrying `highBytes` message bytes, waiting for the
+        /// threadpool, until they drain to `lowJobs` and `lowBytes`. A high
+        /// mark of zero leaves that dimension unchecked.
+        void setReadBackpressure(bsl::size_t highJobs,
+                                 bsl::size_t lowJobs,
+                                 bsl::size_t highBytes,
+                                 bsl::size_t lowBytes)
+        {
+            d_readBackpressureHighJobs  = highJobs;
+            d_readBackpressureLowJobs   = lowJobs;
+            d_readBackpressureHighBytes = highBytes;
+            d_readBackpressureLowBytes  = lowBytes;
+        }
+
+        /// Return a `ReadBackpressure` for one connection, or a null
+        /// pointer if `setReadBackpressure` was not called
+        bsl::shared_ptr<ReadBackpressure> newReadBackpressure() const;
+
+        /// Let consumers with the same topology and channel settings share
+        /// one channel, see `ConsumerImpl::shareChannel`
+        void setChannelSharing(bool channelSharing)
+        {
+            d_channelSharing = channelSharing;
+        }
+
+        /// Measure the delivery latency of the consumers created from this
+        /// factory, see `ConsumerImpl::setDeliveryLatencyMetric`
+        void setDeliveryLatencyMetric(bool enabled)
+        {
+            d_deliveryLatencyMetric = enabled;
+        }
+
+        bool deliveryLatencyMetric() const { return d_deliveryLatencyMetric; }
+
+        bool channelSharing() const { return d_channelSharing; }
+
+        /// Executor for consumers with `rmqt::ConsumerDispatch::
+        /// WORK_STEALING`, see `ConsumerImpl::setWorkStealingDispatch`
+        void setWorkStealingExecutor(
+            const bsl::shared_ptr<WorkStealingExecutor>& executor)
+        {
+            d_workStealingExecutor = executor;
+        }
+
+        const bsl::shared_ptr<WorkStealingExecutor>&
+        workStealingExecutor() const
+        {
+            return d_workStealingExecutor;
+        }
+
+        /// Also dispatch consumers with `rmqt::ConsumerDispatch::THREADPOOL`
+        /// through the work-stealing executor, if there is one
+        void setWorkStealingByDefault(bool byDefault)
+        {
+            d_workStealingByDefault = byDefault;
+        }
+
+        bool workStealingByDefault() const { return d_workStealingByDefault; }
+
+        /// Run the callbacks of consumers which dispatch to the threadpool,
+        /// and were not given one, on the event loop instead, see
+        /// `rmqt::ConsumerDispatch::EVENT_LOOP`
+        void setInlineDispatchByDefault(bool byDefault)
+        {
+            d_inlineDispatchByDefault = byDefault;
+        }
+
+        bool inlineDispatchByDefault() const
+        {
+            return d_inlineDispatchByDefault;
+        }
+
+      private:
+        MessageCodecUtil::Codecs d_messageCodecs;
+        bsl::size_t d_readBackpressureHighJobs;
+        bsl::size_t d_readBackpressureLowJobs;
+        bsl::size_t d_readBackpressureHighBytes;
+        bsl::size_t d_readBackpressureLowBytes;
+        bool d_channelSharing;
+        bool d_deliveryLatencyMetric;
+        bsl::shared_ptr<WorkStealingExecutor> d_workStealingExecutor;
+        bool d_workStealingByDefault;
+        bool d_inlineDispatchByDefault;
     };
 
     // CREATORS
@@ -79,6 +190,95 @@ class ConsumerImpl : public rmqp::Consumer,
     /// Destructor stops the consumer
     ~ConsumerImpl();
 
+    /// Deliver messages to `onBatch` in batches of up to `maxBatchSize`
+    /// instead of to the per-message callback. A batch is delivered when
+    /// full, or `maxLinger` after its first message arrived (when the event
+    /// loop has handled the current read, if `maxLinger` is zero), with one
+    /// threadpool job per batch. Must be called before `start()`.
+    void setBatchConsumer(const bsl::shared_ptr<BatchConsumerFunc>& onBatch,
+                          bsl::size_t maxBatchSize,
+                          const bsls::TimeInterval& maxLinger);
+
+    /// Deliver messages (or batches) one at a time in delivery order, via a
+    /// `SerialExecutor` on the threadpool, instead of one threadpool job
+    /// each. Must be called before `start()`.
+    /// \param queueCapacity Size of the lock-free queue, a power of two
+    void setOrderedDispatch(bsl::size_t queueCapacity);
+
+    /// Spread messages over `partitions` ordered lanes by the hash of
+    /// `partitionKey` (or of the routing key, if it is empty), see
+    /// `rmqt::ConsumerDispatch::PARTITIONED`. Batches go to the first lane.
+    /// Must be called before `start()`.
+    /// \param queueCapacity Size of each lane's lock-free queue, a power of
+    ///        two
+    void setPartitionedDispatch(
+        bsl::size_t partitions,
+        bsl::size_t queueCapacity,
+        const rmqt::ConsumerConfig::PartitionKeyFunc& partitionKey);
+
+    /// Invoke the consumer callback directly on the event loop thread, see
+    /// `rmqt::ConsumerDispatch::EVENT_LOOP`. Must be called before `start()`.
+    void setInlineDispatch();
+
+    /// Deliver messages (or batches) through a lane of `executor` instead
+    /// of one threadpool job each, see
+    /// `rmqt::ConsumerDispatch::WORK_STEALING`. Must be called before
+    /// `start()`.
+    void setWorkStealingDispatch(
+        const bsl::shared_ptr<WorkStealingExecutor>& executor);
+
+    /// Have each threadpool job deliver the waiting message of highest
+    /// priority, see `rmqt::ConsumerDispatch::PRIORITY`. Must be called
+    /// before `start()`.
+    void setPriorityDispatch();
+
+    /// Hand out message guards which acknowledge nothing, for a consumer
+    /// started with `rmqt::ConsumerConfig::setNoAck`. Must be called before
+    /// `start()`.
+    void setNoAck();
+
+    /// Settle the messages `preFilter` returns false for on the event loop
+    /// thread, by an ack or, if `rejectFiltered`, a reject, instead of
+    /// dispatching them to the callback. Must be called before `start()`.
+    void setPreFilter(const rmqt::ConsumerConfig::PreFilterFunc& preFilter,
+                      bool rejectFiltered);
+
+    /// Settle messages whose deadline has passed on the event loop thread
+    /// according to `policy`, see `rmqt::ConsumerConfig`. Must be called
+    /// before `start()`.
+    void setStaleMessagePolicy(rmqt::StaleMessagePolicy::Value policy,
+                               const bsl::string& deadlineHeader);
+
+    /// Ack redeliveries of messages `filter` remembers on the event loop
+    /// thread, instead of dispatching them to the callback, and remember
+    /// the messages the callback acks. Must be called before `start()`.
+    void setRedeliveryFilter(const bsl::shared_ptr<RedeliveryFilter>& filter);
+
+    /// Publish the `publish_to_deliver_latency` distribution, the time from
+    /// each message's send time (see `SendTimeUtil`) to its delivery, on
+    /// the event loop thread. Must be called before `start()`.
+    void setDeliveryLatencyMetric(bool enabled);
+
+    /// Decompress messages whose content encoding names one of `codecs`
+    /// before handing them to the consumer callback, on the thread running
+    /// the callback. Must be called before `start()`.
+    void setMessageCodecs(const MessageCodecUtil::Codecs& codecs);
+
+    /// Count the jobs this consumer queues for the threadpool, and the
+    /// bytes they carry, against `backpressure`, which pauses reads on the
+    /// connection while they back up. Inline dispatch queues no jobs. Must
+    /// be called before `start()`.
+    void
+    setReadBackpressure(const bsl::shared_ptr<ReadBackpressure>& backpressure);
+
+    /// Consume on `sharedChannel`, which must hold the channel and ack queue
+    /// this consumer was created with, alongside the other consumers on it.
+    /// `cancel` and `drain` then act on this consumer alone, and the channel
+    /// closes once its last consumer is destroyed. Must be called before
+    /// `start()`.
+    void
+    shareChannel(const bsl::shared_ptr<SharedReceiveChannel>& sharedChannel);
+
     rmqt::Result<> start();
 
     /// Cancels the consumer, stops new messages flowing in
@@ -94,6 +294,14 @@ class ConsumerImpl : public rmqp::Consumer,
     rmqt::Future<> updateTopologyAsync(
         const rmqt::TopologyUpdate& topologyUpdate) BSLS_KEYWORD_OVERRIDE;
 
+    /// On a shared channel only this consumer's deliveries are nacked, as
+    /// multiple nacks of their contiguous runs
+    rmqt::Future<> nackAllOutstanding(bool requeue) BSLS_KEYWORD_OVERRIDE;
+
+    /// On a shared channel only this consumer's deliveries are acked
+    rmqt::Future<>
+    ackThrough(const rmqt::Envelope& envelope) BSLS_KEYWORD_OVERRIDE;
+
   private:
     ConsumerImpl(const ConsumerImpl&) BSLS_KEYWORD_DELETED;
     ConsumerImpl& operator=(const ConsumerImpl&) BSLS_KEYWORD_DELETED;
@@ -105,17 +313,141 @@ class ConsumerImpl : public rmqp::Consumer,
     static void
     handleMessage(const bsl::weak_ptr<ConsumerImpl>& consumerWeakPtr,
                   bdlmt::ThreadPool& threadPool,
+                  const bsl::shared_ptr<ReadBackpressure>& backpressure,
+                  const rmqt::Message& message,
+                  const rmqt::Envelope& envelope);
+
+    /// Called from the event loop thread with a received message in ordered
+    /// dispatch mode
+    static void
+    handleOrderedMessage(const bsl::weak_ptr<ConsumerImpl>& consumerWeakPtr,
+                         const bsl::shared_ptr<SerialExecutor>& executor,
+                         const bsl::shared_ptr<ReadBackpressure>& backpressure,
+                         const rmqt::Message& message,
+                         const rmqt::Envelope& envelope);
+
+    /// Called from the event loop thread with a received message in
+    /// priority dispatch mode: queues it in `queue`, and a threadpool job to
+    /// deliver the most urgent message waiting there
+    static void
+    handlePriorityMessage(const bsl::weak_ptr<ConsumerImpl>& consumerWeakPtr,
+                          bdlmt::ThreadPool& threadPool,
+                          const bsl::shared_ptr<PriorityDispatchQueue>& queue,
+                          const bsl::shared_ptr<ReadBackpressure>& backpressure,
+                          const rmqt::Message& message,
+                          const rmqt::Envelope& envelope);
+
+    static void threadPoolHandlePriorityMessage(
+        const bsl::weak_ptr<ConsumerImpl>& consumerWeakPtr,
+        const bsl::shared_ptr<PriorityDispatchQueue>& queue,
+        bsls::Types::Int64 dispatchedAt);
+
+    /// Called from the event loop thread with a received message in
+    /// work-stealing dispatch mode
+    static void handleWorkStealingMessage(
+        const bsl::weak_ptr<ConsumerImpl>& consumerWeakPtr,
+        const bsl::shared_ptr<WorkStealingExecutor>& executor,
+        const bsl::shared_ptr<WorkStealingExecutor::Lane>& lane,
+        const bsl::shared_ptr<ReadBackpressure>& backpressure,
+        const rmqt::Message& message,
+        const rmqt::Envelope& envelope);
+
+    /// Called from the event loop thread with a received message in
+    /// partitioned dispatch mode: hands it to the ordered lane its key
+    /// hashes to
+    static void
+    handlePartitionedMessage(const bsl::weak_ptr<ConsumerImpl>& consumerWeakPtr,
+                             const rmqt::Message& message,
+                             const rmqt::Envelope& envelope);
+
+    /// Return `job` counted against `backpressure` (if set) as carrying
+    /// `bytes` message bytes, until it has run
+    static bsl::function<void()>
+    countedJob(const bsl::function<void()>& job,
+               const bsl::shared_ptr<ReadBackpressure>& backpressure,
+               bsl::size_t bytes);
+
+    static void
+    runCountedJob(const bsl::function<void()>& job,
+                  const bsl::shared_ptr<ReadBackpressure>& backpressure,
+                  bsl::size_t bytes);
+
+    /// Called from the event loop thread with a received message: passes it
+    /// on to `onMessage` if `preFilter` accepts it, otherwise settles it
+    /// with `settleAs`
+    static void
+    filterMessage(const bsl::weak_ptr<ConsumerImpl>& consumerWeakPtr,
+                  const rmqt::ConsumerConfig::PreFilterFunc& preFilter,
+                  rmqt::ConsumerAck::Type settleAs,
+                  const rmqamqp::ReceiveChannel::MessageCallback& onMessage,
                   const rmqt::Message& message,
                   const rmqt::Envelope& envelope);
 
+    /// Called from the event loop thread with a received message in inline
+    /// dispatch mode. Runs the callback there and records how long it took.
+    static void
+    handleInlineMessage(const bsl::weak_ptr<ConsumerImpl>& consumerWeakPtr,
+                        const rmqt::Message& message,
+                        const rmqt::Envelope& envelope);
+
+    /// Publish how long an inline callback held up the event loop, warning
+    /// if it was long enough to delay heartbeats and other consumers
+    void recordInlineCallbackTime(bsls::Types::Int64 startNanos);
+
+    /// Deliver `message` to the callback. `dispatchedAt` is when it was
+    /// queued for this thread, a `rmqio::PipelineClock::now()` timestamp,
+    /// or zero if it was not queued or is untimed.
     static void
     threadPoolHandleMessage(const bsl::weak_ptr<ConsumerImpl>& consumer,
                             const rmqt::Message& message,
-                            const rmqt::Envelope& envelope);
+                            const rmqt::Envelope& envelope,
+                            bsls::Types::Int64 dispatchedAt);
+
+    /// Record how long the ack batch queued at `queuedAt` waited for the
+    /// event loop, then consume it
+    static void consumeTimedAckBatch(
+        const bsl::shared_ptr<rmqamqp::ReceiveChannel>& channel,
+        bsls::Types::Int64 queuedAt);
+
+    /// Return `message`, decompressed if it was compressed with one of
+    /// `d_messageCodecs`
+    rmqt::Message decompressed(const rmqt::Message& message) const;
+
+    typedef bsl::vector<bslma::ManagedPtr<rmqa::MessageGuard> > Guards;
+
+    /// Append a guard for `message`, decompressed, to `guards`. A batch
+    /// container (see `MessageBatchUtil`) gets a guard per message packed
+    /// in it, and is acked once they all are, or requeued (or rejected) as
+    /// a whole if any of them is.
+    void createGuards(Guards* guards,
+                      const rmqt::Message& message,
+                      const rmqt::Envelope& envelope);
 
     static void messageGuardCb(const bsl::weak_ptr<ConsumerImpl>& consumerPtr,
                                const rmqt::ConsumerAck& ack);
 
+    typedef bsl::vector<bsl::pair<rmqt::Message, rmqt::Envelope> > Batch;
+
+    /// Called from the event loop thread with a received message when
+    /// batching: adds it to the pending batch
+    static void
+    handleBatchMessage(const bsl::weak_ptr<ConsumerImpl>& consumerWeakPtr,
+                       const rmqt::Message& message,
+                       const rmqt::Envelope& envelope);
+
+    static void flushBatchCb(const bsl::weak_ptr<ConsumerImpl>& consumerPtr);
+
+    static void onLingerTimer(const bsl::weak_ptr<ConsumerImpl>& consumerPtr,
+                              rmqio::Timer::InterruptReason reason);
+
+    static void
+    threadPoolHandleBatch(const bsl::weak_ptr<ConsumerImpl>& consumerWeakPtr,
+                          const bsl::shared_ptr<Batch>& batch);
+
+    /// Hand the pending batch, if any, to the threadpool. Event loop thread
+    /// only.
+    void flushBatch();
+
   private:
     bsl::string d_consumerTag;
     rmqt::QueueHandle d_queue;
@@ -123,14 +455,69 @@ class ConsumerImpl : public rmqp::Consumer,
     bdlmt::ThreadPool& d_threadPool;
     rmqio::EventLoop& d_eventLoop;
     bsl::shared_ptr<rmqt::ConsumerAckQueue> d_ackQueue;
-    bsl::shared_ptr<rmqt::ConsumerAckBatch> d_ackBatch;
-    bslmt::Mutex d_ackMessageMutex;
 
     bsl::shared_ptr<rmqamqp::ReceiveChannel> d_channel;
     bsl::shared_ptr<MessageGuard::Factory> d_guardFactory;
 
+    /// Guards, and the vectors holding them, are allocated and freed on
+    /// every delivery, so they are recycled through a pool. Guards never
+    /// outlive a dispatch, which holds a reference to this consumer.
+    bdlma::ConcurrentMultipoolAllocator d_guardAllocator;
+
     bsl::function<void()> d_onNewAckBatch;
     bsl::function<void(const rmqt::ConsumerAck&)> d_messageGuardCb;
+
+    // Batch delivery, see `setBatchConsumer`. `d_batch` and `d_lingerTimer`
+    // are only accessed from the event loop thread.
+    bsl::shared_ptr<BatchConsumerFunc> d_onBatch;
+    bsl::size_t d_maxBatchSize;
+    bsls::TimeInterval d_maxBatchLinger;
+    bsl::shared_ptr<Batch> d_batch;
+    bsl::shared_ptr<rmqio::Timer> d_lingerTimer;
+
+    /// Set in ordered dispatch mode, see `setOrderedDispatch`
+    bsl::shared_ptr<SerialExecutor> d_serialExecutor;
+
+    /// Set in partitioned dispatch mode, see `setPartitionedDispatch`. The
+    /// first lane is also `d_serialExecutor`, which batches go to.
+    bsl::vector<bsl::shared_ptr<SerialExecutor> > d_partitions;
+    rmqt::ConsumerConfig::PartitionKeyFunc d_partitionKey;
+
+    /// Set in inline dispatch mode, see `setInlineDispatch`
+    bool d_inlineDispatch;
+
+    /// Set in priority dispatch mode, see `setPriorityDispatch`
+    bsl::shared_ptr<PriorityDispatchQueue> d_priorityQueue;
+
+    /// Set in work-stealing dispatch mode, see `setWorkStealingDispatch`
+    bsl::shared_ptr<WorkStealingExecutor> d_workStealingExecutor;
+    bsl::shared_ptr<WorkStealingExecutor::Lane> d_workStealingLane;
+
+    /// See `setNoAck`
+    bool d_noAck;
+
+    /// See `setPreFilter`
+    rmqt::ConsumerConfig::PreFilterFunc d_preFilter;
+    bool d_rejectFiltered;
+
+    /// See `setStaleMessagePolicy`
+    rmqt::StaleMessagePolicy::Value d_staleMessagePolicy;
+    bsl::string d_deadlineHeader;
+
+    /// See `setRedeliveryFilter`
+    bsl::shared_ptr<RedeliveryFilter> d_redeliveryFilter;
+
+    /// See `setDeliveryLatencyMetric`
+    bool d_deliveryLatencyMetric;
+
+    /// See `setMessageCodecs`
+    MessageCodecUtil::Codecs d_messageCodecs;
+
+    /// See `setReadBackpressure`
+    bsl::shared_ptr<ReadBackpressure> d_readBackpressure;
+
+    /// See `shareChannel`
+    bsl::shared_ptr<SharedReceiveChannel> d_sharedChannel;
 }; // class ConsumerImpl
 
 } // namespace rmqa
@@ -0,0 +1,73 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_coroutineutil.h>
+
+#include <rmqp_producer.h>
+
+#include <bdlf_bind.h>
+#include <bdlf_placeholder.h>
+
+#include <bsl_memory.h>
+#include <bsl_sstream.h>
+
+namespace BloombergLP {
+namespace rmqa {
+namespace {
+
+void resolveWithConfirm(
+    const rmqt::Future<rmqt::ConfirmResponse>::Maker& maker,
+    const rmqt::Message&,
+    const bsl::string&,
+    const rmqt::ConfirmResponse& response)
+{
+    maker(rmqt::Result<rmqt::ConfirmResponse>(
+        bsl::make_shared<rmqt::ConfirmResponse>(response)));
+}
+
+} // namespace
+
+rmqt::Future<rmqt::ConfirmResponse>
+CoroutineUtil::confirmation(Producer& producer,
+                            const rmqt::Message& message,
+                            const bsl::string& routingKey,
+                            const bsls::TimeInterval& timeout)
+{
+    rmqt::Future<rmqt::ConfirmResponse>::Pair confirm =
+        rmqt::Future<rmqt::ConfirmResponse>::make();
+
+    const rmqp::Producer::SendStatus status =
+        producer.send(message,
+                      routingKey,
+                      bdlf::BindUtil::bind(&resolveWithConfirm,
+                                           confirm.first,
+                                           bdlf::PlaceHolders::_1,
+                                           bdlf::PlaceHolders::_2,
+                                           bdlf::PlaceHolders::_3),
+                      timeout);
+
+    if (status != rmqp::Producer::SENDING) {
+        bsl::ostringstream error;
+        error << "Message " << message.guid()
+              << " was not accepted for sending, status: " << status;
+        confirm.first(
+            rmqt::Result<rmqt::ConfirmResponse>(error.str(), status));
+    }
+
+    return confirm.second;
+}
+
+} // namespace rmqa
+} // namespace BloombergLP
@@ -0,0 +1,108 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQA_COROUTINEUTIL
+#define INCLUDED_RMQA_COROUTINEUTIL
+
+#include <rmqa_producer.h>
+#include <rmqa_vhost.h>
+#include <rmqt_awaitable.h>
+#include <rmqt_confirmresponse.h>
+#include <rmqt_future.h>
+#include <rmqt_message.h>
+
+#include <bsls_timeinterval.h>
+
+#include <bsl_string.h>
+
+//@PURPOSE: Publish and create producers/consumers from C++20 coroutines
+//
+//@CLASSES:
+//  rmqa::CoroutineUtil: Future and awaitable forms of Producer::send and the
+//  asynchronous VHost factory methods
+//
+// `confirmation` is available at every language level. The awaitables need
+// C++20 coroutines (see `RMQT_AWAITABLE_SUPPORTED`), and the VHost ones also
+// `USES_LIBRMQ_EXPERIMENTAL_FEATURES`, like the methods they wrap.
+
+namespace BloombergLP {
+namespace rmqa {
+
+struct CoroutineUtil {
+    /// Send `message` with `producer` and return a Future resolved with the
+    /// broker's confirm response. If the message is not accepted for sending
+    /// the Future resolves straight away with an error whose return code is
+    /// the `rmqp::Producer::SendStatus`. `send` still waits up to `timeout`
+    /// (forever if 0) for room under the unconfirmed message limit, so keep
+    /// `timeout` short when calling from a coroutine.
+    static rmqt::Future<rmqt::ConfirmResponse>
+    confirmation(Producer& producer,
+                 const rmqt::Message& message,
+                 const bsl::string& routingKey,
+                 const bsls::TimeInterval& timeout = bsls::TimeInterval());
+
+#ifdef RMQT_AWAITABLE_SUPPORTED
+    typedef rmqt::Awaitable<rmqt::ConfirmResponse>::Executor Executor;
+
+    /// `co_await` the confirm for `message`, see `confirmation`. The
+    /// coroutine resumes through `executor`, or on the event loop thread
+    /// receiving the confirm if it is empty.
+    static rmqt::Awaitable<rmqt::ConfirmResponse>
+    send(Producer& producer,
+         const rmqt::Message& message,
+         const bsl::string& routingKey,
+         const Executor& executor = Executor(),
+         const bsls::TimeInterval& timeout = bsls::TimeInterval())
+    {
+        return rmqt::Awaitable<rmqt::ConfirmResponse>(
+            confirmation(producer, message, routingKey, timeout), executor);
+    }
+
+#ifdef USES_LIBRMQ_EXPERIMENTAL_FEATURES
+    /// `co_await` `VHost::createProducerAsync`
+    static rmqt::Awaitable<Producer>
+    createProducer(VHost& vhost,
+                   const rmqp::Topology& topology,
+                   rmqt::ExchangeHandle exchange,
+                   uint16_t maxOutstandingConfirms,
+                   const Executor& executor = Executor())
+    {
+        return rmqt::Awaitable<Producer>(
+            vhost.createProducerAsync(
+                topology, exchange, maxOutstandingConfirms),
+            executor);
+    }
+
+    /// `co_await` `VHost::createConsumerAsync`
+    static rmqt::Awaitable<Consumer>
+    createConsumer(VHost& vhost,
+                   const rmqp::Topology& topology,
+                   rmqt::QueueHandle queue,
+                   const rmqp::Consumer::ConsumerFunc& onMessage,
+                   const rmqt::ConsumerConfig& config = rmqt::ConsumerConfig(),
+                   const Executor& executor = Executor())
+    {
+        return rmqt::Awaitable<Consumer>(
+            vhost.createConsumerAsync(topology, queue, onMessage, config),
+            executor);
+    }
+#endif
+#endif
+};
+
+} // namespace rmqa
+} // namespace BloombergLP
+
+#endif
@@ -0,0 +1,200 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_executorscaler.h>
+
+#include <ball_log.h>
+#include <bsls_platform.h>
+
+#include <bsl_algorithm.h>
+#include <bsl_cmath.h>
+
+#ifdef BSLS_PLATFORM_OS_UNIX
+#include <unistd.h>
+#endif
+
+namespace BloombergLP {
+namespace rmqa {
+namespace {
+BALL_LOG_SET_NAMESPACE_CATEGORY("RMQA.EXECUTORSCALER")
+
+/// Below this share of CPU time handlers are treated as not CPU-bound at
+/// all, which avoids a huge ceiling from a noisy near-zero share
+const double k_MIN_CPU_SHARE = 0.05;
+
+const char* reasonName(ExecutorScaler::Reason reason)
+{
+    switch (reason) {
+        case ExecutorScaler::BACKLOG:
+            return "backlog";
+        case ExecutorScaler::CPU_BOUND:
+            return "cpu_bound";
+        case ExecutorScaler::IDLE:
+            return "idle";
+        case ExecutorScaler::NONE:
+            break;
+    }
+    return "none";
+}
+
+} // namespace
+
+const bsl::size_t ExecutorScaler::k_IDLE_RUNS;
+
+ExecutorScaler::ExecutorScaler(
+    const bsl::shared_ptr<WorkStealingExecutor>& executor,
+    bsl::size_t minWorkers,
+    bsl::size_t maxWorkers,
+    bsl::size_t cpus,
+    const bsl::shared_ptr<rmqp::MetricPublisher>& metricPublisher)
+: d_executor(executor)
+, d_minWorkers(bsl::max(minWorkers, bsl::size_t(1)))
+, d_maxWorkers(bsl::max(maxWorkers, bsl::max(minWorkers, bsl::size_t(1))))
+, d_cpus(cpus ? cpus : onlineCpus())
+, d_metricPublisher(metricPublisher)
+, d_last(executor->stats())
+, d_idleRuns(0)
+, d_cpuShare(-1)
+{
+}
+
+bsl::size_t ExecutorScaler::decide(Reason* reason,
+                                   bsl::size_t* idleRuns,
+                                   const Sample& sample,
+                                   bsl::size_t minWorkers,
+                                   bsl::size_t maxWorkers,
+                                   bsl::size_t cpus)
+{
+    *reason = NONE;
+
+    bsl::size_t ceiling = maxWorkers;
+    if (cpus > 0 && sample.cpuShare > k_MIN_CPU_SHARE) {
+        ceiling = bsl::min(maxWorkers,
+                           static_cast<bsl::size_t>(bsl::ceil(
+                               static_cast<double>(cpus) / sample.cpuShare)));
+    }
+    ceiling = bsl::max(ceiling, minWorkers);
+
+    const bsl::size_t workers = sample.workers;
+    if (workers > ceiling) {
+        *idleRuns = 0;
+        *reason   = CPU_BOUND;
+        return ceiling;
+    }
+
+    if (sample.queuedJobs > 0 && sample.busyWorkers >= workers) {
+        *idleRuns = 0;
+        const bsl::size_t target =
+            bsl::min(ceiling, workers + bsl::min(sample.queuedJobs, workers));
+        if (target > workers) {
+            *reason = BACKLOG;
+        }
+        return bsl::max(target, workers);
+    }
+
+    if (sample.queuedJobs == 0 && sample.busyWorkers < workers) {
+        if (++*idleRuns >= k_IDLE_RUNS && workers > minWorkers) {
+            *idleRuns = 0;
+            *reason   = IDLE;
+            return workers - 1;
+        }
+        return workers;
+    }
+
+    *idleRuns = 0;
+    return workers;
+}
+
+bsl::size_t ExecutorScaler::onlineCpus()
+{
+#ifdef BSLS_PLATFORM_OS_UNIX
+    const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? static_cast<bsl::size_t>(cpus) : 0;
+#else
+    return 0;
+#endif
+}
+
+void ExecutorScaler::run()
+{
+    const WorkStealingExecutor::Stats stats = d_executor->stats();
+
+    const bsls::Types::Int64 runNanoseconds =
+        stats.runNanoseconds - d_last.runNanoseconds;
+    const bsls::Types::Int64 cpuNanoseconds =
+        stats.cpuNanoseconds - d_last.cpuNanoseconds;
+    const bsls::Types::Int64 jobsRun = stats.jobsRun - d_last.jobsRun;
+    if (runNanoseconds > 0 && cpuNanoseconds > 0) {
+        // Kept from earlier runs while idle
+        d_cpuShare = bsl::min(1.0,
+                              static_cast<double>(cpuNanoseconds) /
+                                  static_cast<double>(runNanoseconds));
+    }
+
+    Sample sample;
+    sample.workers     = stats.workers;
+    sample.busyWorkers = stats.busyWorkers;
+    sample.queuedJobs =
+        static_cast<bsl::size_t>(bsl::max<bsls::Types::Int64>(
+            stats.queuedJobs, 0));
+    sample.jobsRun  = static_cast<bsl::size_t>(jobsRun);
+    sample.cpuShare = d_cpuShare;
+
+    Reason reason            = NONE;
+    const bsl::size_t target = decide(
+        &reason, &d_idleRuns, sample, d_minWorkers, d_maxWorkers, d_cpus);
+
+    if (target != stats.workers) {
+        BALL_LOG_DEBUG << "Resizing work-stealing executor from "
+                       << stats.workers << " to " << target << " workers ("
+                       << reasonName(reason) << ")";
+        if (d_executor->resize(target)) {
+            BALL_LOG_WARN << "Couldn't start all " << target
+                          << " work-stealing workers";
+        }
+
+        bsl::vector<bsl::pair<bsl::string, bsl::string> > tags;
+        tags.push_back(bsl::make_pair(
+            bsl::string("direction"),
+            bsl::string(target > stats.workers ? "grow" : "shrink")));
+        tags.push_back(bsl::make_pair(bsl::string("reason"),
+                                      bsl::string(reasonName(reason))));
+        d_metricPublisher->publishCounter(
+            "executor_scaling_decisions", 1, tags);
+    }
+
+    publish("executor_workers", static_cast<double>(target));
+    publish("executor_busy_workers", static_cast<double>(stats.busyWorkers));
+    publish("executor_queued_jobs", static_cast<double>(sample.queuedJobs));
+    if (jobsRun > 0) {
+        publish("executor_handler_ns",
+                static_cast<double>(runNanoseconds) /
+                    static_cast<double>(jobsRun));
+    }
+    if (d_cpuShare >= 0) {
+        publish("executor_cpu_share", d_cpuShare);
+    }
+
+    d_last = stats;
+}
+
+void ExecutorScaler::publish(const bsl::string& name, double value)
+{
+    d_metricPublisher->publishGauge(
+        name, value, bsl::vector<bsl::pair<bsl::string, bsl::string> >());
+}
+
+} // namespace rmqa
+} // namespace BloombergLP
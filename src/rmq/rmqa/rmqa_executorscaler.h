@@ -0,0 +1,114 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQA_EXECUTORSCALER
+#define INCLUDED_RMQA_EXECUTORSCALER
+
+#include <rmqa_workstealingexecutor.h>
+
+#include <rmqio_task.h>
+#include <rmqp_metricpublisher.h>
+
+#include <bsls_keyword.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_memory.h>
+#include <bsl_string.h>
+#include <bsl_utility.h>
+#include <bsl_vector.h>
+
+//@PURPOSE: Size a work-stealing executor to its backlog and handler load
+//
+//@CLASSES:
+//  rmqa::ExecutorScaler: resizes an executor each time it is run
+
+namespace BloombergLP {
+namespace rmqa {
+
+/// \brief Grows and shrinks the workers of a `WorkStealingExecutor`
+///
+/// Each time it is run, e.g. by a `rmqio::WatchDog`, it compares the
+/// executor's activity with the last run:
+/// - Jobs queued while every worker was busy add workers, up to double.
+/// - Workers are capped at the CPUs divided by the share of handler time
+///   spent on CPU, so handlers waiting on I/O get more concurrency and
+///   CPU-bound handlers do not oversubscribe the host.
+/// - Idle workers are removed one at a time, after a few idle runs.
+/// Within `minWorkers` and `maxWorkers` throughout. Each run publishes the
+/// worker count, backlog, handler time and CPU share as gauges, and every
+/// change as an `executor_scaling_decisions` counter tagged with its
+/// direction and reason.
+
+class ExecutorScaler : public rmqio::Task {
+  public:
+    /// Activity between two runs
+    struct Sample {
+        bsl::size_t workers;
+        bsl::size_t busyWorkers;
+        bsl::size_t queuedJobs;
+        bsl::size_t jobsRun;
+        /// Share of handler time spent on CPU, 0 to 1, or negative if not
+        /// measured
+        double cpuShare;
+    };
+
+    /// Why `decide` changed the number of workers
+    enum Reason { NONE, BACKLOG, CPU_BOUND, IDLE };
+
+    /// Runs which must find idle workers before one is removed
+    static const bsl::size_t k_IDLE_RUNS = 3;
+
+    /// \param cpus CPUs available to the workers, zero to detect them
+    ExecutorScaler(
+        const bsl::shared_ptr<WorkStealingExecutor>& executor,
+        bsl::size_t minWorkers,
+        bsl::size_t maxWorkers,
+        bsl::size_t cpus,
+        const bsl::shared_ptr<rmqp::MetricPublisher>& metricPublisher);
+
+    void run() BSLS_KEYWORD_OVERRIDE;
+
+    /// Return the workers wanted after `sample`, loading why into `reason`.
+    /// `idleRuns` counts consecutive runs with idle workers, and is updated.
+    static bsl::size_t decide(Reason* reason,
+                              bsl::size_t* idleRuns,
+                              const Sample& sample,
+                              bsl::size_t minWorkers,
+                              bsl::size_t maxWorkers,
+                              bsl::size_t cpus);
+
+    /// Return the CPUs online, or zero if unknown
+    static bsl::size_t onlineCpus();
+
+  private:
+    ExecutorScaler(const ExecutorScaler&) BSLS_KEYWORD_DELETED;
+    ExecutorScaler& operator=(const ExecutorScaler&) BSLS_KEYWORD_DELETED;
+
+    void publish(const bsl::string& name, double value);
+
+    bsl::shared_ptr<WorkStealingExecutor> d_executor;
+    const bsl::size_t d_minWorkers;
+    const bsl::size_t d_maxWorkers;
+    const bsl::size_t d_cpus;
+    bsl::shared_ptr<rmqp::MetricPublisher> d_metricPublisher;
+    WorkStealingExecutor::Stats d_last;
+    bsl::size_t d_idleRuns;
+    double d_cpuShare;
+}; // class ExecutorScaler
+
+} // namespace rmqa
+} // namespace BloombergLP
+
+#endif
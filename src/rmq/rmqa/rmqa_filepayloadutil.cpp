@@ -0,0 +1,151 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_filepayloadutil.h>
+
+#include <ball_log.h>
+#include <bsls_platform.h>
+
+#include <bsl_memory.h>
+
+#ifdef BSLS_PLATFORM_OS_UNIX
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace BloombergLP {
+namespace rmqa {
+namespace {
+
+BALL_LOG_SET_NAMESPACE_CATEGORY("RMQA.FILEPAYLOADUTIL")
+
+#ifdef BSLS_PLATFORM_OS_UNIX
+/// Unmaps a file range once the last message referring to it is gone
+class Unmapper {
+  public:
+    explicit Unmapper(bsl::size_t size)
+    : d_size(size)
+    {
+    }
+
+    void operator()(void* base) const { munmap(base, d_size); }
+
+  private:
+    bsl::size_t d_size;
+};
+#endif
+
+} // namespace
+
+int FilePayloadUtil::makeMessage(rmqt::Message* message,
+                                 int fd,
+                                 bsl::uint64_t offset,
+                                 bsl::size_t length,
+                                 const rmqt::Properties& properties)
+{
+#ifdef BSLS_PLATFORM_OS_UNIX
+    struct stat status;
+    if (fstat(fd, &status) != 0) {
+        BALL_LOG_ERROR << "Cannot stat payload file: errno " << errno;
+        return -1;
+    }
+    const bsl::uint64_t fileSize = static_cast<bsl::uint64_t>(status.st_size);
+    if (offset > fileSize || length > fileSize - offset) {
+        // Touching a mapping beyond the end of the file raises SIGBUS
+        BALL_LOG_ERROR << "Payload range of " << length << " bytes from "
+                       << offset << " is beyond the end of the file ("
+                       << fileSize << " bytes)";
+        return -1;
+    }
+
+    if (length == 0) {
+        *message = rmqt::Message(0, 0, properties);
+        return 0;
+    }
+
+    // Mappings start on a page boundary
+    const bsl::uint64_t pageSize  = sysconf(_SC_PAGESIZE);
+    const bsl::uint64_t mapOffset = offset - offset % pageSize;
+    const bsl::size_t lead = static_cast<bsl::size_t>(offset - mapOffset);
+
+    void* base = mmap(0,
+                      lead + length,
+                      PROT_READ,
+                      MAP_SHARED,
+                      fd,
+                      static_cast<off_t>(mapOffset));
+    if (base == MAP_FAILED) {
+        BALL_LOG_ERROR << "Cannot map " << length
+                       << " byte payload: errno " << errno;
+        return -1;
+    }
+
+    // It is read once, front to back, as it is framed
+    madvise(base, lead + length, MADV_SEQUENTIAL);
+
+    const bsl::shared_ptr<const void> owner(base, Unmapper(lead + length));
+    *message = rmqt::Message(static_cast<const bsl::uint8_t*>(base) + lead,
+                             length,
+                             owner,
+                             properties);
+    return 0;
+#else
+    (void)message;
+    (void)fd;
+    (void)offset;
+    (void)length;
+    (void)properties;
+    BALL_LOG_ERROR << "File payloads are not supported on this platform";
+    return -1;
+#endif
+}
+
+int FilePayloadUtil::makeMessage(rmqt::Message* message,
+                                 const bsl::string& path,
+                                 const rmqt::Properties& properties)
+{
+#ifdef BSLS_PLATFORM_OS_UNIX
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        BALL_LOG_ERROR << "Cannot open payload file '" << path
+                       << "': errno " << errno;
+        return -1;
+    }
+
+    struct stat status;
+    int rc = fstat(fd, &status);
+    if (rc == 0) {
+        rc = makeMessage(message,
+                         fd,
+                         0,
+                         static_cast<bsl::size_t>(status.st_size),
+                         properties);
+    }
+    close(fd);
+    return rc;
+#else
+    (void)message;
+    (void)path;
+    (void)properties;
+    BALL_LOG_ERROR << "File payloads are not supported on this platform";
+    return -1;
+#endif
+}
+
+} // namespace rmqa
+} // namespace BloombergLP
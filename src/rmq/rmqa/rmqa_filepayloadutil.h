@@ -0,0 +1,64 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQA_FILEPAYLOADUTIL
+#define INCLUDED_RMQA_FILEPAYLOADUTIL
+
+#include <rmqt_message.h>
+#include <rmqt_properties.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_cstdint.h>
+#include <bsl_string.h>
+
+//@PURPOSE: Publish messages whose payloads are ranges of files
+//
+//@CLASSES:
+//  rmqa::FilePayloadUtil: makes messages referencing memory mapped files
+
+namespace BloombergLP {
+namespace rmqa {
+
+/// Makes messages whose payload is a range of a file mapped into memory,
+/// rather than read into a buffer. Such a message is framed for publishing
+/// without being copied (see the `rmqt::Message` constructor taking an
+/// owner), so its pages are read from the page cache straight into the
+/// socket's writes, or into TLS encryption. The mapping is released once
+/// every copy of the message is gone, including the producer's until the
+/// message is confirmed. The file must not be truncated, nor the range
+/// changed, while the message is referenced.
+struct FilePayloadUtil {
+    /// Make `*message` with the `length` bytes of the open file `fd` from
+    /// `offset` as its payload, and `properties`. `fd` may be closed
+    /// afterwards. Return 0 on success, and a non-zero value, leaving
+    /// `*message` untouched, if the range is not within the file or cannot
+    /// be mapped.
+    static int makeMessage(rmqt::Message* message,
+                           int fd,
+                           bsl::uint64_t offset,
+                           bsl::size_t length,
+                           const rmqt::Properties& properties);
+
+    /// Make `*message` with the whole file at `path` as its payload. Return
+    /// 0 on success, and a non-zero value otherwise.
+    static int makeMessage(rmqt::Message* message,
+                           const bsl::string& path,
+                           const rmqt::Properties& properties);
+};
+
+} // namespace rmqa
+} // namespace BloombergLP
+
+#endif
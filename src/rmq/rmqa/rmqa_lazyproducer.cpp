@@ -0,0 +1,419 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_lazyproducer.h>
+
+#include <rmqio_eventloop.h>
+#include <rmqt_confirmresponse.h>
+
+#include <ball_log.h>
+#include <bdlf_bind.h>
+#include <bslmt_lockguard.h>
+#include <bsls_types.h>
+
+namespace BloombergLP {
+namespace rmqa {
+namespace {
+
+BALL_LOG_SET_NAMESPACE_CATEGORY("RMQA.LAZYPRODUCER")
+
+typedef LazyProducer::SharedState SharedState;
+
+void confirmOne(const bsl::weak_ptr<SharedState>& weakState,
+                const rmqp::Producer::ConfirmationCallback& confirmCallback,
+                const rmqt::Message& message,
+                const bsl::string& routingKey,
+                const rmqt::ConfirmResponse& confirmResponse)
+{
+    bsl::shared_ptr<SharedState> state = weakState.lock();
+    if (state) {
+        --state->unconfirmed;
+    }
+    if (confirmCallback) {
+        confirmCallback(message, routingKey, confirmResponse);
+    }
+}
+
+/// Start the idle timer, if the producer closes when idle
+void armTimer(SharedState& state)
+{
+    if (!state.timer) {
+        return;
+    }
+    state.eventLoop.post(bdlf::BindUtil::bind(
+        &rmqio::Timer::reset, state.timer, state.idleClose));
+}
+
+/// Hand the open producer the settings given so far, and replay the
+/// topology updates. The lock must be held
+void install(SharedState& state,
+             const bsl::shared_ptr<rmqp::Producer>& producer)
+{
+    state.producer = producer;
+    state.opening.reset();
+
+    if (state.writableCallback) {
+        producer->setWritableCallback(state.writableCallback,
+                                      state.minimumCredits);
+    }
+    if (state.writeWeight) {
+        producer->setWriteWeight(state.writeWeight.value());
+    }
+
+    // Senders wait for the lock, so none publishes before the topology is
+    // back as it was
+    for (bsl::size_t i = 0; i < state.topologyUpdates.size(); ++i) {
+        rmqt::Result<> result =
+            producer->updateTopologyAsync(state.topologyUpdates[i])
+                .blockResult();
+        if (!result) {
+            BALL_LOG_ERROR << "Failed to replay topology update on reopened "
+                              "producer: "
+                           << result.error();
+        }
+    }
+
+    armTimer(state);
+}
+
+void closeIfIdle(const bsl::shared_ptr<SharedState>& state)
+{
+    bsl::shared_ptr<rmqp::Producer> closing;
+    {
+        bslmt::LockGuard<bslmt::Mutex> guard(&state->mutex);
+        if (!state->producer || state->sequenced) {
+            return;
+        }
+        if (state->used || state->unconfirmed > 0) {
+            state->used = false;
+            armTimer(*state);
+            return;
+        }
+        closing.swap(state->producer);
+    }
+
+    BALL_LOG_DEBUG << "Closing producer channel idle for "
+                   << state->idleClose;
+
+    // The channel closes as `closing` goes, outside of the lock
+}
+
+void onIdleTimer(const bsl::weak_ptr<SharedState>& weakState,
+                 rmqio::Timer::InterruptReason reason)
+{
+    bsl::shared_ptr<SharedState> state = weakState.lock();
+    if (reason != rmqio::Timer::EXPIRE || !state) {
+        return;
+    }
+
+    // Closing the producer may wait on it, so keep it off the event loop
+    int rc = state->threadPool.enqueueJob(
+        bdlf::BindUtil::bind(&closeIfIdle, state));
+    if (rc != 0) {
+        BALL_LOG_ERROR << "Couldn't enqueue thread pool job to close idle "
+                          "producer (return code "
+                       << rc << ")";
+    }
+}
+
+} // namespace
+
+LazyProducer::LazyProducer(const Opener& opener,
+                           bsl::size_t credits,
+                           bool confirms,
+                           const bsls::TimeInterval& idleClose,
+                           bdlmt::ThreadPool& threadPool,
+                           rmqio::EventLoop& eventLoop)
+: d_sharedState(new SharedState(
+      opener, credits, confirms, idleClose, threadPool, eventLoop))
+{
+    if (idleClose > bsls::TimeInterval()) {
+        d_sharedState->timer = eventLoop.timerFactory()->createWithCallback(
+            bdlf::BindUtil::bind(&onIdleTimer,
+                                 bsl::weak_ptr<SharedState>(d_sharedState),
+                                 bdlf::PlaceHolders::_1));
+    }
+}
+
+LazyProducer::~LazyProducer()
+{
+    if (d_sharedState->timer) {
+        d_sharedState->eventLoop.post(
+            bdlf::BindUtil::bind(&rmqio::Timer::cancel, d_sharedState->timer));
+    }
+}
+
+rmqt::Result<rmqp::Producer>
+LazyProducer::acquire(bsl::size_t messages,
+                      const bsls::TimeInterval& timeout,
+                      bool wait)
+{
+    SharedState& state = *d_sharedState;
+
+    rmqt::Future<rmqp::Producer> opening;
+    {
+        bslmt::LockGuard<bslmt::Mutex> guard(&state.mutex);
+        state.used = true;
+        if (state.producer) {
+            state.unconfirmed.addRelaxed(
+                static_cast<bsls::Types::Int64>(messages));
+            return rmqt::Result<rmqp::Producer>(state.producer);
+        }
+        if (!state.opening) {
+            BALL_LOG_DEBUG << "Opening producer channel";
+            state.opening = state.opener();
+        }
+        opening = state.opening.value();
+    }
+
+    rmqt::Result<rmqp::Producer> opened = opening.tryResult();
+    if (!opened && wait) {
+        opened = timeout.totalNanoseconds() == 0 ? opening.blockResult()
+                                                 : opening.waitResult(timeout);
+    }
+
+    bslmt::LockGuard<bslmt::Mutex> guard(&state.mutex);
+    if (!opened) {
+        if (opened.returnCode() != rmqt::TIMEOUT) {
+            BALL_LOG_ERROR << "Failed to open producer channel: "
+                           << opened.error();
+
+            // Let the next call try again
+            state.opening.reset();
+        }
+        return rmqt::Result<rmqp::Producer>(opened.error(), rmqt::TIMEOUT);
+    }
+
+    if (!state.producer) {
+        // Either the first to see it opened, or it was closed when idle
+        // since, while `opened` kept it alive
+        install(state, opened.value());
+    }
+    state.unconfirmed.addRelaxed(static_cast<bsls::Types::Int64>(messages));
+    return rmqt::Result<rmqp::Producer>(state.producer);
+}
+
+rmqp::Producer::ConfirmationCallback LazyProducer::wrap(
+    const rmqp::Producer::ConfirmationCallback& confirmCallback) const
+{
+    if (!d_sharedState->confirms) {
+        return confirmCallback;
+    }
+    return bdlf::BindUtil::bind(&confirmOne,
+                                bsl::weak_ptr<SharedState>(d_sharedState),
+                                confirmCallback,
+                                bdlf::PlaceHolders::_1,
+                                bdlf::PlaceHolders::_2,
+                                bdlf::PlaceHolders::_3);
+}
+
+void LazyProducer::release(bsl::size_t messages, bool awaitingConfirms)
+{
+    if (awaitingConfirms && d_sharedState->confirms) {
+        return;
+    }
+    d_sharedState->unconfirmed.addRelaxed(
+        -static_cast<bsls::Types::Int64>(messages));
+}
+
+rmqp::Producer::SendStatus LazyProducer::send(
+    const rmqt::Message& message,
+    const bsl::string& routingKey,
+    const rmqp::Producer::ConfirmationCallback& confirmCallback,
+    const bsls::TimeInterval& timeout)
+{
+    return send(message,
+                routingKey,
+                rmqt::Mandatory::RETURN_UNROUTABLE,
+                confirmCallback,
+                timeout);
+}
+
+rmqp::Producer::SendStatus LazyProducer::send(
+    const rmqt::Message& message,
+    const bsl::string& routingKey,
+    rmqt::Mandatory::Value mandatoryFlag,
+    const rmqp::Producer::ConfirmationCallback& confirmCallback,
+    const bsls::TimeInterval& timeout)
+{
+    rmqt::Result<rmqp::Producer> producer = acquire(1, timeout);
+    if (!producer) {
+        return TIMEOUT;
+    }
+
+    const SendStatus status = producer.value()->send(
+        message, routingKey, mandatoryFlag, wrap(confirmCallback), timeout);
+    release(1, status == SENDING);
+    return status;
+}
+
+rmqp::Producer::SendStatus LazyProducer::trySend(
+    const rmqt::Message& message,
+    const bsl::string& routingKey,
+    const rmqp::Producer::ConfirmationCallback& confirmCallback)
+{
+    rmqt::Result<rmqp::Producer> producer =
+        acquire(1, bsls::TimeInterval(), false);
+    if (!producer) {
+        return INFLIGHT_LIMIT;
+    }
+
+    const SendStatus status =
+        producer.value()->trySend(message, routingKey, wrap(confirmCallback));
+    release(1, status == SENDING);
+    return status;
+}
+
+void LazyProducer::setWritableCallback(
+    const rmqp::Producer::WritableCallback& callback,
+    bsl::size_t minimumCredits)
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_sharedState->mutex);
+    d_sharedState->writableCallback = callback;
+    d_sharedState->minimumCredits   = minimumCredits;
+    if (d_sharedState->producer) {
+        d_sharedState->producer->setWritableCallback(callback,
+                                                     minimumCredits);
+    }
+}
+
+bsl::size_t LazyProducer::availableCredits() const
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_sharedState->mutex);
+    if (d_sharedState->producer) {
+        return d_sharedState->producer->availableCredits();
+    }
+    return d_sharedState->credits;
+}
+
+void LazyProducer::setWriteWeight(unsigned weight)
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_sharedState->mutex);
+    d_sharedState->writeWeight = weight;
+    if (d_sharedState->producer) {
+        d_sharedState->producer->setWriteWeight(weight);
+    }
+}
+
+rmqp::Producer::SendStatus LazyProducer::sendBatch(
+    const bsl::vector<rmqt::Message>& messages,
+    const bsl::string& routingKey,
+    const rmqp::Producer::ConfirmationCallback& confirmCallback,
+    const bsls::TimeInterval& timeout)
+{
+    rmqt::Result<rmqp::Producer> producer = acquire(messages.size(), timeout);
+    if (!producer) {
+        return TIMEOUT;
+    }
+
+    const SendStatus status = producer.value()->sendBatch(
+        messages, routingKey, wrap(confirmCallback), timeout);
+    release(messages.size(), status == SENDING);
+    return status;
+}
+
+rmqt::Result<rmqp::MessageSink> LazyProducer::openStream(
+    const rmqt::Message& message,
+    bsl::size_t bodySize,
+    const bsl::string& routingKey,
+    const rmqp::Producer::ConfirmationCallback& confirmCallback,
+    const bsls::TimeInterval& timeout)
+{
+    rmqt::Result<rmqp::Producer> producer = acquire(1, timeout);
+    if (!producer) {
+        return rmqt::Result<rmqp::MessageSink>(producer.error(), TIMEOUT);
+    }
+
+    rmqt::Result<rmqp::MessageSink> sink = producer.value()->openStream(
+        message, bodySize, routingKey, wrap(confirmCallback), timeout);
+    release(1, static_cast<bool>(sink));
+    return sink;
+}
+
+rmqp::Producer::SendStatus
+LazyProducer::sendSequenced(const rmqt::Message& message,
+                            const bsl::string& routingKey,
+                            bsl::uint64_t* sequenceNumber,
+                            const bsls::TimeInterval& timeout)
+{
+    rmqt::Result<rmqp::Producer> producer = acquire(1, timeout);
+    if (!producer) {
+        return TIMEOUT;
+    }
+    {
+        bslmt::LockGuard<bslmt::Mutex> guard(&d_sharedState->mutex);
+        d_sharedState->sequenced = true;
+    }
+
+    const SendStatus status = producer.value()->sendSequenced(
+        message, routingKey, sequenceNumber, timeout);
+
+    // No callback uncounts it, but the producer now never closes
+    release(1, false);
+    return status;
+}
+
+bsl::uint64_t LazyProducer::confirmedThrough() const
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_sharedState->mutex);
+    return d_sharedState->producer
+               ? d_sharedState->producer->confirmedThrough()
+               : 0;
+}
+
+rmqp::Producer::FailedSequences LazyProducer::takeFailedSequences()
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_sharedState->mutex);
+    return d_sharedState->producer
+               ? d_sharedState->producer->takeFailedSequences()
+               : FailedSequences();
+}
+
+rmqt::Future<>
+LazyProducer::updateTopologyAsync(const rmqt::TopologyUpdate& topologyUpdate)
+{
+    bsl::shared_ptr<rmqp::Producer> producer;
+    {
+        bslmt::LockGuard<bslmt::Mutex> guard(&d_sharedState->mutex);
+        d_sharedState->topologyUpdates.push_back(topologyUpdate);
+        producer = d_sharedState->producer;
+    }
+    if (!producer) {
+        return rmqt::Future<>(rmqt::Result<>());
+    }
+    return producer->updateTopologyAsync(topologyUpdate);
+}
+
+rmqt::Result<> LazyProducer::waitForConfirms(const bsls::TimeInterval& timeout)
+{
+    bsl::shared_ptr<rmqp::Producer> producer;
+    {
+        bslmt::LockGuard<bslmt::Mutex> guard(&d_sharedState->mutex);
+        producer = d_sharedState->producer;
+    }
+    if (!producer) {
+        return rmqt::Result<>();
+    }
+    return producer->waitForConfirms(timeout);
+}
+
+bool LazyProducer::isOpen() const
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_sharedState->mutex);
+    return static_cast<bool>(d_sharedState->producer);
+}
+
+} // namespace rmqa
+} // namespace BloombergLP
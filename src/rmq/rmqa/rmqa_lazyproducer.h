@@ -0,0 +1,236 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQA_LAZYPRODUCER
+#define INCLUDED_RMQA_LAZYPRODUCER
+
+#include <rmqio_timer.h>
+#include <rmqp_messagesink.h>
+#include <rmqp_producer.h>
+#include <rmqt_future.h>
+#include <rmqt_message.h>
+#include <rmqt_result.h>
+#include <rmqt_topologyupdate.h>
+
+#include <bdlmt_threadpool.h>
+#include <bslmt_mutex.h>
+#include <bsls_atomic.h>
+#include <bsls_keyword.h>
+#include <bsls_timeinterval.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_functional.h>
+#include <bsl_memory.h>
+#include <bsl_optional.h>
+#include <bsl_string.h>
+#include <bsl_vector.h>
+
+//@PURPOSE: Open a producer's channel on first use and close it when idle
+//
+//@CLASSES:
+//  rmqa::LazyProducer: an rmqp::Producer opening the producer it wraps on
+//  demand
+
+namespace BloombergLP {
+namespace rmqio {
+class EventLoop;
+}
+namespace rmqa {
+
+/// \brief An rmqp::Producer which opens its channel only when it is used
+///
+/// Creating the producer does not touch the broker: its channel is opened,
+/// and its topology declared, by the first call which publishes. That call
+/// waits for the channel within its timeout. If `idleClose` is set, the
+/// channel is closed again once no message has been sent for that long and
+/// every sent message has been confirmed, and the next publishing call
+/// reopens it. Processes holding many rarely used producers then keep
+/// neither the channels nor the memory behind them.
+///
+/// Topology updates are replayed on every channel opened after them. The
+/// writable callback and write weight are handed to each channel opened.
+/// Sequence numbers are per channel, so a producer which has sent with
+/// `sendSequenced` is never closed when idle.
+
+class LazyProducer : public rmqp::Producer {
+  public:
+    // TYPES
+    /// Starts opening the wrapped producer
+    typedef bsl::function<rmqt::Future<rmqp::Producer>()> Opener;
+
+    // CREATORS
+    /// Open producers with `opener` as they are needed. `credits` is what
+    /// `availableCredits` returns while no producer is open: the limit the
+    /// opened producers are created with. `confirms` is false if they never
+    /// invoke confirm callbacks, as `UnconfirmedProducer`s. An `idleClose`
+    /// of 0 keeps the producer open once opened.
+    LazyProducer(const Opener& opener,
+                 bsl::size_t credits,
+                 bool confirms,
+                 const bsls::TimeInterval& idleClose,
+                 bdlmt::ThreadPool& threadPool,
+                 rmqio::EventLoop& eventLoop);
+
+    ~LazyProducer() BSLS_KEYWORD_OVERRIDE;
+
+    SendStatus send(const rmqt::Message& message,
+                    const bsl::string& routingKey,
+                    const rmqp::Producer::ConfirmationCallback& confirmCallback,
+                    const bsls::TimeInterval& timeout) BSLS_KEYWORD_OVERRIDE;
+
+    SendStatus send(const rmqt::Message& message,
+                    const bsl::string& routingKey,
+                    rmqt::Mandatory::Value mandatoryFlag,
+                    const rmqp::Producer::ConfirmationCallback& confirmCallback,
+                    const bsls::TimeInterval& timeout) BSLS_KEYWORD_OVERRIDE;
+
+    /// Returns INFLIGHT_LIMIT without sending while the producer is not
+    /// open, after starting to open it
+    SendStatus
+    trySend(const rmqt::Message& message,
+            const bsl::string& routingKey,
+            const rmqp::Producer::ConfirmationCallback& confirmCallback)
+        BSLS_KEYWORD_OVERRIDE;
+
+    void setWritableCallback(const rmqp::Producer::WritableCallback& callback,
+                             bsl::size_t minimumCredits) BSLS_KEYWORD_OVERRIDE;
+
+    bsl::size_t availableCredits() const BSLS_KEYWORD_OVERRIDE;
+
+    void setWriteWeight(unsigned weight) BSLS_KEYWORD_OVERRIDE;
+
+    SendStatus
+    sendBatch(const bsl::vector<rmqt::Message>& messages,
+              const bsl::string& routingKey,
+              const rmqp::Producer::ConfirmationCallback& confirmCallback,
+              const bsls::TimeInterval& timeout) BSLS_KEYWORD_OVERRIDE;
+
+    rmqt::Result<rmqp::MessageSink>
+    openStream(const rmqt::Message& message,
+               bsl::size_t bodySize,
+               const bsl::string& routingKey,
+               const rmqp::Producer::ConfirmationCallback& confirmCallback,
+               const bsls::TimeInterval& timeout) BSLS_KEYWORD_OVERRIDE;
+
+    SendStatus sendSequenced(const rmqt::Message& message,
+                             const bsl::string& routingKey,
+                             bsl::uint64_t* sequenceNumber,
+                             const bsls::TimeInterval& timeout)
+        BSLS_KEYWORD_OVERRIDE;
+
+    bsl::uint64_t confirmedThrough() const BSLS_KEYWORD_OVERRIDE;
+
+    FailedSequences takeFailedSequences() BSLS_KEYWORD_OVERRIDE;
+
+    /// Apply `topologyUpdate` on the open producer, if any, and on every
+    /// producer opened later. Resolves at once while none is open.
+    rmqt::Future<> updateTopologyAsync(
+        const rmqt::TopologyUpdate& topologyUpdate) BSLS_KEYWORD_OVERRIDE;
+
+    /// Succeeds at once while no producer is open
+    rmqt::Result<>
+    waitForConfirms(const bsls::TimeInterval& timeout = bsls::TimeInterval(0))
+        BSLS_KEYWORD_OVERRIDE;
+
+    /// Return true if a producer is open
+    bool isOpen() const;
+
+    /// State shared with the idle timer and confirm callbacks, which may
+    /// outlive the producer
+    struct SharedState {
+        SharedState(const Opener& _opener,
+                    bsl::size_t _credits,
+                    bool _confirms,
+                    const bsls::TimeInterval& _idleClose,
+                    bdlmt::ThreadPool& _threadPool,
+                    rmqio::EventLoop& _eventLoop)
+        : opener(_opener)
+        , credits(_credits)
+        , confirms(_confirms)
+        , idleClose(_idleClose)
+        , threadPool(_threadPool)
+        , eventLoop(_eventLoop)
+        , timer()
+        , mutex()
+        , producer()
+        , opening()
+        , topologyUpdates()
+        , writableCallback()
+        , minimumCredits(0)
+        , writeWeight()
+        , used(false)
+        , sequenced(false)
+        , unconfirmed(0)
+        {
+        }
+
+        const Opener opener;
+        const bsl::size_t credits;
+        const bool confirms;
+        const bsls::TimeInterval idleClose;
+        bdlmt::ThreadPool& threadPool;
+        rmqio::EventLoop& eventLoop;
+        bsl::shared_ptr<rmqio::Timer> timer;
+
+        // Guards every member below but `unconfirmed`
+        mutable bslmt::Mutex mutex;
+        bsl::shared_ptr<rmqp::Producer> producer;
+        bsl::optional<rmqt::Future<rmqp::Producer> > opening;
+        bsl::vector<rmqt::TopologyUpdate> topologyUpdates;
+        rmqp::Producer::WritableCallback writableCallback;
+        bsl::size_t minimumCredits;
+        bsl::optional<unsigned> writeWeight;
+
+        // Set by each publishing call, cleared by each idle check
+        bool used;
+
+        // Set once `sendSequenced` is used: the producer then stays open
+        bool sequenced;
+
+        // Messages being sent, and, if `confirms`, sent and not yet
+        // confirmed. Only raised
+        // while `mutex` is held, so that a producer seen with none can be
+        // closed
+        bsls::AtomicInt64 unconfirmed;
+    };
+
+  private:
+    LazyProducer(const LazyProducer&) BSLS_KEYWORD_DELETED;
+    LazyProducer& operator=(const LazyProducer&) BSLS_KEYWORD_DELETED;
+
+    /// Return the open producer, counting `messages` about to be sent
+    /// through it as unconfirmed. If there is none, start opening one and
+    /// wait up to `timeout` (forever if 0) for it if `wait`. On failure the
+    /// result code is TIMEOUT.
+    rmqt::Result<rmqp::Producer> acquire(bsl::size_t messages,
+                                         const bsls::TimeInterval& timeout,
+                                         bool wait = true);
+
+    /// Return a callback uncounting each confirm before passing it on to
+    /// `confirmCallback`, if confirms are counted
+    rmqp::Producer::ConfirmationCallback
+    wrap(const rmqp::Producer::ConfirmationCallback& confirmCallback) const;
+
+    /// Uncount `messages` counted by `acquire`, unless `awaitingConfirms`
+    /// and confirms are counted
+    void release(bsl::size_t messages, bool awaitingConfirms);
+
+    bsl::shared_ptr<SharedState> d_sharedState;
+}; // class LazyProducer
+
+} // namespace rmqa
+} // namespace BloombergLP
+
+#endif
@@ -0,0 +1,175 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_messagebatchutil.h>
+
+#include <rmqt_segmentedpayload.h>
+
+#include <bdlb_bigendian.h>
+#include <bsls_assert.h>
+
+#include <bsl_cstdint.h>
+#include <bsl_cstring.h>
+#include <bsl_memory.h>
+
+namespace BloombergLP {
+namespace rmqa {
+namespace {
+
+const uint8_t k_FORMAT_VERSION = 1;
+
+// Version byte and message count
+const bsl::size_t k_HEADER_SIZE = 1 + sizeof(bdlb::BigEndianUint32);
+
+// Message ids are AMQP short strings
+const bsl::size_t k_MAX_MESSAGE_ID = 255;
+
+void appendUint32(bsl::vector<uint8_t>* out, bsl::size_t value)
+{
+    const bdlb::BigEndianUint32 encoded =
+        bdlb::BigEndianUint32::make(static_cast<unsigned int>(value));
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&encoded);
+    out->insert(out->end(), bytes, bytes + sizeof(encoded));
+}
+
+bsl::size_t readUint32(const uint8_t* in)
+{
+    bdlb::BigEndianUint32 encoded;
+    bsl::memcpy(&encoded, in, sizeof(encoded));
+    return static_cast<unsigned int>(encoded);
+}
+
+void appendPayload(bsl::vector<uint8_t>* out, const rmqt::Message& message)
+{
+    const bsl::shared_ptr<const rmqt::SegmentedPayload> segments =
+        message.payloadSegments();
+    if (!segments) {
+        out->insert(out->end(),
+                    message.payload(),
+                    message.payload() + message.payloadSize());
+        return;
+    }
+
+    for (rmqt::SegmentedPayload::const_iterator it = segments->begin();
+         it != segments->end();
+         ++it) {
+        out->insert(out->end(), it->first, it->first + it->second);
+    }
+}
+
+} // namespace
+
+const char* MessageBatchUtil::contentType()
+{
+    return "application/vnd.rmqcpp.batch";
+}
+
+bool MessageBatchUtil::isBatch(const rmqt::Message& message)
+{
+    const bdlb::NullableValue<bsl::string>& type =
+        message.properties().contentType;
+    return !type.isNull() && type.value() == contentType();
+}
+
+rmqt::Message
+MessageBatchUtil::pack(const bsl::vector<rmqt::Message>& messages)
+{
+    BSLS_ASSERT(!messages.empty());
+
+    bsl::size_t size = k_HEADER_SIZE;
+    for (bsl::vector<rmqt::Message>::const_iterator it = messages.begin();
+         it != messages.end();
+         ++it) {
+        size += 1 + it->messageId().size() + sizeof(bdlb::BigEndianUint32) +
+                it->payloadSize();
+    }
+
+    bsl::shared_ptr<bsl::vector<uint8_t> > payload =
+        bsl::make_shared<bsl::vector<uint8_t> >();
+    payload->reserve(size);
+    payload->push_back(k_FORMAT_VERSION);
+    appendUint32(payload.get(), messages.size());
+
+    for (bsl::vector<rmqt::Message>::const_iterator it = messages.begin();
+         it != messages.end();
+         ++it) {
+        const bsl::string& messageId = it->messageId();
+        BSLS_ASSERT(messageId.size() <= k_MAX_MESSAGE_ID);
+        payload->push_back(static_cast<uint8_t>(messageId.size()));
+        payload->insert(payload->end(), messageId.begin(), messageId.end());
+
+        appendUint32(payload.get(), it->payloadSize());
+        appendPayload(payload.get(), *it);
+    }
+
+    // The container gets a message id, and so a GUID, of its own
+    rmqt::Properties properties(messages.front().properties());
+    properties.contentType = contentType();
+    properties.messageId.reset();
+    return rmqt::Message(payload, properties);
+}
+
+int MessageBatchUtil::unpack(bsl::vector<rmqt::Message>* messages,
+                             const rmqt::Message& batch)
+{
+    messages->clear();
+
+    const uint8_t* data    = batch.payload();
+    const bsl::size_t size = batch.payloadSize();
+    if (size < k_HEADER_SIZE || data[0] != k_FORMAT_VERSION) {
+        return 1;
+    }
+
+    rmqt::Properties properties(batch.properties());
+    properties.contentType.reset();
+
+    const bsl::size_t count = readUint32(data + 1);
+    bsl::size_t offset      = k_HEADER_SIZE;
+    for (bsl::size_t i = 0; i < count; ++i) {
+        if (size - offset < 1 || size - offset - 1 < data[offset]) {
+            messages->clear();
+            return 2;
+        }
+        properties.messageId = bsl::string(
+            reinterpret_cast<const char*>(data + offset + 1), data[offset]);
+        offset += 1 + data[offset];
+
+        if (size - offset < sizeof(bdlb::BigEndianUint32)) {
+            messages->clear();
+            return 2;
+        }
+        const bsl::size_t length = readUint32(data + offset);
+        offset += sizeof(bdlb::BigEndianUint32);
+
+        if (size - offset < length) {
+            messages->clear();
+            return 2;
+        }
+        messages->push_back(rmqt::Message(
+            bsl::make_shared<bsl::vector<uint8_t> >(
+                data + offset, data + offset + length),
+            properties));
+        offset += length;
+    }
+
+    if (offset != size) {
+        messages->clear();
+        return 3;
+    }
+    return 0;
+}
+
+} // namespace rmqa
+} // namespace BloombergLP
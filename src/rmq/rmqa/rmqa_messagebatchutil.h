@@ -0,0 +1,65 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQA_MESSAGEBATCHUTIL
+#define INCLUDED_RMQA_MESSAGEBATCHUTIL
+
+#include <rmqt_message.h>
+
+#include <bsl_vector.h>
+
+//@PURPOSE: Pack several logical messages into one AMQP message
+//
+//@CLASSES:
+//  rmqa::MessageBatchUtil: encodes and decodes batch containers
+
+namespace BloombergLP {
+namespace rmqa {
+
+/// \brief A batch container is a message holding the payloads of several
+/// logical messages, so that the broker handles one message for all of them
+///
+/// The container's `contentType` is `contentType()`. Its payload is a format
+/// version byte and a big-endian 32 bit message count, followed by each
+/// logical message as its message id, prefixed with a length byte, and its
+/// payload, prefixed with a big-endian 32 bit length.
+///
+/// Only message ids and payloads are packed: the container carries the
+/// other properties of the first logical message, and every message
+/// unpacked from it is given the container's properties, without its
+/// content type, and its own message id.
+
+struct MessageBatchUtil {
+    /// The content type marking a message as a batch container
+    static const char* contentType();
+
+    /// Return true if `message` is a batch container
+    static bool isBatch(const rmqt::Message& message);
+
+    /// Return a batch container holding the payloads of `messages`. The
+    /// behavior is undefined unless `messages` is not empty.
+    static rmqt::Message pack(const bsl::vector<rmqt::Message>& messages);
+
+    /// Load the logical messages held by the batch container `batch` into
+    /// `messages`, replacing its contents. Return 0 on success, and a
+    /// non-zero value if `batch` is malformed.
+    static int unpack(bsl::vector<rmqt::Message>* messages,
+                      const rmqt::Message& batch);
+};
+
+} // namespace rmqa
+} // namespace BloombergLP
+
+#endif
@@ -0,0 +1,102 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_messagecodecutil.h>
+
+#include <ball_log.h>
+
+#include <bsl_cstdint.h>
+#include <bsl_string.h>
+
+namespace BloombergLP {
+namespace rmqa {
+namespace {
+
+BALL_LOG_SET_NAMESPACE_CATEGORY("RMQA.MESSAGECODECUTIL")
+
+} // namespace
+
+bool MessageCodecUtil::compress(rmqt::Message* message,
+                                const rmqp::MessageCodec& codec,
+                                bsl::size_t minimumSize)
+{
+    const rmqt::Message& original = *message;
+    if (original.payloadSize() < minimumSize ||
+        !original.properties().contentEncoding.isNull()) {
+        return false;
+    }
+
+    bsl::shared_ptr<bsl::vector<uint8_t> > compressed =
+        bsl::make_shared<bsl::vector<uint8_t> >();
+
+    const int rc = codec.compress(
+        compressed.get(), message->payload(), message->payloadSize());
+    if (rc != 0) {
+        BALL_LOG_WARN << "Failed to compress message " << message->guid()
+                      << " with " << codec.name() << " (return code " << rc
+                      << "). Sending it uncompressed.";
+        return false;
+    }
+
+    if (compressed->size() >= message->payloadSize()) {
+        return false;
+    }
+
+    message->updatePayload(compressed);
+    message->properties().contentEncoding = codec.name();
+
+    return true;
+}
+
+int MessageCodecUtil::decompress(rmqt::Message* message, const Codecs& codecs)
+{
+    // Read through a const reference, so a message whose properties are
+    // shared with its copies isn't given its own until they change
+    const rmqt::Message& original = *message;
+    if (original.properties().contentEncoding.isNull()) {
+        return 0;
+    }
+
+    const bsl::string encoding = original.properties().contentEncoding.value();
+
+    for (Codecs::const_iterator it = codecs.begin(); it != codecs.end();
+         ++it) {
+        if ((*it)->name() != encoding) {
+            continue;
+        }
+
+        bsl::shared_ptr<bsl::vector<uint8_t> > decompressed =
+            bsl::make_shared<bsl::vector<uint8_t> >();
+
+        const int rc = (*it)->decompress(
+            decompressed.get(), message->payload(), message->payloadSize());
+        if (rc != 0) {
+            BALL_LOG_ERROR << "Failed to decompress message "
+                           << message->guid() << " with content encoding "
+                           << encoding << " (return code " << rc << ")";
+            return rc;
+        }
+
+        message->updatePayload(decompressed);
+        message->properties().contentEncoding.reset();
+        return 0;
+    }
+
+    // Not ours to decode: the application sees the content encoding
+    return 0;
+}
+
+} // namespace rmqa
+} // namespace BloombergLP
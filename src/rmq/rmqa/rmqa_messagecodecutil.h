@@ -0,0 +1,56 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQA_MESSAGECODECUTIL
+#define INCLUDED_RMQA_MESSAGECODECUTIL
+
+#include <rmqp_messagecodec.h>
+#include <rmqt_message.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_memory.h>
+#include <bsl_vector.h>
+
+//@PURPOSE: Compress and decompress message payloads with rmqp::MessageCodec
+//
+//@CLASSES:
+//  rmqa::MessageCodecUtil: applies message codecs to rmqt::Message payloads
+
+namespace BloombergLP {
+namespace rmqa {
+
+struct MessageCodecUtil {
+    typedef bsl::vector<bsl::shared_ptr<rmqp::MessageCodec> > Codecs;
+
+    /// Compress the payload of `message` with `codec` and record the codec
+    /// in its `contentEncoding`. Messages smaller than `minimumSize` bytes,
+    /// messages which already have a content encoding, and messages which
+    /// would not get smaller are left as they are. Return true if `message`
+    /// was compressed.
+    static bool compress(rmqt::Message* message,
+                         const rmqp::MessageCodec& codec,
+                         bsl::size_t minimumSize);
+
+    /// Decompress the payload of `message` if its `contentEncoding` names
+    /// one of `codecs`, clearing the content encoding. Return 0 if the
+    /// message was decompressed or needs no decompression, and a non-zero
+    /// value, leaving `message` untouched, if decompression failed.
+    static int decompress(rmqt::Message* message, const Codecs& codecs);
+};
+
+} // namespace rmqa
+} // namespace BloombergLP
+
+#endif
@@ -18,6 +18,7 @@
 #include <rmqp_consumer.h>
 
 #include <ball_log.h>
+#include <bslma_default.h>
 #include <bsl_exception.h>
 
 namespace BloombergLP {
@@ -30,10 +31,14 @@ bslma::ManagedPtr<rmqa::MessageGuard>
 MessageGuard::Factory::create(const rmqt::Message& message,
                               const rmqt::Envelope& envelope,
                               const MessageGuardCallback& ackCallback,
-                              rmqp::Consumer* consumer) const
+                              rmqp::Consumer* consumer,
+                              bslma::Allocator* allocator) const
 {
-    return bslma::ManagedPtrUtil::makeManaged<rmqa::MessageGuard>(
-        message, envelope, ackCallback, consumer);
+    allocator = bslma::Default::allocator(allocator);
+    return bslma::ManagedPtr<rmqa::MessageGuard>(
+        new (*allocator)
+            rmqa::MessageGuard(message, envelope, ackCallback, consumer),
+        allocator);
 }
 
 MessageGuard::Factory::~Factory() {}
@@ -75,7 +80,7 @@ MessageGuard& MessageGuard::operator=(const MessageGuard& other)
 
 MessageGuard::~MessageGuard()
 {
-    if (d_state == READY) {
+    if (d_state == READY && d_ackCallback) {
         BALL_LOG_ERROR << "Unacked message, explicitly nacking. Message guid: "
                        << d_message.guid()
                        << ", payload size: " << d_message.payloadSize();
@@ -123,7 +128,9 @@ void MessageGuard::resolve(rmqt::ConsumerAck::Type ackOption)
         return;
     }
     d_state = RESOLVED;
-    d_ackCallback(rmqt::ConsumerAck(d_envelope, ackOption));
+    if (d_ackCallback) {
+        d_ackCallback(rmqt::ConsumerAck(d_envelope, ackOption));
+    }
 }
 
 rmqp::TransferrableMessageGuard MessageGuard::transferOwnership()
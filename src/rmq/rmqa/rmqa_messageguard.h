@@ -26,6 +26,7 @@
 #include <bsl_functional.h>
 #include <bsl_memory.h>
 #include <bsl_ostream.h>
+#include <bslma_allocator.h>
 #include <bslma_managedptr.h>
 
 namespace BloombergLP {
@@ -46,11 +47,14 @@ class MessageGuard : public rmqp::MessageGuard {
   public:
     class Factory {
       public:
+        /// Create a guard for `message`, allocated from `allocator`, or the
+        /// default allocator if 0
         virtual bslma::ManagedPtr<rmqa::MessageGuard>
         create(const rmqt::Message& message,
                const rmqt::Envelope& envelope,
                const MessageGuardCallback& ackCallback,
-               rmqp::Consumer* consumer) const;
+               rmqp::Consumer* consumer,
+               bslma::Allocator* allocator = 0) const;
 
         virtual ~Factory();
     };
@@ -58,7 +62,10 @@ class MessageGuard : public rmqp::MessageGuard {
     /// Constructs a new valid guard
     /// \param message Consumed message
     /// \param envelope Consumed delivery metadata
-    /// \param ackCallback Callback called when resolving message
+    /// \param ackCallback Callback called when resolving message. If empty,
+    ///        the message needs no acknowledgement (see
+    ///        `rmqt::ConsumerConfig::setNoAck`), so `ack`/`nack` only update
+    ///        the guard's state and destroying it unresolved nacks nothing.
     /// \param consumer Pointer to the Consumer
     MessageGuard(const rmqt::Message& message,
                  const rmqt::Envelope& envelope,
@@ -0,0 +1,147 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_partitionutil.h>
+
+#include <rmqa_topology.h>
+
+#include <rmqt_fieldvalue.h>
+
+#include <bsls_assert.h>
+
+#include <bsl_sstream.h>
+
+namespace BloombergLP {
+namespace rmqa {
+namespace {
+
+const char k_QUEUE_TYPE[]      = "x-queue-type";
+const char k_PARTITION_ORDER[] = "x-stream-partition-order";
+
+bsl::uint32_t rotl32(bsl::uint32_t x, int r)
+{
+    return (x << r) | (x >> (32 - r));
+}
+
+} // namespace
+
+const bsl::uint32_t PartitionUtil::k_HASH_SEED;
+
+bsl::uint32_t PartitionUtil::murmurHash3(const char* data,
+                                         bsl::size_t length,
+                                         bsl::uint32_t seed)
+{
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    const bsl::uint32_t c1     = 0xcc9e2d51;
+    const bsl::uint32_t c2     = 0x1b873593;
+    const bsl::size_t blocks   = length / 4;
+
+    bsl::uint32_t h = seed;
+
+    // Blocks are read little-endian whatever the platform, so that the
+    // hash is the same everywhere
+    for (bsl::size_t i = 0; i < blocks; ++i) {
+        const unsigned char* b = bytes + i * 4;
+        bsl::uint32_t k = static_cast<bsl::uint32_t>(b[0]) |
+                          static_cast<bsl::uint32_t>(b[1]) << 8 |
+                          static_cast<bsl::uint32_t>(b[2]) << 16 |
+                          static_cast<bsl::uint32_t>(b[3]) << 24;
+        k *= c1;
+        k = rotl32(k, 15);
+        k *= c2;
+
+        h ^= k;
+        h = rotl32(h, 13);
+        h = h * 5 + 0xe6546b64;
+    }
+
+    const unsigned char* tail = bytes + blocks * 4;
+    bsl::uint32_t k           = 0;
+    switch (length & 3) {
+        case 3:
+            k ^= static_cast<bsl::uint32_t>(tail[2]) << 16;
+            // fall through
+        case 2:
+            k ^= static_cast<bsl::uint32_t>(tail[1]) << 8;
+            // fall through
+        case 1:
+            k ^= tail[0];
+            k *= c1;
+            k = rotl32(k, 15);
+            k *= c2;
+            h ^= k;
+    }
+
+    h ^= static_cast<bsl::uint32_t>(length);
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return h;
+}
+
+bsl::size_t PartitionUtil::partitionOf(const bsl::string& key,
+                                       bsl::size_t partitions)
+{
+    BSLS_ASSERT(partitions != 0);
+
+    return murmurHash3(key.data(), key.size(), k_HASH_SEED) % partitions;
+}
+
+bsl::vector<bsl::string>
+PartitionUtil::superStreamRoutingKeys(bsl::size_t partitions)
+{
+    bsl::vector<bsl::string> keys;
+    keys.reserve(partitions);
+    for (bsl::size_t i = 0; i < partitions; ++i) {
+        bsl::ostringstream key;
+        key << i;
+        keys.push_back(key.str());
+    }
+    return keys;
+}
+
+rmqt::ExchangeHandle PartitionUtil::addSuperStream(Topology* topology,
+                                                   const bsl::string& name,
+                                                   bsl::size_t partitions)
+{
+    BSLS_ASSERT(topology);
+
+    rmqt::ExchangeHandle exchange = topology->addExchange(name);
+
+    const bsl::vector<bsl::string> keys = superStreamRoutingKeys(partitions);
+    for (bsl::size_t i = 0; i < keys.size(); ++i) {
+        rmqt::FieldTable queueArgs;
+        queueArgs[k_QUEUE_TYPE] = rmqt::FieldValue(bsl::string("stream"));
+
+        rmqt::QueueHandle queue = topology->addQueue(
+            name + "-" + keys[i],
+            rmqt::AutoDelete::OFF,
+            rmqt::Durable::ON,
+            queueArgs);
+
+        // Lets stream clients list the partitions in order
+        rmqt::FieldTable bindArgs;
+        bindArgs[k_PARTITION_ORDER] =
+            rmqt::FieldValue(static_cast<int32_t>(i));
+        topology->bind(exchange, queue, keys[i], bindArgs);
+    }
+
+    return exchange;
+}
+
+} // namespace rmqa
+} // namespace BloombergLP
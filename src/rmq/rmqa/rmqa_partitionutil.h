@@ -0,0 +1,76 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQA_PARTITIONUTIL
+#define INCLUDED_RMQA_PARTITIONUTIL
+
+#include <rmqt_exchange.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_cstdint.h>
+#include <bsl_string.h>
+#include <bsl_vector.h>
+
+//@PURPOSE: Map message keys onto the partitions of a partitioned destination
+//
+//@CLASSES:
+//  rmqa::PartitionUtil: stable key hashing and super stream declaration
+
+namespace BloombergLP {
+namespace rmqa {
+class Topology;
+
+/// \brief Utilities for publishing to a destination split into partitions
+///
+/// A key is mapped onto a partition with the 32 bit MurmurHash3 of its
+/// bytes, seeded with `k_HASH_SEED`, modulo the partition count. This is
+/// the mapping RabbitMQ stream clients use for super streams, so that
+/// producers in other languages send a given key to the same partition.
+/// Unlike `bsl::hash`, the mapping does not change between processes or
+/// platforms.
+
+struct PartitionUtil {
+    /// The MurmurHash3 seed used by RabbitMQ super stream clients
+    static const bsl::uint32_t k_HASH_SEED = 104729;
+
+    /// Return the 32 bit MurmurHash3 (x86 variant) of the `length` bytes at
+    /// `data`, seeded with `seed`
+    static bsl::uint32_t
+    murmurHash3(const char* data, bsl::size_t length, bsl::uint32_t seed);
+
+    /// Return the partition, in `[0, partitions)`, which messages with `key`
+    /// go to. The behavior is undefined unless `partitions` is not 0.
+    static bsl::size_t partitionOf(const bsl::string& key,
+                                   bsl::size_t partitions);
+
+    /// Return the binding keys of the `partitions` partitions of a super
+    /// stream: "0", "1", and so on
+    static bsl::vector<bsl::string>
+    superStreamRoutingKeys(bsl::size_t partitions);
+
+    /// Add a super stream called `name` with `partitions` partitions to
+    /// `topology`, as `rabbitmq-streams add_super_stream` declares it: a
+    /// durable direct exchange `name`, bound to the stream queues
+    /// `name-0`, `name-1`, ... with the keys `superStreamRoutingKeys`
+    /// returns. Return the exchange to produce to.
+    static rmqt::ExchangeHandle addSuperStream(Topology* topology,
+                                               const bsl::string& name,
+                                               bsl::size_t partitions);
+};
+
+} // namespace rmqa
+} // namespace BloombergLP
+
+#endif
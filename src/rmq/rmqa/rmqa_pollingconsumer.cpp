@@ -0,0 +1,148 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_pollingconsumer.h>
+
+#include <ball_log.h>
+#include <bslmt_lockguard.h>
+#include <bsls_systemtime.h>
+
+#include <bsl_algorithm.h>
+
+namespace BloombergLP {
+namespace rmqa {
+namespace {
+
+BALL_LOG_SET_NAMESPACE_CATEGORY("RMQA.POLLINGCONSUMER")
+
+} // namespace
+
+PollingConsumer::Buffer::Buffer()
+: d_mutex()
+, d_arrived()
+, d_guards()
+, d_closed(false)
+{
+}
+
+void PollingConsumer::Buffer::push(rmqp::MessageGuard& guard)
+{
+    {
+        bslmt::LockGuard<bslmt::Mutex> lock(&d_mutex);
+        if (!d_closed) {
+            d_guards.push_back(guard.transferOwnership());
+            d_arrived.signal();
+            return;
+        }
+    }
+
+    // Delivered between closing and the broker's cancel-ok
+    guard.nack(true);
+}
+
+bsl::size_t PollingConsumer::Buffer::pop(
+    bsl::vector<rmqp::TransferrableMessageGuard>* out,
+    bsl::size_t max,
+    bool wait,
+    const bsls::TimeInterval& timeout)
+{
+    const bool hasTimeout = timeout.totalNanoseconds() != 0;
+    const bsls::TimeInterval deadline =
+        bsls::SystemTime::nowRealtimeClock() + timeout;
+
+    bslmt::LockGuard<bslmt::Mutex> lock(&d_mutex);
+    while (wait && d_guards.empty() && !d_closed) {
+        if (!hasTimeout) {
+            d_arrived.wait(&d_mutex);
+        }
+        else if (d_arrived.timedWait(&d_mutex, deadline)) {
+            break;
+        }
+    }
+
+    const bsl::size_t count = bsl::min(max, d_guards.size());
+    out->insert(out->end(), d_guards.begin(), d_guards.begin() + count);
+    d_guards.erase(d_guards.begin(), d_guards.begin() + count);
+    return count;
+}
+
+void PollingConsumer::Buffer::close()
+{
+    bsl::deque<rmqp::TransferrableMessageGuard> guards;
+    {
+        bslmt::LockGuard<bslmt::Mutex> lock(&d_mutex);
+        d_closed = true;
+        guards.swap(d_guards);
+        d_arrived.broadcast();
+    }
+
+    if (!guards.empty()) {
+        BALL_LOG_INFO << "Requeueing " << guards.size()
+                      << " messages which were never polled";
+    }
+
+    // Nacked without the mutex held, so a consumer callback pushing a
+    // message meanwhile is not held up
+    for (bsl::deque<rmqp::TransferrableMessageGuard>::iterator it =
+             guards.begin();
+         it != guards.end();
+         ++it) {
+        (*it)->nack(true);
+    }
+}
+
+bsl::size_t PollingConsumer::Buffer::size() const
+{
+    bslmt::LockGuard<bslmt::Mutex> lock(&d_mutex);
+    return d_guards.size();
+}
+
+PollingConsumer::PollingConsumer(const bsl::shared_ptr<Consumer>& consumer,
+                                 const bsl::shared_ptr<Buffer>& buffer)
+: d_consumer(consumer)
+, d_buffer(buffer)
+{
+}
+
+PollingConsumer::~PollingConsumer() { d_buffer->close(); }
+
+bsl::size_t
+PollingConsumer::poll(bsl::vector<rmqp::TransferrableMessageGuard>* out,
+                      bsl::size_t max,
+                      const bsls::TimeInterval& timeout)
+{
+    return d_buffer->pop(out, max, true, timeout);
+}
+
+bsl::size_t
+PollingConsumer::tryPoll(bsl::vector<rmqp::TransferrableMessageGuard>* out,
+                         bsl::size_t max)
+{
+    return d_buffer->pop(out, max, false, bsls::TimeInterval());
+}
+
+bsl::size_t PollingConsumer::buffered() const { return d_buffer->size(); }
+
+void PollingConsumer::cancel() { d_consumer->cancel(); }
+
+rmqt::Result<>
+PollingConsumer::cancelAndDrain(const bsls::TimeInterval& timeout)
+{
+    d_buffer->close();
+    return d_consumer->cancelAndDrain(timeout);
+}
+
+} // namespace rmqa
+} // namespace BloombergLP
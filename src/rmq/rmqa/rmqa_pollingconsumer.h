@@ -0,0 +1,144 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// rmqa_pollingconsumer.h
+#ifndef INCLUDED_RMQA_POLLINGCONSUMER
+#define INCLUDED_RMQA_POLLINGCONSUMER
+
+#include <rmqa_consumer.h>
+
+#include <rmqp_messageguard.h>
+#include <rmqt_result.h>
+
+#include <bslmt_condition.h>
+#include <bslmt_mutex.h>
+#include <bsls_keyword.h>
+#include <bsls_timeinterval.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_deque.h>
+#include <bsl_memory.h>
+#include <bsl_vector.h>
+
+//@PURPOSE: Provide a RabbitMQ consumer which the application polls
+//
+//@CLASSES:
+//  rmqa::PollingConsumer: a consumer whose messages are pulled in batches
+
+namespace BloombergLP {
+namespace rmqa {
+
+/// \brief A consumer which buffers its messages until the application polls
+/// for them, instead of invoking a callback for each
+///
+/// Deliveries are taken into the buffer on the connection's event loop
+/// thread. The broker stops delivering once `prefetchCount` messages are
+/// unacked, whether they are still buffered or have been polled, so the
+/// prefetch count bounds the buffer. Poll for up to that many messages at a
+/// time, and ack or nack each returned guard as usual.
+///
+/// Create with `VHost::createPollingConsumer`. `poll` may be called from
+/// any thread, but not from another consumer's callback.
+
+class PollingConsumer {
+  public:
+    /// Holds the guards of delivered messages until they are polled.
+    /// Thread safe.
+    class Buffer {
+      public:
+        Buffer();
+
+        /// Consumer callback: take ownership of `guard`, or requeue its
+        /// message once the buffer is closed
+        void push(rmqp::MessageGuard& guard);
+
+        /// Move up to `max` guards, oldest first, to the end of `out`. If
+        /// `wait` is true and the buffer is empty, first wait for a message,
+        /// until `timeout` passes (if non-zero) or the buffer is closed.
+        /// Return the number of guards moved.
+        bsl::size_t pop(bsl::vector<rmqp::TransferrableMessageGuard>* out,
+                        bsl::size_t max,
+                        bool wait,
+                        const bsls::TimeInterval& timeout);
+
+        /// Requeue the buffered messages and any delivered later, and wake
+        /// any waiting `pop`
+        void close();
+
+        /// Number of buffered messages
+        bsl::size_t size() const;
+
+      private:
+        Buffer(const Buffer&) BSLS_KEYWORD_DELETED;
+        Buffer& operator=(const Buffer&) BSLS_KEYWORD_DELETED;
+
+        mutable bslmt::Mutex d_mutex;
+        bslmt::Condition d_arrived;
+        bsl::deque<rmqp::TransferrableMessageGuard> d_guards;
+        bool d_closed;
+    }; // class Buffer
+
+    /// Constructed by `VHost::createPollingConsumer`, from a consumer
+    /// delivering to `buffer`
+    PollingConsumer(const bsl::shared_ptr<Consumer>& consumer,
+                    const bsl::shared_ptr<Buffer>& buffer);
+
+    /// Requeues the buffered messages and stops the consumer
+    ~PollingConsumer();
+
+    /// \brief Wait for messages, and take up to `max` of them
+    /// \param out Guards of the messages taken are appended to this. Each
+    ///        must be acked or nacked, as in a consumer callback.
+    /// \param max Take no more than this many messages
+    /// \param timeout How long to wait for a message if none are buffered.
+    ///        If timeout is 0, wait indefinitely.
+    /// \return The number of messages taken: zero if none arrived in time,
+    ///         or the consumer was cancelled with `cancelAndDrain`
+    bsl::size_t
+    poll(bsl::vector<rmqp::TransferrableMessageGuard>* out,
+         bsl::size_t max,
+         const bsls::TimeInterval& timeout = bsls::TimeInterval(0));
+
+    /// \brief Take up to `max` of the buffered messages without waiting
+    /// \return The number of messages taken
+    bsl::size_t tryPoll(bsl::vector<rmqp::TransferrableMessageGuard>* out,
+                        bsl::size_t max);
+
+    /// Number of messages waiting to be polled
+    bsl::size_t buffered() const;
+
+    /// \brief Tells the broker to stop delivering messages to this consumer.
+    /// Messages already delivered can still be polled, but a `poll` waiting
+    /// indefinitely is not woken.
+    void cancel();
+
+    /// \brief Tells the broker to stop delivering messages to this consumer,
+    /// requeues the messages not yet polled, and waits for those already
+    /// polled to be acked or nacked, as `Consumer::cancelAndDrain`
+    rmqt::Result<>
+    cancelAndDrain(const bsls::TimeInterval& timeout = bsls::TimeInterval(0));
+
+  private:
+    PollingConsumer(const PollingConsumer&) BSLS_KEYWORD_DELETED;
+    PollingConsumer& operator=(const PollingConsumer&) BSLS_KEYWORD_DELETED;
+
+    bsl::shared_ptr<Consumer> d_consumer;
+    bsl::shared_ptr<Buffer> d_buffer;
+}; // class PollingConsumer
+
+} // namespace rmqa
+} // namespace BloombergLP
+
+#endif // ! INCLUDED_RMQA_POLLINGCONSUMER
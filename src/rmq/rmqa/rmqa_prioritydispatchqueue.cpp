@@ -0,0 +1,64 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_prioritydispatchqueue.h>
+
+#include <bslmt_lockguard.h>
+
+namespace BloombergLP {
+namespace rmqa {
+
+PriorityDispatchQueue::PriorityDispatchQueue()
+: d_mutex()
+, d_entries()
+, d_nextSequence(0)
+{
+}
+
+void PriorityDispatchQueue::push(const rmqt::Message& message,
+                                 const rmqt::Envelope& envelope)
+{
+    const rmqt::Properties& properties = message.properties();
+
+    Entry entry = {properties.priority.isNull() ? 0
+                                                : properties.priority.value(),
+                   0,
+                   Delivery(message, envelope)};
+
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    entry.sequence = d_nextSequence++;
+    d_entries.push(entry);
+}
+
+bsl::optional<PriorityDispatchQueue::Delivery> PriorityDispatchQueue::pop()
+{
+    bsl::optional<Delivery> result;
+
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    if (!d_entries.empty()) {
+        result = d_entries.top().delivery;
+        d_entries.pop();
+    }
+    return result;
+}
+
+bsl::size_t PriorityDispatchQueue::size() const
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    return d_entries.size();
+}
+
+} // namespace rmqa
+} // namespace BloombergLP
@@ -0,0 +1,89 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// rmqa_prioritydispatchqueue.h
+#ifndef INCLUDED_RMQA_PRIORITYDISPATCHQUEUE
+#define INCLUDED_RMQA_PRIORITYDISPATCHQUEUE
+
+#include <rmqt_envelope.h>
+#include <rmqt_message.h>
+
+#include <bslmt_mutex.h>
+#include <bsls_keyword.h>
+#include <bsls_types.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_optional.h>
+#include <bsl_queue.h>
+#include <bsl_utility.h>
+
+//@PURPOSE: Hand out prefetched deliveries most urgent first
+//
+//@CLASSES:
+//  rmqa::PriorityDispatchQueue: Deliveries waiting for a threadpool job,
+//  ordered by message priority
+
+namespace BloombergLP {
+namespace rmqa {
+
+/// \brief Deliveries received but not yet handed to the consumer callback,
+/// taken highest `rmqt::Properties::priority` first, and in delivery order
+/// within a priority
+///
+/// Messages without a priority count as priority 0, as the broker treats
+/// them. Thread safe: deliveries are pushed on the event loop thread and
+/// popped by threadpool jobs.
+
+class PriorityDispatchQueue {
+  public:
+    typedef bsl::pair<rmqt::Message, rmqt::Envelope> Delivery;
+
+    PriorityDispatchQueue();
+
+    void push(const rmqt::Message& message, const rmqt::Envelope& envelope);
+
+    /// Remove and return the most urgent delivery, if there is one
+    bsl::optional<Delivery> pop();
+
+    bsl::size_t size() const;
+
+  private:
+    PriorityDispatchQueue(const PriorityDispatchQueue&) BSLS_KEYWORD_DELETED;
+    PriorityDispatchQueue&
+    operator=(const PriorityDispatchQueue&) BSLS_KEYWORD_DELETED;
+
+    struct Entry {
+        int priority;
+        bsls::Types::Uint64 sequence;
+        Delivery delivery;
+
+        /// Orders the heap so the highest priority, then earliest sequence,
+        /// is on top
+        bool operator<(const Entry& other) const
+        {
+            return priority != other.priority ? priority < other.priority
+                                              : sequence > other.sequence;
+        }
+    };
+
+    mutable bslmt::Mutex d_mutex;
+    bsl::priority_queue<Entry> d_entries;
+    bsls::Types::Uint64 d_nextSequence;
+}; // class PriorityDispatchQueue
+
+} // namespace rmqa
+} // namespace BloombergLP
+
+#endif // ! INCLUDED_RMQA_PRIORITYDISPATCHQUEUE
@@ -53,6 +53,80 @@ Producer::trySend(const rmqt::Message& message,
     return d_impl->trySend(message, routingKey, confirmCallback);
 }
 
+void Producer::setWritableCallback(
+    const rmqp::Producer::WritableCallback& callback,
+    bsl::size_t minimumCredits)
+{
+    d_impl->setWritableCallback(callback, minimumCredits);
+}
+
+bsl::size_t Producer::availableCredits() const
+{
+    return d_impl->availableCredits();
+}
+
+void Producer::setWriteWeight(unsigned weight)
+{
+    d_impl->setWriteWeight(weight);
+}
+
+rmqt::Result<rmqp::MessageSink>
+Producer::openStream(const rmqt::Message& message,
+                     bsl::size_t bodySize,
+                     const bsl::string& routingKey,
+                     const rmqp::Producer::ConfirmationCallback& confirmCallback,
+                     const bsls::TimeInterval& timeout)
+{
+    return d_impl->openStream(
+        message, bodySize, routingKey, confirmCallback, timeout);
+}
+
+rmqp::Producer::SendStatus
+Producer::sendBatch(const bsl::vector<rmqt::Message>& messages,
+                    const bsl::string& routingKey,
+                    const rmqp::Producer::ConfirmationCallback& confirmCallback,
+                    const bsls::TimeInterval& timeout)
+{
+    return d_impl->sendBatch(messages, routingKey, confirmCallback, timeout);
+}
+
+rmqp::Producer::SendStatus Producer::sendToMany(
+    const rmqt::Message& message,
+    const bsl::vector<bsl::string>& routingKeys,
+    const rmqp::Producer::FanOutConfirmationCallback& confirmCallback,
+    const bsls::TimeInterval& timeout)
+{
+    return d_impl->sendToMany(message, routingKeys, confirmCallback, timeout);
+}
+
+rmqp::Producer::SendStatus Producer::sendUrgent(
+    const rmqt::Message& message,
+    const bsl::string& routingKey,
+    const rmqp::Producer::ConfirmationCallback& confirmCallback,
+    const bsls::TimeInterval& timeout)
+{
+    return d_impl->sendUrgent(message, routingKey, confirmCallback, timeout);
+}
+
+rmqp::Producer::SendStatus
+Producer::sendSequenced(const rmqt::Message& message,
+                        const bsl::string& routingKey,
+                        bsl::uint64_t* sequenceNumber,
+                        const bsls::TimeInterval& timeout)
+{
+    return d_impl->sendSequenced(message, routingKey, sequenceNumber, timeout);
+}
+
+bsl::uint64_t Producer::confirmedThrough() const
+{
+    return d_impl->confirmedThrough();
+}
+
+rmqp::Producer::FailedSequences Producer::takeFailedSequences()
+{
+    return d_impl->takeFailedSequences();
+}
+
 rmqt::Result<> Producer::waitForConfirms(const bsls::TimeInterval& timeout)
 {
     return d_impl->waitForConfirms(timeout);
@@ -74,5 +148,11 @@ Producer::updateTopology(const rmqa::TopologyUpdate& topologyUpdate,
     return result;
 }
 
+rmqt::Future<>
+Producer::updateTopologyAsync(const rmqa::TopologyUpdate& topologyUpdate)
+{
+    return d_impl->updateTopologyAsync(topologyUpdate.topologyUpdate());
+}
+
 } // namespace rmqa
 } // namespace BloombergLP
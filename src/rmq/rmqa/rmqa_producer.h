@@ -18,14 +18,19 @@
 #define INCLUDED_RMQA_PRODUCER
 
 #include <rmqa_topologyupdate.h>
+#include <rmqp_messagesink.h>
 #include <rmqp_producer.h>
 #include <rmqp_topology.h>
 #include <rmqt_exchange.h>
+#include <rmqt_future.h>
 #include <rmqt_message.h>
 #include <rmqt_queue.h>
 #include <rmqt_result.h>
 
+#include <bsl_cstddef.h>
+#include <bsl_cstdint.h>
 #include <bsl_string.h>
+#include <bsl_vector.h>
 #include <bslma_managedptr.h>
 #include <bsls_timeinterval.h>
 
@@ -134,6 +139,87 @@ class Producer {
          const rmqp::Producer::ConfirmationCallback& confirmCallback,
          const bsls::TimeInterval& timeout = bsls::TimeInterval());
 
+    /// Send a batch of messages with the given `routingKey` to the exchange
+    /// this Producer targets.
+    ///
+    /// Equivalent to calling `send` for each message in order, but room for
+    /// the whole batch under the maxOutstandingConfirms limit is reserved at
+    /// once, and the batch is written to the broker together. Either every
+    /// message is accepted for sending, or none are.
+    ///
+    /// \param messages   The messages to be sent
+    /// \param routingKey The routing key (e.g. topic, or queue name) passed to
+    ///                   the exchange, for every message.
+    /// \param confirmCallback Called for each message when the broker
+    ///                      explicitly confirms/rejects it.
+    /// \param timeout    How long to wait for as a relative timeout. If
+    ///                   timeout is 0, the method will wait to send the batch
+    ///                   indefinitely
+    ///
+    /// \return SENDING   When the library accepts the batch for sending.
+    /// \return DUPLICATE Returned if any message GUID in the batch is
+    ///                   repeated, or already awaiting a confirm.
+    /// \return TIMEOUT   Returned if the batch couldn't be enqueued within
+    ///                   the timeout time
+    /// \return INFLIGHT_LIMIT Returned if the batch holds more messages than
+    ///                   the maxOutstandingConfirms limit
+    rmqp::Producer::SendStatus
+    sendBatch(const bsl::vector<rmqt::Message>& messages,
+              const bsl::string& routingKey,
+              const rmqp::Producer::ConfirmationCallback& confirmCallback,
+              const bsls::TimeInterval& timeout = bsls::TimeInterval());
+
+    /// Send `message` once for each of `routingKeys` to the exchange this
+    /// Producer targets.
+    ///
+    /// The publishes share the message's payload and properties, and are
+    /// reserved for and written to the broker together, as with
+    /// `sendBatch`. Each is tracked under a GUID of its own, so the message
+    /// can be sent again before its confirms arrive.
+    ///
+    /// \param message     The message to be sent
+    /// \param routingKeys The routing keys to send it with, one publish each
+    /// \param confirmCallback Called once the broker has confirmed or
+    ///                    rejected every publish, with the response for each
+    ///                    routing key.
+    /// \param timeout     How long to wait for as a relative timeout. If
+    ///                    timeout is 0, the method will wait indefinitely
+    ///
+    /// \return SENDING, DUPLICATE, TIMEOUT or INFLIGHT_LIMIT as for
+    ///         `sendBatch`
+    rmqp::Producer::SendStatus sendToMany(
+        const rmqt::Message& message,
+        const bsl::vector<bsl::string>& routingKeys,
+        const rmqp::Producer::FanOutConfirmationCallback& confirmCallback,
+        const bsls::TimeInterval& timeout = bsls::TimeInterval());
+
+    /// \brief Send a control-plane message ahead of any messages still
+    /// waiting to be published. See rmqp::Producer#sendUrgent. Sent as
+    /// `send` would with producer batching.
+    rmqp::Producer::SendStatus
+    sendUrgent(const rmqt::Message& message,
+               const bsl::string& routingKey,
+               const rmqp::Producer::ConfirmationCallback& confirmCallback,
+               const bsls::TimeInterval& timeout = bsls::TimeInterval());
+
+    /// \brief Send a message tracked by sequence number rather than a
+    /// confirm callback, loading its sequence number into
+    /// `sequenceNumber`. See rmqp::Producer#sendSequenced. Not supported
+    /// with producer batching.
+    rmqp::Producer::SendStatus
+    sendSequenced(const rmqt::Message& message,
+                  const bsl::string& routingKey,
+                  bsl::uint64_t* sequenceNumber,
+                  const bsls::TimeInterval& timeout = bsls::TimeInterval());
+
+    /// \brief Return the sequence number up to which every confirm of
+    /// `sendSequenced` has arrived
+    bsl::uint64_t confirmedThrough() const;
+
+    /// \brief Return, and forget, the sequence numbers rejected or returned
+    /// since the last call
+    rmqp::Producer::FailedSequences takeFailedSequences();
+
     /// Updates topology and waits for the server to confirm the update status
     ///
     /// \param timeout   How long to wait for. If timeout is 0, the method will
@@ -145,6 +231,17 @@ class Producer {
     updateTopology(const rmqa::TopologyUpdate& topologyUpdate,
                    const bsls::TimeInterval& timeout = bsls::TimeInterval(0));
 
+    /// Updates topology without waiting for the server to confirm it
+    ///
+    /// Updates are pipelined: many can be sent before the broker has replied
+    /// to the first, so a stream of updates is not held to one per round
+    /// trip. They are still applied in the order they are made.
+    ///
+    /// \return A future which completes once all updates were confirmed by
+    ///         the broker, or with an error if the update failed.
+    rmqt::Future<>
+    updateTopologyAsync(const rmqa::TopologyUpdate& topologyUpdate);
+
 #ifdef USES_LIBRMQ_EXPERIMENTAL_FEATURES
     /// \brief Send a message with the given `routingKey` to the exchange
     /// targeted by the producer.
@@ -183,6 +280,45 @@ class Producer {
     trySend(const rmqt::Message& message,
             const bsl::string& routingKey,
             const rmqp::Producer::ConfirmationCallback& confirmCallback);
+
+    /// \brief Register `callback` to be told when sending is possible again.
+    ///
+    /// Once `trySend` has returned INFLIGHT_LIMIT, `callback` is invoked a
+    /// single time, on the thread pool, as soon as publisher confirms bring
+    /// the available credit back up to `minimumCredits`. Publishers can stop
+    /// when `trySend` fails and resume from `callback`, without blocking a
+    /// thread or polling `trySend`.
+    ///
+    /// \param callback       Invoked when sending is possible again. An
+    ///                       empty callback removes any registered callback.
+    /// \param minimumCredits How many messages must be sendable before
+    ///                       `callback` is invoked.
+    void
+    setWritableCallback(const rmqp::Producer::WritableCallback& callback,
+                        bsl::size_t minimumCredits = 1);
+
+    /// \brief Return how many more messages can be sent before the
+    /// maxOutstandingConfirms limit is reached.
+    bsl::size_t availableCredits() const;
+
+    /// \brief Let this producer write up to `weight` frames each time it
+    /// takes its turn on a busy connection, see
+    /// rmqp::Producer#setWriteWeight
+    void setWriteWeight(unsigned weight);
+
+    /// \brief Start sending a message whose body of `bodySize` bytes is
+    /// written afterwards, through the returned sink, so that it never has
+    /// to be held in memory at once.
+    ///
+    /// Streamed messages are not retried on reconnection: `confirmCallback`
+    /// is invoked with REJECT if the stream fails. See
+    /// rmqp::Producer#openStream for details.
+    rmqt::Result<rmqp::MessageSink>
+    openStream(const rmqt::Message& message,
+               bsl::size_t bodySize,
+               const bsl::string& routingKey,
+               const rmqp::Producer::ConfirmationCallback& confirmCallback,
+               const bsls::TimeInterval& timeout = bsls::TimeInterval());
 #endif
 
     /// Wait for all outstanding publisher confirms to arrive.
@@ -15,23 +15,40 @@
 
 #include <rmqa_producerimpl.h>
 
+#include <rmqa_messagecodecutil.h>
+#include <rmqa_sendtimeutil.h>
+#include <rmqa_sharedsendchannel.h>
+#include <rmqamqp_messagewithroute.h>
 #include <rmqamqp_sendchannel.h>
+#include <rmqio_coarseclock.h>
 #include <rmqio_eventloop.h>
+#include <rmqio_pipelineclock.h>
+#include <rmqio_timer.h>
 #include <rmqt_confirmresponse.h>
 #include <rmqt_future.h>
+#include <rmqt_log.h>
 #include <rmqt_message.h>
 #include <rmqt_topologyupdate.h>
 
 #include <bdlmt_threadpool.h>
 #include <bslma_managedptr.h>
+#include <bslmt_condition.h>
 #include <bslmt_lockguard.h>
 #include <bslmt_mutex.h>
+#include <bslmt_semaphore.h>
+#include <bsls_assert.h>
+#include <bsls_atomic.h>
 #include <bsls_systemtime.h>
 #include <bsls_timeinterval.h>
+#include <bsls_types.h>
 
+#include <bsl_algorithm.h>
+#include <bsl_cstdint.h>
+#include <bsl_deque.h>
 #include <bsl_memory.h>
 #include <bsl_string.h>
 #include <bsl_utility.h>
+#include <bsl_vector.h>
 
 namespace BloombergLP {
 namespace rmqa {
@@ -39,24 +56,461 @@ namespace {
 
 BALL_LOG_SET_NAMESPACE_CATEGORY("RMQA.PRODUCERIMPL")
 
-void actionConfirmOnThreadPool(
-    const rmqt::Message& message,
-    const bsl::string& routingKey,
-    const rmqt::ConfirmResponse& confirmResponse,
+// Chunks of a streamed message which may be queued for the connection
+// before `MessageSink::write` blocks
+const int k_MAX_UNWRITTEN_CHUNKS = 4;
+
+/// Return the number of messages trySend would accept. With a spool, must be
+/// called with the mutex held
+bsl::size_t availableCapacity(const ProducerImpl::SharedState& sharedState)
+{
+    if (sharedState.memoryBudget && sharedState.memoryBudget->exhausted()) {
+        return 0;
+    }
+
+    if (sharedState.publishGate && sharedState.publishGate->isClosed()) {
+        return 0;
+    }
+
+    const int value = sharedState.outstandingMessagesCap.getValue();
+    bsl::size_t capacity = value > 0 ? static_cast<bsl::size_t>(value) : 0;
+
+    // Once the limit is reached sends are spooled, while the spool accepts
+    // them
+    if (sharedState.spool && sharedState.spool->accepting()) {
+        capacity = bsl::max<bsl::size_t>(capacity, 1);
+    }
+
+    if (sharedState.rateLimiter) {
+        capacity = bsl::min(capacity, sharedState.rateLimiter->available());
+    }
+    return capacity;
+}
+
+/// Count `bytes` of a message being published against the memory budget,
+/// if there is one. Must be called with the mutex held
+void chargeMemoryBudget(ProducerImpl::SharedState& sharedState,
+                        bsl::size_t bytes)
+{
+    if (sharedState.memoryBudget) {
+        sharedState.budgetBytes += bytes;
+        sharedState.memoryBudget->acquire(bytes);
+    }
+}
+
+/// Return the bytes of a confirmed message to the memory budget, if there
+/// is one. Must be called with the mutex held
+void releaseMemoryBudget(ProducerImpl::SharedState& sharedState,
+                         bsl::size_t bytes)
+{
+    if (sharedState.memoryBudget) {
+        bytes = bsl::min(bytes, sharedState.budgetBytes);
+        sharedState.budgetBytes -= bytes;
+        sharedState.memoryBudget->release(bytes);
+    }
+}
+
+/// Publish spooled messages, oldest first, for as long as the unconfirmed
+/// message limit has room for them, and wake any sender waiting for the
+/// spool to accept sends. Must be called with the mutex held
+void drainSpool(ProducerImpl::SharedState& sharedState)
+{
+    PublishSpool& spool = *sharedState.spool;
+
+    PublishSpool::Entry entry;
+    while (!spool.empty() && !sharedState.outstandingMessagesCap.tryWait()) {
+        spool.pop(&entry);
+        chargeMemoryBudget(sharedState, entry.message.payloadSize());
+        sharedState.publishSpooled(entry);
+    }
+
+    if (spool.accepting()) {
+        sharedState.spoolAccepting.broadcast();
+    }
+}
+
+/// Publish `message`, which was posted to the event loop as a handle so that
+/// the posted job does not copy the message itself
+void publishRoutedMessage(const bsl::shared_ptr<rmqamqp::SendChannel>& channel,
+                          const rmqamqp::MessageWithRoute& message)
+{
+    channel->publishMessage(
+        message.message(), message.routingKey(), message.mandatory());
+}
+
+/// Publish `message` ahead of any messages pending on `channel`
+void publishUrgentMessage(const bsl::shared_ptr<rmqamqp::SendChannel>& channel,
+                          const rmqamqp::MessageWithRoute& message)
+{
+    channel->publishUrgent(
+        message.message(), message.routingKey(), message.mandatory());
+}
+
+/// Record how long `message` waited for the event loop since it was sent at
+/// `sentAt`, then publish it
+void publishTimedMessage(const bsl::shared_ptr<rmqamqp::SendChannel>& channel,
+                         const rmqamqp::MessageWithRoute& message,
+                         bsls::Types::Int64 sentAt)
+{
+    channel->recordPipelineStage(rmqamqp::PipelineStage::SEND_QUEUE, sentAt);
+    publishRoutedMessage(channel, message);
+}
+
+void publishSpooledMessage(
+    rmqio::EventLoop& eventLoop,
+    const bsl::weak_ptr<rmqamqp::SendChannel>& weakChannel,
+    const PublishSpool::Entry& entry)
+{
+    bsl::shared_ptr<rmqamqp::SendChannel> channel = weakChannel.lock();
+    if (!channel) {
+        return;
+    }
+
+    // Queued by the channel while it reconnects, and resent once it is ready
+    eventLoop.post(bdlf::BindUtil::bind(&rmqamqp::SendChannel::publishMessage,
+                                        channel,
+                                        entry.message,
+                                        entry.routingKey,
+                                        entry.mandatory));
+}
+
+/// Return the writable callback if trySend is waiting for capacity and
+/// enough is now available, clearing the wait. Otherwise return an empty
+/// callback. Must be called with the mutex held
+rmqp::Producer::WritableCallback
+takeWritableCallback(ProducerImpl::SharedState& sharedState)
+{
+    if (!sharedState.writablePending || !sharedState.writableCallback ||
+        availableCapacity(sharedState) < sharedState.writableThreshold) {
+        return rmqp::Producer::WritableCallback();
+    }
+
+    sharedState.writablePending = false;
+    return sharedState.writableCallback;
+}
+
+void scheduleWritableCallback(
+    bdlmt::ThreadPool& threadPool,
+    const rmqp::Producer::WritableCallback& writableCallback)
+{
+    int rc = threadPool.enqueueJob(writableCallback);
+
+    if (rc != 0) {
+        BALL_LOG_ERROR << "Couldn't enqueue thread pool job for producer "
+                          "writable callback (return code "
+                       << rc << ")";
+    }
+}
+
+void awaitCapacity(
+    const bsl::shared_ptr<ProducerImpl::SharedState>& sharedState);
+
+/// Invoke the writable callback if it is still due, now that the memory
+/// budget has room
+void onMemoryBudgetRoom(
+    const bsl::weak_ptr<ProducerImpl::SharedState>& weakState)
+{
+    bsl::shared_ptr<ProducerImpl::SharedState> sharedState = weakState.lock();
+    if (!sharedState) {
+        return;
+    }
+
+    rmqp::Producer::WritableCallback writableCallback;
+    {
+        bslmt::LockGuard<bslmt::Mutex> guard(&(sharedState->mutex));
+        sharedState->budgetWaitPending = false;
+        if (!sharedState->isValid) {
+            return;
+        }
+
+        writableCallback = takeWritableCallback(*sharedState);
+        if (!writableCallback) {
+            // Exhausted again already, or the gate is closed
+            awaitCapacity(sharedState);
+        }
+    }
+
+    if (writableCallback) {
+        writableCallback();
+    }
+}
+
+void scheduleMemoryBudgetRoom(
+    bdlmt::ThreadPool& threadPool,
+    const bsl::weak_ptr<ProducerImpl::SharedState>& weakState)
+{
+    // Never run on the releasing thread, which may hold the mutex
+    int rc = threadPool.enqueueJob(
+        bdlf::BindUtil::bind(&onMemoryBudgetRoom, weakState));
+
+    if (rc != 0) {
+        BALL_LOG_ERROR << "Couldn't enqueue thread pool job for producer "
+                          "memory budget wakeup (return code "
+                       << rc << ")";
+    }
+}
+
+/// If the writable callback is due but held back by an exhausted memory
+/// budget, have the budget report back once it has room. Must be called
+/// with the mutex held
+void awaitMemoryBudget(
     const bsl::shared_ptr<ProducerImpl::SharedState>& sharedState)
 {
-    bslmt::LockGuard<bslmt::Mutex> guard(&(sharedState->mutex));
+    if (!sharedState->memoryBudget || !sharedState->writablePending ||
+        sharedState->budgetWaitPending ||
+        !sharedState->memoryBudget->exhausted()) {
+        return;
+    }
 
-    if (!(sharedState->isValid)) {
-        BALL_LOG_ERROR << "Received publisher confirmation for message "
-                       << message.guid() << " after closing the producer";
+    sharedState->budgetWaitPending = true;
+    sharedState->memoryBudget->notifyWhenRoom(
+        bdlf::BindUtil::bind(&scheduleMemoryBudgetRoom,
+                             bsl::ref(sharedState->threadPool),
+                             bsl::weak_ptr<ProducerImpl::SharedState>(
+                                 sharedState)));
+}
+
+/// Invoke the writable callback if it is still due, now that the publish
+/// gate is open
+void onPublishGateOpen(
+    const bsl::weak_ptr<ProducerImpl::SharedState>& weakState)
+{
+    bsl::shared_ptr<ProducerImpl::SharedState> sharedState = weakState.lock();
+    if (!sharedState) {
         return;
     }
 
-    ProducerImpl::CallbackMap::iterator it =
-        sharedState->callbackMap.find(message.guid());
+    rmqp::Producer::WritableCallback writableCallback;
+    {
+        bslmt::LockGuard<bslmt::Mutex> guard(&(sharedState->mutex));
+        sharedState->gateWaitPending = false;
+        if (!sharedState->isValid) {
+            return;
+        }
 
-    if (it == sharedState->callbackMap.end()) {
+        writableCallback = takeWritableCallback(*sharedState);
+        if (!writableCallback) {
+            awaitCapacity(sharedState);
+        }
+    }
+
+    if (writableCallback) {
+        writableCallback();
+    }
+}
+
+void schedulePublishGateOpen(
+    bdlmt::ThreadPool& threadPool,
+    const bsl::weak_ptr<ProducerImpl::SharedState>& weakState)
+{
+    // Never run on the event loop thread opening the gate
+    int rc = threadPool.enqueueJob(
+        bdlf::BindUtil::bind(&onPublishGateOpen, weakState));
+
+    if (rc != 0) {
+        BALL_LOG_ERROR << "Couldn't enqueue thread pool job for producer "
+                          "publish gate wakeup (return code "
+                       << rc << ")";
+    }
+}
+
+/// If the writable callback is due but held back by a closed publish gate,
+/// have the gate report back once it opens. Must be called with the mutex
+/// held
+void awaitPublishGate(
+    const bsl::shared_ptr<ProducerImpl::SharedState>& sharedState)
+{
+    if (!sharedState->publishGate || !sharedState->writablePending ||
+        sharedState->gateWaitPending ||
+        !sharedState->publishGate->isClosed()) {
+        return;
+    }
+
+    sharedState->gateWaitPending = true;
+    sharedState->publishGate->notifyWhenOpen(
+        bdlf::BindUtil::bind(&schedulePublishGateOpen,
+                             bsl::ref(sharedState->threadPool),
+                             bsl::weak_ptr<ProducerImpl::SharedState>(
+                                 sharedState)));
+}
+
+/// Invoke the writable callback if it is still due, now that the rate
+/// limiter should allow a send
+void onRateLimiterRoom(
+    const bsl::weak_ptr<ProducerImpl::SharedState>& weakState)
+{
+    bsl::shared_ptr<ProducerImpl::SharedState> sharedState = weakState.lock();
+    if (!sharedState) {
+        return;
+    }
+
+    rmqp::Producer::WritableCallback writableCallback;
+    {
+        bslmt::LockGuard<bslmt::Mutex> guard(&(sharedState->mutex));
+        sharedState->rateWaitPending = false;
+        if (!sharedState->isValid) {
+            return;
+        }
+
+        writableCallback = takeWritableCallback(*sharedState);
+        if (!writableCallback) {
+            // Other producers sharing the limit got there first
+            awaitCapacity(sharedState);
+        }
+    }
+
+    if (writableCallback) {
+        writableCallback();
+    }
+}
+
+void onRateTimer(const bsl::weak_ptr<ProducerImpl::SharedState>& weakState,
+                 rmqio::Timer::InterruptReason reason)
+{
+    bsl::shared_ptr<ProducerImpl::SharedState> sharedState = weakState.lock();
+    if (reason != rmqio::Timer::EXPIRE || !sharedState) {
+        return;
+    }
+
+    // Never run the writable callback on the event loop thread
+    int rc = sharedState->threadPool.enqueueJob(
+        bdlf::BindUtil::bind(&onRateLimiterRoom, weakState));
+
+    if (rc != 0) {
+        BALL_LOG_ERROR << "Couldn't enqueue thread pool job for producer "
+                          "rate limit wakeup (return code "
+                       << rc << ")";
+    }
+}
+
+/// If the writable callback is due but held back by the rate limiter, have
+/// the rate timer report back once the limiter allows enough sends. Must be
+/// called with the mutex held
+void awaitRateLimiter(
+    const bsl::shared_ptr<ProducerImpl::SharedState>& sharedState)
+{
+    if (!sharedState->rateLimiter || !sharedState->writablePending ||
+        sharedState->rateWaitPending) {
+        return;
+    }
+
+    const bsls::TimeInterval delay =
+        sharedState->rateLimiter->delay(sharedState->writableThreshold);
+    if (delay == bsls::TimeInterval()) {
+        return;
+    }
+
+    sharedState->rateWaitPending = true;
+    sharedState->eventLoop->post(bdlf::BindUtil::bind(
+        &rmqio::Timer::reset, sharedState->rateTimer, delay));
+}
+
+/// Have whichever of the memory budget, publish gate and rate limiter holds
+/// back the due writable callback report back once it no longer does. Must
+/// be called with the mutex held
+void awaitCapacity(
+    const bsl::shared_ptr<ProducerImpl::SharedState>& sharedState)
+{
+    awaitMemoryBudget(sharedState);
+    awaitPublishGate(sharedState);
+    awaitRateLimiter(sharedState);
+}
+
+/// Return the stripe tracking the unconfirmed message with `guid`
+ProducerImpl::CallbackStripe& stripeFor(ProducerImpl::SharedState& sharedState,
+                                        const bdlb::Guid& guid)
+{
+    return sharedState.callbackStripes[bsl::hash<bdlb::Guid>()(guid) %
+                                       ProducerImpl::k_CALLBACK_STRIPES];
+}
+
+/// Return true if a message with `guid` is unconfirmed
+bool isPending(ProducerImpl::SharedState& sharedState, const bdlb::Guid& guid)
+{
+    ProducerImpl::CallbackStripe& stripe = stripeFor(sharedState, guid);
+    bslmt::LockGuard<bslmt::Mutex> guard(&stripe.mutex);
+
+    return stripe.callbacks.count(guid) != 0;
+}
+
+/// Track `pending` for the unconfirmed message with `guid`. Return false,
+/// tracking nothing, if a message with `guid` is already unconfirmed
+bool insertPending(ProducerImpl::SharedState& sharedState,
+                   const bdlb::Guid& guid,
+                   const ProducerImpl::PendingConfirm& pending)
+{
+    ProducerImpl::CallbackStripe& stripe = stripeFor(sharedState, guid);
+    bslmt::LockGuard<bslmt::Mutex> guard(&stripe.mutex);
+
+    if (!stripe.callbacks.insert(bsl::make_pair(guid, pending)).second) {
+        return false;
+    }
+    ++sharedState.pendingConfirms;
+    return true;
+}
+
+/// Stop tracking the unconfirmed message with `guid`, loading what was
+/// tracked for it into `pending` if specified. Return false if no message
+/// with `guid` is unconfirmed
+bool erasePending(ProducerImpl::SharedState& sharedState,
+                  const bdlb::Guid& guid,
+                  ProducerImpl::PendingConfirm* pending = 0)
+{
+    ProducerImpl::CallbackStripe& stripe = stripeFor(sharedState, guid);
+    bslmt::LockGuard<bslmt::Mutex> guard(&stripe.mutex);
+
+    ProducerImpl::CallbackMap::iterator it = stripe.callbacks.find(guid);
+    if (it == stripe.callbacks.end()) {
+        return false;
+    }
+    if (pending) {
+        *pending = it->second;
+    }
+    stripe.callbacks.erase(it);
+    --sharedState.pendingConfirms;
+    return true;
+}
+
+/// Return the sequence number of the next sequenced message, tracking it as
+/// unconfirmed. Must be called with the mutex held
+bsl::uint64_t nextSequenceNumber(ProducerImpl::SharedState& sharedState)
+{
+    sharedState.sequenceWindow.push_back(0);
+    return ++sharedState.lastSequenceNumber;
+}
+
+/// Record that `sequenceNumber` is confirmed with `confirmResponse`,
+/// advancing the confirmed watermark past any run of confirmed sequence
+/// numbers it completes. Must be called with the mutex held
+void confirmSequence(bsl::uint64_t sequenceNumber,
+                     const rmqt::ConfirmResponse& confirmResponse,
+                     ProducerImpl::SharedState& sharedState)
+{
+    if (confirmResponse.status() != rmqt::ConfirmResponse::ACK) {
+        sharedState.failedSequences[sequenceNumber] = confirmResponse;
+    }
+
+    bsl::uint64_t confirmedThrough = sharedState.confirmedThrough.load();
+    bsl::deque<char>& window = sharedState.sequenceWindow;
+    window[sequenceNumber - confirmedThrough - 1] = 1;
+
+    while (!window.empty() && window.front()) {
+        window.pop_front();
+        ++confirmedThrough;
+    }
+    sharedState.confirmedThrough.storeRelease(confirmedThrough);
+}
+
+/// Invoke the confirm callback for `message`, or record its sequence
+/// number as confirmed if it was sent sequenced, and release its
+/// unconfirmed message slot. Must be called with the mutex held
+void confirmMessage(const rmqt::Message& message,
+                    const bsl::string& routingKey,
+                    const rmqt::ConfirmResponse& confirmResponse,
+                    ProducerImpl::SharedState& sharedState)
+{
+    ProducerImpl::PendingConfirm pending;
+    if (!erasePending(sharedState, message.guid(), &pending)) {
         BALL_LOG_FATAL
             << "Failed to find Producer callback to invoke for message: "
             << message.guid()
@@ -66,46 +520,352 @@ void actionConfirmOnThreadPool(
         return;
     }
 
-    BALL_LOG_TRACE << confirmResponse << " for " << message;
+    RMQT_LOG_TRACE << confirmResponse << " for " << message;
+
+    if (pending.urgent) {
+        sharedState.urgentMessagesCap.post();
+    }
+    else {
+        sharedState.outstandingMessagesCap.post();
+    }
+    releaseMemoryBudget(sharedState, message.payloadSize());
+
+    if (pending.callback) {
+        pending.callback(message, routingKey, confirmResponse);
+    }
+    else if (pending.sequenceNumber) {
+        confirmSequence(pending.sequenceNumber, confirmResponse, sharedState);
+    }
+}
+
+void actionConfirmsOnThreadPool(
+    const bsl::shared_ptr<const rmqamqp::SendChannel::ConfirmationBatch>&
+        confirmations,
+    const bsl::shared_ptr<ProducerImpl::SharedState>& sharedState)
+{
+    rmqp::Producer::WritableCallback writableCallback;
+    {
+        bslmt::LockGuard<bslmt::Mutex> guard(&(sharedState->mutex));
+
+        if (!(sharedState->isValid)) {
+            BALL_LOG_ERROR << "Received " << confirmations->size()
+                           << " publisher confirmation(s) after closing the "
+                              "producer";
+            return;
+        }
+
+        for (rmqamqp::SendChannel::ConfirmationBatch::const_iterator it =
+                 confirmations->begin();
+             it != confirmations->end();
+             ++it) {
+            confirmMessage(it->first.message(),
+                           it->first.routingKey(),
+                           it->second,
+                           *sharedState);
+        }
 
-    sharedState->outstandingMessagesCap.post();
+        if (sharedState->spool) {
+            drainSpool(*sharedState);
+        }
 
-    it->second(message, routingKey, confirmResponse);
+        if (sharedState->pendingConfirms.load() == 0 &&
+            sharedState->waitForConfirmsFuture) {
+            sharedState->waitForConfirmsFuture->first(rmqt::Result<>());
+            sharedState->waitForConfirmsFuture.reset();
+        }
 
-    sharedState->callbackMap.erase(it);
+        writableCallback = takeWritableCallback(*sharedState);
+        if (!writableCallback) {
+            awaitCapacity(sharedState);
+        }
+    }
 
-    if (sharedState->callbackMap.size() == 0 &&
-        sharedState->waitForConfirmsFuture) {
-        sharedState->waitForConfirmsFuture->first(rmqt::Result<>());
-        sharedState->waitForConfirmsFuture.reset();
+    // Invoked without the mutex held, so that the callback can send
+    if (writableCallback) {
+        writableCallback();
     }
 }
 
-void handleConfirmOnEventLoop(
+void handleConfirmsOnEventLoop(
     const bsl::shared_ptr<ProducerImpl::SharedState>& sharedState,
-    const rmqt::Message& message,
-    const bsl::string& routingKey,
-    const rmqt::ConfirmResponse& confirmResponse)
+    const bsl::shared_ptr<const rmqamqp::SendChannel::ConfirmationBatch>&
+        confirmations)
 {
-    int rc = sharedState->threadPool.enqueueJob(
-        bdlf::BindUtil::bind(&actionConfirmOnThreadPool,
-                             message,
-                             routingKey,
-                             confirmResponse,
-                             sharedState));
+    // One job per broker ack/nack, however many messages it confirms
+    int rc = sharedState->threadPool.enqueueJob(bdlf::BindUtil::bind(
+        &actionConfirmsOnThreadPool, confirmations, sharedState));
 
     if (rc != 0) {
-        BALL_LOG_FATAL
-            << "Couldn't enqueue thread pool job for message confirm: "
-            << message.guid() << " (return code " << rc
-            << "). Application will NEVER be informed of confirm";
+        BALL_LOG_FATAL << "Couldn't enqueue thread pool job for "
+                       << confirmations->size() << " message confirm(s) "
+                       << "(return code " << rc
+                       << "). Application will NEVER be informed of these "
+                          "confirms";
     }
 }
 
+/// State of a streamed message, shared by its sink and the event loop
+struct StreamState {
+    explicit StreamState(
+        const bsl::shared_ptr<ProducerImpl::SharedState>& sharedState)
+    : chunkCredits(k_MAX_UNWRITTEN_CHUNKS)
+    , failed(false)
+    , released(false)
+    , producerState(sharedState)
+    {
+    }
+
+    bslmt::Semaphore chunkCredits;
+    bsls::AtomicBool failed;
+    bsls::AtomicBool released;
+    bsl::shared_ptr<ProducerImpl::SharedState> producerState;
+};
+
+/// Allow the producer to open another stream. Only the first call for a
+/// stream has an effect
+void releaseStream(StreamState& state)
+{
+    if (!state.released.testAndSwap(false, true)) {
+        state.producerState->streamOpen = false;
+    }
+}
+
+void onStreamChunkWritten(const bsl::shared_ptr<StreamState>& state)
+{
+    state->chunkCredits.post();
+}
+
+void onStreamFailed(const bsl::shared_ptr<StreamState>& state)
+{
+    state->failed = true;
+    releaseStream(*state);
+
+    // Wake up a writer waiting for a chunk to be written
+    state->chunkCredits.post(k_MAX_UNWRITTEN_CHUNKS);
+}
+
+class StreamSink : public rmqp::MessageSink {
+  public:
+    StreamSink(bsl::size_t bodySize,
+               const bsl::shared_ptr<StreamState>& state,
+               const bsl::shared_ptr<rmqamqp::SendChannel>& channel,
+               rmqio::EventLoop& eventLoop)
+    : d_remaining(bodySize)
+    , d_state(state)
+    , d_channel(channel)
+    , d_eventLoop(eventLoop)
+    {
+        if (!d_remaining) {
+            releaseStream(*d_state);
+        }
+    }
+
+    ~StreamSink() BSLS_KEYWORD_OVERRIDE
+    {
+        if (d_remaining && !d_state->failed) {
+            BALL_LOG_WARN << "Streamed message abandoned with " << d_remaining
+                          << " body bytes unwritten";
+            d_eventLoop.post(bdlf::BindUtil::bind(
+                &rmqamqp::SendChannel::abortStream, d_channel));
+        }
+        releaseStream(*d_state);
+    }
+
+    int write(const uint8_t* data, bsl::size_t length) BSLS_KEYWORD_OVERRIDE
+    {
+        if (length > d_remaining) {
+            BALL_LOG_ERROR << "Cannot write " << length
+                           << " bytes to a streamed message with "
+                           << d_remaining << " bytes remaining";
+            return -1;
+        }
+
+        if (d_state->failed) {
+            return -1;
+        }
+
+        if (!length) {
+            return 0;
+        }
+
+        d_state->chunkCredits.wait();
+        if (d_state->failed) {
+            d_state->chunkCredits.post();
+            return -1;
+        }
+
+        const bsl::shared_ptr<const bsl::vector<uint8_t> > chunk =
+            bsl::make_shared<bsl::vector<uint8_t> >(data, data + length);
+        const rmqio::Connection::SuccessWriteCallback onWritten =
+            bdlf::BindUtil::bind(&onStreamChunkWritten, d_state);
+
+        d_eventLoop.post(
+            bdlf::BindUtil::bind(&rmqamqp::SendChannel::publishStreamContent,
+                                 d_channel,
+                                 chunk,
+                                 onWritten));
+
+        d_remaining -= length;
+        if (!d_remaining) {
+            // Only after the last chunk is posted, so that the next stream
+            // begins after it on the event loop
+            releaseStream(*d_state);
+        }
+
+        return 0;
+    }
+
+    bsl::size_t remaining() const BSLS_KEYWORD_OVERRIDE
+    {
+        return d_remaining;
+    }
+
+  private:
+    bsl::size_t d_remaining;
+    bsl::shared_ptr<StreamState> d_state;
+    bsl::shared_ptr<rmqamqp::SendChannel> d_channel;
+    rmqio::EventLoop& d_eventLoop;
+};
+
+/// Gathers the confirms of the publishes of one `sendToMany`, and invokes
+/// the application's callback once the last of them arrives
+class FanOutConfirms {
+  public:
+    FanOutConfirms(
+        const rmqt::Message& message,
+        const bsl::vector<bsl::string>& routingKeys,
+        const rmqp::Producer::FanOutConfirmationCallback& callback)
+    : d_message(message)
+    , d_routingKeys(routingKeys)
+    , d_callback(callback)
+    , d_responses(routingKeys.size(),
+                  rmqt::ConfirmResponse(rmqt::ConfirmResponse::REJECT))
+    , d_remaining(static_cast<int>(routingKeys.size()))
+    {
+    }
+
+    void confirmed(bsl::size_t index,
+                   const rmqt::Message&,
+                   const bsl::string&,
+                   const rmqt::ConfirmResponse& response)
+    {
+        // Each publish is confirmed once, into its own slot. The decrement
+        // orders the slots written before it with the final read.
+        d_responses[index] = response;
+        if (--d_remaining == 0 && d_callback) {
+            d_callback(d_message, d_routingKeys, d_responses);
+        }
+    }
+
+  private:
+    rmqt::Message d_message;
+    bsl::vector<bsl::string> d_routingKeys;
+    rmqp::Producer::FanOutConfirmationCallback d_callback;
+    bsl::vector<rmqt::ConfirmResponse> d_responses;
+    bsls::AtomicInt d_remaining;
+};
+
 } // namespace
 
+ProducerImpl::Factory::Factory()
+: d_compressionCodec()
+, d_compressionMinimumSize(0)
+, d_sendTimestamps(false)
+, d_channelSharing(false)
+, d_spoolDirectory()
+, d_spoolCapacity(0)
+, d_spoolHighWaterMark(0)
+, d_spoolLowWaterMark(0)
+, d_batchMaxMessages(0)
+, d_batchMaxBytes(0)
+, d_batchMaxLinger()
+, d_lazyOpen(false)
+, d_idleClose()
+, d_memoryBudget()
+, d_producerRateLimit()
+, d_contextRateLimiter()
+{
+}
+
 ProducerImpl::Factory::~Factory() {}
 
+void ProducerImpl::Factory::setCompression(
+    const bsl::shared_ptr<rmqp::MessageCodec>& codec,
+    bsl::size_t minimumSize)
+{
+    d_compressionCodec       = codec;
+    d_compressionMinimumSize = minimumSize;
+}
+
+void ProducerImpl::Factory::setChannelSharing(bool channelSharing)
+{
+    d_channelSharing = channelSharing;
+}
+
+void ProducerImpl::Factory::setPublishSpool(const bsl::string& directory,
+                                            bsl::size_t capacity,
+                                            bsl::size_t highWaterMark,
+                                            bsl::size_t lowWaterMark)
+{
+    d_spoolDirectory     = directory;
+    d_spoolCapacity      = capacity;
+    d_spoolHighWaterMark = highWaterMark;
+    d_spoolLowWaterMark  = lowWaterMark;
+}
+
+void ProducerImpl::Factory::setBatching(bsl::size_t maxMessages,
+                                        bsl::size_t maxBytes,
+                                        const bsls::TimeInterval& maxLinger)
+{
+    d_batchMaxMessages = maxMessages;
+    d_batchMaxBytes    = maxBytes;
+    d_batchMaxLinger   = maxLinger;
+}
+
+void ProducerImpl::Factory::setLazyOpen(bool lazyOpen,
+                                        const bsls::TimeInterval& idleClose)
+{
+    d_lazyOpen  = lazyOpen;
+    d_idleClose = idleClose;
+}
+
+void ProducerImpl::Factory::setMemoryBudget(
+    const bsl::shared_ptr<rmqamqp::MemoryBudget>& budget)
+{
+    d_memoryBudget = budget;
+}
+
+void ProducerImpl::Factory::setRateLimit(
+    const bsl::optional<rmqt::RateLimit>& producerLimit,
+    const bsl::shared_ptr<rmqamqp::RateLimiter>& contextLimiter)
+{
+    d_producerRateLimit  = producerLimit;
+    d_contextRateLimiter = contextLimiter;
+}
+
+bsl::shared_ptr<rmqamqp::RateLimiter>
+ProducerImpl::Factory::createRateLimiter() const
+{
+    if (!d_producerRateLimit) {
+        return d_contextRateLimiter;
+    }
+
+    return bsl::make_shared<rmqamqp::RateLimiter>(*d_producerRateLimit,
+                                                  d_contextRateLimiter);
+}
+
+bsl::shared_ptr<PublishSpool> ProducerImpl::Factory::createPublishSpool() const
+{
+    if (!d_spoolCapacity) {
+        return bsl::shared_ptr<PublishSpool>();
+    }
+
+    return PublishSpool::create(d_spoolDirectory,
+                                d_spoolCapacity,
+                                d_spoolHighWaterMark,
+                                d_spoolLowWaterMark);
+}
+
 bsl::shared_ptr<ProducerImpl> ProducerImpl::Factory::create(
     uint16_t maxOutstandingConfirms,
     const rmqt::ExchangeHandle&,
@@ -117,6 +877,11 @@ bsl::shared_ptr<ProducerImpl> ProducerImpl::Factory::create(
         maxOutstandingConfirms, channel, threadPool, eventLoop));
 }
 
+int ProducerImpl::urgentReserve(uint16_t maxOutstandingConfirms)
+{
+    return bsl::max(1, maxOutstandingConfirms / 16);
+}
+
 ProducerImpl::ProducerImpl(uint16_t maxOutstandingConfirms,
                            const bsl::shared_ptr<rmqamqp::SendChannel>& channel,
                            bdlmt::ThreadPool& threadPool,
@@ -125,10 +890,15 @@ ProducerImpl::ProducerImpl(uint16_t maxOutstandingConfirms,
 , d_channel(channel)
 , d_sharedState(bsl::shared_ptr<SharedState>(
       new SharedState(true, threadPool, maxOutstandingConfirms)))
+, d_compressionCodec()
+, d_compressionMinimumSize(0)
+, d_sendTimestamps(false)
+, d_sharedChannel()
+, d_sharedChannelId(0)
 {
     using namespace bdlf::PlaceHolders;
-    channel->setCallback(bdlf::BindUtil::bind(
-        &handleConfirmOnEventLoop, d_sharedState, _1, _2, _3));
+    channel->setBatchCallback(
+        bdlf::BindUtil::bind(&handleConfirmsOnEventLoop, d_sharedState, _1));
 }
 
 ProducerImpl::~ProducerImpl()
@@ -138,26 +908,136 @@ ProducerImpl::~ProducerImpl()
     bslmt::LockGuard<bslmt::Mutex> guard(&(d_sharedState->mutex));
     d_sharedState->isValid = false;
 
+    // No confirm will release these now
+    releaseMemoryBudget(*d_sharedState, d_sharedState->budgetBytes);
+
+    if (d_sharedState->rateTimer) {
+        d_eventLoop.post(bdlf::BindUtil::bind(&rmqio::Timer::cancel,
+                                              d_sharedState->rateTimer));
+    }
+
+    if (d_sharedChannel) {
+        // The channel closes once its last producer releases it
+        d_sharedChannel->detach(d_sharedChannelId);
+        return;
+    }
+
     d_eventLoop.post(
         bdlf::BindUtil::bind(&rmqamqp::Channel::gracefulClose, d_channel));
 }
 
+void ProducerImpl::shareChannel(
+    const bsl::shared_ptr<SharedSendChannel>& sharedChannel)
+{
+    using namespace bdlf::PlaceHolders;
+    d_sharedChannelId = sharedChannel->attach(
+        bdlf::BindUtil::bind(&handleConfirmsOnEventLoop, d_sharedState, _1));
+    d_sharedChannel = sharedChannel;
+}
+
+void ProducerImpl::setCompression(
+    const bsl::shared_ptr<rmqp::MessageCodec>& codec,
+    bsl::size_t minimumSize)
+{
+    d_compressionCodec       = codec;
+    d_compressionMinimumSize = minimumSize;
+}
+
+void ProducerImpl::setSendTimestamps(bool enabled)
+{
+    d_sendTimestamps = enabled;
+}
+
+void ProducerImpl::setPublishSpool(const bsl::shared_ptr<PublishSpool>& spool)
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&(d_sharedState->mutex));
+    d_sharedState->spool          = spool;
+    d_sharedState->publishSpooled = bdlf::BindUtil::bind(
+        &publishSpooledMessage,
+        bsl::ref(d_eventLoop),
+        bsl::weak_ptr<rmqamqp::SendChannel>(d_channel),
+        bdlf::PlaceHolders::_1);
+}
+
+void ProducerImpl::setMemoryBudget(
+    const bsl::shared_ptr<rmqamqp::MemoryBudget>& budget)
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&(d_sharedState->mutex));
+    d_sharedState->memoryBudget = budget;
+}
+
+void ProducerImpl::setPublishGate(
+    const bsl::shared_ptr<rmqamqp::PublishGate>& gate)
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&(d_sharedState->mutex));
+    d_sharedState->publishGate = gate;
+}
+
+void ProducerImpl::setRateLimiter(
+    const bsl::shared_ptr<rmqamqp::RateLimiter>& limiter)
+{
+    bsl::shared_ptr<rmqio::Timer> timer =
+        d_eventLoop.timerFactory()->createWithCallback(bdlf::BindUtil::bind(
+            &onRateTimer,
+            bsl::weak_ptr<SharedState>(d_sharedState),
+            bdlf::PlaceHolders::_1));
+
+    d_eventLoop.post(
+        bdlf::BindUtil::bind(&rmqamqp::SendChannel::setResendRateLimiter,
+                             d_channel,
+                             limiter));
+
+    bslmt::LockGuard<bslmt::Mutex> guard(&(d_sharedState->mutex));
+    d_sharedState->rateLimiter = limiter;
+    d_sharedState->rateTimer   = timer;
+    d_sharedState->eventLoop   = &d_eventLoop;
+}
+
+rmqt::Message ProducerImpl::prepared(const rmqt::Message& message) const
+{
+    // Prepared on the sending thread, to keep the cost off the event loop.
+    // The GUID is kept, so the confirm still finds its callback
+    rmqt::Message toSend(message);
+    if (d_sendTimestamps) {
+        SendTimeUtil::stamp(&toSend, rmqio::CoarseClock::utc());
+    }
+    if (d_compressionCodec) {
+        MessageCodecUtil::compress(
+            &toSend, *d_compressionCodec, d_compressionMinimumSize);
+    }
+    return toSend;
+}
+
 bool ProducerImpl::registerUniqueCallback(
     const bdlb::Guid& guid,
-    const rmqp::Producer::ConfirmationCallback& confirmCallback)
+    const rmqp::Producer::ConfirmationCallback& confirmCallback,
+    bsl::uint64_t* sequenceNumber,
+    bool urgent)
 {
-    bslmt::LockGuard<bslmt::Mutex> guard(&(d_sharedState->mutex));
+    // Only sequenced sends take the producer's mutex, to number them in the
+    // order they are tracked
+    bslmt::LockGuard<bslmt::Mutex> guard(
+        sequenceNumber ? &(d_sharedState->mutex) : 0);
 
-    bsl::pair<ProducerImpl::CallbackMap::iterator, bool> result =
-        d_sharedState->callbackMap.insert(
-            bsl::make_pair(guid, confirmCallback));
+    PendingConfirm pending(confirmCallback, 0, urgent);
+    if (sequenceNumber) {
+        pending.sequenceNumber = d_sharedState->lastSequenceNumber + 1;
+    }
 
-    if (!result.second) {
+    if (!insertPending(*d_sharedState, guid, pending)) {
         BALL_LOG_ERROR << "Cannot send message. Encountered duplicate "
                           "outstanding message GUID: "
                        << guid;
 
-        return false;
+        return false;
+    }
+
+    if (sequenceNumber) {
+        *sequenceNumber = nextSequenceNumber(*d_sharedState);
+    }
+
+    if (d_sharedChannel) {
+        d_sharedChannel->route(guid, d_sharedChannelId);
     }
 
     return true;
@@ -194,15 +1074,67 @@ rmqp::Producer::SendStatus ProducerImpl::sendImpl(
     const bsl::string& routingKey,
     rmqt::Mandatory::Value mandatoryFlag,
     const rmqp::Producer::ConfirmationCallback& confirmCallback,
-    const bsls::TimeInterval& timeout)
+    const bsls::TimeInterval& timeout,
+    bsl::uint64_t* sequenceNumber)
 {
-    BALL_LOG_TRACE
+    if (d_sharedState->publishGate &&
+        !d_sharedState->publishGate->waitUntilOpen(timeout)) {
+        RMQT_LOG_TRACE << "Timed out waiting for the broker to unblock the "
+                          "connection for "
+                       << message;
+        return rmqp::Producer::TIMEOUT;
+    }
+
+    if (d_sharedState->memoryBudget &&
+        !d_sharedState->memoryBudget->waitForRoom(timeout)) {
+        RMQT_LOG_TRACE << "Timed out waiting on the memory budget for "
+                       << message;
+        return rmqp::Producer::TIMEOUT;
+    }
+
+    if (d_sharedState->rateLimiter &&
+        !d_sharedState->rateLimiter->acquire(message.payloadSize(), timeout)) {
+        RMQT_LOG_TRACE << "Timed out waiting on the publish rate limit for "
+                       << message;
+        return rmqp::Producer::TIMEOUT;
+    }
+
+    if (d_sharedState->spool) {
+        SpoolOutcome outcome;
+        const rmqt::Message toSend(prepared(message));
+        const rmqp::Producer::SendStatus status =
+            spoolMessage(&outcome,
+                         toSend,
+                         routingKey,
+                         mandatoryFlag,
+                         confirmCallback,
+                         timeout,
+                         true,
+                         sequenceNumber);
+        if (status != rmqp::Producer::SENDING || outcome == SPOOLED) {
+            if (status != rmqp::Producer::SENDING) {
+                releaseRate(message);
+            }
+            return status;
+        }
+        if (outcome == RESERVED) {
+            return doSend(toSend,
+                          routingKey,
+                          mandatoryFlag,
+                          confirmCallback,
+                          sequenceNumber);
+        }
+        // Too large to spool: the spool is empty, wait for the limit
+    }
+
+    RMQT_LOG_TRACE
         << "Waiting on send(exchange) outstanding message limit for message "
         << message;
 
     if (timeout.totalNanoseconds()) {
         if (d_sharedState->outstandingMessagesCap.timedWait(
                 bsls::SystemTime::nowRealtimeClock() + timeout)) {
+            releaseRate(message);
             return rmqp::Producer::TIMEOUT;
         }
     }
@@ -210,7 +1142,91 @@ rmqp::Producer::SendStatus ProducerImpl::sendImpl(
         d_sharedState->outstandingMessagesCap.wait();
     }
 
-    return doSend(message, routingKey, mandatoryFlag, confirmCallback);
+    return doSend(prepared(message),
+                  routingKey,
+                  mandatoryFlag,
+                  confirmCallback,
+                  sequenceNumber);
+}
+
+rmqp::Producer::SendStatus ProducerImpl::sendUrgent(
+    const rmqt::Message& message,
+    const bsl::string& routingKey,
+    const rmqp::Producer::ConfirmationCallback& confirmCallback,
+    const bsls::TimeInterval& timeout)
+{
+    // Not held back by the publish gate, memory budget, rate limiter or
+    // spool: urgent messages are few, and waiting behind the rest of the
+    // sends would defeat them
+    bslmt::TimedSemaphore* cap = &(d_sharedState->urgentMessagesCap);
+    bool urgent                = true;
+    if (cap->tryWait()) {
+        RMQT_LOG_TRACE << "Urgent message reserve used up, waiting on the "
+                          "outstanding message limit for "
+                       << message;
+
+        cap    = &(d_sharedState->outstandingMessagesCap);
+        urgent = false;
+        if (timeout.totalNanoseconds()) {
+            if (cap->timedWait(bsls::SystemTime::nowRealtimeClock() +
+                               timeout)) {
+                return rmqp::Producer::TIMEOUT;
+            }
+        }
+        else {
+            cap->wait();
+        }
+    }
+
+    const rmqt::Message toSend(prepared(message));
+    if (!registerUniqueCallback(toSend.guid(), confirmCallback, 0, urgent)) {
+        cap->post();
+        return rmqp::Producer::DUPLICATE;
+    }
+
+    if (d_sharedState->memoryBudget) {
+        bslmt::LockGuard<bslmt::Mutex> guard(&(d_sharedState->mutex));
+        chargeMemoryBudget(*d_sharedState, toSend.payloadSize());
+    }
+
+    d_eventLoop.post(bdlf::BindUtil::bind(
+        &publishUrgentMessage,
+        d_channel,
+        rmqamqp::MessageWithRoute(
+            toSend, routingKey, rmqt::Mandatory::RETURN_UNROUTABLE)));
+
+    return rmqp::Producer::SENDING;
+}
+
+rmqp::Producer::SendStatus
+ProducerImpl::sendSequenced(const rmqt::Message& message,
+                            const bsl::string& routingKey,
+                            bsl::uint64_t* sequenceNumber,
+                            const bsls::TimeInterval& timeout)
+{
+    BSLS_ASSERT(sequenceNumber);
+
+    return sendImpl(message,
+                    routingKey,
+                    rmqt::Mandatory::RETURN_UNROUTABLE,
+                    rmqp::Producer::ConfirmationCallback(),
+                    timeout,
+                    sequenceNumber);
+}
+
+bsl::uint64_t ProducerImpl::confirmedThrough() const
+{
+    return d_sharedState->confirmedThrough.loadAcquire();
+}
+
+rmqp::Producer::FailedSequences ProducerImpl::takeFailedSequences()
+{
+    rmqp::Producer::FailedSequences failed;
+
+    bslmt::LockGuard<bslmt::Mutex> guard(&(d_sharedState->mutex));
+    failed.swap(d_sharedState->failedSequences);
+
+    return failed;
 }
 
 rmqp::Producer::SendStatus ProducerImpl::trySend(
@@ -218,16 +1234,429 @@ rmqp::Producer::SendStatus ProducerImpl::trySend(
     const bsl::string& routingKey,
     const rmqp::Producer::ConfirmationCallback& confirmCallback)
 {
+    if (d_sharedState->publishGate && d_sharedState->publishGate->isClosed()) {
+        RMQT_LOG_TRACE << "Connection blocked by the broker";
+        awaitWritable();
+        return rmqp::Producer::INFLIGHT_LIMIT;
+    }
+
+    if (d_sharedState->memoryBudget &&
+        d_sharedState->memoryBudget->exhausted()) {
+        RMQT_LOG_TRACE << "Memory budget exhausted";
+        awaitWritable();
+        return rmqp::Producer::INFLIGHT_LIMIT;
+    }
+
+    if (d_sharedState->rateLimiter &&
+        d_sharedState->rateLimiter->tryAcquire(message.payloadSize()) >
+            bsls::TimeInterval()) {
+        RMQT_LOG_TRACE << "Publish rate limit reached";
+        awaitWritable();
+        return rmqp::Producer::INFLIGHT_LIMIT;
+    }
+
+    if (d_sharedState->spool) {
+        SpoolOutcome outcome;
+        const rmqt::Message toSend(prepared(message));
+        const rmqp::Producer::SendStatus status =
+            spoolMessage(&outcome,
+                         toSend,
+                         routingKey,
+                         rmqt::Mandatory::RETURN_UNROUTABLE,
+                         confirmCallback,
+                         bsls::TimeInterval(),
+                         false);
+        if (status == rmqp::Producer::SENDING && outcome == RESERVED) {
+            return doSend(toSend,
+                          routingKey,
+                          rmqt::Mandatory::RETURN_UNROUTABLE,
+                          confirmCallback);
+        }
+        if (status == rmqp::Producer::SENDING && outcome == SPOOLED) {
+            return status;
+        }
+        if (status == rmqp::Producer::DUPLICATE) {
+            releaseRate(message);
+            return status;
+        }
+
+        RMQT_LOG_TRACE << "Unconfirmed message limit reached and the "
+                          "publish spool is not accepting sends";
+        releaseRate(message);
+        awaitWritable();
+        return rmqp::Producer::INFLIGHT_LIMIT;
+    }
+
     if (!d_sharedState->outstandingMessagesCap.tryWait()) {
-        return doSend(message,
+        return doSend(prepared(message),
                       routingKey,
                       rmqt::Mandatory::RETURN_UNROUTABLE,
                       confirmCallback);
     }
     else {
-        BALL_LOG_TRACE << "Unconfirmed message limit already reached";
+        RMQT_LOG_TRACE << "Unconfirmed message limit already reached";
+        releaseRate(message);
+        awaitWritable();
+        return rmqp::Producer::INFLIGHT_LIMIT;
+    }
+}
+
+void ProducerImpl::releaseRate(const rmqt::Message& message)
+{
+    if (d_sharedState->rateLimiter) {
+        d_sharedState->rateLimiter->release(message.payloadSize());
+    }
+}
+
+void ProducerImpl::awaitWritable()
+{
+    rmqp::Producer::WritableCallback writableCallback;
+    {
+        bslmt::LockGuard<bslmt::Mutex> guard(&(d_sharedState->mutex));
+        d_sharedState->writablePending = true;
+
+        // Confirms may have freed capacity since tryWait failed
+        writableCallback = takeWritableCallback(*d_sharedState);
+        if (!writableCallback) {
+            awaitCapacity(d_sharedState);
+        }
+    }
+
+    if (writableCallback) {
+        scheduleWritableCallback(d_sharedState->threadPool, writableCallback);
+    }
+}
+
+void ProducerImpl::setWritableCallback(
+    const rmqp::Producer::WritableCallback& callback,
+    bsl::size_t minimumCredits)
+{
+    rmqp::Producer::WritableCallback writableCallback;
+    {
+        bslmt::LockGuard<bslmt::Mutex> guard(&(d_sharedState->mutex));
+        d_sharedState->writableCallback  = callback;
+        d_sharedState->writableThreshold = bsl::min<bsl::size_t>(
+            bsl::max<bsl::size_t>(minimumCredits, 1),
+            d_sharedState->maxOutstandingConfirms);
+
+        writableCallback = takeWritableCallback(*d_sharedState);
+    }
+
+    if (writableCallback) {
+        scheduleWritableCallback(d_sharedState->threadPool, writableCallback);
+    }
+}
+
+bsl::size_t ProducerImpl::availableCredits() const
+{
+    if (d_sharedState->spool) {
+        bslmt::LockGuard<bslmt::Mutex> guard(&(d_sharedState->mutex));
+        return availableCapacity(*d_sharedState);
+    }
+    return availableCapacity(*d_sharedState);
+}
+
+void ProducerImpl::setWriteWeight(unsigned weight)
+{
+    d_eventLoop.post(bdlf::BindUtil::bind(
+        &rmqamqp::SendChannel::setWriteWeight, d_channel, weight));
+}
+
+rmqp::Producer::SendStatus ProducerImpl::sendBatch(
+    const bsl::vector<rmqt::Message>& messages,
+    const bsl::string& routingKey,
+    const rmqp::Producer::ConfirmationCallback& confirmCallback,
+    const bsls::TimeInterval& timeout)
+{
+    return sendBatchImpl(
+        messages,
+        routingKey,
+        rmqt::Mandatory::RETURN_UNROUTABLE,
+        bsl::vector<rmqp::Producer::ConfirmationCallback>(messages.size(),
+                                                          confirmCallback),
+        timeout);
+}
+
+rmqp::Producer::SendStatus ProducerImpl::sendToMany(
+    const rmqt::Message& message,
+    const bsl::vector<bsl::string>& routingKeys,
+    const rmqp::Producer::FanOutConfirmationCallback& confirmCallback,
+    const bsls::TimeInterval& timeout)
+{
+    if (routingKeys.empty()) {
+        return rmqp::Producer::SENDING;
+    }
+
+    const bsl::shared_ptr<FanOutConfirms> confirms =
+        bsl::make_shared<FanOutConfirms>(message, routingKeys, confirmCallback);
+
+    // The first publish keeps the message's GUID, so a message already
+    // awaiting confirms is still refused as a duplicate
+    bsl::vector<rmqt::Message> messages;
+    bsl::vector<rmqp::Producer::ConfirmationCallback> callbacks;
+    messages.reserve(routingKeys.size());
+    callbacks.reserve(routingKeys.size());
+    for (bsl::size_t i = 0; i < routingKeys.size(); ++i) {
+        messages.push_back(i == 0 ? message : message.withNewGuid());
+        callbacks.push_back(bdlf::BindUtil::bind(&FanOutConfirms::confirmed,
+                                                 confirms,
+                                                 i,
+                                                 bdlf::PlaceHolders::_1,
+                                                 bdlf::PlaceHolders::_2,
+                                                 bdlf::PlaceHolders::_3));
+    }
+
+    return sendRoutedImpl(messages,
+                          routingKeys,
+                          rmqt::Mandatory::RETURN_UNROUTABLE,
+                          callbacks,
+                          timeout);
+}
+
+rmqp::Producer::SendStatus ProducerImpl::sendBatchImpl(
+    const bsl::vector<rmqt::Message>& messages,
+    const bsl::string& routingKey,
+    rmqt::Mandatory::Value mandatoryFlag,
+    const bsl::vector<rmqp::Producer::ConfirmationCallback>& confirmCallbacks,
+    const bsls::TimeInterval& timeout)
+{
+    return sendRoutedImpl(messages,
+                          bsl::vector<bsl::string>(1, routingKey),
+                          mandatoryFlag,
+                          confirmCallbacks,
+                          timeout);
+}
+
+rmqp::Producer::SendStatus ProducerImpl::sendRoutedImpl(
+    const bsl::vector<rmqt::Message>& messages,
+    const bsl::vector<bsl::string>& routingKeys,
+    rmqt::Mandatory::Value mandatoryFlag,
+    const bsl::vector<rmqp::Producer::ConfirmationCallback>& confirmCallbacks,
+    const bsls::TimeInterval& timeout)
+{
+    BSLS_ASSERT(messages.size() == confirmCallbacks.size());
+    BSLS_ASSERT(routingKeys.size() == 1 ||
+                routingKeys.size() == messages.size());
+
+    if (messages.empty()) {
+        return rmqp::Producer::SENDING;
+    }
+
+    if (messages.size() > d_sharedState->maxOutstandingConfirms) {
+        BALL_LOG_ERROR << "Cannot send batch of " << messages.size()
+                       << " messages: larger than the unconfirmed message "
+                          "limit of "
+                       << d_sharedState->maxOutstandingConfirms;
         return rmqp::Producer::INFLIGHT_LIMIT;
     }
+
+    if (d_sharedState->publishGate &&
+        !d_sharedState->publishGate->waitUntilOpen(timeout)) {
+        RMQT_LOG_TRACE << "Timed out waiting for the broker to unblock the "
+                          "connection for a batch of "
+                       << messages.size() << " messages";
+        return rmqp::Producer::TIMEOUT;
+    }
+
+    if (d_sharedState->memoryBudget &&
+        !d_sharedState->memoryBudget->waitForRoom(timeout)) {
+        RMQT_LOG_TRACE << "Timed out waiting on the memory budget for a "
+                          "batch of "
+                       << messages.size() << " messages";
+        return rmqp::Producer::TIMEOUT;
+    }
+
+    RMQT_LOG_TRACE << "Waiting on sendBatch(exchange) outstanding message "
+                      "limit for "
+                   << messages.size() << " messages";
+
+    const rmqp::Producer::SendStatus reserved =
+        reserveOutstanding(messages.size(), timeout);
+    if (reserved != rmqp::Producer::SENDING) {
+        return reserved;
+    }
+
+    if (!registerUniqueCallbacks(messages, confirmCallbacks)) {
+        d_sharedState->outstandingMessagesCap.post(
+            static_cast<int>(messages.size()));
+        return rmqp::Producer::DUPLICATE;
+    }
+
+    // Prepared here, on the sending thread, to keep the cost off the event
+    // loop. GUIDs are kept, so confirms still find their callbacks
+    const bool prepare = d_compressionCodec || d_sendTimestamps;
+    bsl::vector<rmqt::Message> preparedMessages;
+    if (prepare) {
+        preparedMessages.reserve(messages.size());
+        for (bsl::vector<rmqt::Message>::const_iterator it = messages.begin();
+             it != messages.end();
+             ++it) {
+            preparedMessages.push_back(prepared(*it));
+        }
+    }
+
+    const bsl::vector<rmqt::Message>& toSend =
+        prepare ? preparedMessages : messages;
+    if (d_sharedState->memoryBudget) {
+        bsl::size_t bytes = 0;
+        for (bsl::vector<rmqt::Message>::const_iterator it = toSend.begin();
+             it != toSend.end();
+             ++it) {
+            bytes += it->payloadSize();
+        }
+
+        bslmt::LockGuard<bslmt::Mutex> guard(&(d_sharedState->mutex));
+        chargeMemoryBudget(*d_sharedState, bytes);
+    }
+
+    if (routingKeys.size() == 1) {
+        d_eventLoop.post(bdlf::BindUtil::bind(
+            &rmqamqp::SendChannel::publishMessages,
+            d_channel,
+            toSend,
+            routingKeys.front(),
+            mandatoryFlag));
+    }
+    else {
+        d_eventLoop.post(
+            bdlf::BindUtil::bind(&rmqamqp::SendChannel::publishToMany,
+                                 d_channel,
+                                 toSend,
+                                 routingKeys,
+                                 mandatoryFlag));
+    }
+
+    return rmqp::Producer::SENDING;
+}
+
+rmqp::Producer::SendStatus
+ProducerImpl::reserveOutstanding(bsl::size_t count,
+                                 const bsls::TimeInterval& timeout)
+{
+    bslmt::TimedSemaphore& cap       = d_sharedState->outstandingMessagesCap;
+    bslmt::TimedSemaphore& batchLock = d_sharedState->batchReserveLock;
+    const bool hasTimeout            = timeout.totalNanoseconds() != 0;
+    const bsls::TimeInterval deadline =
+        bsls::SystemTime::nowRealtimeClock() + timeout;
+
+    if (hasTimeout) {
+        if (batchLock.timedWait(deadline)) {
+            return rmqp::Producer::TIMEOUT;
+        }
+    }
+    else {
+        batchLock.wait();
+    }
+
+    bsl::size_t acquired = 0;
+    for (; acquired < count; ++acquired) {
+        if (hasTimeout) {
+            if (cap.timedWait(deadline)) {
+                break;
+            }
+        }
+        else {
+            cap.wait();
+        }
+    }
+
+    batchLock.post();
+
+    if (acquired < count) {
+        if (acquired) {
+            cap.post(static_cast<int>(acquired));
+        }
+        return rmqp::Producer::TIMEOUT;
+    }
+
+    return rmqp::Producer::SENDING;
+}
+
+bool ProducerImpl::registerUniqueCallbacks(
+    const bsl::vector<rmqt::Message>& messages,
+    const bsl::vector<rmqp::Producer::ConfirmationCallback>& confirmCallbacks)
+{
+    for (bsl::size_t i = 0; i < messages.size(); ++i) {
+        if (!insertPending(
+                *d_sharedState, messages[i].guid(), confirmCallbacks[i])) {
+            BALL_LOG_ERROR << "Cannot send batch. Encountered duplicate "
+                              "outstanding message GUID: "
+                           << messages[i].guid();
+
+            // Roll back the callbacks registered for this batch
+            for (bsl::size_t j = 0; j < i; ++j) {
+                erasePending(*d_sharedState, messages[j].guid());
+            }
+            return false;
+        }
+    }
+
+    if (d_sharedChannel) {
+        for (bsl::size_t i = 0; i < messages.size(); ++i) {
+            d_sharedChannel->route(messages[i].guid(), d_sharedChannelId);
+        }
+    }
+
+    return true;
+}
+
+rmqt::Result<rmqp::MessageSink> ProducerImpl::openStream(
+    const rmqt::Message& message,
+    bsl::size_t bodySize,
+    const bsl::string& routingKey,
+    const rmqp::Producer::ConfirmationCallback& confirmCallback,
+    const bsls::TimeInterval& timeout)
+{
+    if (d_sharedState->streamOpen.testAndSwap(false, true)) {
+        return rmqt::Result<rmqp::MessageSink>(
+            "Another streamed message is still being written",
+            rmqp::Producer::INFLIGHT_LIMIT);
+    }
+
+    if (d_sharedState->publishGate &&
+        !d_sharedState->publishGate->waitUntilOpen(timeout)) {
+        d_sharedState->streamOpen = false;
+        return rmqt::Result<rmqp::MessageSink>(
+            "Timed out waiting for the broker to unblock the connection",
+            rmqp::Producer::TIMEOUT);
+    }
+
+    const rmqp::Producer::SendStatus reserved =
+        reserveOutstanding(1, timeout);
+    if (reserved != rmqp::Producer::SENDING) {
+        d_sharedState->streamOpen = false;
+        return rmqt::Result<rmqp::MessageSink>(
+            "Timed out waiting on the unconfirmed message limit", reserved);
+    }
+
+    if (!registerUniqueCallback(message.guid(), confirmCallback)) {
+        d_sharedState->outstandingMessagesCap.post();
+        d_sharedState->streamOpen = false;
+        return rmqt::Result<rmqp::MessageSink>(
+            "Duplicate outstanding message GUID", rmqp::Producer::DUPLICATE);
+    }
+
+    if (d_sharedState->memoryBudget) {
+        // Balances the release on confirm, which carries `message` as given
+        bslmt::LockGuard<bslmt::Mutex> guard(&(d_sharedState->mutex));
+        chargeMemoryBudget(*d_sharedState, message.payloadSize());
+    }
+
+    const bsl::shared_ptr<StreamState> state =
+        bsl::make_shared<StreamState>(d_sharedState);
+    const rmqamqp::SendChannel::StreamFailureCallback onFailure =
+        bdlf::BindUtil::bind(&onStreamFailed, state);
+
+    d_eventLoop.post(bdlf::BindUtil::bind(&rmqamqp::SendChannel::beginStream,
+                                          d_channel,
+                                          message,
+                                          bodySize,
+                                          routingKey,
+                                          rmqt::Mandatory::RETURN_UNROUTABLE,
+                                          onFailure));
+
+    return rmqt::Result<rmqp::MessageSink>(bsl::shared_ptr<rmqp::MessageSink>(
+        new StreamSink(bodySize, state, d_channel, d_eventLoop)));
 }
 
 rmqt::Future<>
@@ -242,23 +1671,125 @@ rmqp::Producer::SendStatus ProducerImpl::doSend(
     const rmqt::Message& message,
     const bsl::string& routingKey,
     const rmqt::Mandatory::Value mandatory,
-    const rmqp::Producer::ConfirmationCallback& confirmCallback)
+    const rmqp::Producer::ConfirmationCallback& confirmCallback,
+    bsl::uint64_t* sequenceNumber)
 {
-    BALL_LOG_TRACE << "Below confirm limit";
+    RMQT_LOG_TRACE << "Below confirm limit";
 
-    if (!registerUniqueCallback(message.guid(), confirmCallback)) {
+    if (!registerUniqueCallback(
+            message.guid(), confirmCallback, sequenceNumber)) {
         return rmqp::Producer::DUPLICATE;
     }
 
-    d_eventLoop.post(bdlf::BindUtil::bind(&rmqamqp::SendChannel::publishMessage,
-                                          d_channel,
-                                          message,
-                                          routingKey,
-                                          mandatory));
+    if (d_sharedState->memoryBudget) {
+        bslmt::LockGuard<bslmt::Mutex> guard(&(d_sharedState->mutex));
+        chargeMemoryBudget(*d_sharedState, message.payloadSize());
+    }
+
+    const rmqamqp::MessageWithRoute route(message, routingKey, mandatory);
+
+    const bsls::Types::Int64 sentAt = rmqio::PipelineClock::now();
+    if (sentAt) {
+        d_eventLoop.post(bdlf::BindUtil::bind(
+            &publishTimedMessage, d_channel, route, sentAt));
+        return rmqp::Producer::SENDING;
+    }
+
+    d_eventLoop.post(
+        bdlf::BindUtil::bind(&publishRoutedMessage, d_channel, route));
 
     return rmqp::Producer::SENDING;
 }
 
+rmqp::Producer::SendStatus ProducerImpl::spoolMessage(
+    SpoolOutcome* outcome,
+    const rmqt::Message& message,
+    const bsl::string& routingKey,
+    rmqt::Mandatory::Value mandatoryFlag,
+    const rmqp::Producer::ConfirmationCallback& confirmCallback,
+    const bsls::TimeInterval& timeout,
+    bool wait,
+    bsl::uint64_t* sequenceNumber)
+{
+    const bool hasTimeout = timeout.totalNanoseconds() != 0;
+    const bsls::TimeInterval deadline =
+        bsls::SystemTime::nowRealtimeClock() + timeout;
+
+    bslmt::LockGuard<bslmt::Mutex> guard(&(d_sharedState->mutex));
+    PublishSpool& spool = *d_sharedState->spool;
+
+    for (;;) {
+        if (isPending(*d_sharedState, message.guid())) {
+            BALL_LOG_ERROR << "Cannot send message. Encountered duplicate "
+                              "outstanding message GUID: "
+                           << message.guid();
+            return rmqp::Producer::DUPLICATE;
+        }
+
+        // Publish what the limit has room for first, so that this message
+        // cannot overtake a spooled one
+        drainSpool(*d_sharedState);
+
+        if (spool.empty()) {
+            if (!d_sharedState->outstandingMessagesCap.tryWait()) {
+                *outcome = RESERVED;
+                return rmqp::Producer::SENDING;
+            }
+            if (message.payloadSize() > spool.capacity()) {
+                *outcome = TOO_LARGE;
+                return rmqp::Producer::SENDING;
+            }
+        }
+
+        // Tracked before it is spooled, as a concurrent send of the same
+        // GUID does not take the mutex
+        ProducerImpl::PendingConfirm pending(confirmCallback);
+        if (sequenceNumber) {
+            pending.sequenceNumber = d_sharedState->lastSequenceNumber + 1;
+        }
+        if (!insertPending(*d_sharedState, message.guid(), pending)) {
+            BALL_LOG_ERROR << "Cannot send message. Encountered duplicate "
+                              "outstanding message GUID: "
+                           << message.guid();
+            return rmqp::Producer::DUPLICATE;
+        }
+
+        if (spool.push(message, routingKey, mandatoryFlag)) {
+            if (sequenceNumber) {
+                *sequenceNumber = nextSequenceNumber(*d_sharedState);
+            }
+            if (d_sharedChannel) {
+                d_sharedChannel->route(message.guid(), d_sharedChannelId);
+            }
+
+            RMQT_LOG_TRACE << "Unconfirmed message limit reached, spooled "
+                           << message << ". " << spool.count()
+                           << " messages (" << spool.bytes()
+                           << " bytes) spooled";
+            *outcome = SPOOLED;
+            return rmqp::Producer::SENDING;
+        }
+        erasePending(*d_sharedState, message.guid());
+
+        if (!wait) {
+            return rmqp::Producer::INFLIGHT_LIMIT;
+        }
+
+        RMQT_LOG_TRACE << "Waiting for the publish spool to drain below its "
+                          "low-water mark";
+        if (hasTimeout) {
+            if (bslmt::Condition::e_TIMED_OUT ==
+                d_sharedState->spoolAccepting.timedWait(
+                    &(d_sharedState->mutex), deadline)) {
+                return rmqp::Producer::TIMEOUT;
+            }
+        }
+        else {
+            d_sharedState->spoolAccepting.wait(&(d_sharedState->mutex));
+        }
+    }
+}
+
 rmqt::Result<> ProducerImpl::waitForConfirms(const bsls::TimeInterval& timeout)
 {
     rmqt::Result<> result;
@@ -267,7 +1798,7 @@ rmqt::Result<> ProducerImpl::waitForConfirms(const bsls::TimeInterval& timeout)
 
     {
         bslmt::LockGuard<bslmt::Mutex> guard(&(d_sharedState->mutex));
-        if (d_sharedState->callbackMap.size() > 0) {
+        if (d_sharedState->pendingConfirms.load() > 0) {
             outstandingConfirms = true;
             if (d_sharedState->waitForConfirmsFuture) {
                 waitForConfirmsFuture =
@@ -16,27 +16,42 @@
 #ifndef INCLUDED_RMQA_PRODUCERIMPL
 #define INCLUDED_RMQA_PRODUCERIMPL
 
+#include <rmqp_messagecodec.h>
+#include <rmqp_messagesink.h>
 #include <rmqp_producer.h>
 #include <rmqt_endpoint.h>
 #include <rmqt_exchange.h>
 #include <rmqt_future.h>
 #include <rmqt_message.h>
 #include <rmqt_queue.h>
+#include <rmqt_ratelimit.h>
 #include <rmqt_result.h>
 
+#include <rmqa_publishspool.h>
+#include <rmqamqp_memorybudget.h>
+#include <rmqamqp_publishgate.h>
+#include <rmqamqp_ratelimiter.h>
 #include <rmqamqp_sendchannel.h>
 
 #include <bdlb_guid.h>
 #include <bdlmt_threadpool.h>
 #include <bslma_managedptr.h>
+#include <bslmt_condition.h>
 #include <bslmt_mutex.h>
 #include <bslmt_timedsemaphore.h>
+#include <bsls_atomic.h>
 #include <bsls_keyword.h>
 #include <bsls_timeinterval.h>
 
+#include <bsl_cstddef.h>
+#include <bsl_cstdint.h>
+#include <bsl_deque.h>
+#include <bsl_functional.h>
 #include <bsl_memory.h>
+#include <bsl_optional.h>
 #include <bsl_string.h>
 #include <bsl_unordered_map.h>
+#include <bsl_vector.h>
 
 //@PURPOSE: Implements the rmqa::Producer interface
 //
@@ -46,13 +61,16 @@
 namespace BloombergLP {
 namespace rmqio {
 class EventLoop;
-}
+class Timer;
+} // namespace rmqio
 namespace rmqa {
+class SharedSendChannel;
 
 class ProducerImpl : public rmqp::Producer {
   public:
     class Factory {
       public:
+        Factory();
         virtual ~Factory();
         virtual bsl::shared_ptr<ProducerImpl>
         create(uint16_t maxOutstandingConfirms,
@@ -60,6 +78,112 @@ class ProducerImpl : public rmqp::Producer {
                const bsl::shared_ptr<rmqamqp::SendChannel>& channel,
                bdlmt::ThreadPool& threadPool,
                rmqio::EventLoop& eventLoop) const;
+
+        /// Compression to apply to the producers created from this factory,
+        /// see `ProducerImpl::setCompression`
+        void setCompression(const bsl::shared_ptr<rmqp::MessageCodec>& codec,
+                            bsl::size_t minimumSize);
+
+        const bsl::shared_ptr<rmqp::MessageCodec>& compressionCodec() const
+        {
+            return d_compressionCodec;
+        }
+
+        bsl::size_t compressionMinimumSize() const
+        {
+            return d_compressionMinimumSize;
+        }
+
+        /// Stamp the messages of the producers created from this factory
+        /// with their send time, see `ProducerImpl::setSendTimestamps`
+        void setSendTimestamps(bool enabled)
+        {
+            d_sendTimestamps = enabled;
+        }
+
+        bool sendTimestamps() const { return d_sendTimestamps; }
+
+        /// Let producers to the same exchange and topology share one
+        /// channel, see `ProducerImpl::shareChannel`
+        void setChannelSharing(bool channelSharing);
+
+        bool channelSharing() const { return d_channelSharing; }
+
+        /// Give each producer created from this factory a publish spool,
+        /// see `ProducerImpl::setPublishSpool`. A `capacity` of 0 disables
+        /// spooling.
+        void setPublishSpool(const bsl::string& directory,
+                             bsl::size_t capacity,
+                             bsl::size_t highWaterMark,
+                             bsl::size_t lowWaterMark);
+
+        /// Return a new publish spool for a producer, or a null pointer if
+        /// spooling is disabled or the spool cannot be created
+        bsl::shared_ptr<PublishSpool> createPublishSpool() const;
+
+        /// Wrap the producers created for this factory in a
+        /// `BatchingProducer` with these limits. A `maxMessages` of 0 or 1
+        /// disables batching.
+        void setBatching(bsl::size_t maxMessages,
+                         bsl::size_t maxBytes,
+                         const bsls::TimeInterval& maxLinger);
+
+        bsl::size_t batchMaxMessages() const { return d_batchMaxMessages; }
+
+        bsl::size_t batchMaxBytes() const { return d_batchMaxBytes; }
+
+        const bsls::TimeInterval& batchMaxLinger() const
+        {
+            return d_batchMaxLinger;
+        }
+
+        /// Hand out producers which open their channel on first use, and
+        /// close it again once idle for `idleClose` (never if 0), see
+        /// `LazyProducer`
+        void setLazyOpen(bool lazyOpen, const bsls::TimeInterval& idleClose);
+
+        bool lazyOpen() const { return d_lazyOpen; }
+
+        const bsls::TimeInterval& idleClose() const { return d_idleClose; }
+
+        /// Count the producers' unconfirmed messages against `budget`, see
+        /// `ProducerImpl::setMemoryBudget`
+        void
+        setMemoryBudget(const bsl::shared_ptr<rmqamqp::MemoryBudget>& budget);
+
+        const bsl::shared_ptr<rmqamqp::MemoryBudget>& memoryBudget() const
+        {
+            return d_memoryBudget;
+        }
+
+        /// Pace each producer to `producerLimit`, if set, and all of them
+        /// together to `contextLimiter`, if set, see
+        /// `ProducerImpl::setRateLimiter`
+        void setRateLimit(
+            const bsl::optional<rmqt::RateLimit>& producerLimit,
+            const bsl::shared_ptr<rmqamqp::RateLimiter>& contextLimiter);
+
+        /// Return a new rate limiter for a producer, or a null pointer if
+        /// producers are not rate limited
+        bsl::shared_ptr<rmqamqp::RateLimiter> createRateLimiter() const;
+
+      private:
+        bsl::shared_ptr<rmqp::MessageCodec> d_compressionCodec;
+        bsl::size_t d_compressionMinimumSize;
+        bool d_sendTimestamps;
+        bool d_channelSharing;
+        bsl::string d_spoolDirectory;
+        bsl::size_t d_spoolCapacity;
+        bsl::size_t d_spoolHighWaterMark;
+        bsl::size_t d_spoolLowWaterMark;
+        bsl::size_t d_batchMaxMessages;
+        bsl::size_t d_batchMaxBytes;
+        bsls::TimeInterval d_batchMaxLinger;
+        bool d_lazyOpen;
+        bsls::TimeInterval d_idleClose;
+        bsl::shared_ptr<rmqamqp::MemoryBudget> d_memoryBudget;
+        bsl::optional<rmqt::RateLimit> d_producerRateLimit;
+        bsl::shared_ptr<rmqamqp::RateLimiter> d_contextRateLimiter;
     };
 
     // CREATORS
@@ -70,6 +194,52 @@ class ProducerImpl : public rmqp::Producer {
 
     ~ProducerImpl() BSLS_KEYWORD_OVERRIDE;
 
+    /// Compress the payload of every message of at least `minimumSize` bytes
+    /// with `codec` before it is sent, on the sending thread. Must be called
+    /// before the first send.
+    void setCompression(const bsl::shared_ptr<rmqp::MessageCodec>& codec,
+                        bsl::size_t minimumSize);
+
+    /// Stamp every message with the time it is sent, see
+    /// `SendTimeUtil`, so consumers can measure its delivery latency. Must
+    /// be called before the first send.
+    void setSendTimestamps(bool enabled);
+
+    /// Publish on `sharedChannel`, which must hold the channel this producer
+    /// was created with, alongside the other producers attached to it. Must
+    /// be called on the event loop thread before the first send.
+    void shareChannel(const bsl::shared_ptr<SharedSendChannel>& sharedChannel);
+
+    /// Spool sends in `spool` rather than block once the unconfirmed
+    /// message limit is reached. Spooled messages are published, in order,
+    /// as confirms free up the limit; while any are spooled every send is
+    /// spooled behind them. Sends block (or `trySend` returns
+    /// INFLIGHT_LIMIT) only while the spool is above its high-water mark.
+    /// Batches and streams are not spooled and may overtake spooled
+    /// messages. Must be called before the first send.
+    void setPublishSpool(const bsl::shared_ptr<PublishSpool>& spool);
+
+    /// Count the payloads of unconfirmed messages against `budget`, shared
+    /// with the rest of the context. While it is exhausted sends wait for
+    /// room (up to their timeout), `trySend` returns INFLIGHT_LIMIT and the
+    /// writable callback is held back. Must be called before the first send.
+    void setMemoryBudget(const bsl::shared_ptr<rmqamqp::MemoryBudget>& budget);
+
+    /// Hold back sends while `gate` is closed, i.e. while the broker has
+    /// blocked the connection. Sends wait for it to open (up to their
+    /// timeout), `trySend` returns INFLIGHT_LIMIT and the writable callback
+    /// is held back until it opens. Must be called before the first send.
+    void setPublishGate(const bsl::shared_ptr<rmqamqp::PublishGate>& gate);
+
+    /// Pace sends to `limiter`. Sends wait for it (up to their timeout),
+    /// `trySend` returns INFLIGHT_LIMIT and the writable callback is held
+    /// back until it allows another send. Each message counts its payload
+    /// size before compression. Batches and streams are not paced. Resends
+    /// after a reconnect are paced to it too, if the channel paces them,
+    /// see `rmqamqp::SendChannel::enableResendPacing`. Must be called
+    /// before the first send.
+    void setRateLimiter(const bsl::shared_ptr<rmqamqp::RateLimiter>& limiter);
+
     SendStatus send(const rmqt::Message& message,
                     const bsl::string& routingKey,
                     const rmqp::Producer::ConfirmationCallback& confirmCallback,
@@ -87,6 +257,48 @@ class ProducerImpl : public rmqp::Producer {
             const rmqp::Producer::ConfirmationCallback& confirmCallback)
         BSLS_KEYWORD_OVERRIDE;
 
+    void setWritableCallback(const rmqp::Producer::WritableCallback& callback,
+                             bsl::size_t minimumCredits) BSLS_KEYWORD_OVERRIDE;
+
+    bsl::size_t availableCredits() const BSLS_KEYWORD_OVERRIDE;
+
+    void setWriteWeight(unsigned weight) BSLS_KEYWORD_OVERRIDE;
+
+    SendStatus
+    sendBatch(const bsl::vector<rmqt::Message>& messages,
+              const bsl::string& routingKey,
+              const rmqp::Producer::ConfirmationCallback& confirmCallback,
+              const bsls::TimeInterval& timeout) BSLS_KEYWORD_OVERRIDE;
+
+    SendStatus sendToMany(
+        const rmqt::Message& message,
+        const bsl::vector<bsl::string>& routingKeys,
+        const rmqp::Producer::FanOutConfirmationCallback& confirmCallback,
+        const bsls::TimeInterval& timeout) BSLS_KEYWORD_OVERRIDE;
+
+    SendStatus sendUrgent(
+        const rmqt::Message& message,
+        const bsl::string& routingKey,
+        const rmqp::Producer::ConfirmationCallback& confirmCallback,
+        const bsls::TimeInterval& timeout) BSLS_KEYWORD_OVERRIDE;
+
+    SendStatus sendSequenced(const rmqt::Message& message,
+                             const bsl::string& routingKey,
+                             bsl::uint64_t* sequenceNumber,
+                             const bsls::TimeInterval& timeout)
+        BSLS_KEYWORD_OVERRIDE;
+
+    bsl::uint64_t confirmedThrough() const BSLS_KEYWORD_OVERRIDE;
+
+    FailedSequences takeFailedSequences() BSLS_KEYWORD_OVERRIDE;
+
+    rmqt::Result<rmqp::MessageSink>
+    openStream(const rmqt::Message& message,
+               bsl::size_t bodySize,
+               const bsl::string& routingKey,
+               const rmqp::Producer::ConfirmationCallback& confirmCallback,
+               const bsls::TimeInterval& timeout) BSLS_KEYWORD_OVERRIDE;
+
     rmqt::Future<> updateTopologyAsync(
         const rmqt::TopologyUpdate& topologyUpdate) BSLS_KEYWORD_OVERRIDE;
 
@@ -94,53 +306,242 @@ class ProducerImpl : public rmqp::Producer {
     waitForConfirms(const bsls::TimeInterval& timeout = bsls::TimeInterval(0))
         BSLS_KEYWORD_OVERRIDE;
 
-    typedef bsl::unordered_map<bdlb::Guid, rmqp::Producer::ConfirmationCallback>
-        CallbackMap;
+    /// Return the number of unconfirmed messages kept for `sendUrgent` on
+    /// top of `maxOutstandingConfirms`: a sixteenth of it, and at least one
+    static int urgentReserve(uint16_t maxOutstandingConfirms);
+
+    /// An unconfirmed message: the callback to invoke once it is
+    /// confirmed, or, if that is empty, the sequence number it was sent with.
+    /// `urgent` is set if it holds one of the slots reserved for urgent
+    /// messages rather than one of the unconfirmed message limit
+    struct PendingConfirm {
+        PendingConfirm(const rmqp::Producer::ConfirmationCallback& _callback =
+                           rmqp::Producer::ConfirmationCallback(),
+                       bsl::uint64_t _sequenceNumber = 0,
+                       bool _urgent                   = false)
+        : callback(_callback)
+        , sequenceNumber(_sequenceNumber)
+        , urgent(_urgent)
+        {
+        }
+
+        rmqp::Producer::ConfirmationCallback callback;
+        bsl::uint64_t sequenceNumber;
+        bool urgent;
+    };
+
+    typedef bsl::unordered_map<bdlb::Guid, PendingConfirm> CallbackMap;
+
+    /// A share of the unconfirmed messages, picked by GUID, with its own
+    /// mutex so that concurrent senders rarely contend with each other
+    struct CallbackStripe {
+        bslmt::Mutex mutex;
+        CallbackMap callbacks;
+    };
+
+    enum { k_CALLBACK_STRIPES = 16 };
 
     // State shared with event loop thread
     struct SharedState {
         SharedState(bool _isValid,
                     bdlmt::ThreadPool& _threadPool,
-                    uint16_t maxOutstandingConfirms)
-        : callbackMap()
+                    uint16_t _maxOutstandingConfirms)
+        : callbackStripes()
+        , pendingConfirms(0)
         , mutex()
         , isValid(_isValid)
         , threadPool(_threadPool)
-        , outstandingMessagesCap(maxOutstandingConfirms)
+        , maxOutstandingConfirms(_maxOutstandingConfirms)
+        , outstandingMessagesCap(_maxOutstandingConfirms)
+        , urgentMessagesCap(urgentReserve(_maxOutstandingConfirms))
+        , batchReserveLock(1)
         , waitForConfirmsFuture()
+        , writableCallback()
+        , writableThreshold(1)
+        , writablePending(false)
+        , streamOpen(false)
+        , spool()
+        , spoolAccepting()
+        , publishSpooled()
+        , memoryBudget()
+        , budgetBytes(0)
+        , budgetWaitPending(false)
+        , publishGate()
+        , gateWaitPending(false)
+        , rateLimiter()
+        , rateTimer()
+        , eventLoop(0)
+        , rateWaitPending(false)
+        , lastSequenceNumber(0)
+        , sequenceWindow()
+        , failedSequences()
+        , confirmedThrough(0)
         {
         }
 
-        // Can only be accessed when mutex is held
-        CallbackMap callbackMap;
+        // A stripe can only be accessed when its mutex is held, which may
+        // be locked while `mutex` is held but never the other way round.
+        // `pendingConfirms` counts the messages held by all stripes
+        CallbackStripe callbackStripes[k_CALLBACK_STRIPES];
+        bsls::AtomicUint64 pendingConfirms;
 
         bslmt::Mutex mutex;
         bool isValid;
         bdlmt::ThreadPool& threadPool;
+        const uint16_t maxOutstandingConfirms;
         bslmt::TimedSemaphore outstandingMessagesCap;
+
+        // Slots taken by urgent messages before they wait on
+        // `outstandingMessagesCap`, see `urgentReserve`
+        bslmt::TimedSemaphore urgentMessagesCap;
+
+        // Held while reserving capacity for a batch, so that concurrent
+        // batches cannot each hold part of the capacity the other needs
+        bslmt::TimedSemaphore batchReserveLock;
         bsl::optional<rmqt::Future<>::Pair> waitForConfirmsFuture;
+
+        // Can only be accessed when mutex is held. `writablePending` is set
+        // when trySend hits the limit, and cleared when `writableCallback`
+        // is scheduled
+        rmqp::Producer::WritableCallback writableCallback;
+        bsl::size_t writableThreshold;
+        bool writablePending;
+
+        // Set while a streamed message's body is being written
+        bsls::AtomicBool streamOpen;
+
+        // Can only be accessed when mutex is held. Messages sent while the
+        // unconfirmed message limit is reached, if spooling is enabled.
+        // `spoolAccepting` is signalled when the spool accepts sends again,
+        // and `publishSpooled` publishes a message taken from it
+        bsl::shared_ptr<PublishSpool> spool;
+        bslmt::Condition spoolAccepting;
+        bsl::function<void(const PublishSpool::Entry&)> publishSpooled;
+
+        // Set before the first send, if the context has a memory budget.
+        // `budgetBytes` (the payload bytes of this producer's unconfirmed
+        // messages) and `budgetWaitPending` (set while the budget will
+        // report back once it has room) can only be accessed when mutex is
+        // held
+        bsl::shared_ptr<rmqamqp::MemoryBudget> memoryBudget;
+        bsl::size_t budgetBytes;
+        bool budgetWaitPending;
+
+        // Set before the first send. `gateWaitPending` (set while the gate
+        // will report back once it opens) can only be accessed when mutex
+        // is held
+        bsl::shared_ptr<rmqamqp::PublishGate> publishGate;
+        bool gateWaitPending;
+
+        // Set before the first send, if sends are rate limited.
+        // `rateWaitPending` (set while `rateTimer`, run on `eventLoop`, will
+        // report back once the limiter allows a send) can only be accessed
+        // when mutex is held
+        bsl::shared_ptr<rmqamqp::RateLimiter> rateLimiter;
+        bsl::shared_ptr<rmqio::Timer> rateTimer;
+        rmqio::EventLoop* eventLoop;
+        bool rateWaitPending;
+
+        // Can only be accessed when mutex is held. `sequenceWindow` holds,
+        // for each sequence number after `confirmedThrough`, whether it is
+        // confirmed, and `failedSequences` the unacknowledged ones not yet
+        // taken
+        bsl::uint64_t lastSequenceNumber;
+        bsl::deque<char> sequenceWindow;
+        rmqp::Producer::FailedSequences failedSequences;
+
+        // Written with mutex held, readable without
+        bsls::AtomicUint64 confirmedThrough;
     };
 
+  protected:
+    /// Send `messages`, registering `confirmCallbacks[i]` for `messages[i]`
+    rmqp::Producer::SendStatus sendBatchImpl(
+        const bsl::vector<rmqt::Message>& messages,
+        const bsl::string& routingKey,
+        rmqt::Mandatory::Value mandatoryFlag,
+        const bsl::vector<rmqp::Producer::ConfirmationCallback>&
+            confirmCallbacks,
+        const bsls::TimeInterval& timeout);
+
   private:
     ProducerImpl(const ProducerImpl&) BSLS_KEYWORD_DELETED;
     ProducerImpl& operator=(const ProducerImpl&) BSLS_KEYWORD_DELETED;
 
+    /// As `sendBatchImpl`, publishing `messages[i]` with `routingKeys[i]`,
+    /// or every message with `routingKeys[0]` if there is only one
+    rmqp::Producer::SendStatus sendRoutedImpl(
+        const bsl::vector<rmqt::Message>& messages,
+        const bsl::vector<bsl::string>& routingKeys,
+        rmqt::Mandatory::Value mandatoryFlag,
+        const bsl::vector<rmqp::Producer::ConfirmationCallback>&
+            confirmCallbacks,
+        const bsls::TimeInterval& timeout);
+
+    /// Register `confirmCallback` for `guid`. If `sequenceNumber` is given,
+    /// load the number the message is tracked by into it. `urgent` is set if
+    /// the message holds a slot reserved for urgent messages
     bool registerUniqueCallback(
         const bdlb::Guid& guid,
-        const rmqp::Producer::ConfirmationCallback& confirmCallback);
+        const rmqp::Producer::ConfirmationCallback& confirmCallback,
+        bsl::uint64_t* sequenceNumber = 0,
+        bool urgent                   = false);
+
+    bool registerUniqueCallbacks(
+        const bsl::vector<rmqt::Message>& messages,
+        const bsl::vector<rmqp::Producer::ConfirmationCallback>&
+            confirmCallbacks);
+
+    /// Wait for `count` units of the unconfirmed message limit. Either all
+    /// are acquired, or none are and TIMEOUT is returned.
+    rmqp::Producer::SendStatus
+    reserveOutstanding(bsl::size_t count, const bsls::TimeInterval& timeout);
+
+    /// Note that trySend hit the unconfirmed message limit, so the writable
+    /// callback is due once enough confirms arrive
+    void awaitWritable();
+
+    /// Give the rate limiter back what `message` took, as it was not sent
+    void releaseRate(const rmqt::Message& message);
 
     rmqp::Producer::SendStatus
     doSend(const rmqt::Message& message,
            const bsl::string& routingKey,
            rmqt::Mandatory::Value mandatoryFlag,
-           const rmqp::Producer::ConfirmationCallback& confirmCallback);
+           const rmqp::Producer::ConfirmationCallback& confirmCallback,
+           bsl::uint64_t* sequenceNumber = 0);
+
+    enum SpoolOutcome {
+        SPOOLED,  // The message is spooled
+        RESERVED, // The caller holds a unit of the limit to send it with
+        TOO_LARGE // The spool is empty but can never hold the message
+    };
+
+    /// Spool `message`, unless nothing is spooled and the unconfirmed
+    /// message limit is not reached, loading the outcome into `outcome`.
+    /// While the spool does not accept the message, returns INFLIGHT_LIMIT
+    /// unless `wait`, in which case it waits up to `timeout`.
+    rmqp::Producer::SendStatus
+    spoolMessage(SpoolOutcome* outcome,
+                 const rmqt::Message& message,
+                 const bsl::string& routingKey,
+                 rmqt::Mandatory::Value mandatoryFlag,
+                 const rmqp::Producer::ConfirmationCallback& confirmCallback,
+                 const bsls::TimeInterval& timeout,
+                 bool wait,
+                 bsl::uint64_t* sequenceNumber = 0);
+
+    /// Return `message` as it is to be sent: stamped with the send time if
+    /// `setSendTimestamps` is on, and compressed if compression applies
+    rmqt::Message prepared(const rmqt::Message& message) const;
 
     rmqp::Producer::SendStatus
     sendImpl(const rmqt::Message& message,
              const bsl::string& routingKey,
              rmqt::Mandatory::Value mandatoryFlag,
              const rmqp::Producer::ConfirmationCallback& confirmCallback,
-             const bsls::TimeInterval& timeout);
+             const bsls::TimeInterval& timeout,
+             bsl::uint64_t* sequenceNumber = 0);
 
     rmqio::EventLoop& d_eventLoop;
 
@@ -148,6 +549,15 @@ class ProducerImpl : public rmqp::Producer {
 
     bsl::shared_ptr<SharedState> d_sharedState;
 
+    bsl::shared_ptr<rmqp::MessageCodec> d_compressionCodec;
+    bsl::size_t d_compressionMinimumSize;
+
+    /// See `setSendTimestamps`
+    bool d_sendTimestamps;
+
+    bsl::shared_ptr<SharedSendChannel> d_sharedChannel;
+    unsigned int d_sharedChannelId;
+
 }; // class Producer
 
 } // namespace rmqa
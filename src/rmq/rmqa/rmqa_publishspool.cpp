@@ -0,0 +1,267 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_publishspool.h>
+
+#include <rmqt_segmentedpayload.h>
+
+#include <ball_log.h>
+#include <bsls_assert.h>
+#include <bsls_platform.h>
+
+#include <bsl_algorithm.h>
+#include <bsl_cstring.h>
+#include <bsl_vector.h>
+
+#ifdef BSLS_PLATFORM_OS_UNIX
+#include <errno.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace BloombergLP {
+namespace rmqa {
+namespace {
+
+BALL_LOG_SET_NAMESPACE_CATEGORY("RMQA.PUBLISHSPOOL")
+
+/// Copy the payload of `message` to `out`
+void copyPayload(bsl::uint8_t* out, const rmqt::Message& message)
+{
+    const bsl::shared_ptr<const rmqt::SegmentedPayload> segments =
+        message.payloadSegments();
+    if (!segments) {
+        bsl::memcpy(out, message.payload(), message.payloadSize());
+        return;
+    }
+
+    for (rmqt::SegmentedPayload::const_iterator it = segments->begin();
+         it != segments->end();
+         ++it) {
+        bsl::memcpy(out, it->first, it->second);
+        out += it->second;
+    }
+}
+
+/// Map `capacity` bytes backed by a new file in `directory`, or by anonymous
+/// memory if `directory` is empty. Return a null pointer on failure
+bsl::uint8_t* mapRing(const bsl::string& directory, bsl::size_t capacity)
+{
+#ifdef BSLS_PLATFORM_OS_UNIX
+    int fd    = -1;
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    if (!directory.empty()) {
+        bsl::string path = directory + "/rmqcpp-spool-XXXXXX";
+        fd               = mkstemp(&path[0]);
+        if (fd < 0) {
+            BALL_LOG_ERROR << "Cannot create publish spool file in '"
+                           << directory << "': errno " << errno;
+            return 0;
+        }
+
+        // Only the mapping refers to the file from here on
+        unlink(path.c_str());
+
+        if (ftruncate(fd, static_cast<off_t>(capacity)) != 0) {
+            BALL_LOG_ERROR << "Cannot size publish spool file to " << capacity
+                           << " bytes: errno " << errno;
+            close(fd);
+            return 0;
+        }
+        flags = MAP_SHARED;
+    }
+
+    void* ring = mmap(0, capacity, PROT_READ | PROT_WRITE, flags, fd, 0);
+    if (fd >= 0) {
+        close(fd);
+    }
+
+    if (ring == MAP_FAILED) {
+        BALL_LOG_ERROR << "Cannot map a publish spool of " << capacity
+                       << " bytes: errno " << errno;
+        return 0;
+    }
+    return static_cast<bsl::uint8_t*>(ring);
+#else
+    if (!directory.empty()) {
+        BALL_LOG_WARN << "File backed publish spools are not supported on "
+                         "this platform, spooling to memory instead";
+    }
+    return new bsl::uint8_t[capacity];
+#endif
+}
+
+void unmapRing(bsl::uint8_t* ring, bsl::size_t capacity)
+{
+#ifdef BSLS_PLATFORM_OS_UNIX
+    munmap(ring, capacity);
+#else
+    (void)capacity;
+    delete[] ring;
+#endif
+}
+
+} // namespace
+
+bsl::shared_ptr<PublishSpool>
+PublishSpool::create(const bsl::string& directory,
+                     bsl::size_t capacity,
+                     bsl::size_t highWaterMark,
+                     bsl::size_t lowWaterMark)
+{
+    if (capacity == 0 || lowWaterMark > highWaterMark) {
+        BALL_LOG_ERROR << "Invalid publish spool: capacity " << capacity
+                       << ", high-water mark " << highWaterMark
+                       << ", low-water mark " << lowWaterMark;
+        return bsl::shared_ptr<PublishSpool>();
+    }
+
+    bsl::uint8_t* ring = mapRing(directory, capacity);
+    if (!ring) {
+        return bsl::shared_ptr<PublishSpool>();
+    }
+
+    return bsl::shared_ptr<PublishSpool>(
+        new PublishSpool(ring,
+                         capacity,
+                         bsl::min(highWaterMark, capacity),
+                         bsl::min(lowWaterMark, capacity)));
+}
+
+PublishSpool::PublishSpool(bsl::uint8_t* ring,
+                           bsl::size_t capacity,
+                           bsl::size_t highWaterMark,
+                           bsl::size_t lowWaterMark)
+: d_ring(ring)
+, d_capacity(capacity)
+, d_highWaterMark(highWaterMark)
+, d_lowWaterMark(lowWaterMark)
+, d_records()
+, d_tail(0)
+, d_wrapped(false)
+, d_bytes(0)
+, d_accepting(true)
+{
+}
+
+PublishSpool::~PublishSpool()
+{
+    if (!d_records.empty()) {
+        BALL_LOG_WARN << "Dropping " << d_records.size()
+                      << " spooled message(s) which were never published";
+    }
+    unmapRing(d_ring, d_capacity);
+}
+
+bsl::size_t PublishSpool::placement(bsl::size_t size) const
+{
+    if (d_records.empty()) {
+        return size <= d_capacity ? 0 : d_capacity;
+    }
+
+    const bsl::size_t head = d_records.front().offset;
+    if (d_wrapped) {
+        // Free space is [tail, head)
+        return d_tail + size <= head ? d_tail : d_capacity;
+    }
+
+    // Free space is [tail, capacity) and [0, head)
+    if (d_tail + size <= d_capacity) {
+        return d_tail;
+    }
+    return size <= head ? 0 : d_capacity;
+}
+
+bool PublishSpool::push(const rmqt::Message& message,
+                        const bsl::string& routingKey,
+                        rmqt::Mandatory::Value mandatory)
+{
+    if (!d_accepting) {
+        return false;
+    }
+
+    const bsl::size_t size = message.payloadSize();
+    if (size > d_capacity) {
+        return false;
+    }
+
+    const bsl::size_t offset = placement(size);
+    if (offset == d_capacity && size) {
+        // Wait for the spool to drain rather than let small messages
+        // overtake this one
+        d_accepting = false;
+        return false;
+    }
+
+    copyPayload(d_ring + offset, message);
+
+    Record record;
+    record.entry.message = message;
+    record.entry.message.updatePayload(
+        bsl::shared_ptr<const bsl::vector<bsl::uint8_t> >());
+    record.entry.routingKey = routingKey;
+    record.entry.mandatory  = mandatory;
+    record.offset           = offset;
+    record.size             = size;
+
+    if (!d_records.empty() && offset < d_tail) {
+        d_wrapped = true;
+    }
+    d_records.push_back(record);
+
+    d_tail = offset + size;
+    d_bytes += size;
+    if (d_bytes >= d_highWaterMark) {
+        d_accepting = false;
+    }
+
+    return true;
+}
+
+bool PublishSpool::pop(Entry* entry)
+{
+    if (d_records.empty()) {
+        return false;
+    }
+
+    const Record& record = d_records.front();
+
+    *entry = record.entry;
+    entry->message.updatePayload(bsl::make_shared<bsl::vector<bsl::uint8_t> >(
+        d_ring + record.offset, d_ring + record.offset + record.size));
+
+    const bsl::size_t offset = record.offset;
+    d_bytes -= record.size;
+    d_records.pop_front();
+
+    if (d_records.empty()) {
+        d_tail    = 0;
+        d_wrapped = false;
+    }
+    else if (d_records.front().offset < offset) {
+        // The oldest message is back at the start of the ring
+        d_wrapped = false;
+    }
+
+    if (!d_accepting && d_bytes <= d_lowWaterMark) {
+        d_accepting = true;
+    }
+
+    return true;
+}
+
+} // namespace rmqa
+} // namespace BloombergLP
@@ -0,0 +1,132 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQA_PUBLISHSPOOL
+#define INCLUDED_RMQA_PUBLISHSPOOL
+
+#include <rmqt_message.h>
+#include <rmqt_properties.h>
+
+#include <bsls_keyword.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_cstdint.h>
+#include <bsl_deque.h>
+#include <bsl_memory.h>
+#include <bsl_string.h>
+
+//@PURPOSE: Bounded FIFO spool for a producer's sends
+//
+//@CLASSES:
+//  rmqa::PublishSpool: Messages waiting for the unconfirmed message limit,
+//  with their payloads held in a memory-mapped ring
+
+namespace BloombergLP {
+namespace rmqa {
+
+/// \brief Holds sends a producer cannot publish yet, e.g. while the broker
+/// is unreachable and no confirms free up the unconfirmed message limit
+///
+/// Payloads are copied into a ring of `capacity` bytes mapped from a file
+/// (unlinked as soon as it is created, so it never outlives the process) or
+/// from anonymous memory, rather than onto the heap. The message itself is
+/// kept with an empty payload, which preserves its GUID and properties, and
+/// the payload is copied back out when the message is taken from the spool.
+///
+/// The spool stops accepting messages once its payloads reach
+/// `highWaterMark` bytes, or once the ring has no room for the next one, and
+/// accepts them again once it has drained to `lowWaterMark` bytes.
+///
+/// Not thread safe.
+
+class PublishSpool {
+  public:
+    /// A message taken from the spool, with its payload restored
+    struct Entry {
+        rmqt::Message message;
+        bsl::string routingKey;
+        rmqt::Mandatory::Value mandatory;
+    };
+
+    /// Map a ring of `capacity` bytes, backed by a file created in
+    /// `directory`, or by anonymous memory if `directory` is empty. Return a
+    /// null pointer, logging why, if the ring cannot be mapped.
+    static bsl::shared_ptr<PublishSpool> create(const bsl::string& directory,
+                                                bsl::size_t capacity,
+                                                bsl::size_t highWaterMark,
+                                                bsl::size_t lowWaterMark);
+
+    ~PublishSpool();
+
+    /// Append `message` to the spool, copying its payload into the ring.
+    /// Return false if it is not accepting messages, or the payload does not
+    /// fit. A payload larger than `capacity()` is never accepted.
+    bool push(const rmqt::Message& message,
+              const bsl::string& routingKey,
+              rmqt::Mandatory::Value mandatory);
+
+    /// Remove the oldest message into `entry`. Return false if the spool is
+    /// empty.
+    bool pop(Entry* entry);
+
+    /// Return true if `push` may accept another message
+    bool accepting() const { return d_accepting; }
+
+    bool empty() const { return d_records.empty(); }
+
+    /// Number of spooled messages
+    bsl::size_t count() const { return d_records.size(); }
+
+    /// Payload bytes held by the spooled messages
+    bsl::size_t bytes() const { return d_bytes; }
+
+    bsl::size_t capacity() const { return d_capacity; }
+
+  private:
+    PublishSpool(bsl::uint8_t* ring,
+                 bsl::size_t capacity,
+                 bsl::size_t highWaterMark,
+                 bsl::size_t lowWaterMark);
+
+    PublishSpool(const PublishSpool&) BSLS_KEYWORD_DELETED;
+    PublishSpool& operator=(const PublishSpool&) BSLS_KEYWORD_DELETED;
+
+    struct Record {
+        Entry entry;
+        bsl::size_t offset;
+        bsl::size_t size;
+    };
+
+    /// Return the offset at which `size` payload bytes fit in the ring, or
+    /// `d_capacity` if they do not. The ring is `d_wrapped` once the newest
+    /// payload is stored before the oldest
+    bsl::size_t placement(bsl::size_t size) const;
+
+    bsl::uint8_t* d_ring;
+    const bsl::size_t d_capacity;
+    const bsl::size_t d_highWaterMark;
+    const bsl::size_t d_lowWaterMark;
+
+    bsl::deque<Record> d_records;
+    bsl::size_t d_tail;
+    bool d_wrapped;
+    bsl::size_t d_bytes;
+    bool d_accepting;
+}; // class PublishSpool
+
+} // namespace rmqa
+} // namespace BloombergLP
+
+#endif // ! INCLUDED_RMQA_PUBLISHSPOOL
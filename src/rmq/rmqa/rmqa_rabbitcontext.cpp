@@ -16,6 +16,7 @@
 #include <rmqa_rabbitcontext.h>
 
 #include <rmqa_rabbitcontextimpl.h>
+#include <rmqa_sharedrabbitcontext.h>
 #include <rmqa_vhost.h>
 #include <rmqa_vhostimpl.h>
 
@@ -28,18 +29,64 @@
 #include <bdlf_placeholder.h>
 #include <bslma_managedptr.h>
 
+#include <bsl_functional.h>
 #include <bsl_memory.h>
 
 namespace BloombergLP {
 namespace rmqa {
 namespace {
 BALL_LOG_SET_NAMESPACE_CATEGORY("RMQA.RABBITCONTEXT")
+
+RabbitContextImpl::EventLoops
+createEventLoops(const RabbitContextOptions& options)
+{
+    RabbitContextImpl::EventLoops eventLoops;
+    if (options.ioContext()) {
+        // The application runs the context on one thread: one loop is all
+        // it can serve
+        eventLoops.push_back(bsl::make_shared<rmqio::AsioEventLoop>(
+            bsl::ref(*options.ioContext()),
+            rmqio::AsioEventLoop::k_DEFAULT_POST_QUEUE_CAPACITY,
+            options.eventLoopTimerWheel()));
+        return eventLoops;
+    }
+    if (options.applicationDriven()) {
+        eventLoops.push_back(rmqio::AsioEventLoop::makeDriven(
+            rmqio::AsioEventLoop::k_DEFAULT_POST_QUEUE_CAPACITY,
+            options.eventLoopTimerWheel()));
+        return eventLoops;
+    }
+    for (bsl::size_t i = 0; i < options.eventLoopThreads(); ++i) {
+        eventLoops.push_back(bsl::make_shared<rmqio::AsioEventLoop>(
+            options.eventLoopBusyPoll(),
+            rmqio::AsioEventLoop::k_DEFAULT_POST_QUEUE_CAPACITY,
+            options.eventLoopTimerWheel(),
+            options.eventLoopMetrics()));
+    }
+    return eventLoops;
+}
+
+bsl::shared_ptr<rmqp::RabbitContext>
+createSharedImpl(const RabbitContextOptions& options)
+{
+    return bsl::make_shared<RabbitContextImpl>(createEventLoops(options),
+                                               options);
+}
+
+bslma::ManagedPtr<rmqp::RabbitContext>
+createImpl(const RabbitContextOptions& options)
+{
+    if (options.processWideSharing()) {
+        return SharedRabbitContext::acquire(
+            bdlf::BindUtil::bind(&createSharedImpl, options));
+    }
+    return bslma::ManagedPtr<rmqp::RabbitContext>(
+        new RabbitContextImpl(createEventLoops(options), options));
+}
 } // namespace
 
 RabbitContext::RabbitContext(const RabbitContextOptions& options)
-: d_impl(bslma::ManagedPtr<RabbitContextImpl>(new RabbitContextImpl(
-      bslma::ManagedPtr<rmqio::EventLoop>(new rmqio::AsioEventLoop()),
-      options)))
+: d_impl(createImpl(options))
 {
 }
 
@@ -69,5 +116,23 @@ RabbitContext::createVHostConnection(const bsl::string& userDefinedName,
                       .managedPtr()));
 }
 
+rmqt::Result<> RabbitContext::shutdown(const bsls::TimeInterval& timeout)
+{
+    return d_impl->shutdown(timeout);
+}
+
+bsl::size_t RabbitContext::poll() { return d_impl->poll(); }
+
+bsl::size_t RabbitContext::runFor(const bsls::TimeInterval& duration)
+{
+    return d_impl->runFor(duration);
+}
+
+bsl::vector<rmqt::ConnectionStats>
+RabbitContext::stats(const bsls::TimeInterval& timeout)
+{
+    return d_impl->stats(timeout);
+}
+
 } // namespace rmqa
 } // namespace BloombergLP
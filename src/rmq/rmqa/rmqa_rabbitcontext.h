@@ -24,15 +24,20 @@
 #include <rmqp_rabbitcontext.h>
 #include <rmqp_topology.h>
 
+#include <rmqt_connectionstats.h>
 #include <rmqt_credentials.h>
 #include <rmqt_endpoint.h>
 #include <rmqt_future.h>
+#include <rmqt_result.h>
 #include <rmqt_vhostinfo.h>
 
 #include <bdlmt_threadpool.h>
+#include <bsls_timeinterval.h>
 
+#include <bsl_cstddef.h>
 #include <bsl_memory.h>
 #include <bsl_string.h>
+#include <bsl_vector.h>
 
 namespace BloombergLP {
 namespace rmqa {
@@ -92,6 +97,51 @@ class RabbitContext {
     createVHostConnection(const bsl::string& userDefinedName,
                           const rmqt::VHostInfo& vhostInfo);
 
+    /// \brief Stop every consumer and producer of this context at once,
+    /// ahead of destroying it
+    ///
+    /// Cancels the consumers on all connections together, then waits for
+    /// the messages already delivered to them to be acked and for every
+    /// producer's outstanding confirms, before closing all connections
+    /// together. Each connection is closed even if its channels did not
+    /// drain in time. Consumers receive no further messages, and producers
+    /// and consumers cannot be used afterwards, but must still be destroyed
+    /// before the context.
+    ///
+    /// \param timeout How long the whole shutdown may take
+    ///
+    /// \return an error if draining or closing did not finish within
+    /// `timeout`
+    rmqt::Result<> shutdown(const bsls::TimeInterval& timeout);
+
+    /// \brief Return a snapshot of every open connection of this context
+    /// and of each of its channels
+    ///
+    /// Each connection's counters are read on its event loop thread, so
+    /// they are consistent with one another; different connections may be
+    /// read moments apart. Nothing is counted or locked on the publish and
+    /// delivery paths beyond plain increments. Cheap enough to poll, e.g.
+    /// once a second for a dashboard.
+    ///
+    /// \param timeout How long to wait for the event loops to answer.
+    /// Connections whose event loop does not answer in time are left out.
+    bsl::vector<rmqt::ConnectionStats> stats(const bsls::TimeInterval& timeout);
+
+    /// \brief Run the event loop work which is ready, on the calling
+    /// thread, without waiting
+    ///
+    /// Only for contexts the application drives, see
+    /// `RabbitContextOptions::setApplicationDriven`, and only ever from one
+    /// thread at a time. Socket reads and writes, timers, heartbeats and
+    /// inline consumer callbacks all run within these calls.
+    ///
+    /// \return the number of handlers run: always 0 for other contexts
+    bsl::size_t poll();
+
+    /// \brief As `poll`, but waiting up to `duration` for work to arrive,
+    /// for when the application has nothing else to do
+    bsl::size_t runFor(const bsls::TimeInterval& duration);
+
   private:
     bslma::ManagedPtr<rmqp::RabbitContext> d_impl;
 
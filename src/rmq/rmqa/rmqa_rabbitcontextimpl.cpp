@@ -17,32 +17,66 @@
 
 #include <rmqa_connectionimpl.h>
 #include <rmqa_consumerimpl.h>
+#include <rmqa_executorscaler.h>
 #include <rmqa_noopmetricpublisher.h>
 #include <rmqa_producerimpl.h>
 #include <rmqa_tracingconsumerimpl.h>
 #include <rmqa_tracingproducerimpl.h>
+#include <rmqa_tracingsampler.h>
 #include <rmqa_vhost.h>
 #include <rmqa_vhostimpl.h>
+#include <rmqa_workstealingexecutor.h>
 
 #include <rmqamqp_connection.h>
+#include <rmqamqp_hostselector.h>
+#include <rmqamqp_memorybudget.h>
+#include <rmqamqp_ratelimiter.h>
+#include <rmqamqpt_frame.h>
+#include <rmqio_coarseclock.h>
+#include <rmqio_connectlimiter.h>
+#include <rmqio_connectionoptions.h>
 #include <rmqio_eventloop.h>
+#include <rmqio_hugepagearena.h>
+#include <rmqio_numatopology.h>
+#include <rmqio_pipelineclock.h>
+#include <rmqio_readstats.h>
+#include <rmqio_resolutioncache.h>
+#include <rmqio_task.h>
 #include <rmqio_timer.h>
+#include <rmqio_tlssessioncache.h>
 #include <rmqio_watchdog.h>
+#include <rmqio_wirecapture.h>
+#include <rmqio_writequeuestats.h>
 #include <rmqp_connection.h>
+#include <rmqp_metricpublisher.h>
 #include <rmqt_endpoint.h>
 #include <rmqt_future.h>
+#include <rmqt_log.h>
+#include <rmqt_messageguidutil.h>
 #include <rmqt_vhostinfo.h>
 
 #include <ball_log.h>
 #include <bdlf_bind.h>
 #include <bdlmt_threadpool.h>
+#include <bslmt_latch.h>
+#include <bslmt_lockguard.h>
+#include <bslmt_threadattributes.h>
+#include <bsls_assert.h>
+#include <bsls_keyword.h>
 #include <bsls_review.h>
+#include <bsls_systemclocktype.h>
+#include <bsls_systemtime.h>
 #include <bsls_timeinterval.h>
+#include <bsls_types.h>
 
 #include <boost/algorithm/string/join.hpp>
 
+#include <bsl_algorithm.h>
+#include <bsl_cstdint.h>
+#include <bsl_limits.h>
 #include <bsl_sstream.h>
 #include <bsl_string.h>
+#include <bsl_utility.h>
 #include <bsl_vector.h>
 
 namespace BloombergLP {
@@ -57,6 +91,14 @@ const int DEFAULT_THREADPOOL_MINTHREADS    = 2;
 const int DEFAULT_THREADPOOL_MAXTHREADS    = 10;
 const int DEFAULT_THREADPOOL_MAXIDLETIMEMS = 60 * 1000;
 
+const char DEFAULT_NUMA_WORKER_NAME[] = "LIBRMQ.NUMA";
+
+const char DEFAULT_WORK_STEALING_WORKER_NAME[] = "LIBRMQ.STEALER";
+
+const char DEFAULT_TLS_HANDSHAKE_WORKER_NAME[] = "LIBRMQ.TLSHS";
+
+const char DEFAULT_DECODE_WORKER_NAME[] = "LIBRMQ.DECODE";
+
 void handleErrorCbOnEventLoop(bdlmt::ThreadPool* threadPool,
                               const rmqt::ErrorCallback& errorCb,
                               const bsl::string& errorText,
@@ -77,13 +119,453 @@ void handleSuccessCbOnEventLoop(bdlmt::ThreadPool* threadPool,
     }
 }
 
+void handleBlockedCbOnEventLoop(
+    bdlmt::ThreadPool* threadPool,
+    const rmqt::ConnectionBlockedCallback& blockedCb,
+    const bsl::string& vhostName,
+    bool blocked,
+    const bsl::string& reason)
+{
+    if (blockedCb) {
+        threadPool->enqueueJob(
+            bdlf::BindUtil::bind(blockedCb, vhostName, blocked, reason));
+    }
+}
+
+void bindWorker(const bsl::vector<int>& cpus,
+                const bsl::shared_ptr<bslmt::Latch>& bound,
+                const bsl::shared_ptr<bslmt::Latch>& release)
+{
+    if (rmqio::NumaTopology::bindThread(cpus)) {
+        BALL_LOG_WARN << "Failed to bind a NUMA worker thread to its node";
+    }
+    bound->arrive();
+    release->wait();
+}
+
+/// Bind each of the `numThreads` threads of `threadPool` to `cpus`. Every
+/// thread is held until all are bound, so that no thread runs two of the
+/// jobs.
+void bindWorkers(bdlmt::ThreadPool& threadPool,
+                 int numThreads,
+                 const bsl::vector<int>& cpus)
+{
+    bsl::shared_ptr<bslmt::Latch> bound =
+        bsl::make_shared<bslmt::Latch>(numThreads);
+    bsl::shared_ptr<bslmt::Latch> release = bsl::make_shared<bslmt::Latch>(1);
+
+    for (int i = 0; i < numThreads; ++i) {
+        if (threadPool.enqueueJob(
+                bdlf::BindUtil::bind(&bindWorker, cpus, bound, release))) {
+            bound->countDown(1);
+        }
+    }
+    bound->wait();
+    release->arrive();
+}
+
+/// Return the region the per-message buffers are served from, or null if
+/// `options` configure none
+bsl::shared_ptr<rmqio::HugePageArena>
+makeHugePageArena(const RabbitContextOptions& options)
+{
+    if (options.hugePageBufferBytes() == 0 || options.allocationStats()) {
+        return bsl::shared_ptr<rmqio::HugePageArena>();
+    }
+    return rmqio::HugePageArena::create(
+        options.hugePageBufferBytes(),
+        options.explicitHugePages()
+            ? rmqio::HugePageArena::Mode::e_EXPLICIT
+            : rmqio::HugePageArena::Mode::e_TRANSPARENT,
+        options.allocator());
+}
+
+/// Return the options every connection is made with, reading into buffers
+/// from `allocator` unless `options` count allocations
+rmqio::ConnectionOptions
+connectionOptions(const RabbitContextOptions& options,
+                  bslma::Allocator* allocator)
+{
+    rmqio::ConnectionOptions connectionOptions;
+    if (options.writeCoalescing()) {
+        connectionOptions.setWriteCoalescing(
+            options.writeCoalescing()->first,
+            options.writeCoalescing()->second);
+    }
+    connectionOptions.setDeferWrites(options.deferWrites());
+    connectionOptions.setSocketOptions(options.socketOptions());
+    connectionOptions.setBusyPoll(options.socketBusyPoll().value_or(
+        options.socketOptions().busyPollMicroseconds()));
+    connectionOptions.setKernelTls(options.kernelTls());
+    if (options.tlsSessionResumption()) {
+        connectionOptions.setTlsSessionCache(
+            bsl::make_shared<rmqio::TlsSessionCache>());
+    }
+    if (options.resolutionCacheTtl() > bsls::TimeInterval()) {
+        connectionOptions.setResolutionCache(
+            bsl::make_shared<rmqio::ResolutionCache>(
+                options.resolutionCacheTtl()));
+    }
+    connectionOptions.setConnectRace(options.connectRace());
+    if (!options.wireCapturePath().empty()) {
+        connectionOptions.setWireCapture(
+            rmqio::WireCapture::open(options.wireCapturePath()));
+    }
+    connectionOptions.setMaxReadBytes(options.maxReadBytes());
+    connectionOptions.setReadFrameBudget(options.readFrameBudget());
+    connectionOptions.setReadAllocator(
+        options.allocationStats()
+            ? options.allocationStats()->allocator(AllocationStats::RMQIO)
+            : allocator);
+    return connectionOptions;
+}
+
+/// Return the sampler for tracing configured by `options`, or null if every
+/// message is traced
+bsl::shared_ptr<TracingSampler>
+makeTracingSampler(const RabbitContextOptions& options)
+{
+    if (options.tracingSampleOneIn() <= 1 &&
+        options.tracingSampleMaxPerSecond() == 0 &&
+        !options.tracingSamplePropagate()) {
+        return bsl::shared_ptr<TracingSampler>();
+    }
+    return bsl::make_shared<TracingSampler>(
+        options.tracingSampleOneIn(),
+        options.tracingSampleMaxPerSecond(),
+        options.tracingSamplePropagate());
+}
+
+/// Return the rate limiter shared by all producers configured by `options`,
+/// or null if publishing is not limited as a whole
+bsl::shared_ptr<rmqamqp::RateLimiter>
+makePublishRateLimiter(const RabbitContextOptions& options)
+{
+    if (!options.publishRateLimit()) {
+        return bsl::shared_ptr<rmqamqp::RateLimiter>();
+    }
+    return bsl::make_shared<rmqamqp::RateLimiter>(
+        options.publishRateLimit().value());
+}
+
+/// Publishes the growth in an event loop's busy-poll counters each time it
+/// is run by the WatchDog
+class BusyPollMetrics : public rmqio::Task {
+  public:
+    BusyPollMetrics(
+        rmqio::EventLoop& eventLoop,
+        const bsl::shared_ptr<rmqp::MetricPublisher>& metricPublisher,
+        bsl::size_t eventLoopIndex)
+    : d_eventLoop(eventLoop)
+    , d_metricPublisher(metricPublisher)
+    , d_tags(1, bsl::make_pair(bsl::string("event_loop"),
+                               bsl::to_string(eventLoopIndex)))
+    , d_last()
+    {
+    }
+
+    void run() BSLS_KEYWORD_OVERRIDE
+    {
+        const rmqio::EventLoop::BusyPollStats stats =
+            d_eventLoop.busyPollStats();
+
+        d_metricPublisher->publishCounter(
+            "event_loop_idle_spin_ns",
+            static_cast<double>(stats.idleSpinNanoseconds -
+                                d_last.idleSpinNanoseconds),
+            d_tags);
+        d_metricPublisher->publishCounter(
+            "event_loop_spin_handlers",
+            static_cast<double>(stats.spinHandlers - d_last.spinHandlers),
+            d_tags);
+        d_metricPublisher->publishCounter(
+            "event_loop_blocking_wakeups",
+            static_cast<double>(stats.blockingWakeups -
+                                d_last.blockingWakeups),
+            d_tags);
+
+        d_last = stats;
+    }
+
+  private:
+    rmqio::EventLoop& d_eventLoop;
+    bsl::shared_ptr<rmqp::MetricPublisher> d_metricPublisher;
+    bsl::vector<bsl::pair<bsl::string, bsl::string> > d_tags;
+    rmqio::EventLoop::BusyPollStats d_last;
+};
+
+/// Publishes how busy an event loop is each time it is run by the WatchDog:
+/// posted items waiting to run, time spent in posted work and in I/O and
+/// timer handlers, the longest loop iteration, and the writes queued and
+/// reads completed by its connections. Also publishes the consumer thread
+/// pool's backlog, if given one.
+class EventLoopMetrics : public rmqio::Task {
+  public:
+    EventLoopMetrics(
+        rmqio::EventLoop& eventLoop,
+        const bsl::shared_ptr<rmqio::WriteQueueStats>& writeQueueStats,
+        const bsl::shared_ptr<rmqio::ReadStats>& readStats,
+        const bdlmt::ThreadPool* threadPool,
+        const bsl::shared_ptr<rmqp::MetricPublisher>& metricPublisher,
+        bsl::size_t eventLoopIndex)
+    : d_eventLoop(eventLoop)
+    , d_writeQueueStats(writeQueueStats)
+    , d_readStats(readStats)
+    , d_threadPool(threadPool)
+    , d_metricPublisher(metricPublisher)
+    , d_tags(1, bsl::make_pair(bsl::string("event_loop"),
+                               bsl::to_string(eventLoopIndex)))
+    , d_postedTags(d_tags)
+    , d_ioTags(d_tags)
+    , d_last()
+    , d_lastReads(0)
+    , d_lastReadBytes(0)
+    , d_lastRun(bsls::SystemTime::nowMonotonicClock())
+    {
+        d_postedTags.push_back(
+            bsl::make_pair(bsl::string("handler"), bsl::string("posted")));
+        d_ioTags.push_back(
+            bsl::make_pair(bsl::string("handler"), bsl::string("io")));
+    }
+
+    void run() BSLS_KEYWORD_OVERRIDE
+    {
+        const rmqio::EventLoop::LoadStats stats = d_eventLoop.loadStats();
+
+        d_metricPublisher->publishGauge(
+            "event_loop_pending_posts",
+            static_cast<double>(stats.pendingPosts),
+            d_tags);
+        d_metricPublisher->publishCounter(
+            "event_loop_iterations",
+            static_cast<double>(stats.iterations - d_last.iterations),
+            d_tags);
+        d_metricPublisher->publishCounter(
+            "event_loop_handler_ns",
+            static_cast<double>(stats.postedNanoseconds -
+                                d_last.postedNanoseconds),
+            d_postedTags);
+        d_metricPublisher->publishCounter(
+            "event_loop_handler_ns",
+            static_cast<double>(stats.ioNanoseconds - d_last.ioNanoseconds),
+            d_ioTags);
+        d_metricPublisher->publishGauge(
+            "event_loop_max_iteration_ns",
+            static_cast<double>(stats.maxIterationNanoseconds),
+            d_tags);
+
+        d_metricPublisher->publishGauge(
+            "event_loop_write_queue_entries",
+            static_cast<double>(d_writeQueueStats->entries()),
+            d_tags);
+        d_metricPublisher->publishGauge(
+            "event_loop_write_queue_bytes",
+            static_cast<double>(d_writeQueueStats->bytes()),
+            d_tags);
+
+        const bsls::Types::Int64 reads     = d_readStats->reads();
+        const bsls::Types::Int64 readBytes = d_readStats->bytes();
+
+        const bsls::TimeInterval now = bsls::SystemTime::nowMonotonicClock();
+        if (now > d_lastRun) {
+            d_metricPublisher->publishGauge(
+                "event_loop_reads_per_second",
+                static_cast<double>(reads - d_lastReads) /
+                    (now - d_lastRun).totalSecondsAsDouble(),
+                d_tags);
+        }
+        if (reads > d_lastReads) {
+            d_metricPublisher->publishGauge(
+                "event_loop_bytes_per_read",
+                static_cast<double>(readBytes - d_lastReadBytes) /
+                    static_cast<double>(reads - d_lastReads),
+                d_tags);
+        }
+        d_lastReads     = reads;
+        d_lastReadBytes = readBytes;
+        d_lastRun       = now;
+
+        if (d_threadPool) {
+            d_metricPublisher->publishGauge(
+                "threadpool_pending_jobs",
+                static_cast<double>(d_threadPool->numPendingJobs()),
+                bsl::vector<bsl::pair<bsl::string, bsl::string> >());
+        }
+
+        d_last = stats;
+    }
+
+  private:
+    rmqio::EventLoop& d_eventLoop;
+    bsl::shared_ptr<rmqio::WriteQueueStats> d_writeQueueStats;
+    bsl::shared_ptr<rmqio::ReadStats> d_readStats;
+    const bdlmt::ThreadPool* d_threadPool;
+    bsl::shared_ptr<rmqp::MetricPublisher> d_metricPublisher;
+    bsl::vector<bsl::pair<bsl::string, bsl::string> > d_tags;
+    bsl::vector<bsl::pair<bsl::string, bsl::string> > d_postedTags;
+    bsl::vector<bsl::pair<bsl::string, bsl::string> > d_ioTags;
+    rmqio::EventLoop::LoadStats d_last;
+    bsls::Types::Int64 d_lastReads;
+    bsls::Types::Int64 d_lastReadBytes;
+    bsls::TimeInterval d_lastRun;
+};
+
+/// Record the duration of a TLS handshake
+void recordHandshakeTime(
+    const rmqamqp::MetricAggregator::Distribution& handshakeTime,
+    const bsls::TimeInterval& duration)
+{
+    handshakeTime.record(duration.totalSecondsAsDouble());
+}
+
+/// Publishes the resumed and full TLS handshakes of a RabbitContext's
+/// connections each time it is run by the WatchDog. Their ratio is the
+/// session cache hit rate.
+class TlsSessionMetrics : public rmqio::Task {
+  public:
+    TlsSessionMetrics(
+        const bsl::shared_ptr<rmqio::TlsSessionCache>& cache,
+        const bsl::shared_ptr<rmqp::MetricPublisher>& metricPublisher)
+    : d_cache(cache)
+    , d_metricPublisher(metricPublisher)
+    , d_last()
+    {
+    }
+
+    void run() BSLS_KEYWORD_OVERRIDE
+    {
+        const rmqio::TlsSessionCache::Stats stats = d_cache->stats();
+
+        d_metricPublisher->publishCounter(
+            "tls_resumed_handshakes",
+            static_cast<double>(stats.resumedHandshakes -
+                                d_last.resumedHandshakes),
+            bsl::vector<bsl::pair<bsl::string, bsl::string> >());
+        d_metricPublisher->publishCounter(
+            "tls_full_handshakes",
+            static_cast<double>(stats.fullHandshakes - d_last.fullHandshakes),
+            bsl::vector<bsl::pair<bsl::string, bsl::string> >());
+        d_metricPublisher->publishGauge(
+            "tls_cached_sessions",
+            static_cast<double>(d_cache->size()),
+            bsl::vector<bsl::pair<bsl::string, bsl::string> >());
+
+        d_last = stats;
+    }
+
+  private:
+    bsl::shared_ptr<rmqio::TlsSessionCache> d_cache;
+    bsl::shared_ptr<rmqp::MetricPublisher> d_metricPublisher;
+    rmqio::TlsSessionCache::Stats d_last;
+};
+
+/// Publishes how much of a RabbitContext's memory budget its unconfirmed
+/// and unacked messages hold each time it is run by the WatchDog
+class MemoryBudgetMetrics : public rmqio::Task {
+  public:
+    MemoryBudgetMetrics(
+        const bsl::shared_ptr<rmqamqp::MemoryBudget>& budget,
+        const bsl::shared_ptr<rmqp::MetricPublisher>& metricPublisher)
+    : d_budget(budget)
+    , d_metricPublisher(metricPublisher)
+    {
+    }
+
+    void run() BSLS_KEYWORD_OVERRIDE
+    {
+        d_metricPublisher->publishGauge(
+            "memory_budget_used_bytes",
+            static_cast<double>(d_budget->used()),
+            bsl::vector<bsl::pair<bsl::string, bsl::string> >());
+        d_metricPublisher->publishGauge(
+            "memory_budget_limit_bytes",
+            static_cast<double>(d_budget->limit()),
+            bsl::vector<bsl::pair<bsl::string, bsl::string> >());
+    }
+
+  private:
+    bsl::shared_ptr<rmqamqp::MemoryBudget> d_budget;
+    bsl::shared_ptr<rmqp::MetricPublisher> d_metricPublisher;
+};
+
+/// Publishes the allocations each subsystem has made for a RabbitContext's
+/// messages each time it is run by the WatchDog. Divided by the
+/// `published_messages` and `received_messages` counters, they give the
+/// allocations per message.
+class AllocationMetrics : public rmqio::Task {
+  public:
+    AllocationMetrics(
+        const bsl::shared_ptr<AllocationStats>& stats,
+        const bsl::shared_ptr<rmqp::MetricPublisher>& metricPublisher)
+    : d_stats(stats)
+    , d_metricPublisher(metricPublisher)
+    , d_last(AllocationStats::NUM_SUBSYSTEMS)
+    {
+    }
+
+    void run() BSLS_KEYWORD_OVERRIDE
+    {
+        for (int i = 0; i < AllocationStats::NUM_SUBSYSTEMS; ++i) {
+            const AllocationStats::Subsystem subsystem =
+                static_cast<AllocationStats::Subsystem>(i);
+            const AllocationStats::Counts counts = d_stats->counts(subsystem);
+            const bsl::vector<bsl::pair<bsl::string, bsl::string> > tags(
+                1,
+                bsl::make_pair(bsl::string("subsystem"),
+                               bsl::string(AllocationStats::toString(
+                                   subsystem))));
+
+            d_metricPublisher->publishCounter(
+                "allocations",
+                static_cast<double>(counts.allocations -
+                                    d_last[i].allocations),
+                tags);
+            d_metricPublisher->publishCounter(
+                "allocated_bytes",
+                static_cast<double>(counts.bytes - d_last[i].bytes),
+                tags);
+
+            d_last[i] = counts;
+        }
+    }
+
+  private:
+    bsl::shared_ptr<AllocationStats> d_stats;
+    bsl::shared_ptr<rmqp::MetricPublisher> d_metricPublisher;
+    bsl::vector<AllocationStats::Counts> d_last;
+};
+
+/// Log a stall of event loop `tags` reports, and publish its duration once
+/// the loop recovers
+void reportStall(
+    const bsl::shared_ptr<rmqp::MetricPublisher>& metricPublisher,
+    const bsl::vector<bsl::pair<bsl::string, bsl::string> >& tags,
+    const rmqio::StallDetector::Stall& stall)
+{
+    if (stall.ongoing) {
+        BALL_LOG_WARN << "Event loop " << tags.front().second
+                      << " has not run posted work for "
+                      << stall.duration.totalSecondsAsDouble() << "s"
+                      << (stall.stack.empty() ? "" : ", at:\n")
+                      << stall.stack;
+        return;
+    }
+
+    BALL_LOG_WARN << "Event loop " << tags.front().second << " stalled for "
+                  << stall.duration.totalSecondsAsDouble() << "s";
+    metricPublisher->publishDistribution(
+        "event_loop_stall_seconds",
+        stall.duration.totalSecondsAsDouble(),
+        tags);
+}
+
 void startFirstConnection(
     const bsl::weak_ptr<rmqamqp::Connection>& weakConn,
     const rmqamqp::Connection::ConnectedCallback& callback)
 {
     bsl::shared_ptr<rmqamqp::Connection> amqpConn = weakConn.lock();
     if (!amqpConn) {
-        BALL_LOG_DEBUG << "Started connection as Future was destructed";
+        RMQT_LOG_DEBUG << "Started connection as Future was destructed";
         return;
     }
 
@@ -105,7 +587,7 @@ void initiateConnection(
 {
     bsl::shared_ptr<rmqamqp::Connection> amqpConn = weakConn.lock();
     if (!amqpConn) {
-        BALL_LOG_DEBUG << "Started connection as Future was destructed";
+        RMQT_LOG_DEBUG << "Started connection as Future was destructed";
         return;
     }
 
@@ -140,6 +622,37 @@ void shutdownAmqpConnection(
         &rmqamqp::Connection::close, connection, &noopConnectionShutdown));
 }
 
+typedef bsl::vector<bsl::shared_ptr<rmqamqp::Connection> > Connections;
+
+rmqt::Future<> drainConnections(const Connections& connections)
+{
+    bsl::vector<rmqt::Future<> > drained;
+    for (Connections::const_iterator it = connections.begin();
+         it != connections.end();
+         ++it) {
+        drained.push_back((*it)->drainChannels());
+    }
+    return rmqt::FutureUtil::whenAll(drained);
+}
+
+bsl::vector<rmqt::ConnectionStats>
+collectStats(const Connections& connections)
+{
+    bsl::vector<rmqt::ConnectionStats> stats;
+    stats.reserve(connections.size());
+    for (Connections::const_iterator it = connections.begin();
+         it != connections.end();
+         ++it) {
+        stats.push_back((*it)->stats());
+    }
+    return stats;
+}
+
+void connectionClosed(const rmqt::Future<>::Maker& maker)
+{
+    maker(rmqt::Result<>());
+}
+
 void asyncFetchConnectionInfo(
     const bsl::shared_ptr<rmqa::ConnectionMonitor>& monitor,
     rmqt::Future<ConnectionMonitor::AliveConnectionInfo>::Maker maker)
@@ -147,16 +660,86 @@ void asyncFetchConnectionInfo(
     maker(rmqt::Result<ConnectionMonitor::AliveConnectionInfo>(
         monitor->fetchAliveConnectionInfo()));
 }
+
+void waitForEventLoopExit(
+    rmqio::EventLoop& eventLoop,
+    const bsl::shared_ptr<rmqa::ConnectionMonitor>& connectionMonitor)
+{
+    rmqt::Future<ConnectionMonitor::AliveConnectionInfo>::Pair logOnEventLoop =
+        rmqt::Future<ConnectionMonitor::AliveConnectionInfo>::make();
+
+    const bool eventLoopShutdownResult = eventLoop.waitForEventLoopExit(60);
+
+    if (eventLoopShutdownResult) {
+        return;
+    }
+
+    eventLoop.post(bdlf::BindUtil::bind(
+        &asyncFetchConnectionInfo, connectionMonitor, logOnEventLoop.first));
+
+    const int64_t MAX_CONN_INFO_WAIT_SEC = 60;
+
+    rmqt::Result<ConnectionMonitor::AliveConnectionInfo> result =
+        logOnEventLoop.second.waitResult(
+            bsls::TimeInterval(MAX_CONN_INFO_WAIT_SEC));
+
+    if (!result) {
+        BALL_LOG_FATAL
+            << "Attempted to query alive connections on the Event Loop but "
+               "no response after "
+            << MAX_CONN_INFO_WAIT_SEC
+            << " seconds. Something is badly wrong with the event loop if "
+               "it can't process anything in this time.";
+        return;
+    }
+
+    typedef bsl::vector<
+        ConnectionMonitor::AliveConnectionInfo::ConnectionChannelsInfo>
+        ConnChannelInfo;
+
+    const ConnChannelInfo& info = result.value()->aliveConnectionChannelInfo;
+
+    if (info.size() > 0) {
+        bsl::stringstream logOutput;
+
+        for (ConnChannelInfo::const_iterator it = info.begin();
+             it != info.end();
+             ++it) {
+
+            logOutput << " Connection [" << it->first
+                      << "] is still alive. It has " << it->second.size()
+                      << " producers/consumers";
+
+            if (it->second.size() > 0) {
+                bsl::string channelsDebugInfo =
+                    boost::algorithm::join(it->second, ", ");
+
+                logOutput << ": [" << channelsDebugInfo << "]. ";
+            }
+        }
+
+        BALL_LOG_FATAL
+            << "Attempting to destruct RabbitContext with outstanding "
+               "Producer/Consumer references. These will hold up "
+               "RabbitContext shutdown. Waited 60 seconds. Destruct "
+               "these objects first: "
+            << logOutput.str();
+    }
+}
 } // namespace
 
 RabbitContextImpl::RabbitContextImpl(
     bslma::ManagedPtr<rmqio::EventLoop> eventLoop,
     const rmqa::RabbitContextOptions& options)
-: d_eventLoop(eventLoop)
-, d_watchDog(bsl::make_shared<rmqio::WatchDog>(
-      bsls::TimeInterval(DEFAULT_WATCHDOG_PERIOD)))
+: d_shards()
+, d_eventLoopAffinity(options.eventLoopAffinity())
+, d_nextShard(0)
 , d_threadPool(options.threadpool())
 , d_hostedThreadPool()
+, d_nodeThreadPools()
+, d_workStealingExecutor()
+, d_executorScaler()
+, d_executorScalerWatchDog()
 , d_onError(bdlf::BindUtil::bind(&handleErrorCbOnEventLoop,
                                  bsl::ref(d_threadPool),
                                  options.errorCallback(),
@@ -165,36 +748,321 @@ RabbitContextImpl::RabbitContextImpl(
 , d_onSuccess(bdlf::BindUtil::bind(&handleSuccessCbOnEventLoop,
                                  bsl::ref(d_threadPool),
                                  options.successCallback()))
-, d_connectionMonitor(
-      bsl::make_shared<ConnectionMonitor>(options.messageProcessingTimeout()))
-, d_connectionFactory()
+, d_onBlocked(bdlf::BindUtil::bind(&handleBlockedCbOnEventLoop,
+                                   bsl::ref(d_threadPool),
+                                   options.connectionBlockedCallback(),
+                                   bdlf::PlaceHolders::_1,
+                                   bdlf::PlaceHolders::_2,
+                                   bdlf::PlaceHolders::_3))
 , d_tunables(options.tunables())
 , d_consumerTracing(options.consumerTracing())
 , d_producerTracing(options.producerTracing())
+, d_tracingSampler(makeTracingSampler(options))
+, d_compressionCodec(options.compressionCodec())
+, d_compressionMinimumSize(options.compressionMinimumSize())
+, d_messageCodecs(options.messageCodecs())
+, d_producerChannelSharing(options.producerChannelSharing())
+, d_consumerChannelSharing(options.consumerChannelSharing())
+, d_inlineDispatchByDefault(options.applicationDriven())
+, d_connectionPoolSize(options.connectionPoolSize())
+, d_publishSpoolCapacity(options.publishSpoolCapacity())
+, d_publishSpoolHighWaterMark(options.publishSpoolHighWaterMark())
+, d_publishSpoolLowWaterMark(options.publishSpoolLowWaterMark())
+, d_publishSpoolDirectory(options.publishSpoolDirectory())
+, d_producerBatchMaxMessages(options.producerBatchMaxMessages())
+, d_producerBatchMaxBytes(options.producerBatchMaxBytes())
+, d_producerBatchMaxLinger(options.producerBatchMaxLinger())
+, d_lazyProducers(options.lazyProducers())
+, d_producerIdleClose(options.producerIdleClose())
+, d_producerRateLimit(options.producerRateLimit())
+, d_publishRateLimiter(makePublishRateLimiter(options))
+, d_deliveryLatencyMetrics(options.deliveryLatencyMetrics())
+, d_readBackpressureHighJobs(options.readBackpressureHighJobs())
+, d_readBackpressureLowJobs(options.readBackpressureLowJobs())
+, d_readBackpressureHighBytes(options.readBackpressureHighBytes())
+, d_readBackpressureLowBytes(options.readBackpressureLowBytes())
+, d_tlsSessionMetrics()
+, d_tlsHandshakePool()
+, d_decodePool()
+, d_memoryBudget()
+, d_memoryBudgetMetrics()
+, d_heartbeatScheduler()
+, d_allocationStats(options.allocationStats())
+, d_allocationMetrics()
+, d_hugePageArena(makeHugePageArena(options))
+, d_metricAggregator()
+, d_metricFlushWatchDog()
+, d_connectionsMutex()
 {
+    init(EventLoops(1, bsl::shared_ptr<rmqio::EventLoop>(eventLoop)), options);
+}
+
+RabbitContextImpl::RabbitContextImpl(const EventLoops& eventLoops,
+                                     const rmqa::RabbitContextOptions& options)
+: d_shards()
+, d_eventLoopAffinity(options.eventLoopAffinity())
+, d_nextShard(0)
+, d_threadPool(options.threadpool())
+, d_hostedThreadPool()
+, d_nodeThreadPools()
+, d_workStealingExecutor()
+, d_executorScaler()
+, d_executorScalerWatchDog()
+, d_onError(bdlf::BindUtil::bind(&handleErrorCbOnEventLoop,
+                                 bsl::ref(d_threadPool),
+                                 options.errorCallback(),
+                                 bdlf::PlaceHolders::_1,
+                                 bdlf::PlaceHolders::_2))
+, d_onSuccess(bdlf::BindUtil::bind(&handleSuccessCbOnEventLoop,
+                                 bsl::ref(d_threadPool),
+                                 options.successCallback()))
+, d_onBlocked(bdlf::BindUtil::bind(&handleBlockedCbOnEventLoop,
+                                   bsl::ref(d_threadPool),
+                                   options.connectionBlockedCallback(),
+                                   bdlf::PlaceHolders::_1,
+                                   bdlf::PlaceHolders::_2,
+                                   bdlf::PlaceHolders::_3))
+, d_tunables(options.tunables())
+, d_consumerTracing(options.consumerTracing())
+, d_producerTracing(options.producerTracing())
+, d_tracingSampler(makeTracingSampler(options))
+, d_compressionCodec(options.compressionCodec())
+, d_compressionMinimumSize(options.compressionMinimumSize())
+, d_messageCodecs(options.messageCodecs())
+, d_producerChannelSharing(options.producerChannelSharing())
+, d_consumerChannelSharing(options.consumerChannelSharing())
+, d_inlineDispatchByDefault(options.applicationDriven())
+, d_connectionPoolSize(options.connectionPoolSize())
+, d_publishSpoolCapacity(options.publishSpoolCapacity())
+, d_publishSpoolHighWaterMark(options.publishSpoolHighWaterMark())
+, d_publishSpoolLowWaterMark(options.publishSpoolLowWaterMark())
+, d_publishSpoolDirectory(options.publishSpoolDirectory())
+, d_producerBatchMaxMessages(options.producerBatchMaxMessages())
+, d_producerBatchMaxBytes(options.producerBatchMaxBytes())
+, d_producerBatchMaxLinger(options.producerBatchMaxLinger())
+, d_lazyProducers(options.lazyProducers())
+, d_producerIdleClose(options.producerIdleClose())
+, d_producerRateLimit(options.producerRateLimit())
+, d_publishRateLimiter(makePublishRateLimiter(options))
+, d_deliveryLatencyMetrics(options.deliveryLatencyMetrics())
+, d_readBackpressureHighJobs(options.readBackpressureHighJobs())
+, d_readBackpressureLowJobs(options.readBackpressureLowJobs())
+, d_readBackpressureHighBytes(options.readBackpressureHighBytes())
+, d_readBackpressureLowBytes(options.readBackpressureLowBytes())
+, d_tlsSessionMetrics()
+, d_tlsHandshakePool()
+, d_decodePool()
+, d_memoryBudget()
+, d_memoryBudgetMetrics()
+, d_heartbeatScheduler()
+, d_allocationStats(options.allocationStats())
+, d_allocationMetrics()
+, d_hugePageArena(makeHugePageArena(options))
+, d_metricAggregator()
+, d_metricFlushWatchDog()
+, d_connectionsMutex()
+{
+    init(eventLoops, options);
+}
+
+void RabbitContextImpl::init(const EventLoops& eventLoops,
+                             const rmqa::RabbitContextOptions& options)
+{
+    BSLS_ASSERT(!eventLoops.empty());
+
     bsl::shared_ptr<rmqp::MetricPublisher> metricPublisher =
         options.metricPublisher();
     if (!metricPublisher) {
         metricPublisher = bsl::make_shared<NoOpMetricPublisher>();
     }
-    d_connectionFactory =
-        bslma::ManagedPtrUtil::makeManaged<rmqamqp::Connection::Factory>(
-            d_eventLoop->resolver(
-                options.shuffleConnectionEndpoints().value_or(false)),
-            d_eventLoop->timerFactory(),
-            d_onError,
-            d_onSuccess,
+    else if (options.metricAggregation() > bsls::TimeInterval()) {
+        // Channels register their per-message metrics with the aggregator,
+        // everything else passes straight through it
+        d_metricAggregator =
+            bsl::make_shared<rmqamqp::MetricAggregator>(metricPublisher);
+        metricPublisher = d_metricAggregator;
+        d_metricFlushWatchDog =
+            bsl::make_shared<rmqio::WatchDog>(options.metricAggregation());
+        d_metricFlushWatchDog->addTask(
+            bsl::weak_ptr<rmqio::Task>(d_metricAggregator));
+    }
+
+    bslma::Allocator* connectionAllocator =
+        d_hugePageArena ? d_hugePageArena.get() : options.allocator();
+
+    // Shared by every shard, so one TLS session cache and resolution cache
+    // serve the context
+    rmqio::ConnectionOptions sharedConnectionOptions =
+        connectionOptions(options, connectionAllocator);
+    if (sharedConnectionOptions.tlsSessionCache()) {
+        d_tlsSessionMetrics = bsl::make_shared<TlsSessionMetrics>(
+            sharedConnectionOptions.tlsSessionCache(), metricPublisher);
+    }
+    sharedConnectionOptions.setTlsHandshakeObserver(bdlf::BindUtil::bind(
+        &recordHandshakeTime,
+        rmqamqp::MetricAggregator::distribution(
             metricPublisher,
-            d_connectionMonitor,
-            options.clientProperties(),
-            options.connectionErrorThreshold());
-    if (!d_threadPool) {
+            "tls_handshake_time",
+            rmqamqp::MetricAggregator::Tags()),
+        bdlf::PlaceHolders::_1));
+    if (options.tlsHandshakeThreads() > 0) {
         bslmt::ThreadAttributes attributes;
-        attributes.setThreadName(DEFAULT_THREADPOOL_WORKER_NAME);
+        attributes.setThreadName(DEFAULT_TLS_HANDSHAKE_WORKER_NAME);
+        d_tlsHandshakePool = bsl::make_shared<rmqio::TlsHandshakePool>(
+            attributes,
+            options.tlsHandshakeThreads(),
+            options.tlsHandshakeTimeout());
+        if (d_tlsHandshakePool->start() == 0) {
+            sharedConnectionOptions.setTlsHandshakePool(d_tlsHandshakePool);
+        }
+        else {
+            BALL_LOG_ERROR << "TLS handshakes stay on the event loops";
+            d_tlsHandshakePool.reset();
+        }
+    }
+    if (options.decodeThreads() > 0) {
+        bslmt::ThreadAttributes attributes;
+        attributes.setThreadName(DEFAULT_DECODE_WORKER_NAME);
+        d_decodePool = bsl::make_shared<rmqio::DecodePool>(
+            attributes, options.decodeThreads());
+        if (d_decodePool->start() == 0) {
+            sharedConnectionOptions.setDecodePool(d_decodePool);
+        }
+        else {
+            BALL_LOG_ERROR << "Reads are decoded on the event loops";
+            d_decodePool.reset();
+        }
+    }
+
+    if (options.messageGuidMode()) {
+        rmqt::MessageGuidUtil::setMode(options.messageGuidMode().value());
+    }
+
+    if (options.memoryBudget()) {
+        // One budget across every shard's connections
+        d_memoryBudget =
+            bsl::make_shared<rmqamqp::MemoryBudget>(options.memoryBudget());
+        d_memoryBudgetMetrics = bsl::make_shared<MemoryBudgetMetrics>(
+            d_memoryBudget, metricPublisher);
+    }
+
+    if (options.heartbeatThread()) {
+        d_heartbeatScheduler = bsl::make_shared<bdlmt::EventScheduler>(
+            bsls::SystemClockType::e_MONOTONIC);
+        bslmt::ThreadAttributes attributes;
+        attributes.setThreadName("RMQAMQP.HBEATS");
+        d_heartbeatScheduler->start(attributes);
+    }
+
+    // One limit across every shard's connections
+    const bsl::shared_ptr<rmqio::ConnectLimiter> connectLimiter =
+        options.maxConcurrentConnects()
+            ? bsl::make_shared<rmqio::ConnectLimiter>(
+                  options.maxConcurrentConnects())
+            : bsl::shared_ptr<rmqio::ConnectLimiter>();
+
+    // Shared too, so that it sees every connection to each host
+    const bsl::shared_ptr<rmqamqp::HostSelector> hostSelector =
+        bsl::make_shared<rmqamqp::HostSelector>(options.hostSelection());
+
+    if (d_allocationStats) {
+        connectionAllocator =
+            d_allocationStats->allocator(AllocationStats::RMQAMQP);
+        d_allocationMetrics = bsl::make_shared<AllocationMetrics>(
+            d_allocationStats, metricPublisher);
+    }
+
+    d_shards.resize(eventLoops.size());
+    for (bsl::size_t i = 0; i < eventLoops.size(); ++i) {
+        EventLoopShard& shard = d_shards[i];
+        shard.eventLoop       = eventLoops[i];
+        shard.cpus            = options.eventLoopCpuAffinity();
+        shard.threadPool      = 0;
+
+        rmqio::ConnectionOptions shardConnectionOptions =
+            sharedConnectionOptions;
+        if (options.eventLoopMetrics()) {
+            shard.writeQueueStats = bsl::make_shared<rmqio::WriteQueueStats>();
+            shardConnectionOptions.setWriteQueueStats(shard.writeQueueStats);
+            shard.readStats = bsl::make_shared<rmqio::ReadStats>();
+            shardConnectionOptions.setReadStats(shard.readStats);
+        }
+
+        shard.watchDog        = bsl::make_shared<rmqio::WatchDog>(
+            bsls::TimeInterval(DEFAULT_WATCHDOG_PERIOD));
+        shard.connectionMonitor = bsl::make_shared<ConnectionMonitor>(
+            options.messageProcessingTimeout());
+        shard.connectionMonitor->setMetricPublisher(metricPublisher);
+        shard.connectionMonitor->setChannelMetrics(options.channelMetrics());
+        if (options.ackDeadline()) {
+            shard.connectionMonitor->setAckDeadline(
+                options.ackDeadline().value(), options.ackDeadlineCallback());
+        }
+        shard.connectionFactory =
+            bsl::make_shared<rmqamqp::Connection::Factory>(
+                shard.eventLoop->resolver(
+                    options.shuffleConnectionEndpoints().value_or(false),
+                    shardConnectionOptions),
+                shard.eventLoop->timerFactory(),
+                d_onError,
+                d_onSuccess,
+                metricPublisher,
+                shard.connectionMonitor,
+                options.clientProperties(),
+                options.connectionErrorThreshold());
+        shard.connectionFactory->setMemoryBudget(d_memoryBudget);
+        shard.connectionFactory->setAllocator(connectionAllocator);
+        if (options.frameMax() || options.channelMax()) {
+            shard.connectionFactory->setTuneLimits(
+                options.frameMax().value_or(static_cast<bsl::uint32_t>(
+                    rmqamqpt::Frame::getMaxFrameSize())),
+                options.channelMax().value_or(
+                    bsl::numeric_limits<bsl::uint16_t>::max()));
+        }
+        shard.connectionFactory->setDefaultAckCoalescing(
+            options.defaultAckCoalescingDelay(),
+            options.defaultAckCoalescingTags());
+        shard.connectionFactory->setResendPacing(options.resendBatchSize());
+        if (options.jitteredReconnect()) {
+            shard.connectionFactory->setJitteredRetry(
+                options.jitteredReconnect()->first,
+                options.jitteredReconnect()->second);
+        }
+        if (options.idleTrimPeriod() > bsls::TimeInterval()) {
+            shard.connectionFactory->setIdleTrim(options.idleTrimPeriod(),
+                                                 options.idleTrimWatermark());
+        }
+        shard.connectionFactory->setConnectLimiter(connectLimiter);
+        shard.connectionFactory->setHostSelector(hostSelector);
+        shard.connectionFactory->setBlockedCallback(d_onBlocked);
+        shard.connectionFactory->setTopologyStoreDirectory(
+            options.topologyCacheDirectory());
+        if (d_heartbeatScheduler) {
+            shard.connectionFactory->setHeartbeatScheduler(
+                d_heartbeatScheduler,
+                bdlf::BindUtil::bind(&rmqio::EventLoop::post,
+                                     shard.eventLoop.get(),
+                                     bdlf::PlaceHolders::_1));
+        }
+        if (options.eventLoopBusyPoll() > bsls::TimeInterval()) {
+            shard.busyPollMetrics = bsl::make_shared<BusyPollMetrics>(
+                bsl::ref(*shard.eventLoop), metricPublisher, i);
+        }
+    }
+
+    if (!d_threadPool) {
+        bslmt::ThreadAttributes attributes =
+            options.threadpoolThreadAttributes().value_or(
+                bslmt::ThreadAttributes());
+        if (attributes.threadName().empty()) {
+            attributes.setThreadName(DEFAULT_THREADPOOL_WORKER_NAME);
+        }
         d_hostedThreadPool =
             bslma::ManagedPtrUtil::makeManaged<bdlmt::ThreadPool>(
                 attributes,
-                DEFAULT_THREADPOOL_MINTHREADS,
+                // With no threads of its own until a job needs one
+                options.applicationDriven() ? 0
+                                            : DEFAULT_THREADPOOL_MINTHREADS,
                 DEFAULT_THREADPOOL_MAXTHREADS,
                 DEFAULT_THREADPOOL_MAXIDLETIMEMS);
         d_hostedThreadPool->start();
@@ -202,84 +1070,369 @@ RabbitContextImpl::RabbitContextImpl(
     }
     BSLS_REVIEW(d_threadPool->enabled());
 
-    d_eventLoop->start();
-    d_watchDog->addTask(bsl::weak_ptr<ConnectionMonitor>(d_connectionMonitor));
-    d_watchDog->start(d_eventLoop->timerFactory());
+    if (options.numaAware()) {
+        // Before the event loops start, so they are bound from the outset
+        placeOnNumaNodes(options);
+    }
+
+    const bool adaptive = options.adaptiveMaxWorkers() > 0;
+    if (options.workStealingWorkers() > 0 || adaptive) {
+        bslmt::ThreadAttributes attributes =
+            options.threadpoolThreadAttributes().value_or(
+                bslmt::ThreadAttributes());
+        attributes.setThreadName(DEFAULT_WORK_STEALING_WORKER_NAME);
+
+        const bsl::size_t minWorkers =
+            adaptive ? bsl::max<bsl::size_t>(options.adaptiveMinWorkers(), 1)
+                     : options.workStealingWorkers();
+        d_workStealingExecutor = bsl::make_shared<WorkStealingExecutor>(
+            attributes,
+            minWorkers,
+            options.workStealingQuota(),
+            adaptive ? bsl::max(options.adaptiveMaxWorkers(), minWorkers)
+                     : minWorkers);
+        if (d_workStealingExecutor->start()) {
+            BALL_LOG_ERROR << "Work-stealing dispatch falls back to the "
+                              "threadpool";
+            d_workStealingExecutor.reset();
+        }
+    }
+
+    if (options.coarseClock()) {
+        // Before the event loops start, so they tick it from the outset
+        rmqio::CoarseClock::setEnabled(true);
+    }
+
+    if (options.pipelineTiming()) {
+        // Before any connection or channel registers its stage metrics
+        rmqio::PipelineClock::setEnabled(true);
+    }
+
+    for (bsl::vector<EventLoopShard>::iterator it = d_shards.begin();
+         it != d_shards.end();
+         ++it) {
+        if (it->writeQueueStats) {
+            // The first shard also reports the thread pool all shards share
+            it->eventLoopMetrics = bsl::make_shared<EventLoopMetrics>(
+                bsl::ref(*it->eventLoop),
+                it->writeQueueStats,
+                it->readStats,
+                it == d_shards.begin() ? d_threadPool : 0,
+                metricPublisher,
+                static_cast<bsl::size_t>(it - d_shards.begin()));
+        }
+        it->eventLoop->start(options.eventLoopThreadAttributes().value_or(
+                                 bslmt::ThreadAttributes()),
+                             it->cpus);
+        if (options.eventLoopStallThreshold()) {
+            const bsl::vector<bsl::pair<bsl::string, bsl::string> > tags(
+                1,
+                bsl::make_pair(
+                    bsl::string("event_loop"),
+                    bsl::to_string(
+                        static_cast<bsl::size_t>(it - d_shards.begin()))));
+            it->stallDetector = bsl::make_shared<rmqio::StallDetector>(
+                bsl::ref(*it->eventLoop),
+                options.eventLoopStallThreshold().value(),
+                rmqio::StallDetector::StallCallback(
+                    bdlf::BindUtil::bind(&reportStall,
+                                         metricPublisher,
+                                         tags,
+                                         bdlf::PlaceHolders::_1)));
+            // An application's thread is not ours to signal
+            if (options.eventLoopStallStackSignal() && !options.ioContext() &&
+                !options.applicationDriven()) {
+                it->stallDetector->setStackCaptureSignal(
+                    options.eventLoopStallStackSignal());
+            }
+            it->stallDetector->start();
+        }
+        it->watchDog->addTask(
+            bsl::weak_ptr<ConnectionMonitor>(it->connectionMonitor));
+        if (it->busyPollMetrics) {
+            it->watchDog->addTask(
+                bsl::weak_ptr<rmqio::Task>(it->busyPollMetrics));
+        }
+        if (it->eventLoopMetrics) {
+            it->watchDog->addTask(
+                bsl::weak_ptr<rmqio::Task>(it->eventLoopMetrics));
+        }
+        if (d_tlsSessionMetrics && it == d_shards.begin()) {
+            it->watchDog->addTask(
+                bsl::weak_ptr<rmqio::Task>(d_tlsSessionMetrics));
+        }
+        if (d_memoryBudgetMetrics && it == d_shards.begin()) {
+            it->watchDog->addTask(
+                bsl::weak_ptr<rmqio::Task>(d_memoryBudgetMetrics));
+        }
+        if (d_allocationMetrics && it == d_shards.begin()) {
+            it->watchDog->addTask(
+                bsl::weak_ptr<rmqio::Task>(d_allocationMetrics));
+        }
+        it->watchDog->start(it->eventLoop->timerFactory());
+    }
+
+    if (d_metricFlushWatchDog) {
+        d_metricFlushWatchDog->start(
+            d_shards.front().eventLoop->timerFactory());
+    }
+
+    if (d_workStealingExecutor && options.adaptiveMaxWorkers() > 0) {
+        d_executorScaler = bsl::make_shared<ExecutorScaler>(
+            d_workStealingExecutor,
+            d_workStealingExecutor->numWorkers(),
+            d_workStealingExecutor->maxWorkers(),
+            0,
+            metricPublisher);
+        d_executorScalerWatchDog = bsl::make_shared<rmqio::WatchDog>(
+            options.adaptiveScalingPeriod());
+        d_executorScalerWatchDog->addTask(
+            bsl::weak_ptr<rmqio::Task>(d_executorScaler));
+        d_executorScalerWatchDog->start(
+            d_shards.front().eventLoop->timerFactory());
+    }
 }
 
 RabbitContextImpl::~RabbitContextImpl()
 {
-    rmqt::Future<ConnectionMonitor::AliveConnectionInfo>::Pair logOnEventLoop =
-        rmqt::Future<ConnectionMonitor::AliveConnectionInfo>::make();
-
     d_producerTracing.reset();
     d_consumerTracing.reset();
 
-    d_connectionFactory.reset();
+    for (bsl::vector<EventLoopShard>::iterator it = d_shards.begin();
+         it != d_shards.end();
+         ++it) {
+        it->connectionFactory.reset();
+    }
 
     d_hostedThreadPool.reset();
+    d_nodeThreadPools.clear();
+    if (d_workStealingExecutor) {
+        // Connection factories may still hold it, its jobs run now
+        d_workStealingExecutor->stop();
+    }
+    if (d_tlsHandshakePool) {
+        // Handshakes post their outcomes to the event loops, so stop them
+        // first
+        d_tlsHandshakePool->shutdown();
+    }
+    if (d_decodePool) {
+        // As are decoded reads
+        d_decodePool->shutdown();
+    }
+
+    for (bsl::vector<EventLoopShard>::iterator it = d_shards.begin();
+         it != d_shards.end();
+         ++it) {
+        it->watchDog.reset();
+        // Shutting down is slow, not stalled
+        it->stallDetector.reset();
+    }
+    d_metricFlushWatchDog.reset();
+    d_executorScalerWatchDog.reset();
+
+    for (bsl::vector<EventLoopShard>::iterator it = d_shards.begin();
+         it != d_shards.end();
+         ++it) {
+        waitForEventLoopExit(*it->eventLoop, it->connectionMonitor);
+    }
 
-    d_watchDog.reset();
+    d_shards.clear();
 
-    const bool eventLoopShutdownResult = d_eventLoop->waitForEventLoopExit(60);
+    if (d_heartbeatScheduler) {
+        // Connections are gone, so nothing holds its thread any more
+        d_heartbeatScheduler->stop();
+    }
+}
 
-    if (!eventLoopShutdownResult) {
-        d_eventLoop->post(bdlf::BindUtil::bind(&asyncFetchConnectionInfo,
-                                               d_connectionMonitor,
-                                               logOnEventLoop.first));
+rmqt::Result<> RabbitContextImpl::shutdown(const bsls::TimeInterval& timeout)
+{
+    const bsls::TimeInterval deadline =
+        bsls::SystemTime::nowRealtimeClock() + timeout;
 
-        const int64_t MAX_CONN_INFO_WAIT_SEC = 60;
+    bsl::vector<Connections> shardConnections;
+    liveConnections(&shardConnections);
 
-        rmqt::Result<ConnectionMonitor::AliveConnectionInfo> result =
-            logOnEventLoop.second.waitResult(
-                bsls::TimeInterval(MAX_CONN_INFO_WAIT_SEC));
+    // Cancel, drain and flush every connection's channels together
+    bsl::vector<rmqt::Future<> > drained;
+    for (bsl::size_t i = 0; i < d_shards.size(); ++i) {
+        if (shardConnections[i].empty()) {
+            continue;
+        }
+        drained.push_back(rmqt::FutureUtil::flatten<void>(
+            d_shards[i].eventLoop->postF<rmqt::Future<> >(bdlf::BindUtil::bind(
+                &drainConnections, shardConnections[i]))));
+    }
+    const rmqt::Result<> drainResult =
+        rmqt::FutureUtil::whenAll(drained).timedWaitResult(deadline);
+    if (!drainResult) {
+        BALL_LOG_WARN << "Closing connections before their channels drained: "
+                      << drainResult.error();
+    }
 
+    // Then close them all together, drained or not
+    bsl::vector<rmqt::Future<> > closed;
+    for (bsl::size_t i = 0; i < d_shards.size(); ++i) {
+        for (Connections::const_iterator it = shardConnections[i].begin();
+             it != shardConnections[i].end();
+             ++it) {
+            rmqt::Future<>::Pair closedPair = rmqt::Future<>::make();
+            d_shards[i].eventLoop->post(bdlf::BindUtil::bind(
+                &rmqamqp::Connection::close,
+                *it,
+                rmqamqp::Connection::CloseFinishCallback(bdlf::BindUtil::bind(
+                    &connectionClosed, closedPair.first))));
+            closed.push_back(closedPair.second);
+        }
+    }
+    const rmqt::Result<> closeResult =
+        rmqt::FutureUtil::whenAll(closed).timedWaitResult(deadline);
+
+    BALL_LOG_INFO << "Shut down " << closed.size() << " connections";
+
+    if (!drainResult) {
+        return rmqt::Result<>("Timed out draining channels on shutdown",
+                              drainResult.returnCode());
+    }
+    if (!closeResult) {
+        return rmqt::Result<>("Timed out closing connections on shutdown",
+                              closeResult.returnCode());
+    }
+    return rmqt::Result<>();
+}
+
+bsl::vector<rmqt::ConnectionStats>
+RabbitContextImpl::stats(const bsls::TimeInterval& timeout)
+{
+    const bsls::TimeInterval deadline =
+        bsls::SystemTime::nowRealtimeClock() + timeout;
+
+    bsl::vector<Connections> shardConnections;
+    liveConnections(&shardConnections);
+
+    // Ask every event loop at once, each reads its own connections
+    bsl::vector<rmqt::Future<bsl::vector<rmqt::ConnectionStats> > > collected;
+    for (bsl::size_t i = 0; i < d_shards.size(); ++i) {
+        if (shardConnections[i].empty()) {
+            continue;
+        }
+        collected.push_back(
+            d_shards[i]
+                .eventLoop->postF<bsl::vector<rmqt::ConnectionStats> >(
+                    bdlf::BindUtil::bind(&collectStats,
+                                         shardConnections[i])));
+    }
+
+    bsl::vector<rmqt::ConnectionStats> stats;
+    for (bsl::size_t i = 0; i < collected.size(); ++i) {
+        const rmqt::Result<bsl::vector<rmqt::ConnectionStats> > result =
+            collected[i].timedWaitResult(deadline);
         if (!result) {
-            BALL_LOG_FATAL
-                << "Attempted to query alive connections on the Event Loop but "
-                   "no response after "
-                << MAX_CONN_INFO_WAIT_SEC
-                << " seconds. Something is badly wrong with the event loop if "
-                   "it can't process anything in this time.";
+            BALL_LOG_WARN << "Leaving out connections from stats: "
+                          << result.error();
+            continue;
         }
-        else {
-            typedef bsl::vector<
-                ConnectionMonitor::AliveConnectionInfo::ConnectionChannelsInfo>
-                ConnChannelInfo;
-
-            const ConnChannelInfo& info =
-                result.value()->aliveConnectionChannelInfo;
-
-            if (info.size() > 0) {
-                bsl::stringstream logOutput;
-
-                for (ConnChannelInfo::const_iterator it = info.begin();
-                     it != info.end();
-                     ++it) {
-
-                    logOutput << " Connection [" << it->first
-                              << "] is still alive. It has "
-                              << it->second.size() << " producers/consumers";
-
-                    if (it->second.size() > 0) {
-                        bsl::string channelsDebugInfo =
-                            boost::algorithm::join(it->second, ", ");
-
-                        logOutput << ": [" << channelsDebugInfo << "]. ";
-                    }
-                }
-
-                BALL_LOG_FATAL
-                    << "Attempting to destruct RabbitContext with outstanding "
-                       "Producer/Consumer references. These will hold up "
-                       "RabbitContext shutdown. Waited 60 seconds. Destruct "
-                       "these objects first: "
-                    << logOutput.str();
+        stats.insert(
+            stats.end(), result.value()->begin(), result.value()->end());
+    }
+    return stats;
+}
+
+bsl::size_t RabbitContextImpl::poll()
+{
+    bsl::size_t ran = 0;
+    for (bsl::size_t i = 0; i < d_shards.size(); ++i) {
+        ran += d_shards[i].eventLoop->poll();
+    }
+    return ran;
+}
+
+bsl::size_t RabbitContextImpl::runFor(const bsls::TimeInterval& duration)
+{
+    // Contexts the application drives have a single event loop
+    bsl::size_t ran = 0;
+    for (bsl::size_t i = 0; i < d_shards.size(); ++i) {
+        ran += d_shards[i].eventLoop->runFor(duration);
+    }
+    return ran;
+}
+
+void RabbitContextImpl::liveConnections(
+    bsl::vector<bsl::vector<bsl::shared_ptr<rmqamqp::Connection> > >*
+        shardConnections)
+{
+    shardConnections->resize(d_shards.size());
+
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_connectionsMutex);
+    for (bsl::size_t i = 0; i < d_shards.size(); ++i) {
+        const bsl::vector<bsl::weak_ptr<rmqamqp::Connection> >& connections =
+            d_shards[i].connections;
+        for (bsl::size_t j = 0; j < connections.size(); ++j) {
+            bsl::shared_ptr<rmqamqp::Connection> connection =
+                connections[j].lock();
+            if (connection) {
+                (*shardConnections)[i].push_back(connection);
             }
         }
     }
+}
 
-    d_eventLoop.reset();
+void RabbitContextImpl::placeOnNumaNodes(
+    const rmqa::RabbitContextOptions& options)
+{
+    const bsl::vector<bsl::vector<int> > nodes =
+        rmqio::NumaTopology::nodeCpus();
+    if (nodes.size() < 2) {
+        BALL_LOG_INFO << "NUMA-aware placement is enabled, but "
+                      << nodes.size()
+                      << " NUMA node(s) were found: threads are not placed";
+        return;
+    }
+
+    for (bsl::size_t node = 0; node < nodes.size(); ++node) {
+        bslmt::ThreadAttributes attributes =
+            options.threadpoolThreadAttributes().value_or(
+                bslmt::ThreadAttributes());
+        attributes.setThreadName(DEFAULT_NUMA_WORKER_NAME +
+                                 bsl::to_string(node));
+
+        // A fixed number of threads, so that each stays bound
+        const int numThreads = static_cast<int>(bsl::min<bsl::size_t>(
+            nodes[node].size(), DEFAULT_THREADPOOL_MAXTHREADS));
+        bsl::shared_ptr<bdlmt::ThreadPool> threadPool =
+            bsl::make_shared<bdlmt::ThreadPool>(
+                attributes,
+                numThreads,
+                numThreads,
+                DEFAULT_THREADPOOL_MAXIDLETIMEMS);
+        threadPool->start();
+        bindWorkers(*threadPool, numThreads, nodes[node]);
+        d_nodeThreadPools.push_back(threadPool);
+    }
+
+    for (bsl::size_t i = 0; i < d_shards.size(); ++i) {
+        const bsl::size_t node = i % nodes.size();
+        d_shards[i].threadPool = d_nodeThreadPools[node].get();
+        if (d_shards[i].cpus.empty()) {
+            d_shards[i].cpus = nodes[node];
+        }
+    }
+
+    BALL_LOG_INFO << "Placed " << d_shards.size() << " event loop(s) on "
+                  << nodes.size() << " NUMA nodes";
+}
+
+RabbitContextImpl::EventLoopShard&
+RabbitContextImpl::selectShard(const bsl::string& connectionName)
+{
+    if (d_shards.size() == 1) {
+        return d_shards.front();
+    }
+
+    const bsl::size_t index = d_eventLoopAffinity
+                                  ? d_eventLoopAffinity(connectionName)
+                                  : d_nextShard.add(1) - 1;
+
+    return d_shards[index % d_shards.size()];
 }
 
 bsl::shared_ptr<rmqp::Connection> RabbitContextImpl::createVHostConnection(
@@ -293,7 +1446,9 @@ bsl::shared_ptr<rmqp::Connection> RabbitContextImpl::createVHostConnection(
                              userDefinedName,
                              endpoint,
                              credentials,
-                             bdlf::PlaceHolders::_1));
+                             bdlf::PlaceHolders::_1,
+                             bsl::shared_ptr<rmqt::Endpoint>()),
+        d_connectionPoolSize);
 }
 
 bsl::shared_ptr<rmqp::Connection>
@@ -306,14 +1461,17 @@ RabbitContextImpl::createVHostConnection(const bsl::string& userDefinedName,
                              userDefinedName,
                              vhostInfo.endpoint(),
                              vhostInfo.credentials(),
-                             bdlf::PlaceHolders::_1));
+                             bdlf::PlaceHolders::_1,
+                             vhostInfo.standbyEndpoint()),
+        d_connectionPoolSize);
 }
 
 rmqt::Future<rmqp::Connection> RabbitContextImpl::createNewConnection(
     const bsl::string& userDefinedName,
     const bsl::shared_ptr<rmqt::Endpoint>& endpoint,
     const bsl::shared_ptr<rmqt::Credentials>& credentials,
-    const bsl::string& suffix)
+    const bsl::string& suffix,
+    const bsl::shared_ptr<rmqt::Endpoint>& standbyEndpoint)
 {
     bsl::string name =
         suffix.empty() ? userDefinedName : userDefinedName + "-" + suffix;
@@ -338,7 +1496,9 @@ rmqt::Future<rmqp::Connection> RabbitContextImpl::createNewConnection(
         return futurePair.second;
     }
 
-    if (!d_eventLoop->isStarted()) {
+    EventLoopShard& shard = selectShard(name);
+
+    if (!shard.eventLoop->isStarted()) {
         rmqt::Future<rmqp::Connection>::Pair futurePair =
             rmqt::Future<rmqp::Connection>::make();
         futurePair.first(rmqt::Result<rmqp::Connection>(
@@ -348,34 +1508,80 @@ rmqt::Future<rmqp::Connection> RabbitContextImpl::createNewConnection(
     }
 
     bsl::shared_ptr<rmqamqp::Connection> amqpConn =
-        d_connectionFactory->create(endpoint, credentials, name);
+        shard.connectionFactory->create(endpoint, credentials, name);
+    {
+        // Forget connections already destroyed, then remember this one
+        bslmt::LockGuard<bslmt::Mutex> guard(&d_connectionsMutex);
+        bsl::vector<bsl::weak_ptr<rmqamqp::Connection> >::iterator it =
+            shard.connections.begin();
+        while (it != shard.connections.end()) {
+            it = it->expired() ? shard.connections.erase(it) : it + 1;
+        }
+        shard.connections.push_back(amqpConn);
+    }
+    if (standbyEndpoint) {
+        // On the same shard, so both are driven by the same event loop
+        amqpConn->setStandby(shard.connectionFactory->create(
+            standbyEndpoint, credentials, name + "-standby"));
+    }
 
     // The cancel function is given `amqpConn` which is what keeps it alive
     // until the shared_ptr<rmqamqp::Connection> is retrieved in
     // initiateConnection
     rmqt::Future<rmqp::Connection>::Pair futurePair =
         rmqt::Future<rmqp::Connection>::make(bdlf::BindUtil::bind(
-            &shutdownAmqpConnection, bsl::ref(*d_eventLoop), amqpConn));
+            &shutdownAmqpConnection, bsl::ref(*shard.eventLoop), amqpConn));
 
     bsl::shared_ptr<ConsumerImpl::Factory> consumerFactory(
         d_consumerTracing
             ? bsl::shared_ptr<ConsumerImpl::Factory>(
-                  new TracingConsumerImpl::Factory(endpoint, d_consumerTracing))
+                  new TracingConsumerImpl::Factory(
+                      endpoint, d_consumerTracing, d_tracingSampler))
             : bsl::make_shared<rmqa::ConsumerImpl::Factory>());
 
     bsl::shared_ptr<ProducerImpl::Factory> producerFactory(
         d_producerTracing
             ? bsl::shared_ptr<ProducerImpl::Factory>(
-                  new TracingProducerImpl::Factory(endpoint, d_producerTracing))
+                  new TracingProducerImpl::Factory(
+                      endpoint, d_producerTracing, d_tracingSampler))
             : bsl::make_shared<ProducerImpl::Factory>());
 
+    consumerFactory->setMessageCodecs(d_messageCodecs);
+    consumerFactory->setChannelSharing(d_consumerChannelSharing);
+    consumerFactory->setDeliveryLatencyMetric(d_deliveryLatencyMetrics);
+    consumerFactory->setInlineDispatchByDefault(d_inlineDispatchByDefault);
+    consumerFactory->setWorkStealingExecutor(d_workStealingExecutor);
+    consumerFactory->setWorkStealingByDefault(
+        static_cast<bool>(d_executorScaler));
+    consumerFactory->setReadBackpressure(d_readBackpressureHighJobs,
+                                         d_readBackpressureLowJobs,
+                                         d_readBackpressureHighBytes,
+                                         d_readBackpressureLowBytes);
+    if (d_compressionCodec) {
+        producerFactory->setCompression(d_compressionCodec,
+                                        d_compressionMinimumSize);
+    }
+    producerFactory->setChannelSharing(d_producerChannelSharing);
+    producerFactory->setSendTimestamps(d_deliveryLatencyMetrics);
+    producerFactory->setPublishSpool(d_publishSpoolDirectory,
+                                     d_publishSpoolCapacity,
+                                     d_publishSpoolHighWaterMark,
+                                     d_publishSpoolLowWaterMark);
+    producerFactory->setBatching(d_producerBatchMaxMessages,
+                                 d_producerBatchMaxBytes,
+                                 d_producerBatchMaxLinger);
+    producerFactory->setLazyOpen(d_lazyProducers, d_producerIdleClose);
+    producerFactory->setMemoryBudget(d_memoryBudget);
+    producerFactory->setRateLimit(d_producerRateLimit, d_publishRateLimiter);
+
     rmqamqp::Connection::ConnectedCallback cb =
         bdlf::BindUtil::bind(&initiateConnection,
                              _1,
                              bsl::weak_ptr<rmqamqp::Connection>(amqpConn),
                              futurePair.first,
-                             bsl::ref(*d_eventLoop),
-                             bsl::ref(*d_threadPool),
+                             bsl::ref(*shard.eventLoop),
+                             bsl::ref(shard.threadPool ? *shard.threadPool
+                                                       : *d_threadPool),
                              d_onError,
                              d_onSuccess,
                              endpoint,
@@ -383,7 +1589,7 @@ rmqt::Future<rmqp::Connection> RabbitContextImpl::createNewConnection(
                              consumerFactory,
                              producerFactory);
 
-    d_eventLoop->post(
+    shard.eventLoop->post(
         bdlf::BindUtil::bind(&startFirstConnection,
                              bsl::weak_ptr<rmqamqp::Connection>(amqpConn),
                              cb));
@@ -17,35 +17,64 @@
 #ifndef INCLUDED_RMQA_RABBITCONTEXTIMPL
 #define INCLUDED_RMQA_RABBITCONTEXTIMPL
 
+#include <rmqa_allocationstats.h>
 #include <rmqa_connectionmonitor.h>
+#include <rmqa_messagecodecutil.h>
 #include <rmqa_rabbitcontextoptions.h>
 
 #include <rmqamqp_connection.h>
+#include <rmqamqp_memorybudget.h>
+#include <rmqamqp_metricaggregator.h>
+#include <rmqamqp_ratelimiter.h>
 #include <rmqio_eventloop.h>
+#include <rmqio_hugepagearena.h>
+#include <rmqio_readstats.h>
+#include <rmqio_stalldetector.h>
+#include <rmqio_task.h>
+#include <rmqio_decodepool.h>
+#include <rmqio_tlshandshakepool.h>
 #include <rmqio_watchdog.h>
+#include <rmqio_writequeuestats.h>
 #include <rmqp_connection.h>
+#include <rmqp_messagecodec.h>
 #include <rmqp_rabbitcontext.h>
 #include <rmqt_endpoint.h>
 #include <rmqt_future.h>
+#include <rmqt_ratelimit.h>
 #include <rmqt_result.h>
 #include <rmqt_vhostinfo.h>
 
 #include <bdlf_bind.h>
+#include <bdlmt_eventscheduler.h>
 #include <bdlmt_threadpool.h>
+#include <bslmt_mutex.h>
+#include <bsls_atomic.h>
 #include <bsls_keyword.h>
 #include <bsls_timeinterval.h>
 
+#include <bsl_cstddef.h>
 #include <bsl_memory.h>
+#include <bsl_optional.h>
 #include <bsl_string.h>
+#include <bsl_vector.h>
 
 namespace BloombergLP {
 namespace rmqa {
+class TracingSampler;
+class WorkStealingExecutor;
 
 class RabbitContextImpl : public rmqp::RabbitContext {
   public:
+    typedef bsl::vector<bsl::shared_ptr<rmqio::EventLoop> > EventLoops;
+
     RabbitContextImpl(bslma::ManagedPtr<rmqio::EventLoop> eventLoop,
                       const rmqa::RabbitContextOptions& options);
 
+    /// Connections are spread across `eventLoops`, which must not be empty,
+    /// according to `options.eventLoopAffinity()`, or round-robin if unset.
+    RabbitContextImpl(const EventLoops& eventLoops,
+                      const rmqa::RabbitContextOptions& options);
+
     ~RabbitContextImpl();
 
     bsl::shared_ptr<rmqp::Connection>
@@ -58,29 +87,139 @@ class RabbitContextImpl : public rmqp::RabbitContext {
         const bsl::string& userDefinedName,
         const rmqt::VHostInfo& endpoint) BSLS_KEYWORD_OVERRIDE;
 
-    rmqt::Future<rmqp::Connection>
-    createNewConnection(const bsl::string& name,
-                        const bsl::shared_ptr<rmqt::Endpoint>& endpoint,
-                        const bsl::shared_ptr<rmqt::Credentials>& credentials,
-                        const bsl::string& suffix);
+    /// Drain the channels of every connection opened so far, on all event
+    /// loops at once, then close those connections at once, see
+    /// `rmqa::RabbitContext::shutdown`
+    rmqt::Result<>
+    shutdown(const bsls::TimeInterval& timeout) BSLS_KEYWORD_OVERRIDE;
+
+    /// Collect the stats of every connection opened so far on its event
+    /// loop, see `rmqa::RabbitContext::stats`
+    bsl::vector<rmqt::ConnectionStats>
+    stats(const bsls::TimeInterval& timeout) BSLS_KEYWORD_OVERRIDE;
+
+    /// Run the ready work of every event loop the application drives, see
+    /// `rmqa::RabbitContext::poll`
+    bsl::size_t poll() BSLS_KEYWORD_OVERRIDE;
+
+    bsl::size_t
+    runFor(const bsls::TimeInterval& duration) BSLS_KEYWORD_OVERRIDE;
+
+    /// Open a connection to `endpoint`, with a warm standby connection to
+    /// `standbyEndpoint` if given, see `rmqt::VHostInfo::setStandbyEndpoint`
+    rmqt::Future<rmqp::Connection> createNewConnection(
+        const bsl::string& name,
+        const bsl::shared_ptr<rmqt::Endpoint>& endpoint,
+        const bsl::shared_ptr<rmqt::Credentials>& credentials,
+        const bsl::string& suffix,
+        const bsl::shared_ptr<rmqt::Endpoint>& standbyEndpoint =
+            bsl::shared_ptr<rmqt::Endpoint>());
 
   private:
     RabbitContextImpl(const RabbitContextImpl&) BSLS_KEYWORD_DELETED;
     RabbitContextImpl& operator=(const RabbitContextImpl&) BSLS_KEYWORD_DELETED;
 
+    /// An event loop together with the connection factory and monitoring
+    /// for the connections it runs
+    struct EventLoopShard {
+        bsl::shared_ptr<rmqio::EventLoop> eventLoop;
+        bsl::shared_ptr<rmqio::WatchDog> watchDog;
+        bsl::shared_ptr<ConnectionMonitor> connectionMonitor;
+        bsl::shared_ptr<rmqamqp::Connection::Factory> connectionFactory;
+        bsl::shared_ptr<rmqio::Task> busyPollMetrics;
+        bsl::shared_ptr<rmqio::WriteQueueStats> writeQueueStats;
+        bsl::shared_ptr<rmqio::ReadStats> readStats;
+        bsl::shared_ptr<rmqio::Task> eventLoopMetrics;
+        bsl::shared_ptr<rmqio::StallDetector> stallDetector;
+
+        /// CPUs the event loop thread is bound to, if any
+        bsl::vector<int> cpus;
+
+        /// Runs the callbacks of this event loop's connections, if not the
+        /// context's threadpool
+        bdlmt::ThreadPool* threadPool;
+
+        /// Connections opened on this event loop, guarded by
+        /// `d_connectionsMutex`
+        bsl::vector<bsl::weak_ptr<rmqamqp::Connection> > connections;
+    };
+
+    void init(const EventLoops& eventLoops,
+              const rmqa::RabbitContextOptions& options);
+
+    EventLoopShard& selectShard(const bsl::string& connectionName);
+
+    /// Give each NUMA node a worker pool bound to its CPUs, and place each
+    /// shard on a node, if the host has more than one
+    void placeOnNumaNodes(const rmqa::RabbitContextOptions& options);
+
+    /// Load the connections of each shard still alive, by shard index
+    void liveConnections(
+        bsl::vector<bsl::vector<bsl::shared_ptr<rmqamqp::Connection> > >*
+            shardConnections);
+
   private:
     static const int DEFAULT_WATCHDOG_PERIOD = 60;
-    bslma::ManagedPtr<rmqio::EventLoop> d_eventLoop;
-    bsl::shared_ptr<rmqio::WatchDog> d_watchDog;
+    bsl::vector<EventLoopShard> d_shards;
+    RabbitContextOptions::EventLoopAffinity d_eventLoopAffinity;
+    bsls::AtomicUint d_nextShard;
     bdlmt::ThreadPool* d_threadPool;
     bslma::ManagedPtr<bdlmt::ThreadPool> d_hostedThreadPool;
+    /// One per NUMA node, if placing connections on NUMA nodes
+    bsl::vector<bsl::shared_ptr<bdlmt::ThreadPool> > d_nodeThreadPools;
+    /// Runs consumers with work-stealing dispatch, if configured
+    bsl::shared_ptr<WorkStealingExecutor> d_workStealingExecutor;
+    /// Sizes `d_workStealingExecutor`, if adaptive dispatch is configured
+    bsl::shared_ptr<rmqio::Task> d_executorScaler;
+    bsl::shared_ptr<rmqio::WatchDog> d_executorScalerWatchDog;
     rmqt::ErrorCallback d_onError;
     rmqt::SuccessCallback d_onSuccess;
-    bsl::shared_ptr<ConnectionMonitor> d_connectionMonitor;
-    bslma::ManagedPtr<rmqamqp::Connection::Factory> d_connectionFactory;
+    rmqt::ConnectionBlockedCallback d_onBlocked;
     rmqt::Tunables d_tunables;
     bsl::shared_ptr<rmqp::ConsumerTracing> d_consumerTracing;
     bsl::shared_ptr<rmqp::ProducerTracing> d_producerTracing;
+    bsl::shared_ptr<TracingSampler> d_tracingSampler;
+    bsl::shared_ptr<rmqp::MessageCodec> d_compressionCodec;
+    bsl::size_t d_compressionMinimumSize;
+    MessageCodecUtil::Codecs d_messageCodecs;
+    bool d_producerChannelSharing;
+    bool d_consumerChannelSharing;
+    /// Consumers dispatching to the threadpool run inline instead
+    bool d_inlineDispatchByDefault;
+    bsl::size_t d_connectionPoolSize;
+    bsl::size_t d_publishSpoolCapacity;
+    bsl::size_t d_publishSpoolHighWaterMark;
+    bsl::size_t d_publishSpoolLowWaterMark;
+    bsl::string d_publishSpoolDirectory;
+    bsl::size_t d_producerBatchMaxMessages;
+    bsl::size_t d_producerBatchMaxBytes;
+    bsls::TimeInterval d_producerBatchMaxLinger;
+    bool d_lazyProducers;
+    bsls::TimeInterval d_producerIdleClose;
+    bsl::optional<rmqt::RateLimit> d_producerRateLimit;
+    /// Shared by every producer, if publishing is rate limited
+    bsl::shared_ptr<rmqamqp::RateLimiter> d_publishRateLimiter;
+    bool d_deliveryLatencyMetrics;
+    bsl::size_t d_readBackpressureHighJobs;
+    bsl::size_t d_readBackpressureLowJobs;
+    bsl::size_t d_readBackpressureHighBytes;
+    bsl::size_t d_readBackpressureLowBytes;
+    bsl::shared_ptr<rmqio::Task> d_tlsSessionMetrics;
+    /// Runs TLS handshakes, if they are kept off the event loops
+    bsl::shared_ptr<rmqio::TlsHandshakePool> d_tlsHandshakePool;
+    /// Decodes connections' reads, if kept off the event loops
+    bsl::shared_ptr<rmqio::DecodePool> d_decodePool;
+    bsl::shared_ptr<rmqamqp::MemoryBudget> d_memoryBudget;
+    bsl::shared_ptr<rmqio::Task> d_memoryBudgetMetrics;
+    /// Checks every connection's heartbeats, if not left to the loops
+    bsl::shared_ptr<bdlmt::EventScheduler> d_heartbeatScheduler;
+    bsl::shared_ptr<AllocationStats> d_allocationStats;
+    bsl::shared_ptr<rmqio::Task> d_allocationMetrics;
+    /// Backs the per-message buffers, if huge page buffers are configured
+    bsl::shared_ptr<rmqio::HugePageArena> d_hugePageArena;
+    bsl::shared_ptr<rmqamqp::MetricAggregator> d_metricAggregator;
+    bsl::shared_ptr<rmqio::WatchDog> d_metricFlushWatchDog;
+    bslmt::Mutex d_connectionsMutex;
 };
 
 } // namespace rmqa
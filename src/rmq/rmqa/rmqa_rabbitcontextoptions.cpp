@@ -16,12 +16,15 @@
 #include <rmqa_rabbitcontextoptions.h>
 
 #include <rmqamqpt_constants.h>
+#include <rmqio_connectionoptions.h>
 
 #include <ball_log.h>
 #include <bdlf_bind.h>
 #include <bdls_osutil.h>
 #include <bdls_processutil.h>
 
+#include <bsl_algorithm.h>
+
 namespace BloombergLP {
 namespace rmqa {
 namespace {
@@ -62,11 +65,93 @@ RabbitContextOptions::RabbitContextOptions()
                                  bdlf::PlaceHolders::_1,
                                  bdlf::PlaceHolders::_2))
 , d_metricPublisher()
+, d_metricAggregation()
 , d_clientProperties()
 , d_messageProcessingTimeout(DEFAULT_MESSAGE_PROCESSING_TIMEOUT)
+, d_ackDeadline()
+, d_ackDeadlineCallback()
 , d_tunables()
 , d_connectionErrorThreshold()
+, d_tracingSampleOneIn(1)
+, d_tracingSampleMaxPerSecond(0)
+, d_tracingSamplePropagate(false)
+, d_compressionCodec()
+, d_compressionMinimumSize(0)
+, d_messageCodecs()
 , d_shuffleConnectionEndpoints()
+, d_writeCoalescing()
+, d_deferWrites(false)
+, d_maxReadBytes(0)
+, d_readFrameBudget(0)
+, d_eventLoopThreads(1)
+, d_eventLoopAffinity()
+, d_eventLoopThreadAttributes()
+, d_eventLoopCpuAffinity()
+, d_numaAware(false)
+, d_eventLoopStallThreshold()
+, d_eventLoopStallStackSignal(0)
+, d_heartbeatThread(false)
+, d_threadpoolThreadAttributes()
+, d_eventLoopBusyPoll()
+, d_eventLoopTimerWheel()
+, d_eventLoopMetrics(false)
+, d_socketBusyPoll()
+, d_coarseClock(false)
+, d_pipelineTiming(false)
+, d_kernelTls(false)
+, d_tlsSessionResumption(false)
+, d_tlsHandshakeThreads(0)
+, d_tlsHandshakeTimeout(30)
+, d_decodeThreads(0)
+, d_resolutionCacheTtl()
+, d_wireCapturePath()
+, d_connectRace()
+, d_producerChannelSharing(false)
+, d_consumerChannelSharing(false)
+, d_workStealingWorkers(0)
+, d_workStealingQuota(16)
+, d_adaptiveMinWorkers(0)
+, d_adaptiveMaxWorkers(0)
+, d_adaptiveScalingPeriod(1)
+, d_connectionPoolSize(1)
+, d_publishSpoolCapacity(0)
+, d_publishSpoolHighWaterMark(0)
+, d_publishSpoolLowWaterMark(0)
+, d_publishSpoolDirectory()
+, d_producerBatchMaxMessages(0)
+, d_producerBatchMaxBytes(0)
+, d_producerBatchMaxLinger()
+, d_lazyProducers(false)
+, d_producerIdleClose()
+, d_producerRateLimit()
+, d_publishRateLimit()
+, d_deliveryLatencyMetrics(false)
+, d_channelMetrics(false)
+, d_memoryBudget(0)
+, d_allocator(0)
+, d_allocationStats()
+, d_hugePageBufferBytes(0)
+, d_explicitHugePages(false)
+, d_idleTrimPeriod()
+, d_idleTrimWatermark(0)
+, d_messageGuidMode()
+, d_readBackpressureHighJobs(0)
+, d_readBackpressureLowJobs(0)
+, d_readBackpressureHighBytes(0)
+, d_readBackpressureLowBytes(0)
+, d_frameMax()
+, d_channelMax()
+, d_defaultAckCoalescingDelay()
+, d_defaultAckCoalescingTags(0)
+, d_resendBatchSize(DEFAULT_RESEND_BATCH_SIZE)
+, d_processWideSharing(false)
+, d_ioContext(0)
+, d_applicationDriven(false)
+, d_socketOptions()
+, d_jitteredReconnect()
+, d_maxConcurrentConnects(0)
+, d_topologyCacheDirectory()
+, d_hostSelection(rmqt::HostSelection::ROUND_ROBIN)
 {
     populateUsefulInformation(&d_clientProperties);
 }
@@ -92,6 +177,13 @@ RabbitContextOptions::setSuccessCallback(const rmqt::SuccessCallback& successCal
     return *this;
 }
 
+RabbitContextOptions& RabbitContextOptions::setConnectionBlockedCallback(
+    const rmqt::ConnectionBlockedCallback& blockedCallback)
+{
+    d_onBlocked = blockedCallback;
+    return *this;
+}
+
 RabbitContextOptions& RabbitContextOptions::setMetricPublisher(
     const bsl::shared_ptr<rmqp::MetricPublisher>& metricPublisher)
 {
@@ -99,6 +191,13 @@ RabbitContextOptions& RabbitContextOptions::setMetricPublisher(
     return *this;
 }
 
+RabbitContextOptions&
+RabbitContextOptions::setMetricAggregation(const bsls::TimeInterval& interval)
+{
+    d_metricAggregation = interval;
+    return *this;
+}
+
 RabbitContextOptions&
 RabbitContextOptions::setClientProperty(const bsl::string& name,
                                         const rmqt::FieldValue& value)
@@ -114,6 +213,15 @@ RabbitContextOptions& RabbitContextOptions::setMessageProcessingTimeout(
     return *this;
 }
 
+RabbitContextOptions& RabbitContextOptions::setAckDeadline(
+    const bsls::TimeInterval& deadline,
+    const AckDeadlineCallback& callback /* = AckDeadlineCallback() */)
+{
+    d_ackDeadline         = deadline;
+    d_ackDeadlineCallback = callback;
+    return *this;
+}
+
 RabbitContextOptions& RabbitContextOptions::setConnectionErrorThreshold(
     const bsl::optional<bsls::TimeInterval>& timeout)
 {
@@ -121,6 +229,35 @@ RabbitContextOptions& RabbitContextOptions::setConnectionErrorThreshold(
     return *this;
 }
 
+RabbitContextOptions&
+RabbitContextOptions::setJitteredReconnect(const bsls::TimeInterval& minWait,
+                                           const bsls::TimeInterval& maxWait)
+{
+    d_jitteredReconnect = bsl::make_pair(minWait, maxWait);
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setMaxConcurrentConnects(bsl::size_t maxConnects)
+{
+    d_maxConcurrentConnects = maxConnects;
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setTopologyCacheDirectory(const bsl::string& directory)
+{
+    d_topologyCacheDirectory = directory;
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setHostSelection(rmqt::HostSelection::Value policy)
+{
+    d_hostSelection = policy;
+    return *this;
+}
+
 RabbitContextOptions& RabbitContextOptions::setConsumerTracing(
     const bsl::shared_ptr<rmqp::ConsumerTracing>& consumerTracing)
 {
@@ -135,6 +272,37 @@ RabbitContextOptions& RabbitContextOptions::setProducerTracing(
     return *this;
 }
 
+RabbitContextOptions&
+RabbitContextOptions::setTracingSampling(bsl::uint32_t oneIn,
+                                         bsl::uint32_t maxPerSecond,
+                                         bool propagate)
+{
+    d_tracingSampleOneIn        = oneIn ? oneIn : 1;
+    d_tracingSampleMaxPerSecond = maxPerSecond;
+    d_tracingSamplePropagate    = propagate;
+    return *this;
+}
+
+RabbitContextOptions& RabbitContextOptions::setMessageCompression(
+    const bsl::shared_ptr<rmqp::MessageCodec>& codec,
+    bsl::size_t minimumSize)
+{
+    d_compressionCodec       = codec;
+    d_compressionMinimumSize = minimumSize;
+    return addMessageCodec(codec);
+}
+
+RabbitContextOptions& RabbitContextOptions::addMessageCodec(
+    const bsl::shared_ptr<rmqp::MessageCodec>& codec)
+{
+    if (codec && bsl::find(d_messageCodecs.begin(),
+                           d_messageCodecs.end(),
+                           codec) == d_messageCodecs.end()) {
+        d_messageCodecs.push_back(codec);
+    }
+    return *this;
+}
+
 RabbitContextOptions& RabbitContextOptions::useRabbitMQFieldValueEncoding(bool)
 {
     return *this;
@@ -147,6 +315,423 @@ RabbitContextOptions& RabbitContextOptions::setShuffleConnectionEndpoints(
     return *this;
 }
 
+RabbitContextOptions&
+RabbitContextOptions::setWriteCoalescing(bsl::size_t maxBytes,
+                                         bsl::size_t maxBuffers)
+{
+    d_writeCoalescing = bsl::make_pair(maxBytes, maxBuffers);
+    return *this;
+}
+
+RabbitContextOptions& RabbitContextOptions::setDeferWrites(bool enabled)
+{
+    d_deferWrites = enabled;
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setAdaptiveReads(bsl::size_t maxBytes)
+{
+    d_maxReadBytes = maxBytes;
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setReadFrameBudget(bsl::size_t frames)
+{
+    d_readFrameBudget = frames;
+    return *this;
+}
+
+RabbitContextOptions& RabbitContextOptions::setFrameMax(bsl::uint32_t frameMax)
+{
+    d_frameMax = frameMax;
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setChannelMax(bsl::uint16_t channelMax)
+{
+    d_channelMax = channelMax;
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setDefaultAckCoalescing(const bsls::TimeInterval& delay,
+                                              bsl::size_t tags)
+{
+    d_defaultAckCoalescingDelay = delay;
+    d_defaultAckCoalescingTags  = tags;
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setResendBatchSize(bsl::size_t batchMessages)
+{
+    d_resendBatchSize = batchMessages;
+    return *this;
+}
+
+RabbitContextOptions& RabbitContextOptions::setProcessWideSharing(bool enabled)
+{
+    d_processWideSharing = enabled;
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setIoContext(boost::asio::io_context* context)
+{
+    d_ioContext = context;
+    return *this;
+}
+
+RabbitContextOptions& RabbitContextOptions::setApplicationDriven(bool enabled)
+{
+    d_applicationDriven = enabled;
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::applyProfile(Profile::Value profile)
+{
+    const bsl::size_t maxBuffers =
+        rmqio::ConnectionOptions::k_DEFAULT_MAX_COALESCED_WRITE_BUFFERS;
+
+    switch (profile) {
+        case Profile::LOW_LATENCY:
+            setFrameMax(128 * 1024);
+            setAdaptiveReads(0);
+            setWriteCoalescing(16 * 1024, maxBuffers);
+            setDeferWrites(false);
+            setDefaultAckCoalescing(bsls::TimeInterval());
+            break;
+        case Profile::BULK_THROUGHPUT:
+            setFrameMax(1024 * 1024);
+            setAdaptiveReads(4 * 1024 * 1024);
+            setWriteCoalescing(1024 * 1024, maxBuffers);
+            setDeferWrites(true);
+            setDefaultAckCoalescing(bsls::TimeInterval(0, 10 * 1000 * 1000),
+                                    512);
+            break;
+    }
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setEventLoopThreads(bsl::size_t numThreads)
+{
+    d_eventLoopThreads = numThreads > 0 ? numThreads : 1;
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setEventLoopAffinity(const EventLoopAffinity& affinity)
+{
+    d_eventLoopAffinity = affinity;
+    return *this;
+}
+
+RabbitContextOptions& RabbitContextOptions::setEventLoopThreadAttributes(
+    const bslmt::ThreadAttributes& attributes)
+{
+    d_eventLoopThreadAttributes = attributes;
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setEventLoopCpuAffinity(const bsl::vector<int>& cpus)
+{
+    d_eventLoopCpuAffinity = cpus;
+    return *this;
+}
+
+RabbitContextOptions& RabbitContextOptions::setNumaAware(bool enabled)
+{
+    d_numaAware = enabled;
+    return *this;
+}
+
+RabbitContextOptions& RabbitContextOptions::setEventLoopStallThreshold(
+    const bsls::TimeInterval& threshold)
+{
+    d_eventLoopStallThreshold = threshold;
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setEventLoopStallStackSignal(int signalNumber)
+{
+    d_eventLoopStallStackSignal = signalNumber;
+    return *this;
+}
+
+RabbitContextOptions& RabbitContextOptions::setHeartbeatThread(bool enabled)
+{
+    d_heartbeatThread = enabled;
+    return *this;
+}
+
+RabbitContextOptions& RabbitContextOptions::setThreadpoolThreadAttributes(
+    const bslmt::ThreadAttributes& attributes)
+{
+    d_threadpoolThreadAttributes = attributes;
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setEventLoopBusyPoll(const bsls::TimeInterval& spinBudget)
+{
+    d_eventLoopBusyPoll = spinBudget;
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setEventLoopTimerWheel(const bsls::TimeInterval& tick)
+{
+    d_eventLoopTimerWheel = tick;
+    return *this;
+}
+
+RabbitContextOptions& RabbitContextOptions::setSocketBusyPoll(int microseconds)
+{
+    d_socketBusyPoll = microseconds;
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setSocketOptions(const rmqt::SocketOptions& options)
+{
+    d_socketOptions = options;
+    return *this;
+}
+
+RabbitContextOptions& RabbitContextOptions::setEventLoopMetrics(bool enabled)
+{
+    d_eventLoopMetrics = enabled;
+    return *this;
+}
+
+RabbitContextOptions& RabbitContextOptions::setCoarseClock(bool enabled)
+{
+    d_coarseClock = enabled;
+    return *this;
+}
+
+RabbitContextOptions& RabbitContextOptions::setPipelineTiming(bool enabled)
+{
+    d_pipelineTiming = enabled;
+    return *this;
+}
+
+RabbitContextOptions& RabbitContextOptions::setKernelTls(bool enabled)
+{
+    d_kernelTls = enabled;
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setTlsSessionResumption(bool enabled)
+{
+    d_tlsSessionResumption = enabled;
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setTlsHandshakeThreads(bsl::size_t numThreads,
+                                             const bsls::TimeInterval& timeout)
+{
+    d_tlsHandshakeThreads = numThreads;
+    d_tlsHandshakeTimeout = timeout;
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setDecodeThreads(bsl::size_t numThreads)
+{
+    d_decodeThreads = numThreads;
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setResolutionCacheTtl(const bsls::TimeInterval& ttl)
+{
+    d_resolutionCacheTtl = ttl;
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setWireCapturePath(const bsl::string& path)
+{
+    d_wireCapturePath = path;
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setConnectRace(const bsls::TimeInterval& stagger)
+{
+    d_connectRace = stagger;
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setProducerChannelSharing(bool enabled)
+{
+    d_producerChannelSharing = enabled;
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setConsumerChannelSharing(bool enabled)
+{
+    d_consumerChannelSharing = enabled;
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setWorkStealingDispatch(bsl::size_t numWorkers,
+                                              bsl::size_t quota)
+{
+    d_workStealingWorkers = numWorkers;
+    d_workStealingQuota   = quota;
+    return *this;
+}
+
+RabbitContextOptions& RabbitContextOptions::setAdaptiveDispatch(
+    bsl::size_t minWorkers,
+    bsl::size_t maxWorkers,
+    const bsls::TimeInterval& scalingPeriod)
+{
+    d_adaptiveMinWorkers    = minWorkers;
+    d_adaptiveMaxWorkers    = maxWorkers;
+    d_adaptiveScalingPeriod = scalingPeriod;
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setConnectionPoolSize(bsl::size_t poolSize)
+{
+    d_connectionPoolSize = poolSize;
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setPublishSpool(bsl::size_t capacity,
+                                      bsl::size_t highWaterMark,
+                                      bsl::size_t lowWaterMark,
+                                      const bsl::string& directory)
+{
+    d_publishSpoolCapacity      = capacity;
+    d_publishSpoolHighWaterMark = highWaterMark;
+    d_publishSpoolLowWaterMark  = lowWaterMark;
+    d_publishSpoolDirectory     = directory;
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setProducerBatching(bsl::size_t maxMessages,
+                                          bsl::size_t maxBytes,
+                                          const bsls::TimeInterval& maxLinger)
+{
+    d_producerBatchMaxMessages = maxMessages;
+    d_producerBatchMaxBytes    = maxBytes;
+    d_producerBatchMaxLinger   = maxLinger;
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setLazyProducers(bool enabled,
+                                       const bsls::TimeInterval& idleClose)
+{
+    d_lazyProducers     = enabled;
+    d_producerIdleClose = idleClose;
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setProducerRateLimit(const rmqt::RateLimit& limit)
+{
+    d_producerRateLimit = limit;
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setPublishRateLimit(const rmqt::RateLimit& limit)
+{
+    d_publishRateLimit = limit;
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setDeliveryLatencyMetrics(bool enabled)
+{
+    d_deliveryLatencyMetrics = enabled;
+    return *this;
+}
+
+RabbitContextOptions& RabbitContextOptions::setChannelMetrics(bool enabled)
+{
+    d_channelMetrics = enabled;
+    return *this;
+}
+
+RabbitContextOptions& RabbitContextOptions::setMemoryBudget(bsl::size_t bytes)
+{
+    d_memoryBudget = bytes;
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setAllocator(bslma::Allocator* allocator)
+{
+    d_allocator = allocator;
+    return *this;
+}
+
+RabbitContextOptions& RabbitContextOptions::setAllocationStats(
+    const bsl::shared_ptr<AllocationStats>& stats)
+{
+    d_allocationStats = stats;
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setHugePageBuffers(bsl::size_t bytes,
+                                         bool explicitHugePages)
+{
+    d_hugePageBufferBytes = bytes;
+    d_explicitHugePages   = explicitHugePages;
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setIdleTrim(const bsls::TimeInterval& idlePeriod,
+                                  bsl::size_t watermarkFrames)
+{
+    d_idleTrimPeriod    = idlePeriod;
+    d_idleTrimWatermark = watermarkFrames;
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setMessageGuidMode(rmqt::MessageGuidMode::Value mode)
+{
+    d_messageGuidMode = mode;
+    return *this;
+}
+
+RabbitContextOptions&
+RabbitContextOptions::setConsumerReadBackpressure(bsl::size_t highJobs,
+                                                  bsl::size_t lowJobs,
+                                                  bsl::size_t highBytes,
+                                                  bsl::size_t lowBytes)
+{
+    d_readBackpressureHighJobs  = highJobs;
+    d_readBackpressureLowJobs   = lowJobs;
+    d_readBackpressureHighBytes = highBytes;
+    d_readBackpressureLowBytes  = lowBytes;
+    return *this;
+}
+
 #ifdef USES_LIBRMQ_EXPERIMENTAL_FEATURES
 RabbitContextOptions&
 RabbitContextOptions::setTunable(const bsl::string& tunable)
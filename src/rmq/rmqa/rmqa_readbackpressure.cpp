@@ -0,0 +1,118 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_readbackpressure.h>
+
+#include <ball_log.h>
+#include <bslmt_lockguard.h>
+
+#include <bsl_algorithm.h>
+
+namespace BloombergLP {
+namespace rmqa {
+namespace {
+
+BALL_LOG_SET_NAMESPACE_CATEGORY("RMQA.READBACKPRESSURE")
+
+} // namespace
+
+ReadBackpressure::ReadBackpressure(bsl::size_t highJobs,
+                                   bsl::size_t lowJobs,
+                                   bsl::size_t highBytes,
+                                   bsl::size_t lowBytes)
+: d_highJobs(highJobs)
+, d_lowJobs(bsl::min(lowJobs, highJobs))
+, d_highBytes(highBytes)
+, d_lowBytes(bsl::min(lowBytes, highBytes))
+, d_pause()
+, d_resume()
+, d_mutex()
+, d_jobs(0)
+, d_bytes(0)
+, d_paused(false)
+{
+}
+
+void ReadBackpressure::setCallbacks(const Callback& pause,
+                                    const Callback& resume)
+{
+    d_pause  = pause;
+    d_resume = resume;
+}
+
+void ReadBackpressure::add(bsl::size_t jobs, bsl::size_t bytes)
+{
+    {
+        bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+        d_jobs += jobs;
+        d_bytes += bytes;
+
+        if (d_paused || !((d_highJobs && d_jobs >= d_highJobs) ||
+                          (d_highBytes && d_bytes >= d_highBytes))) {
+            return;
+        }
+
+        BALL_LOG_INFO << d_jobs << " consumer jobs holding " << d_bytes
+                      << " bytes are pending, pausing reads";
+        d_paused = true;
+    }
+
+    if (d_pause) {
+        d_pause();
+    }
+}
+
+void ReadBackpressure::remove(bsl::size_t jobs, bsl::size_t bytes)
+{
+    {
+        bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+        d_jobs -= bsl::min(jobs, d_jobs);
+        d_bytes -= bsl::min(bytes, d_bytes);
+
+        if (!d_paused || (d_highJobs && d_jobs > d_lowJobs) ||
+            (d_highBytes && d_bytes > d_lowBytes)) {
+            return;
+        }
+
+        BALL_LOG_INFO << "Consumer jobs drained to " << d_jobs
+                      << ", resuming reads";
+        d_paused = false;
+    }
+
+    if (d_resume) {
+        d_resume();
+    }
+}
+
+bool ReadBackpressure::paused() const
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    return d_paused;
+}
+
+bsl::size_t ReadBackpressure::jobs() const
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    return d_jobs;
+}
+
+bsl::size_t ReadBackpressure::bytes() const
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    return d_bytes;
+}
+
+} // namespace rmqa
+} // namespace BloombergLP
@@ -0,0 +1,89 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQA_READBACKPRESSURE
+#define INCLUDED_RMQA_READBACKPRESSURE
+
+#include <bslmt_mutex.h>
+#include <bsls_keyword.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_functional.h>
+
+//@PURPOSE: Pause socket reads while consumer jobs back up
+//
+//@CLASSES:
+//  rmqa::ReadBackpressure: Water marks on a connection's pending consumer
+//  jobs
+
+namespace BloombergLP {
+namespace rmqa {
+
+/// \brief Counts the consumer jobs, and the message bytes they carry,
+/// waiting on the threadpool for one connection
+///
+/// `pause` is invoked when the jobs or bytes reach their high-water mark,
+/// and `resume` once both have drained to their low-water marks. A high-water
+/// mark of zero leaves that dimension unchecked.
+///
+/// Thread safe. The callbacks are invoked without the mutex held, on the
+/// thread calling `add` or `remove`.
+
+class ReadBackpressure {
+  public:
+    typedef bsl::function<void()> Callback;
+
+    ReadBackpressure(bsl::size_t highJobs,
+                     bsl::size_t lowJobs,
+                     bsl::size_t highBytes,
+                     bsl::size_t lowBytes);
+
+    /// Must be called before the first `add`
+    void setCallbacks(const Callback& pause, const Callback& resume);
+
+    /// Count `jobs` jobs carrying `bytes` message bytes
+    void add(bsl::size_t jobs, bsl::size_t bytes);
+
+    /// Uncount jobs counted by `add`, once they have run
+    void remove(bsl::size_t jobs, bsl::size_t bytes);
+
+    bool paused() const;
+
+    bsl::size_t jobs() const;
+
+    bsl::size_t bytes() const;
+
+  private:
+    ReadBackpressure(const ReadBackpressure&) BSLS_KEYWORD_DELETED;
+    ReadBackpressure& operator=(const ReadBackpressure&) BSLS_KEYWORD_DELETED;
+
+    const bsl::size_t d_highJobs;
+    const bsl::size_t d_lowJobs;
+    const bsl::size_t d_highBytes;
+    const bsl::size_t d_lowBytes;
+
+    Callback d_pause;
+    Callback d_resume;
+
+    mutable bslmt::Mutex d_mutex;
+    bsl::size_t d_jobs;
+    bsl::size_t d_bytes;
+    bool d_paused;
+}; // class ReadBackpressure
+
+} // namespace rmqa
+} // namespace BloombergLP
+
+#endif // ! INCLUDED_RMQA_READBACKPRESSURE
@@ -0,0 +1,128 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_redeliveryfilter.h>
+
+#include <bslmt_lockguard.h>
+#include <bsls_systemtime.h>
+
+namespace BloombergLP {
+namespace rmqa {
+
+RedeliveryFilter::RedeliveryFilter(bsl::size_t capacity,
+                                   const bsls::TimeInterval& window,
+                                   const KeyFunc& key)
+: d_capacity(capacity)
+, d_window(window)
+, d_key(key)
+, d_mutex()
+, d_entries()
+, d_index()
+{
+}
+
+bsl::string RedeliveryFilter::key(const rmqt::Message& message,
+                                  const rmqt::Envelope& envelope) const
+{
+    if (d_key) {
+        return d_key(message, envelope);
+    }
+    if (message.properties().messageId.isNull()) {
+        return bsl::string();
+    }
+    return message.properties().messageId.value();
+}
+
+void RedeliveryFilter::insert(const bsl::string& key,
+                              const bsls::TimeInterval& now)
+{
+    if (key.empty() || d_capacity == 0) {
+        return;
+    }
+
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+
+    bsl::unordered_map<bsl::string, Entries::iterator>::iterator it =
+        d_index.find(key);
+    if (it != d_index.end()) {
+        it->second->ackedAt = now;
+        d_entries.splice(d_entries.begin(), d_entries, it->second);
+        return;
+    }
+
+    Entry entry;
+    entry.key     = key;
+    entry.ackedAt = now;
+    d_entries.push_front(entry);
+    d_index[key] = d_entries.begin();
+
+    // The oldest keys are at the back, whether over capacity or expired
+    while (d_entries.size() > d_capacity || expired(d_entries.back(), now)) {
+        d_index.erase(d_entries.back().key);
+        d_entries.pop_back();
+    }
+}
+
+bool RedeliveryFilter::contains(const bsl::string& key,
+                                const bsls::TimeInterval& now)
+{
+    if (key.empty()) {
+        return false;
+    }
+
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+
+    bsl::unordered_map<bsl::string, Entries::iterator>::iterator it =
+        d_index.find(key);
+    if (it == d_index.end()) {
+        return false;
+    }
+    if (expired(*it->second, now)) {
+        d_entries.erase(it->second);
+        d_index.erase(it);
+        return false;
+    }
+    return true;
+}
+
+bool RedeliveryFilter::isUnprocessed(const rmqt::Message& message,
+                                     const rmqt::Envelope& envelope)
+{
+    // Only redeliveries can have been processed before
+    return !envelope.redelivered() ||
+           !contains(key(message, envelope),
+                     bsls::SystemTime::nowMonotonicClock());
+}
+
+void RedeliveryFilter::processed(const rmqt::Message& message,
+                                 const rmqt::Envelope& envelope)
+{
+    insert(key(message, envelope), bsls::SystemTime::nowMonotonicClock());
+}
+
+bsl::size_t RedeliveryFilter::size() const
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    return d_entries.size();
+}
+
+bool RedeliveryFilter::expired(const Entry& entry,
+                               const bsls::TimeInterval& now) const
+{
+    return d_window != bsls::TimeInterval() && now - entry.ackedAt > d_window;
+}
+
+} // namespace rmqa
+} // namespace BloombergLP
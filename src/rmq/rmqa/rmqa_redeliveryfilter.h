@@ -0,0 +1,114 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// rmqa_redeliveryfilter.h
+#ifndef INCLUDED_RMQA_REDELIVERYFILTER
+#define INCLUDED_RMQA_REDELIVERYFILTER
+
+#include <rmqt_envelope.h>
+#include <rmqt_message.h>
+
+#include <bslmt_mutex.h>
+#include <bsls_keyword.h>
+#include <bsls_timeinterval.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_functional.h>
+#include <bsl_list.h>
+#include <bsl_string.h>
+#include <bsl_unordered_map.h>
+
+//@PURPOSE: Recognise redeliveries of messages which were already processed
+//
+//@CLASSES:
+//  rmqa::RedeliveryFilter: Keys of the messages a consumer acked lately
+
+namespace BloombergLP {
+namespace rmqa {
+
+/// \brief Remembers the keys of the most recent messages a consumer acked,
+/// so that redeliveries of them (e.g. after a reconnect lost the acks) can be
+/// settled without running the callback again
+///
+/// At most `capacity` keys are kept, the least recently acked dropped first,
+/// and each for at most `window` (zero keeps them until dropped). Keys are
+/// compared exactly: a redelivery is only skipped if its key was acked, never
+/// on a hash collision.
+///
+/// Thread safe: keys are added from the threads acking messages, and looked
+/// up on the event loop thread.
+
+class RedeliveryFilter {
+  public:
+    /// Return the key of a message, or an empty string for a message which
+    /// has none (and is never skipped)
+    typedef bsl::function<bsl::string(const rmqt::Message&,
+                                      const rmqt::Envelope&)>
+        KeyFunc;
+
+    RedeliveryFilter(bsl::size_t capacity,
+                     const bsls::TimeInterval& window,
+                     const KeyFunc& key = KeyFunc());
+
+    /// Return the key of `message`: its message id, unless a `KeyFunc` was
+    /// given
+    bsl::string key(const rmqt::Message& message,
+                    const rmqt::Envelope& envelope) const;
+
+    /// Remember `key` as acked at `now`. Empty keys are ignored.
+    void insert(const bsl::string& key, const bsls::TimeInterval& now);
+
+    /// Return true if `key` was acked within the window before `now`, and
+    /// has not been dropped since
+    bool contains(const bsl::string& key, const bsls::TimeInterval& now);
+
+    /// Return false for a redelivered message whose key was acked, true
+    /// otherwise. Suits `rmqt::ConsumerConfig::PreFilterFunc`.
+    bool isUnprocessed(const rmqt::Message& message,
+                       const rmqt::Envelope& envelope);
+
+    /// Remember the key of `message` as acked now
+    void processed(const rmqt::Message& message,
+                   const rmqt::Envelope& envelope);
+
+    bsl::size_t size() const;
+
+  private:
+    RedeliveryFilter(const RedeliveryFilter&) BSLS_KEYWORD_DELETED;
+    RedeliveryFilter& operator=(const RedeliveryFilter&) BSLS_KEYWORD_DELETED;
+
+    struct Entry {
+        bsl::string key;
+        bsls::TimeInterval ackedAt;
+    };
+
+    /// Most recently acked first
+    typedef bsl::list<Entry> Entries;
+
+    bool expired(const Entry& entry, const bsls::TimeInterval& now) const;
+
+    const bsl::size_t d_capacity;
+    const bsls::TimeInterval d_window;
+    const KeyFunc d_key;
+
+    mutable bslmt::Mutex d_mutex;
+    Entries d_entries;
+    bsl::unordered_map<bsl::string, Entries::iterator> d_index;
+}; // class RedeliveryFilter
+
+} // namespace rmqa
+} // namespace BloombergLP
+
+#endif // ! INCLUDED_RMQA_REDELIVERYFILTER
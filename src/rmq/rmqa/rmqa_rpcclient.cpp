@@ -0,0 +1,48 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_rpcclient.h>
+
+namespace BloombergLP {
+namespace rmqa {
+
+RpcClient::RpcClient(bslma::ManagedPtr<rmqp::RpcClient>& impl)
+: d_impl(impl)
+{
+}
+
+RpcClient::~RpcClient() {}
+
+rmqt::Future<rmqt::Message>
+RpcClient::callAsync(const rmqt::Message& request,
+                     const bsl::string& routingKey)
+{
+    return d_impl->call(request, routingKey);
+}
+
+rmqt::Result<rmqt::Message>
+RpcClient::call(const rmqt::Message& request,
+                const bsl::string& routingKey,
+                const bsls::TimeInterval& timeout /* = bsls::TimeInterval() */)
+{
+    rmqt::Future<rmqt::Message> reply = d_impl->call(request, routingKey);
+    if (timeout == bsls::TimeInterval()) {
+        return reply.blockResult();
+    }
+    return reply.waitResult(timeout);
+}
+
+} // namespace rmqa
+} // namespace BloombergLP
@@ -0,0 +1,78 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// rmqa_rpcclient.h
+#ifndef INCLUDED_RMQA_RPCCLIENT
+#define INCLUDED_RMQA_RPCCLIENT
+
+#include <rmqp_rpcclient.h>
+#include <rmqt_future.h>
+#include <rmqt_message.h>
+#include <rmqt_result.h>
+
+#include <bsl_string.h>
+#include <bslma_managedptr.h>
+#include <bsls_keyword.h>
+#include <bsls_timeinterval.h>
+
+namespace BloombergLP {
+namespace rmqa {
+
+/// \class RpcClient
+/// \brief Provide a RabbitMQ request/response API over direct reply-to
+///
+/// Publishes requests to one exchange and returns a future for each reply.
+/// These objects are constructed by rmqa::VHost#createRpcClient
+class RpcClient {
+  public:
+    // CREATORS
+    /// Create an RpcClient that will operate through the supplied
+    /// implementation, taking ownership of it
+    explicit RpcClient(bslma::ManagedPtr<rmqp::RpcClient>& impl);
+
+    /// Pending calls fail with an error when the client is destroyed
+    ~RpcClient();
+
+    // MANIPULATORS
+    /// Send `request` with the given `routingKey` to the client's exchange.
+    /// The `replyTo` and `correlationId` properties of the request are
+    /// overwritten.
+    ///
+    /// \return A future resolved with the reply, or with an error if the
+    ///         request could not be sent or its reply was lost with the
+    ///         connection. Wait for it with a timeout: a server which never
+    ///         replies leaves it unresolved.
+    rmqt::Future<rmqt::Message> callAsync(const rmqt::Message& request,
+                                          const bsl::string& routingKey);
+
+    /// Send `request` as for `callAsync` and wait up to `timeout` for the
+    /// reply. A `timeout` of 0 waits indefinitely.
+    rmqt::Result<rmqt::Message>
+    call(const rmqt::Message& request,
+         const bsl::string& routingKey,
+         const bsls::TimeInterval& timeout = bsls::TimeInterval());
+
+  private:
+    RpcClient(const RpcClient&) BSLS_KEYWORD_DELETED;
+    RpcClient& operator=(const RpcClient&) BSLS_KEYWORD_DELETED;
+
+  private:
+    bslma::ManagedPtr<rmqp::RpcClient> d_impl;
+};
+
+} // namespace rmqa
+} // namespace BloombergLP
+
+#endif // ! INCLUDED_RMQA_RPCCLIENT
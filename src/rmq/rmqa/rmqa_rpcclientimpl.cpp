@@ -0,0 +1,214 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_rpcclientimpl.h>
+
+#include <rmqio_eventloop.h>
+#include <rmqt_consumerconfig.h>
+#include <rmqt_log.h>
+
+#include <bdlf_bind.h>
+#include <bdlf_placeholder.h>
+
+#include <bsl_cstdlib.h>
+#include <bsl_sstream.h>
+
+namespace BloombergLP {
+namespace rmqa {
+namespace {
+
+BALL_LOG_SET_NAMESPACE_CATEGORY("RMQA.RPCCLIENTIMPL")
+
+/// Parse the correlation id of a reply into `id`, returning false if it is
+/// not one of ours
+bool parseCorrelationId(const rmqt::Message& reply, bsls::Types::Uint64* id)
+{
+    if (reply.properties().correlationId.isNull()) {
+        return false;
+    }
+    const bsl::string& value = reply.properties().correlationId.value();
+    if (value.empty()) {
+        return false;
+    }
+
+    char* end = 0;
+    *id       = bsl::strtoull(value.c_str(), &end, 10);
+    return *end == '\0';
+}
+
+} // namespace
+
+const char* const RpcClientImpl::k_REPLY_TO_QUEUE = "amq.rabbitmq.reply-to";
+
+RpcClientImpl::RpcClientImpl(
+    const bsl::shared_ptr<rmqamqp::ReceiveChannel>& channel,
+    const bsl::string& exchange,
+    rmqio::EventLoop& eventLoop)
+: d_channel(channel)
+, d_exchange(exchange)
+, d_eventLoop(eventLoop)
+, d_replyQueue(bsl::make_shared<rmqt::Queue>(k_REPLY_TO_QUEUE))
+, d_pending()
+, d_pendingLifetime(channel->lifetimeId())
+, d_nextCorrelationId(0)
+{
+}
+
+rmqt::Result<> RpcClientImpl::start()
+{
+    return d_channel->consume(
+        d_replyQueue,
+        bdlf::BindUtil::bind(&RpcClientImpl::onReply,
+                             weak_from_this(),
+                             bdlf::PlaceHolders::_1,
+                             bdlf::PlaceHolders::_2),
+        rmqt::ConsumerConfig::generateConsumerTag());
+}
+
+rmqt::Future<rmqt::Message>
+RpcClientImpl::call(const rmqt::Message& request, const bsl::string& routingKey)
+{
+    const bsls::Types::Uint64 id = ++d_nextCorrelationId;
+
+    rmqt::Future<rmqt::Message>::Pair reply =
+        rmqt::Future<rmqt::Message>::make(bdlf::BindUtil::bind(
+            &RpcClientImpl::abandonCall, weak_from_this(), id));
+
+    d_eventLoop.post(bdlf::BindUtil::bind(&RpcClientImpl::sendCall,
+                                          weak_from_this(),
+                                          id,
+                                          request,
+                                          routingKey,
+                                          reply.first));
+
+    return reply.second;
+}
+
+RpcClientImpl::~RpcClientImpl()
+{
+    failPending("RpcClient destroyed before the reply arrived");
+
+    d_eventLoop.post(
+        bdlf::BindUtil::bind(&rmqamqp::Channel::gracefulClose, d_channel));
+}
+
+void RpcClientImpl::sendCall(
+    const bsl::weak_ptr<RpcClientImpl>& weakSelf,
+    bsls::Types::Uint64 id,
+    const rmqt::Message& request,
+    const bsl::string& routingKey,
+    const rmqt::Future<rmqt::Message>::Maker& onReply)
+{
+    bsl::shared_ptr<RpcClientImpl> self = weakSelf.lock();
+    if (!self) {
+        onReply(rmqt::Result<rmqt::Message>(
+            "RpcClient destroyed before the request was sent"));
+        return;
+    }
+
+    self->failStaleCalls();
+
+    bsl::ostringstream correlationId;
+    correlationId << id;
+
+    rmqt::Message message(request);
+    message.properties().correlationId = correlationId.str();
+    message.properties().replyTo       = bsl::string(k_REPLY_TO_QUEUE);
+
+    self->d_pending.insert(bsl::make_pair(id, onReply));
+
+    const rmqt::Result<> sent =
+        self->d_channel->publish(message, self->d_exchange, routingKey);
+    if (!sent) {
+        self->d_pending.erase(id);
+        onReply(rmqt::Result<rmqt::Message>(sent.error(), sent.returnCode()));
+    }
+}
+
+void RpcClientImpl::onReply(const bsl::weak_ptr<RpcClientImpl>& weakSelf,
+                            const rmqt::Message& reply,
+                            const rmqt::Envelope&)
+{
+    bsl::shared_ptr<RpcClientImpl> self = weakSelf.lock();
+    if (!self) {
+        return;
+    }
+
+    self->failStaleCalls();
+
+    bsls::Types::Uint64 id = 0;
+    PendingCalls::iterator it = self->d_pending.end();
+    if (parseCorrelationId(reply, &id)) {
+        it = self->d_pending.find(id);
+    }
+    if (it == self->d_pending.end()) {
+        BALL_LOG_WARN << "Dropping a reply matching no pending call";
+        return;
+    }
+
+    const rmqt::Future<rmqt::Message>::Maker onCallReply = it->second;
+    self->d_pending.erase(it);
+
+    onCallReply(rmqt::Result<rmqt::Message>(
+        bsl::make_shared<rmqt::Message>(reply)));
+}
+
+void RpcClientImpl::abandonCall(const bsl::weak_ptr<RpcClientImpl>& weakSelf,
+                                bsls::Types::Uint64 id)
+{
+    bsl::shared_ptr<RpcClientImpl> self = weakSelf.lock();
+    if (self) {
+        self->d_eventLoop.post(
+            bdlf::BindUtil::bind(&RpcClientImpl::forgetCall, weakSelf, id));
+    }
+}
+
+void RpcClientImpl::forgetCall(const bsl::weak_ptr<RpcClientImpl>& weakSelf,
+                               bsls::Types::Uint64 id)
+{
+    bsl::shared_ptr<RpcClientImpl> self = weakSelf.lock();
+    if (self) {
+        self->d_pending.erase(id);
+    }
+}
+
+void RpcClientImpl::failPending(const bsl::string& error)
+{
+    PendingCalls pending;
+    pending.swap(d_pending);
+
+    for (PendingCalls::iterator it = pending.begin(); it != pending.end();
+         ++it) {
+        it->second(rmqt::Result<rmqt::Message>(error));
+    }
+}
+
+void RpcClientImpl::failStaleCalls()
+{
+    const bsl::size_t lifetime = d_channel->lifetimeId();
+    if (lifetime == d_pendingLifetime) {
+        return;
+    }
+    d_pendingLifetime = lifetime;
+
+    if (!d_pending.empty()) {
+        BALL_LOG_WARN << "Failing " << d_pending.size()
+                      << " RPC calls whose replies were lost with the channel";
+        failPending("Channel reset before the reply arrived");
+    }
+}
+
+} // namespace rmqa
+} // namespace BloombergLP
@@ -0,0 +1,126 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// rmqa_rpcclientimpl.h
+#ifndef INCLUDED_RMQA_RPCCLIENTIMPL
+#define INCLUDED_RMQA_RPCCLIENTIMPL
+
+#include <rmqamqp_receivechannel.h>
+#include <rmqp_rpcclient.h>
+#include <rmqt_envelope.h>
+#include <rmqt_future.h>
+#include <rmqt_message.h>
+#include <rmqt_queue.h>
+#include <rmqt_result.h>
+
+#include <bsls_atomic.h>
+#include <bsls_keyword.h>
+#include <bsls_types.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_memory.h>
+#include <bsl_string.h>
+#include <bsl_unordered_map.h>
+
+//@PURPOSE: Make RPC calls over RabbitMQ direct reply-to
+//
+//@CLASSES:
+//  rmqa::RpcClientImpl: an `rmqp::RpcClient` on one receive channel
+
+namespace BloombergLP {
+namespace rmqio {
+class EventLoop;
+}
+namespace rmqa {
+
+/// \brief Publishes requests and consumes their replies on one channel
+///
+/// The channel consumes `amq.rabbitmq.reply-to` without acks, and requests
+/// are published on the same channel, as direct reply-to requires. Each
+/// request gets the next number of a counter as its correlation id, which
+/// keys the pending call in a map touched only on the event loop thread.
+/// Calls pending when the channel resets are failed: their replies went to
+/// the old channel. A call whose future is dropped, e.g. after timing out,
+/// is forgotten so that a reply which never comes does not leak its entry.
+
+class RpcClientImpl : public rmqp::RpcClient,
+                      public bsl::enable_shared_from_this<RpcClientImpl> {
+  public:
+    /// The pseudo-queue a client consumes its replies from
+    static const char* const k_REPLY_TO_QUEUE;
+
+    RpcClientImpl(const bsl::shared_ptr<rmqamqp::ReceiveChannel>& channel,
+                  const bsl::string& exchange,
+                  rmqio::EventLoop& eventLoop);
+
+    /// Start consuming replies. Must be called on the event loop thread
+    /// before the first `call`.
+    rmqt::Result<> start();
+
+    rmqt::Future<rmqt::Message>
+    call(const rmqt::Message& request,
+         const bsl::string& routingKey) BSLS_KEYWORD_OVERRIDE;
+
+    /// Fail the pending calls and gracefully close the channel
+    ~RpcClientImpl() BSLS_KEYWORD_OVERRIDE;
+
+  private:
+    RpcClientImpl(const RpcClientImpl&) BSLS_KEYWORD_DELETED;
+    RpcClientImpl& operator=(const RpcClientImpl&) BSLS_KEYWORD_DELETED;
+
+    typedef bsl::unordered_map<bsls::Types::Uint64,
+                               rmqt::Future<rmqt::Message>::Maker>
+        PendingCalls;
+
+    static void sendCall(const bsl::weak_ptr<RpcClientImpl>& weakSelf,
+                         bsls::Types::Uint64 id,
+                         const rmqt::Message& request,
+                         const bsl::string& routingKey,
+                         const rmqt::Future<rmqt::Message>::Maker& onReply);
+
+    static void onReply(const bsl::weak_ptr<RpcClientImpl>& weakSelf,
+                        const rmqt::Message& reply,
+                        const rmqt::Envelope& envelope);
+
+    /// Forget the call `id` once its future is dropped. May be called on
+    /// any thread.
+    static void abandonCall(const bsl::weak_ptr<RpcClientImpl>& weakSelf,
+                            bsls::Types::Uint64 id);
+
+    static void forgetCall(const bsl::weak_ptr<RpcClientImpl>& weakSelf,
+                           bsls::Types::Uint64 id);
+
+    /// Fail every pending call with `error`
+    void failPending(const bsl::string& error);
+
+    /// Fail the pending calls if the channel has reset since they were sent
+    void failStaleCalls();
+
+    bsl::shared_ptr<rmqamqp::ReceiveChannel> d_channel;
+    bsl::string d_exchange;
+    rmqio::EventLoop& d_eventLoop;
+    bsl::shared_ptr<rmqt::Queue> d_replyQueue;
+
+    // Accessed only on the event loop thread
+    PendingCalls d_pending;
+    bsl::size_t d_pendingLifetime;
+
+    bsls::AtomicUint64 d_nextCorrelationId;
+};
+
+} // namespace rmqa
+} // namespace BloombergLP
+
+#endif // ! INCLUDED_RMQA_RPCCLIENTIMPL
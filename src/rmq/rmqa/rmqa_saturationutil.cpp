@@ -0,0 +1,76 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_saturationutil.h>
+
+#include <bdlf_bind.h>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+namespace BloombergLP {
+namespace rmqa {
+namespace {
+
+bool hasBacklog(bdlmt::ThreadPool* threadPool, int pendingJobs)
+{
+    return threadPool->numPendingJobs() >= pendingJobs;
+}
+
+bool hasCpuLoad(double loadPerCpu)
+{
+    double load[1];
+    const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (getloadavg(load, 1) != 1 || cpus <= 0) {
+        return false;
+    }
+    return load[0] / static_cast<double>(cpus) >= loadPerCpu;
+}
+
+bool anyOfImpl(const bsl::vector<SaturationUtil::SaturationFunc>& probes)
+{
+    for (bsl::vector<SaturationUtil::SaturationFunc>::const_iterator it =
+             probes.begin();
+         it != probes.end();
+         ++it) {
+        if (*it && (*it)()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+SaturationUtil::SaturationFunc
+SaturationUtil::threadPoolBacklog(bdlmt::ThreadPool* threadPool,
+                                  int pendingJobs)
+{
+    return bdlf::BindUtil::bind(&hasBacklog, threadPool, pendingJobs);
+}
+
+SaturationUtil::SaturationFunc SaturationUtil::cpuLoad(double loadPerCpu)
+{
+    return bdlf::BindUtil::bind(&hasCpuLoad, loadPerCpu);
+}
+
+SaturationUtil::SaturationFunc
+SaturationUtil::anyOf(const bsl::vector<SaturationFunc>& probes)
+{
+    return bdlf::BindUtil::bind(&anyOfImpl, probes);
+}
+
+} // namespace rmqa
+} // namespace BloombergLP
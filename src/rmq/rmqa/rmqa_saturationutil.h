@@ -0,0 +1,60 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQA_SATURATIONUTIL
+#define INCLUDED_RMQA_SATURATIONUTIL
+
+#include <rmqt_consumerconfig.h>
+
+#include <bdlmt_threadpool.h>
+
+#include <bsl_vector.h>
+
+//@PURPOSE: Probes of local load, for consumers to shed messages to peers
+//
+//@CLASSES:
+//  rmqa::SaturationUtil: makes `rmqt::ConsumerConfig::SaturationFunc`s
+
+namespace BloombergLP {
+namespace rmqa {
+
+/// \brief Makes probes for `rmqt::ConsumerConfig::setSaturationProbe`,
+/// which report the process saturated so that its consumers' prefetch
+/// counts drop, and the broker routes messages to less loaded consumers
+///
+/// Each probe is cheap enough to run on the event loop thread.
+
+struct SaturationUtil {
+    typedef rmqt::ConsumerConfig::SaturationFunc SaturationFunc;
+
+    /// Return a probe which is saturated while `threadPool` has at least
+    /// `pendingJobs` jobs waiting for a thread. `threadPool` must outlive
+    /// the consumers given the probe.
+    static SaturationFunc threadPoolBacklog(bdlmt::ThreadPool* threadPool,
+                                            int pendingJobs);
+
+    /// Return a probe which is saturated while the one minute load average
+    /// of the host, divided by its number of online CPUs, is at least
+    /// `loadPerCpu`. Never saturated where the load average is unknown.
+    static SaturationFunc cpuLoad(double loadPerCpu);
+
+    /// Return a probe which is saturated while any of `probes` is
+    static SaturationFunc anyOf(const bsl::vector<SaturationFunc>& probes);
+};
+
+} // namespace rmqa
+} // namespace BloombergLP
+
+#endif
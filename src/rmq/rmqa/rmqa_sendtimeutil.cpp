@@ -0,0 +1,74 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_sendtimeutil.h>
+
+#include <rmqt_fieldvalue.h>
+#include <rmqt_properties.h>
+
+#include <bdlt_datetimeinterval.h>
+#include <bdlt_epochutil.h>
+
+#include <bsl_cstdint.h>
+#include <bsl_memory.h>
+
+namespace BloombergLP {
+namespace rmqa {
+
+const char* SendTimeUtil::sendTimeHeader() { return "rmqSentAt"; }
+
+void SendTimeUtil::stamp(rmqt::Message* message, const bdlt::Datetime& now)
+{
+    const bsl::shared_ptr<rmqt::FieldTable> current =
+        message->decodedHeaders();
+    bsl::shared_ptr<rmqt::FieldTable> headers =
+        current ? bsl::make_shared<rmqt::FieldTable>(*current)
+                : bsl::make_shared<rmqt::FieldTable>();
+    (*headers)[sendTimeHeader()] = rmqt::FieldValue(static_cast<int64_t>(
+        (now - bdlt::EpochUtil::epoch()).totalMicroseconds()));
+
+    rmqt::Properties& properties = message->properties();
+    properties.headers           = headers;
+    message->setHeadersView(bsl::shared_ptr<const rmqt::FieldTableView>());
+    if (properties.timestamp.isNull()) {
+        properties.timestamp = now;
+    }
+}
+
+bool SendTimeUtil::elapsed(double* seconds,
+                           const rmqt::Message& message,
+                           const bdlt::Datetime& now)
+{
+    bdlt::Datetime sent;
+    rmqt::FieldValue value;
+    if (message.findHeader(&value, sendTimeHeader()) &&
+        value.is<int64_t>()) {
+        sent = bdlt::EpochUtil::epoch();
+        sent.addMicroseconds(value.the<int64_t>());
+    }
+    else if (!message.properties().timestamp.isNull()) {
+        sent = message.properties().timestamp.value();
+    }
+    else {
+        return false;
+    }
+
+    const double latency = (now - sent).totalSecondsAsDouble();
+    *seconds             = latency > 0 ? latency : 0;
+    return true;
+}
+
+} // namespace rmqa
+} // namespace BloombergLP
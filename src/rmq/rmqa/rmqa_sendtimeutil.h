@@ -0,0 +1,60 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQA_SENDTIMEUTIL
+#define INCLUDED_RMQA_SENDTIMEUTIL
+
+#include <rmqt_message.h>
+
+#include <bdlt_datetime.h>
+
+//@PURPOSE: Stamp messages with their send time, to measure delivery latency
+//
+//@CLASSES:
+//  rmqa::SendTimeUtil: records and reads back message send times
+
+namespace BloombergLP {
+namespace rmqa {
+
+/// \brief Producers stamp each message with the time it was sent, and
+/// consumers read it back as it is delivered, for the
+/// `publish_to_deliver_latency` metric
+///
+/// The send time goes in the `sendTimeHeader()` header, as microseconds
+/// since the epoch, and in the `timestamp` property if it is not already
+/// set. Messages from other publishers only have a `timestamp`, which AMQP
+/// carries in whole seconds, so their latency is that coarse.
+
+struct SendTimeUtil {
+    /// The header holding a message's send time
+    static const char* sendTimeHeader();
+
+    /// Record `now` as the send time of `message`. Its headers are copied,
+    /// rather than modified in place, as they may be shared with the
+    /// caller's copy of the message.
+    static void stamp(rmqt::Message* message, const bdlt::Datetime& now);
+
+    /// Load into `seconds` how long before `now` `message` was sent,
+    /// clamped to zero when clocks disagree. Return false, leaving
+    /// `seconds` untouched, if the send time of `message` is unknown.
+    static bool elapsed(double* seconds,
+                        const rmqt::Message& message,
+                        const bdlt::Datetime& now);
+};
+
+} // namespace rmqa
+} // namespace BloombergLP
+
+#endif
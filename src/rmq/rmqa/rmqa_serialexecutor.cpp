@@ -0,0 +1,120 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_serialexecutor.h>
+
+#include <bdlf_bind.h>
+#include <bslmt_lockguard.h>
+
+namespace BloombergLP {
+namespace rmqa {
+
+SerialExecutor::SerialExecutor(bdlmt::ThreadPool& threadPool,
+                               bsl::size_t capacity)
+: d_threadPool(threadPool)
+, d_queue(capacity)
+, d_drainScheduled(false)
+, d_overflowMutex()
+, d_overflow()
+, d_overflowCount(0)
+{
+}
+
+int SerialExecutor::submit(const Job& job)
+{
+    // Once anything has overflowed, later jobs must queue behind it
+    if (d_overflowCount.load() != 0 || !d_queue.tryPush(job)) {
+        bslmt::LockGuard<bslmt::Mutex> guard(&d_overflowMutex);
+        d_overflow.push_back(job);
+        d_overflowCount.add(1);
+    }
+
+    return scheduleDrain();
+}
+
+int SerialExecutor::scheduleDrain()
+{
+    if (d_drainScheduled.testAndSwap(false, true)) {
+        // A drain is scheduled or running, and will find the job
+        return 0;
+    }
+
+    const int rc = d_threadPool.enqueueJob(
+        bdlf::BindUtil::bind(&SerialExecutor::drain, shared_from_this()));
+    if (rc != 0) {
+        d_drainScheduled.store(false);
+    }
+    return rc;
+}
+
+void SerialExecutor::drain(const bsl::shared_ptr<SerialExecutor>& executor)
+{
+    for (;;) {
+        if (executor->runQueued()) {
+            // Give other pool jobs a turn, this drain stays scheduled
+            if (executor->d_threadPool.enqueueJob(bdlf::BindUtil::bind(
+                    &SerialExecutor::drain, executor)) == 0) {
+                return;
+            }
+            continue;
+        }
+
+        // Cleared before checking for more, so a job submitted after the
+        // check schedules another drain
+        executor->d_drainScheduled.store(false);
+        if (!executor->hasQueued() ||
+            executor->d_drainScheduled.testAndSwap(false, true)) {
+            return;
+        }
+    }
+}
+
+bool SerialExecutor::runQueued()
+{
+    Job job;
+    bsl::size_t ran = 0;
+    while (d_queue.tryPop(&job)) {
+        job();
+        job = Job();
+        if (++ran == d_queue.capacity()) {
+            return true;
+        }
+    }
+
+    // Overflowed jobs were submitted after everything popped above
+    if (d_overflowCount.load() != 0) {
+        bsl::deque<Job> overflow;
+        {
+            bslmt::LockGuard<bslmt::Mutex> guard(&d_overflowMutex);
+            overflow.swap(d_overflow);
+            d_overflowCount.store(0);
+        }
+        for (bsl::deque<Job>::iterator it = overflow.begin();
+             it != overflow.end();
+             ++it) {
+            (*it)();
+        }
+    }
+
+    return false;
+}
+
+bool SerialExecutor::hasQueued() const
+{
+    return !d_queue.empty() || d_overflowCount.load() != 0;
+}
+
+} // namespace rmqa
+} // namespace BloombergLP
@@ -0,0 +1,94 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQA_SERIALEXECUTOR
+#define INCLUDED_RMQA_SERIALEXECUTOR
+
+#include <rmqio_mpscqueue.h>
+
+#include <bdlmt_threadpool.h>
+#include <bslmt_mutex.h>
+#include <bsls_atomic.h>
+#include <bsls_keyword.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_deque.h>
+#include <bsl_functional.h>
+#include <bsl_memory.h>
+
+//@PURPOSE: Run jobs on a threadpool one at a time, in submission order
+//
+//@CLASSES:
+//  rmqa::SerialExecutor: ordered job queue drained by one threadpool worker
+
+namespace BloombergLP {
+namespace rmqa {
+
+/// \brief Runs jobs on a `bdlmt::ThreadPool` one at a time, in order
+///
+/// Jobs are pushed onto a lock-free ring. A single drain job on the
+/// threadpool runs them, so at most one pool thread works through the queue
+/// at a time and jobs from one submitting thread run in the order submitted.
+/// While a drain is scheduled, submitting costs one atomic exchange on the
+/// ring rather than the pool's mutex and condition variable.
+///
+/// When the ring is full, jobs go to a mutex-protected overflow queue, which
+/// keeps the ordering and is emptied once the ring has been drained. Each
+/// drain runs at most one lap of the ring before re-enqueueing itself, so a
+/// busy executor does not monopolise a pool thread.
+
+class SerialExecutor : public bsl::enable_shared_from_this<SerialExecutor> {
+  public:
+    typedef bsl::function<void()> Job;
+
+    /// \param threadPool Runs the drain jobs. Must outlive any job
+    ///        submitted, including those still queued when the executor is
+    ///        released.
+    /// \param capacity Size of the lock-free ring, a power of two
+    SerialExecutor(bdlmt::ThreadPool& threadPool, bsl::size_t capacity);
+
+    /// Queue `job`, scheduling a drain if none is scheduled. May be called
+    /// from any thread. Return 0 on success or the non-zero result of
+    /// `bdlmt::ThreadPool::enqueueJob`, in which case `job` stays queued
+    /// until the next successful submit.
+    int submit(const Job& job);
+
+  private:
+    SerialExecutor(const SerialExecutor&) BSLS_KEYWORD_DELETED;
+    SerialExecutor& operator=(const SerialExecutor&) BSLS_KEYWORD_DELETED;
+
+    int scheduleDrain();
+
+    static void drain(const bsl::shared_ptr<SerialExecutor>& executor);
+
+    /// Run queued jobs. Return true if it stopped after a full lap of the
+    /// ring with more jobs possibly waiting.
+    bool runQueued();
+
+    bool hasQueued() const;
+
+    bdlmt::ThreadPool& d_threadPool;
+    rmqio::MpscQueue<Job> d_queue;
+    bsls::AtomicBool d_drainScheduled;
+
+    bslmt::Mutex d_overflowMutex;
+    bsl::deque<Job> d_overflow;
+    bsls::AtomicInt d_overflowCount;
+}; // class SerialExecutor
+
+} // namespace rmqa
+} // namespace BloombergLP
+
+#endif
@@ -0,0 +1,85 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_shardedconsumer.h>
+
+#include <bdlf_bind.h>
+#include <bsls_assert.h>
+
+#include <bsl_functional.h>
+
+namespace BloombergLP {
+namespace rmqa {
+
+ShardedConsumer::ShardedConsumer(
+    const bsl::vector<bsl::shared_ptr<rmqp::Consumer> >& shards)
+: d_shards(shards)
+{
+    BSLS_ASSERT(!d_shards.empty());
+}
+
+ShardedConsumer::~ShardedConsumer() {}
+
+rmqt::Future<> ShardedConsumer::cancel()
+{
+    bsl::vector<rmqt::Future<> > cancels;
+    for (bsl::size_t i = 0; i < d_shards.size(); ++i) {
+        cancels.push_back(d_shards[i]->cancel());
+    }
+    return rmqt::FutureUtil::whenAll(cancels);
+}
+
+rmqt::Future<> ShardedConsumer::drain()
+{
+    bsl::vector<rmqt::Future<> > drains;
+    for (bsl::size_t i = 0; i < d_shards.size(); ++i) {
+        drains.push_back(d_shards[i]->drain());
+    }
+    return rmqt::FutureUtil::whenAll(drains);
+}
+
+rmqt::Result<>
+ShardedConsumer::cancelAndDrain(const bsls::TimeInterval& timeout)
+{
+    // Stop every shard's deliveries before waiting for any of them to drain
+    bsl::function<rmqt::Future<>()> fn =
+        bdlf::BindUtil::bind(&rmqp::Consumer::drain, this);
+    rmqt::Future<> done =
+        cancel().thenFuture<void>(rmqt::FutureUtil::propagateError<void>(fn));
+    return timeout == bsls::TimeInterval(0) ? done.blockResult()
+                                            : done.waitResult(timeout);
+}
+
+rmqt::Future<>
+ShardedConsumer::updateTopologyAsync(const rmqt::TopologyUpdate& topologyUpdate)
+{
+    bsl::vector<rmqt::Future<> > updates;
+    for (bsl::size_t i = 0; i < d_shards.size(); ++i) {
+        updates.push_back(d_shards[i]->updateTopologyAsync(topologyUpdate));
+    }
+    return rmqt::FutureUtil::whenAll(updates);
+}
+
+rmqt::Future<> ShardedConsumer::nackAllOutstanding(bool requeue)
+{
+    bsl::vector<rmqt::Future<> > nacks;
+    for (bsl::size_t i = 0; i < d_shards.size(); ++i) {
+        nacks.push_back(d_shards[i]->nackAllOutstanding(requeue));
+    }
+    return rmqt::FutureUtil::whenAll(nacks);
+}
+
+} // namespace rmqa
+} // namespace BloombergLP
@@ -0,0 +1,82 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQA_SHARDEDCONSUMER
+#define INCLUDED_RMQA_SHARDEDCONSUMER
+
+#include <rmqp_consumer.h>
+#include <rmqt_future.h>
+#include <rmqt_result.h>
+#include <rmqt_topologyupdate.h>
+
+#include <bsls_keyword.h>
+#include <bsls_timeinterval.h>
+
+#include <bsl_memory.h>
+#include <bsl_vector.h>
+
+//@PURPOSE: Consume from one queue through several consumers
+//
+//@CLASSES:
+//  rmqa::ShardedConsumer: an rmqp::Consumer consuming through shards
+
+namespace BloombergLP {
+namespace rmqa {
+
+/// \brief An rmqp::Consumer which consumes through several consumers
+///
+/// Each shard is a consumer of the same queue on its own channel, all
+/// invoking the same callback, so that delivery, decoding and acks are no
+/// longer limited to a single channel. The broker spreads the queue's
+/// messages across the shards, so messages are not processed in queue
+/// order. Cancelling, draining and topology updates apply to every shard.
+
+class ShardedConsumer : public rmqp::Consumer {
+  public:
+    // CREATORS
+    /// Consume through `shards`. The behavior is undefined unless `shards`
+    /// is not empty.
+    explicit ShardedConsumer(
+        const bsl::vector<bsl::shared_ptr<rmqp::Consumer> >& shards);
+
+    ~ShardedConsumer() BSLS_KEYWORD_OVERRIDE;
+
+    /// Resolves once every shard is cancelled
+    rmqt::Future<> cancel() BSLS_KEYWORD_OVERRIDE;
+
+    /// Resolves once every shard is drained
+    rmqt::Future<> drain() BSLS_KEYWORD_OVERRIDE;
+
+    rmqt::Result<>
+    cancelAndDrain(const bsls::TimeInterval& timeout) BSLS_KEYWORD_OVERRIDE;
+
+    rmqt::Future<> updateTopologyAsync(
+        const rmqt::TopologyUpdate& topologyUpdate) BSLS_KEYWORD_OVERRIDE;
+
+    /// Resolves once every shard has queued its nack
+    rmqt::Future<> nackAllOutstanding(bool requeue) BSLS_KEYWORD_OVERRIDE;
+
+  private:
+    ShardedConsumer(const ShardedConsumer&) BSLS_KEYWORD_DELETED;
+    ShardedConsumer& operator=(const ShardedConsumer&) BSLS_KEYWORD_DELETED;
+
+    bsl::vector<bsl::shared_ptr<rmqp::Consumer> > d_shards;
+
+}; // class ShardedConsumer
+
+} // namespace rmqa
+} // namespace BloombergLP
+
+#endif
@@ -0,0 +1,381 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_shardedproducer.h>
+
+#include <rmqa_partitionutil.h>
+
+#include <rmqt_log.h>
+
+#include <ball_log.h>
+#include <bdlf_bind.h>
+#include <bdlf_placeholder.h>
+#include <bslmt_lockguard.h>
+#include <bsls_assert.h>
+#include <bsls_systemtime.h>
+
+#include <bsl_algorithm.h>
+#include <bsl_functional.h>
+
+namespace BloombergLP {
+namespace rmqa {
+namespace {
+
+BALL_LOG_SET_NAMESPACE_CATEGORY("RMQA.SHARDEDPRODUCER")
+
+bsl::size_t creditsLeft(const ShardedProducer::Budget& budget)
+{
+    const int value = budget.credits.getValue();
+    return value > 0 ? static_cast<bsl::size_t>(value) : 0;
+}
+
+/// Return the writable callback if trySend is waiting for credit and enough
+/// is now available, clearing the wait. Otherwise return an empty callback.
+/// Must be called with the mutex held
+rmqp::Producer::WritableCallback
+takeWritableCallback(ShardedProducer::Budget& budget)
+{
+    if (!budget.writablePending || !budget.writableCallback ||
+        creditsLeft(budget) < budget.writableThreshold) {
+        return rmqp::Producer::WritableCallback();
+    }
+
+    budget.writablePending = false;
+    return budget.writableCallback;
+}
+
+void confirmThroughShard(
+    const bsl::shared_ptr<ShardedProducer::Budget>& budget,
+    const rmqp::Producer::ConfirmationCallback& confirmCallback,
+    const bsl::string& routingKey,
+    const rmqt::Message& message,
+    const bsl::string&,
+    const rmqt::ConfirmResponse& confirmResponse)
+{
+    budget->credits.post();
+
+    confirmCallback(message, routingKey, confirmResponse);
+
+    rmqp::Producer::WritableCallback writableCallback;
+    {
+        bslmt::LockGuard<bslmt::Mutex> guard(&budget->mutex);
+        writableCallback = takeWritableCallback(*budget);
+    }
+
+    // Confirms are delivered on the thread pool, where the writable
+    // callback is documented to run
+    if (writableCallback) {
+        writableCallback();
+    }
+}
+
+} // namespace
+
+ShardedProducer::ShardedProducer(
+    const bsl::vector<bsl::shared_ptr<rmqp::Producer> >& shards,
+    uint16_t maxOutstandingConfirms,
+    bool orderByRoutingKey)
+: d_shards(shards)
+, d_partitionRoutingKeys()
+, d_orderByRoutingKey(orderByRoutingKey)
+, d_nextShard(0)
+, d_budget(bsl::make_shared<Budget>(maxOutstandingConfirms))
+{
+    BSLS_ASSERT(!d_shards.empty());
+}
+
+ShardedProducer::ShardedProducer(
+    const bsl::vector<bsl::shared_ptr<rmqp::Producer> >& shards,
+    uint16_t maxOutstandingConfirms,
+    const bsl::vector<bsl::string>& partitionRoutingKeys)
+: d_shards(shards)
+, d_partitionRoutingKeys(partitionRoutingKeys)
+, d_orderByRoutingKey(true)
+, d_nextShard(0)
+, d_budget(bsl::make_shared<Budget>(maxOutstandingConfirms))
+{
+    BSLS_ASSERT(!d_shards.empty());
+    BSLS_ASSERT(d_shards.size() == d_partitionRoutingKeys.size());
+}
+
+ShardedProducer::~ShardedProducer() {}
+
+bsl::size_t ShardedProducer::shardFor(const bsl::string& routingKey)
+{
+    if (!d_partitionRoutingKeys.empty()) {
+        return PartitionUtil::partitionOf(routingKey, d_shards.size());
+    }
+
+    bsl::size_t shard;
+    if (d_orderByRoutingKey) {
+        shard = bsl::hash<bsl::string>()(routingKey);
+    }
+    else {
+        shard = d_nextShard++;
+    }
+    return shard % d_shards.size();
+}
+
+const bsl::string&
+ShardedProducer::publishKey(bsl::size_t shard,
+                            const bsl::string& routingKey) const
+{
+    return d_partitionRoutingKeys.empty() ? routingKey
+                                          : d_partitionRoutingKeys[shard];
+}
+
+rmqp::Producer::ConfirmationCallback ShardedProducer::wrap(
+    const rmqp::Producer::ConfirmationCallback& confirmCallback,
+    const bsl::string& routingKey) const
+{
+    using namespace bdlf::PlaceHolders;
+    return bdlf::BindUtil::bind(&confirmThroughShard,
+                                d_budget,
+                                confirmCallback,
+                                routingKey,
+                                _1,
+                                _2,
+                                _3);
+}
+
+rmqp::Producer::SendStatus
+ShardedProducer::reserve(bsl::size_t count, const bsls::TimeInterval& timeout)
+{
+    bslmt::TimedSemaphore& credits   = d_budget->credits;
+    bslmt::TimedSemaphore& batchLock = d_budget->batchReserveLock;
+    const bool hasTimeout            = timeout.totalNanoseconds() != 0;
+    const bsls::TimeInterval deadline =
+        bsls::SystemTime::nowRealtimeClock() + timeout;
+
+    if (hasTimeout) {
+        if (batchLock.timedWait(deadline)) {
+            return rmqp::Producer::TIMEOUT;
+        }
+    }
+    else {
+        batchLock.wait();
+    }
+
+    bsl::size_t acquired = 0;
+    for (; acquired < count; ++acquired) {
+        if (hasTimeout) {
+            if (credits.timedWait(deadline)) {
+                break;
+            }
+        }
+        else {
+            credits.wait();
+        }
+    }
+
+    batchLock.post();
+
+    if (acquired < count) {
+        release(acquired);
+        return rmqp::Producer::TIMEOUT;
+    }
+
+    return rmqp::Producer::SENDING;
+}
+
+void ShardedProducer::release(bsl::size_t count)
+{
+    if (count) {
+        d_budget->credits.post(static_cast<int>(count));
+    }
+}
+
+rmqp::Producer::SendStatus ShardedProducer::send(
+    const rmqt::Message& message,
+    const bsl::string& routingKey,
+    const rmqp::Producer::ConfirmationCallback& confirmCallback,
+    const bsls::TimeInterval& timeout)
+{
+    return send(message,
+                routingKey,
+                rmqt::Mandatory::RETURN_UNROUTABLE,
+                confirmCallback,
+                timeout);
+}
+
+rmqp::Producer::SendStatus ShardedProducer::send(
+    const rmqt::Message& message,
+    const bsl::string& routingKey,
+    rmqt::Mandatory::Value mandatoryFlag,
+    const rmqp::Producer::ConfirmationCallback& confirmCallback,
+    const bsls::TimeInterval& timeout)
+{
+    const rmqp::Producer::SendStatus reserved = reserve(1, timeout);
+    if (reserved != rmqp::Producer::SENDING) {
+        return reserved;
+    }
+
+    const bsl::size_t shard = shardFor(routingKey);
+    const rmqp::Producer::SendStatus status =
+        d_shards[shard]->send(message,
+                              publishKey(shard, routingKey),
+                              mandatoryFlag,
+                              wrap(confirmCallback, routingKey),
+                              timeout);
+    if (status != rmqp::Producer::SENDING) {
+        release(1);
+    }
+    return status;
+}
+
+rmqp::Producer::SendStatus ShardedProducer::trySend(
+    const rmqt::Message& message,
+    const bsl::string& routingKey,
+    const rmqp::Producer::ConfirmationCallback& confirmCallback)
+{
+    if (d_budget->credits.tryWait()) {
+        {
+            bslmt::LockGuard<bslmt::Mutex> guard(&d_budget->mutex);
+            d_budget->writablePending = true;
+        }
+
+        // A confirm may have returned credit before the wait was recorded,
+        // in which case no writable callback would follow
+        if (d_budget->credits.tryWait()) {
+            RMQT_LOG_TRACE << "Unconfirmed message limit already reached";
+            return rmqp::Producer::INFLIGHT_LIMIT;
+        }
+
+        bslmt::LockGuard<bslmt::Mutex> guard(&d_budget->mutex);
+        d_budget->writablePending = false;
+    }
+
+    const bsl::size_t shard = shardFor(routingKey);
+    const rmqp::Producer::SendStatus status =
+        d_shards[shard]->trySend(message,
+                                 publishKey(shard, routingKey),
+                                 wrap(confirmCallback, routingKey));
+    if (status != rmqp::Producer::SENDING) {
+        release(1);
+    }
+    return status;
+}
+
+void ShardedProducer::setWritableCallback(
+    const rmqp::Producer::WritableCallback& callback,
+    bsl::size_t minimumCredits)
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_budget->mutex);
+    d_budget->writableCallback  = callback;
+    d_budget->writableThreshold = bsl::min<bsl::size_t>(
+        bsl::max<bsl::size_t>(minimumCredits, 1),
+        d_budget->maxOutstandingConfirms);
+}
+
+bsl::size_t ShardedProducer::availableCredits() const
+{
+    return creditsLeft(*d_budget);
+}
+
+void ShardedProducer::setWriteWeight(unsigned weight)
+{
+    for (bsl::size_t i = 0; i < d_shards.size(); ++i) {
+        d_shards[i]->setWriteWeight(weight);
+    }
+}
+
+rmqp::Producer::SendStatus ShardedProducer::sendBatch(
+    const bsl::vector<rmqt::Message>& messages,
+    const bsl::string& routingKey,
+    const rmqp::Producer::ConfirmationCallback& confirmCallback,
+    const bsls::TimeInterval& timeout)
+{
+    const rmqp::Producer::SendStatus reserved =
+        reserve(messages.size(), timeout);
+    if (reserved != rmqp::Producer::SENDING) {
+        return reserved;
+    }
+
+    // The whole batch goes through one shard, so that it stays one write
+    const bsl::size_t shard = shardFor(routingKey);
+    const rmqp::Producer::SendStatus status =
+        d_shards[shard]->sendBatch(messages,
+                                   publishKey(shard, routingKey),
+                                   wrap(confirmCallback, routingKey),
+                                   timeout);
+    if (status != rmqp::Producer::SENDING) {
+        release(messages.size());
+    }
+    return status;
+}
+
+rmqt::Result<rmqp::MessageSink> ShardedProducer::openStream(
+    const rmqt::Message& message,
+    bsl::size_t bodySize,
+    const bsl::string& routingKey,
+    const rmqp::Producer::ConfirmationCallback& confirmCallback,
+    const bsls::TimeInterval& timeout)
+{
+    const rmqp::Producer::SendStatus reserved = reserve(1, timeout);
+    if (reserved != rmqp::Producer::SENDING) {
+        return rmqt::Result<rmqp::MessageSink>(
+            "Timed out waiting for the unconfirmed message limit", reserved);
+    }
+
+    const bsl::size_t shard = shardFor(routingKey);
+    rmqt::Result<rmqp::MessageSink> sink =
+        d_shards[shard]->openStream(message,
+                                    bodySize,
+                                    publishKey(shard, routingKey),
+                                    wrap(confirmCallback, routingKey),
+                                    timeout);
+    if (!sink) {
+        release(1);
+    }
+    return sink;
+}
+
+rmqt::Future<> ShardedProducer::updateTopologyAsync(
+    const rmqt::TopologyUpdate& topologyUpdate)
+{
+    bsl::vector<rmqt::Future<> > updates;
+    for (bsl::size_t i = 0; i < d_shards.size(); ++i) {
+        updates.push_back(d_shards[i]->updateTopologyAsync(topologyUpdate));
+    }
+    return rmqt::FutureUtil::whenAll(updates);
+}
+
+rmqt::Result<> ShardedProducer::waitForConfirms(
+    const bsls::TimeInterval& timeout)
+{
+    const bool hasTimeout = timeout.totalNanoseconds() != 0;
+    const bsls::TimeInterval deadline =
+        bsls::SystemTime::nowRealtimeClock() + timeout;
+
+    for (bsl::size_t i = 0; i < d_shards.size(); ++i) {
+        bsls::TimeInterval remaining;
+        if (hasTimeout) {
+            remaining = deadline - bsls::SystemTime::nowRealtimeClock();
+            if (remaining.totalNanoseconds() <= 0) {
+                // Still give the shard a chance to report it has no confirms
+                remaining = bsls::TimeInterval(0, 1);
+            }
+        }
+
+        rmqt::Result<> result = d_shards[i]->waitForConfirms(remaining);
+        if (!result) {
+            return result;
+        }
+    }
+    return rmqt::Result<>();
+}
+
+} // namespace rmqa
+} // namespace BloombergLP
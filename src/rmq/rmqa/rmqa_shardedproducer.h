@@ -0,0 +1,192 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQA_SHARDEDPRODUCER
+#define INCLUDED_RMQA_SHARDEDPRODUCER
+
+#include <rmqp_messagesink.h>
+#include <rmqp_producer.h>
+#include <rmqt_future.h>
+#include <rmqt_message.h>
+#include <rmqt_result.h>
+#include <rmqt_topologyupdate.h>
+
+#include <bslmt_mutex.h>
+#include <bslmt_timedsemaphore.h>
+#include <bsls_atomic.h>
+#include <bsls_keyword.h>
+#include <bsls_timeinterval.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_memory.h>
+#include <bsl_string.h>
+#include <bsl_vector.h>
+
+//@PURPOSE: Spread one logical producer's messages across several producers
+//
+//@CLASSES:
+//  rmqa::ShardedProducer: an rmqp::Producer publishing through shards
+
+namespace BloombergLP {
+namespace rmqa {
+
+/// \brief An rmqp::Producer which publishes through several producers
+///
+/// Each shard is a producer on its own channel, so publishing and confirm
+/// processing for one logical producer are no longer limited to a single
+/// channel. A single unconfirmed message limit covers all of the shards,
+/// which should each be created with at least that limit. When ordering by
+/// routing key, every message with a given routing key goes through the
+/// same shard and keeps its relative order; otherwise shards are used in
+/// turn and messages may be confirmed out of order.
+///
+/// In partitioned mode each shard publishes to one partition of the
+/// destination, such as a RabbitMQ super stream, with that partition's
+/// routing key. The routing key passed to `send` is then the message's
+/// partition key, mapped onto a partition by `PartitionUtil::partitionOf`,
+/// and is what the confirm callback is given back.
+
+class ShardedProducer : public rmqp::Producer {
+  public:
+    // CREATORS
+    /// Publish through `shards`, allowing at most `maxOutstandingConfirms`
+    /// unconfirmed messages across them. The behavior is undefined unless
+    /// `shards` is not empty.
+    ShardedProducer(const bsl::vector<bsl::shared_ptr<rmqp::Producer> >& shards,
+                    uint16_t maxOutstandingConfirms,
+                    bool orderByRoutingKey);
+
+    /// Publish to partition `i` through `shards[i]`, with routing key
+    /// `partitionRoutingKeys[i]`, allowing at most `maxOutstandingConfirms`
+    /// unconfirmed messages across the shards. The behavior is undefined
+    /// unless `shards` is not empty and has one entry per partition.
+    ShardedProducer(const bsl::vector<bsl::shared_ptr<rmqp::Producer> >& shards,
+                    uint16_t maxOutstandingConfirms,
+                    const bsl::vector<bsl::string>& partitionRoutingKeys);
+
+    ~ShardedProducer() BSLS_KEYWORD_OVERRIDE;
+
+    SendStatus send(const rmqt::Message& message,
+                    const bsl::string& routingKey,
+                    const rmqp::Producer::ConfirmationCallback& confirmCallback,
+                    const bsls::TimeInterval& timeout) BSLS_KEYWORD_OVERRIDE;
+
+    SendStatus send(const rmqt::Message& message,
+                    const bsl::string& routingKey,
+                    rmqt::Mandatory::Value mandatoryFlag,
+                    const rmqp::Producer::ConfirmationCallback& confirmCallback,
+                    const bsls::TimeInterval& timeout) BSLS_KEYWORD_OVERRIDE;
+
+    SendStatus
+    trySend(const rmqt::Message& message,
+            const bsl::string& routingKey,
+            const rmqp::Producer::ConfirmationCallback& confirmCallback)
+        BSLS_KEYWORD_OVERRIDE;
+
+    void setWritableCallback(const rmqp::Producer::WritableCallback& callback,
+                             bsl::size_t minimumCredits) BSLS_KEYWORD_OVERRIDE;
+
+    bsl::size_t availableCredits() const BSLS_KEYWORD_OVERRIDE;
+
+    void setWriteWeight(unsigned weight) BSLS_KEYWORD_OVERRIDE;
+
+    SendStatus
+    sendBatch(const bsl::vector<rmqt::Message>& messages,
+              const bsl::string& routingKey,
+              const rmqp::Producer::ConfirmationCallback& confirmCallback,
+              const bsls::TimeInterval& timeout) BSLS_KEYWORD_OVERRIDE;
+
+    rmqt::Result<rmqp::MessageSink>
+    openStream(const rmqt::Message& message,
+               bsl::size_t bodySize,
+               const bsl::string& routingKey,
+               const rmqp::Producer::ConfirmationCallback& confirmCallback,
+               const bsls::TimeInterval& timeout) BSLS_KEYWORD_OVERRIDE;
+
+    /// Apply `topologyUpdate` on every shard, so that each redeclares it
+    /// after a reconnect. Resolves once all shards have applied it.
+    rmqt::Future<> updateTopologyAsync(
+        const rmqt::TopologyUpdate& topologyUpdate) BSLS_KEYWORD_OVERRIDE;
+
+    /// Wait for the outstanding confirms of every shard
+    rmqt::Result<>
+    waitForConfirms(const bsls::TimeInterval& timeout = bsls::TimeInterval(0))
+        BSLS_KEYWORD_OVERRIDE;
+
+    /// The unconfirmed message limit shared by the shards. Shared with the
+    /// confirm callbacks, which may outlive the producer.
+    struct Budget {
+        explicit Budget(uint16_t maxOutstandingConfirms)
+        : credits(maxOutstandingConfirms)
+        , batchReserveLock(1)
+        , maxOutstandingConfirms(maxOutstandingConfirms)
+        , mutex()
+        , writableCallback()
+        , writableThreshold(1)
+        , writablePending(false)
+        {
+        }
+
+        bslmt::TimedSemaphore credits;
+
+        // Held while reserving credits for a batch, so that concurrent
+        // batches cannot each hold part of the credit the other needs
+        bslmt::TimedSemaphore batchReserveLock;
+        const uint16_t maxOutstandingConfirms;
+
+        // Guards the writable callback state
+        bslmt::Mutex mutex;
+        rmqp::Producer::WritableCallback writableCallback;
+        bsl::size_t writableThreshold;
+        bool writablePending;
+    };
+
+  private:
+    ShardedProducer(const ShardedProducer&) BSLS_KEYWORD_DELETED;
+    ShardedProducer& operator=(const ShardedProducer&) BSLS_KEYWORD_DELETED;
+
+    /// Return the index of the shard publishing messages with `routingKey`
+    bsl::size_t shardFor(const bsl::string& routingKey);
+
+    /// Return the routing key shard `shard` publishes messages given
+    /// `routingKey` with
+    const bsl::string& publishKey(bsl::size_t shard,
+                                  const bsl::string& routingKey) const;
+
+    /// Wait for `count` credits. Either all are acquired, or none are and
+    /// TIMEOUT is returned.
+    SendStatus reserve(bsl::size_t count, const bsls::TimeInterval& timeout);
+
+    /// Return the credits of messages which were not sent
+    void release(bsl::size_t count);
+
+    /// Return a callback returning the credit of a confirmed message and
+    /// reporting it with `routingKey` to `confirmCallback`
+    rmqp::Producer::ConfirmationCallback
+    wrap(const rmqp::Producer::ConfirmationCallback& confirmCallback,
+         const bsl::string& routingKey) const;
+
+    bsl::vector<bsl::shared_ptr<rmqp::Producer> > d_shards;
+    const bsl::vector<bsl::string> d_partitionRoutingKeys;
+    const bool d_orderByRoutingKey;
+    bsls::AtomicUint d_nextShard;
+    bsl::shared_ptr<Budget> d_budget;
+
+}; // class ShardedProducer
+
+} // namespace rmqa
+} // namespace BloombergLP
+
+#endif
@@ -0,0 +1,239 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_sharedrabbitcontext.h>
+
+#include <rmqa_sharedregistry.h>
+
+#include <ball_log.h>
+#include <bdlf_bind.h>
+#include <bdlf_placeholder.h>
+#include <bslma_allocator.h>
+#include <bslma_default.h>
+#include <bslmt_once.h>
+
+namespace BloombergLP {
+namespace rmqa {
+namespace {
+BALL_LOG_SET_NAMESPACE_CATEGORY("RMQA.SHAREDRABBITCONTEXT")
+
+/// Return the key vhosts to `vhostInfo` share connections under. It holds
+/// the credentials, so must never be logged.
+bsl::string vhostKey(const rmqt::VHostInfo& vhostInfo)
+{
+    const bsl::shared_ptr<rmqt::Endpoint> standby =
+        vhostInfo.standbyEndpoint();
+
+    bsl::string key = vhostInfo.endpoint()->formatAddress();
+    key += '\n';
+    key += vhostInfo.endpoint()->vhost();
+    key += '\n';
+    key += standby ? standby->formatAddress() : bsl::string();
+    key += '\n';
+    key += vhostInfo.credentials()->authenticationMechanism();
+    key += '\n';
+    key += vhostInfo.credentials()->formatCredentials();
+    return key;
+}
+
+void closeVHost(const bsl::shared_ptr<rmqp::Connection>& vhost,
+                rmqp::Connection*)
+{
+    vhost->close();
+}
+
+/// Return a vhost to `vhostInfo` from `context`, which closes once its last
+/// hold is released
+bsl::shared_ptr<rmqp::Connection>
+makeVHost(const bsl::shared_ptr<rmqp::RabbitContext>& context,
+          const bsl::string& userDefinedName,
+          const rmqt::VHostInfo& vhostInfo)
+{
+    BALL_LOG_INFO << "Opening vhost '" << userDefinedName << "' to "
+                  << vhostInfo.endpoint()->formatAddress()
+                  << ", shared across the process";
+
+    const bsl::shared_ptr<rmqp::Connection> vhost =
+        context->createVHostConnection(userDefinedName, vhostInfo);
+    return bsl::shared_ptr<rmqp::Connection>(
+        vhost.get(),
+        bdlf::BindUtil::bind(&closeVHost, vhost, bdlf::PlaceHolders::_1));
+}
+
+/// A hold on a vhost shared with other holders
+class SharedVHost : public rmqp::Connection {
+  public:
+    explicit SharedVHost(const bsl::shared_ptr<rmqp::Connection>& vhost)
+    : d_vhost(vhost)
+    {
+    }
+
+    rmqt::Result<rmqp::Producer>
+    createProducer(const rmqt::Topology& topology,
+                   rmqt::ExchangeHandle exchange,
+                   uint16_t maxOutstandingConfirms) BSLS_KEYWORD_OVERRIDE
+    {
+        return d_vhost->createProducer(
+            topology, exchange, maxOutstandingConfirms);
+    }
+
+    rmqt::Result<rmqp::Consumer>
+    createConsumer(const rmqt::Topology& topology,
+                   rmqt::QueueHandle queue,
+                   const rmqp::Consumer::ConsumerFunc& onMessage,
+                   const rmqt::ConsumerConfig& config) BSLS_KEYWORD_OVERRIDE
+    {
+        return d_vhost->createConsumer(topology, queue, onMessage, config);
+    }
+
+    rmqt::Future<rmqp::Producer>
+    createProducerAsync(const rmqt::Topology& topology,
+                        rmqt::ExchangeHandle exchange,
+                        uint16_t maxOutstandingConfirms) BSLS_KEYWORD_OVERRIDE
+    {
+        return d_vhost->createProducerAsync(
+            topology, exchange, maxOutstandingConfirms);
+    }
+
+    rmqt::Future<rmqp::Producer> createUnconfirmedProducerAsync(
+        const rmqt::Topology& topology,
+        rmqt::ExchangeHandle exchange,
+        uint16_t maxUnwrittenMessages) BSLS_KEYWORD_OVERRIDE
+    {
+        return d_vhost->createUnconfirmedProducerAsync(
+            topology, exchange, maxUnwrittenMessages);
+    }
+
+    rmqt::Future<rmqp::RpcClient>
+    createRpcClientAsync(const rmqt::Topology& topology,
+                         rmqt::ExchangeHandle exchange) BSLS_KEYWORD_OVERRIDE
+    {
+        return d_vhost->createRpcClientAsync(topology, exchange);
+    }
+
+    rmqt::Future<rmqp::Consumer> createConsumerAsync(
+        const rmqt::Topology& topology,
+        rmqt::QueueHandle queue,
+        const rmqp::Consumer::ConsumerFunc& onMessage,
+        const rmqt::ConsumerConfig& config) BSLS_KEYWORD_OVERRIDE
+    {
+        return d_vhost->createConsumerAsync(topology, queue, onMessage, config);
+    }
+
+    rmqt::Future<rmqp::Consumer> createBatchConsumerAsync(
+        const rmqt::Topology& topology,
+        rmqt::QueueHandle queue,
+        const rmqp::Consumer::BatchConsumerFunc& onBatch,
+        const rmqt::ConsumerConfig& config) BSLS_KEYWORD_OVERRIDE
+    {
+        return d_vhost->createBatchConsumerAsync(
+            topology, queue, onBatch, config);
+    }
+
+    /// Other holders may still be using the vhost: it closes once the last
+    /// hold is destroyed
+    void close() BSLS_KEYWORD_OVERRIDE {}
+
+  private:
+    bsl::shared_ptr<rmqp::Connection> d_vhost;
+};
+
+} // namespace
+
+struct SharedRabbitContext::Core {
+    explicit Core(const bsl::shared_ptr<rmqp::RabbitContext>& context)
+    : context(context)
+    , vhosts()
+    {
+    }
+
+    bsl::shared_ptr<rmqp::RabbitContext> context;
+    SharedRegistry<rmqp::Connection> vhosts;
+};
+
+bslma::ManagedPtr<rmqp::RabbitContext>
+SharedRabbitContext::acquire(const ContextMaker& makeContext)
+{
+    static SharedRegistry<Core>* s_contexts;
+    BSLMT_ONCE_DO
+    {
+        // Never freed, as holds may still be released during static
+        // destruction
+        bslma::Allocator* allocator = bslma::Default::globalAllocator();
+        s_contexts = new (*allocator) SharedRegistry<Core>();
+    }
+
+    return bslma::ManagedPtr<rmqp::RabbitContext>(
+        new SharedRabbitContext(s_contexts->acquire(
+            bsl::string(),
+            bdlf::BindUtil::bind(&SharedRabbitContext::makeCore,
+                                 makeContext))));
+}
+
+bsl::shared_ptr<SharedRabbitContext::Core>
+SharedRabbitContext::makeCore(const ContextMaker& makeContext)
+{
+    BALL_LOG_INFO << "Creating the RabbitContext shared across the process";
+
+    return bsl::make_shared<Core>(makeContext());
+}
+
+SharedRabbitContext::SharedRabbitContext(const bsl::shared_ptr<Core>& core)
+: d_core(core)
+{
+}
+
+SharedRabbitContext::~SharedRabbitContext() {}
+
+bsl::shared_ptr<rmqp::Connection> SharedRabbitContext::createVHostConnection(
+    const bsl::string& userDefinedName,
+    const bsl::shared_ptr<rmqt::Endpoint>& endpoint,
+    const bsl::shared_ptr<rmqt::Credentials>& credentials)
+{
+    return createVHostConnection(userDefinedName,
+                                 rmqt::VHostInfo(endpoint, credentials));
+}
+
+bsl::shared_ptr<rmqp::Connection>
+SharedRabbitContext::createVHostConnection(const bsl::string& userDefinedName,
+                                           const rmqt::VHostInfo& vhostInfo)
+{
+    return bsl::make_shared<SharedVHost>(d_core->vhosts.acquire(
+        vhostKey(vhostInfo),
+        bdlf::BindUtil::bind(
+            &makeVHost, d_core->context, userDefinedName, vhostInfo)));
+}
+
+rmqt::Result<> SharedRabbitContext::shutdown(const bsls::TimeInterval&)
+{
+    return rmqt::Result<>("A RabbitContext shared across the process cannot "
+                          "shut down the connections other holders use");
+}
+
+bsl::vector<rmqt::ConnectionStats>
+SharedRabbitContext::stats(const bsls::TimeInterval& timeout)
+{
+    return d_core->context->stats(timeout);
+}
+
+bsl::size_t SharedRabbitContext::poll() { return d_core->context->poll(); }
+
+bsl::size_t SharedRabbitContext::runFor(const bsls::TimeInterval& duration)
+{
+    return d_core->context->runFor(duration);
+}
+
+} // namespace rmqa
+} // namespace BloombergLP
@@ -0,0 +1,107 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQA_SHAREDRABBITCONTEXT
+#define INCLUDED_RMQA_SHAREDRABBITCONTEXT
+
+#include <rmqp_connection.h>
+#include <rmqp_rabbitcontext.h>
+#include <rmqt_connectionstats.h>
+#include <rmqt_credentials.h>
+#include <rmqt_endpoint.h>
+#include <rmqt_result.h>
+#include <rmqt_vhostinfo.h>
+
+#include <bslma_managedptr.h>
+#include <bsls_keyword.h>
+#include <bsls_timeinterval.h>
+
+#include <bsl_functional.h>
+#include <bsl_memory.h>
+#include <bsl_string.h>
+#include <bsl_vector.h>
+
+//@PURPOSE: Share one RabbitContext, and its connections, across a process
+//
+//@CLASSES:
+//  rmqa::SharedRabbitContext: a hold on the context shared process-wide
+
+namespace BloombergLP {
+namespace rmqa {
+
+/// \brief A hold on the one RabbitContext shared across the process
+///
+/// Every hold `acquire` returns uses the same context, and so the same
+/// event loops, threadpool and connections, which are destroyed when the
+/// last hold is. Vhosts created with the same endpoint, vhost and
+/// credentials through any hold share their connections too, which keep
+/// the name given by the first. Closing such a vhost does nothing, as
+/// others may be using it: its connections close once every vhost sharing
+/// them has been destroyed.
+class SharedRabbitContext : public rmqp::RabbitContext {
+  public:
+    typedef bsl::function<bsl::shared_ptr<rmqp::RabbitContext>()>
+        ContextMaker;
+
+    /// Return a hold on the process-wide context, made by `makeContext` if
+    /// nothing holds one.
+    static bslma::ManagedPtr<rmqp::RabbitContext>
+    acquire(const ContextMaker& makeContext);
+
+    ~SharedRabbitContext() BSLS_KEYWORD_OVERRIDE;
+
+    bsl::shared_ptr<rmqp::Connection> createVHostConnection(
+        const bsl::string& userDefinedName,
+        const bsl::shared_ptr<rmqt::Endpoint>& endpoint,
+        const bsl::shared_ptr<rmqt::Credentials>& credentials)
+        BSLS_KEYWORD_OVERRIDE;
+
+    bsl::shared_ptr<rmqp::Connection>
+    createVHostConnection(const bsl::string& userDefinedName,
+                          const rmqt::VHostInfo& vhostInfo)
+        BSLS_KEYWORD_OVERRIDE;
+
+    /// Return an error: the connections belong to every holder
+    rmqt::Result<> shutdown(const bsls::TimeInterval& timeout)
+        BSLS_KEYWORD_OVERRIDE;
+
+    /// Snapshot the connections of every holder
+    bsl::vector<rmqt::ConnectionStats>
+    stats(const bsls::TimeInterval& timeout) BSLS_KEYWORD_OVERRIDE;
+
+    bsl::size_t poll() BSLS_KEYWORD_OVERRIDE;
+
+    bsl::size_t
+    runFor(const bsls::TimeInterval& duration) BSLS_KEYWORD_OVERRIDE;
+
+  private:
+    struct Core;
+
+    static bsl::shared_ptr<Core> makeCore(const ContextMaker& makeContext);
+
+    explicit SharedRabbitContext(const bsl::shared_ptr<Core>& core);
+
+    bsl::shared_ptr<Core> d_core;
+
+  private:
+    SharedRabbitContext(const SharedRabbitContext&) BSLS_KEYWORD_DELETED;
+    SharedRabbitContext&
+    operator=(const SharedRabbitContext&) BSLS_KEYWORD_DELETED;
+};
+
+} // namespace rmqa
+} // namespace BloombergLP
+
+#endif
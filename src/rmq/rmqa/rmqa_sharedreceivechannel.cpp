@@ -0,0 +1,165 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_sharedreceivechannel.h>
+
+#include <rmqio_eventloop.h>
+
+#include <bdlf_bind.h>
+#include <bslmt_lockguard.h>
+
+namespace BloombergLP {
+namespace rmqa {
+namespace {
+
+template <typename T>
+void addEntities(bsl::unordered_set<const void*>* entities,
+                 const bsl::vector<bsl::shared_ptr<T> >& vec)
+{
+    for (typename bsl::vector<bsl::shared_ptr<T> >::const_iterator it =
+             vec.begin();
+         it != vec.end();
+         ++it) {
+        entities->insert(it->get());
+    }
+}
+
+template <typename T>
+bool containsAll(const bsl::unordered_set<const void*>& entities,
+                 const bsl::vector<bsl::shared_ptr<T> >& vec)
+{
+    for (typename bsl::vector<bsl::shared_ptr<T> >::const_iterator it =
+             vec.begin();
+         it != vec.end();
+         ++it) {
+        if (entities.find(it->get()) == entities.end()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Return true if `lhs` and `rhs` agree on the settings a receive channel
+/// applies to all of its consumers. Payload allocators and saturation probes
+/// cannot be compared, so consumers with either never share a channel.
+bool sameChannelSettings(const rmqt::ConsumerConfig& lhs,
+                         const rmqt::ConsumerConfig& rhs)
+{
+    return lhs.prefetchCount() == rhs.prefetchCount() &&
+           lhs.minPrefetchCount() == rhs.minPrefetchCount() &&
+           lhs.maxPrefetchCount() == rhs.maxPrefetchCount() &&
+           lhs.prefetchBytes() == rhs.prefetchBytes() &&
+           lhs.slowStartPrefetchCount() == rhs.slowStartPrefetchCount() &&
+           lhs.exclusiveFlag() == rhs.exclusiveFlag() &&
+           lhs.consumerPriority() == rhs.consumerPriority() &&
+           lhs.noAck() == rhs.noAck() &&
+           lhs.ackCoalescingDelay() == rhs.ackCoalescingDelay() &&
+           lhs.ackCoalescingTags() == rhs.ackCoalescingTags() &&
+           lhs.lazyHeaders() == rhs.lazyHeaders() &&
+           lhs.decodedProperties() == rhs.decodedProperties() &&
+           lhs.streamOffset() == rhs.streamOffset() &&
+           !lhs.payloadAllocator() && !rhs.payloadAllocator() &&
+           !lhs.saturationProbe() && !rhs.saturationProbe();
+}
+
+} // namespace
+
+SharedReceiveChannel::Registry::Registry()
+: d_mutex()
+, d_channels()
+{
+}
+
+bsl::shared_ptr<SharedReceiveChannel>
+SharedReceiveChannel::Registry::find(const rmqt::Topology& topology,
+                                     const rmqt::ConsumerConfig& consumerConfig)
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+
+    bsl::vector<bsl::weak_ptr<SharedReceiveChannel> >::iterator it =
+        d_channels.begin();
+    while (it != d_channels.end()) {
+        bsl::shared_ptr<SharedReceiveChannel> channel = it->lock();
+        if (!channel) {
+            it = d_channels.erase(it);
+            continue;
+        }
+        if (channel->covers(topology, consumerConfig)) {
+            return channel;
+        }
+        ++it;
+    }
+    return bsl::shared_ptr<SharedReceiveChannel>();
+}
+
+void SharedReceiveChannel::Registry::add(
+    const bsl::shared_ptr<SharedReceiveChannel>& channel)
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    d_channels.push_back(channel);
+}
+
+SharedReceiveChannel::SharedReceiveChannel(
+    const bsl::shared_ptr<rmqamqp::ReceiveChannel>& channel,
+    const rmqt::Topology& topology,
+    const rmqt::ConsumerConfig& consumerConfig,
+    const bsl::shared_ptr<rmqt::ConsumerAckQueue>& ackQueue,
+    rmqio::EventLoop& eventLoop)
+: d_channel(channel)
+, d_topology(topology)
+, d_consumerConfig(consumerConfig)
+, d_ackQueue(ackQueue)
+, d_eventLoop(eventLoop)
+, d_entities()
+{
+    addEntities(&d_entities, d_topology.queues);
+    addEntities(&d_entities, d_topology.exchanges);
+    addEntities(&d_entities, d_topology.queueBindings);
+    addEntities(&d_entities, d_topology.exchangeBindings);
+}
+
+bsl::shared_ptr<SharedReceiveChannel> SharedReceiveChannel::make(
+    const bsl::shared_ptr<rmqamqp::ReceiveChannel>& channel,
+    const rmqt::Topology& topology,
+    const rmqt::ConsumerConfig& consumerConfig,
+    const bsl::shared_ptr<rmqt::ConsumerAckQueue>& ackQueue,
+    rmqio::EventLoop& eventLoop)
+{
+    channel->shareBetweenConsumers();
+
+    return bsl::shared_ptr<SharedReceiveChannel>(new SharedReceiveChannel(
+        channel, topology, consumerConfig, ackQueue, eventLoop));
+}
+
+SharedReceiveChannel::~SharedReceiveChannel()
+{
+    d_eventLoop.post(
+        bdlf::BindUtil::bind(&rmqamqp::Channel::gracefulClose, d_channel));
+}
+
+bool SharedReceiveChannel::covers(
+    const rmqt::Topology& topology,
+    const rmqt::ConsumerConfig& consumerConfig) const
+{
+    return topology.declareMode == d_topology.declareMode &&
+           sameChannelSettings(consumerConfig, d_consumerConfig) &&
+           containsAll(d_entities, topology.queues) &&
+           containsAll(d_entities, topology.exchanges) &&
+           containsAll(d_entities, topology.queueBindings) &&
+           containsAll(d_entities, topology.exchangeBindings);
+}
+
+} // namespace rmqa
+} // namespace BloombergLP
@@ -0,0 +1,130 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQA_SHAREDRECEIVECHANNEL
+#define INCLUDED_RMQA_SHAREDRECEIVECHANNEL
+
+#include <rmqamqp_receivechannel.h>
+#include <rmqt_consumerackqueue.h>
+#include <rmqt_consumerconfig.h>
+#include <rmqt_topology.h>
+
+#include <bslmt_mutex.h>
+#include <bsls_keyword.h>
+
+#include <bsl_memory.h>
+#include <bsl_unordered_set.h>
+#include <bsl_vector.h>
+
+//@PURPOSE: Share one receive channel between several consumers
+//
+//@CLASSES:
+//  rmqa::SharedReceiveChannel: a receive channel several consumers consume on
+//  rmqa::SharedReceiveChannel::Registry: the shared channels of a connection
+
+namespace BloombergLP {
+namespace rmqio {
+class EventLoop;
+}
+namespace rmqa {
+
+/// \brief A ReceiveChannel consumed from by several consumers
+///
+/// Each consumer issues its own basic.consume on the channel, which
+/// delivers to it by consumer tag, and acks through the channel's ack queue.
+/// The prefetch count limits the unacked deliveries of all the consumers
+/// together. The channel is closed once the last consumer releases it.
+/// Consumers share a channel only if their topology is already declared by
+/// the channel, so that redeclaring it after a reconnect covers them all,
+/// and their configuration agrees on everything the channel applies to all
+/// of its consumers (prefetch, acking, header decoding and the consume
+/// arguments).
+
+class SharedReceiveChannel {
+  public:
+    /// Shared channels of one connection, which consumers can join
+    class Registry {
+      public:
+        Registry();
+
+        /// Return a live channel which declares every entity of `topology`
+        /// and can take a consumer configured by `consumerConfig`, or an
+        /// empty pointer
+        bsl::shared_ptr<SharedReceiveChannel>
+        find(const rmqt::Topology& topology,
+             const rmqt::ConsumerConfig& consumerConfig);
+
+        void add(const bsl::shared_ptr<SharedReceiveChannel>& channel);
+
+      private:
+        bslmt::Mutex d_mutex;
+        bsl::vector<bsl::weak_ptr<SharedReceiveChannel> > d_channels;
+    };
+
+    /// Share `channel`, which was opened for a consumer configured by
+    /// `consumerConfig` declaring `topology`, and acking through `ackQueue`.
+    /// Must be called on the event loop thread before that consumer starts.
+    static bsl::shared_ptr<SharedReceiveChannel>
+    make(const bsl::shared_ptr<rmqamqp::ReceiveChannel>& channel,
+         const rmqt::Topology& topology,
+         const rmqt::ConsumerConfig& consumerConfig,
+         const bsl::shared_ptr<rmqt::ConsumerAckQueue>& ackQueue,
+         rmqio::EventLoop& eventLoop);
+
+    /// Gracefully close the channel
+    ~SharedReceiveChannel();
+
+    const bsl::shared_ptr<rmqamqp::ReceiveChannel>& channel() const
+    {
+        return d_channel;
+    }
+
+    /// The queue every consumer on the channel acks through
+    const bsl::shared_ptr<rmqt::ConsumerAckQueue>& ackQueue() const
+    {
+        return d_ackQueue;
+    }
+
+    /// Return true if consumers configured by `consumerConfig` declaring
+    /// `topology` can use this channel
+    bool covers(const rmqt::Topology& topology,
+                const rmqt::ConsumerConfig& consumerConfig) const;
+
+  private:
+    SharedReceiveChannel(
+        const bsl::shared_ptr<rmqamqp::ReceiveChannel>& channel,
+        const rmqt::Topology& topology,
+        const rmqt::ConsumerConfig& consumerConfig,
+        const bsl::shared_ptr<rmqt::ConsumerAckQueue>& ackQueue,
+        rmqio::EventLoop& eventLoop);
+
+    bsl::shared_ptr<rmqamqp::ReceiveChannel> d_channel;
+    rmqt::Topology d_topology;
+    rmqt::ConsumerConfig d_consumerConfig;
+    bsl::shared_ptr<rmqt::ConsumerAckQueue> d_ackQueue;
+    rmqio::EventLoop& d_eventLoop;
+
+    /// Addresses of the entities in `d_topology`, which keeps them alive
+    bsl::unordered_set<const void*> d_entities;
+
+    SharedReceiveChannel(const SharedReceiveChannel&) BSLS_KEYWORD_DELETED;
+    SharedReceiveChannel&
+    operator=(const SharedReceiveChannel&) BSLS_KEYWORD_DELETED;
+};
+
+} // namespace rmqa
+} // namespace BloombergLP
+
+#endif
@@ -0,0 +1,121 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQA_SHAREDREGISTRY
+#define INCLUDED_RMQA_SHAREDREGISTRY
+
+#include <bslmt_lockguard.h>
+#include <bslmt_mutex.h>
+#include <bsls_keyword.h>
+
+#include <bsl_functional.h>
+#include <bsl_map.h>
+#include <bsl_memory.h>
+#include <bsl_string.h>
+
+//@PURPOSE: Share one object between everyone asking for the same key
+//
+//@CLASSES:
+//  rmqa::SharedRegistry: objects shared by key while anyone holds them
+
+namespace BloombergLP {
+namespace rmqa {
+
+/// \brief Objects shared by key for as long as anyone holds them
+///
+/// `acquire` returns the object already held under a key, or makes one, so
+/// that everyone acquiring the same key shares one object. Only weak
+/// references are kept: an object is destroyed, by whoever releases it
+/// last, once it is no longer held, and the next `acquire` of its key makes
+/// a new one. Thread-safe.
+template <typename T>
+class SharedRegistry {
+  public:
+    typedef bsl::function<bsl::shared_ptr<T>()> Maker;
+
+    SharedRegistry();
+
+    /// Return the object held under `key`, or one made by `make` if there
+    /// is none. `make` is called with the registry locked, so must not use
+    /// it.
+    bsl::shared_ptr<T> acquire(const bsl::string& key, const Maker& make);
+
+    /// Return the number of keys whose object is still held
+    bsl::size_t size() const;
+
+  private:
+    typedef bsl::map<bsl::string, bsl::weak_ptr<T> > Objects;
+
+    mutable bslmt::Mutex d_mutex;
+    Objects d_objects;
+
+  private:
+    SharedRegistry(const SharedRegistry&) BSLS_KEYWORD_DELETED;
+    SharedRegistry& operator=(const SharedRegistry&) BSLS_KEYWORD_DELETED;
+};
+
+template <typename T>
+SharedRegistry<T>::SharedRegistry()
+: d_mutex()
+, d_objects()
+{
+}
+
+template <typename T>
+bsl::shared_ptr<T> SharedRegistry<T>::acquire(const bsl::string& key,
+                                              const Maker& make)
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+
+    // Drop the keys of released objects as we go, so they do not pile up
+    typename Objects::iterator it = d_objects.begin();
+    while (it != d_objects.end()) {
+        if (it->second.expired() && it->first != key) {
+            d_objects.erase(it++);
+        }
+        else {
+            ++it;
+        }
+    }
+
+    bsl::weak_ptr<T>& entry   = d_objects[key];
+    bsl::shared_ptr<T> object = entry.lock();
+    if (!object) {
+        object = make();
+        entry  = object;
+    }
+    return object;
+}
+
+template <typename T>
+bsl::size_t SharedRegistry<T>::size() const
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+
+    bsl::size_t held = 0;
+    for (typename Objects::const_iterator it = d_objects.begin();
+         it != d_objects.end();
+         ++it) {
+        if (!it->second.expired()) {
+            ++held;
+        }
+    }
+    return held;
+}
+
+} // namespace rmqa
+} // namespace BloombergLP
+
+#endif
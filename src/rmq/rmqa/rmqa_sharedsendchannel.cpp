@@ -0,0 +1,264 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_sharedsendchannel.h>
+
+#include <rmqio_eventloop.h>
+
+#include <ball_log.h>
+#include <bdlf_bind.h>
+#include <bdlf_placeholder.h>
+#include <bslmt_lockguard.h>
+
+#include <bsl_utility.h>
+
+namespace BloombergLP {
+namespace rmqa {
+namespace {
+
+BALL_LOG_SET_NAMESPACE_CATEGORY("RMQA.SHAREDSENDCHANNEL")
+
+template <typename T>
+void addEntities(bsl::unordered_set<const void*>* entities,
+                 const bsl::vector<bsl::shared_ptr<T> >& vec)
+{
+    for (typename bsl::vector<bsl::shared_ptr<T> >::const_iterator it =
+             vec.begin();
+         it != vec.end();
+         ++it) {
+        entities->insert(it->get());
+    }
+}
+
+template <typename T>
+bool containsAll(const bsl::unordered_set<const void*>& entities,
+                 const bsl::vector<bsl::shared_ptr<T> >& vec)
+{
+    for (typename bsl::vector<bsl::shared_ptr<T> >::const_iterator it =
+             vec.begin();
+         it != vec.end();
+         ++it) {
+        if (entities.find(it->get()) == entities.end()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+SharedSendChannel::Registry::Registry()
+: d_mutex()
+, d_channels()
+{
+}
+
+bsl::shared_ptr<SharedSendChannel>
+SharedSendChannel::Registry::find(const rmqt::Exchange& exchange,
+                                  const rmqt::Topology& topology)
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+
+    bsl::vector<bsl::weak_ptr<SharedSendChannel> >::iterator it =
+        d_channels.begin();
+    while (it != d_channels.end()) {
+        bsl::shared_ptr<SharedSendChannel> channel = it->lock();
+        if (!channel) {
+            it = d_channels.erase(it);
+            continue;
+        }
+        if (channel->covers(exchange, topology)) {
+            return channel;
+        }
+        ++it;
+    }
+    return bsl::shared_ptr<SharedSendChannel>();
+}
+
+void SharedSendChannel::Registry::add(
+    const bsl::shared_ptr<SharedSendChannel>& channel)
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    d_channels.push_back(channel);
+}
+
+SharedSendChannel::SharedSendChannel(
+    const bsl::shared_ptr<rmqamqp::SendChannel>& channel,
+    const rmqt::Exchange& exchange,
+    const rmqt::Topology& topology,
+    rmqio::EventLoop& eventLoop)
+: d_channel(channel)
+, d_exchange(exchange)
+, d_topology(topology)
+, d_eventLoop(eventLoop)
+, d_self()
+, d_entities()
+, d_mutex()
+, d_nextProducerId(0)
+, d_producers()
+, d_routes()
+{
+    addEntities(&d_entities, d_topology.queues);
+    addEntities(&d_entities, d_topology.exchanges);
+    addEntities(&d_entities, d_topology.queueBindings);
+    addEntities(&d_entities, d_topology.exchangeBindings);
+}
+
+bsl::shared_ptr<SharedSendChannel>
+SharedSendChannel::make(const bsl::shared_ptr<rmqamqp::SendChannel>& channel,
+                        const rmqt::Exchange& exchange,
+                        const rmqt::Topology& topology,
+                        rmqio::EventLoop& eventLoop)
+{
+    bsl::shared_ptr<SharedSendChannel> shared(
+        new SharedSendChannel(channel, exchange, topology, eventLoop));
+    shared->d_self = shared;
+    shared->installRouter();
+
+    return shared;
+}
+
+void SharedSendChannel::installRouter()
+{
+    d_channel->setBatchCallback(bdlf::BindUtil::bind(
+        &SharedSendChannel::onConfirms, d_self, bdlf::PlaceHolders::_1));
+}
+
+SharedSendChannel::~SharedSendChannel()
+{
+    d_eventLoop.post(
+        bdlf::BindUtil::bind(&rmqamqp::Channel::gracefulClose, d_channel));
+}
+
+bool SharedSendChannel::covers(const rmqt::Exchange& exchange,
+                               const rmqt::Topology& topology) const
+{
+    return exchange == d_exchange &&
+           topology.declareMode == d_topology.declareMode &&
+           containsAll(d_entities, topology.queues) &&
+           containsAll(d_entities, topology.exchanges) &&
+           containsAll(d_entities, topology.queueBindings) &&
+           containsAll(d_entities, topology.exchangeBindings);
+}
+
+SharedSendChannel::ProducerId SharedSendChannel::attach(
+    const rmqamqp::SendChannel::MessageBatchConfirmCallback& onConfirm)
+{
+    // Producers install their own confirm callback when created
+    installRouter();
+
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+
+    const ProducerId producerId = d_nextProducerId++;
+    d_producers[producerId]     = onConfirm;
+    return producerId;
+}
+
+void SharedSendChannel::detach(ProducerId producerId)
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+
+    d_producers.erase(producerId);
+
+    // Confirms still outstanding for this producer have nowhere to go
+    bsl::unordered_map<bdlb::Guid, ProducerId>::iterator it =
+        d_routes.begin();
+    while (it != d_routes.end()) {
+        if (it->second == producerId) {
+            it = d_routes.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+void SharedSendChannel::route(const bdlb::Guid& guid, ProducerId producerId)
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    d_routes[guid] = producerId;
+}
+
+void SharedSendChannel::onConfirms(
+    const bsl::weak_ptr<SharedSendChannel>& weakSelf,
+    const bsl::shared_ptr<const rmqamqp::SendChannel::ConfirmationBatch>&
+        confirmations)
+{
+    bsl::shared_ptr<SharedSendChannel> self = weakSelf.lock();
+    if (!self) {
+        return;
+    }
+    self->dispatch(*confirmations);
+}
+
+void SharedSendChannel::dispatch(
+    const rmqamqp::SendChannel::ConfirmationBatch& confirmations)
+{
+    typedef bsl::map<ProducerId,
+                     bsl::shared_ptr<rmqamqp::SendChannel::ConfirmationBatch> >
+        BatchMap;
+
+    typedef bsl::pair<rmqamqp::SendChannel::MessageBatchConfirmCallback,
+                      BatchMap::mapped_type>
+        Delivery;
+
+    BatchMap batches;
+    bsl::vector<Delivery> deliveries;
+    {
+        bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+
+        for (rmqamqp::SendChannel::ConfirmationBatch::const_iterator it =
+                 confirmations.begin();
+             it != confirmations.end();
+             ++it) {
+            const bdlb::Guid& guid = it->first.message().guid();
+            bsl::unordered_map<bdlb::Guid, ProducerId>::iterator route =
+                d_routes.find(guid);
+            if (route == d_routes.end()) {
+                BALL_LOG_WARN << "Confirm for message " << guid
+                              << " which no producer on "
+                                 "this channel is waiting for";
+                continue;
+            }
+
+            bsl::shared_ptr<rmqamqp::SendChannel::ConfirmationBatch>& batch =
+                batches[route->second];
+            if (!batch) {
+                batch = bsl::make_shared<
+                    rmqamqp::SendChannel::ConfirmationBatch>();
+            }
+            batch->push_back(*it);
+            d_routes.erase(route);
+        }
+
+        for (BatchMap::const_iterator it = batches.begin();
+             it != batches.end();
+             ++it) {
+            ProducerMap::const_iterator producer = d_producers.find(it->first);
+            if (producer != d_producers.end()) {
+                deliveries.push_back(Delivery(producer->second, it->second));
+            }
+        }
+    }
+
+    // Run the producers' callbacks without holding the lock, as they may
+    // detach
+    for (bsl::size_t i = 0; i < deliveries.size(); ++i) {
+        deliveries[i].first(deliveries[i].second);
+    }
+}
+
+} // namespace rmqa
+} // namespace BloombergLP
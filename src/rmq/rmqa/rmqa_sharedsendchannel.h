@@ -0,0 +1,150 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQA_SHAREDSENDCHANNEL
+#define INCLUDED_RMQA_SHAREDSENDCHANNEL
+
+#include <rmqamqp_sendchannel.h>
+#include <rmqt_exchange.h>
+#include <rmqt_topology.h>
+
+#include <bdlb_guid.h>
+#include <bslmt_mutex.h>
+#include <bsls_keyword.h>
+
+#include <bsl_map.h>
+#include <bsl_memory.h>
+#include <bsl_unordered_map.h>
+#include <bsl_unordered_set.h>
+#include <bsl_vector.h>
+
+//@PURPOSE: Share one send channel between several producers
+//
+//@CLASSES:
+//  rmqa::SharedSendChannel: a send channel routing confirms to producers
+//  rmqa::SharedSendChannel::Registry: the shared channels of a connection
+
+namespace BloombergLP {
+namespace rmqio {
+class EventLoop;
+}
+namespace rmqa {
+
+/// \brief A SendChannel published to by several producers
+///
+/// Each producer attaches a confirm callback and routes the GUID of every
+/// message it sends to it, so that the channel's confirmations reach the
+/// producer which sent each message. The channel is closed once the last
+/// producer releases it. Producers share a channel only if they publish to
+/// the same exchange with a topology the channel already declares, so that
+/// redeclaring the channel's topology after a reconnect covers them all.
+
+class SharedSendChannel {
+  public:
+    typedef unsigned int ProducerId;
+
+    /// Shared channels of one connection, which producers can join
+    class Registry {
+      public:
+        Registry();
+
+        /// Return a live channel publishing to `exchange` which declares
+        /// every entity of `topology`, or an empty pointer
+        bsl::shared_ptr<SharedSendChannel>
+        find(const rmqt::Exchange& exchange, const rmqt::Topology& topology);
+
+        void add(const bsl::shared_ptr<SharedSendChannel>& channel);
+
+      private:
+        bslmt::Mutex d_mutex;
+        bsl::vector<bsl::weak_ptr<SharedSendChannel> > d_channels;
+    };
+
+    /// Share `channel`, which was opened for a producer to `exchange`
+    /// declaring `topology`. Must be called on the event loop thread before
+    /// any message is published on `channel`.
+    static bsl::shared_ptr<SharedSendChannel>
+    make(const bsl::shared_ptr<rmqamqp::SendChannel>& channel,
+         const rmqt::Exchange& exchange,
+         const rmqt::Topology& topology,
+         rmqio::EventLoop& eventLoop);
+
+    /// Gracefully close the channel
+    ~SharedSendChannel();
+
+    const bsl::shared_ptr<rmqamqp::SendChannel>& channel() const
+    {
+        return d_channel;
+    }
+
+    /// Return true if producers to `exchange` declaring `topology` can use
+    /// this channel
+    bool covers(const rmqt::Exchange& exchange,
+                const rmqt::Topology& topology) const;
+
+    /// Register the callback receiving confirms for a producer's messages.
+    /// Must be called on the event loop thread.
+    ProducerId
+    attach(const rmqamqp::SendChannel::MessageBatchConfirmCallback& onConfirm);
+
+    /// Stop delivering confirms to `producerId`
+    void detach(ProducerId producerId);
+
+    /// Deliver the confirm for the message `guid` to `producerId`
+    void route(const bdlb::Guid& guid, ProducerId producerId);
+
+  private:
+    SharedSendChannel(const bsl::shared_ptr<rmqamqp::SendChannel>& channel,
+                      const rmqt::Exchange& exchange,
+                      const rmqt::Topology& topology,
+                      rmqio::EventLoop& eventLoop);
+
+    static void onConfirms(
+        const bsl::weak_ptr<SharedSendChannel>& weakSelf,
+        const bsl::shared_ptr<const rmqamqp::SendChannel::ConfirmationBatch>&
+            confirmations);
+
+    /// Deliver the channel's confirms to `onConfirms`
+    void installRouter();
+
+    void dispatch(const rmqamqp::SendChannel::ConfirmationBatch& confirmations);
+
+    typedef bsl::map<ProducerId,
+                     rmqamqp::SendChannel::MessageBatchConfirmCallback>
+        ProducerMap;
+
+    bsl::shared_ptr<rmqamqp::SendChannel> d_channel;
+    rmqt::Exchange d_exchange;
+    rmqt::Topology d_topology;
+    rmqio::EventLoop& d_eventLoop;
+    bsl::weak_ptr<SharedSendChannel> d_self;
+
+    /// Addresses of the entities in `d_topology`, which keeps them alive
+    bsl::unordered_set<const void*> d_entities;
+
+    /// Guards every member below
+    bslmt::Mutex d_mutex;
+    ProducerId d_nextProducerId;
+    ProducerMap d_producers;
+    bsl::unordered_map<bdlb::Guid, ProducerId> d_routes;
+
+    SharedSendChannel(const SharedSendChannel&) BSLS_KEYWORD_DELETED;
+    SharedSendChannel& operator=(const SharedSendChannel&) BSLS_KEYWORD_DELETED;
+};
+
+} // namespace rmqa
+} // namespace BloombergLP
+
+#endif
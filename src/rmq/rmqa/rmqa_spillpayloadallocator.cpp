@@ -0,0 +1,105 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_spillpayloadallocator.h>
+
+#include <ball_log.h>
+#include <bsls_platform.h>
+
+#ifdef BSLS_PLATFORM_OS_UNIX
+#include <errno.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace BloombergLP {
+namespace rmqa {
+namespace {
+
+BALL_LOG_SET_NAMESPACE_CATEGORY("RMQA.SPILLPAYLOADALLOCATOR")
+
+#ifdef BSLS_PLATFORM_OS_UNIX
+/// Unmaps a spilled body once the last message referring to it is gone
+class Unmapper {
+  public:
+    explicit Unmapper(bsl::size_t size)
+    : d_size(size)
+    {
+    }
+
+    void operator()(bsl::uint8_t* body) const { munmap(body, d_size); }
+
+  private:
+    bsl::size_t d_size;
+};
+#endif
+
+} // namespace
+
+SpillPayloadAllocator::SpillPayloadAllocator(bsl::size_t threshold,
+                                             const bsl::string& directory)
+: d_threshold(threshold)
+, d_directory(directory)
+{
+}
+
+bsl::shared_ptr<bsl::uint8_t>
+SpillPayloadAllocator::operator()(bsl::size_t bodySize) const
+{
+#ifdef BSLS_PLATFORM_OS_UNIX
+    if (bodySize <= d_threshold) {
+        return bsl::shared_ptr<bsl::uint8_t>();
+    }
+
+    bsl::string path = d_directory + "/rmqcpp-body-XXXXXX";
+    const int fd     = mkstemp(&path[0]);
+    if (fd < 0) {
+        BALL_LOG_WARN << "Cannot create a file in '" << d_directory
+                      << "' for a " << bodySize
+                      << " byte body, assembling it in memory: errno "
+                      << errno;
+        return bsl::shared_ptr<bsl::uint8_t>();
+    }
+
+    // Only the mapping refers to the file from here on
+    unlink(path.c_str());
+
+    void* body = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(bodySize)) == 0) {
+        body = mmap(0, bodySize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    const int error = errno;
+    close(fd);
+
+    if (body == MAP_FAILED) {
+        BALL_LOG_WARN << "Cannot map a file for a " << bodySize
+                      << " byte body, assembling it in memory: errno "
+                      << error;
+        return bsl::shared_ptr<bsl::uint8_t>();
+    }
+
+    BALL_LOG_DEBUG << "Spilling a " << bodySize << " byte body to '"
+                   << d_directory << "'";
+    return bsl::shared_ptr<bsl::uint8_t>(static_cast<bsl::uint8_t*>(body),
+                                         Unmapper(bodySize));
+#else
+    (void)bodySize;
+    return bsl::shared_ptr<bsl::uint8_t>();
+#endif
+}
+
+} // namespace rmqa
+} // namespace BloombergLP
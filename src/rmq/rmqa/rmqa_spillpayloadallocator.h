@@ -0,0 +1,70 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// rmqa_spillpayloadallocator.h
+#ifndef INCLUDED_RMQA_SPILLPAYLOADALLOCATOR
+#define INCLUDED_RMQA_SPILLPAYLOADALLOCATOR
+
+#include <bsl_cstddef.h>
+#include <bsl_cstdint.h>
+#include <bsl_memory.h>
+#include <bsl_string.h>
+
+//@PURPOSE: Assemble very large message bodies in memory mapped files
+//
+//@CLASSES:
+//  rmqa::SpillPayloadAllocator: payload allocator spilling large bodies
+
+namespace BloombergLP {
+namespace rmqa {
+
+/// A `rmqt::ConsumerConfig::PayloadAllocatorFunc` which assembles bodies of
+/// more than a threshold size in a temporary file mapped into memory, e.g.
+///
+/// ```
+/// consumerConfig.setPayloadAllocator(
+///     rmqa::SpillPayloadAllocator(64 * 1024 * 1024, "/var/tmp"));
+/// ```
+///
+/// The message's payload is then the mapped region, whose pages the kernel
+/// can write back to the file and drop while the message is held, so a few
+/// very large messages do not need their size in memory. The file is
+/// removed as soon as it is created, and is gone once every copy of the
+/// message is destroyed. Smaller bodies, and all bodies where the file
+/// cannot be created or on platforms without `mmap`, are assembled in
+/// memory as usual.
+class SpillPayloadAllocator {
+  public:
+    /// \param threshold Bodies of more than this many bytes are spilled
+    /// \param directory Where the temporary files are created
+    SpillPayloadAllocator(bsl::size_t threshold, const bsl::string& directory);
+
+    /// Return a buffer of `bodySize` bytes mapped from a temporary file if
+    /// `bodySize` is above the threshold, and null otherwise or on failure
+    bsl::shared_ptr<bsl::uint8_t> operator()(bsl::size_t bodySize) const;
+
+    bsl::size_t threshold() const { return d_threshold; }
+
+    const bsl::string& directory() const { return d_directory; }
+
+  private:
+    bsl::size_t d_threshold;
+    bsl::string d_directory;
+};
+
+} // namespace rmqa
+} // namespace BloombergLP
+
+#endif
@@ -0,0 +1,116 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_startupbatch.h>
+
+#include <bsls_assert.h>
+
+namespace BloombergLP {
+namespace rmqa {
+namespace {
+
+template <typename T>
+rmqt::Result<> discardValue(const rmqt::Result<T>& result)
+{
+    if (!result) {
+        return rmqt::Result<>(result.error(), result.returnCode());
+    }
+    return rmqt::Result<>();
+}
+
+template <typename T>
+rmqt::Future<> readiness(rmqt::Future<T> future)
+{
+    return future.template then<void>(&discardValue<T>);
+}
+
+} // namespace
+
+StartupBatch::StartupBatch()
+: d_producers()
+, d_consumers()
+, d_ready()
+{
+}
+
+bsl::size_t StartupBatch::addProducer(VHost& vhost,
+                                      const rmqp::Topology& topology,
+                                      rmqt::ExchangeHandle exchange,
+                                      uint16_t maxOutstandingConfirms)
+{
+    d_producers.push_back(
+        vhost.createProducerAsync(topology, exchange, maxOutstandingConfirms));
+    d_ready.push_back(readiness(d_producers.back()));
+    return d_producers.size() - 1;
+}
+
+bsl::size_t
+StartupBatch::addConsumer(VHost& vhost,
+                          const rmqp::Topology& topology,
+                          rmqt::QueueHandle queue,
+                          const rmqp::Consumer::ConsumerFunc& onMessage,
+                          const rmqt::ConsumerConfig& config)
+{
+    d_consumers.push_back(
+        vhost.createConsumerAsync(topology, queue, onMessage, config));
+    d_ready.push_back(readiness(d_consumers.back()));
+    return d_consumers.size() - 1;
+}
+
+bsl::size_t StartupBatch::addBatchConsumer(
+    VHost& vhost,
+    const rmqp::Topology& topology,
+    rmqt::QueueHandle queue,
+    const rmqp::Consumer::BatchConsumerFunc& onBatch,
+    const rmqt::ConsumerConfig& config)
+{
+    d_consumers.push_back(
+        vhost.createBatchConsumerAsync(topology, queue, onBatch, config));
+    d_ready.push_back(readiness(d_consumers.back()));
+    return d_consumers.size() - 1;
+}
+
+rmqt::Future<> StartupBatch::whenReady() const
+{
+    return rmqt::FutureUtil::whenAll(d_ready);
+}
+
+rmqt::Result<> StartupBatch::wait(const bsls::TimeInterval& timeout) const
+{
+    rmqt::Future<> ready = whenReady();
+    return timeout.totalNanoseconds() == 0 ? ready.blockResult()
+                                           : ready.waitResult(timeout);
+}
+
+rmqt::Result<Producer> StartupBatch::producer(bsl::size_t index) const
+{
+    BSLS_ASSERT(index < d_producers.size());
+
+    return d_producers[index].blockResult();
+}
+
+rmqt::Result<Consumer> StartupBatch::consumer(bsl::size_t index) const
+{
+    BSLS_ASSERT(index < d_consumers.size());
+
+    return d_consumers[index].blockResult();
+}
+
+bsl::size_t StartupBatch::numProducers() const { return d_producers.size(); }
+
+bsl::size_t StartupBatch::numConsumers() const { return d_consumers.size(); }
+
+} // namespace rmqa
+} // namespace BloombergLP
@@ -0,0 +1,130 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQA_STARTUPBATCH
+#define INCLUDED_RMQA_STARTUPBATCH
+
+#include <rmqa_consumer.h>
+#include <rmqa_producer.h>
+#include <rmqa_vhost.h>
+
+#include <rmqp_consumer.h>
+#include <rmqp_topology.h>
+#include <rmqt_consumerconfig.h>
+#include <rmqt_exchange.h>
+#include <rmqt_future.h>
+#include <rmqt_queue.h>
+#include <rmqt_result.h>
+
+#include <bsls_timeinterval.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_vector.h>
+
+//@PURPOSE: Create many producers and consumers concurrently
+//
+//@CLASSES:
+//  rmqa::StartupBatch: starts producers and consumers across vhosts at once
+
+namespace BloombergLP {
+namespace rmqa {
+
+/// \brief Creates a set of producers and consumers, across any number of
+/// vhosts, concurrently
+///
+/// Creating producers and consumers one at a time with `VHost` waits for
+/// each connection, channel and topology declaration in turn. Each producer
+/// or consumer added to a `StartupBatch` starts being created straight
+/// away, without waiting for the others, so connection handshakes, channel
+/// opens and declarations for all of them are in flight together: startup
+/// takes as long as the slowest of them rather than the sum.
+///
+/// Producers and consumers added for the same vhost share its connection,
+/// which is only established once.
+///
+/// \note Each VHost must outlive the producers and consumers created on it
+
+class StartupBatch {
+  public:
+    // CREATORS
+    StartupBatch();
+
+    // MANIPULATORS
+    /// Start creating a producer on `vhost`, as `VHost::createProducer`
+    /// does. Return the index of the producer in this batch.
+    bsl::size_t addProducer(VHost& vhost,
+                            const rmqp::Topology& topology,
+                            rmqt::ExchangeHandle exchange,
+                            uint16_t maxOutstandingConfirms);
+
+    /// Start creating a consumer on `vhost`, as `VHost::createConsumer`
+    /// does. Return the index of the consumer in this batch.
+    bsl::size_t
+    addConsumer(VHost& vhost,
+                const rmqp::Topology& topology,
+                rmqt::QueueHandle queue,
+                const rmqp::Consumer::ConsumerFunc& onMessage,
+                const rmqt::ConsumerConfig& config = rmqt::ConsumerConfig());
+
+    /// Start creating a batch consumer on `vhost`, as
+    /// `VHost::createBatchConsumer` does. Return the index of the consumer
+    /// in this batch.
+    bsl::size_t addBatchConsumer(
+        VHost& vhost,
+        const rmqp::Topology& topology,
+        rmqt::QueueHandle queue,
+        const rmqp::Consumer::BatchConsumerFunc& onBatch,
+        const rmqt::ConsumerConfig& config = rmqt::ConsumerConfig());
+
+    // ACCESSORS
+    /// Return a Future which resolves once every producer and consumer added
+    /// so far has been created, or with the first error in the order they
+    /// were added
+    rmqt::Future<> whenReady() const;
+
+    /// Wait for every producer and consumer added so far to be created, for
+    /// up to `timeout`, or without limit if `timeout` is 0. Return the first
+    /// error, in the order they were added, or a TIMEOUT result.
+    rmqt::Result<>
+    wait(const bsls::TimeInterval& timeout = bsls::TimeInterval(0)) const;
+
+    /// Return the producer added with index `index`, waiting for it to be
+    /// created if need be. The behavior is undefined unless `index` was
+    /// returned by `addProducer`.
+    rmqt::Result<Producer> producer(bsl::size_t index) const;
+
+    /// Return the consumer added with index `index`, waiting for it to be
+    /// created if need be. The behavior is undefined unless `index` was
+    /// returned by `addConsumer` or `addBatchConsumer`.
+    rmqt::Result<Consumer> consumer(bsl::size_t index) const;
+
+    /// Return the number of producers added
+    bsl::size_t numProducers() const;
+
+    /// Return the number of consumers added
+    bsl::size_t numConsumers() const;
+
+  private:
+    // Futures are mutable so that accessors can wait on them
+    mutable bsl::vector<rmqt::Future<Producer> > d_producers;
+    mutable bsl::vector<rmqt::Future<Consumer> > d_consumers;
+    mutable bsl::vector<rmqt::Future<> > d_ready;
+
+}; // class StartupBatch
+
+} // namespace rmqa
+} // namespace BloombergLP
+
+#endif
@@ -144,6 +144,11 @@ void Topology::bind(const rmqt::ExchangeHandle& sourceExchange,
     d_topology.exchangeBindings.push_back(bindingPtr);
 }
 
+void Topology::setDeclareMode(rmqt::Topology::DeclareMode mode)
+{
+    d_topology.declareMode = mode;
+}
+
 const rmqt::Topology& Topology::topology() const { return d_topology; }
 
 const rmqt::ExchangeHandle Topology::defaultExchange()
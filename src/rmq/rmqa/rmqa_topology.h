@@ -132,6 +132,15 @@ class Topology : public rmqp::Topology {
               const rmqt::FieldTable& args = rmqt::FieldTable())
         BSLS_KEYWORD_OVERRIDE;
 
+    /// \brief Choose how much of this topology is declared to the broker
+    ///
+    /// For large pre-provisioned topologies, `VERIFY_USED` only passively
+    /// declares the exchange a producer publishes to, or the queue a
+    /// consumer reads from, and fails if it is missing. `SKIP_DECLARE`
+    /// declares nothing. The default, `DECLARE_ALL`, declares every queue,
+    /// exchange and binding when each producer or consumer starts.
+    void setDeclareMode(rmqt::Topology::DeclareMode mode);
+
     /// \brief Get a readonly copy of stored topology
     ///
     /// This is used internally by `rmqamqp` to send the topology to the broker
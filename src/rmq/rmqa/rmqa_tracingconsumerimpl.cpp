@@ -23,9 +23,11 @@ namespace BloombergLP {
 namespace rmqa {
 TracingConsumerImpl::Factory::Factory(
     const bsl::shared_ptr<rmqt::Endpoint>& endpoint,
-    const bsl::shared_ptr<rmqp::ConsumerTracing>& tracing)
+    const bsl::shared_ptr<rmqp::ConsumerTracing>& tracing,
+    const bsl::shared_ptr<TracingSampler>& sampler)
 : d_endpoint(endpoint)
 , d_tracing(tracing)
+, d_sampler(sampler)
 {
 }
 
@@ -47,7 +49,7 @@ bsl::shared_ptr<ConsumerImpl> TracingConsumerImpl::Factory::create(
                          eventLoop,
                          ackQueue,
                          bsl::make_shared<rmqa::TracingMessageGuard::Factory>(
-                             queue, d_endpoint, d_tracing)));
+                             queue, d_endpoint, d_tracing, d_sampler)));
 }
 
 } // namespace rmqa
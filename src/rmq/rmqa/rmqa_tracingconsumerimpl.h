@@ -39,13 +39,18 @@ class ConsumerTracing;
 }
 
 namespace rmqa {
+class TracingSampler;
 
 class TracingConsumerImpl {
   public:
     class Factory : public rmqa::ConsumerImpl::Factory {
       public:
+        /// \param sampler decides which messages are traced, all of them if
+        ///        null
         Factory(const bsl::shared_ptr<rmqt::Endpoint>& endpoint,
-                const bsl::shared_ptr<rmqp::ConsumerTracing>& tracing);
+                const bsl::shared_ptr<rmqp::ConsumerTracing>& tracing,
+                const bsl::shared_ptr<TracingSampler>& sampler =
+                    bsl::shared_ptr<TracingSampler>());
 
         virtual bsl::shared_ptr<ConsumerImpl> create(
             const bsl::shared_ptr<rmqamqp::ReceiveChannel>& channel,
@@ -60,6 +65,7 @@ class TracingConsumerImpl {
       private:
         bsl::shared_ptr<rmqt::Endpoint> d_endpoint;
         bsl::shared_ptr<rmqp::ConsumerTracing> d_tracing;
+        bsl::shared_ptr<TracingSampler> d_sampler;
     };
 
 }; // class TracingConsumerImpl
@@ -16,6 +16,7 @@
 #include <rmqa_tracingmessageguard.h>
 
 #include <ball_log.h>
+#include <bslma_default.h>
 #include <bsl_exception.h>
 #include <bsl_memory.h>
 #include <bslmf_movableref.h>
@@ -35,10 +36,12 @@ bsl::string extractQueueName(const rmqt::QueueHandle& queueHandle)
 TracingMessageGuard::Factory::Factory(
     const rmqt::QueueHandle& queue,
     const bsl::shared_ptr<const rmqt::Endpoint>& endpoint,
-    const bsl::shared_ptr<rmqp::ConsumerTracing>& contextFactory)
+    const bsl::shared_ptr<rmqp::ConsumerTracing>& contextFactory,
+    const bsl::shared_ptr<TracingSampler>& sampler)
 : d_queueName(extractQueueName(queue))
 , d_endpoint(endpoint)
 , d_contextFactory(contextFactory)
+, d_sampler(sampler)
 {
 }
 
@@ -46,16 +49,24 @@ bslma::ManagedPtr<rmqa::MessageGuard>
 TracingMessageGuard::Factory::create(const rmqt::Message& message,
                                      const rmqt::Envelope& envelope,
                                      const MessageGuardCallback& ackCallback,
-                                     rmqp::Consumer* consumer) const
+                                     rmqp::Consumer* consumer,
+                                     bslma::Allocator* allocator) const
 {
+    if (d_sampler && !d_sampler->sampleDelivery(message.properties())) {
+        return rmqa::MessageGuard::Factory::create(
+            message, envelope, ackCallback, consumer, allocator);
+    }
+
+    allocator = bslma::Default::allocator(allocator);
     return bslma::ManagedPtr<rmqa::MessageGuard>(
-        new TracingMessageGuard(message,
-                                envelope,
-                                ackCallback,
-                                consumer,
-                                d_queueName,
-                                d_endpoint,
-                                d_contextFactory));
+        new (*allocator) TracingMessageGuard(message,
+                                             envelope,
+                                             ackCallback,
+                                             consumer,
+                                             d_queueName,
+                                             d_endpoint,
+                                             d_contextFactory),
+        allocator);
 }
 
 TracingMessageGuard::TracingMessageGuard(
@@ -17,6 +17,7 @@
 #define INCLUDED_RMQA_TRACINGMESSAGEGUARD
 
 #include <rmqa_messageguard.h>
+#include <rmqa_tracingsampler.h>
 
 #include <rmqp_consumertracing.h>
 
@@ -43,24 +44,30 @@ namespace rmqa {
 /// MessageGuard object is allowed to destruct before ack/nack is called a nack
 /// with requeue is automatically signaled to the broker.
 
-class TracingMessageGuard : public rmqa::MessageGuard {
+class TracingMessageGuard BSLS_KEYWORD_FINAL : public rmqa::MessageGuard {
   public:
     class Factory : public rmqa::MessageGuard::Factory {
       public:
+        /// \param sampler decides which messages are traced, all of them if
+        ///        null. Messages which are not get a plain MessageGuard.
         Factory(const rmqt::QueueHandle& queue,
                 const bsl::shared_ptr<const rmqt::Endpoint>& endpoint,
-                const bsl::shared_ptr<rmqp::ConsumerTracing>& contextFactory);
+                const bsl::shared_ptr<rmqp::ConsumerTracing>& contextFactory,
+                const bsl::shared_ptr<TracingSampler>& sampler =
+                    bsl::shared_ptr<TracingSampler>());
 
         virtual bslma::ManagedPtr<rmqa::MessageGuard>
         create(const rmqt::Message& message,
                const rmqt::Envelope& envelope,
                const MessageGuardCallback& ackCallback,
-               rmqp::Consumer* consumer) const BSLS_KEYWORD_OVERRIDE;
+               rmqp::Consumer* consumer,
+               bslma::Allocator* allocator = 0) const BSLS_KEYWORD_OVERRIDE;
 
       private:
         bsl::string d_queueName;
         bsl::shared_ptr<const rmqt::Endpoint> d_endpoint;
         bsl::shared_ptr<rmqp::ConsumerTracing> d_contextFactory;
+        bsl::shared_ptr<TracingSampler> d_sampler;
     };
 
     /// Transfers ownership of the message processing to a MessageGuard that is
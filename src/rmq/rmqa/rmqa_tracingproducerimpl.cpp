@@ -17,6 +17,7 @@
 
 #include <bdlf_placeholder.h>
 #include <bsl_memory.h>
+#include <bsl_vector.h>
 
 namespace BloombergLP {
 namespace rmqa {
@@ -42,9 +43,11 @@ bsl::string extractExchangeName(const rmqt::ExchangeHandle& exchangeHandle)
 
 TracingProducerImpl::Factory::Factory(
     const bsl::shared_ptr<const rmqt::Endpoint>& endpoint,
-    const bsl::shared_ptr<rmqp::ProducerTracing>& tracing)
+    const bsl::shared_ptr<rmqp::ProducerTracing>& tracing,
+    const bsl::shared_ptr<TracingSampler>& sampler)
 : d_endpoint(endpoint)
 , d_tracing(tracing)
+, d_sampler(sampler)
 {
 }
 
@@ -62,7 +65,8 @@ bsl::shared_ptr<ProducerImpl> TracingProducerImpl::Factory::create(
                                 eventLoop,
                                 extractExchangeName(exchange),
                                 d_endpoint,
-                                d_tracing));
+                                d_tracing,
+                                d_sampler));
 }
 
 TracingProducerImpl::TracingProducerImpl(
@@ -72,27 +76,44 @@ TracingProducerImpl::TracingProducerImpl(
     rmqio::EventLoop& eventLoop,
     const bsl::string& exchangeName,
     const bsl::shared_ptr<const rmqt::Endpoint>& endpoint,
-    const bsl::shared_ptr<rmqp::ProducerTracing>& tracing)
+    const bsl::shared_ptr<rmqp::ProducerTracing>& tracing,
+    const bsl::shared_ptr<TracingSampler>& sampler)
 : ProducerImpl(maxOutstandingConfirms, channel, threadPool, eventLoop)
 , d_exchangeName(exchangeName)
 , d_endpoint(endpoint)
 , d_tracing(tracing)
+, d_sampler(sampler)
 {
 }
 
+bsl::shared_ptr<rmqp::ProducerTracing::Context>
+TracingProducerImpl::createContext(rmqt::Message* message,
+                                   const bsl::string& routingKey)
+{
+    if (d_sampler) {
+        d_sampler->markSampled(&(message->properties()));
+    }
+    return d_tracing->createAndTag(
+        &(message->properties()), routingKey, d_exchangeName, d_endpoint);
+}
+
 rmqp::Producer::SendStatus TracingProducerImpl::send(
     const rmqt::Message& message,
     const bsl::string& routingKey,
     const rmqp::Producer::ConfirmationCallback& confirmCallback,
     const bsls::TimeInterval& timeout)
 {
+    if (!sampled()) {
+        return ProducerImpl::send(
+            message, routingKey, confirmCallback, timeout);
+    }
+
     rmqt::Message newMessage(message);
     // ideally we'd have move semantics on the message to avoid
     // copying the metadata note that this is not a deep copy of
     // the message payload
     bsl::shared_ptr<rmqp::ProducerTracing::Context> context =
-        d_tracing->createAndTag(
-            &(newMessage.properties()), routingKey, d_exchangeName, d_endpoint);
+        createContext(&newMessage, routingKey);
 
     return ProducerImpl::send(newMessage,
                               routingKey,
@@ -110,13 +131,16 @@ rmqp::Producer::SendStatus TracingProducerImpl::trySend(
     const bsl::string& routingKey,
     const rmqp::Producer::ConfirmationCallback& confirmCallback)
 {
+    if (!sampled()) {
+        return ProducerImpl::trySend(message, routingKey, confirmCallback);
+    }
+
     rmqt::Message newMessage(message);
     // ideally we'd have move semantics on the message to avoid
     // copying the metadata note that this is not a deep copy of
     // the message payload
     bsl::shared_ptr<rmqp::ProducerTracing::Context> context =
-        d_tracing->createAndTag(
-            &(newMessage.properties()), routingKey, d_exchangeName, d_endpoint);
+        createContext(&newMessage, routingKey);
 
     return ProducerImpl::trySend(newMessage,
                                  routingKey,
@@ -128,5 +152,53 @@ rmqp::Producer::SendStatus TracingProducerImpl::trySend(
                                                       bdlf::PlaceHolders::_3));
 }
 
+rmqp::Producer::SendStatus TracingProducerImpl::sendBatch(
+    const bsl::vector<rmqt::Message>& messages,
+    const bsl::string& routingKey,
+    const rmqp::Producer::ConfirmationCallback& confirmCallback,
+    const bsls::TimeInterval& timeout)
+{
+    // Messages are only copied once one of them is sampled, until then
+    // `callbacks` stays empty
+    bsl::vector<rmqt::Message> newMessages;
+    bsl::vector<rmqp::Producer::ConfirmationCallback> callbacks;
+
+    for (bsl::size_t i = 0; i < messages.size(); ++i) {
+        if (!sampled()) {
+            if (!callbacks.empty()) {
+                callbacks.push_back(confirmCallback);
+            }
+            continue;
+        }
+
+        if (callbacks.empty()) {
+            newMessages = messages;
+            callbacks.reserve(messages.size());
+            callbacks.assign(i, confirmCallback);
+        }
+
+        bsl::shared_ptr<rmqp::ProducerTracing::Context> context =
+            createContext(&newMessages[i], routingKey);
+
+        callbacks.push_back(bdlf::BindUtil::bind(&callbackAndContext,
+                                                 confirmCallback,
+                                                 context,
+                                                 bdlf::PlaceHolders::_1,
+                                                 bdlf::PlaceHolders::_2,
+                                                 bdlf::PlaceHolders::_3));
+    }
+
+    if (callbacks.empty()) {
+        return ProducerImpl::sendBatch(
+            messages, routingKey, confirmCallback, timeout);
+    }
+
+    return ProducerImpl::sendBatchImpl(newMessages,
+                                       routingKey,
+                                       rmqt::Mandatory::RETURN_UNROUTABLE,
+                                       callbacks,
+                                       timeout);
+}
+
 } // namespace rmqa
 } // namespace BloombergLP
@@ -17,6 +17,7 @@
 #define INCLUDED_RMQA_TRACINGPRODUCERIMPL
 
 #include <rmqa_producerimpl.h>
+#include <rmqa_tracingsampler.h>
 
 #include <rmqp_producertracing.h>
 
@@ -31,12 +32,16 @@
 namespace BloombergLP {
 namespace rmqa {
 
-class TracingProducerImpl : public ProducerImpl {
+class TracingProducerImpl BSLS_KEYWORD_FINAL : public ProducerImpl {
   public:
     class Factory : public ProducerImpl::Factory {
       public:
+        /// \param sampler decides which messages are traced, all of them if
+        ///        null
         Factory(const bsl::shared_ptr<const rmqt::Endpoint>& endpoint,
-                const bsl::shared_ptr<rmqp::ProducerTracing>& tracing);
+                const bsl::shared_ptr<rmqp::ProducerTracing>& tracing,
+                const bsl::shared_ptr<TracingSampler>& sampler =
+                    bsl::shared_ptr<TracingSampler>());
 
         virtual bsl::shared_ptr<ProducerImpl>
         create(uint16_t maxOutstandingConfirms,
@@ -48,6 +53,7 @@ class TracingProducerImpl : public ProducerImpl {
       private:
         bsl::shared_ptr<const rmqt::Endpoint> d_endpoint;
         bsl::shared_ptr<rmqp::ProducerTracing> d_tracing;
+        bsl::shared_ptr<TracingSampler> d_sampler;
     };
 
     // CREATORS
@@ -57,7 +63,9 @@ class TracingProducerImpl : public ProducerImpl {
                         rmqio::EventLoop& eventLoop,
                         const bsl::string& exchangeName,
                         const bsl::shared_ptr<const rmqt::Endpoint>& endpoint,
-                        const bsl::shared_ptr<rmqp::ProducerTracing>& tracing);
+                        const bsl::shared_ptr<rmqp::ProducerTracing>& tracing,
+                        const bsl::shared_ptr<TracingSampler>& sampler =
+                            bsl::shared_ptr<TracingSampler>());
 
     SendStatus send(const rmqt::Message& message,
                     const bsl::string& routingKey,
@@ -70,10 +78,24 @@ class TracingProducerImpl : public ProducerImpl {
             const rmqp::Producer::ConfirmationCallback& confirmCallback)
         BSLS_KEYWORD_OVERRIDE;
 
+    SendStatus
+    sendBatch(const bsl::vector<rmqt::Message>& messages,
+              const bsl::string& routingKey,
+              const rmqp::Producer::ConfirmationCallback& confirmCallback,
+              const bsls::TimeInterval& timeout) BSLS_KEYWORD_OVERRIDE;
+
   private:
+    /// Return true if the next message sent is traced
+    bool sampled() { return !d_sampler || d_sampler->sampleSend(); }
+
+    /// Create the tracing context for `message`, marking it as sampled
+    bsl::shared_ptr<rmqp::ProducerTracing::Context>
+    createContext(rmqt::Message* message, const bsl::string& routingKey);
+
     bsl::string d_exchangeName;
     bsl::shared_ptr<const rmqt::Endpoint> d_endpoint;
     bsl::shared_ptr<rmqp::ProducerTracing> d_tracing;
+    bsl::shared_ptr<TracingSampler> d_sampler;
 
 }; // class TracingProducerImpl
 
@@ -0,0 +1,97 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_tracingsampler.h>
+
+#include <rmqt_fieldvalue.h>
+
+#include <bsls_timeutil.h>
+
+#include <bsl_memory.h>
+
+namespace BloombergLP {
+namespace rmqa {
+namespace {
+
+const char k_SAMPLED_HEADER[]                    = "rmqTraceSampled";
+const bsls::Types::Int64 k_NANOSECONDS_PER_SECOND = 1000000000LL;
+
+} // namespace
+
+TracingSampler::TracingSampler(bsl::uint32_t oneIn,
+                               bsl::uint32_t maxPerSecond,
+                               bool propagate)
+: d_oneIn(oneIn ? oneIn : 1)
+, d_maxPerSecond(maxPerSecond)
+, d_propagate(propagate)
+, d_messages(0)
+, d_second(0)
+, d_sampledThisSecond(0)
+{
+}
+
+const char* TracingSampler::sampledHeader() { return k_SAMPLED_HEADER; }
+
+bool TracingSampler::sample()
+{
+    // Sample the first message, and every `d_oneIn`th after it
+    if (d_oneIn > 1 && (d_messages.addRelaxed(1) - 1) % d_oneIn != 0) {
+        return false;
+    }
+
+    if (d_maxPerSecond == 0) {
+        return true;
+    }
+
+    // Threads racing at the start of a second may each reset the count, so
+    // the limit is approximate
+    const bsls::Types::Int64 second =
+        bsls::TimeUtil::getTimer() / k_NANOSECONDS_PER_SECOND;
+    if (d_second.loadRelaxed() != second) {
+        d_second.storeRelaxed(second);
+        d_sampledThisSecond.storeRelaxed(0);
+    }
+    return d_sampledThisSecond.addRelaxed(1) <= d_maxPerSecond;
+}
+
+void TracingSampler::markSampled(rmqt::Properties* properties) const
+{
+    if (!d_propagate) {
+        return;
+    }
+
+    // The header table may be shared with the caller's message
+    bsl::shared_ptr<rmqt::FieldTable> headers =
+        properties->headers
+            ? bsl::make_shared<rmqt::FieldTable>(*properties->headers)
+            : bsl::make_shared<rmqt::FieldTable>();
+    (*headers)[k_SAMPLED_HEADER] = rmqt::FieldValue(true);
+    properties->headers          = headers;
+}
+
+bool TracingSampler::sampleDelivery(const rmqt::Properties& properties)
+{
+    if (d_propagate && properties.headers) {
+        rmqt::FieldTable::const_iterator it =
+            properties.headers->find(k_SAMPLED_HEADER);
+        if (it != properties.headers->end() && it->second.is<bool>()) {
+            return it->second.the<bool>();
+        }
+    }
+    return sample();
+}
+
+} // namespace rmqa
+} // namespace BloombergLP
@@ -0,0 +1,95 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQA_TRACINGSAMPLER
+#define INCLUDED_RMQA_TRACINGSAMPLER
+
+#include <rmqt_properties.h>
+
+#include <bsls_atomic.h>
+#include <bsls_keyword.h>
+#include <bsls_types.h>
+
+#include <bsl_cstdint.h>
+#include <bsl_string.h>
+
+//@PURPOSE: Decide which messages producer and consumer tracing sees
+//
+//@CLASSES:
+//  rmqa::TracingSampler: Head sampling for rmqp::ProducerTracing and
+//  rmqp::ConsumerTracing
+
+namespace BloombergLP {
+namespace rmqa {
+
+/// \brief Head sampling for tracing
+///
+/// Messages which are not sampled skip tracing altogether: no tracing
+/// context is created, their properties are left alone, and they are sent,
+/// confirmed and delivered as they would be with tracing disabled.
+///
+/// A message is sampled if it is one of every `oneIn` messages, and fewer
+/// than `maxPerSecond` (if non-zero) messages have been sampled in the
+/// current second. With `propagate`, producers mark the messages they sample
+/// with the `sampledHeader()` header, and consumers trace exactly those
+/// messages which carry it, applying their own decision only to messages
+/// without it, so that a trace is either kept or dropped end to end.
+///
+/// Thread safe.
+
+class TracingSampler {
+  public:
+    /// \param oneIn sample one in every `oneIn` messages, 1 samples all
+    /// \param maxPerSecond the most messages sampled in any one second, 0
+    ///        for no limit
+    /// \param propagate mark sampled messages when sending and honour the
+    ///        mark when consuming
+    TracingSampler(bsl::uint32_t oneIn,
+                   bsl::uint32_t maxPerSecond,
+                   bool propagate);
+
+    /// Decide whether a message about to be sent is traced
+    bool sampleSend() { return sample(); }
+
+    /// Mark the `properties` of a message `sampleSend` chose to trace, if
+    /// the decision is propagated
+    void markSampled(rmqt::Properties* properties) const;
+
+    /// Decide whether a delivered message with `properties` is traced
+    bool sampleDelivery(const rmqt::Properties& properties);
+
+    /// Name of the header carrying a propagated decision
+    static const char* sampledHeader();
+
+  private:
+    TracingSampler(const TracingSampler&) BSLS_KEYWORD_DELETED;
+    TracingSampler& operator=(const TracingSampler&) BSLS_KEYWORD_DELETED;
+
+    /// Apply the `oneIn` and `maxPerSecond` policy
+    bool sample();
+
+    const bsl::uint32_t d_oneIn;
+    const bsl::uint32_t d_maxPerSecond;
+    const bool d_propagate;
+
+    bsls::AtomicUint64 d_messages;
+    bsls::AtomicInt64 d_second;
+    bsls::AtomicUint d_sampledThisSecond;
+}; // class TracingSampler
+
+} // namespace rmqa
+} // namespace BloombergLP
+
+#endif // ! INCLUDED_RMQA_TRACINGSAMPLER
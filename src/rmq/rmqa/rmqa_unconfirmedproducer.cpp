@@ -0,0 +1,315 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_unconfirmedproducer.h>
+
+#include <rmqio_eventloop.h>
+#include <rmqt_log.h>
+
+#include <bdlf_bind.h>
+#include <bslmt_lockguard.h>
+#include <bsls_systemtime.h>
+
+#include <bsl_algorithm.h>
+
+namespace BloombergLP {
+namespace rmqa {
+namespace {
+
+BALL_LOG_SET_NAMESPACE_CATEGORY("RMQA.UNCONFIRMEDPRODUCER")
+
+typedef UnconfirmedProducer::SharedState SharedState;
+
+/// Return the writable callback if trySend is waiting for room and enough
+/// is now available, clearing the wait. Otherwise return an empty callback.
+/// Must be called with the mutex held
+rmqp::Producer::WritableCallback takeWritableCallback(SharedState& state)
+{
+    if (!state.writablePending || !state.writableCallback ||
+        state.maxUnwrittenMessages - state.unwritten <
+            state.writableThreshold) {
+        return rmqp::Producer::WritableCallback();
+    }
+
+    state.writablePending = false;
+    return state.writableCallback;
+}
+
+void scheduleWritableCallback(
+    bdlmt::ThreadPool& threadPool,
+    const rmqp::Producer::WritableCallback& writableCallback)
+{
+    int rc = threadPool.enqueueJob(writableCallback);
+
+    if (rc != 0) {
+        BALL_LOG_ERROR << "Couldn't enqueue thread pool job for producer "
+                          "writable callback (return code "
+                       << rc << ")";
+    }
+}
+
+/// Invoked by the channel once a message is written to the socket or
+/// dropped, either of which makes room for another
+void onPublished(const bsl::shared_ptr<SharedState>& state, bool)
+{
+    rmqp::Producer::WritableCallback writableCallback;
+    {
+        bslmt::LockGuard<bslmt::Mutex> guard(&(state->mutex));
+        --state->unwritten;
+        state->written.broadcast();
+        writableCallback = takeWritableCallback(*state);
+    }
+
+    if (writableCallback) {
+        scheduleWritableCallback(state->threadPool, writableCallback);
+    }
+}
+
+void publishBatch(
+    const bsl::shared_ptr<rmqamqp::SendChannel>& channel,
+    const bsl::vector<rmqt::Message>& messages,
+    const bsl::string& routingKey,
+    const rmqamqp::SendChannel::UnconfirmedPublishCallback& onPublished)
+{
+    for (bsl::vector<rmqt::Message>::const_iterator it = messages.begin();
+         it != messages.end();
+         ++it) {
+        channel->publishUnconfirmed(
+            *it, routingKey, rmqt::Mandatory::RETURN_UNROUTABLE, onPublished);
+    }
+}
+
+} // namespace
+
+UnconfirmedProducer::UnconfirmedProducer(
+    uint16_t maxUnwrittenMessages,
+    const bsl::shared_ptr<rmqamqp::SendChannel>& channel,
+    bdlmt::ThreadPool& threadPool,
+    rmqio::EventLoop& eventLoop)
+: d_eventLoop(eventLoop)
+, d_channel(channel)
+, d_sharedState(bsl::make_shared<SharedState>(
+      bsl::ref(threadPool), bsl::max<uint16_t>(maxUnwrittenMessages, 1)))
+, d_onPublished(bdlf::BindUtil::bind(&onPublished,
+                                     d_sharedState,
+                                     bdlf::PlaceHolders::_1))
+{
+}
+
+UnconfirmedProducer::~UnconfirmedProducer()
+{
+    {
+        bslmt::LockGuard<bslmt::Mutex> guard(&(d_sharedState->mutex));
+        d_sharedState->writableCallback = rmqp::Producer::WritableCallback();
+    }
+
+    d_eventLoop.post(
+        bdlf::BindUtil::bind(&rmqamqp::Channel::gracefulClose, d_channel));
+}
+
+rmqp::Producer::SendStatus
+UnconfirmedProducer::send(const rmqt::Message& message,
+                          const bsl::string& routingKey,
+                          const rmqp::Producer::ConfirmationCallback&,
+                          const bsls::TimeInterval& timeout)
+{
+    // Returned messages are counted as dropped, rather than silently
+    // discarded by the broker
+    return send(message,
+                routingKey,
+                rmqt::Mandatory::RETURN_UNROUTABLE,
+                rmqp::Producer::ConfirmationCallback(),
+                timeout);
+}
+
+rmqp::Producer::SendStatus
+UnconfirmedProducer::send(const rmqt::Message& message,
+                          const bsl::string& routingKey,
+                          rmqt::Mandatory::Value mandatoryFlag,
+                          const rmqp::Producer::ConfirmationCallback&,
+                          const bsls::TimeInterval& timeout)
+{
+    const rmqp::Producer::SendStatus status = reserve(1, timeout);
+    if (status == rmqp::Producer::SENDING) {
+        publish(message, routingKey, mandatoryFlag);
+    }
+    return status;
+}
+
+rmqp::Producer::SendStatus
+UnconfirmedProducer::trySend(const rmqt::Message& message,
+                             const bsl::string& routingKey,
+                             const rmqp::Producer::ConfirmationCallback&)
+{
+    {
+        bslmt::LockGuard<bslmt::Mutex> guard(&(d_sharedState->mutex));
+        if (d_sharedState->unwritten >= d_sharedState->maxUnwrittenMessages) {
+            RMQT_LOG_TRACE << "Unwritten message limit already reached";
+            d_sharedState->writablePending = true;
+            return rmqp::Producer::INFLIGHT_LIMIT;
+        }
+        ++d_sharedState->unwritten;
+    }
+
+    publish(message, routingKey, rmqt::Mandatory::RETURN_UNROUTABLE);
+    return rmqp::Producer::SENDING;
+}
+
+void UnconfirmedProducer::setWritableCallback(
+    const rmqp::Producer::WritableCallback& callback,
+    bsl::size_t minimumCredits)
+{
+    rmqp::Producer::WritableCallback writableCallback;
+    {
+        bslmt::LockGuard<bslmt::Mutex> guard(&(d_sharedState->mutex));
+        d_sharedState->writableCallback  = callback;
+        d_sharedState->writableThreshold = bsl::min<bsl::size_t>(
+            bsl::max<bsl::size_t>(minimumCredits, 1),
+            d_sharedState->maxUnwrittenMessages);
+
+        writableCallback = takeWritableCallback(*d_sharedState);
+    }
+
+    if (writableCallback) {
+        scheduleWritableCallback(d_sharedState->threadPool, writableCallback);
+    }
+}
+
+bsl::size_t UnconfirmedProducer::availableCredits() const
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&(d_sharedState->mutex));
+    return d_sharedState->maxUnwrittenMessages - d_sharedState->unwritten;
+}
+
+void UnconfirmedProducer::setWriteWeight(unsigned weight)
+{
+    d_eventLoop.post(bdlf::BindUtil::bind(
+        &rmqamqp::SendChannel::setWriteWeight, d_channel, weight));
+}
+
+rmqp::Producer::SendStatus UnconfirmedProducer::sendBatch(
+    const bsl::vector<rmqt::Message>& messages,
+    const bsl::string& routingKey,
+    const rmqp::Producer::ConfirmationCallback&,
+    const bsls::TimeInterval& timeout)
+{
+    if (messages.empty()) {
+        return rmqp::Producer::SENDING;
+    }
+
+    if (messages.size() > d_sharedState->maxUnwrittenMessages) {
+        BALL_LOG_ERROR << "Cannot send batch of " << messages.size()
+                       << " messages: larger than the unwritten message "
+                          "limit of "
+                       << d_sharedState->maxUnwrittenMessages;
+        return rmqp::Producer::INFLIGHT_LIMIT;
+    }
+
+    const rmqp::Producer::SendStatus status =
+        reserve(messages.size(), timeout);
+    if (status != rmqp::Producer::SENDING) {
+        return status;
+    }
+
+    d_eventLoop.post(bdlf::BindUtil::bind(
+        &publishBatch, d_channel, messages, routingKey, d_onPublished));
+
+    return rmqp::Producer::SENDING;
+}
+
+rmqt::Result<rmqp::MessageSink>
+UnconfirmedProducer::openStream(const rmqt::Message&,
+                                bsl::size_t,
+                                const bsl::string&,
+                                const rmqp::Producer::ConfirmationCallback&,
+                                const bsls::TimeInterval&)
+{
+    return rmqt::Result<rmqp::MessageSink>(
+        "Streamed messages need a producer with publisher confirms");
+}
+
+rmqt::Future<> UnconfirmedProducer::updateTopologyAsync(
+    const rmqt::TopologyUpdate& topologyUpdate)
+{
+    return rmqt::FutureUtil::flatten<void>(
+        d_eventLoop.postF<rmqt::Future<> >(bdlf::BindUtil::bind(
+            &rmqamqp::SendChannel::updateTopology, d_channel, topologyUpdate)));
+}
+
+rmqt::Result<>
+UnconfirmedProducer::waitForConfirms(const bsls::TimeInterval& timeout)
+{
+    const bool hasTimeout = timeout.totalNanoseconds() != 0;
+    const bsls::TimeInterval deadline =
+        bsls::SystemTime::nowRealtimeClock() + timeout;
+
+    bslmt::LockGuard<bslmt::Mutex> guard(&(d_sharedState->mutex));
+    while (d_sharedState->unwritten > 0) {
+        if (hasTimeout) {
+            if (bslmt::Condition::e_TIMED_OUT ==
+                d_sharedState->written.timedWait(&(d_sharedState->mutex),
+                                                 deadline)) {
+                return rmqt::Result<>("TIMED OUT", rmqt::TIMEOUT);
+            }
+        }
+        else {
+            d_sharedState->written.wait(&(d_sharedState->mutex));
+        }
+    }
+    return rmqt::Result<>();
+}
+
+rmqp::Producer::SendStatus
+UnconfirmedProducer::reserve(bsl::size_t count,
+                             const bsls::TimeInterval& timeout)
+{
+    const bool hasTimeout = timeout.totalNanoseconds() != 0;
+    const bsls::TimeInterval deadline =
+        bsls::SystemTime::nowRealtimeClock() + timeout;
+
+    bslmt::LockGuard<bslmt::Mutex> guard(&(d_sharedState->mutex));
+    while (d_sharedState->unwritten + count >
+           d_sharedState->maxUnwrittenMessages) {
+        if (hasTimeout) {
+            if (bslmt::Condition::e_TIMED_OUT ==
+                d_sharedState->written.timedWait(&(d_sharedState->mutex),
+                                                 deadline)) {
+                return rmqp::Producer::TIMEOUT;
+            }
+        }
+        else {
+            d_sharedState->written.wait(&(d_sharedState->mutex));
+        }
+    }
+
+    d_sharedState->unwritten += count;
+    return rmqp::Producer::SENDING;
+}
+
+void UnconfirmedProducer::publish(const rmqt::Message& message,
+                                  const bsl::string& routingKey,
+                                  rmqt::Mandatory::Value mandatory)
+{
+    d_eventLoop.post(
+        bdlf::BindUtil::bind(&rmqamqp::SendChannel::publishUnconfirmed,
+                             d_channel,
+                             message,
+                             routingKey,
+                             mandatory,
+                             d_onPublished));
+}
+
+} // namespace rmqa
+} // namespace BloombergLP
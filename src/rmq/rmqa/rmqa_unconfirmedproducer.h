@@ -0,0 +1,179 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQA_UNCONFIRMEDPRODUCER
+#define INCLUDED_RMQA_UNCONFIRMEDPRODUCER
+
+#include <rmqamqp_sendchannel.h>
+#include <rmqp_messagesink.h>
+#include <rmqp_producer.h>
+#include <rmqt_future.h>
+#include <rmqt_message.h>
+#include <rmqt_result.h>
+#include <rmqt_topologyupdate.h>
+
+#include <bdlmt_threadpool.h>
+#include <bslmt_condition.h>
+#include <bslmt_mutex.h>
+#include <bsls_keyword.h>
+#include <bsls_timeinterval.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_cstdint.h>
+#include <bsl_memory.h>
+#include <bsl_string.h>
+#include <bsl_vector.h>
+
+//@PURPOSE: Fire-and-forget producer, publishing without publisher confirms
+//
+//@CLASSES:
+//  rmqa::UnconfirmedProducer: an rmqp::Producer on a channel which is not in
+//  confirm mode
+
+namespace BloombergLP {
+namespace rmqio {
+class EventLoop;
+}
+namespace rmqa {
+
+/// \brief An rmqp::Producer for best-effort publishing, e.g. of metrics
+///
+/// The channel is never put in confirm mode, so there is no record of
+/// published messages, no delivery tag bookkeeping and no unconfirmed
+/// message limit. Confirmation callbacks are never invoked. Instead, sends
+/// are held back while `maxUnwrittenMessages` messages wait to be written
+/// to the socket, so that a slow connection pushes back on the sender.
+///
+/// Messages are dropped, and counted in the `dropped_messages` metric, if
+/// the channel is not ready (e.g. while reconnecting), if the connection is
+/// lost before they are written, or if the broker returns them. Streamed
+/// messages are not supported.
+
+class UnconfirmedProducer : public rmqp::Producer {
+  public:
+    // CREATORS
+    UnconfirmedProducer(uint16_t maxUnwrittenMessages,
+                        const bsl::shared_ptr<rmqamqp::SendChannel>& channel,
+                        bdlmt::ThreadPool& threadPool,
+                        rmqio::EventLoop& eventLoop);
+
+    ~UnconfirmedProducer() BSLS_KEYWORD_OVERRIDE;
+
+    SendStatus send(const rmqt::Message& message,
+                    const bsl::string& routingKey,
+                    const rmqp::Producer::ConfirmationCallback& confirmCallback,
+                    const bsls::TimeInterval& timeout) BSLS_KEYWORD_OVERRIDE;
+
+    SendStatus send(const rmqt::Message& message,
+                    const bsl::string& routingKey,
+                    rmqt::Mandatory::Value mandatoryFlag,
+                    const rmqp::Producer::ConfirmationCallback& confirmCallback,
+                    const bsls::TimeInterval& timeout) BSLS_KEYWORD_OVERRIDE;
+
+    SendStatus
+    trySend(const rmqt::Message& message,
+            const bsl::string& routingKey,
+            const rmqp::Producer::ConfirmationCallback& confirmCallback)
+        BSLS_KEYWORD_OVERRIDE;
+
+    void setWritableCallback(const rmqp::Producer::WritableCallback& callback,
+                             bsl::size_t minimumCredits) BSLS_KEYWORD_OVERRIDE;
+
+    bsl::size_t availableCredits() const BSLS_KEYWORD_OVERRIDE;
+
+    void setWriteWeight(unsigned weight) BSLS_KEYWORD_OVERRIDE;
+
+    SendStatus
+    sendBatch(const bsl::vector<rmqt::Message>& messages,
+              const bsl::string& routingKey,
+              const rmqp::Producer::ConfirmationCallback& confirmCallback,
+              const bsls::TimeInterval& timeout) BSLS_KEYWORD_OVERRIDE;
+
+    /// Return an error: a streamed message cannot be dropped part way
+    /// through, so streaming needs publisher confirms
+    rmqt::Result<rmqp::MessageSink>
+    openStream(const rmqt::Message& message,
+               bsl::size_t bodySize,
+               const bsl::string& routingKey,
+               const rmqp::Producer::ConfirmationCallback& confirmCallback,
+               const bsls::TimeInterval& timeout) BSLS_KEYWORD_OVERRIDE;
+
+    rmqt::Future<> updateTopologyAsync(
+        const rmqt::TopologyUpdate& topologyUpdate) BSLS_KEYWORD_OVERRIDE;
+
+    /// Wait until every message sent so far has been written to the socket
+    /// or dropped
+    rmqt::Result<>
+    waitForConfirms(const bsls::TimeInterval& timeout = bsls::TimeInterval(0))
+        BSLS_KEYWORD_OVERRIDE;
+
+    // State shared with the event loop thread. Can only be accessed when
+    // mutex is held
+    struct SharedState {
+        SharedState(bdlmt::ThreadPool& _threadPool,
+                    uint16_t _maxUnwrittenMessages)
+        : mutex()
+        , written()
+        , threadPool(_threadPool)
+        , maxUnwrittenMessages(_maxUnwrittenMessages)
+        , unwritten(0)
+        , writableCallback()
+        , writableThreshold(1)
+        , writablePending(false)
+        {
+        }
+
+        bslmt::Mutex mutex;
+
+        // Signalled whenever a message is written or dropped
+        bslmt::Condition written;
+        bdlmt::ThreadPool& threadPool;
+        const bsl::size_t maxUnwrittenMessages;
+
+        // Messages handed to the channel but not yet written or dropped
+        bsl::size_t unwritten;
+
+        // `writablePending` is set when trySend is held back, and cleared
+        // when `writableCallback` is scheduled
+        rmqp::Producer::WritableCallback writableCallback;
+        bsl::size_t writableThreshold;
+        bool writablePending;
+    };
+
+  private:
+    UnconfirmedProducer(const UnconfirmedProducer&) BSLS_KEYWORD_DELETED;
+    UnconfirmedProducer&
+    operator=(const UnconfirmedProducer&) BSLS_KEYWORD_DELETED;
+
+    /// Wait up to `timeout` (forever if 0) for room for `count` more
+    /// unwritten messages, and count them. Return TIMEOUT if there is no
+    /// room in time.
+    SendStatus reserve(bsl::size_t count, const bsls::TimeInterval& timeout);
+
+    /// Hand `message`, counted by `reserve`, to the channel
+    void publish(const rmqt::Message& message,
+                 const bsl::string& routingKey,
+                 rmqt::Mandatory::Value mandatory);
+
+    rmqio::EventLoop& d_eventLoop;
+    bsl::shared_ptr<rmqamqp::SendChannel> d_channel;
+    bsl::shared_ptr<SharedState> d_sharedState;
+    rmqamqp::SendChannel::UnconfirmedPublishCallback d_onPublished;
+}; // class UnconfirmedProducer
+
+} // namespace rmqa
+} // namespace BloombergLP
+
+#endif // ! INCLUDED_RMQA_UNCONFIRMEDPRODUCER
@@ -16,25 +16,62 @@
 #include <rmqa_vhost.h>
 
 #include <rmqa_consumer.h>
+#include <rmqa_pollingconsumer.h>
 #include <rmqa_producer.h>
+#include <rmqa_rpcclient.h>
+#include <rmqa_shardedconsumer.h>
+#include <rmqa_shardedproducer.h>
 
 #include <rmqt_future.h>
+#include <rmqt_log.h>
 #include <rmqt_properties.h>
 
 #include <bdlb_guidutil.h>
+#include <bdlf_bind.h>
+#include <bdlf_placeholder.h>
 #include <bslma_managedptr.h>
 
 #include <bsl_memory.h>
+#include <bsl_vector.h>
 
 namespace BloombergLP {
 namespace rmqa {
 namespace {
 BALL_LOG_SET_NAMESPACE_CATEGORY("RMQA.VHOST")
+
+/// Create `count` producers on `connection`, each on its own channel, and
+/// load them into `producers`
+rmqt::Result<>
+createShards(bsl::vector<bsl::shared_ptr<rmqp::Producer> >* producers,
+             rmqp::Connection& connection,
+             const rmqp::Topology& topology,
+             const rmqt::ExchangeHandle& exchange,
+             uint16_t maxOutstandingConfirms,
+             bsl::size_t count)
+{
+    // Each shard may hold the whole limit: the sharded producer enforces it
+    // across them
+    bsl::vector<rmqt::Future<rmqp::Producer> > futures;
+    for (bsl::size_t i = 0; i < count; ++i) {
+        futures.push_back(connection.createProducerAsync(
+            topology.topology(), exchange, maxOutstandingConfirms));
+    }
+
+    for (bsl::size_t i = 0; i < futures.size(); ++i) {
+        rmqt::Result<rmqp::Producer> result = futures[i].blockResult();
+        if (!result) {
+            return rmqt::Result<>(result.error(), result.returnCode());
+        }
+        producers->push_back(result.value());
+    }
+    return rmqt::Result<>();
+}
+
 } // namespace
 
 VHost::~VHost()
 {
-    BALL_LOG_TRACE << "~VHost";
+    RMQT_LOG_TRACE << "~VHost";
     close();
 }
 
@@ -50,16 +87,82 @@ bsl::string VHost::generateConsumerTag()
     return rmqt::ConsumerConfig::generateConsumerTag();
 }
 
-rmqt::Result<Producer> VHost::createProducer(const rmqp::Topology& topology,
-                                             rmqt::ExchangeHandle exchange,
-                                             uint16_t maxOutstandingConfirms)
+rmqt::Result<Producer>
+VHost::createProducer(const rmqp::Topology& topology,
+                      rmqt::ExchangeHandle exchange,
+                      uint16_t maxOutstandingConfirms,
+                      rmqt::PublisherConfirms::Value confirms)
 {
+    if (confirms == rmqt::PublisherConfirms::OFF) {
+        return rmqt::FutureUtil::convertViaManagedPtr<rmqp::Producer,
+                                                      rmqa::Producer>(
+            d_impl
+                ->createUnconfirmedProducerAsync(
+                    topology.topology(), exchange, maxOutstandingConfirms)
+                .blockResult());
+    }
     return rmqt::FutureUtil::convertViaManagedPtr<rmqp::Producer,
                                                   rmqa::Producer>(
         d_impl->createProducer(
             topology.topology(), exchange, maxOutstandingConfirms));
 }
 
+rmqt::Result<Producer>
+VHost::createShardedProducer(const rmqp::Topology& topology,
+                             rmqt::ExchangeHandle exchange,
+                             uint16_t maxOutstandingConfirms,
+                             bsl::size_t shards,
+                             bool orderByRoutingKey)
+{
+    if (shards == 0) {
+        return rmqt::Result<Producer>("A sharded producer needs a shard");
+    }
+
+    bsl::vector<bsl::shared_ptr<rmqp::Producer> > producers;
+    rmqt::Result<> created = createShards(&producers,
+                                          *d_impl,
+                                          topology,
+                                          exchange,
+                                          maxOutstandingConfirms,
+                                          shards);
+    if (!created) {
+        return rmqt::Result<Producer>(created.error(), created.returnCode());
+    }
+
+    bslma::ManagedPtr<rmqp::Producer> impl(new ShardedProducer(
+        producers, maxOutstandingConfirms, orderByRoutingKey));
+    return rmqt::Result<Producer>(
+        bsl::shared_ptr<Producer>(new Producer(impl)));
+}
+
+rmqt::Result<Producer> VHost::createPartitionedProducer(
+    const rmqp::Topology& topology,
+    rmqt::ExchangeHandle exchange,
+    uint16_t maxOutstandingConfirms,
+    const bsl::vector<bsl::string>& partitionRoutingKeys)
+{
+    if (partitionRoutingKeys.empty()) {
+        return rmqt::Result<Producer>(
+            "A partitioned producer needs a partition");
+    }
+
+    bsl::vector<bsl::shared_ptr<rmqp::Producer> > producers;
+    rmqt::Result<> created = createShards(&producers,
+                                          *d_impl,
+                                          topology,
+                                          exchange,
+                                          maxOutstandingConfirms,
+                                          partitionRoutingKeys.size());
+    if (!created) {
+        return rmqt::Result<Producer>(created.error(), created.returnCode());
+    }
+
+    bslma::ManagedPtr<rmqp::Producer> impl(new ShardedProducer(
+        producers, maxOutstandingConfirms, partitionRoutingKeys));
+    return rmqt::Result<Producer>(
+        bsl::shared_ptr<Producer>(new Producer(impl)));
+}
+
 rmqt::Result<Consumer>
 VHost::createConsumer(const rmqp::Topology& topology,
                       rmqt::QueueHandle queue,
@@ -71,6 +174,90 @@ VHost::createConsumer(const rmqp::Topology& topology,
         d_impl->createConsumer(topology.topology(), queue, onMessage, config));
 }
 
+rmqt::Result<Consumer>
+VHost::createShardedConsumer(const rmqp::Topology& topology,
+                             rmqt::QueueHandle queue,
+                             const rmqp::Consumer::ConsumerFunc& onMessage,
+                             bsl::size_t shards,
+                             const rmqt::ConsumerConfig& config)
+{
+    if (shards == 0) {
+        return rmqt::Result<Consumer>("A sharded consumer needs a shard");
+    }
+
+    bsl::vector<rmqt::Future<rmqp::Consumer> > futures;
+    for (bsl::size_t i = 0; i < shards; ++i) {
+        futures.push_back(d_impl->createConsumerAsync(
+            topology.topology(), queue, onMessage, config));
+    }
+
+    bsl::vector<bsl::shared_ptr<rmqp::Consumer> > consumers;
+    for (bsl::size_t i = 0; i < futures.size(); ++i) {
+        rmqt::Result<rmqp::Consumer> result = futures[i].blockResult();
+        if (!result) {
+            return rmqt::Result<Consumer>(result.error(), result.returnCode());
+        }
+        consumers.push_back(result.value());
+    }
+
+    bslma::ManagedPtr<rmqp::Consumer> impl(new ShardedConsumer(consumers));
+    return rmqt::Result<Consumer>(
+        bsl::shared_ptr<Consumer>(new Consumer(impl)));
+}
+
+rmqt::Result<Consumer>
+VHost::createBatchConsumer(const rmqp::Topology& topology,
+                           rmqt::QueueHandle queue,
+                           const rmqp::Consumer::BatchConsumerFunc& onBatch,
+                           const rmqt::ConsumerConfig& config)
+{
+    return rmqt::FutureUtil::convertViaManagedPtr<rmqp::Consumer,
+                                                  rmqa::Consumer>(
+        d_impl->createBatchConsumer(
+            topology.topology(), queue, onBatch, config));
+}
+
+rmqt::Result<PollingConsumer>
+VHost::createPollingConsumer(const rmqp::Topology& topology,
+                             rmqt::QueueHandle queue,
+                             const rmqt::ConsumerConfig& config)
+{
+    if (config.noAck()) {
+        return rmqt::Result<PollingConsumer>(
+            "A polling consumer needs acks, which bound its buffer");
+    }
+
+    // Taking a message into the buffer is cheap enough for the event loop
+    rmqt::ConsumerConfig pollingConfig(config);
+    pollingConfig.setDispatch(rmqt::ConsumerDispatch::EVENT_LOOP);
+
+    bsl::shared_ptr<PollingConsumer::Buffer> buffer =
+        bsl::make_shared<PollingConsumer::Buffer>();
+    rmqt::Result<Consumer> consumer =
+        createConsumer(topology,
+                       queue,
+                       bdlf::BindUtil::bind(&PollingConsumer::Buffer::push,
+                                            buffer,
+                                            bdlf::PlaceHolders::_1),
+                       pollingConfig);
+    if (!consumer) {
+        return rmqt::Result<PollingConsumer>(consumer.error(),
+                                             consumer.returnCode());
+    }
+
+    return rmqt::Result<PollingConsumer>(
+        bsl::make_shared<PollingConsumer>(consumer.value(), buffer));
+}
+
+rmqt::Result<RpcClient> VHost::createRpcClient(const rmqp::Topology& topology,
+                                               rmqt::ExchangeHandle exchange)
+{
+    return rmqt::FutureUtil::convertViaManagedPtr<rmqp::RpcClient,
+                                                  rmqa::RpcClient>(
+        d_impl->createRpcClientAsync(topology.topology(), exchange)
+            .blockResult());
+}
+
 rmqt::Result<rmqa::Consumer> VHost::createConsumer(
     const rmqp::Topology& topology,
     rmqt::QueueHandle queue,
@@ -134,6 +321,19 @@ VHost::createConsumerAsync(const rmqp::Topology& topology,
                                                     rmqa::Consumer>);
 }
 
+rmqt::Future<Consumer> VHost::createBatchConsumerAsync(
+    const rmqp::Topology& topology,
+    rmqt::QueueHandle queue,
+    const rmqp::Consumer::BatchConsumerFunc& onBatch,
+    const rmqt::ConsumerConfig& config)
+{
+    return d_impl
+        ->createBatchConsumerAsync(topology.topology(), queue, onBatch, config)
+        .then<rmqa::Consumer>(
+            &rmqt::FutureUtil::convertViaManagedPtr<rmqp::Consumer,
+                                                    rmqa::Consumer>);
+}
+
 rmqt::Future<Consumer> VHost::createConsumerAsync(
     const rmqp::Topology& topology,
     rmqt::QueueHandle queue,
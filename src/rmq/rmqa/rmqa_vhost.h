@@ -36,12 +36,15 @@
 
 #include <bsl_memory.h>
 #include <bsl_string.h>
+#include <bsl_vector.h>
 
 namespace BloombergLP {
 namespace rmqa {
 
 class Producer;
 class Consumer;
+class PollingConsumer;
+class RpcClient;
 
 /// \brief A RabbitMQ VHost object
 ///
@@ -72,14 +75,63 @@ class VHost {
     /// \param maxOutstandingConfirms The maximum number of unconfirmed
     ///        messages `Producer` will allow before blocking and waiting for a
     ///        publisher confirm from the broker.
+    /// \param confirms With `PublisherConfirms::OFF` the producer is fire and
+    ///        forget: the broker never confirms its messages, so confirm
+    ///        callbacks are never invoked, and `maxOutstandingConfirms`
+    ///        instead limits the messages not yet written to the socket.
+    ///        Messages lost with the connection, or returned by the broker,
+    ///        are only counted in the `dropped_messages` metric.
     ///
     /// \return A result which will either be a connected producer that has
     /// been registered on the Event Loop thread or an error.
     ///
     /// \note The VHost object must outlive the Producer
-    rmqt::Result<Producer> createProducer(const rmqp::Topology& topology,
-                                          rmqt::ExchangeHandle exchange,
-                                          uint16_t maxOutstandingConfirms);
+    rmqt::Result<Producer> createProducer(
+        const rmqp::Topology& topology,
+        rmqt::ExchangeHandle exchange,
+        uint16_t maxOutstandingConfirms,
+        rmqt::PublisherConfirms::Value confirms = rmqt::PublisherConfirms::ON);
+
+    /// \brief Create a producer which publishes through `shards` channels.
+    /// Behaves as `createProducer`, with publishing and confirm processing
+    /// spread across the channels, for throughput beyond what a single
+    /// channel sustains.
+    /// \param maxOutstandingConfirms The maximum number of unconfirmed
+    ///        messages across all of the channels.
+    /// \param shards How many channels to publish through.
+    /// \param orderByRoutingKey If true, messages with the same routing key
+    ///        always go through the same channel, so they keep their relative
+    ///        order. Otherwise the channels are used in turn, and messages may
+    ///        be confirmed in a different order than they were sent.
+    ///
+    /// \note Channel sharing, see
+    /// `RabbitContextOptions::setProducerChannelSharing`, would put every
+    /// shard on the same channel, so should not be combined with this.
+    rmqt::Result<Producer>
+    createShardedProducer(const rmqp::Topology& topology,
+                          rmqt::ExchangeHandle exchange,
+                          uint16_t maxOutstandingConfirms,
+                          bsl::size_t shards,
+                          bool orderByRoutingKey = true);
+
+    /// \brief Create a producer which publishes to a destination split into
+    /// partitions, such as a RabbitMQ super stream, through one channel per
+    /// partition.
+    /// The routing key passed to `send` is the message's partition key: it
+    /// is mapped onto a partition with `PartitionUtil::partitionOf`, and the
+    /// message is published with that partition's routing key.
+    /// \param partitionRoutingKeys The routing key of each partition. For a
+    ///        super stream declared with `PartitionUtil::addSuperStream`,
+    ///        these are `PartitionUtil::superStreamRoutingKeys`.
+    ///
+    /// \note A consistent hash exchange hashes the routing key itself, so a
+    /// producer to one should be created with `createShardedProducer`
+    /// instead.
+    rmqt::Result<Producer> createPartitionedProducer(
+        const rmqp::Topology& topology,
+        rmqt::ExchangeHandle exchange,
+        uint16_t maxOutstandingConfirms,
+        const bsl::vector<bsl::string>& partitionRoutingKeys);
 
     /// \brief Create an asynchronous consumer using the provided Topology.
     /// \param topology The RabbitMQ topology which will be declared on the
@@ -102,6 +154,89 @@ class VHost {
                    const rmqp::Consumer::ConsumerFunc& onMessage,
                    const rmqt::ConsumerConfig& config = rmqt::ConsumerConfig());
 
+    /// \brief Create a consumer which consumes from `queue` through `shards`
+    /// channels. Behaves as `createConsumer`, with deliveries, decoding and
+    /// acks spread across the channels, for throughput beyond what a single
+    /// channel sustains. `config` applies to each channel, so the prefetch
+    /// count is per channel.
+    ///
+    /// \note `onMessage` may be invoked concurrently for messages delivered
+    /// on different channels, and messages are not processed in queue order.
+    ///
+    /// \note Channel sharing, see
+    /// `RabbitContextOptions::setConsumerChannelSharing`, would put every
+    /// shard on the same channel, so should not be combined with this.
+    rmqt::Result<Consumer> createShardedConsumer(
+        const rmqp::Topology& topology,
+        rmqt::QueueHandle queue,
+        const rmqp::Consumer::ConsumerFunc& onMessage,
+        bsl::size_t shards,
+        const rmqt::ConsumerConfig& config = rmqt::ConsumerConfig());
+
+    /// \brief Create an asynchronous consumer which receives messages in
+    ///        batches, using the provided Topology.
+    /// \param topology The RabbitMQ topology which will be declared on the
+    ///        broker with this consumer.
+    /// \param queue The `queue` to consume from. This queue must be contained
+    ///        within `topology`.
+    /// \param onBatch The callback to be invoked with each batch of
+    ///        messages. This will be invoked from the RabbitContext
+    ///        threadpool, once per batch rather than once per message.
+    /// \param config additional options as for `createConsumer`.
+    ///        `setMaxBatchSize` and `setMaxBatchLinger` control how many
+    ///        messages are collected into a batch, and how long to wait for
+    ///        them.
+    ///
+    /// \return A result which will contain either the connected consumer
+    ///         object which has been registered on the Event Loop thread or an
+    ///         error.
+    ///
+    /// \note The VHost object must outlive the Consumer
+    rmqt::Result<Consumer> createBatchConsumer(
+        const rmqp::Topology& topology,
+        rmqt::QueueHandle queue,
+        const rmqp::Consumer::BatchConsumerFunc& onBatch,
+        const rmqt::ConsumerConfig& config = rmqt::ConsumerConfig());
+
+    /// \brief Create a consumer whose messages the application pulls with
+    ///        `PollingConsumer::poll`, rather than receiving callbacks.
+    /// \param topology The RabbitMQ topology which will be declared on the
+    ///        broker with this consumer.
+    /// \param queue The `queue` to consume from. This queue must be contained
+    ///        within `topology`.
+    /// \param config additional options as for `createConsumer`. The
+    ///        prefetch count bounds how many messages are buffered for
+    ///        polling, so should be at least the batch size polled. The
+    ///        dispatch mode is ignored, and `setNoAck` is not supported.
+    ///
+    /// \return A result which will contain either the connected consumer
+    ///         object which has been registered on the Event Loop thread or an
+    ///         error.
+    ///
+    /// \note The VHost object must outlive the PollingConsumer
+    rmqt::Result<PollingConsumer> createPollingConsumer(
+        const rmqp::Topology& topology,
+        rmqt::QueueHandle queue,
+        const rmqt::ConsumerConfig& config = rmqt::ConsumerConfig());
+
+    /// \brief Create a client which publishes requests to `exchange` and
+    ///        waits for their replies, using RabbitMQ direct reply-to.
+    /// \param topology The RabbitMQ topology declared by this client, as for
+    ///        `createProducer`.
+    /// \param exchange The exchange requests are published to. This
+    ///        exchange must be contained in `topology`.
+    ///
+    /// Requests are sent without publisher confirms, and replies are
+    /// consumed without acks: a request or reply lost with the connection
+    /// fails its call rather than being retried.
+    ///
+    /// \return A result which will contain either the client, ready for
+    ///         calls, or an error.
+    ///
+    /// \note The VHost object must outlive the RpcClient
+    rmqt::Result<RpcClient> createRpcClient(const rmqp::Topology& topology,
+                                            rmqt::ExchangeHandle exchange);
+
     /// \deprecated
     /// \brief Create an asynchronous consumer using the provided Topology.
     /// \param topology The RabbitMQ topology which will be declared on the
@@ -175,6 +310,12 @@ class VHost {
         const rmqp::Consumer::ConsumerFunc& onMessage,
         const rmqt::ConsumerConfig& config = rmqt::ConsumerConfig());
 
+    rmqt::Future<Consumer> createBatchConsumerAsync(
+        const rmqp::Topology& topology,
+        rmqt::QueueHandle queue,
+        const rmqp::Consumer::BatchConsumerFunc& onBatch,
+        const rmqt::ConsumerConfig& config = rmqt::ConsumerConfig());
+
     // DEPRECATED
     rmqt::Future<Consumer> createConsumerAsync(
         const rmqp::Topology& topology,
@@ -18,8 +18,10 @@
 #include <rmqt_exchange.h>
 #include <rmqt_topology.h>
 
+#include <bsl_algorithm.h>
 #include <bsl_cstdint.h>
 #include <bsl_memory.h>
+#include <bsl_sstream.h>
 #include <bslmt_lockguard.h>
 
 namespace BloombergLP {
@@ -35,6 +37,24 @@ proxyCreateProducerAsync(const bsl::shared_ptr<rmqp::Connection>& c,
     return c->createProducerAsync(topology, exchange, maxOutstandingConfirms);
 }
 
+rmqt::Future<rmqp::Producer> proxyCreateUnconfirmedProducerAsync(
+    const bsl::shared_ptr<rmqp::Connection>& c,
+    const rmqt::Topology& topology,
+    rmqt::ExchangeHandle exchange,
+    uint16_t maxUnwrittenMessages)
+{
+    return c->createUnconfirmedProducerAsync(
+        topology, exchange, maxUnwrittenMessages);
+}
+
+rmqt::Future<rmqp::RpcClient>
+proxyCreateRpcClientAsync(const bsl::shared_ptr<rmqp::Connection>& c,
+                          const rmqt::Topology& topology,
+                          rmqt::ExchangeHandle exchange)
+{
+    return c->createRpcClientAsync(topology, exchange);
+}
+
 rmqt::Future<rmqp::Consumer>
 proxyCreateConsumerAsync(const bsl::shared_ptr<rmqp::Connection>& c,
                          const rmqt::Topology& topology,
@@ -45,26 +65,73 @@ proxyCreateConsumerAsync(const bsl::shared_ptr<rmqp::Connection>& c,
     return c->createConsumerAsync(topology, queue, onMessage, config);
 }
 
+rmqt::Future<rmqp::Consumer> proxyCreateBatchConsumerAsync(
+    const bsl::shared_ptr<rmqp::Connection>& c,
+    const rmqt::Topology& topology,
+    rmqt::QueueHandle queue,
+    const rmqp::Consumer::BatchConsumerFunc& onBatch,
+    const rmqt::ConsumerConfig& config)
+{
+    return c->createBatchConsumerAsync(topology, queue, onBatch, config);
+}
+
 void shutdownConnectionFuture(
-    bslma::ManagedPtr<rmqt::Future<rmqp::Connection> >& connectionFuturePtr)
+    const bsl::shared_ptr<rmqt::Future<rmqp::Connection> >& connectionFuture)
 {
-    if (connectionFuturePtr) {
+    if (connectionFuture) {
         rmqt::Result<rmqp::Connection> connection =
-            connectionFuturePtr->tryResult();
+            connectionFuture->tryResult();
         if (connection) {
             connection.value()->close();
         }
-        connectionFuturePtr.reset();
     }
 }
 
+/// Owns a producer or consumer, and releases its pooled connection's
+/// channel count once it is destroyed
+template <typename T>
+class ChannelRelease {
+  public:
+    ChannelRelease(const bsl::shared_ptr<T>& owner,
+                   const bsl::shared_ptr<bsls::AtomicInt>& channels)
+    : d_owner(owner)
+    , d_channels(channels)
+    {
+    }
+
+    void operator()(T*) const { --(*d_channels); }
+
+  private:
+    bsl::shared_ptr<T> d_owner;
+    bsl::shared_ptr<bsls::AtomicInt> d_channels;
+};
+
+template <typename T>
+rmqt::Result<T> countChannel(const bsl::shared_ptr<bsls::AtomicInt>& channels,
+                             const rmqt::Result<T>& result)
+{
+    if (!result) {
+        --(*channels);
+        return result;
+    }
+    return rmqt::Result<T>(bsl::shared_ptr<T>(
+        result.value().get(), ChannelRelease<T>(result.value(), channels)));
+}
+
 } // namespace
 
-VHostImpl::VHostImpl(const ConnectionMaker& connectionMaker)
+VHostImpl::VHostImpl(const ConnectionMaker& connectionMaker,
+                     bsl::size_t poolSize)
 : d_newConnection(connectionMaker)
-, d_consumerFuture()
-, d_producerFuture()
+, d_connectionMutex()
+, d_consumerPool()
+, d_producerPool()
 {
+    // Each connection needs its own channel count, so they are not copies
+    for (bsl::size_t i = 0; i < bsl::max<bsl::size_t>(poolSize, 1); ++i) {
+        d_consumerPool.push_back(PooledConnection());
+        d_producerPool.push_back(PooledConnection());
+    }
 }
 
 rmqt::Result<rmqp::Producer>
@@ -91,22 +158,68 @@ VHostImpl::createProducerAsync(const rmqt::Topology& topology,
                                rmqt::ExchangeHandle exchange,
                                uint16_t maxOutstandingConfirms)
 {
-    {
-        bslmt::LockGuard<bslmt::Mutex> guard(&d_connectionMutex);
-        if (!d_producerFuture) {
-            d_producerFuture = bslma::ManagedPtrUtil::makeManaged<
-                rmqt::Future<rmqp::Connection> >(d_newConnection("producer"));
-        }
+    bsl::shared_ptr<bsls::AtomicInt> channels;
+    rmqt::Future<rmqp::Producer> producer =
+        placeChannel(&d_producerPool, "producer", &channels)
+            .thenFuture<rmqp::Producer>(
+                rmqt::FutureUtil::propagateError<rmqp::Connection,
+                                                 rmqp::Producer>(
+                    bdlf::BindUtil::bind(&proxyCreateProducerAsync,
+                                         bdlf::PlaceHolders::_1,
+                                         topology,
+                                         exchange,
+                                         maxOutstandingConfirms)));
+    if (!channels) {
+        return producer;
+    }
+    return producer.then<rmqp::Producer>(bdlf::BindUtil::bind(
+        &countChannel<rmqp::Producer>, channels, bdlf::PlaceHolders::_1));
+}
+
+rmqt::Future<rmqp::Producer>
+VHostImpl::createUnconfirmedProducerAsync(const rmqt::Topology& topology,
+                                          rmqt::ExchangeHandle exchange,
+                                          uint16_t maxUnwrittenMessages)
+{
+    bsl::shared_ptr<bsls::AtomicInt> channels;
+    rmqt::Future<rmqp::Producer> producer =
+        placeChannel(&d_producerPool, "producer", &channels)
+            .thenFuture<rmqp::Producer>(
+                rmqt::FutureUtil::propagateError<rmqp::Connection,
+                                                 rmqp::Producer>(
+                    bdlf::BindUtil::bind(&proxyCreateUnconfirmedProducerAsync,
+                                         bdlf::PlaceHolders::_1,
+                                         topology,
+                                         exchange,
+                                         maxUnwrittenMessages)));
+    if (!channels) {
+        return producer;
     }
-    return d_producerFuture->thenFuture<rmqp::Producer>(
-        rmqt::FutureUtil::propagateError<rmqp::Connection, rmqp::Producer>(
-            bdlf::BindUtil::bind(&proxyCreateProducerAsync,
-                                 bdlf::PlaceHolders::_1,
-                                 topology,
-                                 exchange,
-                                 maxOutstandingConfirms))
+    return producer.then<rmqp::Producer>(bdlf::BindUtil::bind(
+        &countChannel<rmqp::Producer>, channels, bdlf::PlaceHolders::_1));
+}
 
-    );
+rmqt::Future<rmqp::RpcClient>
+VHostImpl::createRpcClientAsync(const rmqt::Topology& topology,
+                                rmqt::ExchangeHandle exchange)
+{
+    // Replies are consumed, so the client's channel is placed on a consumer
+    // connection
+    bsl::shared_ptr<bsls::AtomicInt> channels;
+    rmqt::Future<rmqp::RpcClient> client =
+        placeChannel(&d_consumerPool, "consumer", &channels)
+            .thenFuture<rmqp::RpcClient>(
+                rmqt::FutureUtil::propagateError<rmqp::Connection,
+                                                 rmqp::RpcClient>(
+                    bdlf::BindUtil::bind(&proxyCreateRpcClientAsync,
+                                         bdlf::PlaceHolders::_1,
+                                         topology,
+                                         exchange)));
+    if (!channels) {
+        return client;
+    }
+    return client.then<rmqp::RpcClient>(bdlf::BindUtil::bind(
+        &countChannel<rmqp::RpcClient>, channels, bdlf::PlaceHolders::_1));
 }
 
 rmqt::Future<rmqp::Consumer>
@@ -115,27 +228,97 @@ VHostImpl::createConsumerAsync(const rmqt::Topology& topology,
                                const rmqp::Consumer::ConsumerFunc& onMessage,
                                const rmqt::ConsumerConfig& config)
 {
-    {
-        bslmt::LockGuard<bslmt::Mutex> guard(&d_connectionMutex);
-        if (!d_consumerFuture) {
-            d_consumerFuture = bslma::ManagedPtrUtil::makeManaged<
-                rmqt::Future<rmqp::Connection> >(d_newConnection("consumer"));
+    bsl::shared_ptr<bsls::AtomicInt> channels;
+    rmqt::Future<rmqp::Consumer> consumer =
+        placeChannel(&d_consumerPool, "consumer", &channels)
+            .thenFuture<rmqp::Consumer>(
+                rmqt::FutureUtil::propagateError<rmqp::Connection,
+                                                 rmqp::Consumer>(
+                    bdlf::BindUtil::bind(&proxyCreateConsumerAsync,
+                                         bdlf::PlaceHolders::_1,
+                                         topology,
+                                         queue,
+                                         onMessage,
+                                         config)));
+    if (!channels) {
+        return consumer;
+    }
+    return consumer.then<rmqp::Consumer>(bdlf::BindUtil::bind(
+        &countChannel<rmqp::Consumer>, channels, bdlf::PlaceHolders::_1));
+}
+
+rmqt::Future<rmqp::Consumer> VHostImpl::createBatchConsumerAsync(
+    const rmqt::Topology& topology,
+    rmqt::QueueHandle queue,
+    const rmqp::Consumer::BatchConsumerFunc& onBatch,
+    const rmqt::ConsumerConfig& config)
+{
+    bsl::shared_ptr<bsls::AtomicInt> channels;
+    rmqt::Future<rmqp::Consumer> consumer =
+        placeChannel(&d_consumerPool, "consumer", &channels)
+            .thenFuture<rmqp::Consumer>(
+                rmqt::FutureUtil::propagateError<rmqp::Connection,
+                                                 rmqp::Consumer>(
+                    bdlf::BindUtil::bind(&proxyCreateBatchConsumerAsync,
+                                         bdlf::PlaceHolders::_1,
+                                         topology,
+                                         queue,
+                                         onBatch,
+                                         config)));
+    if (!channels) {
+        return consumer;
+    }
+    return consumer.then<rmqp::Consumer>(bdlf::BindUtil::bind(
+        &countChannel<rmqp::Consumer>, channels, bdlf::PlaceHolders::_1));
+}
+
+rmqt::Future<rmqp::Connection>
+VHostImpl::placeChannel(ConnectionPool* pool,
+                        const bsl::string& role,
+                        bsl::shared_ptr<bsls::AtomicInt>* channels)
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_connectionMutex);
+
+    // Unopened connections count as empty, so the pool fills up before any
+    // connection carries a second channel
+    bsl::size_t chosen = 0;
+    for (bsl::size_t i = 1; i < pool->size(); ++i) {
+        if ((*pool)[i].channels->load() < (*pool)[chosen].channels->load()) {
+            chosen = i;
         }
     }
-    return d_consumerFuture->thenFuture<rmqp::Consumer>(
-        rmqt::FutureUtil::propagateError<rmqp::Connection, rmqp::Consumer>(
-            bdlf::BindUtil::bind(&proxyCreateConsumerAsync,
-                                 bdlf::PlaceHolders::_1,
-                                 topology,
-                                 queue,
-                                 onMessage,
-                                 config)));
+
+    PooledConnection& connection = (*pool)[chosen];
+    if (!connection.future) {
+        bsl::string name = role;
+        if (pool->size() > 1) {
+            bsl::ostringstream suffix;
+            suffix << role << "-" << chosen;
+            name = suffix.str();
+        }
+        connection.future = bsl::make_shared<rmqt::Future<rmqp::Connection> >(
+            d_newConnection(name));
+    }
+
+    // A single connection carries every channel, so needs no count
+    if (pool->size() > 1) {
+        ++(*connection.channels);
+        *channels = connection.channels;
+    }
+    return *connection.future;
 }
 
 void VHostImpl::close()
 {
-    shutdownConnectionFuture(d_producerFuture);
-    shutdownConnectionFuture(d_consumerFuture);
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_connectionMutex);
+    for (bsl::size_t i = 0; i < d_producerPool.size(); ++i) {
+        shutdownConnectionFuture(d_producerPool[i].future);
+        d_producerPool[i].future.reset();
+    }
+    for (bsl::size_t i = 0; i < d_consumerPool.size(); ++i) {
+        shutdownConnectionFuture(d_consumerPool[i].future);
+        d_consumerPool[i].future.reset();
+    }
 }
 } // namespace rmqa
 } // namespace BloombergLP
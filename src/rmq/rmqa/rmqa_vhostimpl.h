@@ -22,9 +22,14 @@
 #include <rmqp_producer.h>
 #include <rmqt_topology.h>
 
+#include <bsl_cstddef.h>
 #include <bsl_functional.h>
+#include <bsl_memory.h>
+#include <bsl_string.h>
+#include <bsl_vector.h>
 #include <bslma_managedptr.h>
 #include <bslmt_mutex.h>
+#include <bsls_atomic.h>
 
 namespace BloombergLP {
 namespace rmqa {
@@ -37,7 +42,10 @@ class VHostImpl : public rmqp::Connection {
         const bsl::string& suffix)>
         ConnectionMaker;
 
-    explicit VHostImpl(const ConnectionMaker& connectionMaker);
+    /// Open up to `poolSize` connections each for producers and consumers,
+    /// placing each new channel on the connection carrying the fewest
+    explicit VHostImpl(const ConnectionMaker& connectionMaker,
+                       bsl::size_t poolSize = 1);
 
     rmqt::Result<rmqp::Producer>
     createProducer(const rmqt::Topology& topology,
@@ -55,19 +63,58 @@ class VHostImpl : public rmqp::Connection {
                         rmqt::ExchangeHandle exchange,
                         uint16_t maxOutstandingConfirms) BSLS_KEYWORD_OVERRIDE;
 
+    rmqt::Future<rmqp::Producer> createUnconfirmedProducerAsync(
+        const rmqt::Topology& topology,
+        rmqt::ExchangeHandle exchange,
+        uint16_t maxUnwrittenMessages) BSLS_KEYWORD_OVERRIDE;
+
+    rmqt::Future<rmqp::RpcClient>
+    createRpcClientAsync(const rmqt::Topology& topology,
+                         rmqt::ExchangeHandle exchange) BSLS_KEYWORD_OVERRIDE;
+
     rmqt::Future<rmqp::Consumer> createConsumerAsync(
         const rmqt::Topology& topology,
         rmqt::QueueHandle queue,
         const rmqp::Consumer::ConsumerFunc& onMessage,
         const rmqt::ConsumerConfig& config) BSLS_KEYWORD_OVERRIDE;
 
+    rmqt::Future<rmqp::Consumer> createBatchConsumerAsync(
+        const rmqt::Topology& topology,
+        rmqt::QueueHandle queue,
+        const rmqp::Consumer::BatchConsumerFunc& onBatch,
+        const rmqt::ConsumerConfig& config) BSLS_KEYWORD_OVERRIDE;
+
     void close() BSLS_KEYWORD_OVERRIDE;
 
   private:
+    struct PooledConnection {
+        PooledConnection()
+        : future()
+        , channels(bsl::make_shared<bsls::AtomicInt>(0))
+        {
+        }
+
+        bsl::shared_ptr<rmqt::Future<rmqp::Connection> > future;
+
+        /// Producers or consumers open on this connection
+        bsl::shared_ptr<bsls::AtomicInt> channels;
+    };
+
+    typedef bsl::vector<PooledConnection> ConnectionPool;
+
+    /// Return the connection of `pool` carrying the fewest channels, opening
+    /// it if needed, and count the channel about to be opened on it. Load
+    /// `channels` with the count to release once that channel is destroyed,
+    /// or leave it empty if `pool` has a single connection.
+    rmqt::Future<rmqp::Connection>
+    placeChannel(ConnectionPool* pool,
+                 const bsl::string& role,
+                 bsl::shared_ptr<bsls::AtomicInt>* channels);
+
     ConnectionMaker d_newConnection;
     bslmt::Mutex d_connectionMutex;
-    bslma::ManagedPtr<rmqt::Future<rmqp::Connection> > d_consumerFuture;
-    bslma::ManagedPtr<rmqt::Future<rmqp::Connection> > d_producerFuture;
+    ConnectionPool d_consumerPool;
+    ConnectionPool d_producerPool;
 
   private:
     VHostImpl(const VHostImpl&) BSLS_KEYWORD_DELETED;
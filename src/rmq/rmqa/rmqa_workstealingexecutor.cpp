@@ -0,0 +1,414 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_workstealingexecutor.h>
+
+#include <ball_log.h>
+#include <bdlf_bind.h>
+#include <bslmt_lockguard.h>
+#include <bsls_platform.h>
+#include <bsls_timeutil.h>
+
+#include <bsl_algorithm.h>
+
+#ifdef BSLS_PLATFORM_OS_UNIX
+#include <time.h>
+#endif
+
+namespace BloombergLP {
+namespace rmqa {
+namespace {
+BALL_LOG_SET_NAMESPACE_CATEGORY("RMQA.WORKSTEALINGEXECUTOR")
+
+/// Turns a worker takes between checks of the shared queue ahead of its
+/// own deque
+const bsl::size_t k_SHARED_CHECK_INTERVAL = 31;
+
+/// Return the CPU time of the calling thread, or zero if unavailable
+bsls::Types::Int64 threadCpuNanoseconds()
+{
+#ifdef BSLS_PLATFORM_OS_UNIX
+    timespec now;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now) != 0) {
+        return 0;
+    }
+    return static_cast<bsls::Types::Int64>(now.tv_sec) * 1000 * 1000 * 1000 +
+           now.tv_nsec;
+#else
+    return 0;
+#endif
+}
+
+} // namespace
+
+WorkStealingExecutor::Lane::Lane(bsl::size_t maxParallel)
+: d_mutex()
+, d_jobs()
+, d_turns(0)
+, d_maxParallel(bsl::max(maxParallel, bsl::size_t(1)))
+{
+}
+
+WorkStealingExecutor::WorkStealingExecutor(
+    const bslmt::ThreadAttributes& attributes,
+    bsl::size_t numWorkers,
+    bsl::size_t quota,
+    bsl::size_t maxWorkers)
+: d_attributes(attributes)
+, d_quota(bsl::max(quota, bsl::size_t(1)))
+, d_workers()
+, d_target(static_cast<int>(bsl::max(numWorkers, bsl::size_t(1))))
+, d_workerKey()
+, d_mutex()
+, d_condition()
+, d_shared()
+, d_running(false)
+, d_stopping(false)
+, d_pending(0)
+, d_sleeping(0)
+, d_busy(0)
+, d_queuedJobs(0)
+, d_jobsRun(0)
+, d_runNanoseconds(0)
+, d_cpuNanoseconds(0)
+{
+    const bsl::size_t slots =
+        bsl::max(maxWorkers, static_cast<bsl::size_t>(d_target.load()));
+    for (bsl::size_t i = 0; i < slots; ++i) {
+        bsl::shared_ptr<Worker> worker = bsl::make_shared<Worker>();
+        worker->alive    = false;
+        worker->joinable = false;
+        d_workers.push_back(worker);
+    }
+    bslmt::ThreadUtil::createKey(&d_workerKey, 0);
+}
+
+WorkStealingExecutor::~WorkStealingExecutor()
+{
+    stop();
+    bslmt::ThreadUtil::deleteKey(d_workerKey);
+}
+
+int WorkStealingExecutor::start()
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    d_running  = true;
+    d_stopping = false;
+
+    for (bsl::size_t i = 0; i < numWorkers(); ++i) {
+        const int rc = startWorker(i);
+        if (rc) {
+            d_stopping = true;
+            d_condition.broadcast();
+            guard.release()->unlock();
+
+            for (bsl::size_t j = 0; j < i; ++j) {
+                bslmt::ThreadUtil::join(d_workers[j]->handle);
+                d_workers[j]->joinable = false;
+            }
+            bslmt::LockGuard<bslmt::Mutex> stopped(&d_mutex);
+            d_running = false;
+            return rc;
+        }
+    }
+    return 0;
+}
+
+void WorkStealingExecutor::stop()
+{
+    {
+        bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+        if (!d_running || d_stopping) {
+            return;
+        }
+        d_stopping = true;
+        d_condition.broadcast();
+    }
+
+    // No worker starts once stopping, so the slots can be read unlocked
+    for (bsl::size_t i = 0; i < d_workers.size(); ++i) {
+        if (d_workers[i]->joinable) {
+            bslmt::ThreadUtil::join(d_workers[i]->handle);
+            d_workers[i]->joinable = false;
+        }
+    }
+
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    d_running = false;
+}
+
+int WorkStealingExecutor::resize(bsl::size_t numWorkers)
+{
+    numWorkers = bsl::min(bsl::max(numWorkers, bsl::size_t(1)),
+                          d_workers.size());
+
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    d_target.store(static_cast<int>(numWorkers));
+
+    int rc = 0;
+    if (d_running && !d_stopping) {
+        for (bsl::size_t i = 0; i < numWorkers && rc == 0; ++i) {
+            rc = startWorker(i);
+        }
+    }
+    // Wakes surplus workers to retire
+    d_condition.broadcast();
+    return rc;
+}
+
+int WorkStealingExecutor::startWorker(bsl::size_t index)
+{
+    Worker& worker = *d_workers[index];
+    if (worker.alive) {
+        return 0;
+    }
+    if (worker.joinable) {
+        // It marked itself exited under the mutex, and does no more after
+        bslmt::ThreadUtil::join(worker.handle);
+        worker.joinable = false;
+    }
+
+    bslmt::ThreadAttributes attributes(d_attributes);
+    attributes.setDetachedState(bslmt::ThreadAttributes::e_CREATE_JOINABLE);
+
+    const int rc = bslmt::ThreadUtil::create(
+        &worker.handle,
+        attributes,
+        bdlf::BindUtil::bind(&WorkStealingExecutor::runWorker, this, index));
+    if (rc) {
+        BALL_LOG_ERROR << "Couldn't start work-stealing worker thread "
+                       << index << ". Error code: " << rc;
+        return rc;
+    }
+    worker.alive    = true;
+    worker.joinable = true;
+    return 0;
+}
+
+bsl::shared_ptr<WorkStealingExecutor::Lane>
+WorkStealingExecutor::createLane(bsl::size_t maxParallel) const
+{
+    return bsl::make_shared<Lane>(maxParallel);
+}
+
+int WorkStealingExecutor::submit(const bsl::shared_ptr<Lane>& lane,
+                                 const Job& job)
+{
+    {
+        bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+        if (!d_running || d_stopping) {
+            return 1;
+        }
+    }
+
+    bool schedule = false;
+    {
+        bslmt::LockGuard<bslmt::Mutex> guard(&lane->d_mutex);
+        lane->d_jobs.push_back(job);
+        d_queuedJobs.add(1);
+        // Running turns find the job once they finish their current one
+        if (lane->d_turns < lane->d_maxParallel &&
+            lane->d_turns < lane->d_jobs.size()) {
+            ++lane->d_turns;
+            schedule = true;
+        }
+    }
+
+    if (schedule) {
+        scheduleTurn(lane, false);
+    }
+    return 0;
+}
+
+WorkStealingExecutor::Stats WorkStealingExecutor::stats() const
+{
+    Stats stats;
+    stats.workers        = numWorkers();
+    stats.busyWorkers    = static_cast<bsl::size_t>(d_busy.load());
+    stats.queuedJobs     = d_queuedJobs.load();
+    stats.jobsRun        = d_jobsRun.load();
+    stats.runNanoseconds = d_runNanoseconds.load();
+    stats.cpuNanoseconds = d_cpuNanoseconds.load();
+    return stats;
+}
+
+void WorkStealingExecutor::scheduleTurn(const bsl::shared_ptr<Lane>& lane,
+                                        bool yield)
+{
+    // Counted first, so a worker finding nothing to take keeps looking
+    // rather than sleeping through the turn
+    d_pending.add(1);
+
+    Worker* self = static_cast<Worker*>(
+        bslmt::ThreadUtil::getSpecific(d_workerKey));
+    if (self && !yield) {
+        bslmt::LockGuard<bslmt::Mutex> guard(&self->mutex);
+        self->turns.push_back(lane);
+    }
+    else {
+        bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+        d_shared.push_back(lane);
+    }
+
+    if (d_sleeping.load() != 0) {
+        bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+        d_condition.signal();
+    }
+}
+
+void WorkStealingExecutor::runWorker(bsl::size_t index)
+{
+    bslmt::ThreadUtil::setSpecific(d_workerKey, d_workers[index].get());
+
+    for (bsl::size_t taken = 0;; ++taken) {
+        bsl::shared_ptr<Lane> lane = takeTurn(index, taken);
+        if (!lane) {
+            return;
+        }
+        runTurn(lane);
+    }
+}
+
+void WorkStealingExecutor::retireWorker(bsl::size_t index)
+{
+    Worker& worker = *d_workers[index];
+
+    bsl::deque<bsl::shared_ptr<Lane> > turns;
+    {
+        bslmt::LockGuard<bslmt::Mutex> guard(&worker.mutex);
+        turns.swap(worker.turns);
+    }
+
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    d_shared.insert(d_shared.end(), turns.begin(), turns.end());
+    worker.alive = false;
+    if (!turns.empty()) {
+        d_condition.broadcast();
+    }
+}
+
+bsl::shared_ptr<WorkStealingExecutor::Lane>
+WorkStealingExecutor::takeTurn(bsl::size_t index, bsl::size_t taken)
+{
+    Worker& worker = *d_workers[index];
+
+    for (;;) {
+        if (index >= numWorkers()) {
+            retireWorker(index);
+            return bsl::shared_ptr<Lane>();
+        }
+
+        bsl::shared_ptr<Lane> lane;
+        if (taken % k_SHARED_CHECK_INTERVAL == 0) {
+            lane = popShared();
+        }
+        if (!lane) {
+            bslmt::LockGuard<bslmt::Mutex> guard(&worker.mutex);
+            if (!worker.turns.empty()) {
+                lane = worker.turns.back();
+                worker.turns.pop_back();
+            }
+        }
+        if (!lane) {
+            lane = popShared();
+        }
+        if (!lane) {
+            lane = steal(index);
+        }
+        if (lane) {
+            d_pending.add(-1);
+            return lane;
+        }
+
+        bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+        d_sleeping.add(1);
+        while (d_pending.load() <= 0 && !d_stopping &&
+               index < numWorkers()) {
+            d_condition.wait(&d_mutex);
+        }
+        d_sleeping.add(-1);
+        if (d_pending.load() <= 0 && d_stopping) {
+            worker.alive = false;
+            return bsl::shared_ptr<Lane>();
+        }
+    }
+}
+
+bsl::shared_ptr<WorkStealingExecutor::Lane> WorkStealingExecutor::popShared()
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    if (d_shared.empty()) {
+        return bsl::shared_ptr<Lane>();
+    }
+    bsl::shared_ptr<Lane> lane = d_shared.front();
+    d_shared.pop_front();
+    return lane;
+}
+
+bsl::shared_ptr<WorkStealingExecutor::Lane>
+WorkStealingExecutor::steal(bsl::size_t thief)
+{
+    for (bsl::size_t i = 1; i < d_workers.size(); ++i) {
+        Worker& victim = *d_workers[(thief + i) % d_workers.size()];
+
+        bslmt::LockGuard<bslmt::Mutex> guard(&victim.mutex);
+        if (!victim.turns.empty()) {
+            bsl::shared_ptr<Lane> lane = victim.turns.front();
+            victim.turns.pop_front();
+            return lane;
+        }
+    }
+    return bsl::shared_ptr<Lane>();
+}
+
+void WorkStealingExecutor::runTurn(const bsl::shared_ptr<Lane>& lane)
+{
+    d_busy.add(1);
+    const bsls::Types::Int64 start    = bsls::TimeUtil::getTimer();
+    const bsls::Types::Int64 cpuStart = threadCpuNanoseconds();
+
+    bool yield = false;
+    for (bsl::size_t ran = 0;; ++ran) {
+        Job job;
+        {
+            bslmt::LockGuard<bslmt::Mutex> guard(&lane->d_mutex);
+            if (lane->d_jobs.empty()) {
+                --lane->d_turns;
+                break;
+            }
+            if (ran == d_quota) {
+                yield = true;
+                break;
+            }
+            job = lane->d_jobs.front();
+            lane->d_jobs.pop_front();
+            d_queuedJobs.add(-1);
+        }
+        job();
+        d_jobsRun.add(1);
+    }
+
+    d_runNanoseconds.add(bsls::TimeUtil::getTimer() - start);
+    d_cpuNanoseconds.add(threadCpuNanoseconds() - cpuStart);
+    d_busy.add(-1);
+
+    if (yield) {
+        // Still counted in `d_turns`: other lanes' turns go first
+        scheduleTurn(lane, true);
+    }
+}
+
+} // namespace rmqa
+} // namespace BloombergLP
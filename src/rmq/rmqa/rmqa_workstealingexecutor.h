@@ -0,0 +1,219 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQA_WORKSTEALINGEXECUTOR
+#define INCLUDED_RMQA_WORKSTEALINGEXECUTOR
+
+#include <bslmt_condition.h>
+#include <bslmt_mutex.h>
+#include <bslmt_threadattributes.h>
+#include <bslmt_threadutil.h>
+#include <bsls_atomic.h>
+#include <bsls_keyword.h>
+#include <bsls_types.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_deque.h>
+#include <bsl_functional.h>
+#include <bsl_memory.h>
+#include <bsl_vector.h>
+
+//@PURPOSE: Run the jobs of many consumers fairly on work-stealing workers
+//
+//@CLASSES:
+//  rmqa::WorkStealingExecutor: worker threads taking turns across lanes
+
+namespace BloombergLP {
+namespace rmqa {
+
+/// \brief Runs jobs from many lanes, e.g. one per consumer, on a set of
+/// worker threads
+///
+/// Jobs are queued on their lane. A lane with queued jobs is scheduled as a
+/// turn, and a worker taking the turn runs up to `quota` of the lane's jobs
+/// before sending the turn to the back of the shared queue. A burst on one
+/// lane therefore delays the jobs of another by at most `quota` jobs per
+/// worker, where a single FIFO would put the whole burst ahead of them.
+///
+/// Turns scheduled from outside the workers, e.g. by an event loop, go on
+/// the shared FIFO queue. Turns scheduled by a worker go on its own deque,
+/// which it takes from newest first, while its data is still in cache, and
+/// which idle workers steal from oldest first. Workers check the shared
+/// queue first every few turns, so it is never starved by local work.
+///
+/// A lane runs up to `maxParallel` turns at once, and never more turns than
+/// it has jobs, so jobs of a lane run concurrently and out of order unless
+/// `maxParallel` is 1.
+///
+/// The number of workers may be changed with `resize`, up to the maximum
+/// given at construction, e.g. by an `ExecutorScaler`. Surplus workers
+/// retire once they finish their current turn.
+
+class WorkStealingExecutor {
+  public:
+    typedef bsl::function<void()> Job;
+
+    /// The jobs of one submitter, see `createLane`
+    class Lane {
+      public:
+        explicit Lane(bsl::size_t maxParallel);
+
+      private:
+        Lane(const Lane&) BSLS_KEYWORD_DELETED;
+        Lane& operator=(const Lane&) BSLS_KEYWORD_DELETED;
+
+        friend class WorkStealingExecutor;
+
+        bslmt::Mutex d_mutex;
+        bsl::deque<Job> d_jobs;
+        /// Turns scheduled or running, guarded by `d_mutex`
+        bsl::size_t d_turns;
+        const bsl::size_t d_maxParallel;
+    };
+
+    /// Activity since the executor was created, see `stats`
+    struct Stats {
+        /// Workers wanted, see `resize`
+        bsl::size_t workers;
+        /// Workers running a turn
+        bsl::size_t busyWorkers;
+        /// Jobs submitted and not yet started
+        bsls::Types::Int64 queuedJobs;
+        bsls::Types::Int64 jobsRun;
+        /// Wall-clock and thread CPU time spent running jobs. CPU time is
+        /// zero on platforms which cannot measure it.
+        bsls::Types::Int64 runNanoseconds;
+        bsls::Types::Int64 cpuNanoseconds;
+    };
+
+    /// \param attributes Of the worker threads
+    /// \param numWorkers Number of worker threads, at least one
+    /// \param quota Jobs a turn runs before yielding to other lanes, at
+    ///        least one
+    /// \param maxWorkers Most workers `resize` may ask for. Defaults to
+    ///        `numWorkers`.
+    WorkStealingExecutor(const bslmt::ThreadAttributes& attributes,
+                         bsl::size_t numWorkers,
+                         bsl::size_t quota,
+                         bsl::size_t maxWorkers = 0);
+
+    /// Stops the workers, see `stop`
+    ~WorkStealingExecutor();
+
+    /// Start the worker threads. Return 0 on success, or non-zero if a
+    /// thread could not be created, in which case none are left running.
+    int start();
+
+    /// Run every job already queued, then join the worker threads. Jobs
+    /// submitted afterwards are refused.
+    void stop();
+
+    /// Return a lane whose jobs run up to `maxParallel` at a time (at least
+    /// one)
+    bsl::shared_ptr<Lane> createLane(bsl::size_t maxParallel) const;
+
+    /// Queue `job` on `lane`, scheduling a turn if the lane can run more.
+    /// May be called from any thread. Return 0 on success, or non-zero if
+    /// the executor is not running, in which case `job` is discarded.
+    int submit(const bsl::shared_ptr<Lane>& lane, const Job& job);
+
+    /// Run `numWorkers` workers, between one and `maxWorkers()`, starting
+    /// any missing ones now. Workers beyond that retire after their
+    /// current turn. Return 0 on success, or non-zero if a thread could not
+    /// be created, in which case fewer workers run.
+    int resize(bsl::size_t numWorkers);
+
+    /// Workers wanted, see `resize`
+    bsl::size_t numWorkers() const
+    {
+        return static_cast<bsl::size_t>(d_target.load());
+    }
+
+    bsl::size_t maxWorkers() const { return d_workers.size(); }
+
+    Stats stats() const;
+
+  private:
+    WorkStealingExecutor(const WorkStealingExecutor&) BSLS_KEYWORD_DELETED;
+    WorkStealingExecutor&
+    operator=(const WorkStealingExecutor&) BSLS_KEYWORD_DELETED;
+
+    struct Worker {
+        bslmt::Mutex mutex;
+        /// Turns this worker scheduled, taken from the back by it and from
+        /// the front by thieves
+        bsl::deque<bsl::shared_ptr<Lane> > turns;
+        bslmt::ThreadUtil::Handle handle;
+        /// Guarded by the executor's `d_mutex`
+        bool alive;
+        bool joinable;
+    };
+
+    /// Start the worker in slot `index` if it is not running, reaping its
+    /// previous thread. Called with `d_mutex` held.
+    int startWorker(bsl::size_t index);
+
+    /// Mark the calling worker `index` as exited, handing its own turns to
+    /// the other workers
+    void retireWorker(bsl::size_t index);
+
+    /// Queue a turn of `lane`: on the calling worker's deque, unless
+    /// `yield`, or the caller is not a worker of this executor
+    void scheduleTurn(const bsl::shared_ptr<Lane>& lane, bool yield);
+
+    void runWorker(bsl::size_t index);
+
+    /// Return the next turn for worker `index`, waiting for one, or a null
+    /// pointer once stopped with none left
+    bsl::shared_ptr<Lane> takeTurn(bsl::size_t index, bsl::size_t taken);
+
+    bsl::shared_ptr<Lane> popShared();
+
+    bsl::shared_ptr<Lane> steal(bsl::size_t thief);
+
+    void runTurn(const bsl::shared_ptr<Lane>& lane);
+
+    const bslmt::ThreadAttributes d_attributes;
+    const bsl::size_t d_quota;
+    /// One slot per potential worker, `maxWorkers` of them
+    bsl::vector<bsl::shared_ptr<Worker> > d_workers;
+    /// Workers in slots from this index retire
+    bsls::AtomicInt d_target;
+    /// Identifies the `Worker` of the calling thread
+    bslmt::ThreadUtil::Key d_workerKey;
+
+    /// Guards `d_shared`, `d_running` and `d_stopping`, and the sleep of
+    /// idle workers on `d_condition`
+    bslmt::Mutex d_mutex;
+    bslmt::Condition d_condition;
+    bsl::deque<bsl::shared_ptr<Lane> > d_shared;
+    bool d_running;
+    bool d_stopping;
+
+    /// Turns scheduled and not yet taken
+    bsls::AtomicInt d_pending;
+    bsls::AtomicInt d_sleeping;
+
+    bsls::AtomicInt d_busy;
+    bsls::AtomicInt64 d_queuedJobs;
+    bsls::AtomicInt64 d_jobsRun;
+    bsls::AtomicInt64 d_runNanoseconds;
+    bsls::AtomicInt64 d_cpuNanoseconds;
+}; // class WorkStealingExecutor
+
+} // namespace rmqa
+} // namespace BloombergLP
+
+#endif
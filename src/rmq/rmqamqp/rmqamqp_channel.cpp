@@ -18,6 +18,7 @@
 #include <rmqamqp_framer.h>
 #include <rmqamqp_metrics.h>
 #include <rmqamqp_topologymerger.h>
+#include <rmqamqp_topologystore.h>
 #include <rmqamqpt_channelclose.h>
 #include <rmqamqpt_channelcloseok.h>
 #include <rmqamqpt_channelflow.h>
@@ -29,9 +30,12 @@
 #include <rmqamqpt_queuemethod.h>
 #include <rmqp_metricpublisher.h>
 
+#include <rmqt_log.h>
+
 #include <ball_log.h>
 #include <bdlf_bind.h>
 #include <bdlt_currenttime.h>
+#include <bsls_systemtime.h>
 
 #include <bsl_memory.h>
 #include <bsl_string.h>
@@ -53,9 +57,45 @@ void callBothMakers(const rmqt::Future<>::Maker& maker1,
     maker1(res);
     maker2(res);
 }
+
+/// Load into `sentinel` a passive declaration of the first queue, or else
+/// the first exchange, of `topology`. Return false if there is neither.
+bool makeSentinel(rmqt::Topology* sentinel, const rmqt::Topology& topology)
+{
+    if (!topology.queues.empty()) {
+        const rmqt::Queue& queue = *topology.queues.front();
+        sentinel->queues.push_back(
+            bsl::make_shared<rmqt::Queue>(queue.name(),
+                                          true,
+                                          queue.autoDelete(),
+                                          queue.durable(),
+                                          queue.arguments()));
+        return true;
+    }
+    for (rmqt::Topology::ExchangeVec::const_iterator it =
+             topology.exchanges.begin();
+         it != topology.exchanges.end();
+         ++it) {
+        const rmqt::Exchange& exchange = **it;
+        if (exchange.isDefault()) {
+            continue;
+        }
+        sentinel->exchanges.push_back(bsl::make_shared<rmqt::Exchange>(
+            exchange.name(),
+            true,
+            rmqt::ExchangeType(exchange.type()),
+            exchange.autoDelete(),
+            exchange.durable(),
+            exchange.internal(),
+            exchange.arguments()));
+        return true;
+    }
+    return false;
+}
 } // namespace
 
 const int Channel::k_HUNG_CHANNEL_TIMER_SEC = 60;
+const bsl::size_t Channel::k_MAX_PIPELINED_UPDATES = 64;
 
 Channel::Channel(const rmqt::Topology& topology,
                  const AsyncWriteCallback& onAsyncWrite,
@@ -71,17 +111,31 @@ Channel::Channel(const rmqt::Topology& topology,
       1,
       bsl::pair<bsl::string, bsl::string>(Metrics::VHOST_TAG, d_vhostName))
 , d_vhostAndChannelTags()
+, d_pipelineTiming(metricPublisher, d_vhostTags)
 , d_hungProgressTimer(hungProgressTimer)
 , d_state(CLOSED)
 , d_topology(topology)
+, d_topologyMerger(&d_topology)
 , d_topologyTransformer()
 , d_updateQueue()
+, d_sentUpdates()
 , d_onAsyncWrite(onAsyncWrite)
+, d_onAsyncBatchWrite()
+, d_topologyCache()
+, d_topologyStore()
 , d_retryHandler(retryHandler)
 , d_permanentlyClosing(false)
 , d_declareTopologyStartTime()
+, d_topologyDeclareTime()
+, d_channelMetricsRun(bsls::SystemTime::nowMonotonicClock())
+, d_channelMetricsStats()
+, d_topologyConfirmed(false)
 , d_readyMade()
 , d_connErrorCb(connErrorCb)
+, d_pipelinedOpen(false)
+, d_setupPipelined(false)
+, d_checkingSentinel(false)
+, d_pipelinedTopology()
 {
 }
 
@@ -144,6 +198,12 @@ class Channel::ChannelMethodProcessor {
     {
         BALL_LOG_INFO << "Received ChannelClose from server: " << closeMethod;
 
+        if (d_channel.d_checkingSentinel) {
+            // The stored topology is gone from the broker, declare it again
+            d_channel.d_checkingSentinel = false;
+            d_channel.d_topologyStore->forget(d_channel.d_topology);
+        }
+
         rmqamqpt::ChannelCloseOk closeOkMethod;
         d_channel.writeMessage(
             Message(rmqamqpt::Method(rmqamqpt::ChannelMethod(closeOkMethod))),
@@ -205,6 +265,7 @@ void Channel::processTopologyMethod(const rmqamqpt::Method& method)
                 rmqt::Result<>("Error occurred, while declaring topology"));
         }
         d_topologyTransformer.first.reset();
+        d_sentUpdates.clear();
         return;
     }
 
@@ -232,6 +293,7 @@ void Channel::processTopologyMethod(const rmqamqpt::Method& method)
                 rmqt::Result<>("Error occurred, while declaring topology"));
         }
         d_topologyTransformer.first.reset();
+        d_sentUpdates.clear();
         return;
     }
 
@@ -247,13 +309,26 @@ void Channel::processTopologyMethod(const rmqamqpt::Method& method)
                        "support.";
                 return;
             }
-            TopologyMerger::merge(d_topology, d_updateQueue.front().first);
-            d_updateQueue.pop();
-        }
-        if (d_topologyTransformer.second) {
-            d_topologyTransformer.second(rmqt::Result<>());
+            if (d_topologyCache) {
+                d_topologyCache->recordUpdate(d_updateQueue.front().first);
+            }
+            d_topologyMerger.apply(d_updateQueue.front().first);
+            d_updateQueue.pop_front();
+            if (!d_sentUpdates.empty()) {
+                d_sentUpdates.pop_front();
+            }
         }
+        const TopologyUpdateConfirmCallback callback =
+            d_topologyTransformer.second;
         d_topologyTransformer.first.reset();
+        if (!d_sentUpdates.empty()) {
+            // The next pipelined update's replies follow
+            d_topologyTransformer = bsl::make_pair(
+                d_sentUpdates.front(), d_updateQueue.front().second);
+        }
+        if (callback) {
+            callback(rmqt::Result<>());
+        }
         // kick off outstanding updates if there are any
         sendNextUpdate();
     }
@@ -261,36 +336,40 @@ void Channel::processTopologyMethod(const rmqamqpt::Method& method)
 
 void Channel::sendNextUpdate()
 {
-    if (d_updateQueue.empty()) {
-        return;
-    }
-    bsl::shared_ptr<TopologyTransformer> topologyTransformer;
-    do {
-        topologyTransformer =
-            bsl::make_shared<TopologyTransformer>(d_updateQueue.front().first);
+    // Replies come back in the order the methods were written, so each is
+    // matched against the oldest update still awaiting them
+    while (d_sentUpdates.size() < d_updateQueue.size() &&
+           d_sentUpdates.size() < k_MAX_PIPELINED_UPDATES) {
+        UpdateQueue::iterator next =
+            d_updateQueue.begin() + d_sentUpdates.size();
+        bsl::shared_ptr<TopologyTransformer> topologyTransformer =
+            bsl::make_shared<TopologyTransformer>(next->first);
         if (topologyTransformer->hasError()) {
             BALL_LOG_ERROR << "TopologyTransformer failed to update topology";
             close(rmqamqpt::Constants::CHANNEL_ERROR,
                   "Error occurred, while updating topology");
 
-            d_updateQueue.front().second(rmqt::Result<>(
+            next->second(rmqt::Result<>(
                 "TopologyTransformer failed to update topology"));
             return;
         }
         if (topologyTransformer->isDone()) {
             // No topology being declared
-            d_updateQueue.front().second(rmqt::Result<>());
-            d_updateQueue.pop();
+            const TopologyUpdateConfirmCallback callback = next->second;
+            d_updateQueue.erase(next);
+            callback(rmqt::Result<>());
+            continue;
         }
-    } while (topologyTransformer->isDone() && !d_updateQueue.empty());
 
-    if (!d_updateQueue.empty()) {
-        d_topologyTransformer =
-            bsl::make_pair(topologyTransformer, d_updateQueue.front().second);
         while (topologyTransformer->hasNext()) {
             writeMessage(topologyTransformer->getNextMessage(),
                          &noopWriteHandler);
         }
+        d_sentUpdates.push_back(topologyTransformer);
+        if (d_sentUpdates.size() == 1) {
+            d_topologyTransformer = bsl::make_pair(
+                topologyTransformer, d_updateQueue.front().second);
+        }
     }
 }
 
@@ -298,18 +377,52 @@ rmqt::Future<>
 Channel::updateTopology(const rmqt::TopologyUpdate& topologyUpdate)
 {
     rmqt::Future<>::Pair futurePair = rmqt::Future<>::make();
-    d_updateQueue.push(bsl::make_pair(topologyUpdate, futurePair.first));
-    if (!d_topologyTransformer.first || d_topologyTransformer.first->isDone()) {
+    d_updateQueue.push_back(bsl::make_pair(topologyUpdate, futurePair.first));
+    if (!d_topologyTransformer.first || d_topologyTransformer.first->isDone() ||
+        !d_sentUpdates.empty()) {
+        // No topology declaration is awaiting its replies
         sendNextUpdate();
     }
     return futurePair.second;
 }
 
+bsl::shared_ptr<TopologyTransformer> Channel::makeTopologyTransformer()
+{
+    d_checkingSentinel = false;
+    if (d_topologyStore && !d_topologyConfirmed &&
+        d_topologyStore->contains(d_topology)) {
+        // An earlier process declared exactly this topology on this cluster:
+        // check it is still there rather than declare all of it again
+        rmqt::Topology sentinel;
+        if (makeSentinel(&sentinel, d_topology)) {
+            d_checkingSentinel = true;
+            return bsl::make_shared<TopologyTransformer>(sentinel, false);
+        }
+    }
+
+    // Once the broker has accepted this topology, redeclare it after a
+    // reconnect as one pipelined burst answered by a single reply, rather
+    // than one round trip per method. Any failure still closes the channel
+    return bsl::make_shared<TopologyTransformer>(
+        d_topologyCache ? d_topologyCache->undeclared(d_topology)
+                        : d_topology,
+        d_topologyConfirmed);
+}
+
 void Channel::declareTopology()
 {
     d_declareTopologyStartTime = bdlt::CurrentTime::now();
-    bsl::shared_ptr<TopologyTransformer> topologyTransformer =
-        bsl::make_shared<TopologyTransformer>(d_topology);
+
+    bsl::shared_ptr<TopologyTransformer> topologyTransformer;
+    bool alreadySent = false;
+    if (d_pipelinedTopology) {
+        // Written with channel.open, only the replies are left
+        topologyTransformer.swap(d_pipelinedTopology);
+        alreadySent = true;
+    }
+    else {
+        topologyTransformer = makeTopologyTransformer();
+    }
 
     if (topologyTransformer->hasError()) {
         BALL_LOG_ERROR
@@ -332,6 +445,9 @@ void Channel::declareTopology()
             &Channel::topologyDeclaredCb, weak_from_this(), _1);
     d_topologyTransformer =
         bsl::make_pair(topologyTransformer, declareTopologyCallback);
+    if (alreadySent) {
+        return;
+    }
     while (topologyTransformer->hasNext()) {
         writeMessage(topologyTransformer->getNextMessage(), DECLARING_TOPOLOGY);
     }
@@ -343,7 +459,7 @@ void Channel::topologyDeclaredCb(const bsl::weak_ptr<Channel>& weakSelf,
 {
     bsl::shared_ptr<Channel> self = weakSelf.lock();
     if (!self) {
-        BALL_LOG_TRACE << "Topology Declare Finished after channel destruction";
+        RMQT_LOG_TRACE << "Topology Declare Finished after channel destruction";
         // Closing
         return;
     }
@@ -353,18 +469,31 @@ void Channel::topologyDeclaredCb(const bsl::weak_ptr<Channel>& weakSelf,
 
 void Channel::topologyDeclared(const rmqt::Result<>& result)
 {
+    d_topologyDeclareTime =
+        bdlt::CurrentTime::now() - d_declareTopologyStartTime;
     d_metricPublisher->publishSummary(
         "topology_declare_time",
-        (bdlt::CurrentTime::now() - d_declareTopologyStartTime)
-            .totalSecondsAsDouble(),
+        d_topologyDeclareTime.totalSecondsAsDouble(),
         d_vhostTags);
 
     if (!result) {
+        if (d_topologyStore) {
+            d_topologyStore->forget(d_topology);
+        }
+        d_checkingSentinel = false;
         close(rmqamqpt::Constants::CHANNEL_ERROR,
               "Error occurred, while declaring topology");
         return;
     }
 
+    if (d_topologyStore && !d_checkingSentinel) {
+        d_topologyStore->record(d_topology);
+    }
+    d_checkingSentinel  = false;
+    d_topologyConfirmed = true;
+    if (d_topologyCache) {
+        d_topologyCache->recordDeclared(d_topology);
+    }
     updateState(TOPOLOGY_LOADED);
 
     d_hungProgressTimer->cancel();
@@ -381,7 +510,7 @@ Channel::CleanupIndicator
 Channel::processReceived(const rmqamqp::Message& message)
 {
     if (d_state == CLOSED) {
-        BALL_LOG_ERROR << "Received frame when channel is closed";
+        RMQT_LOG_ERROR_THROTTLED << "Received frame when channel is closed";
         return KEEP;
     }
 
@@ -430,14 +559,14 @@ Channel::processReceived(const rmqamqp::Message& message)
 
 void Channel::processMessage(const rmqt::Message&)
 {
-    BALL_LOG_ERROR << "Throwing Content Away";
+    RMQT_LOG_ERROR_THROTTLED << "Throwing Content Away";
 }
 
 void Channel::onWriteComplete(const bsl::weak_ptr<Channel>& weakSelf)
 {
     bsl::shared_ptr<Channel> self = weakSelf.lock();
     if (!self) {
-        BALL_LOG_TRACE
+        RMQT_LOG_TRACE
             << "Write completion handler called after channel destroyed";
         return;
     }
@@ -451,6 +580,10 @@ void Channel::onWriteComplete(const bsl::weak_ptr<Channel>& weakSelf)
 Channel::CleanupIndicator Channel::reset(bool startRetry)
 {
     updateState(CLOSED);
+    d_pipelinedTopology.reset();
+    // Updates awaiting replies are written again once the topology has been
+    // redeclared
+    d_sentUpdates.clear();
 
     processFailures();
 
@@ -469,7 +602,7 @@ void Channel::retry(const bsl::weak_ptr<Channel>& weakSelf)
 {
     bsl::shared_ptr<Channel> self = weakSelf.lock();
     if (!self) {
-        BALL_LOG_TRACE << "Retry handler called during shutdown";
+        RMQT_LOG_TRACE << "Retry handler called during shutdown";
         return;
     }
 
@@ -478,9 +611,10 @@ void Channel::retry(const bsl::weak_ptr<Channel>& weakSelf)
 void Channel::onReset() {}
 void Channel::onFlowAllowed() {}
 void Channel::onOpen() { ready(); }
+bool Channel::appendSetupMethods(bsl::vector<Message>*) { return false; }
 void Channel::ready()
 {
-    BALL_LOG_TRACE << "Channel Ready";
+    RMQT_LOG_TRACE << "Channel Ready";
 
     d_hungProgressTimer->cancel();
     d_state = READY;
@@ -492,21 +626,51 @@ void Channel::ready()
         "channel_ready", 1, getVHostAndChannelTags());
 }
 
+void Channel::requestReconnect() { d_connErrorCb(); }
+
 void Channel::open()
 {
     using bdlf::PlaceHolders::_1;
     d_hungProgressTimer->start(
         bdlf::BindUtil::bind(&Channel::channelHung, weak_from_this(), _1));
 
-    writeMessage(Message(rmqamqpt::Method(
-                     rmqamqpt::ChannelMethod(rmqamqpt::ChannelOpen()))),
-                 CHANNEL_OPEN_SENT);
+    const Message channelOpen(
+        rmqamqpt::Method(rmqamqpt::ChannelMethod(rmqamqpt::ChannelOpen())));
+
+    d_setupPipelined = false;
+    d_pipelinedTopology.reset();
+
+    bsl::shared_ptr<TopologyTransformer> topologyTransformer;
+    if (d_pipelinedOpen) {
+        topologyTransformer = makeTopologyTransformer();
+    }
+    if (!topologyTransformer || topologyTransformer->hasError()) {
+        // A topology error is reported once the channel is open
+        writeMessage(channelOpen, CHANNEL_OPEN_SENT);
+        return;
+    }
+
+    bsl::shared_ptr<bsl::vector<Message> > methods =
+        bsl::make_shared<bsl::vector<Message> >();
+    methods->push_back(channelOpen);
+    while (topologyTransformer->hasNext()) {
+        methods->push_back(topologyTransformer->getNextMessage());
+    }
+    d_pipelinedTopology = topologyTransformer;
+    d_setupPipelined    = appendSetupMethods(methods.get());
+
+    updateState(CHANNEL_OPEN_SENT);
+    RMQT_LOG_TRACE << "Pipelining " << methods->size()
+                   << " methods with channel.open";
+    writeMessages(
+        methods,
+        bdlf::BindUtil::bind(&Channel::onWriteComplete, weak_from_this()));
 }
 
 void Channel::writeMessage(const rmqamqp::Message& message, State newState)
 {
     updateState(newState);
-    BALL_LOG_TRACE << "State now set to: " << d_state;
+    RMQT_LOG_TRACE << "State now set to: " << d_state;
     d_onAsyncWrite(
         bsl::make_shared<Message>(message),
         bdlf::BindUtil::bind(&Channel::onWriteComplete, weak_from_this()));
@@ -519,6 +683,47 @@ void Channel::writeMessage(
     d_onAsyncWrite(bsl::make_shared<Message>(message), callBack);
 }
 
+void Channel::writeMessages(
+    const bsl::shared_ptr<bsl::vector<rmqamqp::Message> >& messages,
+    const rmqio::Connection::SuccessWriteCallback& callBack)
+{
+    if (messages->empty()) {
+        return;
+    }
+
+    if (d_onAsyncBatchWrite) {
+        d_onAsyncBatchWrite(messages, callBack);
+        return;
+    }
+
+    for (bsl::size_t i = 0; i + 1 < messages->size(); ++i) {
+        d_onAsyncWrite(bsl::make_shared<Message>((*messages)[i]),
+                       &noopWriteHandler);
+    }
+    d_onAsyncWrite(bsl::make_shared<Message>(messages->back()), callBack);
+}
+
+void Channel::setAsyncBatchWrite(
+    const AsyncBatchWriteCallback& onAsyncBatchWrite)
+{
+    d_onAsyncBatchWrite = onAsyncBatchWrite;
+}
+
+void Channel::setPipelinedOpen(bool pipelined)
+{
+    d_pipelinedOpen = pipelined;
+}
+
+void Channel::setTopologyCache(const bsl::shared_ptr<TopologyCache>& cache)
+{
+    d_topologyCache = cache;
+}
+
+void Channel::setTopologyStore(const bsl::shared_ptr<TopologyStore>& store)
+{
+    d_topologyStore = store;
+}
+
 void Channel::gracefulClose()
 {
     d_permanentlyClosing = true;
@@ -538,6 +743,65 @@ void Channel::close(rmqamqpt::Constants::AMQPReplyCode replyCode,
 
 const bsl::string& Channel::vhostName() const { return d_vhostName; }
 
+void Channel::loadStats(rmqt::ChannelStats* stats) const
+{
+    stats->topologyDeclareTime = d_topologyDeclareTime;
+}
+
+void Channel::publishChannelMetrics()
+{
+    rmqt::ChannelStats stats;
+    loadStats(&stats);
+
+    const bsl::vector<bsl::pair<bsl::string, bsl::string> > tags =
+        channelMetricTags();
+
+    const bsls::TimeInterval now = bsls::SystemTime::nowMonotonicClock();
+    if (now > d_channelMetricsRun) {
+        const double seconds =
+            (now - d_channelMetricsRun).totalSecondsAsDouble();
+        if (stats.type == rmqt::ChannelStats::PRODUCER) {
+            d_metricPublisher->publishGauge(
+                "channel_messages_out_per_second",
+                static_cast<double>(stats.messagesOut -
+                                    d_channelMetricsStats.messagesOut) /
+                    seconds,
+                tags);
+            d_metricPublisher->publishGauge(
+                "channel_bytes_out_per_second",
+                static_cast<double>(stats.bytesOut -
+                                    d_channelMetricsStats.bytesOut) /
+                    seconds,
+                tags);
+        }
+        else {
+            d_metricPublisher->publishGauge(
+                "channel_messages_in_per_second",
+                static_cast<double>(stats.messagesIn -
+                                    d_channelMetricsStats.messagesIn) /
+                    seconds,
+                tags);
+            d_metricPublisher->publishGauge(
+                "channel_bytes_in_per_second",
+                static_cast<double>(stats.bytesIn -
+                                    d_channelMetricsStats.bytesIn) /
+                    seconds,
+                tags);
+        }
+    }
+    d_metricPublisher->publishGauge(
+        "channel_in_flight", static_cast<double>(inFlight()), tags);
+
+    d_channelMetricsRun   = now;
+    d_channelMetricsStats = stats;
+}
+
+bsl::vector<bsl::pair<bsl::string, bsl::string> >
+Channel::channelMetricTags() const
+{
+    return d_vhostTags;
+}
+
 bsl::vector<bsl::pair<bsl::string, bsl::string> >
 Channel::getVHostAndChannelTags()
 {
@@ -577,7 +841,7 @@ void Channel::updateState(State state)
             ready();
             break;
         case CLOSED:
-            BALL_LOG_DEBUG << "Closing channel for vhost:" << d_vhostName;
+            RMQT_LOG_DEBUG << "Closing channel for vhost:" << d_vhostName;
             // fall through
         default:
             d_state = state;
@@ -592,14 +856,15 @@ void Channel::channelHung(const bsl::weak_ptr<Channel>& weakSelf,
     }
     bsl::shared_ptr<Channel> self = weakSelf.lock();
     if (!self) {
-        BALL_LOG_TRACE << "Channel hung called after channel destruction";
+        RMQT_LOG_TRACE << "Channel hung called after channel destruction";
         return;
     }
 
-    BALL_LOG_ERROR << "Detected channel hung in setup. VHost: "
-                   << self->vhostName()
-                   << " Channel Type: " << self->channelType() << " in state "
-                   << self->d_state << ". Triggering reconnection.";
+    RMQT_LOG_ERROR_THROTTLED << "Detected channel hung in setup. VHost: "
+                             << self->vhostName()
+                             << " Channel Type: " << self->channelType()
+                             << " in state " << self->d_state
+                             << ". Triggering reconnection.";
 
     self->d_connErrorCb();
 }
@@ -17,6 +17,10 @@
 #define INCLUDED_RMQAMQP_CHANNEL
 
 #include <rmqamqp_message.h>
+#include <rmqamqp_pipelinetiming.h>
+#include <rmqamqp_topologycache.h>
+#include <rmqamqp_topologymerger.h>
+#include <rmqamqp_topologystore.h>
 #include <rmqamqp_topologytransformer.h>
 #include <rmqamqpt_basicmethod.h>
 #include <rmqamqpt_queuemethod.h>
@@ -24,12 +28,14 @@
 #include <rmqio_connection.h>
 #include <rmqio_retryhandler.h>
 #include <rmqp_metricpublisher.h>
+#include <rmqt_connectionstats.h>
 #include <rmqt_future.h>
 #include <rmqt_message.h>
 #include <rmqt_topology.h>
 #include <rmqt_topologyupdate.h>
 
 #include <bsl_cstdint.h>
+#include <bsl_deque.h>
 #include <bsl_functional.h>
 #include <bsl_memory.h>
 #include <bsl_queue.h>
@@ -64,12 +70,18 @@ class Channel : public bsl::enable_shared_from_this<Channel> {
                                const rmqio::Connection::SuccessWriteCallback&)>
         AsyncWriteCallback;
 
+    typedef bsl::function<void(
+        const bsl::shared_ptr<bsl::vector<rmqamqp::Message> >&,
+        const rmqio::Connection::SuccessWriteCallback&)>
+        AsyncBatchWriteCallback;
+
     typedef bsl::function<void()> HungChannelCallback;
 
     typedef bsl::function<void(const rmqt::Result<>&)>
         TopologyUpdateConfirmCallback;
 
     static const int k_HUNG_CHANNEL_TIMER_SEC;
+    static const bsl::size_t k_MAX_PIPELINED_UPDATES;
 
     virtual ~Channel() {}
 
@@ -112,18 +124,73 @@ class Channel : public bsl::enable_shared_from_this<Channel> {
 
     rmqt::Future<> waitForReady();
 
+    /// Queue `topologyUpdate` to be applied. Updates are pipelined: the
+    /// methods of up to `k_MAX_PIPELINED_UPDATES` queued updates are written
+    /// without waiting for the replies to those before them. The returned
+    /// future completes once the broker has replied to all of this update's
+    /// methods.
     rmqt::Future<> updateTopology(const rmqt::TopologyUpdate& topologyUpdate);
 
+    /// Set the function used to write several messages with a single socket
+    /// write. Until this is set, batches are written one message at a time.
+    void setAsyncBatchWrite(const AsyncBatchWriteCallback& onAsyncBatchWrite);
+
+    /// Share the record of the topology already declared on this channel's
+    /// connection. Entities found there are not declared again.
+    void setTopologyCache(const bsl::shared_ptr<TopologyCache>& cache);
+
+    /// Consult `store` for topologies declared by an earlier process. The
+    /// first declaration of a recorded topology only passively checks one
+    /// of its entities; a missing entity forgets the record, so the retry
+    /// declares everything.
+    void setTopologyStore(const bsl::shared_ptr<TopologyStore>& store);
+
+    /// Send the methods which finish opening the channel, the topology
+    /// declaration and the setup `appendSetupMethods` gives, in the same
+    /// write as channel.open rather than each after the previous reply. The
+    /// broker processes a channel's methods in order, so the replies still
+    /// arrive, and are handled, in sequence. Takes effect from the next
+    /// `open`.
+    void setPipelinedOpen(bool pipelined);
+
     /// Return a string which summarises what this channel is
     /// For the purposes of identifying the channel for debug logs
     virtual bsl::string channelDebugName() const = 0;
 
+    /// Fill in the parts of `stats` this channel knows about, apart from
+    /// the channel id. Call on the event loop thread.
+    virtual void loadStats(rmqt::ChannelStats* stats) const;
+
+    /// Publish this channel's gauges, tagged with `channelMetricTags()`: its
+    /// message and byte rates since the last call and its messages in
+    /// flight. Call periodically, on the event loop thread.
+    virtual void publishChannelMetrics();
+
+    /// Return the bytes this channel holds on to for its messages in
+    /// flight, whether in use or not
+    virtual bsl::size_t retainedBytes() const { return 0; }
+
+    /// Give back the memory a burst of messages in flight left this channel
+    /// holding on to. Call on the event loop thread.
+    virtual void trim() {}
+
+    const bsl::string& vhostName() const;
+
+    /// Record that `stage` ran from `start`, a `rmqio::PipelineClock::now()`
+    /// timestamp, until now. Thread safe.
+    void recordPipelineStage(PipelineStage::Value stage,
+                             bsls::Types::Int64 start) const
+    {
+        d_pipelineTiming.record(stage, start);
+    }
+
   protected:
     bsl::string d_vhostName;
     bool d_flow;
     bsl::shared_ptr<rmqp::MetricPublisher> d_metricPublisher;
     bsl::vector<bsl::pair<bsl::string, bsl::string> > d_vhostTags;
     bsl::vector<bsl::pair<bsl::string, bsl::string> > d_vhostAndChannelTags;
+    PipelineTiming d_pipelineTiming;
 
     // Used to ensure we make forward progress during channel
     // open/topology&consumer declare
@@ -141,16 +208,33 @@ class Channel : public bsl::enable_shared_from_this<Channel> {
     virtual void processConfirmMethod(const rmqamqpt::ConfirmMethod&);
     virtual void processMessage(const rmqt::Message&);
     virtual void onOpen();
+
+    /// Append the methods `onOpen` would send to `methods`, for an open
+    /// which is pipelined. Return true if they were appended, in which case
+    /// `setupPipelined` is true and `onOpen` must not send them again. By
+    /// default nothing is appended.
+    virtual bool appendSetupMethods(bsl::vector<Message>* methods);
+
+    /// Return true if the methods given by `appendSetupMethods` were sent
+    /// with the last channel.open
+    bool setupPipelined() const { return d_setupPipelined; }
+
     virtual void onReset();
     virtual void onFlowAllowed();
     /// Process failures when client got disconnected from broker and try to
     /// reconnect.
     virtual void processFailures() = 0;
 
+    /// Write the methods of queued updates not yet written, up to
+    /// `k_MAX_PIPELINED_UPDATES` awaiting replies
     void sendNextUpdate();
 
     void ready();
 
+    /// Ask the connection to reconnect, for failures this channel cannot
+    /// recover from by itself
+    void requestReconnect();
+
     // Callback for writes
     static void onWriteComplete(const bsl::weak_ptr<Channel>& weakSelf);
 
@@ -159,33 +243,64 @@ class Channel : public bsl::enable_shared_from_this<Channel> {
     void writeMessage(const rmqamqp::Message& message,
                       const rmqio::Connection::SuccessWriteCallback& callBack);
 
+    /// Write `messages` in order. `callBack` is invoked once, after the last
+    /// message is written.
+    void writeMessages(
+        const bsl::shared_ptr<bsl::vector<rmqamqp::Message> >& messages,
+        const rmqio::Connection::SuccessWriteCallback& callBack);
+
     /// Callback for re-opening channel
     static void retry(const bsl::weak_ptr<Channel>& weakSelf);
 
-    const bsl::string& vhostName() const;
-
     virtual const char* channelType() const = 0;
 
     virtual bsl::vector<bsl::pair<bsl::string, bsl::string> >
     getVHostAndChannelTags();
 
+    /// Return the tags of the gauges `publishChannelMetrics` publishes. By
+    /// default the vhost tag.
+    virtual bsl::vector<bsl::pair<bsl::string, bsl::string> >
+    channelMetricTags() const;
+
     void updateState(State state);
 
   private:
+    typedef bsl::deque<
+        bsl::pair<rmqt::TopologyUpdate, TopologyUpdateConfirmCallback> >
+        UpdateQueue;
+
     State d_state;
     rmqt::Topology d_topology;
+    TopologyMerger d_topologyMerger; ///< Indexes and updates d_topology
     bsl::pair<bsl::shared_ptr<TopologyTransformer>,
               TopologyUpdateConfirmCallback>
         d_topologyTransformer;
-    bsl::queue<bsl::pair<rmqt::TopologyUpdate, TopologyUpdateConfirmCallback> >
-        d_updateQueue;
+    UpdateQueue d_updateQueue;
+    /// Transformers of the updates at the front of `d_updateQueue` whose
+    /// methods have been written, oldest first. Replies are matched against
+    /// the front one, which is also `d_topologyTransformer`.
+    bsl::deque<bsl::shared_ptr<TopologyTransformer> > d_sentUpdates;
 
     AsyncWriteCallback d_onAsyncWrite;
+    AsyncBatchWriteCallback d_onAsyncBatchWrite;
+    bsl::shared_ptr<TopologyCache> d_topologyCache;
+    bsl::shared_ptr<TopologyStore> d_topologyStore;
     bsl::shared_ptr<rmqio::RetryHandler> d_retryHandler;
     bool d_permanentlyClosing;
     bsls::TimeInterval d_declareTopologyStartTime;
+    bsls::TimeInterval d_topologyDeclareTime; ///< Last declaration's duration
+    bsls::TimeInterval d_channelMetricsRun; ///< Last `publishChannelMetrics`
+    rmqt::ChannelStats d_channelMetricsStats; ///< Stats as of that run
+    bool d_topologyConfirmed; ///< Broker has accepted d_topology once
     bsl::optional<rmqt::Future<>::Maker> d_readyMade;
     HungChannelCallback d_connErrorCb;
+    bool d_pipelinedOpen;   ///< Set by `setPipelinedOpen`
+    bool d_setupPipelined;  ///< Setup was sent with the last channel.open
+    bool d_checkingSentinel; ///< Declaring only a stored topology's sentinel
+
+    /// Topology declaration already sent with channel.open, whose replies
+    /// are due once channel.open-ok arrives
+    bsl::shared_ptr<TopologyTransformer> d_pipelinedTopology;
 
     Channel(const Channel&) BSLS_KEYWORD_DELETED;
     Channel& operator=(const Channel&) BSLS_KEYWORD_DELETED;
@@ -194,6 +309,8 @@ class Channel : public bsl::enable_shared_from_this<Channel> {
 
     void processTopologyMethod(const rmqamqpt::Method&);
 
+    bsl::shared_ptr<TopologyTransformer> makeTopologyTransformer();
+
     void declareTopology();
     static void topologyDeclaredCb(const bsl::weak_ptr<Channel>& weakSelf,
                                    const rmqt::Result<>& result);
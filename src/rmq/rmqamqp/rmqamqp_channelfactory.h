@@ -21,7 +21,7 @@
 
 #include <rmqamqpt_constants.h>
 #include <rmqio_retryhandler.h>
-#include <rmqt_consumerackbatch.h>
+#include <rmqt_consumerackqueue.h>
 #include <rmqt_consumerconfig.h>
 
 #include <bsl_memory.h>
@@ -15,6 +15,8 @@
 
 #include <rmqamqp_channelmap.h>
 
+#include <rmqt_log.h>
+
 #include <ball_log.h>
 
 #include <bsl_vector.h>
@@ -30,6 +32,7 @@ ChannelMap::ChannelMap()
 : d_channels()
 , d_sendChannels()
 , d_receiveChannels()
+, d_channelIndex()
 {
 }
 
@@ -56,6 +59,7 @@ void ChannelMap::associateChannel(uint16_t channelId,
 {
     d_sendChannels[channelId] = channel;
     d_channels[channelId]     = channel;
+    index(channelId, channel.get());
 }
 
 void ChannelMap::associateChannel(
@@ -64,6 +68,7 @@ void ChannelMap::associateChannel(
 {
     d_receiveChannels[channelId] = channel;
     d_channels[channelId]        = channel;
+    index(channelId, channel.get());
 }
 
 void ChannelMap::removeChannel(uint16_t channelId)
@@ -71,7 +76,8 @@ void ChannelMap::removeChannel(uint16_t channelId)
     d_channels.erase(channelId);
     d_sendChannels.erase(channelId);
     d_receiveChannels.erase(channelId);
-    BALL_LOG_DEBUG << "Cleaned up channel " << channelId;
+    index(channelId, 0);
+    RMQT_LOG_DEBUG << "Cleaned up channel " << channelId;
 }
 
 void ChannelMap::resetAll()
@@ -117,21 +123,34 @@ void ChannelMap::openAll()
 bool ChannelMap::processReceived(uint16_t channelId,
                                  const rmqamqp::Message& message)
 {
-    ChannelPtrMap::const_iterator it = d_channels.find(channelId);
+    Channel* channel = channelId < d_channelIndex.size()
+                           ? d_channelIndex[channelId]
+                           : 0;
 
-    if (it == d_channels.end() || !it->second) {
+    if (!channel) {
         return false;
     }
 
-    Channel::CleanupIndicator cleanupInd = it->second->processReceived(message);
+    Channel::CleanupIndicator cleanupInd = channel->processReceived(message);
 
     if (cleanupInd == Channel::CLEANUP) {
-        // invalidates iterator
+        // destroys channel
         removeChannel(channelId);
     }
 
     return true;
 }
 
+void ChannelMap::index(uint16_t channelId, Channel* channel)
+{
+    if (channelId >= d_channelIndex.size()) {
+        if (!channel) {
+            return;
+        }
+        d_channelIndex.resize(channelId + 1, 0);
+    }
+    d_channelIndex[channelId] = channel;
+}
+
 } // namespace rmqamqp
 } // namespace BloombergLP
@@ -24,6 +24,7 @@
 #include <bsl_cstdint.h>
 #include <bsl_map.h>
 #include <bsl_memory.h>
+#include <bsl_vector.h>
 
 //@PURPOSE: Provide a container of Channels with associated Channel IDs
 //
@@ -80,9 +81,16 @@ class ChannelMap {
     }
 
   private:
+    /// Point `channelId`'s slot in `d_channelIndex` at `channel`
+    void index(uint16_t channelId, Channel* channel);
+
     ChannelPtrMap d_channels;
     SendChannelMap d_sendChannels;
     ReceiveChannelMap d_receiveChannels;
+
+    /// The channels in `d_channels`, indexed by channel id: ids are small
+    /// and dense, so routing a received message is a single array access
+    bsl::vector<Channel*> d_channelIndex;
 };
 
 } // namespace rmqamqp
@@ -20,18 +20,22 @@
 #include <rmqamqp_heartbeatmanagerimpl.h>
 #include <rmqamqp_message.h>
 #include <rmqamqp_metrics.h>
+#include <rmqamqpt_connectionblocked.h>
 #include <rmqamqpt_connectionopen.h>
 #include <rmqamqpt_connectionopenok.h>
 #include <rmqamqpt_connectionstart.h>
 #include <rmqamqpt_connectionstartok.h>
 #include <rmqamqpt_connectiontune.h>
 #include <rmqamqpt_connectiontuneok.h>
+#include <rmqamqpt_connectionunblocked.h>
 #include <rmqamqpt_constants.h>
 #include <rmqamqpt_frame.h>
 #include <rmqamqpt_method.h>
 #include <rmqio_backofflevelretrystrategy.h>
 #include <rmqio_connection.h>
 #include <rmqio_connectionretryhandler.h>
+#include <rmqio_jitteredretrystrategy.h>
+#include <rmqio_pipelineclock.h>
 #include <rmqio_resolver.h>
 #include <rmqio_retryhandler.h>
 #include <rmqio_serializedframe.h>
@@ -39,6 +43,8 @@
 #include <rmqp_metricpublisher.h>
 #include <rmqt_consumerconfig.h>
 #include <rmqt_fieldvalue.h>
+#include <rmqt_log.h>
+#include <rmqt_probe.h>
 
 #include <bdlf_bind.h>
 #include <bdlf_placeholder.h>
@@ -81,6 +87,30 @@ const bsl::uint16_t k_HUNG_TIMER_SEC            = 60;
 
 BALL_LOG_SET_NAMESPACE_CATEGORY("RMQAMQP.CONNECTION")
 
+rmqt::Future<>
+drainAfterCancel(const bsl::weak_ptr<ReceiveChannel>& weakChannel,
+                 const rmqt::Result<>& cancelled)
+{
+    bsl::shared_ptr<ReceiveChannel> channel = weakChannel.lock();
+    if (!channel) {
+        return rmqt::Future<>(rmqt::Result<>());
+    }
+    if (!cancelled) {
+        // e.g. the consumers were already cancelled, drain all the same
+        RMQT_LOG_DEBUG << "Draining " << channel->channelDebugName()
+                       << " after failed cancel: " << cancelled.error();
+    }
+    return channel->drain();
+}
+
+rmqt::Result<> logDrainFailure(const rmqt::Result<>& drained)
+{
+    if (!drained) {
+        BALL_LOG_WARN << "Failed to drain channel: " << drained.error();
+    }
+    return rmqt::Result<>();
+}
+
 rmqt::FieldTable generateClientProperties(const rmqt::FieldTable& base,
                                           const bsl::string& connectionName)
 {
@@ -89,7 +119,7 @@ rmqt::FieldTable generateClientProperties(const rmqt::FieldTable& base,
     FieldTable props(base);
     bsl::shared_ptr<FieldTable> capabilities = bsl::make_shared<FieldTable>();
 
-    (*capabilities)["connection.blocked"]           = FieldValue(false);
+    (*capabilities)["connection.blocked"]           = FieldValue(true);
     (*capabilities)["authentication_failure_close"] = FieldValue(true);
     (*capabilities)["consumer_cancel_notify"]       = FieldValue(true);
     (*capabilities)["publisher_confirms"]           = FieldValue(true);
@@ -149,9 +179,9 @@ void negotiateTuneParams(uint16_t* outChannelMax,
 void noopWriteComplete() {}
 
 bsl::shared_ptr<rmqio::SerializedFrame>
-serializeFrame(const rmqamqpt::Frame& frame)
+serializeFrame(const rmqamqpt::Frame& frame, bslma::Allocator* allocator)
 {
-    return bsl::make_shared<rmqio::SerializedFrame>(frame);
+    return bsl::allocate_shared<rmqio::SerializedFrame>(allocator, frame);
 }
 
 } // namespace
@@ -166,31 +196,67 @@ Connection::Connection(
     const bsl::shared_ptr<rmqt::Endpoint>& endpoint,
     const bsl::shared_ptr<rmqt::Credentials>& credentials,
     const rmqt::FieldTable& clientProperties,
-    bsl::string_view name)
+    bsl::string_view name,
+    bslma::Allocator* allocator)
 : d_resolver(resolver)
 , d_retryHandler(retryHandler)
 , d_heartbeatManager(hbManager)
 , d_endpoint(endpoint)
 , d_credentials(credentials)
 , d_socketConnection()
+, d_socketRoute()
+, d_standby()
 , d_channelFactory(channelFactory)
 , d_metricPublisher(metricPublisher)
-, d_framer()
+, d_bufferAllocator(allocator)
+, d_framePool(rmqio::FrameBufferPool::create(allocator))
+, d_framer(d_framePool.get())
+, d_heartbeatFrame(bsl::allocate_shared<rmqio::SerializedFrame>(
+      d_framePool.get(),
+      Framer::makeHeartbeatFrame()))
 , d_state(Connection::DISCONNECTED)
 , d_clientProperties(clientProperties)
 , d_channels()
+, d_topologyCache(bsl::make_shared<TopologyCache>())
+, d_topologyStore()
+, d_hostSelector()
+, d_currentHost()
+, d_countedOnHost(false)
+, d_memoryBudget()
+, d_publishGate(bsl::make_shared<PublishGate>())
+, d_blockedCb()
+, d_clientFrameMax(static_cast<uint32_t>(rmqamqpt::Frame::getMaxFrameSize()))
+, d_clientChannelMax(k_MAX_CHANNEL_NUM)
+, d_negotiatedFrameMax(d_clientFrameMax)
+, d_negotiatedHeartbeatTimeout(0)
+, d_defaultAckCoalescingDelay()
+, d_defaultAckCoalescingTags(0)
+, d_resendBatchMessages(0)
+, d_readsPaused(false)
+, d_channelWeights()
 , d_hungTimer(
       timerFactory->createWithTimeout(bsls::TimeInterval(k_HUNG_TIMER_SEC)))
+, d_connectLimiter()
+, d_connectPermitTimer()
+, d_holdsConnectPermit(false)
+, d_idleTrimTimer()
+, d_idleTrimWatermark(0)
+, d_idleTrimFrames(0)
+, d_idleTrimmed(false)
 , d_timerFactory(timerFactory)
 , d_firstConnectCb()
 , d_closeCb()
 , d_connectStartTime()
 , d_hasBeenConnected(false)
+, d_connectTime()
+, d_reconnects(0)
 , d_vhostTags()
+, d_pipelineTiming()
 , d_connectionName(name)
 {
     d_vhostTags.push_back(bsl::pair<bsl::string, bsl::string>(
         Metrics::VHOST_TAG, d_endpoint->vhost()));
+    d_pipelineTiming = PipelineTiming(d_metricPublisher, d_vhostTags);
 }
 
 void Connection::close(const CloseFinishCallback& closeCallback)
@@ -199,6 +265,10 @@ void Connection::close(const CloseFinishCallback& closeCallback)
 
     d_closeCb = closeCallback;
 
+    if (d_standby) {
+        d_standby->close(CloseFinishCallback());
+    }
+
     if (d_state == DISCONNECTED) {
         socketShutdown(Connection::FATAL,
                        rmqio::Connection::GRACEFUL_DISCONNECT);
@@ -209,9 +279,44 @@ void Connection::close(const CloseFinishCallback& closeCallback)
     }
 }
 
+rmqt::Future<> Connection::drainChannels()
+{
+    using bdlf::PlaceHolders::_1;
+
+    bsl::vector<rmqt::Future<> > drained;
+
+    const ChannelMap::ReceiveChannelMap& receiveChannels =
+        d_channels.getReceiveChannels();
+    for (ChannelMap::ReceiveChannelMap::const_iterator it =
+             receiveChannels.begin();
+         it != receiveChannels.end();
+         ++it) {
+        drained.push_back(
+            it->second->cancel()
+                .thenFuture<void>(bdlf::BindUtil::bind(
+                    &drainAfterCancel,
+                    bsl::weak_ptr<ReceiveChannel>(it->second),
+                    _1))
+                .then<void>(&logDrainFailure));
+    }
+
+    const ChannelMap::SendChannelMap& sendChannels =
+        d_channels.getSendChannels();
+    for (ChannelMap::SendChannelMap::const_iterator it = sendChannels.begin();
+         it != sendChannels.end();
+         ++it) {
+        drained.push_back(it->second->waitForConfirms());
+    }
+
+    RMQT_LOG_DEBUG << "Draining " << drained.size()
+                   << " channels of connection: " << connectionDebugName();
+
+    return rmqt::FutureUtil::whenAll(drained);
+}
+
 Connection::~Connection()
 {
-    BALL_LOG_TRACE << "Destruct connection: " << connectionDebugName();
+    RMQT_LOG_TRACE << "Destruct connection: " << connectionDebugName();
     socketShutdown(Connection::FATAL, rmqio::Connection::GRACEFUL_DISCONNECT);
 
     if (d_closeCb) {
@@ -222,22 +327,57 @@ Connection::~Connection()
 void Connection::initiateConnect()
 {
     using bdlf::PlaceHolders::_1;
-    BALL_LOG_INFO << "Starting connection to: " << connectionDebugName();
+
+    if (d_connectLimiter && !d_holdsConnectPermit) {
+        if (!d_connectLimiter->tryAcquire()) {
+            RMQT_LOG_DEBUG << "Waiting for one of "
+                           << d_connectLimiter->maxConcurrent()
+                           << " connect permits: " << connectionDebugName();
+            d_connectPermitTimer->reset(d_connectLimiter->retryInterval());
+            d_connectPermitTimer->start(bdlf::BindUtil::bind(
+                &Connection::connectPermitWait, weak_from_this(), _1));
+            return;
+        }
+        d_holdsConnectPermit = true;
+    }
+
+    const rmqt::Endpoint::HostList hosts = d_endpoint->hosts();
+    d_currentHost = hosts[d_hostSelector ? d_hostSelector->select(hosts) : 0];
+
+    BALL_LOG_INFO << "Starting connection to: " << connectionDebugName()
+                  << " via " << d_currentHost.first << ":"
+                  << d_currentHost.second;
     d_connectStartTime = bdlt::CurrentTime::now();
+
+    // Reads and errors of the new socket go to this connection until a
+    // primary takes it over, see `takeOverStandby`
+    d_socketRoute             = bsl::make_shared<SocketRoute>();
+    d_socketRoute->connection = weak_from_this();
+
     rmqio::Connection::Callbacks callbacks;
     callbacks.onRead =
-        bdlf::BindUtil::bind(&Connection::readHandler, weak_from_this(), _1);
+        bdlf::BindUtil::bind(&Connection::readHandler, d_socketRoute, _1);
     callbacks.onError =
-        bdlf::BindUtil::bind(&Connection::socketError, weak_from_this(), _1);
+        bdlf::BindUtil::bind(&Connection::socketError, d_socketRoute, _1);
 
     d_hungTimer->start(
         bdlf::BindUtil::bind(&Connection::connectionHung, this, _1));
 
-    if (d_endpoint->securityParameters()) {
+    const bsl::string localPath = d_endpoint->localPath();
+    if (!localPath.empty()) {
+        d_socketConnection = d_resolver->asyncLocalConnect(
+            localPath,
+            d_clientFrameMax,
+            callbacks,
+            bdlf::BindUtil::bind(&Connection::connectCb, weak_from_this()),
+            bdlf::BindUtil::bind(
+                &Connection::connectErrorCb, weak_from_this(), _1));
+    }
+    else if (d_endpoint->securityParameters()) {
         d_socketConnection = d_resolver->asyncSecureConnect(
-            d_endpoint->hostname(),
-            d_endpoint->port(),
-            rmqamqpt::Frame::getMaxFrameSize(),
+            d_currentHost.first,
+            d_currentHost.second,
+            d_clientFrameMax,
             d_endpoint->securityParameters(),
             callbacks,
             bdlf::BindUtil::bind(&Connection::connectCb, weak_from_this()),
@@ -246,14 +386,16 @@ void Connection::initiateConnect()
     }
     else {
         d_socketConnection = d_resolver->asyncConnect(
-            d_endpoint->hostname(),
-            d_endpoint->port(),
-            rmqamqpt::Frame::getMaxFrameSize(),
+            d_currentHost.first,
+            d_currentHost.second,
+            d_clientFrameMax,
             callbacks,
             bdlf::BindUtil::bind(&Connection::connectCb, weak_from_this()),
             bdlf::BindUtil::bind(
                 &Connection::connectErrorCb, weak_from_this(), _1));
     }
+
+    applyChannelWeights();
 }
 
 void Connection::startFirstConnection(
@@ -262,6 +404,9 @@ void Connection::startFirstConnection(
     d_firstConnectCb = connectedCallback;
 
     initiateConnect();
+    if (d_standby) {
+        d_standby->initiateConnect();
+    }
 }
 
 void Connection::connect()
@@ -277,6 +422,9 @@ void Connection::connect()
 
 void Connection::connectError(const rmqio::Resolver::Error&)
 {
+    if (d_hostSelector) {
+        d_hostSelector->failed(d_currentHost);
+    }
     socketShutdown(WILL_RETRY, rmqio::Connection::CONNECT_ERROR);
 }
 
@@ -285,7 +433,7 @@ void Connection::connectCb(const bsl::weak_ptr<Connection> weakSelf)
     bsl::shared_ptr<Connection> self = weakSelf.lock();
 
     if (!self) {
-        BALL_LOG_DEBUG << "Connect came back after connection destructed";
+        RMQT_LOG_DEBUG << "Connect came back after connection destructed";
         return;
     }
 
@@ -298,21 +446,21 @@ void Connection::connectErrorCb(const bsl::weak_ptr<Connection> weakSelf,
     bsl::shared_ptr<Connection> self = weakSelf.lock();
 
     if (!self) {
-        BALL_LOG_DEBUG << "connectError came back after connection destructed";
+        RMQT_LOG_DEBUG << "connectError came back after connection destructed";
         return;
     }
 
     self->connectError(error);
 }
 
-void Connection::socketError(const bsl::weak_ptr<Connection>& weakConn,
+void Connection::socketError(const bsl::shared_ptr<SocketRoute>& route,
                              const rmqio::Connection::ReturnCode& rc)
 {
-    bsl::shared_ptr<Connection> conn = weakConn.lock();
+    bsl::shared_ptr<Connection> conn = route->connection.lock();
 
     if (!conn) {
         // Connection shutdown
-        BALL_LOG_TRACE << "Socket Error after Connection closed. RC: " << rc;
+        RMQT_LOG_TRACE << "Socket Error after Connection closed. RC: " << rc;
         return;
     }
 
@@ -320,7 +468,7 @@ void Connection::socketError(const bsl::weak_ptr<Connection>& weakConn,
         return;
     }
 
-    BALL_LOG_TRACE << "Socket snapped, RC: " << rc;
+    RMQT_LOG_TRACE << "Socket snapped, RC: " << rc;
 
     conn->socketShutdown(WILL_RETRY, rc);
 }
@@ -328,7 +476,7 @@ void Connection::socketError(const bsl::weak_ptr<Connection>& weakConn,
 void Connection::onWriteComplete(State state)
 {
     d_state = state;
-    BALL_LOG_TRACE << "State now set to: " << d_state;
+    RMQT_LOG_TRACE << "State now set to: " << d_state;
 
     // close socket if the server closed us
     if (d_state == CONNECTION_CLOSEOK_SENT) {
@@ -341,7 +489,7 @@ void Connection::onWriteCompleteCb(bsl::weak_ptr<Connection> weakSelf,
 {
     bsl::shared_ptr<Connection> self = weakSelf.lock();
     if (!self) {
-        BALL_LOG_TRACE << "Write completion handler called during shutdown";
+        RMQT_LOG_TRACE << "Write completion handler called during shutdown";
         return;
     }
 
@@ -361,11 +509,11 @@ void Connection::sendConnectionStartOk()
     Framer::makeMethodFrame(
         &frame, channel, rmqamqpt::ConnectionMethod(startOkMethod));
 
-    asyncWriteSingleFrame(serializeFrame(frame),
+    asyncWriteSingleFrame(serializeFrame(frame, d_framePool.get()),
                           bdlf::BindUtil::bind(&Connection::onWriteCompleteCb,
                                                weak_from_this(),
                                                CONNECTION_STARTOK_SENT));
-    BALL_LOG_TRACE << "Connection Start-ok method sent to server: "
+    RMQT_LOG_TRACE << "Connection Start-ok method sent to server: "
                    << startOkMethod;
 }
 
@@ -381,10 +529,12 @@ void Connection::sendConnectionTuneOk(
         &negotiatedMaxFrameSize,
         &negotiatedHeartbeatTimeout,
         tuneMethod,
-        k_MAX_CHANNEL_NUM,
-        static_cast<uint32_t>(rmqamqpt::Frame::getMaxFrameSize()),
+        d_clientChannelMax,
+        d_clientFrameMax,
         k_MAX_HEARTBEAT_TIMEOUT_SEC);
 
+    d_negotiatedFrameMax         = negotiatedMaxFrameSize;
+    d_negotiatedHeartbeatTimeout = negotiatedHeartbeatTimeout;
     startHeartbeatManager(negotiatedHeartbeatTimeout);
     d_framer.setMaxFrameSize(negotiatedMaxFrameSize);
 
@@ -395,11 +545,11 @@ void Connection::sendConnectionTuneOk(
     rmqamqpt::Frame frame;
     Framer::makeMethodFrame(
         &frame, channel, rmqamqpt::ConnectionMethod(tuneOkMethod));
-    asyncWriteSingleFrame(serializeFrame(frame),
+    asyncWriteSingleFrame(serializeFrame(frame, d_framePool.get()),
                           bdlf::BindUtil::bind(&Connection::onWriteCompleteCb,
                                                weak_from_this(),
                                                CONNECTION_TUNEOK_SENT));
-    BALL_LOG_TRACE << "Connection Tune-ok method sent to server: "
+    RMQT_LOG_TRACE << "Connection Tune-ok method sent to server: "
                    << tuneOkMethod;
 }
 
@@ -410,11 +560,11 @@ void Connection::sendConnectionOpen()
     rmqamqpt::Frame frame;
     Framer::makeMethodFrame(
         &frame, channel, rmqamqpt::ConnectionMethod(openMethod));
-    asyncWriteSingleFrame(serializeFrame(frame),
+    asyncWriteSingleFrame(serializeFrame(frame, d_framePool.get()),
                           bdlf::BindUtil::bind(&Connection::onWriteCompleteCb,
                                                weak_from_this(),
                                                CONNECTION_OPEN_SENT));
-    BALL_LOG_TRACE << "Connection Open method sent to server: " << openMethod;
+    RMQT_LOG_TRACE << "Connection Open method sent to server: " << openMethod;
 }
 
 void Connection::sendConnectionCloseOk()
@@ -424,11 +574,11 @@ void Connection::sendConnectionCloseOk()
     rmqamqpt::Frame frame;
     Framer::makeMethodFrame(
         &frame, channel, rmqamqpt::ConnectionMethod(closeOkMethod));
-    asyncWriteSingleFrame(serializeFrame(frame),
+    asyncWriteSingleFrame(serializeFrame(frame, d_framePool.get()),
                           bdlf::BindUtil::bind(&Connection::onWriteComplete,
                                                shared_from_this(),
                                                CONNECTION_CLOSEOK_SENT));
-    BALL_LOG_TRACE << "Connection Close-ok method sent to server: "
+    RMQT_LOG_TRACE << "Connection Close-ok method sent to server: "
                    << closeOkMethod;
 }
 
@@ -446,19 +596,19 @@ void Connection::sendConnectionClose(
         &frame, channel, rmqamqpt::ConnectionMethod(closeMethod));
     if (replyCode != rmqamqpt::Constants::REPLY_SUCCESS) {
         asyncWriteSingleFrame(
-            serializeFrame(frame),
+            serializeFrame(frame, d_framePool.get()),
             bdlf::BindUtil::bind(&Connection::onWriteComplete,
                                  shared_from_this(),
                                  CONNECTION_CLOSE_SENT_RECONNECT));
     }
     else {
-        asyncWriteSingleFrame(serializeFrame(frame),
+        asyncWriteSingleFrame(serializeFrame(frame, d_framePool.get()),
                               bdlf::BindUtil::bind(&Connection::onWriteComplete,
                                                    shared_from_this(),
                                                    CONNECTION_CLOSE_SENT_EXIT));
     }
 
-    BALL_LOG_TRACE << "Connection Close method sent to server: " << closeMethod;
+    RMQT_LOG_TRACE << "Connection Close method sent to server: " << closeMethod;
 }
 
 void Connection::connectionException(
@@ -489,25 +639,139 @@ void Connection::connectionException(
     }
 }
 
+void Connection::releaseConnectPermit()
+{
+    if (d_holdsConnectPermit) {
+        d_holdsConnectPermit = false;
+        d_connectLimiter->release();
+    }
+}
+
+void Connection::connectPermitWait(const bsl::weak_ptr<Connection>& weakSelf,
+                                   rmqio::Timer::InterruptReason reason)
+{
+    bsl::shared_ptr<Connection> self = weakSelf.lock();
+    if (!self || reason != rmqio::Timer::EXPIRE) {
+        return;
+    }
+    self->initiateConnect();
+}
+
+void Connection::startIdleTrim()
+{
+    if (!d_idleTrimTimer) {
+        return;
+    }
+    d_idleTrimFrames = 0;
+    d_idleTrimmed    = false;
+    d_idleTrimTimer->start(bdlf::BindUtil::bind(&Connection::idleTrimCheck,
+                                                weak_from_this(),
+                                                bdlf::PlaceHolders::_1));
+}
+
+void Connection::idleTrimCheck(const bsl::weak_ptr<Connection>& weakSelf,
+                               rmqio::Timer::InterruptReason reason)
+{
+    bsl::shared_ptr<Connection> self = weakSelf.lock();
+    if (!self || reason != rmqio::Timer::EXPIRE) {
+        return;
+    }
+
+    if (self->d_idleTrimFrames > self->d_idleTrimWatermark) {
+        self->d_idleTrimmed = false;
+    }
+    else if (!self->d_idleTrimmed) {
+        self->trim();
+        self->d_idleTrimmed = true;
+    }
+    self->d_idleTrimFrames = 0;
+
+    self->d_idleTrimTimer->start(
+        bdlf::BindUtil::bind(&Connection::idleTrimCheck,
+                             weakSelf,
+                             bdlf::PlaceHolders::_1));
+}
+
 void Connection::retry(const bsl::weak_ptr<Connection>& weakSelf)
 {
     bsl::shared_ptr<Connection> self = weakSelf.lock();
     if (!self) {
-        BALL_LOG_TRACE << "Retry handler called during shutdown";
+        RMQT_LOG_TRACE << "Retry handler called during shutdown";
         return;
     }
     self->initiateConnect();
 }
 
+bool Connection::takeOverStandby()
+{
+    if (!d_standby || d_standby->d_state != CONNECTED ||
+        !d_standby->d_socketConnection) {
+        return false;
+    }
+
+    Connection& standby = *d_standby;
+    RMQT_LOG_WARN_THROTTLED << "Failing over " << connectionDebugName()
+                            << " to standby " << standby.connectionDebugName();
+
+    // The standby's socket carries on where it is, now reading into this
+    // connection
+    d_socketConnection.swap(standby.d_socketConnection);
+    d_socketRoute.swap(standby.d_socketRoute);
+    d_socketRoute->connection = weak_from_this();
+    d_endpoint.swap(standby.d_endpoint);
+    bsl::swap(d_currentHost, standby.d_currentHost);
+    bsl::swap(d_countedOnHost, standby.d_countedOnHost);
+    applyChannelWeights();
+
+    d_negotiatedFrameMax         = standby.d_negotiatedFrameMax;
+    d_negotiatedHeartbeatTimeout = standby.d_negotiatedHeartbeatTimeout;
+    d_framer.setMaxFrameSize(d_negotiatedFrameMax);
+    startHeartbeatManager(d_negotiatedHeartbeatTimeout);
+
+    standby.d_heartbeatManager->stop();
+    standby.d_framer.reset();
+    standby.d_state = DISCONNECTED;
+
+    // The standby now stands by on the node which failed, once it is back
+    standby.d_retryHandler->retry(
+        bdlf::BindUtil::bind(&Connection::retry, standby.weak_from_this()));
+
+    d_state = CONNECTED;
+    RMQT_LOG_TRACE << "State now set to: " << d_state;
+    d_metricPublisher->publishCounter("standby_failovers", 1, d_vhostTags);
+    startIdleTrim();
+    if (d_hasBeenConnected) {
+        ++d_reconnects;
+        RMQT_PROBE2(
+            reconnect_end, static_cast<const void*>(this), d_reconnects);
+    }
+    d_hasBeenConnected = true;
+    d_connectTime      = standby.d_connectTime;
+
+    if (d_readsPaused) {
+        applyReadPause();
+    }
+
+    d_channels.openAll();
+
+    if (d_firstConnectCb) {
+        const bool result = true;
+        d_firstConnectCb(result);
+        d_firstConnectCb = ConnectedCallback();
+    }
+
+    return true;
+}
+
 void Connection::closeSocket(DisconnectType disconnectType)
 {
-    BALL_LOG_TRACE << "closeSocket: " << disconnectType;
+    RMQT_LOG_TRACE << "closeSocket: " << disconnectType;
 
     d_state = CONNECTION_CLOSED;
-    BALL_LOG_TRACE << "State now set to: " << d_state;
+    RMQT_LOG_TRACE << "State now set to: " << d_state;
     using bdlf::PlaceHolders::_1;
     if (d_socketConnection && d_socketConnection->isConnected()) {
-        BALL_LOG_TRACE << "Closing Socket Gracefully";
+        RMQT_LOG_TRACE << "Closing Socket Gracefully";
         d_socketConnection->close(
             bdlf::BindUtil::bind(&Connection::socketShutdown,
                                  shared_from_this(),
@@ -532,21 +796,46 @@ void Connection::socketShutdown(DisconnectType dcType,
 
     d_channels.resetAll();
 
+    // The broker may not keep the declared topology once disconnected
+    d_topologyCache->clear();
+
     // Clear buffered frames in the framer
-    d_framer = Framer();
+    d_framer.reset();
 
     d_hungTimer->cancel();
+    if (d_connectPermitTimer) {
+        d_connectPermitTimer->cancel();
+    }
+    if (d_idleTrimTimer) {
+        d_idleTrimTimer->cancel();
+    }
+    releaseConnectPermit();
     d_heartbeatManager->stop();
+    d_heartbeatManager->setReadsPaused(false);
+
+    // A new connection starts unblocked. If the alarm persists the broker
+    // blocks it again once it publishes
+    setBlocked(false, bsl::string());
 
     if (d_socketConnection) {
         d_socketConnection.reset();
     }
+    d_socketRoute.reset();
 
     d_metricPublisher->publishCounter("disconnect_events", 1, d_vhostTags);
 
+    if (d_countedOnHost) {
+        d_hostSelector->disconnected(d_currentHost);
+        d_countedOnHost = false;
+    }
+
     d_state = Connection::DISCONNECTED;
-    BALL_LOG_TRACE << "State now set to: " << d_state;
+    RMQT_LOG_TRACE << "State now set to: " << d_state;
     if (dcType == WILL_RETRY) {
+        if (takeOverStandby()) {
+            return;
+        }
+        RMQT_PROBE1(reconnect_begin, static_cast<const void*>(this));
         d_retryHandler->retry(
             bdlf::BindUtil::bind(&Connection::retry, weak_from_this()));
     }
@@ -576,7 +865,16 @@ class Connection::ConnectionMethodProcessor {
     {
         if (expectedState(start, Connection::PROTOCOL_HEADER_SENT)) {
             conn.d_state = CONNECTION_START_RECEIVED;
-            BALL_LOG_TRACE << "State now set to: " << conn.d_state;
+            RMQT_LOG_TRACE << "State now set to: " << conn.d_state;
+            if (conn.d_topologyStore) {
+                rmqt::FieldTable::const_iterator it =
+                    start.properties().find("cluster_name");
+                conn.d_topologyStore->setClusterName(
+                    it != start.properties().end() &&
+                            it->second.is<bsl::string>()
+                        ? it->second.the<bsl::string>()
+                        : bsl::string());
+            }
             conn.sendConnectionStartOk();
         }
     }
@@ -585,7 +883,7 @@ class Connection::ConnectionMethodProcessor {
     {
         if (expectedState(tune, Connection::CONNECTION_STARTOK_SENT)) {
             conn.d_state = CONNECTION_TUNE_RECEIVED;
-            BALL_LOG_TRACE << "State now set to: " << conn.d_state;
+            RMQT_LOG_TRACE << "State now set to: " << conn.d_state;
             conn.sendConnectionTuneOk(tune);
             conn.sendConnectionOpen();
         }
@@ -597,17 +895,37 @@ class Connection::ConnectionMethodProcessor {
             BALL_LOG_INFO << "Connected " << conn.connectionDebugName();
 
             conn.d_state = CONNECTED;
-            BALL_LOG_TRACE << "State now set to: " << conn.d_state;
+            RMQT_LOG_TRACE << "State now set to: " << conn.d_state;
             conn.d_hungTimer->cancel();
+            conn.releaseConnectPermit();
             conn.d_retryHandler->success();
+            conn.startIdleTrim();
 
+            const bsls::TimeInterval connectTime =
+                bdlt::CurrentTime::now() - conn.d_connectStartTime;
             conn.d_metricPublisher->publishDistribution(
                 conn.d_hasBeenConnected ? "reconnect_time" : "connect_time",
-                (bdlt::CurrentTime::now() - conn.d_connectStartTime)
-                    .totalSecondsAsDouble(),
+                connectTime.totalSecondsAsDouble(),
                 conn.d_vhostTags);
 
+            if (conn.d_hostSelector) {
+                conn.d_hostSelector->connected(conn.d_currentHost,
+                                               connectTime);
+                conn.d_countedOnHost = true;
+            }
+
+            if (conn.d_hasBeenConnected) {
+                ++conn.d_reconnects;
+                RMQT_PROBE2(reconnect_end,
+                            static_cast<const void*>(&conn),
+                            conn.d_reconnects);
+            }
             conn.d_hasBeenConnected = true;
+            conn.d_connectTime      = connectTime;
+
+            if (conn.d_readsPaused) {
+                conn.applyReadPause();
+            }
 
             conn.d_channels.openAll();
 
@@ -626,7 +944,7 @@ class Connection::ConnectionMethodProcessor {
         BALL_LOG_INFO << "Received Connection.Close method from server. "
                       << closeMethod;
         conn.d_state = CONNECTION_CLOSE_RECEIVED;
-        BALL_LOG_TRACE << "State now set to: " << conn.d_state;
+        RMQT_LOG_TRACE << "State now set to: " << conn.d_state;
         conn.sendConnectionCloseOk();
 
         if (closeMethod.classId() || closeMethod.methodId()) {
@@ -636,9 +954,23 @@ class Connection::ConnectionMethodProcessor {
         }
     }
 
+    void operator()(const rmqamqpt::ConnectionBlocked& blocked) const
+    {
+        RMQT_LOG_WARN_THROTTLED << "Broker blocked "
+                                << conn.connectionDebugName() << ": "
+                                << blocked.reason();
+        conn.setBlocked(true, blocked.reason());
+    }
+
+    void operator()(const rmqamqpt::ConnectionUnblocked&) const
+    {
+        BALL_LOG_INFO << "Broker unblocked " << conn.connectionDebugName();
+        conn.setBlocked(false, bsl::string());
+    }
+
     void operator()(const rmqamqpt::ConnectionCloseOk&) const
     {
-        BALL_LOG_TRACE << "Received CLOSE-OK method from server";
+        RMQT_LOG_TRACE << "Received CLOSE-OK method from server";
         const DisconnectType dcType =
             conn.d_state == CONNECTION_CLOSE_SENT_EXIT ? FATAL : WILL_RETRY;
         conn.closeSocket(dcType);
@@ -680,6 +1012,27 @@ class Connection::ConnectionMethodProcessor {
     }
 };
 
+void Connection::setBlocked(bool blocked, const bsl::string& reason)
+{
+    if (blocked == d_publishGate->isClosed()) {
+        return;
+    }
+
+    if (blocked) {
+        d_publishGate->close(reason);
+    }
+    else {
+        d_publishGate->open();
+    }
+
+    d_metricPublisher->publishGauge(
+        "connection_blocked", blocked ? 1 : 0, d_vhostTags);
+
+    if (d_blockedCb) {
+        d_blockedCb(d_endpoint->vhost(), blocked, reason);
+    }
+}
+
 void Connection::processConnectionMethod(
     const rmqamqpt::ConnectionMethod& method)
 {
@@ -702,13 +1055,13 @@ void Connection::processMethod(const rmqamqpt::Method& method)
     }
 }
 
-void Connection::readHandler(const bsl::weak_ptr<Connection>& weakConn,
+void Connection::readHandler(const bsl::shared_ptr<SocketRoute>& route,
                              const rmqamqpt::Frame& frame)
 {
-    bsl::shared_ptr<Connection> conn = weakConn.lock();
+    bsl::shared_ptr<Connection> conn = route->connection.lock();
 
     if (!conn) {
-        BALL_LOG_DEBUG
+        RMQT_LOG_DEBUG
             << "Read data after destruction - socket close in progress";
         return;
     }
@@ -719,6 +1072,10 @@ void Connection::readHandler(const bsl::weak_ptr<Connection>& weakConn,
 void Connection::processNextFrame(const rmqamqpt::Frame& frame)
 {
     d_heartbeatManager->notifyMessageReceived();
+    if (frame.payloadLength()) {
+        // Heartbeats carry no payload, and do not count as traffic
+        ++d_idleTrimFrames;
+    }
 
     uint16_t channel = 0;
     Message received;
@@ -736,7 +1093,7 @@ void Connection::processNextFrame(const rmqamqpt::Frame& frame)
         return;
     }
 
-    BALL_LOG_TRACE << "Received message: MESSAGE=" << received
+    RMQT_LOG_TRACE << "Received message: MESSAGE=" << received
                    << " CHANNEL=" << frame.channel()
                    << " LEN=" << frame.payloadLength();
 
@@ -747,7 +1104,7 @@ void Connection::processNextFrame(const rmqamqpt::Frame& frame)
         }
         else if (received.is<rmqamqpt::Heartbeat>()) {
             // Already notified receipt above
-            BALL_LOG_DEBUG << "Received Heartbeat from server";
+            RMQT_LOG_DEBUG << "Received Heartbeat from server";
             d_heartbeatManager->notifyHeartbeatReceived();
         }
         else {
@@ -756,8 +1113,24 @@ void Connection::processNextFrame(const rmqamqpt::Frame& frame)
         }
     }
     else {
+        // Deliveries are timed from the socket read which completed them
+        bsls::Types::Int64 assembled = 0;
+        if (received.is<rmqt::Message>()) {
+            assembled = rmqio::PipelineClock::now();
+            if (assembled && d_socketConnection) {
+                const rmqio::Connection::ReadTimes readTimes =
+                    d_socketConnection->readTimes();
+                d_pipelineTiming.record(PipelineStage::DECODE,
+                                        readTimes.completed,
+                                        readTimes.decoded);
+                d_pipelineTiming.record(
+                    PipelineStage::ASSEMBLE, readTimes.decoded, assembled);
+            }
+        }
+
         // Handle channel messages
         bool channelExists = d_channels.processReceived(channel, received);
+        d_pipelineTiming.record(PipelineStage::PROCESS, assembled);
 
         if (!channelExists) {
             connectionException(rmqamqpt::Constants::CHANNEL_ERROR,
@@ -776,9 +1149,87 @@ void Connection::startHeartbeatManager(uint32_t timeout)
         bdlf::BindUtil::bind(&Connection::killConnection, this));
 }
 
-void Connection::sendHeartbeat(const rmqamqpt::Frame& heartbeat)
+void Connection::pauseReads()
+{
+    if (d_readsPaused) {
+        return;
+    }
+
+    BALL_LOG_INFO << "Pausing reads, consumers are behind: "
+                  << connectionDebugName();
+    d_readsPaused = true;
+    d_metricPublisher->publishCounter("read_pauses", 1, d_vhostTags);
+    applyReadPause();
+}
+
+void Connection::resumeReads()
+{
+    if (!d_readsPaused) {
+        return;
+    }
+
+    BALL_LOG_INFO << "Resuming reads: " << connectionDebugName();
+    d_readsPaused = false;
+    applyReadPause();
+}
+
+void Connection::applyReadPause()
+{
+    if (d_state != CONNECTED || !d_socketConnection) {
+        return;
+    }
+
+    d_heartbeatManager->setReadsPaused(d_readsPaused);
+    if (d_readsPaused) {
+        d_socketConnection->pauseReading();
+    }
+    else {
+        d_socketConnection->resumeReading();
+    }
+}
+
+void Connection::setChannelWeight(uint16_t channel, unsigned weight)
+{
+    if (weight <= 1) {
+        d_channelWeights.erase(channel);
+    }
+    else {
+        d_channelWeights[channel] = weight;
+    }
+
+    if (d_socketConnection) {
+        d_socketConnection->setChannelWeight(channel, weight);
+    }
+}
+
+void Connection::setChannelWeightWeakPtr(
+    const bsl::weak_ptr<Connection>& weakSelf,
+    uint16_t channel,
+    unsigned weight)
+{
+    bsl::shared_ptr<Connection> self = weakSelf.lock();
+    if (self) {
+        self->setChannelWeight(channel, weight);
+    }
+}
+
+void Connection::applyChannelWeights()
+{
+    if (!d_socketConnection) {
+        return;
+    }
+
+    for (bsl::unordered_map<uint16_t, unsigned>::const_iterator it =
+             d_channelWeights.begin();
+         it != d_channelWeights.end();
+         ++it) {
+        d_socketConnection->setChannelWeight(it->first, it->second);
+    }
+}
+
+void Connection::sendHeartbeat(const rmqamqpt::Frame&)
 {
-    asyncWriteSingleFrame(serializeFrame(heartbeat), &noopWriteComplete);
+    asyncWriteSingleFrame(d_heartbeatFrame, &noopWriteComplete);
 }
 
 void Connection::killConnection()
@@ -815,7 +1266,7 @@ void Connection::handleAsyncChannelSendWeakPtr(
     bsl::shared_ptr<Connection> self = weakSelf.lock();
 
     if (!self) {
-        BALL_LOG_DEBUG << "Channel attempted to send message after its "
+        RMQT_LOG_DEBUG << "Channel attempted to send message after its "
                           "connection has destructed.";
         return;
     }
@@ -832,32 +1283,106 @@ void Connection::handleAsyncChannelSend(
         return;
     }
 
-    BALL_LOG_TRACE << "Sending Method: Message=" << *message
+    RMQT_LOG_TRACE << "Sending Method: Message=" << *message
                    << " CHANNEL=" << channel;
 
-    bsl::vector<rmqamqpt::Frame> frames;
-    d_framer.makeFrames(&frames, channel, *message);
+    const bsls::Types::Int64 framingStart = rmqio::PipelineClock::now();
+
+    // Content body frames reference the message payload directly, so the
+    // payload is gathered into the socket write without being copied
+    bsl::vector<bsl::shared_ptr<rmqio::SerializedFrame> > serializedFrames;
+    d_framer.makeSerializedFrames(&serializedFrames, channel, *message);
 
-    if (frames.size() == 0) {
+    if (serializedFrames.size() == 0) {
         BALL_LOG_ERROR
             << "Attempted to send a message which doesn't serialize: "
             << message;
         return;
     }
 
-    using bdlf::PlaceHolders::_1;
+    writeFrames(serializedFrames, framingStart, callback);
+}
 
+void Connection::handleAsyncChannelSendBatchWeakPtr(
+    const bsl::weak_ptr<Connection>& weakSelf,
+    uint16_t channel,
+    const bsl::shared_ptr<bsl::vector<rmqamqp::Message> >& messages,
+    const rmqio::Connection::SuccessWriteCallback& callback)
+{
+    bsl::shared_ptr<Connection> self = weakSelf.lock();
+
+    if (!self) {
+        RMQT_LOG_DEBUG << "Channel attempted to send messages after its "
+                          "connection has destructed.";
+        return;
+    }
+
+    self->handleAsyncChannelSendBatch(channel, messages, callback);
+}
+
+void Connection::handleAsyncChannelSendBatch(
+    uint16_t channel,
+    const bsl::shared_ptr<bsl::vector<rmqamqp::Message> >& messages,
+    const rmqio::Connection::SuccessWriteCallback& callback)
+{
+    if (!d_socketConnection) {
+        return;
+    }
+
+    RMQT_LOG_TRACE << "Sending batch of " << messages->size()
+                   << " messages CHANNEL=" << channel;
+
+    const bsls::Types::Int64 framingStart = rmqio::PipelineClock::now();
+
+    // Frame the whole batch into one write
     bsl::vector<bsl::shared_ptr<rmqio::SerializedFrame> > serializedFrames;
-    serializedFrames.reserve(frames.size());
-    bsl::transform(frames.cbegin(),
-                   frames.cend(),
-                   bsl::back_inserter(serializedFrames),
-                   &serializeFrame);
+    for (bsl::vector<rmqamqp::Message>::const_iterator it = messages->begin();
+         it != messages->end();
+         ++it) {
+        d_framer.makeSerializedFrames(&serializedFrames, channel, *it);
+    }
 
-    d_socketConnection->asyncWrite(serializedFrames, callback);
+    if (serializedFrames.size() == 0) {
+        BALL_LOG_ERROR << "Attempted to send a batch which doesn't serialize";
+        return;
+    }
+
+    writeFrames(serializedFrames, framingStart, callback);
+}
+
+void Connection::writeFrames(
+    const bsl::vector<bsl::shared_ptr<rmqio::SerializedFrame> >& frames,
+    bsls::Types::Int64 framingStart,
+    const rmqio::Connection::SuccessWriteCallback& callback)
+{
+    if (framingStart) {
+        const bsls::Types::Int64 framed = rmqio::PipelineClock::now();
+        d_pipelineTiming.record(PipelineStage::FRAME, framingStart, framed);
+        d_socketConnection->asyncWrite(
+            frames,
+            bdlf::BindUtil::bind(&Connection::onTimedWrite,
+                                 d_pipelineTiming,
+                                 framed,
+                                 callback));
+    }
+    else {
+        d_socketConnection->asyncWrite(frames, callback);
+    }
+    d_idleTrimFrames += frames.size();
     d_heartbeatManager->notifyMessageSent();
 }
 
+void Connection::onTimedWrite(
+    const PipelineTiming& timing,
+    bsls::Types::Int64 framed,
+    const rmqio::Connection::SuccessWriteCallback& callback)
+{
+    timing.record(PipelineStage::WRITE, framed);
+    if (callback) {
+        callback();
+    }
+}
+
 rmqt::Future<ReceiveChannel> Connection::createTopologySyncedReceiveChannel(
     const rmqt::Topology& topology,
     const rmqt::ConsumerConfig& config,
@@ -872,10 +1397,11 @@ rmqt::Future<ReceiveChannel> Connection::createTopologySyncedReceiveChannel(
 rmqt::Future<SendChannel> Connection::createTopologySyncedSendChannel(
     const rmqt::Topology& topology,
     const bsl::shared_ptr<rmqt::Exchange>& exchange,
-    const bsl::shared_ptr<rmqio::RetryHandler>& retryHandler)
+    const bsl::shared_ptr<rmqio::RetryHandler>& retryHandler,
+    rmqt::PublisherConfirms::Value confirms)
 {
     bsl::shared_ptr<SendChannel> sc =
-        createSendChannel(topology, exchange, retryHandler);
+        createSendChannel(topology, exchange, retryHandler, confirms);
     return sc->waitForReady().then<SendChannel>(passOnSuccess(sc));
 }
 
@@ -889,6 +1415,13 @@ bsl::shared_ptr<ReceiveChannel> Connection::createReceiveChannel(
 
     using namespace bdlf::PlaceHolders;
 
+    rmqt::ConsumerConfig effectiveConfig(config);
+    if (config.ackCoalescingDelay() == bsls::TimeInterval() &&
+        d_defaultAckCoalescingDelay > bsls::TimeInterval()) {
+        effectiveConfig.setAckCoalescingDelay(d_defaultAckCoalescingDelay)
+            .setAckCoalescingTags(d_defaultAckCoalescingTags);
+    }
+
     bsl::shared_ptr<ReceiveChannel> receiveChannel =
         d_channelFactory->createReceiveChannel(
             topology,
@@ -899,13 +1432,37 @@ bsl::shared_ptr<ReceiveChannel> Connection::createReceiveChannel(
                                  _2),
             retryHandler,
             d_metricPublisher,
-            config,
+            effectiveConfig,
             d_endpoint->vhost(),
             ackQueue,
             d_timerFactory->createWithTimeout(
                 bsls::TimeInterval(Channel::k_HUNG_CHANNEL_TIMER_SEC)),
             bdlf::BindUtil::bind(&Connection::channelHung, weak_from_this()));
 
+    if (effectiveConfig.ackCoalescingDelay() > bsls::TimeInterval()) {
+        receiveChannel->enableAckCoalescing(*d_timerFactory);
+    }
+    // Prefetch adapts to ack latency, which a no-ack consumer does not have
+    if (config.adaptivePrefetch() && !config.noAck()) {
+        receiveChannel->enableAdaptivePrefetch(*d_timerFactory);
+    }
+    // Set either way: the channel id may have been used by a lazy consumer
+    d_framer.setLazyHeaders(channelId, config.lazyHeaders());
+    d_framer.setDecodedProperties(channelId, config.decodedProperties());
+    d_framer.setPayloadAllocator(channelId, config.payloadAllocator());
+    receiveChannel->setTopologyCache(d_topologyCache);
+    receiveChannel->setTopologyStore(d_topologyStore);
+    receiveChannel->setAsyncBatchWrite(
+        bdlf::BindUtil::bind(&Connection::handleAsyncChannelSendBatchWeakPtr,
+                             weak_from_this(),
+                             channelId,
+                             _1,
+                             _2));
+    receiveChannel->setPipelinedOpen(true);
+    if (d_memoryBudget) {
+        receiveChannel->setMemoryBudget(d_memoryBudget);
+    }
+
     d_channels.associateChannel(channelId, receiveChannel);
 
     if (d_state == CONNECTED) {
@@ -915,10 +1472,115 @@ bsl::shared_ptr<ReceiveChannel> Connection::createReceiveChannel(
     return receiveChannel;
 }
 
+void Connection::setTuneLimits(bsl::uint32_t frameMax,
+                               bsl::uint16_t channelMax)
+{
+    // AMQP 0.9.1 requires peers to accept frames of at least 4096 bytes
+    d_clientFrameMax   = bsl::max(frameMax, static_cast<bsl::uint32_t>(4096));
+    d_clientChannelMax = channelMax;
+}
+
+void Connection::setDefaultAckCoalescing(const bsls::TimeInterval& delay,
+                                         bsl::size_t tags)
+{
+    d_defaultAckCoalescingDelay = delay;
+    d_defaultAckCoalescingTags  = tags;
+}
+
+void Connection::setResendPacing(bsl::size_t batchMessages)
+{
+    d_resendBatchMessages = batchMessages;
+}
+
+void Connection::setIdleTrim(const bsls::TimeInterval& idlePeriod,
+                             bsl::size_t watermarkFrames)
+{
+    d_idleTrimTimer     = d_timerFactory->createWithTimeout(idlePeriod);
+    d_idleTrimWatermark = watermarkFrames;
+}
+
+void Connection::trim()
+{
+    const bsl::size_t before = retainedBytes();
+
+    if (d_socketConnection) {
+        d_socketConnection->trim();
+    }
+    d_framer.trim();
+
+    const ChannelMap::SendChannelMap& sendChannels =
+        d_channels.getSendChannels();
+    for (ChannelMap::SendChannelMap::const_iterator it = sendChannels.begin();
+         it != sendChannels.end();
+         ++it) {
+        it->second->trim();
+    }
+    const ChannelMap::ReceiveChannelMap& receiveChannels =
+        d_channels.getReceiveChannels();
+    for (ChannelMap::ReceiveChannelMap::const_iterator it =
+             receiveChannels.begin();
+         it != receiveChannels.end();
+         ++it) {
+        it->second->trim();
+    }
+
+    // A multipool never hands its memory back, so start a fresh pool. The
+    // old one goes once the frames and messages still using it are freed.
+    d_framePool = rmqio::FrameBufferPool::create(d_bufferAllocator);
+    d_framer.setBufferAllocator(d_framePool.get());
+    d_heartbeatFrame = bsl::allocate_shared<rmqio::SerializedFrame>(
+        d_framePool.get(), Framer::makeHeartbeatFrame());
+
+    const bsl::size_t after = retainedBytes();
+    RMQT_LOG_DEBUG << "Trimmed idle connection " << connectionDebugName()
+                   << " from " << before << " to " << after << " bytes";
+    d_metricPublisher->publishGauge(
+        "retained_bytes_before_trim", static_cast<double>(before), d_vhostTags);
+    d_metricPublisher->publishGauge(
+        "retained_bytes_after_trim", static_cast<double>(after), d_vhostTags);
+}
+
+bsl::size_t Connection::retainedBytes() const
+{
+    bsl::size_t bytes = static_cast<bsl::size_t>(
+        d_framePool->stats().upstreamBytesOutstanding);
+    if (d_socketConnection) {
+        bytes += d_socketConnection->retainedBytes();
+    }
+
+    const ChannelMap::SendChannelMap& sendChannels =
+        d_channels.getSendChannels();
+    for (ChannelMap::SendChannelMap::const_iterator it = sendChannels.begin();
+         it != sendChannels.end();
+         ++it) {
+        bytes += it->second->retainedBytes();
+    }
+    const ChannelMap::ReceiveChannelMap& receiveChannels =
+        d_channels.getReceiveChannels();
+    for (ChannelMap::ReceiveChannelMap::const_iterator it =
+             receiveChannels.begin();
+         it != receiveChannels.end();
+         ++it) {
+        bytes += it->second->retainedBytes();
+    }
+    return bytes;
+}
+
+void Connection::setConnectLimiter(
+    const bsl::shared_ptr<rmqio::ConnectLimiter>& limiter)
+{
+    d_connectLimiter = limiter;
+    if (d_connectLimiter && !d_connectPermitTimer) {
+        d_connectPermitTimer =
+            d_timerFactory->createWithTimeout(limiter->retryInterval());
+    }
+}
+
 bsl::shared_ptr<SendChannel> Connection::createSendChannel(
     const rmqt::Topology& topology,
     const bsl::shared_ptr<rmqt::Exchange>& exchange,
-    const bsl::shared_ptr<rmqio::RetryHandler>& retryHandler)
+    const bsl::shared_ptr<rmqio::RetryHandler>& retryHandler,
+    rmqt::PublisherConfirms::Value confirms)
 {
     const uint16_t channelId = d_channels.assignId();
 
@@ -940,6 +1602,35 @@ bsl::shared_ptr<SendChannel> Connection::createSendChannel(
                 bsls::TimeInterval(Channel::k_HUNG_CHANNEL_TIMER_SEC)),
             bdlf::BindUtil::bind(&Connection::channelHung, weak_from_this()));
 
+    sendChannel->setAsyncBatchWrite(
+        bdlf::BindUtil::bind(&Connection::handleAsyncChannelSendBatchWeakPtr,
+                             weak_from_this(),
+                             channelId,
+                             _1,
+                             _2));
+
+    d_framer.setLazyHeaders(channelId, false);
+    d_framer.setDecodedProperties(channelId, rmqt::MessageProperty::ALL);
+    d_framer.setPayloadAllocator(
+        channelId, rmqt::ConsumerConfig::PayloadAllocatorFunc());
+    // The id may have been used by an earlier channel with its own weight
+    setChannelWeight(channelId, 1);
+    sendChannel->setWriteWeightCallback(
+        bdlf::BindUtil::bind(&Connection::setChannelWeightWeakPtr,
+                             weak_from_this(),
+                             channelId,
+                             _1));
+    sendChannel->setTopologyCache(d_topologyCache);
+    sendChannel->setTopologyStore(d_topologyStore);
+    sendChannel->setPipelinedOpen(true);
+    sendChannel->setPublishGate(d_publishGate);
+    if (confirms == rmqt::PublisherConfirms::OFF) {
+        sendChannel->setUnconfirmed();
+    }
+    else if (d_resendBatchMessages > 0) {
+        sendChannel->enableResendPacing(d_resendBatchMessages,
+                                        *d_timerFactory);
+    }
     d_channels.associateChannel(channelId, sendChannel);
 
     if (d_state == CONNECTED) {
@@ -979,6 +1670,55 @@ bsl::string Connection::connectionDebugName() const
     return d_connectionName + ": " + d_endpoint->formatAddress();
 }
 
+rmqt::ConnectionStats Connection::stats() const
+{
+    rmqt::ConnectionStats stats;
+    stats.name         = d_connectionName;
+    stats.vhost        = d_endpoint->vhost();
+    stats.connected    = d_state == CONNECTED;
+    stats.queuedWrites =
+        d_socketConnection ? d_socketConnection->queuedWrites() : 0;
+    stats.connectTime = d_connectTime;
+    stats.reconnects  = d_reconnects;
+
+    const ChannelMap::SendChannelMap& sendChannels =
+        d_channels.getSendChannels();
+    for (ChannelMap::SendChannelMap::const_iterator it = sendChannels.begin();
+         it != sendChannels.end();
+         ++it) {
+        rmqt::ChannelStats channel;
+        channel.channelId = it->first;
+        it->second->loadStats(&channel);
+        stats.channels.push_back(channel);
+    }
+
+    const ChannelMap::ReceiveChannelMap& receiveChannels =
+        d_channels.getReceiveChannels();
+    for (ChannelMap::ReceiveChannelMap::const_iterator it =
+             receiveChannels.begin();
+         it != receiveChannels.end();
+         ++it) {
+        rmqt::ChannelStats channel;
+        channel.channelId = it->first;
+        it->second->loadStats(&channel);
+        stats.channels.push_back(channel);
+    }
+
+    for (bsl::vector<rmqt::ChannelStats>::const_iterator it =
+             stats.channels.begin();
+         it != stats.channels.end();
+         ++it) {
+        stats.messagesIn += it->messagesIn;
+        stats.bytesIn += it->bytesIn;
+        stats.messagesOut += it->messagesOut;
+        stats.bytesOut += it->bytesOut;
+        stats.inFlightConfirms += it->inFlightConfirms;
+        stats.unackedDeliveries += it->unackedDeliveries;
+    }
+
+    return stats;
+}
+
 Connection::Factory::Factory(
     const bsl::shared_ptr<rmqio::Resolver>& resolver,
     const bsl::shared_ptr<rmqio::TimerFactory>& timerFactory,
@@ -996,9 +1736,49 @@ Connection::Factory::Factory(
 , d_timerFactory(timerFactory)
 , d_connectionMonitor(connectionMonitor)
 , d_connectionErrorThreshold(connectionErrorThreshold)
+, d_memoryBudget()
+, d_allocator(0)
+, d_tuneLimits()
+, d_defaultAckCoalescingDelay()
+, d_defaultAckCoalescingTags(0)
+, d_resendBatchMessages(0)
+, d_idleTrim()
+, d_jitteredRetry()
+, d_connectLimiter()
+, d_blockedCb()
+, d_topologyStoreDirectory()
+, d_hostSelector()
+, d_heartbeatScheduler()
+, d_heartbeatPost()
 {
 }
 
+void Connection::Factory::setTuneLimits(bsl::uint32_t frameMax,
+                                        bsl::uint16_t channelMax)
+{
+    d_tuneLimits = bsl::make_pair(frameMax, channelMax);
+}
+
+void Connection::Factory::setDefaultAckCoalescing(
+    const bsls::TimeInterval& delay,
+    bsl::size_t tags)
+{
+    d_defaultAckCoalescingDelay = delay;
+    d_defaultAckCoalescingTags  = tags;
+}
+
+void Connection::Factory::setIdleTrim(const bsls::TimeInterval& idlePeriod,
+                                      bsl::size_t watermarkFrames)
+{
+    d_idleTrim = bsl::make_pair(idlePeriod, watermarkFrames);
+}
+
+void Connection::Factory::setJitteredRetry(const bsls::TimeInterval& minWait,
+                                           const bsls::TimeInterval& maxWait)
+{
+    d_jitteredRetry = bsl::make_pair(minWait, maxWait);
+}
+
 bsl::shared_ptr<Connection> Connection::Factory::create(
     const bsl::shared_ptr<rmqt::Endpoint>& endpoint,
     const bsl::shared_ptr<rmqt::Credentials>& credentials,
@@ -1014,7 +1794,25 @@ bsl::shared_ptr<Connection> Connection::Factory::create(
         endpoint,
         credentials,
         generateClientProperties(d_clientProperties, name),
-        name));
+        name,
+        d_allocator));
+    result->setMemoryBudget(d_memoryBudget);
+    if (d_tuneLimits) {
+        result->setTuneLimits(d_tuneLimits->first, d_tuneLimits->second);
+    }
+    result->setDefaultAckCoalescing(d_defaultAckCoalescingDelay,
+                                    d_defaultAckCoalescingTags);
+    result->setResendPacing(d_resendBatchMessages);
+    if (d_idleTrim) {
+        result->setIdleTrim(d_idleTrim->first, d_idleTrim->second);
+    }
+    result->setConnectLimiter(d_connectLimiter);
+    result->setBlockedCallback(d_blockedCb);
+    result->setHostSelector(d_hostSelector);
+    if (!d_topologyStoreDirectory.empty()) {
+        result->setTopologyStore(bsl::make_shared<TopologyStore>(
+            d_topologyStoreDirectory, endpoint->vhost()));
+    }
 
     d_connectionMonitor->addConnection(bsl::weak_ptr<Connection>(result));
 
@@ -1023,24 +1821,32 @@ bsl::shared_ptr<Connection> Connection::Factory::create(
 
 bsl::shared_ptr<rmqio::RetryHandler> Connection::Factory::newRetryHandler()
 {
+    const bsl::shared_ptr<rmqio::RetryStrategy> strategy =
+        d_jitteredRetry
+            ? bsl::shared_ptr<rmqio::RetryStrategy>(
+                  bsl::make_shared<rmqio::JitteredRetryStrategy>(
+                      d_jitteredRetry->first, d_jitteredRetry->second))
+            : bsl::make_shared<rmqio::BackoffLevelRetryStrategy>();
+
     return d_connectionErrorThreshold
                ? bsl::shared_ptr<rmqio::RetryHandler>(
                      bsl::make_shared<rmqio::ConnectionRetryHandler>(
                          d_timerFactory,
                          d_errorCb,
                          d_successCb,
-                         bsl::make_shared<rmqio::BackoffLevelRetryStrategy>(),
+                         strategy,
                          *d_connectionErrorThreshold))
                : bsl::make_shared<rmqio::RetryHandler>(
-                     d_timerFactory,
-                     d_errorCb,
-                     d_successCb,
-                     bsl::make_shared<rmqio::BackoffLevelRetryStrategy>());
+                     d_timerFactory, d_errorCb, d_successCb, strategy);
 }
 
 bsl::shared_ptr<rmqamqp::HeartbeatManager>
 Connection::Factory::newHeartBeatManager()
 {
+    if (d_heartbeatScheduler) {
+        return bsl::make_shared<rmqamqp::ThreadedHeartbeatManager>(
+            d_heartbeatScheduler, d_heartbeatPost);
+    }
     return bsl::make_shared<rmqamqp::HeartbeatManagerImpl>(d_timerFactory);
 }
 
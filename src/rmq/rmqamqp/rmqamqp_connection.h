@@ -23,27 +23,46 @@
 #include <rmqamqp_connectionmonitor.h>
 #include <rmqamqp_framer.h>
 #include <rmqamqp_heartbeatmanager.h>
-
+#include <rmqamqp_hostselector.h>
+#include <rmqamqp_memorybudget.h>
+#include <rmqamqp_pipelinetiming.h>
+#include <rmqamqp_publishgate.h>
+#include <rmqamqp_threadedheartbeatmanager.h>
+#include <rmqamqp_topologycache.h>
+#include <rmqamqp_topologystore.h>
+
+#include <rmqio_connectlimiter.h>
 #include <rmqio_eventloop.h>
+#include <rmqio_framebufferpool.h>
 #include <rmqio_resolver.h>
 #include <rmqio_retryhandler.h>
+#include <rmqio_serializedframe.h>
 #include <rmqio_timer.h>
 #include <rmqp_metricpublisher.h>
-#include <rmqt_consumerackbatch.h>
+#include <rmqt_consumerackqueue.h>
+#include <rmqt_connectionstats.h>
 #include <rmqt_consumerconfig.h>
 #include <rmqt_credentials.h>
 #include <rmqt_endpoint.h>
 #include <rmqt_message.h>
+#include <rmqt_properties.h>
+#include <rmqt_result.h>
 
 #include <ball_log.h>
+#include <bdlmt_eventscheduler.h>
+#include <bslma_allocator.h>
 #include <bslmt_mutex.h>
 #include <bsls_timeinterval.h>
+#include <bsls_types.h>
 
+#include <bsl_cstddef.h>
+#include <bsl_cstdint.h>
 #include <bsl_functional.h>
 #include <bsl_memory.h>
 #include <bsl_optional.h>
 #include <bsl_string.h>
 #include <bsl_string_view.h>
+#include <bsl_unordered_map.h>
 #include <bsl_utility.h>
 #include <bsl_vector.h>
 
@@ -106,11 +125,14 @@ class Connection : public bsl::enable_shared_from_this<Connection>,
     /// The function must be called from the Connection's EventLoop thread.
     /// Calling this function when disconnected will successfully return a
     /// send channel future object.  The future resolves when the connection and
-    /// channel is established and the topology is sync'd.
+    /// channel is established and the topology is sync'd. With `confirms`
+    /// OFF the channel publishes without publisher confirms, see
+    /// `SendChannel::setUnconfirmed`.
     virtual rmqt::Future<SendChannel> createTopologySyncedSendChannel(
         const rmqt::Topology& topology,
         const bsl::shared_ptr<rmqt::Exchange>& exchange,
-        const bsl::shared_ptr<rmqio::RetryHandler>& retryHandler);
+        const bsl::shared_ptr<rmqio::RetryHandler>& retryHandler,
+        rmqt::PublisherConfirms::Value confirms);
 
     /// Declares a new channel which can be used to receive messages
     /// The function must be called from the Connection's EventLoop thread.
@@ -128,18 +150,120 @@ class Connection : public bsl::enable_shared_from_this<Connection>,
     /// Calling this function when disconnected will successfully return a
     /// channel object. The channel will be opened when the connection is
     /// established
-    bsl::shared_ptr<SendChannel>
-    createSendChannel(const rmqt::Topology& topology,
-                      const bsl::shared_ptr<rmqt::Exchange>& exchange,
-                      const bsl::shared_ptr<rmqio::RetryHandler>& retryHandler);
+    bsl::shared_ptr<SendChannel> createSendChannel(
+        const rmqt::Topology& topology,
+        const bsl::shared_ptr<rmqt::Exchange>& exchange,
+        const bsl::shared_ptr<rmqio::RetryHandler>& retryHandler,
+        rmqt::PublisherConfirms::Value confirms = rmqt::PublisherConfirms::ON);
 
     State state() const { return d_state; }
 
+    /// Return a snapshot of this connection's traffic and of each of its
+    /// channels. Must be called from the Connection's EventLoop thread.
+    rmqt::ConnectionStats stats() const;
+
+    /// Count the deliveries of receive channels created from here on
+    /// against `budget`, see `ReceiveChannel::setMemoryBudget`
+    void setMemoryBudget(const bsl::shared_ptr<MemoryBudget>& budget)
+    {
+        d_memoryBudget = budget;
+    }
+
+    /// Offer `frameMax` (at least 4096) and `channelMax` (0 to accept the
+    /// broker's) when tuning the connection. The broker's own limits still
+    /// apply. Takes effect from the next connect.
+    void setTuneLimits(bsl::uint32_t frameMax, bsl::uint16_t channelMax);
+
+    /// Hold the acks of receive channels created from here on, whose
+    /// ConsumerConfig does not set `ackCoalescingDelay`, for up to `delay`
+    /// and `tags` acks, see `ConsumerConfig::setAckCoalescingDelay`
+    void setDefaultAckCoalescing(const bsls::TimeInterval& delay,
+                                 bsl::size_t tags);
+
+    /// Resend the backlog of send channels created from here on
+    /// `batchMessages` at a time after a reconnect, see
+    /// `SendChannel::enableResendPacing`. 0 resends it at once.
+    void setResendPacing(bsl::size_t batchMessages);
+
+    /// Take a permit from `limiter` before each connect, holding it until
+    /// the AMQP handshake completes or the attempt fails. While none is free
+    /// the connection retries after `ConnectLimiter::retryInterval`.
+    void
+    setConnectLimiter(const bsl::shared_ptr<rmqio::ConnectLimiter>& limiter);
+
+    /// Keep `standby`, a connection to another node of the cluster with no
+    /// channels of its own, connected alongside this one. When this
+    /// connection loses its broker it takes over the standby's socket, if
+    /// the standby is connected, and reopens its channels there straight
+    /// away rather than reconnecting. The standby then reconnects to the
+    /// node which failed. Must be set before `startFirstConnection`.
+    void setStandby(const bsl::shared_ptr<Connection>& standby)
+    {
+        d_standby = standby;
+    }
+
+    /// Invoke `callback` whenever the broker blocks or unblocks this
+    /// connection, see `publishGate`
+    void setBlockedCallback(const rmqt::ConnectionBlockedCallback& callback)
+    {
+        d_blockedCb = callback;
+    }
+
+    /// Pass `store` to channels created from here on, see
+    /// `Channel::setTopologyStore`. Its records are kept per broker
+    /// cluster, named by the `cluster_name` sent in connection.start.
+    void setTopologyStore(const bsl::shared_ptr<TopologyStore>& store)
+    {
+        d_topologyStore = store;
+    }
+
+    /// Pick which of the endpoint's hosts each connection attempt goes to
+    /// with `selector`, and report the outcome back to it. Without one,
+    /// every attempt goes to the first host.
+    void setHostSelector(const bsl::shared_ptr<HostSelector>& selector)
+    {
+        d_hostSelector = selector;
+    }
+
+    /// Closed while the broker has blocked this connection with
+    /// Connection.Blocked. Send channels created from here pass it on to
+    /// their producers, which hold back sends while it is closed.
+    const bsl::shared_ptr<PublishGate>& publishGate() const
+    {
+        return d_publishGate;
+    }
+
+    bool blocked() const { return d_publishGate->isClosed(); }
+
+    /// Stop reading from the broker, so that deliveries back up in the
+    /// broker rather than in memory, until `resumeReads`. Held across
+    /// reconnects. Must be called on the event loop thread.
+    void pauseReads();
+
+    /// Undo `pauseReads`. Must be called on the event loop thread.
+    void resumeReads();
+
+    bool readsPaused() const { return d_readsPaused; }
+
+    /// Let `channel` write up to `weight` content frames each time it takes
+    /// its turn among the channels with publishes queued, so that a large
+    /// publish on one channel does not hold up the others. Held across
+    /// reconnects. Must be called on the event loop thread.
+    void setChannelWeight(uint16_t channel, unsigned weight);
+
     /// Initiates a graceful connection close. closeCallback is invoked once the
     /// connection has been closed.
     /// This method is virtual for testing purposes.
     virtual void close(const CloseFinishCallback& closeCallback);
 
+    /// Cancel the consumers of every receive channel and wait for the
+    /// messages they were delivered to be acked, and for the confirms of
+    /// every send channel, all at once. The returned Future resolves when
+    /// all have finished; failures are logged rather than returned, so one
+    /// channel does not cut the wait for the others short. Channels stay
+    /// open. Must be called on the event loop thread.
+    rmqt::Future<> drainChannels();
+
     void startFirstConnection(const ConnectedCallback& connectedCallback);
 
     const ChannelMap& channelMap() const BSLS_KEYWORD_OVERRIDE
@@ -150,6 +274,32 @@ class Connection : public bsl::enable_shared_from_this<Connection>,
     bsl::string
     connectionDebugName() const BSLS_KEYWORD_OVERRIDE BSLS_KEYWORD_FINAL;
 
+    /// Once the connection has carried no more than `watermarkFrames` frames
+    /// (heartbeats aside) in an `idlePeriod`, `trim` it, once per idle
+    /// stretch. Checked every `idlePeriod` while connected. Must be set
+    /// before `startFirstConnection`.
+    void setIdleTrim(const bsls::TimeInterval& idlePeriod,
+                     bsl::size_t watermarkFrames);
+
+    /// Give back the memory a burst of traffic left this connection holding
+    /// on to: spare read and write buffer capacity, each channel's ring of
+    /// messages in flight, and the pooled memory of outgoing frames and
+    /// incoming payloads, by moving to a fresh pool. Publishes the
+    /// `retained_bytes_before_trim` and `retained_bytes_after_trim` gauges.
+    /// Must be called on the event loop thread.
+    void trim();
+
+    /// Return the bytes this connection holds on to for its traffic, see
+    /// `trim`. Must be called on the event loop thread.
+    bsl::size_t retainedBytes() const;
+
+    /// Allocation counters of the pool backing outgoing frames. In steady
+    /// state `upstreamAllocations` should not grow.
+    rmqio::FrameBufferPool::Stats frameBufferPoolStats() const
+    {
+        return d_framePool->stats();
+    }
+
   protected:
     /// Constructs + begins connecting to the given AMQP endpoint
     /// \param resolver        Used to create sockets to the broker
@@ -162,6 +312,10 @@ class Connection : public bsl::enable_shared_from_this<Connection>,
     /// \param endpoint        references the vhost this connection is
     ///                        joining
     /// \param credentials     Credentials used to connect to the broker
+    /// \param allocator       Upstream of the pool supplying frames and
+    ///                        incoming message payloads, the default
+    ///                        allocator if 0. Must be thread safe and
+    ///                        outlive every message.
     Connection(const bsl::shared_ptr<rmqio::Resolver>& resolver,
                const bsl::shared_ptr<rmqio::RetryHandler>& retryHandler,
                const bsl::shared_ptr<rmqamqp::HeartbeatManager>& hbManager,
@@ -171,9 +325,16 @@ class Connection : public bsl::enable_shared_from_this<Connection>,
                const bsl::shared_ptr<rmqt::Endpoint>& endpoint,
                const bsl::shared_ptr<rmqt::Credentials>& credentials,
                const rmqt::FieldTable& clientProperties,
-               bsl::string_view name);
+               bsl::string_view name,
+               bslma::Allocator* allocator = 0);
 
   private:
+    /// Routes a socket's reads and errors to the connection driving it,
+    /// which changes when a standby's socket is taken over
+    struct SocketRoute {
+        bsl::weak_ptr<Connection> connection;
+    };
+
     bsl::shared_ptr<rmqio::Resolver> d_resolver;
     bsl::shared_ptr<rmqio::RetryHandler> d_retryHandler;
     bsl::shared_ptr<rmqamqp::HeartbeatManager> d_heartbeatManager;
@@ -183,13 +344,51 @@ class Connection : public bsl::enable_shared_from_this<Connection>,
     class ConnectionMethodProcessor;
 
     bsl::shared_ptr<rmqio::Connection> d_socketConnection;
+    bsl::shared_ptr<SocketRoute> d_socketRoute;
+    bsl::shared_ptr<Connection> d_standby;
     bsl::shared_ptr<rmqamqp::ChannelFactory> d_channelFactory;
     bsl::shared_ptr<rmqp::MetricPublisher> d_metricPublisher;
+    /// Upstream of `d_framePool`, and of the pools replacing it on `trim`
+    bslma::Allocator* d_bufferAllocator;
+    bsl::shared_ptr<rmqio::FrameBufferPool> d_framePool;
     Framer d_framer;
+    /// Encoded once, as every heartbeat is the same eight bytes
+    bsl::shared_ptr<rmqio::SerializedFrame> d_heartbeatFrame;
     State d_state;
     rmqt::FieldTable d_clientProperties;
     ChannelMap d_channels;
+    /// Entities declared by this connection's channels since it connected
+    bsl::shared_ptr<TopologyCache> d_topologyCache;
+    bsl::shared_ptr<TopologyStore> d_topologyStore;
+    bsl::shared_ptr<HostSelector> d_hostSelector;
+    /// Host of the latest connection attempt
+    rmqt::Endpoint::Host d_currentHost;
+    /// Whether `d_hostSelector` counts this connection on `d_currentHost`
+    bool d_countedOnHost;
+    bsl::shared_ptr<MemoryBudget> d_memoryBudget;
+    bsl::shared_ptr<PublishGate> d_publishGate;
+    rmqt::ConnectionBlockedCallback d_blockedCb;
+    bsl::uint32_t d_clientFrameMax;
+    bsl::uint16_t d_clientChannelMax;
+    bsl::uint32_t d_negotiatedFrameMax;
+    bsl::uint16_t d_negotiatedHeartbeatTimeout;
+    bsls::TimeInterval d_defaultAckCoalescingDelay;
+    bsl::size_t d_defaultAckCoalescingTags;
+    bsl::size_t d_resendBatchMessages;
+    bool d_readsPaused;
+    /// Write weights other than 1, passed on to each new socket
+    bsl::unordered_map<uint16_t, unsigned> d_channelWeights;
     bsl::shared_ptr<rmqio::Timer> d_hungTimer;
+    bsl::shared_ptr<rmqio::ConnectLimiter> d_connectLimiter;
+    bsl::shared_ptr<rmqio::Timer> d_connectPermitTimer;
+    bool d_holdsConnectPermit;
+    /// Checks for idleness every idle period, if `setIdleTrim` was called
+    bsl::shared_ptr<rmqio::Timer> d_idleTrimTimer;
+    bsl::size_t d_idleTrimWatermark;
+    /// Frames carried since the last check
+    bsl::size_t d_idleTrimFrames;
+    /// Set once trimmed, until traffic picks up again
+    bool d_idleTrimmed;
 
     bsl::shared_ptr<rmqio::TimerFactory> d_timerFactory;
 
@@ -200,13 +399,32 @@ class Connection : public bsl::enable_shared_from_this<Connection>,
     bool d_hasBeenConnected; // For metrics purposes -- indicates whether this
                              // instance has successfully connected at least
                              // once so far
+    bsls::TimeInterval d_connectTime; ///< Duration of the last handshake
+    bsls::Types::Int64 d_reconnects;
 
     bsl::vector<bsl::pair<bsl::string, bsl::string> > d_vhostTags;
+    PipelineTiming d_pipelineTiming;
     bsl::string d_connectionName;
 
     /// Initiate connection
     void initiateConnect();
 
+    /// Record that the broker has `blocked` (for `reason`) or unblocked the
+    /// connection, unless nothing changed
+    void setBlocked(bool blocked, const bsl::string& reason);
+
+    /// Return the permit taken from `d_connectLimiter`, if held
+    void releaseConnectPermit();
+
+    static void connectPermitWait(const bsl::weak_ptr<Connection>& weakSelf,
+                                  rmqio::Timer::InterruptReason reason);
+
+    /// Start checking for idleness, if `setIdleTrim` was called
+    void startIdleTrim();
+
+    static void idleTrimCheck(const bsl::weak_ptr<Connection>& weakSelf,
+                              rmqio::Timer::InterruptReason reason);
+
     // ConnectionMethods
     void sendConnectionStartOk();
     void sendConnectionTuneOk(const rmqamqpt::ConnectionTune& tuneMethod);
@@ -240,7 +458,7 @@ class Connection : public bsl::enable_shared_from_this<Connection>,
     // Frame Method Router
     void processMethod(const rmqamqpt::Method& method);
 
-    static void readHandler(const bsl::weak_ptr<Connection>& weakConn,
+    static void readHandler(const bsl::shared_ptr<SocketRoute>& route,
                             const rmqamqpt::Frame& frame);
 
     // Callback for new frames
@@ -259,7 +477,7 @@ class Connection : public bsl::enable_shared_from_this<Connection>,
     static void connectErrorCb(const bsl::weak_ptr<Connection> weakSelf,
                                const rmqio::Resolver::Error& error);
 
-    static void socketError(const bsl::weak_ptr<Connection>& weakConn,
+    static void socketError(const bsl::shared_ptr<SocketRoute>& route,
                             const rmqio::Connection::ReturnCode& rc);
 
     // Async, registers callback for read Messages
@@ -278,8 +496,17 @@ class Connection : public bsl::enable_shared_from_this<Connection>,
     /// Callback for retrying connection
     static void retry(const bsl::weak_ptr<Connection>& weakSelf);
 
+    /// Move the socket of `d_standby` to this connection and reopen the
+    /// channels on it. Return false, doing nothing, unless the standby is
+    /// connected.
+    bool takeOverStandby();
+
     void startHeartbeatManager(uint32_t timeout);
 
+    /// Pass `d_readsPaused` on to the socket and heartbeat manager. Reads
+    /// are only paused once connected, so a handshake is never held up
+    void applyReadPause();
+
     void sendHeartbeat(const rmqamqpt::Frame&);
 
     void killConnection();
@@ -299,6 +526,39 @@ class Connection : public bsl::enable_shared_from_this<Connection>,
         const bsl::shared_ptr<rmqamqp::Message>& message,
         const rmqio::Connection::SuccessWriteCallback& callback);
 
+    static void handleAsyncChannelSendBatchWeakPtr(
+        const bsl::weak_ptr<Connection>& weakSelf,
+        uint16_t channel,
+        const bsl::shared_ptr<bsl::vector<rmqamqp::Message> >& messages,
+        const rmqio::Connection::SuccessWriteCallback& callback);
+
+    static void
+    setChannelWeightWeakPtr(const bsl::weak_ptr<Connection>& weakSelf,
+                            uint16_t channel,
+                            unsigned weight);
+
+    /// Pass `d_channelWeights` on to the socket
+    void applyChannelWeights();
+
+    /// Write `frames`, which framing started to produce at `framingStart`
+    /// (a `rmqio::PipelineClock::now()` timestamp, zero if untimed)
+    void writeFrames(
+        const bsl::vector<bsl::shared_ptr<rmqio::SerializedFrame> >& frames,
+        bsls::Types::Int64 framingStart,
+        const rmqio::Connection::SuccessWriteCallback& callback);
+
+    /// Record the write of frames framed at `framed`, then invoke
+    /// `callback`
+    static void
+    onTimedWrite(const PipelineTiming& timing,
+                 bsls::Types::Int64 framed,
+                 const rmqio::Connection::SuccessWriteCallback& callback);
+
+    void handleAsyncChannelSendBatch(
+        uint16_t channel,
+        const bsl::shared_ptr<bsl::vector<rmqamqp::Message> >& messages,
+        const rmqio::Connection::SuccessWriteCallback& callback);
+
     void asyncWriteSingleFrame(
         const bsl::shared_ptr<rmqio::SerializedFrame>& frame,
         const rmqio::Connection::SuccessWriteCallback& callback);
@@ -324,6 +584,82 @@ class Connection::Factory {
            const bsl::shared_ptr<rmqt::Credentials>& credentials,
            const bsl::string& name = "");
 
+    /// Share `budget` between the connections created from here on, see
+    /// `Connection::setMemoryBudget`
+    void setMemoryBudget(const bsl::shared_ptr<MemoryBudget>& budget)
+    {
+        d_memoryBudget = budget;
+    }
+
+    /// Pool the frames and message payloads of connections created from
+    /// here on from `allocator`, see `Connection::Connection`
+    void setAllocator(bslma::Allocator* allocator)
+    {
+        d_allocator = allocator;
+    }
+
+    /// See `Connection::setTuneLimits`
+    void setTuneLimits(bsl::uint32_t frameMax, bsl::uint16_t channelMax);
+
+    /// See `Connection::setDefaultAckCoalescing`
+    void setDefaultAckCoalescing(const bsls::TimeInterval& delay,
+                                 bsl::size_t tags);
+
+    /// See `Connection::setResendPacing`
+    void setResendPacing(bsl::size_t batchMessages)
+    {
+        d_resendBatchMessages = batchMessages;
+    }
+
+    /// See `Connection::setIdleTrim`
+    void setIdleTrim(const bsls::TimeInterval& idlePeriod,
+                     bsl::size_t watermarkFrames);
+
+    /// Back off reconnects with `rmqio::JitteredRetryStrategy` waiting
+    /// between `minWait` and `maxWait`, instead of
+    /// `rmqio::BackoffLevelRetryStrategy`
+    void setJitteredRetry(const bsls::TimeInterval& minWait,
+                          const bsls::TimeInterval& maxWait);
+
+    /// See `Connection::setBlockedCallback`
+    void setBlockedCallback(const rmqt::ConnectionBlockedCallback& callback)
+    {
+        d_blockedCb = callback;
+    }
+
+    /// Share `limiter` between the connections created from here on, see
+    /// `Connection::setConnectLimiter`
+    void
+    setConnectLimiter(const bsl::shared_ptr<rmqio::ConnectLimiter>& limiter)
+    {
+        d_connectLimiter = limiter;
+    }
+
+    /// Keep a `TopologyStore` in `directory`, which must exist, for each
+    /// connection created from here on. An empty `directory` keeps none.
+    void setTopologyStoreDirectory(const bsl::string& directory)
+    {
+        d_topologyStoreDirectory = directory;
+    }
+
+    /// Share `selector` between the connections created from here on, see
+    /// `Connection::setHostSelector`
+    void setHostSelector(const bsl::shared_ptr<HostSelector>& selector)
+    {
+        d_hostSelector = selector;
+    }
+
+    /// Check the heartbeat deadlines of connections created from here on
+    /// on `scheduler`'s thread, posting sends and liveness checks to their
+    /// event loop through `post`, see `ThreadedHeartbeatManager`
+    void setHeartbeatScheduler(
+        const bsl::shared_ptr<bdlmt::EventScheduler>& scheduler,
+        const ThreadedHeartbeatManager::Post& post)
+    {
+        d_heartbeatScheduler = scheduler;
+        d_heartbeatPost      = post;
+    }
+
   protected:
     virtual bsl::shared_ptr<rmqio::RetryHandler> newRetryHandler();
     virtual bsl::shared_ptr<rmqamqp::HeartbeatManager> newHeartBeatManager();
@@ -341,6 +677,21 @@ class Connection::Factory {
     const bsl::shared_ptr<rmqio::TimerFactory> d_timerFactory;
     const bsl::shared_ptr<ConnectionMonitor> d_connectionMonitor;
     const bsl::optional<bsls::TimeInterval> d_connectionErrorThreshold;
+    bsl::shared_ptr<MemoryBudget> d_memoryBudget;
+    bslma::Allocator* d_allocator;
+    bsl::optional<bsl::pair<bsl::uint32_t, bsl::uint16_t> > d_tuneLimits;
+    bsls::TimeInterval d_defaultAckCoalescingDelay;
+    bsl::size_t d_defaultAckCoalescingTags;
+    bsl::size_t d_resendBatchMessages;
+    bsl::optional<bsl::pair<bsls::TimeInterval, bsl::size_t> > d_idleTrim;
+    bsl::optional<bsl::pair<bsls::TimeInterval, bsls::TimeInterval> >
+        d_jitteredRetry;
+    bsl::shared_ptr<rmqio::ConnectLimiter> d_connectLimiter;
+    rmqt::ConnectionBlockedCallback d_blockedCb;
+    bsl::string d_topologyStoreDirectory;
+    bsl::shared_ptr<HostSelector> d_hostSelector;
+    bsl::shared_ptr<bdlmt::EventScheduler> d_heartbeatScheduler;
+    ThreadedHeartbeatManager::Post d_heartbeatPost;
 }; // class Connection::Factory
 } // namespace rmqamqp
 } // namespace BloombergLP
@@ -15,10 +15,14 @@
 
 #include <rmqamqp_contentmaker.h>
 
+#include <rmqt_log.h>
 #include <rmqt_properties.h>
 
 #include <ball_log.h>
+#include <bslma_default.h>
+
 #include <bsl_algorithm.h>
+#include <bsl_cstring.h>
 
 namespace BloombergLP {
 namespace rmqamqp {
@@ -26,38 +30,198 @@ namespace {
 BALL_LOG_SET_NAMESPACE_CATEGORY("RMQAMQP.CONTENTMAKER")
 }
 
-ContentMaker::ContentMaker(const rmqamqpt::ContentHeader& contentHeader)
-: d_header(bsl::make_shared<rmqamqpt::ContentHeader>(contentHeader))
-, d_body(bsl::make_shared<bsl::vector<uint8_t> >())
+ContentMaker::ContentMaker(const rmqamqpt::ContentHeader& contentHeader,
+                           bslma::Allocator* allocator)
+: d_allocator(bslma::Default::allocator(allocator))
+, d_header(contentHeader)
+, d_body()
+, d_heldFrames(d_allocator)
+, d_segments()
+, d_payloadBuffer()
+, d_payloadBufferOffset(0)
 , d_remainingContentBytes(contentHeader.bodySize())
 {
-    BALL_LOG_TRACE << "remaining: " << d_remainingContentBytes;
-    d_body->reserve(contentHeader.bodySize());
+    RMQT_LOG_TRACE << "remaining: " << d_remainingContentBytes;
+}
+
+ContentMaker::ContentMaker(const ContentMaker& other,
+                           bslma::Allocator* allocator)
+: d_allocator(bslma::Default::allocator(allocator))
+, d_header(other.d_header)
+, d_body(other.d_body)
+, d_heldFrames(other.d_heldFrames, d_allocator)
+, d_segments(other.d_segments)
+, d_payloadBuffer(other.d_payloadBuffer)
+, d_payloadBufferOffset(other.d_payloadBufferOffset)
+, d_remainingContentBytes(other.d_remainingContentBytes)
+{
+}
+
+void ContentMaker::reset(const rmqamqpt::ContentHeader& contentHeader)
+{
+    clear();
+    d_header                = contentHeader;
+    d_remainingContentBytes = contentHeader.bodySize();
+}
+
+void ContentMaker::clear()
+{
+    // The body and segments are shared with the messages made, so they are
+    // let go of rather than reused
+    d_body.reset();
+    d_segments.reset();
+    d_payloadBuffer.reset();
+    d_payloadBufferOffset = 0;
+    d_heldFrames.clear();
+}
+
+void ContentMaker::setPayloadBuffer(const bsl::shared_ptr<uint8_t>& buffer)
+{
+    d_payloadBuffer       = buffer;
+    d_payloadBufferOffset = 0;
 }
 
 bool ContentMaker::done() const { return d_remainingContentBytes <= 0; }
 
 rmqt::Message ContentMaker::message() const
 {
-    return rmqt::Message(d_body, d_header->properties().toProperties());
+    const rmqt::Properties properties = d_header.properties().toProperties();
+
+    // Unless assembled or chained, the payload is the lone held frame, if any
+    const uint8_t* data =
+        d_heldFrames.empty() ? 0 : d_heldFrames.front().payload();
+    const bsl::size_t size =
+        d_heldFrames.empty() ? 0 : d_heldFrames.front().payloadLength();
+
+    rmqt::Message message =
+        d_payloadBuffer
+            ? rmqt::Message(d_payloadBuffer.get(),
+                            d_payloadBufferOffset,
+                            d_payloadBuffer,
+                            properties)
+        : d_segments
+            ? rmqt::Message(
+                  bsl::shared_ptr<const rmqt::SegmentedPayload>(d_segments),
+                  properties)
+        : d_body ? rmqt::Message(d_body, properties)
+                 : rmqt::Message(data, size, properties);
+    message.setHeadersView(d_header.properties().headersView());
+    return message;
 }
 
 ContentMaker::ReturnCode
 ContentMaker::appendContentBody(const rmqamqpt::ContentBody& contentBody)
 {
-    BALL_LOG_TRACE << "remaining: " << d_remainingContentBytes
+    RMQT_LOG_TRACE << "remaining: " << d_remainingContentBytes
                    << ", body: " << contentBody.dataLength();
-    if (d_remainingContentBytes < contentBody.dataLength()) {
+    return appendBytes(contentBody.data().data(), contentBody.dataLength());
+}
+
+ContentMaker::ReturnCode
+ContentMaker::appendContentFrame(const rmqamqpt::Frame& frame)
+{
+    RMQT_LOG_TRACE << "remaining: " << d_remainingContentBytes
+                   << ", body: " << frame.payloadLength();
+    if (d_payloadBuffer) {
+        return appendToPayloadBuffer(frame.payload(), frame.payloadLength());
+    }
+
+    if (d_remainingContentBytes < frame.payloadLength()) {
+        return ERROR;
+    }
+
+    d_remainingContentBytes -= frame.payloadLength();
+    d_heldFrames.push_back(frame);
+
+    if (!done()) {
+        return PARTIAL;
+    }
+
+    if (!d_body && d_heldFrames.size() > 1) {
+        chainHeldFrames();
+    }
+    else if (d_body || d_heldFrames.front().payloadLength() >
+                           rmqt::Message::INLINE_PAYLOAD_CAPACITY) {
+        assembleHeldFrames();
+    }
+    // Otherwise the lone frame is copied into the message when it is made
+    return DONE;
+}
+
+ContentMaker::ReturnCode ContentMaker::appendBytes(const uint8_t* data,
+                                                   bsl::size_t length)
+{
+    if (d_payloadBuffer) {
+        return appendToPayloadBuffer(data, length);
+    }
+
+    if (d_remainingContentBytes < length) {
+        return ERROR;
+    }
+
+    // Keep body bytes in order if frames are also being held
+    assembleHeldFrames();
+
+    bsl::vector<uint8_t>& contents = body();
+    contents.insert(contents.end(), data, data + length);
+
+    d_remainingContentBytes -= length;
+    return done() ? DONE : PARTIAL;
+}
+
+ContentMaker::ReturnCode
+ContentMaker::appendToPayloadBuffer(const uint8_t* data, bsl::size_t length)
+{
+    if (d_remainingContentBytes < length) {
         return ERROR;
     }
 
-    bsl::copy(contentBody.data().begin(),
-              contentBody.data().end(),
-              bsl::back_inserter(*d_body));
+    bsl::memcpy(d_payloadBuffer.get() + d_payloadBufferOffset, data, length);
+    d_payloadBufferOffset += length;
 
-    d_remainingContentBytes -= contentBody.dataLength();
+    d_remainingContentBytes -= length;
     return done() ? DONE : PARTIAL;
 }
 
+void ContentMaker::assembleHeldFrames()
+{
+    if (d_heldFrames.empty()) {
+        return;
+    }
+
+    bsl::vector<uint8_t>& contents = body();
+    for (bsl::vector<rmqamqpt::Frame>::const_iterator it =
+             d_heldFrames.cbegin();
+         it != d_heldFrames.cend();
+         ++it) {
+        contents.insert(
+            contents.end(), it->payload(), it->payload() + it->payloadLength());
+    }
+    d_heldFrames.clear();
+}
+
+bsl::vector<uint8_t>& ContentMaker::body()
+{
+    if (!d_body) {
+        d_body = bsl::allocate_shared<bsl::vector<uint8_t> >(d_allocator);
+        d_body->reserve(d_header.bodySize());
+    }
+    return *d_body;
+}
+
+void ContentMaker::chainHeldFrames()
+{
+    d_segments = bsl::allocate_shared<rmqt::SegmentedPayload>(d_allocator);
+    for (bsl::vector<rmqamqpt::Frame>::const_iterator it =
+             d_heldFrames.cbegin();
+         it != d_heldFrames.cend();
+         ++it) {
+        d_segments->append(it->payload(),
+                           it->payloadLength(),
+                           bsl::shared_ptr<const void>(it->serializedData()));
+    }
+    d_heldFrames.clear();
+}
+
 } // namespace rmqamqp
 } // namespace BloombergLP
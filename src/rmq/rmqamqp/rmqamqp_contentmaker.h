@@ -19,8 +19,14 @@
 
 #include <rmqamqpt_contentbody.h>
 #include <rmqamqpt_contentheader.h>
+#include <rmqamqpt_frame.h>
 
 #include <rmqt_message.h>
+#include <rmqt_segmentedpayload.h>
+
+#include <bslma_allocator.h>
+#include <bslma_usesbslmaallocator.h>
+#include <bslmf_nestedtraitdeclaration.h>
 
 #include <bsl_memory.h>
 #include <bsl_vector.h>
@@ -33,21 +39,79 @@
 namespace BloombergLP {
 namespace rmqamqp {
 
+/// The message payload, and the bookkeeping held while its frames arrive,
+/// are allocated from the maker's allocator, so they can come from a
+/// connection's pool rather than the default allocator. A maker can be
+/// `reset` for the next message on its channel, keeping that bookkeeping's
+/// capacity, and a small single frame payload is held inline in the message
+/// made, so in the steady state small messages are made without allocating.
+
 class ContentMaker {
   public:
     enum ReturnCode { DONE, PARTIAL, ERROR };
 
-    explicit ContentMaker(const rmqamqpt::ContentHeader& contentHeader);
+    BSLMF_NESTED_TRAIT_DECLARATION(ContentMaker, bslma::UsesBslmaAllocator);
+
+    /// \param allocator Supplies the payload of the message made. Must be
+    ///        thread safe and outlive the message if it is handed to other
+    ///        threads. Uses the default allocator if 0.
+    explicit ContentMaker(const rmqamqpt::ContentHeader& contentHeader,
+                          bslma::Allocator* allocator = 0);
+
+    /// Share the partly made message of `other`
+    ContentMaker(const ContentMaker& other, bslma::Allocator* allocator = 0);
+
+    /// Start making the message described by `contentHeader`, releasing
+    /// the previous one
+    void reset(const rmqamqpt::ContentHeader& contentHeader);
+
+    /// Release the frames and payload of the message made, keeping the
+    /// capacity to make the next one
+    void clear();
+
+    /// Assemble the body of the message being made into `buffer`, which
+    /// must hold at least its body size, rather than into a payload
+    /// allocated here or the frames it arrives in. Call before appending
+    /// any of the body.
+    void setPayloadBuffer(const bsl::shared_ptr<uint8_t>& buffer);
 
     rmqt::Message message() const;
 
     bool done() const;
 
+    /// Size of the body of the message being made, from its content header
+    uint64_t bodySize() const { return d_header.bodySize(); }
+
     ReturnCode appendContentBody(const rmqamqpt::ContentBody& contentBody);
 
+    /// Append the payload of a content body `frame` without copying it. The
+    /// frame is held until the last body frame arrives. A message spanning
+    /// several frames is then presented as a `rmqt::SegmentedPayload`
+    /// referencing the frames, while a single frame payload is copied (into
+    /// the message itself if it fits) so that small messages do not hold on
+    /// to whole read buffers.
+    ReturnCode appendContentFrame(const rmqamqpt::Frame& frame);
+
   private:
-    bsl::shared_ptr<rmqamqpt::ContentHeader> d_header;
+    ReturnCode appendBytes(const uint8_t* data, bsl::size_t length);
+
+    /// Copy `length` bytes at `data` into the payload buffer
+    ReturnCode appendToPayloadBuffer(const uint8_t* data, bsl::size_t length);
+
+    void assembleHeldFrames();
+
+    void chainHeldFrames();
+
+    /// Return the contiguous body, allocating it on first use
+    bsl::vector<uint8_t>& body();
+
+    bslma::Allocator* d_allocator;
+    rmqamqpt::ContentHeader d_header;
     bsl::shared_ptr<bsl::vector<uint8_t> > d_body;
+    bsl::vector<rmqamqpt::Frame> d_heldFrames;
+    bsl::shared_ptr<rmqt::SegmentedPayload> d_segments;
+    bsl::shared_ptr<uint8_t> d_payloadBuffer;
+    bsl::size_t d_payloadBufferOffset;
     uint64_t d_remainingContentBytes;
 }; // class ContentMaker
 
@@ -15,17 +15,27 @@
 
 #include <rmqamqp_framer.h>
 
+#include <rmqamqpt_basicack.h>
+#include <rmqamqpt_basicmethod.h>
+#include <rmqamqpt_basicnack.h>
 #include <rmqamqpt_constants.h>
+#include <rmqamqpt_contentbody.h>
 #include <rmqamqpt_contentheader.h>
+#include <rmqamqpt_encodedmethod.h>
 #include <rmqamqpt_heartbeat.h>
 #include <rmqamqpt_method.h>
 #include <rmqamqpt_types.h>
 
+#include <rmqt_probe.h>
+
 #include <boost/iostreams/device/back_inserter.hpp>
 #include <boost/iostreams/stream.hpp>
 
 #include <ball_log.h>
 #include <bdlb_bigendian.h>
+#include <bslma_default.h>
+#include <bslmt_once.h>
+#include <bsls_assert.h>
 
 #include <bsl_algorithm.h>
 #include <bsl_cstdint.h>
@@ -39,21 +49,110 @@ namespace rmqamqp {
 namespace {
 BALL_LOG_SET_NAMESPACE_CATEGORY("RMQAMQP.FRAMER")
 
+const uint8_t k_HEARTBEAT_FRAME[] = {
+    rmqamqpt::Constants::HEARTBEAT,
+    0, 0,       // channel
+    0, 0, 0, 0, // payload size
+    0xCE        // frame end
+};
+
+/// basic.ack and basic.nack frames differ only in the bytes patched in by
+/// `Framer::makeAckFrame`
+const uint8_t k_ACK_FRAME_TEMPLATE[Framer::k_ACK_FRAME_SIZE] = {
+    rmqamqpt::Constants::METHOD,
+    0, 0,                   // channel
+    0, 0, 0, 13,            // payload size
+    0, rmqamqpt::Constants::BASIC,
+    0, 0,                   // method id
+    0, 0, 0, 0, 0, 0, 0, 0, // delivery tag
+    0,                      // flags
+    0xCE                    // frame end
+};
+
+const bsl::size_t k_ACK_CHANNEL_OFFSET   = 1;
+const bsl::size_t k_ACK_METHOD_OFFSET    = 9;
+const bsl::size_t k_ACK_TAG_OFFSET       = 11;
+const bsl::size_t k_ACK_FLAGS_OFFSET     = 19;
+const uint8_t k_ACK_MULTIPLE_FLAG        = 1;
+const uint8_t k_NACK_REQUEUE_FLAG        = 2;
+
+bsl::shared_ptr<bsl::vector<uint8_t> >* s_heartbeatBuffer = 0;
+
+/// Write `value` big-endian into the `size` bytes at `out`
+void writeBigEndian(uint8_t* out, bsl::uint64_t value, bsl::size_t size)
+{
+    for (bsl::size_t i = size; i > 0; --i) {
+        out[i - 1] = static_cast<uint8_t>(value);
+        value >>= 8;
+    }
+}
+
+/// Return a buffer of exactly `encodedFrameSize` bytes, measured from the
+/// `encodedSize` of the frame contents, to be filled by a fixed-buffer
+/// Writer: the frame takes one allocation, and no write checks capacity
+bsl::shared_ptr<bsl::vector<uint8_t> >
+makeFrameBuffer(size_t encodedFrameSize, bslma::Allocator* allocator)
+{
+    const bsl::shared_ptr<bsl::vector<uint8_t> > data =
+        bsl::allocate_shared<bsl::vector<uint8_t> >(allocator);
+    data->resize(encodedFrameSize);
+    return data;
+}
+
+rmqamqpt::Frame
+makeMessageHeaderFrame(const rmqt::Message& message,
+                       const rmqamqpt::PropertiesTemplate* propertiesTemplate,
+                       uint16_t channel,
+                       bslma::Allocator* allocator)
+{
+    if (propertiesTemplate) {
+        return rmqamqp::Framer::makeContentHeaderFrame(
+            message, *propertiesTemplate, channel, allocator);
+    }
+    return rmqamqp::Framer::makeContentHeaderFrame(
+        message, channel, allocator);
+}
+
+/// Return `message`, or if it is a consumed message with lazily decoded
+/// headers which is being published again, a copy of it in `storage` with
+/// the headers decoded so they are sent
+const rmqamqp::Message& withDecodedHeaders(rmqamqp::Message* storage,
+                                           const rmqamqp::Message& message)
+{
+    if (!message.is<rmqt::Message>()) {
+        return message;
+    }
+    const rmqt::Message& content = message.the<rmqt::Message>();
+    if (!content.headersView() || content.headers()) {
+        return message;
+    }
+
+    rmqt::Message decoded(content);
+    decoded.properties().headers = content.decodedHeaders();
+    decoded.setHeadersView(bsl::shared_ptr<const rmqt::FieldTableView>());
+    storage->assignTo<rmqt::Message>(decoded);
+    return *storage;
+}
+
 class MessageSerializer {
   public:
     MessageSerializer(bsl::vector<rmqamqpt::Frame>* frames,
                       uint16_t channel,
-                      size_t maxFrameSize)
+                      size_t maxFrameSize,
+                      const rmqamqpt::PropertiesTemplate* propertiesTemplate,
+                      bslma::Allocator* allocator)
     : d_frames(frames)
     , d_channel(channel)
     , d_maxFrameSize(maxFrameSize)
+    , d_propertiesTemplate(propertiesTemplate)
+    , d_allocator(allocator)
     {
     }
 
     void operator()(const rmqt::Message& message) const
     {
-        d_frames->push_back(
-            rmqamqp::Framer::makeContentHeaderFrame(message, d_channel));
+        d_frames->push_back(makeMessageHeaderFrame(
+            message, d_propertiesTemplate, d_channel, d_allocator));
 
         const size_t frameSize =
             d_maxFrameSize - rmqamqpt::Frame::frameOverhead();
@@ -67,9 +166,36 @@ class MessageSerializer {
                 rmqamqp::Framer::makeContentBodyFrame(message.payload() + i,
                                                       encodedFrameSize,
                                                       encodedPayloadSize,
-                                                      d_channel));
+                                                      d_channel,
+                                                      d_allocator));
         }
     }
+    void operator()(const rmqamqpt::ContentHeader& header) const
+    {
+        d_frames->push_back(rmqamqp::Framer::makeContentHeaderFrame(
+            header, d_channel, d_allocator));
+    }
+
+    void operator()(const rmqamqpt::ContentBody& body) const
+    {
+        const size_t frameSize =
+            d_maxFrameSize - rmqamqpt::Frame::frameOverhead();
+        const uint8_t* data = body.data().data();
+        for (bsl::size_t i = 0; i < body.dataLength(); i += frameSize) {
+            const size_t encodedPayloadSize =
+                bsl::min(frameSize, body.dataLength() - i);
+            const size_t encodedFrameSize =
+                rmqamqpt::Frame::calculateFrameSize(encodedPayloadSize);
+
+            d_frames->push_back(
+                rmqamqp::Framer::makeContentBodyFrame(data + i,
+                                                      encodedFrameSize,
+                                                      encodedPayloadSize,
+                                                      d_channel,
+                                                      d_allocator));
+        }
+    }
+
     void operator()(const rmqamqpt::Heartbeat&) const
     {
         d_frames->push_back(Framer::makeHeartbeatFrame());
@@ -78,7 +204,15 @@ class MessageSerializer {
     void operator()(const rmqamqpt::Method& method) const
     {
         d_frames->push_back(rmqamqpt::Frame());
-        Framer::makeMethodFrame(&d_frames->back(), d_channel, method);
+        Framer::makeMethodFrame(
+            &d_frames->back(), d_channel, method, d_allocator);
+    }
+
+    void operator()(const rmqamqpt::EncodedMethod& method) const
+    {
+        d_frames->push_back(rmqamqpt::Frame());
+        Framer::makeMethodFrame(
+            &d_frames->back(), d_channel, method, d_allocator);
     }
 
     void operator()(const bslmf::Nil&) const {}
@@ -87,26 +221,282 @@ class MessageSerializer {
     bsl::vector<rmqamqpt::Frame>* d_frames;
     const uint16_t d_channel;
     const bsl::size_t d_maxFrameSize;
+    const rmqamqpt::PropertiesTemplate* d_propertiesTemplate;
+    bslma::Allocator* d_allocator;
+};
+class ZeroCopyMessageSerializer {
+  public:
+    ZeroCopyMessageSerializer(
+        bsl::vector<bsl::shared_ptr<rmqio::SerializedFrame> >* frames,
+        uint16_t channel,
+        size_t maxFrameSize,
+        const rmqamqpt::PropertiesTemplate* propertiesTemplate,
+        bslma::Allocator* allocator)
+    : d_frames(frames)
+    , d_channel(channel)
+    , d_maxFrameSize(maxFrameSize)
+    , d_propertiesTemplate(propertiesTemplate)
+    , d_allocator(allocator)
+    {
+    }
+
+    void operator()(const rmqt::Message& message) const
+    {
+        const size_t frameSize =
+            d_maxFrameSize - rmqamqpt::Frame::frameOverhead();
+
+        d_frames->reserve(d_frames->size() + 1 +
+                          (message.payloadSize() + frameSize - 1) / frameSize);
+
+        d_frames->push_back(bsl::allocate_shared<rmqio::SerializedFrame>(
+            d_allocator,
+            makeMessageHeaderFrame(
+                message, d_propertiesTemplate, d_channel, d_allocator)));
+
+        const bsl::shared_ptr<const void> owner(message.payloadOwner());
+        const bsl::shared_ptr<const rmqt::SegmentedPayload>& segments =
+            message.payloadSegments();
+        if (segments) {
+            // Frame each segment separately, so that a consumed message can
+            // be republished without flattening it
+            for (rmqt::SegmentedPayload::const_iterator it =
+                     segments->begin();
+                 it != segments->end();
+                 ++it) {
+                appendBodyFrames(it->first, it->second, frameSize, owner);
+            }
+            return;
+        }
+
+        appendBodyFrames(
+            message.payload(), message.payloadSize(), frameSize, owner);
+    }
+
+    void operator()(const rmqamqpt::ContentHeader& header) const
+    {
+        d_frames->push_back(bsl::allocate_shared<rmqio::SerializedFrame>(
+            d_allocator,
+            rmqamqp::Framer::makeContentHeaderFrame(
+                header, d_channel, d_allocator)));
+    }
+
+    void operator()(const rmqamqpt::ContentBody& body) const
+    {
+        // A chunk of a streamed message: framed as it arrives, referencing
+        // the chunk rather than copying it
+        const size_t frameSize =
+            d_maxFrameSize - rmqamqpt::Frame::frameOverhead();
+
+        d_frames->reserve(d_frames->size() +
+                          (body.dataLength() + frameSize - 1) / frameSize);
+
+        appendBodyFrames(
+            body.data().data(), body.dataLength(), frameSize, body.buffer());
+    }
+
+    void operator()(const rmqamqpt::Heartbeat&) const
+    {
+        d_frames->push_back(bsl::allocate_shared<rmqio::SerializedFrame>(
+            d_allocator, k_HEARTBEAT_FRAME, sizeof(k_HEARTBEAT_FRAME)));
+    }
+
+    void operator()(const rmqamqpt::Method& method) const
+    {
+        // Acks are the most frequent method, and small enough to be held
+        // inside the SerializedFrame
+        uint8_t ack[Framer::k_ACK_FRAME_SIZE];
+        if (Framer::makeAckFrame(ack, d_channel, method)) {
+            d_frames->push_back(bsl::allocate_shared<rmqio::SerializedFrame>(
+                d_allocator, ack, sizeof(ack)));
+            return;
+        }
+
+        rmqamqpt::Frame frame;
+        Framer::makeMethodFrame(&frame, d_channel, method, d_allocator);
+        d_frames->push_back(
+            bsl::allocate_shared<rmqio::SerializedFrame>(d_allocator, frame));
+    }
+
+    void operator()(const rmqamqpt::EncodedMethod& method) const
+    {
+        // Already encoded: only the frame header & end are written
+        d_frames->push_back(bsl::allocate_shared<rmqio::SerializedFrame>(
+            d_allocator,
+            rmqamqpt::Constants::METHOD,
+            d_channel,
+            method.data().data(),
+            method.dataLength(),
+            method.buffer()));
+    }
+
+    void operator()(const bslmf::Nil&) const {}
+
+  private:
+    void appendBodyFrames(const uint8_t* payload,
+                          bsl::size_t payloadSize,
+                          bsl::size_t frameSize,
+                          const bsl::shared_ptr<const void>& owner) const
+    {
+        for (bsl::size_t i = 0; i < payloadSize; i += frameSize) {
+            const size_t encodedPayloadSize =
+                bsl::min(frameSize, payloadSize - i);
+
+            if (!owner) {
+                // A small payload held inside the message, which does not
+                // outlive this call: copy it into the frame
+                d_frames->push_back(
+                    bsl::allocate_shared<rmqio::SerializedFrame>(
+                        d_allocator,
+                        rmqamqp::Framer::makeContentBodyFrame(
+                            payload + i,
+                            rmqamqpt::Frame::calculateFrameSize(
+                                encodedPayloadSize),
+                            encodedPayloadSize,
+                            d_channel,
+                            d_allocator)));
+                continue;
+            }
+
+            d_frames->push_back(bsl::allocate_shared<rmqio::SerializedFrame>(
+                d_allocator,
+                rmqamqpt::Constants::BODY,
+                d_channel,
+                payload + i,
+                encodedPayloadSize,
+                owner));
+        }
+    }
+
+    bsl::vector<bsl::shared_ptr<rmqio::SerializedFrame> >* d_frames;
+    const uint16_t d_channel;
+    const bsl::size_t d_maxFrameSize;
+    const rmqamqpt::PropertiesTemplate* d_propertiesTemplate;
+    bslma::Allocator* d_allocator;
 };
 } // namespace
 
-Framer::Framer()
-: d_channelContentMakers()
+Framer::Framer(bslma::Allocator* bufferAllocator)
+: d_channelContentMakers(bufferAllocator)
+, d_contentInProgress()
+, d_channelPropertiesTemplates()
+, d_lazyHeaderChannels()
+, d_decodedProperties()
+, d_payloadAllocators()
 , d_maxFrameSize(rmqamqpt::Frame::getMaxFrameSize())
+, d_bufferAllocator(bufferAllocator)
 {
 }
 
 void Framer::setMaxFrameSize(bsl::size_t maxSize) { d_maxFrameSize = maxSize; }
 
+void Framer::setLazyHeaders(uint16_t channel, bool lazyHeaders)
+{
+    if (channel >= d_lazyHeaderChannels.size()) {
+        if (!lazyHeaders) {
+            return;
+        }
+        d_lazyHeaderChannels.resize(channel + 1, false);
+    }
+    d_lazyHeaderChannels[channel] = lazyHeaders;
+}
+
+void Framer::setDecodedProperties(uint16_t channel, int decodedProperties)
+{
+    if (channel >= d_decodedProperties.size()) {
+        if (decodedProperties == rmqt::MessageProperty::ALL) {
+            return;
+        }
+        d_decodedProperties.resize(channel + 1, rmqt::MessageProperty::ALL);
+    }
+    d_decodedProperties[channel] = decodedProperties;
+}
+
+void Framer::setPayloadAllocator(
+    uint16_t channel,
+    const rmqt::ConsumerConfig::PayloadAllocatorFunc& payloadAllocator)
+{
+    if (channel >= d_payloadAllocators.size()) {
+        if (!payloadAllocator) {
+            return;
+        }
+        d_payloadAllocators.resize(channel + 1);
+    }
+    d_payloadAllocators[channel] = payloadAllocator;
+}
+
+void Framer::reset()
+{
+    d_channelContentMakers.clear();
+    d_contentInProgress.clear();
+    d_channelPropertiesTemplates.clear();
+    d_maxFrameSize = rmqamqpt::Frame::getMaxFrameSize();
+}
+
+void Framer::trim()
+{
+    for (bsl::size_t channel = 0; channel < d_channelContentMakers.size();
+         ++channel) {
+        if (!d_contentInProgress[channel]) {
+            d_channelContentMakers[channel].reset();
+        }
+    }
+}
+
+ContentMaker* Framer::contentMaker(uint16_t channel)
+{
+    if (channel >= d_contentInProgress.size() ||
+        !d_contentInProgress[channel]) {
+        return 0;
+    }
+    return &d_channelContentMakers[channel].value();
+}
+
+void Framer::finishContent(uint16_t channel)
+{
+    d_channelContentMakers[channel]->clear();
+    d_contentInProgress[channel] = false;
+}
+
+bool Framer::lazyHeaders(uint16_t channel) const
+{
+    return channel < d_lazyHeaderChannels.size() &&
+           d_lazyHeaderChannels[channel];
+}
+
+int Framer::decodedProperties(uint16_t channel) const
+{
+    return channel < d_decodedProperties.size()
+               ? d_decodedProperties[channel]
+               : static_cast<int>(rmqt::MessageProperty::ALL);
+}
+
+void Framer::supplyPayloadBuffer(uint16_t channel, ContentMaker* maker) const
+{
+    if (channel >= d_payloadAllocators.size() ||
+        !d_payloadAllocators[channel] || maker->done()) {
+        return;
+    }
+
+    const bsl::shared_ptr<uint8_t> buffer = d_payloadAllocators[channel](
+        static_cast<bsl::size_t>(maker->bodySize()));
+    if (buffer) {
+        maker->setPayloadBuffer(buffer);
+    }
+}
+
 Framer::ReturnCode Framer::appendFrame(uint16_t* receiveChannel,
                                        rmqamqp::Message* receiveMessage,
                                        const rmqamqpt::Frame& frame)
 {
+    RMQT_PROBE3(frame_decoded,
+                frame.type(),
+                frame.channel(),
+                frame.payloadLength());
+
     *receiveChannel = frame.channel();
     switch (frame.type()) {
         case rmqamqpt::Constants::METHOD: {
-            if (d_channelContentMakers.find(frame.channel()) !=
-                d_channelContentMakers.end()) {
+            if (contentMaker(frame.channel())) {
                 BALL_LOG_ERROR << "Channel exception: Unable to decode frames "
                                   "in buffer for channel ["
                                << frame.channel() << "].";
@@ -131,8 +521,7 @@ Framer::ReturnCode Framer::appendFrame(uint16_t* receiveChannel,
             return OK;
         }
         case rmqamqpt::Constants::HEADER: {
-            if (d_channelContentMakers.find(frame.channel()) !=
-                d_channelContentMakers.end()) {
+            if (contentMaker(frame.channel())) {
                 BALL_LOG_ERROR << " Channel exception: Unable to decode frames "
                                   "in buffer for channel ["
                                << frame.channel() << "].";
@@ -141,7 +530,11 @@ Framer::ReturnCode Framer::appendFrame(uint16_t* receiveChannel,
 
             rmqamqpt::ContentHeader contentHeader;
             if (!rmqamqpt::ContentHeader::decode(
-                    &contentHeader, frame.payload(), frame.payloadLength())) {
+                    &contentHeader,
+                    frame.payload(),
+                    frame.payloadLength(),
+                    lazyHeaders(frame.channel()),
+                    decodedProperties(frame.channel()))) {
                 BALL_LOG_ERROR
                     << "Failed to decode content header for channel: "
                     << frame.channel()
@@ -149,22 +542,36 @@ Framer::ReturnCode Framer::appendFrame(uint16_t* receiveChannel,
                 return CHANNEL_EXCEPTION;
             }
 
-            bsl::shared_ptr<ContentMaker> maker =
-                bsl::make_shared<ContentMaker>(contentHeader);
+            if (frame.channel() >= d_channelContentMakers.size()) {
+                d_channelContentMakers.resize(frame.channel() + 1);
+                d_contentInProgress.resize(frame.channel() + 1, false);
+            }
+
+            // The channel's previous maker is reused, with its capacity
+            bsl::optional<ContentMaker>& maker =
+                d_channelContentMakers[frame.channel()];
+            if (maker.has_value()) {
+                maker->reset(contentHeader);
+            }
+            else {
+                maker.emplace(contentHeader);
+            }
+            d_contentInProgress[frame.channel()] = true;
+            supplyPayloadBuffer(frame.channel(), &maker.value());
 
             if (maker->done()) { // It's possible a message has just the header
                                  // and no body
                 receiveMessage->assignTo<rmqt::Message>(maker->message());
+                RMQT_PROBE2(message_assembled, frame.channel(), 0);
+                finishContent(frame.channel());
                 return OK;
             }
 
-            d_channelContentMakers[frame.channel()] = maker;
             return PARTIAL;
         }
         case rmqamqpt::Constants::BODY: {
-            ChannelContentMaker::iterator it =
-                d_channelContentMakers.find(frame.channel());
-            if (it == d_channelContentMakers.end()) {
+            ContentMaker* maker = contentMaker(frame.channel());
+            if (!maker) {
                 BALL_LOG_ERROR
                     << "Channel Exception: Received content body frame without "
                        "prior header frame on channel [ "
@@ -172,12 +579,9 @@ Framer::ReturnCode Framer::appendFrame(uint16_t* receiveChannel,
                 return CHANNEL_EXCEPTION;
             }
 
-            rmqamqpt::ContentBody contentBody;
-            rmqamqpt::ContentBody::decode(
-                &contentBody, frame.payload(), frame.payloadLength());
-
-            ContentMaker::ReturnCode rc =
-                it->second->appendContentBody(contentBody);
+            // The frame may be a view over the connection's read buffer, it
+            // is held rather than copied until the message is complete
+            ContentMaker::ReturnCode rc = maker->appendContentFrame(frame);
             if (rc == ContentMaker::ERROR) {
                 BALL_LOG_ERROR << "Channel exception: size of content body is "
                                   "more than specified in the content header ["
@@ -186,8 +590,12 @@ Framer::ReturnCode Framer::appendFrame(uint16_t* receiveChannel,
             }
 
             if (rc == ContentMaker::DONE) {
-                receiveMessage->assignTo<rmqt::Message>(it->second->message());
-                d_channelContentMakers.erase(it);
+                receiveMessage->assignTo<rmqt::Message>(maker->message());
+                RMQT_PROBE2(
+                    message_assembled,
+                    frame.channel(),
+                    receiveMessage->the<rmqt::Message>().payloadSize());
+                finishContent(frame.channel());
                 return OK;
             }
             return PARTIAL;
@@ -202,12 +610,17 @@ Framer::ReturnCode Framer::appendFrame(uint16_t* receiveChannel,
 
 void Framer::clearChannel(uint16_t channel)
 {
-    d_channelContentMakers.erase(channel);
+    if (channel < d_channelContentMakers.size()) {
+        d_channelContentMakers[channel].reset();
+        d_contentInProgress[channel] = false;
+    }
+    d_channelPropertiesTemplates.erase(channel);
 }
 
 void Framer::makeMethodFrame(rmqamqpt::Frame* frame,
                              uint16_t channel,
-                             const rmqamqpt::Method& method)
+                             const rmqamqpt::Method& method,
+                             bslma::Allocator* allocator)
 {
     using namespace boost::iostreams;
 
@@ -215,15 +628,37 @@ void Framer::makeMethodFrame(rmqamqpt::Frame* frame,
     const size_t encodedFrameSize =
         rmqamqpt::Frame::calculateFrameSize(encodedPayloadSize);
 
-    bsl::shared_ptr<bsl::vector<uint8_t> > data =
-        bsl::make_shared<bsl::vector<uint8_t> >();
-    data->reserve(encodedFrameSize);
-    rmqamqpt::Writer writer(data.get());
+    const bsl::shared_ptr<bsl::vector<uint8_t> > data =
+        makeFrameBuffer(encodedFrameSize, allocator);
+    rmqamqpt::Writer writer(data->data(), data->size());
 
     encodeFrameHeader(
         writer, rmqamqpt::Constants::METHOD, channel, encodedPayloadSize);
     rmqamqpt::Method::Util::encode(writer, method);
     encodeFrameEnd(writer);
+    BSLS_ASSERT(writer.offset() == encodedFrameSize);
+
+    *frame = rmqamqpt::Frame(rmqamqpt::Constants::METHOD, channel, data);
+}
+
+void Framer::makeMethodFrame(rmqamqpt::Frame* frame,
+                             uint16_t channel,
+                             const rmqamqpt::EncodedMethod& method,
+                             bslma::Allocator* allocator)
+{
+    const size_t encodedPayloadSize = method.dataLength();
+    const size_t encodedFrameSize =
+        rmqamqpt::Frame::calculateFrameSize(encodedPayloadSize);
+
+    const bsl::shared_ptr<bsl::vector<uint8_t> > data =
+        makeFrameBuffer(encodedFrameSize, allocator);
+    rmqamqpt::Writer writer(data->data(), data->size());
+
+    encodeFrameHeader(
+        writer, rmqamqpt::Constants::METHOD, channel, encodedPayloadSize);
+    rmqamqpt::EncodedMethod::encode(writer, method);
+    encodeFrameEnd(writer);
+    BSLS_ASSERT(writer.offset() == encodedFrameSize);
 
     *frame = rmqamqpt::Frame(rmqamqpt::Constants::METHOD, channel, data);
 }
@@ -231,12 +666,15 @@ void Framer::makeMethodFrame(rmqamqpt::Frame* frame,
 rmqamqpt::Frame Framer::makeContentBodyFrame(const uint8_t* message,
                                              const size_t encodedFrameSize,
                                              const size_t encodedPayloadSize,
-                                             uint16_t channel)
+                                             uint16_t channel,
+                                             bslma::Allocator* allocator)
 {
     using namespace boost::iostreams;
 
+    // Appended rather than written into a sized buffer, which would zero
+    // fill the payload before copying it
     bsl::shared_ptr<bsl::vector<uint8_t> > data =
-        bsl::make_shared<bsl::vector<uint8_t> >();
+        bsl::allocate_shared<bsl::vector<uint8_t> >(allocator);
     data->reserve(encodedFrameSize);
     rmqamqpt::Writer writer(data.get());
 
@@ -249,52 +687,176 @@ rmqamqpt::Frame Framer::makeContentBodyFrame(const uint8_t* message,
 }
 
 rmqamqpt::Frame Framer::makeContentHeaderFrame(const rmqt::Message& message,
-                                               uint16_t channel)
+                                               uint16_t channel,
+                                               bslma::Allocator* allocator)
 {
-    using namespace boost::iostreams;
-
-    const rmqamqpt::ContentHeader header(rmqamqpt::Constants::BASIC, message);
+    return makeContentHeaderFrame(
+        rmqamqpt::ContentHeader(rmqamqpt::Constants::BASIC, message),
+        channel,
+        allocator);
+}
 
-    const size_t encodedPayloadSize = header.encodedSize();
+rmqamqpt::Frame Framer::makeContentHeaderFrame(
+    const rmqt::Message& message,
+    const rmqamqpt::PropertiesTemplate& propertiesTemplate,
+    uint16_t channel,
+    bslma::Allocator* allocator)
+{
+    const size_t encodedPayloadSize =
+        rmqamqpt::ContentHeader::encodedSize(message, propertiesTemplate);
     const size_t encodedFrameSize =
         rmqamqpt::Frame::calculateFrameSize(encodedPayloadSize);
 
     const bsl::shared_ptr<bsl::vector<uint8_t> > data =
-        bsl::make_shared<bsl::vector<uint8_t> >();
-    data->reserve(encodedFrameSize);
-    rmqamqpt::Writer writer(data.get());
+        makeFrameBuffer(encodedFrameSize, allocator);
+    rmqamqpt::Writer writer(data->data(), data->size());
 
     rmqamqp::Framer::encodeFrameHeader(
         writer, rmqamqpt::Constants::HEADER, channel, encodedPayloadSize);
-    rmqamqpt::ContentHeader::encode(writer, header);
+    rmqamqpt::ContentHeader::encode(
+        writer, rmqamqpt::Constants::BASIC, message, propertiesTemplate);
     rmqamqp::Framer::encodeFrameEnd(writer);
+    BSLS_ASSERT(writer.offset() == encodedFrameSize);
 
     return rmqamqpt::Frame(rmqamqpt::Constants::HEADER, channel, data);
 }
 
-rmqamqpt::Frame Framer::makeHeartbeatFrame()
+rmqamqpt::Frame
+Framer::makeContentHeaderFrame(const rmqamqpt::ContentHeader& header,
+                               uint16_t channel,
+                               bslma::Allocator* allocator)
 {
     using namespace boost::iostreams;
 
+    const size_t encodedPayloadSize = header.encodedSize();
+    const size_t encodedFrameSize =
+        rmqamqpt::Frame::calculateFrameSize(encodedPayloadSize);
+
     const bsl::shared_ptr<bsl::vector<uint8_t> > data =
-        bsl::make_shared<bsl::vector<uint8_t> >();
-    data->reserve(rmqamqpt::Frame::frameOverhead());
-    rmqamqpt::Writer writer(data.get());
+        makeFrameBuffer(encodedFrameSize, allocator);
+    rmqamqpt::Writer writer(data->data(), data->size());
 
     rmqamqp::Framer::encodeFrameHeader(
-        writer, rmqamqpt::Constants::HEARTBEAT, 0, 0);
+        writer, rmqamqpt::Constants::HEADER, channel, encodedPayloadSize);
+    rmqamqpt::ContentHeader::encode(writer, header);
     rmqamqp::Framer::encodeFrameEnd(writer);
+    BSLS_ASSERT(writer.offset() == encodedFrameSize);
+
+    return rmqamqpt::Frame(rmqamqpt::Constants::HEADER, channel, data);
+}
+
+rmqamqpt::Frame Framer::makeHeartbeatFrame()
+{
+    BSLMT_ONCE_DO
+    {
+        // Never freed, so it comes from the global allocator rather than a
+        // default allocator which may be a test allocator
+        bslma::Allocator* allocator = bslma::Default::globalAllocator();
+        s_heartbeatBuffer = new (*allocator)
+            bsl::shared_ptr<bsl::vector<uint8_t> >(
+                bsl::allocate_shared<bsl::vector<uint8_t> >(
+                    allocator,
+                    k_HEARTBEAT_FRAME,
+                    k_HEARTBEAT_FRAME + sizeof(k_HEARTBEAT_FRAME)));
+    }
+
+    return rmqamqpt::Frame(
+        rmqamqpt::Constants::HEARTBEAT, 0, *s_heartbeatBuffer);
+}
+
+bool Framer::makeAckFrame(uint8_t (&frame)[k_ACK_FRAME_SIZE],
+                          uint16_t channel,
+                          const rmqamqpt::Method& method)
+{
+    if (method.classId() != rmqamqpt::BasicMethod::CLASS_ID) {
+        return false;
+    }
+
+    const rmqamqpt::BasicMethod& basic = method.the<rmqamqpt::BasicMethod>();
+
+    bsl::uint64_t deliveryTag;
+    uint8_t flags = 0;
+    if (basic.is<rmqamqpt::BasicAck>()) {
+        const rmqamqpt::BasicAck& ack = basic.the<rmqamqpt::BasicAck>();
+        deliveryTag = ack.deliveryTag();
+        flags       = ack.multiple() ? k_ACK_MULTIPLE_FLAG : 0;
+    }
+    else if (basic.is<rmqamqpt::BasicNack>()) {
+        const rmqamqpt::BasicNack& nack = basic.the<rmqamqpt::BasicNack>();
+        deliveryTag = nack.deliveryTag();
+        flags       = (nack.multiple() ? k_ACK_MULTIPLE_FLAG : 0) |
+                (nack.requeue() ? k_NACK_REQUEUE_FLAG : 0);
+    }
+    else {
+        return false;
+    }
 
-    return rmqamqpt::Frame(rmqamqpt::Constants::HEARTBEAT, 0, data);
+    bsl::copy(k_ACK_FRAME_TEMPLATE,
+              k_ACK_FRAME_TEMPLATE + k_ACK_FRAME_SIZE,
+              frame);
+    writeBigEndian(frame + k_ACK_CHANNEL_OFFSET, channel, 2);
+    writeBigEndian(frame + k_ACK_METHOD_OFFSET, basic.methodId(), 2);
+    writeBigEndian(frame + k_ACK_TAG_OFFSET, deliveryTag, 8);
+    frame[k_ACK_FLAGS_OFFSET] = flags;
+    return true;
 }
 
 void Framer::makeFrames(bsl::vector<rmqamqpt::Frame>* frames,
                         uint16_t channel,
                         const rmqamqp::Message& message) const
 {
-    MessageSerializer serializer(frames, channel, d_maxFrameSize);
+    rmqamqp::Message storage;
+    const rmqamqp::Message& toFrame = withDecodedHeaders(&storage, message);
+
+    MessageSerializer serializer(frames,
+                                 channel,
+                                 d_maxFrameSize,
+                                 propertiesTemplateFor(channel, toFrame),
+                                 d_bufferAllocator);
+
+    toFrame.apply(serializer);
+}
+
+void Framer::makeSerializedFrames(
+    bsl::vector<bsl::shared_ptr<rmqio::SerializedFrame> >* frames,
+    uint16_t channel,
+    const rmqamqp::Message& message) const
+{
+    rmqamqp::Message storage;
+    const rmqamqp::Message& toFrame = withDecodedHeaders(&storage, message);
+
+    ZeroCopyMessageSerializer serializer(
+        frames,
+        channel,
+        d_maxFrameSize,
+        propertiesTemplateFor(channel, toFrame),
+        d_bufferAllocator);
+
+    toFrame.apply(serializer);
+}
+
+const rmqamqpt::PropertiesTemplate*
+Framer::propertiesTemplateFor(uint16_t channel,
+                              const rmqamqp::Message& message) const
+{
+    if (!message.is<rmqt::Message>()) {
+        return 0;
+    }
+
+    const rmqt::Properties& properties =
+        message.the<rmqt::Message>().properties();
+
+    // Publishers commonly send long runs of messages whose properties differ
+    // only in id & timestamp. Re-use the channel's last template while that
+    // holds, and replace it when the properties change.
+    bsl::shared_ptr<rmqamqpt::PropertiesTemplate>& propertiesTemplate =
+        d_channelPropertiesTemplates[channel];
+    if (!propertiesTemplate || !propertiesTemplate->matches(properties)) {
+        propertiesTemplate =
+            bsl::make_shared<rmqamqpt::PropertiesTemplate>(properties);
+    }
 
-    message.apply(serializer);
+    return propertiesTemplate.get();
 }
 
 void Framer::encodeFrameHeader(rmqamqpt::Writer& output,
@@ -19,11 +19,19 @@
 
 #include <rmqamqp_contentmaker.h>
 #include <rmqamqp_message.h>
+#include <rmqamqpt_contentheader.h>
+#include <rmqamqpt_encodedmethod.h>
 #include <rmqamqpt_frame.h>
+#include <rmqamqpt_propertiestemplate.h>
 #include <rmqamqpt_writer.h>
+#include <rmqio_serializedframe.h>
+#include <rmqt_consumerconfig.h>
+
+#include <bslma_allocator.h>
 
 #include <bsl_cstdlib.h>
 #include <bsl_memory.h>
+#include <bsl_optional.h>
 #include <bsl_unordered_map.h>
 #include <bsl_vector.h>
 
@@ -48,11 +56,48 @@ class Framer {
         CONNECTION_EXCEPTION
     };
 
-    Framer();
+    /// \param bufferAllocator Allocator used for the buffers of outgoing
+    ///        frames (and SerializedFrame objects), and for the payloads of
+    ///        incoming messages. Must be thread safe and outlive all frames
+    ///        and messages created by this Framer. Uses the default
+    ///        allocator if 0.
+    explicit Framer(bslma::Allocator* bufferAllocator = 0);
 
     /// Updates the maximum frame size used when encoding Content frames.
     void setMaxFrameSize(bsl::size_t maxSize);
 
+    /// Allocate the buffers described for the constructor from
+    /// `bufferAllocator` from now on. Frames and messages already made keep
+    /// theirs, so the previous allocator must still outlive them.
+    void setBufferAllocator(bslma::Allocator* bufferAllocator)
+    {
+        d_bufferAllocator = bufferAllocator;
+    }
+
+    /// Keep the headers of messages received on `channel` encoded, see
+    /// `rmqt::ConsumerConfig::setLazyHeaders`. Kept across `reset`.
+    void setLazyHeaders(uint16_t channel, bool lazyHeaders);
+
+    /// Decode only `decodedProperties` of messages received on `channel`, see
+    /// `rmqt::ConsumerConfig::setDecodedProperties`. Kept across `reset`.
+    void setDecodedProperties(uint16_t channel, int decodedProperties);
+
+    /// Assemble the bodies of messages received on `channel` into buffers
+    /// from `payloadAllocator`, see
+    /// `rmqt::ConsumerConfig::setPayloadAllocator`. Kept across `reset`.
+    void setPayloadAllocator(
+        uint16_t channel,
+        const rmqt::ConsumerConfig::PayloadAllocatorFunc& payloadAllocator);
+
+    /// Drop all buffered frames and cached state for a new connection,
+    /// keeping the per-channel configuration set by `setLazyHeaders`,
+    /// `setDecodedProperties` and `setPayloadAllocator`
+    void reset();
+
+    /// Drop the content makers kept, with their capacity, for channels with
+    /// no message being assembled
+    void trim();
+
     /// Statefully constructs rmqamqp::Message objects from incoming frames
     /// Incoming Messages spread across frames are de-multiplexed by channel
     /// Partial message receipt is indicated by the ReturnCode PARTIAL.
@@ -72,25 +117,73 @@ class Framer {
                     uint16_t channel,
                     const rmqamqp::Message& message) const;
 
+    /// Constructs the frames for a Message ready to be written to the socket.
+    /// Content body frames of rmqt::Message objects are zero-copy views over
+    /// the message payload: only the frame headers, frame ends and content
+    /// header are serialized into owned buffers.
+    void makeSerializedFrames(
+        bsl::vector<bsl::shared_ptr<rmqio::SerializedFrame> >* frames,
+        uint16_t channel,
+        const rmqamqp::Message& message) const;
+
     /// Constructs an rmqamqpt::Frame from an rmqamqpt::Method
     /// This is a specialisation of `makeFrames` as Method messages are
     /// always framed into one rmqamqpt::Frame
     static void makeMethodFrame(rmqamqpt::Frame* frame,
                                 uint16_t channel,
-                                const rmqamqpt::Method& method);
+                                const rmqamqpt::Method& method,
+                                bslma::Allocator* allocator = 0);
 
-    /// Constructs an rmqamqpt::Frame for a Heartbeat message
+    /// Constructs an rmqamqpt::Frame from an already encoded Method
+    static void makeMethodFrame(rmqamqpt::Frame* frame,
+                                uint16_t channel,
+                                const rmqamqpt::EncodedMethod& method,
+                                bslma::Allocator* allocator = 0);
+
+    /// Returns the rmqamqpt::Frame for a Heartbeat message. Heartbeat frames
+    /// are all alike, so they share one buffer, built on first use.
     static rmqamqpt::Frame makeHeartbeatFrame();
 
+    /// Size of a basic.ack or basic.nack frame
+    static const bsl::size_t k_ACK_FRAME_SIZE = 21;
+
+    /// If `method` is a basic.ack or basic.nack, write its frame on
+    /// `channel` into `frame` and return true. The frame is copied from a
+    /// template, with the channel, delivery tag and flags patched in, rather
+    /// than encoded. Return false for any other method.
+    static bool makeAckFrame(uint8_t (&frame)[k_ACK_FRAME_SIZE],
+                             uint16_t channel,
+                             const rmqamqpt::Method& method);
+
     /// Constructs a content header frame for a message
-    static rmqamqpt::Frame makeContentHeaderFrame(const rmqt::Message& message,
-                                                  uint16_t channel);
+    static rmqamqpt::Frame
+    makeContentHeaderFrame(const rmqt::Message& message,
+                           uint16_t channel,
+                           bslma::Allocator* allocator = 0);
+
+    /// Constructs a content header frame for a message whose properties
+    /// match `propertiesTemplate`, patching the message's id & timestamp
+    /// into the template's pre-encoded properties
+    static rmqamqpt::Frame makeContentHeaderFrame(
+        const rmqt::Message& message,
+        const rmqamqpt::PropertiesTemplate& propertiesTemplate,
+        uint16_t channel,
+        bslma::Allocator* allocator = 0);
+
+    /// Constructs a content header frame from an encoded-ready header, e.g.
+    /// for a streamed message whose body follows separately
+    static rmqamqpt::Frame
+    makeContentHeaderFrame(const rmqamqpt::ContentHeader& header,
+                           uint16_t channel,
+                           bslma::Allocator* allocator = 0);
 
     /// Constructs a content body frame for a message
-    static rmqamqpt::Frame makeContentBodyFrame(const uint8_t* message,
-                                                const size_t encodedFrameSize,
-                                                const size_t encodedPayloadSize,
-                                                uint16_t channel);
+    static rmqamqpt::Frame
+    makeContentBodyFrame(const uint8_t* message,
+                         const size_t encodedFrameSize,
+                         const size_t encodedPayloadSize,
+                         uint16_t channel,
+                         bslma::Allocator* allocator = 0);
 
     static void encodeFrameHeader(rmqamqpt::Writer& output,
                                   uint8_t type,
@@ -100,11 +193,50 @@ class Framer {
     static void encodeFrameEnd(rmqamqpt::Writer& output);
 
   private:
-    typedef bsl::unordered_map<uint16_t, bsl::shared_ptr<ContentMaker> >
-        ChannelContentMaker;
-
-    ChannelContentMaker d_channelContentMakers;
+    /// Channel ids are small and dense (the lowest free id is assigned), so
+    /// per-channel receive state is held in vectors indexed by channel id
+    typedef bsl::vector<bsl::optional<ContentMaker> > ChannelContentMakers;
+
+    typedef bsl::unordered_map<
+        uint16_t,
+        bsl::shared_ptr<rmqamqpt::PropertiesTemplate> >
+        ChannelPropertiesTemplates;
+
+    /// Return the template to encode `message`'s content header with, or 0
+    /// if it has no content header. The channel's cached template is
+    /// replaced if it does not match the message's properties.
+    const rmqamqpt::PropertiesTemplate*
+    propertiesTemplateFor(uint16_t channel,
+                          const rmqamqp::Message& message) const;
+
+    /// Return the message being assembled on `channel`, or 0 if none is
+    ContentMaker* contentMaker(uint16_t channel);
+
+    /// Mark the message being assembled on `channel` as done, keeping its
+    /// maker to be reset for the channel's next message
+    void finishContent(uint16_t channel);
+
+    /// Return true if headers are kept encoded on `channel`
+    bool lazyHeaders(uint16_t channel) const;
+
+    /// Return the `rmqt::MessageProperty` bits decoded on `channel`
+    int decodedProperties(uint16_t channel) const;
+
+    /// Give the maker of a message with a body on `channel` a buffer from
+    /// the channel's payload allocator, if it has one
+    void supplyPayloadBuffer(uint16_t channel, ContentMaker* maker) const;
+
+    ChannelContentMakers d_channelContentMakers;
+
+    /// Channels with a message being assembled by their content maker
+    bsl::vector<bool> d_contentInProgress;
+    mutable ChannelPropertiesTemplates d_channelPropertiesTemplates;
+    bsl::vector<bool> d_lazyHeaderChannels;
+    bsl::vector<int> d_decodedProperties;
+    bsl::vector<rmqt::ConsumerConfig::PayloadAllocatorFunc>
+        d_payloadAllocators;
     size_t d_maxFrameSize;
+    bslma::Allocator* d_bufferAllocator;
 }; // class Framer
 
 } // namespace rmqamqp
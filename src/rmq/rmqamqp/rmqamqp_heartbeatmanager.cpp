@@ -22,5 +22,7 @@ HeartbeatManager::HeartbeatManager() {}
 
 HeartbeatManager::~HeartbeatManager() {}
 
+void HeartbeatManager::setReadsPaused(bool) {}
+
 } // namespace rmqamqp
 } // namespace BloombergLP
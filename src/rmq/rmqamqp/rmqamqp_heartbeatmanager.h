@@ -76,6 +76,11 @@ class HeartbeatManager {
     /// first heartbeat takes twice as long to be sent.
     virtual void notifyHeartbeatReceived() = 0;
 
+    /// Suspend connection death detection while reads from the socket are
+    /// paused, as nothing can be received. Heartbeats are still sent.
+    /// Resuming restarts the timeout from now.
+    virtual void setReadsPaused(bool paused);
+
   private:
     HeartbeatManager(const HeartbeatManager&) BSLS_KEYWORD_DELETED;
     HeartbeatManager& operator=(const HeartbeatManager&) BSLS_KEYWORD_DELETED;
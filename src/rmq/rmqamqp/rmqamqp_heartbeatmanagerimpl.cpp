@@ -19,35 +19,48 @@
 
 #include <rmqio_timer.h>
 
+#include <rmqt_log.h>
+
 #include <ball_log.h>
 #include <bdlf_bind.h>
+#include <bsls_systemtime.h>
 
+#include <bsl_algorithm.h>
 #include <bsl_functional.h>
 #include <bsl_memory.h>
 
 namespace BloombergLP {
 namespace rmqamqp {
 namespace {
-/// Number of seconds per tick
+/// Added to the disconnect timeout: the timeout used to be counted in ticks
+/// of this many seconds, one of them partial
 const int TICK_TIME = 1;
 
 BALL_LOG_SET_NAMESPACE_CATEGORY("RMQAMQP.HEARTBEATMANAGERIMPL")
+
+bsls::TimeInterval monotonicNow()
+{
+    return bsls::SystemTime::nowMonotonicClock();
+}
 } // namespace
 
 HeartbeatManagerImpl::HeartbeatManagerImpl(
-    const bsl::shared_ptr<rmqio::TimerFactory>& timerFactory)
+    const bsl::shared_ptr<rmqio::TimerFactory>& timerFactory,
+    const Clock& clock)
 : d_timeoutSeconds()
 , d_tickTimer(timerFactory->createWithCallback(
       bdlf::BindUtil::bind(&HeartbeatManagerImpl::handleTick,
                            this,
                            bdlf::PlaceHolders::_1)))
+, d_clock(clock ? clock : Clock(&monotonicNow))
 , d_sendHeartbeat()
 , d_killConnection()
 , d_active(false)
-, d_ticksUntilDisconnect(0)
-, d_ticksUntilHeartBeat(0)
-, d_totalTicksUntilDisconnect(0)
-, d_totalTicksUntilHeartBeat(0)
+, d_readsPaused(false)
+, d_lastSent()
+, d_lastReceived()
+, d_heartbeatInterval()
+, d_disconnectTimeout()
 {
 }
 
@@ -56,21 +69,25 @@ void HeartbeatManagerImpl::start(
     const HeartbeatManagerImpl::HeartbeatCallback& sendHeartbeat,
     const HeartbeatManagerImpl::ConnectionDeathCallback& onConnectionDeath)
 {
-    d_timeoutSeconds            = timeoutSeconds;
-    d_sendHeartbeat             = sendHeartbeat;
-    d_killConnection            = onConnectionDeath;
-    d_active                    = true;
-    d_totalTicksUntilDisconnect = d_timeoutSeconds * 2 / TICK_TIME + 1;
-    d_ticksUntilDisconnect      = d_totalTicksUntilDisconnect;
+    const bsls::TimeInterval now = d_clock();
+
+    d_timeoutSeconds = timeoutSeconds;
+    d_sendHeartbeat  = sendHeartbeat;
+    d_killConnection = onConnectionDeath;
+    d_active         = true;
+    d_lastSent       = now;
+    d_lastReceived   = now;
     // Add one tick as we want to guarantee d_timeoutSeconds has passed since
     // the last update.
     // Double timeout for the first heartbeat as before 3.7.11 of RMQ broker
     // first hearbeat takes twice as long to arrive.
     // https://github.com/rabbitmq/rabbitmq-common/pull/293/files
-    d_totalTicksUntilHeartBeat = d_timeoutSeconds / 2 / TICK_TIME;
-    d_ticksUntilHeartBeat      = d_totalTicksUntilHeartBeat;
+    d_disconnectTimeout =
+        bsls::TimeInterval(d_timeoutSeconds * 2 + TICK_TIME, 0);
+    d_heartbeatInterval = bsls::TimeInterval();
+    d_heartbeatInterval.addMilliseconds(d_timeoutSeconds * 1000 / 2);
 
-    startTickTimer();
+    startTickTimer(now);
 }
 
 void HeartbeatManagerImpl::stop()
@@ -85,41 +102,65 @@ void HeartbeatManagerImpl::handleTick(rmqio::Timer::InterruptReason reason)
         // Cancelled
         return;
     }
-    startTickTimer();
-    --d_ticksUntilHeartBeat;
-    --d_ticksUntilDisconnect;
-    if (d_ticksUntilHeartBeat == 0) {
-        BALL_LOG_DEBUG << "Heartbeat Triggered";
+
+    const bsls::TimeInterval now = d_clock();
+    if (now - d_lastSent >= d_heartbeatInterval) {
+        RMQT_LOG_DEBUG << "Heartbeat Triggered";
         d_sendHeartbeat(Framer::makeHeartbeatFrame());
-        d_ticksUntilHeartBeat = d_totalTicksUntilHeartBeat;
+        d_lastSent = now;
     }
-    if (d_ticksUntilDisconnect == 0) {
+    if (!d_readsPaused && now - d_lastReceived >= d_disconnectTimeout) {
         BALL_LOG_WARN << "Received no heartbeats for " << d_timeoutSeconds
                       << "seconds. Triggering connection termination";
+        d_lastReceived = now;
         d_killConnection();
-        d_ticksUntilDisconnect = d_totalTicksUntilDisconnect;
+    }
+
+    if (d_active) {
+        startTickTimer(now);
     }
 }
 
-void HeartbeatManagerImpl::startTickTimer()
+void HeartbeatManagerImpl::startTickTimer(const bsls::TimeInterval& now)
 {
-    d_tickTimer->reset(bsls::TimeInterval(TICK_TIME));
+    bsls::TimeInterval deadline = d_lastSent + d_heartbeatInterval;
+    if (!d_readsPaused) {
+        deadline = bsl::min(deadline, d_lastReceived + d_disconnectTimeout);
+    }
+    d_tickTimer->reset(deadline - now);
 }
 
 void HeartbeatManagerImpl::notifyMessageSent()
 {
-    d_ticksUntilHeartBeat = d_totalTicksUntilHeartBeat;
+    if (d_active) {
+        d_lastSent = d_clock();
+    }
 }
 
 void HeartbeatManagerImpl::notifyMessageReceived()
 {
-    d_ticksUntilDisconnect = d_totalTicksUntilDisconnect;
+    if (d_active) {
+        d_lastReceived = d_clock();
+    }
+}
+
+void HeartbeatManagerImpl::setReadsPaused(bool paused)
+{
+    if (paused == d_readsPaused) {
+        return;
+    }
+
+    d_readsPaused = paused;
+    if (!paused) {
+        // Frames held back by the pause are not the broker's fault
+        d_lastReceived = d_clock();
+    }
 }
 
 void HeartbeatManagerImpl::notifyHeartbeatReceived()
 {
-    d_totalTicksUntilDisconnect = d_timeoutSeconds / TICK_TIME + 1;
-    d_ticksUntilDisconnect      = d_totalTicksUntilDisconnect;
+    d_disconnectTimeout = bsls::TimeInterval(d_timeoutSeconds + TICK_TIME, 0);
+    d_lastReceived      = d_clock();
 }
 
 } // namespace rmqamqp
@@ -23,6 +23,7 @@
 
 #include <ball_log.h>
 #include <bdlf_bind.h>
+#include <bsls_timeinterval.h>
 
 #include <bsl_functional.h>
 #include <bsl_memory.h>
@@ -38,16 +39,27 @@ class Frame;
 }
 namespace rmqamqp {
 
+/// Sends and received frames only record the time. The one timer is armed
+/// for the earlier of the next heartbeat and the disconnect deadline, and
+/// deadlines pushed back by traffic are noticed when it fires, so a busy
+/// connection never sends a heartbeat and its timer fires only about once
+/// per half timeout.
+
 class HeartbeatManagerImpl : public HeartbeatManager {
   public:
     typedef bsl::function<void(const rmqamqpt::Frame&)> HeartbeatCallback;
     typedef bsl::function<void()> ConnectionDeathCallback;
 
+    /// Returns the current time, on the clock the timers run on
+    typedef bsl::function<bsls::TimeInterval()> Clock;
+
     /// Construct a HeartbeatManager associated with the timer factory.
     /// This class will do nothing until start() is called
     /// \param timerFactory factory for constructing timers
-    HeartbeatManagerImpl(
-        const bsl::shared_ptr<rmqio::TimerFactory>& timerFactory);
+    /// \param clock the monotonic system clock if empty
+    explicit HeartbeatManagerImpl(
+        const bsl::shared_ptr<rmqio::TimerFactory>& timerFactory,
+        const Clock& clock = Clock());
 
     ~HeartbeatManagerImpl() {}
 
@@ -62,6 +74,8 @@ class HeartbeatManagerImpl : public HeartbeatManager {
 
     virtual void notifyHeartbeatReceived() BSLS_KEYWORD_OVERRIDE;
 
+    virtual void setReadsPaused(bool paused) BSLS_KEYWORD_OVERRIDE;
+
   private:
     HeartbeatManagerImpl(const HeartbeatManagerImpl&) BSLS_KEYWORD_DELETED;
 
@@ -69,19 +83,23 @@ class HeartbeatManagerImpl : public HeartbeatManager {
     operator=(const HeartbeatManagerImpl&) BSLS_KEYWORD_DELETED;
     void handleTick(rmqio::Timer::InterruptReason reason);
 
-    void startTickTimer();
+    /// Arm the timer for the earlier of the heartbeat and disconnect
+    /// deadlines, as of `now`
+    void startTickTimer(const bsls::TimeInterval& now);
 
   private:
     uint32_t d_timeoutSeconds;
 
     bsl::shared_ptr<rmqio::Timer> d_tickTimer;
+    Clock d_clock;
     HeartbeatCallback d_sendHeartbeat;
     ConnectionDeathCallback d_killConnection;
     bool d_active;
-    size_t d_ticksUntilDisconnect;
-    size_t d_ticksUntilHeartBeat;
-    size_t d_totalTicksUntilDisconnect;
-    size_t d_totalTicksUntilHeartBeat;
+    bool d_readsPaused;
+    bsls::TimeInterval d_lastSent;
+    bsls::TimeInterval d_lastReceived;
+    bsls::TimeInterval d_heartbeatInterval;
+    bsls::TimeInterval d_disconnectTimeout;
 }; // class HeartbeatManagerImpl
 
 } // namespace rmqamqp
@@ -0,0 +1,147 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqamqp_hostselector.h>
+
+#include <bslmt_lockguard.h>
+#include <bsls_assert.h>
+#include <bsls_systemtime.h>
+
+namespace BloombergLP {
+namespace rmqamqp {
+
+namespace {
+/// Weight of the latest connect time in the moving average
+const double k_CONNECT_TIME_WEIGHT = 0.25;
+} // namespace
+
+HostSelector::HostState::HostState()
+: connections(0)
+, connectTime(0)
+, failedAt()
+{
+}
+
+HostSelector::HostSelector(rmqt::HostSelection::Value policy,
+                           const bsls::TimeInterval& failureCooldown)
+: d_policy(policy)
+, d_failureCooldown(failureCooldown)
+, d_mutex()
+, d_hosts()
+, d_next(0)
+{
+}
+
+double HostSelector::cost(const HostState& state,
+                          double meanConnectTime) const
+{
+    switch (d_policy) {
+        case rmqt::HostSelection::ROUND_ROBIN:
+            return 0;
+        case rmqt::HostSelection::LEAST_CONNECTIONS:
+            return static_cast<double>(state.connections);
+        case rmqt::HostSelection::LATENCY_WEIGHTED: {
+            // Hosts not measured yet count as average, so they get tried
+            const double connectTime =
+                state.connectTime > 0 ? state.connectTime : meanConnectTime;
+            return static_cast<double>(state.connections + 1) * connectTime;
+        }
+    }
+    return 0;
+}
+
+bsl::size_t HostSelector::select(const HostList& hosts)
+{
+    BSLS_ASSERT(!hosts.empty());
+    if (hosts.size() == 1) {
+        return 0;
+    }
+
+    const bsls::TimeInterval now = bsls::SystemTime::nowMonotonicClock();
+
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+
+    double totalConnectTime = 0;
+    bsl::size_t measured    = 0;
+    for (HostList::const_iterator it = hosts.begin(); it != hosts.end();
+         ++it) {
+        const HostState& state = d_hosts[*it];
+        if (state.connectTime > 0) {
+            totalConnectTime += state.connectTime;
+            ++measured;
+        }
+    }
+    const double meanConnectTime =
+        measured ? totalConnectTime / static_cast<double>(measured) : 1;
+
+    // Search from `d_next` so that equally suitable hosts take turns. Prefer
+    // hosts which are not failing, then the lowest cost.
+    bsl::size_t best = hosts.size();
+    bool bestFailing = true;
+    double bestCost  = 0;
+    for (bsl::size_t i = 0; i < hosts.size(); ++i) {
+        const bsl::size_t index = (d_next + i) % hosts.size();
+        const HostState& state  = d_hosts[hosts[index]];
+        const bool failing      = state.failedAt > bsls::TimeInterval() &&
+                             now - state.failedAt < d_failureCooldown;
+        const double hostCost = cost(state, meanConnectTime);
+
+        if (best == hosts.size() || (bestFailing && !failing) ||
+            (bestFailing == failing && hostCost < bestCost)) {
+            best        = index;
+            bestFailing = failing;
+            bestCost    = hostCost;
+        }
+    }
+
+    d_next = best + 1;
+    return best;
+}
+
+void HostSelector::connected(const Host& host,
+                             const bsls::TimeInterval& connectTime)
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+
+    HostState& state = d_hosts[host];
+    ++state.connections;
+    state.failedAt    = bsls::TimeInterval();
+    const double seconds = connectTime.totalSecondsAsDouble();
+    state.connectTime =
+        state.connectTime > 0
+            ? state.connectTime * (1 - k_CONNECT_TIME_WEIGHT) +
+                  seconds * k_CONNECT_TIME_WEIGHT
+            : seconds;
+}
+
+void HostSelector::disconnected(const Host& host)
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+
+    HostState& state = d_hosts[host];
+    if (state.connections > 0) {
+        --state.connections;
+    }
+}
+
+void HostSelector::failed(const Host& host)
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+
+    d_hosts[host].failedAt = bsls::SystemTime::nowMonotonicClock();
+}
+
+} // namespace rmqamqp
+} // namespace BloombergLP
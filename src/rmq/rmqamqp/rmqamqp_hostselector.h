@@ -0,0 +1,100 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQAMQP_HOSTSELECTOR
+#define INCLUDED_RMQAMQP_HOSTSELECTOR
+
+#include <rmqt_endpoint.h>
+#include <rmqt_properties.h>
+
+#include <bslmt_mutex.h>
+#include <bsls_keyword.h>
+#include <bsls_timeinterval.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_map.h>
+
+namespace BloombergLP {
+namespace rmqamqp {
+
+//@PURPOSE: Pick which broker host a connection attempt goes to
+//
+//@CLASSES:
+//  rmqamqp::HostSelector: spreads a context's connections across hosts
+
+/// \brief Spreads the connections of a context across the hosts of their
+/// endpoints, see `rmqt::Endpoint::hosts`
+///
+/// Connections report how each attempt on a host went, so that one selector
+/// shared between all connections of a context knows how many connections
+/// each host carries, how long connecting to it takes, and which hosts are
+/// failing. A host which failed to connect is skipped for
+/// `failureCooldown`, unless every host is failing, so reconnects go
+/// straight to the hosts which are up. Thread-safe.
+
+class HostSelector {
+  public:
+    typedef rmqt::Endpoint::Host Host;
+    typedef rmqt::Endpoint::HostList HostList;
+
+    static const int k_DEFAULT_FAILURE_COOLDOWN_SEC = 30;
+
+    explicit HostSelector(
+        rmqt::HostSelection::Value policy = rmqt::HostSelection::ROUND_ROBIN,
+        const bsls::TimeInterval& failureCooldown =
+            bsls::TimeInterval(k_DEFAULT_FAILURE_COOLDOWN_SEC));
+
+    /// Return the index of the host of `hosts`, which must not be empty, to
+    /// connect to next
+    bsl::size_t select(const HostList& hosts);
+
+    /// Record a connection to `host` which took `connectTime` to open
+    void connected(const Host& host, const bsls::TimeInterval& connectTime);
+
+    /// Record a connection to `host` which has closed after `connected`
+    void disconnected(const Host& host);
+
+    /// Record a failed attempt to connect to `host`
+    void failed(const Host& host);
+
+  private:
+    struct HostState {
+        HostState();
+
+        bsl::size_t connections;
+        double connectTime;          ///< Seconds, moving average, 0 if unknown
+        bsls::TimeInterval failedAt; ///< Zero if not failing
+    };
+
+    typedef bsl::map<Host, HostState> HostStates;
+
+    /// Return how much less suitable `state` is, lower being better
+    double cost(const HostState& state, double meanConnectTime) const;
+
+    const rmqt::HostSelection::Value d_policy;
+    const bsls::TimeInterval d_failureCooldown;
+    bslmt::Mutex d_mutex;
+    HostStates d_hosts;
+    bsl::size_t d_next; ///< Where the next search starts, to break ties
+
+  private:
+    HostSelector(const HostSelector&) BSLS_KEYWORD_DELETED;
+    HostSelector& operator=(const HostSelector&) BSLS_KEYWORD_DELETED;
+};
+
+} // namespace rmqamqp
+} // namespace BloombergLP
+
+#endif
@@ -0,0 +1,123 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqamqp_memorybudget.h>
+
+#include <ball_log.h>
+#include <bslmt_lockguard.h>
+#include <bsls_systemtime.h>
+
+#include <bsl_algorithm.h>
+
+namespace BloombergLP {
+namespace rmqamqp {
+namespace {
+
+BALL_LOG_SET_NAMESPACE_CATEGORY("RMQAMQP.MEMORYBUDGET")
+
+} // namespace
+
+MemoryBudget::MemoryBudget(bsl::size_t limit)
+: d_limit(limit)
+, d_mutex()
+, d_room()
+, d_used(0)
+, d_roomCallbacks()
+{
+}
+
+void MemoryBudget::acquire(bsl::size_t bytes)
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    const bool wasExhausted = d_used >= d_limit;
+    d_used += bytes;
+
+    if (!wasExhausted && d_used >= d_limit) {
+        BALL_LOG_INFO << "Memory budget of " << d_limit
+                      << " bytes exhausted, applying backpressure";
+    }
+}
+
+void MemoryBudget::release(bsl::size_t bytes)
+{
+    bsl::vector<RoomCallback> callbacks;
+    {
+        bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+        const bool wasExhausted = d_used >= d_limit;
+        d_used -= bsl::min(bytes, d_used);
+
+        if (!wasExhausted || d_used >= d_limit) {
+            return;
+        }
+
+        BALL_LOG_INFO << "Memory budget back under " << d_limit << " bytes";
+        d_room.broadcast();
+        callbacks.swap(d_roomCallbacks);
+    }
+
+    // Invoked without the mutex held, so that callbacks can use the budget
+    for (bsl::vector<RoomCallback>::iterator it = callbacks.begin();
+         it != callbacks.end();
+         ++it) {
+        (*it)();
+    }
+}
+
+bool MemoryBudget::waitForRoom(const bsls::TimeInterval& timeout)
+{
+    const bool hasTimeout = timeout.totalNanoseconds() != 0;
+    const bsls::TimeInterval deadline =
+        bsls::SystemTime::nowRealtimeClock() + timeout;
+
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    while (d_used >= d_limit) {
+        if (hasTimeout) {
+            if (d_room.timedWait(&d_mutex, deadline)) {
+                return d_used < d_limit;
+            }
+        }
+        else {
+            d_room.wait(&d_mutex);
+        }
+    }
+    return true;
+}
+
+void MemoryBudget::notifyWhenRoom(const RoomCallback& callback)
+{
+    {
+        bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+        if (d_used >= d_limit) {
+            d_roomCallbacks.push_back(callback);
+            return;
+        }
+    }
+    callback();
+}
+
+bool MemoryBudget::exhausted() const
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    return d_used >= d_limit;
+}
+
+bsl::size_t MemoryBudget::used() const
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    return d_used;
+}
+
+} // namespace rmqamqp
+} // namespace BloombergLP
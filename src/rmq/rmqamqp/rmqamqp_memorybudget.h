@@ -0,0 +1,89 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQAMQP_MEMORYBUDGET
+#define INCLUDED_RMQAMQP_MEMORYBUDGET
+
+#include <bslmt_condition.h>
+#include <bslmt_mutex.h>
+#include <bsls_keyword.h>
+#include <bsls_timeinterval.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_functional.h>
+#include <bsl_vector.h>
+
+namespace BloombergLP {
+namespace rmqamqp {
+
+//@PURPOSE: Bound the message bytes a RabbitContext holds
+//
+//@CLASSES:
+//  rmqamqp::MemoryBudget: Byte accounting shared by producers and consumers
+
+/// \brief Counts the payload bytes of unconfirmed publishes and unacked
+/// deliveries against a limit
+///
+/// Deliveries have already arrived when they are counted, so `acquire`
+/// always succeeds and the budget may run over its limit. Producers check
+/// for room before publishing, and consumers shrink their prefetch while
+/// the budget is exhausted, which bounds how far it runs over.
+///
+/// Thread safe.
+
+class MemoryBudget {
+  public:
+    /// Invoked once the budget has room again, see `notifyWhenRoom`
+    typedef bsl::function<void()> RoomCallback;
+
+    explicit MemoryBudget(bsl::size_t limit);
+
+    /// Count `bytes` against the budget
+    void acquire(bsl::size_t bytes);
+
+    /// Return `bytes` counted by `acquire`, waking waiters and invoking
+    /// callbacks if this brings the budget back under its limit
+    void release(bsl::size_t bytes);
+
+    /// Block until the budget has room, or `timeout` passes (if non-zero).
+    /// Return false on timeout.
+    bool waitForRoom(const bsls::TimeInterval& timeout);
+
+    /// Invoke `callback` once the budget has room: immediately, on this
+    /// thread, if it already has, otherwise on the thread calling `release`
+    void notifyWhenRoom(const RoomCallback& callback);
+
+    /// Return true once the bytes counted reach the limit
+    bool exhausted() const;
+
+    bsl::size_t used() const;
+
+    bsl::size_t limit() const { return d_limit; }
+
+  private:
+    MemoryBudget(const MemoryBudget&) BSLS_KEYWORD_DELETED;
+    MemoryBudget& operator=(const MemoryBudget&) BSLS_KEYWORD_DELETED;
+
+    const bsl::size_t d_limit;
+    mutable bslmt::Mutex d_mutex;
+    bslmt::Condition d_room;
+    bsl::size_t d_used;
+    bsl::vector<RoomCallback> d_roomCallbacks;
+};
+
+} // namespace rmqamqp
+} // namespace BloombergLP
+
+#endif
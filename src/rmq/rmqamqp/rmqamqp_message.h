@@ -16,6 +16,9 @@
 #ifndef INCLUDED_RMQAMQP_MESSAGE
 #define INCLUDED_RMQAMQP_MESSAGE
 
+#include <rmqamqpt_contentbody.h>
+#include <rmqamqpt_contentheader.h>
+#include <rmqamqpt_encodedmethod.h>
 #include <rmqamqpt_heartbeat.h>
 #include <rmqamqpt_method.h>
 #include <rmqt_message.h>
@@ -30,12 +33,20 @@
 //         Frame Type 1   (Method)         -> message.the<Method>()
 //         Frame Type 2/3 (Header/Body(s)) -> message.the<rmqt::Message>()
 //         Frame Type 8   (Heartbeat)      -> message.the<Heartbeat>()
+//       A streamed message is written as a ContentHeader followed by its
+//       ContentBody chunks, each framed as it is published.
+//       An EncodedMethod is an outgoing Method whose encoding is re-used.
 //
 
 namespace BloombergLP {
 namespace rmqamqp {
 
-typedef bdlb::Variant<rmqamqpt::Heartbeat, rmqt::Message, rmqamqpt::Method>
+typedef bdlb::Variant<rmqamqpt::Heartbeat,
+                      rmqt::Message,
+                      rmqamqpt::Method,
+                      rmqamqpt::ContentHeader,
+                      rmqamqpt::ContentBody,
+                      rmqamqpt::EncodedMethod>
     Message;
 
 } // namespace rmqamqp
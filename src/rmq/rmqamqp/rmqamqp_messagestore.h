@@ -16,18 +16,20 @@
 #ifndef INCLUDED_RMQAMQP_MESSAGESTORE
 #define INCLUDED_RMQAMQP_MESSAGESTORE
 
+#include <rmqio_coarseclock.h>
+#include <rmqt_log.h>
 #include <rmqt_message.h>
 
 #include <ball_log.h>
 #include <bdlb_guid.h>
 #include <bdlb_guidutil.h>
-#include <bdlt_currenttime.h>
 #include <bslmt_once.h>
 #include <bsls_atomic.h>
 #include <bsls_timeinterval.h>
 
 #include <bsl_algorithm.h>
 #include <bsl_cstddef.h>
+#include <bsl_functional.h>
 #include <bsl_map.h>
 #include <bsl_memory.h>
 #include <bsl_unordered_map.h>
@@ -46,6 +48,9 @@ class MessageStore {
   public:
     typedef bsl::pair<uint64_t, bsl::pair<Msg, bdlt::Datetime> > Entry;
     typedef bsl::vector<Entry> MessageList;
+    typedef bsl::function<void(uint64_t deliveryTag,
+                               const bsl::pair<Msg, bdlt::Datetime>& message)>
+        MessageVisitor;
 
     MessageStore();
 
@@ -61,6 +66,8 @@ class MessageStore {
     /// Search message by guid in the store
     /// Return true and set the message and deliveryTag arguments, if
     /// successful search
+    /// The GUID index is built on the first call, and maintained from then
+    /// on, so stores which are never searched by GUID do not pay for it.
     bool
     lookup(const bdlb::Guid& guid, Msg* message, uint64_t* deliveryTag) const;
 
@@ -92,6 +99,14 @@ class MessageStore {
     /// Return messages older than `time` (absolute time)
     MessageList getMessagesOlderThan(const bdlt::Datetime& time) const;
 
+    /// Call `visitor` with the delivery-tag, message and insert time of each
+    /// message inserted at or before `time` (absolute time), oldest first,
+    /// without copying them out of the store. Delivery-tags are assigned in
+    /// insertion order, so the scan stops at the first younger message.
+    /// Return the number of messages visited.
+    bsl::size_t visitMessagesOlderThan(const bdlt::Datetime& time,
+                                       const MessageVisitor& visitor) const;
+
   private:
     MessageStore(const MessageStore&) BSLS_KEYWORD_DELETED;
     MessageStore& operator=(const MessageStore&) BSLS_KEYWORD_DELETED;
@@ -102,8 +117,11 @@ class MessageStore {
                                typename DeliveryTagToMessageMap::iterator>
         GuidToMessageMap;
 
+    void buildGuidIndex() const;
+
     DeliveryTagToMessageMap d_deliveryTagToMsg;
-    GuidToMessageMap d_guidToMsg;
+    mutable GuidToMessageMap d_guidToMsg;
+    mutable bool d_guidIndexBuilt;
     uint64_t d_latestTagTilNow;
     size_t d_lifetimeId;
 
@@ -114,6 +132,7 @@ template <typename Msg>
 MessageStore<Msg>::MessageStore()
 : d_deliveryTagToMsg()
 , d_guidToMsg()
+, d_guidIndexBuilt(false)
 , d_latestTagTilNow(0)
 , d_lifetimeId(0)
 {
@@ -124,7 +143,7 @@ bool MessageStore<Msg>::insert(uint64_t deliveryTag, const Msg& message)
 {
     bsl::pair<typename DeliveryTagToMessageMap::iterator, bool> ret =
         d_deliveryTagToMsg.emplace(
-            deliveryTag, bsl::make_pair(message, bdlt::CurrentTime::utc()));
+            deliveryTag, bsl::make_pair(message, rmqio::CoarseClock::utc()));
     if (!ret.second) {
         if (message.guid() != (ret.first)->second.first.guid()) {
             BALL_LOG_FATAL << "Different message already present in the store "
@@ -138,15 +157,17 @@ bool MessageStore<Msg>::insert(uint64_t deliveryTag, const Msg& message)
         return false;
     }
 
-    bsl::pair<typename GuidToMessageMap::iterator, bool> guidRc =
-        d_guidToMsg.insert(bsl::make_pair(message.guid(), ret.first));
+    if (d_guidIndexBuilt) {
+        bsl::pair<typename GuidToMessageMap::iterator, bool> guidRc =
+            d_guidToMsg.insert(bsl::make_pair(message.guid(), ret.first));
 
-    if (!guidRc.second) {
-        BALL_LOG_ERROR << "Duplicate message id (" << message.guid()
-                       << ") received from broker with "
-                          "different deliveryTags [r"
-                       << deliveryTag << ":s" << guidRc.first->second->first
-                       << "]";
+        if (!guidRc.second) {
+            BALL_LOG_ERROR << "Duplicate message id (" << message.guid()
+                           << ") received from broker with "
+                              "different deliveryTags [r"
+                           << deliveryTag << ":s"
+                           << guidRc.first->second->first << "]";
+        }
     }
 
     d_latestTagTilNow = bsl::max(d_latestTagTilNow, deliveryTag);
@@ -171,6 +192,10 @@ bool MessageStore<Msg>::lookup(const bdlb::Guid& guid,
                                Msg* message,
                                uint64_t* deliveryTag) const
 {
+    if (!d_guidIndexBuilt) {
+        buildGuidIndex();
+    }
+
     const typename GuidToMessageMap::const_iterator it = d_guidToMsg.find(guid);
     if (it == d_guidToMsg.end()) {
         return false;
@@ -193,7 +218,9 @@ bool MessageStore<Msg>::remove(uint64_t deliveryTag,
     *message    = it->second.first;
     *insertTime = it->second.second;
     d_deliveryTagToMsg.erase(it);
-    d_guidToMsg.erase(message->guid());
+    if (d_guidIndexBuilt) {
+        d_guidToMsg.erase(message->guid());
+    }
     return true;
 }
 
@@ -208,7 +235,8 @@ MessageStore<Msg>::removeUntil(uint64_t deliveryTag)
     }
 
     if (d_deliveryTagToMsg.find(deliveryTag) == d_deliveryTagToMsg.end()) {
-        BALL_LOG_ERROR << deliveryTag << " is not present in the store.";
+        RMQT_LOG_ERROR_THROTTLED << deliveryTag
+                                 << " is not present in the store.";
         return removedMessages;
     }
 
@@ -216,7 +244,9 @@ MessageStore<Msg>::removeUntil(uint64_t deliveryTag)
         d_deliveryTagToMsg.cbegin();
     for (; (it != d_deliveryTagToMsg.cend()) && (it->first <= deliveryTag);
          ++it) {
-        d_guidToMsg.erase(it->second.first.guid());
+        if (d_guidIndexBuilt) {
+            d_guidToMsg.erase(it->second.first.guid());
+        }
         removedMessages.push_back(*it);
     }
     d_deliveryTagToMsg.erase(d_deliveryTagToMsg.cbegin(), it);
@@ -229,11 +259,31 @@ void MessageStore<Msg>::swap(MessageStore& msgStore)
 {
     bsl::swap(d_deliveryTagToMsg, msgStore.d_deliveryTagToMsg);
     bsl::swap(d_guidToMsg, msgStore.d_guidToMsg);
+    bsl::swap(d_guidIndexBuilt, msgStore.d_guidIndexBuilt);
     bsl::swap(d_latestTagTilNow, msgStore.d_latestTagTilNow);
 
     d_lifetimeId++;
 }
 
+template <typename Msg>
+void MessageStore<Msg>::buildGuidIndex() const
+{
+    // `d_deliveryTagToMsg` is logically const here, the index only needs
+    // mutable iterators to it
+    DeliveryTagToMessageMap& messages =
+        const_cast<DeliveryTagToMessageMap&>(d_deliveryTagToMsg);
+
+    d_guidToMsg.clear();
+    d_guidToMsg.reserve(messages.size());
+    for (typename DeliveryTagToMessageMap::iterator it = messages.begin();
+         it != messages.end();
+         ++it) {
+        // Keep the oldest tag for a duplicated GUID, as insert does
+        d_guidToMsg.insert(bsl::make_pair(it->second.first.guid(), it));
+    }
+    d_guidIndexBuilt = true;
+}
+
 template <typename Msg>
 uint64_t MessageStore<Msg>::latestTagInStore() const
 {
@@ -268,6 +318,23 @@ MessageStore<Msg>::getMessagesOlderThan(const bdlt::Datetime& time) const
     return results;
 }
 
+template <typename Msg>
+bsl::size_t MessageStore<Msg>::visitMessagesOlderThan(
+    const bdlt::Datetime& time,
+    const MessageVisitor& visitor) const
+{
+    bsl::size_t visited = 0;
+    for (typename DeliveryTagToMessageMap::const_iterator it =
+             d_deliveryTagToMsg.cbegin();
+         it != d_deliveryTagToMsg.cend() && it->second.second <= time;
+         ++it) {
+        visitor(it->first, it->second);
+        ++visited;
+    }
+
+    return visited;
+}
+
 } // namespace rmqamqp
 } // namespace BloombergLP
 
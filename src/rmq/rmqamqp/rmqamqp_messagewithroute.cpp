@@ -17,25 +17,40 @@
 
 #include <rmqt_message.h>
 
+#include <bsl_memory.h>
 #include <bsl_ostream.h>
 #include <bsl_string.h>
 
 namespace BloombergLP {
 namespace rmqamqp {
 
+MessageWithRoute::Route::Route(const rmqt::Message& msg,
+                               const bsl::shared_ptr<const bsl::string>& key,
+                               rmqt::Mandatory::Value flag)
+: message(msg)
+, routingKey(key)
+, mandatory(flag)
+{
+}
+
 MessageWithRoute::MessageWithRoute()
-: d_message()
-, d_routingKey()
-, d_mandatory(rmqt::Mandatory::RETURN_UNROUTABLE)
+: d_route()
 {
 }
 
 MessageWithRoute::MessageWithRoute(const rmqt::Message& msg,
                                    const bsl::string& routingKey,
                                    rmqt::Mandatory::Value mandatory)
-: d_message(msg)
-, d_routingKey(routingKey)
-, d_mandatory(mandatory)
+: d_route(bsl::make_shared<Route>(
+      msg, bsl::make_shared<bsl::string>(routingKey), mandatory))
+{
+}
+
+MessageWithRoute::MessageWithRoute(
+    const rmqt::Message& msg,
+    const bsl::shared_ptr<const bsl::string>& routingKey,
+    rmqt::Mandatory::Value mandatory)
+: d_route(bsl::make_shared<Route>(msg, routingKey, mandatory))
 {
 }
 
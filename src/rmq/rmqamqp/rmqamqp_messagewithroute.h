@@ -22,12 +22,20 @@
 #include <bsls_timeinterval.h>
 
 #include <bsl_cstddef.h>
+#include <bsl_memory.h>
 #include <bsl_ostream.h>
 #include <bsl_string.h>
 
 namespace BloombergLP {
 namespace rmqamqp {
 
+/// \brief A message published with its routing key and mandatory flag
+///
+/// A handle to an immutable message, shared by its copies: the channel keeps
+/// the same message in its pending queue, its message store and the confirm
+/// it hands back, so copying it only bumps a reference count. A
+/// default-constructed MessageWithRoute is empty, and is only assigned to.
+
 class MessageWithRoute {
   public:
     MessageWithRoute();
@@ -35,17 +43,31 @@ class MessageWithRoute {
                      const bsl::string& routingKey,
                      rmqt::Mandatory::Value mandatory);
 
-    const rmqt::Message& message() const { return d_message; }
-    const bsl::string& routingKey() const { return d_routingKey; }
-    rmqt::Mandatory::Value mandatory() const { return d_mandatory; }
+    /// Refer to `routingKey`, e.g. as interned by a RoutingKeyTable, rather
+    /// than copying it
+    MessageWithRoute(const rmqt::Message& msg,
+                     const bsl::shared_ptr<const bsl::string>& routingKey,
+                     rmqt::Mandatory::Value mandatory);
+
+    const rmqt::Message& message() const { return d_route->message; }
+    const bsl::string& routingKey() const { return *d_route->routingKey; }
+    rmqt::Mandatory::Value mandatory() const { return d_route->mandatory; }
 
-    const bdlb::Guid guid() const { return d_message.guid(); }
-    bsl::size_t payloadSize() const { return d_message.payloadSize(); }
+    const bdlb::Guid guid() const { return message().guid(); }
+    bsl::size_t payloadSize() const { return message().payloadSize(); }
 
   private:
-    rmqt::Message d_message;
-    bsl::string d_routingKey;
-    rmqt::Mandatory::Value d_mandatory;
+    struct Route {
+        Route(const rmqt::Message& msg,
+              const bsl::shared_ptr<const bsl::string>& key,
+              rmqt::Mandatory::Value flag);
+
+        const rmqt::Message message;
+        const bsl::shared_ptr<const bsl::string> routingKey;
+        const rmqt::Mandatory::Value mandatory;
+    };
+
+    bsl::shared_ptr<const Route> d_route;
 }; // class MessageWithRoute
 
 bsl::ostream& operator<<(bsl::ostream& os,
@@ -0,0 +1,363 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqamqp_metricaggregator.h>
+
+#include <bdlb_bitutil.h>
+#include <bslmt_lockguard.h>
+#include <bslmt_threadutil.h>
+#include <bsls_atomic.h>
+
+#include <bsl_algorithm.h>
+
+namespace BloombergLP {
+namespace rmqamqp {
+namespace {
+
+const bsl::size_t k_COUNTER_STRIPES      = 8;
+const bsl::size_t k_DISTRIBUTION_STRIPES = 4;
+const bsl::size_t k_CACHE_LINE           = 64;
+
+/// Values below `k_SUB_BUCKETS` microseconds have a bucket each, above that
+/// each power of two is split into `k_SUB_BUCKETS` buckets
+const int k_SUB_BUCKET_BITS   = 3;
+const int k_SUB_BUCKETS       = 1 << k_SUB_BUCKET_BITS;
+const int k_MAX_EXPONENT      = 40; // ~12.7 days in microseconds
+const bsl::size_t k_BUCKETS   = k_SUB_BUCKETS +
+                              (k_MAX_EXPONENT - k_SUB_BUCKET_BITS + 1) *
+                                  k_SUB_BUCKETS;
+
+struct PaddedCounter {
+    bsls::AtomicInt64 value;
+    char padding[k_CACHE_LINE - sizeof(bsls::AtomicInt64)];
+};
+
+/// Return the stripe the calling thread updates, out of `stripes` (a power
+/// of two)
+bsl::size_t stripe(bsl::size_t stripes)
+{
+    // Thread ids are often aligned addresses, so mix them before picking
+    const bsls::Types::Uint64 mixed =
+        bslmt::ThreadUtil::selfIdAsUint64() * 0x9E3779B97F4A7C15ULL;
+    return static_cast<bsl::size_t>(mixed >> 32) & (stripes - 1);
+}
+
+bsl::size_t bucketOf(double seconds)
+{
+    const double microseconds = seconds * 1e6;
+    if (!(microseconds >= 1)) { // Also catches NaN
+        return 0;
+    }
+    if (microseconds >= static_cast<double>(1ULL << (k_MAX_EXPONENT + 1))) {
+        return k_BUCKETS - 1;
+    }
+
+    const bsls::Types::Uint64 value =
+        static_cast<bsls::Types::Uint64>(microseconds);
+    if (value < static_cast<bsls::Types::Uint64>(k_SUB_BUCKETS)) {
+        return static_cast<bsl::size_t>(value);
+    }
+
+    const int exponent = 63 - bdlb::BitUtil::numLeadingUnsetBits(value);
+    const int shift    = exponent - k_SUB_BUCKET_BITS;
+    const bsl::size_t subBucket =
+        static_cast<bsl::size_t>(value >> shift) & (k_SUB_BUCKETS - 1);
+    return k_SUB_BUCKETS + shift * k_SUB_BUCKETS + subBucket;
+}
+
+/// Return the midpoint, in seconds, of the values in `bucket`
+double valueOf(bsl::size_t bucket)
+{
+    if (bucket < static_cast<bsl::size_t>(k_SUB_BUCKETS)) {
+        return static_cast<double>(bucket) / 1e6;
+    }
+
+    const int shift = static_cast<int>(bucket / k_SUB_BUCKETS) - 1;
+    const bsls::Types::Uint64 lower =
+        static_cast<bsls::Types::Uint64>(k_SUB_BUCKETS +
+                                         bucket % k_SUB_BUCKETS)
+        << shift;
+    const double width = static_cast<double>(1ULL << shift);
+    return (static_cast<double>(lower) + width / 2) / 1e6;
+}
+
+} // namespace
+
+class MetricAggregator::CounterImpl {
+  public:
+    /// Publish every update to `publisher` if given, otherwise accumulate
+    /// them until `flush`
+    CounterImpl(const bsl::shared_ptr<rmqp::MetricPublisher>& publisher,
+                const bsl::string& name,
+                const Tags& tags)
+    : d_publisher(publisher)
+    , d_name(name)
+    , d_tags(tags)
+    {
+    }
+
+    void add(bsls::Types::Int64 value)
+    {
+        if (d_publisher) {
+            d_publisher->publishCounter(
+                d_name, static_cast<double>(value), d_tags);
+            return;
+        }
+        d_stripes[stripe(k_COUNTER_STRIPES)].value.addRelaxed(value);
+    }
+
+    void flush(rmqp::MetricPublisher& publisher)
+    {
+        bsls::Types::Int64 total = 0;
+        for (bsl::size_t i = 0; i < k_COUNTER_STRIPES; ++i) {
+            total += d_stripes[i].value.swapAcqRel(0);
+        }
+        if (total) {
+            publisher.publishCounter(
+                d_name, static_cast<double>(total), d_tags);
+        }
+    }
+
+  private:
+    bsl::shared_ptr<rmqp::MetricPublisher> d_publisher;
+    const bsl::string d_name;
+    const Tags d_tags;
+    PaddedCounter d_stripes[k_COUNTER_STRIPES];
+};
+
+class MetricAggregator::DistributionImpl {
+  public:
+    /// Publish every update to `publisher` if given, otherwise accumulate
+    /// them until `flush`
+    DistributionImpl(const bsl::shared_ptr<rmqp::MetricPublisher>& publisher,
+                     const bsl::string& name,
+                     const Tags& tags)
+    : d_publisher(publisher)
+    , d_name(name)
+    , d_tags(tags)
+    {
+    }
+
+    void record(double seconds)
+    {
+        if (d_publisher) {
+            d_publisher->publishDistribution(d_name, seconds, d_tags);
+            return;
+        }
+        d_stripes[stripe(k_DISTRIBUTION_STRIPES)][bucketOf(seconds)]
+            .addRelaxed(1);
+    }
+
+    void flush(rmqp::MetricPublisher& publisher)
+    {
+        for (bsl::size_t bucket = 0; bucket < k_BUCKETS; ++bucket) {
+            bsls::Types::Int64 count = 0;
+            for (bsl::size_t i = 0; i < k_DISTRIBUTION_STRIPES; ++i) {
+                if (d_stripes[i][bucket].loadRelaxed()) {
+                    count += d_stripes[i][bucket].swapAcqRel(0);
+                }
+            }
+            if (count) {
+                publisher.publishDistributionSamples(
+                    d_name,
+                    valueOf(bucket),
+                    static_cast<bsl::size_t>(count),
+                    d_tags);
+            }
+        }
+    }
+
+  private:
+    bsl::shared_ptr<rmqp::MetricPublisher> d_publisher;
+    const bsl::string d_name;
+    const Tags d_tags;
+    bsls::AtomicInt64 d_stripes[k_DISTRIBUTION_STRIPES][k_BUCKETS];
+};
+
+MetricAggregator::Counter::Counter()
+: d_impl()
+{
+}
+
+MetricAggregator::Counter::Counter(const bsl::shared_ptr<CounterImpl>& impl)
+: d_impl(impl)
+{
+}
+
+void MetricAggregator::Counter::addImpl(bsls::Types::Int64 value) const
+{
+    d_impl->add(value);
+}
+
+MetricAggregator::Distribution::Distribution()
+: d_impl()
+{
+}
+
+MetricAggregator::Distribution::Distribution(
+    const bsl::shared_ptr<DistributionImpl>& impl)
+: d_impl(impl)
+{
+}
+
+void MetricAggregator::Distribution::recordImpl(double seconds) const
+{
+    d_impl->record(seconds);
+}
+
+MetricAggregator::Counter MetricAggregator::counter(
+    const bsl::shared_ptr<rmqp::MetricPublisher>& publisher,
+    const bsl::string& name,
+    const Tags& tags)
+{
+    if (!publisher) {
+        return Counter();
+    }
+
+    MetricAggregator* aggregator =
+        dynamic_cast<MetricAggregator*>(publisher.get());
+    if (aggregator) {
+        return aggregator->registerCounter(name, tags);
+    }
+    return Counter(bsl::make_shared<CounterImpl>(publisher, name, tags));
+}
+
+MetricAggregator::Distribution MetricAggregator::distribution(
+    const bsl::shared_ptr<rmqp::MetricPublisher>& publisher,
+    const bsl::string& name,
+    const Tags& tags)
+{
+    if (!publisher) {
+        return Distribution();
+    }
+
+    MetricAggregator* aggregator =
+        dynamic_cast<MetricAggregator*>(publisher.get());
+    if (aggregator) {
+        return aggregator->registerDistribution(name, tags);
+    }
+    return Distribution(
+        bsl::make_shared<DistributionImpl>(publisher, name, tags));
+}
+
+MetricAggregator::MetricAggregator(
+    const bsl::shared_ptr<rmqp::MetricPublisher>& publisher)
+: d_publisher(publisher)
+, d_mutex()
+, d_counters()
+, d_distributions()
+{
+}
+
+MetricAggregator::~MetricAggregator() { flush(); }
+
+MetricAggregator::Counter
+MetricAggregator::registerCounter(const bsl::string& name, const Tags& tags)
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+
+    bsl::shared_ptr<CounterImpl>& impl = d_counters[Key(name, tags)];
+    if (!impl) {
+        impl = bsl::make_shared<CounterImpl>(
+            bsl::shared_ptr<rmqp::MetricPublisher>(), name, tags);
+    }
+    return Counter(impl);
+}
+
+MetricAggregator::Distribution
+MetricAggregator::registerDistribution(const bsl::string& name,
+                                       const Tags& tags)
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+
+    bsl::shared_ptr<DistributionImpl>& impl = d_distributions[Key(name, tags)];
+    if (!impl) {
+        impl = bsl::make_shared<DistributionImpl>(
+            bsl::shared_ptr<rmqp::MetricPublisher>(), name, tags);
+    }
+    return Distribution(impl);
+}
+
+void MetricAggregator::flush()
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+
+    // Metrics are forgotten once only the aggregator holds them: no handle
+    // can update them again, and a new registration starts afresh
+    for (bsl::map<Key, bsl::shared_ptr<CounterImpl> >::iterator it =
+             d_counters.begin();
+         it != d_counters.end();) {
+        it->second->flush(*d_publisher);
+        if (it->second.use_count() == 1) {
+            d_counters.erase(it++);
+        }
+        else {
+            ++it;
+        }
+    }
+
+    for (bsl::map<Key, bsl::shared_ptr<DistributionImpl> >::iterator it =
+             d_distributions.begin();
+         it != d_distributions.end();) {
+        it->second->flush(*d_publisher);
+        if (it->second.use_count() == 1) {
+            d_distributions.erase(it++);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+void MetricAggregator::run() { flush(); }
+
+void MetricAggregator::publishGauge(const bsl::string& name,
+                                    double value,
+                                    const Tags& tags)
+{
+    d_publisher->publishGauge(name, value, tags);
+}
+
+void MetricAggregator::publishCounter(const bsl::string& name,
+                                      double value,
+                                      const Tags& tags)
+{
+    d_publisher->publishCounter(name, value, tags);
+}
+
+void MetricAggregator::publishSummary(const bsl::string& name,
+                                      double value,
+                                      const Tags& tags)
+{
+    d_publisher->publishSummary(name, value, tags);
+}
+
+void MetricAggregator::publishDistribution(const bsl::string& name,
+                                           double value,
+                                           const Tags& tags)
+{
+    d_publisher->publishDistribution(name, value, tags);
+}
+
+void MetricAggregator::publishDistributionSamples(const bsl::string& name,
+                                                  double value,
+                                                  bsl::size_t count,
+                                                  const Tags& tags)
+{
+    d_publisher->publishDistributionSamples(name, value, count, tags);
+}
+
+} // namespace rmqamqp
+} // namespace BloombergLP
@@ -0,0 +1,203 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQAMQP_METRICAGGREGATOR
+#define INCLUDED_RMQAMQP_METRICAGGREGATOR
+
+#include <rmqio_task.h>
+#include <rmqp_metricpublisher.h>
+
+#include <bslmt_mutex.h>
+#include <bsls_keyword.h>
+#include <bsls_types.h>
+
+#include <bsl_map.h>
+#include <bsl_memory.h>
+#include <bsl_string.h>
+#include <bsl_utility.h>
+#include <bsl_vector.h>
+
+//@PURPOSE: Pre-aggregate hot path metrics before publishing them
+//
+//@CLASSES:
+//  rmqamqp::MetricAggregator: MetricPublisher front-end flushed on a timer
+//  rmqamqp::MetricAggregator::Counter: Handle for a registered counter
+//  rmqamqp::MetricAggregator::Distribution: Handle for a registered
+//  distribution
+
+namespace BloombergLP {
+namespace rmqamqp {
+
+/// \brief Accumulates counters and distributions published per message, and
+/// passes them to the user's `rmqp::MetricPublisher` when flushed
+///
+/// Hot paths register their metrics once, getting a `Counter` or
+/// `Distribution` handle which holds the interned name and tags. Updating a
+/// handle is a relaxed atomic add to one of a few cache-line padded stripes,
+/// picked by thread, so it neither allocates nor contends on the event
+/// loop. Distributions are kept as log-linear histograms of microseconds,
+/// within 1/16th of the value recorded, and flushed a bucket at a time
+/// through `publishDistributionSamples`.
+///
+/// The aggregator is itself a `MetricPublisher`: metrics published to it
+/// directly (gauges, summaries and rare events) go straight through. It is a
+/// `rmqio::Task` whose `run` flushes, so it can be scheduled on a
+/// `rmqio::WatchDog`.
+///
+/// Handles registered against any other `MetricPublisher` publish each
+/// update immediately, so components take handles whether or not
+/// aggregation is enabled.
+///
+/// Updating a handle is inline: a handle which drops its updates costs a
+/// null check. Built with `RMQ_NO_HOT_PATH_METRICS` (the CMake option
+/// `RMQ_HOT_PATH_METRICS=OFF`) updates are empty, and compiled out once
+/// inlined.
+///
+/// Thread safe.
+
+class MetricAggregator : public rmqp::MetricPublisher, public rmqio::Task {
+  public:
+    typedef bsl::vector<bsl::pair<bsl::string, bsl::string> > Tags;
+
+    class CounterImpl;
+    class DistributionImpl;
+
+    /// \brief A counter registered with `counter`. A default constructed
+    /// handle drops its updates.
+    class Counter {
+      public:
+        Counter();
+
+        void add(bsls::Types::Int64 value) const;
+
+      private:
+        friend class MetricAggregator;
+        explicit Counter(const bsl::shared_ptr<CounterImpl>& impl);
+
+        void addImpl(bsls::Types::Int64 value) const;
+
+        bsl::shared_ptr<CounterImpl> d_impl;
+    };
+
+    /// \brief A distribution registered with `distribution`. A default
+    /// constructed handle drops its updates.
+    class Distribution {
+      public:
+        Distribution();
+
+        /// Record `seconds`, as passed to `publishDistribution`
+        void record(double seconds) const;
+
+      private:
+        friend class MetricAggregator;
+        explicit Distribution(const bsl::shared_ptr<DistributionImpl>& impl);
+
+        void recordImpl(double seconds) const;
+
+        bsl::shared_ptr<DistributionImpl> d_impl;
+    };
+
+    /// Return a handle for the counter `name` with `tags`, aggregated if
+    /// `publisher` is a `MetricAggregator`, otherwise published through to
+    /// `publisher` on every update. Return a handle which drops its updates
+    /// if `publisher` is null.
+    static Counter counter(
+        const bsl::shared_ptr<rmqp::MetricPublisher>& publisher,
+        const bsl::string& name,
+        const Tags& tags);
+
+    /// Return a handle for the distribution `name` with `tags`, as for
+    /// `counter`
+    static Distribution distribution(
+        const bsl::shared_ptr<rmqp::MetricPublisher>& publisher,
+        const bsl::string& name,
+        const Tags& tags);
+
+    explicit MetricAggregator(
+        const bsl::shared_ptr<rmqp::MetricPublisher>& publisher);
+
+    ~MetricAggregator() BSLS_KEYWORD_OVERRIDE;
+
+    /// Publish what has accumulated since the last flush, and forget
+    /// metrics whose handles have all been destroyed
+    void flush();
+
+    /// Flush, when run by a WatchDog
+    void run() BSLS_KEYWORD_OVERRIDE;
+
+    void publishGauge(const bsl::string& name,
+                      double value,
+                      const Tags& tags) BSLS_KEYWORD_OVERRIDE;
+
+    void publishCounter(const bsl::string& name,
+                        double value,
+                        const Tags& tags) BSLS_KEYWORD_OVERRIDE;
+
+    void publishSummary(const bsl::string& name,
+                        double value,
+                        const Tags& tags) BSLS_KEYWORD_OVERRIDE;
+
+    void publishDistribution(const bsl::string& name,
+                             double value,
+                             const Tags& tags) BSLS_KEYWORD_OVERRIDE;
+
+    void publishDistributionSamples(const bsl::string& name,
+                                    double value,
+                                    bsl::size_t count,
+                                    const Tags& tags) BSLS_KEYWORD_OVERRIDE;
+
+  private:
+    MetricAggregator(const MetricAggregator&) BSLS_KEYWORD_DELETED;
+    MetricAggregator& operator=(const MetricAggregator&) BSLS_KEYWORD_DELETED;
+
+    typedef bsl::pair<bsl::string, Tags> Key;
+
+    Counter registerCounter(const bsl::string& name, const Tags& tags);
+
+    Distribution registerDistribution(const bsl::string& name,
+                                      const Tags& tags);
+
+    bsl::shared_ptr<rmqp::MetricPublisher> d_publisher;
+    bslmt::Mutex d_mutex;
+    bsl::map<Key, bsl::shared_ptr<CounterImpl> > d_counters;
+    bsl::map<Key, bsl::shared_ptr<DistributionImpl> > d_distributions;
+};
+
+inline void MetricAggregator::Counter::add(bsls::Types::Int64 value) const
+{
+#ifndef RMQ_NO_HOT_PATH_METRICS
+    if (d_impl) {
+        addImpl(value);
+    }
+#else
+    (void)value;
+#endif
+}
+
+inline void MetricAggregator::Distribution::record(double seconds) const
+{
+#ifndef RMQ_NO_HOT_PATH_METRICS
+    if (d_impl) {
+        recordImpl(seconds);
+    }
+#else
+    (void)seconds;
+#endif
+}
+
+} // namespace rmqamqp
+} // namespace BloombergLP
+
+#endif
@@ -18,7 +18,10 @@
 namespace BloombergLP {
 namespace rmqamqp {
 
-const char* Metrics::VHOST_TAG       = "rmqVhostName";
-const char* Metrics::CHANNELTYPE_TAG = "rmqChannelType";
+const char* Metrics::VHOST_TAG         = "rmqVhostName";
+const char* Metrics::CHANNELTYPE_TAG   = "rmqChannelType";
+const char* Metrics::PIPELINESTAGE_TAG = "rmqPipelineStage";
+const char* Metrics::QUEUE_TAG         = "rmqQueueName";
+const char* Metrics::EXCHANGE_TAG      = "rmqExchangeName";
 } // namespace rmqamqp
 } // namespace BloombergLP
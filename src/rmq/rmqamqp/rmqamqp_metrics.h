@@ -30,6 +30,9 @@ class Metrics {
     static const char* NAMESPACE;
     static const char* VHOST_TAG;
     static const char* CHANNELTYPE_TAG;
+    static const char* PIPELINESTAGE_TAG;
+    static const char* QUEUE_TAG;
+    static const char* EXCHANGE_TAG;
 };
 
 } // namespace rmqamqp
@@ -15,6 +15,9 @@
 
 #include <rmqamqp_multipleackhandler.h>
 
+#include <rmqt_log.h>
+#include <rmqt_probe.h>
+
 #include <ball_log.h>
 
 namespace BloombergLP {
@@ -23,10 +26,22 @@ namespace rmqamqp {
 namespace {
 BALL_LOG_SET_NAMESPACE_CATEGORY("RMQAMQP.MULTIPLEACKHANDLER")
 
+const bsl::size_t k_WORD_BITS = 64;
+const uint64_t k_ALL_BITS     = ~uint64_t(0);
+
 bool compare(const rmqt::ConsumerAck& a, const rmqt::ConsumerAck& b)
 {
     return a.envelope().deliveryTag() < b.envelope().deliveryTag();
 }
+
+bsl::size_t countBits(uint64_t word)
+{
+    bsl::size_t count = 0;
+    for (; word != 0; word &= word - 1) {
+        ++count;
+    }
+    return count;
+}
 } // namespace
 
 MultipleAckHandler::MultipleAckHandler(const AckCallback& ackCb,
@@ -35,6 +50,14 @@ MultipleAckHandler::MultipleAckHandler(const AckCallback& ackCb,
 , d_onNack(nackCb)
 , d_totalAcked(0)
 , d_maxProcessedTag(0)
+, d_settledThrough(0)
+, d_coalescing(false)
+, d_maxHeldAcks(0)
+, d_heldAcks(0)
+, d_sentUpTo(0)
+, d_bitmapBase(1)
+, d_resolved()
+, d_held()
 {
 }
 
@@ -45,6 +68,22 @@ void MultipleAckHandler::process(bsl::vector<rmqt::ConsumerAck>& acks)
     // Process the acks in increasing order of delivery tags
     bsl::sort(acks.begin(), acks.end(), compare);
 
+    // Tags settled by `nackThrough` or `ackThrough` must not be sent again
+    bsl::vector<rmqt::ConsumerAck>::iterator settled = acks.begin();
+    while (settled != acks.end() &&
+           settled->envelope().deliveryTag() <= d_settledThrough) {
+        BALL_LOG_WARN << "Ignoring ack/nack for delivery tag "
+                      << settled->envelope().deliveryTag()
+                      << ", already settled with every earlier message";
+        ++settled;
+    }
+    acks.erase(acks.begin(), settled);
+
+    if (d_coalescing) {
+        processCoalesced(acks);
+        return;
+    }
+
     // Maintain information about pending batches -- length, last (highest) tag
     // and type
     size_t batchLength                = 0;
@@ -88,17 +127,256 @@ void MultipleAckHandler::process(bsl::vector<rmqt::ConsumerAck>& acks)
 
         d_maxProcessedTag = bsl::max(d_maxProcessedTag, tag);
         d_totalAcked++;
+
+        // Tracked for `ackThrough`; nothing is held, so nothing is resent
+        markResolved(tag, false);
     }
 
     if (batchLength > 0) {
         sendAck(batchMaxTag, batchType, batchLength);
     }
+    flushContiguous();
 }
 
 void MultipleAckHandler::reset()
 {
     d_totalAcked      = 0;
     d_maxProcessedTag = 0;
+    d_settledThrough  = 0;
+    d_heldAcks        = 0;
+    d_sentUpTo        = 0;
+    d_bitmapBase      = 1;
+    d_resolved.clear();
+    d_held.clear();
+}
+
+void MultipleAckHandler::setCoalescing(bsl::size_t maxHeldAcks)
+{
+    d_coalescing  = true;
+    d_maxHeldAcks = maxHeldAcks;
+}
+
+void MultipleAckHandler::processCoalesced(
+    const bsl::vector<rmqt::ConsumerAck>& acks)
+{
+    // A pending run of nacks of one type, sent as a single multi-nack
+    uint64_t runMaxTag              = 0;
+    size_t runLength                = 0;
+    rmqt::ConsumerAck::Type runType = rmqt::ConsumerAck::REJECT;
+
+    for (size_t i = 0; i < acks.size(); i++) {
+        const uint64_t tag                 = acks[i].envelope().deliveryTag();
+        const rmqt::ConsumerAck::Type type = acks[i].type();
+
+        if (tag <= d_sentUpTo || isBitSet(d_resolved, tag)) {
+            BALL_LOG_WARN << "Ignoring repeated ack/nack for delivery tag "
+                          << tag;
+            continue;
+        }
+
+        if (runLength > 0 && (type != runType || tag != runMaxTag + 1)) {
+            sendAck(runMaxTag, runType, runLength);
+            runLength = 0;
+        }
+
+        if (type == rmqt::ConsumerAck::ACK) {
+            markResolved(tag, true);
+            continue;
+        }
+
+        // Nacks aren't worth delaying, and sending them now means a later
+        // multi-ack can cover their tags
+        if (runLength == 0) {
+            // A multi-nack covers every unsettled tag below it, so a run
+            // can only start once every earlier tag is sent. With no acks
+            // held this sends nothing, only catching up `d_sentUpTo`.
+            if (d_heldAcks == 0) {
+                flushContiguous();
+            }
+            if (d_heldAcks == 0 && tag == d_sentUpTo + 1) {
+                runType = type;
+            }
+            else {
+                sendAck(tag, type, 1);
+                markResolved(tag, false);
+                continue;
+            }
+        }
+        ++runLength;
+        runMaxTag = tag;
+        markResolved(tag, false);
+    }
+
+    if (runLength > 0) {
+        sendAck(runMaxTag, runType, runLength);
+    }
+
+    if (d_maxHeldAcks > 0 && d_heldAcks >= d_maxHeldAcks) {
+        flushContiguous();
+
+        // Acks held beyond a gap must not stall the prefetch window either
+        if (d_heldAcks >= d_maxHeldAcks) {
+            flush();
+        }
+    }
+}
+
+void MultipleAckHandler::flush()
+{
+    flushContiguous();
+
+    if (d_heldAcks == 0) {
+        return;
+    }
+
+    // Beyond the gap only individual acks are safe
+    for (bsl::size_t word = 0; word < d_held.size(); ++word) {
+        for (uint64_t bits = d_held[word]; bits != 0; bits &= bits - 1) {
+            bsl::size_t bit = 0;
+            while (!(bits & (uint64_t(1) << bit))) {
+                ++bit;
+            }
+            sendAck(d_bitmapBase + word * k_WORD_BITS + bit,
+                    rmqt::ConsumerAck::ACK,
+                    1);
+        }
+        d_held[word] = 0;
+    }
+    d_heldAcks = 0;
+}
+
+void MultipleAckHandler::nackThrough(uint64_t deliveryTag, bool requeue)
+{
+    // Sent first, so that the multi-nack leaves them acked
+    flush();
+
+    RMQT_LOG_TRACE << "Nacking every outstanding tag up to: " << deliveryTag
+                   << ", requeue = " << requeue;
+    d_onNack(deliveryTag, requeue, true);
+
+    d_settledThrough  = deliveryTag;
+    d_totalAcked      = deliveryTag;
+    d_maxProcessedTag = deliveryTag;
+    d_sentUpTo        = deliveryTag;
+    d_bitmapBase      = deliveryTag + 1;
+    d_resolved.clear();
+    d_held.clear();
+}
+
+void MultipleAckHandler::ackThrough(uint64_t deliveryTag)
+{
+    // Sent first, so that every resolved tag is settled at the broker and
+    // only the unresolved ones are left to the multi-ack
+    flush();
+
+    if (deliveryTag <= d_settledThrough) {
+        return;
+    }
+    d_settledThrough = deliveryTag;
+
+    // A multi-ack must end on a tag the broker still has outstanding
+    uint64_t last = deliveryTag;
+    while (last > d_sentUpTo && isBitSet(d_resolved, last)) {
+        --last;
+    }
+    if (last <= d_sentUpTo) {
+        return;
+    }
+
+    sendAck(last, rmqt::ConsumerAck::ACK, last - d_sentUpTo);
+
+    for (uint64_t tag = d_sentUpTo + 1; tag <= last; ++tag) {
+        if (!isBitSet(d_resolved, tag)) {
+            markResolved(tag, false);
+            ++d_totalAcked;
+        }
+    }
+    d_maxProcessedTag = bsl::max(d_maxProcessedTag, last);
+
+    // Nothing is held after `flush`, so this only advances `d_sentUpTo`
+    flushContiguous();
+}
+
+bool MultipleAckHandler::isResolved(uint64_t deliveryTag) const
+{
+    return deliveryTag <= d_settledThrough || deliveryTag <= d_sentUpTo ||
+           isBitSet(d_resolved, deliveryTag);
+}
+
+void MultipleAckHandler::flushContiguous()
+{
+    // Find the end of the run of resolved tags after d_sentUpTo, counting
+    // the held acks it contains
+    const bsl::size_t bits = d_resolved.size() * k_WORD_BITS;
+    bsl::size_t bit        = bitIndex(d_sentUpTo + 1);
+    bsl::size_t held       = 0;
+
+    while (bit < bits) {
+        const bsl::size_t word   = bit / k_WORD_BITS;
+        const bsl::size_t offset = bit % k_WORD_BITS;
+
+        if (offset == 0 && d_resolved[word] == k_ALL_BITS) {
+            held += countBits(d_held[word]);
+            d_held[word] = 0;
+            bit += k_WORD_BITS;
+            continue;
+        }
+
+        const uint64_t mask = uint64_t(1) << offset;
+        if (!(d_resolved[word] & mask)) {
+            break;
+        }
+        if (d_held[word] & mask) {
+            ++held;
+            d_held[word] &= ~mask;
+        }
+        ++bit;
+    }
+    const uint64_t end = d_bitmapBase + bit - 1;
+
+    if (end == d_sentUpTo) {
+        return;
+    }
+
+    if (held > 0) {
+        sendAck(end, rmqt::ConsumerAck::ACK, end - d_sentUpTo);
+        d_heldAcks -= held;
+    }
+    d_sentUpTo = end;
+
+    // Drop the words which are entirely sent
+    while (!d_resolved.empty() &&
+           d_bitmapBase + k_WORD_BITS <= d_sentUpTo + 1) {
+        d_resolved.pop_front();
+        d_held.pop_front();
+        d_bitmapBase += k_WORD_BITS;
+    }
+}
+
+void MultipleAckHandler::markResolved(uint64_t tag, bool held)
+{
+    const bsl::size_t bit  = bitIndex(tag);
+    const bsl::size_t word = bit / k_WORD_BITS;
+    if (word >= d_resolved.size()) {
+        d_resolved.resize(word + 1, 0);
+        d_held.resize(word + 1, 0);
+    }
+
+    const uint64_t mask = uint64_t(1) << (bit % k_WORD_BITS);
+    d_resolved[word] |= mask;
+    if (held) {
+        d_held[word] |= mask;
+        ++d_heldAcks;
+    }
+}
+
+bool MultipleAckHandler::isBitSet(const bsl::deque<uint64_t>& bitmap,
+                                  uint64_t tag) const
+{
+    const bsl::size_t bit  = bitIndex(tag);
+    const bsl::size_t word = bit / k_WORD_BITS;
+    return word < bitmap.size() &&
+           (bitmap[word] & (uint64_t(1) << (bit % k_WORD_BITS)));
 }
 
 void MultipleAckHandler::sendAck(uint64_t deliveryTag,
@@ -107,10 +385,11 @@ void MultipleAckHandler::sendAck(uint64_t deliveryTag,
 {
     const bool multiple = (batchSize > 1);
 
-    BALL_LOG_TRACE << (type == rmqt::ConsumerAck::ACK ? "Acking: "
+    RMQT_LOG_TRACE << (type == rmqt::ConsumerAck::ACK ? "Acking: "
                                                       : "Nacking: ")
                    << deliveryTag << ", type = " << type
                    << ", batch size = " << batchSize;
+    RMQT_PROBE3(ack_sent, deliveryTag, multiple, static_cast<int>(type));
 
     if (type == rmqt::ConsumerAck::ACK) {
         d_onAck(deliveryTag, multiple);
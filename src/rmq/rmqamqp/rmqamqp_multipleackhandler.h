@@ -19,6 +19,8 @@
 #include <rmqt_consumerack.h>
 
 #include <bsl_algorithm.h>
+#include <bsl_cstddef.h>
+#include <bsl_deque.h>
 #include <bsl_functional.h>
 #include <bsl_vector.h>
 
@@ -31,6 +33,14 @@ namespace rmqamqp {
 //@CLASSES:
 //  rmqamqp::MultipleAckHandler: Batches acks into multi-acks
 
+/// By default each call to `process` sends its acks straight away,
+/// collapsing contiguous runs into multi-acks. With coalescing enabled (see
+/// `setCoalescing`) acks are held instead: nacks are still sent straight
+/// away, a run of them with the same `requeue` flag as one multi-nack once
+/// every earlier tag is sent, and resolved tags are tracked in a bitmap so
+/// that a later `flush` sends a single multi-ack covering the highest
+/// contiguous resolved tag.
+
 class MultipleAckHandler {
   public:
     typedef bsl::function<void(uint64_t, bool)> AckCallback;
@@ -43,10 +53,52 @@ class MultipleAckHandler {
     /// NB: this method takes a vector by reference and modifies (sorts) it.
     void process(bsl::vector<rmqt::ConsumerAck>& acks);
 
-    /// Reset upon channel reopen.
+    /// Reset upon channel reopen. Held acks are discarded.
     void reset();
 
+    /// Hold acks until `flush` is called, or until `maxHeldAcks` are held
+    /// (0 for no limit). The caller is responsible for calling `flush`
+    /// often enough to keep the broker's prefetch window moving.
+    void setCoalescing(bsl::size_t maxHeldAcks);
+
+    /// Send every held ack: one ack, multiple when it covers more than one
+    /// tag, up to the highest contiguous resolved tag, then any acks beyond
+    /// a gap individually.
+    void flush();
+
+    /// Send any held acks, then nack every tag up to `deliveryTag` not
+    /// acked yet with a single multi-nack, requeueing them if `requeue`.
+    /// Later acks for those tags are ignored. The behavior is undefined
+    /// unless no tag above `deliveryTag` has been delivered.
+    void nackThrough(uint64_t deliveryTag, bool requeue);
+
+    /// Send any held acks, then ack every tag up to `deliveryTag` not
+    /// resolved yet with a single multi-ack, ending on the highest of them.
+    /// Later acks and nacks for those tags are ignored. Tags above
+    /// `deliveryTag` are unaffected.
+    void ackThrough(uint64_t deliveryTag);
+
+    /// Return true if `deliveryTag` was acked or nacked, whether or not
+    /// that was sent to the broker yet
+    bool isResolved(uint64_t deliveryTag) const;
+
+    /// Number of acks held, waiting for `flush`
+    bsl::size_t heldAcks() const { return d_heldAcks; }
+
   private:
+    void processCoalesced(const bsl::vector<rmqt::ConsumerAck>& acks);
+
+    /// Send the held acks up to the highest contiguous resolved tag
+    void flushContiguous();
+
+    /// Resolved tags are held from `d_bitmapBase`, one bit per tag
+    bsl::size_t bitIndex(uint64_t tag) const
+    {
+        return static_cast<bsl::size_t>(tag - d_bitmapBase);
+    }
+    void markResolved(uint64_t tag, bool held);
+    bool isBitSet(const bsl::deque<uint64_t>& bitmap, uint64_t tag) const;
+
     void sendAck(uint64_t deliveryTag,
                  rmqt::ConsumerAck::Type type,
                  size_t batchSize);
@@ -62,6 +114,27 @@ class MultipleAckHandler {
 
     /// Highest delivery tag acknowledged
     uint64_t d_maxProcessedTag;
+
+    /// Every tag up to and including this one was settled by `nackThrough`
+    /// or `ackThrough`
+    uint64_t d_settledThrough;
+
+    /// Coalescing state, see `setCoalescing`
+    bool d_coalescing;
+    bsl::size_t d_maxHeldAcks;
+    bsl::size_t d_heldAcks;
+
+    /// Every tag up to and including this one has been sent to the broker
+    uint64_t d_sentUpTo;
+
+    /// Delivery tag of bit 0 of the first word of the bitmaps below
+    uint64_t d_bitmapBase;
+
+    /// Tags acked or nacked by the application
+    bsl::deque<uint64_t> d_resolved;
+
+    /// Resolved tags whose ack is held rather than sent
+    bsl::deque<uint64_t> d_held;
 };
 
 } // namespace rmqamqp
@@ -0,0 +1,76 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqamqp_pipelinetiming.h>
+
+#include <rmqamqp_metrics.h>
+
+#include <bsl_string.h>
+#include <bsl_utility.h>
+
+namespace BloombergLP {
+namespace rmqamqp {
+
+const char* PipelineStage::toString(Value stage)
+{
+    switch (stage) {
+        case DECODE:
+            return "decode";
+        case ASSEMBLE:
+            return "assemble";
+        case PROCESS:
+            return "process";
+        case DISPATCH:
+            return "dispatch";
+        case CALLBACK:
+            return "callback";
+        case ACK_QUEUE:
+            return "ack_queue";
+        case SEND_QUEUE:
+            return "send_queue";
+        case FRAME:
+            return "frame";
+        case WRITE:
+            return "write";
+        case NUM_STAGES:
+            break;
+    }
+    return "unknown";
+}
+
+PipelineTiming::PipelineTiming() {}
+
+PipelineTiming::PipelineTiming(
+    const bsl::shared_ptr<rmqp::MetricPublisher>& publisher,
+    const Tags& tags)
+{
+    if (!rmqio::PipelineClock::isEnabled()) {
+        return;
+    }
+
+    Tags stageTags(tags);
+    stageTags.push_back(bsl::pair<bsl::string, bsl::string>(
+        Metrics::PIPELINESTAGE_TAG, ""));
+
+    for (int stage = 0; stage < PipelineStage::NUM_STAGES; ++stage) {
+        stageTags.back().second =
+            PipelineStage::toString(static_cast<PipelineStage::Value>(stage));
+        d_stages[stage] = MetricAggregator::distribution(
+            publisher, "pipeline_stage", stageTags);
+    }
+}
+
+} // namespace rmqamqp
+} // namespace BloombergLP
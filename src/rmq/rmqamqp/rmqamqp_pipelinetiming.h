@@ -0,0 +1,126 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQAMQP_PIPELINETIMING
+#define INCLUDED_RMQAMQP_PIPELINETIMING
+
+#include <rmqamqp_metricaggregator.h>
+
+#include <rmqio_pipelineclock.h>
+#include <rmqp_metricpublisher.h>
+
+#include <bsls_types.h>
+
+#include <bsl_memory.h>
+
+//@PURPOSE: Publish how long messages spend in each hot path stage
+//
+//@CLASSES:
+//  rmqamqp::PipelineStage: Stages of the consumer and producer pipelines
+//  rmqamqp::PipelineTiming: Per-stage distributions for one vhost
+
+namespace BloombergLP {
+namespace rmqamqp {
+
+/// \brief Stages a message passes through between the socket and the
+/// application
+struct PipelineStage {
+    enum Value {
+        /// Consumer: socket read completed, until its frames are decoded
+        DECODE = 0,
+        /// Consumer: frames decoded, until the delivery is assembled
+        ASSEMBLE,
+        /// Consumer: delivery handed to its channel, until it has been
+        /// passed on to the consumer (and its callback, if inline)
+        PROCESS,
+        /// Consumer: delivery queued for a consumer thread, until its
+        /// callback starts
+        DISPATCH,
+        /// Consumer: callback running
+        CALLBACK,
+        /// Consumer: first ack of a batch queued, until the event loop
+        /// picks up the batch
+        ACK_QUEUE,
+        /// Producer: `send` returned, until the event loop picks up the
+        /// message
+        SEND_QUEUE,
+        /// Producer and consumer: message or method framed for the socket
+        FRAME,
+        /// Producer and consumer: frames queued for the socket, until the
+        /// write completes
+        WRITE,
+        NUM_STAGES
+    };
+
+    static const char* toString(Value stage);
+};
+
+/// \brief Records the time spent in each `PipelineStage` to the
+/// `pipeline_stage` distribution, tagged with the stage
+///
+/// Timings are taken with `rmqio::PipelineClock`. Nothing is registered or
+/// recorded unless it was enabled when the `PipelineTiming` was created,
+/// and stages whose start timestamp is zero (because the clock was disabled
+/// when it was taken) are skipped.
+///
+/// Thread safe.
+
+class PipelineTiming {
+  public:
+    typedef MetricAggregator::Tags Tags;
+
+    /// Record nothing
+    PipelineTiming();
+
+    /// Register a distribution per stage with `publisher`, tagged with
+    /// `tags`, if `rmqio::PipelineClock` is enabled
+    PipelineTiming(const bsl::shared_ptr<rmqp::MetricPublisher>& publisher,
+                   const Tags& tags);
+
+    /// Record that `stage` ran from `start` until `end`, both
+    /// `rmqio::PipelineClock::now()` timestamps
+    void record(PipelineStage::Value stage,
+                bsls::Types::Int64 start,
+                bsls::Types::Int64 end) const;
+
+    /// Record that `stage` ran from `start` until now
+    void record(PipelineStage::Value stage, bsls::Types::Int64 start) const;
+
+  private:
+    MetricAggregator::Distribution d_stages[PipelineStage::NUM_STAGES];
+};
+
+inline void PipelineTiming::record(PipelineStage::Value stage,
+                                   bsls::Types::Int64 start,
+                                   bsls::Types::Int64 end) const
+{
+    if (start && end >= start) {
+        d_stages[stage].record(static_cast<double>(end - start) /
+                               (1000 * 1000 * 1000));
+    }
+}
+
+inline void PipelineTiming::record(PipelineStage::Value stage,
+                                   bsls::Types::Int64 start) const
+{
+    if (start) {
+        record(stage, start, rmqio::PipelineClock::now());
+    }
+}
+
+} // namespace rmqamqp
+} // namespace BloombergLP
+
+#endif
@@ -0,0 +1,99 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqamqp_prefetchcontroller.h>
+
+#include <bsl_algorithm.h>
+
+namespace BloombergLP {
+namespace rmqamqp {
+
+namespace {
+// Grow while messages wait less than a callback's worth, or this long
+const double k_GROW_MAX_WAIT_SECONDS = 0.001;
+
+// Shrink once messages wait this many callbacks' worth before being handled
+const double k_SHRINK_WAIT_RATIO = 4;
+
+// ...and for at least this long, so cheap callbacks don't shrink on jitter
+const double k_SHRINK_MIN_WAIT_SECONDS = 0.01;
+
+// Windows with fewer acks than this say too little to act on
+const bsl::size_t k_MIN_ACKS_PER_WINDOW = 10;
+} // namespace
+
+PrefetchController::PrefetchController(uint16_t initialPrefetch,
+                                       uint16_t minPrefetch,
+                                       uint16_t maxPrefetch)
+: d_prefetch()
+, d_minPrefetch(bsl::max<uint16_t>(minPrefetch, 1))
+, d_maxPrefetch(bsl::max(maxPrefetch, d_minPrefetch))
+, d_latencySeconds(0)
+, d_acks(0)
+{
+    d_prefetch = bsl::min(bsl::max(initialPrefetch, d_minPrefetch),
+                          d_maxPrefetch);
+}
+
+void PrefetchController::onAck(double latencySeconds)
+{
+    d_latencySeconds += latencySeconds;
+    ++d_acks;
+}
+
+bsl::optional<uint16_t> PrefetchController::evaluate(double callbackSeconds,
+                                                     bool saturated)
+{
+    const bsl::size_t acks = d_acks;
+    const double latency   = acks ? d_latencySeconds / acks : 0;
+    d_latencySeconds       = 0;
+    d_acks                 = 0;
+
+    // A saturated process acks slowly, so this does not wait for acks
+    if (saturated) {
+        if (d_prefetch == d_minPrefetch) {
+            return bsl::optional<uint16_t>();
+        }
+        d_prefetch = d_minPrefetch;
+        return d_prefetch;
+    }
+
+    if (acks < k_MIN_ACKS_PER_WINDOW) {
+        return bsl::optional<uint16_t>();
+    }
+
+    const double wait = bsl::max(latency - callbackSeconds, 0.0);
+
+    uint32_t next = d_prefetch;
+    if (wait < bsl::max(callbackSeconds, k_GROW_MAX_WAIT_SECONDS)) {
+        next = bsl::max<uint32_t>(d_prefetch + d_prefetch / 2, d_prefetch + 1);
+    }
+    else if (wait > k_SHRINK_WAIT_RATIO * callbackSeconds &&
+             wait > k_SHRINK_MIN_WAIT_SECONDS) {
+        next = bsl::min<uint32_t>(d_prefetch - d_prefetch / 4, d_prefetch - 1);
+    }
+
+    next = bsl::min<uint32_t>(bsl::max<uint32_t>(next, d_minPrefetch),
+                              d_maxPrefetch);
+    if (next == d_prefetch) {
+        return bsl::optional<uint16_t>();
+    }
+
+    d_prefetch = static_cast<uint16_t>(next);
+    return d_prefetch;
+}
+
+} // namespace rmqamqp
+} // namespace BloombergLP
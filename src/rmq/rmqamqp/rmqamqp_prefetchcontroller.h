@@ -0,0 +1,79 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQAMQP_PREFETCHCONTROLLER
+#define INCLUDED_RMQAMQP_PREFETCHCONTROLLER
+
+#include <bsl_cstddef.h>
+#include <bsl_cstdint.h>
+#include <bsl_optional.h>
+
+namespace BloombergLP {
+namespace rmqamqp {
+
+//@PURPOSE: Adapt a consumer's prefetch count to how fast it works
+//
+//@CLASSES:
+//  rmqamqp::PrefetchController: Decides when to grow or shrink prefetch
+
+/// \brief Picks a prefetch count between a minimum and maximum
+///
+/// Over each evaluation window the controller compares the average time
+/// from delivery to ack with the average time a consumer callback takes.
+/// The difference is how long messages sit in the client before a callback
+/// picks them up:
+///  - Less than a callback's worth (or a millisecond, for cheap callbacks)
+///    means consumers take messages as soon as they arrive and may be
+///    starved, so prefetch grows.
+///  - Several callbacks' worth means messages are buffered for no benefit,
+///    so prefetch shrinks.
+/// In between, the prefetch count is left alone.
+///
+/// While the process reports itself saturated the prefetch count drops to
+/// the minimum, whatever the window says, so the broker hands the queue's
+/// messages to less loaded consumers. It grows back as above once the
+/// saturation clears.
+
+class PrefetchController {
+  public:
+    PrefetchController(uint16_t initialPrefetch,
+                       uint16_t minPrefetch,
+                       uint16_t maxPrefetch);
+
+    /// Account for a message acked (or nacked) `latencySeconds` after
+    /// delivery
+    void onAck(double latencySeconds);
+
+    /// Finish the current window, given the average callback time over it
+    /// and whether the process is `saturated`. Return the new prefetch
+    /// count if it should change.
+    bsl::optional<uint16_t> evaluate(double callbackSeconds,
+                                     bool saturated = false);
+
+    uint16_t prefetch() const { return d_prefetch; }
+
+  private:
+    uint16_t d_prefetch;
+    uint16_t d_minPrefetch;
+    uint16_t d_maxPrefetch;
+
+    double d_latencySeconds;
+    bsl::size_t d_acks;
+};
+
+} // namespace rmqamqp
+} // namespace BloombergLP
+
+#endif
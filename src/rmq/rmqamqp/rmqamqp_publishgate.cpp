@@ -0,0 +1,105 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqamqp_publishgate.h>
+
+#include <bslmt_lockguard.h>
+#include <bsls_systemtime.h>
+
+namespace BloombergLP {
+namespace rmqamqp {
+
+PublishGate::PublishGate()
+: d_mutex()
+, d_opened()
+, d_closed(false)
+, d_reason()
+, d_openCallbacks()
+{
+}
+
+void PublishGate::close(const bsl::string& reason)
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    d_reason = reason;
+    d_closed = true;
+}
+
+void PublishGate::open()
+{
+    bsl::vector<OpenCallback> callbacks;
+    {
+        bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+        if (!d_closed) {
+            return;
+        }
+
+        d_closed = false;
+        d_opened.broadcast();
+        callbacks.swap(d_openCallbacks);
+    }
+
+    // Invoked without the mutex held, so that callbacks can use the gate
+    for (bsl::vector<OpenCallback>::iterator it = callbacks.begin();
+         it != callbacks.end();
+         ++it) {
+        (*it)();
+    }
+}
+
+bool PublishGate::waitUntilOpen(const bsls::TimeInterval& timeout)
+{
+    if (!d_closed) {
+        return true;
+    }
+
+    const bool hasTimeout = timeout.totalNanoseconds() != 0;
+    const bsls::TimeInterval deadline =
+        bsls::SystemTime::nowRealtimeClock() + timeout;
+
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    while (d_closed) {
+        if (hasTimeout) {
+            if (d_opened.timedWait(&d_mutex, deadline)) {
+                return !d_closed;
+            }
+        }
+        else {
+            d_opened.wait(&d_mutex);
+        }
+    }
+    return true;
+}
+
+void PublishGate::notifyWhenOpen(const OpenCallback& callback)
+{
+    {
+        bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+        if (d_closed) {
+            d_openCallbacks.push_back(callback);
+            return;
+        }
+    }
+    callback();
+}
+
+bsl::string PublishGate::reason() const
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    return d_reason;
+}
+
+} // namespace rmqamqp
+} // namespace BloombergLP
@@ -0,0 +1,90 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQAMQP_PUBLISHGATE
+#define INCLUDED_RMQAMQP_PUBLISHGATE
+
+#include <bslmt_condition.h>
+#include <bslmt_mutex.h>
+#include <bsls_atomic.h>
+#include <bsls_keyword.h>
+#include <bsls_timeinterval.h>
+
+#include <bsl_functional.h>
+#include <bsl_string.h>
+#include <bsl_vector.h>
+
+namespace BloombergLP {
+namespace rmqamqp {
+
+//@PURPOSE: Hold back publishes while the broker blocks a connection
+//
+//@CLASSES:
+//  rmqamqp::PublishGate: Shared by a connection and its producers
+
+/// \brief Closed while the broker has blocked a connection with
+/// Connection.Blocked, e.g. during a memory or disk alarm
+///
+/// A blocked connection is no longer read by the broker, so anything
+/// published on it only piles up in the library's buffers. The connection
+/// closes the gate when it is blocked and opens it when it is unblocked or
+/// reconnects. Producers check the gate before publishing: sends wait for it
+/// to open (up to their timeout), and `trySend` fails straight away.
+///
+/// Thread safe.
+
+class PublishGate {
+  public:
+    /// Invoked once the gate opens, see `notifyWhenOpen`
+    typedef bsl::function<void()> OpenCallback;
+
+    PublishGate();
+
+    /// Close the gate, recording the `reason` the broker gave
+    void close(const bsl::string& reason);
+
+    /// Open the gate, waking waiters and invoking callbacks if it was closed
+    void open();
+
+    /// Block until the gate is open, or `timeout` passes (if non-zero).
+    /// Return false on timeout.
+    bool waitUntilOpen(const bsls::TimeInterval& timeout);
+
+    /// Invoke `callback` once the gate is open: immediately, on this thread,
+    /// if it already is, otherwise on the thread calling `open`
+    void notifyWhenOpen(const OpenCallback& callback);
+
+    /// Return true while the gate is closed. Does not lock, so it is cheap
+    /// enough to check on every send.
+    bool isClosed() const { return d_closed; }
+
+    /// Return the reason the gate was last closed for
+    bsl::string reason() const;
+
+  private:
+    PublishGate(const PublishGate&) BSLS_KEYWORD_DELETED;
+    PublishGate& operator=(const PublishGate&) BSLS_KEYWORD_DELETED;
+
+    mutable bslmt::Mutex d_mutex;
+    bslmt::Condition d_opened;
+    bsls::AtomicBool d_closed;
+    bsl::string d_reason;
+    bsl::vector<OpenCallback> d_openCallbacks;
+};
+
+} // namespace rmqamqp
+} // namespace BloombergLP
+
+#endif
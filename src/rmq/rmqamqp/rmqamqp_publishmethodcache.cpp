@@ -0,0 +1,82 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqamqp_publishmethodcache.h>
+
+#include <rmqamqpt_basicmethod.h>
+#include <rmqamqpt_basicpublish.h>
+#include <rmqamqpt_method.h>
+
+#include <bsls_assert.h>
+
+namespace BloombergLP {
+namespace rmqamqp {
+
+PublishMethodCache::Entry::Entry(const bsl::string& routingKey,
+                                 rmqt::Mandatory::Value mandatory,
+                                 const rmqamqpt::EncodedMethod& method)
+: routingKey(routingKey)
+, mandatory(mandatory)
+, method(method)
+{
+}
+
+PublishMethodCache::PublishMethodCache(const bsl::string& exchange,
+                                       bsl::size_t capacity)
+: d_exchange(exchange)
+, d_capacity(capacity)
+, d_entries()
+, d_index()
+{
+    BSLS_ASSERT(capacity > 0);
+}
+
+const rmqamqpt::EncodedMethod&
+PublishMethodCache::get(const bsl::string& routingKey,
+                        rmqt::Mandatory::Value mandatory)
+{
+    BSLS_ASSERT(mandatory == rmqt::Mandatory::DISCARD_UNROUTABLE ||
+                mandatory == rmqt::Mandatory::RETURN_UNROUTABLE);
+
+    Index& index           = d_index[mandatory];
+    Index::iterator cached = index.find(routingKey);
+    if (cached != index.end()) {
+        d_entries.splice(d_entries.begin(), d_entries, cached->second);
+        return cached->second->method;
+    }
+
+    if (d_entries.size() == d_capacity) {
+        const Entry& evicted = d_entries.back();
+        d_index[evicted.mandatory].erase(evicted.routingKey);
+        d_entries.pop_back();
+    }
+
+    const bool mandatoryFlag = mandatory == rmqt::Mandatory::RETURN_UNROUTABLE;
+
+    // Not implemented (connection is closed if set) in rabbitmq 3.0+
+    const bool immediateFlag = false;
+
+    const rmqamqpt::EncodedMethod method(
+        rmqamqpt::Method(rmqamqpt::BasicMethod(rmqamqpt::BasicPublish(
+            d_exchange, routingKey, mandatoryFlag, immediateFlag))));
+
+    d_entries.push_front(Entry(routingKey, mandatory, method));
+    index[routingKey] = d_entries.begin();
+
+    return d_entries.front().method;
+}
+
+} // namespace rmqamqp
+} // namespace BloombergLP
@@ -0,0 +1,85 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQAMQP_PUBLISHMETHODCACHE
+#define INCLUDED_RMQAMQP_PUBLISHMETHODCACHE
+
+#include <rmqamqpt_encodedmethod.h>
+#include <rmqt_properties.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_list.h>
+#include <bsl_string.h>
+#include <bsl_unordered_map.h>
+
+namespace BloombergLP {
+namespace rmqamqp {
+
+//@PURPOSE: Re-use the encoding of a channel's basic.publish methods
+//
+//@CLASSES:
+//  rmqamqp::PublishMethodCache: LRU cache of encoded basic.publish methods
+
+/// \brief Caches the encoded basic.publish methods for one exchange
+///
+/// A publisher's basic.publish methods differ only by routing key and
+/// mandatory flag, so they are encoded once per combination. The least
+/// recently used method is evicted once `capacity` are cached.
+
+class PublishMethodCache {
+  public:
+    static const bsl::size_t k_DEFAULT_CAPACITY = 256;
+
+    explicit PublishMethodCache(const bsl::string& exchange,
+                                bsl::size_t capacity = k_DEFAULT_CAPACITY);
+
+    /// Return the encoded basic.publish of a message to `routingKey` on
+    /// the exchange, encoding it if it is not cached. The reference is
+    /// valid until the next call.
+    const rmqamqpt::EncodedMethod& get(const bsl::string& routingKey,
+                                       rmqt::Mandatory::Value mandatory);
+
+    bsl::size_t size() const { return d_entries.size(); }
+
+    bsl::size_t capacity() const { return d_capacity; }
+
+  private:
+    struct Entry {
+        Entry(const bsl::string& routingKey,
+              rmqt::Mandatory::Value mandatory,
+              const rmqamqpt::EncodedMethod& method);
+
+        bsl::string routingKey;
+        rmqt::Mandatory::Value mandatory;
+        rmqamqpt::EncodedMethod method;
+    };
+
+    typedef bsl::list<Entry> EntryList;
+    typedef bsl::unordered_map<bsl::string, EntryList::iterator> Index;
+
+    bsl::string d_exchange;
+    bsl::size_t d_capacity;
+
+    /// Most recently used first
+    EntryList d_entries;
+
+    /// Routing key to entry, for each value of the mandatory flag
+    Index d_index[2];
+};
+
+} // namespace rmqamqp
+} // namespace BloombergLP
+
+#endif
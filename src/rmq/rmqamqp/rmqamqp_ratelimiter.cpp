@@ -0,0 +1,206 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqamqp_ratelimiter.h>
+
+#include <bslmt_threadutil.h>
+#include <bsls_systemtime.h>
+
+#include <bsl_algorithm.h>
+#include <bsl_limits.h>
+
+namespace BloombergLP {
+namespace rmqamqp {
+namespace {
+
+const double k_NANOS_PER_SECOND = 1e9;
+
+bsls::Types::Int64 nowNanos()
+{
+    return bsls::SystemTime::nowMonotonicClock().totalNanoseconds();
+}
+
+bsls::TimeInterval fromNanos(bsls::Types::Int64 nanos)
+{
+    bsls::TimeInterval interval;
+    interval.addNanoseconds(nanos);
+    return interval;
+}
+
+} // namespace
+
+RateLimiter::Bucket::Bucket(double perSecond, bsl::size_t burst)
+: d_unlimited(perSecond <= 0)
+, d_nanosPerToken(d_unlimited ? 0 : k_NANOS_PER_SECOND / perSecond)
+, d_burstNanos(static_cast<bsls::Types::Int64>(
+      d_nanosPerToken * static_cast<double>(bsl::max<bsl::size_t>(burst, 1))))
+, d_fullAt(0)
+{
+}
+
+bsls::Types::Int64 RateLimiter::Bucket::cost(bsl::size_t count) const
+{
+    // More than a full bucket waits for a full bucket, not forever
+    return bsl::min(static_cast<bsls::Types::Int64>(
+                        d_nanosPerToken * static_cast<double>(count)),
+                    d_burstNanos);
+}
+
+bsls::Types::Int64 RateLimiter::Bucket::tryTake(bsl::size_t count,
+                                                bsls::Types::Int64 now)
+{
+    if (d_unlimited) {
+        return 0;
+    }
+
+    const bsls::Types::Int64 tokens = cost(count);
+    bsls::Types::Int64 fullAt       = d_fullAt.loadAcquire();
+    for (;;) {
+        const bsls::Types::Int64 newFullAt = bsl::max(fullAt, now) + tokens;
+        if (newFullAt - now > d_burstNanos) {
+            return newFullAt - now - d_burstNanos;
+        }
+
+        const bsls::Types::Int64 previous =
+            d_fullAt.testAndSwapAcqRel(fullAt, newFullAt);
+        if (previous == fullAt) {
+            return 0;
+        }
+        fullAt = previous;
+    }
+}
+
+void RateLimiter::Bucket::giveBack(bsl::size_t count)
+{
+    if (!d_unlimited) {
+        d_fullAt.addAcqRel(-cost(count));
+    }
+}
+
+bsls::Types::Int64 RateLimiter::Bucket::wait(bsl::size_t count,
+                                             bsls::Types::Int64 now) const
+{
+    if (d_unlimited) {
+        return 0;
+    }
+
+    const bsls::Types::Int64 fullAt = bsl::max(d_fullAt.loadAcquire(), now);
+    return bsl::max<bsls::Types::Int64>(
+        fullAt + cost(count) - now - d_burstNanos, 0);
+}
+
+bsl::size_t RateLimiter::Bucket::available(bsls::Types::Int64 now) const
+{
+    if (d_unlimited) {
+        return bsl::numeric_limits<bsl::size_t>::max();
+    }
+
+    const bsls::Types::Int64 used =
+        bsl::max<bsls::Types::Int64>(d_fullAt.loadAcquire() - now, 0);
+    return static_cast<bsl::size_t>(
+        static_cast<double>(d_burstNanos - bsl::min(used, d_burstNanos)) /
+        d_nanosPerToken);
+}
+
+RateLimiter::RateLimiter(const rmqt::RateLimit& limit,
+                         const bsl::shared_ptr<RateLimiter>& parent)
+: d_messages(limit.messagesPerSecond(), limit.messageBurst())
+, d_bytes(limit.bytesPerSecond(), limit.byteBurst())
+, d_parent(parent)
+{
+}
+
+bsls::TimeInterval RateLimiter::tryAcquire(bsl::size_t bytes)
+{
+    const bsls::Types::Int64 time = nowNanos();
+
+    bsls::Types::Int64 wait = d_messages.tryTake(1, time);
+    if (wait) {
+        return fromNanos(wait);
+    }
+
+    wait = d_bytes.tryTake(bytes, time);
+    if (wait) {
+        d_messages.giveBack(1);
+        return fromNanos(wait);
+    }
+
+    if (d_parent) {
+        const bsls::TimeInterval parentWait = d_parent->tryAcquire(bytes);
+        if (parentWait > bsls::TimeInterval()) {
+            d_messages.giveBack(1);
+            d_bytes.giveBack(bytes);
+            return parentWait;
+        }
+    }
+
+    return bsls::TimeInterval();
+}
+
+bool RateLimiter::acquire(bsl::size_t bytes, const bsls::TimeInterval& timeout)
+{
+    const bsls::TimeInterval deadline =
+        bsls::SystemTime::nowMonotonicClock() + timeout;
+
+    for (;;) {
+        const bsls::TimeInterval wait = tryAcquire(bytes);
+        if (wait == bsls::TimeInterval()) {
+            return true;
+        }
+
+        if (timeout != bsls::TimeInterval() &&
+            bsls::SystemTime::nowMonotonicClock() + wait > deadline) {
+            return false;
+        }
+
+        // Other publishers may take the tokens first, so try again after
+        bslmt::ThreadUtil::sleep(wait);
+    }
+}
+
+void RateLimiter::release(bsl::size_t bytes)
+{
+    d_messages.giveBack(1);
+    d_bytes.giveBack(bytes);
+    if (d_parent) {
+        d_parent->release(bytes);
+    }
+}
+
+bsls::TimeInterval RateLimiter::delay(bsl::size_t messages) const
+{
+    const bsls::Types::Int64 time = nowNanos();
+
+    // Bytes owed by earlier messages hold back the next one too
+    const bsls::Types::Int64 wait =
+        bsl::max(d_messages.wait(messages, time), d_bytes.wait(1, time));
+
+    bsls::TimeInterval result = fromNanos(wait);
+    if (d_parent) {
+        result = bsl::max(result, d_parent->delay(messages));
+    }
+    return result;
+}
+
+bsl::size_t RateLimiter::available() const
+{
+    const bsls::Types::Int64 time = nowNanos();
+    const bsl::size_t messages =
+        d_bytes.wait(1, time) > 0 ? 0 : d_messages.available(time);
+    return d_parent ? bsl::min(messages, d_parent->available()) : messages;
+}
+
+} // namespace rmqamqp
+} // namespace BloombergLP
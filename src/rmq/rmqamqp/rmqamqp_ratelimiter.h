@@ -0,0 +1,111 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQAMQP_RATELIMITER
+#define INCLUDED_RMQAMQP_RATELIMITER
+
+#include <rmqt_ratelimit.h>
+
+#include <bsls_atomic.h>
+#include <bsls_keyword.h>
+#include <bsls_timeinterval.h>
+#include <bsls_types.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_memory.h>
+
+namespace BloombergLP {
+namespace rmqamqp {
+
+//@PURPOSE: Pace publishing to a `rmqt::RateLimit`
+//
+//@CLASSES:
+//  rmqamqp::RateLimiter: Lock-free message and byte token buckets
+
+/// \brief Paces publishes to a `rmqt::RateLimit`, and optionally to the
+/// limit of a parent limiter shared with other publishers
+///
+/// Each rate is a token bucket, kept as the time at which it will be full
+/// again (the generic cell rate algorithm), so taking tokens is a single
+/// compare-and-swap and never blocks other publishers. Lock-free and
+/// thread-safe.
+
+class RateLimiter {
+  public:
+    /// Pace to `limit`, and then to `parent`'s limits if it is set
+    explicit RateLimiter(const rmqt::RateLimit& limit,
+                         const bsl::shared_ptr<RateLimiter>& parent =
+                             bsl::shared_ptr<RateLimiter>());
+
+    /// Take one message of `bytes` if the limits allow it now, and return
+    /// zero. Otherwise take nothing and return how long until they would.
+    bsls::TimeInterval tryAcquire(bsl::size_t bytes);
+
+    /// Take one message of `bytes`, sleeping until the limits allow it.
+    /// Return false, having taken nothing, if that would take longer than
+    /// `timeout` (if non-zero).
+    bool acquire(bsl::size_t bytes, const bsls::TimeInterval& timeout);
+
+    /// Give back one message of `bytes` taken but not sent after all
+    void release(bsl::size_t bytes);
+
+    /// Return how long until `messages` messages could be taken, zero if
+    /// they could be now
+    bsls::TimeInterval delay(bsl::size_t messages) const;
+
+    /// Return how many messages the message limits allow now
+    bsl::size_t available() const;
+
+  private:
+    /// A token bucket, see the class documentation
+    class Bucket {
+      public:
+        Bucket(double perSecond, bsl::size_t burst);
+
+        /// Take `count` tokens and return zero, or return the nanoseconds
+        /// until there are enough
+        bsls::Types::Int64 tryTake(bsl::size_t count, bsls::Types::Int64 now);
+
+        void giveBack(bsl::size_t count);
+
+        /// Return the nanoseconds until `count` tokens could be taken
+        bsls::Types::Int64 wait(bsl::size_t count,
+                                bsls::Types::Int64 now) const;
+
+        bsl::size_t available(bsls::Types::Int64 now) const;
+
+      private:
+        bsls::Types::Int64 cost(bsl::size_t count) const;
+
+        const bool d_unlimited;
+        const double d_nanosPerToken;
+        const bsls::Types::Int64 d_burstNanos;
+        /// When the bucket is full again, in monotonic clock nanoseconds
+        bsls::AtomicInt64 d_fullAt;
+    };
+
+    Bucket d_messages;
+    Bucket d_bytes;
+    const bsl::shared_ptr<RateLimiter> d_parent;
+
+  private:
+    RateLimiter(const RateLimiter&) BSLS_KEYWORD_DELETED;
+    RateLimiter& operator=(const RateLimiter&) BSLS_KEYWORD_DELETED;
+};
+
+} // namespace rmqamqp
+} // namespace BloombergLP
+
+#endif
@@ -16,23 +16,30 @@
 // rmqamqp_receivechannel.cpp   -*-C++-*-
 #include <rmqamqp_receivechannel.h>
 
+#include <rmqamqp_metrics.h>
 #include <rmqamqpt_basicconsume.h>
 #include <rmqamqpt_basicdeliver.h>
+#include <rmqamqpt_basicpublish.h>
 #include <rmqamqpt_basicqos.h>
+#include <rmqio_coarseclock.h>
 #include <rmqt_consumerack.h>
-#include <rmqt_consumerackbatch.h>
+#include <rmqt_consumerackqueue.h>
 #include <rmqt_envelope.h>
 #include <rmqt_fieldvalue.h>
+#include <rmqt_log.h>
 #include <rmqt_properties.h>
+#include <rmqt_streamoffset.h>
 
 #include <ball_log.h>
 #include <bdlf_bind.h>
-#include <bdlt_currenttime.h>
+#include <bdlt_datetimeinterval.h>
 #include <bsls_assert.h>
 
 #include <bsl_algorithm.h>
+#include <bsl_limits.h>
 #include <bsl_map.h>
 #include <bsl_optional.h>
+#include <bsl_set.h>
 #include <bsl_string.h>
 #include <bsl_vector.h>
 
@@ -44,6 +51,29 @@ BALL_LOG_SET_NAMESPACE_CATEGORY("RMQAMQP.RECEIVECHANNEL")
 using bdlf::PlaceHolders::_1;
 using bdlf::PlaceHolders::_2;
 using bdlf::PlaceHolders::_3;
+
+// How often the adaptive prefetch count is reconsidered
+const bsls::TimeInterval k_PREFETCH_EVALUATION_INTERVAL(1);
+
+void noopWriteHandler() {}
+
+const char k_STREAM_OFFSET[] = "x-stream-offset";
+
+/// Return the stream offset the broker attached to `message`, if any
+bsl::optional<uint64_t> streamOffset(const rmqt::Message& message)
+{
+    rmqt::FieldValue value;
+    if (!message.findHeader(&value, k_STREAM_OFFSET)) {
+        return bsl::optional<uint64_t>();
+    }
+    if (value.is<int64_t>()) {
+        return static_cast<uint64_t>(value.the<int64_t>());
+    }
+    if (value.is<uint64_t>()) {
+        return value.the<uint64_t>();
+    }
+    return bsl::optional<uint64_t>();
+}
 } // namespace
 
 class ReceiveChannel::Consumer {
@@ -69,6 +99,7 @@ class ReceiveChannel::Consumer {
              const bsl::string& tag);
 
     bool isStarted() const;
+    bool isStarting() const;
     bool isActive() const;
     bool shouldRestart() const;
 
@@ -77,11 +108,52 @@ class ReceiveChannel::Consumer {
     const bsl::string& consumerTag() const;
     const bsl::string& queueName() const;
 
+    /// Mark the consumer's callback as gone, see `releaseConsumer`
+    void release() { d_released = true; }
+    bool isReleased() const { return d_released; }
+
+    /// Return a future resolved by `cancelled`, see `cancelConsumer`
+    rmqt::Future<> cancelFuture();
+
+    /// Resolve the future returned by `cancelFuture`, if any
+    void cancelled(const rmqt::Result<>& result);
+
+    /// Count a delivery to this consumer which is waiting for its ack, on a
+    /// shared channel
+    void delivered();
+
+    /// Count an acked delivery, resolving the `drain` future once none are
+    /// left
+    void settled();
+
+    /// Return a future resolved once no deliveries are waiting for acks,
+    /// see `drainConsumer`
+    rmqt::Future<> drain();
+
+    /// Resolve the future returned by `drain`, if any, and forget the
+    /// deliveries waiting for acks
+    void drained(const rmqt::Result<>& result);
+
   private:
     State d_state;
     bsl::string d_tag;
+
+    /// `d_tag`, and the exchange of the last delivery, shared by the
+    /// envelopes of this consumer's deliveries
+    bsl::shared_ptr<const bsl::string> d_envelopeTag;
+    bsl::shared_ptr<const bsl::string> d_envelopeExchange;
+
+    /// Set when consuming a stream queue: the offset of the last delivery,
+    /// which a restarted consumer resumes after
+    bool d_streamConsumer;
+    bsl::optional<uint64_t> d_lastStreamOffset;
+
     bsl::shared_ptr<rmqt::Queue> d_queue;
     MessageCallback d_onNewMessage;
+    bool d_released;
+    bsl::size_t d_inFlight;
+    bslma::ManagedPtr<rmqt::Future<>::Pair> d_cancelFuturePair;
+    bslma::ManagedPtr<rmqt::Future<>::Maker> d_drainFuture;
 };
 
 ReceiveChannel::Consumer::Consumer(const bsl::shared_ptr<rmqt::Queue>& queue,
@@ -89,8 +161,16 @@ ReceiveChannel::Consumer::Consumer(const bsl::shared_ptr<rmqt::Queue>& queue,
                                    const bsl::string& consumerTag)
 : d_state(NOT_CONSUMING)
 , d_tag(consumerTag)
+, d_envelopeTag(bsl::make_shared<const bsl::string>(consumerTag))
+, d_envelopeExchange()
+, d_streamConsumer(false)
+, d_lastStreamOffset()
 , d_queue(queue)
 , d_onNewMessage(onNewMessage)
+, d_released(false)
+, d_inFlight(0)
+, d_cancelFuturePair()
+, d_drainFuture()
 {
 }
 
@@ -136,6 +216,10 @@ bool ReceiveChannel::Consumer::isStarted() const
 {
     return d_state != NOT_CONSUMING;
 }
+bool ReceiveChannel::Consumer::isStarting() const
+{
+    return d_state == STARTING;
+}
 bool ReceiveChannel::Consumer::isActive() const { return d_state == CONSUMING; }
 bool ReceiveChannel::Consumer::shouldRestart() const
 {
@@ -146,19 +230,35 @@ void ReceiveChannel::Consumer::process(const rmqt::Message& msg,
                                        const rmqamqpt::BasicDeliver& deliver,
                                        size_t lifetimeId)
 {
-    d_onNewMessage(msg,
-                   rmqt::Envelope(deliver.deliveryTag(),
-                                  lifetimeId,
-                                  deliver.consumerTag(),
-                                  deliver.exchange(),
-                                  deliver.routingKey(),
-                                  deliver.redelivered()));
+    // A consumer's deliveries nearly always come through one exchange
+    if (!d_envelopeExchange || *d_envelopeExchange != deliver.exchange()) {
+        d_envelopeExchange =
+            bsl::make_shared<const bsl::string>(deliver.exchange());
+    }
+
+    rmqt::Envelope envelope(deliver.deliveryTag(),
+                            lifetimeId,
+                            d_envelopeTag,
+                            d_envelopeExchange,
+                            deliver.routingKey(),
+                            deliver.redelivered());
+
+    if (d_streamConsumer) {
+        bsl::optional<uint64_t> offset = streamOffset(msg);
+        if (offset) {
+            envelope.setStreamOffset(offset.value());
+            d_lastStreamOffset = offset;
+        }
+    }
+
+    d_onNewMessage(msg, envelope);
 }
 
 namespace {
 
 rmqt::FieldTable
-getBasicConsumeArguments(const rmqt::ConsumerConfig& consumerConfig)
+getBasicConsumeArguments(const rmqt::ConsumerConfig& consumerConfig,
+                         const bsl::optional<uint64_t>& lastStreamOffset)
 {
     rmqt::FieldTable arguments;
 
@@ -167,6 +267,16 @@ getBasicConsumeArguments(const rmqt::ConsumerConfig& consumerConfig)
         arguments["x-priority"] = rmqt::FieldValue(consumerPriority.value());
     }
 
+    if (consumerConfig.streamOffset()) {
+        // A restarted consumer carries on after its last delivery, which the
+        // application has already seen
+        const rmqt::StreamOffset offset =
+            lastStreamOffset
+                ? rmqt::StreamOffset::offset(lastStreamOffset.value() + 1)
+                : consumerConfig.streamOffset().value();
+        arguments[k_STREAM_OFFSET] = offset.toFieldValue();
+    }
+
     return arguments;
 }
 
@@ -182,8 +292,10 @@ ReceiveChannel::Consumer::consume(const rmqt::ConsumerConfig& consumerConfig)
                       << " for queue: " << d_queue->name();
         d_state = STARTING;
 
+        d_streamConsumer = consumerConfig.streamOffset().has_value();
+
         const bool noLocal = false;
-        const bool noAck   = false;
+        const bool noAck   = consumerConfig.noAck();
         const bool exclusive =
             consumerConfig.exclusiveFlag() == rmqt::Exclusive::ON;
         const bool noWait = false;
@@ -191,7 +303,8 @@ ReceiveChannel::Consumer::consume(const rmqt::ConsumerConfig& consumerConfig)
         method =
             rmqamqpt::BasicConsume(d_queue->name(),
                                    d_tag,
-                                   getBasicConsumeArguments(consumerConfig),
+                                   getBasicConsumeArguments(
+                                       consumerConfig, d_lastStreamOffset),
                                    noLocal,
                                    noAck,
                                    exclusive,
@@ -232,7 +345,68 @@ void ReceiveChannel::Consumer::cancelOk()
     d_state = CANCELLED;
 }
 
-ReceiveChannel::Consumer::~Consumer() {}
+rmqt::Future<> ReceiveChannel::Consumer::cancelFuture()
+{
+    if (!d_cancelFuturePair) {
+        d_cancelFuturePair =
+            bslma::ManagedPtrUtil::makeManaged<rmqt::Future<>::Pair>(
+                rmqt::Future<>::make());
+    }
+    return d_cancelFuturePair->second;
+}
+
+void ReceiveChannel::Consumer::cancelled(const rmqt::Result<>& result)
+{
+    if (d_cancelFuturePair) {
+        d_cancelFuturePair->first(result);
+        d_cancelFuturePair.reset();
+    }
+}
+
+void ReceiveChannel::Consumer::delivered() { ++d_inFlight; }
+
+void ReceiveChannel::Consumer::settled()
+{
+    if (d_inFlight > 0) {
+        --d_inFlight;
+    }
+    if (d_inFlight == 0 && d_drainFuture) {
+        drained(rmqt::Result<>());
+    }
+}
+
+rmqt::Future<> ReceiveChannel::Consumer::drain()
+{
+    if (d_drainFuture) {
+        return rmqt::Future<>(
+            rmqt::Result<>("Calling drain() 2x is unsupported"));
+    }
+    if (d_inFlight == 0) {
+        return rmqt::Future<>(rmqt::Result<>());
+    }
+
+    rmqt::Future<>::Pair future = rmqt::Future<>::make();
+    d_drainFuture = bslma::ManagedPtrUtil::makeManaged<rmqt::Future<>::Maker>(
+        future.first);
+    return future.second;
+}
+
+void ReceiveChannel::Consumer::drained(const rmqt::Result<>& result)
+{
+    d_inFlight = 0;
+    if (d_drainFuture) {
+        (*d_drainFuture)(result);
+        d_drainFuture.reset();
+    }
+}
+
+ReceiveChannel::Consumer::~Consumer()
+{
+    cancelled(rmqt::Result<>("ReceiveChannel Shut Down Before CancelOk "
+                             "Received, outstanding Acks/Nacks will not be "
+                             "processed"));
+    drained(rmqt::Result<>("ReceiveChannel Shut Down Before Fully Drained"));
+}
 
 // Constructor
 ReceiveChannel::ReceiveChannel(
@@ -253,57 +427,117 @@ ReceiveChannel::ReceiveChannel(
           hungProgressTimer,
           connErrorCb)
 , d_consumerConfig(consumerConfig)
-, d_consumer()
+, d_consumers()
+, d_shared(false)
+, d_deliveredTo()
+, d_expiredTags()
+, d_heldPublishes()
 , d_nextMessage()
+, d_expectingContent(false)
 , d_messageStore()
 , d_ackQueue(ackQueue)
+, d_pendingAcks()
 , d_multipleAckHandler(
       bdlf::BindUtil::bind(&ReceiveChannel::sendAck, this, _1, _2),
       bdlf::BindUtil::bind(&ReceiveChannel::sendNack, this, _1, _2, _3))
+, d_ackFlushTimer()
+, d_ackFlushArmed(false)
+, d_prefetchController()
+, d_prefetchTimer()
+, d_memoryBudget()
+, d_budgetBytes(0)
+, d_budgetThrottled(false)
+, d_bytesThrottled(false)
+, d_slowStartPrefetch(0)
+, d_slowStartAcks(0)
+, d_pendingQoSUpdates(0)
 , d_cancelFuturePair()
 , d_drainFuture()
+, d_receivedMessagesMetric(MetricAggregator::counter(metricPublisher,
+                                                     "received_messages",
+                                                     d_vhostTags))
+, d_acknowledgeLatencyMetric(
+      MetricAggregator::distribution(metricPublisher,
+                                     "acknowledge_latency",
+                                     d_vhostTags))
+, d_inlineCallbackMetric(
+      MetricAggregator::distribution(metricPublisher,
+                                     "inline_callback_seconds",
+                                     d_vhostTags))
+, d_messagesIn(0)
+, d_bytesIn(0)
+, d_lastDeliveryTime()
 {
+    restartSlowStart();
 }
 
 void ReceiveChannel::onOpen()
 {
-    BALL_LOG_TRACE << "Setting Prefetch: " << d_consumerConfig.prefetchCount();
     d_hungProgressTimer->reset(
         bsls::TimeInterval(Channel::k_HUNG_CHANNEL_TIMER_SEC));
+    if (setupPipelined()) {
+        // basic.qos, and basic.consume for each consumer, went with
+        // channel.open, their replies are next
+        updateState(AWAITING_REPLY);
+        return;
+    }
+
+    RMQT_LOG_TRACE << "Setting Prefetch: " << effectivePrefetch();
     writeMessage(Message(rmqamqpt::Method(rmqamqpt::BasicMethod(
-                     rmqamqpt::BasicQoS(d_consumerConfig.prefetchCount())))),
+                     rmqamqpt::BasicQoS(effectivePrefetch(), 0, d_shared)))),
                  AWAITING_REPLY);
 }
 
+bool ReceiveChannel::appendSetupMethods(bsl::vector<Message>* methods)
+{
+    RMQT_LOG_TRACE << "Setting Prefetch: " << effectivePrefetch();
+    methods->push_back(Message(rmqamqpt::Method(rmqamqpt::BasicMethod(
+        rmqamqpt::BasicQoS(effectivePrefetch(), 0, d_shared)))));
+
+    for (Consumers::iterator it = d_consumers.begin(); it != d_consumers.end();
+         ++it) {
+        bsl::optional<rmqamqpt::BasicMethod> method =
+            (*it)->consume(d_consumerConfig);
+        if (method) {
+            methods->push_back(Message(rmqamqpt::Method(method.value())));
+        }
+    }
+    return true;
+}
+
 void ReceiveChannel::onReset()
 {
-    d_nextMessage.reset();
+    d_expectingContent = false;
     d_multipleAckHandler.reset();
+    d_expiredTags.clear();
+    d_pendingQoSUpdates = 0;
+    restartSlowStart();
+    d_heldPublishes.reset();
+    if (d_ackFlushArmed) {
+        d_ackFlushArmed = false;
+        d_ackFlushTimer->cancel();
+    }
 
-    // Drop and lock all pending acknowledgement batches
+    // Drop all pending acknowledgements
     // This reduces the number of 'Ignoring ack/nack for a channel which is
     // closed' alerts by just eliminating the acks.
-    typedef bsl::vector<bsl::shared_ptr<rmqt::ConsumerAckBatch> >
-        AckBatchVector;
-
-    AckBatchVector clearedAcknowledgements;
-    d_ackQueue->removeAll(&clearedAcknowledgements);
-    for (AckBatchVector::iterator it = clearedAcknowledgements.begin();
-         it != clearedAcknowledgements.end();
-         ++it) {
-        (*it)->lock();
-    }
+    d_ackQueue->clear();
 
     // processFailures() clears d_messageStore;
 
-    if (d_consumer) {
-        if (d_consumer->shouldRestart()) {
-            BALL_LOG_TRACE << "Resetting consumer";
-            d_consumer->reset();
+    Consumers::iterator it = d_consumers.begin();
+    while (it != d_consumers.end()) {
+        if ((*it)->shouldRestart()) {
+            RMQT_LOG_TRACE << "Resetting consumer";
+            (*it)->reset();
+            ++it;
         }
         else {
             BALL_LOG_WARN << "Clearing Consumer in Cancelling/Cancelled State";
-            d_consumer.reset();
+            (*it)->cancelled(rmqt::Result<>(
+                "Cancel could not be processed by the server, due channel "
+                "reset, however consumer is now in a cancelled state"));
+            it = d_consumers.erase(it);
         }
     }
     if (d_cancelFuturePair) {
@@ -330,16 +564,21 @@ rmqt::Result<> ReceiveChannel::consume(const rmqt::QueueHandle& queue,
         return rmqt::Result<>("QueueHandle expired", 1);
     }
 
-    BSLS_ASSERT(!d_consumer);
+    BSLS_ASSERT(d_shared || d_consumers.empty());
 
-    d_consumer =
-        bsl::make_shared<Consumer>(queuePtr, onNewMessage, consumerTag);
+    if (findConsumer(consumerTag) != d_consumers.end()) {
+        return rmqt::Result<>(
+            "Consumer tag already in use on this channel: " + consumerTag, 1);
+    }
+
+    d_consumers.push_back(
+        bsl::make_shared<Consumer>(queuePtr, onNewMessage, consumerTag));
 
     if (state() == READY || state() == AWAITING_REPLY) {
-        restartConsumers();
+        startConsumer(*d_consumers.back());
     }
     else {
-        BALL_LOG_TRACE << "Consume called before channel ready, consumertag: "
+        RMQT_LOG_TRACE << "Consume called before channel ready, consumertag: "
                        << consumerTag << " pending";
     }
     // send consume off to server
@@ -361,29 +600,26 @@ ReceiveChannel::~ReceiveChannel()
             "messages that should have been acked weren't"));
         d_drainFuture.reset();
     }
+    if (d_memoryBudget) {
+        // Unacked deliveries are redelivered elsewhere, never acked here
+        d_memoryBudget->release(d_budgetBytes);
+    }
 }
 
 void ReceiveChannel::consumeAckBatchFromQueue()
 {
-    if (d_ackQueue->length() == 0) {
-        BALL_LOG_ERROR << "Ack queue is empty";
+    // Reused between drains, so steady-state acking doesn't allocate
+    bsl::vector<rmqt::ConsumerAck>& acks = d_pendingAcks;
+    acks.clear();
+    d_ackQueue->drain(&acks);
+    if (acks.empty()) {
         return;
     }
 
-    bsl::shared_ptr<rmqt::ConsumerAckBatch> batch = d_ackQueue->popFront();
-    bsl::vector<rmqt::ConsumerAck>& acks          = batch->lock();
-
     bsl::vector<rmqt::ConsumerAck>::iterator valid = acks.begin();
     for (bsl::vector<rmqt::ConsumerAck>::iterator it = valid; it < acks.end();
          ++it) {
-        if (it->envelope().channelLifetimeId() == lifetimeId()) {
-            // Avoid unnecessary copying to the same vector index
-            if (it != valid) {
-                (*valid) = (*it);
-            }
-            ++valid;
-        }
-        else {
+        if (it->envelope().channelLifetimeId() != lifetimeId()) {
             BALL_LOG_WARN << "Ignoring ack/nack for a channel which is "
                              "closed. Delivery tag: "
                           << it->envelope().deliveryTag()
@@ -394,48 +630,324 @@ void ReceiveChannel::consumeAckBatchFromQueue()
                              "message is being processed. The broker will "
                              "safely redeliver the message.";
         }
+        else if (d_expiredTags.erase(it->envelope().deliveryTag())) {
+            BALL_LOG_WARN << "Ignoring ack/nack for delivery tag "
+                          << it->envelope().deliveryTag()
+                          << ", requeued after its ack deadline";
+        }
+        else if (d_shared && !d_consumerConfig.noAck() &&
+                 !d_deliveredTo.count(it->envelope().deliveryTag())) {
+            // e.g. nacked by `nackConsumerDeliveries`
+            BALL_LOG_WARN << "Ignoring ack/nack for delivery tag "
+                          << it->envelope().deliveryTag()
+                          << ", which is already settled";
+        }
+        else {
+            // Avoid unnecessary copying to the same vector index
+            if (it != valid) {
+                (*valid) = (*it);
+            }
+            ++valid;
+        }
     }
     acks.erase(valid, acks.end());
 
     d_multipleAckHandler.process(acks);
+
+    if (d_ackFlushTimer && !d_ackFlushArmed &&
+        d_multipleAckHandler.heldAcks() > 0) {
+        d_ackFlushArmed = true;
+        d_ackFlushTimer->reset(d_consumerConfig.ackCoalescingDelay());
+    }
+}
+
+void ReceiveChannel::enableAckCoalescing(rmqio::TimerFactory& timerFactory)
+{
+    using bdlf::PlaceHolders::_1;
+
+    d_ackFlushTimer = timerFactory.createWithCallback(bdlf::BindUtil::bind(
+        &ReceiveChannel::onAckFlushTimer, weak_from_this(), _1));
+    d_multipleAckHandler.setCoalescing(d_consumerConfig.ackCoalescingTags());
+}
+
+void ReceiveChannel::onAckFlushTimer(const bsl::weak_ptr<Channel>& weakSelf,
+                                     rmqio::Timer::InterruptReason reason)
+{
+    if (reason != rmqio::Timer::EXPIRE) {
+        return;
+    }
+
+    bsl::shared_ptr<Channel> self = weakSelf.lock();
+    if (self) {
+        bsl::static_pointer_cast<ReceiveChannel>(self)->flushHeldAcks();
+    }
+}
+
+void ReceiveChannel::flushHeldAcks()
+{
+    d_ackFlushArmed = false;
+    d_multipleAckHandler.flush();
+}
+
+void ReceiveChannel::gracefulClose()
+{
+    flushHeldAcks();
+    Channel::gracefulClose();
+}
+
+void ReceiveChannel::shareBetweenConsumers()
+{
+    if (d_shared) {
+        return;
+    }
+    d_shared = true;
+
+    // Replaces the per-consumer limit set when the channel opened
+    updatePrefetch(effectivePrefetch());
 }
 
 bool ReceiveChannel::consumerIsActive() const
 {
-    return d_consumer && d_consumer->isActive();
+    for (Consumers::const_iterator it = d_consumers.begin();
+         it != d_consumers.end();
+         ++it) {
+        if ((*it)->isActive()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+rmqt::Result<> ReceiveChannel::publish(const rmqt::Message& message,
+                                       const bsl::string& exchange,
+                                       const bsl::string& routingKey)
+{
+    if (!consumerIsActive() && !awaitingConsumeOk()) {
+        return rmqt::Result<>("Cannot publish without a started consumer");
+    }
+
+    const Message method(rmqamqpt::Method(rmqamqpt::BasicMethod(
+        rmqamqpt::BasicPublish(exchange, routingKey, false, false))));
+
+    if (state() != READY || !consumerIsActive()) {
+        if (!d_heldPublishes) {
+            d_heldPublishes = bsl::make_shared<bsl::vector<Message> >();
+        }
+        d_heldPublishes->push_back(method);
+        d_heldPublishes->push_back(Message(message));
+        return rmqt::Result<>();
+    }
+
+    writeMessage(method, &noopWriteHandler);
+    writeMessage(Message(message), &noopWriteHandler);
+    return rmqt::Result<>();
+}
+
+ReceiveChannel::Consumers::iterator
+ReceiveChannel::findConsumer(const bsl::string& consumerTag)
+{
+    Consumers::iterator it = d_consumers.begin();
+    while (it != d_consumers.end() && (*it)->consumerTag() != consumerTag) {
+        ++it;
+    }
+    return it;
 }
 
 rmqt::Future<> ReceiveChannel::cancel()
 {
+    // The consumer may not be around to ack again, send what's held
+    flushHeldAcks();
+
     if (d_cancelFuturePair) {
         BALL_LOG_WARN << "Cancel called with a cancel already in "
                          "flight";
         return d_cancelFuturePair->second;
     }
-    if (d_consumer) {
-        if (d_consumer->isStarted()) {
-            d_cancelFuturePair =
-                bslma::ManagedPtrUtil::makeManaged<rmqt::Future<>::Pair>(
-                    rmqt::Future<>::make());
-            bsl::optional<rmqamqpt::BasicMethod> method = d_consumer->cancel();
-            if (method) {
-                writeMessage(Message(rmqamqpt::Method(method.value())),
-                             AWAITING_REPLY);
-            }
-            return d_cancelFuturePair->second;
+    if (d_consumers.empty()) {
+        return rmqt::Future<>(
+            rmqt::Result<>("Cancel called, with no active consumer"));
+    }
+
+    Consumers::iterator it = d_consumers.begin();
+    while (it != d_consumers.end()) {
+        if ((*it)->isStarted()) {
+            sendCancel(**it);
+            ++it;
+        }
+        else {
+            // Not consuming so we're already done
+            it = d_consumers.erase(it);
         }
-        // Not consuming so we're already done
-        d_consumer.reset();
+    }
+    if (d_consumers.empty()) {
+        return rmqt::Future<>(rmqt::Result<>());
+    }
+
+    d_cancelFuturePair =
+        bslma::ManagedPtrUtil::makeManaged<rmqt::Future<>::Pair>(
+            rmqt::Future<>::make());
+    return d_cancelFuturePair->second;
+}
+
+rmqt::Future<> ReceiveChannel::cancelConsumer(const bsl::string& consumerTag)
+{
+    flushHeldAcks();
+
+    Consumers::iterator it = findConsumer(consumerTag);
+    if (it == d_consumers.end()) {
+        return rmqt::Future<>(rmqt::Result<>(
+            "Cancel called, with no active consumer: " + consumerTag));
+    }
+    if (!(*it)->isStarted()) {
+        d_consumers.erase(it);
         return rmqt::Future<>(rmqt::Result<>());
     }
-    return rmqt::Future<>(
-        rmqt::Result<>("Cancel called, with no active consumer"));
+
+    const bsl::shared_ptr<Consumer> consumer = *it;
+    rmqt::Future<> future = consumer->cancelFuture();
+    if (consumer->shouldRestart()) {
+        sendCancel(*consumer);
+    }
+    return future;
+}
+
+void ReceiveChannel::releaseConsumer(const bsl::string& consumerTag)
+{
+    Consumers::iterator it = findConsumer(consumerTag);
+    if (it == d_consumers.end()) {
+        return;
+    }
+    (*it)->release();
+    const bsl::shared_ptr<Consumer> consumer = *it;
+
+    // Acks the consumer queued before it went are sent first (cancelling
+    // flushes any held back), so only deliveries it will never ack are
+    // requeued
+    consumeAckBatchFromQueue();
+    cancelConsumer(consumerTag);
+    const bsl::size_t requeued = nackDeliveries(consumerTag, true);
+    if (requeued > 0) {
+        BALL_LOG_INFO << "Requeued " << requeued
+                      << " messages delivered to released consumer: "
+                      << consumerTag;
+    }
+}
+
+rmqt::Future<> ReceiveChannel::nackAllOutstanding(bool requeue)
+{
+    // Acks queued by the application are sent first, so that only the
+    // deliveries it has not resolved are nacked
+    consumeAckBatchFromQueue();
+
+    if (state() != READY || d_messageStore.count() == 0) {
+        // Anything outstanding on a closed channel is redelivered anyway
+        return rmqt::Future<>(rmqt::Result<>());
+    }
+
+    BALL_LOG_INFO << "Nacking all " << d_messageStore.count()
+                  << " outstanding messages (requeue = " << requeue
+                  << ") on " << channelDebugName();
+    d_multipleAckHandler.nackThrough(d_messageStore.latestTagTilNow(),
+                                     requeue);
+    return rmqt::Future<>(rmqt::Result<>());
+}
+
+rmqt::Future<>
+ReceiveChannel::nackConsumerDeliveries(const bsl::string& consumerTag,
+                                       bool requeue)
+{
+    consumeAckBatchFromQueue();
+
+    if (state() != READY) {
+        return rmqt::Future<>(rmqt::Result<>());
+    }
+
+    const bsl::size_t nacked = nackDeliveries(consumerTag, requeue);
+    BALL_LOG_INFO << "Nacked all " << nacked
+                  << " outstanding messages (requeue = " << requeue
+                  << ") delivered to consumer: " << consumerTag;
+    return rmqt::Future<>(rmqt::Result<>());
+}
+
+rmqt::Future<> ReceiveChannel::ackThrough(const rmqt::Envelope& envelope)
+{
+    consumeAckBatchFromQueue();
+
+    if (state() != READY || envelope.channelLifetimeId() != lifetimeId()) {
+        return rmqt::Future<>(
+            rmqt::Result<>("Channel closed since the message was delivered, "
+                           "it will be redelivered"));
+    }
+
+    if (d_shared) {
+        bsl::vector<rmqt::ConsumerAck> acks;
+        for (DeliveryMap::const_iterator it = d_deliveredTo.begin();
+             it != d_deliveredTo.upper_bound(envelope.deliveryTag());
+             ++it) {
+            if (it->second->consumerTag() == envelope.consumerTag()) {
+                acks.push_back(rmqt::ConsumerAck(
+                    rmqt::Envelope(it->first,
+                                   lifetimeId(),
+                                   envelope.consumerTag(),
+                                   bsl::string(),
+                                   bsl::string(),
+                                   false),
+                    rmqt::ConsumerAck::ACK));
+            }
+        }
+        if (!acks.empty()) {
+            d_multipleAckHandler.process(acks);
+        }
+    }
+    else {
+        d_multipleAckHandler.ackThrough(envelope.deliveryTag());
+    }
+
+    // Not left for the coalescing timer: the caller asked for them now
+    flushHeldAcks();
+    return rmqt::Future<>(rmqt::Result<>());
+}
+
+bsl::size_t ReceiveChannel::nackDeliveries(const bsl::string& consumerTag,
+                                           bool requeue)
+{
+    bsl::vector<rmqt::ConsumerAck> nacks;
+    for (DeliveryMap::const_iterator it = d_deliveredTo.begin();
+         it != d_deliveredTo.end();
+         ++it) {
+        if (it->second->consumerTag() == consumerTag) {
+            nacks.push_back(rmqt::ConsumerAck(
+                rmqt::Envelope(it->first,
+                               lifetimeId(),
+                               consumerTag,
+                               bsl::string(),
+                               bsl::string(),
+                               false),
+                requeue ? rmqt::ConsumerAck::REQUEUE
+                        : rmqt::ConsumerAck::REJECT));
+        }
+    }
+    if (!nacks.empty()) {
+        d_multipleAckHandler.process(nacks);
+    }
+    return nacks.size();
+}
+
+void ReceiveChannel::sendCancel(Consumer& consumer)
+{
+    bsl::optional<rmqamqpt::BasicMethod> method = consumer.cancel();
+    if (method) {
+        writeMessage(Message(rmqamqpt::Method(method.value())),
+                     AWAITING_REPLY);
+    }
 }
 
 rmqt::Future<> ReceiveChannel::drain()
 {
+    flushHeldAcks();
+
     rmqt::Future<>::Pair future = rmqt::Future<>::make();
-    if (!d_consumer) {
+    if (d_consumers.empty()) {
         if (d_messageStore.count() > 0) {
             d_drainFuture =
                 bslma::ManagedPtrUtil::makeManaged<rmqt::Future<>::Maker>(
@@ -455,12 +967,96 @@ rmqt::Future<> ReceiveChannel::drain()
     return future.second;
 }
 
+rmqt::Future<> ReceiveChannel::drainConsumer(const bsl::string& consumerTag)
+{
+    flushHeldAcks();
+
+    if (findConsumer(consumerTag) != d_consumers.end()) {
+        return rmqt::Future<>(
+            rmqt::Result<>("drain() called, but consumer not cancelled"));
+    }
+
+    // A cancelled consumer is only kept while it has deliveries to ack
+    for (DeliveryMap::const_iterator it = d_deliveredTo.begin();
+         it != d_deliveredTo.end();
+         ++it) {
+        if (it->second->consumerTag() == consumerTag) {
+            return it->second->drain();
+        }
+    }
+    return rmqt::Future<>(rmqt::Result<>());
+}
+
 MessageStore<rmqt::Message>::MessageList
 ReceiveChannel::getMessagesOlderThan(const bdlt::Datetime& cutoffTime) const
 {
     return d_messageStore.getMessagesOlderThan(cutoffTime);
 }
 
+bsl::size_t ReceiveChannel::visitMessagesOlderThan(
+    const bdlt::Datetime& cutoffTime,
+    const MessageStore<rmqt::Message>::MessageVisitor& visitor) const
+{
+    return d_messageStore.visitMessagesOlderThan(cutoffTime, visitor);
+}
+
+bsl::size_t ReceiveChannel::visitNewlyHungMessages(
+    const bdlt::Datetime& cutoffTime,
+    const MessageStore<rmqt::Message>::MessageVisitor& visitor)
+{
+    return d_messageStore.updateHung(cutoffTime, visitor);
+}
+
+bsl::size_t
+ReceiveChannel::requeueMessagesOlderThan(const bdlt::Datetime& cutoffTime,
+                                         const ExpiryFilter& filter)
+{
+    // Acks already queued must not be overtaken by the nacks
+    consumeAckBatchFromQueue();
+    flushHeldAcks();
+
+    if (state() != READY || d_consumerConfig.noAck()) {
+        return 0;
+    }
+
+    const MessageStore<rmqt::Message>::MessageList expired =
+        d_messageStore.getMessagesOlderThan(cutoffTime);
+
+    bsl::vector<rmqt::ConsumerAck> nacks;
+    for (MessageStore<rmqt::Message>::MessageList::const_iterator it =
+             expired.begin();
+         it != expired.end();
+         ++it) {
+        const uint64_t deliveryTag = it->first;
+        if (d_multipleAckHandler.isResolved(deliveryTag) ||
+            d_expiredTags.count(deliveryTag) || (filter && !filter(*it))) {
+            continue;
+        }
+
+        DeliveryMap::const_iterator delivery = d_deliveredTo.find(deliveryTag);
+        nacks.push_back(rmqt::ConsumerAck(
+            rmqt::Envelope(deliveryTag,
+                           lifetimeId(),
+                           delivery != d_deliveredTo.end()
+                               ? delivery->second->consumerTag()
+                               : bsl::string(),
+                           bsl::string(),
+                           bsl::string(),
+                           false),
+            rmqt::ConsumerAck::REQUEUE));
+        d_expiredTags.insert(deliveryTag);
+    }
+
+    if (!nacks.empty()) {
+        BALL_LOG_WARN << "Requeueing " << nacks.size()
+                      << " messages unacked past their ack deadline on "
+                      << channelDebugName();
+        d_multipleAckHandler.process(nacks);
+        flushHeldAcks();
+    }
+    return nacks.size();
+}
+
 void ReceiveChannel::processBasicMethod(const rmqamqpt::BasicMethod& basic)
 {
     if (!(state() == READY || state() == AWAITING_REPLY)) {
@@ -469,32 +1065,32 @@ void ReceiveChannel::processBasicMethod(const rmqamqpt::BasicMethod& basic)
     }
     switch (basic.methodId()) {
         case rmqamqpt::BasicDeliver::METHOD_ID: {
-            if (d_nextMessage) {
+            if (d_expectingContent) {
                 BALL_LOG_ERROR
                     << "Expecting Content, got another deliver, have: "
-                    << *d_nextMessage
+                    << d_nextMessage
                     << ", got: " << basic.the<rmqamqpt::BasicDeliver>();
                 close(rmqamqpt::Constants::UNEXPECTED_FRAME,
                       "Expected Content");
             }
             else {
-                BALL_LOG_TRACE << "Deliver: "
+                RMQT_LOG_TRACE << "Deliver: "
                                << basic.the<rmqamqpt::BasicDeliver>();
-                d_nextMessage =
-                    bslma::ManagedPtrUtil::makeManaged<rmqamqpt::BasicDeliver>(
-                        basic.the<rmqamqpt::BasicDeliver>());
+                d_nextMessage      = basic.the<rmqamqpt::BasicDeliver>();
+                d_expectingContent = true;
             }
 
         } break;
         case rmqamqpt::BasicConsumeOk::METHOD_ID: {
-            if (d_consumer &&
-                d_consumer->consumerTag() ==
-                    basic.the<rmqamqpt::BasicConsumeOk>().consumerTag()) {
-
-                d_hungProgressTimer->cancel();
-
+            Consumers::iterator it = findConsumer(
+                basic.the<rmqamqpt::BasicConsumeOk>().consumerTag());
+            if (it != d_consumers.end()) {
                 bsl::optional<rmqamqpt::BasicMethod> method =
-                    d_consumer->consumeOk();
+                    (*it)->consumeOk();
+
+                if (!awaitingConsumeOk()) {
+                    d_hungProgressTimer->cancel();
+                }
                 if (method) {
                     writeMessage(Message(rmqamqpt::Method(method.value())),
                                  AWAITING_REPLY);
@@ -509,9 +1105,18 @@ void ReceiveChannel::processBasicMethod(const rmqamqpt::BasicMethod& basic)
                     ready();
                 }
             }
+            if (d_heldPublishes && state() == READY && consumerIsActive()) {
+                bsl::shared_ptr<bsl::vector<Message> > held;
+                held.swap(d_heldPublishes);
+                writeMessages(held, &noopWriteHandler);
+            }
         } break;
         case rmqamqpt::BasicQoSOk::METHOD_ID: {
-            if (d_consumer) {
+            if (d_pendingQoSUpdates > 0) {
+                // Reply to an adaptive prefetch update, nothing to do
+                --d_pendingQoSUpdates;
+            }
+            else if (!d_consumers.empty()) {
                 // we've restarted, we already have a callback so can declare
                 // consumer
                 restartConsumers();
@@ -523,11 +1128,21 @@ void ReceiveChannel::processBasicMethod(const rmqamqpt::BasicMethod& basic)
             }
         } break;
         case rmqamqpt::BasicCancel::METHOD_ID: {
-            if (d_consumer &&
-                d_consumer->consumerTag() ==
-                    basic.the<rmqamqpt::BasicCancel>().consumerTag()) {
+            Consumers::iterator it = findConsumer(
+                basic.the<rmqamqpt::BasicCancel>().consumerTag());
+            if (it != d_consumers.end() && d_shared) {
+                // Reopening the channel would restart the other consumers
+                // too, and fail them all if the queue was deleted
+                BALL_LOG_WARN << "Consumer cancelled by broker, removing it "
+                                 "from the shared channel: "
+                              << (*it)->consumerTag();
+                (*it)->cancelled(
+                    rmqt::Result<>("Consumer cancelled by broker"));
+                d_consumers.erase(it);
+            }
+            else if (it != d_consumers.end()) {
                 BALL_LOG_WARN << "Consumer cancelled by broker: "
-                              << d_consumer->consumerTag();
+                              << (*it)->consumerTag();
                 close(rmqamqpt::Constants::REPLY_SUCCESS,
                       "Closing Channel due to consumer cancel");
             }
@@ -537,14 +1152,14 @@ void ReceiveChannel::processBasicMethod(const rmqamqpt::BasicMethod& basic)
             }
         } break;
         case rmqamqpt::BasicCancelOk::METHOD_ID: {
-            if (d_consumer &&
-                d_consumer->consumerTag() ==
-                    basic.the<rmqamqpt::BasicCancelOk>().consumerTag()) {
-                d_consumer->cancelOk();
-                BALL_LOG_INFO << "Stopping Consumer: "
-                              << d_consumer->consumerTag();
-                d_consumer.reset();
-                if (d_cancelFuturePair) {
+            Consumers::iterator it = findConsumer(
+                basic.the<rmqamqpt::BasicCancelOk>().consumerTag());
+            if (it != d_consumers.end()) {
+                (*it)->cancelOk();
+                BALL_LOG_INFO << "Stopping Consumer: " << (*it)->consumerTag();
+                (*it)->cancelled(rmqt::Result<>());
+                d_consumers.erase(it);
+                if (d_cancelFuturePair && d_consumers.empty()) {
                     d_cancelFuturePair->first(rmqt::Result<>());
                     d_cancelFuturePair.reset();
                 }
@@ -566,23 +1181,46 @@ void ReceiveChannel::processBasicMethod(const rmqamqpt::BasicMethod& basic)
 
 void ReceiveChannel::processMessage(const rmqt::Message& message)
 {
-    if (!d_nextMessage) {
+    if (!d_expectingContent) {
         BALL_LOG_ERROR << "Unexpected Content";
         close(rmqamqpt::Constants::UNEXPECTED_FRAME, "Expected BasicDeliver");
     }
     else {
-        if (!d_messageStore.insert(d_nextMessage->deliveryTag(), message)) {
+        // No-ack deliveries are never acked, so nothing is kept for them and
+        // they are never counted as hung
+        if (!d_consumerConfig.noAck() &&
+            !d_messageStore.insert(d_nextMessage.deliveryTag(), message)) {
             close(rmqamqpt::Constants::NOT_ALLOWED, "Duplicate DeliveryTag");
         }
         else {
-            if (d_consumer &&
-                d_consumer->consumerTag() == d_nextMessage->consumerTag()) {
+            if (!d_consumerConfig.noAck()) {
+                holdBytes(message.payloadSize());
+            }
+
+            Consumers::iterator it =
+                findConsumer(d_nextMessage.consumerTag());
+            if (it != d_consumers.end()) {
 
-                d_metricPublisher->publishCounter(
-                    "received_messages", 1, d_vhostTags);
+                d_receivedMessagesMetric.add(1);
+                ++d_messagesIn;
+                d_bytesIn += message.payloadSize();
+                d_lastDeliveryTime = rmqio::CoarseClock::utc();
 
-                d_consumer->process(message, *d_nextMessage, lifetimeId());
-                d_nextMessage.reset();
+                if (d_shared && !d_consumerConfig.noAck()) {
+                    d_deliveredTo[d_nextMessage.deliveryTag()] = *it;
+                    (*it)->delivered();
+                }
+
+                // The callback may cancel the consumer, erasing it
+                const bsl::shared_ptr<Consumer> consumer = *it;
+                d_expectingContent = false;
+                if (consumer->isReleased()) {
+                    // Delivered before the broker saw the cancel
+                    nackDeliveries(consumer->consumerTag(), true);
+                }
+                else {
+                    consumer->process(message, d_nextMessage, lifetimeId());
+                }
             }
             else {
                 close(rmqamqpt::Constants::NOT_FOUND, "Invalid ConsumerTag");
@@ -593,20 +1231,67 @@ void ReceiveChannel::processMessage(const rmqt::Message& message)
 
 void ReceiveChannel::restartConsumers()
 {
-    if (d_consumer) {
-        bsl::optional<rmqamqpt::BasicMethod> method =
-            d_consumer->consume(d_consumerConfig);
-        if (method) {
-            d_hungProgressTimer->reset(
-                bsls::TimeInterval(Channel::k_HUNG_CHANNEL_TIMER_SEC));
-            writeMessage(Message(rmqamqpt::Method(method.value())),
-                         AWAITING_REPLY);
+    for (Consumers::iterator it = d_consumers.begin();
+         it != d_consumers.end();
+         ++it) {
+        // Consumers started with a pipelined channel.open are awaiting
+        // their consume-ok already
+        if (!(*it)->isStarting()) {
+            startConsumer(**it);
         }
-        else {
-            BALL_LOG_WARN << "Consumer does not want to be restarted. Queue: "
-                          << d_consumer->queueName();
+    }
+}
+
+void ReceiveChannel::startConsumer(Consumer& consumer)
+{
+    bsl::optional<rmqamqpt::BasicMethod> method =
+        consumer.consume(d_consumerConfig);
+    if (method) {
+        d_hungProgressTimer->reset(
+            bsls::TimeInterval(Channel::k_HUNG_CHANNEL_TIMER_SEC));
+        writeMessage(Message(rmqamqpt::Method(method.value())),
+                     AWAITING_REPLY);
+    }
+    else {
+        BALL_LOG_WARN << "Consumer does not want to be restarted. Queue: "
+                      << consumer.queueName();
+    }
+}
+
+bool ReceiveChannel::awaitingConsumeOk() const
+{
+    for (Consumers::const_iterator it = d_consumers.begin();
+         it != d_consumers.end();
+         ++it) {
+        if ((*it)->isStarting()) {
+            return true;
         }
     }
+    return false;
+}
+
+void ReceiveChannel::settleDeliveries(uint64_t deliveryTag, bool multiple)
+{
+    DeliveryMap::iterator end = d_deliveredTo.upper_bound(deliveryTag);
+    DeliveryMap::iterator it =
+        multiple ? d_deliveredTo.begin() : d_deliveredTo.find(deliveryTag);
+    if (it == d_deliveredTo.end()) {
+        return;
+    }
+    if (!multiple) {
+        end = it;
+        ++end;
+    }
+
+    // Erased first, so a consumer drained by `settled` is not visited again
+    bsl::vector<bsl::shared_ptr<Consumer> > consumers;
+    for (DeliveryMap::iterator settled = it; settled != end; ++settled) {
+        consumers.push_back(settled->second);
+    }
+    d_deliveredTo.erase(it, end);
+    for (bsl::size_t i = 0; i < consumers.size(); ++i) {
+        consumers[i]->settled();
+    }
 }
 
 void ReceiveChannel::invalidConsumerError(const bsl::string& consumerTag)
@@ -630,10 +1315,229 @@ void ReceiveChannel::removeSingleMessageFromStore(uint64_t deliveryTag)
         return;
     }
 
-    d_metricPublisher->publishDistribution(
-        "acknowledge_latency",
-        (bdlt::CurrentTime::utc() - insertTime).totalSecondsAsDouble(),
-        d_vhostTags);
+    recordAckLatency(insertTime);
+    releaseBudget(msg.payloadSize());
+    advanceSlowStart(1);
+}
+
+void ReceiveChannel::recordAckLatency(const bdlt::Datetime& insertTime)
+{
+    const bdlt::DatetimeInterval latency =
+        rmqio::CoarseClock::utc() - insertTime;
+
+    d_acknowledgeLatencyMetric.record(latency.totalSecondsAsDouble());
+
+    if (d_prefetchController) {
+        d_prefetchController->onAck(latency.totalSecondsAsDouble());
+    }
+}
+
+void ReceiveChannel::enableAdaptivePrefetch(rmqio::TimerFactory& timerFactory)
+{
+    using bdlf::PlaceHolders::_1;
+
+    d_prefetchController =
+        bslma::ManagedPtrUtil::makeManaged<PrefetchController>(
+            d_consumerConfig.prefetchCount(),
+            d_consumerConfig.minPrefetchCount(),
+            d_consumerConfig.maxPrefetchCount());
+    d_consumerConfig.setPrefetchCount(d_prefetchController->prefetch());
+
+    d_ackQueue->enableCallbackTiming();
+
+    d_prefetchTimer = timerFactory.createWithCallback(bdlf::BindUtil::bind(
+        &ReceiveChannel::onPrefetchTimer, weak_from_this(), _1));
+    d_prefetchTimer->reset(k_PREFETCH_EVALUATION_INTERVAL);
+}
+
+void ReceiveChannel::onPrefetchTimer(const bsl::weak_ptr<Channel>& weakSelf,
+                                     rmqio::Timer::InterruptReason reason)
+{
+    if (reason != rmqio::Timer::EXPIRE) {
+        return;
+    }
+
+    bsl::shared_ptr<Channel> self = weakSelf.lock();
+    if (self) {
+        bsl::shared_ptr<ReceiveChannel> receiveChannel =
+            bsl::static_pointer_cast<ReceiveChannel>(self);
+        receiveChannel->adjustPrefetch();
+        receiveChannel->d_prefetchTimer->reset(
+            k_PREFETCH_EVALUATION_INTERVAL);
+    }
+}
+
+void ReceiveChannel::adjustPrefetch()
+{
+    bsls::Types::Int64 callbackNanos    = 0;
+    bsls::Types::Int64 callbackMessages = 0;
+    d_ackQueue->takeCallbackTimes(&callbackNanos, &callbackMessages);
+
+    const double callbackSeconds =
+        callbackMessages > 0
+            ? static_cast<double>(callbackNanos) / callbackMessages / 1e9
+            : 0;
+
+    const rmqt::ConsumerConfig::SaturationFunc& saturated =
+        d_consumerConfig.saturationProbe();
+
+    bsl::optional<uint16_t> prefetch = d_prefetchController->evaluate(
+        callbackSeconds, saturated && saturated());
+    if (!prefetch) {
+        return;
+    }
+
+    BALL_LOG_INFO << "Adjusting prefetch count from "
+                  << d_consumerConfig.prefetchCount() << " to "
+                  << prefetch.value() << " on " << channelDebugName();
+
+    // Also used when the channel reopens
+    const uint16_t previous = effectivePrefetch();
+    d_consumerConfig.setPrefetchCount(prefetch.value());
+    d_metricPublisher->publishGauge(
+        "prefetch_count", prefetch.value(), d_vhostTags);
+
+    refreshPrefetch(previous);
+}
+
+void ReceiveChannel::updatePrefetch(uint16_t prefetch)
+{
+    if (state() == READY) {
+        ++d_pendingQoSUpdates;
+        writeMessage(Message(rmqamqpt::Method(rmqamqpt::BasicMethod(
+                         rmqamqpt::BasicQoS(prefetch, 0, d_shared)))),
+                     &noopWriteHandler);
+    }
+}
+
+uint16_t ReceiveChannel::effectivePrefetch() const
+{
+    // A prefetch count of 0 would lift the limit altogether
+    if (d_budgetThrottled || d_bytesThrottled) {
+        return 1;
+    }
+    const uint16_t prefetch = d_consumerConfig.prefetchCount();
+    return d_slowStartPrefetch && (!prefetch || d_slowStartPrefetch < prefetch)
+               ? d_slowStartPrefetch
+               : prefetch;
+}
+
+void ReceiveChannel::restartSlowStart()
+{
+    const uint16_t initial  = d_consumerConfig.slowStartPrefetchCount();
+    const uint16_t prefetch = d_consumerConfig.prefetchCount();
+
+    d_slowStartPrefetch = !prefetch || initial < prefetch ? initial : 0;
+    d_slowStartAcks     = 0;
+}
+
+void ReceiveChannel::advanceSlowStart(bsl::size_t acked)
+{
+    if (!d_slowStartPrefetch) {
+        return;
+    }
+
+    d_slowStartAcks += acked;
+    if (d_slowStartAcks < d_slowStartPrefetch) {
+        return;
+    }
+
+    const uint16_t previous = effectivePrefetch();
+    const uint16_t prefetch = d_consumerConfig.prefetchCount();
+    d_slowStartAcks         = 0;
+    if (d_slowStartPrefetch > bsl::numeric_limits<uint16_t>::max() / 2 ||
+        (prefetch && d_slowStartPrefetch * 2 >= prefetch)) {
+        BALL_LOG_INFO << "Slow start complete, prefetch count " << prefetch
+                      << " on " << channelDebugName();
+        d_slowStartPrefetch = 0;
+    }
+    else {
+        d_slowStartPrefetch *= 2;
+        BALL_LOG_DEBUG << "Slow start raising prefetch count to "
+                       << d_slowStartPrefetch << " on " << channelDebugName();
+    }
+
+    refreshPrefetch(previous);
+}
+
+void ReceiveChannel::refreshPrefetch(uint16_t previous)
+{
+    if (effectivePrefetch() != previous) {
+        updatePrefetch(effectivePrefetch());
+    }
+}
+
+void ReceiveChannel::holdBytes(bsl::size_t bytes)
+{
+    const uint16_t previous = effectivePrefetch();
+    d_budgetBytes += bytes;
+
+    if (d_memoryBudget) {
+        d_memoryBudget->acquire(bytes);
+        if (!d_budgetThrottled && d_memoryBudget->exhausted()) {
+            BALL_LOG_WARN << "Memory budget exhausted, dropping prefetch "
+                             "count to 1 on "
+                          << channelDebugName();
+            d_budgetThrottled = true;
+        }
+    }
+
+    const bsl::size_t prefetchBytes = d_consumerConfig.prefetchBytes();
+    if (prefetchBytes && !d_bytesThrottled && d_budgetBytes >= prefetchBytes) {
+        BALL_LOG_DEBUG << d_budgetBytes << " bytes unacked, pausing "
+                       << "deliveries on " << channelDebugName();
+        d_bytesThrottled = true;
+    }
+
+    refreshPrefetch(previous);
+}
+
+void ReceiveChannel::setMemoryBudget(
+    const bsl::shared_ptr<MemoryBudget>& budget)
+{
+    d_memoryBudget = budget;
+}
+
+void ReceiveChannel::releaseBudget(bsl::size_t bytes)
+{
+    const uint16_t previous = effectivePrefetch();
+    bytes                   = bsl::min(bytes, d_budgetBytes);
+    d_budgetBytes -= bytes;
+
+    // Checked as this channel's own deliveries are acked: with a prefetch
+    // count of 1 it keeps receiving, so it notices room freed by others too
+    if (d_memoryBudget) {
+        d_memoryBudget->release(bytes);
+        if (d_budgetThrottled && !d_memoryBudget->exhausted()) {
+            BALL_LOG_INFO << "Memory budget has room, restoring prefetch "
+                          << "count " << d_consumerConfig.prefetchCount()
+                          << " on " << channelDebugName();
+            d_budgetThrottled = false;
+        }
+    }
+
+    if (d_bytesThrottled && d_budgetBytes < d_consumerConfig.prefetchBytes()) {
+        BALL_LOG_DEBUG << d_budgetBytes << " bytes unacked, resuming "
+                       << "deliveries on " << channelDebugName();
+        d_bytesThrottled = false;
+    }
+
+    refreshPrefetch(previous);
+}
+
+void ReceiveChannel::publishInlineCallbackTime(double seconds)
+{
+    d_inlineCallbackMetric.record(seconds);
+}
+
+MetricAggregator::Distribution
+ReceiveChannel::deliveryLatencyMetric(const bsl::string& queueName) const
+{
+    MetricAggregator::Tags tags(d_vhostTags);
+    tags.push_back(bsl::pair<bsl::string, bsl::string>(Metrics::QUEUE_TAG,
+                                                       queueName));
+    return MetricAggregator::distribution(
+        d_metricPublisher, "publish_to_deliver_latency", tags);
 }
 
 void ReceiveChannel::removeMultipleMessagesFromStore(uint64_t deliveryTag)
@@ -641,16 +1545,16 @@ void ReceiveChannel::removeMultipleMessagesFromStore(uint64_t deliveryTag)
     MessageStore<rmqt::Message>::MessageList removedMessages =
         d_messageStore.removeUntil(deliveryTag);
 
+    bsl::size_t bytes = 0;
     for (MessageStore<rmqt::Message>::MessageList::iterator it =
              removedMessages.begin();
          it != removedMessages.end();
          it++) {
-        bdlt::Datetime insertTime = it->second.second;
-        d_metricPublisher->publishDistribution(
-            "acknowledge_latency",
-            (bdlt::CurrentTime::utc() - insertTime).totalSecondsAsDouble(),
-            d_vhostTags);
+        recordAckLatency(it->second.second);
+        bytes += it->second.first.payloadSize();
     }
+    releaseBudget(bytes);
+    advanceSlowStart(removedMessages.size());
 }
 
 void ReceiveChannel::removeMessagesFromStore(uint64_t deliveryTag,
@@ -687,6 +1591,11 @@ void ReceiveChannel::sendAckOrNack(const rmqamqpt::BasicMethod& basicMethod,
                                    uint64_t deliveryTag,
                                    bool multiple)
 {
+    if (d_shared) {
+        // Settled once sent, so a released consumer's deliveries are not
+        // requeued after their ack is already on its way
+        settleDeliveries(deliveryTag, multiple);
+    }
     writeMessage(Message(rmqamqpt::Method(basicMethod)),
                  bdlf::BindUtil::bind(&ReceiveChannel::removeMessagesFromStore,
                                       this,
@@ -697,11 +1606,20 @@ void ReceiveChannel::sendAckOrNack(const rmqamqpt::BasicMethod& basicMethod,
 void ReceiveChannel::processFailures()
 {
     const size_t nFailedMsg = d_messageStore.count();
-    MessageStore<rmqt::Message> failures;
+    RingMessageStore<rmqt::Message> failures;
 
     // This increments the d_messageStore lifetime which is critical
     // for ensuring stale delivered message ack/nacks are ignored
     d_messageStore.swap(failures);
+    releaseBudget(d_budgetBytes);
+
+    for (DeliveryMap::iterator it = d_deliveredTo.begin();
+         it != d_deliveredTo.end();
+         ++it) {
+        it->second->drained(
+            rmqt::Result<>("ReceiveChannel reset before it was Fully Drained"));
+    }
+    d_deliveredTo.clear();
 
     if (nFailedMsg > 0) {
         BALL_LOG_INFO
@@ -713,20 +1631,73 @@ void ReceiveChannel::processFailures()
 
 const char* ReceiveChannel::channelType() const { return "Consumer"; }
 
+bsl::vector<bsl::pair<bsl::string, bsl::string> >
+ReceiveChannel::channelMetricTags() const
+{
+    // A shared channel consumes from several queues
+    bsl::set<bsl::string> queues;
+    for (Consumers::const_iterator it = d_consumers.begin();
+         it != d_consumers.end();
+         ++it) {
+        queues.insert((*it)->queueName());
+    }
+
+    bsl::string queueNames;
+    for (bsl::set<bsl::string>::const_iterator it = queues.begin();
+         it != queues.end();
+         ++it) {
+        if (!queueNames.empty()) {
+            queueNames += ",";
+        }
+        queueNames += *it;
+    }
+
+    bsl::vector<bsl::pair<bsl::string, bsl::string> > tags(d_vhostTags);
+    tags.push_back(
+        bsl::pair<bsl::string, bsl::string>(Metrics::QUEUE_TAG, queueNames));
+    return tags;
+}
+
+void ReceiveChannel::publishChannelMetrics()
+{
+    Channel::publishChannelMetrics();
+
+    if (d_lastDeliveryTime) {
+        d_metricPublisher->publishGauge(
+            "channel_seconds_since_delivery",
+            (rmqio::CoarseClock::utc() - *d_lastDeliveryTime)
+                .totalSecondsAsDouble(),
+            channelMetricTags());
+    }
+}
+
 bsl::string ReceiveChannel::channelDebugName() const
 {
     bsl::string consumerSummary;
-    if (d_consumer) {
-        consumerSummary = "Queue: " + d_consumer->queueName() +
-                          " Consumer Tag: " + d_consumer->consumerTag() + " ";
+    if (d_consumers.size() == 1) {
+        const Consumer& consumer = *d_consumers.front();
+        consumerSummary = "Queue: " + consumer.queueName() +
+                          " Consumer Tag: " + consumer.consumerTag() + " ";
     }
-    else {
+    else if (d_consumers.empty()) {
         consumerSummary = "No Consumer ";
     }
+    else {
+        consumerSummary = bsl::to_string(d_consumers.size()) + " Consumers ";
+    }
 
     return "Consumer Channel: " + consumerSummary + bsl::to_string(inFlight()) +
            " in-flight messages";
 }
 
+void ReceiveChannel::loadStats(rmqt::ChannelStats* stats) const
+{
+    Channel::loadStats(stats);
+    stats->type              = rmqt::ChannelStats::CONSUMER;
+    stats->messagesIn        = d_messagesIn;
+    stats->bytesIn           = d_bytesIn;
+    stats->unackedDeliveries = inFlight();
+}
+
 } // namespace rmqamqp
 } // namespace BloombergLP
@@ -31,11 +31,18 @@
 
 // Includes
 #include <rmqamqp_channel.h>
+#include <rmqamqp_memorybudget.h>
 #include <rmqamqp_message.h>
 #include <rmqamqp_messagestore.h>
+#include <rmqamqp_metricaggregator.h>
 #include <rmqamqp_multipleackhandler.h>
+#include <rmqamqp_prefetchcontroller.h>
+#include <rmqamqp_ringmessagestore.h>
+#include <rmqamqpt_basicdeliver.h>
 #include <rmqio_serializedframe.h>
-#include <rmqt_consumerackbatch.h>
+#include <rmqio_timer.h>
+#include <rmqt_consumerack.h>
+#include <rmqt_consumerackqueue.h>
 #include <rmqt_consumerconfig.h>
 #include <rmqt_envelope.h>
 #include <rmqt_future.h>
@@ -43,10 +50,17 @@
 #include <rmqt_result.h>
 #include <rmqt_topology.h>
 
+#include <bdlt_datetime.h>
+
 #include <bsl_functional.h>
+#include <bsl_map.h>
 #include <bsl_memory.h>
+#include <bsl_optional.h>
 #include <bsl_unordered_map.h>
+#include <bsl_unordered_set.h>
+#include <bsl_vector.h>
 #include <bsls_keyword.h>
+#include <bsls_types.h>
 
 namespace BloombergLP {
 namespace rmqamqp {
@@ -82,6 +96,8 @@ class ReceiveChannel : public Channel {
     /// validates the queue handle references a queue in the channel topology,
     // starts the consumer (basic.consume) on that queue, with consumer tag
     // passed in, to the MessageCallback, sets the channel QoS to prefetch value
+    // Only a shared channel, see `shareBetweenConsumers`, takes more than
+    // one consumer; each needs its own consumer tag.
     virtual rmqt::Result<> consume(const rmqt::QueueHandle&,
                                    const MessageCallback& onNewMessage,
                                    const bsl::string& consumerTag = "");
@@ -90,18 +106,70 @@ class ReceiveChannel : public Channel {
 
     virtual void consumeAckBatchFromQueue();
 
+    /// Let further consumers `consume` on this channel, delivering to each
+    /// by consumer tag. The prefetch count then limits the unacked
+    /// deliveries of the channel as a whole (basic.qos global) rather than
+    /// of each consumer. Must be called before the first consumer starts.
+    void shareBetweenConsumers();
+
+    /// Return true if any consumer on the channel is active
     virtual bool consumerIsActive() const;
 
-    /// Cancels the active consumer on the channel
+    /// Publish `message` to `exchange` on this channel, without publisher
+    /// confirms: e.g. an RPC request whose `replyTo` is this channel's
+    /// consumer of `amq.rabbitmq.reply-to`. The broker refuses such a
+    /// request until the consumer is confirmed, so publishes made while it
+    /// is starting are held until then, and dropped if the channel resets
+    /// first. Return an error if no consumer is started.
+    virtual rmqt::Result<> publish(const rmqt::Message& message,
+                                   const bsl::string& exchange,
+                                   const bsl::string& routingKey);
+
+    /// Cancels the active consumers on the channel
     /// returns Future that will resolve when CancelOk received from server
+    /// for all of them
     virtual rmqt::Future<> cancel();
 
+    /// Cancel the consumer `consumerTag`, leaving any others on a shared
+    /// channel consuming. Return a Future resolved when its CancelOk is
+    /// received from the server.
+    virtual rmqt::Future<> cancelConsumer(const bsl::string& consumerTag);
+
+    /// Cancel the consumer `consumerTag` of a shared channel, whose callback
+    /// is gone, and requeue every message delivered to it which it has not
+    /// acked: those outstanding now, and those delivered before its
+    /// CancelOk arrives
+    virtual void releaseConsumer(const bsl::string& consumerTag);
+
+    /// Nack every delivery not yet acked with a single basic.nack, after
+    /// sending the acks already queued, requeueing them if `requeue`. Acks
+    /// for them which arrive later are ignored. Return a resolved Future.
+    virtual rmqt::Future<> nackAllOutstanding(bool requeue);
+
+    /// As `nackAllOutstanding`, for the deliveries to the consumer
+    /// `consumerTag` of a shared channel. Contiguous runs of them are nacked
+    /// as multiple nacks.
+    virtual rmqt::Future<>
+    nackConsumerDeliveries(const bsl::string& consumerTag, bool requeue);
+
+    /// Ack the delivery `envelope` and every earlier one not acked yet, with
+    /// a single basic.ack, after sending the acks already queued. On a
+    /// shared channel only the deliveries to the consumer of `envelope` are
+    /// acked, as multiple acks of their contiguous runs. Acks and nacks for
+    /// them which arrive later are ignored. Return a Future resolved with an
+    /// error if the channel has closed since `envelope` was delivered.
+    virtual rmqt::Future<> ackThrough(const rmqt::Envelope& envelope);
+
     /// If the channel is in a cancelled state, waits for number of the
     /// messages in the message store to reach 0 before resolving the future,
     /// if the channel is not in a cancelled state then the Future will resolve
     /// immediately with an error result
     virtual rmqt::Future<> drain();
 
+    /// As `drain`, for the cancelled consumer `consumerTag` of a shared
+    /// channel: waits only for the messages delivered to that consumer
+    virtual rmqt::Future<> drainConsumer(const bsl::string& consumerTag);
+
     size_t inFlight() const BSLS_KEYWORD_OVERRIDE
     {
         return d_messageStore.count();
@@ -112,16 +180,86 @@ class ReceiveChannel : public Channel {
         return d_messageStore.lifetimeId();
     }
 
+    bsl::size_t retainedBytes() const BSLS_KEYWORD_OVERRIDE
+    {
+        return d_messageStore.retainedBytes();
+    }
+
+    void trim() BSLS_KEYWORD_OVERRIDE { d_messageStore.shrinkToFit(); }
+
     bsl::string channelDebugName() const BSLS_KEYWORD_OVERRIDE;
 
+    void loadStats(rmqt::ChannelStats* stats) const BSLS_KEYWORD_OVERRIDE;
+
+    /// Also publishes the seconds since the last delivery
+    void publishChannelMetrics() BSLS_KEYWORD_OVERRIDE;
+
     virtual MessageStore<rmqt::Message>::MessageList
     getMessagesOlderThan(const bdlt::Datetime& cutoffTime) const;
 
+    /// Visit the outstanding messages delivered at or before `cutoffTime`,
+    /// oldest first, without copying them. Return the number visited.
+    virtual bsl::size_t visitMessagesOlderThan(
+        const bdlt::Datetime& cutoffTime,
+        const MessageStore<rmqt::Message>::MessageVisitor& visitor) const;
+
+    /// Visit the outstanding messages which became older than `cutoffTime`
+    /// since the last call, oldest first. Return the number of outstanding
+    /// messages older than `cutoffTime`, see `RingMessageStore::updateHung`.
+    /// Must be called on the event loop thread.
+    virtual bsl::size_t visitNewlyHungMessages(
+        const bdlt::Datetime& cutoffTime,
+        const MessageStore<rmqt::Message>::MessageVisitor& visitor);
+
+    /// Return true to requeue a delivery past its ack deadline
+    typedef bsl::function<bool(const MessageStore<rmqt::Message>::Entry&)>
+        ExpiryFilter;
+
+    /// Nack, requeueing, every delivery made at or before `cutoffTime` not
+    /// acked or nacked yet, for which `filter`, if set, returns true. Acks
+    /// and nacks for them which arrive later are ignored. Return the number
+    /// requeued. Must be called on the event loop thread.
+    virtual bsl::size_t
+    requeueMessagesOlderThan(const bdlt::Datetime& cutoffTime,
+                             const ExpiryFilter& filter = ExpiryFilter());
+
+    /// Hold acks for up to `ConsumerConfig::ackCoalescingDelay` and send
+    /// them as multiple acks, see `MultipleAckHandler::setCoalescing`.
+    /// \param timerFactory Creates the timer which flushes held acks
+    void enableAckCoalescing(rmqio::TimerFactory& timerFactory);
+
+    /// Adapt the prefetch count within the bounds set by
+    /// `ConsumerConfig::setMinPrefetchCount` and `setMaxPrefetchCount`,
+    /// re-issuing basic.qos as it changes, see `PrefetchController`.
+    /// \param timerFactory Creates the timer which reconsiders the count
+    void enableAdaptivePrefetch(rmqio::TimerFactory& timerFactory);
+
+    /// Count the payloads of unacked deliveries against `budget`, dropping
+    /// the prefetch count to 1 while it is exhausted
+    void setMemoryBudget(const bsl::shared_ptr<MemoryBudget>& budget);
+
+    /// Flushes held acks before closing
+    void gracefulClose() BSLS_KEYWORD_OVERRIDE;
+
+    /// Publish the time a consumer callback run on the event loop thread
+    /// held it up, see `rmqt::ConsumerDispatch::EVENT_LOOP`
+    void publishInlineCallbackTime(double seconds);
+
+    /// Return a handle for the `publish_to_deliver_latency` distribution of
+    /// messages consumed from `queueName`, tagged with it and the vhost
+    MetricAggregator::Distribution
+    deliveryLatencyMetric(const bsl::string& queueName) const;
+
   protected:
     void onOpen() BSLS_KEYWORD_OVERRIDE;
+    bool appendSetupMethods(bsl::vector<Message>* methods)
+        BSLS_KEYWORD_OVERRIDE;
 
   private:
     class Consumer;
+    typedef bsl::vector<bsl::shared_ptr<Consumer> > Consumers;
+    typedef bsl::map<uint64_t, bsl::shared_ptr<Consumer> > DeliveryMap;
+
     void processBasicMethod(const rmqamqpt::BasicMethod& basic)
         BSLS_KEYWORD_OVERRIDE;
     void processMessage(const rmqt::Message& message) BSLS_KEYWORD_OVERRIDE;
@@ -129,11 +267,68 @@ class ReceiveChannel : public Channel {
     void onReset() BSLS_KEYWORD_OVERRIDE;
     void processFailures() BSLS_KEYWORD_OVERRIDE;
     void restartConsumers();
+    void startConsumer(Consumer& consumer);
+    void sendCancel(Consumer& consumer);
+    Consumers::iterator findConsumer(const bsl::string& consumerTag);
+
+    /// Return true if a consumer is waiting for its ConsumeOk
+    bool awaitingConsumeOk() const;
+
+    /// Count the delivery `deliveryTag`, and every earlier one if
+    /// `multiple`, as acked by its consumer, on a shared channel
+    void settleDeliveries(uint64_t deliveryTag, bool multiple);
+
+    /// Nack every unacked delivery to the consumer `consumerTag`,
+    /// requeueing them if `requeue`. Return the number nacked.
+    bsl::size_t nackDeliveries(const bsl::string& consumerTag, bool requeue);
     void invalidConsumerError(const bsl::string& consumerTag);
     void removeSingleMessageFromStore(uint64_t deliveryTag);
     void removeMultipleMessagesFromStore(uint64_t deliveryTag);
     void removeMessagesFromStore(uint64_t deliveryTag, bool multiple);
     void sendAck(uint64_t deliveryTag, bool multiple = false);
+
+    /// Send any acks held for coalescing
+    void flushHeldAcks();
+
+    void recordAckLatency(const bdlt::Datetime& insertTime);
+
+    void adjustPrefetch();
+
+    /// Send basic.qos for `prefetch` if the channel is READY, otherwise it
+    /// is sent when the channel reopens
+    void updatePrefetch(uint16_t prefetch);
+
+    /// The prefetch count to ask for: 1 while the memory budget is
+    /// exhausted or the prefetch bytes are held, otherwise the configured
+    /// count
+    uint16_t effectivePrefetch() const;
+
+    /// Start ramping the prefetch count up from
+    /// `ConsumerConfig::slowStartPrefetchCount`, if set below the prefetch
+    /// count
+    void restartSlowStart();
+
+    /// Account for `acked` more messages acked during slow start, doubling
+    /// the slow start prefetch count once a full window of them is acked
+    void advanceSlowStart(bsl::size_t acked);
+
+    /// Send basic.qos if the prefetch count to ask for is no longer
+    /// `previous`
+    void refreshPrefetch(uint16_t previous);
+
+    /// Count `bytes` of a delivery against the memory budget and
+    /// `ConsumerConfig::prefetchBytes`, pausing deliveries if either runs out
+    void holdBytes(bsl::size_t bytes);
+
+    /// Release `bytes` of acked or failed deliveries to the memory budget,
+    /// restoring the prefetch count if there is room again
+    void releaseBudget(bsl::size_t bytes);
+
+    static void onPrefetchTimer(const bsl::weak_ptr<Channel>& weakSelf,
+                                rmqio::Timer::InterruptReason reason);
+
+    static void onAckFlushTimer(const bsl::weak_ptr<Channel>& weakSelf,
+                                rmqio::Timer::InterruptReason reason);
     void
     sendNack(uint64_t deliveryTag, bool requeue = true, bool multiple = false);
     void sendAckOrNack(const rmqamqpt::BasicMethod& basicMethod,
@@ -142,18 +337,78 @@ class ReceiveChannel : public Channel {
 
     const char* channelType() const BSLS_KEYWORD_OVERRIDE;
 
+    /// The vhost tag, and the queue tag naming the queues consumed from
+    bsl::vector<bsl::pair<bsl::string, bsl::string> >
+    channelMetricTags() const BSLS_KEYWORD_OVERRIDE;
+
   private:
     ReceiveChannel(const ReceiveChannel& copy) BSLS_KEYWORD_DELETED;
     ReceiveChannel& operator=(const ReceiveChannel&) BSLS_KEYWORD_DELETED;
 
     rmqt::ConsumerConfig d_consumerConfig;
-    bsl::shared_ptr<Consumer> d_consumer;
-    bslma::ManagedPtr<rmqamqpt::BasicDeliver> d_nextMessage;
-    rmqamqp::MessageStore<rmqt::Message> d_messageStore;
+    Consumers d_consumers;
+
+    /// Set by `shareBetweenConsumers`
+    bool d_shared;
+
+    /// The consumer each delivery not yet acked went to, on a shared
+    /// channel. It keeps cancelled consumers around until they have drained.
+    DeliveryMap d_deliveredTo;
+
+    /// Deliveries requeued by `requeueMessagesOlderThan`, whose late acks
+    /// and nacks are dropped
+    bsl::unordered_set<uint64_t> d_expiredTags;
+
+    /// Frames of the messages passed to `publish` while the consumer was
+    /// starting
+    bsl::shared_ptr<bsl::vector<Message> > d_heldPublishes;
+
+    /// The basic.deliver of the message whose content is expected next, if
+    /// `d_expectingContent`. Assigned in place, re-using its strings'
+    /// capacity, rather than allocated per delivery.
+    rmqamqpt::BasicDeliver d_nextMessage;
+    bool d_expectingContent;
+
+    rmqamqp::RingMessageStore<rmqt::Message> d_messageStore;
     bsl::shared_ptr<rmqt::ConsumerAckQueue> d_ackQueue;
+    bsl::vector<rmqt::ConsumerAck> d_pendingAcks;
     MultipleAckHandler d_multipleAckHandler;
+
+    /// Set when acks are coalesced, see `enableAckCoalescing`
+    bsl::shared_ptr<rmqio::Timer> d_ackFlushTimer;
+    bool d_ackFlushArmed;
+
+    /// Set when the prefetch count adapts, see `enableAdaptivePrefetch`
+    bslma::ManagedPtr<PrefetchController> d_prefetchController;
+    bsl::shared_ptr<rmqio::Timer> d_prefetchTimer;
+
+    /// Set by `setMemoryBudget`
+    bsl::shared_ptr<MemoryBudget> d_memoryBudget;
+    /// The payload bytes of deliveries not yet acked
+    bsl::size_t d_budgetBytes;
+    bool d_budgetThrottled;
+    /// Set while `d_budgetBytes` is up to `ConsumerConfig::prefetchBytes`
+    bool d_bytesThrottled;
+
+    /// The prefetch count ramping up after the channel (re)opened, 0 once
+    /// slow start is over, and the acks counted towards its next doubling
+    uint16_t d_slowStartPrefetch;
+    bsl::size_t d_slowStartAcks;
+
+    /// Replies still to come for basic.qos updates sent while READY
+    bsl::size_t d_pendingQoSUpdates;
     bslma::ManagedPtr<rmqt::Future<>::Pair> d_cancelFuturePair;
     bslma::ManagedPtr<rmqt::Future<>::Maker> d_drainFuture;
+
+    // Registered once, so receiving a message does not build metric names
+    MetricAggregator::Counter d_receivedMessagesMetric;
+    MetricAggregator::Distribution d_acknowledgeLatencyMetric;
+    MetricAggregator::Distribution d_inlineCallbackMetric;
+
+    // Reported by `loadStats`, only touched on the event loop thread
+    bsls::Types::Int64 d_messagesIn;
+    bsls::Types::Int64 d_bytesIn;
+    bsl::optional<bdlt::Datetime> d_lastDeliveryTime;
 };
 
 } // namespace rmqamqp
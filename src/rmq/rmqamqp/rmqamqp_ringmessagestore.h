@@ -0,0 +1,467 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQAMQP_RINGMESSAGESTORE
+#define INCLUDED_RMQAMQP_RINGMESSAGESTORE
+
+#include <rmqio_coarseclock.h>
+
+#include <ball_log.h>
+#include <bdlb_guid.h>
+#include <bdlt_datetime.h>
+#include <bsls_assert.h>
+#include <bsls_keyword.h>
+
+#include <bsl_algorithm.h>
+#include <bsl_cstddef.h>
+#include <bsl_cstdint.h>
+#include <bsl_functional.h>
+#include <bsl_optional.h>
+#include <bsl_utility.h>
+#include <bsl_vector.h>
+
+//@PURPOSE: Store for unacknowledged messages indexed by delivery-tag
+//
+//@CLASSES: rmqamqp::RingMessageStore
+
+namespace BloombergLP {
+namespace rmqamqp {
+
+/// \brief Drop-in alternative to `MessageStore` for dense delivery-tags
+///
+/// Delivery-tags are assigned sequentially for the lifetime of a channel, so
+/// instead of a tree the store keeps a power-of-two ring of slots indexed by
+/// `tag & mask`, covering the tags from the oldest to the newest stored
+/// message. Removed messages leave empty slots (tombstones) until the
+/// oldest/newest bound moves past them. `insert`, `lookup` and `remove` are
+/// O(1), and `removeUntil` is linear in the number of tags it covers.
+///
+/// The ring grows (doubling) to span the oldest to the newest outstanding
+/// tag, so one message left outstanding while many later ones are removed
+/// keeps that span allocated. Looking up by GUID scans the ring; it is used
+/// only for the rare basic.return.
+///
+/// Messages are stored in insertion order, and a message stays hung once it
+/// is old enough, so the store remembers up to which tag messages have been
+/// found hung (`updateHung`) and keeps count of those still outstanding.
+///
+/// `Entry`, `MessageList` and `MessageVisitor` are the same types as
+/// `MessageStore`'s.
+
+template <typename Msg>
+class RingMessageStore {
+  public:
+    typedef bsl::pair<uint64_t, bsl::pair<Msg, bdlt::Datetime> > Entry;
+    typedef bsl::vector<Entry> MessageList;
+    typedef bsl::function<void(uint64_t deliveryTag,
+                               const bsl::pair<Msg, bdlt::Datetime>& message)>
+        MessageVisitor;
+
+    RingMessageStore();
+
+    /// Save the message with delivery-tag in the store
+    /// Return true if the message was inserted in the store, otherwise log the
+    /// error and return false
+    bool insert(uint64_t deliveryTag, const Msg& message);
+
+    /// Search message by delivery-tag in the store
+    /// Return true and set the message argument if successful search
+    bool lookup(uint64_t deliveryTag, Msg* message) const;
+
+    /// Search message by guid in the store, oldest first
+    /// Return true and set the message and deliveryTag arguments, if
+    /// successful search
+    bool
+    lookup(const bdlb::Guid& guid, Msg* message, uint64_t* deliveryTag) const;
+
+    /// Remove message by delivery-tag from the store
+    /// Return true and set the message argument if delivery-tag exists
+    bool remove(uint64_t deliveryTag, Msg* message, bdlt::Datetime* insertTime);
+
+    /// Remove all the messages till specified delivery-tag from the store and
+    /// return those messages
+    MessageList removeUntil(uint64_t deliveryTag);
+
+    void swap(RingMessageStore& messageStore);
+
+    /// Return total messages inside the store
+    bsl::size_t count() const { return d_count; }
+
+    /// Return maximum assigned delivery-tag to any message till now
+    uint64_t latestTagTilNow() const { return d_latestTagTilNow; }
+
+    uint64_t latestTagInStore() const { return d_count ? d_end - 1 : 0; }
+    uint64_t oldestTagInStore() const { return d_count ? d_begin : 0; }
+
+    /// @brief lifetime ID starts at 0 for a MessageStore and increments
+    ///        each time the MessageStore is `swap()`'ed out, which must
+    ///        happen each time the Channel is closed
+    /// @return the current lifetime ID
+    bsl::size_t lifetimeId() const { return d_lifetimeId; }
+
+    /// Return messages older than `time` (absolute time)
+    MessageList getMessagesOlderThan(const bdlt::Datetime& time) const;
+
+    /// Call `visitor` with the delivery-tag, message and insert time of each
+    /// message inserted at or before `time` (absolute time), oldest first,
+    /// without copying them out of the store. Delivery-tags are assigned in
+    /// insertion order, so the scan stops at the first younger message.
+    /// Return the number of messages visited.
+    bsl::size_t visitMessagesOlderThan(const bdlt::Datetime& time,
+                                       const MessageVisitor& visitor) const;
+
+    /// Call `visitor` for each message inserted at or before `time` (absolute
+    /// time) which no earlier call has visited, oldest first, and count it
+    /// as hung until it is removed. Only the messages which became hung
+    /// since the previous call are visited. Return `hungCount()`.
+    bsl::size_t updateHung(const bdlt::Datetime& time,
+                           const MessageVisitor& visitor);
+
+    /// Return the number of outstanding messages found hung by `updateHung`
+    bsl::size_t hungCount() const { return d_hungCount; }
+
+    /// Shrink the ring, grown to span a burst of outstanding messages, to
+    /// the smallest that holds the messages stored now
+    void shrinkToFit();
+
+    /// Bytes the ring holds on to, whether its slots are used or not
+    bsl::size_t retainedBytes() const
+    {
+        return d_slots.capacity() * sizeof(Slot);
+    }
+
+  private:
+    RingMessageStore(const RingMessageStore&) BSLS_KEYWORD_DELETED;
+    RingMessageStore& operator=(const RingMessageStore&) BSLS_KEYWORD_DELETED;
+
+    typedef bsl::optional<bsl::pair<Msg, bdlt::Datetime> > Slot;
+
+    static const bsl::size_t k_INITIAL_CAPACITY = 64;
+
+    Slot& slot(uint64_t deliveryTag) { return d_slots[deliveryTag & d_mask]; }
+    const Slot& slot(uint64_t deliveryTag) const
+    {
+        return d_slots[deliveryTag & d_mask];
+    }
+
+    bool contains(uint64_t deliveryTag) const
+    {
+        return d_count && deliveryTag >= d_begin && deliveryTag < d_end &&
+               slot(deliveryTag).has_value();
+    }
+
+    /// Grow the ring until it can hold tags [begin, end)
+    void reserveSpan(uint64_t begin, uint64_t end);
+
+    /// Move the stored messages into a ring of `capacity` slots, which
+    /// must be a power of two covering the stored tags
+    void rebuild(bsl::size_t capacity);
+
+    /// Move the bounds inwards past removed messages
+    void trim();
+
+    bsl::vector<Slot> d_slots;
+    uint64_t d_mask;
+    uint64_t d_begin;
+    uint64_t d_end;
+    bsl::size_t d_count;
+    uint64_t d_latestTagTilNow;
+    size_t d_lifetimeId;
+    /// Messages before this tag have been visited by `updateHung`
+    uint64_t d_hungEnd;
+    bsl::size_t d_hungCount;
+
+    BALL_LOG_SET_CLASS_CATEGORY("RMQAMQP.RINGMESSAGESTORE");
+}; // class RingMessageStore
+
+template <typename Msg>
+const bsl::size_t RingMessageStore<Msg>::k_INITIAL_CAPACITY;
+
+template <typename Msg>
+RingMessageStore<Msg>::RingMessageStore()
+: d_slots(k_INITIAL_CAPACITY)
+, d_mask(k_INITIAL_CAPACITY - 1)
+, d_begin(0)
+, d_end(0)
+, d_count(0)
+, d_latestTagTilNow(0)
+, d_lifetimeId(0)
+, d_hungEnd(0)
+, d_hungCount(0)
+{
+}
+
+template <typename Msg>
+void RingMessageStore<Msg>::reserveSpan(uint64_t begin, uint64_t end)
+{
+    bsl::size_t capacity = d_slots.size();
+    if (end - begin <= capacity) {
+        return;
+    }
+    while (end - begin > capacity) {
+        capacity *= 2;
+    }
+    rebuild(capacity);
+}
+
+template <typename Msg>
+void RingMessageStore<Msg>::shrinkToFit()
+{
+    const uint64_t span  = d_count ? d_end - d_begin : 0;
+    bsl::size_t capacity = k_INITIAL_CAPACITY;
+    while (span > capacity) {
+        capacity *= 2;
+    }
+    if (capacity < d_slots.size()) {
+        rebuild(capacity);
+    }
+}
+
+template <typename Msg>
+void RingMessageStore<Msg>::rebuild(bsl::size_t capacity)
+{
+    bsl::vector<Slot> slots(capacity);
+    const uint64_t mask = capacity - 1;
+    if (d_count) {
+        for (uint64_t tag = d_begin; tag < d_end; ++tag) {
+            Slot& oldSlot = slot(tag);
+            if (oldSlot.has_value()) {
+                slots[tag & mask].swap(oldSlot);
+            }
+        }
+    }
+    d_slots.swap(slots);
+    d_mask = mask;
+}
+
+template <typename Msg>
+void RingMessageStore<Msg>::trim()
+{
+    if (d_count == 0) {
+        d_begin = d_end;
+        return;
+    }
+    while (!slot(d_begin).has_value()) {
+        ++d_begin;
+    }
+    while (!slot(d_end - 1).has_value()) {
+        --d_end;
+    }
+}
+
+template <typename Msg>
+bool RingMessageStore<Msg>::insert(uint64_t deliveryTag, const Msg& message)
+{
+    if (contains(deliveryTag)) {
+        const Msg& stored = slot(deliveryTag).value().first;
+        if (message.guid() != stored.guid()) {
+            BALL_LOG_FATAL << "Different message already present in the store "
+                              "with same delivery-tag"
+                           << "\nMessage inside the store: " << stored
+                           << "\nMessage passed as an argument: " << message;
+            return false;
+        }
+        BALL_LOG_ERROR << "Same message already present in the store";
+        return false;
+    }
+
+    if (d_count == 0) {
+        d_begin = deliveryTag;
+        d_end   = deliveryTag + 1;
+    }
+    else {
+        const uint64_t begin = bsl::min(d_begin, deliveryTag);
+        const uint64_t end   = bsl::max(d_end, deliveryTag + 1);
+        reserveSpan(begin, end);
+        d_begin = begin;
+        d_end   = end;
+    }
+
+    slot(deliveryTag).emplace(message, rmqio::CoarseClock::utc());
+    ++d_count;
+
+    d_latestTagTilNow = bsl::max(d_latestTagTilNow, deliveryTag);
+
+    return true;
+}
+
+template <typename Msg>
+bool RingMessageStore<Msg>::lookup(uint64_t deliveryTag, Msg* message) const
+{
+    if (!contains(deliveryTag)) {
+        return false;
+    }
+    *message = slot(deliveryTag).value().first;
+    return true;
+}
+
+template <typename Msg>
+bool RingMessageStore<Msg>::lookup(const bdlb::Guid& guid,
+                                   Msg* message,
+                                   uint64_t* deliveryTag) const
+{
+    if (d_count == 0) {
+        return false;
+    }
+    for (uint64_t tag = d_begin; tag < d_end; ++tag) {
+        const Slot& entry = slot(tag);
+        if (entry.has_value() && entry.value().first.guid() == guid) {
+            *message     = entry.value().first;
+            *deliveryTag = tag;
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename Msg>
+bool RingMessageStore<Msg>::remove(uint64_t deliveryTag,
+                                   Msg* message,
+                                   bdlt::Datetime* insertTime)
+{
+    if (!contains(deliveryTag)) {
+        return false;
+    }
+    Slot& entry = slot(deliveryTag);
+    *message    = entry.value().first;
+    *insertTime = entry.value().second;
+    entry.reset();
+    --d_count;
+    if (deliveryTag < d_hungEnd) {
+        --d_hungCount;
+    }
+    trim();
+    return true;
+}
+
+template <typename Msg>
+typename RingMessageStore<Msg>::MessageList
+RingMessageStore<Msg>::removeUntil(uint64_t deliveryTag)
+{
+    MessageList removedMessages;
+    if (count() == 0) {
+        BALL_LOG_INFO << "The message store is empty.";
+        return removedMessages;
+    }
+
+    if (!contains(deliveryTag)) {
+        BALL_LOG_ERROR << deliveryTag << " is not present in the store.";
+        return removedMessages;
+    }
+
+    for (uint64_t tag = d_begin; tag <= deliveryTag; ++tag) {
+        Slot& entry = slot(tag);
+        if (entry.has_value()) {
+            removedMessages.push_back(bsl::make_pair(tag, entry.value()));
+            entry.reset();
+            --d_count;
+            if (tag < d_hungEnd) {
+                --d_hungCount;
+            }
+        }
+    }
+    trim();
+
+    return removedMessages;
+}
+
+template <typename Msg>
+void RingMessageStore<Msg>::swap(RingMessageStore& msgStore)
+{
+    d_slots.swap(msgStore.d_slots);
+    bsl::swap(d_mask, msgStore.d_mask);
+    bsl::swap(d_begin, msgStore.d_begin);
+    bsl::swap(d_end, msgStore.d_end);
+    bsl::swap(d_count, msgStore.d_count);
+    bsl::swap(d_latestTagTilNow, msgStore.d_latestTagTilNow);
+    bsl::swap(d_hungEnd, msgStore.d_hungEnd);
+    bsl::swap(d_hungCount, msgStore.d_hungCount);
+
+    d_lifetimeId++;
+}
+
+template <typename Msg>
+typename RingMessageStore<Msg>::MessageList
+RingMessageStore<Msg>::getMessagesOlderThan(const bdlt::Datetime& time) const
+{
+    MessageList results;
+    if (d_count == 0) {
+        return results;
+    }
+    for (uint64_t tag = d_begin; tag < d_end; ++tag) {
+        const Slot& entry = slot(tag);
+        if (!entry.has_value()) {
+            continue;
+        }
+        if (entry.value().second <= time) {
+            results.push_back(bsl::make_pair(tag, entry.value()));
+        }
+        else {
+            break;
+        }
+    }
+
+    return results;
+}
+
+template <typename Msg>
+bsl::size_t RingMessageStore<Msg>::visitMessagesOlderThan(
+    const bdlt::Datetime& time,
+    const MessageVisitor& visitor) const
+{
+    bsl::size_t visited = 0;
+    for (uint64_t tag = d_begin; visited < d_count && tag < d_end; ++tag) {
+        const Slot& entry = slot(tag);
+        if (!entry.has_value()) {
+            continue;
+        }
+        if (entry.value().second > time) {
+            break;
+        }
+        visitor(tag, entry.value());
+        ++visited;
+    }
+
+    return visited;
+}
+
+template <typename Msg>
+bsl::size_t RingMessageStore<Msg>::updateHung(const bdlt::Datetime& time,
+                                              const MessageVisitor& visitor)
+{
+    if (d_count == 0) {
+        return d_hungCount;
+    }
+
+    for (uint64_t tag = bsl::max(d_begin, d_hungEnd); tag < d_end; ++tag) {
+        const Slot& entry = slot(tag);
+        if (!entry.has_value()) {
+            continue;
+        }
+        if (entry.value().second > time) {
+            break;
+        }
+        visitor(tag, entry.value());
+        ++d_hungCount;
+        d_hungEnd = tag + 1;
+    }
+
+    return d_hungCount;
+}
+
+} // namespace rmqamqp
+} // namespace BloombergLP
+
+#endif
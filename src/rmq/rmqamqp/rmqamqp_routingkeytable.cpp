@@ -0,0 +1,46 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqamqp_routingkeytable.h>
+
+#include <bsl_utility.h>
+
+namespace BloombergLP {
+namespace rmqamqp {
+
+RoutingKeyTable::RoutingKeyTable(bsl::size_t capacity)
+: d_capacity(capacity)
+, d_keys()
+{
+}
+
+bsl::shared_ptr<const bsl::string>
+RoutingKeyTable::intern(const bsl::string& routingKey)
+{
+    const Keys::const_iterator interned = d_keys.find(routingKey);
+    if (interned != d_keys.end()) {
+        return interned->second;
+    }
+
+    const bsl::shared_ptr<const bsl::string> key =
+        bsl::make_shared<bsl::string>(routingKey);
+    if (d_keys.size() < d_capacity) {
+        d_keys.insert(bsl::make_pair(routingKey, key));
+    }
+    return key;
+}
+
+} // namespace rmqamqp
+} // namespace BloombergLP
@@ -0,0 +1,65 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQAMQP_ROUTINGKEYTABLE
+#define INCLUDED_RMQAMQP_ROUTINGKEYTABLE
+
+#include <bsl_cstddef.h>
+#include <bsl_memory.h>
+#include <bsl_string.h>
+#include <bsl_unordered_map.h>
+
+namespace BloombergLP {
+namespace rmqamqp {
+
+//@PURPOSE: Share the storage of a channel's routing keys
+//
+//@CLASSES:
+//  rmqamqp::RoutingKeyTable: Intern table of routing keys
+
+/// \brief Interns the routing keys published on one channel
+///
+/// Publishers use few distinct routing keys across many messages, so each
+/// outstanding message refers to one shared copy of its key rather than
+/// holding its own. Once `capacity` keys are interned, further keys are
+/// returned in a copy of their own, which bounds the table for publishers
+/// that do use many keys.
+
+class RoutingKeyTable {
+  public:
+    static const bsl::size_t k_DEFAULT_CAPACITY = 1024;
+
+    explicit RoutingKeyTable(bsl::size_t capacity = k_DEFAULT_CAPACITY);
+
+    /// Return the shared copy of `routingKey`, interning it if there is
+    /// room
+    bsl::shared_ptr<const bsl::string> intern(const bsl::string& routingKey);
+
+    bsl::size_t size() const { return d_keys.size(); }
+
+    bsl::size_t capacity() const { return d_capacity; }
+
+  private:
+    typedef bsl::unordered_map<bsl::string, bsl::shared_ptr<const bsl::string> >
+        Keys;
+
+    bsl::size_t d_capacity;
+    Keys d_keys;
+};
+
+} // namespace rmqamqp
+} // namespace BloombergLP
+
+#endif
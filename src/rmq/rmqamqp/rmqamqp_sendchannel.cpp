@@ -15,17 +15,26 @@
 
 #include <rmqamqp_sendchannel.h>
 
-#include <rmqamqpt_basicpublish.h>
+#include <rmqamqp_metrics.h>
+#include <rmqamqpt_basicproperties.h>
 #include <rmqamqpt_constants.h>
+#include <rmqamqpt_contentbody.h>
+#include <rmqamqpt_contentheader.h>
+#include <rmqio_coarseclock.h>
 #include <rmqt_exchange.h>
+#include <rmqt_log.h>
+#include <rmqt_probe.h>
 
-#include <bdlt_currenttime.h>
+#include <bdlf_bind.h>
 #include <bsls_assert.h>
+#include <bsls_keyword.h>
 
+#include <bsl_algorithm.h>
 #include <bsl_memory.h>
 #include <bsl_numeric.h>
 #include <bsl_ostream.h>
 #include <bsl_utility.h>
+#include <bsl_vector.h>
 
 namespace BloombergLP {
 namespace rmqamqp {
@@ -35,9 +44,50 @@ BALL_LOG_SET_NAMESPACE_CATEGORY("RMQAMQP.SENDCHANNEL")
 
 void noopWriteHandler() {}
 
+/// Reports the outcome of an unconfirmed publish: written once the
+/// connection invokes `onWritten`, dropped once the connection lets go of
+/// its write callback without invoking it
+class UnconfirmedWrite {
+  public:
+    UnconfirmedWrite(
+        const SendChannel::UnconfirmedPublishCallback& onPublished,
+        const MetricAggregator::Counter& droppedMessages)
+    : d_onPublished(onPublished)
+    , d_droppedMessages(droppedMessages)
+    , d_written(false)
+    {
+    }
+
+    ~UnconfirmedWrite()
+    {
+        if (!d_written) {
+            d_droppedMessages.add(1);
+            if (d_onPublished) {
+                d_onPublished(false);
+            }
+        }
+    }
+
+    static void onWritten(const bsl::shared_ptr<UnconfirmedWrite>& write)
+    {
+        write->d_written = true;
+        if (write->d_onPublished) {
+            write->d_onPublished(true);
+        }
+    }
+
+  private:
+    UnconfirmedWrite(const UnconfirmedWrite&) BSLS_KEYWORD_DELETED;
+    UnconfirmedWrite& operator=(const UnconfirmedWrite&) BSLS_KEYWORD_DELETED;
+
+    SendChannel::UnconfirmedPublishCallback d_onPublished;
+    MetricAggregator::Counter d_droppedMessages;
+    bool d_written;
+};
+
 void printPartialReturns(
     const bsl::map<uint64_t, rmqt::ConfirmResponse>& returnNoAck,
-    const MessageStore<MessageWithRoute>& store)
+    const RingMessageStore<MessageWithRoute>& store)
 {
     if (!returnNoAck.empty()) {
         bsl::stringstream st;
@@ -88,11 +138,43 @@ SendChannel::SendChannel(
           connErrorCb)
 , d_messageStore()
 , d_confirmCallback()
+, d_batchConfirmCallback()
 , d_pendingMessages()
+, d_urgentMessages()
 , d_exchange(exchange)
+, d_publishMethods(exchange->name())
+, d_routingKeys()
 , d_deliveryCounter(1)
 , d_basicReturn()
 , d_returnedTagResponse()
+, d_stream()
+, d_streamedTags()
+, d_publishGate()
+, d_onWriteWeight()
+, d_confirms(true)
+, d_confirmWaiters()
+, d_resendBatch(0)
+, d_resendTimer()
+, d_resendRateLimiter()
+, d_resending(false)
+, d_sentMessagesMetric(MetricAggregator::counter(metricPublisher,
+                                                 "client_sent_messages",
+                                                 d_vhostTags))
+, d_publishedMessagesMetric(MetricAggregator::counter(metricPublisher,
+                                                      "published_messages",
+                                                      d_vhostTags))
+, d_confirmLatencyMetric(MetricAggregator::distribution(metricPublisher,
+                                                        "confirm_latency",
+                                                        d_vhostTags))
+, d_droppedMessagesMetric(MetricAggregator::counter(metricPublisher,
+                                                    "dropped_messages",
+                                                    d_vhostTags))
+, d_resentMessagesMetric(MetricAggregator::counter(metricPublisher,
+                                                   "resent_messages",
+                                                   d_vhostTags))
+, d_messagesOut(0)
+, d_bytesOut(0)
+, d_lastConfirmTime()
 {
 }
 
@@ -103,9 +185,32 @@ void SendChannel::setCallback(const MessageConfirmCallback& onMessageConfirm)
     d_confirmCallback = onMessageConfirm;
 }
 
+void SendChannel::setBatchCallback(
+    const MessageBatchConfirmCallback& onMessagesConfirm)
+{
+    d_batchConfirmCallback = onMessagesConfirm;
+}
+
+void SendChannel::setWriteWeight(unsigned weight)
+{
+    if (d_onWriteWeight) {
+        d_onWriteWeight(weight);
+    }
+}
+
+void SendChannel::enableResendPacing(bsl::size_t batchMessages,
+                                     rmqio::TimerFactory& timerFactory)
+{
+    using bdlf::PlaceHolders::_1;
+
+    d_resendBatch = batchMessages;
+    d_resendTimer = timerFactory.createWithCallback(bdlf::BindUtil::bind(
+        &SendChannel::onResendTimer, weak_from_this(), _1));
+}
+
 void SendChannel::onReset()
 {
-    BALL_LOG_DEBUG << "Channel Reset New LifetimeId: "
+    RMQT_LOG_DEBUG << "Channel Reset New LifetimeId: "
                    << d_messageStore.lifetimeId();
     d_deliveryCounter = 1;
     d_basicReturn.reset();
@@ -113,26 +218,68 @@ void SendChannel::onReset()
 
 void SendChannel::onFlowAllowed()
 {
-    if (state() == READY) {
+    if (channelWritable()) {
+        publishUrgentMessages();
+    }
+    if (canPublish()) {
         publishPendingMessages();
     }
 }
 
 void SendChannel::processFailures()
 {
-    MessageStore<MessageWithRoute> store;
+    d_resending = false;
+    if (d_resendTimer) {
+        d_resendTimer->cancel();
+    }
+
+    RingMessageStore<MessageWithRoute> store;
     d_messageStore.swap(store);
-    const size_t count = store.count();
+    RingMessageStore<MessageWithRoute>::MessageList streamed;
+    size_t count = 0;
+
+    // The unconfirmed messages were published before any still pending, so
+    // they are resent first
+    bsl::queue<MessageWithRoute> pending;
+    d_pendingMessages.swap(pending);
     while (store.count() > 0) {
         MessageWithRoute msg;
-        bdlt::Datetime unused;
-        store.remove(store.oldestTagInStore(), &msg, &unused);
-        d_pendingMessages.push(msg);
+        bdlt::Datetime insertTime;
+        const uint64_t deliveryTag = store.oldestTagInStore();
+        store.remove(deliveryTag, &msg, &insertTime);
+
+        if (d_streamedTags.erase(deliveryTag)) {
+            streamed.push_back(
+                bsl::make_pair(deliveryTag, bsl::make_pair(msg, insertTime)));
+        }
+        else {
+            d_pendingMessages.push(msg);
+            ++count;
+        }
+    }
+    d_streamedTags.clear();
+    for (; !pending.empty(); pending.pop()) {
+        d_pendingMessages.push(pending.front());
     }
 
     printPartialReturns(d_returnedTagResponse, store);
+
+    if (!streamed.empty()) {
+        BALL_LOG_ERROR << "Rejecting " << streamed.size()
+                       << " outstanding streamed message(s), which cannot "
+                          "be resent after reconnection";
+        callbackMessages(
+            streamed, rmqt::ConfirmResponse(rmqt::ConfirmResponse::REJECT));
+        notifyConfirmWaiters();
+    }
     d_returnedTagResponse.clear();
 
+    if (d_stream) {
+        const StreamFailureCallback onFailure = d_stream->onFailure;
+        d_stream.reset();
+        onFailure();
+    }
+
     if (count) {
         BALL_LOG_INFO
             << "Queuing " << count
@@ -142,68 +289,431 @@ void SendChannel::processFailures()
 
 void SendChannel::onOpen()
 {
-    BALL_LOG_TRACE << "Turning on confirm delivery for the channel";
+    if (!d_confirms) {
+        ready();
+        BALL_LOG_INFO << "Unconfirmed producer for exchange '"
+                      << d_exchange->name() << "' is now ready";
+        return;
+    }
+
+    if (setupPipelined()) {
+        // confirm.select went with channel.open, its reply is next
+        updateState(AWAITING_REPLY);
+        return;
+    }
+
+    RMQT_LOG_TRACE << "Turning on confirm delivery for the channel";
     writeMessage(Message(rmqamqpt::Method(
                      rmqamqpt::ConfirmMethod(rmqamqpt::ConfirmSelect(false)))),
                  AWAITING_REPLY);
 }
 
+bool SendChannel::appendSetupMethods(bsl::vector<Message>* methods)
+{
+    if (!d_confirms) {
+        return false;
+    }
+
+    methods->push_back(Message(rmqamqpt::Method(
+        rmqamqpt::ConfirmMethod(rmqamqpt::ConfirmSelect(false)))));
+    return true;
+}
+
 void SendChannel::publishMessage(const rmqt::Message& message,
                                  const bsl::string& routingKey,
                                  rmqt::Mandatory::Value mandatory)
 {
-    BSLS_ASSERT(d_confirmCallback);
+    BSLS_ASSERT(d_confirmCallback || d_batchConfirmCallback);
 
-    d_metricPublisher->publishCounter("client_sent_messages", 1, d_vhostTags);
+    d_sentMessagesMetric.add(1);
 
-    if (state() != READY || !d_flow) {
-        d_pendingMessages.push(
-            MessageWithRoute(message, routingKey, mandatory));
+    // Copied once here, then shared by the pending queue and message store
+    const MessageWithRoute route(
+        message, d_routingKeys.intern(routingKey), mandatory);
+
+    if (!canPublish()) {
+        d_pendingMessages.push(route);
         BALL_LOG_INFO << "Channel not ready. Message queued as pending. "
                       << message << " " << d_pendingMessages.size()
                       << " messages pending.";
         return;
     }
 
-    readyToPublishMsg(message, routingKey, mandatory);
+    readyToPublishMsg(route);
 }
 
-void SendChannel::readyToPublishMsg(const rmqt::Message& message,
-                                    const bsl::string& routingKey,
-                                    const rmqt::Mandatory::Value mandatory)
+void SendChannel::publishUrgent(const rmqt::Message& message,
+                                const bsl::string& routingKey,
+                                rmqt::Mandatory::Value mandatory)
 {
-    if (d_messageStore.insert(
-            d_deliveryCounter,
-            MessageWithRoute(message, routingKey, mandatory))) {
-        ++d_deliveryCounter; // only increment delivery counter if we
-                             // successfully add to msg store
+    BSLS_ASSERT(d_confirmCallback || d_batchConfirmCallback);
+
+    d_sentMessagesMetric.add(1);
+
+    const MessageWithRoute route(
+        message, d_routingKeys.intern(routingKey), mandatory);
+
+    if (!channelWritable()) {
+        d_urgentMessages.push(route);
+        BALL_LOG_INFO << "Channel not ready. Urgent message queued ahead of "
+                      << d_pendingMessages.size() << " pending messages. "
+                      << message;
+        return;
     }
 
-    const bool mandatoryFlag = mandatory == rmqt::Mandatory::RETURN_UNROUTABLE;
+    // Written between two batches of a paced resend, if one is in progress
+    readyToPublishMsg(route);
+}
+
+void SendChannel::publishUnconfirmed(
+    const rmqt::Message& message,
+    const bsl::string& routingKey,
+    rmqt::Mandatory::Value mandatory,
+    const UnconfirmedPublishCallback& onPublished)
+{
+    BSLS_ASSERT(!d_confirms);
+
+    d_sentMessagesMetric.add(1);
+
+    const bsl::shared_ptr<UnconfirmedWrite> write =
+        bsl::make_shared<UnconfirmedWrite>(onPublished,
+                                           d_droppedMessagesMetric);
 
-    // Not implemented (connection is closed if set) in rabbitmq 3.0+
-    const bool immediateFlag = false;
+    if (!canPublish()) {
+        RMQT_LOG_DEBUG << "Channel not ready. Dropping unconfirmed message "
+                       << message;
+        return;
+    }
 
+    writeMessage(makePublishMethod(routingKey, mandatory), &noopWriteHandler);
+
+    d_publishedMessagesMetric.add(1);
+    ++d_messagesOut;
+    d_bytesOut += message.payloadSize();
     writeMessage(
-        Message(rmqamqpt::Method(rmqamqpt::BasicMethod(rmqamqpt::BasicPublish(
-            d_exchange->name(), routingKey, mandatoryFlag, immediateFlag)))),
-        &noopWriteHandler);
+        Message(message),
+        bdlf::BindUtil::bind(&UnconfirmedWrite::onWritten, write));
+}
+
+void SendChannel::publishMessages(const bsl::vector<rmqt::Message>& messages,
+                                  const bsl::string& routingKey,
+                                  rmqt::Mandatory::Value mandatory)
+{
+    const bsl::shared_ptr<const bsl::string> key =
+        d_routingKeys.intern(routingKey);
+
+    bsl::vector<MessageWithRoute> routed;
+    routed.reserve(messages.size());
+    for (bsl::vector<rmqt::Message>::const_iterator it = messages.begin();
+         it != messages.end();
+         ++it) {
+        routed.push_back(MessageWithRoute(*it, key, mandatory));
+    }
+    publishRouted(routed);
+}
+
+void SendChannel::publishToMany(const bsl::vector<rmqt::Message>& messages,
+                                const bsl::vector<bsl::string>& routingKeys,
+                                rmqt::Mandatory::Value mandatory)
+{
+    BSLS_ASSERT(messages.size() == routingKeys.size());
+
+    bsl::vector<MessageWithRoute> routed;
+    routed.reserve(messages.size());
+    for (bsl::size_t i = 0; i < messages.size(); ++i) {
+        routed.push_back(MessageWithRoute(
+            messages[i], d_routingKeys.intern(routingKeys[i]), mandatory));
+    }
+    publishRouted(routed);
+}
+
+void SendChannel::publishRouted(const bsl::vector<MessageWithRoute>& messages)
+{
+    BSLS_ASSERT(d_confirmCallback || d_batchConfirmCallback);
+
+    d_sentMessagesMetric.add(messages.size());
 
-    d_metricPublisher->publishCounter("published_messages", 1, d_vhostTags);
-    writeMessage(Message(message), &noopWriteHandler);
+    if (!canPublish()) {
+        for (bsl::vector<MessageWithRoute>::const_iterator it =
+                 messages.begin();
+             it != messages.end();
+             ++it) {
+            d_pendingMessages.push(*it);
+        }
+        BALL_LOG_INFO << "Channel not ready. " << messages.size()
+                      << " messages queued as pending. "
+                      << d_pendingMessages.size() << " messages pending.";
+        return;
+    }
+
+    bsl::shared_ptr<bsl::vector<Message> > batch =
+        bsl::make_shared<bsl::vector<Message> >();
+    batch->reserve(messages.size() * 2);
+    for (bsl::vector<MessageWithRoute>::const_iterator it = messages.begin();
+         it != messages.end();
+         ++it) {
+        prepareToPublishMsg(batch.get(), *it);
+    }
+
+    d_publishedMessagesMetric.add(messages.size());
+    writeMessages(batch, &noopWriteHandler);
+}
+
+void SendChannel::beginStream(const rmqt::Message& message,
+                              bsl::size_t bodySize,
+                              const bsl::string& routingKey,
+                              rmqt::Mandatory::Value mandatory,
+                              const StreamFailureCallback& onFailure)
+{
+    BSLS_ASSERT(d_confirmCallback || d_batchConfirmCallback);
+
+    d_sentMessagesMetric.add(1);
+
+    const MessageWithRoute streamedMessage(
+        message, d_routingKeys.intern(routingKey), mandatory);
+
+    if (!canPublish()) {
+        // Unlike other messages a stream cannot wait as pending, its body is
+        // already on its way
+        BALL_LOG_ERROR << "Cannot stream message, the channel is not ready "
+                          "or already streaming: "
+                       << message;
+
+        RingMessageStore<MessageWithRoute>::MessageList rejected;
+        rejected.push_back(bsl::make_pair(
+            0, bsl::make_pair(streamedMessage, rmqio::CoarseClock::utc())));
+        callbackMessages(
+            rejected, rmqt::ConfirmResponse(rmqt::ConfirmResponse::REJECT));
+        onFailure();
+        return;
+    }
+
+    if (d_messageStore.insert(d_deliveryCounter, streamedMessage)) {
+        d_streamedTags.insert(d_deliveryCounter);
+        ++d_deliveryCounter;
+    }
+
+    bsl::shared_ptr<bsl::vector<Message> > publish =
+        bsl::make_shared<bsl::vector<Message> >();
+    publish->push_back(makePublishMethod(routingKey, mandatory));
+    publish->push_back(Message(rmqamqpt::ContentHeader(
+        rmqamqpt::Constants::BASIC,
+        bodySize,
+        rmqamqpt::BasicProperties(message.properties()))));
+
+    d_publishedMessagesMetric.add(1);
+    ++d_messagesOut;
+    d_bytesOut += bodySize;
+    writeMessages(publish, &noopWriteHandler);
+
+    if (bodySize) {
+        d_stream = Stream(bodySize, onFailure);
+    }
+}
+
+void SendChannel::publishStreamContent(
+    const bsl::shared_ptr<const bsl::vector<uint8_t> >& chunk,
+    const rmqio::Connection::SuccessWriteCallback& onWritten)
+{
+    if (!d_stream) {
+        RMQT_LOG_DEBUG << "Dropping " << chunk->size()
+                       << " bytes of a failed streamed message";
+        return;
+    }
+
+    BSLS_ASSERT(chunk->size() <= d_stream->remaining);
+    d_stream->remaining -= chunk->size();
+
+    writeMessage(Message(rmqamqpt::ContentBody(chunk)), onWritten);
+
+    if (d_stream->remaining == 0) {
+        d_stream.reset();
+
+        if (channelWritable()) {
+            publishUrgentMessages();
+        }
+        if (canPublish()) {
+            publishPendingMessages();
+        }
+    }
+}
+
+void SendChannel::abortStream()
+{
+    if (!d_stream) {
+        return;
+    }
+
+    BALL_LOG_ERROR << "Streamed message abandoned with "
+                   << d_stream->remaining
+                   << " body bytes unpublished. Reconnecting, as a partly "
+                      "published message cannot be cancelled";
+
+    // The stream is failed when the reconnection resets this channel
+    requestReconnect();
+}
+
+bool SendChannel::canPublish() const
+{
+    return channelWritable() && !d_resending;
+}
+
+bool SendChannel::channelWritable() const
+{
+    return state() == READY && d_flow && !d_stream;
+}
+
+void SendChannel::readyToPublishMsg(const MessageWithRoute& message)
+{
+    bsl::vector<Message> publish;
+    prepareToPublishMsg(&publish, message);
+
+    writeMessage(publish[0], &noopWriteHandler);
+
+    d_publishedMessagesMetric.add(1);
+    writeMessage(publish[1], &noopWriteHandler);
+}
+
+void SendChannel::prepareToPublishMsg(bsl::vector<Message>* out,
+                                      const MessageWithRoute& message)
+{
+    RMQT_PROBE2(
+        publish_framed, d_deliveryCounter, message.message().payloadSize());
+
+    if (d_messageStore.insert(d_deliveryCounter, message)) {
+        ++d_deliveryCounter; // only increment delivery counter if we
+                             // successfully add to msg store
+    }
+
+    out->push_back(
+        makePublishMethod(message.routingKey(), message.mandatory()));
+    out->push_back(Message(message.message()));
+
+    ++d_messagesOut;
+    d_bytesOut += message.message().payloadSize();
+}
+
+Message SendChannel::makePublishMethod(const bsl::string& routingKey,
+                                       const rmqt::Mandatory::Value mandatory)
+{
+    return Message(d_publishMethods.get(routingKey, mandatory));
 }
 
 void SendChannel::publishPendingMessages()
 {
+    publishUrgentMessages();
+
+    if (d_resendBatch > 0) {
+        if (!d_resending && !d_pendingMessages.empty()) {
+            BALL_LOG_INFO << "Resending " << d_pendingMessages.size()
+                          << " pending messages, " << d_resendBatch
+                          << " at a time.";
+            d_resending = true;
+            publishPendingBatch();
+        }
+        return;
+    }
+
     BALL_LOG_INFO << "Publishing " << d_pendingMessages.size()
                   << " pending messages.";
     while (!d_pendingMessages.empty()) {
-        const MessageWithRoute& msg = d_pendingMessages.front();
-        readyToPublishMsg(msg.message(), msg.routingKey(), msg.mandatory());
+        readyToPublishMsg(d_pendingMessages.front());
         d_pendingMessages.pop();
     }
 }
 
+void SendChannel::publishUrgentMessages()
+{
+    if (d_urgentMessages.empty()) {
+        return;
+    }
+
+    BALL_LOG_INFO << "Publishing " << d_urgentMessages.size()
+                  << " urgent messages ahead of " << d_pendingMessages.size()
+                  << " pending messages.";
+    while (!d_urgentMessages.empty()) {
+        readyToPublishMsg(d_urgentMessages.front());
+        d_urgentMessages.pop();
+    }
+}
+
+void SendChannel::publishPendingBatch()
+{
+    if (!channelWritable()) {
+        // Resumed by `onFlowAllowed`, or once the channel is ready again
+        d_resending = false;
+        return;
+    }
+    publishUrgentMessages();
+    if (d_pendingMessages.empty()) {
+        d_resending = false;
+        BALL_LOG_INFO << "Finished resending pending messages. "
+                      << channelDebugName();
+        return;
+    }
+
+    bsl::shared_ptr<bsl::vector<Message> > batch =
+        bsl::make_shared<bsl::vector<Message> >();
+    batch->reserve(bsl::min(d_resendBatch, d_pendingMessages.size()) * 2);
+    bsl::size_t count = 0;
+    while (count < d_resendBatch && !d_pendingMessages.empty()) {
+        const MessageWithRoute& message = d_pendingMessages.front();
+        if (d_resendRateLimiter) {
+            const bsls::TimeInterval wait = d_resendRateLimiter->tryAcquire(
+                message.message().payloadSize());
+            if (wait > bsls::TimeInterval()) {
+                if (count == 0) {
+                    d_resendTimer->reset(wait);
+                    return;
+                }
+                break;
+            }
+        }
+        prepareToPublishMsg(batch.get(), message);
+        d_pendingMessages.pop();
+        ++count;
+    }
+
+    d_publishedMessagesMetric.add(count);
+    d_resentMessagesMetric.add(count);
+    writeMessages(batch,
+                  bdlf::BindUtil::bind(&SendChannel::onResendBatchWritten,
+                                       weak_from_this(),
+                                       lifetimeId()));
+}
+
+void SendChannel::onResendBatchWritten(const bsl::weak_ptr<Channel>& weakSelf,
+                                       bsl::size_t lifetimeId)
+{
+    bsl::shared_ptr<Channel> self = weakSelf.lock();
+    if (!self) {
+        return;
+    }
+
+    SendChannel* channel = static_cast<SendChannel*>(self.get());
+    if (channel->d_resending && channel->lifetimeId() == lifetimeId) {
+        channel->publishPendingBatch();
+    }
+}
+
+void SendChannel::onResendTimer(const bsl::weak_ptr<Channel>& weakSelf,
+                                rmqio::Timer::InterruptReason reason)
+{
+    if (reason != rmqio::Timer::EXPIRE) {
+        return;
+    }
+
+    bsl::shared_ptr<Channel> self = weakSelf.lock();
+    if (!self) {
+        return;
+    }
+
+    SendChannel* channel = static_cast<SendChannel*>(self.get());
+    if (channel->d_resending) {
+        channel->publishPendingBatch();
+    }
+}
+
 void SendChannel::processConfirmMethod(const rmqamqpt::ConfirmMethod& confirm)
 {
     if (!(state() == AWAITING_REPLY)) {
@@ -231,6 +741,13 @@ void SendChannel::processMessage(const rmqt::Message& message)
         BALL_LOG_ERROR << "Unexpected Content";
         close(rmqamqpt::Constants::UNEXPECTED_FRAME, "Expected BasicReturn");
     }
+    else if (!d_confirms) {
+        BALL_LOG_WARN << "Unconfirmed message was returned by the broker "
+                         "and is dropped. Returned message: "
+                      << message << " Method basic.return: " << *d_basicReturn;
+        d_droppedMessagesMetric.add(1);
+        d_basicReturn.reset();
+    }
     else {
         MessageWithRoute storedMsg;
         uint64_t deliveryTag;
@@ -260,10 +777,16 @@ void SendChannel::processMessage(const rmqt::Message& message)
 }
 
 void SendChannel::callbackMessages(
-    const MessageStore<MessageWithRoute>::MessageList& confs,
+    const RingMessageStore<MessageWithRoute>::MessageList& confs,
     const rmqt::ConfirmResponse& confirmResponse)
 {
-    for (MessageStore<MessageWithRoute>::MessageList::const_iterator it =
+    bsl::shared_ptr<ConfirmationBatch> batch;
+    if (d_batchConfirmCallback) {
+        batch = bsl::make_shared<ConfirmationBatch>();
+        batch->reserve(confs.size());
+    }
+
+    for (RingMessageStore<MessageWithRoute>::MessageList::const_iterator it =
              confs.cbegin();
          it != confs.cend();
          ++it) {
@@ -277,18 +800,26 @@ void SendChannel::callbackMessages(
                 : confirmResponse;
 
         const MessageWithRoute& msg = it->second.first;
-        BALL_LOG_TRACE << actualResponse << " for " << msg;
-        d_confirmCallback(msg.message(), msg.routingKey(), actualResponse);
+        RMQT_LOG_TRACE << actualResponse << " for " << msg;
+        if (batch) {
+            batch->push_back(bsl::make_pair(msg, actualResponse));
+        }
+        else {
+            d_confirmCallback(msg.message(), msg.routingKey(), actualResponse);
+        }
 
-        d_metricPublisher->publishDistribution(
-            "confirm_latency",
-            (bdlt::CurrentTime::utc() - it->second.second)
-                .totalSecondsAsDouble(),
-            d_vhostTags);
+        d_confirmLatencyMetric.record(
+            (rmqio::CoarseClock::utc() - it->second.second)
+                .totalSecondsAsDouble());
 
         if (returnedDeliveryTag != d_returnedTagResponse.end()) {
             d_returnedTagResponse.erase(returnedDeliveryTag);
         }
+        d_streamedTags.erase(it->first);
+    }
+
+    if (batch) {
+        d_batchConfirmCallback(batch);
     }
 }
 
@@ -296,8 +827,10 @@ void SendChannel::processAckNack(bool multiple,
                                  size_t deliveryTag,
                                  const rmqt::ConfirmResponse& confirmResponse)
 {
+    RMQT_PROBE2(confirm_received, deliveryTag, multiple);
+
     bool success = false;
-    MessageStore<MessageWithRoute>::MessageList msgs;
+    RingMessageStore<MessageWithRoute>::MessageList msgs;
     if (multiple) {
         msgs    = d_messageStore.removeUntil(deliveryTag);
         success = msgs.size();
@@ -311,7 +844,9 @@ void SendChannel::processAckNack(bool multiple,
         msgs.push_back(bsl::make_pair(deliveryTag, msgTime));
     }
     if (success) {
+        d_lastConfirmTime = rmqio::CoarseClock::utc();
         callbackMessages(msgs, confirmResponse);
+        notifyConfirmWaiters();
     }
     else {
         BALL_LOG_WARN << "Failed to find message(s) with delivery "
@@ -388,6 +923,59 @@ void SendChannel::processBasicMethod(const rmqamqpt::BasicMethod& basic)
 }
 const char* SendChannel::channelType() const { return "Producer"; }
 
+bsl::vector<bsl::pair<bsl::string, bsl::string> >
+SendChannel::channelMetricTags() const
+{
+    bsl::vector<bsl::pair<bsl::string, bsl::string> > tags(d_vhostTags);
+    tags.push_back(bsl::pair<bsl::string, bsl::string>(Metrics::EXCHANGE_TAG,
+                                                       d_exchange->name()));
+    return tags;
+}
+
+void SendChannel::publishChannelMetrics()
+{
+    Channel::publishChannelMetrics();
+
+    const bsl::vector<bsl::pair<bsl::string, bsl::string> > tags =
+        channelMetricTags();
+    d_metricPublisher->publishGauge(
+        "channel_pending_messages",
+        static_cast<double>(d_pendingMessages.size() +
+                            d_urgentMessages.size()),
+        tags);
+    if (d_lastConfirmTime) {
+        d_metricPublisher->publishGauge(
+            "channel_seconds_since_confirm",
+            (rmqio::CoarseClock::utc() - *d_lastConfirmTime)
+                .totalSecondsAsDouble(),
+            tags);
+    }
+}
+
+rmqt::Future<> SendChannel::waitForConfirms()
+{
+    rmqt::Future<>::Pair futurePair = rmqt::Future<>::make();
+    d_confirmWaiters.push_back(futurePair.first);
+    notifyConfirmWaiters();
+    return futurePair.second;
+}
+
+void SendChannel::notifyConfirmWaiters()
+{
+    if (d_confirmWaiters.empty() || d_messageStore.count() > 0 ||
+        !d_pendingMessages.empty() || !d_urgentMessages.empty()) {
+        return;
+    }
+
+    bsl::vector<rmqt::Future<>::Maker> waiters;
+    waiters.swap(d_confirmWaiters);
+    for (bsl::vector<rmqt::Future<>::Maker>::iterator it = waiters.begin();
+         it != waiters.end();
+         ++it) {
+        (*it)(rmqt::Result<>());
+    }
+}
+
 bsl::string SendChannel::channelDebugName() const
 {
     return "Producer Channel: Exchange: " + d_exchange->name() +
@@ -395,6 +983,15 @@ bsl::string SendChannel::channelDebugName() const
            ". Pending Messages: " + bsl::to_string(d_pendingMessages.size());
 }
 
+void SendChannel::loadStats(rmqt::ChannelStats* stats) const
+{
+    Channel::loadStats(stats);
+    stats->type             = rmqt::ChannelStats::PRODUCER;
+    stats->messagesOut      = d_messagesOut;
+    stats->bytesOut         = d_bytesOut;
+    stats->inFlightConfirms = inFlight();
+}
+
 bsl::ostream& operator<<(bsl::ostream& os, rmqt::ConfirmResponse::Status status)
 {
     switch (status) {
@@ -18,19 +18,36 @@
 #define INCLUDED_RMQAMQP_SENDCHANNEL_H
 
 #include <rmqamqp_channel.h>
-#include <rmqamqp_messagestore.h>
 #include <rmqamqp_messagewithroute.h>
+#include <rmqamqp_metricaggregator.h>
+#include <rmqamqp_publishgate.h>
+#include <rmqamqp_publishmethodcache.h>
+#include <rmqamqp_ratelimiter.h>
+#include <rmqamqp_ringmessagestore.h>
+#include <rmqamqp_routingkeytable.h>
 #include <rmqamqpt_basicreturn.h>
+#include <rmqio_connection.h>
+#include <rmqio_timer.h>
 #include <rmqt_confirmresponse.h>
+#include <rmqt_future.h>
 #include <rmqt_message.h>
 
+#include <bdlt_datetime.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_cstdint.h>
 #include <bsl_functional.h>
 #include <bsl_map.h>
 #include <bsl_memory.h>
+#include <bsl_optional.h>
 #include <bsl_ostream.h>
 #include <bsl_queue.h>
+#include <bsl_set.h>
 #include <bsl_string.h>
+#include <bsl_utility.h>
+#include <bsl_vector.h>
 #include <bslma_managedptr.h>
+#include <bsls_types.h>
 
 namespace BloombergLP {
 namespace rmqamqp {
@@ -42,6 +59,26 @@ class SendChannel : public Channel {
                                const rmqt::ConfirmResponse& confirmResponse)>
         MessageConfirmCallback;
 
+    /// A confirmed message, the routing key it was published with and the
+    /// broker's response
+    typedef bsl::pair<MessageWithRoute, rmqt::ConfirmResponse> Confirmation;
+    typedef bsl::vector<Confirmation> ConfirmationBatch;
+    typedef bsl::function<void(
+        const bsl::shared_ptr<const ConfirmationBatch>& confirmations)>
+        MessageBatchConfirmCallback;
+
+    /// Invoked if a streamed message fails before its whole body has been
+    /// published, e.g. because the connection was lost
+    typedef bsl::function<void()> StreamFailureCallback;
+
+    /// Invoked once for each message published with `publishUnconfirmed`:
+    /// with true once it is written to the socket, or with false if it is
+    /// dropped before then
+    typedef bsl::function<void(bool written)> UnconfirmedPublishCallback;
+
+    /// Applies a write weight to this channel, see `setWriteWeight`
+    typedef bsl::function<void(unsigned weight)> WriteWeightCallback;
+
     SendChannel(const rmqt::Topology& topology,
                 const bsl::shared_ptr<rmqt::Exchange>& exchange,
                 const Channel::AsyncWriteCallback& onAsyncWrite,
@@ -59,10 +96,130 @@ class SendChannel : public Channel {
                                 const bsl::string& routingKey,
                                 rmqt::Mandatory::Value mandatory);
 
+    /// Publish `messages` to broker for the exchange passed at construction,
+    /// all with the given routingKey & mandatory flag. The whole batch is
+    /// handed to the connection as a single write.
+    virtual void publishMessages(const bsl::vector<rmqt::Message>& messages,
+                                 const bsl::string& routingKey,
+                                 rmqt::Mandatory::Value mandatory);
+
+    /// Publish a message like `publishMessage`, but ahead of any messages
+    /// still pending: straight away if the channel can write, even while a
+    /// paced resend is in progress, otherwise before the pending messages
+    /// once it can
+    virtual void publishUrgent(const rmqt::Message& message,
+                               const bsl::string& routingKey,
+                               rmqt::Mandatory::Value mandatory);
+
+    /// Publish each of `messages` with the routing key at the same index of
+    /// `routingKeys`, as a single write like `publishMessages`
+    virtual void publishToMany(const bsl::vector<rmqt::Message>& messages,
+                               const bsl::vector<bsl::string>& routingKeys,
+                               rmqt::Mandatory::Value mandatory);
+
+    /// Publish the properties of `message` now, and a body of `bodySize`
+    /// bytes later through `publishStreamContent`, so that the body never has
+    /// to be held in memory at once. Other messages are held back until the
+    /// body is complete, as content cannot interleave on a channel. Streamed
+    /// bodies are not kept, so the message cannot be resent: it is rejected
+    /// (and `onFailure` invoked) if the channel is not ready, or if the
+    /// connection is lost before it is confirmed.
+    virtual void beginStream(const rmqt::Message& message,
+                             bsl::size_t bodySize,
+                             const bsl::string& routingKey,
+                             rmqt::Mandatory::Value mandatory,
+                             const StreamFailureCallback& onFailure);
+
+    /// Publish the next `chunk` of the streamed message's body. `onWritten`
+    /// is invoked once the chunk is written to the socket. Chunks of a
+    /// stream which has failed are dropped.
+    virtual void publishStreamContent(
+        const bsl::shared_ptr<const bsl::vector<uint8_t> >& chunk,
+        const rmqio::Connection::SuccessWriteCallback& onWritten);
+
+    /// Abandon the streamed message before its body is complete. A partly
+    /// published message cannot be cancelled, so this triggers a reconnect.
+    virtual void abortStream();
+
+    /// Publish without publisher confirms: the channel does not turn on
+    /// confirm delivery when it opens, and keeps no record of what it
+    /// publishes. Messages are then published with `publishUnconfirmed`.
+    /// Must be called before the channel is opened.
+    void setUnconfirmed() { d_confirms = false; }
+
+    /// False once `setUnconfirmed` is called
+    bool confirms() const { return d_confirms; }
+
+    /// Publish `message` on a channel set up with `setUnconfirmed`, invoking
+    /// `onPublished` once it is written to the socket. Nothing is kept to
+    /// resend it from, so it is dropped if the channel is not ready or the
+    /// connection is lost before it is written. Dropped messages, and
+    /// messages the broker returns, are counted in the `dropped_messages`
+    /// metric.
+    virtual void
+    publishUnconfirmed(const rmqt::Message& message,
+                       const bsl::string& routingKey,
+                       rmqt::Mandatory::Value mandatory,
+                       const UnconfirmedPublishCallback& onPublished);
+
     /// Set the confirmation callback function
     /// Must be called before the first call to `publishMessage`
     virtual void setCallback(const MessageConfirmCallback& onMessageConfirm);
 
+    /// Set a confirmation callback receiving every message resolved by a
+    /// single broker ack/nack at once, in delivery tag order. When set, it
+    /// is invoked instead of the callback passed to `setCallback`.
+    /// Must be called before the first call to `publishMessage`
+    virtual void
+    setBatchCallback(const MessageBatchConfirmCallback& onMessagesConfirm);
+
+    /// Have producers publishing on this channel hold back sends while
+    /// `gate` is closed, see `rmqa::ProducerImpl::setPublishGate`
+    void setPublishGate(const bsl::shared_ptr<PublishGate>& gate)
+    {
+        d_publishGate = gate;
+    }
+
+    const bsl::shared_ptr<PublishGate>& publishGate() const
+    {
+        return d_publishGate;
+    }
+
+    /// Set how the connection applies `setWriteWeight`
+    void setWriteWeightCallback(const WriteWeightCallback& callback)
+    {
+        d_onWriteWeight = callback;
+    }
+
+    /// Let this channel write up to `weight` content frames each time it
+    /// takes its turn among the connection's channels with publishes
+    /// queued, see `rmqio::WriteQueue`. Must be called on the event loop
+    /// thread.
+    virtual void setWriteWeight(unsigned weight);
+
+    /// Resend the messages left unconfirmed by a reconnect, oldest first,
+    /// and then those queued while the channel was not ready,
+    /// `batchMessages` at a time: each batch is written once the previous
+    /// one has been, so that a large backlog does not crowd heartbeats and
+    /// other channels out of the write queue. Publishes made meanwhile
+    /// queue behind the backlog, and streamed messages, which cannot
+    /// queue, are rejected. Must be called before the channel is opened.
+    void enableResendPacing(bsl::size_t batchMessages,
+                            rmqio::TimerFactory& timerFactory);
+
+    /// Also pace the resends of `enableResendPacing` to `limiter`, waiting
+    /// for room in it between batches. Must be called on the event loop
+    /// thread.
+    void setResendRateLimiter(const bsl::shared_ptr<RateLimiter>& limiter)
+    {
+        d_resendRateLimiter = limiter;
+    }
+
+    /// Return a Future resolved once nothing published on this channel is
+    /// awaiting a confirm, including messages queued to be (re)sent. It is
+    /// resolved straight away on a channel set up with `setUnconfirmed`.
+    virtual rmqt::Future<> waitForConfirms();
+
     size_t inFlight() const BSLS_KEYWORD_OVERRIDE
     {
         return d_messageStore.count();
@@ -73,8 +230,21 @@ class SendChannel : public Channel {
         return d_messageStore.lifetimeId();
     }
 
+    bsl::size_t retainedBytes() const BSLS_KEYWORD_OVERRIDE
+    {
+        return d_messageStore.retainedBytes();
+    }
+
+    void trim() BSLS_KEYWORD_OVERRIDE { d_messageStore.shrinkToFit(); }
+
     bsl::string channelDebugName() const BSLS_KEYWORD_OVERRIDE;
 
+    void loadStats(rmqt::ChannelStats* stats) const BSLS_KEYWORD_OVERRIDE;
+
+    /// Also publishes the messages waiting to be published and the seconds
+    /// since the last confirm
+    void publishChannelMetrics() BSLS_KEYWORD_OVERRIDE;
+
   private:
     void processBasicMethod(const rmqamqpt::BasicMethod& basic)
         BSLS_KEYWORD_OVERRIDE;
@@ -86,44 +256,141 @@ class SendChannel : public Channel {
     void onFlowAllowed() BSLS_KEYWORD_OVERRIDE;
     void processFailures() BSLS_KEYWORD_OVERRIDE;
     void onOpen() BSLS_KEYWORD_OVERRIDE;
+    bool appendSetupMethods(bsl::vector<Message>* methods)
+        BSLS_KEYWORD_OVERRIDE;
 
     // Send Confirm.Select method to turn on confirm delivery
 
+    /// The streamed message whose body is being published
+    struct Stream {
+        Stream(bsl::size_t remainingBytes,
+               const StreamFailureCallback& failureCallback)
+        : remaining(remainingBytes)
+        , onFailure(failureCallback)
+        {
+        }
+
+        bsl::size_t remaining;
+        StreamFailureCallback onFailure;
+    };
+
+    /// Return true if messages can be written now, rather than queued
+    bool canPublish() const;
+
+    /// Return true if the channel can take writes, whether or not a paced
+    /// resend is in progress
+    bool channelWritable() const;
+
     // Publish all messages from pendingMessages queue.
     // Should be called immediately after re-opening channel
     void publishPendingMessages();
 
-    void readyToPublishMsg(const rmqt::Message& message,
-                           const bsl::string& routingKey,
-                           const rmqt::Mandatory::Value mandatory);
+    /// Publish the urgent messages queued while the channel could not write
+    void publishUrgentMessages();
+
+    /// Write the next batch of a paced resend, see `enableResendPacing`
+    void publishPendingBatch();
+
+    static void onResendBatchWritten(const bsl::weak_ptr<Channel>& weakSelf,
+                                     bsl::size_t lifetimeId);
+
+    static void onResendTimer(const bsl::weak_ptr<Channel>& weakSelf,
+                              rmqio::Timer::InterruptReason reason);
+
+    void readyToPublishMsg(const MessageWithRoute& message);
+
+    /// Publish `messages` as a single write, or queue them as pending if
+    /// the channel is not ready
+    void publishRouted(const bsl::vector<MessageWithRoute>& messages);
+
+    /// Record `message` as outstanding and append the basic.publish method
+    /// and content to `out`. `message` is shared with the message store, not
+    /// copied
+    void prepareToPublishMsg(bsl::vector<Message>* out,
+                             const MessageWithRoute& message);
+
+    /// Return the basic.publish method for a message, re-using its encoding
+    /// from d_publishMethods
+    Message makePublishMethod(const bsl::string& routingKey,
+                              const rmqt::Mandatory::Value mandatory);
 
     void processAckNack(bool multiple,
                         size_t deliveryTag,
                         const rmqt::ConfirmResponse& confirmResponse);
 
-    void
-    callbackMessages(const MessageStore<MessageWithRoute>::MessageList& confs,
-                     const rmqt::ConfirmResponse& confirmResponse);
+    void callbackMessages(
+        const RingMessageStore<MessageWithRoute>::MessageList& confs,
+        const rmqt::ConfirmResponse& confirmResponse);
+
+    /// Resolve `d_confirmWaiters` if nothing is awaiting a confirm
+    void notifyConfirmWaiters();
 
     const char* channelType() const BSLS_KEYWORD_OVERRIDE;
 
+    /// The vhost and exchange tags
+    bsl::vector<bsl::pair<bsl::string, bsl::string> >
+    channelMetricTags() const BSLS_KEYWORD_OVERRIDE;
+
   private:
     SendChannel(const SendChannel& copy) BSLS_KEYWORD_DELETED;
     SendChannel& operator=(const SendChannel&) BSLS_KEYWORD_DELETED;
 
     class BasicMethodProcessor;
 
-    rmqamqp::MessageStore<MessageWithRoute> d_messageStore;
+    rmqamqp::RingMessageStore<MessageWithRoute> d_messageStore;
     MessageConfirmCallback d_confirmCallback;
+    MessageBatchConfirmCallback d_batchConfirmCallback;
 
     /// Stores messages until channel is ready to send them
     bsl::queue<MessageWithRoute> d_pendingMessages;
+
+    /// Messages sent with `publishUrgent` while the channel could not write,
+    /// published before `d_pendingMessages`
+    bsl::queue<MessageWithRoute> d_urgentMessages;
     bsl::shared_ptr<rmqt::Exchange> d_exchange;
 
+    PublishMethodCache d_publishMethods;
+    RoutingKeyTable d_routingKeys;
+
     uint64_t d_deliveryCounter;
 
     bslma::ManagedPtr<rmqamqpt::BasicReturn> d_basicReturn;
     bsl::map<uint64_t, rmqt::ConfirmResponse> d_returnedTagResponse;
+
+    bsl::optional<Stream> d_stream;
+
+    /// Delivery tags of the outstanding streamed messages, which have no
+    /// payload to resend
+    bsl::set<uint64_t> d_streamedTags;
+
+    bsl::shared_ptr<PublishGate> d_publishGate;
+    WriteWeightCallback d_onWriteWeight;
+
+    /// See `setUnconfirmed`
+    bool d_confirms;
+
+    /// Made by `waitForConfirms`, resolved once nothing is outstanding
+    bsl::vector<rmqt::Future<>::Maker> d_confirmWaiters;
+
+    /// See `enableResendPacing`. A batch size of 0 resends at once.
+    bsl::size_t d_resendBatch;
+    bsl::shared_ptr<rmqio::Timer> d_resendTimer;
+    bsl::shared_ptr<RateLimiter> d_resendRateLimiter;
+    /// True from the first batch of a paced resend until the pending
+    /// messages are all written, or the resend pauses
+    bool d_resending;
+
+    // Registered once, so publishing a message does not build metric names
+    MetricAggregator::Counter d_sentMessagesMetric;
+    MetricAggregator::Counter d_publishedMessagesMetric;
+    MetricAggregator::Distribution d_confirmLatencyMetric;
+    MetricAggregator::Counter d_droppedMessagesMetric;
+    MetricAggregator::Counter d_resentMessagesMetric;
+
+    // Reported by `loadStats`, only touched on the event loop thread
+    bsls::Types::Int64 d_messagesOut;
+    bsls::Types::Int64 d_bytesOut;
+    bsl::optional<bdlt::Datetime> d_lastConfirmTime;
 }; // class SendChannel
 
 bsl::ostream& operator<<(bsl::ostream&, rmqt::ConfirmResponse::Status);
@@ -0,0 +1,240 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqamqp_threadedheartbeatmanager.h>
+
+#include <rmqamqp_framer.h>
+
+#include <rmqt_log.h>
+
+#include <ball_log.h>
+#include <bdlf_bind.h>
+#include <bsls_systemtime.h>
+
+#include <bsl_algorithm.h>
+
+namespace BloombergLP {
+namespace rmqamqp {
+namespace {
+/// Added to the disconnect timeout, as in `HeartbeatManagerImpl`
+const int TICK_TIME = 1;
+
+/// The deadlines are checked at least this often
+const int MAX_POLL_MILLISECONDS = 1000;
+const int MIN_POLL_MILLISECONDS = 10;
+
+BALL_LOG_SET_NAMESPACE_CATEGORY("RMQAMQP.THREADEDHEARTBEATMANAGER")
+
+bsls::TimeInterval monotonicNow()
+{
+    return bsls::SystemTime::nowMonotonicClock();
+}
+} // namespace
+
+ThreadedHeartbeatManager::ThreadedHeartbeatManager(
+    const bsl::shared_ptr<bdlmt::EventScheduler>& scheduler,
+    const Post& post,
+    const Clock& clock)
+: d_scheduler(scheduler)
+, d_post(post)
+, d_clock(clock ? clock : Clock(&monotonicNow))
+, d_heartbeatFrame(Framer::makeHeartbeatFrame())
+, d_pollEvent()
+, d_timeoutSeconds()
+, d_sendHeartbeat()
+, d_killConnection()
+, d_active(false)
+, d_readsPaused(false)
+, d_livenessCheckPosted(false)
+, d_lastSentNs(0)
+, d_lastReceivedNs(0)
+, d_heartbeatIntervalNs(0)
+, d_disconnectTimeoutNs(0)
+{
+}
+
+ThreadedHeartbeatManager::~ThreadedHeartbeatManager()
+{
+    // May run on the scheduler thread, when `poll` held the last reference
+    cancelPolling(false);
+}
+
+void ThreadedHeartbeatManager::start(
+    uint32_t timeoutSeconds,
+    const HeartbeatCallback& sendHeartbeat,
+    const ConnectionDeathCallback& onConnectionDeath)
+{
+    cancelPolling(true);
+
+    const bsls::Types::Int64 now = nowNs();
+
+    d_timeoutSeconds = timeoutSeconds;
+    d_sendHeartbeat  = sendHeartbeat;
+    d_killConnection = onConnectionDeath;
+    d_lastSentNs     = now;
+    d_lastReceivedNs = now;
+    d_livenessCheckPosted = false;
+    // Doubled until the first heartbeat arrives, see `HeartbeatManagerImpl`
+    d_disconnectTimeoutNs =
+        bsls::TimeInterval(timeoutSeconds * 2 + TICK_TIME, 0)
+            .totalNanoseconds();
+
+    bsls::TimeInterval heartbeatInterval;
+    heartbeatInterval.addMilliseconds(timeoutSeconds * 1000 / 2);
+    d_heartbeatIntervalNs = heartbeatInterval.totalNanoseconds();
+    d_active              = true;
+
+    if (!d_scheduler) {
+        return;
+    }
+
+    bsls::TimeInterval period;
+    period.addMilliseconds(bsl::max(
+        MIN_POLL_MILLISECONDS,
+        bsl::min<int>(MAX_POLL_MILLISECONDS, timeoutSeconds * 1000 / 4)));
+    d_scheduler->scheduleRecurringEvent(
+        &d_pollEvent,
+        period,
+        bdlf::BindUtil::bind(&ThreadedHeartbeatManager::pollWeak,
+                             weak_from_this()));
+}
+
+void ThreadedHeartbeatManager::stop()
+{
+    d_active = false;
+    cancelPolling(true);
+}
+
+void ThreadedHeartbeatManager::cancelPolling(bool wait)
+{
+    if (!d_scheduler || !d_pollEvent) {
+        return;
+    }
+
+    if (wait) {
+        d_scheduler->cancelEventAndWait(d_pollEvent);
+    }
+    else {
+        d_scheduler->cancelEvent(d_pollEvent);
+    }
+    d_pollEvent.release();
+}
+
+void ThreadedHeartbeatManager::pollWeak(
+    const bsl::weak_ptr<ThreadedHeartbeatManager>& weak)
+{
+    bsl::shared_ptr<ThreadedHeartbeatManager> self = weak.lock();
+    if (self) {
+        self->poll();
+    }
+}
+
+void ThreadedHeartbeatManager::poll()
+{
+    if (!d_active) {
+        return;
+    }
+
+    const bsls::Types::Int64 now = nowNs();
+    if (now - d_lastSentNs >= d_heartbeatIntervalNs) {
+        d_lastSentNs = now;
+        d_post(bdlf::BindUtil::bind(
+            &ThreadedHeartbeatManager::sendHeartbeatWeak, weak_from_this()));
+    }
+    if (!d_readsPaused && now - d_lastReceivedNs >= d_disconnectTimeoutNs &&
+        !d_livenessCheckPosted.testAndSwap(false, true)) {
+        d_post(bdlf::BindUtil::bind(
+            &ThreadedHeartbeatManager::checkLivenessWeak, weak_from_this()));
+    }
+}
+
+void ThreadedHeartbeatManager::sendHeartbeatWeak(
+    const bsl::weak_ptr<ThreadedHeartbeatManager>& weak)
+{
+    bsl::shared_ptr<ThreadedHeartbeatManager> self = weak.lock();
+    if (self && self->d_active) {
+        RMQT_LOG_DEBUG << "Heartbeat Triggered";
+        self->d_sendHeartbeat(self->d_heartbeatFrame);
+    }
+}
+
+void ThreadedHeartbeatManager::checkLivenessWeak(
+    const bsl::weak_ptr<ThreadedHeartbeatManager>& weak)
+{
+    bsl::shared_ptr<ThreadedHeartbeatManager> self = weak.lock();
+    if (self) {
+        self->checkLiveness();
+    }
+}
+
+void ThreadedHeartbeatManager::checkLiveness()
+{
+    d_livenessCheckPosted = false;
+    if (!d_active || d_readsPaused) {
+        return;
+    }
+
+    // Frames read while this waited on the loop have been noted by now
+    const bsls::Types::Int64 now = nowNs();
+    if (now - d_lastReceivedNs >= d_disconnectTimeoutNs) {
+        BALL_LOG_WARN << "Received no heartbeats for " << d_timeoutSeconds
+                      << "seconds. Triggering connection termination";
+        d_lastReceivedNs = now;
+        d_killConnection();
+    }
+}
+
+void ThreadedHeartbeatManager::notifyMessageSent()
+{
+    if (d_active) {
+        d_lastSentNs = nowNs();
+    }
+}
+
+void ThreadedHeartbeatManager::notifyMessageReceived()
+{
+    if (d_active) {
+        d_lastReceivedNs = nowNs();
+    }
+}
+
+void ThreadedHeartbeatManager::setReadsPaused(bool paused)
+{
+    if (paused == d_readsPaused) {
+        return;
+    }
+
+    d_readsPaused = paused;
+    if (!paused) {
+        // Frames held back by the pause are not the broker's fault
+        d_lastReceivedNs = nowNs();
+    }
+}
+
+void ThreadedHeartbeatManager::notifyHeartbeatReceived()
+{
+    d_disconnectTimeoutNs =
+        bsls::TimeInterval(d_timeoutSeconds + TICK_TIME, 0)
+            .totalNanoseconds();
+    d_lastReceivedNs = nowNs();
+}
+
+bsls::Types::Int64 ThreadedHeartbeatManager::nowNs() const
+{
+    return d_clock().totalNanoseconds();
+}
+
+} // namespace rmqamqp
+} // namespace BloombergLP
@@ -0,0 +1,134 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQAMQP_THREADEDHEARTBEATMANAGER
+#define INCLUDED_RMQAMQP_THREADEDHEARTBEATMANAGER
+
+#include <rmqamqp_heartbeatmanager.h>
+
+#include <rmqamqpt_frame.h>
+
+#include <bdlmt_eventscheduler.h>
+#include <bsls_atomic.h>
+#include <bsls_keyword.h>
+#include <bsls_timeinterval.h>
+#include <bsls_types.h>
+
+#include <bsl_functional.h>
+#include <bsl_memory.h>
+
+//@PURPOSE: Schedule AMQP heartbeats from a dedicated timer thread
+//
+//@CLASSES:
+//  rmqamqp::ThreadedHeartbeatManager: Implements rmqamqp::HeartbeatManager
+//      off the event loop
+
+namespace BloombergLP {
+namespace rmqamqp {
+
+/// Deadlines are checked on the thread of a `bdlmt::EventScheduler`, which
+/// may be shared between connections, rather than by an event loop timer,
+/// so the check itself never waits behind a saturated loop. Sent and
+/// received frames only store the time in an atomic. When a heartbeat is
+/// due, sending it is posted to the event loop, as the socket may only be
+/// written from there; `rmqio::WriteQueue` puts it ahead of queued content.
+/// A missed disconnect deadline is checked again on the loop before the
+/// connection is killed, so frames which arrived while the loop was busy
+/// still count.
+///
+/// Must be owned by a `bsl::shared_ptr`: posted work holds a weak pointer.
+
+class ThreadedHeartbeatManager
+: public HeartbeatManager,
+  public bsl::enable_shared_from_this<ThreadedHeartbeatManager> {
+  public:
+    /// Returns the current time, monotonic
+    typedef bsl::function<bsls::TimeInterval()> Clock;
+
+    /// Runs the given function on the connection's event loop
+    typedef bsl::function<void(const bsl::function<void()>&)> Post;
+
+    /// Construct a manager which checks its deadlines on `scheduler`'s
+    /// thread and runs callbacks through `post`. With a null `scheduler`
+    /// nothing checks the deadlines but `poll`.
+    /// \param clock the monotonic system clock if empty
+    ThreadedHeartbeatManager(
+        const bsl::shared_ptr<bdlmt::EventScheduler>& scheduler,
+        const Post& post,
+        const Clock& clock = Clock());
+
+    ~ThreadedHeartbeatManager() BSLS_KEYWORD_OVERRIDE;
+
+    virtual void start(uint32_t timeoutSeconds,
+                       const HeartbeatCallback& sendHeartbeat,
+                       const ConnectionDeathCallback& onConnectionDeath)
+        BSLS_KEYWORD_OVERRIDE;
+    virtual void stop() BSLS_KEYWORD_OVERRIDE;
+
+    virtual void notifyMessageSent() BSLS_KEYWORD_OVERRIDE;
+    virtual void notifyMessageReceived() BSLS_KEYWORD_OVERRIDE;
+
+    virtual void notifyHeartbeatReceived() BSLS_KEYWORD_OVERRIDE;
+
+    virtual void setReadsPaused(bool paused) BSLS_KEYWORD_OVERRIDE;
+
+    /// Check the deadlines as of now, posting a heartbeat or a liveness
+    /// check if one has passed. Run periodically on the scheduler thread.
+    void poll();
+
+  private:
+    ThreadedHeartbeatManager(const ThreadedHeartbeatManager&)
+        BSLS_KEYWORD_DELETED;
+    ThreadedHeartbeatManager&
+    operator=(const ThreadedHeartbeatManager&) BSLS_KEYWORD_DELETED;
+
+    static void pollWeak(const bsl::weak_ptr<ThreadedHeartbeatManager>& weak);
+    static void
+    sendHeartbeatWeak(const bsl::weak_ptr<ThreadedHeartbeatManager>& weak);
+    static void
+    checkLivenessWeak(const bsl::weak_ptr<ThreadedHeartbeatManager>& weak);
+
+    /// Event loop thread
+    void checkLiveness();
+
+    bsls::Types::Int64 nowNs() const;
+
+    void cancelPolling(bool wait);
+
+  private:
+    const bsl::shared_ptr<bdlmt::EventScheduler> d_scheduler;
+    const Post d_post;
+    const Clock d_clock;
+    const rmqamqpt::Frame d_heartbeatFrame;
+    bdlmt::EventScheduler::RecurringEventHandle d_pollEvent;
+
+    // Only touched on the event loop thread
+    uint32_t d_timeoutSeconds;
+    HeartbeatCallback d_sendHeartbeat;
+    ConnectionDeathCallback d_killConnection;
+
+    bsls::AtomicBool d_active;
+    bsls::AtomicBool d_readsPaused;
+    bsls::AtomicBool d_livenessCheckPosted;
+    bsls::AtomicInt64 d_lastSentNs;
+    bsls::AtomicInt64 d_lastReceivedNs;
+    bsls::AtomicInt64 d_heartbeatIntervalNs;
+    bsls::AtomicInt64 d_disconnectTimeoutNs;
+}; // class ThreadedHeartbeatManager
+
+} // namespace rmqamqp
+} // namespace BloombergLP
+
+#endif
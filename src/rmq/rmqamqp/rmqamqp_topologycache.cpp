@@ -0,0 +1,131 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqamqp_topologycache.h>
+
+#include <rmqt_fieldvalue.h>
+#include <rmqt_log.h>
+
+#include <ball_log.h>
+
+namespace BloombergLP {
+namespace rmqamqp {
+
+namespace {
+BALL_LOG_SET_NAMESPACE_CATEGORY("RMQAMQP.TOPOLOGYCACHE")
+} // namespace
+
+TopologyCache::TopologyCache()
+: d_queues()
+, d_exchanges()
+{
+}
+
+rmqt::Topology
+TopologyCache::undeclared(const rmqt::Topology& topology) const
+{
+    rmqt::Topology result;
+    for (rmqt::Topology::QueueVec::const_iterator it = topology.queues.begin();
+         it != topology.queues.end();
+         ++it) {
+        if (!isDeclared(**it)) {
+            result.queues.push_back(*it);
+        }
+    }
+    for (rmqt::Topology::ExchangeVec::const_iterator it =
+             topology.exchanges.begin();
+         it != topology.exchanges.end();
+         ++it) {
+        if (!isDeclared(**it)) {
+            result.exchanges.push_back(*it);
+        }
+    }
+    result.queueBindings    = topology.queueBindings;
+    result.exchangeBindings = topology.exchangeBindings;
+
+    const bsl::size_t skipped =
+        topology.queues.size() + topology.exchanges.size() -
+        result.queues.size() - result.exchanges.size();
+    if (skipped > 0) {
+        RMQT_LOG_DEBUG << "Skipping " << skipped
+                       << " queues/exchanges already declared on this "
+                          "connection";
+    }
+
+    return result;
+}
+
+void TopologyCache::recordDeclared(const rmqt::Topology& topology)
+{
+    for (rmqt::Topology::QueueVec::const_iterator it = topology.queues.begin();
+         it != topology.queues.end();
+         ++it) {
+        const bsl::shared_ptr<rmqt::Queue>& queue = *it;
+        if (!queue->name().empty() && !queue->autoDelete()) {
+            d_queues[queue->name()] = queue;
+        }
+    }
+    for (rmqt::Topology::ExchangeVec::const_iterator it =
+             topology.exchanges.begin();
+         it != topology.exchanges.end();
+         ++it) {
+        const bsl::shared_ptr<rmqt::Exchange>& exchange = *it;
+        if (!exchange->isDefault() && !exchange->autoDelete()) {
+            d_exchanges[exchange->name()] = exchange;
+        }
+    }
+}
+
+void TopologyCache::recordUpdate(const rmqt::TopologyUpdate& topologyUpdate)
+{
+    for (rmqt::TopologyUpdate::UpdatesVec::const_iterator it =
+             topologyUpdate.updates.begin();
+         it != topologyUpdate.updates.end();
+         ++it) {
+        if (it->is<bsl::shared_ptr<rmqt::QueueDelete> >()) {
+            d_queues.erase(
+                it->the<bsl::shared_ptr<rmqt::QueueDelete> >()->name());
+        }
+    }
+}
+
+void TopologyCache::clear()
+{
+    d_queues.clear();
+    d_exchanges.clear();
+}
+
+bool TopologyCache::isDeclared(const rmqt::Queue& queue) const
+{
+    QueueMap::const_iterator it = d_queues.find(queue.name());
+    if (it == d_queues.end()) {
+        return false;
+    }
+
+    const rmqt::Queue& declared = *it->second;
+    return declared.passive() == queue.passive() &&
+           declared.autoDelete() == queue.autoDelete() &&
+           declared.durable() == queue.durable() &&
+           declared.arguments() == queue.arguments();
+}
+
+bool TopologyCache::isDeclared(const rmqt::Exchange& exchange) const
+{
+    ExchangeMap::const_iterator it = d_exchanges.find(exchange.name());
+    return it != d_exchanges.end() && *it->second == exchange;
+}
+
+} // namespace rmqamqp
+} // namespace BloombergLP
@@ -0,0 +1,80 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQAMQP_TOPOLOGYCACHE
+#define INCLUDED_RMQAMQP_TOPOLOGYCACHE
+
+#include <rmqt_exchange.h>
+#include <rmqt_queue.h>
+#include <rmqt_topology.h>
+#include <rmqt_topologyupdate.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_map.h>
+#include <bsl_memory.h>
+#include <bsl_string.h>
+
+namespace BloombergLP {
+namespace rmqamqp {
+
+//@PURPOSE: Track the topology a connection has already declared
+//
+//@CLASSES:
+//  rmqamqp::TopologyCache: queues and exchanges declared on a connection
+
+/// \brief Remembers the queues and exchanges the broker has confirmed
+///
+/// Channels on one connection often share exchanges and queues. Once one
+/// channel's declaration of an entity has been confirmed, later channels
+/// skip declaring an identical entity. Entries must be cleared whenever the
+/// connection is lost, since the broker may not keep them. Server-named and
+/// auto-delete entities are never cached, as they may change or vanish
+/// while the connection is up.
+
+class TopologyCache {
+  public:
+    TopologyCache();
+
+    /// Return `topology` without the queues and exchanges already declared
+    /// with identical properties. Bindings are kept.
+    rmqt::Topology undeclared(const rmqt::Topology& topology) const;
+
+    /// Record the queues and exchanges of `topology` as declared
+    void recordDeclared(const rmqt::Topology& topology);
+
+    /// Forget the queues deleted by the confirmed `topologyUpdate`
+    void recordUpdate(const rmqt::TopologyUpdate& topologyUpdate);
+
+    /// Forget every entity, e.g. when the connection is lost
+    void clear();
+
+    bsl::size_t size() const { return d_queues.size() + d_exchanges.size(); }
+
+  private:
+    bool isDeclared(const rmqt::Queue& queue) const;
+    bool isDeclared(const rmqt::Exchange& exchange) const;
+
+    typedef bsl::map<bsl::string, bsl::shared_ptr<rmqt::Queue> > QueueMap;
+    typedef bsl::map<bsl::string, bsl::shared_ptr<rmqt::Exchange> >
+        ExchangeMap;
+
+    QueueMap d_queues;
+    ExchangeMap d_exchanges;
+};
+
+} // namespace rmqamqp
+} // namespace BloombergLP
+
+#endif
@@ -15,10 +15,11 @@
 
 #include <rmqamqp_topologymerger.h>
 
+#include <rmqt_log.h>
+
 #include <ball_log.h>
-#include <bdlf_bind.h>
-#include <bsl_algorithm.h>
-#include <bsl_memory.h>
+
+#include <bsl_utility.h>
 
 namespace BloombergLP {
 namespace rmqamqp {
@@ -26,102 +27,122 @@ namespace rmqamqp {
 namespace {
 BALL_LOG_SET_NAMESPACE_CATEGORY("RMQAMQP.TOPOLOGYMERGER")
 
+/// Load the index key of `binding` into `key`. Return false if its queue
+/// or exchange has been destructed.
 template <typename T>
-bool findByBinding(const bsl::string& exchangeName,
-                   const bsl::string& queueName,
-                   const bsl::string& bindingKey,
-                   const bsl::shared_ptr<T>& binding)
+bool indexKey(const T& binding, bsl::string* key)
 {
-    bsl::shared_ptr<rmqt::Exchange> exchange = binding->exchange().lock();
+    bsl::shared_ptr<rmqt::Exchange> exchange = binding.exchange().lock();
     if (!exchange) {
+        BALL_LOG_ERROR << "Exchange object passed to " << binding
+                       << " was destructed. Cannot apply it to reconnect "
+                          "topology.";
         return false;
     }
-    bsl::shared_ptr<rmqt::Queue> queue = binding->queue().lock();
+    bsl::shared_ptr<rmqt::Queue> queue = binding.queue().lock();
     if (!queue) {
+        BALL_LOG_ERROR << "Queue object passed to " << binding
+                       << " was destructed. Cannot apply it to reconnect "
+                          "topology.";
         return false;
     }
 
-    if (exchangeName == exchange->name() && queueName == queue->name() &&
-        bindingKey == binding->bindingKey()) {
-        return true;
-    }
-    return false;
+    // Names cannot contain NUL, so the key is unambiguous
+    key->assign(exchange->name());
+    key->push_back('\0');
+    key->append(queue->name());
+    key->push_back('\0');
+    key->append(binding.bindingKey());
+    return true;
 }
 
 } // namespace
 
-void TopologyMerger::merge(rmqt::Topology& topology,
-                           const rmqt::TopologyUpdate& topologyUpdate)
+TopologyMerger::TopologyMerger(rmqt::Topology* topology)
+: d_topology(topology)
+, d_queueBindings()
+, d_keys()
 {
+    rmqt::Topology::QueueBindingVec& bindings = d_topology->queueBindings;
+
+    bsl::size_t kept = 0;
+    bsl::string key;
+    for (bsl::size_t i = 0; i < bindings.size(); ++i) {
+        if (!indexKey(*bindings[i], &key)) {
+            key.clear();
+        }
+        else if (!d_queueBindings.insert(bsl::make_pair(key, kept)).second) {
+            RMQT_LOG_DEBUG << "Collapsing duplicate " << *bindings[i];
+            continue;
+        }
+        bindings[kept++] = bindings[i];
+        d_keys.push_back(key);
+    }
+    bindings.resize(kept);
+}
+
+void TopologyMerger::apply(const rmqt::TopologyUpdate& topologyUpdate)
+{
+    bsl::string key;
     for (rmqt::TopologyUpdate::UpdatesVec::const_iterator it =
              topologyUpdate.updates.cbegin();
          it != topologyUpdate.updates.cend();
          ++it) {
         const rmqt::TopologyUpdate::SupportedUpdate& update = *it;
         if (update.is<bsl::shared_ptr<rmqt::QueueBinding> >()) {
-            const bsl::shared_ptr<rmqt::QueueBinding>& queueBinding =
-                update.the<bsl::shared_ptr<rmqt::QueueBinding> >();
-            bsl::shared_ptr<rmqt::Exchange> exchange =
-                queueBinding->exchange().lock();
-            if (!exchange) {
-                BALL_LOG_ERROR
-                    << "Exchange object passed to bind update was destructed. "
-                       "Cannot apply bind to reconnect topology.";
-                continue;
-            }
-            bsl::shared_ptr<rmqt::Queue> queue = queueBinding->queue().lock();
-            if (!queue) {
-                BALL_LOG_ERROR
-                    << "Queue object passed to bind update was destructed. "
-                       "Cannot apply bind to reconnect topology.";
-                continue;
-            }
-            using bdlf::PlaceHolders::_1;
-            rmqt::Topology::QueueBindingVec::const_iterator iter = bsl::find_if(
-                topology.queueBindings.cbegin(),
-                topology.queueBindings.cend(),
-                bdlf::BindUtil::bind(findByBinding<rmqt::QueueBinding>,
-                                     exchange->name(),
-                                     queue->name(),
-                                     queueBinding->bindingKey(),
-                                     _1));
-            if (iter == topology.queueBindings.cend()) {
-                topology.queueBindings.push_back(
-                    update.the<bsl::shared_ptr<rmqt::QueueBinding> >());
-            }
+            addBinding(update.the<bsl::shared_ptr<rmqt::QueueBinding> >());
         }
         else if (update.is<bsl::shared_ptr<rmqt::QueueUnbinding> >()) {
-            const bsl::shared_ptr<rmqt::QueueUnbinding>& queueUnbinding =
-                update.the<bsl::shared_ptr<rmqt::QueueUnbinding> >();
-            bsl::shared_ptr<rmqt::Exchange> exchange =
-                queueUnbinding->exchange().lock();
-            if (!exchange) {
-                BALL_LOG_ERROR
-                    << "Exchange object passed to unbind update was "
-                       "destructed. Cannot apply unbind to reconnect topology.";
-                continue;
+            if (indexKey(*update.the<bsl::shared_ptr<rmqt::QueueUnbinding> >(),
+                         &key)) {
+                removeBinding(key);
             }
-            bsl::shared_ptr<rmqt::Queue> queue = queueUnbinding->queue().lock();
-            if (!queue) {
-                BALL_LOG_ERROR
-                    << "Queue object passed to unbind update was destructed. "
-                       "Cannot apply unbind to reconnect topology.";
-                continue;
-            }
-            using bdlf::PlaceHolders::_1;
-            topology.queueBindings.erase(
-                bsl::remove_if(
-                    topology.queueBindings.begin(),
-                    topology.queueBindings.end(),
-                    bdlf::BindUtil::bind(findByBinding<rmqt::QueueBinding>,
-                                         exchange->name(),
-                                         queue->name(),
-                                         queueUnbinding->bindingKey(),
-                                         _1)),
-                topology.queueBindings.end());
         }
     }
 }
 
+void TopologyMerger::merge(rmqt::Topology& topology,
+                           const rmqt::TopologyUpdate& topologyUpdate)
+{
+    TopologyMerger(&topology).apply(topologyUpdate);
+}
+
+void TopologyMerger::addBinding(
+    const bsl::shared_ptr<rmqt::QueueBinding>& binding)
+{
+    bsl::string key;
+    if (!indexKey(*binding, &key)) {
+        return;
+    }
+
+    rmqt::Topology::QueueBindingVec& bindings = d_topology->queueBindings;
+    if (d_queueBindings.insert(bsl::make_pair(key, bindings.size())).second) {
+        bindings.push_back(binding);
+        d_keys.push_back(key);
+    }
+}
+
+void TopologyMerger::removeBinding(const bsl::string& key)
+{
+    BindingIndex::iterator found = d_queueBindings.find(key);
+    if (found == d_queueBindings.end()) {
+        return;
+    }
+
+    // Fill the gap with the last binding rather than shifting the rest down
+    rmqt::Topology::QueueBindingVec& bindings = d_topology->queueBindings;
+    const bsl::size_t position = found->second;
+    d_queueBindings.erase(found);
+    if (position + 1 != bindings.size()) {
+        bindings[position] = bindings.back();
+        d_keys[position].swap(d_keys.back());
+        if (!d_keys[position].empty()) {
+            d_queueBindings[d_keys[position]] = position;
+        }
+    }
+    bindings.pop_back();
+    d_keys.pop_back();
+}
+
 } // namespace rmqamqp
 } // namespace BloombergLP
@@ -19,15 +19,53 @@
 #include <rmqt_topology.h>
 #include <rmqt_topologyupdate.h>
 
+#include <bsl_cstddef.h>
+#include <bsl_memory.h>
+#include <bsl_string.h>
+#include <bsl_unordered_map.h>
+#include <bsl_vector.h>
+
 namespace BloombergLP {
 namespace rmqamqp {
 
 //@PURPOSE: Merge rmqt::Topology with rmqt::TopologyUpdate
 //
+//@CLASSES:
+//  rmqamqp::TopologyMerger: applies topology updates to a topology
+
+/// \brief Applies confirmed topology updates to a channel's topology
+///
+/// Queue bindings are indexed by exchange, queue and binding key, so each
+/// update costs time proportional to its own size rather than to the whole
+/// topology. Indexing a topology collapses any duplicate bindings in it.
+
 class TopologyMerger {
   public:
+    /// Index the bindings in `topology`, which must outlive this object and
+    /// only be modified through it
+    explicit TopologyMerger(rmqt::Topology* topology);
+
+    /// Add the bindings and remove the unbindings in `topologyUpdate`
+    void apply(const rmqt::TopologyUpdate& topologyUpdate);
+
+    /// Apply `topologyUpdate` to `topology` without keeping an index
     static void merge(rmqt::Topology& topology,
                       const rmqt::TopologyUpdate& topologyUpdate);
+
+  private:
+    typedef bsl::unordered_map<bsl::string, bsl::size_t> BindingIndex;
+
+    void addBinding(const bsl::shared_ptr<rmqt::QueueBinding>& binding);
+    void removeBinding(const bsl::string& key);
+
+    rmqt::Topology* d_topology;
+
+    /// Position of each binding in `d_topology->queueBindings`
+    BindingIndex d_queueBindings;
+
+    /// Key of each binding in `d_topology->queueBindings`, empty for those
+    /// which could not be indexed
+    bsl::vector<bsl::string> d_keys;
 };
 
 } // namespace rmqamqp
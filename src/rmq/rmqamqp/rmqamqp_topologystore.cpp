@@ -0,0 +1,124 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqamqp_topologystore.h>
+
+#include <rmqt_log.h>
+
+#include <ball_log.h>
+#include <bdls_filesystemutil.h>
+#include <bdls_pathutil.h>
+
+#include <bsl_cstdint.h>
+#include <bsl_fstream.h>
+#include <bsl_iomanip.h>
+#include <bsl_sstream.h>
+
+namespace BloombergLP {
+namespace rmqamqp {
+
+namespace {
+BALL_LOG_SET_NAMESPACE_CATEGORY("RMQAMQP.TOPOLOGYSTORE")
+
+/// 64 bit FNV-1a, which unlike `bsl::hash` is the same in every process
+bsl::uint64_t fnv1a(const bsl::string& text)
+{
+    bsl::uint64_t hash = 14695981039346656037ULL;
+    for (bsl::string::const_iterator it = text.begin(); it != text.end();
+         ++it) {
+        hash ^= static_cast<unsigned char>(*it);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+bsl::string toHex(bsl::uint64_t value)
+{
+    bsl::ostringstream os;
+    os << bsl::hex << bsl::setw(16) << bsl::setfill('0') << value;
+    return os.str();
+}
+
+} // namespace
+
+TopologyStore::TopologyStore(const bsl::string& directory,
+                             const bsl::string& vhost)
+: d_directory(directory)
+, d_vhost(vhost)
+, d_clusterName()
+{
+}
+
+void TopologyStore::setClusterName(const bsl::string& clusterName)
+{
+    d_clusterName = clusterName;
+}
+
+bsl::string TopologyStore::fingerprint(const rmqt::Topology& topology)
+{
+    // The description covers every entity, property, argument and binding
+    bsl::ostringstream description;
+    description << topology;
+    return toHex(fnv1a(description.str()));
+}
+
+bsl::string TopologyStore::recordPath(const rmqt::Topology& topology) const
+{
+    if (d_clusterName.empty()) {
+        return bsl::string();
+    }
+
+    const bsl::string key = d_vhost + '\n' + d_clusterName + '\n' +
+                            fingerprint(topology);
+
+    bsl::string path = d_directory;
+    if (bdls::PathUtil::appendIfValid(&path, "topology-" + toHex(fnv1a(key)))) {
+        return bsl::string();
+    }
+    return path;
+}
+
+bool TopologyStore::contains(const rmqt::Topology& topology) const
+{
+    const bsl::string path = recordPath(topology);
+    return !path.empty() && bdls::FilesystemUtil::exists(path);
+}
+
+void TopologyStore::record(const rmqt::Topology& topology)
+{
+    const bsl::string path = recordPath(topology);
+    if (path.empty() || bdls::FilesystemUtil::exists(path)) {
+        return;
+    }
+
+    bsl::ofstream file(path.c_str());
+    if (!file) {
+        BALL_LOG_WARN << "Could not record declared topology in " << path;
+        return;
+    }
+    RMQT_LOG_DEBUG << "Recorded declared topology in " << path;
+}
+
+void TopologyStore::forget(const rmqt::Topology& topology)
+{
+    const bsl::string path = recordPath(topology);
+    if (!path.empty() && bdls::FilesystemUtil::exists(path)) {
+        BALL_LOG_INFO << "Forgetting declared topology recorded in " << path;
+        bdls::FilesystemUtil::remove(path);
+    }
+}
+
+} // namespace rmqamqp
+} // namespace BloombergLP
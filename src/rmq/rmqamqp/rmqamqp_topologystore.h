@@ -0,0 +1,80 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQAMQP_TOPOLOGYSTORE
+#define INCLUDED_RMQAMQP_TOPOLOGYSTORE
+
+#include <rmqt_topology.h>
+
+#include <bsl_string.h>
+
+namespace BloombergLP {
+namespace rmqamqp {
+
+//@PURPOSE: Remember across restarts which topologies a broker has accepted
+//
+//@CLASSES:
+//  rmqamqp::TopologyStore: on-disk record of verified topologies
+
+/// \brief Records, in a directory, the topologies a broker cluster has
+/// accepted, so that a restarted process need not declare them again
+///
+/// Each record is an empty marker file named after a hash of the vhost, the
+/// broker's `cluster_name`, and the full description of the topology, so a
+/// change to any entity, property or binding misses the record. A record
+/// only says the topology was declared once: it may have been deleted
+/// since, so a channel finding one still checks that a sentinel entity
+/// exists, and forgets the record if it does not.
+///
+/// Failing to read or write the directory is logged and otherwise treated
+/// as a missing record.
+
+class TopologyStore {
+  public:
+    /// Keep records in `directory`, which must exist, for `vhost`
+    TopologyStore(const bsl::string& directory, const bsl::string& vhost);
+
+    /// Set the `cluster_name` the broker reported when connecting. Records
+    /// are only kept once it is known.
+    void setClusterName(const bsl::string& clusterName);
+
+    /// Return true if `topology` was recorded as declared on this vhost of
+    /// the current cluster
+    bool contains(const rmqt::Topology& topology) const;
+
+    /// Record `topology` as declared on this vhost of the current cluster
+    void record(const rmqt::Topology& topology);
+
+    /// Remove the record of `topology`, e.g. when its sentinel is missing
+    void forget(const rmqt::Topology& topology);
+
+    /// Return a hash of everything `topology` declares, stable across
+    /// processes, as 16 hex digits
+    static bsl::string fingerprint(const rmqt::Topology& topology);
+
+  private:
+    /// Return the path of the record of `topology`, or an empty string if
+    /// the cluster is not known yet
+    bsl::string recordPath(const rmqt::Topology& topology) const;
+
+    bsl::string d_directory;
+    bsl::string d_vhost;
+    bsl::string d_clusterName;
+};
+
+} // namespace rmqamqp
+} // namespace BloombergLP
+
+#endif
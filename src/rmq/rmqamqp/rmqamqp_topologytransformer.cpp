@@ -45,14 +45,30 @@ namespace {
 BALL_LOG_SET_NAMESPACE_CATEGORY("RMQAMQP.TOPOLOGYTRANSFORMER")
 } // namespace
 
-TopologyTransformer::TopologyTransformer(const rmqt::Topology& topology)
+TopologyTransformer::TopologyTransformer(const rmqt::Topology& topology,
+                                         bool pipelined)
 : d_messages()
 , d_sentMessageCount(0)
 , d_receivedReplyCount(0)
 , d_error(false)
+, d_pipelineLength(0)
 , d_expectedReplies()
 , d_expectedQueueNames()
 {
+    if (pipelined) {
+        d_pipelineLength = topology.queues.size() +
+                           topology.queueBindings.size() +
+                           topology.exchangeBindings.size();
+        for (rmqt::Topology::ExchangeVec::const_iterator it =
+                 topology.exchanges.begin();
+             it != topology.exchanges.end();
+             ++it) {
+            if (!(*it)->isDefault()) {
+                ++d_pipelineLength;
+            }
+        }
+    }
+
     bsl::for_each(topology.queues.begin(),
                   topology.queues.end(),
                   bdlf::BindUtil::bind(&TopologyTransformer::processQueue,
@@ -83,6 +99,7 @@ TopologyTransformer::TopologyTransformer(const rmqt::TopologyUpdate& topology)
 , d_sentMessageCount(0)
 , d_receivedReplyCount(0)
 , d_error(false)
+, d_pipelineLength(0)
 , d_expectedReplies()
 , d_expectedQueueNames()
 {
@@ -193,15 +210,18 @@ bool TopologyTransformer::isDone() const
 void TopologyTransformer::processQueue(
     const bsl::shared_ptr<rmqt::Queue>& queue)
 {
+    const bool noWait = !queue->name().empty() && nextIsPipelined();
     rmqamqpt::QueueDeclare declare(queue->name(),
                                    queue->passive(),
                                    queue->durable(),
                                    false,
                                    queue->autoDelete(),
-                                   false,
+                                   noWait,
                                    queue->arguments());
-    d_expectedReplies.push(QUEUE);
-    d_expectedQueueNames.push(queue->name());
+    if (!noWait) {
+        d_expectedReplies.push(QUEUE);
+        d_expectedQueueNames.push(queue->name());
+    }
     d_messages.push_back(
         Message(rmqamqpt::Method(rmqamqpt::QueueMethod(declare))));
 }
@@ -211,15 +231,18 @@ void TopologyTransformer::processExchange(
 {
     if (exchange->isDefault())
         return;
+    const bool noWait = nextIsPipelined();
     rmqamqpt::ExchangeDeclare declare(exchange->name(),
                                       exchange->type(),
                                       exchange->passive(),
                                       exchange->durable(),
                                       exchange->autoDelete(),
                                       exchange->internal(),
-                                      false,
+                                      noWait,
                                       exchange->arguments());
-    d_expectedReplies.push(EXCHANGE);
+    if (!noWait) {
+        d_expectedReplies.push(EXCHANGE);
+    }
     d_messages.push_back(
         Message(rmqamqpt::Method(rmqamqpt::ExchangeMethod(declare))));
 }
@@ -242,14 +265,17 @@ void TopologyTransformer::processQueueBinding(
         return;
     }
 
+    const bool noWait = nextIsPipelined();
     rmqamqpt::QueueBind bind(queue->name(),
                              exchange->name(),
                              binding->bindingKey(),
-                             false,
+                             noWait,
                              binding->args());
     d_messages.push_back(
         Message(rmqamqpt::Method(rmqamqpt::QueueMethod(bind))));
-    d_expectedReplies.push(QUEUE_BINDING);
+    if (!noWait) {
+        d_expectedReplies.push(QUEUE_BINDING);
+    }
 }
 
 void TopologyTransformer::processQueueUnbinding(
@@ -310,14 +336,24 @@ void TopologyTransformer::processExchangeBinding(
         return;
     }
 
+    const bool noWait = nextIsPipelined();
     rmqamqpt::ExchangeBind bind(sourceX->name(),
                                 destinationX->name(),
                                 binding->bindingKey(),
-                                false,
+                                noWait,
                                 binding->args());
     d_messages.push_back(
         Message(rmqamqpt::Method(rmqamqpt::ExchangeMethod(bind))));
-    d_expectedReplies.push(EXCHANGE_BINDING);
+    if (!noWait) {
+        d_expectedReplies.push(EXCHANGE_BINDING);
+    }
+}
+
+bool TopologyTransformer::nextIsPipelined() const
+{
+    // The last message is always sent synchronously: its reply confirms
+    // every method pipelined ahead of it
+    return d_messages.size() + 1 < d_pipelineLength;
 }
 
 void TopologyTransformer::processUpdate(
@@ -37,7 +37,14 @@ namespace rmqamqp {
 
 class TopologyTransformer {
   public:
-    explicit TopologyTransformer(const rmqt::Topology& topology);
+    /// Transform `topology` into declare and bind messages. When
+    /// `pipelined` is true every idempotent method except the last is sent
+    /// with no-wait set, so only the final method is answered: the broker
+    /// handles a channel's methods in order and closes the channel on any
+    /// failure, so that single -ok confirms the whole topology. Methods
+    /// declaring server-named queues always wait for their reply.
+    explicit TopologyTransformer(const rmqt::Topology& topology,
+                                 bool pipelined = false);
     explicit TopologyTransformer(const rmqt::TopologyUpdate& topology);
 
     /// Returns true iff there is at least one more message to be sent.
@@ -68,12 +75,16 @@ class TopologyTransformer {
     void processExchangeBinding(const bsl::shared_ptr<rmqt::ExchangeBinding>&);
     void processUpdate(const rmqt::TopologyUpdate::SupportedUpdate&);
 
+    /// Returns true iff the next message can be sent with no-wait set
+    bool nextIsPipelined() const;
+
   private:
     bsl::vector<Message> d_messages;
 
     size_t d_sentMessageCount;
     size_t d_receivedReplyCount;
     bool d_error;
+    size_t d_pipelineLength;
 
     // Expected replies
     enum Reply {
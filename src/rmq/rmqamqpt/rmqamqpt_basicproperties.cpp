@@ -16,11 +16,13 @@
 #include <rmqamqpt_basicproperties.h>
 
 #include <rmqamqpt_buffer.h>
+#include <rmqamqpt_encodedfieldtable.h>
 #include <rmqamqpt_fieldvalue.h>
 #include <rmqamqpt_types.h>
 #include <rmqamqpt_writer.h>
 
 #include <rmqt_fieldvalue.h>
+#include <rmqt_log.h>
 #include <rmqt_shortstring.h>
 
 #include <ball_log.h>
@@ -45,6 +47,11 @@ BSLMF_ASSERT(sizeof(uint8_t) == 1);
 BSLMF_ASSERT(sizeof(int16_t) == 2);
 BSLMF_ASSERT(sizeof(bdlt::EpochUtil::TimeT64) == 8);
 
+// rmqt::MessageProperty bits follow the order of BasicProperties::Id
+BSLMF_ASSERT(rmqt::MessageProperty::CONTENT_TYPE ==
+             1 << BasicProperties::CONTENT_TYPE);
+BSLMF_ASSERT(rmqt::MessageProperty::APP_ID == 1 << BasicProperties::APP_ID);
+
 enum PropertyType { SHORT_STRING, FIELD_TABLE, SHORT_SHORT_UINT, TIMESTAMP };
 
 const PropertyType EXPECTED_TYPES[BasicProperties::NUM_BASIC_PROPERTIES] = {
@@ -105,6 +112,74 @@ bsl::string getBitString(uint16_t value)
     return result;
 }
 
+/// Return true if the property `id` is one of `decodedProperties`
+bool isDecoded(BasicProperties::Id id, int decodedProperties)
+{
+    return (decodedProperties & (1 << id)) != 0;
+}
+
+/// If `flags` has the short string property `id`, decode it into `property`,
+/// or skip over it if it is not one of `decodedProperties`. Return false if
+/// it cannot be read.
+bool decodeShortStringProperty(bdlb::NullableValue<bsl::string>* property,
+                               BasicProperties::Id id,
+                               uint16_t flags,
+                               int decodedProperties,
+                               Buffer* buffer)
+{
+    if (!(flags & maskForProperty(id))) {
+        return true;
+    }
+
+    bool success = true;
+    if (isDecoded(id, decodedProperties)) {
+        property->makeValue();
+        success = Types::decodeShortString(&property->value(), buffer);
+    }
+    else if (buffer->available() < sizeof(uint8_t)) {
+        success = false;
+    }
+    else {
+        const uint8_t length = buffer->copy<uint8_t>();
+        success              = length <= buffer->available();
+        if (success) {
+            buffer->skip(length);
+        }
+    }
+
+    if (!success) {
+        BALL_LOG_ERROR << "Decoding fail for basic property: "
+                       << PROPERTY_NAMES[id];
+    }
+    return success;
+}
+
+/// If `flags` has the single octet property `id`, decode it into
+/// `property`, or skip over it if it is not one of `decodedProperties`.
+/// Return false if it cannot be read.
+bool decodeOctetProperty(bdlb::NullableValue<uint8_t>* property,
+                         BasicProperties::Id id,
+                         uint16_t flags,
+                         int decodedProperties,
+                         Buffer* buffer)
+{
+    if (!(flags & maskForProperty(id))) {
+        return true;
+    }
+
+    if (buffer->available() < sizeof(uint8_t)) {
+        BALL_LOG_ERROR << "Decoding fail for basic property: "
+                       << PROPERTY_NAMES[id];
+        return false;
+    }
+
+    const uint8_t value = buffer->copy<uint8_t>();
+    if (isDecoded(id, decodedProperties)) {
+        *property = value;
+    }
+    return true;
+}
+
 } // namespace
 
 uint16_t BasicProperties::propertyFlags() const
@@ -141,11 +216,13 @@ uint16_t BasicProperties::propertyFlags() const
 
 BasicProperties::BasicProperties()
 : d_properties()
+, d_headersView()
 {
 }
 
 BasicProperties::BasicProperties(const rmqt::Properties& p)
 : d_properties(p)
+, d_headersView()
 {
 }
 
@@ -237,6 +314,7 @@ bsl::optional<bsl::string> BasicProperties::appId() const
 void BasicProperties::setProperties(const rmqt::Properties& properties)
 {
     d_properties = properties;
+    d_headersView.reset();
 }
 
 template <typename T>
@@ -248,7 +326,9 @@ void writeErrorMsg(const bsl::string& propertyName, const T& value)
 
 bool BasicProperties::decode(BasicProperties* props,
                              const uint8_t* data,
-                             bsl::size_t dataLength)
+                             bsl::size_t dataLength,
+                             bool lazyHeaders,
+                             int decodedProperties)
 {
     rmqamqpt::Buffer buffer(data, dataLength);
 
@@ -259,26 +339,38 @@ bool BasicProperties::decode(BasicProperties* props,
     const uint16_t flags = buffer.copy<bdlb::BigEndianUint16>();
 
     rmqt::Properties properties;
-
-    if (flags & maskForProperty(CONTENT_TYPE)) {
-        properties.contentType = "";
-        if (!rmqamqpt::Types::decodeShortString(&*properties.contentType,
-                                                &buffer)) {
+    bsl::shared_ptr<const rmqt::FieldTableView> headersView;
+
+    success &= decodeShortStringProperty(&properties.contentType,
+                                         CONTENT_TYPE,
+                                         flags,
+                                         decodedProperties,
+                                         &buffer);
+    success &= decodeShortStringProperty(&properties.contentEncoding,
+                                         CONTENT_ENCODING,
+                                         flags,
+                                         decodedProperties,
+                                         &buffer);
+    if ((flags & maskForProperty(HEADERS)) &&
+        (lazyHeaders || !isDecoded(HEADERS, decodedProperties))) {
+        // Keep the table encoded, including its length
+        const rmqamqpt::Buffer::const_pointer table = buffer.ptr();
+        const bool hasLength =
+            buffer.available() >= sizeof(bdlb::BigEndianUint32);
+        const bsl::size_t tableLength =
+            hasLength ? buffer.copy<bdlb::BigEndianUint32>() : 0;
+        if (!hasLength || tableLength > buffer.available()) {
             BALL_LOG_ERROR << "Decoding fail for basic property: "
-                           << PROPERTY_NAMES[CONTENT_TYPE];
+                           << PROPERTY_NAMES[HEADERS];
             success = false;
         }
-    }
-    if (flags & maskForProperty(CONTENT_ENCODING)) {
-        properties.contentEncoding = "";
-        if (!rmqamqpt::Types::decodeShortString(&*properties.contentEncoding,
-                                                &buffer)) {
-            BALL_LOG_ERROR << "Decoding fail for basic property: "
-                           << PROPERTY_NAMES[CONTENT_ENCODING];
-            success = false;
+        else {
+            buffer.skip(tableLength);
+            headersView = bsl::make_shared<EncodedFieldTable>(
+                table, buffer.ptr() - table);
         }
     }
-    if (flags & maskForProperty(HEADERS)) {
+    else if (flags & maskForProperty(HEADERS)) {
         properties.headers = bsl::make_shared<rmqt::FieldTable>();
         if (!rmqamqpt::Types::decodeFieldTable(properties.headers.ptr(),
                                                &buffer)) {
@@ -287,86 +379,64 @@ bool BasicProperties::decode(BasicProperties* props,
             success = false;
         }
     }
-    if (flags & maskForProperty(DELIVERY_MODE)) {
-        properties.deliveryMode = buffer.copy<uint8_t>();
-    }
-    if (flags & maskForProperty(PRIORITY)) {
-        properties.priority = buffer.copy<uint8_t>();
-    }
-    if (flags & maskForProperty(CORRELATION_ID)) {
-        properties.correlationId = "";
-        if (!rmqamqpt::Types::decodeShortString(&*properties.correlationId,
-                                                &buffer)) {
-            BALL_LOG_ERROR << "Decoding fail for basic property: "
-                           << PROPERTY_NAMES[CORRELATION_ID];
-            success = false;
-        }
-    }
-    if (flags & maskForProperty(REPLY_TO)) {
-        properties.replyTo = "";
-        if (!rmqamqpt::Types::decodeShortString(&*properties.replyTo,
-                                                &buffer)) {
-            BALL_LOG_ERROR << "Decoding fail for basic property: "
-                           << PROPERTY_NAMES[REPLY_TO];
-            success = false;
-        }
-    }
-    if (flags & maskForProperty(EXPIRATION)) {
-        properties.expiration = "";
-        if (!rmqamqpt::Types::decodeShortString(&*properties.expiration,
-                                                &buffer)) {
-            BALL_LOG_ERROR << "Decoding fail for basic property: "
-                           << PROPERTY_NAMES[EXPIRATION];
-            success = false;
-        }
-    }
-    if (flags & maskForProperty(MESSAGE_ID)) {
-        properties.messageId = "";
-        if (!rmqamqpt::Types::decodeShortString(&*properties.messageId,
-                                                &buffer)) {
-            BALL_LOG_ERROR << "Decoding fail for basic property: "
-                           << PROPERTY_NAMES[MESSAGE_ID];
-            success = false;
-        }
-    }
+    success &= decodeOctetProperty(&properties.deliveryMode,
+                                   DELIVERY_MODE,
+                                   flags,
+                                   decodedProperties,
+                                   &buffer);
+    success &= decodeOctetProperty(
+        &properties.priority, PRIORITY, flags, decodedProperties, &buffer);
+    success &= decodeShortStringProperty(&properties.correlationId,
+                                         CORRELATION_ID,
+                                         flags,
+                                         decodedProperties,
+                                         &buffer);
+    success &= decodeShortStringProperty(&properties.replyTo,
+                                         REPLY_TO,
+                                         flags,
+                                         decodedProperties,
+                                         &buffer);
+    success &= decodeShortStringProperty(&properties.expiration,
+                                         EXPIRATION,
+                                         flags,
+                                         decodedProperties,
+                                         &buffer);
+    success &= decodeShortStringProperty(&properties.messageId,
+                                         MESSAGE_ID,
+                                         flags,
+                                         decodedProperties,
+                                         &buffer);
     if (flags & maskForProperty(TIMESTAMP)) {
-        properties.timestamp = bdlt::Datetime();
-        rmqamqpt::Types::decodeTimestamp(&*properties.timestamp, &buffer);
-    }
-    if (flags & maskForProperty(TYPE)) {
-        properties.type = "";
-        if (!rmqamqpt::Types::decodeShortString(&*properties.type, &buffer)) {
+        if (buffer.available() < sizeof(bdlt::EpochUtil::TimeT64)) {
             BALL_LOG_ERROR << "Decoding fail for basic property: "
-                           << PROPERTY_NAMES[TYPE];
+                           << PROPERTY_NAMES[TIMESTAMP];
             success = false;
         }
-    }
-    if (flags & maskForProperty(USER_ID)) {
-        properties.userId = "";
-        if (rmqamqpt::Types::decodeShortString(&*properties.userId, &buffer)) {
-            BALL_LOG_ERROR << "Decoding fail for basic property: "
-                           << PROPERTY_NAMES[USER_ID];
-            success = false;
+        else if (isDecoded(TIMESTAMP, decodedProperties)) {
+            properties.timestamp = bdlt::Datetime();
+            rmqamqpt::Types::decodeTimestamp(&*properties.timestamp, &buffer);
         }
-    }
-    if (flags & maskForProperty(APP_ID)) {
-        properties.appId = "";
-        if (!rmqamqpt::Types::decodeShortString(&*properties.appId, &buffer)) {
-            BALL_LOG_ERROR << "Decoding fail for basic property: "
-                           << PROPERTY_NAMES[APP_ID];
-            success = false;
+        else {
+            buffer.skip(sizeof(bdlt::EpochUtil::TimeT64));
         }
     }
+    success &= decodeShortStringProperty(
+        &properties.type, TYPE, flags, decodedProperties, &buffer);
+    success &= decodeShortStringProperty(
+        &properties.userId, USER_ID, flags, decodedProperties, &buffer);
+    success &= decodeShortStringProperty(
+        &properties.appId, APP_ID, flags, decodedProperties, &buffer);
 
     if (success) {
         props->setProperties(properties);
+        props->d_headersView = headersView;
     }
 
     const uint8_t MORE_PROPERTIES = 15;
     if (maskForProperty(MORE_PROPERTIES) & flags) {
         BALL_LOG_ERROR << "FAILED TO DECODE MORE PROPERTIES, SPEC EXTENDED?";
     }
-    BALL_LOG_TRACE << "decoded props: " << *props;
+    RMQT_LOG_TRACE << "decoded props: " << *props;
     return success;
 }
 
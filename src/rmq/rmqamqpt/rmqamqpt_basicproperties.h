@@ -19,6 +19,7 @@
 #include <rmqamqpt_constants.h>
 #include <rmqamqpt_writer.h>
 
+#include <rmqt_fieldtableview.h>
 #include <rmqt_fieldvalue.h>
 #include <rmqt_properties.h>
 #include <rmqt_shortstring.h>
@@ -61,6 +62,7 @@ class BasicProperties {
 
   private:
     rmqt::Properties d_properties;
+    bsl::shared_ptr<const rmqt::FieldTableView> d_headersView;
 
   public:
     BasicProperties();
@@ -115,11 +117,27 @@ class BasicProperties {
     /// creating application id
     bsl::optional<bsl::string> appId() const;
 
+    /// headers kept encoded by a lazy `decode`, in which case `headers()`
+    /// is unset
+    const bsl::shared_ptr<const rmqt::FieldTableView>& headersView() const
+    {
+        return d_headersView;
+    }
+
     rmqt::Properties toProperties() const;
 
     void setProperties(const rmqt::Properties& properties);
 
-    static bool decode(BasicProperties*, const uint8_t*, bsl::size_t);
+    /// Decode properties from `dataLength` bytes at `data`. With
+    /// `lazyHeaders` the headers table is not decoded, but copied into
+    /// `headersView()`. Only the `rmqt::MessageProperty` bits set in
+    /// `decodedProperties` are decoded: other properties are skipped and left
+    /// unset, other than the headers, which are copied into `headersView()`.
+    static bool decode(BasicProperties*,
+                       const uint8_t* data,
+                       bsl::size_t dataLength,
+                       bool lazyHeaders      = false,
+                       int decodedProperties = rmqt::MessageProperty::ALL);
 
     static void encode(Writer&, const BasicProperties&);
 
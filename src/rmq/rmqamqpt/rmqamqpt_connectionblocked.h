@@ -0,0 +1,65 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQAMQPT_CONNECTIONBLOCKED
+#define INCLUDED_RMQAMQPT_CONNECTIONBLOCKED
+
+#include <rmqamqpt_constants.h>
+#include <rmqamqpt_writer.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_cstdint.h>
+#include <bsl_iostream.h>
+#include <bsl_string.h>
+
+namespace BloombergLP {
+namespace rmqamqpt {
+
+/// \brief Provide connection BLOCKED method
+///
+/// This method indicates that the broker has stopped reading publishes from
+/// the connection, e.g. because of a memory or disk alarm. It is only sent to
+/// clients advertising the `connection.blocked` capability.
+/// https://www.rabbitmq.com/docs/connection-blocked
+
+class ConnectionBlocked {
+  public:
+    static const rmqamqpt::Constants::AMQPMethodId METHOD_ID =
+        rmqamqpt::Constants::CONNECTION_BLOCKED;
+
+    ConnectionBlocked();
+
+    explicit ConnectionBlocked(const bsl::string& reason);
+
+    size_t encodedSize() const { return sizeof(uint8_t) + d_reason.size(); }
+
+    /// Why the broker blocked the connection, e.g. "low on memory"
+    const bsl::string& reason() const { return d_reason; }
+
+    static bool decode(ConnectionBlocked* blocked,
+                       const uint8_t* data,
+                       bsl::size_t dataLength);
+    static void encode(Writer& output, const ConnectionBlocked& blocked);
+
+  private:
+    bsl::string d_reason;
+};
+
+bsl::ostream& operator<<(bsl::ostream& os, const ConnectionBlocked& blocked);
+
+} // namespace rmqamqpt
+} // namespace BloombergLP
+
+#endif
@@ -15,6 +15,7 @@
 
 #include <rmqamqpt_connectionmethod.h>
 
+#include <rmqamqpt_connectionblocked.h>
 #include <rmqamqpt_connectionclose.h>
 #include <rmqamqpt_connectioncloseok.h>
 #include <rmqamqpt_connectionopen.h>
@@ -23,6 +24,7 @@
 #include <rmqamqpt_connectionstartok.h>
 #include <rmqamqpt_connectiontune.h>
 #include <rmqamqpt_connectiontuneok.h>
+#include <rmqamqpt_connectionunblocked.h>
 #include <rmqamqpt_types.h>
 
 #include <ball_log.h>
@@ -61,6 +63,8 @@ bool decodeConnectionMethodPayload(ConnectionMethod* connMethod,
         DECODE_METHOD(ConnectionOpenOk)
         DECODE_METHOD(ConnectionClose)
         DECODE_METHOD(ConnectionCloseOk)
+        DECODE_METHOD(ConnectionBlocked)
+        DECODE_METHOD(ConnectionUnblocked)
         default: {
             BALL_LOG_ERROR
                 << "Failed to decode ConnectionMethod with unknown id: "
@@ -16,6 +16,7 @@
 #ifndef INCLUDED_RMQAMQPT_CONNECTIONMETHOD
 #define INCLUDED_RMQAMQPT_CONNECTIONMETHOD
 
+#include <rmqamqpt_connectionblocked.h>
 #include <rmqamqpt_connectionclose.h>
 #include <rmqamqpt_connectioncloseok.h>
 #include <rmqamqpt_connectionopen.h>
@@ -24,6 +25,7 @@
 #include <rmqamqpt_connectionstartok.h>
 #include <rmqamqpt_connectiontune.h>
 #include <rmqamqpt_connectiontuneok.h>
+#include <rmqamqpt_connectionunblocked.h>
 #include <rmqamqpt_constants.h>
 #include <rmqamqpt_writer.h>
 
@@ -34,14 +36,16 @@
 namespace BloombergLP {
 namespace rmqamqpt {
 
-typedef bdlb::Variant<ConnectionClose,
+typedef bdlb::Variant<ConnectionBlocked,
+                      ConnectionClose,
                       ConnectionCloseOk,
                       ConnectionOpen,
                       ConnectionOpenOk,
                       ConnectionStart,
                       ConnectionStartOk,
                       ConnectionTune,
-                      ConnectionTuneOk>
+                      ConnectionTuneOk,
+                      ConnectionUnblocked>
     SupportedConnectionMethods;
 
 /// \brief Represents an AMQP Connection class:
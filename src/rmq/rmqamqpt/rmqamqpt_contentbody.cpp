@@ -21,12 +21,18 @@ namespace BloombergLP {
 namespace rmqamqpt {
 
 ContentBody::ContentBody()
-: d_data()
+: d_data(bsl::make_shared<bsl::vector<uint8_t> >())
 {
 }
 
 ContentBody::ContentBody(const uint8_t* data, bsl::size_t dataLength)
-: d_data(data, data + dataLength)
+: d_data(bsl::make_shared<bsl::vector<uint8_t> >(data, data + dataLength))
+{
+}
+
+ContentBody::ContentBody(
+    const bsl::shared_ptr<const bsl::vector<uint8_t> >& data)
+: d_data(data)
 {
 }
 
@@ -34,7 +40,8 @@ void ContentBody::decode(ContentBody* contentBody,
                          const uint8_t* data,
                          bsl::size_t dataLength)
 {
-    contentBody->d_data = bsl::vector<uint8_t>(data, data + dataLength);
+    contentBody->d_data =
+        bsl::make_shared<bsl::vector<uint8_t> >(data, data + dataLength);
 }
 
 void ContentBody::encode(Writer& output, const ContentBody& contentBody)
@@ -42,5 +49,11 @@ void ContentBody::encode(Writer& output, const ContentBody& contentBody)
     output.write(contentBody.data().data(), contentBody.dataLength());
 }
 
+bsl::ostream& operator<<(bsl::ostream& os, const ContentBody& contentBody)
+{
+    os << "ContentBody = [ dataLength: " << contentBody.dataLength() << " ]";
+    return os;
+}
+
 } // namespace rmqamqpt
 } // namespace BloombergLP
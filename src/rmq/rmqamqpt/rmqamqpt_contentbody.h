@@ -21,6 +21,7 @@
 
 #include <bsl_cstddef.h>
 #include <bsl_iostream.h>
+#include <bsl_memory.h>
 #include <bsl_vector.h>
 
 #include <bsl_cstdint.h>
@@ -36,9 +37,19 @@ class ContentBody {
 
     ContentBody(const uint8_t* data, bsl::size_t dataLength);
 
-    bsl::size_t dataLength() const { return d_data.size(); }
+    /// Construct a content body sharing, rather than copying, `data`
+    explicit ContentBody(
+        const bsl::shared_ptr<const bsl::vector<uint8_t> >& data);
 
-    const bsl::vector<uint8_t>& data() const { return d_data; }
+    bsl::size_t dataLength() const { return d_data->size(); }
+
+    const bsl::vector<uint8_t>& data() const { return *d_data; }
+
+    /// Shared ownership of the body bytes, which copies of this object share
+    const bsl::shared_ptr<const bsl::vector<uint8_t> >& buffer() const
+    {
+        return d_data;
+    }
 
     static void decode(ContentBody* contentBody,
                        const uint8_t* data,
@@ -46,9 +57,11 @@ class ContentBody {
     static void encode(Writer& output, const ContentBody& contentBody);
 
   private:
-    bsl::vector<uint8_t> d_data;
+    bsl::shared_ptr<const bsl::vector<uint8_t> > d_data;
 };
 
+bsl::ostream& operator<<(bsl::ostream& os, const ContentBody& contentBody);
+
 } // namespace rmqamqpt
 } // namespace BloombergLP
 
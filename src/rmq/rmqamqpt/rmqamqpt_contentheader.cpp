@@ -56,7 +56,9 @@ ContentHeader::ContentHeader(rmqamqpt::Constants::AMQPClassId classId,
 
 bool ContentHeader::decode(ContentHeader* contentHeader,
                            const uint8_t* data,
-                           bsl::size_t dataLength)
+                           bsl::size_t dataLength,
+                           bool lazyHeaders,
+                           int decodedProperties)
 {
     rmqamqpt::Buffer buffer(data, dataLength);
     if (sizeof(uint16_t) + sizeof(uint16_t) +
@@ -82,7 +84,9 @@ bool ContentHeader::decode(ContentHeader* contentHeader,
 
     return BasicProperties::decode(&contentHeader->d_properties,
                                    static_cast<const uint8_t*>(buffer.ptr()),
-                                   buffer.available());
+                                   buffer.available(),
+                                   lazyHeaders,
+                                   decodedProperties);
 }
 
 void ContentHeader::encode(Writer& output, const ContentHeader& contentHeader)
@@ -93,6 +97,24 @@ void ContentHeader::encode(Writer& output, const ContentHeader& contentHeader)
     BasicProperties::encode(output, contentHeader.d_properties);
 }
 
+size_t ContentHeader::encodedSize(const rmqt::Message& message,
+                                  const PropertiesTemplate& propertiesTemplate)
+{
+    return 2 * sizeof(uint16_t) + sizeof(uint64_t) +
+           propertiesTemplate.encodedSize(message.properties());
+}
+
+void ContentHeader::encode(Writer& output,
+                           rmqamqpt::Constants::AMQPClassId classId,
+                           const rmqt::Message& message,
+                           const PropertiesTemplate& propertiesTemplate)
+{
+    Types::write(output, bdlb::BigEndianUint16::make(classId));
+    Types::write(output, bdlb::BigEndianUint16::make(0));
+    Types::write(output, bdlb::BigEndianUint64::make(message.payloadSize()));
+    propertiesTemplate.encode(output, message.properties());
+}
+
 bsl::ostream& operator<<(bsl::ostream& os, const ContentHeader& contentHeader)
 {
     os << "ContentHeader = ["
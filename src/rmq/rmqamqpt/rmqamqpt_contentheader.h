@@ -20,6 +20,7 @@
 #include <rmqamqpt_basicproperties.h>
 #include <rmqamqpt_constants.h>
 #include <rmqamqpt_fieldvalue.h>
+#include <rmqamqpt_propertiestemplate.h>
 #include <rmqamqpt_writer.h>
 
 #include <rmqt_message.h>
@@ -63,11 +64,31 @@ class ContentHeader {
 
     const BasicProperties& properties() const { return d_properties; }
 
+    /// Decode a content header. With `lazyHeaders` the headers table is
+    /// kept encoded, and only `decodedProperties` are decoded, see
+    /// `BasicProperties::decode`.
     static bool decode(ContentHeader* contentHeader,
                        const uint8_t* data,
-                       bsl::size_t dataLength);
+                       bsl::size_t dataLength,
+                       bool lazyHeaders      = false,
+                       int decodedProperties = rmqt::MessageProperty::ALL);
     static void encode(Writer& output, const ContentHeader& contentHeader);
 
+    /// Return the encoded size of a content header for `message`. The
+    /// behaviour is undefined unless `propertiesTemplate` matches the
+    /// message's properties.
+    static size_t encodedSize(const rmqt::Message& message,
+                              const PropertiesTemplate& propertiesTemplate);
+
+    /// Encode a content header for `message`, copying the pre-encoded
+    /// static properties from `propertiesTemplate` rather than encoding
+    /// them again. The behaviour is undefined unless `propertiesTemplate`
+    /// matches the message's properties.
+    static void encode(Writer& output,
+                       rmqamqpt::Constants::AMQPClassId classId,
+                       const rmqt::Message& message,
+                       const PropertiesTemplate& propertiesTemplate);
+
   private:
     uint16_t propertyFlags() const { return d_properties.propertyFlags(); }
 
@@ -0,0 +1,110 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqamqpt_encodedfieldtable.h>
+
+#include <rmqamqpt_buffer.h>
+#include <rmqamqpt_types.h>
+
+#include <ball_log.h>
+#include <bdlb_bigendian.h>
+#include <bslmt_lockguard.h>
+
+#include <bsl_cstring.h>
+
+namespace BloombergLP {
+namespace rmqamqpt {
+
+namespace {
+BALL_LOG_SET_NAMESPACE_CATEGORY("RMQAMQPT.ENCODEDFIELDTABLE")
+} // namespace
+
+EncodedFieldTable::EncodedFieldTable(const uint8_t* data,
+                                     bsl::size_t length,
+                                     bslma::Allocator* allocator)
+: d_data(data, data + length, allocator)
+, d_mutex()
+, d_decoded(false)
+, d_table()
+{
+}
+
+bool EncodedFieldTable::find(rmqt::FieldValue* value,
+                             const bsl::string& key) const
+{
+    rmqamqpt::Buffer buffer(d_data.data(), d_data.size());
+    if (buffer.available() < sizeof(bdlb::BigEndianUint32)) {
+        return false;
+    }
+    const bsl::uint32_t tableLength = buffer.copy<bdlb::BigEndianUint32>();
+    if (tableLength > buffer.available()) {
+        return false;
+    }
+
+    rmqamqpt::Buffer tBuffer = buffer.consume(tableLength);
+    while (tBuffer.available() > 0) {
+        const bsl::size_t keyLength = tBuffer.copy<bsl::uint8_t>();
+        if (keyLength > tBuffer.available()) {
+            BALL_LOG_ERROR << "Cannot read Field name";
+            return false;
+        }
+
+        // Compare the key in place, rather than decoding it into a string
+        const bool isKey =
+            keyLength == key.length() &&
+            bsl::memcmp(tBuffer.ptr(), key.data(), keyLength) == 0;
+        tBuffer.skip(keyLength);
+
+        if (isKey) {
+            if (!Types::decodeFieldValue(value, &tBuffer)) {
+                BALL_LOG_ERROR << "Cannot read Field value: " << key;
+                return false;
+            }
+            return true;
+        }
+
+        if (!Types::skipFieldValue(&tBuffer)) {
+            BALL_LOG_ERROR << "Cannot skip Field value";
+            return false;
+        }
+    }
+
+    return false;
+}
+
+bsl::shared_ptr<rmqt::FieldTable> EncodedFieldTable::table() const
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+
+    if (!d_decoded) {
+        d_decoded = true;
+
+        bsl::shared_ptr<rmqt::FieldTable> table =
+            bsl::make_shared<rmqt::FieldTable>();
+        rmqamqpt::Buffer buffer(d_data.data(), d_data.size());
+        if (buffer.available() >= sizeof(bdlb::BigEndianUint32) &&
+            Types::decodeFieldTable(table.get(), &buffer)) {
+            d_table = table;
+        }
+        else {
+            BALL_LOG_ERROR << "Cannot decode lazily held field table";
+        }
+    }
+
+    return d_table;
+}
+
+} // namespace rmqamqpt
+} // namespace BloombergLP
@@ -0,0 +1,80 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQAMQPT_ENCODEDFIELDTABLE
+#define INCLUDED_RMQAMQPT_ENCODEDFIELDTABLE
+
+#include <rmqt_fieldtableview.h>
+#include <rmqt_fieldvalue.h>
+
+#include <bslma_allocator.h>
+#include <bslmt_mutex.h>
+#include <bsls_keyword.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_cstdint.h>
+#include <bsl_memory.h>
+#include <bsl_string.h>
+#include <bsl_vector.h>
+
+//@PURPOSE: Decode an AMQP field table lazily
+//
+//@CLASSES:
+//  rmqamqpt::EncodedFieldTable: An rmqt::FieldTableView over a field table in
+//      its wire encoding
+
+namespace BloombergLP {
+namespace rmqamqpt {
+
+/// \brief Field table kept in its wire encoding, e.g. consumed message
+/// headers
+///
+/// `find` scans the encoded keys, stepping over the values it does not need,
+/// and decodes only the value asked for. `table` decodes everything once and
+/// keeps the result. As with `Types::decodeFieldTable`, the first of any
+/// duplicated keys wins.
+
+class EncodedFieldTable : public rmqt::FieldTableView {
+  public:
+    /// Copy the `length` bytes at `data`: an encoded field table, starting
+    /// with its 4 byte length. The bytes are copied so the (potentially much
+    /// larger) buffer they were read from need not be kept alive.
+    EncodedFieldTable(const uint8_t* data,
+                      bsl::size_t length,
+                      bslma::Allocator* allocator = 0);
+
+    bool find(rmqt::FieldValue* value,
+              const bsl::string& key) const BSLS_KEYWORD_OVERRIDE;
+
+    bsl::shared_ptr<rmqt::FieldTable> table() const BSLS_KEYWORD_OVERRIDE;
+
+  private:
+    EncodedFieldTable(const EncodedFieldTable&) BSLS_KEYWORD_DELETED;
+    EncodedFieldTable&
+    operator=(const EncodedFieldTable&) BSLS_KEYWORD_DELETED;
+
+    bsl::vector<uint8_t> d_data;
+
+    mutable bslmt::Mutex d_mutex;
+    // Guards the memoized decode below
+
+    mutable bool d_decoded;
+    mutable bsl::shared_ptr<rmqt::FieldTable> d_table;
+};
+
+} // namespace rmqamqpt
+} // namespace BloombergLP
+
+#endif
@@ -0,0 +1,55 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqamqpt_encodedmethod.h>
+
+#include <bsls_assert.h>
+
+namespace BloombergLP {
+namespace rmqamqpt {
+
+namespace {
+
+bsl::shared_ptr<const bsl::vector<uint8_t> > encodeMethod(const Method& method)
+{
+    bsl::shared_ptr<bsl::vector<uint8_t> > data =
+        bsl::make_shared<bsl::vector<uint8_t> >(method.encodedSize());
+    Writer writer(data->data(), data->size());
+    Method::Util::encode(writer, method);
+    BSLS_ASSERT(writer.offset() == data->size());
+    return data;
+}
+
+} // namespace
+
+EncodedMethod::EncodedMethod(const Method& method)
+: d_method(bsl::make_shared<Method>(method))
+, d_data(encodeMethod(method))
+{
+}
+
+void EncodedMethod::encode(Writer& output, const EncodedMethod& encodedMethod)
+{
+    output.write(encodedMethod.data().data(), encodedMethod.dataLength());
+}
+
+bsl::ostream& operator<<(bsl::ostream& os, const EncodedMethod& encodedMethod)
+{
+    os << "EncodedMethod = [ " << encodedMethod.method() << " ]";
+    return os;
+}
+
+} // namespace rmqamqpt
+} // namespace BloombergLP
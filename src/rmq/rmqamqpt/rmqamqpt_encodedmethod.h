@@ -0,0 +1,68 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// rmqamqpt_encodedmethod.h
+#ifndef INCLUDED_RMQAMQPT_ENCODEDMETHOD
+#define INCLUDED_RMQAMQPT_ENCODEDMETHOD
+
+#include <rmqamqpt_method.h>
+#include <rmqamqpt_writer.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_cstdint.h>
+#include <bsl_iostream.h>
+#include <bsl_memory.h>
+#include <bsl_vector.h>
+
+namespace BloombergLP {
+namespace rmqamqpt {
+
+/// \brief A Method encoded once, whose wire format can be written any
+/// number of times without encoding it again
+///
+/// Copies share the method and its encoding.
+
+class EncodedMethod {
+  public:
+    /// Encode `method`
+    explicit EncodedMethod(const Method& method);
+
+    /// The method which was encoded
+    const Method& method() const { return *d_method; }
+
+    bsl::size_t dataLength() const { return d_data->size(); }
+
+    const bsl::vector<uint8_t>& data() const { return *d_data; }
+
+    /// Shared ownership of the encoded bytes, which copies of this object
+    /// share
+    const bsl::shared_ptr<const bsl::vector<uint8_t> >& buffer() const
+    {
+        return d_data;
+    }
+
+    static void encode(Writer& output, const EncodedMethod& encodedMethod);
+
+  private:
+    bsl::shared_ptr<const Method> d_method;
+    bsl::shared_ptr<const bsl::vector<uint8_t> > d_data;
+};
+
+bsl::ostream& operator<<(bsl::ostream& os, const EncodedMethod& encodedMethod);
+
+} // namespace rmqamqpt
+} // namespace BloombergLP
+
+#endif
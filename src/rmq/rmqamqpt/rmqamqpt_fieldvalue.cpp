@@ -18,6 +18,7 @@
 #include <rmqamqpt_constants.h>
 
 #include <bdlt_epochutil.h>
+#include <bsl_algorithm.h>
 #include <bsl_cstddef.h>
 #include <bsl_limits.h>
 #include <bsl_memory.h>
@@ -166,8 +167,23 @@ bsl::size_t FieldValueUtil::encodedTableSize(const rmqt::FieldTable& table)
     for (rmqt::FieldTable::const_iterator it = table.cbegin();
          it != table.cend();
          ++it) {
+        // Keys are short strings, truncated to 255 bytes when encoded
+        size += sizeof(bsl::uint8_t) +
+                bsl::min(it->first.size(), bsl::size_t(255));
+        size += encodedSize(it->second);
+    }
+    return size;
+}
 
-        size += sizeof(bsl::uint8_t) + it->first.size();
+bsl::size_t FieldValueUtil::encodedTableSize(const rmqt::FlatFieldTable& table)
+{
+    bsl::size_t size = 0;
+    for (rmqt::FlatFieldTable::const_iterator it = table.begin();
+         it != table.end();
+         ++it) {
+        // Keys are short strings, truncated to 255 bytes when encoded
+        size += sizeof(bsl::uint8_t) +
+                bsl::min(it->first.size(), bsl::size_t(255));
         size += encodedSize(it->second);
     }
     return size;
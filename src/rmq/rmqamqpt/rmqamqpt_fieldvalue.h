@@ -18,6 +18,7 @@
 
 #include <bsl_cstddef.h>
 #include <rmqt_fieldvalue.h>
+#include <rmqt_flatfieldtable.h>
 
 namespace BloombergLP {
 namespace rmqamqpt {
@@ -55,6 +56,7 @@ struct FieldValueUtil {
     static bsl::size_t encodedValueSize(const rmqt::FieldValue& fv);
 
     static bsl::size_t encodedTableSize(const rmqt::FieldTable& table);
+    static bsl::size_t encodedTableSize(const rmqt::FlatFieldTable& table);
 
     static bsl::size_t
     fieldArrayContentsEncodedSize(const rmqt::FieldArray& fieldArray);
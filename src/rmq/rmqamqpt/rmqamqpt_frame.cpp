@@ -18,6 +18,7 @@
 
 #include <ball_log.h>
 #include <bdlb_bigendian.h>
+#include <bsl_algorithm.h>
 #include <bsl_cstring.h>
 #include <bsl_iostream.h>
 #include <bsl_stdexcept.h>
@@ -33,6 +34,8 @@ Frame::Frame()
 : d_type()
 , d_channel()
 , d_serializedData()
+, d_offset(0)
+, d_length(0)
 {
 }
 
@@ -44,6 +47,8 @@ Frame::Frame(bsl::uint8_t type,
 , d_channel(channel)
 , d_serializedData(
       bsl::make_shared<bsl::vector<uint8_t> >(data, data + totalDataSize))
+, d_offset(0)
+, d_length(totalDataSize)
 {
 }
 
@@ -53,14 +58,28 @@ Frame::Frame(uint8_t type,
 : d_type(type)
 , d_channel(channel)
 , d_serializedData(serializedData)
+, d_offset(0)
+, d_length(serializedData ? serializedData->size() : 0)
 {
 }
 
-Frame::ReturnCode Frame::decode(Frame* frame,
-                                bsl::size_t* readBytes,
-                                bsl::size_t* missingBytes,
-                                const uint8_t* buffer,
-                                bsl::size_t bufferLen)
+Frame::Frame(uint8_t type,
+             uint16_t channel,
+             const bsl::shared_ptr<bsl::vector<uint8_t> >& buffer,
+             bsl::size_t offset,
+             bsl::size_t length)
+: d_type(type)
+, d_channel(channel)
+, d_serializedData(buffer)
+, d_offset(offset)
+, d_length(length)
+{
+}
+
+Frame::ReturnCode Frame::decodeHeader(Frame* frame,
+                                      bsl::size_t* frameLength,
+                                      const uint8_t* buffer,
+                                      bsl::size_t bufferLen)
 {
     if (bufferLen < frameOverhead()) {
         return Frame::PARTIAL;
@@ -90,27 +109,71 @@ Frame::ReturnCode Frame::decode(Frame* frame,
         return Frame::DECODE_ERROR;
     }
 
-    *missingBytes = bufferLen - (frameOverhead() + payloadLength);
-    *readBytes    = payloadLength + frameOverhead();
+    *frameLength = payloadLength + frameOverhead();
+
+    return Frame::OK;
+}
+
+Frame::ReturnCode Frame::decode(Frame* frame,
+                                bsl::size_t* readBytes,
+                                bsl::size_t* missingBytes,
+                                const uint8_t* buffer,
+                                bsl::size_t bufferLen)
+{
+    bsl::size_t frameLength = 0;
+    const ReturnCode rc = decodeHeader(frame, &frameLength, buffer, bufferLen);
+    if (rc != Frame::OK) {
+        return rc;
+    }
+
+    *missingBytes = bufferLen - frameLength;
+    *readBytes    = frameLength;
 
     frame->d_serializedData = bsl::make_shared<bsl::vector<uint8_t> >(
-        buffer, buffer + frameOverhead() + payloadLength);
+        buffer, buffer + frameLength);
+    frame->d_offset = 0;
+    frame->d_length = frameLength;
+
+    return Frame::OK;
+}
+
+Frame::ReturnCode
+Frame::decodeInPlace(Frame* frame,
+                     bsl::size_t* readBytes,
+                     bsl::size_t* missingBytes,
+                     const bsl::shared_ptr<bsl::vector<uint8_t> >& buffer,
+                     bsl::size_t offset,
+                     bsl::size_t bufferLen)
+{
+    bsl::size_t frameLength = 0;
+    const ReturnCode rc =
+        decodeHeader(frame, &frameLength, buffer->data() + offset, bufferLen);
+    if (rc != Frame::OK) {
+        return rc;
+    }
+
+    *missingBytes = bufferLen - frameLength;
+    *readBytes    = frameLength;
+
+    frame->d_serializedData = buffer;
+    frame->d_offset         = offset;
+    frame->d_length         = frameLength;
 
     return Frame::OK;
 }
 
 bsl::size_t Frame::payloadLength() const
 {
-    return d_serializedData ? (d_serializedData->size() - frameOverhead()) : 0;
+    return d_length ? (d_length - frameOverhead()) : 0;
 }
 
 const uint8_t* Frame::rawData() const
 {
-    if (!d_serializedData || d_serializedData->empty()) {
+    if (!d_serializedData || d_length == 0) {
         return NULL;
     }
 
-    return d_serializedData->data();
+    return d_serializedData->data() + d_offset;
 }
 
 const uint8_t* Frame::payload() const
@@ -137,11 +200,15 @@ bool Frame::operator==(const Frame& other) const
         return false;
     }
 
+    if (d_length != other.d_length) {
+        return false;
+    }
+
     if (!d_serializedData || !other.d_serializedData) {
         return d_serializedData == other.d_serializedData;
     }
 
-    return *d_serializedData == *other.d_serializedData;
+    return bsl::equal(rawData(), rawData() + d_length, other.rawData());
 }
 
 bool Frame::operator!=(const Frame& other) const { return !(*this == other); }
@@ -42,14 +42,25 @@ class Frame {
           uint16_t channel,
           const bsl::shared_ptr<bsl::vector<uint8_t> >& serializedData);
 
+    /// Construct a frame referencing the `length` bytes at `offset` within
+    /// `buffer`, which is shared rather than copied
+    Frame(uint8_t type,
+          uint16_t channel,
+          const bsl::shared_ptr<bsl::vector<uint8_t> >& buffer,
+          bsl::size_t offset,
+          bsl::size_t length);
+
     const uint8_t* payload() const;
     bsl::size_t payloadLength() const;
 
     const uint8_t* rawData() const;
+    /// The buffer holding this frame. The frame starts `dataOffset()` bytes
+    /// into it, which is non-zero for frames decoded in place.
     const bsl::shared_ptr<bsl::vector<uint8_t> > serializedData() const
     {
         return d_serializedData;
     }
+    bsl::size_t dataOffset() const { return d_offset; }
     uint8_t type() const;
     uint16_t channel() const;
 
@@ -65,6 +76,17 @@ class Frame {
                              const uint8_t* buffer,
                              bsl::size_t bufferLen);
 
+    /// Attempt to decode a frame from the `bufferLen` bytes at `offset`
+    /// within `buffer` without copying: on success `frame` shares
+    /// `buffer`. Return codes are as for `decode` above.
+    static ReturnCode
+    decodeInPlace(Frame* frame,
+                  bsl::size_t* readBytes,
+                  bsl::size_t* missingBytes,
+                  const bsl::shared_ptr<bsl::vector<uint8_t> >& buffer,
+                  bsl::size_t offset,
+                  bsl::size_t bufferLen);
+
     /// Return the maximum frame size we support
     static bsl::size_t getMaxFrameSize();
 
@@ -90,6 +112,13 @@ class Frame {
     // Re-consider when designing how to present the payload to the user via
     // rmqa::{Async,Sync}Consumer
     bsl::shared_ptr<bsl::vector<uint8_t> > d_serializedData;
+    bsl::size_t d_offset;
+    bsl::size_t d_length;
+
+    static ReturnCode decodeHeader(Frame* frame,
+                                   bsl::size_t* frameLength,
+                                   const uint8_t* buffer,
+                                   bsl::size_t bufferLen);
 
     static const bsl::size_t MAX_FRAME_SIZE;
 };
@@ -110,7 +139,7 @@ inline bsl::size_t Frame::frameHeaderSize()
 
 inline bsl::size_t Frame::totalFrameSize() const
 {
-    return d_serializedData ? d_serializedData->size() : 0;
+    return d_length;
 }
 
 } // namespace rmqamqpt
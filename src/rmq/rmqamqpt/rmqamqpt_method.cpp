@@ -21,6 +21,7 @@
 
 #include <ball_log.h>
 #include <bdlb_bigendian.h>
+#include <bsl_algorithm.h>
 #include <bsl_cstdint.h>
 #include <bsl_ostream.h>
 
@@ -29,42 +30,91 @@ namespace rmqamqpt {
 namespace {
 BALL_LOG_SET_NAMESPACE_CATEGORY("RMQAMQPT.METHOD")
 
-bool decodeMethodPayload(Method* method,
-                         bsl::uint16_t classId,
-                         const uint8_t* data,
-                         bsl::size_t dataLen)
+/// Decode a `T` of class `MethodClass` straight into `method`
+template <class MethodClass, class T>
+bool decodeMethod(Method* method, const uint8_t* data, bsl::size_t dataLen)
 {
-#define DECODE_METHOD_PAYLOAD(MethodClass)                                     \
-    case MethodClass::CLASS_ID: {                                              \
-        method->createInPlace<MethodClass>();                                  \
-        bool rc = MethodClass::Util::decode(                                   \
-            &method->the<MethodClass>(), data, dataLen);                       \
-                                                                               \
-        if (!rc) {                                                             \
-            BALL_LOG_ERROR << "MethodClass::decode failed [class: "            \
-                           << MethodClass::CLASS_ID << "] rc: " << rc;         \
-        }                                                                      \
-                                                                               \
-        return rc;                                                             \
-    } break;
-
-    switch (classId) {
-        DECODE_METHOD_PAYLOAD(BasicMethod)
-        DECODE_METHOD_PAYLOAD(ConfirmMethod)
-        DECODE_METHOD_PAYLOAD(ConnectionMethod)
-        DECODE_METHOD_PAYLOAD(ChannelMethod)
-        DECODE_METHOD_PAYLOAD(ExchangeMethod)
-        DECODE_METHOD_PAYLOAD(QueueMethod)
-        default: {
-            BALL_LOG_ERROR << "Failed to decode Method with class id: "
-                           << classId;
-        }
-    }
-    return false;
+    method->createInPlace<MethodClass>();
+    MethodClass& methodClass = method->the<MethodClass>();
+    methodClass.template createInPlace<T>();
+    return T::decode(&methodClass.template the<T>(), data, dataLen);
+}
+
+typedef bool (*MethodDecoder)(Method*, const uint8_t*, bsl::size_t);
 
-#undef DECODE_METHOD_PAYLOAD
+bsl::uint32_t dispatchKey(bsl::uint16_t classId, bsl::uint16_t methodId)
+{
+    return (static_cast<bsl::uint32_t>(classId) << 16) | methodId;
+}
+
+struct DispatchEntry {
+    bsl::uint32_t key;
+    MethodDecoder decode;
+};
+
+bool operator<(const DispatchEntry& entry, bsl::uint32_t key)
+{
+    return entry.key < key;
 }
 
+#define DISPATCH_ENTRY(MethodClass, T)                                         \
+    {                                                                          \
+        (static_cast<bsl::uint32_t>(MethodClass::CLASS_ID) << 16) |            \
+            T::METHOD_ID,                                                      \
+        &decodeMethod<MethodClass, T>                                          \
+    }
+
+/// Every supported method, keyed on (class-id, method-id) and sorted by key,
+/// so a method is found with one search rather than a switch per level
+const DispatchEntry k_DISPATCH_TABLE[] = {
+    DISPATCH_ENTRY(ConnectionMethod, ConnectionStart),
+    DISPATCH_ENTRY(ConnectionMethod, ConnectionStartOk),
+    DISPATCH_ENTRY(ConnectionMethod, ConnectionTune),
+    DISPATCH_ENTRY(ConnectionMethod, ConnectionTuneOk),
+    DISPATCH_ENTRY(ConnectionMethod, ConnectionOpen),
+    DISPATCH_ENTRY(ConnectionMethod, ConnectionOpenOk),
+    DISPATCH_ENTRY(ConnectionMethod, ConnectionClose),
+    DISPATCH_ENTRY(ConnectionMethod, ConnectionCloseOk),
+    DISPATCH_ENTRY(ConnectionMethod, ConnectionBlocked),
+    DISPATCH_ENTRY(ConnectionMethod, ConnectionUnblocked),
+    DISPATCH_ENTRY(ChannelMethod, ChannelOpen),
+    DISPATCH_ENTRY(ChannelMethod, ChannelOpenOk),
+    DISPATCH_ENTRY(ChannelMethod, ChannelFlow),
+    DISPATCH_ENTRY(ChannelMethod, ChannelFlowOk),
+    DISPATCH_ENTRY(ChannelMethod, ChannelClose),
+    DISPATCH_ENTRY(ChannelMethod, ChannelCloseOk),
+    DISPATCH_ENTRY(ExchangeMethod, ExchangeDeclare),
+    DISPATCH_ENTRY(ExchangeMethod, ExchangeDeclareOk),
+    DISPATCH_ENTRY(ExchangeMethod, ExchangeBind),
+    DISPATCH_ENTRY(ExchangeMethod, ExchangeBindOk),
+    DISPATCH_ENTRY(QueueMethod, QueueDeclare),
+    DISPATCH_ENTRY(QueueMethod, QueueDeclareOk),
+    DISPATCH_ENTRY(QueueMethod, QueueBind),
+    DISPATCH_ENTRY(QueueMethod, QueueBindOk),
+    DISPATCH_ENTRY(QueueMethod, QueueDelete),
+    DISPATCH_ENTRY(QueueMethod, QueueDeleteOk),
+    DISPATCH_ENTRY(QueueMethod, QueueUnbind),
+    DISPATCH_ENTRY(QueueMethod, QueueUnbindOk),
+    DISPATCH_ENTRY(BasicMethod, BasicQoS),
+    DISPATCH_ENTRY(BasicMethod, BasicQoSOk),
+    DISPATCH_ENTRY(BasicMethod, BasicConsume),
+    DISPATCH_ENTRY(BasicMethod, BasicConsumeOk),
+    DISPATCH_ENTRY(BasicMethod, BasicCancel),
+    DISPATCH_ENTRY(BasicMethod, BasicCancelOk),
+    DISPATCH_ENTRY(BasicMethod, BasicPublish),
+    DISPATCH_ENTRY(BasicMethod, BasicReturn),
+    DISPATCH_ENTRY(BasicMethod, BasicDeliver),
+    DISPATCH_ENTRY(BasicMethod, BasicAck),
+    DISPATCH_ENTRY(BasicMethod, BasicNack),
+    DISPATCH_ENTRY(ConfirmMethod, ConfirmSelect),
+    DISPATCH_ENTRY(ConfirmMethod, ConfirmSelectOk),
+};
+
+#undef DISPATCH_ENTRY
+
+const DispatchEntry* const k_DISPATCH_TABLE_END =
+    k_DISPATCH_TABLE + sizeof(k_DISPATCH_TABLE) / sizeof(k_DISPATCH_TABLE[0]);
+
 template <class MethodClass>
 bool subClassMatch(const MethodClass& lhs, const MethodClass& rhs)
 {
@@ -132,16 +182,32 @@ bool Method::Util::decode(Method* method,
                           bsl::size_t dataLen)
 {
     bdlb::BigEndianUint16 classId;
+    bdlb::BigEndianUint16 methodId;
 
-    if (dataLen < sizeof(classId)) {
-        BALL_LOG_ERROR << "Not enough data to read classId";
+    if (dataLen < sizeof(classId) + sizeof(methodId)) {
+        BALL_LOG_ERROR << "Not enough data to read classId and methodId";
         return false;
     }
 
     memcpy(&classId, data, sizeof(classId));
+    memcpy(&methodId, data + sizeof(classId), sizeof(methodId));
+
+    const bsl::uint32_t key = dispatchKey(classId, methodId);
+    const DispatchEntry* entry =
+        bsl::lower_bound(k_DISPATCH_TABLE, k_DISPATCH_TABLE_END, key);
+    if (entry == k_DISPATCH_TABLE_END || entry->key != key) {
+        BALL_LOG_ERROR << "Failed to decode Method with class id: "
+                       << classId << ", method id: " << methodId;
+        return false;
+    }
 
-    return decodeMethodPayload(
-        method, classId, data + sizeof(classId), dataLen - sizeof(classId));
+    const bsl::size_t idsLen = sizeof(classId) + sizeof(methodId);
+    if (!entry->decode(method, data + idsLen, dataLen - idsLen)) {
+        BALL_LOG_ERROR << "Method decode failed [class: " << classId
+                       << ", method: " << methodId << "]";
+        return false;
+    }
+    return true;
 }
 
 void Method::Util::encode(Writer& output, const Method& method)
@@ -0,0 +1,217 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqamqpt_propertiestemplate.h>
+
+#include <rmqamqpt_basicproperties.h>
+#include <rmqamqpt_types.h>
+
+#include <rmqt_fieldvalue.h>
+
+#include <bdlb_bigendian.h>
+#include <bdlt_epochutil.h>
+
+#include <bsl_algorithm.h>
+#include <bsl_memory.h>
+
+namespace BloombergLP {
+namespace rmqamqpt {
+
+namespace {
+
+bsl::shared_ptr<rmqt::FieldTable> copyTable(const rmqt::FieldTable& table);
+bsl::shared_ptr<rmqt::FieldArray> copyArray(const rmqt::FieldArray& array);
+
+/// Copies a FieldValue, including any nested tables or arrays, so that the
+/// copy shares no state with the original
+class FieldValueCopier {
+  public:
+    explicit FieldValueCopier(rmqt::FieldValue* copy)
+    : d_copy(copy)
+    {
+    }
+
+    void operator()(const bsl::shared_ptr<rmqt::FieldTable>& table) const
+    {
+        *d_copy = table ? copyTable(*table) : table;
+    }
+
+    void operator()(const bsl::shared_ptr<rmqt::FieldArray>& array) const
+    {
+        *d_copy = array ? copyArray(*array) : array;
+    }
+
+    template <typename T>
+    void operator()(const T& value) const
+    {
+        *d_copy = value;
+    }
+
+    void operator()(const bslmf::Nil&) const { d_copy->reset(); }
+
+  private:
+    rmqt::FieldValue* d_copy;
+};
+
+bsl::shared_ptr<rmqt::FieldTable> copyTable(const rmqt::FieldTable& table)
+{
+    bsl::shared_ptr<rmqt::FieldTable> copy =
+        bsl::make_shared<rmqt::FieldTable>();
+    for (rmqt::FieldTable::const_iterator it = table.begin();
+         it != table.end();
+         ++it) {
+        it->second.apply(FieldValueCopier(&(*copy)[it->first]));
+    }
+    return copy;
+}
+
+bsl::shared_ptr<rmqt::FieldArray> copyArray(const rmqt::FieldArray& array)
+{
+    bsl::shared_ptr<rmqt::FieldArray> copy =
+        bsl::make_shared<rmqt::FieldArray>();
+    copy->resize(array.size());
+    for (bsl::size_t i = 0; i < array.size(); ++i) {
+        array[i].apply(FieldValueCopier(&(*copy)[i]));
+    }
+    return copy;
+}
+
+bool headersEqual(const bsl::shared_ptr<rmqt::FieldTable>& lhs,
+                  const bsl::shared_ptr<rmqt::FieldTable>& rhs)
+{
+    if (!lhs || !rhs) {
+        return !lhs && !rhs;
+    }
+    return *lhs == *rhs;
+}
+
+uint16_t maskForProperty(BasicProperties::Id id)
+{
+    return static_cast<uint16_t>(1 << (15 - id));
+}
+
+bsl::size_t shortStringSize(const bsl::string& value)
+{
+    // Matches the truncation applied by Types::encodeShortString
+    return sizeof(uint8_t) + bsl::min(value.size(), bsl::size_t(255));
+}
+
+/// Encode `properties` into `output`, without the leading property flags
+void encodeWithoutFlags(bsl::vector<uint8_t>* output,
+                        const rmqt::Properties& properties)
+{
+    Writer writer(output);
+    BasicProperties::encode(writer, BasicProperties(properties));
+    output->erase(output->begin(), output->begin() + sizeof(uint16_t));
+}
+
+void writeBytes(Writer& output, const bsl::vector<uint8_t>& bytes)
+{
+    if (!bytes.empty()) {
+        output.write(bytes.data(), bytes.size());
+    }
+}
+
+} // namespace
+
+PropertiesTemplate::PropertiesTemplate(const rmqt::Properties& properties,
+                                       bslma::Allocator* allocator)
+: d_properties(properties)
+, d_propertyFlags()
+, d_leading(allocator)
+, d_trailing(allocator)
+{
+    d_properties.messageId.reset();
+    d_properties.timestamp.reset();
+    if (d_properties.headers) {
+        d_properties.headers = copyTable(*d_properties.headers);
+    }
+    d_propertyFlags = BasicProperties(d_properties).propertyFlags();
+
+    rmqt::Properties leading;
+    leading.contentType     = d_properties.contentType;
+    leading.contentEncoding = d_properties.contentEncoding;
+    leading.headers         = d_properties.headers;
+    leading.deliveryMode    = d_properties.deliveryMode;
+    leading.priority        = d_properties.priority;
+    leading.correlationId   = d_properties.correlationId;
+    leading.replyTo         = d_properties.replyTo;
+    leading.expiration      = d_properties.expiration;
+    encodeWithoutFlags(&d_leading, leading);
+
+    rmqt::Properties trailing;
+    trailing.type   = d_properties.type;
+    trailing.userId = d_properties.userId;
+    trailing.appId  = d_properties.appId;
+    encodeWithoutFlags(&d_trailing, trailing);
+}
+
+bool PropertiesTemplate::matches(const rmqt::Properties& properties) const
+{
+#define RMQAMQPT_PROPERTY_EQUALS(prop) d_properties.prop == properties.prop
+
+    return RMQAMQPT_PROPERTY_EQUALS(contentType) &&
+           RMQAMQPT_PROPERTY_EQUALS(contentEncoding) &&
+           RMQAMQPT_PROPERTY_EQUALS(deliveryMode) &&
+           RMQAMQPT_PROPERTY_EQUALS(priority) &&
+           RMQAMQPT_PROPERTY_EQUALS(correlationId) &&
+           RMQAMQPT_PROPERTY_EQUALS(replyTo) &&
+           RMQAMQPT_PROPERTY_EQUALS(expiration) &&
+           RMQAMQPT_PROPERTY_EQUALS(type) &&
+           RMQAMQPT_PROPERTY_EQUALS(userId) &&
+           RMQAMQPT_PROPERTY_EQUALS(appId) &&
+           headersEqual(d_properties.headers, properties.headers);
+
+#undef RMQAMQPT_PROPERTY_EQUALS
+}
+
+bsl::size_t
+PropertiesTemplate::encodedSize(const rmqt::Properties& properties) const
+{
+    bsl::size_t totalSize =
+        sizeof(uint16_t) + d_leading.size() + d_trailing.size();
+    if (properties.messageId) {
+        totalSize += shortStringSize(properties.messageId.value());
+    }
+    if (properties.timestamp) {
+        totalSize += sizeof(bdlt::EpochUtil::TimeT64);
+    }
+    return totalSize;
+}
+
+void PropertiesTemplate::encode(Writer& output,
+                                const rmqt::Properties& properties) const
+{
+    uint16_t flags = d_propertyFlags;
+    if (properties.messageId) {
+        flags |= maskForProperty(BasicProperties::MESSAGE_ID);
+    }
+    if (properties.timestamp) {
+        flags |= maskForProperty(BasicProperties::TIMESTAMP);
+    }
+    Types::write(output, bdlb::BigEndianUint16::make(flags));
+
+    writeBytes(output, d_leading);
+    if (properties.messageId) {
+        Types::encodeShortString(output, properties.messageId.value());
+    }
+    if (properties.timestamp) {
+        Types::encodeTimestamp(output, properties.timestamp.value());
+    }
+    writeBytes(output, d_trailing);
+}
+
+} // namespace rmqamqpt
+} // namespace BloombergLP
@@ -0,0 +1,84 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQAMQPT_PROPERTIESTEMPLATE
+#define INCLUDED_RMQAMQPT_PROPERTIESTEMPLATE
+
+#include <rmqamqpt_writer.h>
+
+#include <rmqt_properties.h>
+
+#include <bslma_allocator.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_cstdint.h>
+#include <bsl_vector.h>
+
+//@PURPOSE: Encode BasicProperties which repeat across messages only once
+//
+//@CLASSES:
+//  rmqamqpt::PropertiesTemplate: The pre-encoded static portion of a set of
+//      message properties, into which each message's id & timestamp are
+//      patched when encoding
+
+namespace BloombergLP {
+namespace rmqamqpt {
+
+/// \brief Pre-encoded message properties, for publishing many messages whose
+/// properties differ only in `messageId` and `timestamp`
+///
+/// Every other property, including the `headers` table, is encoded once on
+/// construction. The template keeps its own deep copy of the properties, so
+/// `matches` remains correct if the caller later modifies the headers table
+/// it passed in.
+
+class PropertiesTemplate {
+  public:
+    /// Pre-encode all of `properties` except `messageId` and `timestamp`
+    explicit PropertiesTemplate(const rmqt::Properties& properties,
+                                bslma::Allocator* allocator = 0);
+
+    /// Return true if `properties` is equal to the properties this template
+    /// was constructed from, ignoring `messageId` and `timestamp`. This is
+    /// considerably cheaper than encoding the headers table.
+    bool matches(const rmqt::Properties& properties) const;
+
+    /// Return the size of `properties` encoded as BasicProperties.
+    /// The behaviour is undefined unless `matches(properties)`.
+    bsl::size_t encodedSize(const rmqt::Properties& properties) const;
+
+    /// Write `properties` as BasicProperties, identically to
+    /// `BasicProperties::encode`, copying the pre-encoded static portion.
+    /// The behaviour is undefined unless `matches(properties)`.
+    void encode(Writer& output, const rmqt::Properties& properties) const;
+
+  private:
+    rmqt::Properties d_properties;
+    // Deep copy of the static properties: messageId & timestamp are unset
+
+    uint16_t d_propertyFlags;
+    // Flags for the static properties
+
+    bsl::vector<uint8_t> d_leading;
+    // Encoded properties preceding messageId on the wire
+
+    bsl::vector<uint8_t> d_trailing;
+    // Encoded properties following timestamp on the wire
+};
+
+} // namespace rmqamqpt
+} // namespace BloombergLP
+
+#endif
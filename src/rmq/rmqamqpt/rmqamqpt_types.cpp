@@ -65,6 +65,29 @@ bool decodeString(bsl::string* string, rmqamqpt::Buffer* buffer)
     return true;
 }
 
+/// Write a placeholder for the 4 byte length of a table or array, and
+/// return its offset. The length is only known once the contents have been
+/// written: patching it in then saves measuring (nested) contents twice.
+bsl::size_t beginLengthPrefix(Writer& output)
+{
+    const bsl::size_t lengthOffset = output.offset();
+    Types::write(output, bdlb::BigEndianUint32::make(0));
+    return lengthOffset;
+}
+
+/// Patch in the length of everything written since `beginLengthPrefix`
+/// returned `lengthOffset`
+void endLengthPrefix(Writer& output, bsl::size_t lengthOffset)
+{
+    const bsl::size_t contentOffset =
+        lengthOffset + sizeof(bdlb::BigEndianUint32);
+    const bdlb::BigEndianUint32 length =
+        bdlb::BigEndianUint32::make(output.offset() - contentOffset);
+    output.overwrite(lengthOffset,
+                     reinterpret_cast<const uint8_t*>(&length),
+                     sizeof(length));
+}
+
 } // namespace
 
 bool Types::decodeLongString(bsl::string* string, rmqamqpt::Buffer* buffer)
@@ -254,11 +277,11 @@ bool Types::decodeFieldValue(rmqt::FieldValue* outValue,
             // TODO Handle Decimal
         } break;
         case rmqamqpt::FieldValue::LONG_STRING: {
-            bsl::string val;
-            if (!decodeLongString(&val, buffer)) {
+            // Decode in place, rather than copying the string into the value
+            *outValue = bsl::string();
+            if (!decodeLongString(&outValue->the<bsl::string>(), buffer)) {
                 return false;
             }
-            *outValue = val;
         } break;
         case rmqamqpt::FieldValue::BYTE_ARRAY: {
             if (buffer->available() < sizeof(bdlb::BigEndianUint32)) {
@@ -266,11 +289,12 @@ bool Types::decodeFieldValue(rmqt::FieldValue* outValue,
             }
             const bsl::uint32_t arraySize = static_cast<bsl::uint32_t>(
                 buffer->copy<bdlb::BigEndianUint32>());
-            bsl::vector<bsl::uint8_t> val;
-            if (!decodeByteVector(&val, buffer, arraySize)) {
+            *outValue = bsl::vector<bsl::uint8_t>();
+            if (!decodeByteVector(&outValue->the<bsl::vector<bsl::uint8_t> >(),
+                                  buffer,
+                                  arraySize)) {
                 return false;
             }
-            *outValue = val;
         } break;
         case rmqamqpt::FieldValue::FIELD_ARRAY: {
             bsl::shared_ptr<rmqt::FieldArray> val =
@@ -305,6 +329,63 @@ bool Types::decodeFieldValue(rmqt::FieldValue* outValue,
     return true;
 }
 
+bool Types::skipFieldValue(rmqamqpt::Buffer* buffer)
+{
+    if (buffer->available() < sizeof(bsl::uint8_t)) {
+        return false;
+    }
+
+    const rmqamqpt::FieldValue::Type type =
+        static_cast<rmqamqpt::FieldValue::Type>(buffer->copy<bsl::uint8_t>());
+
+    bsl::size_t valueSize = 0;
+    switch (type) {
+        case rmqamqpt::FieldValue::BOOLEAN:
+        case rmqamqpt::FieldValue::SHORT_SHORT_INT:
+        case rmqamqpt::FieldValue::SHORT_SHORT_UINT: {
+            valueSize = sizeof(bsl::uint8_t);
+        } break;
+        case rmqamqpt::FieldValue::SHORT_INT:
+        case rmqamqpt::FieldValue::SHORT_UINT: {
+            valueSize = sizeof(bsl::uint16_t);
+        } break;
+        case rmqamqpt::FieldValue::LONG_INT:
+        case rmqamqpt::FieldValue::LONG_UINT:
+        case rmqamqpt::FieldValue::FLOAT: {
+            valueSize = sizeof(bsl::uint32_t);
+        } break;
+        case rmqamqpt::FieldValue::AMQP_SPEC_LONG_LONG_INT:
+        case rmqamqpt::FieldValue::RABBIT_SPEC_LONG_LONG_INT:
+        case rmqamqpt::FieldValue::DOUBLE:
+        case rmqamqpt::FieldValue::TIMESTAMP: {
+            valueSize = sizeof(bsl::uint64_t);
+        } break;
+        case rmqamqpt::FieldValue::DECIMAL:
+        case rmqamqpt::FieldValue::NO_FIELD: {
+            // Nothing follows the type: decimals are consumed the same way
+            // by `decodeFieldValue`
+        } break;
+        case rmqamqpt::FieldValue::LONG_STRING:
+        case rmqamqpt::FieldValue::BYTE_ARRAY:
+        case rmqamqpt::FieldValue::FIELD_ARRAY:
+        case rmqamqpt::FieldValue::FIELD_TABLE: {
+            if (buffer->available() < sizeof(bdlb::BigEndianUint32)) {
+                return false;
+            }
+            valueSize = buffer->copy<bdlb::BigEndianUint32>();
+        } break;
+        default: {
+            return false;
+        }
+    }
+
+    if (valueSize > buffer->available()) {
+        return false;
+    }
+    buffer->skip(valueSize);
+    return true;
+}
+
 class FieldValueEncoder {
   public:
   private:
@@ -440,12 +521,10 @@ bool Types::decodeFieldArray(rmqt::FieldArray* fieldArray,
 
     rmqamqpt::Buffer arrayBuffer = buffer->consume(arrayLength);
     while (arrayBuffer.available() > 0) {
-        rmqt::FieldValue value;
-        if (!decodeFieldValue(&value, &arrayBuffer)) {
+        fieldArray->push_back(rmqt::FieldValue());
+        if (!decodeFieldValue(&fieldArray->back(), &arrayBuffer)) {
             return false;
         }
-
-        fieldArray->push_back(value);
     }
 
     return true;
@@ -453,15 +532,14 @@ bool Types::decodeFieldArray(rmqt::FieldArray* fieldArray,
 
 void Types::encodeFieldArray(Writer& output, const rmqt::FieldArray& v)
 {
-    const bsl::size_t hostOrderLen =
-        rmqamqpt::FieldValueUtil::fieldArrayContentsEncodedSize(v);
-
-    Types::write(output, bdlb::BigEndianUint32::make(hostOrderLen));
+    const bsl::size_t lengthOffset = beginLengthPrefix(output);
 
     const bsl::size_t numItems = v.size();
     for (bsl::size_t i = 0; i < numItems; ++i) {
         encodeFieldValue(output, v[i]);
     }
+
+    endLengthPrefix(output, lengthOffset);
 }
 
 bool Types::decodeFieldTable(rmqt::FieldTable* table, rmqamqpt::Buffer* buffer)
@@ -476,42 +554,124 @@ bool Types::decodeFieldTable(rmqt::FieldTable* table, rmqamqpt::Buffer* buffer)
     }
 
     rmqamqpt::Buffer tBuffer = buffer->consume(fieldTableLength);
+    bsl::string fieldName;
     while (tBuffer.available() > 0) {
-        bsl::string fieldName;
         if (!decodeShortString(&fieldName, &tBuffer)) {
             BALL_LOG_ERROR << "Cannot read Field name";
             return false;
         }
 
-        rmqt::FieldValue value;
-        if (!decodeFieldValue(&value, &tBuffer)) {
+        const rmqt::FieldTable::iterator existing =
+            table->lower_bound(fieldName);
+        if (existing != table->end() && existing->first == fieldName) {
+            rmqt::FieldValue value;
+            if (!decodeFieldValue(&value, &tBuffer)) {
+                BALL_LOG_ERROR << "Cannot read Field value: " << fieldName;
+                return false;
+            }
+
+            BALL_LOG_ERROR << "Duplicate FieldTable key [" << fieldName
+                           << "]. Using value [" << existing->second
+                           << "], dropping [" << value << "]";
+            continue;
+        }
+
+        // Decode straight into the table, rather than copying each value in
+        const rmqt::FieldTable::iterator inserted =
+            table->insert(existing,
+                          rmqt::FieldTable::value_type(fieldName,
+                                                       rmqt::FieldValue()));
+        if (!decodeFieldValue(&inserted->second, &tBuffer)) {
             BALL_LOG_ERROR << "Cannot read Field value: " << fieldName;
             return false;
         }
+    }
+    return true;
+}
+
+void Types::encodeFieldTable(Writer& output, const rmqt::FieldTable& table)
+{
+    const bsl::size_t lengthOffset = beginLengthPrefix(output);
+
+    for (rmqt::FieldTable::const_iterator it = table.begin(); it != table.end();
+         ++it) {
+        encodeShortString(output, it->first);
+        encodeFieldValue(output, it->second);
+    }
 
-        const bsl::pair<rmqt::FieldTable::iterator, bool> result =
-            table->insert(bsl::make_pair(fieldName, value));
+    endLengthPrefix(output, lengthOffset);
+}
 
-        if (!result.second) {
+bool Types::decodeFieldTable(rmqt::FlatFieldTable* table,
+                             rmqamqpt::Buffer* buffer)
+{
+    if (buffer->available() < sizeof(bdlb::BigEndianUint32)) {
+        BALL_LOG_ERROR << "Not enough data to read table size";
+        return false;
+    }
+    const bdlb::BigEndianUint32 fieldTableLength =
+        buffer->copy<bdlb::BigEndianUint32>();
+    if (fieldTableLength > buffer->available()) {
+        BALL_LOG_ERROR << "Not enough data to read table size: "
+                       << fieldTableLength
+                       << " available: " << buffer->available();
+        return false;
+    }
+
+    const rmqamqpt::Buffer tBuffer = buffer->consume(fieldTableLength);
+
+    // Count the entries first, so they take a single allocation
+    bsl::size_t numFields = 0;
+    for (rmqamqpt::Buffer counter = tBuffer; counter.available() > 0;
+         ++numFields) {
+        const bsl::size_t nameLength = counter.copy<bsl::uint8_t>();
+        if (nameLength > counter.available()) {
+            BALL_LOG_ERROR << "Cannot read Field name";
+            return false;
+        }
+        counter.skip(nameLength);
+        if (!skipFieldValue(&counter)) {
+            BALL_LOG_ERROR << "Cannot read Field value";
+            return false;
+        }
+    }
+    table->reserve(table->size() + numFields);
+
+    for (rmqamqpt::Buffer fields = tBuffer; fields.available() > 0;) {
+        const bsl::size_t nameLength = fields.copy<bsl::uint8_t>();
+        const bslstl::StringRef fieldName(
+            reinterpret_cast<const char*>(fields.ptr()), nameLength);
+        fields.skip(nameLength);
+
+        rmqt::FieldValue* value = table->emplace(fieldName);
+        if (!value) {
             BALL_LOG_ERROR << "Duplicate FieldTable key [" << fieldName
-                           << "]. Using value [" << result.first->second
-                           << "], dropping [" << value << "]";
+                           << "]. Using value [" << *table->find(fieldName)
+                           << "], dropping the later value";
+            skipFieldValue(&fields);
+            continue;
+        }
+
+        if (!decodeFieldValue(value, &fields)) {
+            BALL_LOG_ERROR << "Cannot read Field value: " << fieldName;
+            return false;
         }
     }
     return true;
 }
 
-void Types::encodeFieldTable(Writer& output, const rmqt::FieldTable& table)
+void Types::encodeFieldTable(Writer& output, const rmqt::FlatFieldTable& table)
 {
-    Types::write(
-        output,
-        bdlb::BigEndianUint32::make(FieldValueUtil::encodedTableSize(table)));
+    const bsl::size_t lengthOffset = beginLengthPrefix(output);
 
-    for (rmqt::FieldTable::const_iterator it = table.begin(); it != table.end();
+    for (rmqt::FlatFieldTable::const_iterator it = table.begin();
+         it != table.end();
          ++it) {
         encodeShortString(output, it->first);
         encodeFieldValue(output, it->second);
     }
+
+    endLengthPrefix(output, lengthOffset);
 }
 
 void Types::encodeTimestamp(Writer& output, const bdlt::Datetime& timestamp)
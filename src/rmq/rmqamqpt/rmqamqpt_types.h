@@ -21,6 +21,7 @@
 #include <rmqamqpt_writer.h>
 
 #include <rmqt_fieldvalue.h>
+#include <rmqt_flatfieldtable.h>
 
 #include <bsl_cstdint.h>
 #include <bsl_sstream.h>
@@ -62,6 +63,10 @@ class Types {
 
     static void encodeFieldValue(Writer& output, const rmqt::FieldValue& value);
 
+    /// Step `buffer` over one encoded field value without decoding it.
+    /// Return false if the value is malformed or truncated.
+    static bool skipFieldValue(rmqamqpt::Buffer* buffer);
+
     static bool decodeFieldArray(rmqt::FieldArray* fieldArray,
                                  rmqamqpt::Buffer* buffer);
 
@@ -72,6 +77,16 @@ class Types {
 
     static void encodeFieldTable(Writer& output, const rmqt::FieldTable& table);
 
+    /// Decode a field table into `table`, adding to any entries it already
+    /// holds. Entries are reserved up front, and keys are compared in the
+    /// buffer, so apart from nested tables and arrays every allocation is
+    /// made with the table's allocator.
+    static bool decodeFieldTable(rmqt::FlatFieldTable* table,
+                                 rmqamqpt::Buffer* buffer);
+
+    static void encodeFieldTable(Writer& output,
+                                 const rmqt::FlatFieldTable& table);
+
     static void encodeTimestamp(Writer& output,
                                 const bdlt::Datetime& timestamp);
 
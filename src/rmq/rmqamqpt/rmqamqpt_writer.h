@@ -16,7 +16,11 @@
 #ifndef INCLUDED_RMQAMQPT_WRITER
 #define INCLUDED_RMQAMQPT_WRITER
 
+#include <bsls_assert.h>
+#include <bsls_keyword.h>
+
 #include <bsl_cstdint.h>
+#include <bsl_cstring.h>
 #include <bsl_sstream.h>
 #include <bsl_string.h>
 #include <bsl_vector.h>
@@ -27,18 +31,36 @@ namespace rmqamqpt {
 /// \brief Represents a wrapper around memcpy, holding a pointer to a
 /// dynamically allocating container and keeping track of offsets across
 /// multiple write calls
+///
+/// Alternatively a Writer can write into a fixed buffer, sized up front from
+/// the `encodedSize` of what is written (measure, then write). Writes into a
+/// fixed buffer are plain copies, with no capacity checks or reallocation.
 
 class Writer {
   public:
     Writer(bsl::vector<uint8_t>* storage)
     : d_currOffset(0)
     , d_storage(storage)
+    , d_buffer(0)
+    , d_length(0)
     {
     }
 
     Writer(bsl::vector<uint8_t>* storage, size_t startOffset)
     : d_currOffset(startOffset)
     , d_storage(storage)
+    , d_buffer(0)
+    , d_length(0)
+    {
+    }
+
+    /// Write into the `length` bytes at `buffer`. The behaviour is undefined
+    /// if more than `length` bytes are written.
+    Writer(uint8_t* buffer, size_t length)
+    : d_currOffset(0)
+    , d_storage(0)
+    , d_buffer(buffer)
+    , d_length(length)
     {
     }
 
@@ -46,11 +68,43 @@ class Writer {
 
     inline void write(const uint8_t* bytes, size_t count)
     {
-        d_storage->resize(d_currOffset + count);
-        memcpy(d_storage->data() + d_currOffset, bytes, count);
+        if (!d_storage) {
+            BSLS_ASSERT(d_currOffset + count <= d_length);
+            memcpy(d_buffer + d_currOffset, bytes, count);
+        }
+        else if (d_currOffset == d_storage->size()) {
+            // Appending: avoid zero-filling bytes which are then overwritten
+            d_storage->insert(d_storage->end(), bytes, bytes + count);
+        }
+        else {
+            d_storage->resize(d_currOffset + count);
+            memcpy(d_storage->data() + d_currOffset, bytes, count);
+        }
         d_currOffset += count;
     }
 
+    /// Replace `count` bytes already written at `offset`, e.g. a length
+    /// prefix only known once what follows it has been written
+    void overwrite(size_t offset, const uint8_t* bytes, size_t count)
+    {
+        BSLS_ASSERT(offset + count <= d_currOffset);
+        memcpy((d_storage ? d_storage->data() : d_buffer) + offset,
+               bytes,
+               count);
+    }
+
+    /// Ensure `count` more bytes can be written without reallocating
+    void reserve(size_t count)
+    {
+        if (d_storage) {
+            d_storage->reserve(d_currOffset + count);
+        }
+    }
+
+    /// The offset the next write goes to, i.e. the bytes written so far
+    /// when starting from offset 0
+    size_t offset() const { return d_currOffset; }
+
   private:
     // No copies
     Writer(const Writer&) BSLS_KEYWORD_DELETED;
@@ -58,6 +112,8 @@ class Writer {
 
     size_t d_currOffset;
     bsl::vector<uint8_t>* d_storage;
+    uint8_t* d_buffer;
+    size_t d_length;
 };
 
 } // namespace rmqamqpt
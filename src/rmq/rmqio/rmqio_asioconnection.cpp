@@ -16,7 +16,16 @@
 #include <rmqio_asioconnection.h>
 
 #include <rmqio_asiosocketwrapper.h>
+#include <rmqio_coarseclock.h>
+#include <rmqio_decodepool.h>
+#include <rmqio_pipelineclock.h>
+#include <rmqio_readstats.h>
+#include <rmqio_wirecapture.h>
+#include <rmqio_writequeuestats.h>
+#include <rmqt_log.h>
+#include <rmqt_probe.h>
 #include <rmqt_securityparameters.h>
+#include <rmqt_socketoptions.h>
 
 #include <boost/asio.hpp>
 #include <fcntl.h>
@@ -41,10 +50,14 @@ namespace {
 
 BALL_LOG_SET_NAMESPACE_CATEGORY("RMQIO.ASIOCONNECTION")
 
-boost::asio::const_buffer
-frame2buffer(const bsl::shared_ptr<SerializedFrame>& frame)
+void appendFrameBuffers(bsl::vector<boost::asio::const_buffer>* buffers,
+                        const bsl::shared_ptr<SerializedFrame>& frame)
 {
-    return boost::asio::const_buffer(frame->serialized(), frame->frameLength());
+    for (bsl::size_t i = 0; i < frame->numSegments(); ++i) {
+        const SerializedFrame::Segment segment = frame->segment(i);
+        buffers->push_back(
+            boost::asio::const_buffer(segment.first, segment.second));
+    }
 }
 
 bsl::size_t accumulateFun(bsl::size_t totalLen,
@@ -53,15 +66,209 @@ bsl::size_t accumulateFun(bsl::size_t totalLen,
     return totalLen + frame->frameLength();
 }
 
-AsioSocket& use_socket(AsioSocket& socket) { return socket; }
+bsl::size_t
+countSegments(const bsl::vector<bsl::shared_ptr<SerializedFrame> >& frames)
+{
+    bsl::size_t segments = 0;
+    for (bsl::vector<bsl::shared_ptr<SerializedFrame> >::const_iterator it =
+             frames.cbegin();
+         it != frames.cend();
+         ++it) {
+        segments += (*it)->numSegments();
+    }
+    return segments;
+}
 
-AsioSSLSocket& use_socket(AsioSecureSocketWrapper& wrapper)
+/// Plain TCP and Unix domain sockets
+template <typename Protocol,
+          typename Executor,
+          typename Buffers,
+          typename Handler>
+void writeTo(boost::asio::basic_stream_socket<Protocol, Executor>& socket,
+             const Buffers& buffers,
+             bsl::vector<bsl::uint8_t>*,
+             const Handler& handler)
 {
-    return wrapper.socket();
+    boost::asio::async_write(socket, buffers, handler);
+}
+
+/// Once the kernel encrypts records (kTLS) frames are written as plaintext
+/// on the plain socket, bypassing OpenSSL. Otherwise OpenSSL encrypts each
+/// buffer of a gathered write into records of its own, so a write of many
+/// small frames would go out as as many small records: they are copied
+/// into `staging` first, which OpenSSL cuts into full size records.
+template <typename Buffers, typename Handler>
+void writeTo(AsioSecureSocketWrapper& wrapper,
+             const Buffers& buffers,
+             bsl::vector<bsl::uint8_t>* staging,
+             const Handler& handler)
+{
+    if (wrapper.kernelTx()) {
+        boost::asio::async_write(
+            wrapper.socket().next_layer(), buffers, handler);
+    }
+    else if (buffers.size() > 1) {
+        staging->resize(boost::asio::buffer_size(buffers));
+        boost::asio::buffer_copy(boost::asio::buffer(*staging), buffers);
+        boost::asio::async_write(
+            wrapper.socket(), boost::asio::buffer(*staging), handler);
+    }
+    else {
+        boost::asio::async_write(wrapper.socket(), buffers, handler);
+    }
+}
+
+template <typename Protocol,
+          typename Executor,
+          typename Buffers,
+          typename Handler>
+void readFrom(boost::asio::basic_stream_socket<Protocol, Executor>& socket,
+              const Buffers& buffers,
+              const Handler& handler)
+{
+    boost::asio::async_read(
+        socket, buffers, boost::asio::transfer_at_least(1), handler);
+}
+
+template <typename Buffers, typename Handler>
+void readFrom(AsioSecureSocketWrapper& wrapper,
+              const Buffers& buffers,
+              const Handler& handler)
+{
+    if (wrapper.kernelRx()) {
+        boost::asio::async_read(wrapper.socket().next_layer(),
+                                buffers,
+                                boost::asio::transfer_at_least(1),
+                                handler);
+    }
+    else {
+        boost::asio::async_read(wrapper.socket(),
+                                buffers,
+                                boost::asio::transfer_at_least(1),
+                                handler);
+    }
+}
+
+/// Set the integer socket option `Level`/`Name` to `value`, logging a
+/// warning naming it `name` on failure
+template <int Level, int Name, typename SocketType>
+void setIntOption(bsl::shared_ptr<SocketType>& socket,
+                  int value,
+                  const char* name)
+{
+    typedef boost::asio::detail::socket_option::integer<Level, Name> Option;
+
+    boost::system::error_code ec;
+    socket->lowest_layer().set_option(Option(value), ec);
+    if (ec) {
+        BALL_LOG_WARN << "Failed to set socket " << name << " to " << value
+                      << ": " << ec.message();
+    }
+}
+
+template <typename SocketType>
+void setBusyPoll(bsl::shared_ptr<SocketType>& socket, int microseconds)
+{
+#ifdef SO_BUSY_POLL
+    // Not fatal: raising SO_BUSY_POLL may need CAP_NET_ADMIN
+    setIntOption<SOL_SOCKET, SO_BUSY_POLL>(
+        socket, microseconds, "SO_BUSY_POLL (us)");
+#else
+    (void)socket;
+    BALL_LOG_WARN << "SO_BUSY_POLL (" << microseconds
+                  << "us) is not supported on this platform";
+#endif
 }
 
+/// Ask the kernel to ack received segments straight away. The kernel falls
+/// back to delayed acks by itself, so this is repeated after every read,
+/// and failures are not logged
 template <typename SocketType>
-bool prepareSocket(bsl::shared_ptr<SocketType>& socket)
+void rearmQuickAck(bsl::shared_ptr<SocketType>& socket)
+{
+#ifdef TCP_QUICKACK
+    typedef boost::asio::detail::socket_option::integer<IPPROTO_TCP,
+                                                        TCP_QUICKACK>
+        QuickAck;
+
+    boost::system::error_code ec;
+    socket->lowest_layer().set_option(QuickAck(1), ec);
+#else
+    (void)socket;
+#endif
+}
+
+/// Unix domain sockets have no acks to rearm
+void rearmQuickAck(bsl::shared_ptr<AsioLocalSocket>&) {}
+
+/// Apply the optional settings of `options`, which are logged and skipped
+/// if they cannot be set
+template <typename SocketType>
+void applySocketOptions(bsl::shared_ptr<SocketType>& socket,
+                        const rmqt::SocketOptions& options)
+{
+    if (options.sendBufferSize() > 0) {
+        setIntOption<SOL_SOCKET, SO_SNDBUF>(
+            socket, options.sendBufferSize(), "SO_SNDBUF");
+    }
+    if (options.receiveBufferSize() > 0) {
+        setIntOption<SOL_SOCKET, SO_RCVBUF>(
+            socket, options.receiveBufferSize(), "SO_RCVBUF");
+    }
+
+    if (options.quickAck()) {
+#ifdef TCP_QUICKACK
+        setIntOption<IPPROTO_TCP, TCP_QUICKACK>(socket, 1, "TCP_QUICKACK");
+#else
+        BALL_LOG_WARN << "TCP_QUICKACK is not supported on this platform";
+#endif
+    }
+
+    if (options.userTimeout() > bsls::TimeInterval()) {
+#ifdef TCP_USER_TIMEOUT
+        setIntOption<IPPROTO_TCP, TCP_USER_TIMEOUT>(
+            socket,
+            static_cast<int>(options.userTimeout().totalMilliseconds()),
+            "TCP_USER_TIMEOUT (ms)");
+#else
+        BALL_LOG_WARN << "TCP_USER_TIMEOUT is not supported on this platform";
+#endif
+    }
+
+    if (!options.keepAlive()) {
+        return;
+    }
+
+#if defined(TCP_KEEPIDLE) && defined(TCP_KEEPINTVL) && defined(TCP_KEEPCNT)
+    if (options.keepAliveIdle() > bsls::TimeInterval()) {
+        setIntOption<IPPROTO_TCP, TCP_KEEPIDLE>(
+            socket,
+            static_cast<int>(options.keepAliveIdle().seconds()),
+            "TCP_KEEPIDLE (s)");
+    }
+    if (options.keepAliveInterval() > bsls::TimeInterval()) {
+        setIntOption<IPPROTO_TCP, TCP_KEEPINTVL>(
+            socket,
+            static_cast<int>(options.keepAliveInterval().seconds()),
+            "TCP_KEEPINTVL (s)");
+    }
+    if (options.keepAliveCount() > 0) {
+        setIntOption<IPPROTO_TCP, TCP_KEEPCNT>(
+            socket, options.keepAliveCount(), "TCP_KEEPCNT");
+    }
+#else
+    if (options.keepAliveIdle() > bsls::TimeInterval() ||
+        options.keepAliveInterval() > bsls::TimeInterval() ||
+        options.keepAliveCount() > 0) {
+        BALL_LOG_WARN << "Keepalive probe settings are not supported on this "
+                         "platform";
+    }
+#endif
+}
+
+template <typename SocketType>
+bool prepareSocket(bsl::shared_ptr<SocketType>& socket,
+                   const ConnectionOptions& options)
 {
 #if defined(__sun)
     /* In 32-bit processes, SunOS limits the file descriptors that may be
@@ -69,7 +276,7 @@ bool prepareSocket(bsl::shared_ptr<SocketType>& socket)
      * on these low descriptors, try to use file descriptors >= 256. */
     const int MIN_ACCEPTABLE_SUN_FD = 256;
     int s                           = socket->lowest_layer().native_handle();
-    BALL_LOG_DEBUG << "File descriptor initial value is " << s;
+    RMQT_LOG_DEBUG << "File descriptor initial value is " << s;
     if (s < MIN_ACCEPTABLE_SUN_FD) {
         int newSocket;
         if ((newSocket = fcntl(s, F_DUPFD, 256)) != -1) {
@@ -78,15 +285,17 @@ bool prepareSocket(bsl::shared_ptr<SocketType>& socket)
                                           newSocket);
         }
     }
-    BALL_LOG_DEBUG << "File descriptor is "
+    RMQT_LOG_DEBUG << "File descriptor is "
                    << socket->lowest_layer().native_handle();
 #endif
 
-    BALL_LOG_DEBUG << "Turning on TCP_NODELAY & KEEP_ALIVE";
+    const rmqt::SocketOptions& socketOptions = options.socketOptions();
+    RMQT_LOG_DEBUG << "Applying " << socketOptions;
     boost::system::error_code ec;
 
     // Nagle must be disabled before the first send
-    socket->lowest_layer().set_option(boost::asio::ip::tcp::no_delay(true), ec);
+    socket->lowest_layer().set_option(
+        boost::asio::ip::tcp::no_delay(socketOptions.noDelay()), ec);
     if (ec) {
         BALL_LOG_ERROR << "Failed to set socket no_delay";
         return false;
@@ -94,12 +303,14 @@ bool prepareSocket(bsl::shared_ptr<SocketType>& socket)
 
     ec = boost::system::error_code();
     socket->lowest_layer().set_option(
-        boost::asio::socket_base::keep_alive(true), ec);
+        boost::asio::socket_base::keep_alive(socketOptions.keepAlive()), ec);
     if (ec) {
         BALL_LOG_ERROR << "Failed to set socket keep_alive";
         return false;
     }
 
+    applySocketOptions(socket, socketOptions);
+
     ec = boost::system::error_code();
     socket->lowest_layer().non_blocking(true, ec);
     if (ec) {
@@ -107,6 +318,34 @@ bool prepareSocket(bsl::shared_ptr<SocketType>& socket)
         return false;
     }
 
+    if (options.busyPollMicroseconds() > 0) {
+        setBusyPoll(socket, options.busyPollMicroseconds());
+    }
+
+    return true;
+}
+
+/// The TCP options of `options` do not apply to a Unix domain socket, only
+/// its buffer sizes
+bool prepareSocket(bsl::shared_ptr<AsioLocalSocket>& socket,
+                   const ConnectionOptions& options)
+{
+    const rmqt::SocketOptions& socketOptions = options.socketOptions();
+    if (socketOptions.sendBufferSize() > 0) {
+        setIntOption<SOL_SOCKET, SO_SNDBUF>(
+            socket, socketOptions.sendBufferSize(), "SO_SNDBUF");
+    }
+    if (socketOptions.receiveBufferSize() > 0) {
+        setIntOption<SOL_SOCKET, SO_RCVBUF>(
+            socket, socketOptions.receiveBufferSize(), "SO_RCVBUF");
+    }
+
+    boost::system::error_code ec;
+    socket->non_blocking(true, ec);
+    if (ec) {
+        BALL_LOG_ERROR << "Failed to set socket non-blocking";
+        return false;
+    }
     return true;
 }
 
@@ -117,9 +356,64 @@ void AsioConnection<SocketType>::asyncWrite(
     const bsl::vector<bsl::shared_ptr<SerializedFrame> >& framePtrs,
     const SuccessWriteCallback& cb)
 {
-    d_writeQueue.push_back(bsl::make_pair(cb, framePtrs));
+    d_writeQueue.push(framePtrs, cb);
+
+    if (d_options.writeQueueStats()) {
+        const bsl::size_t bytes = bsl::accumulate(
+            framePtrs.cbegin(), framePtrs.cend(), 0u, &accumulateFun);
+        d_options.writeQueueStats()->add(
+            static_cast<bsls::Types::Int64>(bytes));
+        d_queuedBytes += bytes;
+    }
+
+    if (!d_inFlight.frames.empty()) {
+        // Gathered into the next write once the current one completes
+        return;
+    }
+
+    if (d_options.deferWrites()) {
+        deferWrite();
+    }
+    else {
+        startNextWrite();
+    }
+}
+
+template <typename SocketType>
+void AsioConnection<SocketType>::deferWrite()
+{
+    if (d_flushPosted || !d_socket) {
+        return;
+    }
+
+    d_flushPosted = true;
+    boost::asio::post(
+        d_socket->lowest_layer().get_executor(),
+        bdlf::BindUtil::bind(&AsioConnection<SocketType>::flushCb,
+                             AsioConnection<SocketType>::weak_from_this(),
+                             d_socket));
+}
+
+template <typename SocketType>
+void AsioConnection<SocketType>::flushCb(
+    const bsl::weak_ptr<AsioConnection>& weakSelf,
+    const bsl::shared_ptr<SocketType>&)
+{
+    bsl::shared_ptr<AsioConnection> self = weakSelf.lock();
+    if (!self) {
+        return;
+    }
+
+    self->flush();
+}
+
+template <typename SocketType>
+void AsioConnection<SocketType>::flush()
+{
+    d_flushPosted = false;
 
-    if (d_writeQueue.size() == 1) {
+    // A write completing before the flush ran has already started the next
+    if (d_inFlight.frames.empty() && !d_writeQueue.empty()) {
         startNextWrite();
     }
 }
@@ -133,24 +427,35 @@ void AsioConnection<SocketType>::startNextWrite()
     }
 
     BSLS_ASSERT(!d_writeQueue.empty());
-    const bsl::vector<bsl::shared_ptr<SerializedFrame> >& framePtrs =
-        d_writeQueue[0].second;
+    BSLS_ASSERT(d_inFlight.frames.empty());
+
+    // Cork queued writes: gather as many frames as fit within the configured
+    // limits into one vectored write, control frames first. Zero-copy frames
+    // contribute several segments each (header, payload view and frame end).
+    d_writeQueue.pop(&d_inFlight,
+                     d_options.maxCoalescedWriteBytes(),
+                     d_options.maxCoalescedWriteBuffers());
 
     bsl::vector<boost::asio::const_buffer> buffers;
-    buffers.reserve(framePtrs.size());
-    bsl::transform(framePtrs.cbegin(),
-                   framePtrs.cend(),
-                   bsl::back_inserter(buffers),
-                   &frame2buffer);
-
-    boost::asio::async_write(
-        use_socket(*d_socket),
-        buffers,
-        bdlf::BindUtil::bind(&AsioConnection<SocketType>::handleWriteCb,
-                             AsioConnection<SocketType>::weak_from_this(),
-                             bdlf::PlaceHolders::_1,
-                             bdlf::PlaceHolders::_2,
-                             d_socket));
+    buffers.reserve(countSegments(d_inFlight.frames));
+    for (bsl::vector<bsl::shared_ptr<SerializedFrame> >::const_iterator it =
+             d_inFlight.frames.cbegin();
+         it != d_inFlight.frames.cend();
+         ++it) {
+        appendFrameBuffers(&buffers, *it);
+    }
+
+    writeTo(*d_socket,
+            buffers,
+            &d_writeStaging,
+            makeAllocatingHandler(
+                d_handlerMemory,
+                bdlf::BindUtil::bind(
+                    &AsioConnection<SocketType>::handleWriteCb,
+                    AsioConnection<SocketType>::weak_from_this(),
+                    bdlf::PlaceHolders::_1,
+                    bdlf::PlaceHolders::_2,
+                    d_socket)));
 }
 
 template <typename SocketType>
@@ -163,31 +468,120 @@ bool AsioConnection<SocketType>::markConnected()
 
     d_state = CONNECTED;
 
-    return prepareSocket(d_socket) && startRead();
+    return prepareSocket(d_socket, d_options) && startRead();
 }
 
 template <typename SocketType>
 bool AsioConnection<SocketType>::startRead()
 {
     if (!d_socket) {
-        BALL_LOG_DEBUG << "Not reading due to socket close";
+        RMQT_LOG_DEBUG << "Not reading due to socket close";
         return false;
     }
 
-    boost::asio::async_read(
-        use_socket(*d_socket),
-        prepareBuffer(),
-        boost::asio::transfer_at_least(1), // read at least 1byte
-        bdlf::BindUtil::bind(&AsioConnection<SocketType>::handleReadCb,
-                             AsioConnection<SocketType>::weak_from_this(),
-                             bdlf::PlaceHolders::_1,
-                             bdlf::PlaceHolders::_2,
-                             d_socket,
-                             d_inbound));
+    if (d_readBuffer) {
+        bsl::vector<bsl::uint8_t>& block = *d_readBuffer->block;
+        readFrom(*d_socket,
+                 boost::asio::buffer(block.data(), block.size()),
+                 makeAllocatingHandler(
+                     d_handlerMemory,
+                     bdlf::BindUtil::bind(
+                         &AsioConnection<SocketType>::handleReadCb,
+                         AsioConnection<SocketType>::weak_from_this(),
+                         bdlf::PlaceHolders::_1,
+                         bdlf::PlaceHolders::_2,
+                         d_socket,
+                         d_readLifetime)));
+        return true;
+    }
+
+    readFrom(*d_socket,
+             prepareBuffer(),
+             makeAllocatingHandler(
+                 d_handlerMemory,
+                 bdlf::BindUtil::bind(
+                     &AsioConnection<SocketType>::handleReadCb,
+                     AsioConnection<SocketType>::weak_from_this(),
+                     bdlf::PlaceHolders::_1,
+                     bdlf::PlaceHolders::_2,
+                     d_socket,
+                     d_readLifetime)));
 
     return true;
 }
 
+template <typename SocketType>
+void AsioConnection<SocketType>::pauseReading()
+{
+    d_readPaused = true;
+}
+
+template <typename SocketType>
+void AsioConnection<SocketType>::resumeReading()
+{
+    d_readPaused = false;
+    if (d_readIdle) {
+        d_readIdle = false;
+        if (d_state == CONNECTED) {
+            RMQT_LOG_DEBUG << "Reads resumed";
+            startRead();
+        }
+    }
+}
+
+template <typename SocketType>
+Connection::ReadTimes AsioConnection<SocketType>::readTimes() const
+{
+    return d_readTimes;
+}
+
+template <typename SocketType>
+bsl::size_t AsioConnection<SocketType>::queuedWrites() const
+{
+    return d_writeQueue.entries() + d_inFlight.completed.size();
+}
+
+template <typename SocketType>
+bsl::size_t AsioConnection<SocketType>::retainedBytes() const
+{
+    // The decode pool's threads use the decoder's buffer
+    bsl::size_t bytes =
+        (d_decodeQueue ? 0 : d_frameDecoder->bufferCapacity()) +
+        d_readFrames.capacity() * sizeof(rmqamqpt::Frame);
+    if (d_readBuffer) {
+        bytes += d_readBuffer->block->capacity();
+    }
+    return bytes + d_writeStaging.capacity();
+}
+
+template <typename SocketType>
+void AsioConnection<SocketType>::trim()
+{
+    if (!d_decodeQueue) {
+        d_frameDecoder->trim();
+    }
+    if (d_readFrames.empty()) {
+        // Otherwise some are still to be handed on, see `continueRead`
+        bsl::vector<rmqamqpt::Frame>().swap(d_readFrames);
+    }
+    d_writeQueue.trim();
+    if (d_inFlight.frames.empty()) {
+        // Otherwise the write in progress may still be reading from it
+        bsl::vector<bsl::uint8_t>().swap(d_writeStaging);
+    }
+
+    // The block an outstanding read is filling is replaced by one of the
+    // reset size once the read completes
+    d_readSizer.reset();
+}
+
+template <typename SocketType>
+void AsioConnection<SocketType>::setChannelWeight(bsl::uint16_t channel,
+                                                  unsigned weight)
+{
+    d_writeQueue.setWeight(channel, weight);
+}
+
 template <typename SocketType>
 void AsioConnection<SocketType>::close(const DoneCallback& cb)
 {
@@ -195,7 +589,7 @@ void AsioConnection<SocketType>::close(const DoneCallback& cb)
     d_state    = CLOSING;
     boost::system::error_code ec;
     if (d_socket) {
-        BALL_LOG_TRACE << "Shutting down socket";
+        RMQT_LOG_TRACE << "Shutting down socket";
         d_socket->shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
     }
     if (ec) {
@@ -211,27 +605,67 @@ template <typename SocketType>
 AsioConnection<SocketType>::AsioConnection(
     bsl::shared_ptr<SocketType> connecting_socket,
     const Connection::Callbacks& callbacks,
-    bslma::ManagedPtr<Decoder> decoder)
+    bslma::ManagedPtr<Decoder> decoder,
+    const ConnectionOptions& options)
 : d_socket(connecting_socket)
 , d_callbacks(callbacks)
 , d_frameDecoder(decoder)
 , d_shutdown()
 , d_state(CONNECTING)
 , d_inbound(bsl::make_shared<boost::asio::streambuf>())
+, d_readBuffer()
+, d_readLifetime(d_inbound)
+, d_readFrames()
+, d_readFramesHanded(0)
+, d_handlerMemory(bsl::make_shared<HandlerMemory>())
 , d_writeQueue()
+, d_inFlight()
+, d_writeStaging()
+, d_flushPosted(false)
+, d_queuedBytes(0)
+, d_options(options)
+, d_readPaused(false)
+, d_readIdle(false)
+, d_readTimes()
+, d_readSizer(d_frameDecoder->maxFrameSize(), options.maxReadBytes())
+, d_captureStream(options.wireCapture() ? options.wireCapture()->newStream()
+                                        : 0)
+, d_decodeQueue(0)
 {
+    if (d_frameDecoder->mode() == Decoder::IN_PLACE) {
+        d_readBuffer        = bsl::make_shared<ReadBuffer>();
+        d_readBuffer->block =
+            bsl::allocate_shared<bsl::vector<bsl::uint8_t> >(
+                d_options.readAllocator(), d_frameDecoder->maxFrameSize());
+        d_readLifetime = d_readBuffer;
+
+        if (d_options.decodePool()) {
+            d_decodeQueue = d_options.decodePool()->createQueue();
+        }
+    }
 }
 
 template <typename SocketType>
 AsioConnection<SocketType>::~AsioConnection()
 {
-    BALL_LOG_TRACE << "~AsioConnection()";
+    RMQT_LOG_TRACE << "~AsioConnection()";
     if (d_socket) {
         // AsioConnection destructor is an intentional disconnect
         // This error code is important for what we pass back up via
         // `d_callbacks`.
         doClose(GRACEFUL_DISCONNECT);
     }
+
+    if (d_options.writeQueueStats()) {
+        d_options.writeQueueStats()->remove(
+            static_cast<bsls::Types::Int64>(d_writeQueue.entries() +
+                                            d_inFlight.completed.size()),
+            static_cast<bsls::Types::Int64>(d_queuedBytes));
+    }
+
+    if (d_decodeQueue) {
+        d_options.decodePool()->deleteQueue(d_decodeQueue);
+    }
 }
 
 template <typename SocketType>
@@ -239,22 +673,33 @@ void AsioConnection<SocketType>::handleWrite(boost::system::error_code error,
                                              bsl::size_t bytes_transferred)
 
 {
-    const CallbackDataPair& front = d_writeQueue[0];
-
     if (!error) {
-        BSLS_ASSERT_OPT(bytes_transferred ==
-                        bsl::accumulate(front.second.cbegin(),
-                                        front.second.cend(),
-                                        0u,
-                                        &accumulateFun));
+        BSLS_ASSERT_OPT(bytes_transferred == d_inFlight.bytes);
+        if (d_options.wireCapture()) {
+            d_options.wireCapture()->record(d_captureStream,
+                                            d_inFlight.frames);
+        }
+        RMQT_PROBE2(write_completed,
+                    d_inFlight.completed.size(),
+                    bytes_transferred);
 
-        front.first();
+        // Callbacks may queue further writes, which are started below
+        for (bsl::size_t i = 0; i < d_inFlight.completed.size(); ++i) {
+            d_inFlight.completed[i]();
+        }
     }
     else {
         handleError(error);
     }
 
-    d_writeQueue.pop_front();
+    if (d_options.writeQueueStats()) {
+        d_options.writeQueueStats()->remove(
+            static_cast<bsls::Types::Int64>(d_inFlight.completed.size()),
+            static_cast<bsls::Types::Int64>(d_inFlight.bytes));
+        d_queuedBytes -= d_inFlight.bytes;
+    }
+
+    d_inFlight = WriteQueue::Batch();
     if (!d_writeQueue.empty()) {
         startNextWrite();
     }
@@ -271,7 +716,7 @@ void AsioConnection<SocketType>::handleWriteCb(
 
     bsl::shared_ptr<AsioConnection> self = weakSelf.lock();
     if (!self) {
-        BALL_LOG_DEBUG
+        RMQT_LOG_DEBUG
             << "Write callback completed after socket object destruction";
         return;
     }
@@ -285,17 +730,22 @@ void AsioConnection<SocketType>::handleReadCb(
     boost::system::error_code error, // Result of operation.
     bsl::size_t bytes_transferred,   // Number of bytes received.
     const bsl::shared_ptr<SocketType>&,
-    const bsl::shared_ptr<boost::asio::streambuf>&)
+    const bsl::shared_ptr<void>&)
 {
     // Extend socket/buffer lifetime to the end of this completion handler
 
+    // One clock read covers every frame decoded from this read
+    CoarseClock::tick();
+    const bsls::Types::Int64 completed = PipelineClock::now();
+
     bsl::shared_ptr<AsioConnection> self = weakSelf.lock();
     if (!self) {
-        BALL_LOG_DEBUG
+        RMQT_LOG_DEBUG
             << "Read callback completed after socket object destruction";
         return;
     }
 
+    self->d_readTimes.completed = completed;
     self->handleRead(error, bytes_transferred);
 }
 
@@ -305,10 +755,25 @@ void AsioConnection<SocketType>::handleRead(boost::system::error_code error,
 
 {
     if (!error) {
-        if (doRead(bytes_transferred)) {
-            startRead(); // read more
+        if (d_options.readStats()) {
+            d_options.readStats()->add(
+                static_cast<bsls::Types::Int64>(bytes_transferred));
+        }
+        d_readSizer.record(bytes_transferred);
+        if (d_options.socketOptions().quickAck()) {
+            rearmQuickAck(d_socket);
+        }
+
+        if (d_decodeQueue) {
+            submitDecode(bytes_transferred);
+        }
+        else if (d_readBuffer ? doReadInPlace(bytes_transferred)
+                              : doRead(bytes_transferred)) {
+            continueRead();
         }
         else {
+            // Still hand on the frames decoded before the bad one
+            handReadFrames(d_readFrames.size());
             doClose(FRAME_ERROR);
         }
     }
@@ -317,10 +782,78 @@ void AsioConnection<SocketType>::handleRead(boost::system::error_code error,
     }
 }
 
+template <typename SocketType>
+void AsioConnection<SocketType>::continueRead()
+{
+    const bsl::size_t budget = d_options.readFrameBudget();
+    if (!handReadFrames(budget && d_socket ? budget : d_readFrames.size())) {
+        // Let the other connections on the event loop run first
+        boost::asio::post(
+            d_socket->lowest_layer().get_executor(),
+            bdlf::BindUtil::bind(&AsioConnection<SocketType>::continueReadCb,
+                                 AsioConnection<SocketType>::weak_from_this(),
+                                 d_socket));
+        return;
+    }
+
+    if (d_readBuffer && (d_readBuffer->block.use_count() != 1 ||
+                         d_readBuffer->block->size() != d_readSizer.size())) {
+        // Some frames (e.g. partial message bodies) are still referencing
+        // this block, or the read size changed: read the next bytes into a
+        // fresh one
+        d_readBuffer->block =
+            bsl::allocate_shared<bsl::vector<bsl::uint8_t> >(
+                d_options.readAllocator(), d_readSizer.size());
+    }
+
+    if (d_readPaused) {
+        RMQT_LOG_DEBUG << "Reads paused";
+        d_readIdle = true;
+    }
+    else {
+        startRead(); // read more
+    }
+}
+
+template <typename SocketType>
+void AsioConnection<SocketType>::continueReadCb(
+    const bsl::weak_ptr<AsioConnection>& weakSelf,
+    const bsl::shared_ptr<SocketType>&)
+{
+    bsl::shared_ptr<AsioConnection> self = weakSelf.lock();
+    if (!self) {
+        return;
+    }
+
+    self->continueRead();
+}
+
+template <typename SocketType>
+bool AsioConnection<SocketType>::handReadFrames(bsl::size_t limit)
+{
+    const bsl::size_t end =
+        bsl::min(d_readFrames.size(), d_readFramesHanded + limit);
+    for (; d_readFramesHanded < end; ++d_readFramesHanded) {
+        d_callbacks.onRead(d_readFrames[d_readFramesHanded]);
+    }
+    if (d_readFramesHanded < d_readFrames.size()) {
+        return false;
+    }
+
+    d_readFrames.clear();
+    d_readFramesHanded = 0;
+    return true;
+}
+
 template <>
 bool AsioConnection<AsioSecureSocketWrapper>::handleSecureError(
     boost::system::error_code)
 {
+    if (d_socket->kernelTx()) {
+        // OpenSSL no longer owns the write sequence, so it cannot send
+        // close_notify
+        return false;
+    }
     d_socket->socket().async_shutdown(bdlf::BindUtil::bind(
         &AsioConnection<AsioSecureSocketWrapper>::handleCloseCb,
         AsioConnection<AsioSecureSocketWrapper>::weak_from_this(),
@@ -342,15 +875,15 @@ void AsioConnection<SocketType>::handleReadError(
     switch (error.value()) {
         case boost::asio::error::eof:
             if (d_state == CLOSING) {
-                BALL_LOG_DEBUG << "Received EOF from broker (Already Closing)";
+                RMQT_LOG_DEBUG << "Received EOF from broker (Already Closing)";
             }
             else {
-                BALL_LOG_DEBUG << "Received unexpected EOF from remote peer";
+                RMQT_LOG_DEBUG << "Received unexpected EOF from remote peer";
             }
             break;
         case boost::asio::error::operation_aborted:
             if (d_state == CLOSING) {
-                BALL_LOG_DEBUG << "Callback Cancelled (operation aborted): "
+                RMQT_LOG_DEBUG << "Callback Cancelled (operation aborted): "
                                   "graceful shutdown";
             }
             else {
@@ -367,7 +900,7 @@ void AsioConnection<SocketType>::handleReadError(
                 ERR_error_string_n(error.value(), buf, sizeof(buf));
                 tlsError << buf;
 
-                BALL_LOG_DEBUG << "TLS Short Read: " << tlsError.str();
+                RMQT_LOG_DEBUG << "TLS Short Read: " << tlsError.str();
             }
             break;
         default:
@@ -399,11 +932,11 @@ void AsioConnection<SocketType>::handleError(boost::system::error_code error)
 {
     switch (error.value()) {
         case boost::asio::error::eof:
-            BALL_LOG_DEBUG << "Socket closed: " << error.message()
+            RMQT_LOG_DEBUG << "Socket closed: " << error.message()
                            << ". Current state: " << d_state;
             break;
         case boost::asio::error::operation_aborted:
-            BALL_LOG_DEBUG << "Socket closed: " << error.message()
+            RMQT_LOG_DEBUG << "Socket closed: " << error.message()
                            << ". Current state: " << d_state;
             break;
         default:
@@ -427,7 +960,7 @@ template <typename SocketType>
 const boost::asio::streambuf::mutable_buffers_type
 AsioConnection<SocketType>::prepareBuffer()
 {
-    return d_inbound->prepare(d_frameDecoder->maxFrameSize());
+    return d_inbound->prepare(d_readSizer.size());
 }
 
 template <typename SocketType>
@@ -436,21 +969,28 @@ bool AsioConnection<SocketType>::doRead(bsl::size_t bytes_transferred)
 
     bool success = true;
 
-    // d_inbound is setup with a buffer size of maxFrameSize in ::prepareBuffer
-    BSLS_ASSERT(bytes_transferred <= d_frameDecoder->maxFrameSize());
+    // d_inbound is setup with a buffer of d_readSizer.size() bytes in
+    // ::prepareBuffer, which recording this read never took below it
+    BSLS_ASSERT(bytes_transferred <= d_readSizer.size());
 
     d_inbound->commit(bytes_transferred);
 
     bsl::size_t bytes_decoded                       = 0;
     boost::asio::streambuf::const_buffers_type bufs = d_inbound->data();
-    bsl::vector<rmqamqpt::Frame> readFrames;
     for (boost::asio::streambuf::const_buffers_type::const_iterator i =
              bufs.begin();
          i != bufs.end();
          ++i) {
         boost::asio::const_buffer buf(*i);
+        if (d_options.wireCapture()) {
+            d_options.wireCapture()->record(
+                d_captureStream,
+                WireCapture::INBOUND,
+                static_cast<const bsl::uint8_t*>(buf.data()),
+                buf.size());
+        }
         Decoder::ReturnCode rcode =
-            d_frameDecoder->appendBytes(&readFrames, buf.data(), buf.size());
+            d_frameDecoder->appendBytes(&d_readFrames, buf.data(), buf.size());
         if (rcode != Decoder::OK) {
             BALL_LOG_WARN << "Bad rcode from decoder: " << rcode;
             // Fail but we still want to process frames we were able to decode
@@ -464,11 +1004,134 @@ bool AsioConnection<SocketType>::doRead(bsl::size_t bytes_transferred)
         BALL_LOG_WARN << "bytes_decoded (" << bytes_decoded
                       << ") != bytes_transferred (" << bytes_transferred << ")";
     }
-    bsl::for_each(readFrames.begin(), readFrames.end(), d_callbacks.onRead);
+    d_readTimes.decoded = PipelineClock::now();
     d_inbound->consume(bytes_decoded);
     return success;
 }
 
+template <typename SocketType>
+bool AsioConnection<SocketType>::doReadInPlace(bsl::size_t bytes_transferred)
+{
+    BSLS_ASSERT(bytes_transferred <= d_readBuffer->block->size());
+
+    bool success = true;
+
+    if (d_options.wireCapture()) {
+        d_options.wireCapture()->record(d_captureStream,
+                                        WireCapture::INBOUND,
+                                        d_readBuffer->block->data(),
+                                        bytes_transferred);
+    }
+
+    Decoder::ReturnCode rcode = d_frameDecoder->decodeInPlace(
+        &d_readFrames, d_readBuffer->block, bytes_transferred);
+    if (rcode != Decoder::OK) {
+        BALL_LOG_WARN << "Bad rcode from decoder: " << rcode;
+        // Fail but we still want to process frames we were able to decode
+        success = false;
+    }
+
+    d_readTimes.decoded = PipelineClock::now();
+    return success;
+}
+
+template <typename SocketType>
+void AsioConnection<SocketType>::submitDecode(bsl::size_t bytes_transferred)
+{
+    BSLS_ASSERT(bytes_transferred <= d_readBuffer->block->size());
+
+    if (d_options.wireCapture()) {
+        d_options.wireCapture()->record(d_captureStream,
+                                        WireCapture::INBOUND,
+                                        d_readBuffer->block->data(),
+                                        bytes_transferred);
+    }
+
+    if (d_options.decodePool()->enqueue(
+            d_decodeQueue,
+            bdlf::BindUtil::bind(&AsioConnection<SocketType>::decodeJob,
+                                 AsioConnection<SocketType>::weak_from_this(),
+                                 d_frameDecoder,
+                                 d_readBuffer->block,
+                                 bytes_transferred,
+                                 d_socket)) != 0) {
+        BALL_LOG_ERROR << "Decode pool is not running, closing connection";
+        doClose(DISCONNECTED_ERROR);
+        return;
+    }
+
+    // The decode job holds the block just read
+    d_readBuffer->block = bsl::allocate_shared<bsl::vector<bsl::uint8_t> >(
+        d_options.readAllocator(), d_readSizer.size());
+
+    if (d_readPaused) {
+        RMQT_LOG_DEBUG << "Reads paused";
+        d_readIdle = true;
+    }
+    else {
+        startRead();
+    }
+}
+
+template <typename SocketType>
+void AsioConnection<SocketType>::decodeJob(
+    const bsl::weak_ptr<AsioConnection>& weakSelf,
+    const bsl::shared_ptr<Decoder>& decoder,
+    const bsl::shared_ptr<bsl::vector<bsl::uint8_t> >& block,
+    bsl::size_t length,
+    const bsl::shared_ptr<SocketType>& socketLifetime)
+{
+    bsl::shared_ptr<bsl::vector<rmqamqpt::Frame> > frames =
+        bsl::make_shared<bsl::vector<rmqamqpt::Frame> >();
+
+    Decoder::ReturnCode rcode =
+        decoder->decodeInPlace(frames.get(), block, length);
+    if (rcode != Decoder::OK) {
+        BALL_LOG_WARN << "Bad rcode from decoder: " << rcode;
+    }
+
+    boost::asio::post(
+        socketLifetime->lowest_layer().get_executor(),
+        bdlf::BindUtil::bind(&AsioConnection<SocketType>::decodedCb,
+                             weakSelf,
+                             frames,
+                             rcode == Decoder::OK,
+                             socketLifetime));
+}
+
+template <typename SocketType>
+void AsioConnection<SocketType>::decodedCb(
+    const bsl::weak_ptr<AsioConnection>& weakSelf,
+    const bsl::shared_ptr<bsl::vector<rmqamqpt::Frame> >& frames,
+    bool success,
+    const bsl::shared_ptr<SocketType>&)
+{
+    bsl::shared_ptr<AsioConnection> self = weakSelf.lock();
+    if (!self || self->d_state == DISCONNECTED) {
+        // Including reads decoded after a bad frame closed the connection
+        return;
+    }
+
+    self->handDecodedFrames(*frames, success);
+}
+
+template <typename SocketType>
+void AsioConnection<SocketType>::handDecodedFrames(
+    const bsl::vector<rmqamqpt::Frame>& frames,
+    bool success)
+{
+    d_readTimes.decoded = PipelineClock::now();
+
+    // Still hand on the frames decoded before a bad one
+    for (bsl::size_t i = 0; i < frames.size(); ++i) {
+        d_callbacks.onRead(frames[i]);
+    }
+
+    if (!success) {
+        doClose(FRAME_ERROR);
+    }
+}
+
 template <typename SocketType>
 void AsioConnection<SocketType>::handleCloseCb(
     const bsl::weak_ptr<AsioConnection>& weakSelf,
@@ -476,7 +1139,7 @@ void AsioConnection<SocketType>::handleCloseCb(
     const bsl::shared_ptr<SocketType>&)
 {
     // Extend socket lifetime to the end of this completion handler
-    BALL_LOG_TRACE << "async_shutdown: " << error.message();
+    RMQT_LOG_TRACE << "async_shutdown: " << error.message();
 
     if (error && error.value() != boost::asio::ssl::error::stream_truncated) {
         BALL_LOG_INFO << "rcode with async_shutdown: " << error.message();
@@ -484,7 +1147,7 @@ void AsioConnection<SocketType>::handleCloseCb(
 
     bsl::shared_ptr<AsioConnection> self = weakSelf.lock();
     if (!self) {
-        BALL_LOG_DEBUG
+        RMQT_LOG_DEBUG
             << "Close callback completed after socket object destruction";
         return;
     }
@@ -508,7 +1171,7 @@ void AsioConnection<SocketType>::doClose(Connection::ReturnCode rc)
         else {
             // This happens when the shutdown is triggered by the socket
             // closing
-            BALL_LOG_DEBUG << "Graceful disconnect but no shutdown handler";
+            RMQT_LOG_DEBUG << "Graceful disconnect but no shutdown handler";
         }
     }
     d_state = DISCONNECTED;
@@ -517,6 +1180,7 @@ void AsioConnection<SocketType>::doClose(Connection::ReturnCode rc)
 
 template class AsioConnection<AsioSocket>;
 template class AsioConnection<AsioSecureSocketWrapper>;
+template class AsioConnection<AsioLocalSocket>;
 
 } // namespace rmqio
 } // namespace BloombergLP
@@ -17,14 +17,16 @@
 #define INCLUDED_RMQIO_ASIOCONNECTION
 
 #include <rmqio_connection.h>
+#include <rmqio_connectionoptions.h>
 #include <rmqio_decoder.h>
+#include <rmqio_handlermemory.h>
+#include <rmqio_readsizer.h>
 #include <rmqio_serializedframe.h>
+#include <rmqio_writequeue.h>
 
 #include <bsl_cstddef.h>
-#include <bsl_deque.h>
 #include <bsl_memory.h>
 #include <bsl_optional.h>
-#include <bsl_utility.h>
 #include <bsl_vector.h>
 #include <bslma_managedptr.h>
 #include <bsls_keyword.h>
@@ -40,17 +42,41 @@ class AsioConnection
 : public Connection,
   public bsl::enable_shared_from_this<AsioConnection<SocketType> > {
   public:
+    // Final, so calls on a known connection type need no virtual dispatch.
+    // Tests substitute `rmqio::Connection` as a whole instead.
+
     virtual void
     asyncWrite(const bsl::vector<bsl::shared_ptr<SerializedFrame> >& frames,
-               const SuccessWriteCallback&) BSLS_KEYWORD_OVERRIDE;
+               const SuccessWriteCallback&)
+        BSLS_KEYWORD_OVERRIDE BSLS_KEYWORD_FINAL;
+
+    virtual void
+    close(const DoneCallback& cb) BSLS_KEYWORD_OVERRIDE BSLS_KEYWORD_FINAL;
+
+    virtual bool isConnected() const BSLS_KEYWORD_OVERRIDE BSLS_KEYWORD_FINAL;
+
+    virtual void pauseReading() BSLS_KEYWORD_OVERRIDE BSLS_KEYWORD_FINAL;
 
-    virtual void close(const DoneCallback& cb) BSLS_KEYWORD_OVERRIDE;
+    virtual void resumeReading() BSLS_KEYWORD_OVERRIDE BSLS_KEYWORD_FINAL;
 
-    virtual bool isConnected() const BSLS_KEYWORD_OVERRIDE;
+    virtual ReadTimes
+    readTimes() const BSLS_KEYWORD_OVERRIDE BSLS_KEYWORD_FINAL;
+
+    virtual void setChannelWeight(bsl::uint16_t channel, unsigned weight)
+        BSLS_KEYWORD_OVERRIDE BSLS_KEYWORD_FINAL;
+
+    virtual bsl::size_t
+    queuedWrites() const BSLS_KEYWORD_OVERRIDE BSLS_KEYWORD_FINAL;
+
+    virtual bsl::size_t
+    retainedBytes() const BSLS_KEYWORD_OVERRIDE BSLS_KEYWORD_FINAL;
+
+    virtual void trim() BSLS_KEYWORD_OVERRIDE BSLS_KEYWORD_FINAL;
 
     AsioConnection(bsl::shared_ptr<SocketType> connecting_socket,
                    const Callbacks& callbacks,
-                   bslma::ManagedPtr<Decoder> decoder);
+                   bslma::ManagedPtr<Decoder> decoder,
+                   const ConnectionOptions& options = ConnectionOptions());
 
     ~AsioConnection() BSLS_KEYWORD_OVERRIDE;
 
@@ -71,7 +97,7 @@ class AsioConnection
                  boost::system::error_code error, // Result of operation.
                  bsl::size_t bytes_transferred,   // Number of bytes received.
                  const bsl::shared_ptr<SocketType>& socketLifetime,
-                 const bsl::shared_ptr<boost::asio::streambuf>& bufferLifetime);
+                 const bsl::shared_ptr<void>& bufferLifetime);
 
     void handleRead(boost::system::error_code error, // Result of operation.
                     bsl::size_t bytes_transferred // Number of bytes received.
@@ -79,6 +105,43 @@ class AsioConnection
 
     bool doRead(bsl::size_t bytes_transferred);
 
+    bool doReadInPlace(bsl::size_t bytes_transferred);
+
+    /// Hand the block just read to the decode pool, then read the next
+    /// into a fresh block
+    void submitDecode(bsl::size_t bytes_transferred);
+
+    /// Decode `length` bytes of `block` with `decoder`, on a decode pool
+    /// thread, and post the frames back to the socket's executor
+    static void
+    decodeJob(const bsl::weak_ptr<AsioConnection>& weakSelf,
+              const bsl::shared_ptr<Decoder>& decoder,
+              const bsl::shared_ptr<bsl::vector<bsl::uint8_t> >& block,
+              bsl::size_t length,
+              const bsl::shared_ptr<SocketType>& socketLifetime);
+
+    static void
+    decodedCb(const bsl::weak_ptr<AsioConnection>& weakSelf,
+              const bsl::shared_ptr<bsl::vector<rmqamqpt::Frame> >& frames,
+              bool success,
+              const bsl::shared_ptr<SocketType>& socketLifetime);
+
+    /// Hand on the frames of a read decoded by the decode pool
+    void handDecodedFrames(const bsl::vector<rmqamqpt::Frame>& frames,
+                           bool success);
+
+    /// Hand the decoded frames on, within the read frame budget, then read
+    /// again, or post the rest if the budget ran out
+    void continueRead();
+
+    static void
+    continueReadCb(const bsl::weak_ptr<AsioConnection>& weakSelf,
+                   const bsl::shared_ptr<SocketType>& socketLifetime);
+
+    /// Hand up to `limit` more of `d_readFrames` to `onRead`. Return true,
+    /// having cleared them, once all have been handed on.
+    bool handReadFrames(bsl::size_t limit);
+
     void handleReadError(boost::system::error_code error);
 
     bool handleSecureError(boost::system::error_code error);
@@ -96,6 +159,15 @@ class AsioConnection
 
     void startNextWrite();
 
+    /// Post a flush of the queued writes to the event loop, unless one is
+    /// already posted
+    void deferWrite();
+
+    static void flushCb(const bsl::weak_ptr<AsioConnection>& weakSelf,
+                        const bsl::shared_ptr<SocketType>& socketLifetime);
+
+    void flush();
+
     bool startRead();
 
     enum State { CONNECTING, CONNECTED, CLOSING, DISCONNECTED };
@@ -103,15 +175,70 @@ class AsioConnection
   private:
     bsl::shared_ptr<SocketType> d_socket;
     Callbacks d_callbacks;
-    bslma::ManagedPtr<Decoder> d_frameDecoder;
+    // Shared with the decode jobs in flight, when there is a decode pool
+    bsl::shared_ptr<Decoder> d_frameDecoder;
     bsl::optional<DoneCallback> d_shutdown;
     State d_state;
     bsl::shared_ptr<boost::asio::streambuf> d_inbound;
 
-    typedef bsl::pair<SuccessWriteCallback,
-                      bsl::vector<bsl::shared_ptr<SerializedFrame> > >
-        CallbackDataPair;
-    bsl::deque<CallbackDataPair> d_writeQueue;
+    /// Inbound block used when the decoder is in IN_PLACE mode. Frames
+    /// decoded from a read share `block`, so it is replaced rather than
+    /// reused while any of them are still alive.
+    struct ReadBuffer {
+        bsl::shared_ptr<bsl::vector<bsl::uint8_t> > block;
+    };
+    bsl::shared_ptr<ReadBuffer> d_readBuffer;
+
+    /// Whichever of `d_inbound` and `d_readBuffer` reads go into, kept so
+    /// each read binds it without converting it afresh
+    bsl::shared_ptr<void> d_readLifetime;
+
+    /// Frames decoded from the current read. Cleared once they have been
+    /// handed to `onRead`, keeping its capacity for the next read.
+    bsl::vector<rmqamqpt::Frame> d_readFrames;
+
+    /// How many of `d_readFrames` have been handed to `onRead`, see
+    /// `ConnectionOptions::setReadFrameBudget`
+    bsl::size_t d_readFramesHanded;
+
+    /// Memory asio allocates the operations of this connection's reads and
+    /// writes from
+    bsl::shared_ptr<HandlerMemory> d_handlerMemory;
+
+    WriteQueue d_writeQueue;
+
+    /// Frames taken from `d_writeQueue` for the socket write currently in
+    /// progress, empty if there is none
+    WriteQueue::Batch d_inFlight;
+
+    /// The frames of `d_inFlight` copied into one buffer, so a TLS write
+    /// is encrypted into full size records, see `writeTo`
+    bsl::vector<bsl::uint8_t> d_writeStaging;
+
+    /// Set while a flush posted by `deferWrite` has not run yet
+    bool d_flushPosted;
+
+    /// Bytes queued and not yet written, kept when counting them into the
+    /// options' write queue stats
+    bsl::size_t d_queuedBytes;
+    ConnectionOptions d_options;
+
+    /// Set by `pauseReading`. `d_readIdle` is set when a read completed
+    /// while paused, so no read is outstanding
+    bool d_readPaused;
+    bool d_readIdle;
+
+    ReadTimes d_readTimes;
+
+    /// Decides how many bytes the next read asks for
+    ReadSizer d_readSizer;
+
+    /// This connection's stream in `d_options.wireCapture()`, if set
+    bsl::uint32_t d_captureStream;
+
+    /// This connection's queue in `d_options.decodePool()`, or 0 if reads
+    /// are decoded on the event loop
+    int d_decodeQueue;
 };
 
 } // namespace rmqio
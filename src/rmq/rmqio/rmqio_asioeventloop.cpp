@@ -16,10 +16,17 @@
 #include <rmqio_asioeventloop.h>
 #include <rmqio_asioresolver.h>
 #include <rmqio_asiotimer.h>
+#include <rmqio_coarseclock.h>
+#include <rmqio_timerwheel.h>
+
+#include <rmqt_log.h>
 
 #include <ball_log.h>
+#include <bdlf_bind.h>
 #include <boost/asio.hpp>
 #include <bslmt_lockguard.h>
+#include <bsls_timeutil.h>
+#include <bsls_types.h>
 
 #include <bsl_iostream.h>
 #include <bsl_memory.h>
@@ -30,18 +37,99 @@ namespace rmqio {
 
 namespace {
 BALL_LOG_SET_NAMESPACE_CATEGORY("RMQIO.ASIOEVENTLOOP")
+
+/// The reactor asio was built with, see the RMQ_IO_URING build option
+#if defined(BOOST_ASIO_HAS_IO_URING) && defined(BOOST_ASIO_DISABLE_EPOLL)
+const char k_IO_BACKEND[] = "io_uring";
+#else
+const char k_IO_BACKEND[] = "default";
+#endif
 } // namespace
 
-AsioEventLoop::AsioEventLoop()
+const bsl::size_t AsioEventLoop::k_DEFAULT_POST_QUEUE_CAPACITY;
+
+AsioEventLoop::AsioEventLoop(const bsls::TimeInterval& busyPollBudget,
+                             bsl::size_t postQueueCapacity,
+                             const bsls::TimeInterval& timerWheelTick,
+                             bool trackLoad)
 : EventLoop()
-, d_context()
+, d_ownedContext(
+      bslma::ManagedPtrUtil::makeManaged<boost::asio::io_context>())
+, d_context(*d_ownedContext)
+, d_ownsThread(true)
 , d_workGuard(boost::asio::make_work_guard(d_context))
 , d_resolver()
 , d_timerFactory()
 , d_mutex()
 , d_condition()
 , d_exited(false)
+, d_busyPollBudget(busyPollBudget)
+, d_timerWheelTick(timerWheelTick)
+, d_idleSpinNanoseconds(0)
+, d_spinHandlers(0)
+, d_blockingWakeups(0)
+, d_postQueue()
+, d_drainScheduled(false)
+, d_bypassedPosts(0)
+, d_trackLoad(trackLoad)
+, d_pendingPosts(0)
+, d_iterations(0)
+, d_postedNanoseconds(0)
+, d_ioNanoseconds(0)
+, d_maxIterationNanoseconds(0)
 {
+    if (postQueueCapacity > 0) {
+        d_postQueue = bslma::ManagedPtrUtil::makeManaged<MpscQueue<Item> >(
+            postQueueCapacity);
+    }
+}
+
+AsioEventLoop::AsioEventLoop(boost::asio::io_context& context,
+                             bsl::size_t postQueueCapacity,
+                             const bsls::TimeInterval& timerWheelTick)
+: EventLoop()
+, d_ownedContext()
+, d_context(context)
+, d_ownsThread(false)
+, d_workGuard(boost::asio::make_work_guard(d_context))
+, d_resolver()
+, d_timerFactory()
+, d_mutex()
+, d_condition()
+, d_exited(false)
+, d_busyPollBudget()
+, d_timerWheelTick(timerWheelTick)
+, d_idleSpinNanoseconds(0)
+, d_spinHandlers(0)
+, d_blockingWakeups(0)
+, d_postQueue()
+, d_drainScheduled(false)
+, d_bypassedPosts(0)
+, d_trackLoad(false)
+, d_pendingPosts(0)
+, d_iterations(0)
+, d_postedNanoseconds(0)
+, d_ioNanoseconds(0)
+, d_maxIterationNanoseconds(0)
+{
+    if (postQueueCapacity > 0) {
+        d_postQueue = bslma::ManagedPtrUtil::makeManaged<MpscQueue<Item> >(
+            postQueueCapacity);
+    }
+}
+
+bsl::shared_ptr<AsioEventLoop>
+AsioEventLoop::makeDriven(bsl::size_t postQueueCapacity,
+                          const bsls::TimeInterval& timerWheelTick)
+{
+    bslma::ManagedPtr<boost::asio::io_context> context =
+        bslma::ManagedPtrUtil::makeManaged<boost::asio::io_context>();
+    bsl::shared_ptr<AsioEventLoop> loop = bsl::make_shared<AsioEventLoop>(
+        bsl::ref(*context), postQueueCapacity, timerWheelTick);
+
+    // Declared first, so the context outlives everything using it
+    loop->d_ownedContext = context;
+    return loop;
 }
 
 AsioEventLoop::~AsioEventLoop()
@@ -69,11 +157,15 @@ AsioEventLoop::~AsioEventLoop()
 
 bool AsioEventLoop::waitForEventLoopExit(int64_t waitTimeSec)
 {
-    BALL_LOG_TRACE << "Beginning to wait " << waitTimeSec
+    RMQT_LOG_TRACE << "Beginning to wait " << waitTimeSec
                    << " seconds for event loop exit";
     bsls::TimeInterval timeoutTime = bsls::SystemTime::nowRealtimeClock();
     timeoutTime.addSeconds(waitTimeSec);
 
+    if (d_ownedContext && !d_ownsThread) {
+        return runDrivenUntilExit(timeoutTime);
+    }
+
     bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
     if (d_exited) {
         return true;
@@ -84,6 +176,13 @@ bool AsioEventLoop::waitForEventLoopExit(int64_t waitTimeSec)
 
     removeWorkGuard();
 
+    if (!d_ownsThread) {
+        // The application keeps running the context, so it never returns:
+        // instead, once everything posted before now has run, nothing is
+        // left for this loop to do
+        postImpl(bdlf::BindUtil::bind(&AsioEventLoop::markExited, this));
+    }
+
     while (!d_exited) {
         if (bslmt::Condition::e_TIMED_OUT ==
             d_condition.timedWait(&d_mutex, timeoutTime)) {
@@ -91,32 +190,318 @@ bool AsioEventLoop::waitForEventLoopExit(int64_t waitTimeSec)
         }
     }
 
-    BALL_LOG_TRACE << "Stopped waiting for event loop exit";
+    RMQT_LOG_TRACE << "Stopped waiting for event loop exit";
 
     return true;
 }
 
 void AsioEventLoop::removeWorkGuard() { d_workGuard.reset(); }
 
-void AsioEventLoop::onThreadStarted()
+void AsioEventLoop::markExited()
 {
-    BALL_LOG_TRACE << "asio context.run";
-    d_context.run();
-
     bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
     d_exited = true;
     d_condition.broadcast();
 }
 
-void AsioEventLoop::postImpl(const Item& item) { d_context.post(item); }
-void AsioEventLoop::dispatchImpl(const Item& item) { d_context.dispatch(item); }
+bool AsioEventLoop::runDrivenUntilExit(const bsls::TimeInterval& timeoutTime)
+{
+    {
+        bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+        if (d_exited) {
+            return true;
+        }
+
+        d_resolver.reset();
+        removeWorkGuard();
+    }
+
+    // Nobody else runs the loop, so run it here, as the loop thread would,
+    // until everything outstanding has finished
+    while (!d_context.stopped()) {
+        if (bsls::SystemTime::nowRealtimeClock() >= timeoutTime) {
+            return false;
+        }
+        d_context.run_one_for(boost::asio::chrono::milliseconds(100));
+    }
+
+    markExited();
+    return true;
+}
+
+bool AsioEventLoop::runsOwnThread() const { return d_ownsThread; }
+
+bsl::size_t AsioEventLoop::poll()
+{
+    if (d_ownsThread || !d_ownedContext) {
+        // Someone else runs the loop
+        return 0;
+    }
+    CoarseClock::tick();
+    return d_context.poll();
+}
+
+bsl::size_t AsioEventLoop::runFor(const bsls::TimeInterval& duration)
+{
+    if (d_ownsThread || !d_ownedContext) {
+        // Someone else runs the loop
+        return 0;
+    }
+    CoarseClock::tick();
+    return d_context.run_for(
+        boost::asio::chrono::microseconds(duration.totalMicroseconds()));
+}
+
+void AsioEventLoop::onThreadStarted()
+{
+    BALL_LOG_INFO << "Event loop started, asio backend: " << k_IO_BACKEND;
+
+    if (d_busyPollBudget > bsls::TimeInterval()) {
+        RMQT_LOG_TRACE << "asio context busy poll, budget: "
+                       << d_busyPollBudget;
+        runBusyPoll();
+    }
+    else if (d_trackLoad) {
+        RMQT_LOG_TRACE << "asio context.poll, tracking load";
+        runTrackingLoad();
+    }
+    else if (CoarseClock::isEnabled()) {
+        RMQT_LOG_TRACE << "asio context.run_one, ticking CoarseClock";
+        while (d_context.run_one()) {
+            CoarseClock::tick();
+        }
+    }
+    else {
+        RMQT_LOG_TRACE << "asio context.run";
+        d_context.run();
+    }
+
+    markExited();
+}
+
+void AsioEventLoop::runBusyPoll()
+{
+    const bsls::Types::Int64 budget = d_busyPollBudget.totalNanoseconds();
+
+    while (!d_context.stopped()) {
+        bsls::Types::Int64 lastPoll  = bsls::TimeUtil::getTimer();
+        bsls::Types::Int64 idleSince = lastPoll;
+
+        // Spin until we have found nothing to do for a whole budget. The
+        // context stops (and poll returns 0) once all work is done.
+        for (;;) {
+            const bsls::Types::Int64 postedBefore =
+                d_postedNanoseconds.loadRelaxed();
+            const bsl::size_t handled    = d_context.poll();
+            const bsls::Types::Int64 now = bsls::TimeUtil::getTimer();
+            if (handled) {
+                CoarseClock::tick();
+                d_spinHandlers.addRelaxed(
+                    static_cast<bsls::Types::Int64>(handled));
+                idleSince = now;
+                if (d_trackLoad) {
+                    recordIteration(lastPoll, now, postedBefore);
+                }
+            }
+            else {
+                d_idleSpinNanoseconds.addRelaxed(now - lastPoll);
+            }
+            lastPoll = now;
+
+            if (d_context.stopped() || now - idleSince >= budget) {
+                break;
+            }
+        }
+
+        if (!d_context.stopped() && d_context.run_one()) {
+            d_blockingWakeups.addRelaxed(1);
+            if (d_trackLoad) {
+                d_iterations.addRelaxed(1);
+            }
+        }
+    }
+}
+
+void AsioEventLoop::runTrackingLoad()
+{
+    while (!d_context.stopped()) {
+        const bsls::Types::Int64 postedBefore =
+            d_postedNanoseconds.loadRelaxed();
+        const bsls::Types::Int64 start = bsls::TimeUtil::getTimer();
+        if (d_context.poll()) {
+            CoarseClock::tick();
+            recordIteration(start, bsls::TimeUtil::getTimer(), postedBefore);
+            continue;
+        }
+
+        // Nothing ready: block, untimed, until something is
+        if (!d_context.stopped() && d_context.run_one()) {
+            CoarseClock::tick();
+            d_iterations.addRelaxed(1);
+        }
+    }
+}
+
+void AsioEventLoop::recordIteration(bsls::Types::Int64 start,
+                                    bsls::Types::Int64 end,
+                                    bsls::Types::Int64 postedBefore)
+{
+    const bsls::Types::Int64 elapsed = end - start;
+    const bsls::Types::Int64 posted =
+        d_postedNanoseconds.loadRelaxed() - postedBefore;
+
+    d_iterations.addRelaxed(1);
+    if (elapsed > posted) {
+        d_ioNanoseconds.addRelaxed(elapsed - posted);
+    }
+
+    // Only this thread raises the maximum, `loadStats` only resets it
+    bsls::Types::Int64 max = d_maxIterationNanoseconds.loadRelaxed();
+    while (elapsed > max) {
+        const bsls::Types::Int64 previous =
+            d_maxIterationNanoseconds.testAndSwap(max, elapsed);
+        if (previous == max) {
+            break;
+        }
+        max = previous;
+    }
+}
+
+void AsioEventLoop::recordPostsRun(bsls::Types::Int64 count,
+                                   bsls::Types::Int64 start)
+{
+    d_pendingPosts.addRelaxed(-count);
+    d_postedNanoseconds.addRelaxed(bsls::TimeUtil::getTimer() - start);
+}
+
+EventLoop::LoadStats AsioEventLoop::loadStats()
+{
+    LoadStats stats;
+    stats.pendingPosts            = d_pendingPosts.loadRelaxed();
+    stats.iterations              = d_iterations.loadRelaxed();
+    stats.postedNanoseconds       = d_postedNanoseconds.loadRelaxed();
+    stats.ioNanoseconds           = d_ioNanoseconds.loadRelaxed();
+    stats.maxIterationNanoseconds = d_maxIterationNanoseconds.swap(0);
+    return stats;
+}
+
+EventLoop::BusyPollStats AsioEventLoop::busyPollStats() const
+{
+    BusyPollStats stats;
+    stats.idleSpinNanoseconds = d_idleSpinNanoseconds.loadRelaxed();
+    stats.spinHandlers        = d_spinHandlers.loadRelaxed();
+    stats.blockingWakeups     = d_blockingWakeups.loadRelaxed();
+    return stats;
+}
+
+void AsioEventLoop::postImpl(const Item& item)
+{
+    if (d_trackLoad) {
+        d_pendingPosts.addRelaxed(1);
+    }
+
+    if (!d_postQueue) {
+        if (d_trackLoad) {
+            d_context.post(bdlf::BindUtil::bind(
+                &AsioEventLoop::runDirectPost, this, item));
+            return;
+        }
+        d_context.post(item);
+        return;
+    }
+
+    if (d_bypassedPosts.load() == 0 && d_postQueue->tryPush(item)) {
+        // One drain per batch: only the post which finds no drain pending
+        // wakes the loop
+        if (!d_drainScheduled.testAndSwap(false, true)) {
+            d_context.post(
+                bdlf::BindUtil::bind(&AsioEventLoop::drainPostQueue, this));
+        }
+        return;
+    }
+
+    d_bypassedPosts.add(1);
+    d_context.post(
+        bdlf::BindUtil::bind(&AsioEventLoop::runBypassedPost, this, item));
+}
+
+void AsioEventLoop::dispatchImpl(const Item& item)
+{
+    if (d_context.get_executor().running_in_this_thread()) {
+        item();
+    }
+    else {
+        postImpl(item);
+    }
+}
+
+void AsioEventLoop::drainPostQueue()
+{
+    // Cleared before popping, so anything pushed after we find the queue
+    // empty schedules another drain
+    d_drainScheduled.store(false);
+    CoarseClock::tick();
+
+    const bsls::Types::Int64 start =
+        d_trackLoad ? bsls::TimeUtil::getTimer() : 0;
+
+    // Run at most one lap of the ring before letting asio run other handlers
+    Item item;
+    bsl::size_t drained = 0;
+    while (drained < d_postQueue->capacity() && d_postQueue->tryPop(&item)) {
+        ++drained;
+        item();
+    }
+
+    if (d_trackLoad) {
+        recordPostsRun(static_cast<bsls::Types::Int64>(drained), start);
+    }
+
+    if (drained == d_postQueue->capacity() &&
+        !d_drainScheduled.testAndSwap(false, true)) {
+        d_context.post(
+            bdlf::BindUtil::bind(&AsioEventLoop::drainPostQueue, this));
+    }
+}
+
+void AsioEventLoop::runBypassedPost(const Item& item)
+{
+    CoarseClock::tick();
+
+    const bsls::Types::Int64 start =
+        d_trackLoad ? bsls::TimeUtil::getTimer() : 0;
+
+    // Everything queued before `item` was posted must run first
+    Item queued;
+    bsls::Types::Int64 ran = 1;
+    while (d_postQueue->tryPop(&queued)) {
+        ++ran;
+        queued();
+    }
+
+    item();
+
+    d_bypassedPosts.add(-1);
+
+    if (d_trackLoad) {
+        recordPostsRun(ran, start);
+    }
+}
+
+void AsioEventLoop::runDirectPost(const Item& item)
+{
+    const bsls::Types::Int64 start = bsls::TimeUtil::getTimer();
+    item();
+    recordPostsRun(1, start);
+}
 
 bsl::shared_ptr<rmqio::Resolver>
-AsioEventLoop::resolver(bool shuffleConnectionEndpoints)
+AsioEventLoop::resolver(bool shuffleConnectionEndpoints,
+                        const ConnectionOptions& connectionOptions)
 {
     if (!d_resolver) {
-        d_resolver =
-            AsioResolver::create(bsl::ref(*this), shuffleConnectionEndpoints);
+        d_resolver = AsioResolver::create(
+            bsl::ref(*this), shuffleConnectionEndpoints, connectionOptions);
     }
     return d_resolver;
 }
@@ -124,7 +509,14 @@ AsioEventLoop::resolver(bool shuffleConnectionEndpoints)
 bsl::shared_ptr<rmqio::TimerFactory> AsioEventLoop::timerFactory()
 {
     if (!d_timerFactory) {
-        d_timerFactory = bsl::make_shared<AsioTimerFactory>(bsl::ref(*this));
+        if (d_timerWheelTick > bsls::TimeInterval()) {
+            d_timerFactory = bsl::make_shared<TimerWheelFactory>(
+                bsl::ref(*this), d_timerWheelTick);
+        }
+        else {
+            d_timerFactory =
+                bsl::make_shared<AsioTimerFactory>(bsl::ref(*this));
+        }
     }
     return d_timerFactory;
 }
@@ -17,12 +17,18 @@
 #define INCLUDED_RMQIO_ASIOEVENTLOOP
 
 #include <rmqio_eventloop.h>
+#include <rmqio_mpscqueue.h>
 
 #include <boost/asio.hpp>
+#include <bslma_managedptr.h>
 #include <bslmt_condition.h>
 #include <bslmt_mutex.h>
+#include <bsls_atomic.h>
 #include <bsls_keyword.h>
+#include <bsls_timeinterval.h>
+#include <bsls_types.h>
 
+#include <bsl_cstddef.h>
 #include <bsl_memory.h>
 #include <bsl_optional.h>
 
@@ -31,8 +37,46 @@ namespace rmqio {
 class Resolver;
 class TimerFactory;
 
-class AsioEventLoop : public EventLoop {
-    boost::asio::io_context d_context;
+/// \brief EventLoop running a boost::asio::io_context on its own thread
+///
+/// By default the thread blocks in `io_context::run()`. With a non-zero
+/// `busyPollBudget` it instead spins on `io_context::poll()`, only blocking
+/// once it has found no work for `busyPollBudget`. This trades CPU for
+/// latency; `busyPollStats()` reports both sides of that trade.
+///
+/// Work posted from other threads goes through a lock-free submission queue
+/// of `postQueueCapacity` items rather than asio's scheduler mutex. The loop
+/// drains it in batches, so a burst of posts costs one wake-up. When the
+/// queue is full posts go straight to asio, and keep doing so until those
+/// have run, which preserves the order of posts from each thread. A
+/// `postQueueCapacity` of 0 posts everything straight to asio.
+///
+/// With a non-zero `timerWheelTick` the loop's timers share one
+/// `TimerWheel` of that resolution, instead of each owning a deadline_timer.
+///
+/// With `trackLoad` set the loop reports `loadStats()`. It then runs
+/// handlers with `io_context::poll()`, timing each pass, and only blocks in
+/// `run_one()` once a pass finds nothing to do. The handler which ends that
+/// wait is counted but not timed, except for posted items, which are always
+/// timed; under load the loop seldom waits, so nearly all of its time is
+/// accounted for.
+///
+/// An event loop may instead run on an `io_context` the application owns
+/// and runs itself, on exactly one thread, so that calls made from that
+/// thread run inline rather than being posted. `start` then creates no
+/// thread, and busy polling, load tracking and CoarseClock ticking, which
+/// need to own the run loop, do not apply. The application must keep
+/// running the context until the event loop is destroyed, from another
+/// thread.
+///
+/// `makeDriven` makes a loop on an `io_context` of its own which no thread
+/// runs: the application runs it by calling `poll` or `runFor`, e.g. from
+/// its own event loop, and the destructor runs it until it is out of work.
+
+class AsioEventLoop BSLS_KEYWORD_FINAL : public EventLoop {
+    bslma::ManagedPtr<boost::asio::io_context> d_ownedContext;
+    boost::asio::io_context& d_context;
+    const bool d_ownsThread;
     boost::asio::executor_work_guard<boost::asio::io_context::executor_type>
         d_workGuard;
     bsl::shared_ptr<rmqio::Resolver> d_resolver;
@@ -42,27 +86,92 @@ class AsioEventLoop : public EventLoop {
     bslmt::Condition d_condition;
     bool d_exited;
 
+    const bsls::TimeInterval d_busyPollBudget;
+    const bsls::TimeInterval d_timerWheelTick;
+    bsls::AtomicInt64 d_idleSpinNanoseconds;
+    bsls::AtomicInt64 d_spinHandlers;
+    bsls::AtomicInt64 d_blockingWakeups;
+
+    bslma::ManagedPtr<MpscQueue<Item> > d_postQueue;
+    bsls::AtomicBool d_drainScheduled;
+    bsls::AtomicInt d_bypassedPosts;
+    const bool d_trackLoad;
+    bsls::AtomicInt64 d_pendingPosts;
+    bsls::AtomicInt64 d_iterations;
+    bsls::AtomicInt64 d_postedNanoseconds;
+    bsls::AtomicInt64 d_ioNanoseconds;
+    bsls::AtomicInt64 d_maxIterationNanoseconds;
+
   public:
+    /// Must be a power of two
+    static const bsl::size_t k_DEFAULT_POST_QUEUE_CAPACITY = 4096;
+
     // CREATORS
-    AsioEventLoop();
+    explicit AsioEventLoop(
+        const bsls::TimeInterval& busyPollBudget = bsls::TimeInterval(),
+        bsl::size_t postQueueCapacity = k_DEFAULT_POST_QUEUE_CAPACITY,
+        const bsls::TimeInterval& timerWheelTick = bsls::TimeInterval(),
+        bool trackLoad                           = false);
+
+    /// Run on `context`, which the application runs on a single thread
+    /// and which must outlive this event loop
+    explicit AsioEventLoop(
+        boost::asio::io_context& context,
+        bsl::size_t postQueueCapacity = k_DEFAULT_POST_QUEUE_CAPACITY,
+        const bsls::TimeInterval& timerWheelTick = bsls::TimeInterval());
+
+    /// Return a loop run by whoever calls its `poll` or `runFor`
+    static bsl::shared_ptr<AsioEventLoop> makeDriven(
+        bsl::size_t postQueueCapacity = k_DEFAULT_POST_QUEUE_CAPACITY,
+        const bsls::TimeInterval& timerWheelTick = bsls::TimeInterval());
     virtual ~AsioEventLoop() BSLS_KEYWORD_OVERRIDE;
 
-    bool waitForEventLoopExit(int64_t waitTimeSec)
-        BSLS_KEYWORD_OVERRIDE BSLS_KEYWORD_FINAL;
+    bool waitForEventLoopExit(int64_t waitTimeSec) BSLS_KEYWORD_OVERRIDE;
 
     boost::asio::io_context& context() { return d_context; }
 
     bsl::shared_ptr<rmqio::Resolver>
-    resolver(bool shuffleConnectionEndpoints) BSLS_KEYWORD_OVERRIDE;
+    resolver(bool shuffleConnectionEndpoints,
+             const ConnectionOptions& connectionOptions) BSLS_KEYWORD_OVERRIDE;
     bsl::shared_ptr<rmqio::TimerFactory> timerFactory() BSLS_KEYWORD_OVERRIDE;
 
+    BusyPollStats busyPollStats() const BSLS_KEYWORD_OVERRIDE;
+
+    LoadStats loadStats() BSLS_KEYWORD_OVERRIDE;
+
+    bsl::size_t poll() BSLS_KEYWORD_OVERRIDE;
+
+    bsl::size_t
+    runFor(const bsls::TimeInterval& duration) BSLS_KEYWORD_OVERRIDE;
+
   protected:
+    bool runsOwnThread() const BSLS_KEYWORD_OVERRIDE;
     void onThreadStarted() BSLS_KEYWORD_OVERRIDE;
     void postImpl(const Item& item) BSLS_KEYWORD_OVERRIDE;
     void dispatchImpl(const Item& item) BSLS_KEYWORD_OVERRIDE;
 
   private:
     void removeWorkGuard();
+    void markExited();
+
+    /// Run the loop of a `makeDriven` event loop on the calling thread
+    /// until it is out of work, or `timeoutTime` (realtime) passes
+    bool runDrivenUntilExit(const bsls::TimeInterval& timeoutTime);
+    void runBusyPoll();
+    void runTrackingLoad();
+
+    /// Account for a loop iteration which ran from `start` to `end`, and
+    /// began when `d_postedNanoseconds` was `postedBefore`
+    void recordIteration(bsls::Types::Int64 start,
+                         bsls::Types::Int64 end,
+                         bsls::Types::Int64 postedBefore);
+
+    /// Account for `count` posted items, started at `start`, having run
+    void recordPostsRun(bsls::Types::Int64 count, bsls::Types::Int64 start);
+
+    void runDirectPost(const Item& item);
+    void drainPostQueue();
+    void runBypassedPost(const Item& item);
 
     AsioEventLoop(AsioEventLoop&) BSLS_KEYWORD_DELETED;
     AsioEventLoop& operator=(const AsioEventLoop&) BSLS_KEYWORD_DELETED;
@@ -17,6 +17,12 @@
 #include <rmqio_asioresolver.h>
 
 #include <rmqio_asioconnection.h>
+#include <rmqio_connectrace.h>
+#include <rmqio_kerneltls.h>
+#include <rmqio_resolutioncache.h>
+#include <rmqio_tlshandshakepool.h>
+#include <rmqio_tlssessioncache.h>
+#include <rmqt_log.h>
 #include <rmqt_result.h>
 #include <rmqt_securityparameters.h>
 
@@ -34,6 +40,7 @@
 #include <bsl_cstdint.h>
 #include <bsl_functional.h>
 #include <bsl_memory.h>
+#include <bsl_sstream.h>
 #include <bsl_string.h>
 #include <bsl_vector.h>
 
@@ -64,15 +71,16 @@ void logTlsConnectionAlert(const SSL* s, int where, int ret)
                  * suppress the trace as a result.
                  */
             case SSL3_AD_CLOSE_NOTIFY:
-                BALL_LOG_DEBUG << "SSL alert " << prefix << ":" << ret << ": "
+                RMQT_LOG_DEBUG << "SSL alert " << prefix << ":" << ret << ": "
                                << SSL_alert_type_string_long(ret) << ": "
                                << SSL_alert_desc_string_long(ret);
                 break;
 
             default:
-                BALL_LOG_WARN << "SSL alert " << prefix << ":" << ret << ": "
-                              << SSL_alert_type_string_long(ret) << ": "
-                              << SSL_alert_desc_string_long(ret);
+                RMQT_LOG_WARN_THROTTLED
+                    << "SSL alert " << prefix << ":" << ret << ": "
+                    << SSL_alert_type_string_long(ret) << ": "
+                    << SSL_alert_desc_string_long(ret);
         }
     }
     else if (where & SSL_CB_EXIT) {
@@ -89,13 +97,13 @@ void logTlsConnectionAlert(const SSL* s, int where, int ret)
 
         if (ret == 0) {
             // Errors are reported with ret = 0
-            BALL_LOG_ERROR << prefix
-                           << " failed in: " << SSL_state_string_long(s);
+            RMQT_LOG_ERROR_THROTTLED << prefix << " failed in: "
+                                     << SSL_state_string_long(s);
         }
         else if (ret < 0) {
             // These errors seem to be informational only (i.e. handshake
             // reached a certain step)
-            BALL_LOG_DEBUG << prefix
+            RMQT_LOG_DEBUG << prefix
                            << " error in: " << SSL_state_string_long(s);
         }
     }
@@ -111,8 +119,8 @@ bool logCertVerificationFailure(bool preverified,
                           subject_name,
                           sizeof(subject_name) - 1);
 
-        BALL_LOG_ERROR << "Certificate verification failed: [" << subject_name
-                       << "]: ";
+        RMQT_LOG_ERROR_THROTTLED << "Certificate verification failed: ["
+                                 << subject_name << "]: ";
     }
 
     return preverified;
@@ -138,15 +146,40 @@ void handleTLSHandshake(boost::system::error_code error,
                         const bsl::string& host,
                         const Resolver::ErrorCallback& onFail,
                         const ConnectHandler& afterHandshake,
-                        AsioResolver::results_type::iterator endpoint)
+                        AsioResolver::results_type::iterator endpoint,
+                        const bsl::shared_ptr<AsioSecureSocketWrapper>& socket,
+                        const ConnectionOptions& options,
+                        const bsls::TimeInterval& startTime)
 {
     if (!error) {
-        BALL_LOG_DEBUG << " TLS Handshake Complete";
+        RMQT_LOG_DEBUG << " TLS Handshake Complete";
+        if (options.tlsHandshakeObserver()) {
+            options.tlsHandshakeObserver()(
+                bsls::SystemTime::nowMonotonicClock() - startTime);
+        }
+        if (options.tlsSessionCache()) {
+            options.tlsSessionCache()->recordHandshake(
+                socket->socket().native_handle());
+        }
+        if (options.kernelTls()) {
+            // Nothing has been exchanged since the handshake, so the
+            // session's keys and sequence numbers are still the initial ones
+            socket->setKernelTls(
+                KernelTls::install(socket->socket().native_handle(),
+                                   socket->lowest_layer().native_handle()));
+            if (socket->kernelTx() || socket->kernelRx()) {
+                BALL_LOG_INFO << "Kernel TLS"
+                              << (socket->kernelTx() ? " transmit" : "")
+                              << (socket->kernelRx() ? " receive" : "")
+                              << " offload enabled for [" << host << "]";
+            }
+        }
         afterHandshake(error, endpoint); // error code can only be success
     }
     else {
-        BALL_LOG_ERROR << "Error Handshaking with [" << host
-                       << "]: " << error.value() << " " << error.message();
+        RMQT_LOG_ERROR_THROTTLED << "Error Handshaking with [" << host
+                                 << "]: " << error.value() << " "
+                                 << error.message();
         onFail(Resolver::ERROR_HANDSHAKE);
     }
 }
@@ -157,7 +190,8 @@ void startTLSHandshake(
     AsioResolver::results_type::iterator endpoint,
     const bsl::shared_ptr<AsioSecureSocketWrapper>& socketWrapper,
     const Resolver::ErrorCallback& onFail,
-    const ConnectHandler& connectHandler)
+    const ConnectHandler& connectHandler,
+    const ConnectionOptions& options)
 {
     if (!error) {
         BALL_LOG_INFO << "Connected to endpoint: (" << host << ")"
@@ -165,24 +199,47 @@ void startTLSHandshake(
                       << endpoint->endpoint().port()
                       << ", starting TLS Handshake";
 
-        socketWrapper->socket().async_handshake(
-            boost::asio::ssl::stream_base::client,
-            bdlf::BindUtil::bind(&handleTLSHandshake,
-                                 bdlf::PlaceHolders::_1,
-                                 host,
-                                 onFail,
-                                 connectHandler,
-                                 endpoint));
+        if (options.tlsSessionCache()) {
+            bsl::ostringstream key;
+            key << endpoint->endpoint();
+            if (options.tlsSessionCache()->prepare(
+                    socketWrapper->socket().native_handle(), key.str())) {
+                RMQT_LOG_DEBUG << "Resuming TLS session with " << key.str();
+            }
+        }
+
+        const bsl::function<void(const boost::system::error_code&)>
+            handshakeHandler = bdlf::BindUtil::bind(
+                &handleTLSHandshake,
+                bdlf::PlaceHolders::_1,
+                host,
+                onFail,
+                connectHandler,
+                endpoint,
+                socketWrapper,
+                options,
+                bsls::SystemTime::nowMonotonicClock());
+        if (options.tlsHandshakePool()) {
+            // Keeps the event loop thread free for established connections
+            options.tlsHandshakePool()->handshake(socketWrapper,
+                                                  handshakeHandler);
+        }
+        else {
+            socketWrapper->socket().async_handshake(
+                boost::asio::ssl::stream_base::client, handshakeHandler);
+        }
     }
     else {
-        BALL_LOG_ERROR << "Error Connecting [" << host << "]: " << error.value()
-                       << " " << error.message();
+        RMQT_LOG_ERROR_THROTTLED << "Error Connecting [" << host
+                                 << "]: " << error.value() << " "
+                                 << error.message();
         onFail(Resolver::ERROR_CONNECT);
     }
 }
 
 bsl::shared_ptr<boost::asio::ssl::context>
-createSecureContext(const bsl::shared_ptr<rmqt::SecurityParameters>& params)
+createSecureContext(const bsl::shared_ptr<rmqt::SecurityParameters>& params,
+                    const ConnectionOptions& options)
 {
     bsl::shared_ptr<boost::asio::ssl::context> result =
         bsl::make_shared<boost::asio::ssl::context>(
@@ -228,7 +285,7 @@ createSecureContext(const bsl::shared_ptr<rmqt::SecurityParameters>& params)
                 ec.clear();
             }
             else {
-                BALL_LOG_DEBUG << "Using " << params->clientKeyPath()
+                RMQT_LOG_DEBUG << "Using " << params->clientKeyPath()
                                << " for Client Key path";
             }
             result->use_certificate_chain_file(params->clientCertificatePath(),
@@ -241,7 +298,7 @@ createSecureContext(const bsl::shared_ptr<rmqt::SecurityParameters>& params)
                 ec.clear();
             }
             else {
-                BALL_LOG_DEBUG << "Using " << params->clientCertificatePath()
+                RMQT_LOG_DEBUG << "Using " << params->clientCertificatePath()
                                << " for Client Cert path";
             }
 
@@ -256,11 +313,27 @@ createSecureContext(const bsl::shared_ptr<rmqt::SecurityParameters>& params)
                 ec.clear();
             }
             else {
-                BALL_LOG_DEBUG << "Using " << params->certificateAuthorityPath()
+                RMQT_LOG_DEBUG << "Using " << params->certificateAuthorityPath()
                                << " for verification";
             }
             break;
     }
+    if (options.tlsSessionCache()) {
+        TlsSessionCache::enable(result->native_handle());
+    }
+
+    if (options.kernelTls()) {
+        if (!KernelTls::isSupported()) {
+            BALL_LOG_WARN << "Kernel TLS is not supported on this platform, "
+                             "TLS records stay in OpenSSL";
+        }
+#ifdef SSL_OP_NO_RENEGOTIATION
+        // Once the kernel holds the keys OpenSSL cannot take part in a
+        // renegotiation
+        SSL_CTX_set_options(result->native_handle(), SSL_OP_NO_RENEGOTIATION);
+#endif
+    }
+
     SSL_CTX_set_info_callback(result->native_handle(), &logTlsConnectionAlert);
 
     result->set_verify_callback(&logCertVerificationFailure);
@@ -275,16 +348,20 @@ createSecureContext(const bsl::shared_ptr<rmqt::SecurityParameters>& params)
 
 // CREATORS
 bsl::shared_ptr<AsioResolver>
-AsioResolver::create(AsioEventLoop& eventloop, bool shuffleConnectionEndpoints)
+AsioResolver::create(AsioEventLoop& eventloop,
+                     bool shuffleConnectionEndpoints,
+                     const ConnectionOptions& connectionOptions)
 {
-    return bsl::shared_ptr<AsioResolver>(
-        new AsioResolver(eventloop, shuffleConnectionEndpoints));
+    return bsl::shared_ptr<AsioResolver>(new AsioResolver(
+        eventloop, shuffleConnectionEndpoints, connectionOptions));
 }
 
 AsioResolver::AsioResolver(AsioEventLoop& eventloop,
-                           bool shuffleConnectionEndpoints)
+                           bool shuffleConnectionEndpoints,
+                           const ConnectionOptions& connectionOptions)
 : d_resolver(eventloop.context())
 , d_shuffleConnectionEndpoints(shuffleConnectionEndpoints)
+, d_connectionOptions(connectionOptions)
 {
 }
 
@@ -300,29 +377,19 @@ AsioResolver::asyncConnect(const bsl::string& host,
         bsl::make_shared<AsioSocket>(d_resolver.get_executor());
 
     bslma::ManagedPtr<Decoder> decoder =
-        bslma::ManagedPtrUtil::makeManaged<Decoder>(maxFrameSize);
+        bslma::ManagedPtrUtil::makeManaged<Decoder>(maxFrameSize,
+                                                    Decoder::IN_PLACE);
 
     bsl::shared_ptr<AsioConnection<AsioSocket> > connection =
         bsl::make_shared<AsioConnection<AsioSocket> >(
-            socket, connCallbacks, bsl::ref(decoder));
-
-    BALL_LOG_TRACE << "Starting resolution for: " << host << ":" << port;
+            socket, connCallbacks, bsl::ref(decoder), d_connectionOptions);
 
-    d_resolver.async_resolve(
-        host.c_str(),
-        bsl::to_string(port).c_str(),
-        boost::asio::ip::resolver_query_base::numeric_service,
-        bdlf::BindUtil::bind(
-            &AsioResolver::handleResolveCb<AsioSocket>,
-            weak_from_this(),
-            host,
-            bsl::to_string(port),
-            bdlf::PlaceHolders::_1,
-            bdlf::PlaceHolders::_2,
-            bsl::weak_ptr<AsioConnection<AsioSocket> >(connection),
-            bsl::weak_ptr<AsioSocket>(socket),
-            onSuccess,
-            onFail));
+    resolve<AsioSocket>(host,
+                        bsl::to_string(port),
+                        connection,
+                        socket,
+                        onSuccess,
+                        onFail);
 
     return connection;
 }
@@ -338,7 +405,7 @@ bsl::shared_ptr<Connection> AsioResolver::asyncSecureConnect(
 {
     bsl::shared_ptr<AsioConnection<AsioSecureSocketWrapper> > connection;
     bsl::shared_ptr<boost::asio::ssl::context> secureContext =
-        createSecureContext(securityParameters);
+        createSecureContext(securityParameters, d_connectionOptions);
     if (!secureContext) {
         BALL_LOG_ERROR << "Failed to setup TLS client with parameters: ["
                        << *securityParameters << "]";
@@ -349,30 +416,100 @@ bsl::shared_ptr<Connection> AsioResolver::asyncSecureConnect(
         bsl::make_shared<AsioSecureSocketWrapper>(d_resolver.get_executor(),
                                                   secureContext);
     bslma::ManagedPtr<rmqio::Decoder> decoder =
-        bslma::ManagedPtrUtil::makeManaged<Decoder>(maxFrameSize);
+        bslma::ManagedPtrUtil::makeManaged<Decoder>(maxFrameSize,
+                                                    Decoder::IN_PLACE);
     connection = bsl::make_shared<AsioConnection<AsioSecureSocketWrapper> >(
-        socket, connCallbacks, bsl::ref(decoder));
+        socket, connCallbacks, bsl::ref(decoder), d_connectionOptions);
 
-    BALL_LOG_TRACE << "Starting resolution for: " << host << ":" << port;
-    d_resolver.async_resolve(
-        host.c_str(),
-        bsl::to_string(port).c_str(),
-        boost::asio::ip::resolver_query_base::numeric_service,
-        bdlf::BindUtil::bind(
-            &AsioResolver::handleResolveCb<AsioSecureSocketWrapper>,
-            weak_from_this(),
-            host,
-            bsl::to_string(port),
-            bdlf::PlaceHolders::_1,
-            bdlf::PlaceHolders::_2,
-            bsl::weak_ptr<AsioConnection<AsioSecureSocketWrapper> >(connection),
-            bsl::weak_ptr<AsioSecureSocketWrapper>(socket),
-            onSuccess,
-            onFail));
+    resolve<AsioSecureSocketWrapper>(host,
+                                     bsl::to_string(port),
+                                     connection,
+                                     socket,
+                                     onSuccess,
+                                     onFail);
+
+    return connection;
+}
+
+bsl::shared_ptr<Connection>
+AsioResolver::asyncLocalConnect(const bsl::string& path,
+                                bsl::size_t maxFrameSize,
+                                const Connection::Callbacks& connCallbacks,
+                                const NewConnectionCallback& onSuccess,
+                                const ErrorCallback& onFail)
+{
+    bsl::shared_ptr<AsioLocalSocket> socket =
+        bsl::make_shared<AsioLocalSocket>(d_resolver.get_executor());
+
+    bslma::ManagedPtr<Decoder> decoder =
+        bslma::ManagedPtrUtil::makeManaged<Decoder>(maxFrameSize,
+                                                    Decoder::IN_PLACE);
+
+    bsl::shared_ptr<AsioConnection<AsioLocalSocket> > connection =
+        bsl::make_shared<AsioConnection<AsioLocalSocket> >(
+            socket, connCallbacks, bsl::ref(decoder), d_connectionOptions);
+
+    RMQT_LOG_TRACE << "Connecting to local socket: " << path;
+
+    socket->async_connect(
+        boost::asio::local::stream_protocol::endpoint(path.c_str()),
+        bdlf::BindUtil::bind(&AsioResolver::handleLocalConnectCb,
+                             weak_from_this(),
+                             path,
+                             bdlf::PlaceHolders::_1,
+                             bsl::weak_ptr<AsioConnection<AsioLocalSocket> >(
+                                 connection),
+                             socket, // Holds asio socket alive
+                             onSuccess,
+                             onFail));
 
     return connection;
 }
 
+void AsioResolver::handleLocalConnectCb(
+    bsl::weak_ptr<AsioResolver> weakSelf,
+    const bsl::string& path,
+    boost::system::error_code error,
+    const bsl::weak_ptr<AsioConnection<AsioLocalSocket> >& weakConnection,
+    const bsl::shared_ptr<AsioLocalSocket>& socketLifetime,
+    const NewConnectionCallback& onSuccess,
+    const ErrorCallback& onFail)
+{
+    (void)socketLifetime;
+
+    if (!weakSelf.lock()) {
+        RMQT_LOG_DEBUG
+            << "Socket connected after resolver destructed, ignoring";
+        return;
+    }
+
+    if (error) {
+        RMQT_LOG_ERROR_THROTTLED << "Error Connecting [" << path << "]: "
+                                 << error.value() << " " << error.message();
+        onFail(Resolver::ERROR_CONNECT);
+        return;
+    }
+
+    bsl::shared_ptr<AsioConnection<AsioLocalSocket> > connection =
+        weakConnection.lock();
+    if (!connection) {
+        RMQT_LOG_DEBUG << "Connection established after we stopped "
+                          "waiting for it";
+        return;
+    }
+
+    BALL_LOG_INFO << "Established Connection to local socket " << path;
+
+    if (connection->markConnected()) {
+        onSuccess();
+    }
+    else {
+        RMQT_LOG_ERROR_THROTTLED << "Error setting up socket for [" << path
+                                 << "]: ";
+        onFail(Resolver::ERROR_CONNECT);
+    }
+}
+
 template <>
 void AsioResolver::startConnect<AsioSecureSocketWrapper>(
     const bsl::string& host,
@@ -386,7 +523,7 @@ void AsioResolver::startConnect<AsioSecureSocketWrapper>(
     bsl::shared_ptr<AsioSecureSocketWrapper> socket = weakSocket.lock();
 
     if (!socket) {
-        BALL_LOG_WARN
+        RMQT_LOG_WARN_THROTTLED
             << "DNS resolved after we stopped listening. Is it too slow?";
         return;
     }
@@ -402,17 +539,28 @@ void AsioResolver::startConnect<AsioSecureSocketWrapper>(
         onSuccess,
         onFail);
 
-    boost::asio::async_connect(
-        socket->lowest_layer(),
-        resolverResults.begin(),
-        resolverResults.end(),
+    const ConnectHandler startHandshake =
         bdlf::BindUtil::bind(&startTLSHandshake,
                              host,
                              bdlf::PlaceHolders::_1,
                              bdlf::PlaceHolders::_2,
                              socket, // Holds asio socket alive
                              onFail,
-                             connectHandler));
+                             connectHandler,
+                             d_connectionOptions);
+
+    if (d_connectionOptions.connectRaceStagger() > bsls::TimeInterval()) {
+        ConnectRace::start(socket->socket().next_layer(),
+                           resolverResults,
+                           d_connectionOptions.connectRaceStagger(),
+                           startHandshake);
+        return;
+    }
+
+    boost::asio::async_connect(socket->lowest_layer(),
+                               resolverResults.begin(),
+                               resolverResults.end(),
+                               startHandshake);
 }
 
 template <typename SocketType>
@@ -428,15 +576,12 @@ void AsioResolver::startConnect(
     bsl::shared_ptr<SocketType> socket = weakSocket.lock();
 
     if (!socket) {
-        BALL_LOG_WARN << "DNS resolved after we stopped listening. Is "
-                         "it too slow?";
+        RMQT_LOG_WARN_THROTTLED
+            << "DNS resolved after we stopped listening. Is it too slow?";
         return;
     }
 
-    boost::asio::async_connect(
-        *socket,
-        resolverResults.begin(),
-        resolverResults.end(),
+    const ConnectHandler connectHandler =
         bdlf::BindUtil::bind(&AsioResolver::handleConnectCb<SocketType>,
                              weak_from_this(),
                              host,
@@ -445,7 +590,68 @@ void AsioResolver::startConnect(
                              weakConnection,
                              socket, // Holds asio socket alive
                              onSuccess,
-                             onFail));
+                             onFail);
+
+    if (d_connectionOptions.connectRaceStagger() > bsls::TimeInterval()) {
+        ConnectRace::start(*socket,
+                           resolverResults,
+                           d_connectionOptions.connectRaceStagger(),
+                           connectHandler);
+        return;
+    }
+
+    boost::asio::async_connect(*socket,
+                               resolverResults.begin(),
+                               resolverResults.end(),
+                               connectHandler);
+}
+
+template <typename SocketType>
+void AsioResolver::resolve(
+    const bsl::string& host,
+    const bsl::string& port,
+    const bsl::weak_ptr<AsioConnection<SocketType> >& weakConnection,
+    const bsl::weak_ptr<SocketType>& weakSocket,
+    const NewConnectionCallback& onSuccess,
+    const ErrorCallback& onFail)
+{
+    results_type cached;
+    if (d_connectionOptions.resolutionCache() &&
+        d_connectionOptions.resolutionCache()->lookup(host, port, &cached)) {
+        // Still completes asynchronously, as a resolution would
+        boost::asio::post(
+            d_resolver.get_executor(),
+            bdlf::BindUtil::bind(&AsioResolver::handleResolveCb<SocketType>,
+                                 weak_from_this(),
+                                 host,
+                                 port,
+                                 boost::system::error_code(),
+                                 cached,
+                                 weakConnection,
+                                 weakSocket,
+                                 onSuccess,
+                                 onFail,
+                                 true));
+        return;
+    }
+
+    RMQT_LOG_TRACE << "Starting resolution for: " << host << ":" << port;
+
+    d_resolver.async_resolve(
+        host.c_str(),
+        port.c_str(),
+        boost::asio::ip::resolver_query_base::numeric_service,
+        bdlf::BindUtil::bind(&AsioResolver::handleResolveCb<SocketType>,
+                             weak_from_this(),
+                             host,
+                             port,
+                             bdlf::PlaceHolders::_1,
+                             bdlf::PlaceHolders::_2,
+                             weakConnection,
+                             weakSocket,
+                             onSuccess,
+                             onFail,
+                             false));
 }
 
 template <typename SocketType>
@@ -461,7 +667,7 @@ void AsioResolver::handleConnect(
         bsl::shared_ptr<AsioConnection<SocketType> > connection =
             weakConnection.lock();
         if (!connection) {
-            BALL_LOG_DEBUG << "Connection established after we stopped "
+            RMQT_LOG_DEBUG << "Connection established after we stopped "
                               "waiting for it";
             return;
         }
@@ -474,13 +680,15 @@ void AsioResolver::handleConnect(
             onSuccess();
         }
         else {
-            BALL_LOG_ERROR << "Error setting up socket for [" << host << "]: ";
+            RMQT_LOG_ERROR_THROTTLED << "Error setting up socket for ["
+                                     << host << "]: ";
             onFail(Resolver::ERROR_CONNECT);
         }
     }
     else {
-        BALL_LOG_ERROR << "Error Connecting [" << host << "]: " << error.value()
-                       << " " << error.message();
+        RMQT_LOG_ERROR_THROTTLED << "Error Connecting [" << host
+                                 << "]: " << error.value() << " "
+                                 << error.message();
         onFail(Resolver::ERROR_CONNECT);
     }
 }
@@ -518,15 +726,22 @@ void AsioResolver::handleResolve(
     const bsl::weak_ptr<AsioConnection<SocketType> >& weakConnection,
     const bsl::weak_ptr<SocketType>& weakSocket,
     const NewConnectionCallback& onSuccess,
-    const ErrorCallback& onFail)
+    const ErrorCallback& onFail,
+    bool fromCache)
 {
     if (!error) {
         BALL_LOG_INFO << "Resolved " << host << ":" << port << " to "
                       << resolverResults.size()
+                      << (fromCache ? " cached" : "")
                       << (d_shuffleConnectionEndpoints
                               ? " results, shuffling dns results enabled."
                               : " results.");
 
+        if (!fromCache && d_connectionOptions.resolutionCache()) {
+            d_connectionOptions.resolutionCache()->store(
+                host, port, resolverResults);
+        }
+
         bsls::Types::Int64 totalMicroseconds =
             bsls::SystemTime::nowRealtimeClock().totalMicroseconds();
         int seed = static_cast<int>(totalMicroseconds);
@@ -541,8 +756,9 @@ void AsioResolver::handleResolve(
                                  onFail);
     }
     else {
-        BALL_LOG_ERROR << "Error Resolving [" << host << "]: " << error.value()
-                       << " " << error.message();
+        RMQT_LOG_ERROR_THROTTLED << "Error Resolving [" << host
+                                 << "]: " << error.value() << " "
+                                 << error.message();
         onFail(Resolver::ERROR_RESOLVE);
     }
 }
@@ -565,7 +781,7 @@ void AsioResolver::handleConnectCb(
 
     bsl::shared_ptr<AsioResolver> self = weakSelf.lock();
     if (!self) {
-        BALL_LOG_DEBUG
+        RMQT_LOG_DEBUG
             << "Socket connected after resolver destructed, ignoring";
         return;
     }
@@ -584,11 +800,12 @@ void AsioResolver::handleResolveCb(
     const bsl::weak_ptr<AsioConnection<SocketType> >& weakConnection,
     const bsl::weak_ptr<SocketType>& weakSocket,
     const NewConnectionCallback& onSuccess,
-    const ErrorCallback& onFail)
+    const ErrorCallback& onFail,
+    bool fromCache)
 {
     bsl::shared_ptr<AsioResolver> self = weakSelf.lock();
     if (!self) {
-        BALL_LOG_DEBUG << "DNS Resolution returned after resolver "
+        RMQT_LOG_DEBUG << "DNS Resolution returned after resolver "
                           "destructed, ignoring";
         return;
     }
@@ -600,7 +817,8 @@ void AsioResolver::handleResolveCb(
                                     weakConnection,
                                     weakSocket,
                                     onSuccess,
-                                    onFail);
+                                    onFail,
+                                    fromCache);
 }
 
 } // namespace rmqio
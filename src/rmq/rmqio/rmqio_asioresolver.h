@@ -30,6 +30,7 @@
 
 #include <rmqio_asioeventloop.h>
 #include <rmqio_asiosocketwrapper.h>
+#include <rmqio_connectionoptions.h>
 
 #include <rmqt_result.h>
 #include <rmqt_securityparameters.h>
@@ -80,7 +81,9 @@ class AsioResolver : public Resolver,
                      public bsl::enable_shared_from_this<AsioResolver> {
   public:
     static bsl::shared_ptr<AsioResolver>
-    create(AsioEventLoop& eventloop, bool shuffleConnectionEndpoints);
+    create(AsioEventLoop& eventloop,
+           bool shuffleConnectionEndpoints,
+           const ConnectionOptions& connectionOptions = ConnectionOptions());
 
     virtual bsl::shared_ptr<Connection>
     asyncConnect(const bsl::string& host,
@@ -99,6 +102,13 @@ class AsioResolver : public Resolver,
         const NewConnectionCallback& onSuccess,
         const ErrorCallback& onFail);
 
+    virtual bsl::shared_ptr<Connection>
+    asyncLocalConnect(const bsl::string& path,
+                      bsl::size_t maxFrameSize,
+                      const Connection::Callbacks& connCallbacks,
+                      const NewConnectionCallback& onSuccess,
+                      const ErrorCallback& onFail);
+
     typedef boost::asio::ip::tcp::resolver::results_type results_type;
 
     static void shuffleResolverResults(results_type& resolverResults,
@@ -108,8 +118,9 @@ class AsioResolver : public Resolver,
                                        const bsl::string& port);
 
   private:
-    explicit AsioResolver(AsioEventLoop& eventloop,
-                          bool shuffleConnectionEndpoints);
+    AsioResolver(AsioEventLoop& eventloop,
+                 bool shuffleConnectionEndpoints,
+                 const ConnectionOptions& connectionOptions);
     template <typename SocketType>
     void startConnect(
         const bsl::string& host,
@@ -119,6 +130,17 @@ class AsioResolver : public Resolver,
         const NewConnectionCallback& onSuccess,
         const ErrorCallback& onFail);
 
+    /// Resolve `host` and `port`, through the resolution cache if there is
+    /// one, then connect
+    template <typename SocketType>
+    void resolve(
+        const bsl::string& host,
+        const bsl::string& port,
+        const bsl::weak_ptr<AsioConnection<SocketType> >& weakConnection,
+        const bsl::weak_ptr<SocketType>& weakSocket,
+        const NewConnectionCallback& onSuccess,
+        const ErrorCallback& onFail);
+
     template <typename SocketType>
     void handleConnect(
         const bsl::string& host,
@@ -139,6 +161,15 @@ class AsioResolver : public Resolver,
         const NewConnectionCallback& onSuccess,
         const ErrorCallback& onFail);
 
+    static void handleLocalConnectCb(
+        bsl::weak_ptr<AsioResolver> weakSelf,
+        const bsl::string& path,
+        boost::system::error_code error,
+        const bsl::weak_ptr<AsioConnection<AsioLocalSocket> >& weakConnection,
+        const bsl::shared_ptr<AsioLocalSocket>& socketLifetime,
+        const NewConnectionCallback& onSuccess,
+        const ErrorCallback& onFail);
+
     template <typename SocketType>
     static void handleHandshakeCb(
         bsl::weak_ptr<AsioResolver> weakSelf,
@@ -157,7 +188,8 @@ class AsioResolver : public Resolver,
         const bsl::weak_ptr<AsioConnection<SocketType> >& weakConnection,
         const bsl::weak_ptr<SocketType>& weakSocket,
         const NewConnectionCallback& onSuccess,
-        const ErrorCallback& onFail);
+        const ErrorCallback& onFail,
+        bool fromCache);
 
     template <typename SocketType>
     static void handleResolveCb(
@@ -169,7 +201,8 @@ class AsioResolver : public Resolver,
         const bsl::weak_ptr<AsioConnection<SocketType> >& weakConnection,
         const bsl::weak_ptr<SocketType>& weakSocket,
         const NewConnectionCallback& onSuccess,
-        const ErrorCallback& onFail);
+        const ErrorCallback& onFail,
+        bool fromCache);
 
     bool shuffleConnectionEndpoints() const
     {
@@ -179,6 +212,7 @@ class AsioResolver : public Resolver,
   private:
     boost::asio::ip::tcp::resolver d_resolver;
     bool d_shuffleConnectionEndpoints;
+    ConnectionOptions d_connectionOptions;
 };
 
 } // namespace rmqio
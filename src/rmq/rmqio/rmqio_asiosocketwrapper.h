@@ -16,6 +16,8 @@
 #ifndef INCLUDED_RMQIO_ASIOSOCKETWRAPPER
 #define INCLUDED_RMQIO_ASIOSOCKETWRAPPER
 
+#include <rmqio_kerneltls.h>
+
 #include <boost/asio.hpp>
 #include <boost/asio/ssl.hpp>
 #include <boost/system/error_code.hpp>
@@ -29,6 +31,7 @@ namespace rmqio {
 
 typedef boost::asio::ip::tcp::socket AsioSocket;
 typedef boost::asio::ssl::stream<boost::asio::ip::tcp::socket> AsioSSLSocket;
+typedef boost::asio::local::stream_protocol::socket AsioLocalSocket;
 
 class AsioSecureSocketWrapper {
   public:
@@ -37,6 +40,7 @@ class AsioSecureSocketWrapper {
         const bsl::shared_ptr<boost::asio::ssl::context>& context)
     : d_context(context)
     , d_socket(bsl::make_shared<AsioSSLSocket>(executor, bsl::ref(*d_context)))
+    , d_kernelTls(0)
     {
     }
 
@@ -72,9 +76,17 @@ class AsioSecureSocketWrapper {
 
     AsioSSLSocket& socket() { return *d_socket; }
 
+    /// Record the `rmqio::KernelTls::Direction`s the kernel now handles.
+    /// Reads and writes in those directions then bypass OpenSSL.
+    void setKernelTls(int directions) { d_kernelTls = directions; }
+
+    bool kernelTx() const { return d_kernelTls & KernelTls::TX; }
+    bool kernelRx() const { return d_kernelTls & KernelTls::RX; }
+
   private:
     bsl::shared_ptr<boost::asio::ssl::context> d_context;
     bsl::shared_ptr<AsioSSLSocket> d_socket;
+    int d_kernelTls;
 };
 
 } // namespace rmqio
@@ -17,6 +17,7 @@
 #define INCLUDED_RMQIO_ASIOTIMER
 
 #include <rmqio_asioeventloop.h>
+#include <rmqio_coarseclock.h>
 #include <rmqio_timer.h>
 
 #include <boost/asio.hpp>
@@ -156,6 +157,8 @@ void basic_AsioTimer<T, TT>::handler_internal(
     const Timer::Callback callback,
     const boost::system::error_code& error)
 {
+    CoarseClock::tick();
+
     bsl::shared_ptr<basic_AsioTimer<T, TT> > t = timer.lock();
     if (t) {
         t->handler(callback, error);
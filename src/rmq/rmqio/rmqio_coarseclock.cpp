@@ -0,0 +1,71 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqio_coarseclock.h>
+
+#include <bdlt_currenttime.h>
+#include <bdlt_epochutil.h>
+#include <bsls_timeinterval.h>
+
+namespace BloombergLP {
+namespace rmqio {
+
+bsls::AtomicBool CoarseClock::s_enabled(false);
+bsls::AtomicInt64 CoarseClock::s_microseconds(0);
+
+bdlt::Datetime CoarseClock::utc()
+{
+    if (!isEnabled()) {
+        return bdlt::CurrentTime::utc();
+    }
+
+    bsls::Types::Int64 microseconds = s_microseconds.loadRelaxed();
+    if (microseconds == 0) {
+        refresh();
+        microseconds = s_microseconds.loadRelaxed();
+    }
+
+    bdlt::Datetime result = bdlt::EpochUtil::epoch();
+    result.addMicroseconds(microseconds);
+    return result;
+}
+
+void CoarseClock::setEnabled(bool enabled)
+{
+    if (enabled) {
+        refresh();
+    }
+    s_enabled.storeRelaxed(enabled);
+}
+
+void CoarseClock::refresh()
+{
+    const bsls::Types::Int64 now =
+        bdlt::CurrentTime::now().totalMicroseconds();
+
+    // Several event loops may tick at once: never move backwards
+    bsls::Types::Int64 current = s_microseconds.loadRelaxed();
+    while (current < now) {
+        const bsls::Types::Int64 previous =
+            s_microseconds.testAndSwap(current, now);
+        if (previous == current) {
+            break;
+        }
+        current = previous;
+    }
+}
+
+} // namespace rmqio
+} // namespace BloombergLP
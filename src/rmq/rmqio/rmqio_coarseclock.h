@@ -0,0 +1,73 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQIO_COARSECLOCK
+#define INCLUDED_RMQIO_COARSECLOCK
+
+#include <bdlt_datetime.h>
+#include <bsls_atomic.h>
+#include <bsls_types.h>
+
+//@PURPOSE: Process-wide clock cached at event loop granularity
+//
+//@CLASSES:
+//  rmqio::CoarseClock: UTC time refreshed by the event loops
+
+namespace BloombergLP {
+namespace rmqio {
+
+/// \brief UTC time cached once per event loop iteration
+///
+/// Timestamps for message stores, hung-message checks and latency metrics do
+/// not need microsecond precision, yet reading the system clock and
+/// converting to `bdlt::Datetime` for every message shows up in profiles.
+/// When enabled, `utc()` returns the time of the latest `tick()`, which the
+/// event loops call as they pick up work (socket reads, timers, posted
+/// work). Values are only ever moved forwards.
+///
+/// Disabled by default, in which case `utc()` is `bdlt::CurrentTime::utc()`.
+/// The setting is process-wide.
+
+class CoarseClock {
+  public:
+    /// Return the current UTC time, which is the time of the last `tick()`
+    /// when enabled
+    static bdlt::Datetime utc();
+
+    /// Refresh the cached time. Cheap to call when disabled.
+    static void tick();
+
+    static void setEnabled(bool enabled);
+    static bool isEnabled() { return s_enabled.loadRelaxed(); }
+
+  private:
+    static void refresh();
+
+    static bsls::AtomicBool s_enabled;
+    /// Microseconds since the epoch, or zero before the first tick
+    static bsls::AtomicInt64 s_microseconds;
+};
+
+inline void CoarseClock::tick()
+{
+    if (isEnabled()) {
+        refresh();
+    }
+}
+
+} // namespace rmqio
+} // namespace BloombergLP
+
+#endif
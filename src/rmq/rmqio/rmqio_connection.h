@@ -19,6 +19,10 @@
 #include <rmqio_serializedframe.h>
 #include <rmqt_result.h>
 
+#include <bsls_types.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_cstdint.h>
 #include <bsl_functional.h>
 #include <bsl_memory.h>
 #include <bsl_vector.h>
@@ -42,6 +46,20 @@ class Connection {
     typedef bsl::function<void(ReturnCode)> DoneCallback;
     typedef bsl::function<void()> SuccessWriteCallback;
 
+    /// When the read whose frames are being passed to `onRead` completed,
+    /// and when they had all been decoded, as `PipelineClock::now()`
+    /// timestamps. Zero unless pipeline timing is enabled.
+    struct ReadTimes {
+        ReadTimes()
+        : completed(0)
+        , decoded(0)
+        {
+        }
+
+        bsls::Types::Int64 completed;
+        bsls::Types::Int64 decoded;
+    };
+
     struct Callbacks {
         Callbacks()
         : onRead()
@@ -66,6 +84,39 @@ class Connection {
     /// returns if the socket is connected
     virtual bool isConnected() const = 0;
 
+    /// Stop reading from the socket once the frames already read have been
+    /// handled, so that TCP flow control holds back the peer
+    virtual void pauseReading() {}
+
+    /// Start reading again after `pauseReading`
+    virtual void resumeReading() {}
+
+    /// Return the timestamps of the read currently being handled. Only
+    /// meaningful from within the `onRead` callback.
+    virtual ReadTimes readTimes() const { return ReadTimes(); }
+
+    /// Let `channel` write up to `weight` content frames each time it takes
+    /// its turn among the channels with publishes queued. The default
+    /// weight is 1.
+    virtual void setChannelWeight(bsl::uint16_t channel, unsigned weight)
+    {
+        (void)channel;
+        (void)weight;
+    }
+
+    /// Return the writes queued and not yet written to the socket,
+    /// including those being written
+    virtual bsl::size_t queuedWrites() const { return 0; }
+
+    /// Return the bytes this connection holds on to for reading, buffered
+    /// data and spare capacity alike
+    virtual bsl::size_t retainedBytes() const { return 0; }
+
+    /// Give back the memory a burst of traffic left this connection holding
+    /// on to: spare buffer capacity, and a read size grown for the burst.
+    /// Buffers still in use by an outstanding read shrink once it completes.
+    virtual void trim() {}
+
     virtual ~Connection() {}
 };
 } // namespace rmqio
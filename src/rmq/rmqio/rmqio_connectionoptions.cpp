@@ -0,0 +1,193 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqio_connectionoptions.h>
+
+#include <rmqio_decodepool.h>
+#include <rmqio_readstats.h>
+#include <rmqio_resolutioncache.h>
+#include <rmqio_tlshandshakepool.h>
+#include <rmqio_tlssessioncache.h>
+#include <rmqio_writequeuestats.h>
+
+#include <bsl_ostream.h>
+
+namespace BloombergLP {
+namespace rmqio {
+
+const bsl::size_t ConnectionOptions::k_DEFAULT_MAX_COALESCED_WRITE_BUFFERS;
+const bsl::size_t ConnectionOptions::k_DEFAULT_MAX_COALESCED_WRITE_BYTES;
+
+ConnectionOptions::ConnectionOptions()
+: d_maxWriteBytes(k_DEFAULT_MAX_COALESCED_WRITE_BYTES)
+, d_maxWriteBuffers(k_DEFAULT_MAX_COALESCED_WRITE_BUFFERS)
+, d_deferWrites(false)
+, d_busyPollMicroseconds(0)
+, d_kernelTls(false)
+, d_tlsSessionCache()
+, d_tlsHandshakePool()
+, d_tlsHandshakeObserver()
+, d_resolutionCache()
+, d_connectRaceStagger()
+, d_readAllocator(0)
+, d_writeQueueStats()
+, d_maxReadBytes(0)
+, d_readFrameBudget(0)
+, d_decodePool()
+, d_readStats()
+, d_wireCapture()
+, d_socketOptions()
+{
+}
+
+ConnectionOptions& ConnectionOptions::setWriteCoalescing(bsl::size_t maxBytes,
+                                                         bsl::size_t maxBuffers)
+{
+    d_maxWriteBytes   = maxBytes;
+    d_maxWriteBuffers = maxBuffers;
+    return *this;
+}
+
+ConnectionOptions& ConnectionOptions::setDeferWrites(bool enabled)
+{
+    d_deferWrites = enabled;
+    return *this;
+}
+
+ConnectionOptions& ConnectionOptions::setBusyPoll(int microseconds)
+{
+    d_busyPollMicroseconds = microseconds;
+    return *this;
+}
+
+ConnectionOptions& ConnectionOptions::setKernelTls(bool enabled)
+{
+    d_kernelTls = enabled;
+    return *this;
+}
+
+ConnectionOptions& ConnectionOptions::setTlsSessionCache(
+    const bsl::shared_ptr<TlsSessionCache>& cache)
+{
+    d_tlsSessionCache = cache;
+    return *this;
+}
+
+ConnectionOptions& ConnectionOptions::setTlsHandshakePool(
+    const bsl::shared_ptr<TlsHandshakePool>& pool)
+{
+    d_tlsHandshakePool = pool;
+    return *this;
+}
+
+ConnectionOptions&
+ConnectionOptions::setTlsHandshakeObserver(const HandshakeObserver& observer)
+{
+    d_tlsHandshakeObserver = observer;
+    return *this;
+}
+
+ConnectionOptions& ConnectionOptions::setResolutionCache(
+    const bsl::shared_ptr<ResolutionCache>& cache)
+{
+    d_resolutionCache = cache;
+    return *this;
+}
+
+ConnectionOptions&
+ConnectionOptions::setConnectRace(const bsls::TimeInterval& stagger)
+{
+    d_connectRaceStagger = stagger;
+    return *this;
+}
+
+ConnectionOptions&
+ConnectionOptions::setReadAllocator(bslma::Allocator* allocator)
+{
+    d_readAllocator = allocator;
+    return *this;
+}
+
+ConnectionOptions& ConnectionOptions::setWriteQueueStats(
+    const bsl::shared_ptr<WriteQueueStats>& stats)
+{
+    d_writeQueueStats = stats;
+    return *this;
+}
+
+ConnectionOptions& ConnectionOptions::setMaxReadBytes(bsl::size_t maxBytes)
+{
+    d_maxReadBytes = maxBytes;
+    return *this;
+}
+
+ConnectionOptions& ConnectionOptions::setReadFrameBudget(bsl::size_t frames)
+{
+    d_readFrameBudget = frames;
+    return *this;
+}
+
+ConnectionOptions&
+ConnectionOptions::setReadStats(const bsl::shared_ptr<ReadStats>& stats)
+{
+    d_readStats = stats;
+    return *this;
+}
+
+ConnectionOptions&
+ConnectionOptions::setWireCapture(const bsl::shared_ptr<WireCapture>& capture)
+{
+    d_wireCapture = capture;
+    return *this;
+}
+
+ConnectionOptions&
+ConnectionOptions::setDecodePool(const bsl::shared_ptr<DecodePool>& pool)
+{
+    d_decodePool = pool;
+    return *this;
+}
+
+ConnectionOptions&
+ConnectionOptions::setSocketOptions(const rmqt::SocketOptions& options)
+{
+    d_socketOptions = options;
+    return *this;
+}
+
+bsl::ostream& operator<<(bsl::ostream& os, const ConnectionOptions& options)
+{
+    return os << "ConnectionOptions = [ maxCoalescedWriteBytes: "
+              << options.maxCoalescedWriteBytes()
+              << ", maxCoalescedWriteBuffers: "
+              << options.maxCoalescedWriteBuffers()
+              << ", deferWrites: " << options.deferWrites()
+              << ", busyPollMicroseconds: " << options.busyPollMicroseconds()
+              << ", kernelTls: " << options.kernelTls()
+              << ", tlsSessionCache: " << bool(options.tlsSessionCache())
+              << ", tlsHandshakePool: " << bool(options.tlsHandshakePool())
+              << ", resolutionCache: " << bool(options.resolutionCache())
+              << ", connectRaceStagger: " << options.connectRaceStagger()
+              << ", readAllocator: " << bool(options.readAllocator())
+              << ", writeQueueStats: " << bool(options.writeQueueStats())
+              << ", maxReadBytes: " << options.maxReadBytes()
+              << ", decodePool: " << bool(options.decodePool())
+              << ", readStats: " << bool(options.readStats())
+              << ", wireCapture: " << bool(options.wireCapture()) << ", "
+              << options.socketOptions() << " ]";
+}
+
+} // namespace rmqio
+} // namespace BloombergLP
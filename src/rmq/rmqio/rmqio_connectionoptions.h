@@ -0,0 +1,262 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQIO_CONNECTIONOPTIONS
+#define INCLUDED_RMQIO_CONNECTIONOPTIONS
+
+#include <rmqt_socketoptions.h>
+
+#include <bslma_allocator.h>
+#include <bsls_timeinterval.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_functional.h>
+#include <bsl_memory.h>
+#include <bsl_ostream.h>
+
+//@PURPOSE: Socket level settings applied to each connection
+//
+//@CLASSES:
+//  rmqio::ConnectionOptions: Settings for rmqio::Connection implementations
+
+namespace BloombergLP {
+namespace rmqio {
+
+class DecodePool;
+class ReadStats;
+class ResolutionCache;
+class TlsHandshakePool;
+class TlsSessionCache;
+class WireCapture;
+class WriteQueueStats;
+
+/// \brief Socket level settings for a connection to the broker
+///
+/// Write coalescing (corking): while a socket write is outstanding, further
+/// writes are queued. When it completes, as many queued frames as fit within
+/// `maxCoalescedWriteBytes` and `maxCoalescedWriteBuffers` are gathered into
+/// the next vectored write, control frames ahead of publishes (see
+/// `WriteQueue`). Publishes are split between writes at frame boundaries,
+/// and a single frame larger than the limits is still written on its own.
+/// These limits therefore also bound how long a heartbeat or ack waits
+/// behind a large publish.
+///
+/// Deferred writes: when `deferWrites` is set, a write queued while the
+/// socket is idle is not started straight away. Instead a flush is posted to
+/// the event loop, which runs once the handlers already ready have run, so
+/// everything the channels write during one turn of the loop (acks from a
+/// batch of deliveries, publishes, heartbeats) goes out in one vectored
+/// write rather than one write per entry.
+///
+/// Busy polling: a non-zero `busyPollMicroseconds` sets `SO_BUSY_POLL` on the
+/// socket (Linux only), so blocking reads spin on the device queue for up to
+/// that long before sleeping.
+///
+/// Kernel TLS: when `kernelTls` is set, secure connections try to install
+/// their session keys into the socket once the handshake completes (see
+/// `rmqio::KernelTls`), so the kernel encrypts and decrypts records and
+/// frames are read and written on the plain socket. Sessions the kernel
+/// cannot take stay in OpenSSL.
+///
+/// TLS session cache: when set, secure connections offer the session last
+/// negotiated with the same endpoint, so reconnects can skip the full
+/// handshake. Connections sharing the cache share their sessions.
+///
+/// TLS handshake pool: when set, secure connections run their handshakes on
+/// its threads rather than the event loop thread, see
+/// `rmqio::TlsHandshakePool`.
+///
+/// TLS handshake observer: when set, is passed the duration of each
+/// successful TLS handshake, on the event loop thread.
+///
+/// Resolution cache: when set, hostnames are resolved through it, so
+/// connections sharing it resolve each host once per cache TTL.
+///
+/// Connect racing: a non-zero `connectRaceStagger` connects to the resolved
+/// endpoints with staggered, overlapping attempts (see `rmqio::ConnectRace`)
+/// instead of one after another.
+///
+/// Read allocator: when set, the blocks frames are read into are allocated
+/// from it rather than the default allocator. Frames reference these blocks
+/// until consumed messages are released, so it must be thread safe and
+/// outlive every message read.
+///
+/// Write queue stats: when set, connections count the writes they have
+/// queued but not yet completed into it.
+///
+/// Adaptive reads: a `maxReadBytes` larger than the negotiated maximum frame
+/// size lets reads grow towards it while they keep filling their buffer,
+/// and shrink back to one frame once they stop (see `rmqio::ReadSizer`).
+///
+/// Read frame budget: when non-zero, a connection hands at most this many
+/// frames from one read to the rest of the stack before posting the rest
+/// to the event loop, and reads again only once all have been handed on.
+/// Other connections on the event loop run in between, so one with a deep
+/// backlog cannot hold them up for a whole large read.
+///
+/// Decode pool: when set, connections whose decoder reads in place decode
+/// their reads on its threads rather than the event loop thread, see
+/// `rmqio::DecodePool`. The read frame budget does not apply to them, as
+/// each read's frames arrive on the event loop in one go while the next
+/// read is already under way.
+///
+/// Read stats: when set, connections count their reads and the bytes read
+/// into it.
+///
+/// Wire capture: when set, connections record the bytes they read and
+/// write into it, see `rmqio::WireCapture`.
+///
+/// Socket options: TCP settings set on each socket once it connects, see
+/// `rmqt::SocketOptions`. Busy polling is configured through `setBusyPoll`
+/// rather than the socket options' own setting.
+
+class ConnectionOptions {
+  public:
+    /// Matches the number of buffers asio passes to a single `writev`
+    static const bsl::size_t k_DEFAULT_MAX_COALESCED_WRITE_BUFFERS = 64;
+    static const bsl::size_t k_DEFAULT_MAX_COALESCED_WRITE_BYTES =
+        128 * 1024;
+
+    typedef bsl::function<void(const bsls::TimeInterval& duration)>
+        HandshakeObserver;
+
+    ConnectionOptions();
+
+    ConnectionOptions& setWriteCoalescing(bsl::size_t maxBytes,
+                                          bsl::size_t maxBuffers);
+
+    ConnectionOptions& setDeferWrites(bool enabled);
+
+    ConnectionOptions& setBusyPoll(int microseconds);
+
+    ConnectionOptions& setKernelTls(bool enabled);
+
+    ConnectionOptions&
+    setTlsSessionCache(const bsl::shared_ptr<TlsSessionCache>& cache);
+
+    ConnectionOptions&
+    setTlsHandshakePool(const bsl::shared_ptr<TlsHandshakePool>& pool);
+
+    ConnectionOptions&
+    setTlsHandshakeObserver(const HandshakeObserver& observer);
+
+    ConnectionOptions&
+    setResolutionCache(const bsl::shared_ptr<ResolutionCache>& cache);
+
+    ConnectionOptions& setConnectRace(const bsls::TimeInterval& stagger);
+
+    ConnectionOptions& setReadAllocator(bslma::Allocator* allocator);
+
+    ConnectionOptions&
+    setWriteQueueStats(const bsl::shared_ptr<WriteQueueStats>& stats);
+
+    ConnectionOptions& setMaxReadBytes(bsl::size_t maxBytes);
+
+    ConnectionOptions& setReadFrameBudget(bsl::size_t frames);
+
+    ConnectionOptions& setDecodePool(const bsl::shared_ptr<DecodePool>& pool);
+
+    ConnectionOptions& setReadStats(const bsl::shared_ptr<ReadStats>& stats);
+
+    ConnectionOptions&
+    setWireCapture(const bsl::shared_ptr<WireCapture>& capture);
+
+    ConnectionOptions& setSocketOptions(const rmqt::SocketOptions& options);
+
+    bsl::size_t maxCoalescedWriteBytes() const { return d_maxWriteBytes; }
+    bsl::size_t maxCoalescedWriteBuffers() const { return d_maxWriteBuffers; }
+    bool deferWrites() const { return d_deferWrites; }
+    int busyPollMicroseconds() const { return d_busyPollMicroseconds; }
+    bool kernelTls() const { return d_kernelTls; }
+    const bsl::shared_ptr<TlsSessionCache>& tlsSessionCache() const
+    {
+        return d_tlsSessionCache;
+    }
+    const bsl::shared_ptr<TlsHandshakePool>& tlsHandshakePool() const
+    {
+        return d_tlsHandshakePool;
+    }
+    const HandshakeObserver& tlsHandshakeObserver() const
+    {
+        return d_tlsHandshakeObserver;
+    }
+    const bsl::shared_ptr<ResolutionCache>& resolutionCache() const
+    {
+        return d_resolutionCache;
+    }
+    const bsls::TimeInterval& connectRaceStagger() const
+    {
+        return d_connectRaceStagger;
+    }
+    /// The read allocator, or 0 for the default allocator
+    bslma::Allocator* readAllocator() const { return d_readAllocator; }
+
+    const bsl::shared_ptr<WriteQueueStats>& writeQueueStats() const
+    {
+        return d_writeQueueStats;
+    }
+
+    /// The most bytes a read asks for, or 0 to read one frame's worth
+    bsl::size_t maxReadBytes() const { return d_maxReadBytes; }
+
+    bsl::size_t readFrameBudget() const { return d_readFrameBudget; }
+
+    const bsl::shared_ptr<DecodePool>& decodePool() const
+    {
+        return d_decodePool;
+    }
+
+    const bsl::shared_ptr<ReadStats>& readStats() const
+    {
+        return d_readStats;
+    }
+
+    const bsl::shared_ptr<WireCapture>& wireCapture() const
+    {
+        return d_wireCapture;
+    }
+
+    const rmqt::SocketOptions& socketOptions() const
+    {
+        return d_socketOptions;
+    }
+
+  private:
+    bsl::size_t d_maxWriteBytes;
+    bsl::size_t d_maxWriteBuffers;
+    bool d_deferWrites;
+    int d_busyPollMicroseconds;
+    bool d_kernelTls;
+    bsl::shared_ptr<TlsSessionCache> d_tlsSessionCache;
+    bsl::shared_ptr<TlsHandshakePool> d_tlsHandshakePool;
+    HandshakeObserver d_tlsHandshakeObserver;
+    bsl::shared_ptr<ResolutionCache> d_resolutionCache;
+    bsls::TimeInterval d_connectRaceStagger;
+    bslma::Allocator* d_readAllocator;
+    bsl::shared_ptr<WriteQueueStats> d_writeQueueStats;
+    bsl::size_t d_maxReadBytes;
+    bsl::size_t d_readFrameBudget;
+    bsl::shared_ptr<DecodePool> d_decodePool;
+    bsl::shared_ptr<ReadStats> d_readStats;
+    bsl::shared_ptr<WireCapture> d_wireCapture;
+    rmqt::SocketOptions d_socketOptions;
+};
+
+bsl::ostream& operator<<(bsl::ostream& os, const ConnectionOptions& options);
+
+} // namespace rmqio
+} // namespace BloombergLP
+
+#endif
@@ -0,0 +1,77 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqio_connectlimiter.h>
+
+#include <bsls_timeutil.h>
+#include <bsls_types.h>
+
+namespace BloombergLP {
+namespace rmqio {
+namespace {
+
+const bsls::Types::Int64 k_MIN_RETRY_MILLISECONDS = 100;
+const bsls::Types::Int64 k_RETRY_SPREAD_MILLISECONDS = 200;
+
+} // namespace
+
+ConnectLimiter::ConnectLimiter(bsl::size_t maxConcurrent)
+: d_maxConcurrent(maxConcurrent)
+, d_inProgress(0)
+, d_jitter(static_cast<bsls::Types::Uint64>(bsls::TimeUtil::getTimer()))
+{
+}
+
+bool ConnectLimiter::tryAcquire()
+{
+    const bsls::Types::Int64 limit =
+        static_cast<bsls::Types::Int64>(d_maxConcurrent);
+
+    bsls::Types::Int64 current = d_inProgress.loadRelaxed();
+    while (current < limit) {
+        const bsls::Types::Int64 previous =
+            d_inProgress.testAndSwap(current, current + 1);
+        if (previous == current) {
+            return true;
+        }
+        current = previous;
+    }
+    return false;
+}
+
+void ConnectLimiter::release() { d_inProgress.addRelaxed(-1); }
+
+bsls::TimeInterval ConnectLimiter::retryInterval()
+{
+    // A Weyl sequence scrambled by a multiply is plenty for spreading retries
+    const bsls::Types::Uint64 x =
+        d_jitter.addRelaxed(0x9E3779B97F4A7C15ULL) * 0xBF58476D1CE4E5B9ULL;
+    const bsls::Types::Int64 milliseconds =
+        k_MIN_RETRY_MILLISECONDS +
+        static_cast<bsls::Types::Int64>((x >> 33) %
+                                        k_RETRY_SPREAD_MILLISECONDS);
+
+    bsls::TimeInterval interval;
+    interval.addMilliseconds(milliseconds);
+    return interval;
+}
+
+bsl::size_t ConnectLimiter::inProgress() const
+{
+    return static_cast<bsl::size_t>(d_inProgress.loadRelaxed());
+}
+
+} // namespace rmqio
+} // namespace BloombergLP
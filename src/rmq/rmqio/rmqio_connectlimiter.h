@@ -0,0 +1,74 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQIO_CONNECTLIMITER
+#define INCLUDED_RMQIO_CONNECTLIMITER
+
+#include <bsls_atomic.h>
+#include <bsls_keyword.h>
+#include <bsls_timeinterval.h>
+
+#include <bsl_cstddef.h>
+
+//@PURPOSE: Bound how many connections handshake with the broker at once
+//
+//@CLASSES:
+//  rmqio::ConnectLimiter: Permits to connect, shared by a context's
+//  connections
+
+namespace BloombergLP {
+namespace rmqio {
+
+/// \brief Hands out at most `maxConcurrent` permits to connect
+///
+/// A connection takes a permit before it starts connecting and returns it
+/// once the AMQP handshake completes or the attempt fails. Connections which
+/// find no permit free try again after `retryInterval()`, which is jittered
+/// so that waiting connections do not all try at the same moment.
+///
+/// Thread safe.
+
+class ConnectLimiter {
+  public:
+    explicit ConnectLimiter(bsl::size_t maxConcurrent);
+
+    /// Take a permit, returning false if none is free
+    bool tryAcquire();
+
+    /// Return a permit taken by `tryAcquire`
+    void release();
+
+    /// How long to wait before trying for a permit again: between 100 and
+    /// 300 milliseconds
+    bsls::TimeInterval retryInterval();
+
+    /// Permits currently taken
+    bsl::size_t inProgress() const;
+
+    bsl::size_t maxConcurrent() const { return d_maxConcurrent; }
+
+  private:
+    ConnectLimiter(const ConnectLimiter&) BSLS_KEYWORD_DELETED;
+    ConnectLimiter& operator=(const ConnectLimiter&) BSLS_KEYWORD_DELETED;
+
+    const bsl::size_t d_maxConcurrent;
+    bsls::AtomicInt64 d_inProgress;
+    bsls::AtomicUint64 d_jitter;
+};
+
+} // namespace rmqio
+} // namespace BloombergLP
+
+#endif
@@ -0,0 +1,162 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <rmqio_connectrace.h>
+
+#include <rmqt_log.h>
+
+#include <ball_log.h>
+#include <bdlf_bind.h>
+#include <bsls_assert.h>
+
+#include <bsl_iterator.h>
+#include <bsl_utility.h>
+
+namespace BloombergLP {
+namespace rmqio {
+
+namespace {
+BALL_LOG_SET_NAMESPACE_CATEGORY("RMQIO.CONNECTRACE")
+} // namespace
+
+void ConnectRace::start(boost::asio::ip::tcp::socket& socket,
+                        const Endpoints& endpoints,
+                        const bsls::TimeInterval& stagger,
+                        const Handler& handler)
+{
+    if (endpoints.empty()) {
+        boost::asio::post(socket.get_executor(),
+                          bdlf::BindUtil::bind(handler,
+                                               boost::asio::error::not_found,
+                                               endpoints.end()));
+        return;
+    }
+
+    bsl::shared_ptr<ConnectRace> race(
+        new ConnectRace(socket, endpoints, stagger, handler));
+    race->launchNext();
+}
+
+ConnectRace::ConnectRace(boost::asio::ip::tcp::socket& socket,
+                         const Endpoints& endpoints,
+                         const bsls::TimeInterval& stagger,
+                         const Handler& handler)
+: d_socket(socket)
+, d_endpoints(endpoints)
+, d_stagger(stagger)
+, d_handler(handler)
+, d_timer(socket.get_executor())
+, d_attempts()
+, d_pending(0)
+, d_done(false)
+, d_lastError()
+{
+    d_attempts.reserve(endpoints.size());
+}
+
+void ConnectRace::launchNext()
+{
+    BSLS_ASSERT(d_attempts.size() < d_endpoints.size());
+
+    const bsl::size_t index = d_attempts.size();
+    Endpoints::iterator endpoint = d_endpoints.begin();
+    bsl::advance(endpoint, index);
+
+    RMQT_LOG_DEBUG << "Connect attempt " << index + 1 << "/"
+                   << d_endpoints.size() << " to " << endpoint->endpoint();
+
+    d_attempts.push_back(bsl::make_shared<boost::asio::ip::tcp::socket>(
+        d_socket.get_executor()));
+    ++d_pending;
+    d_attempts.back()->async_connect(
+        endpoint->endpoint(),
+        bdlf::BindUtil::bind(&ConnectRace::onAttempt,
+                             shared_from_this(),
+                             index,
+                             bdlf::PlaceHolders::_1));
+
+    if (d_attempts.size() < d_endpoints.size()) {
+        d_timer.expires_after(
+            boost::asio::chrono::microseconds(d_stagger.totalMicroseconds()));
+        d_timer.async_wait(bdlf::BindUtil::bind(&ConnectRace::onStagger,
+                                                shared_from_this(),
+                                                bdlf::PlaceHolders::_1));
+    }
+}
+
+void ConnectRace::onStagger(const boost::system::error_code& error)
+{
+    if (error || d_done || d_attempts.size() == d_endpoints.size()) {
+        // Cancelled by a failed attempt starting the next one, or decided
+        return;
+    }
+
+    launchNext();
+}
+
+void ConnectRace::onAttempt(bsl::size_t index,
+                            const boost::system::error_code& error)
+{
+    --d_pending;
+    if (d_done) {
+        return;
+    }
+
+    Endpoints::iterator endpoint = d_endpoints.begin();
+    bsl::advance(endpoint, index);
+
+    if (!error) {
+        d_socket = bsl::move(*d_attempts[index]);
+        finish(error, endpoint);
+        return;
+    }
+
+    RMQT_LOG_DEBUG << "Connect attempt to " << endpoint->endpoint()
+                   << " failed: " << error.message();
+    d_lastError = error;
+
+    boost::system::error_code ignored;
+    d_attempts[index]->close(ignored);
+
+    if (d_attempts.size() < d_endpoints.size()) {
+        // Don't wait out the stagger for an endpoint already known dead
+        d_timer.cancel();
+        launchNext();
+    }
+    else if (d_pending == 0) {
+        finish(d_lastError, d_endpoints.end());
+    }
+}
+
+void ConnectRace::finish(const boost::system::error_code& error,
+                         Endpoints::iterator endpoint)
+{
+    d_done = true;
+    d_timer.cancel();
+
+    boost::system::error_code ignored;
+    for (bsl::vector<SocketSp>::iterator it = d_attempts.begin();
+         it != d_attempts.end();
+         ++it) {
+        // Aborts the attempts still in flight
+        (*it)->close(ignored);
+    }
+
+    Handler handler;
+    bsl::swap(handler, d_handler);
+    handler(error, endpoint);
+}
+
+} // namespace rmqio
+} // namespace BloombergLP
@@ -0,0 +1,100 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef INCLUDED_RMQIO_CONNECTRACE
+#define INCLUDED_RMQIO_CONNECTRACE
+
+#include <boost/asio.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <bsls_keyword.h>
+#include <bsls_timeinterval.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_functional.h>
+#include <bsl_memory.h>
+#include <bsl_vector.h>
+
+//@PURPOSE: Race staggered connection attempts to resolved endpoints
+//
+//@CLASSES:
+//  rmqio::ConnectRace: Happy Eyeballs style replacement for async_connect
+
+namespace BloombergLP {
+namespace rmqio {
+
+/// \brief Connect to whichever resolved endpoint answers first
+///
+/// `boost::asio::async_connect` tries endpoints one after another, so each
+/// dead node in front of a live one costs a full connect timeout. A race
+/// starts with the first endpoint and, every `stagger` without a winner,
+/// adds an attempt to the next one (RFC 8305). An attempt that fails starts
+/// the next one straight away. The first attempt to connect wins: its socket
+/// is moved into the caller's and the others are closed.
+///
+/// Runs on the socket's executor, which must not run handlers concurrently
+/// (e.g. a single-threaded event loop).
+
+class ConnectRace : public bsl::enable_shared_from_this<ConnectRace> {
+  public:
+    typedef boost::asio::ip::tcp::resolver::results_type Endpoints;
+    typedef bsl::function<void(const boost::system::error_code&,
+                               Endpoints::iterator)>
+        Handler;
+
+    /// Connect `socket` to the first of `endpoints` to accept. `handler` is
+    /// called once, with the endpoint now connected to, or with the last
+    /// error and `endpoints.end()` if every attempt failed. `socket` must
+    /// not be open, and must stay alive until `handler` is called.
+    static void start(boost::asio::ip::tcp::socket& socket,
+                      const Endpoints& endpoints,
+                      const bsls::TimeInterval& stagger,
+                      const Handler& handler);
+
+  private:
+    typedef bsl::shared_ptr<boost::asio::ip::tcp::socket> SocketSp;
+
+    ConnectRace(boost::asio::ip::tcp::socket& socket,
+                const Endpoints& endpoints,
+                const bsls::TimeInterval& stagger,
+                const Handler& handler);
+
+    ConnectRace(const ConnectRace&) BSLS_KEYWORD_DELETED;
+    ConnectRace& operator=(const ConnectRace&) BSLS_KEYWORD_DELETED;
+
+    /// Start an attempt to the next endpoint, and time the one after
+    void launchNext();
+
+    void onStagger(const boost::system::error_code& error);
+
+    void onAttempt(bsl::size_t index, const boost::system::error_code& error);
+
+    void finish(const boost::system::error_code& error,
+                Endpoints::iterator endpoint);
+
+    boost::asio::ip::tcp::socket& d_socket;
+    Endpoints d_endpoints;
+    bsls::TimeInterval d_stagger;
+    Handler d_handler;
+    boost::asio::steady_timer d_timer;
+    bsl::vector<SocketSp> d_attempts;
+    bsl::size_t d_pending;
+    bool d_done;
+    boost::system::error_code d_lastError;
+};
+
+} // namespace rmqio
+} // namespace BloombergLP
+
+#endif
@@ -0,0 +1,47 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqio_countingallocator.h>
+
+#include <bslma_default.h>
+
+namespace BloombergLP {
+namespace rmqio {
+
+CountingAllocator::CountingAllocator(bslma::Allocator* upstream)
+: d_upstream(bslma::Default::allocator(upstream))
+, d_allocations(0)
+, d_bytes(0)
+, d_deallocations(0)
+{
+}
+
+void* CountingAllocator::allocate(size_type size)
+{
+    d_allocations.addRelaxed(1);
+    d_bytes.addRelaxed(static_cast<bsls::Types::Int64>(size));
+    return d_upstream->allocate(size);
+}
+
+void CountingAllocator::deallocate(void* address)
+{
+    if (address) {
+        d_deallocations.addRelaxed(1);
+    }
+    d_upstream->deallocate(address);
+}
+
+} // namespace rmqio
+} // namespace BloombergLP
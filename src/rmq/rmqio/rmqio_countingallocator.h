@@ -0,0 +1,83 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQIO_COUNTINGALLOCATOR
+#define INCLUDED_RMQIO_COUNTINGALLOCATOR
+
+#include <bslma_allocator.h>
+#include <bsls_atomic.h>
+#include <bsls_keyword.h>
+#include <bsls_types.h>
+
+//@PURPOSE: Allocator counting what passes through it
+//
+//@CLASSES:
+//  rmqio::CountingAllocator: Counts allocations and bytes, forwarding them to
+//  an upstream allocator
+
+namespace BloombergLP {
+namespace rmqio {
+
+/// \brief Forwards to an upstream allocator, counting the allocations made
+/// and the bytes they requested
+///
+/// Counts only grow, so the allocations made over a period are the
+/// difference of two readings. Counters are relaxed atomics: cheap enough to
+/// leave in a benchmark, but not a synchronisation point.
+///
+/// Thread safe if the upstream allocator is.
+
+class CountingAllocator : public bslma::Allocator {
+  public:
+    /// Forward to `upstream`, or the default allocator if 0
+    explicit CountingAllocator(bslma::Allocator* upstream = 0);
+
+    void* allocate(size_type size) BSLS_KEYWORD_OVERRIDE;
+
+    void deallocate(void* address) BSLS_KEYWORD_OVERRIDE;
+
+    /// Number of `allocate` calls so far
+    bsls::Types::Int64 allocations() const
+    {
+        return d_allocations.loadRelaxed();
+    }
+
+    /// Bytes requested by `allocate` so far
+    bsls::Types::Int64 bytesAllocated() const
+    {
+        return d_bytes.loadRelaxed();
+    }
+
+    /// Number of `deallocate` calls so far, null addresses excluded
+    bsls::Types::Int64 deallocations() const
+    {
+        return d_deallocations.loadRelaxed();
+    }
+
+  private:
+    CountingAllocator(const CountingAllocator&) BSLS_KEYWORD_DELETED;
+    CountingAllocator&
+    operator=(const CountingAllocator&) BSLS_KEYWORD_DELETED;
+
+    bslma::Allocator* d_upstream;
+    bsls::AtomicInt64 d_allocations;
+    bsls::AtomicInt64 d_bytes;
+    bsls::AtomicInt64 d_deallocations;
+};
+
+} // namespace rmqio
+} // namespace BloombergLP
+
+#endif
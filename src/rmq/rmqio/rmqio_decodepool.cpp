@@ -0,0 +1,69 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <rmqio_decodepool.h>
+
+#include <ball_log.h>
+
+namespace BloombergLP {
+namespace rmqio {
+namespace {
+
+BALL_LOG_SET_NAMESPACE_CATEGORY("RMQIO.DECODEPOOL")
+
+void queueDeleted() {}
+
+} // namespace
+
+DecodePool::DecodePool(const bslmt::ThreadAttributes& attributes,
+                       bsl::size_t numThreads)
+: d_numThreads(numThreads)
+, d_threadPool(attributes,
+               static_cast<int>(numThreads),
+               static_cast<int>(numThreads),
+               0)
+{
+}
+
+DecodePool::~DecodePool() { shutdown(); }
+
+int DecodePool::start() { return d_threadPool.start(); }
+
+void DecodePool::shutdown() { d_threadPool.shutdown(); }
+
+int DecodePool::createQueue()
+{
+    const int queue = d_threadPool.createQueue();
+    if (!queue) {
+        BALL_LOG_ERROR << "Decode pool is not running, reads are decoded on "
+                          "the event loop";
+    }
+    return queue;
+}
+
+void DecodePool::deleteQueue(int queue)
+{
+    // Called on event loop threads, so must not wait for the running job
+    d_threadPool.deleteQueue(queue, &queueDeleted);
+}
+
+int DecodePool::enqueue(int queue, const Job& job)
+{
+    return d_threadPool.enqueueJob(queue, job);
+}
+
+} // namespace rmqio
+} // namespace BloombergLP
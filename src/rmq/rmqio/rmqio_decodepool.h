@@ -0,0 +1,91 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef INCLUDED_RMQIO_DECODEPOOL
+#define INCLUDED_RMQIO_DECODEPOOL
+
+#include <bdlmt_multiqueuethreadpool.h>
+#include <bslmt_threadattributes.h>
+#include <bsls_keyword.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_functional.h>
+
+//@PURPOSE: Decode connections' reads off the event loop thread
+//
+//@CLASSES:
+//  rmqio::DecodePool: Threads decoding the frames of connections' reads
+
+namespace BloombergLP {
+namespace rmqio {
+
+/// \brief Threads which decode the bytes connections read into frames
+///
+/// A connection given a pool reads on its event loop thread as before, but
+/// hands each block read to its own queue in the pool and reads the next
+/// straight away. The block's frames are decoded on one of the pool's
+/// threads and posted back to the event loop, which hands them to the
+/// channels as usual. One hot connection then keeps a core reading and
+/// another decoding, while channels still run on the event loop thread
+/// alone.
+///
+/// A connection's blocks are decoded in order, one at a time, as the
+/// decoder carries frames split between them. One pool is shared by all
+/// the connections of a RabbitContext, across event loop threads.
+
+class DecodePool {
+  public:
+    typedef bsl::function<void()> Job;
+
+    DecodePool(const bslmt::ThreadAttributes& attributes,
+               bsl::size_t numThreads);
+
+    /// Abandons queued jobs
+    ~DecodePool();
+
+    /// Start the threads. Return 0 on success.
+    int start();
+
+    /// Abandon queued jobs, which then never run, and wait for those
+    /// running to finish
+    void shutdown();
+
+    /// Return the id of a new queue, whose jobs run in the order they are
+    /// enqueued, one at a time, or 0 if the pool is not running
+    int createQueue();
+
+    /// Stop running the jobs of `queue`, without waiting for the one
+    /// running, if any
+    void deleteQueue(int queue);
+
+    /// Run `job` on one of the pool's threads after the jobs already in
+    /// `queue`. Return 0 on success, non-zero if the pool is not running.
+    int enqueue(int queue, const Job& job);
+
+    bsl::size_t numThreads() const { return d_numThreads; }
+
+  private:
+    DecodePool(const DecodePool&) BSLS_KEYWORD_DELETED;
+    DecodePool& operator=(const DecodePool&) BSLS_KEYWORD_DELETED;
+
+    bsl::size_t d_numThreads;
+    bdlmt::MultiQueueThreadPool d_threadPool;
+};
+
+} // namespace rmqio
+} // namespace BloombergLP
+
+#endif
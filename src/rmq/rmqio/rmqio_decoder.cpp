@@ -19,6 +19,7 @@
 
 #include <bslma_managedptr.h>
 
+#include <bsl_algorithm.h>
 #include <bsl_cstdint.h>
 #include <bsl_cstdio.h>
 #include <bsl_stdexcept.h>
@@ -27,17 +28,26 @@
 namespace BloombergLP {
 namespace rmqio {
 
-bslma::ManagedPtr<Decoder> Decoder::create(bsl::size_t maxFrameSize)
+bslma::ManagedPtr<Decoder> Decoder::create(bsl::size_t maxFrameSize,
+                                           Mode mode)
 {
-    return bslma::ManagedPtrUtil::makeManaged<Decoder>(maxFrameSize);
+    return bslma::ManagedPtrUtil::makeManaged<Decoder>(maxFrameSize, mode);
 }
 
-Decoder::Decoder(bsl::size_t maxFrameSize)
+Decoder::Decoder(bsl::size_t maxFrameSize, Mode mode)
 : d_maxFrameSize(maxFrameSize)
+, d_mode(mode)
 , d_buffer()
 {
 }
 
+void Decoder::trim()
+{
+    if (d_buffer.capacity() > d_buffer.size()) {
+        bsl::vector<uint8_t>(d_buffer).swap(d_buffer);
+    }
+}
+
 Decoder::ReturnCode
 Decoder::appendBytes(bsl::vector<rmqamqpt::Frame>* outFrames,
                      const void* buffer,
@@ -86,5 +96,83 @@ Decoder::appendBytes(bsl::vector<rmqamqpt::Frame>* outFrames,
     return Decoder::OK;
 }
 
+Decoder::ReturnCode
+Decoder::decodeInPlace(bsl::vector<rmqamqpt::Frame>* outFrames,
+                       const bsl::shared_ptr<bsl::vector<uint8_t> >& block,
+                       bsl::size_t length)
+{
+    const bsl::uint8_t* data = block->data();
+    bsl::size_t offset       = 0;
+
+    bsl::size_t readBytes = 0;
+    bsl::size_t missing   = 0;
+    rmqamqpt::Frame frame;
+    rmqamqpt::Frame::ReturnCode rc;
+
+    // Complete a frame left over from the previous block. Only the bytes
+    // belonging to that frame are copied.
+    while (!d_buffer.empty() && offset < length) {
+        bsl::size_t wanted = rmqamqpt::Frame::frameHeaderSize();
+        if (d_buffer.size() >= rmqamqpt::Frame::frameHeaderSize()) {
+            // Peek the payload length (bytes 3-6) to learn the frame size
+            wanted = rmqamqpt::Frame::frameOverhead() +
+                     ((static_cast<bsl::size_t>(d_buffer[3]) << 24) |
+                      (static_cast<bsl::size_t>(d_buffer[4]) << 16) |
+                      (static_cast<bsl::size_t>(d_buffer[5]) << 8) |
+                      static_cast<bsl::size_t>(d_buffer[6]));
+        }
+
+        const bsl::size_t take =
+            bsl::min(wanted - d_buffer.size(), length - offset);
+        d_buffer.insert(d_buffer.end(), data + offset, data + offset + take);
+        offset += take;
+
+        if (d_buffer.size() > d_maxFrameSize) {
+            return Decoder::MAX_FRAME_SIZE;
+        }
+
+        if (d_buffer.size() < wanted ||
+            d_buffer.size() < rmqamqpt::Frame::frameOverhead()) {
+            continue;
+        }
+
+        bsl::shared_ptr<bsl::vector<uint8_t> > carried =
+            bsl::make_shared<bsl::vector<uint8_t> >();
+        carried->swap(d_buffer);
+
+        rc = rmqamqpt::Frame::decodeInPlace(
+            &frame, &readBytes, &missing, carried, 0, carried->size());
+        if (rc == rmqamqpt::Frame::DECODE_ERROR) {
+            return Decoder::DECODE_ERROR;
+        }
+        if (rc == rmqamqpt::Frame::PARTIAL) {
+            // Only the header was complete, keep accumulating
+            d_buffer.swap(*carried);
+            continue;
+        }
+        outFrames->push_back(frame);
+    }
+
+    while (rmqamqpt::Frame::OK ==
+           (rc = rmqamqpt::Frame::decodeInPlace(
+                &frame, &readBytes, &missing, block, offset, length - offset))) {
+        outFrames->push_back(frame);
+        offset += readBytes;
+    }
+
+    if (rc == rmqamqpt::Frame::DECODE_ERROR) {
+        return Decoder::DECODE_ERROR;
+    }
+
+    // Keep the trailing partial frame for the next block
+    d_buffer.insert(d_buffer.end(), data + offset, data + length);
+
+    if (d_buffer.size() > d_maxFrameSize) {
+        return Decoder::MAX_FRAME_SIZE;
+    }
+
+    return Decoder::OK;
+}
+
 } // namespace rmqio
 } // namespace BloombergLP
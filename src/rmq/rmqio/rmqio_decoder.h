@@ -22,6 +22,7 @@
 #include <bsls_keyword.h>
 
 #include <bsl_cstdlib.h>
+#include <bsl_memory.h>
 #include <bsl_vector.h>
 #include <bslma_managedptr.h>
 
@@ -46,14 +47,22 @@ class Decoder {
         DECODE_ERROR    ///< Corrupt/invalid data received
     };
 
-    static bslma::ManagedPtr<Decoder> create(bsl::size_t maxFrameSize = 2048);
+    enum Mode {
+        COPY = 0, ///< Connections feed bytes through `appendBytes`
+        IN_PLACE  ///< Connections read into shared blocks and feed them
+                  ///<     through `decodeInPlace`
+    };
+
+    static bslma::ManagedPtr<Decoder> create(bsl::size_t maxFrameSize = 2048,
+                                             Mode mode = COPY);
 
     /// Constructor
     /// \param maxFrameSize sets the limit after which `appendBytes` will
     /// return
     ///     an error code if a frame cannot be constructed. Indicating either
     ///     invalid data or a large, unsupported, frame size.
-    explicit Decoder(bsl::size_t maxFrameSize);
+    /// \param mode selects how the owning connection feeds data in
+    explicit Decoder(bsl::size_t maxFrameSize, Mode mode = COPY);
 
     /// Add `buffer` bytes to the internal buffer, and attempt to decode whole
     /// Frame(s) using the new, larger, internal buffer.
@@ -70,15 +79,36 @@ class Decoder {
                                    const void* buffer,
                                    bsl::size_t bufferLength);
 
+    /// Decode frames from the first `length` bytes of `block` without
+    /// copying them: decoded frames share ownership of `block`, so the
+    /// caller must not write to it again while any of them are alive. Only
+    /// frames split across calls are copied, into the internal buffer.
+    ///
+    /// \return ReturnCode as for `appendBytes`
+    virtual ReturnCode
+    decodeInPlace(bsl::vector<rmqamqpt::Frame>* outFrames,
+                  const bsl::shared_ptr<bsl::vector<uint8_t> >& block,
+                  bsl::size_t length);
+
     virtual ~Decoder() {}
 
     bsl::size_t maxFrameSize() const { return d_maxFrameSize; }
 
+    /// Release the internal buffer's spare capacity, left behind by frames
+    /// split across reads, keeping only the bytes still buffered
+    void trim();
+
+    /// Bytes the internal buffer holds on to, buffered or not
+    bsl::size_t bufferCapacity() const { return d_buffer.capacity(); }
+
+    Mode mode() const { return d_mode; }
+
   private:
     Decoder(const Decoder&) BSLS_KEYWORD_DELETED;
     Decoder& operator=(const Decoder&) BSLS_KEYWORD_DELETED;
 
     bsl::size_t d_maxFrameSize;
+    Mode d_mode;
     bsl::vector<uint8_t> d_buffer;
 
 }; // class Decoder
@@ -15,8 +15,12 @@
 
 #include <rmqio_eventloop.h>
 
+#include <rmqio_numatopology.h>
+#include <rmqt_log.h>
+
 #include <ball_log.h>
 #include <bslmt_threadutil.h>
+#include <bsls_platform.h>
 
 #include <bdlf_bind.h>
 #include <bsl_memory.h>
@@ -27,12 +31,15 @@ namespace rmqio {
 
 namespace {
 BALL_LOG_SET_NAMESPACE_CATEGORY("RMQIO.EVENTLOOP")
+
+const char DEFAULT_THREAD_NAME[] = "RMQIO.EVENTLOOP";
 } // namespace
 
 EventLoop::EventLoop()
 : d_thread()
 , d_started(false)
 , d_joined(false)
+, d_cpuAffinity()
 {
 }
 
@@ -50,7 +57,10 @@ EventLoop::~EventLoop()
     d_started = false;
 }
 
-void EventLoop::start()
+void EventLoop::start() { start(bslmt::ThreadAttributes()); }
+
+void EventLoop::start(const bslmt::ThreadAttributes& attributes,
+                      const bsl::vector<int>& cpuAffinity)
 {
     // Start worker thread
     if (d_started) {
@@ -58,8 +68,26 @@ void EventLoop::start()
                           "already running";
         return;
     }
+
+    if (!runsOwnThread()) {
+        // Nothing to run: whoever owns the loop's thread runs it
+        d_started = true;
+        d_joined  = true;
+        return;
+    }
+
+    bslmt::ThreadAttributes threadAttributes(attributes);
+    threadAttributes.setDetachedState(
+        bslmt::ThreadAttributes::e_CREATE_JOINABLE);
+    if (threadAttributes.threadName().empty()) {
+        threadAttributes.setThreadName(DEFAULT_THREAD_NAME);
+    }
+    d_cpuAffinity = cpuAffinity;
+
     const int error_code = bslmt::ThreadUtil::create(
-        &d_thread, bdlf::BindUtil::bind(&EventLoop::run, this));
+        &d_thread,
+        threadAttributes,
+        bdlf::BindUtil::bind(&EventLoop::run, this));
     if (error_code) {
         BALL_LOG_ERROR
             << "Couldn't start event loop worker thread. Error code: "
@@ -74,16 +102,47 @@ void EventLoop::start()
 
 bool EventLoop::isStarted() const { return d_started; }
 
+bool EventLoop::runsOwnThread() const { return true; }
+
+EventLoop::BusyPollStats EventLoop::busyPollStats() const
+{
+    return BusyPollStats();
+}
+
+EventLoop::LoadStats EventLoop::loadStats() { return LoadStats(); }
+
+bsl::size_t EventLoop::poll() { return 0; }
+
+bsl::size_t EventLoop::runFor(const bsls::TimeInterval&) { return 0; }
+
+void EventLoop::applyCpuAffinity()
+{
+    if (d_cpuAffinity.empty()) {
+        return;
+    }
+#ifdef BSLS_PLATFORM_OS_LINUX
+    const int rc = NumaTopology::bindThread(d_cpuAffinity);
+    if (rc) {
+        BALL_LOG_WARN << "Failed to set event loop thread CPU affinity. "
+                         "Error code: "
+                      << rc;
+    }
+#else
+    BALL_LOG_WARN << "Event loop thread CPU affinity is not supported on "
+                     "this platform";
+#endif
+}
+
 void EventLoop::run()
 {
-    bslmt::ThreadUtil::setThreadName("RMQIO.EVENTLOOP");
-    BALL_LOG_TRACE << "IO thread started";
+    applyCpuAffinity();
+    RMQT_LOG_TRACE << "IO thread started";
     this->onThreadStarted();
-    BALL_LOG_TRACE << "IO thread finished";
+    RMQT_LOG_TRACE << "IO thread finished";
     // d_running = false;?
 }
 
-void EventLoop::loopStarted() { BALL_LOG_DEBUG << "Event Loop Running"; }
+void EventLoop::loopStarted() { RMQT_LOG_DEBUG << "Event Loop Running"; }
 
 } // namespace rmqio
 } // namespace BloombergLP
@@ -16,16 +16,22 @@
 #ifndef INCLUDED_RMQIO_EVENTLOOP
 #define INCLUDED_RMQIO_EVENTLOOP
 
+#include <rmqio_connectionoptions.h>
 #include <rmqt_future.h>
 #include <rmqt_result.h>
 
 #include <bdlf_bind.h>
 #include <bdlf_placeholder.h>
+#include <bslmt_threadattributes.h>
 #include <bslmt_threadutil.h>
 #include <bsls_keyword.h>
+#include <bsls_timeinterval.h>
+#include <bsls_types.h>
 
+#include <bsl_cstddef.h>
 #include <bsl_functional.h>
 #include <bsl_memory.h>
+#include <bsl_vector.h>
 
 namespace BloombergLP {
 namespace rmqio {
@@ -36,10 +42,56 @@ class EventLoop {
     bslmt::ThreadUtil::Handle d_thread;
     bool d_started;
     bool d_joined;
+    bsl::vector<int> d_cpuAffinity;
 
   public:
     typedef bsl::function<void()> Item;
 
+    /// Cumulative counters for event loops which busy-poll before blocking
+    struct BusyPollStats {
+        /// Time spent polling without finding any work: the CPU cost
+        bsls::Types::Int64 idleSpinNanoseconds;
+        /// Handlers run while spinning: the wake-ups saved
+        bsls::Types::Int64 spinHandlers;
+        /// Handlers run after blocking for work: the wake-ups not saved
+        bsls::Types::Int64 blockingWakeups;
+
+        BusyPollStats()
+        : idleSpinNanoseconds(0)
+        , spinHandlers(0)
+        , blockingWakeups(0)
+        {
+        }
+    };
+
+    /// How busy an event loop is, for event loops tracking their load
+    struct LoadStats {
+        /// Items posted which have not run yet (a gauge)
+        bsls::Types::Int64 pendingPosts;
+
+        /// Loop iterations which ran at least one handler (cumulative)
+        bsls::Types::Int64 iterations;
+
+        /// Time spent running posted items (cumulative)
+        bsls::Types::Int64 postedNanoseconds;
+
+        /// Time spent running every other handler: socket reads and
+        /// writes, timers and resolves (cumulative)
+        bsls::Types::Int64 ioNanoseconds;
+
+        /// Longest iteration since the previous call to `loadStats`
+        bsls::Types::Int64 maxIterationNanoseconds;
+
+        LoadStats()
+        : pendingPosts(0)
+        , iterations(0)
+        , postedNanoseconds(0)
+        , ioNanoseconds(0)
+        , maxIterationNanoseconds(0)
+        {
+        }
+    };
+
     // CREATORS
     EventLoop();
     virtual ~EventLoop();
@@ -60,17 +112,54 @@ class EventLoop {
     /// event
     void start();
 
+    /// As `start()`, creating the worker thread with `attributes` (e.g.
+    /// scheduling policy, priority, stack size). The thread is always
+    /// joinable, and is named RMQIO.EVENTLOOP unless `attributes` names it.
+    /// If `cpuAffinity` is not empty the thread is restricted to those CPUs
+    /// (Linux only, otherwise a warning is logged).
+    void start(const bslmt::ThreadAttributes& attributes,
+               const bsl::vector<int>& cpuAffinity = bsl::vector<int>());
+
     virtual bool isStarted() const;
 
+    /// Return the worker thread, once started
+    const bslmt::ThreadUtil::Handle& threadHandle() const { return d_thread; }
+
+    /// Return the resolver used to open connections. The arguments are used
+    /// to create the resolver on first call, and ignored afterwards.
     virtual bsl::shared_ptr<Resolver>
-    resolver(bool shuffleConnectionEndpoints)            = 0;
+    resolver(bool shuffleConnectionEndpoints,
+             const ConnectionOptions& connectionOptions) = 0;
     virtual bsl::shared_ptr<TimerFactory> timerFactory() = 0;
 
+    /// Return the busy-poll counters. All zero unless the event loop is
+    /// configured to busy-poll. May be called from any thread.
+    virtual BusyPollStats busyPollStats() const;
+
+    /// Return the load counters, resetting `maxIterationNanoseconds`. All
+    /// zero unless the event loop is configured to track its load. May be
+    /// called from any thread.
+    virtual LoadStats loadStats();
+
+    /// Run the handlers ready to run on the calling thread, without
+    /// blocking, and return how many ran. Only loops which do not run their
+    /// own thread, and are not run by anyone else, may be driven this way:
+    /// the default implementation runs nothing.
+    virtual bsl::size_t poll();
+
+    /// As `poll`, but waiting up to `duration` for handlers to become ready
+    virtual bsl::size_t runFor(const bsls::TimeInterval& duration);
+
     /// Attempt to soft-close event loop, waiting up to `waitTimeSec` for
     /// closure
     virtual bool waitForEventLoopExit(int64_t waitTimeSec) = 0;
 
   protected:
+    /// Return false if the loop is run by a thread something else owns, in
+    /// which case `start` creates no thread and `onThreadStarted` is never
+    /// called. The default implementation returns true.
+    virtual bool runsOwnThread() const;
+
     virtual void onThreadStarted()              = 0;
     virtual void postImpl(const Item& item)     = 0;
     virtual void dispatchImpl(const Item& item) = 0;
@@ -81,6 +170,7 @@ class EventLoop {
     EventLoop& operator=(const EventLoop&) BSLS_KEYWORD_DELETED;
 
     void loopStarted();
+    void applyCpuAffinity();
     void run();
 };
 
@@ -0,0 +1,152 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqio_framebufferpool.h>
+
+#include <bslma_default.h>
+#include <bsls_alignmentutil.h>
+#include <bsls_types.h>
+
+namespace BloombergLP {
+namespace rmqio {
+namespace {
+
+/// Room for the size in front of each upstream block, keeping the block
+/// maximally aligned
+const bsl::size_t k_SIZE_HEADER = bsls::AlignmentUtil::BSLS_MAX_ALIGNMENT;
+
+} // namespace
+
+FrameBufferPool::Stats::Stats()
+: allocations(0)
+, deallocations(0)
+, upstreamAllocations(0)
+, upstreamDeallocations(0)
+, upstreamBytesAllocated(0)
+, upstreamBytesOutstanding(0)
+{
+}
+
+FrameBufferPool::CountingAllocator::CountingAllocator(
+    bslma::Allocator* allocator)
+: d_allocations(0)
+, d_deallocations(0)
+, d_bytesAllocated(0)
+, d_bytesOutstanding(0)
+, d_allocator(bslma::Default::allocator(allocator))
+{
+}
+
+void* FrameBufferPool::CountingAllocator::allocate(size_type size)
+{
+    ++d_allocations;
+    d_bytesAllocated.addRelaxed(size);
+    d_bytesOutstanding.addRelaxed(static_cast<bsls::Types::Int64>(size));
+
+    char* block =
+        static_cast<char*>(d_allocator->allocate(k_SIZE_HEADER + size));
+    *reinterpret_cast<size_type*>(block) = size;
+    return block + k_SIZE_HEADER;
+}
+
+void FrameBufferPool::CountingAllocator::deallocate(void* address)
+{
+    if (!address) {
+        return;
+    }
+
+    char* block          = static_cast<char*>(address) - k_SIZE_HEADER;
+    const size_type size = *reinterpret_cast<size_type*>(block);
+    ++d_deallocations;
+    d_bytesOutstanding.addRelaxed(-static_cast<bsls::Types::Int64>(size));
+    d_allocator->deallocate(block);
+}
+
+bsl::shared_ptr<FrameBufferPool>
+FrameBufferPool::create(bslma::Allocator* upstream)
+{
+    return bsl::shared_ptr<FrameBufferPool>(new FrameBufferPool(upstream),
+                                            &FrameBufferPool::releaseHandle);
+}
+
+FrameBufferPool::FrameBufferPool(bslma::Allocator* upstream)
+: d_upstream(upstream)
+, d_pool(k_NUM_POOLS, &d_upstream)
+, d_allocations(0)
+, d_deallocations(0)
+, d_references(1)
+{
+}
+
+FrameBufferPool::~FrameBufferPool() {}
+
+void FrameBufferPool::releaseHandle(FrameBufferPool* pool) { pool->unref(); }
+
+void FrameBufferPool::unref()
+{
+    if (--d_references == 0) {
+        delete this;
+    }
+}
+
+void* FrameBufferPool::allocate(size_type size)
+{
+    if (size == 0) {
+        return 0;
+    }
+
+    void* result = d_pool.allocate(size);
+    ++d_references;
+    ++d_allocations;
+    return result;
+}
+
+void FrameBufferPool::deallocate(void* address)
+{
+    if (!address) {
+        return;
+    }
+
+    ++d_deallocations;
+    d_pool.deallocate(address);
+    unref();
+}
+
+FrameBufferPool::Stats FrameBufferPool::stats() const
+{
+    Stats result;
+    result.allocations            = d_allocations.loadRelaxed();
+    result.deallocations          = d_deallocations.loadRelaxed();
+    result.upstreamAllocations    = d_upstream.d_allocations.loadRelaxed();
+    result.upstreamDeallocations  = d_upstream.d_deallocations.loadRelaxed();
+    result.upstreamBytesAllocated = d_upstream.d_bytesAllocated.loadRelaxed();
+    result.upstreamBytesOutstanding =
+        d_upstream.d_bytesOutstanding.loadRelaxed();
+    return result;
+}
+
+bsl::ostream& operator<<(bsl::ostream& os, const FrameBufferPool::Stats& stats)
+{
+    return os << "FrameBufferPool [allocations: " << stats.allocations
+              << ", deallocations: " << stats.deallocations
+              << ", upstream allocations: " << stats.upstreamAllocations
+              << ", upstream deallocations: " << stats.upstreamDeallocations
+              << ", upstream bytes: " << stats.upstreamBytesAllocated
+              << ", upstream bytes outstanding: "
+              << stats.upstreamBytesOutstanding << "]";
+}
+
+} // namespace rmqio
+} // namespace BloombergLP
@@ -0,0 +1,123 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQIO_FRAMEBUFFERPOOL
+#define INCLUDED_RMQIO_FRAMEBUFFERPOOL
+
+#include <bdlma_concurrentmultipoolallocator.h>
+#include <bslma_allocator.h>
+#include <bsls_atomic.h>
+#include <bsls_keyword.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_cstdint.h>
+#include <bsl_memory.h>
+#include <bsl_ostream.h>
+
+//@PURPOSE: Recycle the memory backing outgoing frames
+//
+//@CLASSES:
+//  rmqio::FrameBufferPool: Pooled allocator for SerializedFrame objects and
+//      their buffers, with allocation counters
+
+namespace BloombergLP {
+namespace rmqio {
+
+/// \brief Thread-safe pool allocator for outgoing frame memory
+///
+/// Frames and their buffers are allocated when a message is written and freed
+/// once the socket write completes. Serving them from a multipool means that
+/// once the pool is warmed up publishing does not call into the system
+/// allocator at all. The pool stays alive until the last handle returned by
+/// 'create' is released AND every block allocated from it has been returned,
+/// so frames still queued on a socket may safely outlive their connection.
+
+class FrameBufferPool : public bslma::Allocator {
+  public:
+    /// Counters describing pool usage. 'allocations' counts every request
+    /// served by the pool, 'upstreamAllocations' counts the requests the
+    /// pool passed on to the underlying allocator (i.e. mallocs). In steady
+    /// state 'upstreamAllocations' should stay constant.
+    /// 'upstreamBytesOutstanding' is the memory the pool holds at the moment,
+    /// in use or pooled.
+    struct Stats {
+        bsl::uint64_t allocations;
+        bsl::uint64_t deallocations;
+        bsl::uint64_t upstreamAllocations;
+        bsl::uint64_t upstreamDeallocations;
+        bsl::uint64_t upstreamBytesAllocated;
+        bsl::uint64_t upstreamBytesOutstanding;
+
+        Stats();
+    };
+
+    /// Pool blocks of up to 2^(k_NUM_POOLS + 2) bytes, which covers the
+    /// largest frame size we negotiate. Larger blocks go straight to the
+    /// upstream allocator.
+    static const int k_NUM_POOLS = 16;
+
+    static bsl::shared_ptr<FrameBufferPool>
+    create(bslma::Allocator* upstream = 0);
+
+    void* allocate(size_type size) BSLS_KEYWORD_OVERRIDE;
+    void deallocate(void* address) BSLS_KEYWORD_OVERRIDE;
+
+    Stats stats() const;
+
+  private:
+    explicit FrameBufferPool(bslma::Allocator* upstream);
+    ~FrameBufferPool() BSLS_KEYWORD_OVERRIDE;
+
+    FrameBufferPool(const FrameBufferPool&) BSLS_KEYWORD_DELETED;
+    FrameBufferPool& operator=(const FrameBufferPool&) BSLS_KEYWORD_DELETED;
+
+    static void releaseHandle(FrameBufferPool* pool);
+
+    /// Drop one reference (the handle, or an outstanding block), deleting
+    /// the pool when none remain
+    void unref();
+
+    /// Forwards to another allocator, counting requests. Each block carries
+    /// its size, so that the bytes outstanding can be counted down.
+    class CountingAllocator : public bslma::Allocator {
+      public:
+        explicit CountingAllocator(bslma::Allocator* allocator);
+
+        void* allocate(size_type size) BSLS_KEYWORD_OVERRIDE;
+        void deallocate(void* address) BSLS_KEYWORD_OVERRIDE;
+
+        bsls::AtomicUint64 d_allocations;
+        bsls::AtomicUint64 d_deallocations;
+        bsls::AtomicUint64 d_bytesAllocated;
+        bsls::AtomicInt64 d_bytesOutstanding;
+
+      private:
+        bslma::Allocator* d_allocator;
+    };
+
+    CountingAllocator d_upstream;
+    bdlma::ConcurrentMultipoolAllocator d_pool;
+    bsls::AtomicUint64 d_allocations;
+    bsls::AtomicUint64 d_deallocations;
+    bsls::AtomicInt64 d_references;
+};
+
+bsl::ostream& operator<<(bsl::ostream& os,
+                         const FrameBufferPool::Stats& stats);
+
+} // namespace rmqio
+} // namespace BloombergLP
+
+#endif
@@ -0,0 +1,57 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqio_handlermemory.h>
+
+#include <new>
+
+namespace BloombergLP {
+namespace rmqio {
+
+const bsl::size_t HandlerMemory::k_SLOT_SIZE;
+const bsl::size_t HandlerMemory::k_NUM_SLOTS;
+
+HandlerMemory::HandlerMemory()
+{
+    for (bsl::size_t i = 0; i < k_NUM_SLOTS; ++i) {
+        d_inUse[i] = false;
+    }
+}
+
+void* HandlerMemory::allocate(bsl::size_t size)
+{
+    if (size <= k_SLOT_SIZE) {
+        for (bsl::size_t i = 0; i < k_NUM_SLOTS; ++i) {
+            if (!d_inUse[i].testAndSwap(false, true)) {
+                return d_slots[i].buffer();
+            }
+        }
+    }
+    return ::operator new(size);
+}
+
+void HandlerMemory::deallocate(void* pointer)
+{
+    for (bsl::size_t i = 0; i < k_NUM_SLOTS; ++i) {
+        if (pointer == d_slots[i].buffer()) {
+            d_inUse[i] = false;
+            return;
+        }
+    }
+    ::operator delete(pointer);
+}
+
+} // namespace rmqio
+} // namespace BloombergLP
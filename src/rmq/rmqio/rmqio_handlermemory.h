@@ -0,0 +1,151 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQIO_HANDLERMEMORY
+#define INCLUDED_RMQIO_HANDLERMEMORY
+
+#include <bsls_alignedbuffer.h>
+#include <bsls_atomic.h>
+#include <bsls_keyword.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_memory.h>
+
+//@PURPOSE: Recycle the memory asio allocates for completion handlers
+//
+//@CLASSES:
+//  rmqio::HandlerMemory: Slots reused by a connection's I/O operations
+//  rmqio::HandlerAllocator: Allocator asio uses for a wrapped handler
+//  rmqio::AllocatingHandler: Associates a handler with a HandlerMemory
+
+namespace BloombergLP {
+namespace rmqio {
+
+/// \brief A few fixed-size slots of memory for asio to store pending
+/// operations (and the handlers they complete to) in
+///
+/// A connection has at most one read and one write outstanding, each
+/// wrapping its handler in one or more asio operations (TLS reads and writes
+/// nest several). Allocations which are too large, or made while every slot
+/// is in use, fall back to the heap.
+///
+/// Thread safe.
+
+class HandlerMemory {
+  public:
+    static const bsl::size_t k_SLOT_SIZE = 1024;
+    static const bsl::size_t k_NUM_SLOTS = 4;
+
+    HandlerMemory();
+
+    void* allocate(bsl::size_t size);
+
+    void deallocate(void* pointer);
+
+  private:
+    HandlerMemory(const HandlerMemory&) BSLS_KEYWORD_DELETED;
+    HandlerMemory& operator=(const HandlerMemory&) BSLS_KEYWORD_DELETED;
+
+    bsls::AlignedBuffer<k_SLOT_SIZE> d_slots[k_NUM_SLOTS];
+    bsls::AtomicBool d_inUse[k_NUM_SLOTS];
+};
+
+/// \brief Allocator found by asio's `associated_allocator` on an
+/// AllocatingHandler. It refers to, rather than owns, the HandlerMemory: the
+/// handler it was taken from keeps the memory alive.
+template <typename T>
+class HandlerAllocator {
+  public:
+    typedef T value_type;
+
+    explicit HandlerAllocator(HandlerMemory* memory)
+    : d_memory(memory)
+    {
+    }
+
+    template <typename U>
+    HandlerAllocator(const HandlerAllocator<U>& other)
+    : d_memory(other.d_memory)
+    {
+    }
+
+    T* allocate(bsl::size_t n)
+    {
+        return static_cast<T*>(d_memory->allocate(sizeof(T) * n));
+    }
+
+    void deallocate(T* pointer, bsl::size_t) { d_memory->deallocate(pointer); }
+
+    template <typename U>
+    bool operator==(const HandlerAllocator<U>& other) const
+    {
+        return d_memory == other.d_memory;
+    }
+
+    template <typename U>
+    bool operator!=(const HandlerAllocator<U>& other) const
+    {
+        return d_memory != other.d_memory;
+    }
+
+  private:
+    template <typename U>
+    friend class HandlerAllocator;
+
+    HandlerMemory* d_memory;
+};
+
+/// \brief Wraps a completion handler taking two arguments (an error code and
+/// a byte count), so that asio allocates its operations from `memory`
+template <typename Handler>
+class AllocatingHandler {
+  public:
+    typedef HandlerAllocator<Handler> allocator_type;
+
+    AllocatingHandler(const bsl::shared_ptr<HandlerMemory>& memory,
+                      const Handler& handler)
+    : d_memory(memory)
+    , d_handler(handler)
+    {
+    }
+
+    allocator_type get_allocator() const
+    {
+        return allocator_type(d_memory.get());
+    }
+
+    template <typename Arg1, typename Arg2>
+    void operator()(const Arg1& arg1, const Arg2& arg2)
+    {
+        d_handler(arg1, arg2);
+    }
+
+  private:
+    bsl::shared_ptr<HandlerMemory> d_memory;
+    Handler d_handler;
+};
+
+template <typename Handler>
+AllocatingHandler<Handler>
+makeAllocatingHandler(const bsl::shared_ptr<HandlerMemory>& memory,
+                      const Handler& handler)
+{
+    return AllocatingHandler<Handler>(memory, handler);
+}
+
+} // namespace rmqio
+} // namespace BloombergLP
+
+#endif
@@ -0,0 +1,266 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqio_hugepagearena.h>
+
+#include <ball_log.h>
+#include <bslma_default.h>
+#include <bslmt_lockguard.h>
+#include <bsls_types.h>
+
+#if defined(__linux__)
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define RMQIO_HUGEPAGEARENA_SUPPORTED
+#endif
+
+namespace BloombergLP {
+namespace rmqio {
+
+namespace {
+
+BALL_LOG_SET_NAMESPACE_CATEGORY("RMQIO.HUGEPAGEARENA")
+
+/// Written before every block: the pool it returns to, or `k_FALLBACK`
+const int k_FALLBACK = -1;
+
+bsl::size_t roundUp(bsl::size_t size, bsl::size_t multiple)
+{
+    return (size + multiple - 1) / multiple * multiple;
+}
+
+/// Return the index of the smallest pool whose blocks hold `size` bytes,
+/// which is `HugePageArena::k_NUM_POOLS` if none do
+int poolFor(bsl::size_t size)
+{
+    int pool               = 0;
+    bsl::size_t blockSize = 8;
+    while (blockSize < size && pool < HugePageArena::k_NUM_POOLS) {
+        blockSize <<= 1;
+        ++pool;
+    }
+    return pool;
+}
+
+/// Bytes of the region one block of `pool` takes, header included
+bsl::size_t carveSize(int pool)
+{
+    return HugePageArena::k_HEADER_SIZE +
+           roundUp(bsl::size_t(8) << pool, HugePageArena::k_HEADER_SIZE);
+}
+
+#ifdef RMQIO_HUGEPAGEARENA_SUPPORTED
+
+/// Map `size` bytes, from the reserved huge pages if `explicitPages`, and
+/// fault them in. Return 0 on failure.
+char* mapRegion(bsl::size_t size, bool explicitPages)
+{
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    if (explicitPages) {
+        flags |= MAP_HUGETLB | MAP_POPULATE;
+    }
+    void* base = ::mmap(0, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (base == MAP_FAILED) {
+        const int error = errno;
+        BALL_LOG_WARN << "Failed to map " << size << " bytes"
+                      << (explicitPages ? " of reserved huge pages" : "")
+                      << ": " << ::strerror(error);
+        return 0;
+    }
+
+    if (!explicitPages) {
+#ifdef MADV_HUGEPAGE
+        if (::madvise(base, size, MADV_HUGEPAGE) != 0) {
+            const int error = errno;
+            BALL_LOG_INFO << "Transparent huge pages unavailable: "
+                          << ::strerror(error);
+        }
+#endif
+        // Fault in after the advice, so the kernel can back the region with
+        // huge pages rather than the small ones it would have used
+        const bsl::size_t pageSize = ::sysconf(_SC_PAGESIZE);
+        for (bsl::size_t offset = 0; offset < size; offset += pageSize) {
+            static_cast<volatile char*>(base)[offset] = 0;
+        }
+    }
+    return static_cast<char*>(base);
+}
+
+#endif
+
+} // namespace
+
+HugePageArena::Stats::Stats()
+: regionBytes(0)
+, regionBytesUsed(0)
+, fallbackAllocations(0)
+, explicitHugePages(false)
+{
+}
+
+HugePageArena::FreeList::FreeList()
+: d_mutex()
+, d_head(0)
+{
+}
+
+bsl::shared_ptr<HugePageArena> HugePageArena::create(
+    bsl::size_t bytes,
+    Mode::Value mode,
+    bslma::Allocator* fallback)
+{
+    return bsl::shared_ptr<HugePageArena>(
+        new HugePageArena(bytes, mode, fallback),
+        &HugePageArena::releaseHandle);
+}
+
+HugePageArena::HugePageArena(bsl::size_t bytes,
+                             Mode::Value mode,
+                             bslma::Allocator* fallback)
+: d_base(0)
+, d_size(0)
+, d_explicit(false)
+, d_used(0)
+, d_fallbackAllocations(0)
+, d_fallback(bslma::Default::allocator(fallback))
+, d_references(1)
+{
+#ifdef RMQIO_HUGEPAGEARENA_SUPPORTED
+    const bsl::size_t size = roundUp(bytes, k_HUGE_PAGE_SIZE);
+    if (size == 0) {
+        return;
+    }
+    if (mode == Mode::e_EXPLICIT) {
+        d_base     = mapRegion(size, true);
+        d_explicit = d_base != 0;
+    }
+    if (!d_base) {
+        d_base = mapRegion(size, false);
+    }
+    if (d_base) {
+        d_size = size;
+    }
+#else
+    (void)bytes;
+    (void)mode;
+    BALL_LOG_INFO << "Huge page buffers are only supported on Linux";
+#endif
+}
+
+HugePageArena::~HugePageArena()
+{
+#ifdef RMQIO_HUGEPAGEARENA_SUPPORTED
+    if (d_base) {
+        ::munmap(d_base, d_size);
+    }
+#endif
+}
+
+void HugePageArena::releaseHandle(HugePageArena* arena) { arena->unref(); }
+
+void HugePageArena::unref()
+{
+    if (--d_references == 0) {
+        delete this;
+    }
+}
+
+char* HugePageArena::carve(int pool)
+{
+    const bsl::size_t size = carveSize(pool);
+    bsls::Types::Uint64 used = d_used.loadRelaxed();
+    for (;;) {
+        if (used + size > d_size) {
+            return 0;
+        }
+        const bsls::Types::Uint64 previous =
+            d_used.testAndSwap(used, used + size);
+        if (previous == used) {
+            return d_base + used;
+        }
+        used = previous;
+    }
+}
+
+void* HugePageArena::allocate(size_type size)
+{
+    if (size == 0) {
+        return 0;
+    }
+
+    const int pool = poolFor(size);
+    char* header   = 0;
+    if (pool < k_NUM_POOLS) {
+        FreeList& freeList = d_pools[pool];
+        {
+            bslmt::LockGuard<bslmt::Mutex> guard(&freeList.d_mutex);
+            if (freeList.d_head) {
+                header = static_cast<char*>(freeList.d_head) - k_HEADER_SIZE;
+                freeList.d_head = *static_cast<void**>(freeList.d_head);
+            }
+        }
+        if (!header) {
+            header = carve(pool);
+        }
+    }
+
+    if (header) {
+        *reinterpret_cast<int*>(header) = pool;
+    }
+    else {
+        header = static_cast<char*>(
+            d_fallback->allocate(k_HEADER_SIZE + size));
+        *reinterpret_cast<int*>(header) = k_FALLBACK;
+        ++d_fallbackAllocations;
+    }
+
+    ++d_references;
+    return header + k_HEADER_SIZE;
+}
+
+void HugePageArena::deallocate(void* address)
+{
+    if (!address) {
+        return;
+    }
+
+    char* header   = static_cast<char*>(address) - k_HEADER_SIZE;
+    const int pool = *reinterpret_cast<int*>(header);
+    if (pool == k_FALLBACK) {
+        d_fallback->deallocate(header);
+    }
+    else {
+        FreeList& freeList = d_pools[pool];
+        bslmt::LockGuard<bslmt::Mutex> guard(&freeList.d_mutex);
+        *static_cast<void**>(address) = freeList.d_head;
+        freeList.d_head               = address;
+    }
+    unref();
+}
+
+HugePageArena::Stats HugePageArena::stats() const
+{
+    Stats result;
+    result.regionBytes         = d_size;
+    result.regionBytesUsed     = d_used.loadRelaxed();
+    result.fallbackAllocations = d_fallbackAllocations.loadRelaxed();
+    result.explicitHugePages   = d_explicit;
+    return result;
+}
+
+} // namespace rmqio
+} // namespace BloombergLP
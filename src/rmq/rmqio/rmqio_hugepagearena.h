@@ -0,0 +1,142 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQIO_HUGEPAGEARENA
+#define INCLUDED_RMQIO_HUGEPAGEARENA
+
+#include <bslma_allocator.h>
+#include <bslmt_mutex.h>
+#include <bsls_atomic.h>
+#include <bsls_keyword.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_cstdint.h>
+#include <bsl_memory.h>
+
+//@PURPOSE: Serve I/O buffers from a pre-faulted, huge-page backed region
+//
+//@CLASSES:
+//  rmqio::HugePageArena: Pooled allocator over a region mapped up front with
+//      huge pages
+
+namespace BloombergLP {
+namespace rmqio {
+
+/// \brief Thread-safe pool allocator carving its blocks out of one region
+/// mapped, and faulted in, when it is created
+///
+/// Read buffers, frame pools and message payloads touch a lot of fresh
+/// memory under load. Backing them with huge pages cuts the TLB misses of
+/// walking those buffers, and faulting the whole region in up front moves
+/// the page faults out of the hot path. With `e_EXPLICIT` the region comes
+/// from the reserved `hugetlbfs` pages (`vm.nr_hugepages`), falling back to
+/// transparent huge pages if none are available. With `e_TRANSPARENT` the
+/// kernel is asked (`madvise`) to back the region with huge pages where it
+/// can. Elsewhere than Linux the region is empty.
+///
+/// Blocks are pooled by power-of-two size, so freed blocks are reused rather
+/// than returned to the region. Once the region is used up, or for a block
+/// larger than the largest pool, the arena allocates from its fallback
+/// allocator.
+///
+/// Like `FrameBufferPool`, the arena stays alive until the last handle
+/// returned by `create` is released AND every block allocated from it has
+/// been returned.
+
+class HugePageArena : public bslma::Allocator {
+  public:
+    struct Mode {
+        enum Value {
+            e_TRANSPARENT, ///< `madvise(MADV_HUGEPAGE)`, best effort
+            e_EXPLICIT     ///< `MAP_HUGETLB`, from the reserved pages
+        };
+    };
+
+    struct Stats {
+        /// Bytes mapped for the region, 0 if mapping failed
+        bsl::size_t regionBytes;
+        /// Bytes of the region carved into blocks so far
+        bsl::size_t regionBytesUsed;
+        /// Requests served by the fallback allocator
+        bsl::uint64_t fallbackAllocations;
+        /// True if the region came from the reserved huge pages
+        bool explicitHugePages;
+
+        Stats();
+    };
+
+    /// Pool blocks of up to 2^(k_NUM_POOLS + 2) bytes, which covers the
+    /// largest read buffer
+    static const int k_NUM_POOLS = 18;
+
+    /// Alignment of every block, and size of the header before it
+    static const bsl::size_t k_HEADER_SIZE = 16;
+
+    /// Size of the huge pages the region is rounded up to
+    static const bsl::size_t k_HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    /// Map a region of at least `bytes` in `mode`, falling back to
+    /// `fallback` (the default allocator if 0) once it is used up
+    static bsl::shared_ptr<HugePageArena>
+    create(bsl::size_t bytes,
+           Mode::Value mode            = Mode::e_TRANSPARENT,
+           bslma::Allocator* fallback = 0);
+
+    void* allocate(size_type size) BSLS_KEYWORD_OVERRIDE;
+    void deallocate(void* address) BSLS_KEYWORD_OVERRIDE;
+
+    Stats stats() const;
+
+  private:
+    HugePageArena(bsl::size_t bytes,
+                  Mode::Value mode,
+                  bslma::Allocator* fallback);
+    ~HugePageArena() BSLS_KEYWORD_OVERRIDE;
+
+    HugePageArena(const HugePageArena&) BSLS_KEYWORD_DELETED;
+    HugePageArena& operator=(const HugePageArena&) BSLS_KEYWORD_DELETED;
+
+    static void releaseHandle(HugePageArena* arena);
+
+    /// Drop one reference (the handle, or an outstanding block), deleting
+    /// the arena when none remain
+    void unref();
+
+    /// Return the header of a fresh block of pool `pool`, carved from the
+    /// region, or 0 if the region is used up
+    char* carve(int pool);
+
+    /// Freed blocks of one size, linked through their first word
+    struct FreeList {
+        bslmt::Mutex d_mutex;
+        void* d_head;
+
+        FreeList();
+    };
+
+    char* d_base;
+    bsl::size_t d_size;
+    bool d_explicit;
+    bsls::AtomicUint64 d_used;
+    bsls::AtomicUint64 d_fallbackAllocations;
+    bslma::Allocator* d_fallback;
+    FreeList d_pools[k_NUM_POOLS];
+    bsls::AtomicInt64 d_references;
+};
+
+} // namespace rmqio
+} // namespace BloombergLP
+
+#endif
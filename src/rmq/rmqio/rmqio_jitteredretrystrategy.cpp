@@ -0,0 +1,90 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqio_jitteredretrystrategy.h>
+
+#include <bdlb_random.h>
+#include <bsls_timeutil.h>
+#include <bsls_types.h>
+
+#include <bsl_algorithm.h>
+#include <bsl_ostream.h>
+
+namespace BloombergLP {
+namespace rmqio {
+
+JitteredRetryStrategy::JitteredRetryStrategy(
+    const bsls::TimeInterval& minWait,
+    const bsls::TimeInterval& maxWait,
+    const UniformRandom& random)
+: d_minWait(minWait)
+, d_maxWait(bsl::max(minWait, maxWait))
+, d_random(random)
+, d_seed(static_cast<int>(bsls::TimeUtil::getTimer() ^
+                          reinterpret_cast<bsls::Types::IntPtr>(this)))
+, d_attempts(0)
+, d_currentWait()
+{
+}
+
+void JitteredRetryStrategy::attempt() { ++d_attempts; }
+
+void JitteredRetryStrategy::success()
+{
+    d_attempts    = 0;
+    d_currentWait = bsls::TimeInterval();
+}
+
+bsls::TimeInterval JitteredRetryStrategy::getNextRetryInterval()
+{
+    const double minWait = d_minWait.totalSecondsAsDouble();
+
+    double wait;
+    if (d_currentWait == bsls::TimeInterval()) {
+        wait = random() * minWait;
+    }
+    else {
+        const double upper =
+            bsl::max(minWait, 3 * d_currentWait.totalSecondsAsDouble());
+        wait = minWait + random() * (upper - minWait);
+    }
+
+    d_currentWait = bsl::min(bsls::TimeInterval(wait), d_maxWait);
+
+    // Waits grow from `minWait` even when the first one was shorter
+    if (d_currentWait < d_minWait) {
+        const bsls::TimeInterval result = d_currentWait;
+        d_currentWait                   = d_minWait;
+        return result;
+    }
+    return d_currentWait;
+}
+
+bsl::ostream& JitteredRetryStrategy::print(bsl::ostream& os) const
+{
+    return os << "attempts: " << d_attempts
+              << ", currentWait: " << d_currentWait;
+}
+
+double JitteredRetryStrategy::random()
+{
+    if (d_random) {
+        return d_random();
+    }
+    return bdlb::Random::generate15(&d_seed) / 32768.0;
+}
+
+} // namespace rmqio
+} // namespace BloombergLP
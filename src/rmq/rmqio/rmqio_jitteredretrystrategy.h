@@ -0,0 +1,80 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQIO_JITTEREDRETRYSTRATEGY
+#define INCLUDED_RMQIO_JITTEREDRETRYSTRATEGY
+
+#include <rmqio_retrystrategy.h>
+
+#include <bsls_keyword.h>
+#include <bsls_timeinterval.h>
+
+#include <bsl_functional.h>
+#include <bsl_iosfwd.h>
+
+//@PURPOSE: Randomised retry backoff which spreads out reconnecting clients
+//
+//@CLASSES:
+//  rmqio::JitteredRetryStrategy: "Decorrelated jitter" exponential backoff
+
+namespace BloombergLP {
+namespace rmqio {
+
+/// \brief Backoff with "decorrelated jitter": each wait is drawn at random
+/// between `minWait` and three times the previous wait, capped at `maxWait`
+///
+/// The first retry after a success waits between 0 and `minWait`, so
+/// clients which all lost their connection at the same moment (e.g. when a
+/// broker node restarts) come back spread out rather than in lockstep, and
+/// later retries keep drifting apart instead of synchronising.
+///
+/// Not thread safe.
+
+class JitteredRetryStrategy : public RetryStrategy {
+  public:
+    /// Return a number in [0, 1)
+    typedef bsl::function<double()> UniformRandom;
+
+    /// \param minWait Shortest wait after the first retry
+    /// \param maxWait Longest wait
+    /// \param random  Source of randomness, defaults to `bdlb::Random`
+    ///                seeded from the clock
+    JitteredRetryStrategy(const bsls::TimeInterval& minWait,
+                          const bsls::TimeInterval& maxWait,
+                          const UniformRandom& random = UniformRandom());
+
+    virtual void attempt() BSLS_KEYWORD_OVERRIDE;
+
+    virtual void success() BSLS_KEYWORD_OVERRIDE;
+
+    virtual bsls::TimeInterval getNextRetryInterval() BSLS_KEYWORD_OVERRIDE;
+
+    virtual bsl::ostream& print(bsl::ostream& os) const BSLS_KEYWORD_OVERRIDE;
+
+  private:
+    double random();
+
+    const bsls::TimeInterval d_minWait;
+    const bsls::TimeInterval d_maxWait;
+    const UniformRandom d_random;
+    int d_seed;
+    unsigned int d_attempts;
+    bsls::TimeInterval d_currentWait;
+};
+
+} // namespace rmqio
+} // namespace BloombergLP
+
+#endif
@@ -0,0 +1,226 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <rmqio_kerneltls.h>
+
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/kdf.h>
+
+#include <ball_log.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_cstdint.h>
+#include <bsl_cstring.h>
+
+#if defined(__linux__)
+#include <errno.h>
+#include <linux/tls.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+
+#if defined(__linux__) && defined(TLS_CIPHER_AES_GCM_256)
+#define RMQIO_KERNELTLS_SUPPORTED
+#ifndef SOL_TLS
+#define SOL_TLS 282
+#endif
+#ifndef TCP_ULP
+#define TCP_ULP 31
+#endif
+#endif
+
+namespace BloombergLP {
+namespace rmqio {
+
+namespace {
+
+BALL_LOG_SET_NAMESPACE_CATEGORY("RMQIO.KERNELTLS")
+
+#ifdef RMQIO_KERNELTLS_SUPPORTED
+
+/// The Finished message is the only record each side sends under the new
+/// keys during a TLS 1.2 handshake, so application data starts at record 1
+const bsl::uint64_t k_FIRST_DATA_RECORD = 1;
+
+const bsl::size_t k_MAX_KEY_BLOCK =
+    2 * (TLS_CIPHER_AES_GCM_256_KEY_SIZE + TLS_CIPHER_AES_GCM_256_SALT_SIZE);
+
+/// Expand the session's master secret into the TLS 1.2 key block
+/// (RFC 5246 6.3). For AEAD ciphers it holds the client and server write
+/// keys followed by the client and server implicit nonces.
+bool deriveKeyBlock(SSL* ssl, unsigned char* keyBlock, bsl::size_t length)
+{
+    unsigned char masterKey[SSL_MAX_MASTER_KEY_LENGTH];
+    unsigned char clientRandom[SSL3_RANDOM_SIZE];
+    unsigned char serverRandom[SSL3_RANDOM_SIZE];
+
+    const bsl::size_t masterKeyLength = SSL_SESSION_get_master_key(
+        SSL_get_session(ssl), masterKey, sizeof(masterKey));
+    SSL_get_client_random(ssl, clientRandom, sizeof(clientRandom));
+    SSL_get_server_random(ssl, serverRandom, sizeof(serverRandom));
+
+    static const unsigned char k_LABEL[] = "key expansion";
+    const EVP_MD* md =
+        SSL_CIPHER_get_handshake_digest(SSL_get_current_cipher(ssl));
+
+    EVP_PKEY_CTX* prf = EVP_PKEY_CTX_new_id(EVP_PKEY_TLS1_PRF, NULL);
+    bool ok = prf && md && masterKeyLength > 0 &&
+              EVP_PKEY_derive_init(prf) > 0 &&
+              EVP_PKEY_CTX_set_tls1_prf_md(prf, md) > 0 &&
+              EVP_PKEY_CTX_set1_tls1_prf_secret(
+                  prf, masterKey, static_cast<int>(masterKeyLength)) > 0 &&
+              EVP_PKEY_CTX_add1_tls1_prf_seed(
+                  prf, k_LABEL, static_cast<int>(sizeof(k_LABEL) - 1)) > 0 &&
+              EVP_PKEY_CTX_add1_tls1_prf_seed(
+                  prf, serverRandom, sizeof(serverRandom)) > 0 &&
+              EVP_PKEY_CTX_add1_tls1_prf_seed(
+                  prf, clientRandom, sizeof(clientRandom)) > 0;
+
+    bsl::size_t derived = length;
+    ok = ok && EVP_PKEY_derive(prf, keyBlock, &derived) > 0 &&
+         derived == length;
+
+    EVP_PKEY_CTX_free(prf);
+    OPENSSL_cleanse(masterKey, sizeof(masterKey));
+    return ok;
+}
+
+template <typename CryptoInfo>
+bool configure(int fd,
+               int direction,
+               unsigned short cipherType,
+               const unsigned char* key,
+               const unsigned char* salt)
+{
+    CryptoInfo info;
+    bsl::memset(&info, 0, sizeof(info));
+    info.info.version     = TLS_1_2_VERSION;
+    info.info.cipher_type = cipherType;
+    bsl::memcpy(info.key, key, sizeof(info.key));
+    bsl::memcpy(info.salt, salt, sizeof(info.salt));
+
+    // Big-endian record sequence number, which also seeds the explicit
+    // nonce the kernel sends with each record
+    for (bsl::size_t i = 0; i < sizeof(info.rec_seq); ++i) {
+        info.rec_seq[sizeof(info.rec_seq) - 1 - i] =
+            static_cast<unsigned char>(k_FIRST_DATA_RECORD >> (8 * i));
+    }
+    bsl::memcpy(info.iv, info.rec_seq, sizeof(info.iv));
+
+    const int rc = setsockopt(fd, SOL_TLS, direction, &info, sizeof(info));
+    OPENSSL_cleanse(&info, sizeof(info));
+
+    if (rc != 0) {
+        BALL_LOG_INFO << "Kernel rejected TLS "
+                      << (direction == TLS_TX ? "transmit" : "receive")
+                      << " keys: " << bsl::strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+#endif
+
+} // namespace
+
+int KernelTls::install(SSL* ssl, int fd)
+{
+#ifdef RMQIO_KERNELTLS_SUPPORTED
+    if (SSL_version(ssl) != TLS1_2_VERSION) {
+        BALL_LOG_INFO << SSL_get_version(ssl)
+                      << " session stays in OpenSSL: only TLS 1.2 sessions "
+                         "are offloaded to the kernel";
+        return NONE;
+    }
+
+    const SSL_CIPHER* cipher = SSL_get_current_cipher(ssl);
+    const int nid = cipher ? SSL_CIPHER_get_cipher_nid(cipher) : NID_undef;
+
+    bsl::size_t keyLength;
+    if (nid == NID_aes_128_gcm) {
+        keyLength = TLS_CIPHER_AES_GCM_128_KEY_SIZE;
+    }
+    else if (nid == NID_aes_256_gcm) {
+        keyLength = TLS_CIPHER_AES_GCM_256_KEY_SIZE;
+    }
+    else {
+        BALL_LOG_INFO << "Cipher " << SSL_get_cipher_name(ssl)
+                      << " stays in OpenSSL: only AES-GCM is offloaded to "
+                         "the kernel";
+        return NONE;
+    }
+
+    const bsl::size_t saltLength = TLS_CIPHER_AES_GCM_128_SALT_SIZE;
+    unsigned char keyBlock[k_MAX_KEY_BLOCK];
+    if (!deriveKeyBlock(ssl, keyBlock, 2 * (keyLength + saltLength))) {
+        BALL_LOG_WARN << "Failed to derive TLS session keys, staying in "
+                         "OpenSSL";
+        return NONE;
+    }
+
+    const unsigned char* clientKey  = keyBlock;
+    const unsigned char* serverKey  = clientKey + keyLength;
+    const unsigned char* clientSalt = serverKey + keyLength;
+    const unsigned char* serverSalt = clientSalt + saltLength;
+
+    int result = NONE;
+    if (setsockopt(fd, IPPROTO_TCP, TCP_ULP, "tls", sizeof("tls")) != 0) {
+        // Typically ENOENT when the tls module is not loaded. Without keys
+        // the upper layer passes data straight through, so OpenSSL can
+        // carry on.
+        BALL_LOG_INFO << "Kernel TLS unavailable (" << bsl::strerror(errno)
+                      << "), staying in OpenSSL";
+    }
+    else if (keyLength == TLS_CIPHER_AES_GCM_128_KEY_SIZE) {
+        if (configure<tls12_crypto_info_aes_gcm_128>(
+                fd, TLS_TX, TLS_CIPHER_AES_GCM_128, clientKey, clientSalt)) {
+            result |= TX;
+        }
+        if (configure<tls12_crypto_info_aes_gcm_128>(
+                fd, TLS_RX, TLS_CIPHER_AES_GCM_128, serverKey, serverSalt)) {
+            result |= RX;
+        }
+    }
+    else {
+        if (configure<tls12_crypto_info_aes_gcm_256>(
+                fd, TLS_TX, TLS_CIPHER_AES_GCM_256, clientKey, clientSalt)) {
+            result |= TX;
+        }
+        if (configure<tls12_crypto_info_aes_gcm_256>(
+                fd, TLS_RX, TLS_CIPHER_AES_GCM_256, serverKey, serverSalt)) {
+            result |= RX;
+        }
+    }
+
+    OPENSSL_cleanse(keyBlock, sizeof(keyBlock));
+    return result;
+#else
+    (void)ssl;
+    (void)fd;
+    return NONE;
+#endif
+}
+
+bool KernelTls::isSupported()
+{
+#ifdef RMQIO_KERNELTLS_SUPPORTED
+    return true;
+#else
+    return false;
+#endif
+}
+
+} // namespace rmqio
+} // namespace BloombergLP
@@ -0,0 +1,66 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef INCLUDED_RMQIO_KERNELTLS
+#define INCLUDED_RMQIO_KERNELTLS
+
+#include <openssl/ssl.h>
+
+//@PURPOSE: Hand the record layer of an established TLS session to the kernel
+//
+//@CLASSES:
+//  rmqio::KernelTls: Installs TLS session keys into a socket (Linux kTLS)
+
+namespace BloombergLP {
+namespace rmqio {
+
+/// \brief Move TLS record encryption and decryption into the kernel
+///
+/// Once the handshake has completed in OpenSSL, `install` derives the
+/// session's traffic keys and configures them on the socket through the
+/// Linux `tls` upper layer protocol. Application data is then read and
+/// written as plaintext on the plain socket, with the kernel framing and
+/// encrypting records, so no copy through OpenSSL's buffers is needed.
+///
+/// Only TLS 1.2 sessions using AES-GCM are offloaded. TLS 1.3 brokers send
+/// session tickets after the handshake, which the kernel cannot consume on
+/// a plain read, so those sessions stay in OpenSSL. Each direction is
+/// reported separately: if the kernel accepts the transmit keys but not the
+/// receive keys, reads must keep going through OpenSSL.
+
+class KernelTls {
+  public:
+    enum Direction {
+        NONE = 0, ///< Nothing offloaded, keep using OpenSSL
+        TX   = 1, ///< Kernel encrypts writes
+        RX   = 2, ///< Kernel decrypts reads
+        BOTH = TX | RX
+    };
+
+    /// Install the keys of the client session `ssl`, which must have just
+    /// completed its handshake with nothing written or read since, into
+    /// the connected socket `fd`.
+    /// \return The directions now handled by the kernel. `NONE` if the
+    ///         session, kernel or platform is not supported, in which case
+    ///         the socket is left unchanged.
+    static int install(SSL* ssl, int fd);
+
+    /// Return `true` if this build can offload sessions at all
+    static bool isSupported();
+};
+
+} // namespace rmqio
+} // namespace BloombergLP
+
+#endif
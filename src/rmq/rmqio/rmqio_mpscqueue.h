@@ -0,0 +1,164 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQIO_MPSCQUEUE
+#define INCLUDED_RMQIO_MPSCQUEUE
+
+#include <bsls_assert.h>
+#include <bsls_atomic.h>
+#include <bsls_keyword.h>
+#include <bsls_types.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_utility.h>
+
+//@PURPOSE: Bounded lock-free multi-producer single-consumer queue
+//
+//@CLASSES:
+//  rmqio::MpscQueue: fixed capacity queue, many threads push, one thread pops
+
+namespace BloombergLP {
+namespace rmqio {
+
+/// \brief Bounded lock-free queue for many producers and a single consumer
+///
+/// Each slot carries a sequence number which tells producers whether the slot
+/// is free for the current lap of the ring, and tells the consumer whether it
+/// has been published. Producers claim a position with a CAS and never block;
+/// `tryPush` fails when the queue is full. Only one thread may call `tryPop`.
+///
+/// Sequence numbers are accessed with sequentially consistent operations, so
+/// a consumer which clears a flag and then finds the queue empty is
+/// guaranteed to be seen by a producer which pushes and then tests the flag.
+
+template <typename T>
+class MpscQueue {
+  public:
+    /// Construct a queue holding up to `capacity` items, where `capacity` is
+    /// a power of two
+    explicit MpscQueue(bsl::size_t capacity);
+    ~MpscQueue();
+
+    /// Append `item`. Return false, leaving the queue unchanged, if full.
+    /// May be called from any thread.
+    bool tryPush(const T& item);
+
+    /// Move the oldest published item into `item`. Return false if there is
+    /// none. Only one thread may pop.
+    bool tryPop(T* item);
+
+    /// Return true if `tryPop` would find no published item. Only the
+    /// popping thread gets a stable answer.
+    bool empty() const;
+
+    bsl::size_t capacity() const { return d_mask + 1; }
+
+  private:
+    MpscQueue(const MpscQueue&) BSLS_KEYWORD_DELETED;
+    MpscQueue& operator=(const MpscQueue&) BSLS_KEYWORD_DELETED;
+
+    struct Slot {
+        bsls::AtomicUint64 sequence;
+        T item;
+    };
+
+    Slot* d_slots;
+    const bsls::Types::Uint64 d_mask;
+    bsls::AtomicUint64 d_pushPosition;
+    bsls::Types::Uint64 d_popPosition;
+}; // class MpscQueue
+
+template <typename T>
+MpscQueue<T>::MpscQueue(bsl::size_t capacity)
+: d_slots(new Slot[capacity])
+, d_mask(capacity - 1)
+, d_pushPosition(0)
+, d_popPosition(0)
+{
+    BSLS_ASSERT(capacity > 0 && (capacity & (capacity - 1)) == 0);
+
+    for (bsl::size_t i = 0; i < capacity; ++i) {
+        d_slots[i].sequence.storeRelaxed(i);
+    }
+}
+
+template <typename T>
+MpscQueue<T>::~MpscQueue()
+{
+    delete[] d_slots;
+}
+
+template <typename T>
+bool MpscQueue<T>::tryPush(const T& item)
+{
+    bsls::Types::Uint64 position = d_pushPosition.loadRelaxed();
+    Slot* slot;
+
+    for (;;) {
+        slot = &d_slots[position & d_mask];
+
+        const bsls::Types::Int64 diff =
+            static_cast<bsls::Types::Int64>(slot->sequence.load() - position);
+        if (diff == 0) {
+            const bsls::Types::Uint64 previous =
+                d_pushPosition.testAndSwap(position, position + 1);
+            if (previous == position) {
+                break;
+            }
+            position = previous;
+        }
+        else if (diff < 0) {
+            // The consumer has not freed this slot from the previous lap
+            return false;
+        }
+        else {
+            position = d_pushPosition.loadRelaxed();
+        }
+    }
+
+    slot->item = item;
+    slot->sequence.store(position + 1);
+    return true;
+}
+
+template <typename T>
+bool MpscQueue<T>::tryPop(T* item)
+{
+    Slot& slot = d_slots[d_popPosition & d_mask];
+
+    if (slot.sequence.load() != d_popPosition + 1) {
+        // Empty, or the producer which claimed this slot hasn't published
+        return false;
+    }
+
+    using bsl::swap;
+    swap(*item, slot.item);
+    slot.item = T();
+    slot.sequence.store(d_popPosition + d_mask + 1);
+    ++d_popPosition;
+    return true;
+}
+
+template <typename T>
+bool MpscQueue<T>::empty() const
+{
+    return d_slots[d_popPosition & d_mask].sequence.load() !=
+           d_popPosition + 1;
+}
+
+} // namespace rmqio
+} // namespace BloombergLP
+
+#endif
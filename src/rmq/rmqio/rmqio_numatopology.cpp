@@ -0,0 +1,132 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqio_numatopology.h>
+
+#include <bsls_platform.h>
+
+#include <bsl_cstdlib.h>
+#include <bsl_fstream.h>
+#include <bsl_sstream.h>
+
+#ifdef BSLS_PLATFORM_OS_LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace BloombergLP {
+namespace rmqio {
+namespace {
+
+/// Nodes may be numbered sparsely, e.g. after hot removal: look a little
+/// past the last one found before giving up
+const int k_MAX_NODE_GAP = 8;
+
+/// Load the number at the start of `text` into `value`, and return the
+/// rest of `text`, or 0 if there is no number
+const char* parseNumber(int* value, const char* text)
+{
+    char* end    = 0;
+    const long n = bsl::strtol(text, &end, 10);
+    if (end == text || n < 0) {
+        return 0;
+    }
+    *value = static_cast<int>(n);
+    return end;
+}
+
+} // namespace
+
+int NumaTopology::parseCpuList(bsl::vector<int>* cpus,
+                               const bsl::string& cpuList)
+{
+    cpus->clear();
+
+    const char* it = cpuList.c_str();
+    while (*it && *it != '\n') {
+        int first = 0;
+        it        = parseNumber(&first, it);
+        if (!it) {
+            return 1;
+        }
+
+        int last = first;
+        if (*it == '-') {
+            it = parseNumber(&last, it + 1);
+            if (!it || last < first) {
+                return 1;
+            }
+        }
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus->push_back(cpu);
+        }
+
+        if (*it == ',') {
+            ++it;
+        }
+        else if (*it && *it != '\n') {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+bsl::vector<bsl::vector<int> > NumaTopology::nodeCpus()
+{
+    bsl::vector<bsl::vector<int> > nodes;
+#ifdef BSLS_PLATFORM_OS_LINUX
+    int lastFound = -1;
+    for (int node = 0; node <= lastFound + k_MAX_NODE_GAP; ++node) {
+        bsl::ostringstream path;
+        path << "/sys/devices/system/node/node" << node << "/cpulist";
+
+        bsl::ifstream file(path.str().c_str());
+        if (!file) {
+            continue;
+        }
+        lastFound = node;
+
+        bsl::string cpuList;
+        bsl::getline(file, cpuList);
+        bsl::vector<int> cpus;
+        if (parseCpuList(&cpus, cpuList) == 0 && !cpus.empty()) {
+            // Memory-only nodes have no CPUs to run on
+            nodes.push_back(cpus);
+        }
+    }
+#endif
+    return nodes;
+}
+
+int NumaTopology::bindThread(const bsl::vector<int>& cpus)
+{
+#ifdef BSLS_PLATFORM_OS_LINUX
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (bsl::vector<int>::const_iterator it = cpus.begin(); it != cpus.end();
+         ++it) {
+        if (*it >= 0 && *it < CPU_SETSIZE) {
+            CPU_SET(*it, &set);
+        }
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)cpus;
+    return 1;
+#endif
+}
+
+} // namespace rmqio
+} // namespace BloombergLP
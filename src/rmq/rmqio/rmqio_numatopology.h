@@ -0,0 +1,58 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQIO_NUMATOPOLOGY
+#define INCLUDED_RMQIO_NUMATOPOLOGY
+
+#include <bsl_string.h>
+#include <bsl_vector.h>
+
+//@PURPOSE: Discover the host's NUMA nodes and bind threads to them
+//
+//@CLASSES:
+//  rmqio::NumaTopology: Reads the CPUs of each NUMA node, binds threads
+
+namespace BloombergLP {
+namespace rmqio {
+
+/// \brief The NUMA nodes of the host, as the kernel reports them
+///
+/// Nodes are read from `/sys/devices/system/node`, so no NUMA library is
+/// needed. Memory is placed by Linux on the node of the thread which first
+/// touches it, so a thread bound to a node's CPUs allocates node-local
+/// buffers without any further policy.
+
+class NumaTopology {
+  public:
+    /// Return the CPUs of each NUMA node with any, by node. Empty if the
+    /// topology cannot be read, e.g. on platforms other than Linux.
+    static bsl::vector<bsl::vector<int> > nodeCpus();
+
+    /// Load the CPUs listed in the kernel's `cpuList` format, e.g.
+    /// `0-3,8,10-11`, into `cpus`.
+    /// \return 0 on success, non-zero if `cpuList` is malformed
+    static int parseCpuList(bsl::vector<int>* cpus, const bsl::string& cpuList);
+
+    /// Restrict the calling thread to `cpus`. Indices out of range are
+    /// ignored.
+    /// \return 0 on success, non-zero if the thread could not be bound, or
+    ///         binding is not supported on this platform
+    static int bindThread(const bsl::vector<int>& cpus);
+};
+
+} // namespace rmqio
+} // namespace BloombergLP
+
+#endif
@@ -0,0 +1,59 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqio_readsizer.h>
+
+#include <bsl_algorithm.h>
+
+namespace BloombergLP {
+namespace rmqio {
+
+const unsigned ReadSizer::k_SHRINK_AFTER;
+
+ReadSizer::ReadSizer(bsl::size_t minSize, bsl::size_t maxSize)
+: d_minSize(minSize)
+, d_maxSize(bsl::max(minSize, maxSize))
+, d_size(minSize)
+, d_smallReads(0)
+{
+}
+
+void ReadSizer::record(bsl::size_t bytes)
+{
+    if (bytes >= d_size) {
+        d_size       = bsl::min(d_size * 2, d_maxSize);
+        d_smallReads = 0;
+        return;
+    }
+
+    if (bytes > d_size / 4) {
+        d_smallReads = 0;
+        return;
+    }
+
+    if (++d_smallReads >= k_SHRINK_AFTER) {
+        d_size       = bsl::max(d_size / 2, d_minSize);
+        d_smallReads = 0;
+    }
+}
+
+void ReadSizer::reset()
+{
+    d_size       = d_minSize;
+    d_smallReads = 0;
+}
+
+} // namespace rmqio
+} // namespace BloombergLP
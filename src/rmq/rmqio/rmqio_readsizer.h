@@ -0,0 +1,69 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQIO_READSIZER
+#define INCLUDED_RMQIO_READSIZER
+
+#include <bsl_cstddef.h>
+
+//@PURPOSE: Adapt the size of socket reads to the traffic
+//
+//@CLASSES:
+//  rmqio::ReadSizer: Chooses how many bytes the next read asks for
+
+namespace BloombergLP {
+namespace rmqio {
+
+/// \brief Chooses how many bytes a connection's next read asks for, between
+/// `minSize` (one maximum sized frame) and `maxSize`
+///
+/// A read which fills the buffer suggests more is waiting, so the next read
+/// asks for twice as much, letting bursts of large messages arrive several
+/// frames to a read. Once `k_SHRINK_AFTER` reads in a row have used no more
+/// than a quarter of the buffer, e.g. because traffic has dropped to a
+/// trickle of small messages, the size is halved again.
+///
+/// Not thread safe.
+
+class ReadSizer {
+  public:
+    /// Consecutive small reads after which the size is halved
+    static const unsigned k_SHRINK_AFTER = 16;
+
+    /// Start at `minSize`. A `maxSize` no larger than `minSize` keeps every
+    /// read at `minSize`.
+    ReadSizer(bsl::size_t minSize, bsl::size_t maxSize);
+
+    /// Bytes the next read should ask for
+    bsl::size_t size() const { return d_size; }
+
+    /// Adapt to a read of `bytes` which asked for `size()` bytes
+    void record(bsl::size_t bytes);
+
+    /// Go back to `minSize`, e.g. once the connection has been idle, when no
+    /// reads come in to shrink the size
+    void reset();
+
+  private:
+    bsl::size_t d_minSize;
+    bsl::size_t d_maxSize;
+    bsl::size_t d_size;
+    unsigned d_smallReads;
+};
+
+} // namespace rmqio
+} // namespace BloombergLP
+
+#endif
@@ -0,0 +1,63 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQIO_READSTATS
+#define INCLUDED_RMQIO_READSTATS
+
+#include <bsls_atomic.h>
+#include <bsls_keyword.h>
+#include <bsls_types.h>
+
+//@PURPOSE: Total the socket reads of a group of connections
+//
+//@CLASSES:
+//  rmqio::ReadStats: Reads completed and bytes read
+
+namespace BloombergLP {
+namespace rmqio {
+
+/// \brief Reads completed, and the bytes they returned, by the connections
+/// sharing this object (e.g. those on one event loop)
+///
+/// Thread safe.
+
+class ReadStats {
+  public:
+    ReadStats();
+
+    /// Count a read which returned `bytes` bytes
+    void add(bsls::Types::Int64 bytes);
+
+    bsls::Types::Int64 reads() const { return d_reads.loadRelaxed(); }
+    bsls::Types::Int64 bytes() const { return d_bytes.loadRelaxed(); }
+
+  private:
+    ReadStats(const ReadStats&) BSLS_KEYWORD_DELETED;
+    ReadStats& operator=(const ReadStats&) BSLS_KEYWORD_DELETED;
+
+    bsls::AtomicInt64 d_reads;
+    bsls::AtomicInt64 d_bytes;
+};
+
+inline void ReadStats::add(bsls::Types::Int64 bytes)
+{
+    d_reads.addRelaxed(1);
+    d_bytes.addRelaxed(bytes);
+}
+
+} // namespace rmqio
+} // namespace BloombergLP
+
+#endif
@@ -0,0 +1,87 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <rmqio_resolutioncache.h>
+
+#include <bslmt_lockguard.h>
+#include <bsls_systemtime.h>
+
+namespace BloombergLP {
+namespace rmqio {
+
+namespace {
+
+bsls::TimeInterval monotonicNow()
+{
+    return bsls::SystemTime::nowMonotonicClock();
+}
+
+bsl::string key(const bsl::string& host, const bsl::string& port)
+{
+    return host + ":" + port;
+}
+
+} // namespace
+
+ResolutionCache::ResolutionCache(const bsls::TimeInterval& ttl,
+                                 const Clock& clock)
+: d_ttl(ttl)
+, d_clock(clock ? clock : Clock(&monotonicNow))
+, d_mutex()
+, d_entries()
+{
+}
+
+bool ResolutionCache::lookup(const bsl::string& host,
+                             const bsl::string& port,
+                             Results* results)
+{
+    const bsls::TimeInterval now = d_clock();
+
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+
+    Entries::iterator it = d_entries.find(key(host, port));
+    if (it == d_entries.end()) {
+        return false;
+    }
+
+    if (it->second.expiry <= now) {
+        d_entries.erase(it);
+        return false;
+    }
+
+    *results = it->second.results;
+    return true;
+}
+
+void ResolutionCache::store(const bsl::string& host,
+                            const bsl::string& port,
+                            const Results& results)
+{
+    Entry entry;
+    entry.results = results;
+    entry.expiry  = d_clock() + d_ttl;
+
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    d_entries[key(host, port)] = entry;
+}
+
+bsl::size_t ResolutionCache::size() const
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    return d_entries.size();
+}
+
+} // namespace rmqio
+} // namespace BloombergLP
@@ -0,0 +1,92 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef INCLUDED_RMQIO_RESOLUTIONCACHE
+#define INCLUDED_RMQIO_RESOLUTIONCACHE
+
+#include <boost/asio.hpp>
+
+#include <bslmt_mutex.h>
+#include <bsls_keyword.h>
+#include <bsls_timeinterval.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_functional.h>
+#include <bsl_string.h>
+#include <bsl_unordered_map.h>
+
+//@PURPOSE: Share hostname resolutions between connection attempts
+//
+//@CLASSES:
+//  rmqio::ResolutionCache: Thread-safe, TTL-bounded cache of resolver results
+
+namespace BloombergLP {
+namespace rmqio {
+
+/// \brief Resolver results keyed by host and port, each kept for a fixed
+/// time-to-live
+///
+/// asio does not report the record TTLs, so entries expire after the
+/// configured `ttl`, which bounds how long a changed DNS record can go
+/// unnoticed. One cache is shared by all the connections of a RabbitContext,
+/// across event loop threads.
+
+class ResolutionCache {
+  public:
+    typedef boost::asio::ip::tcp::resolver::results_type Results;
+    typedef bsl::function<bsls::TimeInterval()> Clock;
+
+    /// \param clock Monotonic time source, defaulting to the system's
+    explicit ResolutionCache(const bsls::TimeInterval& ttl,
+                             const Clock& clock = Clock());
+
+    /// Load the unexpired results cached for `host` and `port` into
+    /// `results`.
+    /// \return `true` on a hit
+    bool lookup(const bsl::string& host,
+                const bsl::string& port,
+                Results* results);
+
+    /// Cache `results` for `host` and `port` for the next `ttl`
+    void store(const bsl::string& host,
+               const bsl::string& port,
+               const Results& results);
+
+    /// Return the number of entries, including expired ones not yet looked
+    /// up again
+    bsl::size_t size() const;
+
+    const bsls::TimeInterval& ttl() const { return d_ttl; }
+
+  private:
+    ResolutionCache(const ResolutionCache&) BSLS_KEYWORD_DELETED;
+    ResolutionCache& operator=(const ResolutionCache&) BSLS_KEYWORD_DELETED;
+
+    struct Entry {
+        Results results;
+        bsls::TimeInterval expiry;
+    };
+
+    typedef bsl::unordered_map<bsl::string, Entry> Entries;
+
+    bsls::TimeInterval d_ttl;
+    Clock d_clock;
+    mutable bslmt::Mutex d_mutex;
+    Entries d_entries;
+};
+
+} // namespace rmqio
+} // namespace BloombergLP
+
+#endif
@@ -74,6 +74,15 @@ class Resolver {
         const NewConnectionCallback& onSuccess,
         const ErrorCallback& onFail) = 0;
 
+    /// Connect to the Unix domain socket at `path`. There is nothing to
+    /// resolve, so `onFail` is only called with `ERROR_CONNECT`.
+    virtual bsl::shared_ptr<Connection>
+    asyncLocalConnect(const bsl::string& path,
+                      bsl::size_t maxFrameSize,
+                      const Connection::Callbacks& connCallbacks,
+                      const NewConnectionCallback& onSuccess,
+                      const ErrorCallback& onFail) = 0;
+
     virtual ~Resolver() {}
 };
 
@@ -15,6 +15,7 @@
 
 #include <rmqio_retryhandler.h>
 
+#include <rmqt_log.h>
 #include <rmqt_result.h>
 
 #include <ball_log.h>
@@ -57,18 +58,18 @@ void RetryHandler::handleRetry(Timer::InterruptReason reason)
 {
     if (reason == Timer::CANCEL) {
         // Cancelled
-        BALL_LOG_DEBUG << "Aborted retrying operation";
+        RMQT_LOG_DEBUG << "Aborted retrying operation";
         return;
     }
 
-    BALL_LOG_DEBUG << "Retry timer triggered";
+    RMQT_LOG_DEBUG << "Retry timer triggered";
     d_retryStrategy->attempt();
     d_retryCallback();
 }
 
 void RetryHandler::scheduleRetry()
 {
-    BALL_LOG_DEBUG << "RetryStrategy: " << *d_retryStrategy;
+    RMQT_LOG_DEBUG << "RetryStrategy: " << *d_retryStrategy;
     d_sleepTimer->reset(d_retryStrategy->getNextRetryInterval());
 }
 
@@ -15,47 +15,136 @@
 
 #include <rmqio_serializedframe.h>
 
+#include <rmqamqpt_constants.h>
 #include <rmqamqpt_frame.h>
 
+#include <bsls_assert.h>
+
+#include <bsl_algorithm.h>
+
+
 namespace BloombergLP {
 namespace rmqio {
 
+const bsl::size_t SerializedFrame::k_INLINE_CAPACITY;
+
 SerializedFrame::SerializedFrame(const rmqamqpt::Frame& frame)
 : d_length(frame.totalFrameSize())
 , d_buffer(frame.serializedData())
+, d_offset(frame.dataOffset())
+, d_isView(false)
+, d_header()
+, d_payload(NULL)
+, d_payloadLength(0)
+, d_payloadOwner()
 {
 }
 
 SerializedFrame::SerializedFrame(const bsl::uint8_t* data, bsl::size_t length)
 : d_length(length)
-, d_buffer(bsl::make_shared<bsl::vector<bsl::uint8_t> >(data, data + length))
+, d_buffer()
+, d_offset(0)
+, d_isView(false)
+, d_header()
+, d_payload(NULL)
+, d_payloadLength(0)
+, d_payloadOwner()
 {
+    if (length <= k_INLINE_CAPACITY) {
+        bsl::copy(data, data + length, d_inline);
+    }
+    else {
+        d_buffer =
+            bsl::make_shared<bsl::vector<bsl::uint8_t> >(data, data + length);
+    }
 }
 
-bool SerializedFrame::operator==(const SerializedFrame& other) const
+SerializedFrame::SerializedFrame(
+    bsl::uint8_t type,
+    bsl::uint16_t channel,
+    const bsl::uint8_t* payload,
+    bsl::size_t payloadLength,
+    const bsl::shared_ptr<const void>& payloadOwner)
+: d_length(rmqamqpt::Frame::calculateFrameSize(payloadLength))
+, d_buffer()
+, d_offset(0)
+, d_isView(true)
+, d_header()
+, d_payload(payload)
+, d_payloadLength(payloadLength)
+, d_payloadOwner(payloadOwner)
 {
-    if (d_length != other.d_length) {
-        return false;
+    // Frame header: type (1 octet), channel (2 octets), size (4 octets), all
+    // big-endian
+    d_header[0] = type;
+    d_header[1] = static_cast<bsl::uint8_t>(channel >> 8);
+    d_header[2] = static_cast<bsl::uint8_t>(channel);
+    d_header[3] = static_cast<bsl::uint8_t>(payloadLength >> 24);
+    d_header[4] = static_cast<bsl::uint8_t>(payloadLength >> 16);
+    d_header[5] = static_cast<bsl::uint8_t>(payloadLength >> 8);
+    d_header[6] = static_cast<bsl::uint8_t>(payloadLength);
+}
+
+bsl::size_t SerializedFrame::numSegments() const
+{
+    if (!d_isView) {
+        return d_length == 0 ? 0 : 1;
     }
+    return d_payloadLength == 0 ? 2 : 3;
+}
+
+SerializedFrame::Segment SerializedFrame::segment(bsl::size_t index) const
+{
+    BSLS_ASSERT(index < numSegments());
 
-    if (!d_buffer || !other.d_buffer) {
-        return d_buffer == other.d_buffer;
+    if (!d_isView) {
+        return Segment(serialized(), d_length);
     }
 
-    return *d_buffer == *other.d_buffer;
+    if (index == 0) {
+        return Segment(d_header, k_HEADER_SIZE);
+    }
+
+    if (index == 1 && d_payloadLength != 0) {
+        return Segment(d_payload, d_payloadLength);
+    }
+
+    return Segment(&rmqamqpt::Constants::FRAME_END, 1);
 }
 
-bool SerializedFrame::operator!=(const SerializedFrame& other) const
+void SerializedFrame::copyTo(bsl::vector<bsl::uint8_t>* output) const
 {
-    if (d_length == other.d_length) {
+    output->reserve(output->size() + d_length);
+    for (bsl::size_t i = 0; i < numSegments(); ++i) {
+        const Segment seg = segment(i);
+        output->insert(output->end(), seg.first, seg.first + seg.second);
+    }
+}
+
+bool SerializedFrame::operator==(const SerializedFrame& other) const
+{
+    if (d_length != other.d_length) {
         return false;
     }
 
-    if (!d_buffer || !other.d_buffer) {
-        return d_buffer != other.d_buffer;
+    if (!d_isView && !other.d_isView) {
+        if (!serialized() || !other.serialized()) {
+            return serialized() == other.serialized();
+        }
+
+        return bsl::equal(
+            serialized(), serialized() + d_length, other.serialized());
     }
 
-    return *d_buffer != *other.d_buffer;
+    bsl::vector<bsl::uint8_t> lhs, rhs;
+    copyTo(&lhs);
+    other.copyTo(&rhs);
+    return lhs == rhs;
+}
+
+bool SerializedFrame::operator!=(const SerializedFrame& other) const
+{
+    return !(*this == other);
 }
 
 } // namespace rmqio
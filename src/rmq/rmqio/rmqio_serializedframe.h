@@ -23,23 +23,63 @@
 #include <bsl_cstddef.h>
 #include <bsl_cstdint.h>
 #include <bsl_memory.h>
+#include <bsl_utility.h>
 #include <bsl_vector.h>
 
 namespace BloombergLP {
 namespace rmqio {
 
+/// \brief Bytes of a single frame, ready to be written to the socket
+///
+/// A SerializedFrame is either contiguous (sharing the buffer of an
+/// rmqamqpt::Frame, or owning a copy of raw bytes, held inline for frames of
+/// up to `k_INLINE_CAPACITY` bytes such as acks), or a zero-copy view made
+/// of a frame header held inline, a payload referencing memory kept alive by
+/// `payloadOwner`, and the frame-end octet. Writers should iterate
+/// `segment(i)` for `i < numSegments()` to build gather buffers.
+
 class SerializedFrame {
   public:
+    /// A contiguous run of bytes making up part of the frame
+    typedef bsl::pair<const bsl::uint8_t*, bsl::size_t> Segment;
+
+    /// Enough for a basic.ack or basic.nack frame
+    static const bsl::size_t k_INLINE_CAPACITY = 24;
+
     explicit SerializedFrame(const rmqamqpt::Frame& frame);
+
+    /// Copy the `length` bytes at `data`, inline if they fit
     SerializedFrame(const bsl::uint8_t* data, bsl::size_t length);
 
+    /// Construct a frame of the given `type` on `channel` whose payload is
+    /// the `payloadLength` bytes at `payload`. The payload is not copied:
+    /// `payloadOwner` must keep it alive and unmodified.
+    SerializedFrame(bsl::uint8_t type,
+                    bsl::uint16_t channel,
+                    const bsl::uint8_t* payload,
+                    bsl::size_t payloadLength,
+                    const bsl::shared_ptr<const void>& payloadOwner);
+
     bsl::size_t frameLength() const { return d_length; }
 
+    /// Contiguous frame bytes. Returns NULL for empty frames and for
+    /// zero-copy views, which must be accessed through `segment`.
     const bsl::uint8_t* serialized() const
     {
-        return d_length == 0 ? NULL : d_buffer->data();
+        return d_length == 0 || d_isView ? NULL
+               : d_buffer                ? d_buffer->data() + d_offset
+                                         : d_inline;
     }
 
+    /// Number of contiguous segments making up this frame
+    bsl::size_t numSegments() const;
+
+    /// The `index`th segment of the frame, `index < numSegments()`
+    Segment segment(bsl::size_t index) const;
+
+    /// Append a copy of all frame bytes to `output`
+    void copyTo(bsl::vector<bsl::uint8_t>* output) const;
+
     bool operator==(const SerializedFrame&) const;
     bool operator!=(const SerializedFrame&) const;
 
@@ -48,8 +88,19 @@ class SerializedFrame {
     SerializedFrame(const SerializedFrame&) BSLS_KEYWORD_DELETED;
 
   private:
+    static const bsl::size_t k_HEADER_SIZE = 7;
+
     bsl::size_t d_length;
     bsl::shared_ptr<bsl::vector<bsl::uint8_t> > d_buffer;
+    bsl::size_t d_offset;
+    bool d_isView;
+    bsl::uint8_t d_header[k_HEADER_SIZE];
+    const bsl::uint8_t* d_payload;
+    bsl::size_t d_payloadLength;
+    bsl::shared_ptr<const void> d_payloadOwner;
+
+    /// The bytes of a small contiguous frame, used when `d_buffer` is null
+    bsl::uint8_t d_inline[k_INLINE_CAPACITY];
 };
 
 } // namespace rmqio
@@ -0,0 +1,240 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqio_stalldetector.h>
+
+#include <rmqio_eventloop.h>
+#include <rmqt_log.h>
+
+#include <ball_log.h>
+#include <bdlf_bind.h>
+#include <bslmt_lockguard.h>
+#include <bslmt_threadattributes.h>
+#include <bsls_platform.h>
+#include <bsls_systemclocktype.h>
+#include <bsls_systemtime.h>
+
+#ifdef BSLS_PLATFORM_OS_LINUX
+#include <execinfo.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#endif
+
+namespace BloombergLP {
+namespace rmqio {
+namespace {
+BALL_LOG_SET_NAMESPACE_CATEGORY("RMQIO.STALLDETECTOR")
+
+const char* THREAD_NAME = "RMQIO.STALLS";
+
+#ifdef BSLS_PLATFORM_OS_LINUX
+const int MAX_FRAMES = 64;
+
+/// How long to wait for the stalled thread to run the signal handler
+const bsls::Types::Int64 CAPTURE_TIMEOUT_NS = 100 * 1000 * 1000;
+
+// Filled in by the signal handler, on the stalled thread
+void* s_frames[MAX_FRAMES];
+bsls::AtomicInt s_frameCount;
+bsls::AtomicBool s_captured;
+
+// One capture at a time, whichever detector asks
+bslmt::Mutex s_captureMutex;
+
+void onStackCaptureSignal(int)
+{
+    s_frameCount.storeRelaxed(backtrace(s_frames, MAX_FRAMES));
+    s_captured.store(true);
+}
+#endif
+
+} // namespace
+
+StallDetector::StallDetector(EventLoop& eventLoop,
+                             const bsls::TimeInterval& threshold,
+                             const StallCallback& onStall)
+: d_eventLoop(eventLoop)
+, d_threshold(threshold)
+, d_onStall(onStall)
+, d_stackSignal(0)
+, d_beats(bsl::make_shared<Beats>())
+, d_thread()
+, d_running(false)
+, d_stopping(false)
+, d_mutex()
+, d_condition(bsls::SystemClockType::e_MONOTONIC)
+{
+}
+
+StallDetector::~StallDetector() { stop(); }
+
+bool StallDetector::setStackCaptureSignal(int signalNumber)
+{
+#ifdef BSLS_PLATFORM_OS_LINUX
+    // The first call loads the unwinder, which must not happen in a handler
+    void* warmUp[1];
+    backtrace(warmUp, 1);
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = &onStackCaptureSignal;
+    action.sa_flags   = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(signalNumber, &action, 0) != 0) {
+        BALL_LOG_WARN << "Failed to install the stack capture handler for "
+                         "signal "
+                      << signalNumber;
+        return false;
+    }
+    d_stackSignal = signalNumber;
+    return true;
+#else
+    (void)signalNumber;
+    BALL_LOG_WARN << "Capturing the event loop's stack on stalls is not "
+                     "supported on this platform";
+    return false;
+#endif
+}
+
+int StallDetector::start()
+{
+    bslmt::ThreadAttributes attributes;
+    attributes.setThreadName(THREAD_NAME);
+
+    const int rc = bslmt::ThreadUtil::create(
+        &d_thread,
+        attributes,
+        bdlf::BindUtil::bind(&StallDetector::monitor, this));
+    if (rc) {
+        BALL_LOG_ERROR << "Couldn't start the stall detector thread. Error "
+                          "code: "
+                       << rc;
+        return rc;
+    }
+    d_running = true;
+    return 0;
+}
+
+void StallDetector::stop()
+{
+    if (!d_running) {
+        return;
+    }
+    {
+        bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+        d_stopping = true;
+    }
+    d_condition.signal();
+    bslmt::ThreadUtil::join(d_thread);
+    d_running = false;
+}
+
+void StallDetector::beat(const bsl::shared_ptr<Beats>& beats,
+                         bsls::Types::Int64 sequence)
+{
+    beats->servicedAtNs.store(
+        bsls::SystemTime::nowMonotonicClock().totalNanoseconds());
+    beats->serviced.store(sequence);
+}
+
+void StallDetector::monitor()
+{
+    const bsls::TimeInterval period =
+        bsls::TimeInterval().addNanoseconds(d_threshold.totalNanoseconds() /
+                                            2);
+
+    bsls::Types::Int64 sequence = 0;
+    bsls::TimeInterval postedAt;
+    bool outstanding = false;
+    bool reported    = false;
+
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    while (!d_stopping) {
+        const bsls::TimeInterval now = bsls::SystemTime::nowMonotonicClock();
+
+        if (outstanding && d_beats->serviced.load() >= sequence) {
+            outstanding = false;
+            if (reported) {
+                Stall stall;
+                stall.duration.addNanoseconds(d_beats->servicedAtNs.load() -
+                                              postedAt.totalNanoseconds());
+                d_onStall(stall);
+                reported = false;
+            }
+        }
+
+        if (!outstanding) {
+            ++sequence;
+            postedAt    = now;
+            outstanding = true;
+            d_eventLoop.post(bdlf::BindUtil::bind(&beat, d_beats, sequence));
+        }
+        else if (!reported && now - postedAt >= d_threshold) {
+            Stall stall;
+            stall.duration = now - postedAt;
+            stall.ongoing  = true;
+            stall.stack    = captureStack();
+            d_onStall(stall);
+            reported = true;
+        }
+
+        d_condition.timedWait(&d_mutex, now + period);
+    }
+}
+
+bsl::string StallDetector::captureStack()
+{
+    bsl::string stack;
+#ifdef BSLS_PLATFORM_OS_LINUX
+    if (!d_stackSignal) {
+        return stack;
+    }
+
+    bslmt::LockGuard<bslmt::Mutex> guard(&s_captureMutex);
+    s_captured.store(false);
+    if (pthread_kill(d_eventLoop.threadHandle(), d_stackSignal) != 0) {
+        return stack;
+    }
+
+    const bsls::Types::Int64 deadline =
+        bsls::SystemTime::nowMonotonicClock().totalNanoseconds() +
+        CAPTURE_TIMEOUT_NS;
+    while (!s_captured.load()) {
+        if (bsls::SystemTime::nowMonotonicClock().totalNanoseconds() >
+            deadline) {
+            RMQT_LOG_DEBUG << "Event loop thread did not report its stack";
+            return stack;
+        }
+        bslmt::ThreadUtil::microSleep(1000);
+    }
+
+    const int frames = s_frameCount.loadRelaxed();
+    char** symbols   = backtrace_symbols(s_frames, frames);
+    if (!symbols) {
+        return stack;
+    }
+    for (int i = 0; i < frames; ++i) {
+        stack += symbols[i];
+        stack += '\n';
+    }
+    free(symbols);
+#endif
+    return stack;
+}
+
+} // namespace rmqio
+} // namespace BloombergLP
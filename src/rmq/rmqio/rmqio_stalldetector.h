@@ -0,0 +1,134 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQIO_STALLDETECTOR
+#define INCLUDED_RMQIO_STALLDETECTOR
+
+#include <bslmt_condition.h>
+#include <bslmt_mutex.h>
+#include <bslmt_threadutil.h>
+#include <bsls_atomic.h>
+#include <bsls_keyword.h>
+#include <bsls_timeinterval.h>
+#include <bsls_types.h>
+
+#include <bsl_functional.h>
+#include <bsl_memory.h>
+#include <bsl_string.h>
+
+//@PURPOSE: Detect an event loop thread which stops servicing its work
+//
+//@CLASSES:
+//  rmqio::StallDetector: Times heartbeats posted to an event loop from a
+//  thread of its own
+
+namespace BloombergLP {
+namespace rmqio {
+class EventLoop;
+
+/// \brief Reports when an event loop takes longer than `threshold` to run a
+/// heartbeat posted to it
+///
+/// Tasks run by a `WatchDog` run on the event loop, so cannot notice the
+/// loop itself being blocked, e.g. by a slow inline consumer callback, a TLS
+/// handshake or replaying a large topology. A StallDetector posts a
+/// heartbeat to the loop from its own monitor thread, and checks on it
+/// every `threshold / 2`. Once a heartbeat has waited `threshold`, the
+/// callback is invoked with `ongoing` set, and once more with the total
+/// stall when the heartbeat finally runs. The callback runs on the monitor
+/// thread.
+///
+/// With `setStackCaptureSignal`, the first report of a stall also carries
+/// the loop thread's stack, which is where the loop is stuck (Linux only).
+
+class StallDetector {
+  public:
+    struct Stall {
+        /// How long the heartbeat has waited, or waited in all once it ran
+        bsls::TimeInterval duration;
+
+        /// True while the loop has still not run the heartbeat
+        bool ongoing;
+
+        /// The loop thread's stack, one frame per line, if captured
+        bsl::string stack;
+
+        Stall()
+        : duration()
+        , ongoing(false)
+        , stack()
+        {
+        }
+    };
+
+    typedef bsl::function<void(const Stall&)> StallCallback;
+
+    StallDetector(EventLoop& eventLoop,
+                  const bsls::TimeInterval& threshold,
+                  const StallCallback& onStall);
+
+    /// Stops the monitor thread
+    ~StallDetector();
+
+    /// Capture the event loop thread's stack on stalls by sending it
+    /// `signalNumber`, which the process must not use for anything else.
+    /// The handler is installed with SA_RESTART, but a system call the loop
+    /// is blocked in may still return early with EINTR. Call before `start`.
+    /// Return false, capturing nothing, where not supported.
+    bool setStackCaptureSignal(int signalNumber);
+
+    /// Start the monitor thread. The event loop must be started. Return 0
+    /// on success.
+    int start();
+
+    /// Stop and join the monitor thread. Heartbeats already posted still
+    /// run, harmlessly.
+    void stop();
+
+  private:
+    StallDetector(const StallDetector&) BSLS_KEYWORD_DELETED;
+    StallDetector& operator=(const StallDetector&) BSLS_KEYWORD_DELETED;
+
+    /// Written by the heartbeats, which may outlive the detector
+    struct Beats {
+        bsls::AtomicInt64 serviced;       ///< Latest heartbeat run
+        bsls::AtomicInt64 servicedAtNs;   ///< When it ran, monotonic
+    };
+
+    static void beat(const bsl::shared_ptr<Beats>& beats,
+                     bsls::Types::Int64 sequence);
+
+    void monitor();
+
+    /// Return the loop thread's stack, or empty if not captured
+    bsl::string captureStack();
+
+    EventLoop& d_eventLoop;
+    const bsls::TimeInterval d_threshold;
+    StallCallback d_onStall;
+    int d_stackSignal;
+    bsl::shared_ptr<Beats> d_beats;
+
+    bslmt::ThreadUtil::Handle d_thread;
+    bool d_running;
+    bool d_stopping; ///< Guarded by `d_mutex`
+    bslmt::Mutex d_mutex;
+    bslmt::Condition d_condition;
+};
+
+} // namespace rmqio
+} // namespace BloombergLP
+
+#endif
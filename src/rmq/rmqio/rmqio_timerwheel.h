@@ -0,0 +1,513 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQIO_TIMERWHEEL
+#define INCLUDED_RMQIO_TIMERWHEEL
+
+#include <rmqio_asioeventloop.h>
+#include <rmqio_coarseclock.h>
+#include <rmqio_timer.h>
+
+#include <boost/asio.hpp>
+
+#include <ball_log.h>
+#include <bdlf_bind.h>
+#include <bsls_assert.h>
+#include <bsls_keyword.h>
+#include <bsls_timeinterval.h>
+#include <bsls_types.h>
+
+#include <bsl_algorithm.h>
+#include <bsl_cstddef.h>
+#include <bsl_memory.h>
+#include <bsl_vector.h>
+
+namespace BloombergLP {
+namespace rmqio {
+
+//@PURPOSE: Timer implementation sharing one ASIO deadline_timer per loop
+//
+//@CLASSES:
+//  rmqio::TimerWheel: A hashed timer wheel driven by a single deadline_timer
+//
+//  rmqio::TimerWheelTimer: A Timer armed on a TimerWheel
+//
+//  rmqio::TimerWheelFactory: Provides a factory for creating TimerWheelTimers
+
+/// \brief A hashed timer wheel, with O(1) arm and disarm
+///
+/// Time is divided into ticks of `tick`. An entry armed to expire in tick
+/// `n` is linked into slot `n % slots`; each tick the wheel expires the
+/// entries of the slot which are due, leaving those due in a later
+/// revolution. A single deadline_timer fires once per tick while anything is
+/// armed, and not at all otherwise.
+///
+/// Entries never expire early, but may expire up to one tick late. Must be
+/// owned by a shared_ptr, and only be used from the event loop thread.
+
+template <typename TIME        = boost::asio::deadline_timer::time_type,
+          typename TIME_TRAITS = boost::asio::time_traits<TIME> >
+class basic_TimerWheel
+: public bsl::enable_shared_from_this<basic_TimerWheel<TIME, TIME_TRAITS> > {
+  public:
+    /// An intrusive node linking an armed timer into its slot
+    class Entry {
+      public:
+        Entry()
+        : d_prev(0)
+        , d_next(0)
+        , d_list(0)
+        , d_dueTick(0)
+        {
+        }
+
+        virtual ~Entry() {}
+
+        bool armed() const { return d_list != 0; }
+
+        /// Invoked when the entry is due, after it is disarmed. The entry
+        /// may be re-armed or destroyed from here.
+        virtual void expire() = 0;
+
+      private:
+        friend class basic_TimerWheel;
+
+        Entry* d_prev;
+        Entry* d_next;
+        Entry** d_list;
+        bsls::Types::Uint64 d_dueTick;
+    };
+
+    static const bsl::size_t k_DEFAULT_SLOTS = 512;
+
+    basic_TimerWheel(boost::asio::io_context& context,
+                     const bsls::TimeInterval& tick,
+                     bsl::size_t slots = k_DEFAULT_SLOTS);
+
+    /// Arm `entry`, which must not be armed, to expire after `timeout`
+    void arm(Entry* entry, const bsls::TimeInterval& timeout);
+
+    /// Disarm `entry` without expiring it. No effect if it is not armed.
+    void disarm(Entry* entry);
+
+    boost::asio::io_context& context() { return d_context; }
+
+    /// Return the number of armed entries
+    bsl::size_t armedCount() const { return d_armedCount; }
+
+  private:
+    basic_TimerWheel(basic_TimerWheel&) BSLS_KEYWORD_DELETED;
+    basic_TimerWheel& operator=(const basic_TimerWheel&) BSLS_KEYWORD_DELETED;
+
+    static void
+    handleTick(bsl::weak_ptr<basic_TimerWheel<TIME, TIME_TRAITS> > wheel,
+               const boost::system::error_code& error);
+
+    void onTick();
+    void scheduleTick();
+
+    /// Return the number of whole ticks from the origin until `time`
+    bsls::Types::Uint64 ticksUntil(const TIME& time) const;
+
+    static void link(Entry** list, Entry* entry);
+    static void unlink(Entry* entry);
+
+    boost::asio::io_context& d_context;
+    boost::asio::basic_deadline_timer<TIME, TIME_TRAITS> d_timer;
+    const TIME d_origin;
+    const bsls::Types::Int64 d_tickMicroseconds;
+    bsl::vector<Entry*> d_slots;
+    Entry* d_expiring;
+    bsls::Types::Uint64 d_nextTick;
+    bsl::size_t d_armedCount;
+    bool d_waiting;
+    bool d_ticking;
+};
+
+typedef basic_TimerWheel<> TimerWheel;
+
+/// \brief A Timer armed on a TimerWheel, behaving as an AsioTimer does
+template <typename TIME        = boost::asio::deadline_timer::time_type,
+          typename TIME_TRAITS = boost::asio::time_traits<TIME> >
+class basic_TimerWheelTimer
+: public Timer,
+  public basic_TimerWheel<TIME, TIME_TRAITS>::Entry,
+  public bsl::enable_shared_from_this<
+      basic_TimerWheelTimer<TIME, TIME_TRAITS> > {
+  public:
+    typedef basic_TimerWheel<TIME, TIME_TRAITS> Wheel;
+
+    basic_TimerWheelTimer(const bsl::shared_ptr<Wheel>& wheel,
+                          const bsls::TimeInterval& timeout);
+    basic_TimerWheelTimer(const bsl::shared_ptr<Wheel>& wheel,
+                          const Timer::Callback& callback);
+    virtual ~basic_TimerWheelTimer() BSLS_KEYWORD_OVERRIDE;
+    virtual void reset(const bsls::TimeInterval& timeout) BSLS_KEYWORD_OVERRIDE;
+    virtual void cancel() BSLS_KEYWORD_OVERRIDE;
+    virtual void resetCallback(const Callback& callback) BSLS_KEYWORD_OVERRIDE;
+    virtual void start(const Timer::Callback& callback) BSLS_KEYWORD_OVERRIDE;
+    virtual void expire() BSLS_KEYWORD_OVERRIDE;
+
+  private:
+    basic_TimerWheelTimer(basic_TimerWheelTimer&) BSLS_KEYWORD_DELETED;
+    basic_TimerWheelTimer&
+    operator=(const basic_TimerWheelTimer&) BSLS_KEYWORD_DELETED;
+
+    static void handleCancel(
+        bsl::weak_ptr<basic_TimerWheelTimer<TIME, TIME_TRAITS> > timer,
+        const Timer::Callback callback);
+
+    /// Disarm the timer, posting its callback with CANCEL if it was armed
+    void cancelPending();
+    void arm();
+
+    bsl::shared_ptr<Wheel> d_wheel;
+    Timer::Callback d_callback;
+    Timer::Callback d_armedCallback;
+    bsls::TimeInterval d_timeout;
+    BALL_LOG_SET_CLASS_CATEGORY("RMQIO.TIMERWHEELTIMER");
+};
+
+typedef basic_TimerWheelTimer<> TimerWheelTimer;
+
+template <typename TIME        = boost::asio::deadline_timer::time_type,
+          typename TIME_TRAITS = boost::asio::time_traits<TIME> >
+class basic_TimerWheelFactory : public TimerFactory {
+  public:
+    typedef basic_TimerWheel<TIME, TIME_TRAITS> Wheel;
+
+    /// Create timers on one wheel of `slots` slots of `tick`, driven by
+    /// `eventLoop`
+    basic_TimerWheelFactory(rmqio::AsioEventLoop& eventLoop,
+                            const bsls::TimeInterval& tick,
+                            bsl::size_t slots = Wheel::k_DEFAULT_SLOTS);
+    virtual ~basic_TimerWheelFactory() BSLS_KEYWORD_OVERRIDE {}
+
+    virtual bsl::shared_ptr<rmqio::Timer>
+    createWithTimeout(const bsls::TimeInterval& timeout) BSLS_KEYWORD_OVERRIDE;
+
+    virtual bsl::shared_ptr<rmqio::Timer>
+    createWithCallback(const Timer::Callback& callback) BSLS_KEYWORD_OVERRIDE;
+
+  private:
+    bsl::shared_ptr<Wheel> d_wheel;
+};
+
+typedef basic_TimerWheelFactory<> TimerWheelFactory;
+
+template <typename T, typename TT>
+const bsl::size_t basic_TimerWheel<T, TT>::k_DEFAULT_SLOTS;
+
+template <typename T, typename TT>
+basic_TimerWheel<T, TT>::basic_TimerWheel(boost::asio::io_context& context,
+                                          const bsls::TimeInterval& tick,
+                                          bsl::size_t slots)
+: d_context(context)
+, d_timer(context)
+, d_origin(TT::now())
+, d_tickMicroseconds(bsl::max(tick.totalMicroseconds(),
+                              static_cast<bsls::Types::Int64>(1)))
+, d_slots(bsl::max(slots, bsl::size_t(1)), 0)
+, d_expiring(0)
+, d_nextTick(1)
+, d_armedCount(0)
+, d_waiting(false)
+, d_ticking(false)
+{
+}
+
+template <typename T, typename TT>
+void basic_TimerWheel<T, TT>::arm(Entry* entry,
+                                  const bsls::TimeInterval& timeout)
+{
+    BSLS_ASSERT(!entry->armed());
+
+    const T now     = TT::now();
+    const bool idle = !d_waiting && !d_ticking;
+    if (idle) {
+        // Skip the ticks which passed with nothing armed
+        d_nextTick = bsl::max(d_nextTick, ticksUntil(now) + 1);
+    }
+
+    // Round up, so that the entry never expires early
+    const bsls::Types::Int64 dueMicroseconds =
+        bsl::max(TT::subtract(now, d_origin).total_microseconds(),
+                 static_cast<bsls::Types::Int64>(0)) +
+        bsl::max(timeout.totalMicroseconds(),
+                 static_cast<bsls::Types::Int64>(0));
+    const bsls::Types::Uint64 dueTick =
+        (dueMicroseconds + d_tickMicroseconds - 1) / d_tickMicroseconds;
+
+    entry->d_dueTick = bsl::max(dueTick, d_nextTick);
+    link(&d_slots[entry->d_dueTick % d_slots.size()], entry);
+    ++d_armedCount;
+
+    if (idle) {
+        scheduleTick();
+    }
+}
+
+template <typename T, typename TT>
+void basic_TimerWheel<T, TT>::disarm(Entry* entry)
+{
+    if (entry->armed()) {
+        unlink(entry);
+        --d_armedCount;
+    }
+}
+
+template <typename T, typename TT>
+void basic_TimerWheel<T, TT>::handleTick(
+    bsl::weak_ptr<basic_TimerWheel<T, TT> > wheel,
+    const boost::system::error_code& error)
+{
+    CoarseClock::tick();
+
+    if (error) {
+        // The wheel is being destroyed
+        return;
+    }
+
+    bsl::shared_ptr<basic_TimerWheel<T, TT> > w = wheel.lock();
+    if (w) {
+        w->onTick();
+    }
+}
+
+template <typename T, typename TT>
+void basic_TimerWheel<T, TT>::onTick()
+{
+    d_waiting = false;
+
+    const bsls::Types::Uint64 nowTick = ticksUntil(TT::now());
+    if (nowTick >= d_nextTick) {
+        // Visit each slot at most once, however many ticks were missed
+        const bsls::Types::Uint64 lastTick =
+            bsl::min(nowTick, d_nextTick + d_slots.size() - 1);
+        for (bsls::Types::Uint64 tick = d_nextTick; tick <= lastTick;
+             ++tick) {
+            Entry* entry = d_slots[tick % d_slots.size()];
+            while (entry) {
+                Entry* next = entry->d_next;
+                if (entry->d_dueTick <= nowTick) {
+                    unlink(entry);
+                    link(&d_expiring, entry);
+                }
+                entry = next;
+            }
+        }
+        d_nextTick = nowTick + 1;
+    }
+
+    // Expiring entries stay linked until expired, so that an earlier
+    // callback can still disarm or destroy them
+    d_ticking = true;
+    while (d_expiring) {
+        Entry* entry = d_expiring;
+        unlink(entry);
+        --d_armedCount;
+        entry->expire();
+    }
+    d_ticking = false;
+
+    if (d_armedCount > 0) {
+        scheduleTick();
+    }
+}
+
+template <typename T, typename TT>
+void basic_TimerWheel<T, TT>::scheduleTick()
+{
+    d_timer.expires_at(TT::add(
+        d_origin,
+        boost::posix_time::microseconds(d_tickMicroseconds * d_nextTick)));
+    d_timer.async_wait(
+        bdlf::BindUtil::bind(&basic_TimerWheel<T, TT>::handleTick,
+                             this->weak_from_this(),
+                             bdlf::PlaceHolders::_1));
+    d_waiting = true;
+}
+
+template <typename T, typename TT>
+bsls::Types::Uint64 basic_TimerWheel<T, TT>::ticksUntil(const T& time) const
+{
+    const bsls::Types::Int64 elapsed =
+        TT::subtract(time, d_origin).total_microseconds();
+    return elapsed > 0 ? elapsed / d_tickMicroseconds : 0;
+}
+
+template <typename T, typename TT>
+void basic_TimerWheel<T, TT>::link(Entry** list, Entry* entry)
+{
+    entry->d_list = list;
+    entry->d_prev = 0;
+    entry->d_next = *list;
+    if (*list) {
+        (*list)->d_prev = entry;
+    }
+    *list = entry;
+}
+
+template <typename T, typename TT>
+void basic_TimerWheel<T, TT>::unlink(Entry* entry)
+{
+    if (entry->d_prev) {
+        entry->d_prev->d_next = entry->d_next;
+    }
+    else {
+        *entry->d_list = entry->d_next;
+    }
+    if (entry->d_next) {
+        entry->d_next->d_prev = entry->d_prev;
+    }
+    entry->d_prev = 0;
+    entry->d_next = 0;
+    entry->d_list = 0;
+}
+
+template <typename T, typename TT>
+basic_TimerWheelTimer<T, TT>::basic_TimerWheelTimer(
+    const bsl::shared_ptr<Wheel>& wheel,
+    const bsls::TimeInterval& timeout)
+: Timer()
+, d_wheel(wheel)
+, d_callback()
+, d_armedCallback()
+, d_timeout(timeout)
+{
+}
+
+template <typename T, typename TT>
+basic_TimerWheelTimer<T, TT>::basic_TimerWheelTimer(
+    const bsl::shared_ptr<Wheel>& wheel,
+    const Timer::Callback& callback)
+: Timer()
+, d_wheel(wheel)
+, d_callback(callback)
+, d_armedCallback()
+, d_timeout()
+{
+}
+
+template <typename T, typename TT>
+basic_TimerWheelTimer<T, TT>::~basic_TimerWheelTimer()
+{
+    d_wheel->disarm(this);
+}
+
+template <typename T, typename TT>
+void basic_TimerWheelTimer<T, TT>::reset(const bsls::TimeInterval& timeout)
+{
+    if (!d_callback) {
+        BALL_LOG_ERROR << "reset() called before start()";
+        return;
+    }
+    d_timeout = timeout;
+    cancelPending();
+    arm();
+}
+
+template <typename T, typename TT>
+void basic_TimerWheelTimer<T, TT>::cancel()
+{
+    cancelPending();
+}
+
+template <typename T, typename TT>
+void basic_TimerWheelTimer<T, TT>::resetCallback(const Callback& callback)
+{
+    d_callback = callback;
+}
+
+template <typename T, typename TT>
+void basic_TimerWheelTimer<T, TT>::start(const Timer::Callback& callback)
+{
+    d_callback = callback;
+    cancelPending();
+    arm();
+}
+
+template <typename T, typename TT>
+void basic_TimerWheelTimer<T, TT>::expire()
+{
+    // The callback may destroy this timer
+    const Timer::Callback callback = d_armedCallback;
+    callback(Timer::EXPIRE);
+}
+
+template <typename T, typename TT>
+void basic_TimerWheelTimer<T, TT>::handleCancel(
+    bsl::weak_ptr<basic_TimerWheelTimer<T, TT> > timer,
+    const Timer::Callback callback)
+{
+    if (timer.lock()) {
+        callback(Timer::CANCEL);
+    }
+}
+
+template <typename T, typename TT>
+void basic_TimerWheelTimer<T, TT>::cancelPending()
+{
+    if (!this->armed()) {
+        return;
+    }
+    d_wheel->disarm(this);
+
+    // Delivered from the event loop, as a cancelled AsioTimer's is
+    boost::asio::post(
+        d_wheel->context(),
+        bdlf::BindUtil::bind(&basic_TimerWheelTimer<T, TT>::handleCancel,
+                             this->weak_from_this(),
+                             d_armedCallback));
+}
+
+template <typename T, typename TT>
+void basic_TimerWheelTimer<T, TT>::arm()
+{
+    d_armedCallback = d_callback;
+    d_wheel->arm(this, d_timeout);
+}
+
+template <typename T, typename TT>
+basic_TimerWheelFactory<T, TT>::basic_TimerWheelFactory(
+    rmqio::AsioEventLoop& eventLoop,
+    const bsls::TimeInterval& tick,
+    bsl::size_t slots)
+: d_wheel(bsl::make_shared<Wheel>(bsl::ref(eventLoop.context()), tick, slots))
+{
+}
+
+template <typename T, typename TT>
+bsl::shared_ptr<rmqio::Timer>
+basic_TimerWheelFactory<T, TT>::createWithTimeout(
+    const bsls::TimeInterval& timeout)
+{
+    return bsl::make_shared<rmqio::basic_TimerWheelTimer<T, TT> >(d_wheel,
+                                                                 timeout);
+}
+
+template <typename T, typename TT>
+bsl::shared_ptr<rmqio::Timer>
+basic_TimerWheelFactory<T, TT>::createWithCallback(
+    const Timer::Callback& callback)
+{
+    return bsl::make_shared<rmqio::basic_TimerWheelTimer<T, TT> >(d_wheel,
+                                                                 callback);
+}
+
+} // namespace rmqio
+} // namespace BloombergLP
+
+#endif
@@ -0,0 +1,134 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqio_tlshandshakepool.h>
+
+#include <ball_log.h>
+#include <bdlf_bind.h>
+#include <bdlf_placeholder.h>
+#include <bsls_atomic.h>
+
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+
+namespace BloombergLP {
+namespace rmqio {
+namespace {
+
+BALL_LOG_SET_NAMESPACE_CATEGORY("RMQIO.TLSHANDSHAKEPOOL")
+
+/// A handshake given to the pool, and the timer abandoning it
+struct PendingHandshake {
+    explicit PendingHandshake(
+        const bsl::shared_ptr<AsioSecureSocketWrapper>& socket)
+    : socket(socket)
+    , timer(socket->lowest_layer().get_executor())
+    , finished(false)
+    {
+    }
+
+    bsl::shared_ptr<AsioSecureSocketWrapper> socket;
+    boost::asio::steady_timer timer;
+    bsls::AtomicBool finished;
+};
+
+void handshakeDone(const boost::system::error_code& error,
+                   const bsl::shared_ptr<PendingHandshake>& pending,
+                   const TlsHandshakePool::HandshakeCallback& callback)
+{
+    pending->timer.cancel();
+    callback(error);
+}
+
+void runHandshake(const bsl::shared_ptr<PendingHandshake>& pending,
+                  const TlsHandshakePool::HandshakeCallback& callback)
+{
+    // The event loop thread leaves the socket alone until `handshakeDone`,
+    // apart from shutting it down on timeout, which only wakes this thread
+    boost::system::error_code error;
+    pending->socket->socket().handshake(boost::asio::ssl::stream_base::client,
+                                        error);
+    pending->finished = true;
+
+    boost::asio::post(
+        pending->socket->lowest_layer().get_executor(),
+        bdlf::BindUtil::bind(&handshakeDone, error, pending, callback));
+}
+
+void handshakeTimedOut(const boost::system::error_code& error,
+                       const bsl::weak_ptr<PendingHandshake>& weakPending)
+{
+    bsl::shared_ptr<PendingHandshake> pending = weakPending.lock();
+    if (error == boost::asio::error::operation_aborted || !pending ||
+        pending->finished) {
+        return;
+    }
+
+    BALL_LOG_WARN << "TLS handshake timed out, shutting down its socket";
+    boost::system::error_code ignored;
+    pending->socket->lowest_layer().shutdown(
+        boost::asio::ip::tcp::socket::shutdown_both, ignored);
+}
+
+} // namespace
+
+TlsHandshakePool::TlsHandshakePool(const bslmt::ThreadAttributes& attributes,
+                                   bsl::size_t numThreads,
+                                   const bsls::TimeInterval& timeout)
+: d_numThreads(numThreads)
+, d_timeout(timeout)
+, d_threadPool(attributes,
+               static_cast<int>(numThreads),
+               static_cast<int>(numThreads),
+               0)
+{
+}
+
+TlsHandshakePool::~TlsHandshakePool() { shutdown(); }
+
+int TlsHandshakePool::start() { return d_threadPool.start(); }
+
+void TlsHandshakePool::shutdown() { d_threadPool.shutdown(); }
+
+void TlsHandshakePool::handshake(
+    const bsl::shared_ptr<AsioSecureSocketWrapper>& socket,
+    const HandshakeCallback& callback)
+{
+    bsl::shared_ptr<PendingHandshake> pending =
+        bsl::make_shared<PendingHandshake>(socket);
+
+    if (d_timeout > bsls::TimeInterval()) {
+        pending->timer.expires_after(
+            boost::asio::chrono::microseconds(d_timeout.totalMicroseconds()));
+        pending->timer.async_wait(
+            bdlf::BindUtil::bind(&handshakeTimedOut,
+                                 bdlf::PlaceHolders::_1,
+                                 bsl::weak_ptr<PendingHandshake>(pending)));
+    }
+
+    if (d_threadPool.enqueueJob(
+            bdlf::BindUtil::bind(&runHandshake, pending, callback)) != 0) {
+        BALL_LOG_ERROR << "TLS handshake pool is not running";
+        pending->timer.cancel();
+        boost::asio::post(
+            socket->lowest_layer().get_executor(),
+            bdlf::BindUtil::bind(
+                callback,
+                boost::system::error_code(boost::asio::error::shut_down)));
+    }
+}
+
+} // namespace rmqio
+} // namespace BloombergLP
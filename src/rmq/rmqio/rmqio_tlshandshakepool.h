@@ -0,0 +1,94 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQIO_TLSHANDSHAKEPOOL
+#define INCLUDED_RMQIO_TLSHANDSHAKEPOOL
+
+#include <rmqio_asiosocketwrapper.h>
+
+#include <bdlmt_threadpool.h>
+#include <bslmt_threadattributes.h>
+#include <bsls_keyword.h>
+#include <bsls_timeinterval.h>
+
+#include <boost/system/error_code.hpp>
+
+#include <bsl_cstddef.h>
+#include <bsl_functional.h>
+#include <bsl_memory.h>
+
+//@PURPOSE: Run TLS client handshakes off the event loop thread
+//
+//@CLASSES:
+//  rmqio::TlsHandshakePool: Threads running blocking TLS handshakes
+
+namespace BloombergLP {
+namespace rmqio {
+
+/// \brief Threads which run TLS client handshakes for secure connections
+///
+/// A full handshake's key exchange and certificate checks take
+/// milliseconds of CPU. After a broker restart hundreds of connections
+/// handshake at once, and on the event loop thread that holds up the frames
+/// of every healthy connection sharing it. A connection given to this pool
+/// instead handshakes with a blocking handshake on one of its threads, so
+/// at most `numThreads` handshakes run at once and the rest queue. The
+/// event loop does not touch the socket until the outcome is posted back
+/// to the socket's executor.
+///
+/// A handshake still running after `timeout` has its socket shut down,
+/// which fails it and frees its thread. One pool is shared by all the
+/// connections of a RabbitContext, across event loop threads.
+
+class TlsHandshakePool {
+  public:
+    typedef bsl::function<void(const boost::system::error_code&)>
+        HandshakeCallback;
+
+    TlsHandshakePool(const bslmt::ThreadAttributes& attributes,
+                     bsl::size_t numThreads,
+                     const bsls::TimeInterval& timeout);
+
+    /// Abandons queued handshakes
+    ~TlsHandshakePool();
+
+    /// Start the threads. Return 0 on success.
+    int start();
+
+    /// Abandon queued handshakes, which then never complete, and wait for
+    /// those running to finish
+    void shutdown();
+
+    /// Handshake `socket` as a client on one of the pool's threads, then
+    /// post `callback` with the outcome to the socket's executor. Called on
+    /// that executor, i.e. the socket's event loop thread.
+    void handshake(const bsl::shared_ptr<AsioSecureSocketWrapper>& socket,
+                   const HandshakeCallback& callback);
+
+    bsl::size_t numThreads() const { return d_numThreads; }
+
+  private:
+    TlsHandshakePool(const TlsHandshakePool&) BSLS_KEYWORD_DELETED;
+    TlsHandshakePool& operator=(const TlsHandshakePool&) BSLS_KEYWORD_DELETED;
+
+    bsl::size_t d_numThreads;
+    bsls::TimeInterval d_timeout;
+    bdlmt::ThreadPool d_threadPool;
+};
+
+} // namespace rmqio
+} // namespace BloombergLP
+
+#endif
@@ -0,0 +1,181 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <rmqio_tlssessioncache.h>
+
+#include <rmqt_log.h>
+
+#include <ball_log.h>
+#include <bslmt_lockguard.h>
+
+#include <bsl_ctime.h>
+
+namespace BloombergLP {
+namespace rmqio {
+
+namespace {
+
+BALL_LOG_SET_NAMESPACE_CATEGORY("RMQIO.TLSSESSIONCACHE")
+
+/// Attached to each prepared connection, and freed along with it
+struct Binding {
+    bsl::shared_ptr<TlsSessionCache> cache;
+    bsl::string endpoint;
+};
+
+void freeBinding(void* /* parent */,
+                 void* binding,
+                 CRYPTO_EX_DATA* /* data */,
+                 int /* index */,
+                 long /* argl */,
+                 void* /* argp */)
+{
+    delete static_cast<Binding*>(binding);
+}
+
+int bindingIndex()
+{
+    static const int index =
+        SSL_get_ex_new_index(0, NULL, NULL, NULL, &freeBinding);
+    return index;
+}
+
+bool hasExpired(const SSL_SESSION* session)
+{
+    return SSL_SESSION_get_time(session) + SSL_SESSION_get_timeout(session) <
+           bsl::time(NULL);
+}
+
+} // namespace
+
+TlsSessionCache::Stats::Stats()
+: resumedHandshakes(0)
+, fullHandshakes(0)
+{
+}
+
+TlsSessionCache::TlsSessionCache()
+: d_mutex()
+, d_sessions()
+, d_resumedHandshakes(0)
+, d_fullHandshakes(0)
+{
+}
+
+TlsSessionCache::~TlsSessionCache()
+{
+    for (Sessions::iterator it = d_sessions.begin(); it != d_sessions.end();
+         ++it) {
+        SSL_SESSION_free(it->second);
+    }
+}
+
+void TlsSessionCache::enable(SSL_CTX* context)
+{
+    SSL_CTX_set_session_cache_mode(
+        context, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(context, &TlsSessionCache::onNewSession);
+}
+
+bool TlsSessionCache::prepare(SSL* ssl, const bsl::string& endpoint)
+{
+    Binding* binding  = new Binding();
+    binding->cache    = shared_from_this();
+    binding->endpoint = endpoint;
+    if (!SSL_set_ex_data(ssl, bindingIndex(), binding)) {
+        delete binding;
+        BALL_LOG_WARN << "Failed to attach TLS session cache to connection";
+        return false;
+    }
+
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+
+    Sessions::iterator it = d_sessions.find(endpoint);
+    if (it == d_sessions.end()) {
+        return false;
+    }
+
+    if (hasExpired(it->second) || !SSL_SESSION_is_resumable(it->second)) {
+        SSL_SESSION_free(it->second);
+        d_sessions.erase(it);
+        return false;
+    }
+
+    if (!SSL_set_session(ssl, it->second)) {
+        RMQT_LOG_DEBUG << "Cached TLS session for " << endpoint
+                       << " was not accepted";
+        return false;
+    }
+
+    RMQT_LOG_TRACE << "Offering cached TLS session for " << endpoint;
+    return true;
+}
+
+void TlsSessionCache::recordHandshake(const SSL* ssl)
+{
+    if (SSL_session_reused(const_cast<SSL*>(ssl))) {
+        d_resumedHandshakes.addRelaxed(1);
+    }
+    else {
+        d_fullHandshakes.addRelaxed(1);
+    }
+}
+
+TlsSessionCache::Stats TlsSessionCache::stats() const
+{
+    Stats result;
+    result.resumedHandshakes = d_resumedHandshakes.loadRelaxed();
+    result.fullHandshakes    = d_fullHandshakes.loadRelaxed();
+    return result;
+}
+
+bsl::size_t TlsSessionCache::size() const
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    return d_sessions.size();
+}
+
+int TlsSessionCache::onNewSession(SSL* ssl, SSL_SESSION* session)
+{
+    Binding* binding = static_cast<Binding*>(
+        SSL_get_ex_data(ssl, bindingIndex()));
+    if (binding) {
+        // Cache a copy: OpenSSL marks the connection's own session as not
+        // resumable if the connection is dropped without a TLS shutdown,
+        // which is how most reconnects start
+        SSL_SESSION* copy = SSL_SESSION_dup(session);
+        if (copy) {
+            binding->cache->store(binding->endpoint, copy);
+        }
+    }
+
+    // OpenSSL keeps ownership of `session`
+    return 0;
+}
+
+void TlsSessionCache::store(const bsl::string& endpoint,
+                            SSL_SESSION* session)
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+
+    bsl::pair<Sessions::iterator, bool> inserted =
+        d_sessions.insert(bsl::make_pair(endpoint, session));
+    if (!inserted.second) {
+        SSL_SESSION_free(inserted.first->second);
+        inserted.first->second = session;
+    }
+}
+
+} // namespace rmqio
+} // namespace BloombergLP
@@ -0,0 +1,102 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef INCLUDED_RMQIO_TLSSESSIONCACHE
+#define INCLUDED_RMQIO_TLSSESSIONCACHE
+
+#include <openssl/ssl.h>
+
+#include <bslmt_mutex.h>
+#include <bsls_atomic.h>
+#include <bsls_keyword.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_cstdint.h>
+#include <bsl_memory.h>
+#include <bsl_string.h>
+#include <bsl_unordered_map.h>
+
+//@PURPOSE: Resume TLS sessions when reconnecting to a broker
+//
+//@CLASSES:
+//  rmqio::TlsSessionCache: Thread-safe client session cache keyed by endpoint
+
+namespace BloombergLP {
+namespace rmqio {
+
+/// \brief Client TLS sessions, keyed by the endpoint they were negotiated
+/// with
+///
+/// A full handshake costs both sides several public key operations, which
+/// adds up when every connection to a restarted broker reconnects at once.
+/// A secure connection calls `prepare` once its TCP connection is up: that
+/// offers the session last negotiated with the same endpoint, and files any
+/// session (or TLS 1.3 ticket) the new connection receives in its place.
+/// A broker which no longer accepts the session falls back to a full
+/// handshake. One cache is shared by all the connections of a
+/// RabbitContext, across event loop threads.
+
+class TlsSessionCache : public bsl::enable_shared_from_this<TlsSessionCache> {
+  public:
+    struct Stats {
+        bsl::uint64_t resumedHandshakes;
+        bsl::uint64_t fullHandshakes;
+
+        Stats();
+    };
+
+    TlsSessionCache();
+    ~TlsSessionCache();
+
+    /// Have client connections created from `context` store the sessions
+    /// they negotiate, through `prepare`. Each connection otherwise creates
+    /// its own context, so OpenSSL's internal cache is turned off.
+    static void enable(SSL_CTX* context);
+
+    /// Offer the session cached for `endpoint` to `ssl`, before its
+    /// handshake, and cache the sessions `ssl` goes on to negotiate under
+    /// `endpoint`.
+    /// \return `true` if a session was offered
+    bool prepare(SSL* ssl, const bsl::string& endpoint);
+
+    /// Count the completed handshake of `ssl` as resumed or full
+    void recordHandshake(const SSL* ssl);
+
+    Stats stats() const;
+
+    /// Return the number of endpoints with a cached session
+    bsl::size_t size() const;
+
+  private:
+    TlsSessionCache(const TlsSessionCache&) BSLS_KEYWORD_DELETED;
+    TlsSessionCache& operator=(const TlsSessionCache&) BSLS_KEYWORD_DELETED;
+
+    static int onNewSession(SSL* ssl, SSL_SESSION* session);
+
+    /// Replace the session cached for `endpoint`, adopting the reference
+    /// held on `session`
+    void store(const bsl::string& endpoint, SSL_SESSION* session);
+
+    typedef bsl::unordered_map<bsl::string, SSL_SESSION*> Sessions;
+
+    mutable bslmt::Mutex d_mutex;
+    Sessions d_sessions;
+    bsls::AtomicUint64 d_resumedHandshakes;
+    bsls::AtomicUint64 d_fullHandshakes;
+};
+
+} // namespace rmqio
+} // namespace BloombergLP
+
+#endif
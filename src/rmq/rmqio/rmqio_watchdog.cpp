@@ -15,6 +15,8 @@
 
 #include <rmqio_watchdog.h>
 
+#include <rmqt_log.h>
+
 #include <ball_log.h>
 #include <bdlf_bind.h>
 
@@ -42,7 +44,7 @@ WatchDog::~WatchDog()
 
 void WatchDog::addTask(const bsl::weak_ptr<Task>& task)
 {
-    BALL_LOG_DEBUG << "Watchdog task added";
+    RMQT_LOG_DEBUG << "Watchdog task added";
     d_tasks.push_back(task);
 }
 
@@ -62,17 +64,17 @@ void WatchDog::timerCallback(const bsl::weak_ptr<WatchDog>& watchdog_wp,
             watchdog->run();
         }
         else {
-            BALL_LOG_DEBUG << "WatchDog has been destructed";
+            RMQT_LOG_DEBUG << "WatchDog has been destructed";
         }
     }
     else {
-        BALL_LOG_DEBUG << "WatchDog timer cancelled";
+        RMQT_LOG_DEBUG << "WatchDog timer cancelled";
     }
 }
 
 void WatchDog::run()
 {
-    BALL_LOG_DEBUG << "WatchDog triggered";
+    RMQT_LOG_DEBUG << "WatchDog triggered";
     d_timer->reset(d_timeout);
     d_tasks.remove_if(&expired);
     for (bsl::list<bsl::weak_ptr<Task> >::iterator task_wp = d_tasks.begin();
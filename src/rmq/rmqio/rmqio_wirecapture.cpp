@@ -0,0 +1,161 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqio_wirecapture.h>
+
+#include <ball_log.h>
+#include <bslmt_lockguard.h>
+#include <bsls_systemtime.h>
+
+#include <bsl_cstring.h>
+#include <bsl_fstream.h>
+
+namespace BloombergLP {
+namespace rmqio {
+namespace {
+
+BALL_LOG_SET_NAMESPACE_CATEGORY("RMQIO.WIRECAPTURE")
+
+const char k_FILE_HEADER[]             = "RMQCAP01";
+const bsl::size_t k_FILE_HEADER_LENGTH = 8;
+const bsl::size_t k_RECORD_HEADER_LENGTH = 4 + 1 + 8 + 4;
+
+/// Write the low `size` bytes of `value` to `out`, big-endian
+void putBigEndian(bsl::uint8_t* out, bsls::Types::Uint64 value, int size)
+{
+    for (int i = size - 1; i >= 0; --i) {
+        out[i] = static_cast<bsl::uint8_t>(value & 0xff);
+        value >>= 8;
+    }
+}
+
+bsls::Types::Uint64 getBigEndian(const bsl::uint8_t* in, int size)
+{
+    bsls::Types::Uint64 value = 0;
+    for (int i = 0; i < size; ++i) {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+} // namespace
+
+bsl::shared_ptr<WireCapture> WireCapture::open(const bsl::string& path)
+{
+    bsl::shared_ptr<bsl::ofstream> file = bsl::make_shared<bsl::ofstream>(
+        path.c_str(), bsl::ios::out | bsl::ios::binary | bsl::ios::trunc);
+    if (!*file) {
+        BALL_LOG_ERROR << "Cannot open wire capture file: " << path;
+        return bsl::shared_ptr<WireCapture>();
+    }
+    return bsl::make_shared<WireCapture>(file);
+}
+
+WireCapture::WireCapture(const bsl::shared_ptr<bsl::ostream>& output)
+: d_mutex()
+, d_output(output)
+, d_streams(0)
+{
+    d_output->write(k_FILE_HEADER, k_FILE_HEADER_LENGTH);
+}
+
+void WireCapture::writeHeader(bsl::uint32_t stream,
+                              Direction direction,
+                              bsl::size_t length)
+{
+    bsl::uint8_t header[k_RECORD_HEADER_LENGTH];
+    putBigEndian(header, stream, 4);
+    header[4] = static_cast<bsl::uint8_t>(direction);
+    putBigEndian(header + 5,
+                 static_cast<bsls::Types::Uint64>(
+                     bsls::SystemTime::nowRealtimeClock().totalNanoseconds()),
+                 8);
+    putBigEndian(header + 13, length, 4);
+    d_output->write(reinterpret_cast<const char*>(header), sizeof(header));
+}
+
+void WireCapture::record(bsl::uint32_t stream,
+                         Direction direction,
+                         const bsl::uint8_t* data,
+                         bsl::size_t length)
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    writeHeader(stream, direction, length);
+    d_output->write(reinterpret_cast<const char*>(data),
+                    static_cast<bsl::streamsize>(length));
+}
+
+void WireCapture::record(
+    bsl::uint32_t stream,
+    const bsl::vector<bsl::shared_ptr<SerializedFrame> >& frames)
+{
+    bsl::size_t length = 0;
+    for (bsl::size_t i = 0; i < frames.size(); ++i) {
+        length += frames[i]->frameLength();
+    }
+
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    writeHeader(stream, OUTBOUND, length);
+    for (bsl::size_t i = 0; i < frames.size(); ++i) {
+        for (bsl::size_t j = 0; j < frames[i]->numSegments(); ++j) {
+            const SerializedFrame::Segment segment = frames[i]->segment(j);
+            d_output->write(reinterpret_cast<const char*>(segment.first),
+                            static_cast<bsl::streamsize>(segment.second));
+        }
+    }
+}
+
+void WireCapture::flush()
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+    d_output->flush();
+}
+
+WireCapture::Reader::Reader(bsl::istream& input)
+: d_input(input)
+, d_valid(false)
+{
+    char header[k_FILE_HEADER_LENGTH];
+    d_valid = d_input.read(header, sizeof(header)) &&
+              bsl::memcmp(header, k_FILE_HEADER, sizeof(header)) == 0;
+}
+
+bool WireCapture::Reader::next(Record* record)
+{
+    if (!d_valid) {
+        return false;
+    }
+
+    bsl::uint8_t header[k_RECORD_HEADER_LENGTH];
+    if (!d_input.read(reinterpret_cast<char*>(header), sizeof(header))) {
+        return false;
+    }
+
+    record->stream    = static_cast<bsl::uint32_t>(getBigEndian(header, 4));
+    record->direction = header[4] == OUTBOUND ? OUTBOUND : INBOUND;
+    record->timestampNs =
+        static_cast<bsls::Types::Int64>(getBigEndian(header + 5, 8));
+    record->bytes.resize(
+        static_cast<bsl::size_t>(getBigEndian(header + 13, 4)));
+    if (record->bytes.empty()) {
+        return true;
+    }
+    return static_cast<bool>(
+        d_input.read(reinterpret_cast<char*>(record->bytes.data()),
+                     static_cast<bsl::streamsize>(record->bytes.size())));
+}
+
+} // namespace rmqio
+} // namespace BloombergLP
@@ -0,0 +1,145 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQIO_WIRECAPTURE
+#define INCLUDED_RMQIO_WIRECAPTURE
+
+#include <rmqio_serializedframe.h>
+
+#include <bslmt_mutex.h>
+#include <bsls_atomic.h>
+#include <bsls_keyword.h>
+#include <bsls_types.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_cstdint.h>
+#include <bsl_istream.h>
+#include <bsl_memory.h>
+#include <bsl_ostream.h>
+#include <bsl_string.h>
+#include <bsl_vector.h>
+
+//@PURPOSE: Record the raw bytes connections read and write, for replay
+//
+//@CLASSES:
+//  rmqio::WireCapture: Writes timestamped socket reads and writes to a file
+//  rmqio::WireCapture::Reader: Reads back a capture
+
+namespace BloombergLP {
+namespace rmqio {
+
+/// \brief A capture of the bytes read from and written to the broker by the
+/// connections sharing it, e.g. to replay production traffic through the
+/// decoder and framer offline.
+///
+/// The capture starts with the 8 bytes `RMQCAP01`, followed by one record
+/// per completed socket read or write:
+///
+///  stream     4 bytes, which connection, see `newStream`
+///  direction  1 byte, `INBOUND` or `OUTBOUND`
+///  timestamp  8 bytes, nanoseconds since the epoch
+///  length     4 bytes
+///  bytes      `length` bytes
+///
+/// Integers are big-endian. A capture can be cut off mid-record, e.g. by a
+/// crash: the reader stops at the last whole record.
+///
+/// Records are written from the event loop threads, so this is a diagnostic
+/// tool rather than something to leave on for a busy connection. Thread
+/// safe.
+
+class WireCapture {
+  public:
+    enum Direction { INBOUND = 0, OUTBOUND = 1 };
+
+    struct Record {
+        Record()
+        : stream(0)
+        , direction(INBOUND)
+        , timestampNs(0)
+        , bytes()
+        {
+        }
+
+        bsl::uint32_t stream;
+        Direction direction;
+        bsls::Types::Int64 timestampNs;
+        bsl::vector<bsl::uint8_t> bytes;
+    };
+
+    class Reader;
+
+    /// Return a capture writing to the file at `path`, which is truncated,
+    /// or null if it cannot be opened
+    static bsl::shared_ptr<WireCapture> open(const bsl::string& path);
+
+    /// Write the capture to `output`, starting with the file header
+    explicit WireCapture(const bsl::shared_ptr<bsl::ostream>& output);
+
+    /// Return a new stream id, one per connection
+    bsl::uint32_t newStream() { return d_streams.addRelaxed(1); }
+
+    /// Record the `length` bytes at `data` as read or written on `stream`
+    void record(bsl::uint32_t stream,
+                Direction direction,
+                const bsl::uint8_t* data,
+                bsl::size_t length);
+
+    /// Record the bytes of `frames`, written together on `stream`
+    void record(bsl::uint32_t stream,
+                const bsl::vector<bsl::shared_ptr<SerializedFrame> >& frames);
+
+    /// Push records written so far to the underlying file
+    void flush();
+
+  private:
+    WireCapture(const WireCapture&) BSLS_KEYWORD_DELETED;
+    WireCapture& operator=(const WireCapture&) BSLS_KEYWORD_DELETED;
+
+    /// Write a record header, with `d_mutex` held
+    void writeHeader(bsl::uint32_t stream,
+                     Direction direction,
+                     bsl::size_t length);
+
+    bslmt::Mutex d_mutex;
+    bsl::shared_ptr<bsl::ostream> d_output;
+    bsls::AtomicUint d_streams;
+};
+
+/// \brief Reads the records of a capture written by `WireCapture`
+class WireCapture::Reader {
+  public:
+    /// Read a capture from `input`, checking its file header
+    explicit Reader(bsl::istream& input);
+
+    /// Return false if the input is not a capture
+    bool isValid() const { return d_valid; }
+
+    /// Load the next record into `record`. Return false at the end of the
+    /// capture, or at a record which was cut off.
+    bool next(Record* record);
+
+  private:
+    Reader(const Reader&) BSLS_KEYWORD_DELETED;
+    Reader& operator=(const Reader&) BSLS_KEYWORD_DELETED;
+
+    bsl::istream& d_input;
+    bool d_valid;
+};
+
+} // namespace rmqio
+} // namespace BloombergLP
+
+#endif
@@ -0,0 +1,290 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqio_writequeue.h>
+
+#include <rmqamqpt_constants.h>
+
+#include <bsls_assert.h>
+
+#include <bsl_utility.h>
+
+namespace BloombergLP {
+namespace rmqio {
+namespace {
+
+/// The frame header: type octet, then channel
+bool frameHeader(const SerializedFrame& frame,
+                 bsl::uint8_t* type,
+                 bsl::uint16_t* channel)
+{
+    if (frame.numSegments() == 0) {
+        return false;
+    }
+
+    const SerializedFrame::Segment header = frame.segment(0);
+    if (header.second < 3) {
+        return false;
+    }
+
+    *type    = header.first[0];
+    *channel = static_cast<bsl::uint16_t>((header.first[1] << 8) |
+                                          header.first[2]);
+    return true;
+}
+
+/// Find the channel of the first frame of `frames` which is not a
+/// heartbeat, and whether any frame carries content. Return false if all of
+/// them are heartbeats.
+bool describe(const WriteQueue::Frames& frames,
+              bsl::uint16_t* channel,
+              bool* content)
+{
+    bool found = false;
+    *content   = false;
+    for (WriteQueue::Frames::const_iterator it = frames.begin();
+         it != frames.end();
+         ++it) {
+        bsl::uint8_t type          = 0;
+        bsl::uint16_t frameChannel = 0;
+        if (!frameHeader(**it, &type, &frameChannel) ||
+            type == rmqamqpt::Constants::HEARTBEAT) {
+            continue;
+        }
+
+        if (!found) {
+            found    = true;
+            *channel = frameChannel;
+        }
+        if (type == rmqamqpt::Constants::HEADER ||
+            type == rmqamqpt::Constants::BODY) {
+            *content = true;
+        }
+    }
+    return found;
+}
+
+} // namespace
+
+WriteQueue::WriteQueue()
+: d_control()
+, d_bulk()
+, d_ring()
+, d_turnFrames(0)
+, d_bulkEntries(0)
+, d_barrier()
+, d_weights()
+{
+}
+
+bool WriteQueue::isContent(const SerializedFrame& frame)
+{
+    bsl::uint8_t type     = 0;
+    bsl::uint16_t channel = 0;
+    return frameHeader(frame, &type, &channel) &&
+           (type == rmqamqpt::Constants::HEADER ||
+            type == rmqamqpt::Constants::BODY);
+}
+
+void WriteQueue::push(const Frames& frames,
+                      const Connection::SuccessWriteCallback& callback)
+{
+    Entry entry;
+    entry.frames   = frames;
+    entry.callback = callback;
+    queue(entry);
+}
+
+void WriteQueue::queue(const Entry& entry)
+{
+    bsl::uint16_t channel = 0;
+    bool content          = false;
+    if (!describe(entry.frames, &channel, &content)) {
+        // Heartbeats only
+        d_control.push_back(entry);
+        return;
+    }
+
+    if (!d_barrier.empty() || (channel == 0 && !d_ring.empty())) {
+        d_barrier.push_back(entry);
+        return;
+    }
+
+    BulkChannels::iterator it = d_bulk.find(channel);
+    if (!content && it == d_bulk.end()) {
+        d_control.push_back(entry);
+        return;
+    }
+
+    if (it == d_bulk.end()) {
+        it = d_bulk.insert(bsl::make_pair(channel, BulkChannel())).first;
+        d_ring.push_back(channel);
+    }
+    it->second.entries.push_back(entry);
+    ++d_bulkEntries;
+}
+
+void WriteQueue::pop(Batch* batch,
+                     bsl::size_t maxBytes,
+                     bsl::size_t maxSegments)
+{
+    BSLS_ASSERT(!empty());
+
+    bsl::size_t segments = 0;
+    for (;;) {
+        if (!popControl(batch, &segments, maxBytes, maxSegments)) {
+            return;
+        }
+
+        if (!d_ring.empty()) {
+            if (!popBulk(batch, &segments, maxBytes, maxSegments)) {
+                return;
+            }
+            continue;
+        }
+
+        if (d_barrier.empty()) {
+            return;
+        }
+        releaseBarrier();
+    }
+}
+
+bool WriteQueue::popControl(Batch* batch,
+                            bsl::size_t* segments,
+                            bsl::size_t maxBytes,
+                            bsl::size_t maxSegments)
+{
+    while (!d_control.empty()) {
+        Entry& entry = d_control.front();
+
+        bsl::size_t entryBytes    = 0;
+        bsl::size_t entrySegments = 0;
+        for (Frames::const_iterator it = entry.frames.begin();
+             it != entry.frames.end();
+             ++it) {
+            entryBytes += (*it)->frameLength();
+            entrySegments += (*it)->numSegments();
+        }
+
+        if (!batch->frames.empty() &&
+            (batch->bytes + entryBytes > maxBytes ||
+             *segments + entrySegments > maxSegments)) {
+            return false;
+        }
+
+        batch->frames.insert(
+            batch->frames.end(), entry.frames.begin(), entry.frames.end());
+        batch->completed.push_back(entry.callback);
+        batch->bytes += entryBytes;
+        *segments += entrySegments;
+
+        d_control.pop_front();
+    }
+    return true;
+}
+
+bool WriteQueue::popBulk(Batch* batch,
+                         bsl::size_t* segments,
+                         bsl::size_t maxBytes,
+                         bsl::size_t maxSegments)
+{
+    while (!d_ring.empty()) {
+        const bsl::uint16_t channel = d_ring.front();
+        BulkChannels::iterator it   = d_bulk.find(channel);
+        BSLS_ASSERT(it != d_bulk.end());
+
+        BulkChannel& bulk = it->second;
+        Entry& entry      = bulk.entries.front();
+
+        const bsl::shared_ptr<SerializedFrame>& frame =
+            entry.frames[bulk.offset];
+        if (!batch->frames.empty() &&
+            (batch->bytes + frame->frameLength() > maxBytes ||
+             *segments + frame->numSegments() > maxSegments)) {
+            return false;
+        }
+
+        batch->frames.push_back(frame);
+        batch->bytes += frame->frameLength();
+        *segments += frame->numSegments();
+        ++d_turnFrames;
+
+        if (++bulk.offset == entry.frames.size()) {
+            batch->completed.push_back(entry.callback);
+            bulk.entries.pop_front();
+            bulk.offset = 0;
+            --d_bulkEntries;
+        }
+
+        if (bulk.entries.empty()) {
+            d_bulk.erase(it);
+            d_ring.pop_front();
+            d_turnFrames = 0;
+        }
+        else if (d_turnFrames >= weight(channel)) {
+            d_ring.pop_front();
+            d_ring.push_back(channel);
+            d_turnFrames = 0;
+        }
+    }
+    return true;
+}
+
+void WriteQueue::releaseBarrier()
+{
+    bsl::deque<Entry> barrier;
+    barrier.swap(d_barrier);
+
+    for (bsl::deque<Entry>::const_iterator it = barrier.begin();
+         it != barrier.end();
+         ++it) {
+        queue(*it);
+    }
+}
+
+void WriteQueue::setWeight(bsl::uint16_t channel, unsigned weight)
+{
+    if (weight <= 1) {
+        d_weights.erase(channel);
+    }
+    else {
+        d_weights[channel] = weight;
+    }
+}
+
+void WriteQueue::trim()
+{
+    if (!empty()) {
+        return;
+    }
+
+    // Every channel's bulk entries have been handed out, so nothing but
+    // the storage is lost
+    bsl::deque<Entry>().swap(d_control);
+    BulkChannels().swap(d_bulk);
+    bsl::deque<bsl::uint16_t>().swap(d_ring);
+    bsl::deque<Entry>().swap(d_barrier);
+}
+
+unsigned WriteQueue::weight(bsl::uint16_t channel) const
+{
+    bsl::unordered_map<bsl::uint16_t, unsigned>::const_iterator it =
+        d_weights.find(channel);
+    return it == d_weights.end() ? 1 : it->second;
+}
+
+} // namespace rmqio
+} // namespace BloombergLP
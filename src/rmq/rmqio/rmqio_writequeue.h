@@ -0,0 +1,184 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQIO_WRITEQUEUE
+#define INCLUDED_RMQIO_WRITEQUEUE
+
+#include <rmqio_connection.h>
+#include <rmqio_serializedframe.h>
+
+#include <bsls_keyword.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_cstdint.h>
+#include <bsl_deque.h>
+#include <bsl_memory.h>
+#include <bsl_unordered_map.h>
+#include <bsl_vector.h>
+
+//@PURPOSE: Order a connection's queued writes so control frames go first
+//
+//@CLASSES:
+//  rmqio::WriteQueue: Control and bulk lanes of writes waiting for the socket
+
+namespace BloombergLP {
+namespace rmqio {
+
+/// \brief Writes waiting for a connection's socket, in two lanes
+///
+/// Entries without content frames (heartbeats, acks, channel methods) go in
+/// the control lane, which is always drained before the bulk lane holding
+/// publishes. Entries in the bulk lane are handed out a frame at a time, so
+/// control entries also overtake the rest of a large publish whose first
+/// frames have already been written.
+///
+/// The bulk lane keeps a queue per channel and takes turns between the
+/// channels with publishes queued, handing out up to the channel's weight
+/// (1 unless set by `setWeight`) in frames each turn. A small publish on one
+/// channel therefore goes out after a few frames of a large publish on
+/// another, rather than after all of them.
+///
+/// AMQP allows frames of other channels between the frames of a content,
+/// but not reordering on one channel. A control entry therefore only goes in
+/// the control lane if no bulk entry is queued for its channel. A connection
+/// method (channel 0) queued behind publishes waits for all of them, and
+/// everything queued after it waits for it. Heartbeats may be sent at any
+/// point.
+///
+/// Not thread safe.
+
+class WriteQueue {
+  public:
+    typedef bsl::vector<bsl::shared_ptr<SerializedFrame> > Frames;
+
+    /// Frames handed out for one socket write, and the callbacks of the
+    /// entries whose last frame is among them
+    struct Batch {
+        Batch()
+        : frames()
+        , completed()
+        , bytes(0)
+        {
+        }
+
+        Frames frames;
+        bsl::vector<Connection::SuccessWriteCallback> completed;
+        bsl::size_t bytes;
+    };
+
+    WriteQueue();
+
+    /// Queue `frames`, invoking `callback` once all of them are written
+    void push(const Frames& frames,
+              const Connection::SuccessWriteCallback& callback);
+
+    /// Move the frames of the next write into `batch`: whole control
+    /// entries, then frames of bulk entries by turns, for as long as they
+    /// fit within `maxBytes` and `maxSegments`. At least one frame is
+    /// taken. The behavior is undefined if the queue is empty.
+    void pop(Batch* batch, bsl::size_t maxBytes, bsl::size_t maxSegments);
+
+    /// Let `channel` hand out up to `weight` frames per turn of the bulk
+    /// lane. A `weight` of 0 is treated as 1.
+    void setWeight(bsl::uint16_t channel, unsigned weight);
+
+    unsigned weight(bsl::uint16_t channel) const;
+
+    /// Release the memory the lanes grew to during a burst. Does nothing
+    /// unless the queue is empty.
+    void trim();
+
+    bool empty() const
+    {
+        return d_control.empty() && d_ring.empty() && d_barrier.empty();
+    }
+
+    /// Number of queued entries, including those partly handed out
+    bsl::size_t entries() const
+    {
+        return d_control.size() + d_bulkEntries + d_barrier.size();
+    }
+
+    /// Return true if `frame` carries content (a header or body frame)
+    static bool isContent(const SerializedFrame& frame);
+
+  private:
+    WriteQueue(const WriteQueue&) BSLS_KEYWORD_DELETED;
+    WriteQueue& operator=(const WriteQueue&) BSLS_KEYWORD_DELETED;
+
+    struct Entry {
+        Frames frames;
+        Connection::SuccessWriteCallback callback;
+    };
+
+    /// The bulk entries of one channel, and how many frames of the first
+    /// have been handed out
+    struct BulkChannel {
+        BulkChannel()
+        : entries()
+        , offset(0)
+        {
+        }
+
+        bsl::deque<Entry> entries;
+        bsl::size_t offset;
+    };
+
+    typedef bsl::unordered_map<bsl::uint16_t, BulkChannel> BulkChannels;
+
+    /// Queue `entry` in the lane its frames belong in
+    void queue(const Entry& entry);
+
+    /// Move whole control entries into `batch`. Return false if one did not
+    /// fit.
+    bool popControl(Batch* batch,
+                    bsl::size_t* segments,
+                    bsl::size_t maxBytes,
+                    bsl::size_t maxSegments);
+
+    /// Move bulk frames into `batch` by turns. Return false if one did not
+    /// fit, true once the bulk lane is empty.
+    bool popBulk(Batch* batch,
+                 bsl::size_t* segments,
+                 bsl::size_t maxBytes,
+                 bsl::size_t maxSegments);
+
+    /// Queue the entries held behind a connection method again, once the
+    /// publishes it waited for have been handed out
+    void releaseBarrier();
+
+    bsl::deque<Entry> d_control;
+    BulkChannels d_bulk;
+
+    /// Channels with bulk entries queued, in the order of their turns
+    bsl::deque<bsl::uint16_t> d_ring;
+
+    /// Frames handed out by the channel at the front of `d_ring` this turn
+    bsl::size_t d_turnFrames;
+
+    bsl::size_t d_bulkEntries;
+
+    /// A connection method which waits for the bulk lane to drain, and the
+    /// entries queued after it
+    bsl::deque<Entry> d_barrier;
+
+    /// Weights other than 1, by channel
+    bsl::unordered_map<bsl::uint16_t, unsigned> d_weights;
+};
+
+} // namespace rmqio
+} // namespace BloombergLP
+
+#endif
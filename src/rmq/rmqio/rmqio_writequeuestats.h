@@ -0,0 +1,74 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQIO_WRITEQUEUESTATS
+#define INCLUDED_RMQIO_WRITEQUEUESTATS
+
+#include <bsls_atomic.h>
+#include <bsls_keyword.h>
+#include <bsls_types.h>
+
+//@PURPOSE: Total the writes queued by a group of connections
+//
+//@CLASSES:
+//  rmqio::WriteQueueStats: Entries and bytes waiting to be written
+
+namespace BloombergLP {
+namespace rmqio {
+
+/// \brief Entries and bytes queued for writing, but not yet written, by the
+/// connections sharing this object (e.g. those on one event loop)
+///
+/// Thread safe.
+
+class WriteQueueStats {
+  public:
+    WriteQueueStats();
+
+    /// Count an entry of `bytes` bytes queued for writing
+    void add(bsls::Types::Int64 bytes);
+
+    /// Count `entries` entries, of `bytes` bytes in total, written or
+    /// discarded
+    void remove(bsls::Types::Int64 entries, bsls::Types::Int64 bytes);
+
+    bsls::Types::Int64 entries() const { return d_entries.loadRelaxed(); }
+    bsls::Types::Int64 bytes() const { return d_bytes.loadRelaxed(); }
+
+  private:
+    WriteQueueStats(const WriteQueueStats&) BSLS_KEYWORD_DELETED;
+    WriteQueueStats& operator=(const WriteQueueStats&) BSLS_KEYWORD_DELETED;
+
+    bsls::AtomicInt64 d_entries;
+    bsls::AtomicInt64 d_bytes;
+};
+
+inline void WriteQueueStats::add(bsls::Types::Int64 bytes)
+{
+    d_entries.addRelaxed(1);
+    d_bytes.addRelaxed(bytes);
+}
+
+inline void WriteQueueStats::remove(bsls::Types::Int64 entries,
+                                    bsls::Types::Int64 bytes)
+{
+    d_entries.addRelaxed(-entries);
+    d_bytes.addRelaxed(-bytes);
+}
+
+} // namespace rmqio
+} // namespace BloombergLP
+
+#endif
@@ -48,5 +48,41 @@ rmqt::Future<rmqp::Consumer> Connection::createConsumerAsync(
         rmqt::ConsumerConfig(consumerTag, prefetchCount));
 }
 
+rmqt::Result<rmqp::Consumer> Connection::createBatchConsumer(
+    const rmqt::Topology& topology,
+    rmqt::QueueHandle queue,
+    const rmqp::Consumer::BatchConsumerFunc& onBatch,
+    const rmqt::ConsumerConfig& consumerConfig)
+{
+    return createBatchConsumerAsync(topology, queue, onBatch, consumerConfig)
+        .blockResult();
+}
+
+rmqt::Future<rmqp::Consumer> Connection::createBatchConsumerAsync(
+    const rmqt::Topology&,
+    rmqt::QueueHandle,
+    const rmqp::Consumer::BatchConsumerFunc&,
+    const rmqt::ConsumerConfig&)
+{
+    return rmqt::Future<rmqp::Consumer>(rmqt::Result<rmqp::Consumer>(
+        "Batch consumers are not supported by this connection"));
+}
+
+rmqt::Future<Producer>
+Connection::createUnconfirmedProducerAsync(const rmqt::Topology&,
+                                           rmqt::ExchangeHandle,
+                                           uint16_t)
+{
+    return rmqt::Future<Producer>(rmqt::Result<Producer>(
+        "Unconfirmed producers are not supported by this connection"));
+}
+
+rmqt::Future<RpcClient>
+Connection::createRpcClientAsync(const rmqt::Topology&, rmqt::ExchangeHandle)
+{
+    return rmqt::Future<RpcClient>(rmqt::Result<RpcClient>(
+        "RPC clients are not supported by this connection"));
+}
+
 } // namespace rmqp
 } // namespace BloombergLP
@@ -19,6 +19,7 @@
 
 #include <rmqp_consumer.h>
 #include <rmqp_producer.h>
+#include <rmqp_rpcclient.h>
 #include <rmqt_consumerconfig.h>
 
 #include <rmqt_future.h>
@@ -103,6 +104,49 @@ class Connection {
                         const rmqp::Consumer::ConsumerFunc& onMessage,
                         const rmqt::ConsumerConfig& consumerConfig) = 0;
 
+    /// \brief Create an asynchronous consumer which is passed batches of
+    /// messages, see `rmqp::Consumer::BatchConsumerFunc`.
+    /// \param consumerConfig As for `createConsumer`. `maxBatchSize` and
+    ///        `maxBatchLinger` control how batches are formed.
+    ///
+    /// The default implementation returns an error: connections which
+    /// support batch consumers override this.
+    virtual rmqt::Result<rmqp::Consumer>
+    createBatchConsumer(const rmqt::Topology& topology,
+                        rmqt::QueueHandle queue,
+                        const rmqp::Consumer::BatchConsumerFunc& onBatch,
+                        const rmqt::ConsumerConfig& consumerConfig);
+
+    virtual rmqt::Future<rmqp::Consumer>
+    createBatchConsumerAsync(const rmqt::Topology& topology,
+                             rmqt::QueueHandle queue,
+                             const rmqp::Consumer::BatchConsumerFunc& onBatch,
+                             const rmqt::ConsumerConfig& consumerConfig);
+
+    /// \brief Create a producer which publishes without publisher confirms,
+    /// see `rmqa::UnconfirmedProducer`.
+    /// \param maxUnwrittenMessages The number of messages the producer
+    ///        hands to the connection before sends wait for them to be
+    ///        written to the socket
+    ///
+    /// The default implementation returns an error: connections which
+    /// support unconfirmed producers override this.
+    virtual rmqt::Future<Producer>
+    createUnconfirmedProducerAsync(const rmqt::Topology& topology,
+                                   rmqt::ExchangeHandle exchange,
+                                   uint16_t maxUnwrittenMessages);
+
+    /// \brief Create a client which publishes requests to `exchange` and
+    /// receives their replies by direct reply-to, see `rmqp::RpcClient`.
+    /// \param topology Declared by the client, as for `createProducer`.
+    ///        `exchange` must exist in it.
+    ///
+    /// The default implementation returns an error: connections which
+    /// support RPC clients override this.
+    virtual rmqt::Future<RpcClient>
+    createRpcClientAsync(const rmqt::Topology& topology,
+                         rmqt::ExchangeHandle exchange);
+
     // DEPRECATED
     /// Create an asynchronous consumer using the topology provided.
     /// This method also creates the `topology` on the target broker
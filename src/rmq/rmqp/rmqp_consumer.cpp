@@ -21,5 +21,17 @@ namespace rmqp {
 Consumer::Consumer() {}
 Consumer::~Consumer() {}
 
+rmqt::Future<> Consumer::nackAllOutstanding(bool)
+{
+    return rmqt::Future<>(
+        rmqt::Result<>("nackAllOutstanding is not supported by this consumer"));
+}
+
+rmqt::Future<> Consumer::ackThrough(const rmqt::Envelope&)
+{
+    return rmqt::Future<>(
+        rmqt::Result<>("ackThrough is not supported by this consumer"));
+}
+
 } // namespace rmqp
 } // namespace BloombergLP
@@ -18,6 +18,7 @@
 
 #include <rmqp_messageguard.h>
 #include <rmqp_topologyupdate.h>
+#include <rmqt_envelope.h>
 #include <rmqt_future.h>
 #include <rmqt_message.h>
 #include <rmqt_result.h>
@@ -25,6 +26,7 @@
 #include <rmqt_topologyupdate.h>
 
 #include <bsl_functional.h>
+#include <bsl_vector.h>
 
 namespace BloombergLP {
 namespace rmqp {
@@ -47,6 +49,17 @@ class Consumer {
     /// always be invoked from the RabbitContext threadpool.
     typedef bsl::function<void(rmqp::MessageGuard&)> ConsumerFunc;
 
+    /// \brief Callback function used to receive messages in batches.
+    ///
+    /// The passed implementation is invoked with up to
+    /// `ConsumerConfig::maxBatchSize` messages at a time, in delivery order,
+    /// from the RabbitContext threadpool. Each guard must be acknowledged as
+    /// for `ConsumerFunc`; guards are only valid until the callback returns,
+    /// any left unresolved are nack'ed (with requeue) when it does. Use
+    /// `MessageGuard::transferOwnership` to resolve a message later.
+    typedef bsl::function<void(const bsl::vector<rmqp::MessageGuard*>& batch)>
+        BatchConsumerFunc;
+
     // CREATORS
     /// Consumer is constructed from the Connection object.
     Consumer();
@@ -84,6 +97,30 @@ class Consumer {
     virtual rmqt::Future<>
     updateTopologyAsync(const rmqt::TopologyUpdate& topologyUpdate) = 0;
 
+    /// \brief Negatively acknowledges every message delivered to this
+    /// consumer which has not been acked yet, with a single basic.nack
+    /// where the channel allows, e.g. to hand a backlog back while a
+    /// downstream store is unavailable. Acks queued before the call are
+    /// sent first. Acks sent afterwards for the nacked messages, e.g. by
+    /// callbacks still processing them, are ignored.
+    /// \param requeue  Whether the broker requeues the messages, rather
+    /// than dead-lettering or dropping them.
+    /// \return A Future which resolves once the nack is queued to send.
+    /// The default implementation resolves with an error.
+    virtual rmqt::Future<> nackAllOutstanding(bool requeue);
+
+    /// \brief Acknowledges the message delivered with `envelope` and every
+    /// earlier message delivered to this consumer which has not been acked
+    /// yet, with a single basic.ack where the channel allows. For consumers
+    /// which process deliveries in order, e.g. from a stream, this replaces
+    /// one ack per message. Acks queued before the call are sent first.
+    /// Acks and nacks sent afterwards for the covered messages, e.g. by
+    /// their `MessageGuard`s, are ignored.
+    /// \return A Future which resolves once the ack is queued to send, or
+    /// with an error if the channel has closed since `envelope` was
+    /// delivered. The default implementation resolves with an error.
+    virtual rmqt::Future<> ackThrough(const rmqt::Envelope& envelope);
+
     virtual ~Consumer();
 
   private:
@@ -0,0 +1,62 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQP_MESSAGECODEC
+#define INCLUDED_RMQP_MESSAGECODEC
+
+#include <bsl_cstddef.h>
+#include <bsl_cstdint.h>
+#include <bsl_string.h>
+#include <bsl_vector.h>
+
+namespace BloombergLP {
+namespace rmqp {
+
+/// \brief An interface for compressing message payloads.
+///
+/// A MessageCodec wraps a compression library, e.g. LZ4 or Zstd. Producers
+/// configured with a codec (see rmqa::RabbitContextOptions) compress the
+/// payload of each message they send and record `name()` in the message's
+/// `contentEncoding` property. Consumers which know a codec of that name
+/// decompress the payload before it is handed to the application.
+///
+/// Both methods may be called concurrently from several threads.
+class MessageCodec {
+  public:
+    /// \brief The content encoding recorded on messages compressed with this
+    /// codec, e.g. "lz4" or "zstd".
+    virtual const bsl::string& name() const = 0;
+
+    /// \brief Compress the `length` bytes at `data` into `out`, replacing its
+    /// contents.
+    /// \return 0 on success, any other value on failure
+    virtual int compress(bsl::vector<uint8_t>* out,
+                         const uint8_t* data,
+                         bsl::size_t length) const = 0;
+
+    /// \brief Decompress the `length` bytes at `data`, as produced by
+    /// `compress`, into `out`, replacing its contents.
+    /// \return 0 on success, any other value if `data` is not valid
+    virtual int decompress(bsl::vector<uint8_t>* out,
+                           const uint8_t* data,
+                           bsl::size_t length) const = 0;
+
+    virtual ~MessageCodec();
+};
+
+} // namespace rmqp
+} // namespace BloombergLP
+
+#endif
@@ -0,0 +1,58 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQP_MESSAGESINK
+#define INCLUDED_RMQP_MESSAGESINK
+
+#include <bsl_cstddef.h>
+#include <bsl_cstdint.h>
+
+namespace BloombergLP {
+namespace rmqp {
+
+/// \brief Writes the body of a streamed message.
+///
+/// Returned by rmqp::Producer#openStream. The body is published chunk by
+/// chunk as it is written, so a message larger than memory can be sent
+/// e.g. straight from a file. The message is complete once `remaining()`
+/// bytes have been written; destroying the sink before then abandons it.
+///
+/// A sink must be used from one thread at a time.
+class MessageSink {
+  public:
+    /// \brief Append the `length` bytes at `data` to the message body.
+    ///
+    /// The bytes are copied, so `data` may be reused once this returns.
+    /// Blocks while too many earlier chunks are still waiting to be written
+    /// to the connection, bounding the memory used by the stream.
+    ///
+    /// \return 0 on success. Any other value if `length` is more than
+    ///         `remaining()`, in which case nothing is written, or if the
+    ///         stream has failed, e.g. the connection was lost. The
+    ///         confirmation callback is invoked with REJECT when a stream
+    ///         fails.
+    virtual int write(const uint8_t* data, bsl::size_t length) = 0;
+
+    /// \brief The number of body bytes still to be written.
+    virtual bsl::size_t remaining() const = 0;
+
+    /// \brief Abandons the message unless its whole body has been written.
+    virtual ~MessageSink();
+};
+
+} // namespace rmqp
+} // namespace BloombergLP
+
+#endif
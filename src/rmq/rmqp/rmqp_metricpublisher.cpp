@@ -18,5 +18,16 @@
 namespace BloombergLP {
 namespace rmqp {
 MetricPublisher::~MetricPublisher() {}
+
+void MetricPublisher::publishDistributionSamples(
+    const bsl::string& name,
+    double value,
+    bsl::size_t count,
+    const bsl::vector<bsl::pair<bsl::string, bsl::string> >& tags)
+{
+    for (bsl::size_t i = 0; i < count; ++i) {
+        publishDistribution(name, value, tags);
+    }
+}
 } // namespace rmqp
 } // namespace BloombergLP
@@ -16,6 +16,7 @@
 #ifndef INCLUDED_RMQP_METRICPUBLISHER
 #define INCLUDED_RMQP_METRICPUBLISHER
 
+#include <bsl_cstddef.h>
 #include <bsl_string.h>
 #include <bsl_utility.h>
 #include <bsl_vector.h>
@@ -62,6 +63,16 @@ class MetricPublisher {
         const bsl::string& name,
         double value,
         const bsl::vector<bsl::pair<bsl::string, bsl::string> >& tags) = 0;
+
+    /// Publish `count` occurrences of `value` for distribution statistics,
+    /// as pre-aggregated by rmqcpp. The default implementation calls
+    /// `publishDistribution` `count` times; override it if the metrics
+    /// backend accepts weighted samples.
+    virtual void publishDistributionSamples(
+        const bsl::string& name,
+        double value,
+        bsl::size_t count,
+        const bsl::vector<bsl::pair<bsl::string, bsl::string> >& tags);
 };
 
 } // namespace rmqp
@@ -21,5 +21,38 @@ namespace rmqp {
 Producer::Producer() {}
 Producer::~Producer() {}
 
+Producer::SendStatus
+Producer::sendToMany(const rmqt::Message&,
+                     const bsl::vector<bsl::string>&,
+                     const FanOutConfirmationCallback&,
+                     const bsls::TimeInterval&)
+{
+    return INFLIGHT_LIMIT;
+}
+
+Producer::SendStatus Producer::sendUrgent(
+    const rmqt::Message& message,
+    const bsl::string& routingKey,
+    const rmqp::Producer::ConfirmationCallback& confirmCallback,
+    const bsls::TimeInterval& timeout)
+{
+    return send(message, routingKey, confirmCallback, timeout);
+}
+
+Producer::SendStatus Producer::sendSequenced(const rmqt::Message&,
+                                             const bsl::string&,
+                                             bsl::uint64_t*,
+                                             const bsls::TimeInterval&)
+{
+    return INFLIGHT_LIMIT;
+}
+
+bsl::uint64_t Producer::confirmedThrough() const { return 0; }
+
+Producer::FailedSequences Producer::takeFailedSequences()
+{
+    return FailedSequences();
+}
+
 } // namespace rmqp
 } // namespace BloombergLP
@@ -19,6 +19,7 @@
 
 #include <rmqt_queue.h>
 
+#include <rmqp_messagesink.h>
 #include <rmqp_topologyupdate.h>
 #include <rmqt_confirmresponse.h>
 #include <rmqt_exchange.h>
@@ -28,8 +29,12 @@
 
 #include <bsls_timeinterval.h>
 
+#include <bsl_cstddef.h>
+#include <bsl_cstdint.h>
 #include <bsl_functional.h>
+#include <bsl_map.h>
 #include <bsl_string.h>
+#include <bsl_vector.h>
 #include <rmqt_future.h>
 
 namespace BloombergLP {
@@ -62,6 +67,23 @@ class Producer {
                                const rmqt::ConfirmResponse&)>
         ConfirmationCallback;
 
+    /// \brief Invoked once the broker has confirmed or rejected a message
+    /// sent with `sendToMany` for every routing key, with the response for
+    /// each key in the order the keys were given.
+    typedef bsl::function<void(const rmqt::Message&,
+                               const bsl::vector<bsl::string>& routingKeys,
+                               const bsl::vector<rmqt::ConfirmResponse>&)>
+        FanOutConfirmationCallback;
+
+    /// \brief Invoked when the producer can accept messages again.
+    ///
+    /// See rmqp::Producer#setWritableCallback.
+    typedef bsl::function<void()> WritableCallback;
+
+    /// \brief Sequence numbers of messages sent with `sendSequenced` which
+    /// were rejected or returned, with their response.
+    typedef bsl::map<bsl::uint64_t, rmqt::ConfirmResponse> FailedSequences;
+
     // CREATORS
     virtual ~Producer();
 
@@ -194,6 +216,175 @@ class Producer {
             const bsl::string& routingKey,
             const rmqp::Producer::ConfirmationCallback& confirmCallback) = 0;
 
+    /// \brief Register `callback` to be told when sending is possible again.
+    ///
+    /// Once `trySend` has returned INFLIGHT_LIMIT, `callback` is invoked a
+    /// single time, on the thread pool, as soon as publisher confirms bring
+    /// the available credit back up to `minimumCredits`. This allows an
+    /// application to stop publishing when the unconfirmed message limit is
+    /// reached and resume from the callback, rather than blocking in `send`
+    /// or polling `trySend`.
+    ///
+    /// \param callback       Invoked when sending is possible again. An
+    ///                       empty callback removes any registered callback.
+    /// \param minimumCredits How many messages must be sendable before
+    ///                       `callback` is invoked. Values above the
+    ///                       unconfirmed message limit are treated as the
+    ///                       limit, and 0 is treated as 1.
+    virtual void setWritableCallback(const WritableCallback& callback,
+                                     bsl::size_t minimumCredits) = 0;
+
+    /// \brief Return how many more messages can be sent before the
+    /// unconfirmed message limit is reached.
+    virtual bsl::size_t availableCredits() const = 0;
+
+    /// \brief Set this producer's share of the connection while it is busy
+    /// writing publishes.
+    ///
+    /// The connection takes turns between channels with publishes waiting
+    /// to be written, writing up to `weight` frames of each channel per
+    /// turn, so a large message on one producer does not hold up small ones
+    /// on another. Producers start with a weight of 1; a `weight` of 0 is
+    /// treated as 1. Producers sharing a channel share its weight.
+    virtual void setWriteWeight(unsigned weight) = 0;
+
+    /// \brief Send a batch of messages with the given `routingKey` to the
+    /// exchange targeted by the producer.
+    ///
+    /// Behaves as `send` for every message in `messages`, in order, but
+    /// reserves room for the whole batch under the unconfirmed message limit
+    /// at once and hands the batch to the connection as a single write. Either
+    /// every message in the batch is accepted for sending, or none are.
+    ///
+    /// \param messages        The messages to be sent.
+    /// \param routingKey      The routing key (e.g. topic or queue name)
+    ///                        passed to the exchange, for every message.
+    /// \param confirmCallback Called for each message when the broker
+    ///                        explicitly confirms/rejects it.
+    /// \param timeout         How long to wait for as a relative timeout. If
+    ///                        timeout is 0, the method will wait to send the
+    ///                        batch indefinitely
+    ///
+    /// \return SENDING        Returned when the library accepts the batch for
+    ///                        sending.
+    /// \return DUPLICATE      Returned if any message in the batch has the
+    ///                        same GUID as another message in the batch or
+    ///                        one awaiting a confirm from the broker.
+    /// \return TIMEOUT        Returned if the batch couldn't be enqueued
+    ///                        within the timeout time.
+    /// \return INFLIGHT_LIMIT Returned if the batch is larger than the
+    ///                        unconfirmed message limit, so could never be
+    ///                        sent.
+    virtual SendStatus
+    sendBatch(const bsl::vector<rmqt::Message>& messages,
+              const bsl::string& routingKey,
+              const rmqp::Producer::ConfirmationCallback& confirmCallback,
+              const bsls::TimeInterval& timeout) = 0;
+
+    /// \brief Send `message` once for each of `routingKeys`, to the exchange
+    /// targeted by the producer.
+    ///
+    /// The publishes share the message's payload and properties, message id
+    /// included; each is tracked under a GUID of its own. As with
+    /// `sendBatch`, room for all of them under the unconfirmed message limit
+    /// is reserved at once and they are handed to the connection as a
+    /// single write. `confirmCallback` is invoked once, when every publish
+    /// has been confirmed or rejected.
+    ///
+    /// Producers which do not support fanning out (e.g. batching or sharded
+    /// ones) send nothing and return INFLIGHT_LIMIT.
+    ///
+    /// \return SENDING, DUPLICATE, TIMEOUT or INFLIGHT_LIMIT as for
+    ///         `sendBatch` of as many messages.
+    virtual SendStatus
+    sendToMany(const rmqt::Message& message,
+               const bsl::vector<bsl::string>& routingKeys,
+               const FanOutConfirmationCallback& confirmCallback,
+               const bsls::TimeInterval& timeout);
+
+    /// \brief Send a control-plane message (e.g. a cancellation or a kill
+    /// switch) ahead of any messages still waiting to be published.
+    ///
+    /// Messages held back while the channel recovers, or while the broker
+    /// applies flow control, are overtaken: the message is published as soon
+    /// as the channel can write, before the resend of the backlog continues.
+    /// It is counted against a small reserve of the unconfirmed message
+    /// limit kept for urgent messages, and only waits for the limit once the
+    /// reserve is used up. It is not held back by the publish rate limit,
+    /// the publish spool or the memory budget.
+    ///
+    /// Producers without an urgent lane (e.g. batching or sharded ones) send
+    /// it as `send` would.
+    ///
+    /// \return SENDING, DUPLICATE or TIMEOUT as for `send`.
+    virtual SendStatus
+    sendUrgent(const rmqt::Message& message,
+               const bsl::string& routingKey,
+               const rmqp::Producer::ConfirmationCallback& confirmCallback,
+               const bsls::TimeInterval& timeout);
+
+    /// \brief Start sending a message whose body is written afterwards,
+    /// through the returned sink.
+    ///
+    /// For messages too large to hold in memory at once. The properties of
+    /// `message` are sent straight away, with a body of `bodySize` bytes; its
+    /// payload is ignored. The body is then published as it is written to
+    /// the sink, split into frames no larger than the connection's maximum
+    /// frame size. Other messages sent with this producer wait until the
+    /// body is complete. Only one stream can be open on a producer at a
+    /// time, and streamed messages are not compressed.
+    ///
+    /// Unlike `send`, a streamed message is not retried on reconnection, as
+    /// its body is not kept: if the connection is lost before the message is
+    /// confirmed, `confirmCallback` is invoked with REJECT.
+    ///
+    /// \param message         The message properties (and GUID) to send.
+    /// \param bodySize        The exact number of body bytes to be written.
+    /// \param routingKey      The routing key passed to the exchange.
+    /// \param confirmCallback Called when the broker confirms/rejects the
+    ///                        message, or when the stream fails.
+    /// \param timeout         How long to wait for the unconfirmed message
+    ///                        limit as a relative timeout. If timeout is 0,
+    ///                        the method will wait indefinitely
+    ///
+    /// \return The sink to write the body to. On failure the result code is
+    ///         a SendStatus: DUPLICATE or TIMEOUT as for `send`, or
+    ///         INFLIGHT_LIMIT if another stream is still open.
+    virtual rmqt::Result<MessageSink>
+    openStream(const rmqt::Message& message,
+               bsl::size_t bodySize,
+               const bsl::string& routingKey,
+               const rmqp::Producer::ConfirmationCallback& confirmCallback,
+               const bsls::TimeInterval& timeout) = 0;
+
+    /// \brief Send a message without a confirm callback, tracking its
+    /// confirm by sequence number instead.
+    ///
+    /// Behaves as `send` with RETURN_UNROUTABLE, but on success loads the
+    /// message's sequence number into `sequenceNumber`. Sequence numbers
+    /// start at 1 and increase by one with each message accepted by this
+    /// method. Once the confirm of every message up to N has arrived,
+    /// `confirmedThrough` returns N; those which were rejected or returned
+    /// are reported by `takeFailedSequences`. For publishers which only
+    /// need to know that everything up to a point is safe, this saves
+    /// storing and invoking a callback per message.
+    ///
+    /// Producers which do not track sequence numbers (e.g. batching or
+    /// sharded ones) send nothing and return INFLIGHT_LIMIT.
+    virtual SendStatus sendSequenced(const rmqt::Message& message,
+                                     const bsl::string& routingKey,
+                                     bsl::uint64_t* sequenceNumber,
+                                     const bsls::TimeInterval& timeout);
+
+    /// \brief Return the highest sequence number N such that the confirms
+    /// of every message sent with `sendSequenced` up to N have arrived, or
+    /// 0 if there is none. Lock-free.
+    virtual bsl::uint64_t confirmedThrough() const;
+
+    /// \brief Return, and forget, the messages sent with `sendSequenced`
+    /// which were rejected or returned since the last call.
+    virtual FailedSequences takeFailedSequences();
+
     /// \brief Wait for all outstanding publisher confirms to arrive.
     ///
     /// This method allows
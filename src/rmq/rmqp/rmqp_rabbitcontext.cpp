@@ -21,5 +21,20 @@ namespace rmqp {
 RabbitContext::RabbitContext() {}
 RabbitContext::~RabbitContext() {}
 
+rmqt::Result<> RabbitContext::shutdown(const bsls::TimeInterval&)
+{
+    return rmqt::Result<>("Shutdown is not supported by this context");
+}
+
+bsl::vector<rmqt::ConnectionStats>
+RabbitContext::stats(const bsls::TimeInterval&)
+{
+    return bsl::vector<rmqt::ConnectionStats>();
+}
+
+bsl::size_t RabbitContext::poll() { return 0; }
+
+bsl::size_t RabbitContext::runFor(const bsls::TimeInterval&) { return 0; }
+
 } // namespace rmqp
 } // namespace BloombergLP
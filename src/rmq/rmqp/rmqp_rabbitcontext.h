@@ -18,13 +18,19 @@
 
 #include <rmqp_connection.h>
 
+#include <rmqt_connectionstats.h>
 #include <rmqt_credentials.h>
 #include <rmqt_endpoint.h>
 #include <rmqt_future.h>
+#include <rmqt_result.h>
 #include <rmqt_vhostinfo.h>
 
+#include <bsls_timeinterval.h>
+
+#include <bsl_cstddef.h>
 #include <bsl_memory.h>
 #include <bsl_string.h>
+#include <bsl_vector.h>
 
 namespace BloombergLP {
 namespace rmqp {
@@ -67,6 +73,29 @@ class RabbitContext {
     createVHostConnection(const bsl::string& userDefinedName,
                           const rmqt::VHostInfo& endpoint) = 0;
 
+    /// \brief Drain and close every connection of this context at once
+    ///
+    /// The default implementation returns an error: contexts which can shut
+    /// down their connections override this.
+    virtual rmqt::Result<> shutdown(const bsls::TimeInterval& timeout);
+
+    /// \brief Snapshot the counters of every connection of this context
+    ///
+    /// The default implementation returns no connections.
+    virtual bsl::vector<rmqt::ConnectionStats>
+    stats(const bsls::TimeInterval& timeout);
+
+    /// \brief Run the work ready on the context's event loops on the
+    /// calling thread, for contexts the application drives
+    ///
+    /// The default implementation runs nothing and returns 0.
+    virtual bsl::size_t poll();
+
+    /// \brief As `poll`, waiting up to `duration` for work
+    ///
+    /// The default implementation runs nothing and returns 0.
+    virtual bsl::size_t runFor(const bsls::TimeInterval& duration);
+
   private:
     RabbitContext(const RabbitContext&) BSLS_KEYWORD_DELETED;
     RabbitContext& operator=(const RabbitContext&) BSLS_KEYWORD_DELETED;
@@ -0,0 +1,59 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// rmqp_rpcclient.h
+#ifndef INCLUDED_RMQP_RPCCLIENT
+#define INCLUDED_RMQP_RPCCLIENT
+
+#include <rmqt_future.h>
+#include <rmqt_message.h>
+
+#include <bsl_string.h>
+
+//@PURPOSE: Provide a RabbitMQ request/response client API
+//
+//@CLASSES:
+//  rmqp::RpcClient: an interface for making RPC calls over RabbitMQ
+
+namespace BloombergLP {
+namespace rmqp {
+
+/// \brief Sends requests and resolves a future with each reply
+///
+/// Replies come back through RabbitMQ direct reply-to
+/// (https://www.rabbitmq.com/direct-reply-to.html): the server publishes
+/// its reply to the default exchange, with the request's `replyTo` as the
+/// routing key and the request's `correlationId`.
+class RpcClient {
+  public:
+    /// \brief Publish `request` with `routingKey` to the client's exchange.
+    ///
+    /// Overwrites the `replyTo` and `correlationId` properties of
+    /// `request`. May be called from any thread.
+    ///
+    /// \return A future resolved with the reply, or with an error if the
+    ///         request could not be sent, or its reply was lost with the
+    ///         connection. A reply that never comes leaves the future
+    ///         unresolved: wait for it with a timeout.
+    virtual rmqt::Future<rmqt::Message> call(const rmqt::Message& request,
+                                             const bsl::string& routingKey) = 0;
+
+    virtual ~RpcClient();
+};
+
+} // namespace rmqp
+} // namespace BloombergLP
+
+#endif // ! INCLUDED_RMQP_RPCCLIENT
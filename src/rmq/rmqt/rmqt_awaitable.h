@@ -0,0 +1,147 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQT_AWAITABLE
+#define INCLUDED_RMQT_AWAITABLE
+
+#include <rmqt_future.h>
+#include <rmqt_result.h>
+
+#include <bdlf_bind.h>
+#include <bsls_atomic.h>
+
+#include <bsl_functional.h>
+#include <bsl_memory.h>
+
+//@PURPOSE: C++20 coroutine support for rmqt::Future
+//
+//@CLASSES:
+//  rmqt::Awaitable: Suspends a coroutine until a Future resolves
+//
+//@MACROS:
+//  RMQT_AWAITABLE_SUPPORTED: Defined when the compiler supports coroutines
+//
+// Everything in this component needs C++20 coroutines. Other language
+// levels see an empty header, so it is always safe to include.
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+
+#include <coroutine>
+
+#define RMQT_AWAITABLE_SUPPORTED 1
+
+namespace BloombergLP {
+namespace rmqt {
+
+/// \brief Awaits a `Future<T>` from a coroutine, without blocking a thread
+///
+/// `co_await rmqt::Awaitable<T>(future, executor)` suspends the coroutine
+/// until `future` resolves and evaluates to its `Result<T>`. The coroutine
+/// is resumed by passing a job to `executor` (e.g. enqueueing it on a
+/// thread pool or the application's own event loop), or, with no executor,
+/// on whichever thread resolves the future. For futures resolved by the
+/// library that is an event loop thread, which must not be blocked. If the
+/// future has already resolved the coroutine carries on without suspending.
+///
+/// `co_await future` is shorthand for awaiting with no executor.
+///
+/// A coroutine must not be destroyed while it is suspended here.
+
+template <typename T>
+class Awaitable {
+  public:
+    /// Runs the job resuming the coroutine
+    typedef bsl::function<void(const bsl::function<void()>&)> Executor;
+
+    explicit Awaitable(const Future<T>& future,
+                       const Executor& executor = Executor())
+    : d_future(future)
+    , d_state(bsl::make_shared<State>(executor))
+    {
+    }
+
+    bool await_ready() const { return false; }
+
+    bool await_suspend(std::coroutine_handle<> handle)
+    {
+        d_state->d_handle = handle;
+
+        // Resolves immediately if the future already has a result. The
+        // chained future is not needed, its callback runs regardless
+        d_future.template then<T>(bdlf::BindUtil::bind(
+            &State::resolved, d_state, bdlf::PlaceHolders::_1));
+
+        // Stay suspended unless the callback has already run
+        return d_state->d_stage.testAndSwap(State::e_INITIAL,
+                                            State::e_SUSPENDED) ==
+               State::e_INITIAL;
+    }
+
+    Result<T> await_resume() const { return d_state->d_result; }
+
+  private:
+    /// Shared with the callback, which may outlive the awaiting expression
+    struct State {
+        enum Stage { e_INITIAL, e_SUSPENDED, e_RESOLVED };
+
+        explicit State(const Executor& executor)
+        : d_stage(e_INITIAL)
+        , d_result("Null")
+        , d_executor(executor)
+        , d_handle()
+        {
+        }
+
+        static Result<T> resolved(const bsl::shared_ptr<State>& state,
+                                  const Result<T>& result)
+        {
+            state->d_result = result;
+            if (state->d_stage.swap(e_RESOLVED) == e_SUSPENDED) {
+                if (state->d_executor) {
+                    state->d_executor(
+                        bdlf::BindUtil::bind(&State::resume, state->d_handle));
+                }
+                else {
+                    state->d_handle.resume();
+                }
+            }
+            return result;
+        }
+
+        static void resume(std::coroutine_handle<> handle) { handle.resume(); }
+
+        bsls::AtomicInt d_stage;
+        Result<T> d_result;
+        Executor d_executor;
+        std::coroutine_handle<> d_handle;
+    };
+
+    Future<T> d_future;
+    bsl::shared_ptr<State> d_state;
+};
+
+/// Await `future`, resuming on the thread which resolves it
+template <typename T>
+Awaitable<T> operator co_await(const Future<T>& future)
+{
+    return Awaitable<T>(future);
+}
+
+} // namespace rmqt
+} // namespace BloombergLP
+
+#endif
+
+#endif
@@ -0,0 +1,86 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqt_connectionstats.h>
+
+namespace BloombergLP {
+namespace rmqt {
+
+ChannelStats::ChannelStats()
+: channelId(0)
+, type(PRODUCER)
+, messagesIn(0)
+, bytesIn(0)
+, messagesOut(0)
+, bytesOut(0)
+, inFlightConfirms(0)
+, unackedDeliveries(0)
+, topologyDeclareTime()
+{
+}
+
+ConnectionStats::ConnectionStats()
+: name()
+, vhost()
+, connected(false)
+, messagesIn(0)
+, bytesIn(0)
+, messagesOut(0)
+, bytesOut(0)
+, inFlightConfirms(0)
+, unackedDeliveries(0)
+, queuedWrites(0)
+, connectTime()
+, reconnects(0)
+, channels()
+{
+}
+
+bsl::ostream& operator<<(bsl::ostream& os, const ChannelStats& stats)
+{
+    os << "[ channel: " << stats.channelId << ", type: "
+       << (stats.type == ChannelStats::PRODUCER ? "producer" : "consumer")
+       << ", in: " << stats.messagesIn << " (" << stats.bytesIn
+       << " bytes), out: " << stats.messagesOut << " (" << stats.bytesOut
+       << " bytes), inFlightConfirms: " << stats.inFlightConfirms
+       << ", unackedDeliveries: " << stats.unackedDeliveries
+       << ", topologyDeclareTime: "
+       << stats.topologyDeclareTime.totalSecondsAsDouble() << "s ]";
+    return os;
+}
+
+bsl::ostream& operator<<(bsl::ostream& os, const ConnectionStats& stats)
+{
+    os << "[ name: " << stats.name << ", vhost: " << stats.vhost
+       << ", connected: " << stats.connected << ", in: " << stats.messagesIn
+       << " (" << stats.bytesIn << " bytes), out: " << stats.messagesOut
+       << " (" << stats.bytesOut
+       << " bytes), inFlightConfirms: " << stats.inFlightConfirms
+       << ", unackedDeliveries: " << stats.unackedDeliveries
+       << ", queuedWrites: " << stats.queuedWrites
+       << ", connectTime: " << stats.connectTime.totalSecondsAsDouble()
+       << "s, reconnects: " << stats.reconnects << ", channels: [";
+    for (bsl::vector<ChannelStats>::const_iterator it =
+             stats.channels.begin();
+         it != stats.channels.end();
+         ++it) {
+        os << " " << *it;
+    }
+    os << " ] ]";
+    return os;
+}
+
+} // namespace rmqt
+} // namespace BloombergLP
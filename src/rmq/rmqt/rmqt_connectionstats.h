@@ -0,0 +1,106 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQT_CONNECTIONSTATS
+#define INCLUDED_RMQT_CONNECTIONSTATS
+
+#include <bsls_timeinterval.h>
+#include <bsls_types.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_cstdint.h>
+#include <bsl_ostream.h>
+#include <bsl_string.h>
+#include <bsl_vector.h>
+
+//@PURPOSE: Point-in-time counters of connections and their channels
+//
+//@CLASSES:
+//  rmqt::ChannelStats: Traffic and outstanding messages of one channel
+//  rmqt::ConnectionStats: A connection's state, writes and channels
+
+namespace BloombergLP {
+namespace rmqt {
+
+/// \brief Counters of one channel, as returned by
+/// `rmqa::RabbitContext::stats`. Message and byte counts are totals since
+/// the channel was created; bytes are payload bytes.
+struct ChannelStats {
+    enum Type { PRODUCER, CONSUMER };
+
+    ChannelStats();
+
+    bsl::uint16_t channelId;
+    Type type;
+
+    /// Deliveries received, for a consumer channel
+    bsls::Types::Int64 messagesIn;
+    bsls::Types::Int64 bytesIn;
+
+    /// Messages published, for a producer channel
+    bsls::Types::Int64 messagesOut;
+    bsls::Types::Int64 bytesOut;
+
+    /// Published messages not yet confirmed by the broker
+    bsl::size_t inFlightConfirms;
+
+    /// Delivered messages not yet acked back to the broker
+    bsl::size_t unackedDeliveries;
+
+    /// How long the latest topology declaration took, from sending the
+    /// first declaration to its last reply. Zero until one completes.
+    bsls::TimeInterval topologyDeclareTime;
+};
+
+/// \brief Counters of one connection and its channels, as returned by
+/// `rmqa::RabbitContext::stats`. The traffic totals are the sums over its
+/// current channels.
+struct ConnectionStats {
+    ConnectionStats();
+
+    bsl::string name;
+    bsl::string vhost;
+    bool connected;
+
+    bsls::Types::Int64 messagesIn;
+    bsls::Types::Int64 bytesIn;
+    bsls::Types::Int64 messagesOut;
+    bsls::Types::Int64 bytesOut;
+    bsl::size_t inFlightConfirms;
+    bsl::size_t unackedDeliveries;
+
+    /// Writes queued for the socket, and not yet written
+    bsl::size_t queuedWrites;
+
+    /// How long the latest connect took, from opening the socket to
+    /// connection.open-ok: a few network round trips to the broker. Zero
+    /// until connected.
+    bsls::TimeInterval connectTime;
+
+    /// Times the connection has been re-established since it first
+    /// connected, including by failing over to a standby
+    bsls::Types::Int64 reconnects;
+
+    bsl::vector<ChannelStats> channels;
+};
+
+bsl::ostream& operator<<(bsl::ostream& os, const ChannelStats& stats);
+
+bsl::ostream& operator<<(bsl::ostream& os, const ConnectionStats& stats);
+
+} // namespace rmqt
+} // namespace BloombergLP
+
+#endif
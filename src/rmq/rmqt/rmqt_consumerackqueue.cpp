@@ -0,0 +1,69 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqt_consumerackqueue.h>
+
+#include <rmqt_envelope.h>
+
+namespace BloombergLP {
+namespace rmqt {
+
+ConsumerAckQueue::ConsumerAckQueue()
+: d_acks()
+, d_drainPending(false)
+, d_callbackTiming(false)
+, d_callbackNanos(0)
+, d_callbackMessages(0)
+{
+}
+
+bool ConsumerAckQueue::push(const ConsumerAck& ack)
+{
+    d_acks.pushBack(ack);
+
+    return !d_drainPending.testAndSwap(false, true);
+}
+
+void ConsumerAckQueue::drain(bsl::vector<ConsumerAck>* acks)
+{
+    // Cleared first, so an ack pushed after the queue looks empty below
+    // asks for another drain
+    d_drainPending.store(false);
+
+    ConsumerAck ack(Envelope(0, 0, "", "", "", false), ConsumerAck::ACK);
+    while (d_acks.tryPopFront(&ack) == 0) {
+        acks->push_back(ack);
+    }
+}
+
+void ConsumerAckQueue::clear() { d_acks.removeAll(); }
+
+void ConsumerAckQueue::recordCallbackTime(bsls::Types::Int64 nanos,
+                                          bsls::Types::Int64 messages)
+{
+    d_callbackNanos.addRelaxed(nanos);
+    d_callbackMessages.addRelaxed(messages);
+}
+
+void ConsumerAckQueue::takeCallbackTimes(bsls::Types::Int64* nanos,
+                                         bsls::Types::Int64* messages)
+{
+    // Not an atomic snapshot of both, which is fine for an average
+    *nanos    = d_callbackNanos.swap(0);
+    *messages = d_callbackMessages.swap(0);
+}
+
+} // namespace rmqt
+} // namespace BloombergLP
@@ -0,0 +1,95 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQT_CONSUMERACKQUEUE
+#define INCLUDED_RMQT_CONSUMERACKQUEUE
+
+#include <rmqt_consumerack.h>
+
+#include <bdlcc_singleconsumerqueue.h>
+#include <bsls_atomic.h>
+#include <bsls_keyword.h>
+#include <bsls_types.h>
+
+#include <bsl_vector.h>
+
+//@PURPOSE: Hand consumer acks from worker threads to the event loop
+//
+//@CLASSES:
+//  rmqt::ConsumerAckQueue: lock-free multi-producer ack queue
+
+namespace BloombergLP {
+namespace rmqt {
+
+/// \brief Queue of acks/nacks from consumer threads for one ReceiveChannel
+///
+/// Any number of threads `push` acks without taking a lock. The event loop
+/// takes everything queued in one pass with `drain`. Only the push which
+/// finds the queue idle asks for a drain to be posted, so a busy consumer
+/// posts roughly once per event loop iteration rather than once per ack.
+///
+/// The queue can also carry consumer callback timings back to the channel,
+/// which uses them to adapt the prefetch count.
+
+class ConsumerAckQueue {
+  public:
+    ConsumerAckQueue();
+
+    /// Queue `ack`. Thread-safe.
+    /// \return true if no drain is pending, in which case the caller must
+    ///         arrange for `drain` to be called on the event loop
+    bool push(const ConsumerAck& ack);
+
+    /// Append every queued ack to `acks`, oldest first, and mark the queue
+    /// idle. Must only be called from one thread at a time.
+    void drain(bsl::vector<ConsumerAck>* acks);
+
+    /// Discard every queued ack. A drain which is pending stays pending.
+    void clear();
+
+    /// Start collecting callback timings, see `recordCallbackTime`
+    void enableCallbackTiming() { d_callbackTiming.store(true); }
+
+    bool callbackTimingEnabled() const
+    {
+        return d_callbackTiming.loadRelaxed();
+    }
+
+    /// Record that `messages` messages were handled by a callback taking
+    /// `nanos` nanoseconds. Thread-safe.
+    void recordCallbackTime(bsls::Types::Int64 nanos,
+                            bsls::Types::Int64 messages = 1);
+
+    /// Load the callback nanoseconds and message count recorded since the
+    /// last call, and reset them
+    void takeCallbackTimes(bsls::Types::Int64* nanos,
+                           bsls::Types::Int64* messages);
+
+  private:
+    ConsumerAckQueue(const ConsumerAckQueue&) BSLS_KEYWORD_DELETED;
+    ConsumerAckQueue& operator=(const ConsumerAckQueue&) BSLS_KEYWORD_DELETED;
+
+    bdlcc::SingleConsumerQueue<ConsumerAck> d_acks;
+    bsls::AtomicBool d_drainPending;
+
+    bsls::AtomicBool d_callbackTiming;
+    bsls::AtomicInt64 d_callbackNanos;
+    bsls::AtomicInt64 d_callbackMessages;
+};
+
+} // namespace rmqt
+} // namespace BloombergLP
+
+#endif
@@ -15,13 +15,38 @@
 
 #include <rmqt_consumerconfig.h>
 
+#include <rmqt_fieldvalue.h>
+
 #include <bdlb_guidutil.h>
+#include <bdlf_bind.h>
+#include <bdlf_placeholder.h>
+
+#include <bsl_sstream.h>
 
 namespace BloombergLP {
 namespace rmqt {
+namespace {
+
+bsl::string headerValue(const bsl::string& header,
+                        const rmqt::Message& message,
+                        const rmqt::Envelope&)
+{
+    rmqt::FieldValue value;
+    if (!message.findHeader(&value, header)) {
+        return bsl::string();
+    }
+
+    bsl::ostringstream key;
+    key << value;
+    return key.str();
+}
+
+} // namespace
 
 const uint16_t ConsumerConfig::s_defaultPrefetchCount = 5;
 
+const uint16_t ConsumerConfig::s_defaultStreamPrefetchCount = 1000;
+
 ConsumerConfig::ConsumerConfig(
     const bsl::string& consumerTag /*= generateConsumerTag()*/,
     uint16_t prefetchCount /* = s_defaultPrefetchCount*/,
@@ -33,11 +58,55 @@ ConsumerConfig::ConsumerConfig(
 , d_threadpool(threadpool)
 , d_exclusiveFlag(exclusiveFlag)
 , d_consumerPriority(consumerPriority)
+, d_maxBatchSize(0)
+, d_maxBatchLinger()
+, d_dispatch(rmqt::ConsumerDispatch::THREADPOOL)
+, d_ackCoalescingDelay()
+, d_ackCoalescingTags(0)
+, d_minPrefetchCount(0)
+, d_maxPrefetchCount(0)
+, d_prefetchBytes(0)
+, d_slowStartPrefetchCount(0)
+, d_lazyHeaders(false)
+, d_decodedProperties(rmqt::MessageProperty::ALL)
+, d_noAck(false)
+, d_partitions(0)
+, d_partitionKey()
+, d_preFilter()
+, d_payloadAllocator()
+, d_rejectFiltered(false)
+, d_staleMessagePolicy(rmqt::StaleMessagePolicy::DELIVER)
+, d_deadlineHeader()
+, d_saturationProbe()
+, d_redeliveryFilterCapacity(0)
+, d_redeliveryFilterWindow()
+, d_redeliveryKey()
+, d_streamOffset()
 {
 }
 
 ConsumerConfig::~ConsumerConfig() {}
 
+ConsumerConfig& ConsumerConfig::setPartitionKeyHeader(const bsl::string& header)
+{
+    d_partitionKey = bdlf::BindUtil::bind(&headerValue,
+                                          header,
+                                          bdlf::PlaceHolders::_1,
+                                          bdlf::PlaceHolders::_2);
+    return *this;
+}
+
+ConsumerConfig
+ConsumerConfig::forStream(const rmqt::StreamOffset& offset,
+                          const bsl::string& consumerTag)
+{
+    ConsumerConfig config(consumerTag, s_defaultStreamPrefetchCount);
+    config.setStreamOffset(offset)
+        .setAckCoalescingDelay(bsls::TimeInterval(0, 10 * 1000 * 1000))
+        .setAckCoalescingTags(s_defaultStreamPrefetchCount / 4);
+    return config;
+}
+
 bsl::string rmqt::ConsumerConfig::generateConsumerTag()
 {
     return bdlb::GuidUtil::guidToString(bdlb::GuidUtil::generate());
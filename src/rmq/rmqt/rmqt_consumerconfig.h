@@ -17,18 +17,84 @@
 #ifndef INCLUDED_RMQT_CONSUMERCONFIG
 #define INCLUDED_RMQT_CONSUMERCONFIG
 
+#include <rmqt_envelope.h>
+#include <rmqt_message.h>
 #include <rmqt_properties.h>
 #include <rmqt_queue.h>
+#include <rmqt_streamoffset.h>
 #include <rmqt_topology.h>
 
 #include <bdlmt_threadpool.h>
+#include <bsls_timeinterval.h>
 
+#include <bsl_cstddef.h>
 #include <bsl_cstdint.h>
+#include <bsl_functional.h>
+#include <bsl_memory.h>
 #include <bsl_optional.h>
+#include <bsl_string.h>
 
 namespace BloombergLP {
 namespace rmqt {
 
+/// How a consumer hands received messages to its callback
+/// THREADPOOL: one threadpool job per message (or batch). Callbacks may run
+///             concurrently, and out of order, on a multi-threaded pool.
+/// ORDERED: messages queue on a per-consumer lock-free queue drained by one
+///          threadpool job at a time. Callbacks run one at a time, in
+///          delivery order.
+/// EVENT_LOOP: callbacks run directly on the connection's event loop thread,
+///             with no threadpool hop. For very cheap handlers only (counters,
+///             handing off to the application's own queue): while a callback
+///             runs no other I/O, heartbeats or timers on the connection
+///             make progress. Callbacks must not block, and must not call
+///             anything which waits on the event loop, for example
+///             `Future::blockResult()`, `Consumer::cancelAndDrain()` or a
+///             blocking `Producer::send()`. Doing so deadlocks the
+///             connection. Acking from the callback is fine. The time spent
+///             in each callback is published as the
+///             `inline_callback_seconds` distribution.
+/// PARTITIONED: each message is hashed by its partition key (the routing key
+///              unless set with `ConsumerConfig::setPartitionKey`) to one of
+///              `ConsumerConfig::partitions()` lanes. Each lane runs like
+///              ORDERED, and the lanes run in parallel on the threadpool:
+///              callbacks for messages with equal keys run one at a time, in
+///              delivery order. Batch consumers deliver their batches on a
+///              single lane, as with ORDERED.
+/// WORK_STEALING: like THREADPOOL, but on the context's work-stealing
+///                executor (see `RabbitContextOptions::
+///                setWorkStealingDispatch`), which takes turns between
+///                consumers so that a burst on one queue does not hold up
+///                the others. Callbacks may run concurrently, and out of
+///                order. Falls back to THREADPOOL if the context has no
+///                executor, or the consumer is given its own threadpool.
+/// PRIORITY: like THREADPOOL, but each threadpool job takes the prefetched
+///           message with the highest `rmqt::Properties::priority` still
+///           waiting, rather than the one it was queued for: urgent
+///           messages overtake those prefetched before them. Equal
+///           priorities are delivered in order, and messages without one
+///           count as priority 0. Batch consumers deliver as THREADPOOL.
+namespace ConsumerDispatch {
+typedef enum {
+    THREADPOOL    = 0,
+    ORDERED       = 1,
+    EVENT_LOOP    = 2,
+    PARTITIONED   = 3,
+    WORK_STEALING = 4,
+    PRIORITY      = 5
+} Value;
+}
+
+/// What a consumer does with a message whose deadline has passed by the
+/// time it is received, see `ConsumerConfig::setStaleMessagePolicy`.
+namespace StaleMessagePolicy {
+typedef enum {
+    DELIVER     = 0, ///< Pass it to the callback like any other message
+    ACK         = 1, ///< Ack it without invoking the callback
+    DEAD_LETTER = 2  ///< Reject it (without requeue), dead-lettering it
+} Value;
+}
+
 /// \brief Class for passing arguments to Consumer
 ///
 /// This class provides passing arguments to Consumer.
@@ -37,15 +103,108 @@ class ConsumerConfig {
   public:
     static const uint16_t s_defaultPrefetchCount;
 
+    /// The prefetch count set by `forStream`
+    static const uint16_t s_defaultStreamPrefetchCount;
+
+    /// Return the key of a message for `ConsumerDispatch::PARTITIONED`.
+    /// Invoked on the connection's event loop thread, so must be cheap and
+    /// must not block.
+    typedef bsl::function<bsl::string(const rmqt::Message&,
+                                      const rmqt::Envelope&)>
+        PartitionKeyFunc;
+
+    /// Return false for a message the consumer has no use for, see
+    /// `setPreFilter`. Invoked on the connection's event loop thread, so
+    /// must be cheap and must not block.
+    typedef bsl::function<bool(const rmqt::Message&, const rmqt::Envelope&)>
+        PreFilterFunc;
+
+    /// Return a buffer of at least `bodySize` bytes to assemble a delivery's
+    /// body into, or null to have the library allocate it, see
+    /// `setPayloadAllocator`. Invoked on the connection's event loop thread,
+    /// so must be cheap and must not block.
+    typedef bsl::function<bsl::shared_ptr<uint8_t>(bsl::size_t bodySize)>
+        PayloadAllocatorFunc;
+
+    /// Return true while the process is too busy to take on more messages,
+    /// see `setSaturationProbe`. Invoked on the connection's event loop
+    /// thread, so must be cheap and must not block.
+    typedef bsl::function<bool()> SaturationFunc;
+
+    /// Return the key redeliveries are recognised by, see
+    /// `setRedeliveryFilter`. Invoked on the connection's event loop thread
+    /// and the threads acking messages, so must be cheap and must not block.
+    typedef bsl::function<bsl::string(const rmqt::Message&,
+                                      const rmqt::Envelope&)>
+        RedeliveryKeyFunc;
+
     /// \brief Util method to generate a default Consumer tag.
     static bsl::string generateConsumerTag();
 
+    /// \brief Return a config for consuming a stream queue from `offset`.
+    ///
+    /// Stream consumers read from a log rather than a queue of messages
+    /// waiting for them, so throughput is limited by the credit the broker
+    /// has to hand out: this sets a large prefetch count
+    /// (`s_defaultStreamPrefetchCount`), and coalesces acks so that they
+    /// return credit in batches. Acks on a stream only return credit: they
+    /// do not remove messages.
+    static ConsumerConfig
+    forStream(const rmqt::StreamOffset& offset,
+              const bsl::string& consumerTag = generateConsumerTag());
+
     /// \param consumerTag A label for the consumer which is displayed on the
     ///        RabbitMQ Management UI. It is useful to give this a meaningful
     ///        name.
     /// \param prefetchCount Used by the RabbitMQ broker to limit the number of
     ///        messages held by a consumer at one time. Higher values can
     ///        increase throughput, particularly in high latency environments.
+    /// \param minPrefetchCount Lower bound for the adaptive prefetch count,
+    ///        see `setMaxPrefetchCount`. Defaults to 0, treated as 1.
+    ConsumerConfig& setMinPrefetchCount(uint16_t minPrefetchCount)
+    {
+        d_minPrefetchCount = minPrefetchCount;
+        return *this;
+    }
+
+    /// \param maxPrefetchCount Setting an upper bound above
+    ///        `minPrefetchCount` makes the prefetch count adaptive: starting
+    ///        from `prefetchCount`, it grows while callbacks pick up messages
+    ///        as soon as they arrive, and shrinks when messages wait a long
+    ///        time for a callback, which means they are buffered needlessly.
+    ///        Defaults to 0, a fixed prefetch count.
+    ConsumerConfig& setMaxPrefetchCount(uint16_t maxPrefetchCount)
+    {
+        d_maxPrefetchCount = maxPrefetchCount;
+        return *this;
+    }
+
+    /// \param prefetchBytes Limit the payload bytes of messages delivered
+    ///        and not yet acked, as well as their number: RabbitMQ ignores
+    ///        basic.qos prefetch-size, so once this many bytes are held
+    ///        the prefetch count drops to 1, pausing deliveries, until acks
+    ///        bring them back under the limit. The message which crosses
+    ///        the limit is still delivered, so one message larger than it
+    ///        can always get through. Defaults to 0, no limit.
+    ConsumerConfig& setPrefetchBytes(bsl::size_t prefetchBytes)
+    {
+        d_prefetchBytes = prefetchBytes;
+        return *this;
+    }
+
+    /// \param slowStartPrefetchCount Start the consumer with this prefetch
+    ///        count, rather than `prefetchCount`, each time its channel
+    ///        (re)opens, so that a consumer of a deep queue is not handed a
+    ///        full prefetch of messages while its caches are still cold.
+    ///        The prefetch count doubles each time as many messages as it
+    ///        allows have been acked, until it reaches `prefetchCount`, so
+    ///        slow callbacks ramp up slowly. Defaults to 0, no slow start.
+    ConsumerConfig& setSlowStartPrefetchCount(uint16_t slowStartPrefetchCount)
+    {
+        d_slowStartPrefetchCount = slowStartPrefetchCount;
+        return *this;
+    }
+
     /// \param threadpool threadpool which should be used to process consumer
     ///        (message) callbacks, defaults to using the context level
     ///        threadpool
@@ -82,6 +241,97 @@ class ConsumerConfig {
         return d_consumerPriority;
     }
 
+    bsl::size_t maxBatchSize() const { return d_maxBatchSize; }
+
+    const bsls::TimeInterval& maxBatchLinger() const
+    {
+        return d_maxBatchLinger;
+    }
+
+    rmqt::ConsumerDispatch::Value dispatch() const { return d_dispatch; }
+
+    const bsls::TimeInterval& ackCoalescingDelay() const
+    {
+        return d_ackCoalescingDelay;
+    }
+
+    bsl::size_t ackCoalescingTags() const { return d_ackCoalescingTags; }
+
+    uint16_t minPrefetchCount() const { return d_minPrefetchCount; }
+    uint16_t maxPrefetchCount() const { return d_maxPrefetchCount; }
+    bsl::size_t prefetchBytes() const { return d_prefetchBytes; }
+    uint16_t slowStartPrefetchCount() const
+    {
+        return d_slowStartPrefetchCount;
+    }
+
+    bool lazyHeaders() const { return d_lazyHeaders; }
+
+    int decodedProperties() const { return d_decodedProperties; }
+
+    bool noAck() const { return d_noAck; }
+
+    /// Number of lanes for `ConsumerDispatch::PARTITIONED`, zero for one per
+    /// threadpool thread
+    bsl::size_t partitions() const { return d_partitions; }
+
+    /// Empty to partition by routing key
+    const PartitionKeyFunc& partitionKey() const { return d_partitionKey; }
+
+    /// Empty to pass every message to the consumer callback
+    const PreFilterFunc& preFilter() const { return d_preFilter; }
+
+    /// Empty to assemble message bodies in buffers the library allocates
+    const PayloadAllocatorFunc& payloadAllocator() const
+    {
+        return d_payloadAllocator;
+    }
+
+    /// True if messages `preFilter` drops are rejected rather than acked
+    bool rejectFiltered() const { return d_rejectFiltered; }
+
+    /// DELIVER (the default) to invoke the callback for stale messages too
+    rmqt::StaleMessagePolicy::Value staleMessagePolicy() const
+    {
+        return d_staleMessagePolicy;
+    }
+
+    /// Header holding a message's deadline, empty if only `expiration` is
+    /// checked
+    const bsl::string& deadlineHeader() const { return d_deadlineHeader; }
+
+    /// Empty unless the prefetch count sheds load while saturated
+    const SaturationFunc& saturationProbe() const { return d_saturationProbe; }
+
+    /// Number of acked message keys remembered, zero (the default) to
+    /// deliver redeliveries like any other message
+    bsl::size_t redeliveryFilterCapacity() const
+    {
+        return d_redeliveryFilterCapacity;
+    }
+
+    /// How long acked message keys are remembered, zero for no limit
+    const bsls::TimeInterval& redeliveryFilterWindow() const
+    {
+        return d_redeliveryFilterWindow;
+    }
+
+    /// Empty to recognise redeliveries by message id
+    const RedeliveryKeyFunc& redeliveryKey() const { return d_redeliveryKey; }
+
+    /// Set for consumers of stream queues
+    const bsl::optional<rmqt::StreamOffset>& streamOffset() const
+    {
+        return d_streamOffset;
+    }
+
+    /// True if the prefetch count adapts within
+    /// [`minPrefetchCount`, `maxPrefetchCount`]
+    bool adaptivePrefetch() const
+    {
+        return d_maxPrefetchCount > d_minPrefetchCount;
+    }
+
     // Setters
     /// \param consumerTag A label for the consumer which is displayed on the
     ///        RabbitMQ Management UI. It is useful to give this a meaningful
@@ -140,12 +390,250 @@ class ConsumerConfig {
         return *this;
     }
 
+    /// \param maxBatchSize The most messages passed to one invocation of a
+    ///        batch consumer callback (see `VHost::createBatchConsumer`).
+    ///        Zero (the default) uses the prefetchCount. Batches larger than
+    ///        the prefetchCount can only be completed by `maxBatchLinger`.
+    ConsumerConfig& setMaxBatchSize(bsl::size_t maxBatchSize)
+    {
+        d_maxBatchSize = maxBatchSize;
+        return *this;
+    }
+
+    /// \param maxBatchLinger How long a batch consumer waits for a batch to
+    ///        fill after its first message arrives before delivering it
+    ///        anyway. Zero (the default) delivers whatever has arrived once
+    ///        the event loop has processed the current network read.
+    ConsumerConfig& setMaxBatchLinger(const bsls::TimeInterval& maxBatchLinger)
+    {
+        d_maxBatchLinger = maxBatchLinger;
+        return *this;
+    }
+
+    /// \param ackCoalescingDelay How long acks may be held before being sent
+    ///        to the broker as one multiple ack. Zero (the default) sends
+    ///        acks as soon as the event loop picks them up. Held acks count
+    ///        against the prefetch window, so keep this well below the time
+    ///        it takes to process `prefetchCount` messages.
+    ConsumerConfig&
+    setAckCoalescingDelay(const bsls::TimeInterval& ackCoalescingDelay)
+    {
+        d_ackCoalescingDelay = ackCoalescingDelay;
+        return *this;
+    }
+
+    /// \param ackCoalescingTags Send held acks early once this many are held.
+    ///        Zero (the default) for no limit. Only used with a non-zero
+    ///        `ackCoalescingDelay`.
+    ConsumerConfig& setAckCoalescingTags(bsl::size_t ackCoalescingTags)
+    {
+        d_ackCoalescingTags = ackCoalescingTags;
+        return *this;
+    }
+
+    /// \param dispatch How received messages are handed to the consumer
+    ///        callback, see `rmqt::ConsumerDispatch`. Defaults to THREADPOOL.
+    ConsumerConfig& setDispatch(rmqt::ConsumerDispatch::Value dispatch)
+    {
+        d_dispatch = dispatch;
+        return *this;
+    }
+
+    /// \param lazyHeaders Keep the headers of consumed messages encoded,
+    ///        decoding a header only when it is looked up with
+    ///        `rmqt::Message::findHeader`, or the whole table on the first
+    ///        call to `rmqt::Message::decodedHeaders`. With lazy headers
+    ///        `rmqt::Message::headers()` is null. Defaults to false.
+    ConsumerConfig& setLazyHeaders(bool lazyHeaders = true)
+    {
+        d_lazyHeaders = lazyHeaders;
+        return *this;
+    }
+
+    /// \param decodedProperties The message properties the consumer needs,
+    ///        as `rmqt::MessageProperty` values combined with `|`. Other
+    ///        properties of consumed messages are skipped over rather than
+    ///        decoded, and are unset on the `rmqt::Message`, except for the
+    ///        headers which are kept encoded as with `setLazyHeaders`.
+    ///        Defaults to `rmqt::MessageProperty::ALL`.
+    ConsumerConfig& setDecodedProperties(int decodedProperties)
+    {
+        d_decodedProperties = decodedProperties;
+        return *this;
+    }
+
+    /// \param noAck Consume in at-most-once mode: the broker considers each
+    ///        message acknowledged as soon as it is delivered, so
+    ///        `ack`/`nack` on its `rmqp::MessageGuard` do nothing and no
+    ///        per-message bookkeeping is kept. Messages not yet processed
+    ///        when the connection drops, or when the consumer is cancelled,
+    ///        are lost. The broker does not apply prefetch to such a
+    ///        consumer, so the prefetch settings have no effect. Defaults to
+    ///        false.
+    ConsumerConfig& setNoAck(bool noAck = true)
+    {
+        d_noAck = noAck;
+        return *this;
+    }
+
+    /// \param partitions Number of lanes messages are spread over with
+    ///        `ConsumerDispatch::PARTITIONED`. Defaults to 0, one lane per
+    ///        thread of the consumer's threadpool.
+    ConsumerConfig& setPartitions(bsl::size_t partitions)
+    {
+        d_partitions = partitions;
+        return *this;
+    }
+
+    /// \param partitionKey Returns the key messages are partitioned by with
+    ///        `ConsumerDispatch::PARTITIONED`. Defaults to the routing key.
+    ConsumerConfig& setPartitionKey(const PartitionKeyFunc& partitionKey)
+    {
+        d_partitionKey = partitionKey;
+        return *this;
+    }
+
+    /// \param header Partition messages by the value of this header with
+    ///        `ConsumerDispatch::PARTITIONED`. Messages without it share one
+    ///        lane.
+    ConsumerConfig& setPartitionKeyHeader(const bsl::string& header);
+
+    /// \param preFilter Return false for messages the consumer callback
+    ///        would discard anyway: they are settled on the event loop
+    ///        thread as they arrive, without a `rmqp::MessageGuard` or a
+    ///        threadpool job. The message is as received, before any
+    ///        message codec decompresses it. Unset (the default) passes
+    ///        every message to the callback.
+    /// \param rejectFiltered Reject (without requeue) the messages
+    ///        `preFilter` drops, e.g. to dead-letter them, rather than
+    ///        acking them. Defaults to false.
+    ConsumerConfig& setPreFilter(const PreFilterFunc& preFilter,
+                                 bool rejectFiltered = false)
+    {
+        d_preFilter      = preFilter;
+        d_rejectFiltered = rejectFiltered;
+        return *this;
+    }
+
+    /// \param payloadAllocator Supplies the buffer each delivery's body is
+    ///        assembled into, once its content header gives the size, e.g.
+    ///        from a pool, an arena or a slot of the application's own ring
+    ///        buffer. The body frames are copied straight into it, and the
+    ///        message's payload refers to it: it is released (the shared
+    ///        pointer's deleter run) once every copy of the message is
+    ///        destroyed. Messages without a body, and those for which it
+    ///        returns null, are made as usual. A consumer with a payload
+    ///        allocator has a channel of its own. Unset (the default) lets
+    ///        the library allocate bodies, or refer to the frames they
+    ///        arrived in. `rmqa::SpillPayloadAllocator` assembles very large
+    ///        bodies in memory mapped temporary files.
+    ConsumerConfig&
+    setPayloadAllocator(const PayloadAllocatorFunc& payloadAllocator)
+    {
+        d_payloadAllocator = payloadAllocator;
+        return *this;
+    }
+
+    /// \param policy What to do with a message whose deadline passed before
+    ///        it was received, decided on the event loop thread without a
+    ///        `rmqp::MessageGuard` or a threadpool job. A message's deadline
+    ///        is its `timestamp` plus its `expiration` in milliseconds, when
+    ///        it has both, or else the value of `deadlineHeader`. Messages
+    ///        with no deadline are always delivered. Defaults to DELIVER.
+    /// \param deadlineHeader Header with the deadline of a message, as a
+    ///        UTC `bdlt::Datetime` or an `int64_t` count of milliseconds
+    ///        since the epoch. Empty (the default) to check `expiration`
+    ///        only.
+    ConsumerConfig&
+    setStaleMessagePolicy(rmqt::StaleMessagePolicy::Value policy,
+                          const bsl::string& deadlineHeader = bsl::string())
+    {
+        d_staleMessagePolicy = policy;
+        d_deadlineHeader     = deadlineHeader;
+        return *this;
+    }
+
+    /// \param saturationProbe With an adaptive prefetch count (see
+    ///        `setMaxPrefetchCount`), checked each time the count is
+    ///        reconsidered: while it returns true the prefetch count drops
+    ///        to `minPrefetchCount`, so the broker routes the queue's
+    ///        messages to less loaded consumers, e.g. other instances of a
+    ///        horizontally scaled service. `rmqa::SaturationUtil` makes
+    ///        probes of threadpool backlog and CPU load. Unset (the
+    ///        default) adapts to handler latency only.
+    ConsumerConfig& setSaturationProbe(const SaturationFunc& saturationProbe)
+    {
+        d_saturationProbe = saturationProbe;
+        return *this;
+    }
+
+    /// \param capacity Remember the keys of the last `capacity` messages
+    ///        this consumer acked: a redelivery of one of them, e.g. after a
+    ///        reconnect lost the ack, is acked on the event loop thread as it
+    ///        arrives, without a `rmqp::MessageGuard` or a threadpool job.
+    ///        For callbacks which process a message the same way however
+    ///        often it is delivered. Only messages flagged as redelivered are
+    ///        checked, and keys are compared exactly. Zero (the default)
+    ///        delivers every redelivery.
+    /// \param window Forget keys acked longer ago than this. Zero (the
+    ///        default) keeps them until `capacity` newer ones were acked.
+    /// \param key Returns the key of a message, or an empty string for one
+    ///        which is always delivered. Defaults to the message id.
+    ConsumerConfig&
+    setRedeliveryFilter(bsl::size_t capacity,
+                        const bsls::TimeInterval& window = bsls::TimeInterval(),
+                        const RedeliveryKeyFunc& key = RedeliveryKeyFunc())
+    {
+        d_redeliveryFilterCapacity = capacity;
+        d_redeliveryFilterWindow   = window;
+        d_redeliveryKey            = key;
+        return *this;
+    }
+
+    /// \param streamOffset Where to start reading a stream queue, sent as
+    ///        the `x-stream-offset` consumer argument. Each delivery's
+    ///        offset is then available from `rmqt::Envelope::streamOffset`,
+    ///        and a consumer restarted after a reconnect resumes after the
+    ///        last offset delivered rather than from `streamOffset`. Stream
+    ///        queues need acks and a prefetch count, so `setNoAck` must not
+    ///        be set. Unset (the default) for other queues.
+    ConsumerConfig&
+    setStreamOffset(const bsl::optional<rmqt::StreamOffset>& streamOffset)
+    {
+        d_streamOffset = streamOffset;
+        return *this;
+    }
+
   private:
     bsl::string d_consumerTag;
     uint16_t d_prefetchCount;
     bdlmt::ThreadPool* d_threadpool;
     rmqt::Exclusive::Value d_exclusiveFlag;
     bsl::optional<int64_t> d_consumerPriority;
+    bsl::size_t d_maxBatchSize;
+    bsls::TimeInterval d_maxBatchLinger;
+    rmqt::ConsumerDispatch::Value d_dispatch;
+    bsls::TimeInterval d_ackCoalescingDelay;
+    bsl::size_t d_ackCoalescingTags;
+    uint16_t d_minPrefetchCount;
+    uint16_t d_maxPrefetchCount;
+    bsl::size_t d_prefetchBytes;
+    uint16_t d_slowStartPrefetchCount;
+    bool d_lazyHeaders;
+    int d_decodedProperties;
+    bool d_noAck;
+    bsl::size_t d_partitions;
+    PartitionKeyFunc d_partitionKey;
+    PreFilterFunc d_preFilter;
+    PayloadAllocatorFunc d_payloadAllocator;
+    bool d_rejectFiltered;
+    rmqt::StaleMessagePolicy::Value d_staleMessagePolicy;
+    bsl::string d_deadlineHeader;
+    SaturationFunc d_saturationProbe;
+    bsl::size_t d_redeliveryFilterCapacity;
+    bsls::TimeInterval d_redeliveryFilterWindow;
+    RedeliveryKeyFunc d_redeliveryKey;
+    bsl::optional<rmqt::StreamOffset> d_streamOffset;
 };
 
 } // namespace rmqt
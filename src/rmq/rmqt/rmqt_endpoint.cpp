@@ -21,5 +21,12 @@ bsl::shared_ptr<rmqt::SecurityParameters> Endpoint::securityParameters() const
 {
     return 0;
 }
+
+Endpoint::HostList Endpoint::hosts() const
+{
+    return HostList(1, Host(hostname(), port()));
+}
+
+bsl::string Endpoint::localPath() const { return bsl::string(); }
 } // namespace rmqt
 } // namespace BloombergLP
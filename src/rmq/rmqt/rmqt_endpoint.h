@@ -19,6 +19,8 @@
 #include <bsl_cstdint.h>
 #include <bsl_memory.h>
 #include <bsl_string.h>
+#include <bsl_utility.h>
+#include <bsl_vector.h>
 
 namespace BloombergLP {
 namespace rmqt {
@@ -29,6 +31,10 @@ class SecurityParameters;
 
 class Endpoint {
   public:
+    /// A broker's hostname and port
+    typedef bsl::pair<bsl::string, bsl::uint16_t> Host;
+    typedef bsl::vector<Host> HostList;
+
     virtual ~Endpoint(){};
     virtual bsl::string formatAddress() const = 0;
     virtual bsl::string hostname() const      = 0;
@@ -36,6 +42,17 @@ class Endpoint {
     virtual bsl::uint16_t port() const        = 0;
     virtual bsl::shared_ptr<rmqt::SecurityParameters>
     securityParameters() const;
+
+    /// \brief The hosts, e.g. the nodes of a cluster, which a connection
+    /// may connect to. Each connect attempt picks one according to the
+    /// context's `rmqt::HostSelection`. By default just `hostname()` and
+    /// `port()`.
+    virtual HostList hosts() const;
+
+    /// \brief The filesystem path of the Unix domain socket to connect to
+    /// instead of `hosts()`, see `rmqt::LocalEndpoint`. By default empty,
+    /// connecting over TCP.
+    virtual bsl::string localPath() const;
 };
 
 } // namespace rmqt
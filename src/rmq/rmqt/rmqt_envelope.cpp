@@ -15,10 +15,39 @@
 
 #include <rmqt_envelope.h>
 
+#include <bslma_default.h>
+#include <bslmt_once.h>
+#include <bsls_assert.h>
+
 #include <bsl_ios.h>
 
 namespace BloombergLP {
 namespace rmqt {
+namespace {
+
+bsl::shared_ptr<const bsl::string>* s_emptyString;
+
+/// Return `value` as a shared string. Empty strings (the default exchange,
+/// and the placeholders in acks) all share one.
+bsl::shared_ptr<const bsl::string> shareString(const bsl::string& value)
+{
+    if (!value.empty()) {
+        return bsl::make_shared<const bsl::string>(value);
+    }
+
+    BSLMT_ONCE_DO
+    {
+        // Never freed, so it comes from the global allocator rather than a
+        // default allocator which may be a test allocator
+        bslma::Allocator* allocator = bslma::Default::globalAllocator();
+        s_emptyString = new (*allocator) bsl::shared_ptr<const bsl::string>(
+            bsl::allocate_shared<const bsl::string>(allocator));
+    }
+    return *s_emptyString;
+}
+
+} // namespace
+
 Envelope::Envelope(uint64_t deliveryTag,
                    size_t channelLifetimeId,
                    const bsl::string& consumerTag,
@@ -27,12 +56,32 @@ Envelope::Envelope(uint64_t deliveryTag,
                    bool redelivered)
 : d_deliveryTag(deliveryTag)
 , d_channelLifetimeId(channelLifetimeId)
+, d_consumerTag(shareString(consumerTag))
+, d_exchange(shareString(exchange))
+, d_routingKey(routingKey)
+, d_redelivered(redelivered)
+, d_streamOffset()
+{
+}
+
+Envelope::Envelope(uint64_t deliveryTag,
+                   size_t channelLifetimeId,
+                   const bsl::shared_ptr<const bsl::string>& consumerTag,
+                   const bsl::shared_ptr<const bsl::string>& exchange,
+                   const bsl::string& routingKey,
+                   bool redelivered)
+: d_deliveryTag(deliveryTag)
+, d_channelLifetimeId(channelLifetimeId)
 , d_consumerTag(consumerTag)
 , d_exchange(exchange)
 , d_routingKey(routingKey)
 , d_redelivered(redelivered)
+, d_streamOffset()
 {
+    BSLS_ASSERT(d_consumerTag && d_exchange);
 }
+
+
 bsl::ostream& operator<<(bsl::ostream& os, const rmqt::Envelope& envelope)
 {
     os << "Envelope = [deliveryTag: " << envelope.deliveryTag()
@@ -40,7 +89,11 @@ bsl::ostream& operator<<(bsl::ostream& os, const rmqt::Envelope& envelope)
        << ", consumerTag: " << envelope.consumerTag()
        << ", exchange: " << envelope.exchange()
        << ", routingKey: " << envelope.routingKey()
-       << ", redelivered: " << bsl::boolalpha << envelope.redelivered() << "]";
+       << ", redelivered: " << bsl::boolalpha << envelope.redelivered();
+    if (envelope.streamOffset()) {
+        os << ", streamOffset: " << envelope.streamOffset().value();
+    }
+    os << "]";
     return os;
 }
 
@@ -17,6 +17,8 @@
 #define INCLUDED_RMQT_ENVELOPE
 
 #include <bsl_cstdint.h>
+#include <bsl_memory.h>
+#include <bsl_optional.h>
 #include <bsl_ostream.h>
 #include <bsl_string.h>
 
@@ -28,6 +30,12 @@ namespace rmqt {
 ///  Holds message delivery information (amqp basic deliver from
 ///  broker): delivery tag, routingKey, redelivery flag. Additionally provides
 ///  the id of the channel's lifetime (client) the message belongs to.
+///
+///  The consumer tag and exchange are the same for most deliveries to a
+///  consumer, so they are held as shared, immutable strings which copies of
+///  the envelope, and the library's envelopes for one consumer, refer to.
+///  Routing keys short enough for the string's own buffer take no
+///  allocation either.
 
 class Envelope {
   public:
@@ -48,6 +56,18 @@ class Envelope {
              const bsl::string& routingKey,
              bool redelivered);
 
+    /// \brief Envelope constructor sharing the consumer tag and exchange
+    ///        with other envelopes. Only to be called by rmqcpp internals.
+    ///
+    /// \param consumerTag Consumer tag, not null
+    /// \param exchange AMQP exchange name, not null
+    Envelope(uint64_t deliveryTag,
+             size_t channelLifetimeId,
+             const bsl::shared_ptr<const bsl::string>& consumerTag,
+             const bsl::shared_ptr<const bsl::string>& exchange,
+             const bsl::string& routingKey,
+             bool redelivered);
+
     /// \brief Message delivery tag
     uint64_t deliveryTag() const { return d_deliveryTag; }
 
@@ -56,10 +76,10 @@ class Envelope {
     size_t channelLifetimeId() const { return d_channelLifetimeId; }
 
     /// \brief Consumer tag
-    const bsl::string& consumerTag() const { return d_consumerTag; }
+    const bsl::string& consumerTag() const { return *d_consumerTag; }
 
     /// \brief AMQP exchange name
-    const bsl::string& exchange() const { return d_exchange; }
+    const bsl::string& exchange() const { return *d_exchange; }
 
     /// \brief AMQP routing key
     const bsl::string& routingKey() const { return d_routingKey; }
@@ -67,13 +87,25 @@ class Envelope {
     /// \brief True if the message has been redelivered
     bool redelivered() const { return d_redelivered; }
 
+    /// \brief Offset of the message in its stream queue, for consumers
+    ///        configured with `ConsumerConfig::setStreamOffset`. Resume
+    ///        after it with `rmqt::StreamOffset::offset(offset + 1)`.
+    const bsl::optional<uint64_t>& streamOffset() const
+    {
+        return d_streamOffset;
+    }
+
+    /// \brief Set the stream offset. Only to be called by rmqcpp internals.
+    void setStreamOffset(uint64_t offset) { d_streamOffset = offset; }
+
   private:
     uint64_t d_deliveryTag;
     size_t d_channelLifetimeId;
-    bsl::string d_consumerTag;
-    bsl::string d_exchange;
+    bsl::shared_ptr<const bsl::string> d_consumerTag;
+    bsl::shared_ptr<const bsl::string> d_exchange;
     bsl::string d_routingKey;
     bool d_redelivered;
+    bsl::optional<uint64_t> d_streamOffset;
 };
 
 bsl::ostream& operator<<(bsl::ostream& os, const rmqt::Envelope& envelope);
@@ -1,51 +1,24 @@
-// Copyright 2020-2023 Bloomberg Finance L.P.
-// SPDX-License-Identifier: Apache-2.0
-//
-// Licensed under the Apache License, Version 2.0 (the "License");
-// you may not use this file except in compliance with the License.
-// You may obtain a copy of the License at
-//
-//     http://www.apache.org/licenses/LICENSE-2.0
-//
-// Unless required by applicable law or agreed to in writing, software
-// distributed under the License is distributed on an "AS IS" BASIS,
-// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
-// See the License for the specific language governing permissions and
-// limitations under the License.
-
-#ifndef INCLUDED_RMQT_CONSUMERACKBATCH
-#define INCLUDED_RMQT_CONSUMERACKBATCH
-
-#include <rmqt_consumerack.h>
-
-#include <bdlcc_deque.h>
-#include <bslmt_lockguard.h>
-#include <bslmt_mutex.h>
-
-#include <bsl_memory.h>
-#include <bsl_vector.h>
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqt_fieldtableview.h>
 
 namespace BloombergLP {
 namespace rmqt {
 
-class ConsumerAckBatch {
-  public:
-    ConsumerAckBatch();
-    ~ConsumerAckBatch();
-
-    bool addAck(const ConsumerAck& ack);
-
-    bsl::vector<ConsumerAck>& lock();
-
-  private:
-    bslmt::Mutex d_mutex;
-    bool d_locked;
-    bsl::vector<ConsumerAck> d_acks;
-};
-
-typedef bdlcc::Deque<bsl::shared_ptr<ConsumerAckBatch> > ConsumerAckQueue;
+FieldTableView::~FieldTableView() {}
 
 } // namespace rmqt
 } // namespace BloombergLP
-
-#endif
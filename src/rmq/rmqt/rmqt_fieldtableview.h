@@ -0,0 +1,57 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQT_FIELDTABLEVIEW
+#define INCLUDED_RMQT_FIELDTABLEVIEW
+
+#include <rmqt_fieldvalue.h>
+
+#include <bsl_memory.h>
+#include <bsl_string.h>
+
+//@PURPOSE: Provide read access to a field table without decoding all of it
+//
+//@CLASSES:
+//  rmqt::FieldTableView: Look up single values of a field table, e.g. the
+//      headers of a consumed message, decoding only what is looked up
+
+namespace BloombergLP {
+namespace rmqt {
+
+/// \brief Read-only, lazily decoded view of a field table
+///
+/// Implementations may be shared between threads, so both methods must be
+/// safe to call concurrently.
+
+class FieldTableView {
+  public:
+    virtual ~FieldTableView();
+
+    /// \brief Look up the value of `key`, decoding only that value
+    /// \return true and load the value into `value` if the table holds
+    ///         `key`, false otherwise
+    virtual bool find(rmqt::FieldValue* value,
+                      const bsl::string& key) const = 0;
+
+    /// \brief Decode the whole table. The table is decoded by the first call
+    ///        and shared by every later call.
+    /// \return The decoded table, or a null pointer if it can not be decoded
+    virtual bsl::shared_ptr<rmqt::FieldTable> table() const = 0;
+};
+
+} // namespace rmqt
+} // namespace BloombergLP
+
+#endif
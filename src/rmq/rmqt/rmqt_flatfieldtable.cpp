@@ -0,0 +1,181 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqt_flatfieldtable.h>
+
+#include <bsl_algorithm.h>
+
+namespace BloombergLP {
+namespace rmqt {
+
+namespace {
+
+struct EntryKeyLess {
+    bool operator()(const FlatFieldTable::Entry& entry,
+                    const bslstl::StringRef& key) const
+    {
+        return bslstl::StringRef(entry.first) < key;
+    }
+};
+
+} // namespace
+
+FlatFieldTable::FlatFieldTable(bslma::Allocator* allocator)
+: d_entries(allocator)
+{
+}
+
+FlatFieldTable::FlatFieldTable(const FieldTable& table,
+                               bslma::Allocator* allocator)
+: d_entries(allocator)
+{
+    d_entries.reserve(table.size());
+    for (FieldTable::const_iterator it = table.begin(); it != table.end();
+         ++it) {
+        // The map is already in key order, so each entry is appended
+        *emplace(it->first) = it->second;
+    }
+}
+
+FlatFieldTable::FlatFieldTable(const FlatFieldTable& other,
+                               bslma::Allocator* allocator)
+: d_entries(other.d_entries, allocator)
+{
+}
+
+FlatFieldTable& FlatFieldTable::operator=(const FlatFieldTable& other)
+{
+    d_entries = other.d_entries;
+    return *this;
+}
+
+void FlatFieldTable::reserve(bsl::size_t count) { d_entries.reserve(count); }
+
+bool FlatFieldTable::insert(const bslstl::StringRef& key,
+                            const FieldValue& value)
+{
+    FieldValue* inserted = emplace(key);
+    if (!inserted) {
+        return false;
+    }
+    *inserted = value;
+    return true;
+}
+
+FieldValue* FlatFieldTable::emplace(const bslstl::StringRef& key)
+{
+    iterator it = d_entries.end();
+    if (!d_entries.empty() &&
+        !(bslstl::StringRef(d_entries.back().first) < key)) {
+        it = lowerBound(key);
+        if (bslstl::StringRef(it->first) == key) {
+            return 0;
+        }
+    }
+
+    // Insert an empty entry, so the key and value are created with the
+    // table's allocator
+    it = d_entries.insert(it, Entry());
+    it->first.assign(key.data(), key.length());
+    return &it->second;
+}
+
+void FlatFieldTable::set(const bslstl::StringRef& key, const FieldValue& value)
+{
+    FieldValue* existing = find(key);
+    if (!existing) {
+        existing = emplace(key);
+    }
+    *existing = value;
+}
+
+bool FlatFieldTable::erase(const bslstl::StringRef& key)
+{
+    const iterator it = lowerBound(key);
+    if (it == d_entries.end() || bslstl::StringRef(it->first) != key) {
+        return false;
+    }
+    d_entries.erase(it);
+    return true;
+}
+
+const FieldValue* FlatFieldTable::find(const bslstl::StringRef& key) const
+{
+    return const_cast<FlatFieldTable*>(this)->find(key);
+}
+
+FieldValue* FlatFieldTable::find(const bslstl::StringRef& key)
+{
+    const iterator it = lowerBound(key);
+    if (it == d_entries.end() || bslstl::StringRef(it->first) != key) {
+        return 0;
+    }
+    return &it->second;
+}
+
+bsl::shared_ptr<FieldTable> FlatFieldTable::toFieldTable() const
+{
+    bsl::shared_ptr<FieldTable> table = bsl::make_shared<FieldTable>();
+    for (const_iterator it = begin(); it != end(); ++it) {
+        table->insert(table->end(),
+                      FieldTable::value_type(it->first, it->second));
+    }
+    return table;
+}
+
+FlatFieldTable::iterator
+FlatFieldTable::lowerBound(const bslstl::StringRef& key)
+{
+    return bsl::lower_bound(
+        d_entries.begin(), d_entries.end(), key, EntryKeyLess());
+}
+
+bool operator==(const FlatFieldTable& lhs, const FlatFieldTable& rhs)
+{
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+    for (FlatFieldTable::const_iterator l = lhs.begin(), r = rhs.begin();
+         l != lhs.end();
+         ++l, ++r) {
+        if (l->first != r->first || l->second != r->second) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool operator!=(const FlatFieldTable& lhs, const FlatFieldTable& rhs)
+{
+    return !(lhs == rhs);
+}
+
+bsl::ostream& operator<<(bsl::ostream& os, const FlatFieldTable& table)
+{
+    os << " [";
+    for (FlatFieldTable::const_iterator it = table.begin(); it != table.end();
+         ++it) {
+        if (it != table.begin()) {
+            os << ",";
+        }
+
+        os << " " << it->first << " = " << it->second;
+    }
+    os << " ]";
+    return os;
+}
+
+} // namespace rmqt
+} // namespace BloombergLP
@@ -0,0 +1,133 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQT_FLATFIELDTABLE
+#define INCLUDED_RMQT_FLATFIELDTABLE
+
+#include <rmqt_fieldvalue.h>
+
+#include <bslma_allocator.h>
+#include <bslma_usesbslmaallocator.h>
+#include <bslmf_nestedtraitdeclaration.h>
+#include <bslstl_stringref.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_memory.h>
+#include <bsl_ostream.h>
+#include <bsl_string.h>
+#include <bsl_utility.h>
+#include <bsl_vector.h>
+
+//@PURPOSE: Provide a field table stored in one contiguous, sorted block
+//
+//@CLASSES:
+//  rmqt::FlatFieldTable: A field table kept as a key-sorted vector, for
+//      encoding and decoding header-rich messages with few allocations
+
+namespace BloombergLP {
+namespace rmqt {
+
+/// \brief AMQP 0.9.1 `Field Table` held as a vector of entries sorted by key
+///
+/// `rmqt::FieldTable` allocates a map node per entry. A FlatFieldTable holds
+/// its entries in a single vector: with `reserve` the entries take one
+/// allocation, and keys and string values short enough for the small string
+/// optimization need no more. Every allocation is made with the table's
+/// allocator, so decoding into a table supplied with a stack or arena
+/// allocator (e.g. `bdlma::LocalSequentialAllocator`) can avoid the heap,
+/// except for nested tables and arrays, which are `FieldValue`s holding
+/// shared pointers.
+///
+/// Lookups are binary searches. Inserting out of key order shifts the later
+/// entries, so FlatFieldTable suits the small, mostly written-once tables of
+/// message headers. As for `FieldTable`, keys longer than 255 characters are
+/// truncated when serialised.
+
+class FlatFieldTable {
+  public:
+    typedef bsl::pair<bsl::string, FieldValue> Entry;
+    typedef bsl::vector<Entry>::const_iterator const_iterator;
+
+    BSLMF_NESTED_TRAIT_DECLARATION(FlatFieldTable, bslma::UsesBslmaAllocator);
+
+    explicit FlatFieldTable(bslma::Allocator* allocator = 0);
+
+    /// Copy the entries of `table`
+    explicit FlatFieldTable(const FieldTable& table,
+                            bslma::Allocator* allocator = 0);
+
+    FlatFieldTable(const FlatFieldTable& other,
+                   bslma::Allocator* allocator = 0);
+
+    FlatFieldTable& operator=(const FlatFieldTable& other);
+
+    /// Reserve space for `count` entries
+    void reserve(bsl::size_t count);
+
+    /// Insert `value` for `key` unless the table already holds `key`.
+    /// Return true if inserted.
+    bool insert(const bslstl::StringRef& key, const FieldValue& value);
+
+    /// Insert an unset value for `key`, and return it to be loaded in place.
+    /// Return 0, leaving the table unchanged, if the table already holds
+    /// `key`. Keys arriving in sorted order, as they are encoded, are
+    /// appended without searching.
+    FieldValue* emplace(const bslstl::StringRef& key);
+
+    /// Set the value for `key`, inserting it if necessary
+    void set(const bslstl::StringRef& key, const FieldValue& value);
+
+    /// Remove `key`. Return true if the table held `key`.
+    bool erase(const bslstl::StringRef& key);
+
+    void clear() { d_entries.clear(); }
+
+    /// Return the value of `key`, or 0 if the table does not hold `key`
+    const FieldValue* find(const bslstl::StringRef& key) const;
+    FieldValue* find(const bslstl::StringRef& key);
+
+    bsl::size_t size() const { return d_entries.size(); }
+    bool empty() const { return d_entries.empty(); }
+
+    /// Entries in key order
+    const_iterator begin() const { return d_entries.begin(); }
+    const_iterator end() const { return d_entries.end(); }
+
+    /// Return a copy of the entries as an `rmqt::FieldTable`, e.g. for
+    /// `rmqt::Properties::headers`
+    bsl::shared_ptr<FieldTable> toFieldTable() const;
+
+    bslma::Allocator* allocator() const
+    {
+        return d_entries.get_allocator().mechanism();
+    }
+
+  private:
+    typedef bsl::vector<Entry>::iterator iterator;
+
+    iterator lowerBound(const bslstl::StringRef& key);
+
+    bsl::vector<Entry> d_entries;
+};
+
+bool operator==(const FlatFieldTable& lhs, const FlatFieldTable& rhs);
+bool operator!=(const FlatFieldTable& lhs, const FlatFieldTable& rhs);
+
+bsl::ostream& operator<<(bsl::ostream& os, const FlatFieldTable& table);
+
+} // namespace rmqt
+} // namespace BloombergLP
+
+#endif
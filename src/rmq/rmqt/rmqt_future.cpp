@@ -28,5 +28,24 @@ FutureUtil::resultWrapperImpl<void>(const bsl::function<void()>& tProducer)
     return rmqt::Result<void>();
 }
 
+Future<void> FutureUtil::whenAll(const bsl::vector<Future<void> >& futures)
+{
+    Future<void> result((Result<void>()));
+    for (bsl::size_t i = 0; i < futures.size(); ++i) {
+        result = result.thenFuture<void>(bdlf::BindUtil::bind(
+            &FutureUtil::whenAllImpl, futures[i], bdlf::PlaceHolders::_1));
+    }
+    return result;
+}
+
+Future<void> FutureUtil::whenAllImpl(const Future<void>& next,
+                                     const Result<void>& previous)
+{
+    if (!previous) {
+        return Future<void>(previous);
+    }
+    return next;
+}
+
 } // namespace rmqt
 } // namespace BloombergLP
@@ -16,6 +16,7 @@
 #ifndef INCLUDED_RMQT_FUTURE
 #define INCLUDED_RMQT_FUTURE
 
+#include <rmqt_log.h>
 #include <rmqt_result.h>
 
 #include <ball_log.h>
@@ -23,14 +24,19 @@
 #include <bslmt_condition.h>
 #include <bslmt_lockguard.h>
 #include <bslmt_mutex.h>
+#include <bsls_alignedbuffer.h>
 #include <bsls_assert.h>
+#include <bsls_atomic.h>
+#include <bsls_keyword.h>
 #include <bsls_systemtime.h>
 
 #include <bsl_exception.h>
 #include <bsl_functional.h>
-#include <bsl_list.h>
+#include <bsl_cstddef.h>
 #include <bsl_memory.h>
+#include <bsl_new.h>
 #include <bsl_utility.h>
+#include <bsl_vector.h>
 
 //@PURPOSE: An async-style Future/Promise object
 //
@@ -56,6 +62,13 @@ namespace rmqt {
 /// future through `Future<T>::make` always creates a new standalone control
 /// block.
 ///
+/// Once resolved, a Future's result never changes and is read without
+/// locking; waiting only takes the control block's mutex when the result is
+/// not there yet. The first continuation added to a control block is held
+/// inside it, so beyond copying its callback a single `then` or
+/// `thenFuture` allocates only the new control block. Only the first result
+/// passed to a `Maker` is kept.
+///
 /// Future objects are cancellable. Any cancel function passed to
 /// `Future<T>::make` is called and then destroyed when a Control Block is
 /// destructed.
@@ -267,6 +280,10 @@ class FutureUtil {
             FutureUtil::unravelFuture<T>());
     }
 
+    /// Return a Future which resolves once every one of `futures` has
+    /// succeeded, or with the first error in `futures` order
+    static Future<void> whenAll(const bsl::vector<Future<void> >& futures);
+
   private:
     template <typename T>
     static Future<T> propagateErrorImpl(const bsl::function<Future<T>()>& t,
@@ -301,6 +318,9 @@ class FutureUtil {
         return result;
     }
 
+    static Future<void> whenAllImpl(const Future<void>& next,
+                                    const Result<void>& previous);
+
     template <typename T>
     static Future<T> unravelImpl(const bsl::shared_ptr<Future<T> >& t)
     {
@@ -338,7 +358,10 @@ Future<T>::~Future()
 template <typename T>
 Result<T> Future<T>::tryResult()
 {
-    return waitResult(bsls::TimeInterval(0));
+    if (d_impl->isDone()) {
+        return d_impl->result();
+    }
+    return Result<T>("TIMED OUT", TIMEOUT);
 }
 
 template <typename T>
@@ -367,11 +390,9 @@ Result<T> Future<T>::timedWaitResult(const bsls::TimeInterval& absoluteTime)
 
 template <typename T>
 Future<T>::Future(const rmqt::Result<T>& result)
-: d_impl()
+: d_impl(bsl::make_shared<Impl>(bsl::function<void()>()))
 {
-    Pair p = make();
-    d_impl = p.second.d_impl;
-    p.first(result);
+    d_impl->resolve(result);
 }
 
 template <typename T>
@@ -433,6 +454,82 @@ template <typename T>
 class Future<T>::Impl
 : public bsl::enable_shared_from_this<typename Future<T>::Impl> {
   private:
+    enum State { e_PENDING = 0, e_DONE = 1 };
+
+    /// Receives the result of this Future, see `addContinuation`
+    class Continuation {
+      public:
+        virtual ~Continuation() {}
+
+        virtual void resolve(const Result<T>& result) const = 0;
+    };
+
+    /// Continuation for `then`: converts the result and resolves the next
+    /// Future with it. The converter runs even if nothing holds the next
+    /// Future any more.
+    template <typename newT>
+    class ThenContinuation : public Continuation {
+      public:
+        ThenContinuation(
+            const bsl::function<Result<newT>(const Result<T>&)>& converter,
+            const bsl::shared_ptr<typename Future<newT>::Impl>& next)
+        : d_converter(converter)
+        , d_next(next)
+        {
+        }
+
+        void resolve(const Result<T>& result) const BSLS_KEYWORD_OVERRIDE
+        {
+            const Result<newT> converted = d_converter(result);
+
+            bsl::shared_ptr<typename Future<newT>::Impl> next = d_next.lock();
+            if (next) {
+                next->resolve(converted);
+            }
+        }
+
+      private:
+        bsl::function<Result<newT>(const Result<T>&)> d_converter;
+        bsl::weak_ptr<typename Future<newT>::Impl> d_next;
+    };
+
+    /// Continuation for `thenFuture`: once this Future resolves, generates
+    /// the Future (C) whose result resolves the next Future (B), and hands
+    /// B ownership of the chain from C, see the class description.
+    template <typename newT>
+    class ThenFutureContinuation : public Continuation {
+      public:
+        ThenFutureContinuation(
+            const bsl::function<Future<newT>(const Result<T>&)>& generator,
+            const bsl::shared_ptr<typename Future<newT>::Impl>& next)
+        : d_generator(generator)
+        , d_next(next)
+        {
+        }
+
+        void resolve(const Result<T>& result) const BSLS_KEYWORD_OVERRIDE
+        {
+            bsl::shared_ptr<typename Future<newT>::Impl> next = d_next.lock();
+            if (!next) {
+                return;
+            }
+
+            Future<newT> cFut = d_generator(result);
+            Future<newT> dFut = cFut.template then<newT>(
+                FutureUtil::makerWrapper<newT>(next->generateMaker()));
+
+            next->keepAlive(dFut.d_impl);
+        }
+
+      private:
+        bsl::function<Future<newT>(const Result<T>&)> d_generator;
+        bsl::weak_ptr<typename Future<newT>::Impl> d_next;
+    };
+
+    /// Space for one continuation held without allocating, enough for a
+    /// `bsl::function` and a `bsl::weak_ptr`
+    static const bsl::size_t k_INLINE_CONTINUATION_SIZE = 128;
+
     static void made(const bsl::weak_ptr<typename Future<T>::Impl>& weakSelf,
                      const Result<T>& item)
     {
@@ -440,7 +537,7 @@ class Future<T>::Impl
 
         if (!self) {
             BALL_LOG_SET_CATEGORY("RMQT.FUTURE.IMPL");
-            BALL_LOG_DEBUG << "Resolved " << bsl::string(!item ? "un" : "")
+            RMQT_LOG_DEBUG << "Resolved " << bsl::string(!item ? "un" : "")
                            << "successful future<" << typeid(T).name()
                            << "> after cancel";
             // This is a safe race condition - e.g. if a user stops caring about
@@ -449,84 +546,23 @@ class Future<T>::Impl
             return;
         }
 
-        bslmt::LockGuard<bslmt::Mutex> guard(&self->d_mutex);
-        self->d_result = item;
-        self->d_done   = true;
-        self->notifyChain(&guard);
-        self->d_condition.broadcast(); // there could be more than one waiter
-    }
-
-    template <typename newT>
-    void static converter(
-        const typename Future<newT>::Maker& maker,
-        const bsl::function<Result<newT>(const Result<T>&)>& newTConverter,
-        const Result<T>& result)
-    {
-        maker(newTConverter(result));
-    }
-
-    /// \brief Core implementation details of `thenFuture`
-    ///
-    /// This function handles the data, and ownership passing required for
-    /// `thenFuture`.
-    ///
-    /// Future objects are labelled A, B, C, D as per the diagram in the class
-    /// description
-    template <typename newT>
-    static void futureConverter(
-        const bsl::function<Future<newT>(const Result<T>&)>& cGenerator,
-        const typename Future<newT>::Maker& bMaker,
-        const bsl::weak_ptr<typename Future<newT>::Impl>& wpBImpl,
-        const Result<T>& aResult)
-    {
-        bsl::shared_ptr<typename Future<newT>::Impl> bImpl = wpBImpl.lock();
-        if (bImpl) {
-            Future<newT> cFut = cGenerator(aResult);
-
-            Future<newT> dFut =
-                cFut.then(FutureUtil::makerWrapper<newT>(bMaker));
-
-            bImpl->updateCancel(dFut.d_impl->getLifetimeExtension());
-        }
-    }
-
-    static void
-    extendChainParentLifetime(const bsl::shared_ptr<typename Future<T>::Impl>&)
-    {
-        // This function exists only as a bind target so that a Future
-        // created in .then() can hold onto the parent Future to keep it
-        // alive as long as itself.
-
-        // E.g.
-
-        // rmqt::Future<bsl::string> asyncGetMultiplyAsString(int a, int b)
-        // {
-        //     rmqt::Future<int> x = asyncMultiply(a, b);
-        //     rmqt::Future<bsl::string> y =
-        //     x.then<bsl::string>(&convertIntToString);
-        //
-        //     return y;
-        // }
-
-        // In the above example, `x` will go out of scope at the end of the
-        // function, but it's successor `y` is still alive.
-
-        // Since the type of `y` does not know about `x`, but it needs to
-        // extend it's lifetime (call the `x` destructor when `y`
-        // destructs), we need to hold a type-erased form of `x`
-
-        // Note: if `y` then goes out of scope, the whole future chain
-        // should be destructed
+        self->resolve(item);
     }
 
   public:
-    Impl(const bsl::function<void()>& cancelFunc)
-    : d_mutex()
+    explicit Impl(
+        const bsl::function<void()>& cancelFunc,
+        const bsl::shared_ptr<void>& parent = bsl::shared_ptr<void>())
+    : d_state(e_PENDING)
+    , d_mutex()
     , d_condition()
+    , d_waiters(0)
     , d_result("Null")
-    , d_chain()
-    , d_done(false)
+    , d_continuation(0)
+    , d_inlineContinuation()
+    , d_moreContinuations()
     , d_cancelFunc(cancelFunc)
+    , d_keepAlive(parent)
     {
     }
 
@@ -535,7 +571,7 @@ class Future<T>::Impl
         BALL_LOG_SET_CATEGORY("RMQT.FUTURE.IMPL");
         try {
             bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
-            if (!d_done && d_cancelFunc) {
+            if (d_state.loadAcquire() != e_DONE && d_cancelFunc) {
                 d_cancelFunc();
             }
         }
@@ -547,26 +583,84 @@ class Future<T>::Impl
             BALL_LOG_ERROR << "Caught unknown exception in future<"
                            << typeid(T).name() << "> dtor";
         }
+        destroyContinuation(d_continuation);
     }
 
+    /// Store `item` as the result, wake any waiters and run the
+    /// continuations, outside the lock. Only the first result is kept.
+    void resolve(const Result<T>& item)
+    {
+        Continuation* continuation = 0;
+        bsl::vector<bsl::shared_ptr<Continuation> > moreContinuations;
+        {
+            bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+            if (d_state.loadRelaxed() == e_DONE) {
+                // Readers no longer lock to read the result, so it must not
+                // change once published
+                BALL_LOG_SET_CATEGORY("RMQT.FUTURE.IMPL");
+                RMQT_LOG_DEBUG << "Ignoring second result for future<"
+                               << typeid(T).name() << ">";
+                return;
+            }
+
+            d_result = item;
+            d_state.storeRelease(e_DONE);
+            if (d_waiters) {
+                d_condition.broadcast(); // there could be more than one waiter
+            }
+
+            continuation   = d_continuation;
+            d_continuation = 0;
+            moreContinuations.swap(d_moreContinuations);
+        }
+
+        // Continuations added from here on run straight away in
+        // `addContinuation`, so these are the only ones left to run
+        if (continuation) {
+            continuation->resolve(d_result);
+            destroyContinuation(continuation);
+        }
+        for (typename bsl::vector<bsl::shared_ptr<Continuation> >::iterator
+                 it = moreContinuations.begin();
+             it != moreContinuations.end();
+             ++it) {
+            (*it)->resolve(d_result);
+        }
+    }
+
+    bool isDone() const { return d_state.loadAcquire() == e_DONE; }
+
     void blockUntilMade()
     {
+        if (isDone()) {
+            return;
+        }
+
         bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
-        while (!d_done) {
+        ++d_waiters;
+        while (d_state.loadRelaxed() != e_DONE) {
             d_condition.wait(&d_mutex);
         }
+        --d_waiters;
     }
 
     // returns true if there was no timeout
     bool timedWaitUntilMade(const bsls::TimeInterval& absoluteTime)
     {
+        if (isDone()) {
+            return true;
+        }
+
         bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
-        while (!d_done) {
+        ++d_waiters;
+        while (d_state.loadRelaxed() != e_DONE) {
             if (bslmt::Condition::e_TIMED_OUT ==
                 d_condition.timedWait(&d_mutex, absoluteTime)) {
+                --d_waiters;
                 return false;
             }
         }
+        --d_waiters;
         return true;
     }
 
@@ -577,108 +671,120 @@ class Future<T>::Impl
                                     bdlf::PlaceHolders::_1);
     }
 
-    const Result<T>& result(bslmt::LockGuard<bslmt::Mutex>* haveGuard = 0)
+    /// The result, which never changes once the Future is done. The
+    /// behaviour is undefined unless `isDone()`.
+    const Result<T>& result() const
     {
-        if (!haveGuard) {
-            bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
-            return resultNoLock();
-        }
-        BSLS_ASSERT(haveGuard->ptr() == &d_mutex);
-        return resultNoLock();
+        BSLS_ASSERT(isDone());
+        return d_result;
     }
 
     template <typename newT>
     Future<newT>
     addChain(const bsl::function<Result<newT>(const Result<T>&)>& newTConverter)
     {
-        typename rmqt::Future<newT>::Pair futurePair(
-            rmqt::Future<newT>::make(getLifetimeExtension()));
+        Future<newT> next;
+        next.d_impl = bsl::make_shared<typename Future<newT>::Impl>(
+            bsl::function<void()>(), Future<T>::Impl::shared_from_this());
 
-        bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
-        if (d_done) {
-            converter(futurePair.first, newTConverter, result(&guard));
-        }
-        else {
-            d_chain.push_back(
-                bdlf::BindUtil::bind(&Future<T>::Impl::converter<newT>,
-                                     futurePair.first,
-                                     newTConverter,
-                                     bdlf::PlaceHolders::_1));
-        }
+        addContinuation(ThenContinuation<newT>(newTConverter, next.d_impl));
 
-        return futurePair.second;
+        return next;
     }
 
     template <typename newT>
     Future<newT>
     addChain(const bsl::function<Future<newT>(const Result<T>&)>& futureMaker)
     {
-        typename rmqt::Future<newT>::Pair futurePair(
-            rmqt::Future<newT>::make(getLifetimeExtension()));
+        Future<newT> next;
+        next.d_impl = bsl::make_shared<typename Future<newT>::Impl>(
+            bsl::function<void()>(), Future<T>::Impl::shared_from_this());
 
-        bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
-        if (d_done) {
-            futureConverter<newT>(
-                futureMaker,
-                futurePair.first,
-                bsl::weak_ptr<typename rmqt::Future<newT>::Impl>(
-                    futurePair.second.d_impl),
-                result(&guard));
-        }
-        else {
-            d_chain.push_back(bdlf::BindUtil::bind(
-                &Future<T>::Impl::futureConverter<newT>,
-                futureMaker,
-                futurePair.first,
-                bsl::weak_ptr<typename rmqt::Future<newT>::Impl>(
-                    futurePair.second.d_impl),
-                bdlf::PlaceHolders::_1));
-        }
-        return futurePair.second;
-    }
+        addContinuation(
+            ThenFutureContinuation<newT>(futureMaker, next.d_impl));
 
-    bsl::function<void()> getLifetimeExtension()
-    {
-        bsl::function<void(const bsl::shared_ptr<typename Future<T>::Impl>&)>
-            func;
-        func = &Future<T>::Impl::extendChainParentLifetime;
-        return bdlf::BindUtil::bind(func, Future<T>::Impl::shared_from_this());
+        return next;
     }
 
-    void updateCancel(const bsl::function<void()>& newCanc)
+    /// Hold `other` for as long as this Future, in place of whatever was
+    /// held before
+    void keepAlive(const bsl::shared_ptr<void>& other)
     {
-        bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
-        d_cancelFunc = newCanc;
+        bsl::shared_ptr<void> previous;
+        {
+            bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+            previous.swap(d_keepAlive);
+            d_keepAlive = other;
+        }
+        // `previous` may be the last owner of a chain, so let it go unlocked
     }
 
   private:
-    const Result<T>& resultNoLock()
+    /// Hold `continuation` until this Future resolves, or, if it already has,
+    /// run it now. The first continuation is held without allocating.
+    template <typename ContinuationType>
+    void addContinuation(const ContinuationType& continuation)
     {
-        BSLS_ASSERT(d_done);
-        return d_result;
+        {
+            bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+            if (d_state.loadRelaxed() != e_DONE) {
+                if (!d_continuation && sizeof(ContinuationType) <=
+                                           k_INLINE_CONTINUATION_SIZE) {
+                    d_continuation = new (d_inlineContinuation.buffer())
+                        ContinuationType(continuation);
+                }
+                else {
+                    d_moreContinuations.push_back(
+                        bsl::make_shared<ContinuationType>(continuation));
+                }
+                return;
+            }
+        }
+
+        continuation.resolve(d_result);
     }
 
-    void notifyChain(bslmt::LockGuard<bslmt::Mutex>* haveGuard)
+    void destroyContinuation(Continuation* continuation)
     {
-        BSLS_ASSERT(haveGuard);
-        typename bsl::list<bsl::function<void(const Result<T>&)> >::iterator it;
-        for (it = d_chain.begin(); it != d_chain.end(); ++it) {
-            (*it)(result(haveGuard));
+        if (continuation) {
+            continuation->~Continuation();
         }
-        d_chain.clear();
     }
 
   private:
+    // `e_DONE` once `d_result` is set, after which it is read without the
+    // mutex
+    bsls::AtomicInt d_state;
     bslmt::Mutex d_mutex;
     bslmt::Condition d_condition;
+    // Threads waiting on `d_condition`, so resolving only signals it when
+    // someone is waiting
+    int d_waiters;
     Result<T> d_result;
-    bsl::list<typename rmqt::Future<T>::Maker> d_chain;
-    bool d_done;
+    // The first continuation, constructed in `d_inlineContinuation`
+    Continuation* d_continuation;
+    bsls::AlignedBuffer<k_INLINE_CONTINUATION_SIZE> d_inlineContinuation;
+    bsl::vector<bsl::shared_ptr<Continuation> > d_moreContinuations;
 
     // Called if the future is not completed when Future<T>::Impl destructs
-    // This function is used to extend the lifetime of chained futures.
-    // See extendChainParentLifetime
     bsl::function<void()> d_cancelFunc;
+
+    // Keeps the Future this one is chained from (by `then`/`thenFuture`)
+    // alive for as long as this one, since it does not know that Future's
+    // type. E.g. in
+    //
+    // rmqt::Future<bsl::string> asyncGetMultiplyAsString(int a, int b)
+    // {
+    //     rmqt::Future<int> x = asyncMultiply(a, b);
+    //     rmqt::Future<bsl::string> y =
+    //     x.then<bsl::string>(&convertIntToString);
+    //
+    //     return y;
+    // }
+    //
+    // `x` goes out of scope at the end of the function, but is only
+    // destructed (and cancelled) once `y` is.
+    bsl::shared_ptr<void> d_keepAlive;
 };
 
 } // namespace rmqt
@@ -13,37 +13,27 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#include <rmqt_consumerackbatch.h>
+
+#include <rmqt_localendpoint.h>
 
 namespace BloombergLP {
 namespace rmqt {
 
-ConsumerAckBatch::ConsumerAckBatch()
-: d_mutex()
-, d_locked(false)
-, d_acks()
+LocalEndpoint::LocalEndpoint(bsl::string_view path, bsl::string_view vhost)
+: d_path(path)
+, d_vhost(vhost)
 {
 }
-ConsumerAckBatch::~ConsumerAckBatch() {}
 
-bool ConsumerAckBatch::addAck(const ConsumerAck& ack)
+bsl::string LocalEndpoint::formatAddress() const
 {
-    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
-
-    if (d_locked) {
-        return false;
-    }
-
-    d_acks.push_back(ack);
-    return true;
+    return "amqp+unix://" + d_path + "/" + d_vhost;
 }
 
-bsl::vector<ConsumerAck>& ConsumerAckBatch::lock()
-{
-    bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
-    d_locked = true;
-    return d_acks;
-}
+bsl::string LocalEndpoint::hostname() const { return d_path; }
+bsl::string LocalEndpoint::vhost() const { return d_vhost; }
+bsl::uint16_t LocalEndpoint::port() const { return 0; }
+bsl::string LocalEndpoint::localPath() const { return d_path; }
 
 } // namespace rmqt
-} // namespace BloombergLP
\ No newline at end of file
+} // namespace BloombergLP
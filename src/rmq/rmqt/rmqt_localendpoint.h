@@ -0,0 +1,61 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef INCLUDED_RMQT_LOCALENDPOINT
+#define INCLUDED_RMQT_LOCALENDPOINT
+
+#include <rmqt_endpoint.h>
+
+#include <bsls_keyword.h>
+
+#include <bsl_string.h>
+
+namespace BloombergLP {
+namespace rmqt {
+
+/// \brief AMQP endpoint reached through a Unix domain socket
+///
+/// For a broker or AMQP proxy on the same host, listening on a Unix domain
+/// socket. Frames are read and written as over TCP, without the costs of
+/// the loopback network stack.
+
+class LocalEndpoint : public Endpoint {
+  public:
+    /// \brief LocalEndpoint constructor
+    /// \param path Filesystem path of the broker's socket
+    /// \param vhost vhost name
+    LocalEndpoint(bsl::string_view path, bsl::string_view vhost);
+
+    bsl::string formatAddress() const BSLS_KEYWORD_OVERRIDE;
+
+    /// The socket path
+    bsl::string hostname() const BSLS_KEYWORD_OVERRIDE;
+    bsl::string vhost() const BSLS_KEYWORD_OVERRIDE;
+
+    /// Always 0, a Unix domain socket has no port
+    bsl::uint16_t port() const BSLS_KEYWORD_OVERRIDE;
+
+    bsl::string localPath() const BSLS_KEYWORD_OVERRIDE;
+
+  private:
+    bsl::string d_path;
+    bsl::string d_vhost;
+};
+
+} // namespace rmqt
+} // namespace BloombergLP
+
+#endif
@@ -0,0 +1,94 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQT_LOG
+#define INCLUDED_RMQT_LOG
+
+#include <rmqt_logthrottle.h>
+
+#include <ball_log.h>
+#include <ball_severity.h>
+#include <bsls_performancehint.h>
+
+//@PURPOSE: Logging macros for verbose messages which can be compiled out
+//
+//@MACROS:
+//  RMQT_LOG_TRACE: `BALL_LOG_TRACE`, unless compiled out
+//  RMQT_LOG_DEBUG: `BALL_LOG_DEBUG`, unless compiled out
+//  RMQ_MIN_LOG_LEVEL: The least severe level which is compiled in
+//  RMQT_LOG_ERROR_THROTTLED: `BALL_LOG_ERROR`, throttled per log site
+//  RMQT_LOG_WARN_THROTTLED: `BALL_LOG_WARN`, throttled per log site
+//
+// `RMQ_MIN_LOG_LEVEL` is set with the CMake option of the same name, to one
+// of the `RMQT_LOG_LEVEL_*` values below. It defaults to
+// `RMQT_LOG_LEVEL_TRACE`, which keeps every message. Messages less severe
+// than it are discarded at compile time: the condition guarding them is a
+// constant expression, so neither the category threshold check nor the
+// streamed expressions are evaluated. Those expressions are still compiled,
+// so they cannot rot.
+//
+// Messages which are compiled in check the category threshold as
+// `BALL_LOG_*` does, hinting to the compiler that they are disabled. Use
+// these macros in place of `BALL_LOG_TRACE` and `BALL_LOG_DEBUG`, e.g.
+//
+//  RMQT_LOG_TRACE << "Deliver: " << deliver;
+//
+// Errors and warnings which repeat for every connection attempt or every
+// frame during a reconnect storm use the throttled macros, which log at most
+// `rmqt::LogThrottle::messageLimit()` messages per site per window and
+// report how many were suppressed in between (see `rmqt_logthrottle.h`).
+// Messages which are not enabled do not count against the budget.
+
+#define RMQT_LOG_LEVEL_TRACE 192 // ball::Severity::e_TRACE
+#define RMQT_LOG_LEVEL_DEBUG 160 // ball::Severity::e_DEBUG
+#define RMQT_LOG_LEVEL_INFO 128  // ball::Severity::e_INFO
+
+#ifndef RMQ_MIN_LOG_LEVEL
+#define RMQ_MIN_LOG_LEVEL RMQT_LOG_LEVEL_TRACE
+#endif
+
+#define RMQT_LOG_IMP(LEVEL, SEVERITY)                                        \
+    if ((LEVEL) > RMQ_MIN_LOG_LEVEL ||                                       \
+        !BSLS_PERFORMANCEHINT_PREDICT_UNLIKELY(                              \
+            BALL_LOG_IS_ENABLED(SEVERITY))) {                                \
+    }                                                                        \
+    else
+
+#define RMQT_LOG_TRACE                                                       \
+    RMQT_LOG_IMP(RMQT_LOG_LEVEL_TRACE, BloombergLP::ball::Severity::e_TRACE) \
+    BALL_LOG_TRACE
+
+#define RMQT_LOG_DEBUG                                                       \
+    RMQT_LOG_IMP(RMQT_LOG_LEVEL_DEBUG, BloombergLP::ball::Severity::e_DEBUG) \
+    BALL_LOG_DEBUG
+
+#define RMQT_LOG_THROTTLED_IMP(SEVERITY)                                     \
+    if (!BALL_LOG_IS_ENABLED(SEVERITY)) {                                    \
+    }                                                                        \
+    else                                                                     \
+        for (BloombergLP::rmqt::LogPermit rmqt_logPermit(                    \
+                 BloombergLP::rmqt::LogThrottle::forSite(__FILE__,           \
+                                                         __LINE__));         \
+             rmqt_logPermit.take();)
+
+#define RMQT_LOG_ERROR_THROTTLED                                             \
+    RMQT_LOG_THROTTLED_IMP(BloombergLP::ball::Severity::e_ERROR)             \
+    BALL_LOG_ERROR << rmqt_logPermit
+
+#define RMQT_LOG_WARN_THROTTLED                                              \
+    RMQT_LOG_THROTTLED_IMP(BloombergLP::ball::Severity::e_WARN)              \
+    BALL_LOG_WARN << rmqt_logPermit
+
+#endif // ! INCLUDED_RMQT_LOG
@@ -0,0 +1,116 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqt_logthrottle.h>
+
+#include <bsls_systemtime.h>
+
+#include <bsl_cstdint.h>
+
+namespace BloombergLP {
+namespace rmqt {
+namespace {
+
+const int k_NUM_SITES = 512;
+
+bsls::AtomicInt s_messageLimit(20);
+bsls::AtomicInt64 s_windowMilliseconds(10000);
+
+LogThrottle s_sites[k_NUM_SITES];
+
+} // namespace
+
+void LogThrottle::setLimit(int messages, const bsls::TimeInterval& window)
+{
+    s_messageLimit.storeRelaxed(messages < 0 ? 0 : messages);
+    s_windowMilliseconds.storeRelaxed(window.totalMilliseconds());
+}
+
+int LogThrottle::messageLimit() { return s_messageLimit.loadRelaxed(); }
+
+bsls::TimeInterval LogThrottle::window()
+{
+    bsls::TimeInterval window;
+    window.addMilliseconds(s_windowMilliseconds.loadRelaxed());
+    return window;
+}
+
+LogThrottle& LogThrottle::forSite(const char* file, int line)
+{
+    const bsl::uintptr_t hash =
+        reinterpret_cast<bsl::uintptr_t>(file) * 31 + line;
+    return s_sites[hash % k_NUM_SITES];
+}
+
+LogThrottle::LogThrottle()
+: d_windowStart(0)
+, d_permitted(0)
+, d_suppressed(0)
+{
+}
+
+bool LogThrottle::permit(int* suppressed, const bsls::TimeInterval& now)
+{
+    *suppressed     = 0;
+    const int limit = s_messageLimit.loadRelaxed();
+    if (limit == 0) {
+        return true;
+    }
+
+    // Races between threads only blur the edges of a window, which is fine
+    // for a log budget
+    const bsls::Types::Int64 nowMs = now.totalMilliseconds();
+    const bsls::Types::Int64 start = d_windowStart.loadRelaxed();
+    if (nowMs - start >= s_windowMilliseconds.loadRelaxed() &&
+        d_windowStart.testAndSwap(start, nowMs) == start) {
+        d_permitted.storeRelaxed(0);
+    }
+
+    if (d_permitted.addRelaxed(1) <= limit) {
+        *suppressed = d_suppressed.swap(0);
+        return true;
+    }
+    d_suppressed.addRelaxed(1);
+    return false;
+}
+
+bool LogThrottle::permit(int* suppressed)
+{
+    return permit(suppressed, bsls::SystemTime::nowMonotonicClock());
+}
+
+LogPermit::LogPermit(LogThrottle& throttle)
+: d_suppressed(0)
+, d_permitted(throttle.permit(&d_suppressed))
+{
+}
+
+bool LogPermit::take()
+{
+    const bool permitted = d_permitted;
+    d_permitted          = false;
+    return permitted;
+}
+
+bsl::ostream& operator<<(bsl::ostream& os, const LogPermit& permit)
+{
+    if (permit.suppressed() > 0) {
+        os << "(" << permit.suppressed() << " similar messages suppressed) ";
+    }
+    return os;
+}
+
+} // namespace rmqt
+} // namespace BloombergLP
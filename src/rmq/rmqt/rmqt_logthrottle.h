@@ -0,0 +1,101 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQT_LOGTHROTTLE
+#define INCLUDED_RMQT_LOGTHROTTLE
+
+#include <bsls_atomic.h>
+#include <bsls_timeinterval.h>
+#include <bsls_types.h>
+
+#include <bsl_ostream.h>
+
+//@PURPOSE: Limit how often a single log statement can emit during a storm
+//
+//@CLASSES:
+//  rmqt::LogThrottle: Per log site budget of messages in a time window
+//  rmqt::LogPermit: Admits one throttled message, reporting those suppressed
+//
+// A reconnect storm makes the same few error and warning statements fire
+// for every connection attempt, on the event loop thread. With a
+// synchronous `ball` observer each one is written before the loop can go
+// on processing frames. `RMQT_LOG_ERROR_THROTTLED` and
+// `RMQT_LOG_WARN_THROTTLED` (see `rmqt_log.h`) let each site log at most
+// `messageLimit()` messages per `window()`. The first message a site logs
+// after it was throttled begins with the number of messages suppressed in
+// between, e.g. "(41 similar messages suppressed) Error Connecting ...".
+//
+// Sites are told apart by a hash of their file and line into a fixed table,
+// so the check takes no locks and allocates nothing. Two sites which hash
+// alike share a budget.
+
+namespace BloombergLP {
+namespace rmqt {
+
+class LogThrottle {
+  public:
+    /// Let each site log at most `messages` messages per `window`, for the
+    /// whole process. A `messages` of 0 turns throttling off. Defaults to
+    /// 20 messages per 10 seconds.
+    static void setLimit(int messages, const bsls::TimeInterval& window);
+
+    static int messageLimit();
+    static bsls::TimeInterval window();
+
+    /// The throttle of the log statement at `line` of `file`
+    static LogThrottle& forSite(const char* file, int line);
+
+    LogThrottle();
+
+    /// Return true if a message may be logged at `now` (on the monotonic
+    /// clock). If it may, load into `suppressed` the number of messages
+    /// refused since the last one permitted, otherwise load 0.
+    bool permit(int* suppressed, const bsls::TimeInterval& now);
+
+    /// As above, at the current time
+    bool permit(int* suppressed);
+
+  private:
+    LogThrottle(const LogThrottle&);
+    LogThrottle& operator=(const LogThrottle&);
+
+    bsls::AtomicInt64 d_windowStart;
+    bsls::AtomicInt d_permitted;
+    bsls::AtomicInt d_suppressed;
+};
+
+/// Asks a `LogThrottle` once and admits the log statement guarded by it at
+/// most once, as the condition of a `for` loop
+class LogPermit {
+  public:
+    explicit LogPermit(LogThrottle& throttle);
+
+    /// Return true the first time if the message was permitted, false after
+    bool take();
+
+    int suppressed() const { return d_suppressed; }
+
+  private:
+    int d_suppressed;
+    bool d_permitted;
+};
+
+/// Writes the suppressed message summary, if any were suppressed
+bsl::ostream& operator<<(bsl::ostream& os, const LogPermit& permit);
+
+} // namespace rmqt
+} // namespace BloombergLP
+
+#endif
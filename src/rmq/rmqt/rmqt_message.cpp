@@ -16,11 +16,16 @@
 #include <rmqt_message.h>
 
 #include <rmqt_fieldvalue.h>
+#include <rmqt_log.h>
+#include <rmqt_messageguidutil.h>
 #include <rmqt_properties.h>
 
 #include <ball_log.h>
 #include <bdlb_guidutil.h>
+#include <bslma_default.h>
+#include <bslmt_once.h>
 
+#include <bsl_cstring.h>
 #include <bsl_string.h>
 
 namespace BloombergLP {
@@ -29,39 +34,60 @@ namespace rmqt {
 namespace {
 BALL_LOG_SET_NAMESPACE_CATEGORY("RMQT.MESSAGE")
 
-rmqt::Properties
+bsl::shared_ptr<rmqt::Properties>
 initialiseProperties(const bsl::string& msgId = "",
                      const bsl::shared_ptr<rmqt::FieldTable>& headers =
                          bsl::shared_ptr<rmqt::FieldTable>())
 {
-    rmqt::Properties p;
-    p.headers      = headers;
-    p.messageId    = msgId;
-    p.deliveryMode = rmqt::DeliveryMode::PERSISTENT;
+    bsl::shared_ptr<rmqt::Properties> p =
+        bsl::make_shared<rmqt::Properties>();
+    p->headers      = headers;
+    p->messageId    = msgId;
+    p->deliveryMode = rmqt::DeliveryMode::PERSISTENT;
     return p;
 }
 
+/// Shared by default constructed messages, which copy it on write
+const bsl::shared_ptr<rmqt::Properties>& defaultProperties()
+{
+    static bsl::shared_ptr<rmqt::Properties>* s_properties;
+    BSLMT_ONCE_DO
+    {
+        // Never freed, as messages may still be destroyed during static
+        // destruction
+        bslma::Allocator* allocator = bslma::Default::globalAllocator();
+        s_properties = new (*allocator)
+            bsl::shared_ptr<rmqt::Properties>(initialiseProperties());
+    }
+    return *s_properties;
+}
+
 void setMessageId(rmqt::Properties& p, bdlb::Guid& guid)
 {
     bsl::string messageId = p.messageId.value_or("");
     if (messageId.empty()) {
-        guid        = bdlb::GuidUtil::generate();
+        guid        = MessageGuidUtil::generate();
         p.messageId = bdlb::GuidUtil::guidToString(guid);
     }
     // bdlb::GuidUtil::guidFromString returns 0 on success and a positive value
     // on failure
     else if (bdlb::GuidUtil::guidFromString(&guid, messageId)) {
-        BALL_LOG_TRACE << "messageId wasn't a guid";
-        guid = bdlb::GuidUtil::generate();
+        RMQT_LOG_TRACE << "messageId wasn't a guid";
+        guid = MessageGuidUtil::generate();
     }
 }
 
 } // namespace
 
+const bsl::size_t Message::INLINE_PAYLOAD_CAPACITY;
+
 Message::Message()
 : d_guid()
 , d_message()
-, d_properties(initialiseProperties())
+, d_segments()
+, d_properties(defaultProperties())
+, d_headersView()
+, d_inlineSize(0)
 {
 }
 
@@ -70,27 +96,160 @@ Message::Message(const bsl::shared_ptr<bsl::vector<uint8_t> >& rawData,
                  const bsl::shared_ptr<rmqt::FieldTable>& headers)
 : d_guid()
 , d_message(rawData)
+, d_segments()
 , d_properties(initialiseProperties(messageId, headers))
+, d_headersView()
+, d_inlineSize(0)
 {
-    setMessageId(d_properties, d_guid);
+    setMessageId(*d_properties, d_guid);
 }
 
 Message::Message(const bsl::shared_ptr<const bsl::vector<uint8_t> >& rawData,
                  const rmqt::Properties& properties)
 : d_guid()
 , d_message(rawData)
-, d_properties(properties)
+, d_segments()
+, d_properties(bsl::make_shared<rmqt::Properties>(properties))
+, d_headersView()
+, d_inlineSize(0)
 {
-    setMessageId(d_properties, d_guid);
+    setMessageId(*d_properties, d_guid);
 }
 
 Message::Message(const bsl::shared_ptr<bsl::vector<uint8_t> >& rawData,
                  const rmqt::Properties& properties)
 : d_guid()
 , d_message(rawData)
-, d_properties(properties)
+, d_segments()
+, d_properties(bsl::make_shared<rmqt::Properties>(properties))
+, d_headersView()
+, d_inlineSize(0)
+{
+    setMessageId(*d_properties, d_guid);
+}
+
+Message::Message(const bsl::shared_ptr<const rmqt::SegmentedPayload>& payload,
+                 const rmqt::Properties& properties)
+: d_guid()
+, d_message()
+, d_segments(payload)
+, d_properties(bsl::make_shared<rmqt::Properties>(properties))
+, d_headersView()
+, d_inlineSize(0)
 {
-    setMessageId(d_properties, d_guid);
+    setMessageId(*d_properties, d_guid);
+}
+
+Message::Message(const uint8_t* data,
+                 bsl::size_t size,
+                 const bsl::shared_ptr<const void>& owner,
+                 const rmqt::Properties& properties)
+: d_guid()
+, d_message()
+, d_segments()
+, d_properties(bsl::make_shared<rmqt::Properties>(properties))
+, d_headersView()
+, d_inlineSize(0)
+{
+    bsl::shared_ptr<rmqt::SegmentedPayload> payload =
+        bsl::make_shared<rmqt::SegmentedPayload>();
+    if (size) {
+        payload->append(data, size, owner);
+    }
+    d_segments = payload;
+
+    setMessageId(*d_properties, d_guid);
+}
+
+Message::Message(const uint8_t* data,
+                 bsl::size_t size,
+                 const rmqt::Properties& properties)
+: d_guid()
+, d_message()
+, d_segments()
+, d_properties(bsl::make_shared<rmqt::Properties>(properties))
+, d_headersView()
+, d_inlineSize(0)
+{
+    if (size <= INLINE_PAYLOAD_CAPACITY) {
+        if (size) {
+            bsl::memcpy(d_inline, data, size);
+        }
+        d_inlineSize = size;
+    }
+    else {
+        d_message = bsl::make_shared<bsl::vector<uint8_t> >(data, data + size);
+    }
+
+    setMessageId(*d_properties, d_guid);
+}
+
+Message::Message(const Message& other)
+: d_guid(other.d_guid)
+, d_message(other.d_message)
+, d_segments(other.d_segments)
+, d_properties(other.d_properties)
+, d_headersView(other.d_headersView)
+, d_inlineSize(other.d_inlineSize)
+{
+    // Only the bytes in use are copied
+    bsl::memcpy(d_inline, other.d_inline, d_inlineSize);
+}
+
+Message& Message::operator=(const Message& other)
+{
+    if (this != &other) {
+        d_guid        = other.d_guid;
+        d_message     = other.d_message;
+        d_segments    = other.d_segments;
+        d_properties  = other.d_properties;
+        d_headersView = other.d_headersView;
+        d_inlineSize  = other.d_inlineSize;
+        bsl::memcpy(d_inline, other.d_inline, d_inlineSize);
+    }
+    return *this;
+}
+
+Message Message::withNewGuid() const
+{
+    Message copy(*this);
+    copy.d_guid = MessageGuidUtil::generate();
+    return copy;
+}
+
+rmqt::Properties& Message::properties()
+{
+    // Copies share the properties until one of them changes them
+    if (d_properties.use_count() > 1) {
+        d_properties = bsl::make_shared<rmqt::Properties>(*d_properties);
+    }
+    return *d_properties;
+}
+
+bool Message::findHeader(rmqt::FieldValue* value, const bsl::string& key) const
+{
+    if (d_headersView) {
+        return d_headersView->find(value, key);
+    }
+    if (!d_properties->headers) {
+        return false;
+    }
+
+    const rmqt::FieldTable& headers = *d_properties->headers;
+    const rmqt::FieldTable::const_iterator it = headers.find(key);
+    if (it == headers.end()) {
+        return false;
+    }
+    *value = it->second;
+    return true;
+}
+
+bsl::shared_ptr<rmqt::FieldTable> Message::decodedHeaders() const
+{
+    if (d_headersView && !d_properties->headers) {
+        return d_headersView->table();
+    }
+    return d_properties->headers;
 }
 
 bsl::ostream& operator<<(bsl::ostream& os, const rmqt::Message& message)
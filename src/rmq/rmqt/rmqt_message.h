@@ -16,8 +16,10 @@
 #ifndef INCLUDED_RMQT_MESSAGE
 #define INCLUDED_RMQT_MESSAGE
 
+#include <rmqt_fieldtableview.h>
 #include <rmqt_fieldvalue.h>
 #include <rmqt_properties.h>
+#include <rmqt_segmentedpayload.h>
 
 #include <bdlb_guid.h>
 
@@ -42,6 +44,10 @@ namespace rmqt {
 
 class Message {
   public:
+    /// Payloads up to this size can be held inside the message itself, see
+    /// the copying constructor
+    static const bsl::size_t INLINE_PAYLOAD_CAPACITY = 256;
+
     Message();
     /// \brief RabbitMQ message constructor. By default, message will have
     ///        persistent delivery-mode.
@@ -67,35 +73,147 @@ class Message {
     Message(const bsl::shared_ptr<const bsl::vector<uint8_t> >& rawData,
             const rmqt::Properties& properties);
 
+    /// \brief RabbitMQ message constructor for a payload made up of
+    ///        several segments, e.g. a consumed message spanning multiple
+    ///        frames. The segments are not copied.
+    /// \param payload Message raw data, as a chain of segments
+    /// \param properties Message properties
+    Message(const bsl::shared_ptr<const rmqt::SegmentedPayload>& payload,
+            const rmqt::Properties& properties);
+
+    /// \brief RabbitMQ message constructor for a payload in memory the
+    ///        caller already manages, e.g. a pooled slab or a memory-mapped
+    ///        segment. The bytes are not copied, and are framed for
+    ///        publishing without being copied either.
+    /// \param data Start of the payload
+    /// \param size Payload length in bytes
+    /// \param owner Kept alive for as long as the payload is referenced: by
+    ///        this message and its copies, by frames not yet written, and by
+    ///        producers until the message is confirmed. Give it a deleter to
+    ///        be told when the payload is released, e.g.
+    ///        `bsl::shared_ptr<const void>(slab, &returnToPool)`.
+    /// \param properties Message properties
+    Message(const uint8_t* data,
+            bsl::size_t size,
+            const bsl::shared_ptr<const void>& owner,
+            const rmqt::Properties& properties);
+
+    /// \brief RabbitMQ message constructor copying the payload. A payload
+    ///        of up to `INLINE_PAYLOAD_CAPACITY` bytes is held inside the
+    ///        message, so neither constructing nor copying the message
+    ///        allocates for it. Larger payloads are copied into a vector.
+    /// \param data Start of the payload
+    /// \param size Payload length in bytes
+    /// \param properties Message properties
+    Message(const uint8_t* data,
+            bsl::size_t size,
+            const rmqt::Properties& properties);
+
+    Message(const Message& other);
+
+    Message& operator=(const Message& other);
+
     /// \brief Message GUID
     /// \return A globally unique identifier of the message
     const bdlb::Guid& guid() const { return d_guid; }
 
+    /// \brief A copy of this message tracked under a new GUID. The copy
+    ///        shares the payload and the properties, message id included,
+    ///        so the same message can be published more than once at a
+    ///        time, e.g. to several routing keys.
+    Message withNewGuid() const;
+
     /// \brief Message id
     const bsl::string& messageId() const
     {
-        return d_properties.messageId.value();
+        return d_properties->messageId.value();
     }
 
     const bsl::shared_ptr<rmqt::FieldTable>& headers() const
     {
-        return d_properties.headers;
+        return d_properties->headers;
     }
 
-    rmqt::Properties& properties() { return d_properties; }
+    /// \brief Encoded headers of a message consumed with
+    ///        `rmqt::ConsumerConfig::setLazyHeaders`, or a null pointer. When
+    ///        set, `headers()` is null.
+    const bsl::shared_ptr<const rmqt::FieldTableView>& headersView() const
+    {
+        return d_headersView;
+    }
 
-    const rmqt::Properties& properties() const { return d_properties; }
+    /// \brief Look up the header `key`, loading it into `value`. For lazy
+    ///        headers only this header is decoded.
+    /// \return true if the message has the header `key`
+    bool findHeader(rmqt::FieldValue* value, const bsl::string& key) const;
+
+    /// \brief The message headers, decoding lazy headers on first use
+    bsl::shared_ptr<rmqt::FieldTable> decodedHeaders() const;
+
+    /// \brief Attach lazily decoded headers. Used by the library for
+    ///        consumed messages
+    void setHeadersView(
+        const bsl::shared_ptr<const rmqt::FieldTableView>& headersView)
+    {
+        d_headersView = headersView;
+    }
+
+    /// \brief Message properties, for modification. Copies of a message
+    ///        share its properties until one of them calls this, when it
+    ///        takes a copy of its own, so the returned reference should not
+    ///        be held while the message is copied.
+    rmqt::Properties& properties();
+
+    const rmqt::Properties& properties() const { return *d_properties; }
 
     /// \brief Message payload
+    ///
+    /// For a segmented payload (see `payloadSegments`) this copies the
+    /// segments into a single buffer on first use.
     const uint8_t* payload() const
     {
-        return d_message ? d_message->data() : NULL;
+        return d_message      ? d_message->data()
+               : d_segments   ? d_segments->contiguous()
+               : d_inlineSize ? d_inline
+                              : NULL;
     }
 
     /// \brief Message payload size
     bsl::size_t payloadSize() const
     {
-        return d_message ? d_message->size() : 0;
+        return d_message    ? d_message->size()
+               : d_segments ? d_segments->size()
+                            : d_inlineSize;
+    }
+
+    /// \brief The payload as a chain of segments, or a null pointer if the
+    ///        payload is held in a single buffer. Iterating the segments
+    ///        avoids the copy made by `payload()`.
+    const bsl::shared_ptr<const rmqt::SegmentedPayload>&
+    payloadSegments() const
+    {
+        return d_segments;
+    }
+
+    /// \brief Shared ownership of the payload storage. Used by the library
+    ///        to reference the payload without copying it. Null for a
+    ///        payload held inside the message, which must be copied.
+    bsl::shared_ptr<const void> payloadOwner() const
+    {
+        if (d_segments) {
+            return d_segments;
+        }
+        return d_message;
+    }
+
+    /// \brief Replace the payload, keeping the GUID and properties. Used by
+    ///        the library to swap in a compressed or decompressed payload
+    void updatePayload(
+        const bsl::shared_ptr<const bsl::vector<uint8_t> >& rawData)
+    {
+        d_message = rawData;
+        d_segments.reset();
+        d_inlineSize = 0;
     }
 
     /// \brief Update delivery-mode(Persistent or Non-persistent). Default
@@ -104,19 +222,19 @@ class Message {
     ///        durable queues.
     void updateDeliveryMode(const rmqt::DeliveryMode::Value& deliveryMode)
     {
-        d_properties.deliveryMode = deliveryMode;
+        properties().deliveryMode = deliveryMode;
     }
 
     /// \brief Update update-priority. Default no priority
     void updateMessagePriority(const bsl::uint8_t& priority)
     {
-        d_properties.priority = priority;
+        properties().priority = priority;
     }
 
     /// \brief Return true, if delivery-mode is persistent for the message
     bool isPersistent() const
     {
-        return d_properties.deliveryMode.value_or(
+        return d_properties->deliveryMode.value_or(
                    rmqt::DeliveryMode::NON_PERSISTENT) ==
                rmqt::DeliveryMode::PERSISTENT;
     }
@@ -124,7 +242,15 @@ class Message {
   private:
     bdlb::Guid d_guid;
     bsl::shared_ptr<const bsl::vector<uint8_t> > d_message;
-    Properties d_properties;
+    bsl::shared_ptr<const rmqt::SegmentedPayload> d_segments;
+
+    // Shared between copies of this message, copied on write
+    bsl::shared_ptr<Properties> d_properties;
+    bsl::shared_ptr<const rmqt::FieldTableView> d_headersView;
+
+    // A small payload, held when neither `d_message` nor `d_segments` is set
+    bsl::size_t d_inlineSize;
+    uint8_t d_inline[INLINE_PAYLOAD_CAPACITY];
 };
 
 bsl::ostream& operator<<(bsl::ostream& os, const rmqt::Message& message);
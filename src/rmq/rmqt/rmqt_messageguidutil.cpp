@@ -0,0 +1,101 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqt_messageguidutil.h>
+
+#include <bdlb_guidutil.h>
+#include <bslmt_once.h>
+#include <bslmt_threadutil.h>
+#include <bsls_atomic.h>
+#include <bsls_types.h>
+
+#include <bsl_cstring.h>
+
+namespace BloombergLP {
+namespace rmqt {
+namespace {
+
+bsls::AtomicInt s_mode(MessageGuidMode::RANDOM);
+
+/// The prefix and counter of one thread's COUNTER mode GUIDs
+struct CounterState {
+    unsigned char prefix[8];
+    bsls::Types::Uint64 counter;
+};
+
+void deleteCounterState(void* state)
+{
+    delete static_cast<CounterState*>(state);
+}
+
+bslmt::ThreadUtil::Key counterStateKey()
+{
+    static bslmt::ThreadUtil::Key key;
+    BSLMT_ONCE_DO { bslmt::ThreadUtil::createKey(&key, &deleteCounterState); }
+    return key;
+}
+
+CounterState& threadCounterState()
+{
+    const bslmt::ThreadUtil::Key key = counterStateKey();
+
+    CounterState* state =
+        static_cast<CounterState*>(bslmt::ThreadUtil::getSpecific(key));
+    if (!state) {
+        const bdlb::Guid seed = bdlb::GuidUtil::generate();
+
+        state = new CounterState();
+        bsl::memcpy(state->prefix, seed.begin(), sizeof(state->prefix));
+        state->counter = 0;
+        bslmt::ThreadUtil::setSpecific(key, state);
+    }
+    return *state;
+}
+
+bdlb::Guid generateCounter()
+{
+    CounterState& state             = threadCounterState();
+    const bsls::Types::Uint64 count = ++state.counter;
+
+    unsigned char bytes[bdlb::Guid::k_GUID_NUM_BYTES];
+    bsl::memcpy(bytes, state.prefix, sizeof(state.prefix));
+    for (int i = 0; i < 8; ++i) {
+        bytes[15 - i] = static_cast<unsigned char>(count >> (8 * i));
+    }
+    return bdlb::Guid(bytes);
+}
+
+} // namespace
+
+void MessageGuidUtil::setMode(MessageGuidMode::Value mode)
+{
+    s_mode.storeRelease(mode);
+}
+
+MessageGuidMode::Value MessageGuidUtil::mode()
+{
+    return static_cast<MessageGuidMode::Value>(s_mode.loadAcquire());
+}
+
+bdlb::Guid MessageGuidUtil::generate()
+{
+    if (mode() == MessageGuidMode::COUNTER) {
+        return generateCounter();
+    }
+    return bdlb::GuidUtil::generate();
+}
+
+} // namespace rmqt
+} // namespace BloombergLP
@@ -0,0 +1,54 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQT_MESSAGEGUIDUTIL
+#define INCLUDED_RMQT_MESSAGEGUIDUTIL
+
+#include <bdlb_guid.h>
+
+//@PURPOSE: Generate the GUIDs identifying messages
+//
+//@CLASSES:
+//  rmqt::MessageGuidUtil: Generates `rmqt::Message` GUIDs, by the process
+//      wide `MessageGuidMode`
+
+namespace BloombergLP {
+namespace rmqt {
+
+/// How `rmqt::Message` GUIDs are generated
+/// RANDOM: every GUID is drawn from the cryptographically secure random
+///         source, see `bdlb::GuidUtil::generate`
+/// COUNTER: each thread draws a random 64 bit prefix once, and the rest of
+///          each GUID is a per-thread counter. Much cheaper, and still
+///          unique, but successive GUIDs are predictable, so they must not
+///          be used as secrets.
+namespace MessageGuidMode {
+typedef enum { RANDOM = 0, COUNTER = 1 } Value;
+}
+
+struct MessageGuidUtil {
+    /// Generate GUIDs by `mode` from here on, in every thread
+    static void setMode(MessageGuidMode::Value mode);
+
+    static MessageGuidMode::Value mode();
+
+    /// Return a new GUID, generated by the current mode
+    static bdlb::Guid generate();
+};
+
+} // namespace rmqt
+} // namespace BloombergLP
+
+#endif // ! INCLUDED_RMQT_MESSAGEGUIDUTIL
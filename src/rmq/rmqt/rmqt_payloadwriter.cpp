@@ -0,0 +1,68 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqt_payloadwriter.h>
+
+#include <bslma_default.h>
+#include <bsls_assert.h>
+
+namespace BloombergLP {
+namespace rmqt {
+namespace {
+
+/// Returns a buffer to the allocator it came from
+class Deallocator {
+  public:
+    explicit Deallocator(bslma::Allocator* allocator)
+    : d_allocator(allocator)
+    {
+    }
+
+    void operator()(bsl::uint8_t* buffer) const
+    {
+        d_allocator->deallocate(buffer);
+    }
+
+  private:
+    bslma::Allocator* d_allocator;
+};
+
+} // namespace
+
+PayloadWriter::PayloadWriter(bsl::size_t capacity,
+                             bslma::Allocator* allocator)
+: d_buffer()
+, d_capacity(capacity)
+{
+    bslma::Allocator* alloc = bslma::Default::allocator(allocator);
+    d_buffer.reset(static_cast<bsl::uint8_t*>(alloc->allocate(capacity)),
+                   Deallocator(alloc));
+}
+
+rmqt::Message PayloadWriter::commit(bsl::size_t size,
+                                    const rmqt::Properties& properties)
+{
+    BSLS_ASSERT(d_buffer);
+    BSLS_ASSERT(size <= d_capacity);
+
+    const rmqt::Message message(d_buffer.get(), size, d_buffer, properties);
+
+    d_buffer.reset();
+    d_capacity = 0;
+    return message;
+}
+
+} // namespace rmqt
+} // namespace BloombergLP
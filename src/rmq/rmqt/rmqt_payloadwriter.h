@@ -0,0 +1,86 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQT_PAYLOADWRITER
+#define INCLUDED_RMQT_PAYLOADWRITER
+
+#include <rmqt_message.h>
+#include <rmqt_properties.h>
+
+#include <bslma_allocator.h>
+#include <bsls_keyword.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_cstdint.h>
+#include <bsl_memory.h>
+
+//@PURPOSE: Serialize a message payload straight into its final buffer
+//
+//@CLASSES:
+//  rmqt::PayloadWriter: A writable payload buffer, committed as a message
+
+namespace BloombergLP {
+namespace rmqt {
+
+/// \brief Lets a producer encode a payload in place, e.g. with protobuf's
+/// `SerializeToArray` or a flatbuffers builder, instead of encoding it into
+/// a buffer of its own which is then wrapped in a vector
+///
+/// The writer reserves `capacity` uninitialized bytes from its allocator,
+/// such as the pool given to `rmqa::RabbitContextOptions::setAllocator`.
+/// Once the payload is written, `commit` returns a message referencing the
+/// buffer. Published messages are framed as views over their payload, so
+/// the payload bytes are written exactly once, by the encoder.
+///
+/// ```
+/// rmqt::PayloadWriter writer(request.ByteSizeLong(), allocator);
+/// request.SerializeToArray(writer.data(), writer.capacity());
+/// producer.send(writer.commit(writer.capacity()), "key", onConfirm, 0);
+/// ```
+///
+/// Not thread safe.
+
+class PayloadWriter {
+  public:
+    /// Reserve `capacity` bytes from `allocator`, or from the default
+    /// allocator if 0. The allocator must be thread safe, and outlive the
+    /// message returned by `commit`.
+    explicit PayloadWriter(bsl::size_t capacity,
+                           bslma::Allocator* allocator = 0);
+
+    /// The bytes to encode the payload into, or 0 once committed
+    bsl::uint8_t* data() { return d_buffer.get(); }
+
+    bsl::size_t capacity() const { return d_capacity; }
+
+    /// Return a message whose payload is the first `size` bytes written,
+    /// with `properties`. The buffer is handed to the message without being
+    /// copied, and the writer is left empty. The behavior is undefined
+    /// unless `size <= capacity()` and the writer was not committed yet.
+    rmqt::Message commit(bsl::size_t size,
+                         const rmqt::Properties& properties = Properties());
+
+  private:
+    PayloadWriter(const PayloadWriter&) BSLS_KEYWORD_DELETED;
+    PayloadWriter& operator=(const PayloadWriter&) BSLS_KEYWORD_DELETED;
+
+    bsl::shared_ptr<bsl::uint8_t> d_buffer;
+    bsl::size_t d_capacity;
+}; // class PayloadWriter
+
+} // namespace rmqt
+} // namespace BloombergLP
+
+#endif // ! INCLUDED_RMQT_PAYLOADWRITER
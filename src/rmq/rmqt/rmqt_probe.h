@@ -0,0 +1,64 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQT_PROBE
+#define INCLUDED_RMQT_PROBE
+
+//@PURPOSE: Static tracepoints on the message path, compiled in on request
+//
+//@MACROS:
+//  RMQT_PROBE0: A USDT probe without arguments, unless compiled out
+//  RMQT_PROBE1: A USDT probe with one integer or pointer argument
+//  RMQT_PROBE2: A USDT probe with two arguments
+//  RMQT_PROBE3: A USDT probe with three arguments
+//  RMQ_USDT_PROBES: Defined when the probes are compiled in
+//
+// `RMQ_USDT_PROBES` is defined by the CMake option of the same name, which
+// needs `<sys/sdt.h>` (systemtap-sdt-dev). Each probe is then a single nop
+// in the `rmq` provider, listed by `bpftrace -l 'usdt:librmq*:rmq:*'`,
+// whose arguments are only read once a tracer attaches. Without it the
+// probes and their arguments are discarded at compile time, but still
+// compiled, so they cannot rot. Probe arguments should be cheap to
+// evaluate, as they are evaluated whenever the probes are compiled in, e.g.
+//
+//  RMQT_PROBE2(ack_sent, deliveryTag, multiple);
+
+#ifdef RMQ_USDT_PROBES
+
+#include <sys/sdt.h>
+
+#define RMQT_PROBE0(NAME) DTRACE_PROBE(rmq, NAME)
+#define RMQT_PROBE1(NAME, A1) DTRACE_PROBE1(rmq, NAME, A1)
+#define RMQT_PROBE2(NAME, A1, A2) DTRACE_PROBE2(rmq, NAME, A1, A2)
+#define RMQT_PROBE3(NAME, A1, A2, A3) DTRACE_PROBE3(rmq, NAME, A1, A2, A3)
+
+#else
+
+#define RMQT_PROBE_IMP(ARGS)                                                 \
+    do {                                                                     \
+        if (false) {                                                         \
+            ARGS;                                                            \
+        }                                                                    \
+    } while (false)
+
+#define RMQT_PROBE0(NAME) RMQT_PROBE_IMP((void)0)
+#define RMQT_PROBE1(NAME, A1) RMQT_PROBE_IMP((void)(A1))
+#define RMQT_PROBE2(NAME, A1, A2) RMQT_PROBE_IMP(((void)(A1), (void)(A2)))
+#define RMQT_PROBE3(NAME, A1, A2, A3)                                        \
+    RMQT_PROBE_IMP(((void)(A1), (void)(A2), (void)(A3)))
+
+#endif
+
+#endif // ! INCLUDED_RMQT_PROBE
@@ -66,6 +66,44 @@ namespace Mandatory {
 typedef enum { DISCARD_UNROUTABLE = 0, RETURN_UNROUTABLE = 1 } Value;
 }
 
+namespace PublisherConfirms {
+typedef enum { OFF = 0, ON = 1 } Value;
+}
+
+/// How a connection picks which of its endpoint's hosts to connect to, see
+/// `rmqt::Endpoint::hosts`. Hosts which recently failed to connect are
+/// skipped while others remain.
+namespace HostSelection {
+typedef enum {
+    ROUND_ROBIN       = 0, ///< Each host in turn
+    LEAST_CONNECTIONS = 1, ///< The host with fewest connections open to it
+    LATENCY_WEIGHTED  = 2  ///< As above, weighted by measured connect time
+} Value;
+}
+
+/// Bits naming the message properties, in AMQP property flag order. Combined
+/// with `|` to select the properties decoded for a consumer, see
+/// `rmqt::ConsumerConfig::setDecodedProperties`.
+namespace MessageProperty {
+typedef enum {
+    CONTENT_TYPE     = 1 << 0,
+    CONTENT_ENCODING = 1 << 1,
+    HEADERS          = 1 << 2,
+    DELIVERY_MODE    = 1 << 3,
+    PRIORITY         = 1 << 4,
+    CORRELATION_ID   = 1 << 5,
+    REPLY_TO         = 1 << 6,
+    EXPIRATION       = 1 << 7,
+    MESSAGE_ID       = 1 << 8,
+    TIMESTAMP        = 1 << 9,
+    TYPE             = 1 << 10,
+    USER_ID          = 1 << 11,
+    APP_ID           = 1 << 12,
+
+    ALL = (1 << 13) - 1
+} Value;
+}
+
 /// \brief Properties is an minimal abstraction of the properties one can set on
 /// a message
 ///
@@ -0,0 +1,56 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqt_ratelimit.h>
+
+#include <bsl_algorithm.h>
+#include <bsl_ostream.h>
+
+namespace BloombergLP {
+namespace rmqt {
+
+RateLimit::RateLimit()
+: d_messagesPerSecond(0)
+, d_messageBurst(1)
+, d_bytesPerSecond(0)
+, d_byteBurst(1)
+{
+}
+
+RateLimit& RateLimit::setMessageRate(double perSecond, bsl::size_t burst)
+{
+    d_messagesPerSecond = bsl::max(perSecond, 0.0);
+    d_messageBurst      = bsl::max<bsl::size_t>(burst, 1);
+    return *this;
+}
+
+RateLimit& RateLimit::setByteRate(double perSecond, bsl::size_t burst)
+{
+    d_bytesPerSecond = bsl::max(perSecond, 0.0);
+    d_byteBurst      = bsl::max<bsl::size_t>(burst, 1);
+    return *this;
+}
+
+bsl::ostream& operator<<(bsl::ostream& os, const RateLimit& limit)
+{
+    return os << "RateLimit = [ messagesPerSecond: "
+              << limit.messagesPerSecond()
+              << ", messageBurst: " << limit.messageBurst()
+              << ", bytesPerSecond: " << limit.bytesPerSecond()
+              << ", byteBurst: " << limit.byteBurst() << " ]";
+}
+
+} // namespace rmqt
+} // namespace BloombergLP
@@ -0,0 +1,69 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQT_RATELIMIT
+#define INCLUDED_RMQT_RATELIMIT
+
+#include <bsl_cstddef.h>
+#include <bsl_ostream.h>
+
+//@PURPOSE: Publish rate limits
+//
+//@CLASSES:
+//  rmqt::RateLimit: Message and byte rates, with bursts, to publish within
+
+namespace BloombergLP {
+namespace rmqt {
+
+/// \brief How fast messages may be published: at most a number of messages
+/// and of payload bytes per second, either of which may be unlimited
+///
+/// Each rate comes with a burst: how far publishing may run ahead of the
+/// rate after a quiet spell. A message larger than the byte burst waits
+/// until the whole burst is available, rather than forever.
+
+class RateLimit {
+  public:
+    /// No limits
+    RateLimit();
+
+    /// \param perSecond Messages per second. 0 (the default) does not
+    ///        limit messages.
+    /// \param burst     Messages which may be sent at once, at least 1
+    RateLimit& setMessageRate(double perSecond, bsl::size_t burst);
+
+    /// \param perSecond Payload bytes per second. 0 (the default) does not
+    ///        limit bytes.
+    /// \param burst     Bytes which may be sent at once, at least 1
+    RateLimit& setByteRate(double perSecond, bsl::size_t burst);
+
+    double messagesPerSecond() const { return d_messagesPerSecond; }
+    bsl::size_t messageBurst() const { return d_messageBurst; }
+    double bytesPerSecond() const { return d_bytesPerSecond; }
+    bsl::size_t byteBurst() const { return d_byteBurst; }
+
+  private:
+    double d_messagesPerSecond;
+    bsl::size_t d_messageBurst;
+    double d_bytesPerSecond;
+    bsl::size_t d_byteBurst;
+};
+
+bsl::ostream& operator<<(bsl::ostream& os, const RateLimit& limit);
+
+} // namespace rmqt
+} // namespace BloombergLP
+
+#endif
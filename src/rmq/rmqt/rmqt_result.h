@@ -171,6 +171,14 @@ typedef bsl::function<void()> SuccessCallback;
 /// SuccessCallback function will be called on client thread,
 /// whenever channel or connection will be restored.
 
+typedef bsl::function<void(
+    const bsl::string& vhostName, bool blocked, const bsl::string& reason)>
+    ConnectionBlockedCallback;
+/// ConnectionBlockedCallback function will be called on client thread,
+/// whenever the broker blocks a connection to `vhostName` (e.g. on a memory
+/// or disk alarm), and again when it unblocks it. `reason` is empty when
+/// unblocked.
+
 } // namespace rmqt
 } // namespace BloombergLP
 
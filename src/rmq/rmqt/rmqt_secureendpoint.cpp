@@ -28,6 +28,15 @@ SecureEndpoint::SecureEndpoint(
 {
 }
 
+SecureEndpoint::SecureEndpoint(
+    const HostList& hosts,
+    const bsl::string& vhost,
+    const bsl::shared_ptr<SecurityParameters>& params)
+: SimpleEndpoint(hosts, vhost)
+, d_params(params)
+{
+}
+
 SecureEndpoint::~SecureEndpoint() {}
 
 bsl::shared_ptr<SecurityParameters> SecureEndpoint::securityParameters() const
@@ -38,6 +38,11 @@ class SecureEndpoint : public SimpleEndpoint {
                    const bsl::string& vhost,
                    bsl::uint16_t port,
                    const bsl::shared_ptr<SecurityParameters>& params);
+
+    /// Connect to any of `hosts`, see `SimpleEndpoint`
+    SecureEndpoint(const HostList& hosts,
+                   const bsl::string& vhost,
+                   const bsl::shared_ptr<SecurityParameters>& params);
     ~SecureEndpoint();
 
     bsl::shared_ptr<SecurityParameters>
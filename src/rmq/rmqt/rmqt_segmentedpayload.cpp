@@ -0,0 +1,84 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqt_segmentedpayload.h>
+
+#include <bslmt_lockguard.h>
+
+namespace BloombergLP {
+namespace rmqt {
+
+SegmentedPayload::SegmentedPayload()
+: d_segments()
+, d_owners()
+, d_size(0)
+, d_flattenMutex()
+, d_flattened(0)
+, d_flattenedStorage()
+{
+}
+
+void SegmentedPayload::append(const bsl::uint8_t* data,
+                              bsl::size_t length,
+                              const bsl::shared_ptr<const void>& owner)
+{
+    if (length == 0) {
+        return;
+    }
+
+    d_segments.push_back(Segment(data, length));
+
+    // Consecutive frames decoded from the same read buffer share one owner
+    if (d_owners.empty() || d_owners.back() != owner) {
+        d_owners.push_back(owner);
+    }
+
+    d_size += length;
+}
+
+void SegmentedPayload::copyTo(bsl::vector<bsl::uint8_t>* out) const
+{
+    out->reserve(out->size() + d_size);
+    for (const_iterator it = begin(); it != end(); ++it) {
+        out->insert(out->end(), it->first, it->first + it->second);
+    }
+}
+
+const bsl::uint8_t* SegmentedPayload::contiguous() const
+{
+    if (d_segments.empty()) {
+        return 0;
+    }
+
+    if (d_segments.size() == 1) {
+        return d_segments.front().first;
+    }
+
+    const bsl::uint8_t* flattened = d_flattened.loadAcquire();
+    if (flattened) {
+        return flattened;
+    }
+
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_flattenMutex);
+    if (!d_flattened.loadRelaxed()) {
+        copyTo(&d_flattenedStorage);
+        d_flattened.storeRelease(d_flattenedStorage.data());
+    }
+
+    return d_flattened.loadRelaxed();
+}
+
+} // namespace rmqt
+} // namespace BloombergLP
@@ -0,0 +1,102 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQT_SEGMENTEDPAYLOAD
+#define INCLUDED_RMQT_SEGMENTEDPAYLOAD
+
+#include <bslmt_mutex.h>
+#include <bsls_atomic.h>
+#include <bsls_keyword.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_cstdint.h>
+#include <bsl_memory.h>
+#include <bsl_utility.h>
+#include <bsl_vector.h>
+
+//@PURPOSE: Message payload held as a chain of shared segments
+//
+//@CLASSES:
+//  rmqt::SegmentedPayload: An ordered sequence of non-owning byte ranges,
+//  each kept alive by a shared owner
+
+namespace BloombergLP {
+namespace rmqt {
+
+/// \brief A message payload made up of one or more byte segments
+///
+/// Large consumed messages arrive as several content body frames. Rather than
+/// copying the frames into one buffer, the library chains the frames together
+/// as segments which reference the decoded read buffers directly. Consumers
+/// able to process the payload piece by piece can iterate the segments (e.g.
+/// building a `boost::asio::const_buffer` sequence) and never materialize a
+/// contiguous copy.
+///
+/// `contiguous()` is available for code requiring a single buffer: the
+/// segments are copied once, on first use, and the copy is shared by every
+/// `rmqt::Message` referencing this payload.
+
+class SegmentedPayload {
+  public:
+    /// A contiguous range of payload bytes: (data, length)
+    typedef bsl::pair<const bsl::uint8_t*, bsl::size_t> Segment;
+    typedef bsl::vector<Segment>::const_iterator const_iterator;
+
+    SegmentedPayload();
+
+    /// Append the `length` bytes at `data` to the payload. `owner` keeps
+    /// the bytes alive for the lifetime of this object.
+    void append(const bsl::uint8_t* data,
+                bsl::size_t length,
+                const bsl::shared_ptr<const void>& owner);
+
+    /// Total number of payload bytes across all segments
+    bsl::size_t size() const { return d_size; }
+
+    bsl::size_t numSegments() const { return d_segments.size(); }
+
+    const Segment& segment(bsl::size_t index) const
+    {
+        return d_segments[index];
+    }
+
+    const_iterator begin() const { return d_segments.begin(); }
+    const_iterator end() const { return d_segments.end(); }
+
+    /// Append every payload byte to `out`
+    void copyTo(bsl::vector<bsl::uint8_t>* out) const;
+
+    /// Return a pointer to the whole payload as a single buffer. A payload
+    /// with more than one segment is copied into contiguous storage the first
+    /// time this is called. Thread safe.
+    const bsl::uint8_t* contiguous() const;
+
+  private:
+    SegmentedPayload(const SegmentedPayload&) BSLS_KEYWORD_DELETED;
+    SegmentedPayload& operator=(const SegmentedPayload&) BSLS_KEYWORD_DELETED;
+
+    bsl::vector<Segment> d_segments;
+    bsl::vector<bsl::shared_ptr<const void> > d_owners;
+    bsl::size_t d_size;
+
+    mutable bslmt::Mutex d_flattenMutex;
+    mutable bsls::AtomicPointer<bsl::uint8_t> d_flattened;
+    mutable bsl::vector<bsl::uint8_t> d_flattenedStorage;
+};
+
+} // namespace rmqt
+} // namespace BloombergLP
+
+#endif
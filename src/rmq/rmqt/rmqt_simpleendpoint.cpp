@@ -15,28 +15,45 @@
 
 #include <rmqt_simpleendpoint.h>
 
+#include <bsls_assert.h>
+
 namespace BloombergLP {
 namespace rmqt {
 
 SimpleEndpoint::SimpleEndpoint(bsl::string_view address,
                                bsl::string_view vhost,
                                bsl::uint16_t port)
-: d_address(address)
+: d_hosts(1, Host(bsl::string(address), port))
+, d_vhost(vhost)
+{
+}
+
+SimpleEndpoint::SimpleEndpoint(const HostList& hosts, bsl::string_view vhost)
+: d_hosts(hosts)
 , d_vhost(vhost)
-, d_port(port)
 {
+    BSLS_ASSERT(!d_hosts.empty());
 }
 
 bsl::string SimpleEndpoint::formatAddress() const
 {
-    return protocol() + "://" + d_address + ":" + bsl::to_string(d_port) + "/" +
-           d_vhost;
+    bsl::string address = protocol() + "://";
+    for (HostList::const_iterator it = d_hosts.begin(); it != d_hosts.end();
+         ++it) {
+        if (it != d_hosts.begin()) {
+            address += ",";
+        }
+        address += it->first + ":" + bsl::to_string(it->second);
+    }
+    return address + "/" + d_vhost;
 }
 
-bsl::string SimpleEndpoint::hostname() const { return d_address; }
+bsl::string SimpleEndpoint::hostname() const { return d_hosts.front().first; }
 
 bsl::string SimpleEndpoint::vhost() const { return d_vhost; }
-bsl::uint16_t SimpleEndpoint::port() const { return d_port; }
+bsl::uint16_t SimpleEndpoint::port() const { return d_hosts.front().second; }
+
+Endpoint::HostList SimpleEndpoint::hosts() const { return d_hosts; }
 bsl::string SimpleEndpoint::protocol() const { return "amqp"; }
 
 } // namespace rmqt
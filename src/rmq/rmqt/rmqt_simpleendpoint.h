@@ -18,6 +18,8 @@
 
 #include <rmqt_endpoint.h>
 
+#include <bsls_keyword.h>
+
 #include <bsl_string.h>
 
 namespace BloombergLP {
@@ -38,18 +40,26 @@ class SimpleEndpoint : public Endpoint {
                    bsl::string_view vhost,
                    bsl::uint16_t port = 5672);
 
+    /// \brief SimpleEndpoint constructor for several hosts of a cluster
+    /// \param hosts The hostname and port of each, at least one
+    /// \param vhost vhost name
+    SimpleEndpoint(const HostList& hosts, bsl::string_view vhost);
+
     bsl::string formatAddress() const;
+
+    /// The first host's name and port
     bsl::string hostname() const;
     bsl::string vhost() const;
     unsigned short port() const;
 
+    HostList hosts() const BSLS_KEYWORD_OVERRIDE;
+
   protected:
     virtual bsl::string protocol() const;
 
   private:
-    bsl::string d_address;
+    HostList d_hosts;
     bsl::string d_vhost;
-    bsl::uint16_t d_port;
 };
 
 } // namespace rmqt
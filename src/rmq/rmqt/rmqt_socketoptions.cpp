@@ -0,0 +1,52 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqt_socketoptions.h>
+
+#include <bsl_ostream.h>
+
+namespace BloombergLP {
+namespace rmqt {
+
+SocketOptions::SocketOptions()
+: d_noDelay(true)
+, d_sendBufferSize(0)
+, d_receiveBufferSize(0)
+, d_quickAck(false)
+, d_busyPollMicroseconds(0)
+, d_userTimeout()
+, d_keepAlive(true)
+, d_keepAliveIdle()
+, d_keepAliveInterval()
+, d_keepAliveCount(0)
+{
+}
+
+bsl::ostream& operator<<(bsl::ostream& os, const SocketOptions& options)
+{
+    return os << "SocketOptions = [ noDelay: " << options.noDelay()
+              << ", sendBufferSize: " << options.sendBufferSize()
+              << ", receiveBufferSize: " << options.receiveBufferSize()
+              << ", quickAck: " << options.quickAck()
+              << ", busyPollMicroseconds: " << options.busyPollMicroseconds()
+              << ", userTimeout: " << options.userTimeout()
+              << ", keepAlive: " << options.keepAlive()
+              << ", keepAliveIdle: " << options.keepAliveIdle()
+              << ", keepAliveInterval: " << options.keepAliveInterval()
+              << ", keepAliveCount: " << options.keepAliveCount() << " ]";
+}
+
+} // namespace rmqt
+} // namespace BloombergLP
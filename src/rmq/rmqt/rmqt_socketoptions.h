@@ -0,0 +1,158 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQT_SOCKETOPTIONS
+#define INCLUDED_RMQT_SOCKETOPTIONS
+
+#include <bsls_timeinterval.h>
+
+#include <bsl_ostream.h>
+
+//@PURPOSE: TCP settings applied to broker connections
+//
+//@CLASSES:
+//  rmqt::SocketOptions: Socket options set on each connection's socket
+
+namespace BloombergLP {
+namespace rmqt {
+
+/// \brief Socket options set on every connection's socket, plain or TLS,
+/// once it connects and before the AMQP handshake
+///
+/// The defaults match what connections have always used: `TCP_NODELAY` and
+/// `SO_KEEPALIVE` on, everything else left to the operating system. Links
+/// with a large bandwidth-delay product (e.g. between datacenters) need
+/// larger buffers to reach line rate; local, latency-sensitive links want
+/// `TCP_NODELAY` and `TCP_QUICKACK`.
+///
+/// Options the platform does not support are logged and skipped. Failing
+/// to set an option never fails the connection, except `TCP_NODELAY` and
+/// `SO_KEEPALIVE`, which connections have always required.
+
+class SocketOptions {
+  public:
+    SocketOptions();
+
+    /// \param noDelay Disable Nagle's algorithm (`TCP_NODELAY`), so small
+    ///        writes are sent immediately. Defaults to true.
+    SocketOptions& setNoDelay(bool noDelay)
+    {
+        d_noDelay = noDelay;
+        return *this;
+    }
+
+    /// \param bytes Socket send buffer size (`SO_SNDBUF`). The kernel may
+    ///        round or cap it (see `net.core.wmem_max`). 0 (the default)
+    ///        keeps the system default, which on Linux auto-tunes.
+    SocketOptions& setSendBufferSize(int bytes)
+    {
+        d_sendBufferSize = bytes;
+        return *this;
+    }
+
+    /// \param bytes Socket receive buffer size (`SO_RCVBUF`). The kernel may
+    ///        round or cap it (see `net.core.rmem_max`). 0 (the default)
+    ///        keeps the system default, which on Linux auto-tunes.
+    SocketOptions& setReceiveBufferSize(int bytes)
+    {
+        d_receiveBufferSize = bytes;
+        return *this;
+    }
+
+    /// \param quickAck Acknowledge received segments immediately
+    ///        (`TCP_QUICKACK`, Linux only) rather than delaying acks. The
+    ///        kernel drops back to delayed acks on its own, so this is
+    ///        re-armed after every read. Defaults to false.
+    SocketOptions& setQuickAck(bool quickAck)
+    {
+        d_quickAck = quickAck;
+        return *this;
+    }
+
+    /// \param microseconds Busy poll the device queue for up to this long
+    ///        on blocking reads (`SO_BUSY_POLL`, Linux only; raising it may
+    ///        need CAP_NET_ADMIN). 0 (the default) does not busy poll.
+    SocketOptions& setBusyPoll(int microseconds)
+    {
+        d_busyPollMicroseconds = microseconds;
+        return *this;
+    }
+
+    /// \param timeout How long written data may remain unacknowledged before
+    ///        the kernel drops the connection (`TCP_USER_TIMEOUT`, Linux
+    ///        only). Detects dead peers faster than heartbeats while
+    ///        writing. Zero (the default) keeps the system default.
+    SocketOptions& setUserTimeout(const bsls::TimeInterval& timeout)
+    {
+        d_userTimeout = timeout;
+        return *this;
+    }
+
+    /// \param keepAlive Send TCP keepalive probes on idle connections
+    ///        (`SO_KEEPALIVE`). Defaults to true.
+    SocketOptions& setKeepAlive(bool keepAlive)
+    {
+        d_keepAlive = keepAlive;
+        return *this;
+    }
+
+    /// \param idle     Idle time before the first probe (`TCP_KEEPIDLE`)
+    /// \param interval Time between probes (`TCP_KEEPINTVL`)
+    /// \param count    Unanswered probes before the connection is dropped
+    ///                 (`TCP_KEEPCNT`)
+    /// Zero values keep the system defaults. Only used with `keepAlive`.
+    SocketOptions& setKeepAliveProbes(const bsls::TimeInterval& idle,
+                                      const bsls::TimeInterval& interval,
+                                      int count)
+    {
+        d_keepAliveIdle     = idle;
+        d_keepAliveInterval = interval;
+        d_keepAliveCount    = count;
+        return *this;
+    }
+
+    bool noDelay() const { return d_noDelay; }
+    int sendBufferSize() const { return d_sendBufferSize; }
+    int receiveBufferSize() const { return d_receiveBufferSize; }
+    bool quickAck() const { return d_quickAck; }
+    int busyPollMicroseconds() const { return d_busyPollMicroseconds; }
+    const bsls::TimeInterval& userTimeout() const { return d_userTimeout; }
+    bool keepAlive() const { return d_keepAlive; }
+    const bsls::TimeInterval& keepAliveIdle() const { return d_keepAliveIdle; }
+    const bsls::TimeInterval& keepAliveInterval() const
+    {
+        return d_keepAliveInterval;
+    }
+    int keepAliveCount() const { return d_keepAliveCount; }
+
+  private:
+    bool d_noDelay;
+    int d_sendBufferSize;
+    int d_receiveBufferSize;
+    bool d_quickAck;
+    int d_busyPollMicroseconds;
+    bsls::TimeInterval d_userTimeout;
+    bool d_keepAlive;
+    bsls::TimeInterval d_keepAliveIdle;
+    bsls::TimeInterval d_keepAliveInterval;
+    int d_keepAliveCount;
+};
+
+bsl::ostream& operator<<(bsl::ostream& os, const SocketOptions& options);
+
+} // namespace rmqt
+} // namespace BloombergLP
+
+#endif
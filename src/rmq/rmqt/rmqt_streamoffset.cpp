@@ -0,0 +1,112 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqt_streamoffset.h>
+
+#include <bsl_string.h>
+
+namespace BloombergLP {
+namespace rmqt {
+
+StreamOffset StreamOffset::first()
+{
+    return StreamOffset(FIRST, 0, bdlt::Datetime());
+}
+
+StreamOffset StreamOffset::last()
+{
+    return StreamOffset(LAST, 0, bdlt::Datetime());
+}
+
+StreamOffset StreamOffset::next()
+{
+    return StreamOffset(NEXT, 0, bdlt::Datetime());
+}
+
+StreamOffset StreamOffset::offset(uint64_t offset)
+{
+    return StreamOffset(OFFSET, offset, bdlt::Datetime());
+}
+
+StreamOffset StreamOffset::timestamp(const bdlt::Datetime& timestamp)
+{
+    return StreamOffset(TIMESTAMP, 0, timestamp);
+}
+
+StreamOffset::StreamOffset()
+: d_type(NEXT)
+, d_offset(0)
+, d_timestamp()
+{
+}
+
+StreamOffset::StreamOffset(Type type,
+                           uint64_t offset,
+                           const bdlt::Datetime& timestamp)
+: d_type(type)
+, d_offset(offset)
+, d_timestamp(timestamp)
+{
+}
+
+rmqt::FieldValue StreamOffset::toFieldValue() const
+{
+    switch (d_type) {
+        case FIRST:
+            return rmqt::FieldValue(bsl::string("first"));
+        case LAST:
+            return rmqt::FieldValue(bsl::string("last"));
+        case OFFSET:
+            // The broker expects a signed long
+            return rmqt::FieldValue(static_cast<int64_t>(d_offset));
+        case TIMESTAMP:
+            return rmqt::FieldValue(d_timestamp);
+        case NEXT:
+        default:
+            return rmqt::FieldValue(bsl::string("next"));
+    }
+}
+
+bool operator==(const StreamOffset& lhs, const StreamOffset& rhs)
+{
+    return lhs.type() == rhs.type() &&
+           lhs.offsetValue() == rhs.offsetValue() &&
+           lhs.timestampValue() == rhs.timestampValue();
+}
+
+bool operator!=(const StreamOffset& lhs, const StreamOffset& rhs)
+{
+    return !(lhs == rhs);
+}
+
+bsl::ostream& operator<<(bsl::ostream& os, const StreamOffset& offset)
+{
+    switch (offset.type()) {
+        case StreamOffset::FIRST:
+            return os << "first";
+        case StreamOffset::LAST:
+            return os << "last";
+        case StreamOffset::OFFSET:
+            return os << "offset " << offset.offsetValue();
+        case StreamOffset::TIMESTAMP:
+            return os << "timestamp " << offset.timestampValue();
+        case StreamOffset::NEXT:
+        default:
+            return os << "next";
+    }
+}
+
+} // namespace rmqt
+} // namespace BloombergLP
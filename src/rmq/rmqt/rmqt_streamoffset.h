@@ -0,0 +1,91 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQT_STREAMOFFSET
+#define INCLUDED_RMQT_STREAMOFFSET
+
+#include <rmqt_fieldvalue.h>
+
+#include <bdlt_datetime.h>
+
+#include <bsl_cstdint.h>
+#include <bsl_ostream.h>
+
+//@PURPOSE: Where a consumer of a RabbitMQ stream starts reading
+//
+//@CLASSES:
+//  rmqt::StreamOffset: the `x-stream-offset` consumer argument
+
+namespace BloombergLP {
+namespace rmqt {
+
+/// \brief The point in a stream queue a consumer starts from
+///
+/// Passed to the broker as the `x-stream-offset` argument of basic.consume,
+/// see https://www.rabbitmq.com/streams.html#consuming. Set it with
+/// `ConsumerConfig::setStreamOffset`.
+
+class StreamOffset {
+  public:
+    enum Type { FIRST, LAST, NEXT, OFFSET, TIMESTAMP };
+
+    /// Start from the first message still in the stream
+    static StreamOffset first();
+
+    /// Start from the last chunk written to the stream
+    static StreamOffset last();
+
+    /// Start with the messages published after the consumer starts
+    static StreamOffset next();
+
+    /// Start from the message at `offset`, e.g. one past the offset of the
+    /// last message processed, see `Envelope::streamOffset`
+    static StreamOffset offset(uint64_t offset);
+
+    /// Start from the chunk written at or just before `timestamp` (UTC).
+    /// The broker works in whole seconds.
+    static StreamOffset timestamp(const bdlt::Datetime& timestamp);
+
+    /// Starts from `next()`, the broker's default
+    StreamOffset();
+
+    Type type() const { return d_type; }
+
+    /// The offset of an `OFFSET` stream offset
+    uint64_t offsetValue() const { return d_offset; }
+
+    /// The time of a `TIMESTAMP` stream offset
+    const bdlt::Datetime& timestampValue() const { return d_timestamp; }
+
+    /// The value of the `x-stream-offset` consumer argument
+    rmqt::FieldValue toFieldValue() const;
+
+  private:
+    StreamOffset(Type type, uint64_t offset, const bdlt::Datetime& timestamp);
+
+    Type d_type;
+    uint64_t d_offset;
+    bdlt::Datetime d_timestamp;
+};
+
+bool operator==(const StreamOffset& lhs, const StreamOffset& rhs);
+bool operator!=(const StreamOffset& lhs, const StreamOffset& rhs);
+
+bsl::ostream& operator<<(bsl::ostream& os, const StreamOffset& offset);
+
+} // namespace rmqt
+} // namespace BloombergLP
+
+#endif
@@ -23,6 +23,7 @@ Topology::Topology()
 , exchanges()
 , queueBindings()
 , exchangeBindings()
+, declareMode(DECLARE_ALL)
 {
 }
 
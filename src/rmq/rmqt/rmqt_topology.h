@@ -31,6 +31,13 @@ namespace rmqt {
 
 class Topology {
   public:
+    /// How producers and consumers make sure this topology exists
+    enum DeclareMode {
+        DECLARE_ALL, ///< Declare every queue, exchange and binding
+        VERIFY_USED, ///< Passively declare only the queue/exchange in use
+        SKIP_DECLARE ///< Declare nothing: the topology is pre-provisioned
+    };
+
     Topology();
 
     typedef bsl::vector<bsl::shared_ptr<Queue> > QueueVec;
@@ -42,6 +49,7 @@ class Topology {
     ExchangeVec exchanges;
     QueueBindingVec queueBindings;
     ExchangeBindingVec exchangeBindings;
+    DeclareMode declareMode;
 
     friend bsl::ostream& operator<<(bsl::ostream& os, const Topology& topology);
 }; // class Topology
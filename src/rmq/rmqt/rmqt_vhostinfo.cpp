@@ -25,6 +25,7 @@ VHostInfo::VHostInfo(const bsl::shared_ptr<rmqt::Endpoint> endpoint,
                      const bsl::shared_ptr<rmqt::Credentials> credentials)
 : d_endpoint(endpoint)
 , d_credentials(credentials)
+, d_standbyEndpoint()
 {
 }
 
@@ -38,5 +39,17 @@ bsl::shared_ptr<rmqt::Credentials> VHostInfo::credentials() const
     return d_credentials;
 }
 
+VHostInfo& VHostInfo::setStandbyEndpoint(
+    const bsl::shared_ptr<rmqt::Endpoint>& standbyEndpoint)
+{
+    d_standbyEndpoint = standbyEndpoint;
+    return *this;
+}
+
+bsl::shared_ptr<rmqt::Endpoint> VHostInfo::standbyEndpoint() const
+{
+    return d_standbyEndpoint;
+}
+
 } // namespace rmqt
 } // namespace BloombergLP
\ No newline at end of file
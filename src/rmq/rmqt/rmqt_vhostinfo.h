@@ -39,9 +39,20 @@ class VHostInfo {
     virtual bsl::shared_ptr<rmqt::Endpoint> endpoint() const;
     virtual bsl::shared_ptr<rmqt::Credentials> credentials() const;
 
+    /// \brief Keep a warm standby connection to `standbyEndpoint`, another
+    /// node of the same cluster, alongside each connection of the VHost.
+    /// When a connection loses its broker, its producers and consumers
+    /// carry on over the standby's already open connection straight away,
+    /// instead of waiting to reconnect.
+    VHostInfo&
+    setStandbyEndpoint(const bsl::shared_ptr<rmqt::Endpoint>& standbyEndpoint);
+
+    virtual bsl::shared_ptr<rmqt::Endpoint> standbyEndpoint() const;
+
   private:
     bsl::shared_ptr<rmqt::Endpoint> d_endpoint;
     bsl::shared_ptr<rmqt::Credentials> d_credentials;
+    bsl::shared_ptr<rmqt::Endpoint> d_standbyEndpoint;
 }; // class VHostInfo
 
 } // namespace rmqt
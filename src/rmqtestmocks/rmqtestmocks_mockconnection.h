@@ -69,6 +69,20 @@ class MockConnection : public rmqp::Connection {
                      const rmqp::Consumer::ConsumerFunc& messageConsumer,
                      const rmqt::ConsumerConfig& config));
 
+    MOCK_METHOD4(createBatchConsumer,
+                 rmqt::Result<rmqp::Consumer>(
+                     const rmqt::Topology& topology,
+                     rmqt::QueueHandle queue,
+                     const rmqp::Consumer::BatchConsumerFunc& onBatch,
+                     const rmqt::ConsumerConfig& config));
+
+    MOCK_METHOD4(createBatchConsumerAsync,
+                 rmqt::Future<rmqp::Consumer>(
+                     const rmqt::Topology& topology,
+                     rmqt::QueueHandle queue,
+                     const rmqp::Consumer::BatchConsumerFunc& onBatch,
+                     const rmqt::ConsumerConfig& config));
+
     // DEPRECATED
 
     MOCK_METHOD5(createConsumer,
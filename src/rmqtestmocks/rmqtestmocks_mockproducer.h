@@ -25,6 +25,7 @@
 
 #include <bsl_memory.h>
 #include <bsl_string.h>
+#include <bsl_vector.h>
 
 namespace BloombergLP {
 namespace rmqtestmocks {
@@ -72,6 +73,32 @@ class MockProducer : public rmqp::Producer {
             const bsl::string& routingKey,
             const rmqp::Producer::ConfirmationCallback& confirmCallback));
 
+    MOCK_METHOD2(
+        setWritableCallback,
+        void(const rmqp::Producer::WritableCallback& callback,
+             bsl::size_t minimumCredits));
+
+    MOCK_CONST_METHOD0(availableCredits, bsl::size_t());
+
+    MOCK_METHOD1(setWriteWeight, void(unsigned weight));
+
+    MOCK_METHOD4(
+        sendBatch,
+        rmqp::Producer::SendStatus(
+            const bsl::vector<rmqt::Message>& messages,
+            const bsl::string& routingKey,
+            const rmqp::Producer::ConfirmationCallback& confirmCallback,
+            const bsls::TimeInterval& timeout));
+
+    MOCK_METHOD5(
+        openStream,
+        rmqt::Result<rmqp::MessageSink>(
+            const rmqt::Message& message,
+            bsl::size_t bodySize,
+            const bsl::string& routingKey,
+            const rmqp::Producer::ConfirmationCallback& confirmCallback,
+            const bsls::TimeInterval& timeout));
+
     MOCK_METHOD1(waitForConfirms, rmqt::Result<>(const bsls::TimeInterval&));
 
     MOCK_METHOD2(updateTopology,
@@ -25,11 +25,13 @@
 #include <rmqt_credentials.h>
 #include <rmqt_endpoint.h>
 #include <rmqt_future.h>
+#include <rmqt_result.h>
 #include <rmqt_vhostinfo.h>
 
 #include <gmock/gmock.h>
 
 #include <bslma_managedptr.h>
+#include <bsls_timeinterval.h>
 
 #include <bsl_memory.h>
 #include <bsl_string.h>
@@ -59,6 +61,8 @@ class MockRabbitContext : public rmqp::RabbitContext {
         bsl::shared_ptr<rmqp::Connection>(const bsl::string& userDefinedName,
                                           const rmqt::VHostInfo& vhostInfo));
 
+    MOCK_METHOD1(shutdown, rmqt::Result<>(const bsls::TimeInterval& timeout));
+
   private:
     MockRabbitContext(const MockRabbitContext&) BSLS_KEYWORD_DELETED;
     MockRabbitContext& operator=(const MockRabbitContext&) BSLS_KEYWORD_DELETED;
@@ -57,6 +57,20 @@ class MockVHost : public rmqp::Connection {
                      const rmqp::Consumer::ConsumerFunc& messageConsumer,
                      const rmqt::ConsumerConfig& config));
 
+    MOCK_METHOD4(createBatchConsumer,
+                 rmqt::Result<rmqp::Consumer>(
+                     const rmqt::Topology& topology,
+                     rmqt::QueueHandle queue,
+                     const rmqp::Consumer::BatchConsumerFunc& onBatch,
+                     const rmqt::ConsumerConfig& config));
+
+    MOCK_METHOD4(createBatchConsumerAsync,
+                 rmqt::Future<rmqp::Consumer>(
+                     const rmqt::Topology& topology,
+                     rmqt::QueueHandle queue,
+                     const rmqp::Consumer::BatchConsumerFunc& onBatch,
+                     const rmqt::ConsumerConfig& config));
+
     MOCK_METHOD3(createProducer,
                  rmqt::Result<rmqp::Producer>(const rmqt::Topology& topology,
                                               rmqt::ExchangeHandle exchange,
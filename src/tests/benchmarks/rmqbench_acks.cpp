@@ -0,0 +1,133 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Tracking outstanding deliveries and publishes, and acknowledging them
+
+#include <rmqamqp_messagestore.h>
+#include <rmqamqp_multipleackhandler.h>
+#include <rmqt_consumerack.h>
+#include <rmqt_envelope.h>
+#include <rmqt_message.h>
+
+#include <bdlf_bind.h>
+#include <bdlf_placeholder.h>
+
+#include <benchmark/benchmark.h>
+
+#include <bsl_cstdint.h>
+#include <bsl_memory.h>
+#include <bsl_vector.h>
+
+using namespace BloombergLP;
+
+namespace {
+
+rmqt::Message makeMessage()
+{
+    return rmqt::Message(bsl::make_shared<bsl::vector<uint8_t> >(16, 'p'));
+}
+
+/// Insert and then remove `range(0)` messages one at a time, as confirms
+/// and single acks do
+void messageStoreInsertRemove(benchmark::State& state)
+{
+    const uint64_t count = static_cast<uint64_t>(state.range(0));
+    const rmqt::Message message = makeMessage();
+
+    rmqamqp::MessageStore<rmqt::Message> store;
+    rmqt::Message removed;
+    bdlt::Datetime insertTime;
+    while (state.KeepRunning()) {
+        for (uint64_t tag = 1; tag <= count; ++tag) {
+            store.insert(tag, message);
+        }
+        for (uint64_t tag = 1; tag <= count; ++tag) {
+            benchmark::DoNotOptimize(store.remove(tag, &removed, &insertTime));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+/// Insert `range(0)` messages and remove them in batches of `range(1)`, as
+/// multiple confirms and acks do
+void messageStoreRemoveUntil(benchmark::State& state)
+{
+    const uint64_t count = static_cast<uint64_t>(state.range(0));
+    const uint64_t batch = static_cast<uint64_t>(state.range(1));
+    const rmqt::Message message = makeMessage();
+
+    rmqamqp::MessageStore<rmqt::Message> store;
+    while (state.KeepRunning()) {
+        for (uint64_t tag = 1; tag <= count; ++tag) {
+            store.insert(tag, message);
+        }
+        for (uint64_t tag = batch; tag < count + batch; tag += batch) {
+            benchmark::DoNotOptimize(store.removeUntil(tag));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+void countAck(bsl::size_t* count, uint64_t, bool) { ++*count; }
+
+void countNack(bsl::size_t* count, uint64_t, bool, bool) { ++*count; }
+
+/// Process `range(0)` consecutive acks, with every `range(1)`th one a nack
+/// (never if 0), which splits the multiple acks sent
+void multipleAckHandlerProcess(benchmark::State& state)
+{
+    const uint64_t count     = static_cast<uint64_t>(state.range(0));
+    const uint64_t nackEvery = static_cast<uint64_t>(state.range(1));
+
+    bsl::vector<rmqt::ConsumerAck> acks;
+    for (uint64_t tag = 1; tag <= count; ++tag) {
+        const bool nack = nackEvery && tag % nackEvery == 0;
+        acks.push_back(rmqt::ConsumerAck(
+            rmqt::Envelope(
+                tag, 0, "consumerTag", "exchange", "routing-key", false),
+            nack ? rmqt::ConsumerAck::REJECT : rmqt::ConsumerAck::ACK));
+    }
+
+    bsl::size_t sent = 0;
+    rmqamqp::MultipleAckHandler handler(
+        bdlf::BindUtil::bind(&countAck,
+                             &sent,
+                             bdlf::PlaceHolders::_1,
+                             bdlf::PlaceHolders::_2),
+        bdlf::BindUtil::bind(&countNack,
+                             &sent,
+                             bdlf::PlaceHolders::_1,
+                             bdlf::PlaceHolders::_2,
+                             bdlf::PlaceHolders::_3));
+
+    bsl::vector<rmqt::ConsumerAck> batch;
+    while (state.KeepRunning()) {
+        batch = acks;
+        handler.process(batch);
+    }
+    benchmark::DoNotOptimize(sent);
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+} // namespace
+
+// Argument: messages outstanding
+BENCHMARK(messageStoreInsertRemove)->RangeMultiplier(8)->Range(8, 4096);
+// Arguments: messages outstanding, messages per removeUntil
+BENCHMARK(messageStoreRemoveUntil)
+    ->ArgsProduct({{64, 4096}, {1, 16, 64}});
+// Arguments: acks per batch, nack frequency
+BENCHMARK(multipleAckHandlerProcess)
+    ->ArgsProduct({{1, 64, 1024}, {0, 16}});
@@ -0,0 +1,143 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Encoding and decoding of message properties and field tables
+
+#include <rmqamqpt_basicproperties.h>
+#include <rmqamqpt_buffer.h>
+#include <rmqamqpt_types.h>
+#include <rmqamqpt_writer.h>
+#include <rmqt_fieldvalue.h>
+#include <rmqt_properties.h>
+
+#include <bdlt_currenttime.h>
+
+#include <benchmark/benchmark.h>
+
+#include <bsl_memory.h>
+#include <bsl_string.h>
+#include <bsl_vector.h>
+
+using namespace BloombergLP;
+
+namespace {
+
+/// Return a table of `count` string, integer and boolean headers
+bsl::shared_ptr<rmqt::FieldTable> makeHeaders(int count)
+{
+    bsl::shared_ptr<rmqt::FieldTable> headers =
+        bsl::make_shared<rmqt::FieldTable>();
+    for (int i = 0; i < count; ++i) {
+        const bsl::string key = "header-" + bsl::to_string(i);
+        switch (i % 3) {
+            case 0:
+                (*headers)[key] = rmqt::FieldValue(bsl::string(32, 'h'));
+                break;
+            case 1:
+                (*headers)[key] = rmqt::FieldValue(bsl::int64_t(i));
+                break;
+            default:
+                (*headers)[key] = rmqt::FieldValue(true);
+        }
+    }
+    return headers;
+}
+
+rmqt::Properties makeProperties(int headerCount)
+{
+    rmqt::Properties properties;
+    properties.contentType   = "application/json";
+    properties.deliveryMode  = 2;
+    properties.correlationId = "correlation-id";
+    properties.messageId     = "message-id";
+    properties.timestamp     = bdlt::CurrentTime::utc();
+    properties.headers       = makeHeaders(headerCount);
+    return properties;
+}
+
+void encodeProperties(benchmark::State& state)
+{
+    const rmqamqpt::BasicProperties properties(
+        makeProperties(static_cast<int>(state.range(0))));
+
+    bsl::vector<uint8_t> buffer;
+    while (state.KeepRunning()) {
+        buffer.clear();
+        rmqamqpt::Writer writer(&buffer);
+        rmqamqpt::BasicProperties::encode(writer, properties);
+        benchmark::DoNotOptimize(buffer.data());
+    }
+    state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+
+void decodeProperties(benchmark::State& state)
+{
+    const rmqamqpt::BasicProperties properties(
+        makeProperties(static_cast<int>(state.range(0))));
+    const bool lazyHeaders = state.range(1) != 0;
+
+    bsl::vector<uint8_t> buffer;
+    rmqamqpt::Writer writer(&buffer);
+    rmqamqpt::BasicProperties::encode(writer, properties);
+
+    while (state.KeepRunning()) {
+        rmqamqpt::BasicProperties decoded;
+        benchmark::DoNotOptimize(rmqamqpt::BasicProperties::decode(
+            &decoded, buffer.data(), buffer.size(), lazyHeaders));
+    }
+    state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+
+void encodeFieldTable(benchmark::State& state)
+{
+    const bsl::shared_ptr<rmqt::FieldTable> table =
+        makeHeaders(static_cast<int>(state.range(0)));
+
+    bsl::vector<uint8_t> buffer;
+    while (state.KeepRunning()) {
+        buffer.clear();
+        rmqamqpt::Writer writer(&buffer);
+        rmqamqpt::Types::encodeFieldTable(writer, *table);
+        benchmark::DoNotOptimize(buffer.data());
+    }
+    state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+
+void decodeFieldTable(benchmark::State& state)
+{
+    const bsl::shared_ptr<rmqt::FieldTable> table =
+        makeHeaders(static_cast<int>(state.range(0)));
+
+    bsl::vector<uint8_t> buffer;
+    rmqamqpt::Writer writer(&buffer);
+    rmqamqpt::Types::encodeFieldTable(writer, *table);
+
+    while (state.KeepRunning()) {
+        rmqt::FieldTable decoded;
+        rmqamqpt::Buffer input(buffer.data(), buffer.size());
+        benchmark::DoNotOptimize(
+            rmqamqpt::Types::decodeFieldTable(&decoded, &input));
+    }
+    state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+
+} // namespace
+
+// Argument: number of headers
+BENCHMARK(encodeProperties)->Arg(0)->Arg(4)->Arg(32);
+// Arguments: number of headers, lazy headers
+BENCHMARK(decodeProperties)->ArgsProduct({{0, 4, 32}, {0, 1}});
+BENCHMARK(encodeFieldTable)->Arg(4)->Arg(32)->Arg(256);
+BENCHMARK(decodeFieldTable)->Arg(4)->Arg(32)->Arg(256);
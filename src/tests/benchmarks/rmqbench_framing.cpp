@@ -0,0 +1,160 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Decoding bytes into frames, and frames into messages, and framing
+// messages for sending
+
+#include <rmqamqp_framer.h>
+#include <rmqamqp_message.h>
+#include <rmqamqpt_frame.h>
+#include <rmqio_decoder.h>
+#include <rmqio_serializedframe.h>
+#include <rmqt_message.h>
+
+#include <bslma_managedptr.h>
+
+#include <benchmark/benchmark.h>
+
+#include <bsl_algorithm.h>
+#include <bsl_memory.h>
+#include <bsl_vector.h>
+
+using namespace BloombergLP;
+
+namespace {
+
+const bsl::uint16_t k_CHANNEL = 1;
+
+rmqt::Message makeMessage(bsl::size_t payloadSize)
+{
+    return rmqt::Message(
+        bsl::make_shared<bsl::vector<uint8_t> >(payloadSize, 'p'));
+}
+
+/// Return the content frames of a message of `payloadSize` bytes
+bsl::vector<rmqamqpt::Frame> contentFrames(bsl::size_t payloadSize)
+{
+    rmqamqp::Framer framer;
+    bsl::vector<rmqamqpt::Frame> frames;
+    framer.makeFrames(
+        &frames, k_CHANNEL, rmqamqp::Message(makeMessage(payloadSize)));
+    return frames;
+}
+
+/// Return the wire bytes of the content frames of a message of
+/// `payloadSize` bytes
+bsl::vector<uint8_t> contentBytes(bsl::size_t payloadSize)
+{
+    const bsl::vector<rmqamqpt::Frame> frames = contentFrames(payloadSize);
+
+    bsl::vector<uint8_t> bytes;
+    for (bsl::vector<rmqamqpt::Frame>::const_iterator it = frames.begin();
+         it != frames.end();
+         ++it) {
+        bytes.insert(
+            bytes.end(), it->rawData(), it->rawData() + it->totalFrameSize());
+    }
+    return bytes;
+}
+
+/// Feed the frames of a message of `range(0)` bytes to a Decoder, in socket
+/// reads of `range(1)` bytes
+void decoderAppendBytes(benchmark::State& state)
+{
+    const bsl::vector<uint8_t> bytes =
+        contentBytes(static_cast<bsl::size_t>(state.range(0)));
+    const bsl::size_t readSize = static_cast<bsl::size_t>(state.range(1));
+
+    bslma::ManagedPtr<rmqio::Decoder> decoder =
+        rmqio::Decoder::create(rmqamqpt::Frame::getMaxFrameSize());
+
+    bsl::vector<rmqamqpt::Frame> frames;
+    while (state.KeepRunning()) {
+        for (bsl::size_t offset = 0; offset < bytes.size();
+             offset += readSize) {
+            frames.clear();
+            decoder->appendBytes(&frames,
+                                 bytes.data() + offset,
+                                 bsl::min(readSize, bytes.size() - offset));
+            benchmark::DoNotOptimize(frames.data());
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * bytes.size());
+}
+
+/// Assemble a message of `range(0)` bytes from its content frames
+void framerAppendFrame(benchmark::State& state)
+{
+    const bsl::vector<rmqamqpt::Frame> frames =
+        contentFrames(static_cast<bsl::size_t>(state.range(0)));
+
+    rmqamqp::Framer framer;
+    bsl::uint16_t channel;
+    rmqamqp::Message message;
+    while (state.KeepRunning()) {
+        for (bsl::vector<rmqamqpt::Frame>::const_iterator it = frames.begin();
+             it != frames.end();
+             ++it) {
+            benchmark::DoNotOptimize(
+                framer.appendFrame(&channel, &message, *it));
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+/// Frame a message of `range(0)` bytes, copying its payload into the frames
+void framerMakeFrames(benchmark::State& state)
+{
+    const rmqamqp::Message message(
+        makeMessage(static_cast<bsl::size_t>(state.range(0))));
+
+    rmqamqp::Framer framer;
+    bsl::vector<rmqamqpt::Frame> frames;
+    while (state.KeepRunning()) {
+        frames.clear();
+        framer.makeFrames(&frames, k_CHANNEL, message);
+        benchmark::DoNotOptimize(frames.data());
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+/// Frame a message of `range(0)` bytes as written to the socket, with body
+/// frames viewing its payload
+void framerMakeSerializedFrames(benchmark::State& state)
+{
+    const rmqamqp::Message message(
+        makeMessage(static_cast<bsl::size_t>(state.range(0))));
+
+    rmqamqp::Framer framer;
+    bsl::vector<bsl::shared_ptr<rmqio::SerializedFrame> > frames;
+    while (state.KeepRunning()) {
+        frames.clear();
+        framer.makeSerializedFrames(&frames, k_CHANNEL, message);
+        benchmark::DoNotOptimize(frames.data());
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+} // namespace
+
+// Arguments: payload size, socket read size
+BENCHMARK(decoderAppendBytes)
+    ->ArgsProduct({{16, 1024, 64 * 1024, 1024 * 1024}, {4096, 65536}});
+// Argument: payload size
+BENCHMARK(framerAppendFrame)->RangeMultiplier(64)->Range(16, 1024 * 1024);
+BENCHMARK(framerMakeFrames)->RangeMultiplier(64)->Range(16, 1024 * 1024);
+BENCHMARK(framerMakeSerializedFrames)
+    ->RangeMultiplier(64)
+    ->Range(16, 1024 * 1024);
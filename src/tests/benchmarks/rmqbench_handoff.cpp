@@ -0,0 +1,276 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Handing work from one thread to another: posting to the event loop,
+// completing futures, queueing consumer acks, dispatching to the callback
+// thread pool and handing a send to the event loop. Run with
+// `--benchmark_perf_counters=CYCLES,CACHE-MISSES` (Google Benchmark built
+// with libpfm) to see the cache misses per operation as well.
+
+#include <rmqtestutil_loopbackbroker.h>
+
+#include <rmqa_producer.h>
+#include <rmqa_rabbitcontext.h>
+#include <rmqa_topology.h>
+#include <rmqa_vhost.h>
+#include <rmqio_asioeventloop.h>
+#include <rmqt_confirmresponse.h>
+#include <rmqt_consumerack.h>
+#include <rmqt_consumerackqueue.h>
+#include <rmqt_envelope.h>
+#include <rmqt_future.h>
+#include <rmqt_message.h>
+#include <rmqt_result.h>
+
+#include <bdlf_bind.h>
+#include <bdlf_placeholder.h>
+#include <bdlmt_threadpool.h>
+#include <bslmt_semaphore.h>
+#include <bslmt_threadattributes.h>
+#include <bsls_atomic.h>
+
+#include <benchmark/benchmark.h>
+
+#include <bsl_cstdint.h>
+#include <bsl_functional.h>
+#include <bsl_memory.h>
+#include <bsl_vector.h>
+
+using namespace BloombergLP;
+
+namespace {
+
+/// An event loop shared by every benchmark, started once so that starting
+/// its thread is not measured
+rmqio::EventLoop& sharedLoop()
+{
+    static rmqio::AsioEventLoop loop;
+    static bool started = (loop.start(), true);
+    (void)started;
+    return loop;
+}
+
+void noop() {}
+
+void increment(bsls::AtomicInt64* counter) { ++*counter; }
+
+rmqt::Result<> identity(const rmqt::Result<>& result) { return result; }
+
+/// Post batches of `range(0)` jobs from each benchmark thread, waiting for
+/// the loop to run every batch, as producers and consumers' acks do
+void eventLoopPostThroughput(benchmark::State& state)
+{
+    static bsls::AtomicInt64 s_executed;
+    rmqio::EventLoop& loop = sharedLoop();
+    const int64_t batch    = state.range(0);
+    const rmqio::EventLoop::Item job =
+        bdlf::BindUtil::bind(&increment, &s_executed);
+
+    while (state.KeepRunning()) {
+        for (int64_t i = 0; i < batch; ++i) {
+            loop.post(job);
+        }
+        // Posts run in order, so this thread's batch has run once this has
+        loop.postF<void>(&noop).blockResult();
+    }
+    state.SetItemsProcessed(state.iterations() * batch);
+}
+
+/// Post a job and wait for the loop to complete its future, the round trip
+/// of a synchronous call onto the event loop
+void eventLoopPostRoundTrip(benchmark::State& state)
+{
+    rmqio::EventLoop& loop = sharedLoop();
+
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(loop.postF<void>(&noop).blockResult());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/// Make a future, complete it and take its result, on one thread
+void futureMakeSetBlock(benchmark::State& state)
+{
+    while (state.KeepRunning()) {
+        rmqt::Future<>::Pair pair = rmqt::Future<>::make();
+        pair.first(rmqt::Result<>());
+        benchmark::DoNotOptimize(pair.second.blockResult());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/// As futureMakeSetBlock, through a continuation added with `then`
+void futureThen(benchmark::State& state)
+{
+    const bsl::function<rmqt::Result<>(const rmqt::Result<>&)> converter =
+        &identity;
+
+    while (state.KeepRunning()) {
+        rmqt::Future<>::Pair pair = rmqt::Future<>::make();
+        rmqt::Future<> next       = pair.second.then<void>(converter);
+        pair.first(rmqt::Result<>());
+        benchmark::DoNotOptimize(next.blockResult());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/// Each benchmark thread pushes `range(0)` acks per iteration, as consumer
+/// callbacks do, and the first thread drains them, as the event loop does
+void consumerAckQueuePushDrain(benchmark::State& state)
+{
+    static rmqt::ConsumerAckQueue* s_queue;
+    if (state.thread_index() == 0) {
+        s_queue = new rmqt::ConsumerAckQueue();
+    }
+
+    const int64_t batch = state.range(0);
+    const rmqt::ConsumerAck ack(
+        rmqt::Envelope(1, 0, "consumerTag", "exchange", "routing-key", false),
+        rmqt::ConsumerAck::ACK);
+    bsl::vector<rmqt::ConsumerAck> drained;
+
+    while (state.KeepRunning()) {
+        for (int64_t i = 0; i < batch; ++i) {
+            s_queue->push(ack);
+        }
+        if (state.thread_index() == 0) {
+            drained.clear();
+            s_queue->drain(&drained);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * batch);
+
+    if (state.thread_index() == 0) {
+        delete s_queue;
+    }
+}
+
+void countDown(bsls::AtomicInt64* remaining, bslmt::Semaphore* done)
+{
+    if (--*remaining == 0) {
+        done->post();
+    }
+}
+
+/// Dispatch batches of `range(0)` jobs to a thread pool of `range(1)`
+/// threads, as consumers hand messages to the application's callbacks
+void threadPoolDispatch(benchmark::State& state)
+{
+    const int64_t batch = state.range(0);
+    const int threads   = static_cast<int>(state.range(1));
+
+    bdlmt::ThreadPool pool(bslmt::ThreadAttributes(), threads, threads, 60);
+    pool.start();
+
+    bsls::AtomicInt64 remaining;
+    bslmt::Semaphore done;
+    const bsl::function<void()> job =
+        bdlf::BindUtil::bind(&countDown, &remaining, &done);
+
+    while (state.KeepRunning()) {
+        remaining = batch;
+        for (int64_t i = 0; i < batch; ++i) {
+            pool.enqueueJob(job);
+        }
+        done.wait();
+    }
+    state.SetItemsProcessed(state.iterations() * batch);
+
+    pool.stop();
+}
+
+void ignoreConfirm(const rmqt::Message&,
+                   const bsl::string&,
+                   const rmqt::ConfirmResponse&)
+{
+}
+
+/// A producer connected to a loopback broker, shared by every run
+struct LoopbackProducer {
+    rmqtestutil::LoopbackBroker broker;
+    bsl::shared_ptr<rmqa::RabbitContext> rabbit;
+    bsl::shared_ptr<rmqa::VHost> vhost;
+    bsl::shared_ptr<rmqa::Producer> producer;
+
+    LoopbackProducer()
+    {
+        broker.start();
+        rabbit = bsl::make_shared<rmqa::RabbitContext>();
+        vhost  = rabbit->createVHostConnection(
+            "rmqbench", broker.endpoint(), broker.credentials());
+
+        rmqa::Topology topology;
+        topology.addQueue("rmqbench");
+        producer = vhost
+                       ->createProducer(topology,
+                                        topology.defaultExchange(),
+                                        k_MAX_OUTSTANDING)
+                       .value();
+    }
+
+    // The most a producer allows
+    static const uint16_t k_MAX_OUTSTANDING = 60000;
+};
+
+/// `Producer::send` on the application's thread: reserving a confirm slot,
+/// registering the callback and posting the message to the event loop.
+/// Waiting for the confirms, every so often, is not timed.
+void producerSendHandoff(benchmark::State& state)
+{
+    static LoopbackProducer s_loopback;
+
+    const rmqp::Producer::ConfirmationCallback onConfirm = &ignoreConfirm;
+    const rmqt::Message message(
+        bsl::make_shared<bsl::vector<uint8_t> >(state.range(0), 'p'));
+    int unconfirmed = 0;
+
+    while (state.KeepRunning()) {
+        s_loopback.producer->send(message.withNewGuid(), "rmqbench", onConfirm);
+        if (++unconfirmed == LoopbackProducer::k_MAX_OUTSTANDING / 2) {
+            state.PauseTiming();
+            s_loopback.producer->waitForConfirms();
+            unconfirmed = 0;
+            state.ResumeTiming();
+        }
+    }
+    state.PauseTiming();
+    s_loopback.producer->waitForConfirms();
+    state.ResumeTiming();
+    state.SetItemsProcessed(state.iterations());
+}
+
+} // namespace
+
+// Argument: posts per batch
+BENCHMARK(eventLoopPostThroughput)
+    ->Arg(1)
+    ->Arg(256)
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+BENCHMARK(eventLoopPostRoundTrip)->UseRealTime();
+BENCHMARK(futureMakeSetBlock);
+BENCHMARK(futureThen);
+// Argument: acks pushed per thread between drains
+BENCHMARK(consumerAckQueuePushDrain)
+    ->Arg(1)
+    ->Arg(64)
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+// Arguments: jobs per batch, pool threads
+BENCHMARK(threadPoolDispatch)
+    ->ArgsProduct({{1, 256}, {1, 4}})
+    ->UseRealTime();
+// Argument: message size
+BENCHMARK(producerSendHandoff)->Arg(16)->Arg(4096);
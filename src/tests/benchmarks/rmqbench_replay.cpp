@@ -0,0 +1,117 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Replaying a wire capture (see rmqio::WireCapture) through the read path.
+// Set RMQBENCH_CAPTURE to a capture file, e.g. recorded with
+// `RabbitContextOptions::setWireCapturePath`, to register `replayCapture`.
+
+#include <rmqamqp_framer.h>
+#include <rmqamqp_message.h>
+#include <rmqamqpt_frame.h>
+#include <rmqio_decoder.h>
+#include <rmqio_wirecapture.h>
+#include <rmqt_message.h>
+
+#include <bslma_managedptr.h>
+
+#include <benchmark/benchmark.h>
+
+#include <bsl_cstdint.h>
+#include <bsl_cstdlib.h>
+#include <bsl_fstream.h>
+#include <bsl_iostream.h>
+#include <bsl_map.h>
+#include <bsl_vector.h>
+
+using namespace BloombergLP;
+
+namespace {
+
+/// The socket reads of each connection in the capture, in order
+typedef bsl::map<bsl::uint32_t, bsl::vector<bsl::vector<bsl::uint8_t> > >
+    InboundReads;
+
+InboundReads s_reads;
+bsl::size_t s_bytes = 0;
+
+/// Feed every connection's reads through a fresh Decoder and Framer, as the
+/// connection did, counting the messages assembled
+void replayCapture(benchmark::State& state)
+{
+    bsl::int64_t messages = 0;
+    bsl::vector<rmqamqpt::Frame> frames;
+    while (state.KeepRunning()) {
+        for (InboundReads::const_iterator stream = s_reads.begin();
+             stream != s_reads.end();
+             ++stream) {
+            bslma::ManagedPtr<rmqio::Decoder> decoder =
+                rmqio::Decoder::create(rmqamqpt::Frame::getMaxFrameSize());
+            rmqamqp::Framer framer;
+            bsl::uint16_t channel;
+            rmqamqp::Message message;
+
+            for (bsl::size_t i = 0; i < stream->second.size(); ++i) {
+                const bsl::vector<bsl::uint8_t>& read = stream->second[i];
+                frames.clear();
+                if (decoder->appendBytes(&frames, read.data(), read.size()) !=
+                    rmqio::Decoder::OK) {
+                    state.SkipWithError("Capture does not decode");
+                    return;
+                }
+                for (bsl::size_t j = 0; j < frames.size(); ++j) {
+                    if (framer.appendFrame(&channel, &message, frames[j]) ==
+                            rmqamqp::Framer::OK &&
+                        message.is<rmqt::Message>()) {
+                        ++messages;
+                    }
+                }
+            }
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * s_bytes);
+    state.counters["messages"] =
+        benchmark::Counter(static_cast<double>(messages),
+                           benchmark::Counter::kIsRate);
+}
+
+struct RegisterReplay {
+    RegisterReplay()
+    {
+        const char* path = bsl::getenv("RMQBENCH_CAPTURE");
+        if (!path) {
+            return;
+        }
+
+        bsl::ifstream file(path, bsl::ios::in | bsl::ios::binary);
+        rmqio::WireCapture::Reader reader(file);
+        if (!reader.isValid()) {
+            bsl::cerr << "RMQBENCH_CAPTURE is not a capture: " << path
+                      << bsl::endl;
+            return;
+        }
+
+        rmqio::WireCapture::Record record;
+        while (reader.next(&record)) {
+            if (record.direction == rmqio::WireCapture::INBOUND) {
+                s_bytes += record.bytes.size();
+                s_reads[record.stream].push_back(record.bytes);
+            }
+        }
+
+        benchmark::RegisterBenchmark("replayCapture", &replayCapture);
+    }
+} s_registerReplay;
+
+} // namespace
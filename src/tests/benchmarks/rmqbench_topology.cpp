@@ -0,0 +1,261 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Declaring large topologies, and merging dynamic binding updates into them
+
+#include <rmqamqp_framer.h>
+#include <rmqamqp_message.h>
+#include <rmqamqp_topologymerger.h>
+#include <rmqamqp_topologytransformer.h>
+#include <rmqamqpt_frame.h>
+#include <rmqamqpt_method.h>
+#include <rmqio_countingallocator.h>
+#include <rmqt_exchange.h>
+#include <rmqt_exchangetype.h>
+#include <rmqt_fieldvalue.h>
+#include <rmqt_queue.h>
+#include <rmqt_queuebinding.h>
+#include <rmqt_queueunbinding.h>
+#include <rmqt_topology.h>
+#include <rmqt_topologyupdate.h>
+
+#include <bslma_default.h>
+#include <bslma_defaultallocatorguard.h>
+
+#include <benchmark/benchmark.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_memory.h>
+#include <bsl_sstream.h>
+#include <bsl_string.h>
+#include <bsl_vector.h>
+
+using namespace BloombergLP;
+
+namespace {
+
+const bsl::uint16_t k_CHANNEL = 1;
+
+// Shape of the generated topologies, relative to their number of bindings:
+// 100 bindings per exchange, 10 per queue, every 4th exchange a headers
+// exchange whose bindings carry match arguments
+const int k_BINDINGS_PER_EXCHANGE = 100;
+const int k_BINDINGS_PER_QUEUE    = 10;
+const int k_HEADERS_EVERY         = 4;
+
+bsl::string entityName(const char* prefix, int index)
+{
+    bsl::ostringstream os;
+    os << prefix << index;
+    return os.str();
+}
+
+rmqt::FieldTable headersArgs(int binding)
+{
+    rmqt::FieldTable args;
+    args["x-match"] = rmqt::FieldValue(bsl::string(binding % 2 ? "any"
+                                                               : "all"));
+    args["format"]  = rmqt::FieldValue(entityName("format-", binding % 7));
+    args["region"]  = rmqt::FieldValue(entityName("region-", binding % 13));
+    return args;
+}
+
+/// Names and arguments of a topology of a given number of bindings,
+/// generated up front so that building the topology allocates only what
+/// it keeps
+struct TopologySpec {
+    explicit TopologySpec(int bindings)
+    : exchanges()
+    , queues()
+    , keys()
+    , args()
+    {
+        const int exchangeCount = (bindings + k_BINDINGS_PER_EXCHANGE - 1) /
+                                  k_BINDINGS_PER_EXCHANGE;
+        for (int i = 0; i < exchangeCount; ++i) {
+            exchanges.push_back(entityName("exchange-", i));
+        }
+
+        const int queueCount =
+            (bindings + k_BINDINGS_PER_QUEUE - 1) / k_BINDINGS_PER_QUEUE;
+        for (int i = 0; i < queueCount; ++i) {
+            queues.push_back(entityName("queue-", i));
+        }
+
+        for (int i = 0; i < bindings; ++i) {
+            const bool headers = isHeaders(i / k_BINDINGS_PER_EXCHANGE);
+            keys.push_back(headers ? bsl::string() : entityName("key-", i));
+            args.push_back(headers ? headersArgs(i) : rmqt::FieldTable());
+        }
+    }
+
+    static bool isHeaders(int exchange)
+    {
+        return exchange % k_HEADERS_EVERY == 0;
+    }
+
+    bsl::vector<bsl::string> exchanges;
+    bsl::vector<bsl::string> queues;
+    bsl::vector<bsl::string> keys;
+    bsl::vector<rmqt::FieldTable> args;
+};
+
+rmqt::Topology makeTopology(const TopologySpec& spec)
+{
+    rmqt::Topology topology;
+
+    topology.exchanges.reserve(spec.exchanges.size());
+    for (bsl::size_t i = 0; i < spec.exchanges.size(); ++i) {
+        topology.exchanges.push_back(bsl::make_shared<rmqt::Exchange>(
+            spec.exchanges[i],
+            false,
+            TopologySpec::isHeaders(static_cast<int>(i))
+                ? rmqt::ExchangeType::HEADERS
+                : rmqt::ExchangeType::DIRECT));
+    }
+
+    topology.queues.reserve(spec.queues.size());
+    for (bsl::size_t i = 0; i < spec.queues.size(); ++i) {
+        topology.queues.push_back(
+            bsl::make_shared<rmqt::Queue>(spec.queues[i]));
+    }
+
+    topology.queueBindings.reserve(spec.keys.size());
+    for (bsl::size_t i = 0; i < spec.keys.size(); ++i) {
+        topology.queueBindings.push_back(bsl::make_shared<rmqt::QueueBinding>(
+            topology.exchanges[i / k_BINDINGS_PER_EXCHANGE],
+            topology.queues[i % topology.queues.size()],
+            spec.keys[i],
+            spec.args[i]));
+    }
+    return topology;
+}
+
+/// Return a topology of `bindings` queue bindings and the exchanges and
+/// queues they need
+rmqt::Topology makeTopology(int bindings)
+{
+    return makeTopology(TopologySpec(bindings));
+}
+
+bsl::size_t entities(const rmqt::Topology& topology)
+{
+    return topology.exchanges.size() + topology.queues.size() +
+           topology.queueBindings.size();
+}
+
+/// Build a topology of `range(0)` bindings, reporting the bytes and
+/// allocations each entity (exchange, queue or binding) costs
+void topologyBuild(benchmark::State& state)
+{
+    const TopologySpec spec(static_cast<int>(state.range(0)));
+
+    rmqio::CountingAllocator allocator(bslma::Default::defaultAllocator());
+    bsl::size_t count = 0;
+    while (state.KeepRunning()) {
+        bslma::DefaultAllocatorGuard guard(&allocator);
+        rmqt::Topology topology = makeTopology(spec);
+        count                   = entities(topology);
+        benchmark::DoNotOptimize(topology.queueBindings.data());
+    }
+
+    const double built = static_cast<double>(state.iterations() * count);
+    state.counters["bytes_per_entity"] =
+        static_cast<double>(allocator.bytesAllocated()) / built;
+    state.counters["allocations_per_entity"] =
+        static_cast<double>(allocator.allocations()) / built;
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+/// Turn a topology of `range(0)` bindings into framed declare and bind
+/// methods, pipelined if `range(1)` is set, as a channel does before it is
+/// ready
+void topologyDeclare(benchmark::State& state)
+{
+    const rmqt::Topology topology =
+        makeTopology(static_cast<int>(state.range(0)));
+    const bool pipelined = state.range(1) != 0;
+
+    bsl::vector<rmqamqpt::Frame> frames;
+    while (state.KeepRunning()) {
+        rmqamqp::TopologyTransformer transformer(topology, pipelined);
+        while (transformer.hasNext()) {
+            const rmqamqp::Message message = transformer.getNextMessage();
+            rmqamqpt::Frame frame;
+            rmqamqp::Framer::makeMethodFrame(
+                &frame, k_CHANNEL, message.the<rmqamqpt::Method>());
+            benchmark::DoNotOptimize(frame.rawData());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * entities(topology));
+}
+
+/// Index a topology of `range(0)` bindings, as a channel does once
+void topologyMergerIndex(benchmark::State& state)
+{
+    const rmqt::Topology original =
+        makeTopology(static_cast<int>(state.range(0)));
+
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        rmqt::Topology topology = original;
+        state.ResumeTiming();
+
+        rmqamqp::TopologyMerger merger(&topology);
+        benchmark::DoNotOptimize(&merger);
+    }
+    state.SetItemsProcessed(state.iterations() * original.queueBindings.size());
+}
+
+/// Into a topology of `range(0)` bindings, merge updates binding and then
+/// unbinding `range(1)` more, as dynamic-binding services do
+void topologyMergerApply(benchmark::State& state)
+{
+    const int bindings = static_cast<int>(state.range(0));
+    const int changed  = static_cast<int>(state.range(1));
+
+    rmqt::Topology topology = makeTopology(bindings);
+    rmqamqp::TopologyMerger merger(&topology);
+
+    rmqt::TopologyUpdate bind;
+    rmqt::TopologyUpdate unbind;
+    for (int i = 0; i < changed; ++i) {
+        // Alongside existing bindings, with a new key
+        const bsl::shared_ptr<rmqt::QueueBinding>& binding =
+            topology.queueBindings[i % bindings];
+        const bsl::string key = entityName("dynamic-", i);
+        bind.updates.push_back(bsl::make_shared<rmqt::QueueBinding>(
+            binding->exchange(), binding->queue(), key, binding->args()));
+        unbind.updates.push_back(bsl::make_shared<rmqt::QueueUnbinding>(
+            binding->exchange(), binding->queue(), key, binding->args()));
+    }
+
+    while (state.KeepRunning()) {
+        merger.apply(bind);
+        merger.apply(unbind);
+    }
+    state.SetItemsProcessed(state.iterations() * 2 * changed);
+}
+
+} // namespace
+
+// Argument: bindings
+BENCHMARK(topologyBuild)->RangeMultiplier(10)->Range(1000, 100000);
+// Arguments: bindings, pipelined
+BENCHMARK(topologyDeclare)->ArgsProduct({{1000, 10000, 100000}, {0, 1}});
+// Argument: bindings
+BENCHMARK(topologyMergerIndex)->RangeMultiplier(10)->Range(1000, 100000);
+// Arguments: bindings, bindings added then removed per iteration
+BENCHMARK(topologyMergerApply)->ArgsProduct({{1000, 100000}, {1, 100}});
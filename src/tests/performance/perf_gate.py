@@ -0,0 +1,168 @@
+"""Copyright 2020-2023 Bloomberg Finance L.P.
+SPDX-License-Identifier: Apache-2.0
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Runs a benchmark which writes its metrics as JSON (`--output <file>`),
+takes the median of each metric over several runs, and compares them against
+a stored baseline using per-metric thresholds.
+
+Exits non-zero if any metric regressed by more than its threshold. With
+`--update-baseline` the medians are stored as the new baseline instead.
+"""
+import argparse
+import json
+import os
+import statistics
+import subprocess
+import sys
+import tempfile
+from typing import Dict, List, Optional, Tuple
+
+
+def run_benchmark(command: List[str], runs: int) -> Tuple[dict, List[dict]]:
+    results = []
+    with tempfile.TemporaryDirectory() as tmp:
+        for run in range(runs):
+            output = os.path.join(tmp, f"run{run}.json")
+            subprocess.run(command + ["--output", output], check=True)
+            with open(output) as f:
+                results.append(json.load(f))
+    return results[0], results
+
+
+def median_metrics(results: List[dict]) -> Dict[str, float]:
+    names = results[0]["metrics"].keys()
+    return {
+        name: statistics.median(result["metrics"][name] for result in results)
+        for name in names
+    }
+
+
+def compare(
+    baseline: Dict[str, float],
+    current: Dict[str, float],
+    thresholds: dict,
+) -> Tuple[List[List[str]], List[str]]:
+    """Return the report rows and the names of regressed metrics"""
+    rows = []
+    regressions = []
+    default = thresholds.get("default", {"better": "lower", "tolerance": 0.1})
+    for name in sorted(set(baseline) | set(current)):
+        limit = thresholds.get("metrics", {}).get(name, default)
+        old: Optional[float] = baseline.get(name)
+        new: Optional[float] = current.get(name)
+        if old is None or new is None:
+            rows.append([name, fmt(old), fmt(new), "", "", "missing"])
+            continue
+
+        change = (new - old) / old if old else 0.0
+        if limit.get("tolerance") is None:
+            # Too noisy to gate on, reported for information
+            rows.append([name, fmt(old), fmt(new), f"{change:+.1%}", "", ""])
+            continue
+
+        worse = -change if limit["better"] == "higher" else change
+        status = "ok"
+        if worse > limit["tolerance"]:
+            status = "REGRESSED"
+            regressions.append(name)
+        elif worse < -limit["tolerance"]:
+            status = "improved"
+        rows.append(
+            [
+                name,
+                fmt(old),
+                fmt(new),
+                f"{change:+.1%}",
+                f"{limit['better']} ±{limit['tolerance']:.0%}",
+                status,
+            ]
+        )
+    return rows, regressions
+
+
+def fmt(value: Optional[float]) -> str:
+    return "-" if value is None else f"{value:.6g}"
+
+
+def markdown(rows: List[List[str]]) -> str:
+    header = ["metric", "baseline", "current", "change", "threshold", "status"]
+    lines = ["| " + " | ".join(header) + " |", "|" + "---|" * len(header)]
+    lines += ["| " + " | ".join(row) + " |" for row in rows]
+    return "\n".join(lines) + "\n"
+
+
+def main() -> int:
+    here = os.path.dirname(os.path.abspath(__file__))
+    parser = argparse.ArgumentParser(
+        description="Compare benchmark metrics against a stored baseline",
+        epilog="e.g. perf_gate.py --runs 5 -- rmqloopback_benchmark -n 50000",
+    )
+    parser.add_argument("benchmark", nargs="+", help="benchmark and its args")
+    parser.add_argument("--runs", type=int, default=3)
+    parser.add_argument(
+        "--baseline", default=os.path.join(here, "baselines", "loopback.json")
+    )
+    parser.add_argument(
+        "--thresholds", default=os.path.join(here, "thresholds.json")
+    )
+    parser.add_argument("--report", help="also write the diff report here")
+    parser.add_argument("--update-baseline", action="store_true")
+    args = parser.parse_args()
+
+    first, results = run_benchmark(args.benchmark, args.runs)
+    current = median_metrics(results)
+    document = {
+        "benchmark": first["benchmark"],
+        "parameters": first["parameters"],
+        "runs": args.runs,
+        "metrics": current,
+    }
+
+    if args.update_baseline or not os.path.exists(args.baseline):
+        os.makedirs(os.path.dirname(args.baseline), exist_ok=True)
+        with open(args.baseline, "w") as f:
+            json.dump(document, f, indent=2, sort_keys=True)
+            f.write("\n")
+        print(f"Stored the median of {args.runs} runs in {args.baseline}")
+        return 0
+
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+    with open(args.thresholds) as f:
+        thresholds = json.load(f)
+
+    if baseline["parameters"] != first["parameters"]:
+        print(
+            f"Baseline parameters {baseline['parameters']} do not match "
+            f"{first['parameters']}, refusing to compare",
+            file=sys.stderr,
+        )
+        return 2
+
+    rows, regressions = compare(baseline["metrics"], current, thresholds)
+    report = markdown(rows)
+    print(report)
+    if args.report:
+        with open(args.report, "w") as f:
+            f.write(report)
+
+    if regressions:
+        print("Regressed: " + ", ".join(regressions), file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,822 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Runs the same workloads, publishing with confirms and consuming with acks
+// across a matrix of message sizes and header counts, through rmqcpp and,
+// where they were found at build time, other AMQP 0-9-1 client libraries,
+// and prints their throughput, confirm latency and CPU time side by side.
+// Against the in-process LoopbackBroker by default, or a real broker with
+// `--host`.
+
+#include <rmqtestutil_loopbackbroker.h>
+
+#include <rmqa_consumer.h>
+#include <rmqa_producer.h>
+#include <rmqa_rabbitcontext.h>
+#include <rmqa_rabbitcontextoptions.h>
+#include <rmqa_topology.h>
+#include <rmqa_vhost.h>
+#include <rmqp_messageguard.h>
+#include <rmqp_producer.h>
+#include <rmqt_confirmresponse.h>
+#include <rmqt_consumerconfig.h>
+#include <rmqt_fieldvalue.h>
+#include <rmqt_message.h>
+#include <rmqt_plaincredentials.h>
+#include <rmqt_simpleendpoint.h>
+
+#include <balcl_commandline.h>
+#include <bdlb_tokenizer.h>
+#include <bdlf_bind.h>
+#include <bdlf_placeholder.h>
+#include <bslmt_threadutil.h>
+#include <bsls_atomic.h>
+#include <bsls_platform.h>
+#include <bsls_systemtime.h>
+#include <bsls_types.h>
+
+#include <bsl_algorithm.h>
+#include <bsl_cstdio.h>
+#include <bsl_cstdlib.h>
+#include <bsl_fstream.h>
+#include <bsl_iomanip.h>
+#include <bsl_iostream.h>
+#include <bsl_memory.h>
+#include <bsl_sstream.h>
+#include <bsl_string.h>
+#include <bsl_vector.h>
+
+#ifdef BSLS_PLATFORM_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+#ifdef RMQCOMPARE_WITH_RABBITMQ_C
+#include <rabbitmq-c/amqp.h>
+#include <rabbitmq-c/tcp_socket.h>
+#endif
+
+using namespace BloombergLP;
+
+namespace {
+
+/// Process CPU time (user and system) in microseconds, or 0 where it is not
+/// available
+bsls::Types::Int64 cpuMicroseconds()
+{
+#ifdef BSLS_PLATFORM_OS_UNIX
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000LL +
+           usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+#else
+    return 0;
+#endif
+}
+
+bsls::Types::Int64 nowMicroseconds()
+{
+    return bsls::SystemTime::nowMonotonicClock().totalMicroseconds();
+}
+
+/// Where the clients connect to
+struct Broker {
+    bsl::string host;
+    int port;
+    bsl::string vhost;
+    bsl::string user;
+    bsl::string password;
+};
+
+/// One cell of the matrix: `count` messages of `size` bytes, each with
+/// `headers` string headers
+struct Workload {
+    int count;
+    int size;
+    int headers;
+    int prefetch;
+    int confirms;
+};
+
+/// Header `index` of a message, named and valued alike by every client
+bsl::string headerName(int index)
+{
+    bsl::ostringstream os;
+    os << "x-header-" << index;
+    return os.str();
+}
+
+const char k_HEADER_VALUE[] = "header-value";
+
+/// What a client measured for one workload
+struct Result {
+    double publishRate;
+    double publishCpu;
+    bsls::Types::Int64 p50;
+    bsls::Types::Int64 p99;
+    bsls::Types::Int64 p999;
+    double consumeRate;
+    double consumeCpu;
+
+    Result()
+    : publishRate(0)
+    , publishCpu(0)
+    , p50(0)
+    , p99(0)
+    , p999(0)
+    , consumeRate(0)
+    , consumeCpu(0)
+    {
+    }
+};
+
+/// Wall clock and process CPU time of one phase
+class Stopwatch {
+  public:
+    Stopwatch()
+    : d_start(nowMicroseconds())
+    , d_cpu(cpuMicroseconds())
+    {
+    }
+
+    /// Set `rate` to messages per second and `cpu` to CPU microseconds per
+    /// message since construction
+    void stop(int count, double* rate, double* cpu) const
+    {
+        const bsls::Types::Int64 taken =
+            bsl::max<bsls::Types::Int64>(nowMicroseconds() - d_start, 1);
+        *rate = count * 1e6 / taken;
+        *cpu  = static_cast<double>(cpuMicroseconds() - d_cpu) / count;
+    }
+
+  private:
+    bsls::Types::Int64 d_start;
+    bsls::Types::Int64 d_cpu;
+};
+
+/// Send to confirm latency of each publish
+class Latencies {
+  public:
+    explicit Latencies(int count)
+    : d_sent(count)
+    , d_latencies(count)
+    {
+    }
+
+    void sent(int index) { d_sent[index] = nowMicroseconds(); }
+
+    void confirmed(int index)
+    {
+        d_latencies[index] = nowMicroseconds() - d_sent[index];
+    }
+
+    /// Sort the latencies and store their percentiles in `result`
+    void summarize(Result* result)
+    {
+        bsl::sort(d_latencies.begin(), d_latencies.end());
+        result->p50  = valueAt(50);
+        result->p99  = valueAt(99);
+        result->p999 = valueAt(99.9);
+    }
+
+  private:
+    bsls::Types::Int64 valueAt(double percentile) const
+    {
+        if (d_latencies.empty()) {
+            return 0;
+        }
+        const bsl::size_t index =
+            static_cast<bsl::size_t>(percentile / 100 * d_latencies.size());
+        return d_latencies[bsl::min(index, d_latencies.size() - 1)];
+    }
+
+    bsl::vector<bsls::Types::Int64> d_sent;
+    bsl::vector<bsls::Types::Int64> d_latencies;
+};
+
+/// A client library driven through a workload. `run` publishes the
+/// workload's messages to `queue` with confirms, then consumes as many from
+/// it with acks. Return 0 on success.
+class Client {
+  public:
+    virtual ~Client() {}
+
+    virtual const char* name() const = 0;
+
+    virtual int run(const Workload& workload,
+                    const bsl::string& queue,
+                    Result* result) = 0;
+};
+
+class RmqcppClient : public Client {
+  public:
+    RmqcppClient(const bsl::shared_ptr<rmqt::Endpoint>& endpoint,
+                 const bsl::shared_ptr<rmqt::Credentials>& credentials)
+    : d_rabbit()
+    , d_vhost(d_rabbit.createVHostConnection("rmqcompare-rmqcpp",
+                                             endpoint,
+                                             credentials))
+    {
+    }
+
+    const char* name() const BSLS_KEYWORD_OVERRIDE { return "rmqcpp"; }
+
+    int run(const Workload& workload,
+            const bsl::string& queueName,
+            Result* result) BSLS_KEYWORD_OVERRIDE
+    {
+        bsl::shared_ptr<rmqt::FieldTable> headers;
+        if (workload.headers > 0) {
+            headers = bsl::make_shared<rmqt::FieldTable>();
+            for (int i = 0; i < workload.headers; ++i) {
+                (*headers)[headerName(i)] =
+                    rmqt::FieldValue(bsl::string(k_HEADER_VALUE));
+            }
+        }
+        const bsl::shared_ptr<bsl::vector<uint8_t> > payload =
+            bsl::make_shared<bsl::vector<uint8_t> >(workload.size, 'a');
+
+        rmqa::Topology topology;
+        rmqt::QueueHandle queue = topology.addQueue(queueName);
+
+        rmqt::Result<rmqa::Producer> producerResult = d_vhost->createProducer(
+            topology, topology.defaultExchange(), workload.confirms);
+        if (!producerResult) {
+            bsl::cerr << "Failed to create producer: "
+                      << producerResult.error() << "\n";
+            return 1;
+        }
+        bsl::shared_ptr<rmqa::Producer> producer = producerResult.value();
+
+        // Confirms for a single producer arrive in publish order, so the nth
+        // confirm belongs to the nth send
+        Latencies latencies(workload.count);
+        bsls::AtomicInt confirmed(0);
+        const rmqp::Producer::ConfirmationCallback onConfirm =
+            bdlf::BindUtil::bind(&RmqcppClient::onConfirm,
+                                 &latencies,
+                                 &confirmed,
+                                 bdlf::PlaceHolders::_1,
+                                 bdlf::PlaceHolders::_2,
+                                 bdlf::PlaceHolders::_3);
+
+        Stopwatch publish;
+        for (int i = 0; i < workload.count; ++i) {
+            // Built per send, as an application would, so that every client
+            // pays for its own message representation
+            const rmqt::Message message(payload, "", headers);
+            latencies.sent(i);
+            producer->send(message, queueName, onConfirm);
+        }
+        producer->waitForConfirms();
+        publish.stop(
+            workload.count, &result->publishRate, &result->publishCpu);
+        latencies.summarize(result);
+
+        bsls::AtomicInt acked(0);
+        Stopwatch consume;
+        rmqt::Result<rmqa::Consumer> consumerResult = d_vhost->createConsumer(
+            topology,
+            queue,
+            bdlf::BindUtil::bind(
+                &RmqcppClient::onMessage, &acked, bdlf::PlaceHolders::_1),
+            rmqt::ConsumerConfig().setPrefetchCount(workload.prefetch));
+        if (!consumerResult) {
+            bsl::cerr << "Failed to create consumer: "
+                      << consumerResult.error() << "\n";
+            return 1;
+        }
+        while (acked < workload.count) {
+            bslmt::ThreadUtil::microSleep(100);
+        }
+        consume.stop(
+            workload.count, &result->consumeRate, &result->consumeCpu);
+        consumerResult.value()->cancelAndDrain();
+        return 0;
+    }
+
+  private:
+    static void onConfirm(Latencies* latencies,
+                          bsls::AtomicInt* confirmed,
+                          const rmqt::Message&,
+                          const bsl::string&,
+                          const rmqt::ConfirmResponse&)
+    {
+        latencies->confirmed((*confirmed)++);
+    }
+
+    static void onMessage(bsls::AtomicInt* acked, rmqp::MessageGuard& guard)
+    {
+        guard.ack();
+        ++*acked;
+    }
+
+    rmqa::RabbitContext d_rabbit;
+    bsl::shared_ptr<rmqa::VHost> d_vhost;
+};
+
+#ifdef RMQCOMPARE_WITH_RABBITMQ_C
+/// rabbitmq-c, driven synchronously from the calling thread as its API
+/// expects: publishes are pipelined up to the confirm window, and confirms
+/// and deliveries are read between them.
+class RabbitmqCClient : public Client {
+  public:
+    explicit RabbitmqCClient(const Broker& broker)
+    : d_broker(broker)
+    {
+    }
+
+    const char* name() const BSLS_KEYWORD_OVERRIDE { return "rabbitmq-c"; }
+
+    int run(const Workload& workload,
+            const bsl::string& queue,
+            Result* result) BSLS_KEYWORD_OVERRIDE
+    {
+        amqp_connection_state_t conn = amqp_new_connection();
+        const int rc = runOn(conn, workload, queue, result);
+        amqp_connection_close(conn, AMQP_REPLY_SUCCESS);
+        amqp_destroy_connection(conn);
+        return rc;
+    }
+
+  private:
+    enum { k_PUBLISH_CHANNEL = 1, k_CONSUME_CHANNEL = 2 };
+
+    static int check(amqp_rpc_reply_t reply, const char* what)
+    {
+        if (reply.reply_type != AMQP_RESPONSE_NORMAL) {
+            bsl::cerr << "rabbitmq-c: " << what << " failed\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    int runOn(amqp_connection_state_t conn,
+              const Workload& workload,
+              const bsl::string& queue,
+              Result* result)
+    {
+        amqp_socket_t* socket = amqp_tcp_socket_new(conn);
+        if (!socket ||
+            amqp_socket_open(
+                socket, d_broker.host.c_str(), d_broker.port) !=
+                AMQP_STATUS_OK) {
+            bsl::cerr << "rabbitmq-c: failed to connect\n";
+            return 1;
+        }
+        if (check(amqp_login(conn,
+                             d_broker.vhost.c_str(),
+                             0,
+                             131072,
+                             0,
+                             AMQP_SASL_METHOD_PLAIN,
+                             d_broker.user.c_str(),
+                             d_broker.password.c_str()),
+                  "login")) {
+            return 1;
+        }
+        amqp_channel_open(conn, k_PUBLISH_CHANNEL);
+        if (check(amqp_get_rpc_reply(conn), "channel.open")) {
+            return 1;
+        }
+        amqp_confirm_select(conn, k_PUBLISH_CHANNEL);
+        if (check(amqp_get_rpc_reply(conn), "confirm.select")) {
+            return 1;
+        }
+        amqp_queue_declare(conn,
+                           k_PUBLISH_CHANNEL,
+                           amqp_cstring_bytes(queue.c_str()),
+                           0,
+                           0,
+                           0,
+                           0,
+                           amqp_empty_table);
+        if (check(amqp_get_rpc_reply(conn), "queue.declare")) {
+            return 1;
+        }
+
+        return publish(conn, workload, queue, result) ||
+               consume(conn, workload, queue, result);
+    }
+
+    int publish(amqp_connection_state_t conn,
+                const Workload& workload,
+                const bsl::string& queue,
+                Result* result)
+    {
+        bsl::vector<bsl::string> names(workload.headers);
+        bsl::vector<amqp_table_entry_t> entries(workload.headers);
+        for (int i = 0; i < workload.headers; ++i) {
+            names[i]                     = headerName(i);
+            entries[i].key               = amqp_cstring_bytes(names[i].c_str());
+            entries[i].value.kind        = AMQP_FIELD_KIND_UTF8;
+            entries[i].value.value.bytes = amqp_cstring_bytes(k_HEADER_VALUE);
+        }
+        const bsl::vector<char> payload(workload.size, 'a');
+        amqp_bytes_t body;
+        body.len   = payload.size();
+        body.bytes = const_cast<char*>(payload.data());
+
+        Latencies latencies(workload.count);
+        bsl::uint64_t confirmed = 0;
+        Stopwatch stopwatch;
+        for (int i = 0; i < workload.count; ++i) {
+            while (i - static_cast<int>(confirmed) >= workload.confirms) {
+                if (awaitConfirms(conn, &latencies, &confirmed)) {
+                    return 1;
+                }
+            }
+
+            // rmqcpp gives each message a unique id, so this does too
+            char messageId[40];
+            bsl::snprintf(messageId, sizeof(messageId), "rmqcompare-%d", i);
+
+            amqp_basic_properties_t props;
+            props._flags = AMQP_BASIC_DELIVERY_MODE_FLAG |
+                           AMQP_BASIC_MESSAGE_ID_FLAG;
+            props.delivery_mode = 2;
+            props.message_id    = amqp_cstring_bytes(messageId);
+            if (workload.headers > 0) {
+                props._flags |= AMQP_BASIC_HEADERS_FLAG;
+                props.headers.num_entries = workload.headers;
+                props.headers.entries     = entries.data();
+            }
+
+            latencies.sent(i);
+            if (amqp_basic_publish(conn,
+                                   k_PUBLISH_CHANNEL,
+                                   amqp_empty_bytes,
+                                   amqp_cstring_bytes(queue.c_str()),
+                                   1,
+                                   0,
+                                   &props,
+                                   body) != AMQP_STATUS_OK) {
+                bsl::cerr << "rabbitmq-c: basic.publish failed\n";
+                return 1;
+            }
+        }
+        while (confirmed < static_cast<bsl::uint64_t>(workload.count)) {
+            if (awaitConfirms(conn, &latencies, &confirmed)) {
+                return 1;
+            }
+        }
+        stopwatch.stop(
+            workload.count, &result->publishRate, &result->publishCpu);
+        latencies.summarize(result);
+        return 0;
+    }
+
+    /// Read frames until a confirm arrives, recording the latency of each
+    /// publish it covers
+    static int awaitConfirms(amqp_connection_state_t conn,
+                             Latencies* latencies,
+                             bsl::uint64_t* confirmed)
+    {
+        for (;;) {
+            amqp_maybe_release_buffers(conn);
+            amqp_frame_t frame;
+            if (amqp_simple_wait_frame(conn, &frame) != AMQP_STATUS_OK) {
+                bsl::cerr << "rabbitmq-c: failed waiting for confirms\n";
+                return 1;
+            }
+            if (frame.frame_type != AMQP_FRAME_METHOD ||
+                frame.payload.method.id != AMQP_BASIC_ACK_METHOD) {
+                continue;
+            }
+            const amqp_basic_ack_t* ack = static_cast<amqp_basic_ack_t*>(
+                frame.payload.method.decoded);
+            const bsl::uint64_t upTo =
+                ack->multiple ? ack->delivery_tag : *confirmed + 1;
+            while (*confirmed < upTo) {
+                latencies->confirmed(static_cast<int>((*confirmed)++));
+            }
+            return 0;
+        }
+    }
+
+    int consume(amqp_connection_state_t conn,
+                const Workload& workload,
+                const bsl::string& queue,
+                Result* result)
+    {
+        Stopwatch stopwatch;
+        amqp_channel_open(conn, k_CONSUME_CHANNEL);
+        if (check(amqp_get_rpc_reply(conn), "channel.open")) {
+            return 1;
+        }
+        amqp_basic_qos(conn, k_CONSUME_CHANNEL, 0, workload.prefetch, 0);
+        if (check(amqp_get_rpc_reply(conn), "basic.qos")) {
+            return 1;
+        }
+        amqp_basic_consume(conn,
+                           k_CONSUME_CHANNEL,
+                           amqp_cstring_bytes(queue.c_str()),
+                           amqp_empty_bytes,
+                           0,
+                           0,
+                           0,
+                           amqp_empty_table);
+        if (check(amqp_get_rpc_reply(conn), "basic.consume")) {
+            return 1;
+        }
+
+        for (int received = 0; received < workload.count;) {
+            amqp_maybe_release_buffers(conn);
+            amqp_envelope_t envelope;
+            if (check(amqp_consume_message(conn, &envelope, NULL, 0),
+                      "consume")) {
+                return 1;
+            }
+            amqp_basic_ack(conn, envelope.channel, envelope.delivery_tag, 0);
+            amqp_destroy_envelope(&envelope);
+            ++received;
+        }
+        stopwatch.stop(
+            workload.count, &result->consumeRate, &result->consumeCpu);
+        return 0;
+    }
+
+    Broker d_broker;
+};
+#endif
+
+/// Parse a comma separated list of non-negative integers into `values`.
+/// Return 0 on success.
+int parseList(const bsl::string& list, bsl::vector<int>* values)
+{
+    values->clear();
+    for (bdlb::Tokenizer it(list, ","); it.isValid(); ++it) {
+        const bsl::string token(it.token());
+        char* end        = 0;
+        const long value = bsl::strtol(token.c_str(), &end, 10);
+        if (token.empty() || *end != '\0' || value < 0) {
+            return 1;
+        }
+        values->push_back(static_cast<int>(value));
+    }
+    return values->empty();
+}
+
+struct Row {
+    const char* client;
+    Workload workload;
+    Result result;
+};
+
+void printTable(const bsl::vector<Row>& rows)
+{
+    bsl::cout << bsl::left << bsl::setw(12) << "client" << bsl::right
+              << bsl::setw(8) << "size" << bsl::setw(8) << "headers"
+              << bsl::setw(12) << "pub msg/s" << bsl::setw(10) << "p50 us"
+              << bsl::setw(10) << "p99 us" << bsl::setw(10) << "p999 us"
+              << bsl::setw(12) << "pub cpu/msg" << bsl::setw(12)
+              << "con msg/s" << bsl::setw(12) << "con cpu/msg" << "\n";
+    for (bsl::size_t i = 0; i < rows.size(); ++i) {
+        const Row& row = rows[i];
+        bsl::cout << bsl::left << bsl::setw(12) << row.client << bsl::right
+                  << bsl::setw(8) << row.workload.size << bsl::setw(8)
+                  << row.workload.headers << bsl::fixed
+                  << bsl::setprecision(0) << bsl::setw(12)
+                  << row.result.publishRate << bsl::setw(10)
+                  << row.result.p50 << bsl::setw(10) << row.result.p99
+                  << bsl::setw(10) << row.result.p999
+                  << bsl::setprecision(2) << bsl::setw(12)
+                  << row.result.publishCpu << bsl::setprecision(0)
+                  << bsl::setw(12) << row.result.consumeRate
+                  << bsl::setprecision(2) << bsl::setw(12)
+                  << row.result.consumeCpu << "\n";
+    }
+}
+
+void writeJson(bsl::ostream& os, const bsl::vector<Row>& rows)
+{
+    os << "{\n  \"benchmark\": \"compare\",\n  \"results\": [\n";
+    for (bsl::size_t i = 0; i < rows.size(); ++i) {
+        const Row& row = rows[i];
+        os << "    {\"client\": \"" << row.client
+           << "\", \"count\": " << row.workload.count
+           << ", \"size\": " << row.workload.size
+           << ", \"headers\": " << row.workload.headers
+           << ", \"publish.throughput_msg_per_s\": " << row.result.publishRate
+           << ", \"publish.cpu_us_per_msg\": " << row.result.publishCpu
+           << ", \"publish.latency_us.p50\": " << row.result.p50
+           << ", \"publish.latency_us.p99\": " << row.result.p99
+           << ", \"publish.latency_us.p999\": " << row.result.p999
+           << ", \"consume.throughput_msg_per_s\": " << row.result.consumeRate
+           << ", \"consume.cpu_us_per_msg\": " << row.result.consumeCpu << "}"
+           << (i + 1 < rows.size() ? ",\n" : "\n");
+    }
+    os << "  ]\n}\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    int count    = 20000;
+    int prefetch = 100;
+    int confirms = 100;
+    bsl::string sizes("16,1000,65536");
+    bsl::string headerCounts("0,10");
+    bsl::string host;
+    int port = 5672;
+    bsl::string vhostName("/");
+    bsl::string user("guest");
+    bsl::string password("guest");
+    bsl::string output;
+
+    balcl::OptionInfo specTable[] = {
+        {
+            "n|count",
+            "count",
+            "Messages to publish, and to consume, per workload",
+            balcl::TypeInfo(&count),
+            balcl::OccurrenceInfo(count),
+        },
+        {
+            "s|sizes",
+            "sizes",
+            "Comma separated message sizes in bytes",
+            balcl::TypeInfo(&sizes),
+            balcl::OccurrenceInfo(sizes),
+        },
+        {
+            "headers",
+            "headers",
+            "Comma separated numbers of headers per message",
+            balcl::TypeInfo(&headerCounts),
+            balcl::OccurrenceInfo(headerCounts),
+        },
+        {
+            "q|qos",
+            "qos",
+            "Consumer prefetch count",
+            balcl::TypeInfo(&prefetch),
+            balcl::OccurrenceInfo(prefetch),
+        },
+        {
+            "c|confirms",
+            "confirms",
+            "Max outstanding confirms",
+            balcl::TypeInfo(&confirms),
+            balcl::OccurrenceInfo(confirms),
+        },
+        {
+            "host",
+            "host",
+            "Broker to run against, instead of the loopback broker",
+            balcl::TypeInfo(&host),
+            balcl::OccurrenceInfo::e_OPTIONAL,
+        },
+        {
+            "port",
+            "port",
+            "Port of --host",
+            balcl::TypeInfo(&port),
+            balcl::OccurrenceInfo(port),
+        },
+        {
+            "vhost",
+            "vhost",
+            "Virtual host of --host",
+            balcl::TypeInfo(&vhostName),
+            balcl::OccurrenceInfo(vhostName),
+        },
+        {
+            "user",
+            "user",
+            "User name for --host",
+            balcl::TypeInfo(&user),
+            balcl::OccurrenceInfo(user),
+        },
+        {
+            "password",
+            "password",
+            "Password for --host",
+            balcl::TypeInfo(&password),
+            balcl::OccurrenceInfo(password),
+        },
+        {
+            "o|output",
+            "output",
+            "File to write the results to, as JSON",
+            balcl::TypeInfo(&output),
+            balcl::OccurrenceInfo::e_OPTIONAL,
+        },
+    };
+    balcl::CommandLine cmdLine(specTable);
+    bsl::vector<int> sizeList, headerList;
+    if (cmdLine.parse(argc, argv) || count <= 0 || prefetch <= 0 ||
+        confirms <= 0 || parseList(sizes, &sizeList) ||
+        parseList(headerCounts, &headerList)) {
+        cmdLine.printUsage();
+        return 1;
+    }
+
+    // Against the loopback broker every client pays for the broker's thread
+    // too, equally, since it runs in this process
+    rmqtestutil::LoopbackBroker loopback;
+    Broker broker;
+    bsl::shared_ptr<rmqt::Endpoint> endpoint;
+    bsl::shared_ptr<rmqt::Credentials> credentials;
+    if (host.empty()) {
+        if (loopback.start() != 0) {
+            bsl::cerr << "Failed to start the loopback broker\n";
+            return 1;
+        }
+        broker.host     = "127.0.0.1";
+        broker.port     = loopback.port();
+        broker.vhost    = "/";
+        broker.user     = "guest";
+        broker.password = "guest";
+        endpoint        = loopback.endpoint();
+        credentials     = loopback.credentials();
+    }
+    else {
+        broker.host     = host;
+        broker.port     = port;
+        broker.vhost    = vhostName;
+        broker.user     = user;
+        broker.password = password;
+        endpoint        = bsl::make_shared<rmqt::SimpleEndpoint>(
+            host, vhostName, static_cast<bsl::uint16_t>(port));
+        credentials = bsl::make_shared<rmqt::PlainCredentials>(user, password);
+    }
+
+    bsl::vector<bsl::shared_ptr<Client> > clients;
+    clients.push_back(
+        bsl::make_shared<RmqcppClient>(endpoint, credentials));
+#ifdef RMQCOMPARE_WITH_RABBITMQ_C
+    clients.push_back(bsl::make_shared<RabbitmqCClient>(broker));
+#endif
+
+    bsl::vector<Row> rows;
+    for (bsl::size_t s = 0; s < sizeList.size(); ++s) {
+        for (bsl::size_t h = 0; h < headerList.size(); ++h) {
+            const Workload workload = {
+                count, sizeList[s], headerList[h], prefetch, confirms};
+
+            if (host.empty()) {
+                // Deliver consumers the workload's message, as a real
+                // broker would deliver what was just published
+                bsl::shared_ptr<rmqt::FieldTable> headers;
+                if (workload.headers > 0) {
+                    headers = bsl::make_shared<rmqt::FieldTable>();
+                    for (int i = 0; i < workload.headers; ++i) {
+                        (*headers)[headerName(i)] =
+                            rmqt::FieldValue(bsl::string(k_HEADER_VALUE));
+                    }
+                }
+                loopback.setDeliveries(
+                    bsl::vector<rmqt::Message>(
+                        1,
+                        rmqt::Message(bsl::make_shared<bsl::vector<uint8_t> >(
+                                          workload.size, 'a'),
+                                      "",
+                                      headers)),
+                    workload.count);
+            }
+
+            for (bsl::size_t c = 0; c < clients.size(); ++c) {
+                bsl::ostringstream queue;
+                queue << "rmqcompare-" << clients[c]->name() << "-"
+                      << workload.size << "-" << workload.headers;
+
+                Row row = {clients[c]->name(), workload, Result()};
+                if (clients[c]->run(workload, queue.str(), &row.result)) {
+                    bsl::cerr << clients[c]->name() << " failed the "
+                              << workload.size << " byte, "
+                              << workload.headers << " header workload\n";
+                    return 1;
+                }
+                rows.push_back(row);
+            }
+        }
+    }
+
+    printTable(rows);
+
+    if (!output.empty()) {
+        bsl::ofstream os(output.c_str());
+        writeJson(os, rows);
+        if (!os) {
+            bsl::cerr << "Failed to write results to " << output << "\n";
+            return 1;
+        }
+    }
+
+    return 0;
+}
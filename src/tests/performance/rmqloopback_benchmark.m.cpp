@@ -0,0 +1,459 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures the client's publish and consume throughput against an
+// in-process LoopbackBroker, so that results are not dominated by the noise
+// of a real RabbitMQ. With `--output` the results are also written as JSON,
+// which `perf_gate.py` compares against a stored baseline.
+
+#include <rmqtestutil_loopbackbroker.h>
+
+#include <rmqa_allocationstats.h>
+#include <rmqa_consumer.h>
+#include <rmqa_producer.h>
+#include <rmqa_rabbitcontext.h>
+#include <rmqa_rabbitcontextoptions.h>
+#include <rmqa_topology.h>
+#include <rmqa_vhost.h>
+#include <rmqio_countingallocator.h>
+#include <rmqp_messageguard.h>
+#include <rmqp_producer.h>
+#include <rmqt_confirmresponse.h>
+#include <rmqt_consumerconfig.h>
+#include <rmqt_message.h>
+
+#include <balcl_commandline.h>
+#include <bdlf_bind.h>
+#include <bdlf_placeholder.h>
+#include <bslma_default.h>
+#include <bslma_newdeleteallocator.h>
+#include <bslmt_threadutil.h>
+#include <bsls_atomic.h>
+#include <bsls_platform.h>
+#include <bsls_systemtime.h>
+#include <bsls_timeinterval.h>
+#include <bsls_types.h>
+
+#include <bsl_algorithm.h>
+#include <bsl_fstream.h>
+#include <bsl_iostream.h>
+#include <bsl_memory.h>
+#include <bsl_string.h>
+#include <bsl_vector.h>
+
+#ifdef BSLS_PLATFORM_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+using namespace BloombergLP;
+
+namespace {
+
+/// Process CPU time (user and system) in microseconds, or 0 where it is not
+/// available
+bsls::Types::Int64 cpuMicroseconds()
+{
+#ifdef BSLS_PLATFORM_OS_UNIX
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000LL +
+           usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+#else
+    return 0;
+#endif
+}
+
+/// Page faults the process has taken so far, or 0 where they are not
+/// available. Minor faults map a page already in memory (first touch of a
+/// fresh buffer), major faults had to read it in.
+void pageFaults(bsls::Types::Int64* minor, bsls::Types::Int64* major)
+{
+    *minor = 0;
+    *major = 0;
+#ifdef BSLS_PLATFORM_OS_UNIX
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        *minor = usage.ru_minflt;
+        *major = usage.ru_majflt;
+    }
+#endif
+}
+
+bsls::Types::Int64 nowMicroseconds()
+{
+    return bsls::SystemTime::nowMonotonicClock().totalMicroseconds();
+}
+
+/// Throughput and resource use of one phase of the benchmark
+class Phase {
+  public:
+    Phase(const char* name,
+          const rmqio::CountingAllocator& allocator,
+          const rmqa::AllocationStats& stats)
+    : d_name(name)
+    , d_allocator(allocator)
+    , d_stats(stats)
+    , d_start()
+    , d_taken()
+    , d_cpu(0)
+    , d_minorFaults(0)
+    , d_majorFaults(0)
+    , d_allocations(0)
+    , d_subsystems(rmqa::AllocationStats::NUM_SUBSYSTEMS)
+    {
+    }
+
+    void start()
+    {
+        d_start       = bsls::SystemTime::nowMonotonicClock();
+        d_cpu         = cpuMicroseconds();
+        pageFaults(&d_minorFaults, &d_majorFaults);
+        d_allocations = d_allocator.allocations();
+        for (int i = 0; i < rmqa::AllocationStats::NUM_SUBSYSTEMS; ++i) {
+            d_subsystems[i] = d_stats.counts(subsystem(i));
+        }
+    }
+
+    void stop()
+    {
+        d_taken       = bsls::SystemTime::nowMonotonicClock() - d_start;
+        d_cpu         = cpuMicroseconds() - d_cpu;
+        bsls::Types::Int64 minorFaults, majorFaults;
+        pageFaults(&minorFaults, &majorFaults);
+        d_minorFaults = minorFaults - d_minorFaults;
+        d_majorFaults = majorFaults - d_majorFaults;
+        d_allocations = d_allocator.allocations() - d_allocations;
+        for (int i = 0; i < rmqa::AllocationStats::NUM_SUBSYSTEMS; ++i) {
+            const rmqa::AllocationStats::Counts counts =
+                d_stats.counts(subsystem(i));
+            d_subsystems[i].allocations =
+                counts.allocations - d_subsystems[i].allocations;
+            d_subsystems[i].bytes = counts.bytes - d_subsystems[i].bytes;
+        }
+    }
+
+    void print(int count) const
+    {
+        bsl::cout << d_name << ": " << count << " messages in "
+                  << d_taken.totalSecondsAsDouble() << "s, "
+                  << count / d_taken.totalSecondsAsDouble() << " msg/s, "
+                  << static_cast<double>(d_cpu) / count << " CPU us/msg, "
+                  << static_cast<double>(d_minorFaults + d_majorFaults) /
+                         count
+                  << " page faults/msg, "
+                  << static_cast<double>(d_allocations) / count
+                  << " allocations/msg (";
+        for (int i = 0; i < rmqa::AllocationStats::NUM_SUBSYSTEMS; ++i) {
+            bsl::cout << rmqa::AllocationStats::toString(subsystem(i)) << " "
+                      << static_cast<double>(d_subsystems[i].allocations) /
+                             count
+                      << ", ";
+        }
+        bsl::cout << "other " << static_cast<double>(other()) / count << ")"
+                  << bsl::endl;
+    }
+
+    void writeJson(bsl::ostream& os, int count) const
+    {
+        os << "    \"" << d_name << ".throughput_msg_per_s\": "
+           << count / d_taken.totalSecondsAsDouble() << ",\n"
+           << "    \"" << d_name << ".cpu_us_per_msg\": "
+           << static_cast<double>(d_cpu) / count << ",\n"
+           << "    \"" << d_name << ".minor_faults_per_msg\": "
+           << static_cast<double>(d_minorFaults) / count << ",\n"
+           << "    \"" << d_name << ".major_faults_per_msg\": "
+           << static_cast<double>(d_majorFaults) / count << ",\n"
+           << "    \"" << d_name << ".allocations_per_msg\": "
+           << static_cast<double>(d_allocations) / count << ",\n";
+        for (int i = 0; i < rmqa::AllocationStats::NUM_SUBSYSTEMS; ++i) {
+            const char* name = rmqa::AllocationStats::toString(subsystem(i));
+            os << "    \"" << d_name << ".allocations_per_msg." << name
+               << "\": "
+               << static_cast<double>(d_subsystems[i].allocations) / count
+               << ",\n"
+               << "    \"" << d_name << ".allocated_bytes_per_msg." << name
+               << "\": "
+               << static_cast<double>(d_subsystems[i].bytes) / count
+               << ",\n";
+        }
+        os << "    \"" << d_name << ".allocations_per_msg.other\": "
+           << static_cast<double>(other()) / count;
+    }
+
+  private:
+    static rmqa::AllocationStats::Subsystem subsystem(int index)
+    {
+        return static_cast<rmqa::AllocationStats::Subsystem>(index);
+    }
+
+    /// Allocations outside the subsystems the context counts, mostly rmqa
+    /// and the loopback broker. The context's counters forward to the
+    /// counting default allocator, so their allocations are in the total.
+    bsls::Types::Int64 other() const
+    {
+        bsls::Types::Int64 other = d_allocations;
+        for (int i = 0; i < rmqa::AllocationStats::NUM_SUBSYSTEMS; ++i) {
+            other -= d_subsystems[i].allocations;
+        }
+        return other;
+    }
+
+    const char* d_name;
+    const rmqio::CountingAllocator& d_allocator;
+    const rmqa::AllocationStats& d_stats;
+    bsls::TimeInterval d_start;
+    bsls::TimeInterval d_taken;
+    bsls::Types::Int64 d_cpu;
+    bsls::Types::Int64 d_minorFaults;
+    bsls::Types::Int64 d_majorFaults;
+    bsls::Types::Int64 d_allocations;
+    bsl::vector<rmqa::AllocationStats::Counts> d_subsystems;
+};
+
+/// Send to confirm latency of each publish. Confirms for a single producer
+/// arrive in publish order, so the nth confirm belongs to the nth send.
+class ConfirmLatencies {
+  public:
+    explicit ConfirmLatencies(int count)
+    : d_sent(count)
+    , d_latencies(count)
+    , d_confirmed(0)
+    {
+    }
+
+    void sent(int index) { d_sent[index] = nowMicroseconds(); }
+
+    void confirmed(const rmqt::Message&,
+                   const bsl::string&,
+                   const rmqt::ConfirmResponse&)
+    {
+        const int index = d_confirmed++;
+        if (index < static_cast<int>(d_latencies.size())) {
+            d_latencies[index] = nowMicroseconds() - d_sent[index];
+        }
+    }
+
+    void writeJson(bsl::ostream& os)
+    {
+        bsl::sort(d_latencies.begin(), d_latencies.end());
+
+        const double percentiles[] = {50, 90, 99, 99.9};
+        const char* names[]        = {"p50", "p90", "p99", "p999"};
+        for (bsl::size_t i = 0; i < sizeof(percentiles) / sizeof(double);
+             ++i) {
+            os << "    \"publish.latency_us." << names[i]
+               << "\": " << valueAt(percentiles[i]) << ",\n";
+        }
+        os << "    \"publish.latency_us.max\": "
+           << (d_latencies.empty() ? 0 : d_latencies.back());
+    }
+
+  private:
+    /// Return the latency at `percentile`, once sorted
+    bsls::Types::Int64 valueAt(double percentile) const
+    {
+        if (d_latencies.empty()) {
+            return 0;
+        }
+        const bsl::size_t index =
+            static_cast<bsl::size_t>(percentile / 100 * d_latencies.size());
+        return d_latencies[bsl::min(index, d_latencies.size() - 1)];
+    }
+
+    bsl::vector<bsls::Types::Int64> d_sent;
+    bsl::vector<bsls::Types::Int64> d_latencies;
+    bsls::AtomicInt d_confirmed;
+};
+
+void ack(rmqp::MessageGuard& guard) { guard.ack(); }
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    // Installed before anything allocates, so that every BDE allocation, by
+    // the client and by the loopback broker alike, is counted
+    static rmqio::CountingAllocator countingAllocator(
+        &bslma::NewDeleteAllocator::singleton());
+    bslma::Default::setDefaultAllocatorRaw(&countingAllocator);
+    bslma::Default::setGlobalAllocator(&countingAllocator);
+
+    int count       = 100000;
+    int messageSize = 1000;
+    int prefetch    = 100;
+    int confirms    = 100;
+    int hugePages   = 0;
+    bsl::string output;
+    bool explicitHugePages = false;
+
+    balcl::OptionInfo specTable[] = {
+        {
+            "n|count",
+            "count",
+            "Messages to publish, and to consume",
+            balcl::TypeInfo(&count),
+            balcl::OccurrenceInfo(count),
+        },
+        {
+            "s|size",
+            "size",
+            "Message size in bytes",
+            balcl::TypeInfo(&messageSize),
+            balcl::OccurrenceInfo(messageSize),
+        },
+        {
+            "q|qos",
+            "qos",
+            "Consumer prefetch count",
+            balcl::TypeInfo(&prefetch),
+            balcl::OccurrenceInfo(prefetch),
+        },
+        {
+            "c|confirms",
+            "confirms",
+            "Max outstanding confirms",
+            balcl::TypeInfo(&confirms),
+            balcl::OccurrenceInfo(confirms),
+        },
+        {
+            "huge-pages",
+            "MiB",
+            "Serve the client's I/O buffers from a region of this many MiB "
+            "backed by huge pages",
+            balcl::TypeInfo(&hugePages),
+            balcl::OccurrenceInfo(hugePages),
+        },
+        {
+            "explicit-huge-pages",
+            "explicit",
+            "Take the region from the reserved huge pages (vm.nr_hugepages)",
+            balcl::TypeInfo(&explicitHugePages),
+            balcl::OccurrenceInfo::e_OPTIONAL,
+        },
+        {
+            "o|output",
+            "output",
+            "File to write the results to, as JSON",
+            balcl::TypeInfo(&output),
+            balcl::OccurrenceInfo::e_OPTIONAL,
+        },
+    };
+    balcl::CommandLine cmdLine(specTable);
+    if (cmdLine.parse(argc, argv) || count <= 0 || hugePages < 0) {
+        cmdLine.printUsage();
+        return 1;
+    }
+
+    const rmqt::Message message(
+        bsl::make_shared<bsl::vector<uint8_t> >(messageSize, 'a'));
+
+    rmqtestutil::LoopbackBroker broker;
+    broker.setDeliveries(bsl::vector<rmqt::Message>(1, message), count);
+    if (broker.start() != 0) {
+        bsl::cerr << "Failed to start the loopback broker\n";
+        return 1;
+    }
+
+    bsl::shared_ptr<rmqa::AllocationStats> allocationStats =
+        bsl::make_shared<rmqa::AllocationStats>();
+    rmqa::RabbitContextOptions options;
+    if (hugePages > 0) {
+        // Counting by subsystem would take the region's place, so the
+        // breakdown reads 0 and only fallback allocations are in the total
+        options.setHugePageBuffers(
+            static_cast<bsl::size_t>(hugePages) * 1024 * 1024,
+            explicitHugePages);
+    }
+    else {
+        options.setAllocationStats(allocationStats);
+    }
+    rmqa::RabbitContext rabbit(options);
+    bsl::shared_ptr<rmqa::VHost> vhost = rabbit.createVHostConnection(
+        "loopback-benchmark", broker.endpoint(), broker.credentials());
+
+    rmqa::Topology topology;
+    rmqt::QueueHandle queue = topology.addQueue("loopback-benchmark");
+
+    rmqt::Result<rmqa::Producer> producerResult =
+        vhost->createProducer(topology, topology.defaultExchange(), confirms);
+    if (!producerResult) {
+        bsl::cerr << "Failed to create producer: " << producerResult.error()
+                  << "\n";
+        return 1;
+    }
+    bsl::shared_ptr<rmqa::Producer> producer = producerResult.value();
+
+    ConfirmLatencies latencies(count);
+    const rmqp::Producer::ConfirmationCallback onConfirm =
+        bdlf::BindUtil::bind(&ConfirmLatencies::confirmed,
+                             &latencies,
+                             bdlf::PlaceHolders::_1,
+                             bdlf::PlaceHolders::_2,
+                             bdlf::PlaceHolders::_3);
+
+    Phase publish("publish", countingAllocator, *allocationStats);
+    publish.start();
+    for (int i = 0; i < count; ++i) {
+        latencies.sent(i);
+        producer->send(message, "loopback-benchmark", onConfirm);
+    }
+    producer->waitForConfirms();
+    publish.stop();
+    publish.print(count);
+
+    Phase consume("consume", countingAllocator, *allocationStats);
+    consume.start();
+    rmqt::Result<rmqa::Consumer> consumerResult = vhost->createConsumer(
+        topology,
+        queue,
+        &ack,
+        rmqt::ConsumerConfig().setPrefetchCount(prefetch));
+    if (!consumerResult) {
+        bsl::cerr << "Failed to create consumer: " << consumerResult.error()
+                  << "\n";
+        return 1;
+    }
+
+    while (broker.acked() < static_cast<bsl::uint64_t>(count)) {
+        bslmt::ThreadUtil::microSleep(1000);
+    }
+    consume.stop();
+    consume.print(count);
+
+    if (!output.empty()) {
+        bsl::ofstream os(output.c_str());
+        os << "{\n"
+           << "  \"benchmark\": \"loopback\",\n"
+           << "  \"parameters\": {\"count\": " << count
+           << ", \"size\": " << messageSize << ", \"qos\": " << prefetch
+           << ", \"confirms\": " << confirms
+           << ", \"huge_pages_mib\": " << hugePages << "},\n"
+           << "  \"metrics\": {\n";
+        publish.writeJson(os, count);
+        os << ",\n";
+        latencies.writeJson(os);
+        os << ",\n";
+        consume.writeJson(os, count);
+        os << "\n  }\n}\n";
+        if (!os) {
+            bsl::cerr << "Failed to write results to " << output << "\n";
+            return 1;
+        }
+    }
+
+    return 0;
+}
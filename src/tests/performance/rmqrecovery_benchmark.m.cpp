@@ -0,0 +1,299 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures how long the client takes to recover many channels, each with
+// its own topology, after an in-process LoopbackBroker drops every
+// connection, and how many methods the recovery costs the broker. Each
+// round ends once every producer has had a message published after the drop
+// confirmed, so it covers noticing the drop, reconnecting, reopening the
+// channels, redeclaring (or checking) their topologies and resending.
+
+#include <rmqtestutil_loopbackbroker.h>
+
+#include <rmqa_producer.h>
+#include <rmqa_rabbitcontext.h>
+#include <rmqa_rabbitcontextoptions.h>
+#include <rmqa_topology.h>
+#include <rmqa_vhost.h>
+#include <rmqp_producer.h>
+#include <rmqt_confirmresponse.h>
+#include <rmqt_exchange.h>
+#include <rmqt_message.h>
+#include <rmqt_queue.h>
+
+#include <balcl_commandline.h>
+#include <bdlf_bind.h>
+#include <bdlf_placeholder.h>
+#include <bslmt_threadutil.h>
+#include <bsls_atomic.h>
+#include <bsls_systemtime.h>
+#include <bsls_timeinterval.h>
+
+#include <bsl_algorithm.h>
+#include <bsl_fstream.h>
+#include <bsl_iostream.h>
+#include <bsl_memory.h>
+#include <bsl_sstream.h>
+#include <bsl_string.h>
+#include <bsl_vector.h>
+
+using namespace BloombergLP;
+
+namespace {
+
+void countConfirm(bsls::AtomicInt* confirmed,
+                  const rmqt::Message&,
+                  const bsl::string&,
+                  const rmqt::ConfirmResponse&)
+{
+    ++*confirmed;
+}
+
+/// Recovery time and broker cost of one dropped connection
+struct Round {
+    double seconds;
+    bsl::uint64_t methods;
+    bsl::uint64_t declares;
+};
+
+bool bySeconds(const Round& lhs, const Round& rhs)
+{
+    return lhs.seconds < rhs.seconds;
+}
+
+bsl::string producerName(int producer)
+{
+    bsl::ostringstream os;
+    os << "recovery-" << producer;
+    return os.str();
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    int producers = 1000;
+    int queues    = 10;
+    int vhosts    = 1;
+    int rounds    = 5;
+    int timeout   = 120;
+    int jitterMin = 0;
+    int jitterMax = 0;
+    bsl::string cacheDirectory;
+    bsl::string output;
+
+    balcl::OptionInfo specTable[] = {
+        {
+            "p|producers",
+            "producers",
+            "Producers, each on its own channel",
+            balcl::TypeInfo(&producers),
+            balcl::OccurrenceInfo(producers),
+        },
+        {
+            "q|queues",
+            "queues",
+            "Queues declared and bound by each producer's topology",
+            balcl::TypeInfo(&queues),
+            balcl::OccurrenceInfo(queues),
+        },
+        {
+            "v|vhosts",
+            "vhosts",
+            "Connections the producers are spread across",
+            balcl::TypeInfo(&vhosts),
+            balcl::OccurrenceInfo(vhosts),
+        },
+        {
+            "r|rounds",
+            "rounds",
+            "Times to drop the connections",
+            balcl::TypeInfo(&rounds),
+            balcl::OccurrenceInfo(rounds),
+        },
+        {
+            "t|timeout",
+            "timeout",
+            "Seconds to wait for a round to recover",
+            balcl::TypeInfo(&timeout),
+            balcl::OccurrenceInfo(timeout),
+        },
+        {
+            "jitter-min-ms",
+            "jitterMin",
+            "Use jittered reconnects with this minimum wait",
+            balcl::TypeInfo(&jitterMin),
+            balcl::OccurrenceInfo(jitterMin),
+        },
+        {
+            "jitter-max-ms",
+            "jitterMax",
+            "Use jittered reconnects with this maximum wait",
+            balcl::TypeInfo(&jitterMax),
+            balcl::OccurrenceInfo(jitterMax),
+        },
+        {
+            "c|topology-cache",
+            "directory",
+            "Existing directory to cache accepted topologies in",
+            balcl::TypeInfo(&cacheDirectory),
+            balcl::OccurrenceInfo::e_OPTIONAL,
+        },
+        {
+            "o|output",
+            "output",
+            "File to write the results to, as JSON",
+            balcl::TypeInfo(&output),
+            balcl::OccurrenceInfo::e_OPTIONAL,
+        },
+    };
+    balcl::CommandLine cmdLine(specTable);
+    if (cmdLine.parse(argc, argv) || producers <= 0 || queues <= 0 ||
+        vhosts <= 0 || rounds <= 0 || jitterMin > jitterMax) {
+        cmdLine.printUsage();
+        return 1;
+    }
+
+    rmqtestutil::LoopbackBroker broker;
+    if (broker.start() != 0) {
+        bsl::cerr << "Failed to start the loopback broker\n";
+        return 1;
+    }
+
+    rmqa::RabbitContextOptions options;
+    if (jitterMax > 0) {
+        options.setJitteredReconnect(
+            bsls::TimeInterval().addMilliseconds(jitterMin),
+            bsls::TimeInterval().addMilliseconds(jitterMax));
+    }
+    if (!cacheDirectory.empty()) {
+        options.setTopologyCacheDirectory(cacheDirectory);
+    }
+    rmqa::RabbitContext rabbit(options);
+
+    bsl::vector<bsl::shared_ptr<rmqa::VHost> > connections;
+    for (int i = 0; i < vhosts; ++i) {
+        connections.push_back(rabbit.createVHostConnection(
+            producerName(i), broker.endpoint(), broker.credentials()));
+    }
+
+    const bsls::TimeInterval setupStart =
+        bsls::SystemTime::nowMonotonicClock();
+    bsl::vector<bsl::shared_ptr<rmqa::Producer> > producerList;
+    for (int p = 0; p < producers; ++p) {
+        const bsl::string name = producerName(p);
+
+        rmqa::Topology topology;
+        rmqt::ExchangeHandle exchange = topology.addExchange(name);
+        for (int q = 0; q < queues; ++q) {
+            bsl::ostringstream queueName;
+            queueName << name << "-" << q;
+            topology.bind(exchange, topology.addQueue(queueName.str()), name);
+        }
+
+        rmqt::Result<rmqa::Producer> result =
+            connections[p % vhosts]->createProducer(topology, exchange, 1);
+        if (!result) {
+            bsl::cerr << "Failed to create producer " << p << ": "
+                      << result.error() << "\n";
+            return 1;
+        }
+        producerList.push_back(result.value());
+    }
+    const double setupSeconds =
+        (bsls::SystemTime::nowMonotonicClock() - setupStart)
+            .totalSecondsAsDouble();
+    bsl::cout << "setup: " << producers << " producers with " << queues
+              << " queues each in " << setupSeconds << "s" << bsl::endl;
+
+    const rmqt::Message message(
+        bsl::make_shared<bsl::vector<uint8_t> >(16, 'a'));
+    bsls::AtomicInt confirmed(0);
+    const rmqp::Producer::ConfirmationCallback onConfirm =
+        bdlf::BindUtil::bind(&countConfirm,
+                             &confirmed,
+                             bdlf::PlaceHolders::_1,
+                             bdlf::PlaceHolders::_2,
+                             bdlf::PlaceHolders::_3);
+
+    bsl::vector<Round> results;
+    for (int r = 0; r < rounds; ++r) {
+        const bsl::uint64_t methods  = broker.methods();
+        const bsl::uint64_t declares = broker.declares();
+        const int target             = confirmed + producers;
+
+        const bsls::TimeInterval start =
+            bsls::SystemTime::nowMonotonicClock();
+        const bsls::TimeInterval deadline =
+            start + bsls::TimeInterval(timeout, 0);
+        broker.dropConnections();
+        for (int p = 0; p < producers; ++p) {
+            producerList[p]->send(message, producerName(p), onConfirm);
+        }
+        while (confirmed < target) {
+            if (bsls::SystemTime::nowMonotonicClock() > deadline) {
+                bsl::cerr << "Round " << r << " did not recover within "
+                          << timeout << "s: " << target - confirmed
+                          << " producers outstanding\n";
+                return 1;
+            }
+            bslmt::ThreadUtil::microSleep(1000);
+        }
+
+        Round round;
+        round.seconds = (bsls::SystemTime::nowMonotonicClock() - start)
+                            .totalSecondsAsDouble();
+        round.methods  = broker.methods() - methods;
+        round.declares = broker.declares() - declares;
+        results.push_back(round);
+
+        bsl::cout << "round " << r << ": recovered in " << round.seconds
+                  << "s, " << round.methods << " methods ("
+                  << round.declares << " declares and binds)" << bsl::endl;
+    }
+
+    bsl::vector<Round> sorted(results);
+    bsl::sort(sorted.begin(), sorted.end(), &bySeconds);
+    const Round& median = sorted[sorted.size() / 2];
+    bsl::cout << "recovery: median " << median.seconds << "s, max "
+              << sorted.back().seconds << "s" << bsl::endl;
+
+    if (!output.empty()) {
+        bsl::ofstream os(output.c_str());
+        os << "{\n"
+           << "  \"benchmark\": \"recovery\",\n"
+           << "  \"parameters\": {\"producers\": " << producers
+           << ", \"queues\": " << queues << ", \"vhosts\": " << vhosts
+           << ", \"rounds\": " << rounds
+           << ", \"jitter_min_ms\": " << jitterMin
+           << ", \"jitter_max_ms\": " << jitterMax
+           << ", \"topology_cache\": "
+           << (cacheDirectory.empty() ? "false" : "true") << "},\n"
+           << "  \"metrics\": {\n"
+           << "    \"setup.seconds\": " << setupSeconds << ",\n"
+           << "    \"recovery.seconds.median\": " << median.seconds << ",\n"
+           << "    \"recovery.seconds.max\": " << sorted.back().seconds
+           << ",\n"
+           << "    \"recovery.methods.median\": " << median.methods << ",\n"
+           << "    \"recovery.declares.median\": " << median.declares
+           << "\n  }\n}\n";
+        if (!os) {
+            bsl::cerr << "Failed to write results to " << output << "\n";
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,64 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_allocationstats.h>
+
+#include <bslma_testallocator.h>
+
+#include <bsl_vector.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqa;
+using namespace ::testing;
+
+TEST(AllocationStats, CountsEachSubsystemSeparately)
+{
+    bslma::TestAllocator upstream;
+    AllocationStats stats(&upstream);
+
+    {
+        bslma::Allocator* ioAllocator =
+            stats.allocator(AllocationStats::RMQIO);
+        bslma::Allocator* amqpAllocator =
+            stats.allocator(AllocationStats::RMQAMQP);
+
+        bsl::vector<char> readBlock(100, 'a', ioAllocator);
+        bsl::vector<char> frame(10, 'b', amqpAllocator);
+        bsl::vector<char> payload(20, 'c', amqpAllocator);
+        EXPECT_THAT(upstream.numBlocksInUse(), Eq(3));
+    }
+
+    const AllocationStats::Counts io = stats.counts(AllocationStats::RMQIO);
+    EXPECT_THAT(io.allocations, Eq(1));
+    EXPECT_THAT(io.bytes, Ge(100));
+
+    const AllocationStats::Counts amqp =
+        stats.counts(AllocationStats::RMQAMQP);
+    EXPECT_THAT(amqp.allocations, Eq(2));
+    EXPECT_THAT(amqp.bytes, Ge(30));
+
+    EXPECT_THAT(upstream.numBlocksInUse(), Eq(0));
+}
+
+TEST(AllocationStats, NamesSubsystems)
+{
+    EXPECT_THAT(AllocationStats::toString(AllocationStats::RMQIO),
+                StrEq("rmqio"));
+    EXPECT_THAT(AllocationStats::toString(AllocationStats::RMQAMQP),
+                StrEq("rmqamqp"));
+}
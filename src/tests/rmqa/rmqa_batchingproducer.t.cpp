@@ -0,0 +1,243 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_batchingproducer.h>
+
+#include <rmqa_messagebatchutil.h>
+#include <rmqtestmocks_mockproducer.h>
+#include <rmqtestutil_mockeventloop.t.h>
+#include <rmqtestutil_mocktimerfactory.h>
+
+#include <rmqp_producer.h>
+#include <rmqt_confirmresponse.h>
+#include <rmqt_message.h>
+#include <rmqt_properties.h>
+
+#include <bdlf_bind.h>
+#include <bdlmt_threadpool.h>
+#include <bsls_timeinterval.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <bsl_memory.h>
+#include <bsl_string.h>
+#include <bsl_vector.h>
+
+using namespace BloombergLP;
+using namespace ::testing;
+using namespace bdlf::PlaceHolders;
+
+namespace {
+
+rmqt::Message makeMessage(const bsl::string& messageId)
+{
+    return rmqt::Message(bsl::make_shared<bsl::vector<uint8_t> >(5),
+                         messageId);
+}
+
+void recordConfirm(bsl::vector<bsl::string>* confirmed,
+                   const rmqt::Message& message,
+                   const bsl::string&,
+                   const rmqt::ConfirmResponse&)
+{
+    confirmed->push_back(message.messageId());
+}
+
+} // namespace
+
+class BatchingProducerTests : public Test {
+  protected:
+    bsl::shared_ptr<rmqtestmocks::MockProducer> d_mock;
+    bsl::shared_ptr<rmqtestutil::MockTimerFactory> d_timerFactory;
+    rmqtestutil::MockEventLoop d_eventLoop;
+    bdlmt::ThreadPool d_threadPool;
+    bsl::vector<rmqt::Message> d_sent;
+    bsl::vector<bsl::string> d_routingKeys;
+    bsl::vector<rmqp::Producer::ConfirmationCallback> d_confirms;
+    bsl::vector<bsl::string> d_confirmed;
+    rmqp::Producer::ConfirmationCallback d_recordConfirm;
+
+    BatchingProducerTests()
+    : d_mock(bsl::make_shared<rmqtestmocks::MockProducer>())
+    , d_timerFactory(bsl::make_shared<rmqtestutil::MockTimerFactory>())
+    , d_eventLoop(d_timerFactory)
+    , d_threadPool(bslmt::ThreadAttributes(), 0, 5, 5)
+    , d_sent()
+    , d_routingKeys()
+    , d_confirms()
+    , d_confirmed()
+    , d_recordConfirm(
+          bdlf::BindUtil::bind(&recordConfirm, &d_confirmed, _1, _2, _3))
+    {
+        d_threadPool.start();
+    }
+
+    bsl::shared_ptr<rmqa::BatchingProducer>
+    createProducer(bsl::size_t maxMessages)
+    {
+        return bsl::make_shared<rmqa::BatchingProducer>(
+            d_mock,
+            maxMessages,
+            0,
+            bsls::TimeInterval(1),
+            bsl::ref(d_threadPool),
+            bsl::ref(d_eventLoop));
+    }
+
+    rmqp::Producer::SendStatus
+    saveSend(const rmqt::Message& message,
+             const bsl::string& routingKey,
+             rmqt::Mandatory::Value,
+             const rmqp::Producer::ConfirmationCallback& confirm,
+             const bsls::TimeInterval&)
+    {
+        return saveTrySend(message, routingKey, confirm);
+    }
+
+    rmqp::Producer::SendStatus
+    saveTrySend(const rmqt::Message& message,
+                const bsl::string& routingKey,
+                const rmqp::Producer::ConfirmationCallback& confirm)
+    {
+        d_sent.push_back(message);
+        d_routingKeys.push_back(routingKey);
+        d_confirms.push_back(confirm);
+        return rmqp::Producer::SENDING;
+    }
+
+    void confirm(bsl::size_t i)
+    {
+        d_confirms[i](d_sent[i],
+                      d_routingKeys[i],
+                      rmqt::ConfirmResponse(rmqt::ConfirmResponse::ACK));
+    }
+
+    bsl::vector<bsl::string> unpackedIds(bsl::size_t i)
+    {
+        bsl::vector<rmqt::Message> messages;
+        EXPECT_THAT(rmqa::MessageBatchUtil::unpack(&messages, d_sent[i]),
+                    Eq(0));
+
+        bsl::vector<bsl::string> ids;
+        for (bsl::size_t j = 0; j < messages.size(); ++j) {
+            ids.push_back(messages[j].messageId());
+        }
+        return ids;
+    }
+};
+
+TEST_F(BatchingProducerTests, SendsAContainerOnceFull)
+{
+    bsl::shared_ptr<rmqa::BatchingProducer> producer = createProducer(3);
+
+    EXPECT_CALL(*d_mock, trySend(_, _, _))
+        .WillOnce(Invoke(this, &BatchingProducerTests::saveTrySend));
+
+    const char* ids[] = {"a", "b", "c"};
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_THAT(producer->send(makeMessage(ids[i]),
+                                   "key",
+                                   d_recordConfirm,
+                                   bsls::TimeInterval()),
+                    Eq(rmqp::Producer::SENDING));
+    }
+
+    ASSERT_THAT(d_sent.size(), Eq(1));
+    EXPECT_TRUE(rmqa::MessageBatchUtil::isBatch(d_sent[0]));
+    EXPECT_THAT(d_routingKeys[0], Eq("key"));
+    EXPECT_THAT(unpackedIds(0), ElementsAre("a", "b", "c"));
+
+    // One confirm for the container confirms each message
+    confirm(0);
+    EXPECT_THAT(d_confirmed, ElementsAre("a", "b", "c"));
+}
+
+TEST_F(BatchingProducerTests, RoutingKeyChangeSendsHeldMessages)
+{
+    bsl::shared_ptr<rmqa::BatchingProducer> producer = createProducer(10);
+
+    EXPECT_CALL(*d_mock, send(_, _, _, _, _))
+        .WillOnce(Invoke(this, &BatchingProducerTests::saveSend));
+
+    producer->send(
+        makeMessage("a"), "key-1", d_recordConfirm, bsls::TimeInterval());
+    producer->send(
+        makeMessage("b"), "key-1", d_recordConfirm, bsls::TimeInterval());
+    EXPECT_TRUE(d_sent.empty());
+
+    producer->send(
+        makeMessage("c"), "key-2", d_recordConfirm, bsls::TimeInterval());
+    ASSERT_THAT(d_sent.size(), Eq(1));
+    EXPECT_THAT(d_routingKeys[0], Eq("key-1"));
+    EXPECT_THAT(unpackedIds(0), ElementsAre("a", "b"));
+
+    // Whatever is still held is sent on destruction
+    EXPECT_CALL(*d_mock, trySend(_, _, _))
+        .WillOnce(Invoke(this, &BatchingProducerTests::saveTrySend));
+    producer.reset();
+
+    ASSERT_THAT(d_sent.size(), Eq(2));
+    EXPECT_THAT(d_routingKeys[1], Eq("key-2"));
+}
+
+TEST_F(BatchingProducerTests, LoneMessageIsSentAsItIsAfterLingering)
+{
+    bsl::shared_ptr<rmqa::BatchingProducer> producer = createProducer(10);
+
+    EXPECT_CALL(*d_mock, trySend(_, _, _))
+        .WillOnce(Invoke(this, &BatchingProducerTests::saveTrySend));
+
+    producer->send(
+        makeMessage("a"), "key", d_recordConfirm, bsls::TimeInterval());
+    EXPECT_TRUE(d_sent.empty());
+
+    d_timerFactory->step_time(bsls::TimeInterval(1));
+    d_threadPool.drain();
+
+    ASSERT_THAT(d_sent.size(), Eq(1));
+    EXPECT_FALSE(rmqa::MessageBatchUtil::isBatch(d_sent[0]));
+    EXPECT_THAT(d_sent[0].messageId(), Eq("a"));
+
+    confirm(0);
+    EXPECT_THAT(d_confirmed, ElementsAre("a"));
+}
+
+TEST_F(BatchingProducerTests, DiscardUnroutableIsSentAfterHeldMessages)
+{
+    bsl::shared_ptr<rmqa::BatchingProducer> producer = createProducer(10);
+
+    {
+        InSequence seq;
+        EXPECT_CALL(*d_mock,
+                    send(_, _, rmqt::Mandatory::RETURN_UNROUTABLE, _, _))
+            .WillOnce(Invoke(this, &BatchingProducerTests::saveSend));
+        EXPECT_CALL(*d_mock,
+                    send(_, _, rmqt::Mandatory::DISCARD_UNROUTABLE, _, _))
+            .WillOnce(Invoke(this, &BatchingProducerTests::saveSend));
+    }
+
+    producer->send(
+        makeMessage("a"), "key", d_recordConfirm, bsls::TimeInterval());
+    producer->send(makeMessage("b"),
+                   "key",
+                   rmqt::Mandatory::DISCARD_UNROUTABLE,
+                   d_recordConfirm,
+                   bsls::TimeInterval());
+
+    ASSERT_THAT(d_sent.size(), Eq(2));
+    EXPECT_THAT(d_sent[0].messageId(), Eq("a"));
+    EXPECT_THAT(d_sent[1].messageId(), Eq("b"));
+}
@@ -82,7 +82,7 @@ class MockConnection : public rmqamqp::Connection {
           bsl::make_shared<rmqtestutil::MockSendChannel>(retryHandler))
     {
 
-        ON_CALL(*this, createTopologySyncedSendChannel(_, _, _))
+        ON_CALL(*this, createTopologySyncedSendChannel(_, _, _, _))
             .WillByDefault(Return(rmqt::Future<rmqamqp::SendChannel>(
                 rmqt::Result<rmqamqp::SendChannel>(d_sendChannel))));
 
@@ -98,11 +98,12 @@ class MockConnection : public rmqamqp::Connection {
                      const bsl::shared_ptr<rmqio::RetryHandler>&,
                      const bsl::shared_ptr<rmqt::ConsumerAckQueue>&));
 
-    MOCK_METHOD3(createTopologySyncedSendChannel,
+    MOCK_METHOD4(createTopologySyncedSendChannel,
                  rmqt::Future<rmqamqp::SendChannel>(
                      const rmqt::Topology& topology,
                      const bsl::shared_ptr<rmqt::Exchange>& exchange,
-                     const bsl::shared_ptr<rmqio::RetryHandler>& retryHandler));
+                     const bsl::shared_ptr<rmqio::RetryHandler>& retryHandler,
+                     rmqt::PublisherConfirms::Value confirms));
 
     MOCK_METHOD1(close, void(const rmqamqp::Connection::CloseFinishCallback&));
 };
@@ -297,6 +298,78 @@ TEST_F(ConnectionTests, CreateProducer)
     EXPECT_TRUE(result);
 }
 
+MATCHER_P(OnlyPassivelyDeclares, name, "")
+{
+    return arg.queues.size() + arg.exchanges.size() == 1 &&
+           arg.queueBindings.empty() && arg.exchangeBindings.empty() &&
+           (arg.queues.empty() ? arg.exchanges[0]->name() == name &&
+                                     arg.exchanges[0]->passive()
+                               : arg.queues[0]->name() == name &&
+                                     arg.queues[0]->passive());
+}
+
+TEST_F(ConnectionTests, VerifyUsedOnlyPassivelyDeclaresWhatIsUsed)
+{
+    // Given
+    bsl::shared_ptr<MockConnection> mockCon = createMockConnection();
+    bsl::shared_ptr<rmqp::Connection> connection(
+        rmqa::ConnectionImpl::make(mockCon,
+                                   d_eventLoop,
+                                   d_threadPool,
+                                   d_onError,
+                                   d_onSuccess,
+                                   d_endpoint,
+                                   d_tunables,
+                                   d_consumerFactory,
+                                   d_producerFactory));
+    d_topology.bind(d_exchange, d_queue, "key");
+    d_topology.setDeclareMode(rmqt::Topology::VERIFY_USED);
+
+    EXPECT_CALL(*mockCon,
+                createTopologySyncedSendChannel(
+                    OnlyPassivelyDeclares(bsl::string("exchange")), _, _, _));
+    EXPECT_CALL(*mockCon,
+                createTopologySyncedReceiveChannel(
+                    OnlyPassivelyDeclares(bsl::string("queue")), _, _, _));
+
+    d_eventLoop.start();
+    // When
+    EXPECT_TRUE(connection->createProducer(
+        d_topology.topology(), d_exchange, d_maxOutstandingConfirms));
+    EXPECT_TRUE(connection->createConsumer(
+        d_topology.topology(), d_queue, d_onMessage, d_consumerConfig));
+}
+
+TEST_F(ConnectionTests, SkipDeclareDeclaresNothing)
+{
+    // Given
+    bsl::shared_ptr<MockConnection> mockCon = createMockConnection();
+    bsl::shared_ptr<rmqp::Connection> connection(
+        rmqa::ConnectionImpl::make(mockCon,
+                                   d_eventLoop,
+                                   d_threadPool,
+                                   d_onError,
+                                   d_onSuccess,
+                                   d_endpoint,
+                                   d_tunables,
+                                   d_consumerFactory,
+                                   d_producerFactory));
+    d_topology.bind(d_exchange, d_queue, "key");
+    d_topology.setDeclareMode(rmqt::Topology::SKIP_DECLARE);
+
+    EXPECT_CALL(*mockCon,
+                createTopologySyncedSendChannel(
+                    AllOf(Field(&rmqt::Topology::exchanges, IsEmpty()),
+                          Field(&rmqt::Topology::queueBindings, IsEmpty())),
+                    _,
+                    _,
+                    _));
+
+    // When
+    EXPECT_TRUE(connection->createProducer(
+        d_topology.topology(), d_exchange, d_maxOutstandingConfirms));
+}
+
 TEST_F(ConnectionTests, CloseCreatesTimerAndInvokesClose)
 {
     bsl::shared_ptr<MockConnection> mockCon = createMockConnection();
@@ -20,6 +20,7 @@
 #include <rmqamqp_messagestore.h>
 #include <rmqt_message.h>
 #include <rmqtestutil_mockchannel.t.h>
+#include <rmqtestutil_mockmetricpublisher.h>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -39,6 +40,70 @@ class MockCallback {
     MOCK_METHOD1(cb, void(const rmqamqp::MessageStore<rmqt::Message>::Entry&));
 };
 
+/// Invokes the visitor passed to `visitNewlyHungMessages` for each entry
+class VisitEntries {
+  public:
+    explicit VisitEntries(
+        const rmqamqp::MessageStore<rmqt::Message>::MessageList& entries)
+    : d_entries(entries)
+    {
+    }
+
+    bsl::size_t operator()(
+        const bdlt::Datetime&,
+        const rmqamqp::MessageStore<rmqt::Message>::MessageVisitor& visitor)
+        const
+    {
+        for (rmqamqp::MessageStore<rmqt::Message>::MessageList::const_iterator
+                 it = d_entries.begin();
+             it != d_entries.end();
+             ++it) {
+            visitor(it->first, it->second);
+        }
+        return d_entries.size();
+    }
+
+  private:
+    rmqamqp::MessageStore<rmqt::Message>::MessageList d_entries;
+};
+
+/// Passes each entry to the filter given to `requeueMessagesOlderThan`,
+/// expecting it to accept `expected` of them
+class FilterEntries {
+  public:
+    FilterEntries(
+        const rmqamqp::MessageStore<rmqt::Message>::MessageList& entries,
+        bsl::size_t expected)
+    : d_entries(entries)
+    , d_expected(expected)
+    {
+    }
+
+    bsl::size_t
+    operator()(const bdlt::Datetime&,
+               const rmqamqp::ReceiveChannel::ExpiryFilter& filter) const
+    {
+        bsl::size_t accepted = 0;
+        for (rmqamqp::MessageStore<rmqt::Message>::MessageList::const_iterator
+                 it = d_entries.begin();
+             it != d_entries.end();
+             ++it) {
+            accepted += filter(*it) ? 1 : 0;
+        }
+        EXPECT_THAT(accepted, Eq(d_expected));
+        return accepted;
+    }
+
+  private:
+    rmqamqp::MessageStore<rmqt::Message>::MessageList d_entries;
+    bsl::size_t d_expected;
+};
+
+bool olderThan90Seconds(const rmqt::Message&, const bsls::TimeInterval& age)
+{
+    return age >= bsls::TimeInterval(90);
+}
+
 class MockConnection : public rmqamqp::ChannelContainer {
   public:
     MOCK_CONST_METHOD0(channelMap, const rmqamqp::ChannelMap&());
@@ -108,8 +173,8 @@ TEST_F(ConnectionMonitorTests, HungMessage)
 
     EXPECT_CALL(*d_connection, channelMap())
         .WillRepeatedly(ReturnRef(d_channelMap));
-    EXPECT_CALL(*d_channel, getMessagesOlderThan(_))
-        .WillOnce(Return(d_messageVector));
+    EXPECT_CALL(*d_channel, visitNewlyHungMessages(_, _))
+        .WillOnce(Invoke(VisitEntries(d_messageVector)));
     EXPECT_CALL(d_cb, cb(d_entry));
 
     s_time += d_timeout;
@@ -124,8 +189,8 @@ TEST_F(ConnectionMonitorTests, MessageNotYetHung)
 
     EXPECT_CALL(*d_connection, channelMap())
         .WillRepeatedly(ReturnRef(d_channelMap));
-    EXPECT_CALL(*d_channel, getMessagesOlderThan(_))
-        .WillRepeatedly(Return(d_messageVector));
+    EXPECT_CALL(*d_channel, visitNewlyHungMessages(_, _))
+        .WillRepeatedly(Invoke(VisitEntries(d_messageVector)));
     EXPECT_CALL(d_cb, cb(_)).Times(0);
 
     bsls::TimeInterval notYet = d_timeout - bsls::TimeInterval(1);
@@ -142,8 +207,8 @@ TEST_F(ConnectionMonitorTests, HungMessageTwice)
 
     EXPECT_CALL(*d_connection, channelMap())
         .WillRepeatedly(ReturnRef(d_channelMap));
-    EXPECT_CALL(*d_channel, getMessagesOlderThan(_))
-        .WillOnce(Return(d_messageVector));
+    EXPECT_CALL(*d_channel, visitNewlyHungMessages(_, _))
+        .WillOnce(Invoke(VisitEntries(d_messageVector)));
     EXPECT_CALL(d_cb, cb(d_entry));
 
     s_time += d_timeout;
@@ -152,8 +217,8 @@ TEST_F(ConnectionMonitorTests, HungMessageTwice)
     Mock::VerifyAndClearExpectations(&d_channel);
     Mock::VerifyAndClearExpectations(&d_cb);
 
-    EXPECT_CALL(*d_channel, getMessagesOlderThan(_))
-        .WillOnce(Return(d_messageVector));
+    EXPECT_CALL(*d_channel, visitNewlyHungMessages(_, _))
+        .WillOnce(Invoke(VisitEntries(d_messageVector)));
     EXPECT_CALL(d_cb, cb(d_entry));
 
     s_time += d_timeout;
@@ -169,8 +234,8 @@ TEST_F(ConnectionMonitorTests, ConnectionExpired)
 
     EXPECT_CALL(*d_connection, channelMap())
         .WillRepeatedly(ReturnRef(d_channelMap));
-    EXPECT_CALL(*d_channel, getMessagesOlderThan(_))
-        .WillOnce(Return(d_messageVector));
+    EXPECT_CALL(*d_channel, visitNewlyHungMessages(_, _))
+        .WillOnce(Invoke(VisitEntries(d_messageVector)));
     EXPECT_CALL(d_cb, cb(d_entry));
 
     s_time += d_timeout;
@@ -188,6 +253,88 @@ TEST_F(ConnectionMonitorTests, ConnectionExpired)
     d_monitor->run();
 }
 
+TEST_F(ConnectionMonitorTests, PublishesHungMessagesPerVHost)
+{
+    bsl::shared_ptr<rmqtestutil::MockMetricPublisher> metricPublisher =
+        bsl::make_shared<rmqtestutil::MockMetricPublisher>();
+    d_monitor->setMetricPublisher(metricPublisher);
+
+    d_channelMap.associateChannel(
+        1, bsl::shared_ptr<rmqamqp::ReceiveChannel>(d_channel));
+    d_monitor->addConnection(d_connection);
+
+    EXPECT_CALL(*d_connection, channelMap())
+        .WillRepeatedly(ReturnRef(d_channelMap));
+    EXPECT_CALL(*d_channel, visitNewlyHungMessages(_, _)).WillOnce(Return(3));
+
+    bsl::vector<bsl::pair<bsl::string, bsl::string> > tags;
+    tags.push_back(bsl::make_pair(bsl::string("rmqVhostName"),
+                                  bsl::string("blankvhost")));
+    EXPECT_CALL(*metricPublisher,
+                publishGauge(bsl::string("hung_messages"), 3, tags));
+
+    s_time += d_timeout;
+    d_monitor->run();
+}
+
+TEST_F(ConnectionMonitorTests, PublishesChannelMetricsWhenEnabled)
+{
+    d_channelMap.associateChannel(
+        1, bsl::shared_ptr<rmqamqp::ReceiveChannel>(d_channel));
+    d_monitor->addConnection(d_connection);
+
+    EXPECT_CALL(*d_connection, channelMap())
+        .WillRepeatedly(ReturnRef(d_channelMap));
+    EXPECT_CALL(*d_channel, visitNewlyHungMessages(_, _))
+        .WillRepeatedly(Return(0));
+
+    EXPECT_CALL(*d_channel, publishChannelMetrics()).Times(0);
+    d_monitor->run();
+    Mock::VerifyAndClearExpectations(&*d_channel);
+
+    d_monitor->setChannelMetrics(true);
+    EXPECT_CALL(*d_channel, visitNewlyHungMessages(_, _))
+        .WillRepeatedly(Return(0));
+    EXPECT_CALL(*d_channel, publishChannelMetrics()).Times(1);
+    d_monitor->run();
+}
+
+TEST_F(ConnectionMonitorTests, AckDeadlineRequeuesThroughCallback)
+{
+    d_messageVector.push_back(d_entry);
+    d_channelMap.associateChannel(
+        1, bsl::shared_ptr<rmqamqp::ReceiveChannel>(d_channel));
+    d_monitor->addConnection(d_connection);
+
+    EXPECT_CALL(*d_connection, channelMap())
+        .WillRepeatedly(ReturnRef(d_channelMap));
+    EXPECT_CALL(*d_channel, visitNewlyHungMessages(_, _))
+        .WillRepeatedly(Return(0));
+
+    // Off by default
+    EXPECT_CALL(*d_channel, requeueMessagesOlderThan(_, _)).Times(0);
+    s_time += bsls::TimeInterval(60);
+    d_monitor->run();
+    Mock::VerifyAndClearExpectations(&*d_channel);
+
+    d_monitor->setAckDeadline(bsls::TimeInterval(30), &olderThan90Seconds);
+    EXPECT_CALL(*d_channel, visitNewlyHungMessages(_, _))
+        .WillRepeatedly(Return(0));
+
+    EXPECT_CALL(*d_channel,
+                requeueMessagesOlderThan(bdlt::Datetime(1970, 1, 1, 0, 0, 30),
+                                         _))
+        .WillOnce(Invoke(FilterEntries(d_messageVector, 0)));
+    d_monitor->run();
+
+    EXPECT_CALL(*d_channel,
+                requeueMessagesOlderThan(bdlt::Datetime(1970, 1, 1, 0, 1, 0),
+                                         _))
+        .WillOnce(Invoke(FilterEntries(d_messageVector, 1)));
+    s_time += bsls::TimeInterval(30);
+    d_monitor->run();
+}
+
 TEST_F(ConnectionMonitorTests, FetchConnectionInfo)
 {
     EXPECT_EQ(d_monitor->fetchAliveConnectionInfo()
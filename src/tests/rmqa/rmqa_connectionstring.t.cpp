@@ -15,6 +15,10 @@
 
 #include <rmqa_connectionstring.h>
 
+#include <rmqt_endpoint.h>
+#include <rmqt_vhostinfo.h>
+
+#include <bsl_optional.h>
 #include <bsl_string.h>
 
 #include <gmock/gmock.h>
@@ -105,3 +109,22 @@ const ConnectionStringTestCase k_CONN_STRING_TESTS[] = {
 INSTANTIATE_TEST_CASE_P(ConnectionStringTests,
                         ConnectionStringPTests,
                         testing::ValuesIn(k_CONN_STRING_TESTS));
+
+TEST(ConnectionStringTests, ParsesMultipleHosts)
+{
+    bsl::optional<rmqt::VHostInfo> info =
+        ConnectionString::parse("amqp://u:p@rabbit1:5673,rabbit2,rabbit3:1/vh");
+    ASSERT_TRUE(info);
+
+    const rmqt::Endpoint::HostList hosts = info->endpoint()->hosts();
+    ASSERT_EQ(3u, hosts.size());
+    EXPECT_EQ(rmqt::Endpoint::Host("rabbit1", 5673), hosts[0]);
+    EXPECT_EQ(rmqt::Endpoint::Host("rabbit2", 5672), hosts[1]);
+    EXPECT_EQ(rmqt::Endpoint::Host("rabbit3", 1), hosts[2]);
+    EXPECT_EQ("vh", info->endpoint()->vhost());
+}
+
+TEST(ConnectionStringTests, RejectsEmptyHostInList)
+{
+    EXPECT_FALSE(ConnectionString::parse("amqp://rabbit1,,rabbit2/vh"));
+}
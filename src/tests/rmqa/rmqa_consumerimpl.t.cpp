@@ -16,26 +16,36 @@
 #include <rmqa_consumerimpl.h>
 #include <rmqa_tracingconsumerimpl.h>
 
+#include <rmqa_messagebatchutil.h>
 #include <rmqa_messageguard.h>
 
 #include <rmqp_consumertracing.h>
 
 #include <rmqtestutil_mockchannel.t.h>
 #include <rmqtestutil_mockeventloop.t.h>
+#include <rmqtestutil_mocktimerfactory.h>
 #include <rmqtestutil_savethreadid.h>
 
-#include <rmqt_consumerackbatch.h>
+#include <rmqt_consumerackqueue.h>
 #include <rmqt_envelope.h>
+#include <rmqt_fieldvalue.h>
+#include <rmqt_properties.h>
 #include <rmqt_queue.h>
 #include <rmqt_simpleendpoint.h>
 
 #include <bdlf_bind.h>
+#include <bdlt_datetime.h>
+#include <bslmt_lockguard.h>
+#include <bslmt_mutex.h>
 #include <bslmt_threadutil.h>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <bsl_algorithm.h>
+#include <bsl_map.h>
 #include <bsl_memory.h>
+#include <bsl_string.h>
 #include <bsl_vector.h>
 
 using namespace BloombergLP;
@@ -55,6 +65,11 @@ class MockConsumerCallback : public ConsumerCallback {
     MOCK_METHOD1(onMessage, void(rmqp::MessageGuard&));
 };
 
+class MockBatchConsumerCallback {
+  public:
+    MOCK_METHOD1(onBatch, void(const bsl::vector<rmqp::MessageGuard*>&));
+};
+
 class MockConsumerTracing : public rmqp::ConsumerTracing {
   public:
     struct MockContext : rmqp::ConsumerTracing::Context {};
@@ -96,8 +111,36 @@ struct MessageHolder : public rmqamqp::Message {
     }
 };
 
+/// Records the delivery tags seen for each routing key
+struct DeliveriesByKey {
+    bslmt::Mutex mutex;
+    bsl::map<bsl::string, bsl::vector<uint64_t> > tags;
+};
+
+void recordDelivery(DeliveriesByKey* deliveries, rmqp::MessageGuard& guard)
+{
+    // Gives lanes sharing the pool a chance to overtake one another
+    bslmt::ThreadUtil::yield();
+
+    bslmt::LockGuard<bslmt::Mutex> lock(&deliveries->mutex);
+    deliveries->tags[guard.envelope().routingKey()].push_back(
+        guard.envelope().deliveryTag());
+}
+
+bool isWanted(const rmqt::Message&, const rmqt::Envelope& envelope)
+{
+    return envelope.routingKey() == "wanted";
+}
+
 ACTION(CallAckOnMessageGuard) { arg0.ack(); }
+ACTION(CallNackOnMessageGuard) { arg0.nack(); }
 ACTION(ExecuteItem) { arg0(); }
+ACTION(AckBatch)
+{
+    for (bsl::size_t i = 0; i < arg0.size(); ++i) {
+        arg0[i]->ack();
+    }
+}
 } // namespace
 
 class ConsumerImplTests : public TestWithParam<ConsumerType> {
@@ -213,6 +256,86 @@ TEST_P(ConsumerImplTests, MessageTriggersClientCallback)
     EXPECT_THAT(threadid, Ne(bslmt::ThreadUtil::selfIdAsInt()));
 }
 
+TEST_P(ConsumerImplTests, InlineDispatchRunsCallbackOnEventLoopThread)
+{
+    rmqamqp::ReceiveChannel::MessageCallback injectMessage;
+    EXPECT_CALL(*d_channel, consume(_, _, _))
+        .WillOnce(DoAll(SaveArg<1>(&injectMessage), Return(rmqt::Result<>())));
+
+    bsl::shared_ptr<rmqa::ConsumerImpl> consumer =
+        d_factory->create(d_channel,
+                          bsl::ref(d_queue),
+                          d_callback,
+                          d_consumerTag,
+                          bsl::ref(d_threadPool),
+                          bsl::ref(d_eventLoop),
+                          d_ackQueue);
+    consumer->setInlineDispatch();
+    consumer->start();
+
+    rmqt::Message message(bsl::make_shared<bsl::vector<uint8_t> >(5));
+
+    uint64_t threadid = 0;
+
+    // Invoked before injectMessage returns, with no threadpool job
+    EXPECT_CALL(d_mockCallback, onMessage(_))
+        .WillOnce(Invoke(bdlf::BindUtil::bind(&rmqtestutil::saveThreadId,
+                                              bsl::ref(threadid))));
+
+    injectMessage(
+        message,
+        rmqt::Envelope(0, 0, "consumerTag", "exchange", "routing-key", false));
+
+    EXPECT_THAT(threadid, Eq(bslmt::ThreadUtil::selfIdAsInt()));
+
+    d_threadPool.stop();
+}
+
+TEST_P(ConsumerImplTests, PartitionedDispatchKeepsOrderPerKey)
+{
+    rmqamqp::ReceiveChannel::MessageCallback injectMessage;
+    EXPECT_CALL(*d_channel, consume(_, _, _))
+        .WillOnce(DoAll(SaveArg<1>(&injectMessage), Return(rmqt::Result<>())));
+
+    bsl::shared_ptr<rmqa::ConsumerImpl> consumer =
+        d_factory->create(d_channel,
+                          bsl::ref(d_queue),
+                          d_callback,
+                          d_consumerTag,
+                          bsl::ref(d_threadPool),
+                          bsl::ref(d_eventLoop),
+                          d_ackQueue);
+    consumer->setPartitionedDispatch(
+        4, 64, rmqt::ConsumerConfig::PartitionKeyFunc());
+    consumer->start();
+
+    DeliveriesByKey deliveries;
+    EXPECT_CALL(d_mockCallback, onMessage(_))
+        .Times(60)
+        .WillRepeatedly(Invoke(
+            bdlf::BindUtil::bind(&recordDelivery, &deliveries, _1)));
+
+    const char* keys[] = {"key-a", "key-b", "key-c"};
+    for (uint64_t tag = 1; tag <= 60; ++tag) {
+        injectMessage(rmqt::Message(bsl::make_shared<bsl::vector<uint8_t> >(5)),
+                      rmqt::Envelope(
+                          tag, 0, "consumerTag", "exchange", keys[tag % 3], 0));
+    }
+
+    d_threadPool.stop();
+
+    ASSERT_THAT(deliveries.tags.size(), Eq(3));
+    for (bsl::map<bsl::string, bsl::vector<uint64_t> >::const_iterator it =
+             deliveries.tags.begin();
+         it != deliveries.tags.end();
+         ++it) {
+        bsl::vector<uint64_t> inOrder(it->second);
+        bsl::sort(inOrder.begin(), inOrder.end());
+        EXPECT_THAT(it->second, ContainerEq(inOrder)) << it->first;
+        EXPECT_THAT(it->second.size(), Eq(20));
+    }
+}
+
 TEST_P(ConsumerImplTests, MessageTriggersChannelAck)
 {
     rmqamqp::ReceiveChannel::MessageCallback injectMessage;
@@ -253,6 +376,102 @@ TEST_P(ConsumerImplTests, MessageTriggersChannelAck)
     d_threadPool.stop();
 }
 
+TEST_P(ConsumerImplTests, PreFilterSettlesMessagesOnEventLoop)
+{
+    rmqamqp::ReceiveChannel::MessageCallback injectMessage;
+    EXPECT_CALL(*d_channel, consume(_, _, _))
+        .WillOnce(DoAll(SaveArg<1>(&injectMessage), Return(rmqt::Result<>())));
+    EXPECT_CALL(*d_channel, consumeAckBatchFromQueue()).Times(AnyNumber());
+
+    bsl::shared_ptr<rmqa::ConsumerImpl> consumer =
+        d_factory->create(d_channel,
+                          bsl::ref(d_queue),
+                          d_callback,
+                          d_consumerTag,
+                          bsl::ref(d_threadPool),
+                          bsl::ref(d_eventLoop),
+                          d_ackQueue);
+    consumer->setPreFilter(&isWanted, true);
+    consumer->start();
+
+    EXPECT_CALL(d_mockCallback, onMessage(_))
+        .WillOnce(CallAckOnMessageGuard());
+
+    injectMessage(
+        rmqt::Message(bsl::make_shared<bsl::vector<uint8_t> >(5)),
+        rmqt::Envelope(1, 0, "consumerTag", "exchange", "unwanted", false));
+    injectMessage(
+        rmqt::Message(bsl::make_shared<bsl::vector<uint8_t> >(5)),
+        rmqt::Envelope(2, 0, "consumerTag", "exchange", "wanted", false));
+
+    d_threadPool.stop();
+
+    // The filtered message is rejected without reaching the callback
+    bsl::vector<rmqt::ConsumerAck> acks;
+    d_ackQueue->drain(&acks);
+    ASSERT_THAT(acks.size(), Eq(2));
+    EXPECT_THAT(acks[0].envelope().deliveryTag(), Eq(1));
+    EXPECT_THAT(acks[0].type(), Eq(rmqt::ConsumerAck::REJECT));
+    EXPECT_THAT(acks[1].envelope().deliveryTag(), Eq(2));
+    EXPECT_THAT(acks[1].type(), Eq(rmqt::ConsumerAck::ACK));
+}
+
+TEST_P(ConsumerImplTests, StaleMessagesAreSettledOnEventLoop)
+{
+    rmqamqp::ReceiveChannel::MessageCallback injectMessage;
+    EXPECT_CALL(*d_channel, consume(_, _, _))
+        .WillOnce(DoAll(SaveArg<1>(&injectMessage), Return(rmqt::Result<>())));
+    EXPECT_CALL(*d_channel, consumeAckBatchFromQueue()).Times(AnyNumber());
+
+    bsl::shared_ptr<rmqa::ConsumerImpl> consumer =
+        d_factory->create(d_channel,
+                          bsl::ref(d_queue),
+                          d_callback,
+                          d_consumerTag,
+                          bsl::ref(d_threadPool),
+                          bsl::ref(d_eventLoop),
+                          d_ackQueue);
+    consumer->setStaleMessagePolicy(rmqt::StaleMessagePolicy::DEAD_LETTER,
+                                    "deadline");
+    consumer->start();
+
+    EXPECT_CALL(d_mockCallback, onMessage(_))
+        .WillOnce(CallAckOnMessageGuard());
+
+    // Expired by its properties
+    rmqt::Properties expired;
+    expired.timestamp  = bdlt::Datetime(2020, 1, 1);
+    expired.expiration = bsl::string("60000");
+    injectMessage(
+        rmqt::Message(bsl::make_shared<bsl::vector<uint8_t> >(5), expired),
+        rmqt::Envelope(1, 0, "consumerTag", "exchange", "routing-key", false));
+
+    // Past its deadline header
+    bsl::shared_ptr<rmqt::FieldTable> headers =
+        bsl::make_shared<rmqt::FieldTable>();
+    (*headers)["deadline"] = rmqt::FieldValue(bdlt::Datetime(2020, 1, 1));
+    injectMessage(
+        rmqt::Message(bsl::make_shared<bsl::vector<uint8_t> >(5), "", headers),
+        rmqt::Envelope(2, 0, "consumerTag", "exchange", "routing-key", false));
+
+    // No deadline at all
+    injectMessage(
+        rmqt::Message(bsl::make_shared<bsl::vector<uint8_t> >(5)),
+        rmqt::Envelope(3, 0, "consumerTag", "exchange", "routing-key", false));
+
+    d_threadPool.stop();
+
+    bsl::vector<rmqt::ConsumerAck> acks;
+    d_ackQueue->drain(&acks);
+    ASSERT_THAT(acks.size(), Eq(3));
+    EXPECT_THAT(acks[0].envelope().deliveryTag(), Eq(1));
+    EXPECT_THAT(acks[0].type(), Eq(rmqt::ConsumerAck::REJECT));
+    EXPECT_THAT(acks[1].envelope().deliveryTag(), Eq(2));
+    EXPECT_THAT(acks[1].type(), Eq(rmqt::ConsumerAck::REJECT));
+    EXPECT_THAT(acks[2].envelope().deliveryTag(), Eq(3));
+    EXPECT_THAT(acks[2].type(), Eq(rmqt::ConsumerAck::ACK));
+}
+
 TEST_P(ConsumerImplTests, Cancel)
 {
     rmqt::Future<>::Pair fakeyCancelFuture = rmqt::Future<>::make();
@@ -449,6 +668,137 @@ TEST_P(ConsumerImplTests, UpdateCallbackFromTwoThreadsAtOnce)
     EXPECT_TRUE(future2.blockResult());
 }
 
+TEST_P(ConsumerImplTests, BatchDeliveredWhenFull)
+{
+    bsl::shared_ptr<rmqtestutil::MockTimerFactory> timerFactory =
+        bsl::make_shared<rmqtestutil::MockTimerFactory>();
+    rmqtestutil::MockEventLoop eventLoop(timerFactory);
+    EXPECT_CALL(eventLoop, timerFactory()).Times(AnyNumber());
+
+    rmqamqp::ReceiveChannel::MessageCallback injectMessage;
+    EXPECT_CALL(*d_channel, consume(_, _, _))
+        .WillOnce(DoAll(SaveArg<1>(&injectMessage), Return(rmqt::Result<>())));
+    EXPECT_CALL(*d_channel, consumeAckBatchFromQueue()).Times(AnyNumber());
+
+    MockBatchConsumerCallback batchCallback;
+    bsl::shared_ptr<rmqa::ConsumerImpl> consumer =
+        d_factory->create(d_channel,
+                          bsl::ref(d_queue),
+                          bsl::shared_ptr<rmqp::Consumer::ConsumerFunc>(),
+                          d_consumerTag,
+                          bsl::ref(d_threadPool),
+                          bsl::ref(eventLoop),
+                          d_ackQueue);
+    consumer->setBatchConsumer(
+        bsl::make_shared<rmqp::Consumer::BatchConsumerFunc>(
+            bdlf::BindUtil::bind(
+                &MockBatchConsumerCallback::onBatch, &batchCallback, _1)),
+        2,
+        bsls::TimeInterval(10));
+    consumer->start();
+
+    EXPECT_CALL(batchCallback, onBatch(SizeIs(2))).WillOnce(AckBatch());
+
+    rmqt::Message message(bsl::make_shared<bsl::vector<uint8_t> >(5));
+    injectMessage(
+        message,
+        rmqt::Envelope(1, 0, "consumerTag", "exchange", "routing-key", false));
+    injectMessage(
+        message,
+        rmqt::Envelope(2, 0, "consumerTag", "exchange", "routing-key", false));
+
+    d_threadPool.stop();
+}
+
+TEST_P(ConsumerImplTests, PartialBatchDeliveredAfterLinger)
+{
+    bsl::shared_ptr<rmqtestutil::MockTimerFactory> timerFactory =
+        bsl::make_shared<rmqtestutil::MockTimerFactory>();
+    rmqtestutil::MockEventLoop eventLoop(timerFactory);
+    EXPECT_CALL(eventLoop, timerFactory()).Times(AnyNumber());
+
+    rmqamqp::ReceiveChannel::MessageCallback injectMessage;
+    EXPECT_CALL(*d_channel, consume(_, _, _))
+        .WillOnce(DoAll(SaveArg<1>(&injectMessage), Return(rmqt::Result<>())));
+    EXPECT_CALL(*d_channel, consumeAckBatchFromQueue()).Times(AnyNumber());
+
+    StrictMock<MockBatchConsumerCallback> batchCallback;
+    bsl::shared_ptr<rmqa::ConsumerImpl> consumer =
+        d_factory->create(d_channel,
+                          bsl::ref(d_queue),
+                          bsl::shared_ptr<rmqp::Consumer::ConsumerFunc>(),
+                          d_consumerTag,
+                          bsl::ref(d_threadPool),
+                          bsl::ref(eventLoop),
+                          d_ackQueue);
+    consumer->setBatchConsumer(
+        bsl::make_shared<rmqp::Consumer::BatchConsumerFunc>(
+            bdlf::BindUtil::bind(
+                &MockBatchConsumerCallback::onBatch, &batchCallback, _1)),
+        10,
+        bsls::TimeInterval(1));
+    consumer->start();
+
+    rmqt::Message message(bsl::make_shared<bsl::vector<uint8_t> >(5));
+    injectMessage(
+        message,
+        rmqt::Envelope(1, 0, "consumerTag", "exchange", "routing-key", false));
+
+    // The batch is only handed to the threadpool once the linger time passes
+    EXPECT_CALL(batchCallback, onBatch(SizeIs(1))).WillOnce(AckBatch());
+    timerFactory->step_time(bsls::TimeInterval(1));
+
+    d_threadPool.stop();
+}
+
+TEST_P(ConsumerImplTests, BatchContainerIsDeliveredMessageByMessage)
+{
+    rmqamqp::ReceiveChannel::MessageCallback injectMessage;
+    EXPECT_CALL(*d_channel, consume(_, _, _))
+        .WillOnce(DoAll(SaveArg<1>(&injectMessage), Return(rmqt::Result<>())));
+    EXPECT_CALL(*d_channel, consumeAckBatchFromQueue()).Times(AnyNumber());
+
+    bsl::shared_ptr<rmqa::ConsumerImpl> consumer =
+        d_factory->create(d_channel,
+                          bsl::ref(d_queue),
+                          d_callback,
+                          d_consumerTag,
+                          bsl::ref(d_threadPool),
+                          bsl::ref(d_eventLoop),
+                          d_ackQueue);
+    consumer->start();
+
+    bsl::vector<rmqt::Message> messages;
+    messages.push_back(
+        rmqt::Message(bsl::make_shared<bsl::vector<uint8_t> >(5), "a"));
+    messages.push_back(
+        rmqt::Message(bsl::make_shared<bsl::vector<uint8_t> >(5), "b"));
+
+    EXPECT_CALL(d_mockCallback,
+                onMessage(Property(&rmqp::MessageGuard::message,
+                                   Property(&rmqt::Message::messageId,
+                                            Eq("a")))))
+        .WillOnce(CallAckOnMessageGuard());
+    EXPECT_CALL(d_mockCallback,
+                onMessage(Property(&rmqp::MessageGuard::message,
+                                   Property(&rmqt::Message::messageId,
+                                            Eq("b")))))
+        .WillOnce(CallNackOnMessageGuard());
+
+    injectMessage(
+        rmqa::MessageBatchUtil::pack(messages),
+        rmqt::Envelope(7, 0, "consumerTag", "exchange", "routing-key", false));
+
+    d_threadPool.stop();
+
+    // One nack requeues the whole container
+    bsl::vector<rmqt::ConsumerAck> acks;
+    d_ackQueue->drain(&acks);
+    ASSERT_THAT(acks.size(), Eq(1));
+    EXPECT_THAT(acks[0].envelope().deliveryTag(), Eq(7));
+    EXPECT_THAT(acks[0].type(), Eq(rmqt::ConsumerAck::REQUEUE));
+}
+
 // We need to stick to INSTANTIATE_TEST_CASE_P for a while longer
 // But we do want to build with -Werror in our CI
 #pragma GCC diagnostic warning "-Wdeprecated-declarations"
@@ -0,0 +1,140 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_executorscaler.h>
+
+#include <rmqa_workstealingexecutor.h>
+#include <rmqtestutil_mockmetricpublisher.h>
+
+#include <bslmt_threadattributes.h>
+
+#include <bsl_memory.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqa;
+using namespace ::testing;
+
+namespace {
+
+ExecutorScaler::Sample sample(bsl::size_t workers,
+                              bsl::size_t busyWorkers,
+                              bsl::size_t queuedJobs,
+                              double cpuShare)
+{
+    ExecutorScaler::Sample result;
+    result.workers     = workers;
+    result.busyWorkers = busyWorkers;
+    result.queuedJobs  = queuedJobs;
+    result.jobsRun     = 100;
+    result.cpuShare    = cpuShare;
+    return result;
+}
+
+} // namespace
+
+TEST(ExecutorScaler, GrowsOnBacklogUpToDouble)
+{
+    ExecutorScaler::Reason reason = ExecutorScaler::NONE;
+    bsl::size_t idleRuns          = 0;
+
+    EXPECT_EQ(ExecutorScaler::decide(
+                  &reason, &idleRuns, sample(4, 4, 100, 0.1), 2, 32, 8),
+              8u);
+    EXPECT_EQ(reason, ExecutorScaler::BACKLOG);
+
+    EXPECT_EQ(ExecutorScaler::decide(
+                  &reason, &idleRuns, sample(4, 4, 1, 0.1), 2, 32, 8),
+              5u);
+}
+
+TEST(ExecutorScaler, CapsCpuBoundHandlersAtTheCpus)
+{
+    ExecutorScaler::Reason reason = ExecutorScaler::NONE;
+    bsl::size_t idleRuns          = 0;
+
+    // Fully CPU-bound: no more workers than CPUs, however deep the backlog
+    EXPECT_EQ(ExecutorScaler::decide(
+                  &reason, &idleRuns, sample(8, 8, 100, 1.0), 2, 32, 8),
+              8u);
+    EXPECT_EQ(reason, ExecutorScaler::NONE);
+
+    EXPECT_EQ(ExecutorScaler::decide(
+                  &reason, &idleRuns, sample(16, 16, 100, 1.0), 2, 32, 8),
+              8u);
+    EXPECT_EQ(reason, ExecutorScaler::CPU_BOUND);
+
+    // Half the time on CPU allows twice the CPUs
+    EXPECT_EQ(ExecutorScaler::decide(
+                  &reason, &idleRuns, sample(12, 12, 100, 0.5), 2, 32, 8),
+              16u);
+}
+
+TEST(ExecutorScaler, ShrinksAfterIdleRuns)
+{
+    ExecutorScaler::Reason reason = ExecutorScaler::NONE;
+    bsl::size_t idleRuns          = 0;
+
+    for (bsl::size_t i = 1; i < ExecutorScaler::k_IDLE_RUNS; ++i) {
+        EXPECT_EQ(ExecutorScaler::decide(
+                      &reason, &idleRuns, sample(4, 1, 0, 0.1), 2, 32, 8),
+                  4u);
+    }
+    EXPECT_EQ(ExecutorScaler::decide(
+                  &reason, &idleRuns, sample(4, 1, 0, 0.1), 2, 32, 8),
+              3u);
+    EXPECT_EQ(reason, ExecutorScaler::IDLE);
+}
+
+TEST(ExecutorScaler, StaysWithinBounds)
+{
+    ExecutorScaler::Reason reason = ExecutorScaler::NONE;
+    bsl::size_t idleRuns          = 0;
+
+    EXPECT_EQ(ExecutorScaler::decide(
+                  &reason, &idleRuns, sample(6, 6, 100, -1), 2, 8, 8),
+              8u);
+
+    for (bsl::size_t i = 0; i < 2 * ExecutorScaler::k_IDLE_RUNS; ++i) {
+        EXPECT_EQ(ExecutorScaler::decide(
+                      &reason, &idleRuns, sample(2, 0, 0, -1), 2, 8, 8),
+                  2u);
+    }
+}
+
+TEST(ExecutorScaler, ResizesTheExecutorAndPublishesTheDecision)
+{
+    bsl::shared_ptr<WorkStealingExecutor> executor =
+        bsl::make_shared<WorkStealingExecutor>(
+            bslmt::ThreadAttributes(), 4, 8, 8);
+    ASSERT_EQ(executor->start(), 0);
+
+    bsl::shared_ptr<rmqtestutil::MockMetricPublisher> metricPublisher =
+        bsl::make_shared<rmqtestutil::MockMetricPublisher>();
+    EXPECT_CALL(*metricPublisher, publishGauge(_, _, _)).Times(AnyNumber());
+    EXPECT_CALL(*metricPublisher,
+                publishCounter(bsl::string("executor_scaling_decisions"),
+                               1,
+                               _));
+
+    ExecutorScaler scaler(executor, 2, 8, 4, metricPublisher);
+    for (bsl::size_t i = 0; i < ExecutorScaler::k_IDLE_RUNS; ++i) {
+        scaler.run();
+    }
+
+    EXPECT_EQ(executor->numWorkers(), 3u);
+    executor->stop();
+}
@@ -0,0 +1,115 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_filepayloadutil.h>
+
+#include <rmqt_message.h>
+#include <rmqt_properties.h>
+
+#include <bsls_platform.h>
+
+#include <bsl_cstdint.h>
+#include <bsl_cstring.h>
+#include <bsl_string.h>
+#include <bsl_vector.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#ifdef BSLS_PLATFORM_OS_UNIX
+#include <stdlib.h>
+#include <unistd.h>
+#endif
+
+using namespace BloombergLP;
+using namespace rmqa;
+using namespace ::testing;
+
+#ifdef BSLS_PLATFORM_OS_UNIX
+namespace {
+
+class FilePayloadUtilTests : public Test {
+  protected:
+    FilePayloadUtilTests()
+    : d_path("/tmp/rmqcpp-filepayload-XXXXXX")
+    , d_contents()
+    , d_fd(mkstemp(&d_path[0]))
+    {
+        // Spans more than one page so ranges start part way into one
+        for (bsl::size_t i = 0; i < 3 * 4096 + 100; ++i) {
+            d_contents.push_back(static_cast<bsl::uint8_t>(i * 7));
+        }
+        EXPECT_EQ(write(d_fd, d_contents.data(), d_contents.size()),
+                  static_cast<ssize_t>(d_contents.size()));
+    }
+
+    ~FilePayloadUtilTests()
+    {
+        close(d_fd);
+        unlink(d_path.c_str());
+    }
+
+    bsl::string d_path;
+    bsl::vector<bsl::uint8_t> d_contents;
+    int d_fd;
+};
+
+} // namespace
+
+TEST_F(FilePayloadUtilTests, MapsARange)
+{
+    rmqt::Message message;
+    ASSERT_EQ(FilePayloadUtil::makeMessage(
+                  &message, d_fd, 5000, 3000, rmqt::Properties()),
+              0);
+    close(d_fd);
+    d_fd = -1;
+
+    ASSERT_EQ(message.payloadSize(), 3000u);
+    EXPECT_EQ(bsl::memcmp(message.payload(), &d_contents[5000], 3000), 0);
+}
+
+TEST_F(FilePayloadUtilTests, MapsAWholeFile)
+{
+    rmqt::Message message;
+    ASSERT_EQ(
+        FilePayloadUtil::makeMessage(&message, d_path, rmqt::Properties()), 0);
+
+    ASSERT_EQ(message.payloadSize(), d_contents.size());
+    EXPECT_EQ(bsl::memcmp(
+                  message.payload(), d_contents.data(), d_contents.size()),
+              0);
+}
+
+TEST_F(FilePayloadUtilTests, RejectsRangesBeyondTheFile)
+{
+    rmqt::Message message;
+    EXPECT_NE(FilePayloadUtil::makeMessage(&message,
+                                           d_fd,
+                                           d_contents.size() - 10,
+                                           11,
+                                           rmqt::Properties()),
+              0);
+    EXPECT_EQ(message.payloadSize(), 0u);
+}
+
+TEST(FilePayloadUtil, FailsForMissingFiles)
+{
+    rmqt::Message message;
+    EXPECT_NE(FilePayloadUtil::makeMessage(
+                  &message, "/nonexistent/rmqcpp", rmqt::Properties()),
+              0);
+}
+#endif
@@ -0,0 +1,231 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_lazyproducer.h>
+
+#include <rmqtestmocks_mockproducer.h>
+#include <rmqtestutil_mockeventloop.t.h>
+#include <rmqtestutil_mocktimerfactory.h>
+
+#include <rmqp_producer.h>
+#include <rmqt_confirmresponse.h>
+#include <rmqt_future.h>
+#include <rmqt_message.h>
+#include <rmqt_result.h>
+#include <rmqt_topologyupdate.h>
+
+#include <bdlf_bind.h>
+#include <bdlmt_threadpool.h>
+#include <bsls_timeinterval.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <bsl_memory.h>
+#include <bsl_string.h>
+#include <bsl_vector.h>
+
+using namespace BloombergLP;
+using namespace ::testing;
+using namespace bdlf::PlaceHolders;
+
+namespace {
+
+rmqt::Future<rmqp::Producer>
+openMock(int* opens, const bsl::shared_ptr<rmqtestmocks::MockProducer>& mock)
+{
+    ++*opens;
+    return rmqt::Future<rmqp::Producer>(rmqt::Result<rmqp::Producer>(mock));
+}
+
+rmqt::Future<rmqp::Producer> openPending(int* opens,
+                                         rmqt::Future<rmqp::Producer> future)
+{
+    ++*opens;
+    return future;
+}
+
+} // namespace
+
+class LazyProducerTests : public Test {
+  protected:
+    bsl::shared_ptr<rmqtestmocks::MockProducer> d_mock;
+    bsl::shared_ptr<rmqtestutil::MockTimerFactory> d_timerFactory;
+    rmqtestutil::MockEventLoop d_eventLoop;
+    bdlmt::ThreadPool d_threadPool;
+    int d_opens;
+    bsl::vector<rmqp::Producer::ConfirmationCallback> d_confirms;
+
+    LazyProducerTests()
+    : d_mock(bsl::make_shared<rmqtestmocks::MockProducer>())
+    , d_timerFactory(bsl::make_shared<rmqtestutil::MockTimerFactory>())
+    , d_eventLoop(d_timerFactory)
+    , d_threadPool(bslmt::ThreadAttributes(), 0, 5, 5)
+    , d_opens(0)
+    , d_confirms()
+    {
+        d_threadPool.start();
+
+        ON_CALL(*d_mock, send(_, _, _, _, _))
+            .WillByDefault(Invoke(this, &LazyProducerTests::saveSend));
+        ON_CALL(*d_mock, updateTopologyAsync(_))
+            .WillByDefault(Return(rmqt::Future<>(rmqt::Result<>())));
+    }
+
+    bsl::shared_ptr<rmqa::LazyProducer>
+    createProducer(const bsls::TimeInterval& idleClose)
+    {
+        return bsl::make_shared<rmqa::LazyProducer>(
+            bdlf::BindUtil::bind(&openMock, &d_opens, d_mock),
+            10,
+            true,
+            idleClose,
+            bsl::ref(d_threadPool),
+            bsl::ref(d_eventLoop));
+    }
+
+    rmqp::Producer::SendStatus
+    saveSend(const rmqt::Message&,
+             const bsl::string&,
+             rmqt::Mandatory::Value,
+             const rmqp::Producer::ConfirmationCallback& confirm,
+             const bsls::TimeInterval&)
+    {
+        d_confirms.push_back(confirm);
+        return rmqp::Producer::SENDING;
+    }
+
+    rmqp::Producer::SendStatus send(rmqa::LazyProducer& producer)
+    {
+        return producer.send(rmqt::Message(),
+                             "key",
+                             rmqp::Producer::ConfirmationCallback(),
+                             bsls::TimeInterval());
+    }
+
+    void confirm(bsl::size_t i)
+    {
+        d_confirms[i](rmqt::Message(),
+                      "key",
+                      rmqt::ConfirmResponse(rmqt::ConfirmResponse::ACK));
+    }
+
+    void idleFor(const bsls::TimeInterval& interval)
+    {
+        d_timerFactory->step_time(interval);
+        d_threadPool.drain();
+        d_threadPool.start();
+    }
+};
+
+TEST_F(LazyProducerTests, OpensOnFirstSend)
+{
+    bsl::shared_ptr<rmqa::LazyProducer> producer =
+        createProducer(bsls::TimeInterval());
+
+    EXPECT_THAT(d_opens, Eq(0));
+    EXPECT_FALSE(producer->isOpen());
+    EXPECT_THAT(producer->availableCredits(), Eq(10));
+
+    EXPECT_CALL(*d_mock, send(_, _, _, _, _)).Times(2);
+    EXPECT_THAT(send(*producer), Eq(rmqp::Producer::SENDING));
+    EXPECT_THAT(send(*producer), Eq(rmqp::Producer::SENDING));
+
+    EXPECT_THAT(d_opens, Eq(1));
+    EXPECT_TRUE(producer->isOpen());
+}
+
+TEST_F(LazyProducerTests, ClosesWhenIdleAndReopens)
+{
+    bsl::shared_ptr<rmqa::LazyProducer> producer =
+        createProducer(bsls::TimeInterval(1));
+
+    EXPECT_CALL(*d_mock, send(_, _, _, _, _)).Times(2);
+    send(*producer);
+    confirm(0);
+
+    // Used during the first period
+    idleFor(bsls::TimeInterval(1));
+    EXPECT_TRUE(producer->isOpen());
+
+    idleFor(bsls::TimeInterval(1));
+    EXPECT_FALSE(producer->isOpen());
+
+    send(*producer);
+    EXPECT_THAT(d_opens, Eq(2));
+    EXPECT_TRUE(producer->isOpen());
+}
+
+TEST_F(LazyProducerTests, StaysOpenWhileUnconfirmed)
+{
+    bsl::shared_ptr<rmqa::LazyProducer> producer =
+        createProducer(bsls::TimeInterval(1));
+
+    EXPECT_CALL(*d_mock, send(_, _, _, _, _)).Times(1);
+    send(*producer);
+
+    idleFor(bsls::TimeInterval(1));
+    idleFor(bsls::TimeInterval(1));
+    EXPECT_TRUE(producer->isOpen());
+
+    confirm(0);
+    idleFor(bsls::TimeInterval(1));
+    EXPECT_FALSE(producer->isOpen());
+}
+
+TEST_F(LazyProducerTests, TrySendStartsOpeningWithoutWaiting)
+{
+    rmqt::Future<rmqp::Producer>::Pair pending =
+        rmqt::Future<rmqp::Producer>::make();
+    rmqa::LazyProducer producer(
+        bdlf::BindUtil::bind(&openPending, &d_opens, pending.second),
+        10,
+        true,
+        bsls::TimeInterval(),
+        d_threadPool,
+        d_eventLoop);
+
+    EXPECT_THAT(producer.trySend(rmqt::Message(),
+                                 "key",
+                                 rmqp::Producer::ConfirmationCallback()),
+                Eq(rmqp::Producer::INFLIGHT_LIMIT));
+    EXPECT_THAT(d_opens, Eq(1));
+
+    pending.first(rmqt::Result<rmqp::Producer>(d_mock));
+
+    EXPECT_CALL(*d_mock, trySend(_, _, _))
+        .WillOnce(Return(rmqp::Producer::SENDING));
+    EXPECT_THAT(producer.trySend(rmqt::Message(),
+                                 "key",
+                                 rmqp::Producer::ConfirmationCallback()),
+                Eq(rmqp::Producer::SENDING));
+    EXPECT_THAT(d_opens, Eq(1));
+}
+
+TEST_F(LazyProducerTests, ReplaysTopologyUpdatesOnOpen)
+{
+    bsl::shared_ptr<rmqa::LazyProducer> producer =
+        createProducer(bsls::TimeInterval());
+
+    EXPECT_TRUE(producer->updateTopologyAsync(rmqt::TopologyUpdate())
+                    .blockResult());
+
+    EXPECT_CALL(*d_mock, updateTopologyAsync(_)).Times(1);
+    EXPECT_CALL(*d_mock, setWriteWeight(3)).Times(1);
+    producer->setWriteWeight(3);
+
+    EXPECT_CALL(*d_mock, send(_, _, _, _, _)).Times(1);
+    send(*producer);
+}
@@ -0,0 +1,138 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_messagebatchutil.h>
+
+#include <rmqt_message.h>
+#include <rmqt_properties.h>
+
+#include <bsl_cstdint.h>
+#include <bsl_memory.h>
+#include <bsl_string.h>
+#include <bsl_vector.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqa;
+using namespace ::testing;
+
+namespace {
+
+rmqt::Message makeMessage(bsl::size_t size,
+                          uint8_t fill,
+                          const bsl::string& messageId)
+{
+    return rmqt::Message(bsl::make_shared<bsl::vector<uint8_t> >(size, fill),
+                         messageId);
+}
+
+bsl::vector<uint8_t> payloadOf(const rmqt::Message& message)
+{
+    const uint8_t* payload = message.payload();
+    return bsl::vector<uint8_t>(payload, payload + message.payloadSize());
+}
+
+} // namespace
+
+TEST(MessageBatchUtil, RoundTripsPayloadsAndMessageIds)
+{
+    bsl::vector<rmqt::Message> messages;
+    messages.push_back(makeMessage(10, 1, "first"));
+    messages.push_back(makeMessage(0, 0, ""));
+    messages.push_back(makeMessage(300, 3, bsl::string(255, 'x')));
+
+    const rmqt::Message batch = MessageBatchUtil::pack(messages);
+    EXPECT_TRUE(MessageBatchUtil::isBatch(batch));
+    EXPECT_THAT(batch.messageId(), Ne("first"));
+
+    bsl::vector<rmqt::Message> unpacked;
+    ASSERT_THAT(MessageBatchUtil::unpack(&unpacked, batch), Eq(0));
+    ASSERT_THAT(unpacked.size(), Eq(messages.size()));
+
+    for (bsl::size_t i = 0; i < messages.size(); ++i) {
+        EXPECT_THAT(unpacked[i].messageId(), Eq(messages[i].messageId()));
+        EXPECT_THAT(payloadOf(unpacked[i]), Eq(payloadOf(messages[i])));
+        EXPECT_FALSE(MessageBatchUtil::isBatch(unpacked[i]));
+    }
+}
+
+TEST(MessageBatchUtil, CarriesTheFirstMessagesProperties)
+{
+    rmqt::Properties properties;
+    properties.messageId     = "first";
+    properties.correlationId = "correlation";
+    properties.contentType   = "text/plain";
+
+    bsl::vector<rmqt::Message> messages;
+    messages.push_back(rmqt::Message(
+        bsl::make_shared<bsl::vector<uint8_t> >(4, 1), properties));
+    messages.push_back(makeMessage(4, 2, "second"));
+
+    bsl::vector<rmqt::Message> unpacked;
+    ASSERT_THAT(MessageBatchUtil::unpack(&unpacked,
+                                         MessageBatchUtil::pack(messages)),
+                Eq(0));
+    ASSERT_THAT(unpacked.size(), Eq(2));
+
+    EXPECT_THAT(unpacked[1].messageId(), Eq("second"));
+    EXPECT_THAT(unpacked[1].properties().correlationId.value(),
+                Eq("correlation"));
+    EXPECT_TRUE(unpacked[1].properties().contentType.isNull());
+}
+
+TEST(MessageBatchUtil, OrdinaryMessagesAreNotBatches)
+{
+    EXPECT_FALSE(MessageBatchUtil::isBatch(makeMessage(4, 1, "id")));
+}
+
+TEST(MessageBatchUtil, MalformedContainersAreRejected)
+{
+    bsl::vector<rmqt::Message> messages;
+    messages.push_back(makeMessage(10, 1, "first"));
+    messages.push_back(makeMessage(10, 2, "second"));
+    const bsl::vector<uint8_t> packed =
+        payloadOf(MessageBatchUtil::pack(messages));
+
+    rmqt::Properties properties;
+    properties.contentType = MessageBatchUtil::contentType();
+    bsl::vector<rmqt::Message> unpacked;
+
+    // Truncated
+    EXPECT_THAT(MessageBatchUtil::unpack(
+                    &unpacked,
+                    rmqt::Message(bsl::make_shared<bsl::vector<uint8_t> >(
+                                      packed.begin(), packed.end() - 1),
+                                  properties)),
+                Ne(0));
+    EXPECT_TRUE(unpacked.empty());
+
+    // Trailing bytes
+    bsl::shared_ptr<bsl::vector<uint8_t> > trailing =
+        bsl::make_shared<bsl::vector<uint8_t> >(packed);
+    trailing->push_back(0);
+    EXPECT_THAT(MessageBatchUtil::unpack(&unpacked,
+                                         rmqt::Message(trailing, properties)),
+                Ne(0));
+
+    // Unknown format version
+    bsl::shared_ptr<bsl::vector<uint8_t> > version =
+        bsl::make_shared<bsl::vector<uint8_t> >(packed);
+    (*version)[0] = 2;
+    EXPECT_THAT(MessageBatchUtil::unpack(&unpacked,
+                                         rmqt::Message(version, properties)),
+                Ne(0));
+}
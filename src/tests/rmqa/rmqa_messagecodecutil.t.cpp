@@ -0,0 +1,183 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_messagecodecutil.h>
+
+#include <rmqp_messagecodec.h>
+#include <rmqt_message.h>
+#include <rmqt_properties.h>
+
+#include <bsl_cstdint.h>
+#include <bsl_memory.h>
+#include <bsl_string.h>
+#include <bsl_vector.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqa;
+using namespace ::testing;
+
+namespace {
+
+/// Run-length encodes payloads as (count, byte) pairs
+class RunLengthCodec : public rmqp::MessageCodec {
+  public:
+    RunLengthCodec()
+    : d_name("x-rle")
+    {
+    }
+
+    const bsl::string& name() const BSLS_KEYWORD_OVERRIDE { return d_name; }
+
+    int compress(bsl::vector<uint8_t>* out,
+                 const uint8_t* data,
+                 bsl::size_t length) const BSLS_KEYWORD_OVERRIDE
+    {
+        out->clear();
+        for (bsl::size_t i = 0; i < length;) {
+            uint8_t run = 1;
+            while (i + run < length && data[i + run] == data[i] &&
+                   run < 255) {
+                ++run;
+            }
+            out->push_back(run);
+            out->push_back(data[i]);
+            i += run;
+        }
+        return 0;
+    }
+
+    int decompress(bsl::vector<uint8_t>* out,
+                   const uint8_t* data,
+                   bsl::size_t length) const BSLS_KEYWORD_OVERRIDE
+    {
+        if (length % 2 != 0) {
+            return 1;
+        }
+        out->clear();
+        for (bsl::size_t i = 0; i < length; i += 2) {
+            out->insert(out->end(), data[i], data[i + 1]);
+        }
+        return 0;
+    }
+
+  private:
+    bsl::string d_name;
+};
+
+rmqt::Message makeMessage(bsl::size_t size, uint8_t value)
+{
+    return rmqt::Message(
+        bsl::make_shared<bsl::vector<uint8_t> >(size, value));
+}
+
+class MessageCodecUtilTests : public Test {
+  protected:
+    MessageCodecUtilTests()
+    : d_codec(bsl::make_shared<RunLengthCodec>())
+    , d_codecs(1, d_codec)
+    {
+    }
+
+    bsl::shared_ptr<RunLengthCodec> d_codec;
+    MessageCodecUtil::Codecs d_codecs;
+};
+
+} // namespace
+
+TEST_F(MessageCodecUtilTests, CompressesAndRecordsEncoding)
+{
+    rmqt::Message message = makeMessage(1000, 'a');
+
+    EXPECT_TRUE(MessageCodecUtil::compress(&message, *d_codec, 100));
+
+    EXPECT_THAT(message.payloadSize(), Lt(1000));
+    ASSERT_FALSE(message.properties().contentEncoding.isNull());
+    EXPECT_THAT(message.properties().contentEncoding.value(), Eq("x-rle"));
+}
+
+TEST_F(MessageCodecUtilTests, RoundTripKeepsGuidAndPayload)
+{
+    const rmqt::Message original = makeMessage(1000, 'a');
+    rmqt::Message message(original);
+
+    ASSERT_TRUE(MessageCodecUtil::compress(&message, *d_codec, 100));
+    EXPECT_THAT(MessageCodecUtil::decompress(&message, d_codecs), Eq(0));
+
+    EXPECT_THAT(message.guid(), Eq(original.guid()));
+    EXPECT_TRUE(message.properties().contentEncoding.isNull());
+    ASSERT_THAT(message.payloadSize(), Eq(original.payloadSize()));
+    const uint8_t* payload = message.payload();
+    EXPECT_THAT(bsl::vector<uint8_t>(payload, payload + message.payloadSize()),
+                Eq(bsl::vector<uint8_t>(1000, 'a')));
+}
+
+TEST_F(MessageCodecUtilTests, SmallPayloadsAreNotCompressed)
+{
+    rmqt::Message message = makeMessage(50, 'a');
+
+    EXPECT_FALSE(MessageCodecUtil::compress(&message, *d_codec, 100));
+
+    EXPECT_THAT(message.payloadSize(), Eq(50));
+    EXPECT_TRUE(message.properties().contentEncoding.isNull());
+}
+
+TEST_F(MessageCodecUtilTests, IncompressiblePayloadsAreSentAsTheyAre)
+{
+    bsl::shared_ptr<bsl::vector<uint8_t> > payload =
+        bsl::make_shared<bsl::vector<uint8_t> >();
+    for (int i = 0; i < 200; ++i) {
+        payload->push_back(static_cast<uint8_t>(i));
+    }
+    rmqt::Message message(payload);
+
+    EXPECT_FALSE(MessageCodecUtil::compress(&message, *d_codec, 100));
+
+    EXPECT_THAT(message.payloadSize(), Eq(200));
+    EXPECT_TRUE(message.properties().contentEncoding.isNull());
+}
+
+TEST_F(MessageCodecUtilTests, EncodedMessagesAreNotCompressedAgain)
+{
+    rmqt::Message message = makeMessage(1000, 'a');
+    message.properties().contentEncoding = "gzip";
+
+    EXPECT_FALSE(MessageCodecUtil::compress(&message, *d_codec, 100));
+
+    EXPECT_THAT(message.payloadSize(), Eq(1000));
+}
+
+TEST_F(MessageCodecUtilTests, UnknownEncodingIsPassedOn)
+{
+    rmqt::Message message = makeMessage(10, 'a');
+    message.properties().contentEncoding = "gzip";
+
+    EXPECT_THAT(MessageCodecUtil::decompress(&message, d_codecs), Eq(0));
+
+    EXPECT_THAT(message.payloadSize(), Eq(10));
+    EXPECT_THAT(message.properties().contentEncoding.value(), Eq("gzip"));
+}
+
+TEST_F(MessageCodecUtilTests, CorruptPayloadFailsAndIsLeftAlone)
+{
+    rmqt::Message message = makeMessage(3, 'a');
+    message.properties().contentEncoding = "x-rle";
+
+    EXPECT_THAT(MessageCodecUtil::decompress(&message, d_codecs), Ne(0));
+
+    EXPECT_THAT(message.payloadSize(), Eq(3));
+    EXPECT_THAT(message.properties().contentEncoding.value(), Eq("x-rle"));
+}
@@ -20,6 +20,7 @@
 #include <rmqtestmocks_mockconsumer.h>
 
 #include <bdlf_bind.h>
+#include <bslma_testallocator.h>
 
 #include <bsl_memory.h>
 
@@ -192,6 +193,29 @@ TEST_F(MessageGuardTest, copiedObjectIsvalidAndCanAck)
     EXPECT_EQ(d_ack_state, rmqt::ConsumerAck::ACK);
 }
 
+TEST_F(MessageGuardTest, EmptyCallbackMakesAckAndNackNoOps)
+{
+    rmqa::MessageGuard acked(
+        rmqt::Message(),
+        rmqt::Envelope(0, 0, "consumerTag", "exchange", "routing-key", false),
+        rmqa::MessageGuard::MessageGuardCallback(),
+        &d_consumer);
+    EXPECT_NO_THROW(acked.ack());
+
+    rmqa::MessageGuard nacked(
+        rmqt::Message(),
+        rmqt::Envelope(1, 0, "consumerTag", "exchange", "routing-key", false),
+        rmqa::MessageGuard::MessageGuardCallback(),
+        &d_consumer);
+    EXPECT_NO_THROW(nacked.nack(false));
+
+    EXPECT_NO_THROW(rmqa::MessageGuard(
+        rmqt::Message(),
+        rmqt::Envelope(2, 0, "consumerTag", "exchange", "routing-key", false),
+        rmqa::MessageGuard::MessageGuardCallback(),
+        &d_consumer));
+}
+
 TEST_F(MessageGuardTest, ConsumerPassThrough)
 {
     rmqa::MessageGuard mg(
@@ -239,3 +263,24 @@ TEST_F(MessageGuardTest, TransferOwnershipOfAckedMG)
         EXPECT_TRUE(tmg);
     }
 }
+
+TEST_F(MessageGuardTest, FactoryAllocatesFromSuppliedAllocator)
+{
+    bslma::TestAllocator allocator;
+    {
+        bslma::ManagedPtr<rmqa::MessageGuard> guard =
+            rmqa::MessageGuard::Factory().create(
+                rmqt::Message(),
+                rmqt::Envelope(
+                    0, 0, "consumerTag", "exchange", "routing-key", false),
+                callback(),
+                &d_consumer,
+                &allocator);
+        EXPECT_THAT(allocator.numBlocksInUse(), Eq(1));
+    }
+    EXPECT_THAT(allocator.numBlocksInUse(), Eq(0));
+
+    // Destroying the unresolved guard nacked the message
+    EXPECT_TRUE(d_acked);
+    EXPECT_THAT(d_ack_state, Eq(rmqt::ConsumerAck::REQUEUE));
+}
@@ -0,0 +1,101 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_partitionutil.h>
+
+#include <rmqa_topology.h>
+
+#include <rmqt_fieldvalue.h>
+#include <rmqt_queue.h>
+#include <rmqt_queuebinding.h>
+#include <rmqt_topology.h>
+
+#include <bsl_cstring.h>
+#include <bsl_string.h>
+#include <bsl_vector.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqa;
+using namespace ::testing;
+
+namespace {
+
+bsl::uint32_t hash(const char* data, bsl::uint32_t seed)
+{
+    return PartitionUtil::murmurHash3(data, bsl::strlen(data), seed);
+}
+
+} // namespace
+
+TEST(PartitionUtilTests, MurmurHash3MatchesReferenceValues)
+{
+    EXPECT_THAT(hash("", 0), Eq(0u));
+    EXPECT_THAT(hash("", 1), Eq(0x514e28b7u));
+    EXPECT_THAT(hash("hello", 0), Eq(0x248bfa47u));
+    EXPECT_THAT(hash("The quick brown fox jumps over the lazy dog", 0),
+                Eq(0x2e4ff723u));
+}
+
+TEST(PartitionUtilTests, PartitionUsesTheSuperStreamSeed)
+{
+    EXPECT_THAT(hash("hello", PartitionUtil::k_HASH_SEED), Eq(0x4ec83379u));
+    EXPECT_THAT(PartitionUtil::partitionOf("hello", 3), Eq(0u));
+    EXPECT_THAT(PartitionUtil::partitionOf("order-42", 3), Eq(1u));
+}
+
+TEST(PartitionUtilTests, PartitionIsInRange)
+{
+    for (int i = 0; i < 100; ++i) {
+        const bsl::string key(static_cast<bsl::size_t>(i), 'k');
+        EXPECT_THAT(PartitionUtil::partitionOf(key, 7), Lt(7u));
+        EXPECT_THAT(PartitionUtil::partitionOf(key, 1), Eq(0u));
+    }
+}
+
+TEST(PartitionUtilTests, SuperStreamRoutingKeys)
+{
+    EXPECT_THAT(PartitionUtil::superStreamRoutingKeys(3),
+                ElementsAre("0", "1", "2"));
+    EXPECT_THAT(PartitionUtil::superStreamRoutingKeys(0), IsEmpty());
+}
+
+TEST(PartitionUtilTests, AddSuperStreamDeclaresPartitions)
+{
+    Topology topology;
+    rmqt::ExchangeHandle exchange =
+        PartitionUtil::addSuperStream(&topology, "orders", 2);
+
+    const rmqt::Topology& declared = topology.topology();
+    ASSERT_THAT(declared.queues.size(), Eq(2u));
+    ASSERT_THAT(declared.queueBindings.size(), Eq(2u));
+
+    for (bsl::size_t i = 0; i < 2; ++i) {
+        const rmqt::Queue& queue = *declared.queues[i];
+        const bsl::string key    = i == 0 ? "0" : "1";
+
+        EXPECT_THAT(queue.name(), Eq("orders-" + key));
+        ASSERT_TRUE(queue.arguments().count("x-queue-type"));
+        EXPECT_THAT(queue.arguments().find("x-queue-type")->second,
+                    Eq(rmqt::FieldValue(bsl::string("stream"))));
+
+        const rmqt::QueueBinding& binding = *declared.queueBindings[i];
+        EXPECT_THAT(binding.bindingKey(), Eq(key));
+        EXPECT_THAT(binding.exchange().lock(), Eq(exchange.lock()));
+        EXPECT_THAT(binding.queue().lock()->name(), Eq(queue.name()));
+    }
+}
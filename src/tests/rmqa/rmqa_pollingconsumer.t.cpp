@@ -0,0 +1,109 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_pollingconsumer.h>
+
+#include <rmqtestmocks_mockmessageguard.h>
+
+#include <rmqp_messageguard.h>
+
+#include <bsls_timeinterval.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <bsl_memory.h>
+#include <bsl_vector.h>
+
+using namespace BloombergLP;
+using namespace ::testing;
+
+namespace {
+
+typedef bsl::vector<rmqp::TransferrableMessageGuard> Guards;
+
+/// A delivered guard, whose ownership moves to `transferred` when buffered
+struct Delivery {
+    rmqtestmocks::MockMessageGuard delivered;
+    bsl::shared_ptr<rmqtestmocks::MockMessageGuard> transferred;
+
+    Delivery()
+    : delivered()
+    , transferred(bsl::make_shared<rmqtestmocks::MockMessageGuard>())
+    {
+        EXPECT_CALL(delivered, transferOwnership())
+            .WillOnce(Return(transferred));
+    }
+};
+
+} // namespace
+
+TEST(PollingConsumerBuffer, PopsInArrivalOrderUpToMax)
+{
+    rmqa::PollingConsumer::Buffer buffer;
+    Delivery first, second, third;
+
+    buffer.push(first.delivered);
+    buffer.push(second.delivered);
+    buffer.push(third.delivered);
+    EXPECT_THAT(buffer.size(), Eq(3));
+
+    Guards guards;
+    EXPECT_THAT(buffer.pop(&guards, 2, false, bsls::TimeInterval()), Eq(2));
+    ASSERT_THAT(guards.size(), Eq(2));
+    EXPECT_THAT(guards[0], Eq(first.transferred));
+    EXPECT_THAT(guards[1], Eq(second.transferred));
+
+    EXPECT_THAT(buffer.pop(&guards, 10, true, bsls::TimeInterval(1)), Eq(1));
+    ASSERT_THAT(guards.size(), Eq(3));
+    EXPECT_THAT(guards[2], Eq(third.transferred));
+    EXPECT_THAT(buffer.size(), Eq(0));
+}
+
+TEST(PollingConsumerBuffer, WaitTimesOutWhenEmpty)
+{
+    rmqa::PollingConsumer::Buffer buffer;
+
+    Guards guards;
+    EXPECT_THAT(buffer.pop(&guards, 10, true, bsls::TimeInterval(0, 1000000)),
+                Eq(0));
+    EXPECT_THAT(guards, IsEmpty());
+}
+
+TEST(PollingConsumerBuffer, CloseRequeuesUnpolledMessages)
+{
+    rmqa::PollingConsumer::Buffer buffer;
+    Delivery polled, buffered;
+
+    buffer.push(polled.delivered);
+    buffer.push(buffered.delivered);
+
+    Guards guards;
+    EXPECT_THAT(buffer.pop(&guards, 1, false, bsls::TimeInterval()), Eq(1));
+
+    EXPECT_CALL(*polled.transferred, nack(_)).Times(0);
+    EXPECT_CALL(*buffered.transferred, nack(true));
+    buffer.close();
+
+    // Delivered after closing, so never buffered
+    rmqtestmocks::MockMessageGuard late;
+    EXPECT_CALL(late, transferOwnership()).Times(0);
+    EXPECT_CALL(late, nack(true));
+    buffer.push(late);
+
+    // Closed, so returns at once
+    EXPECT_THAT(buffer.pop(&guards, 10, true, bsls::TimeInterval()), Eq(0));
+    EXPECT_THAT(buffer.size(), Eq(0));
+}
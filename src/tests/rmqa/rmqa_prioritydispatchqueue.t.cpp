@@ -0,0 +1,105 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_prioritydispatchqueue.h>
+
+#include <rmqt_envelope.h>
+#include <rmqt_message.h>
+#include <rmqt_properties.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <bsl_memory.h>
+#include <bsl_optional.h>
+#include <bsl_string.h>
+#include <bsl_vector.h>
+
+using namespace BloombergLP;
+using namespace rmqa;
+using namespace ::testing;
+
+namespace {
+
+rmqt::Message makeMessage(int priority)
+{
+    rmqt::Message message(bsl::make_shared<bsl::vector<uint8_t> >(4, 'x'));
+    if (priority >= 0) {
+        message.properties().priority = static_cast<bsl::uint8_t>(priority);
+    }
+    return message;
+}
+
+rmqt::Envelope makeEnvelope(uint64_t deliveryTag)
+{
+    return rmqt::Envelope(deliveryTag, 1, "tag", "exchange", "key", false);
+}
+
+uint64_t popTag(PriorityDispatchQueue& queue)
+{
+    bsl::optional<PriorityDispatchQueue::Delivery> delivery = queue.pop();
+    return delivery ? delivery->second.deliveryTag() : 0;
+}
+
+} // namespace
+
+TEST(PriorityDispatchQueueTests, EmptyPopsNothing)
+{
+    PriorityDispatchQueue queue;
+
+    EXPECT_FALSE(queue.pop());
+    EXPECT_THAT(queue.size(), Eq(0));
+}
+
+TEST(PriorityDispatchQueueTests, PopsHighestPriorityFirst)
+{
+    PriorityDispatchQueue queue;
+
+    queue.push(makeMessage(1), makeEnvelope(1));
+    queue.push(makeMessage(9), makeEnvelope(2));
+    queue.push(makeMessage(5), makeEnvelope(3));
+
+    EXPECT_THAT(queue.size(), Eq(3));
+    EXPECT_THAT(popTag(queue), Eq(2));
+    EXPECT_THAT(popTag(queue), Eq(3));
+    EXPECT_THAT(popTag(queue), Eq(1));
+    EXPECT_FALSE(queue.pop());
+}
+
+TEST(PriorityDispatchQueueTests, KeepsDeliveryOrderWithinPriority)
+{
+    PriorityDispatchQueue queue;
+
+    for (uint64_t tag = 1; tag <= 5; ++tag) {
+        queue.push(makeMessage(3), makeEnvelope(tag));
+    }
+
+    for (uint64_t tag = 1; tag <= 5; ++tag) {
+        EXPECT_THAT(popTag(queue), Eq(tag));
+    }
+}
+
+TEST(PriorityDispatchQueueTests, NoPriorityCountsAsZero)
+{
+    PriorityDispatchQueue queue;
+
+    queue.push(makeMessage(-1), makeEnvelope(1));
+    queue.push(makeMessage(0), makeEnvelope(2));
+    queue.push(makeMessage(1), makeEnvelope(3));
+
+    EXPECT_THAT(popTag(queue), Eq(3));
+    EXPECT_THAT(popTag(queue), Eq(1));
+    EXPECT_THAT(popTag(queue), Eq(2));
+}
@@ -14,24 +14,35 @@
 // limitations under the License.
 
 #include <rmqa_producerimpl.h>
+#include <rmqa_publishspool.h>
 
 #include <rmqp_producertracing.h>
 
 #include <rmqa_tracingproducerimpl.h>
 
+#include <rmqamqp_memorybudget.h>
+#include <rmqamqp_messagewithroute.h>
+#include <rmqamqp_publishgate.h>
+#include <rmqamqp_ratelimiter.h>
+#include <rmqamqp_sendchannel.h>
 #include <rmqtestutil_mockchannel.t.h>
 #include <rmqtestutil_mockeventloop.t.h>
+#include <rmqtestutil_mocktimerfactory.h>
 #include <rmqtestutil_savethreadid.h>
 
+#include <rmqp_messagesink.h>
 #include <rmqp_producer.h>
 #include <rmqt_confirmresponse.h>
 #include <rmqt_message.h>
 #include <rmqt_queue.h>
+#include <rmqt_ratelimit.h>
 #include <rmqt_simpleendpoint.h>
 #include <rmqt_topology.h>
 
 #include <bdlf_bind.h>
+#include <bslmt_threadgroup.h>
 #include <bslmt_threadutil.h>
+#include <bsls_atomic.h>
 #include <bsls_systemtime.h>
 #include <bsls_timeinterval.h>
 
@@ -99,6 +110,57 @@ MATCHER_P(ExchangeHandleNameEq, expected, "")
 
 enum ProducerType { PRODUCER, TRACING_PRODUCER };
 
+void countCall(bsls::AtomicInt* calls) { ++(*calls); }
+
+void sendAll(rmqa::ProducerImpl* producer,
+             bsl::vector<rmqt::Message>::const_iterator messages,
+             bsl::size_t count,
+             const bsl::string& routingKey,
+             const rmqp::Producer::ConfirmationCallback& callback,
+             bsls::AtomicInt* sending)
+{
+    for (bsl::size_t i = 0; i < count; ++i, ++messages) {
+        if (producer->trySend(*messages, routingKey, callback) ==
+            rmqp::Producer::SENDING) {
+            ++(*sending);
+        }
+    }
+}
+
+rmqamqp::SendChannel::Confirmation
+confirmation(const rmqt::Message& message,
+             const bsl::string& routingKey,
+             const rmqt::ConfirmResponse& confirmResponse)
+{
+    return bsl::make_pair(
+        rmqamqp::MessageWithRoute(
+            message, routingKey, rmqt::Mandatory::RETURN_UNROUTABLE),
+        confirmResponse);
+}
+
+/// Deliver a single confirm through the channel's batch confirm callback
+void confirmAsBatch(
+    const rmqamqp::SendChannel::MessageBatchConfirmCallback* onConfirms,
+    const rmqt::Message& message,
+    const bsl::string& routingKey,
+    const rmqt::ConfirmResponse& confirmResponse)
+{
+    bsl::shared_ptr<rmqamqp::SendChannel::ConfirmationBatch> batch =
+        bsl::make_shared<rmqamqp::SendChannel::ConfirmationBatch>();
+    batch->push_back(confirmation(message, routingKey, confirmResponse));
+    (*onConfirms)(batch);
+}
+
+void saveFanOutResponses(int* calls,
+                         bsl::vector<rmqt::ConfirmResponse>* saved,
+                         const rmqt::Message&,
+                         const bsl::vector<bsl::string>&,
+                         const bsl::vector<rmqt::ConfirmResponse>& responses)
+{
+    ++*calls;
+    *saved = responses;
+}
+
 } // namespace
 
 class ProducerImplTests : public TestWithParam<ProducerType> {
@@ -178,7 +240,7 @@ class ProducerImplTests : public TestWithParam<ProducerType> {
 
 TEST_P(ProducerImplTests, ItsAlive)
 {
-    EXPECT_CALL(*d_mockSendChannel, setCallback(_));
+    EXPECT_CALL(*d_mockSendChannel, setBatchCallback(_));
     bsl::shared_ptr<rmqa::ProducerImpl> producer(d_factory->create(
         1, d_exchange, d_mockSendChannel, d_threadPool, d_eventLoop));
 }
@@ -187,7 +249,7 @@ TEST_P(ProducerImplTests, PublishToQueueCallsAmqpChannel)
 {
     // Check producer::send(queue) invokes SendChannel::publishMessage correctly
 
-    EXPECT_CALL(*d_mockSendChannel, setCallback(_));
+    EXPECT_CALL(*d_mockSendChannel, setBatchCallback(_));
     bsl::shared_ptr<rmqa::ProducerImpl> producer(d_factory->create(
         1, d_exchange, d_mockSendChannel, d_threadPool, d_eventLoop));
 
@@ -200,11 +262,21 @@ TEST_P(ProducerImplTests, PublishToQueueCallsAmqpChannel)
     d_threadPool.drain();
 }
 
+TEST_P(ProducerImplTests, SetWriteWeightReachesTheChannel)
+{
+    EXPECT_CALL(*d_mockSendChannel, setBatchCallback(_));
+    bsl::shared_ptr<rmqa::ProducerImpl> producer(d_factory->create(
+        1, d_exchange, d_mockSendChannel, d_threadPool, d_eventLoop));
+
+    EXPECT_CALL(*d_mockSendChannel, setWriteWeight(4));
+    producer->setWriteWeight(4);
+}
+
 TEST_P(ProducerImplTests, PublishToExchangeCallsAmqpChannel)
 {
     // Check producer::send(queue) invokes SendChannel::publishMessage correctly
 
-    EXPECT_CALL(*d_mockSendChannel, setCallback(_));
+    EXPECT_CALL(*d_mockSendChannel, setBatchCallback(_));
     bsl::shared_ptr<rmqa::ProducerImpl> producer(d_factory->create(
         1, d_exchange, d_mockSendChannel, d_threadPool, d_eventLoop));
 
@@ -224,7 +296,7 @@ TEST_P(ProducerImplTests, PublishNotMandatory)
 {
     // Check producer::send sends the correct mandatory flag
 
-    EXPECT_CALL(*d_mockSendChannel, setCallback(_));
+    EXPECT_CALL(*d_mockSendChannel, setBatchCallback(_));
     bsl::shared_ptr<rmqa::ProducerImpl> producer(d_factory->create(
         1, d_exchange, d_mockSendChannel, d_threadPool, d_eventLoop));
 
@@ -249,7 +321,7 @@ TEST_P(ProducerImplTests, DuplicateMessagesReturnDuplicate)
     // Ensure sending two msgs to a producer with the same GUID will return
     // DUPLICATE on the second call
 
-    EXPECT_CALL(*d_mockSendChannel, setCallback(_));
+    EXPECT_CALL(*d_mockSendChannel, setBatchCallback(_));
     bsl::shared_ptr<rmqa::ProducerImpl> producer(d_factory->create(
         2, d_exchange, d_mockSendChannel, d_threadPool, d_eventLoop));
 
@@ -265,6 +337,159 @@ TEST_P(ProducerImplTests, DuplicateMessagesReturnDuplicate)
         Eq(rmqp::Producer::DUPLICATE));
 }
 
+TEST_P(ProducerImplTests, SendBatchCallsAmqpChannelOnce)
+{
+    EXPECT_CALL(*d_mockSendChannel, setBatchCallback(_));
+    bsl::shared_ptr<rmqa::ProducerImpl> producer(d_factory->create(
+        3, d_exchange, d_mockSendChannel, d_threadPool, d_eventLoop));
+
+    bsl::vector<rmqt::Message> batch;
+    batch.push_back(newMessage());
+    batch.push_back(newMessage());
+    batch.push_back(newMessage());
+
+    EXPECT_CALL(*d_mockSendChannel,
+                publishMessages(SizeIs(3),
+                                bsl::string("routingKey"),
+                                rmqt::Mandatory::RETURN_UNROUTABLE));
+    EXPECT_THAT(producer->sendBatch(batch, "routingKey", d_callback, d_timeout),
+                Eq(rmqp::Producer::SENDING));
+
+    d_threadPool.drain();
+}
+
+TEST_P(ProducerImplTests, SendBatchLargerThanLimit)
+{
+    EXPECT_CALL(*d_mockSendChannel, setBatchCallback(_));
+    bsl::shared_ptr<rmqa::ProducerImpl> producer(d_factory->create(
+        1, d_exchange, d_mockSendChannel, d_threadPool, d_eventLoop));
+
+    bsl::vector<rmqt::Message> batch;
+    batch.push_back(newMessage());
+    batch.push_back(newMessage());
+
+    EXPECT_THAT(producer->sendBatch(batch, "routingKey", d_callback, d_timeout),
+                Eq(rmqp::Producer::INFLIGHT_LIMIT));
+}
+
+TEST_P(ProducerImplTests, SendBatchDuplicateSendsNothing)
+{
+    // A duplicate within the batch rejects the whole batch, and releases the
+    // capacity reserved for it
+
+    EXPECT_CALL(*d_mockSendChannel, setBatchCallback(_));
+    bsl::shared_ptr<rmqa::ProducerImpl> producer(d_factory->create(
+        2, d_exchange, d_mockSendChannel, d_threadPool, d_eventLoop));
+
+    bsl::vector<rmqt::Message> batch(2, d_message);
+    EXPECT_THAT(producer->sendBatch(batch, "routingKey", d_callback, d_timeout),
+                Eq(rmqp::Producer::DUPLICATE));
+
+    EXPECT_CALL(*d_mockSendChannel, publishMessage(_, _, _)).Times(2);
+    EXPECT_THAT(producer->trySend(d_message, "routingKey", d_callback),
+                Eq(rmqp::Producer::SENDING));
+    EXPECT_THAT(producer->trySend(newMessage(), "routingKey", d_callback),
+                Eq(rmqp::Producer::SENDING));
+}
+
+TEST_P(ProducerImplTests, StreamPublishesBodyAsItIsWritten)
+{
+    EXPECT_CALL(*d_mockSendChannel, setBatchCallback(_));
+    bsl::shared_ptr<rmqa::ProducerImpl> producer(d_factory->create(
+        1, d_exchange, d_mockSendChannel, d_threadPool, d_eventLoop));
+
+    EXPECT_CALL(*d_mockSendChannel,
+                beginStream(_,
+                            10,
+                            bsl::string("routingKey"),
+                            rmqt::Mandatory::RETURN_UNROUTABLE,
+                            _));
+    EXPECT_CALL(*d_mockSendChannel,
+                publishStreamContent(Pointee(SizeIs(6)), _))
+        .WillOnce(InvokeArgument<1>());
+    EXPECT_CALL(*d_mockSendChannel,
+                publishStreamContent(Pointee(SizeIs(4)), _))
+        .WillOnce(InvokeArgument<1>());
+
+    rmqt::Result<rmqp::MessageSink> sink = producer->openStream(
+        d_message, 10, "routingKey", d_callback, d_timeout);
+    ASSERT_TRUE(sink);
+
+    const uint8_t body[10] = {0};
+    EXPECT_THAT(sink.value()->write(body, 6), Eq(0));
+    EXPECT_THAT(sink.value()->remaining(), Eq(4));
+
+    // More than the declared body size is refused
+    EXPECT_THAT(sink.value()->write(body, 6), Ne(0));
+
+    EXPECT_THAT(sink.value()->write(body + 6, 4), Eq(0));
+    EXPECT_THAT(sink.value()->remaining(), Eq(0));
+}
+
+TEST_P(ProducerImplTests, OneStreamAtATime)
+{
+    EXPECT_CALL(*d_mockSendChannel, setBatchCallback(_));
+    bsl::shared_ptr<rmqa::ProducerImpl> producer(d_factory->create(
+        3, d_exchange, d_mockSendChannel, d_threadPool, d_eventLoop));
+
+    EXPECT_CALL(*d_mockSendChannel, beginStream(_, _, _, _, _)).Times(2);
+    EXPECT_CALL(*d_mockSendChannel, publishStreamContent(_, _))
+        .WillOnce(InvokeArgument<1>());
+
+    rmqt::Result<rmqp::MessageSink> first =
+        producer->openStream(newMessage(), 4, "rk", d_callback, d_timeout);
+    ASSERT_TRUE(first);
+
+    rmqt::Result<rmqp::MessageSink> refused =
+        producer->openStream(newMessage(), 4, "rk", d_callback, d_timeout);
+    EXPECT_FALSE(refused);
+    EXPECT_THAT(refused.returnCode(), Eq(rmqp::Producer::INFLIGHT_LIMIT));
+
+    const uint8_t body[4] = {0};
+    EXPECT_THAT(first.value()->write(body, 4), Eq(0));
+
+    EXPECT_TRUE(
+        producer->openStream(newMessage(), 0, "rk", d_callback, d_timeout));
+}
+
+TEST_P(ProducerImplTests, FailedStreamRefusesWrites)
+{
+    EXPECT_CALL(*d_mockSendChannel, setBatchCallback(_));
+    bsl::shared_ptr<rmqa::ProducerImpl> producer(d_factory->create(
+        2, d_exchange, d_mockSendChannel, d_threadPool, d_eventLoop));
+
+    rmqamqp::SendChannel::StreamFailureCallback failStream;
+    EXPECT_CALL(*d_mockSendChannel, beginStream(_, 8, _, _, _))
+        .WillOnce(SaveArg<4>(&failStream));
+
+    rmqt::Result<rmqp::MessageSink> sink =
+        producer->openStream(d_message, 8, "rk", d_callback, d_timeout);
+    ASSERT_TRUE(sink);
+
+    failStream();
+
+    // Not abandoned on destruction, as the channel already failed it
+    const uint8_t body[4] = {0};
+    EXPECT_THAT(sink.value()->write(body, 4), Ne(0));
+    sink = rmqt::Result<rmqp::MessageSink>("reset");
+
+    EXPECT_CALL(*d_mockSendChannel, beginStream(_, 0, _, _, _));
+    EXPECT_TRUE(
+        producer->openStream(newMessage(), 0, "rk", d_callback, d_timeout));
+}
+
+TEST_P(ProducerImplTests, AbandonedStreamIsAborted)
+{
+    EXPECT_CALL(*d_mockSendChannel, setBatchCallback(_));
+    bsl::shared_ptr<rmqa::ProducerImpl> producer(d_factory->create(
+        1, d_exchange, d_mockSendChannel, d_threadPool, d_eventLoop));
+
+    EXPECT_CALL(*d_mockSendChannel, beginStream(_, 8, _, _, _));
+    EXPECT_CALL(*d_mockSendChannel, abortStream());
+
+    producer->openStream(d_message, 8, "rk", d_callback, d_timeout);
+}
+
 class ProducerImplMaxOutstandingTests : public ProducerImplTests {
   public:
     ProducerImplMaxOutstandingTests()
@@ -272,10 +497,14 @@ class ProducerImplMaxOutstandingTests : public ProducerImplTests {
         EXPECT_CALL(*d_mockSendChannel, publishMessage(_, _, _))
             .WillRepeatedly(Return());
 
-        EXPECT_CALL(*d_mockSendChannel, setCallback(_))
-            .WillOnce(SaveArg<0>(&d_injectConfirm));
+        EXPECT_CALL(*d_mockSendChannel, setBatchCallback(_))
+            .WillOnce(SaveArg<0>(&d_injectConfirms));
+
+        d_injectConfirm = bdlf::BindUtil::bind(
+            &confirmAsBatch, &d_injectConfirms, _1, _2, _3);
     }
 
+    rmqamqp::SendChannel::MessageBatchConfirmCallback d_injectConfirms;
     rmqamqp::SendChannel::MessageConfirmCallback d_injectConfirm;
 };
 
@@ -384,6 +613,194 @@ TEST_P(ProducerImplMaxOutstandingTests, TrySendReachesLimit)
     }
 }
 
+TEST_P(ProducerImplMaxOutstandingTests, WritableCallbackFiresAfterLimit)
+{
+    rmqt::ConfirmResponse confirmResponse(rmqt::ConfirmResponse::ACK);
+
+    bsl::shared_ptr<rmqa::ProducerImpl> producer(d_factory->create(
+        2, d_exchange, d_mockSendChannel, d_threadPool, d_eventLoop));
+
+    bsls::AtomicInt writableCalls(0);
+    producer->setWritableCallback(
+        bdlf::BindUtil::bind(&countCall, &writableCalls), 2);
+
+    EXPECT_THAT(producer->availableCredits(), Eq(2));
+
+    rmqt::Message msg1 = newMessage();
+    rmqt::Message msg2 = newMessage();
+    EXPECT_THAT(producer->trySend(msg1, d_queue->name(), d_callback),
+                Eq(rmqp::Producer::SENDING));
+    EXPECT_THAT(producer->trySend(msg2, d_queue->name(), d_callback),
+                Eq(rmqp::Producer::SENDING));
+    EXPECT_THAT(producer->availableCredits(), Eq(0));
+
+    EXPECT_THAT(producer->trySend(newMessage(), d_queue->name(), d_callback),
+                Eq(rmqp::Producer::INFLIGHT_LIMIT));
+
+    EXPECT_CALL(*d_mockCallback, onConfirm(_, _, confirmResponse)).Times(2);
+
+    // One credit back is below the requested two
+    d_injectConfirm(msg1, d_queue->name(), confirmResponse);
+    d_threadPool.drain();
+    EXPECT_THAT(writableCalls.load(), Eq(0));
+    EXPECT_THAT(producer->availableCredits(), Eq(1));
+
+    d_threadPool.start();
+    d_injectConfirm(msg2, d_queue->name(), confirmResponse);
+    d_threadPool.drain();
+    EXPECT_THAT(writableCalls.load(), Eq(1));
+    EXPECT_THAT(producer->availableCredits(), Eq(2));
+}
+
+TEST_P(ProducerImplMaxOutstandingTests, WritableCallbackNeedsInflightLimit)
+{
+    rmqt::ConfirmResponse confirmResponse(rmqt::ConfirmResponse::ACK);
+
+    bsl::shared_ptr<rmqa::ProducerImpl> producer(d_factory->create(
+        1, d_exchange, d_mockSendChannel, d_threadPool, d_eventLoop));
+
+    bsls::AtomicInt writableCalls(0);
+    producer->setWritableCallback(
+        bdlf::BindUtil::bind(&countCall, &writableCalls), 1);
+
+    EXPECT_THAT(producer->trySend(d_message, d_queue->name(), d_callback),
+                Eq(rmqp::Producer::SENDING));
+
+    EXPECT_CALL(*d_mockCallback, onConfirm(_, _, confirmResponse));
+    d_injectConfirm(d_message, d_queue->name(), confirmResponse);
+    d_threadPool.drain();
+
+    // The producer never refused a message, so there is nothing to resume
+    EXPECT_THAT(writableCalls.load(), Eq(0));
+}
+
+TEST_P(ProducerImplMaxOutstandingTests, BatchOfConfirmsSettlesEveryMessage)
+{
+    rmqt::ConfirmResponse confirmResponse(rmqt::ConfirmResponse::ACK);
+
+    bsl::shared_ptr<rmqa::ProducerImpl> producer(d_factory->create(
+        3, d_exchange, d_mockSendChannel, d_threadPool, d_eventLoop));
+
+    bsl::shared_ptr<rmqamqp::SendChannel::ConfirmationBatch> batch =
+        bsl::make_shared<rmqamqp::SendChannel::ConfirmationBatch>();
+    for (int i = 0; i < 3; ++i) {
+        rmqt::Message message = newMessage();
+        EXPECT_THAT(producer->trySend(message, d_queue->name(), d_callback),
+                    Eq(rmqp::Producer::SENDING));
+        batch->push_back(
+            confirmation(message, d_queue->name(), confirmResponse));
+    }
+    EXPECT_THAT(producer->availableCredits(), Eq(0));
+
+    EXPECT_CALL(*d_mockCallback, onConfirm(_, _, confirmResponse)).Times(3);
+
+    // A multiple ack from the broker arrives as one batch
+    d_injectConfirms(batch);
+    d_threadPool.drain();
+
+    EXPECT_THAT(producer->availableCredits(), Eq(3));
+    EXPECT_TRUE(producer->waitForConfirms(bsls::TimeInterval(0, 1)));
+}
+
+TEST_P(ProducerImplMaxOutstandingTests, ConcurrentSendersAreAllTracked)
+{
+    const int k_THREADS = 4;
+    const int k_PER_THREAD = 25;
+
+    bsl::shared_ptr<rmqa::ProducerImpl> producer(
+        d_factory->create(k_THREADS * k_PER_THREAD,
+                          d_exchange,
+                          d_mockSendChannel,
+                          d_threadPool,
+                          d_eventLoop));
+
+    bsl::vector<rmqt::Message> messages;
+    for (int i = 0; i < k_THREADS * k_PER_THREAD; ++i) {
+        messages.push_back(newMessage());
+    }
+
+    bsls::AtomicInt sending(0);
+    bslmt::ThreadGroup senders;
+    for (int i = 0; i < k_THREADS; ++i) {
+        senders.addThread(bdlf::BindUtil::bind(&sendAll,
+                                               producer.get(),
+                                               messages.begin() +
+                                                   i * k_PER_THREAD,
+                                               k_PER_THREAD,
+                                               d_queue->name(),
+                                               d_callback,
+                                               &sending));
+    }
+    senders.joinAll();
+
+    EXPECT_THAT(sending.load(), Eq(k_THREADS * k_PER_THREAD));
+    EXPECT_THAT(producer->availableCredits(), Eq(0));
+    EXPECT_FALSE(producer->waitForConfirms(bsls::TimeInterval(0, 1)));
+
+    rmqt::ConfirmResponse confirmResponse(rmqt::ConfirmResponse::ACK);
+    bsl::shared_ptr<rmqamqp::SendChannel::ConfirmationBatch> batch =
+        bsl::make_shared<rmqamqp::SendChannel::ConfirmationBatch>();
+    for (bsl::size_t i = 0; i < messages.size(); ++i) {
+        batch->push_back(
+            confirmation(messages[i], d_queue->name(), confirmResponse));
+    }
+
+    EXPECT_CALL(*d_mockCallback, onConfirm(_, _, confirmResponse))
+        .Times(k_THREADS * k_PER_THREAD);
+    d_injectConfirms(batch);
+    d_threadPool.drain();
+
+    EXPECT_THAT(producer->availableCredits(), Eq(k_THREADS * k_PER_THREAD));
+    EXPECT_TRUE(producer->waitForConfirms(bsls::TimeInterval(0, 1)));
+}
+
+TEST_P(ProducerImplMaxOutstandingTests, SequencedSendsAdvanceWatermark)
+{
+    bsl::shared_ptr<rmqa::ProducerImpl> producer(d_factory->create(
+        3, d_exchange, d_mockSendChannel, d_threadPool, d_eventLoop));
+
+    rmqt::Message messages[3] = {newMessage(), newMessage(), newMessage()};
+    for (bsl::uint64_t i = 0; i < 3; ++i) {
+        bsl::uint64_t sequenceNumber = 0;
+        EXPECT_THAT(producer->sendSequenced(messages[i],
+                                            d_queue->name(),
+                                            &sequenceNumber,
+                                            d_timeout),
+                    Eq(rmqp::Producer::SENDING));
+        EXPECT_THAT(sequenceNumber, Eq(i + 1));
+    }
+
+    // No callback is invoked for a sequenced message
+    EXPECT_CALL(*d_mockCallback, onConfirm(_, _, _)).Times(0);
+
+    // Out of order confirms only advance the watermark once the gap closes
+    d_injectConfirm(messages[1],
+                    d_queue->name(),
+                    rmqt::ConfirmResponse(rmqt::ConfirmResponse::REJECT));
+    d_threadPool.drain();
+    EXPECT_THAT(producer->confirmedThrough(), Eq(0));
+
+    d_injectConfirm(messages[0],
+                    d_queue->name(),
+                    rmqt::ConfirmResponse(rmqt::ConfirmResponse::ACK));
+    d_threadPool.drain();
+    EXPECT_THAT(producer->confirmedThrough(), Eq(2));
+
+    rmqp::Producer::FailedSequences failed = producer->takeFailedSequences();
+    ASSERT_THAT(failed.size(), Eq(1));
+    EXPECT_THAT(failed.begin()->first, Eq(2));
+    EXPECT_THAT(failed.begin()->second.status(),
+                Eq(rmqt::ConfirmResponse::REJECT));
+    EXPECT_TRUE(producer->takeFailedSequences().empty());
+
+    d_injectConfirm(messages[2],
+                    d_queue->name(),
+                    rmqt::ConfirmResponse(rmqt::ConfirmResponse::ACK));
+    d_threadPool.drain();
+    EXPECT_THAT(producer->confirmedThrough(), Eq(3));
+    EXPECT_TRUE(producer->waitForConfirms(bsls::TimeInterval(0, 1)));
+}
+
 TEST_P(ProducerImplMaxOutstandingTests, InflightLimitTimesOutSecondSend)
 {
     // Ensure sending two msgs to a producer with max oustanding of 1 does not
@@ -444,22 +861,357 @@ TEST_P(ProducerImplMaxOutstandingTests, InflightLimitTimesOutSecondSend)
     }
 }
 
+TEST_P(ProducerImplMaxOutstandingTests, SendBatchTimesOutWithoutCapacity)
+{
+    rmqt::ConfirmResponse confirmResponse(rmqt::ConfirmResponse::ACK);
+
+    bsl::shared_ptr<rmqa::ProducerImpl> producer(d_factory->create(
+        2, d_exchange, d_mockSendChannel, d_threadPool, d_eventLoop));
+
+    d_timeout = bsls::TimeInterval(0, 50000000); // 50 milliseconds
+
+    rmqt::Message msg1 = newMessage();
+    bsl::vector<rmqt::Message> batch;
+    batch.push_back(newMessage());
+    batch.push_back(newMessage());
+
+    EXPECT_CALL(*d_mockSendChannel, publishMessages(_, _, _))
+        .WillRepeatedly(Return());
+
+    {
+        EXPECT_THAT(
+            producer->send(
+                msg1, d_queue->name(), d_callback, bsls::TimeInterval()),
+            Eq(rmqp::Producer::SENDING));
+
+        // Only one of the two slots the batch needs is free
+        EXPECT_THAT(
+            producer->sendBatch(batch, d_queue->name(), d_callback, d_timeout),
+            Eq(rmqp::Producer::TIMEOUT));
+
+        EXPECT_CALL(*d_mockCallback, onConfirm(msg1, _, confirmResponse))
+            .WillOnce(Return());
+        d_injectConfirm(msg1, d_queue->name(), confirmResponse);
+        d_threadPool.drain();
+    }
+
+    d_threadPool.start();
+
+    EXPECT_THAT(
+        producer->sendBatch(batch, d_queue->name(), d_callback, d_timeout),
+        Eq(rmqp::Producer::SENDING));
+}
+
+TEST_P(ProducerImplMaxOutstandingTests, SendToManyConfirmsOnceForAllKeys)
+{
+    const rmqt::ConfirmResponse ack(rmqt::ConfirmResponse::ACK);
+    const rmqt::ConfirmResponse reject(rmqt::ConfirmResponse::REJECT);
+
+    bsl::shared_ptr<rmqa::ProducerImpl> producer(d_factory->create(
+        3, d_exchange, d_mockSendChannel, d_threadPool, d_eventLoop));
+
+    bsl::vector<bsl::string> keys;
+    keys.push_back("a");
+    keys.push_back("b");
+    keys.push_back("c");
+
+    bsl::vector<rmqt::Message> published;
+    EXPECT_CALL(*d_mockSendChannel,
+                publishToMany(
+                    SizeIs(3), keys, rmqt::Mandatory::RETURN_UNROUTABLE))
+        .WillOnce(SaveArg<0>(&published));
+
+    int calls = 0;
+    bsl::vector<rmqt::ConfirmResponse> responses;
+    EXPECT_THAT(producer->sendToMany(
+                    d_message,
+                    keys,
+                    bdlf::BindUtil::bind(
+                        &saveFanOutResponses, &calls, &responses, _1, _2, _3),
+                    d_timeout),
+                Eq(rmqp::Producer::SENDING));
+
+    ASSERT_THAT(published, SizeIs(3));
+    EXPECT_THAT(published[0].guid(), Eq(d_message.guid()));
+    EXPECT_THAT(published[1].guid(), Ne(published[0].guid()));
+    EXPECT_THAT(published[2].guid(), Ne(published[1].guid()));
+    EXPECT_THAT(published[2].payload(), Eq(d_message.payload()));
+
+    d_injectConfirm(published[0], "a", ack);
+    d_injectConfirm(published[1], "b", reject);
+    d_threadPool.drain();
+    EXPECT_THAT(calls, Eq(0));
+
+    d_threadPool.start();
+    d_injectConfirm(published[2], "c", ack);
+    d_threadPool.drain();
+
+    EXPECT_THAT(calls, Eq(1));
+    ASSERT_THAT(responses, SizeIs(3));
+    EXPECT_THAT(responses[0], Eq(ack));
+    EXPECT_THAT(responses[1], Eq(reject));
+    EXPECT_THAT(responses[2], Eq(ack));
+}
+
+TEST_P(ProducerImplMaxOutstandingTests, UrgentSendUsesReservedSlot)
+{
+    rmqt::ConfirmResponse confirmResponse(rmqt::ConfirmResponse::ACK);
+
+    bsl::shared_ptr<rmqa::ProducerImpl> producer(d_factory->create(
+        1, d_exchange, d_mockSendChannel, d_threadPool, d_eventLoop));
+    ASSERT_THAT(rmqa::ProducerImpl::urgentReserve(1), Eq(1));
+
+    d_timeout = bsls::TimeInterval(0, 50000000); // 50 milliseconds
+
+    rmqt::Message msg = newMessage(), urgent1 = newMessage(),
+                  urgent2 = newMessage();
+    EXPECT_CALL(*d_mockSendChannel,
+                publishUrgent(
+                    _, d_queue->name(), rmqt::Mandatory::RETURN_UNROUTABLE))
+        .Times(2);
+    {
+        EXPECT_THAT(producer->send(
+                        msg, d_queue->name(), d_callback, bsls::TimeInterval()),
+                    Eq(rmqp::Producer::SENDING));
+
+        // The limit is reached, but the reserve has room
+        EXPECT_THAT(producer->sendUrgent(
+                        urgent1, d_queue->name(), d_callback, d_timeout),
+            Eq(rmqp::Producer::SENDING));
+        EXPECT_THAT(producer->sendUrgent(
+                        urgent2, d_queue->name(), d_callback, d_timeout),
+            Eq(rmqp::Producer::TIMEOUT));
+
+        EXPECT_CALL(*d_mockCallback, onConfirm(urgent1, _, confirmResponse));
+        d_injectConfirm(urgent1, d_queue->name(), confirmResponse);
+        d_threadPool.drain();
+    }
+
+    d_threadPool.start();
+
+    {
+        // The confirm returned the reserved slot, not one of the limit
+        EXPECT_THAT(producer->sendUrgent(
+                        urgent2, d_queue->name(), d_callback, d_timeout),
+            Eq(rmqp::Producer::SENDING));
+        EXPECT_THAT(
+            producer->trySend(newMessage(), d_queue->name(), d_callback),
+            Eq(rmqp::Producer::INFLIGHT_LIMIT));
+
+        EXPECT_CALL(*d_mockCallback, onConfirm(_, _, confirmResponse))
+            .Times(2);
+        d_injectConfirm(msg, d_queue->name(), confirmResponse);
+        d_injectConfirm(urgent2, d_queue->name(), confirmResponse);
+        d_threadPool.drain();
+    }
+}
+
+MATCHER_P(SpooledMessageMatches, expected, "")
+{
+    return arg == expected && arg.payloadSize() == expected.payloadSize();
+}
+
+TEST_P(ProducerImplMaxOutstandingTests, ExhaustedMemoryBudgetRefusesSends)
+{
+    rmqt::ConfirmResponse confirmResponse(rmqt::ConfirmResponse::ACK);
+
+    bsl::shared_ptr<rmqa::ProducerImpl> producer(d_factory->create(
+        10, d_exchange, d_mockSendChannel, d_threadPool, d_eventLoop));
+    bsl::shared_ptr<rmqamqp::MemoryBudget> budget =
+        bsl::make_shared<rmqamqp::MemoryBudget>(10);
+    producer->setMemoryBudget(budget);
+
+    bsls::AtomicInt writableCalls(0);
+    producer->setWritableCallback(
+        bdlf::BindUtil::bind(&countCall, &writableCalls), 1);
+
+    const rmqt::Message message(
+        bsl::make_shared<bsl::vector<uint8_t> >(10, 'x'));
+    EXPECT_THAT(producer->trySend(message, d_queue->name(), d_callback),
+                Eq(rmqp::Producer::SENDING));
+    EXPECT_THAT(budget->used(), Eq(10));
+    EXPECT_THAT(producer->availableCredits(), Eq(0));
+
+    EXPECT_THAT(producer->trySend(newMessage(), d_queue->name(), d_callback),
+                Eq(rmqp::Producer::INFLIGHT_LIMIT));
+    EXPECT_THAT(producer->send(newMessage(),
+                               d_queue->name(),
+                               d_callback,
+                               bsls::TimeInterval(0.01)),
+                Eq(rmqp::Producer::TIMEOUT));
+
+    EXPECT_CALL(*d_mockCallback, onConfirm(_, _, confirmResponse));
+    d_injectConfirm(message, d_queue->name(), confirmResponse);
+    d_threadPool.drain();
+
+    EXPECT_THAT(budget->used(), Eq(0));
+    EXPECT_THAT(writableCalls.load(), Eq(1));
+    EXPECT_THAT(producer->availableCredits(), Eq(10));
+}
+
+TEST_P(ProducerImplMaxOutstandingTests, MemoryBudgetRoomResumesProducer)
+{
+    bsl::shared_ptr<rmqa::ProducerImpl> producer(d_factory->create(
+        10, d_exchange, d_mockSendChannel, d_threadPool, d_eventLoop));
+    bsl::shared_ptr<rmqamqp::MemoryBudget> budget =
+        bsl::make_shared<rmqamqp::MemoryBudget>(10);
+    producer->setMemoryBudget(budget);
+
+    bsls::AtomicInt writableCalls(0);
+    producer->setWritableCallback(
+        bdlf::BindUtil::bind(&countCall, &writableCalls), 1);
+
+    // Held by another producer or consumer of the context
+    budget->acquire(10);
+    EXPECT_THAT(producer->trySend(newMessage(), d_queue->name(), d_callback),
+                Eq(rmqp::Producer::INFLIGHT_LIMIT));
+
+    budget->release(10);
+    d_threadPool.drain();
+    EXPECT_THAT(writableCalls.load(), Eq(1));
+}
+
+TEST_P(ProducerImplMaxOutstandingTests, RateLimitPacesSends)
+{
+    bsl::shared_ptr<rmqtestutil::MockTimerFactory> timerFactory =
+        bsl::make_shared<rmqtestutil::MockTimerFactory>();
+    EXPECT_CALL(d_eventLoop, timerFactory())
+        .WillRepeatedly(Return(timerFactory));
+
+    bsl::shared_ptr<rmqa::ProducerImpl> producer(d_factory->create(
+        10, d_exchange, d_mockSendChannel, d_threadPool, d_eventLoop));
+    producer->setRateLimiter(bsl::make_shared<rmqamqp::RateLimiter>(
+        rmqt::RateLimit().setMessageRate(100, 1)));
+
+    bsls::AtomicInt writableCalls(0);
+    producer->setWritableCallback(
+        bdlf::BindUtil::bind(&countCall, &writableCalls), 1);
+
+    EXPECT_THAT(producer->trySend(newMessage(), d_queue->name(), d_callback),
+                Eq(rmqp::Producer::SENDING));
+    EXPECT_THAT(producer->availableCredits(), Eq(0));
+    EXPECT_THAT(producer->trySend(newMessage(), d_queue->name(), d_callback),
+                Eq(rmqp::Producer::INFLIGHT_LIMIT));
+
+    // The rate timer fires once the limiter has a token again
+    bslmt::ThreadUtil::microSleep(20 * 1000);
+    timerFactory->step_time(bsls::TimeInterval(1));
+    d_threadPool.drain();
+    EXPECT_THAT(writableCalls.load(), Eq(1));
+
+    // A blocking send waits for the limit instead
+    EXPECT_THAT(producer->send(newMessage(),
+                               d_queue->name(),
+                               d_callback,
+                               bsls::TimeInterval(1)),
+                Eq(rmqp::Producer::SENDING));
+}
+
+TEST_P(ProducerImplMaxOutstandingTests, BlockedConnectionHoldsBackSends)
+{
+    bsl::shared_ptr<rmqa::ProducerImpl> producer(d_factory->create(
+        10, d_exchange, d_mockSendChannel, d_threadPool, d_eventLoop));
+    bsl::shared_ptr<rmqamqp::PublishGate> gate =
+        bsl::make_shared<rmqamqp::PublishGate>();
+    producer->setPublishGate(gate);
+
+    bsls::AtomicInt writableCalls(0);
+    producer->setWritableCallback(
+        bdlf::BindUtil::bind(&countCall, &writableCalls), 1);
+
+    gate->close("low on memory");
+    EXPECT_THAT(producer->availableCredits(), Eq(0));
+    EXPECT_THAT(producer->trySend(newMessage(), d_queue->name(), d_callback),
+                Eq(rmqp::Producer::INFLIGHT_LIMIT));
+    EXPECT_THAT(producer->send(newMessage(),
+                               d_queue->name(),
+                               d_callback,
+                               bsls::TimeInterval(0.01)),
+                Eq(rmqp::Producer::TIMEOUT));
+
+    gate->open();
+    d_threadPool.drain();
+    EXPECT_THAT(writableCalls.load(), Eq(1));
+    EXPECT_THAT(producer->availableCredits(), Eq(10));
+}
+
+TEST_P(ProducerImplMaxOutstandingTests, SpoolAcceptsSendsBeyondLimit)
+{
+    rmqt::ConfirmResponse confirmResponse(rmqt::ConfirmResponse::ACK);
+
+    bsl::shared_ptr<rmqa::ProducerImpl> producer(d_factory->create(
+        1, d_exchange, d_mockSendChannel, d_threadPool, d_eventLoop));
+    producer->setPublishSpool(rmqa::PublishSpool::create("", 1024, 1024, 0));
+
+    const rmqt::Message first(bsl::make_shared<bsl::vector<uint8_t> >(5));
+    const rmqt::Message second(bsl::make_shared<bsl::vector<uint8_t> >(7));
+
+    EXPECT_CALL(*d_mockSendChannel,
+                publishMessage(SpooledMessageMatches(first), _, _));
+    EXPECT_THAT(
+        producer->send(first, d_queue->name(), d_callback, d_timeout),
+        Eq(rmqp::Producer::SENDING));
+
+    // Spooled rather than refused, and not published yet
+    EXPECT_THAT(producer->trySend(second, d_queue->name(), d_callback),
+                Eq(rmqp::Producer::SENDING));
+    EXPECT_THAT(producer->availableCredits(), Eq(1));
+    Mock::VerifyAndClearExpectations(d_mockSendChannel.get());
+
+    // The first confirm frees the limit for the spooled message
+    EXPECT_CALL(*d_mockSendChannel,
+                publishMessage(SpooledMessageMatches(second), _, _));
+    EXPECT_CALL(*d_mockCallback, onConfirm(_, _, confirmResponse));
+    d_injectConfirm(first, d_queue->name(), confirmResponse);
+
+    d_threadPool.drain();
+}
+
+TEST_P(ProducerImplMaxOutstandingTests, FullSpoolReachesLimit)
+{
+    bsl::shared_ptr<rmqa::ProducerImpl> producer(d_factory->create(
+        1, d_exchange, d_mockSendChannel, d_threadPool, d_eventLoop));
+    producer->setPublishSpool(rmqa::PublishSpool::create("", 1024, 5, 0));
+
+    const rmqt::Message spooled(bsl::make_shared<bsl::vector<uint8_t> >(5));
+
+    // The first takes the limit, the second fills the spool to its
+    // high-water mark
+    EXPECT_THAT(producer->trySend(d_message, d_queue->name(), d_callback),
+                Eq(rmqp::Producer::SENDING));
+    EXPECT_THAT(producer->trySend(spooled, d_queue->name(), d_callback),
+                Eq(rmqp::Producer::SENDING));
+    EXPECT_THAT(producer->availableCredits(), Eq(0));
+
+    EXPECT_THAT(producer->trySend(newMessage(), d_queue->name(), d_callback),
+                Eq(rmqp::Producer::INFLIGHT_LIMIT));
+    EXPECT_THAT(producer->send(newMessage(),
+                               d_queue->name(),
+                               d_callback,
+                               bsls::TimeInterval(0, 10 * 1000 * 1000)),
+                Eq(rmqp::Producer::TIMEOUT));
+}
+
 class ProducerImplConfirmTypeTests : public ProducerImplTests {
   public:
     bsl::shared_ptr<rmqa::ProducerImpl>
         d_producer; // shared_ptr to defer construction
+    rmqamqp::SendChannel::MessageBatchConfirmCallback d_injectConfirms;
     rmqamqp::SendChannel::MessageConfirmCallback d_injectConfirm;
 
     ProducerImplConfirmTypeTests()
     : d_producer()
+    , d_injectConfirms()
+    , d_injectConfirm(
+          bdlf::BindUtil::bind(&confirmAsBatch, &d_injectConfirms, _1, _2, _3))
     {
     }
 
     virtual void SetUp()
     {
         // Ensure we publish to an with the queue name as routing key
-        EXPECT_CALL(*d_mockSendChannel, setCallback(_))
-            .WillOnce(SaveArg<0>(&d_injectConfirm));
+        EXPECT_CALL(*d_mockSendChannel, setBatchCallback(_))
+            .WillOnce(SaveArg<0>(&d_injectConfirms));
         d_producer =
             bsl::make_shared<rmqa::ProducerImpl>(1,
                                                  d_mockSendChannel,
@@ -0,0 +1,149 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_publishspool.h>
+
+#include <rmqt_message.h>
+#include <rmqt_properties.h>
+
+#include <bsl_cstdint.h>
+#include <bsl_memory.h>
+#include <bsl_vector.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqa;
+using namespace ::testing;
+
+namespace {
+
+const rmqt::Mandatory::Value k_MANDATORY = rmqt::Mandatory::RETURN_UNROUTABLE;
+
+rmqt::Message makeMessage(bsl::size_t size, bsl::uint8_t fill)
+{
+    return rmqt::Message(
+        bsl::make_shared<bsl::vector<bsl::uint8_t> >(size, fill),
+        "message-id");
+}
+
+bsl::vector<bsl::uint8_t> payloadOf(const rmqt::Message& message)
+{
+    const bsl::uint8_t* payload = message.payload();
+    return bsl::vector<bsl::uint8_t>(payload,
+                                     payload + message.payloadSize());
+}
+
+} // namespace
+
+TEST(PublishSpool, InvalidWaterMarksAreRejected)
+{
+    EXPECT_FALSE(PublishSpool::create("", 0, 0, 0));
+    EXPECT_FALSE(PublishSpool::create("", 100, 10, 20));
+}
+
+TEST(PublishSpool, PopsInOrderRestoringPayloads)
+{
+    bsl::shared_ptr<PublishSpool> spool = PublishSpool::create("", 64, 64, 0);
+    ASSERT_TRUE(spool);
+
+    const rmqt::Message first  = makeMessage(10, 1);
+    const rmqt::Message second = makeMessage(20, 2);
+
+    EXPECT_TRUE(
+        spool->push(first, "key-1", rmqt::Mandatory::RETURN_UNROUTABLE));
+    EXPECT_TRUE(
+        spool->push(second, "key-2", rmqt::Mandatory::DISCARD_UNROUTABLE));
+    EXPECT_THAT(spool->count(), Eq(2));
+    EXPECT_THAT(spool->bytes(), Eq(30));
+
+    PublishSpool::Entry entry;
+    ASSERT_TRUE(spool->pop(&entry));
+    EXPECT_THAT(entry.message.guid(), Eq(first.guid()));
+    EXPECT_THAT(entry.message.messageId(), Eq("message-id"));
+    EXPECT_THAT(payloadOf(entry.message), Eq(payloadOf(first)));
+    EXPECT_THAT(entry.routingKey, Eq("key-1"));
+    EXPECT_THAT(entry.mandatory, Eq(rmqt::Mandatory::RETURN_UNROUTABLE));
+
+    ASSERT_TRUE(spool->pop(&entry));
+    EXPECT_THAT(entry.message.guid(), Eq(second.guid()));
+    EXPECT_THAT(payloadOf(entry.message), Eq(payloadOf(second)));
+    EXPECT_THAT(entry.mandatory, Eq(rmqt::Mandatory::DISCARD_UNROUTABLE));
+
+    EXPECT_TRUE(spool->empty());
+    EXPECT_FALSE(spool->pop(&entry));
+}
+
+TEST(PublishSpool, StopsAtHighWaterMarkUntilLowWaterMark)
+{
+    bsl::shared_ptr<PublishSpool> spool =
+        PublishSpool::create("", 100, 30, 10);
+    ASSERT_TRUE(spool);
+
+    EXPECT_TRUE(spool->push(makeMessage(10, 1), "", k_MANDATORY));
+    EXPECT_TRUE(spool->push(makeMessage(10, 2), "", k_MANDATORY));
+    EXPECT_TRUE(spool->push(makeMessage(10, 3), "", k_MANDATORY));
+    EXPECT_FALSE(spool->accepting());
+    EXPECT_FALSE(spool->push(makeMessage(1, 4), "", k_MANDATORY));
+
+    PublishSpool::Entry entry;
+    ASSERT_TRUE(spool->pop(&entry));
+    EXPECT_FALSE(spool->accepting());
+
+    ASSERT_TRUE(spool->pop(&entry));
+    EXPECT_TRUE(spool->accepting());
+    EXPECT_TRUE(spool->push(makeMessage(1, 4), "", k_MANDATORY));
+}
+
+TEST(PublishSpool, WrapsAroundTheRing)
+{
+    bsl::shared_ptr<PublishSpool> spool = PublishSpool::create("", 30, 30, 30);
+    ASSERT_TRUE(spool);
+
+    PublishSpool::Entry entry;
+    for (bsl::uint8_t i = 0; i < 20; ++i) {
+        const rmqt::Message message = makeMessage(12, i);
+        ASSERT_TRUE(spool->push(message, "", k_MANDATORY));
+        if (spool->count() == 2) {
+            ASSERT_TRUE(spool->pop(&entry));
+            EXPECT_THAT(entry.message.payload()[0], Eq(i - 1));
+        }
+    }
+}
+
+TEST(PublishSpool, RefusesPayloadsLargerThanTheRing)
+{
+    bsl::shared_ptr<PublishSpool> spool = PublishSpool::create("", 16, 16, 0);
+    ASSERT_TRUE(spool);
+
+    EXPECT_FALSE(spool->push(makeMessage(17, 1), "", k_MANDATORY));
+    EXPECT_TRUE(spool->accepting());
+    EXPECT_TRUE(spool->push(makeMessage(16, 1), "", k_MANDATORY));
+}
+
+TEST(PublishSpool, MapsAFileInADirectory)
+{
+    bsl::shared_ptr<PublishSpool> spool =
+        PublishSpool::create("/tmp", 4096, 4096, 0);
+    ASSERT_TRUE(spool);
+
+    const rmqt::Message message = makeMessage(100, 7);
+    EXPECT_TRUE(spool->push(message, "", k_MANDATORY));
+
+    PublishSpool::Entry entry;
+    ASSERT_TRUE(spool->pop(&entry));
+    EXPECT_THAT(payloadOf(entry.message), Eq(payloadOf(message)));
+}
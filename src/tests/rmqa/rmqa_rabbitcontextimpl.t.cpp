@@ -30,6 +30,7 @@
 
 #include <bdlmt_threadpool.h>
 #include <bsl_memory.h>
+#include <bsl_string.h>
 #include <bslma_managedptr.h>
 
 using namespace BloombergLP;
@@ -67,7 +68,7 @@ class RabbitContextImplTests : public Test {
                     .setConnectionErrorThreshold(d_connectionErrorThreshold))
     {
         ON_CALL(*d_mockEventLoop, isStarted()).WillByDefault(Return(false));
-        ON_CALL(*d_mockEventLoop, resolver(false))
+        ON_CALL(*d_mockEventLoop, resolver(false, _))
             .WillByDefault(Return(bsl::shared_ptr<rmqio::Resolver>()));
         ON_CALL(*d_mockEventLoop, timerFactory())
             .WillByDefault(Return(bsl::shared_ptr<rmqio::TimerFactory>()));
@@ -80,7 +81,7 @@ class RabbitContextImplTests : public Test {
 
     void createExpectations()
     {
-        EXPECT_CALL(*d_mockEventLoop, resolver(false)).Times(1);
+        EXPECT_CALL(*d_mockEventLoop, resolver(false, _)).Times(1);
         EXPECT_CALL(*d_mockEventLoop, timerFactory())
             .Times(2)
             .WillRepeatedly(Return(d_mockTimerFactory));
@@ -95,6 +96,22 @@ TEST_F(RabbitContextImplTests, ItsAlive)
     rmqa::RabbitContextImpl context(getMockEventLoop(), d_options);
 }
 
+TEST_F(RabbitContextImplTests, ShutdownWithoutConnectionsSucceeds)
+{
+    createExpectations();
+    rmqa::RabbitContextImpl context(getMockEventLoop(), d_options);
+
+    EXPECT_TRUE(context.shutdown(bsls::TimeInterval(1)));
+}
+
+TEST_F(RabbitContextImplTests, StatsWithoutConnectionsIsEmpty)
+{
+    createExpectations();
+    rmqa::RabbitContextImpl context(getMockEventLoop(), d_options);
+
+    EXPECT_TRUE(context.stats(bsls::TimeInterval(1)).empty());
+}
+
 TEST_F(RabbitContextImplTests, ErrorWhenProvideNullEndpoint)
 {
     createExpectations();
@@ -149,3 +166,69 @@ TEST_F(RabbitContextImplTests, ErrorWhenCantStartWorkerThread)
     EXPECT_TRUE(!conn);
     EXPECT_EQ("Event loop worker thread not started", conn.error());
 }
+
+namespace {
+bsl::size_t alwaysSecondEventLoop(const bsl::string&) { return 1; }
+} // namespace
+
+class RabbitContextImplEventLoopPoolTests : public RabbitContextImplTests {
+  protected:
+    bsl::shared_ptr<rmqtestutil::MockEventLoop> d_secondMockEventLoop;
+
+    RabbitContextImplEventLoopPoolTests()
+    : d_secondMockEventLoop(
+          bsl::make_shared<rmqtestutil::MockEventLoop>(d_mockTimerFactory))
+    {
+        ON_CALL(*d_secondMockEventLoop, isStarted())
+            .WillByDefault(Return(false));
+        EXPECT_CALL(*d_secondMockEventLoop, resolver(false, _)).Times(1);
+        EXPECT_CALL(*d_secondMockEventLoop, timerFactory())
+            .Times(2)
+            .WillRepeatedly(Return(d_mockTimerFactory));
+        EXPECT_CALL(*d_secondMockEventLoop, waitForEventLoopExit(_)).Times(1);
+        createExpectations();
+    }
+
+    rmqa::RabbitContextImpl::EventLoops eventLoops()
+    {
+        rmqa::RabbitContextImpl::EventLoops loops;
+        loops.push_back(d_mockEventLoop);
+        loops.push_back(d_secondMockEventLoop);
+        return loops;
+    }
+
+    void createConnection(rmqa::RabbitContextImpl& context)
+    {
+        context
+            .createNewConnection(
+                "name",
+                bsl::make_shared<rmqt::SimpleEndpoint>("localhost", "/", 5672),
+                bsl::make_shared<rmqt::PlainCredentials>("guest", "guest"),
+                "name suffix")
+            .blockResult();
+    }
+};
+
+TEST_F(RabbitContextImplEventLoopPoolTests, ConnectionsAssignedRoundRobin)
+{
+    EXPECT_CALL(*d_mockEventLoop, isStarted()).Times(2);
+    EXPECT_CALL(*d_secondMockEventLoop, isStarted()).Times(1);
+
+    rmqa::RabbitContextImpl context(eventLoops(), d_options);
+
+    createConnection(context);
+    createConnection(context);
+    createConnection(context);
+}
+
+TEST_F(RabbitContextImplEventLoopPoolTests, ConnectionsFollowAffinity)
+{
+    EXPECT_CALL(*d_mockEventLoop, isStarted()).Times(0);
+    EXPECT_CALL(*d_secondMockEventLoop, isStarted()).Times(2);
+
+    d_options.setEventLoopAffinity(&alwaysSecondEventLoop);
+    rmqa::RabbitContextImpl context(eventLoops(), d_options);
+
+    createConnection(context);
+    createConnection(context);
+}
@@ -29,3 +29,27 @@ TEST(RabbitContextOptions, Defaults)
     EXPECT_FALSE(t.threadpool());
     t.errorCallback()("heres an error", -1);
 }
+
+TEST(RabbitContextOptions, ProfilesSetTuningTogether)
+{
+    rmqa::RabbitContextOptions t;
+    EXPECT_FALSE(t.frameMax());
+    EXPECT_FALSE(t.channelMax());
+
+    t.applyProfile(RabbitContextOptions::Profile::BULK_THROUGHPUT);
+    EXPECT_EQ(t.frameMax().value(), 1024u * 1024u);
+    EXPECT_EQ(t.maxReadBytes(), 4u * 1024u * 1024u);
+    EXPECT_EQ(t.writeCoalescing()->first, 1024u * 1024u);
+    EXPECT_TRUE(t.deferWrites());
+    EXPECT_GT(t.defaultAckCoalescingDelay(), bsls::TimeInterval());
+
+    t.applyProfile(RabbitContextOptions::Profile::LOW_LATENCY);
+    EXPECT_EQ(t.frameMax().value(), 128u * 1024u);
+    EXPECT_EQ(t.maxReadBytes(), 0u);
+    EXPECT_FALSE(t.deferWrites());
+    EXPECT_EQ(t.defaultAckCoalescingDelay(), bsls::TimeInterval());
+
+    t.setFrameMax(65536).setChannelMax(16);
+    EXPECT_EQ(t.frameMax().value(), 65536u);
+    EXPECT_EQ(t.channelMax().value(), 16);
+}
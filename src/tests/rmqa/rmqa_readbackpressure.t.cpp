@@ -0,0 +1,93 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_readbackpressure.h>
+
+#include <rmqtestutil_callcount.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqa;
+using namespace ::testing;
+
+class ReadBackpressureTests : public Test {
+  public:
+    ReadBackpressureTests()
+    : d_pauses(0)
+    , d_resumes(0)
+    {
+    }
+
+    void watch(ReadBackpressure& backpressure)
+    {
+        backpressure.setCallbacks(rmqtestutil::CallCount(&d_pauses),
+                                  rmqtestutil::CallCount(&d_resumes));
+    }
+
+    int d_pauses;
+    int d_resumes;
+};
+
+TEST_F(ReadBackpressureTests, PausesAtHighJobsUntilLowJobs)
+{
+    ReadBackpressure backpressure(3, 1, 0, 0);
+    watch(backpressure);
+
+    backpressure.add(2, 100);
+    EXPECT_THAT(d_pauses, Eq(0));
+
+    backpressure.add(1, 100);
+    EXPECT_THAT(d_pauses, Eq(1));
+    EXPECT_TRUE(backpressure.paused());
+
+    backpressure.add(1, 100);
+    EXPECT_THAT(d_pauses, Eq(1));
+
+    backpressure.remove(2, 200);
+    EXPECT_THAT(d_resumes, Eq(0));
+
+    backpressure.remove(1, 100);
+    EXPECT_THAT(d_resumes, Eq(1));
+    EXPECT_FALSE(backpressure.paused());
+    EXPECT_THAT(backpressure.jobs(), Eq(1));
+    EXPECT_THAT(backpressure.bytes(), Eq(100));
+}
+
+TEST_F(ReadBackpressureTests, ResumesOnlyOnceBothMarksDrain)
+{
+    ReadBackpressure backpressure(10, 5, 1000, 100);
+    watch(backpressure);
+
+    backpressure.add(1, 1000);
+    EXPECT_THAT(d_pauses, Eq(1));
+
+    backpressure.add(9, 0);
+    backpressure.remove(1, 1000);
+    EXPECT_THAT(d_resumes, Eq(0));
+
+    backpressure.remove(4, 0);
+    EXPECT_THAT(d_resumes, Eq(1));
+}
+
+TEST_F(ReadBackpressureTests, ZeroHighWaterMarksNeverPause)
+{
+    ReadBackpressure backpressure(0, 0, 0, 0);
+    watch(backpressure);
+
+    backpressure.add(1000, 1000000);
+    EXPECT_THAT(d_pauses, Eq(0));
+}
@@ -0,0 +1,132 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_redeliveryfilter.h>
+
+#include <rmqt_envelope.h>
+#include <rmqt_message.h>
+
+#include <bsls_timeinterval.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <bsl_memory.h>
+#include <bsl_string.h>
+#include <bsl_vector.h>
+
+using namespace BloombergLP;
+using namespace rmqa;
+using namespace ::testing;
+
+namespace {
+
+rmqt::Message makeMessage(const bsl::string& messageId)
+{
+    return rmqt::Message(bsl::make_shared<bsl::vector<uint8_t> >(4, 'x'),
+                         messageId);
+}
+
+rmqt::Envelope makeEnvelope(bool redelivered)
+{
+    return rmqt::Envelope(1, 1, "tag", "exchange", "key", redelivered);
+}
+
+bsl::string routingKey(const rmqt::Message&, const rmqt::Envelope& envelope)
+{
+    return envelope.routingKey();
+}
+
+} // namespace
+
+TEST(RedeliveryFilterTests, ContainsInsertedKeys)
+{
+    RedeliveryFilter filter(10, bsls::TimeInterval());
+
+    EXPECT_FALSE(filter.contains("a", bsls::TimeInterval(1)));
+    filter.insert("a", bsls::TimeInterval(1));
+    EXPECT_TRUE(filter.contains("a", bsls::TimeInterval(2)));
+    EXPECT_FALSE(filter.contains("b", bsls::TimeInterval(2)));
+}
+
+TEST(RedeliveryFilterTests, IgnoresEmptyKeys)
+{
+    RedeliveryFilter filter(10, bsls::TimeInterval());
+
+    filter.insert("", bsls::TimeInterval(1));
+    EXPECT_FALSE(filter.contains("", bsls::TimeInterval(1)));
+    EXPECT_THAT(filter.size(), Eq(0));
+}
+
+TEST(RedeliveryFilterTests, DropsLeastRecentlyAckedOverCapacity)
+{
+    RedeliveryFilter filter(2, bsls::TimeInterval());
+
+    filter.insert("a", bsls::TimeInterval(1));
+    filter.insert("b", bsls::TimeInterval(2));
+    // Acked again, so "b" is now the least recent
+    filter.insert("a", bsls::TimeInterval(3));
+    filter.insert("c", bsls::TimeInterval(4));
+
+    EXPECT_THAT(filter.size(), Eq(2));
+    EXPECT_TRUE(filter.contains("a", bsls::TimeInterval(5)));
+    EXPECT_FALSE(filter.contains("b", bsls::TimeInterval(5)));
+    EXPECT_TRUE(filter.contains("c", bsls::TimeInterval(5)));
+}
+
+TEST(RedeliveryFilterTests, ForgetsKeysOutsideWindow)
+{
+    RedeliveryFilter filter(10, bsls::TimeInterval(10));
+
+    filter.insert("a", bsls::TimeInterval(1));
+    filter.insert("b", bsls::TimeInterval(8));
+    EXPECT_TRUE(filter.contains("a", bsls::TimeInterval(11)));
+    EXPECT_FALSE(filter.contains("a", bsls::TimeInterval(12)));
+
+    // Inserting expires the oldest keys too
+    filter.insert("c", bsls::TimeInterval(19));
+    EXPECT_THAT(filter.size(), Eq(1));
+}
+
+TEST(RedeliveryFilterTests, PassesFirstDeliveries)
+{
+    RedeliveryFilter filter(10, bsls::TimeInterval());
+
+    filter.processed(makeMessage("id"), makeEnvelope(false));
+
+    EXPECT_TRUE(filter.isUnprocessed(makeMessage("id"), makeEnvelope(false)));
+    EXPECT_FALSE(filter.isUnprocessed(makeMessage("id"), makeEnvelope(true)));
+    EXPECT_TRUE(
+        filter.isUnprocessed(makeMessage("other"), makeEnvelope(true)));
+}
+
+TEST(RedeliveryFilterTests, PassesRedeliveriesWithoutKey)
+{
+    RedeliveryFilter filter(10, bsls::TimeInterval());
+
+    filter.processed(makeMessage(""), makeEnvelope(false));
+
+    EXPECT_TRUE(filter.isUnprocessed(makeMessage(""), makeEnvelope(true)));
+}
+
+TEST(RedeliveryFilterTests, UsesKeyFunc)
+{
+    RedeliveryFilter filter(10, bsls::TimeInterval(), &routingKey);
+
+    filter.processed(makeMessage("id"), makeEnvelope(false));
+
+    EXPECT_FALSE(
+        filter.isUnprocessed(makeMessage("other"), makeEnvelope(true)));
+}
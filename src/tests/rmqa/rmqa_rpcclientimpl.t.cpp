@@ -0,0 +1,161 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_rpcclientimpl.h>
+
+#include <rmqtestutil_mockchannel.t.h>
+#include <rmqtestutil_mockeventloop.t.h>
+
+#include <rmqt_consumerackqueue.h>
+#include <rmqt_envelope.h>
+#include <rmqt_message.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <bsl_memory.h>
+#include <bsl_string.h>
+
+using namespace BloombergLP;
+using namespace ::testing;
+
+namespace {
+
+rmqt::Message reply(const bsl::string& correlationId)
+{
+    rmqt::Message message;
+    message.properties().correlationId = correlationId;
+    return message;
+}
+
+rmqt::Envelope envelope()
+{
+    return rmqt::Envelope(1, 0, "tag", "", "amq.rabbitmq.reply-to", false);
+}
+
+class RpcClientImplTests : public Test {
+  public:
+    RpcClientImplTests()
+    : d_eventLoop()
+    , d_channel(bsl::make_shared<NiceMock<rmqtestutil::MockReceiveChannel> >(
+          bsl::make_shared<rmqt::ConsumerAckQueue>()))
+    , d_onReply()
+    , d_sent()
+    {
+        ON_CALL(*d_channel, consume(_, _, _))
+            .WillByDefault(DoAll(SaveArg<1>(&d_onReply),
+                                 Return(rmqt::Result<>())));
+        ON_CALL(*d_channel, publish(_, _, _))
+            .WillByDefault(
+                DoAll(SaveArg<0>(&d_sent), Return(rmqt::Result<>())));
+    }
+
+    bsl::shared_ptr<rmqa::RpcClientImpl> makeClient()
+    {
+        bsl::shared_ptr<rmqa::RpcClientImpl> client =
+            bsl::make_shared<rmqa::RpcClientImpl>(
+                d_channel, "requests", bsl::ref(d_eventLoop));
+        EXPECT_TRUE(client->start());
+        return client;
+    }
+
+    NiceMock<rmqtestutil::MockEventLoop> d_eventLoop;
+    bsl::shared_ptr<NiceMock<rmqtestutil::MockReceiveChannel> > d_channel;
+    rmqamqp::ReceiveChannel::MessageCallback d_onReply;
+    rmqt::Message d_sent;
+};
+
+} // namespace
+
+TEST_F(RpcClientImplTests, ConsumesDirectReplyTo)
+{
+    EXPECT_CALL(*d_channel, consume(_, _, _));
+
+    bsl::shared_ptr<rmqa::RpcClientImpl> client = makeClient();
+}
+
+TEST_F(RpcClientImplTests, PublishesWithReplyToAndCorrelationId)
+{
+    bsl::shared_ptr<rmqa::RpcClientImpl> client = makeClient();
+
+    EXPECT_CALL(*d_channel, publish(_, bsl::string("requests"), "key"));
+
+    rmqt::Future<rmqt::Message> future = client->call(rmqt::Message(), "key");
+
+    ASSERT_FALSE(d_sent.properties().correlationId.isNull());
+    ASSERT_FALSE(d_sent.properties().replyTo.isNull());
+    EXPECT_EQ(d_sent.properties().replyTo.value(),
+              bsl::string(rmqa::RpcClientImpl::k_REPLY_TO_QUEUE));
+    EXPECT_FALSE(future.tryResult());
+}
+
+TEST_F(RpcClientImplTests, ReplyResolvesMatchingCall)
+{
+    bsl::shared_ptr<rmqa::RpcClientImpl> client = makeClient();
+
+    rmqt::Future<rmqt::Message> first = client->call(rmqt::Message(), "key");
+    const bsl::string firstId = d_sent.properties().correlationId.value();
+
+    rmqt::Future<rmqt::Message> second = client->call(rmqt::Message(), "key");
+    const bsl::string secondId = d_sent.properties().correlationId.value();
+
+    EXPECT_NE(firstId, secondId);
+
+    d_onReply(reply(secondId), envelope());
+
+    EXPECT_FALSE(first.tryResult());
+    rmqt::Result<rmqt::Message> result = second.tryResult();
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result.value()->properties().correlationId.value(), secondId);
+}
+
+TEST_F(RpcClientImplTests, IgnoresUnknownReplies)
+{
+    bsl::shared_ptr<rmqa::RpcClientImpl> client = makeClient();
+
+    rmqt::Future<rmqt::Message> future = client->call(rmqt::Message(), "key");
+
+    d_onReply(reply("not-ours"), envelope());
+    d_onReply(rmqt::Message(), envelope());
+
+    EXPECT_FALSE(future.tryResult());
+}
+
+TEST_F(RpcClientImplTests, PublishErrorFailsCall)
+{
+    bsl::shared_ptr<rmqa::RpcClientImpl> client = makeClient();
+
+    EXPECT_CALL(*d_channel, publish(_, _, _))
+        .WillOnce(Return(rmqt::Result<>("No consumer", 1)));
+
+    rmqt::Future<rmqt::Message> future = client->call(rmqt::Message(), "key");
+
+    rmqt::Result<rmqt::Message> result = future.tryResult();
+    EXPECT_FALSE(result);
+    EXPECT_EQ(result.error(), "No consumer");
+}
+
+TEST_F(RpcClientImplTests, DestructionFailsPendingCalls)
+{
+    bsl::shared_ptr<rmqa::RpcClientImpl> client = makeClient();
+
+    rmqt::Future<rmqt::Message> future = client->call(rmqt::Message(), "key");
+
+    client.reset();
+
+    rmqt::Result<rmqt::Message> result = future.tryResult();
+    EXPECT_FALSE(result);
+    EXPECT_NE(result.returnCode(), rmqt::TIMEOUT);
+}
@@ -0,0 +1,86 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_saturationutil.h>
+
+#include <bdlf_bind.h>
+#include <bdlmt_threadpool.h>
+#include <bslmt_barrier.h>
+#include <bslmt_threadattributes.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <bsl_vector.h>
+
+using namespace BloombergLP;
+using namespace rmqa;
+using namespace ::testing;
+
+namespace {
+
+bool constant(bool value) { return value; }
+
+void block(bslmt::Barrier* started, bslmt::Barrier* release)
+{
+    started->wait();
+    release->wait();
+}
+
+void noop() {}
+
+} // namespace
+
+TEST(SaturationUtilTests, ThreadPoolBacklog)
+{
+    bdlmt::ThreadPool threadPool(bslmt::ThreadAttributes(), 1, 1, 100);
+    threadPool.start();
+
+    SaturationUtil::SaturationFunc probe =
+        SaturationUtil::threadPoolBacklog(&threadPool, 2);
+    EXPECT_FALSE(probe());
+
+    // Occupy the only thread, then queue jobs behind it
+    bslmt::Barrier started(2);
+    bslmt::Barrier release(2);
+    threadPool.enqueueJob(bdlf::BindUtil::bind(&block, &started, &release));
+    started.wait();
+
+    threadPool.enqueueJob(&noop);
+    EXPECT_FALSE(probe());
+    threadPool.enqueueJob(&noop);
+    EXPECT_TRUE(probe());
+
+    release.wait();
+    threadPool.stop();
+}
+
+TEST(SaturationUtilTests, CpuLoad)
+{
+    // No host runs at a load of a million per CPU
+    EXPECT_FALSE(SaturationUtil::cpuLoad(1e6)());
+}
+
+TEST(SaturationUtilTests, AnyOf)
+{
+    bsl::vector<SaturationUtil::SaturationFunc> probes;
+    EXPECT_FALSE(SaturationUtil::anyOf(probes)());
+
+    probes.push_back(bdlf::BindUtil::bind(&constant, false));
+    EXPECT_FALSE(SaturationUtil::anyOf(probes)());
+
+    probes.push_back(bdlf::BindUtil::bind(&constant, true));
+    EXPECT_TRUE(SaturationUtil::anyOf(probes)());
+}
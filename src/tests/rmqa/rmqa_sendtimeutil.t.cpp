@@ -0,0 +1,102 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_sendtimeutil.h>
+
+#include <rmqt_fieldvalue.h>
+#include <rmqt_message.h>
+#include <rmqt_properties.h>
+
+#include <bdlt_datetime.h>
+
+#include <bsl_cstdint.h>
+#include <bsl_memory.h>
+#include <bsl_vector.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqa;
+using namespace ::testing;
+
+namespace {
+
+rmqt::Message makeMessage()
+{
+    return rmqt::Message(bsl::make_shared<bsl::vector<uint8_t> >(5));
+}
+
+} // namespace
+
+TEST(SendTimeUtilTests, StampedMessageHasMicrosecondLatency)
+{
+    rmqt::Message message = makeMessage();
+    bdlt::Datetime sent(2024, 3, 1, 12, 0, 0, 0, 250);
+    SendTimeUtil::stamp(&message, sent);
+
+    bdlt::Datetime delivered(sent);
+    delivered.addMicroseconds(1500);
+
+    double seconds = 0;
+    ASSERT_TRUE(SendTimeUtil::elapsed(&seconds, message, delivered));
+    EXPECT_THAT(seconds, DoubleNear(0.0015, 1e-9));
+    EXPECT_THAT(message.properties().timestamp.value(), Eq(sent));
+}
+
+TEST(SendTimeUtilTests, StampDoesNotModifySharedHeaders)
+{
+    bsl::shared_ptr<rmqt::FieldTable> headers =
+        bsl::make_shared<rmqt::FieldTable>();
+    (*headers)["key"] = rmqt::FieldValue(bsl::string("value"));
+    rmqt::Message original(
+        bsl::make_shared<bsl::vector<uint8_t> >(5), "id", headers);
+
+    rmqt::Message stamped(original);
+    SendTimeUtil::stamp(&stamped, bdlt::Datetime(2024, 3, 1));
+
+    EXPECT_THAT(original.headers()->size(), Eq(1));
+    EXPECT_THAT(stamped.headers()->size(), Eq(2));
+    EXPECT_THAT(stamped.headers()->count("key"), Eq(1));
+}
+
+TEST(SendTimeUtilTests, FallsBackToTimestampProperty)
+{
+    rmqt::Message message = makeMessage();
+    message.properties().timestamp = bdlt::Datetime(2024, 3, 1, 12, 0, 0);
+
+    double seconds = 0;
+    ASSERT_TRUE(SendTimeUtil::elapsed(
+        &seconds, message, bdlt::Datetime(2024, 3, 1, 12, 0, 2)));
+    EXPECT_THAT(seconds, DoubleEq(2));
+}
+
+TEST(SendTimeUtilTests, ClockSkewClampsToZero)
+{
+    rmqt::Message message = makeMessage();
+    SendTimeUtil::stamp(&message, bdlt::Datetime(2024, 3, 1, 12, 0, 1));
+
+    double seconds = -1;
+    ASSERT_TRUE(SendTimeUtil::elapsed(
+        &seconds, message, bdlt::Datetime(2024, 3, 1, 12, 0, 0)));
+    EXPECT_THAT(seconds, Eq(0));
+}
+
+TEST(SendTimeUtilTests, UnknownSendTime)
+{
+    double seconds = -1;
+    EXPECT_FALSE(SendTimeUtil::elapsed(
+        &seconds, makeMessage(), bdlt::Datetime(2024, 3, 1)));
+    EXPECT_THAT(seconds, Eq(-1));
+}
@@ -0,0 +1,99 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <rmqa_serialexecutor.h>
+
+#include <bdlf_bind.h>
+#include <bdlmt_threadpool.h>
+#include <bslmt_threadattributes.h>
+#include <bsls_atomic.h>
+
+#include <bsl_memory.h>
+#include <bsl_vector.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqa;
+using namespace ::testing;
+
+namespace {
+const int k_JOBS = 5000;
+
+struct Recorder {
+    bsl::vector<int> d_order;
+    bsls::AtomicInt d_running;
+    bsls::AtomicInt d_overlaps;
+
+    Recorder()
+    : d_order()
+    , d_running(0)
+    , d_overlaps(0)
+    {
+    }
+
+    void record(int i)
+    {
+        if (d_running.add(1) != 1) {
+            d_overlaps.add(1);
+        }
+        d_order.push_back(i);
+        d_running.add(-1);
+    }
+};
+
+void runJobs(bsl::size_t capacity, Recorder* recorder)
+{
+    bdlmt::ThreadPool threadPool(bslmt::ThreadAttributes(), 4, 4, 100);
+    ASSERT_THAT(threadPool.start(), Eq(0));
+
+    bsl::shared_ptr<SerialExecutor> executor =
+        bsl::make_shared<SerialExecutor>(bsl::ref(threadPool), capacity);
+
+    for (int i = 0; i < k_JOBS; ++i) {
+        EXPECT_THAT(executor->submit(bdlf::BindUtil::bind(
+                        &Recorder::record, recorder, i)),
+                    Eq(0));
+    }
+
+    // Waits for the queued drains, which finish the remaining jobs
+    threadPool.stop();
+}
+} // namespace
+
+TEST(SerialExecutor, RunsJobsOneAtATimeInOrder)
+{
+    Recorder recorder;
+    runJobs(8192, &recorder);
+
+    ASSERT_THAT(recorder.d_order.size(), Eq(bsl::size_t(k_JOBS)));
+    for (int i = 0; i < k_JOBS; ++i) {
+        EXPECT_THAT(recorder.d_order[i], Eq(i));
+    }
+    EXPECT_THAT(recorder.d_overlaps.load(), Eq(0));
+}
+
+TEST(SerialExecutor, KeepsOrderWhenRingOverflows)
+{
+    Recorder recorder;
+    runJobs(4, &recorder);
+
+    ASSERT_THAT(recorder.d_order.size(), Eq(bsl::size_t(k_JOBS)));
+    for (int i = 0; i < k_JOBS; ++i) {
+        EXPECT_THAT(recorder.d_order[i], Eq(i));
+    }
+    EXPECT_THAT(recorder.d_overlaps.load(), Eq(0));
+}
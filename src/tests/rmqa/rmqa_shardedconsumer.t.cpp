@@ -0,0 +1,112 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_shardedconsumer.h>
+
+#include <rmqtestmocks_mockconsumer.h>
+
+#include <rmqp_consumer.h>
+#include <rmqt_future.h>
+#include <rmqt_result.h>
+#include <rmqt_topologyupdate.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <bsl_memory.h>
+#include <bsl_vector.h>
+
+using namespace BloombergLP;
+using namespace ::testing;
+
+class ShardedConsumerTests : public Test {
+  protected:
+    bsl::vector<bsl::shared_ptr<rmqtestmocks::MockConsumer> > d_mocks;
+    bsl::vector<bsl::shared_ptr<rmqp::Consumer> > d_shards;
+
+    ShardedConsumerTests()
+    : d_mocks()
+    , d_shards()
+    {
+        for (int i = 0; i < 3; ++i) {
+            d_mocks.push_back(bsl::make_shared<rmqtestmocks::MockConsumer>());
+            d_shards.push_back(d_mocks.back());
+        }
+    }
+};
+
+TEST_F(ShardedConsumerTests, CancelWaitsForEveryShard)
+{
+    rmqa::ShardedConsumer consumer(d_shards);
+
+    rmqt::Future<>::Pair pending = rmqt::Future<>::make();
+    EXPECT_CALL(*d_mocks[0], cancel())
+        .WillOnce(Return(rmqt::Future<>(rmqt::Result<>())));
+    EXPECT_CALL(*d_mocks[1], cancel()).WillOnce(Return(pending.second));
+    EXPECT_CALL(*d_mocks[2], cancel())
+        .WillOnce(Return(rmqt::Future<>(rmqt::Result<>())));
+
+    rmqt::Future<> cancelled = consumer.cancel();
+    EXPECT_FALSE(cancelled.tryResult());
+
+    pending.first(rmqt::Result<>());
+    EXPECT_TRUE(cancelled.tryResult());
+}
+
+TEST_F(ShardedConsumerTests, CancelAndDrainCancelsEveryShardBeforeDraining)
+{
+    rmqa::ShardedConsumer consumer(d_shards);
+
+    Sequence cancels;
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_CALL(*d_mocks[i], cancel())
+            .InSequence(cancels)
+            .WillOnce(Return(rmqt::Future<>(rmqt::Result<>())));
+    }
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_CALL(*d_mocks[i], drain())
+            .InSequence(cancels)
+            .WillOnce(Return(rmqt::Future<>(rmqt::Result<>())));
+    }
+
+    EXPECT_TRUE(consumer.cancelAndDrain(bsls::TimeInterval(1)));
+}
+
+TEST_F(ShardedConsumerTests, DrainFailsIfAnyShardFails)
+{
+    rmqa::ShardedConsumer consumer(d_shards);
+
+    EXPECT_CALL(*d_mocks[0], drain())
+        .WillOnce(Return(rmqt::Future<>(rmqt::Result<>())));
+    EXPECT_CALL(*d_mocks[1], drain())
+        .WillOnce(Return(rmqt::Future<>(rmqt::Result<>("Not cancelled"))));
+    EXPECT_CALL(*d_mocks[2], drain())
+        .WillOnce(Return(rmqt::Future<>(rmqt::Result<>())));
+
+    EXPECT_THAT(consumer.drain().blockResult().error(), Eq("Not cancelled"));
+}
+
+TEST_F(ShardedConsumerTests, TopologyUpdateAppliesToEveryShard)
+{
+    rmqa::ShardedConsumer consumer(d_shards);
+
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_CALL(*d_mocks[i], updateTopologyAsync(_))
+            .WillOnce(Return(rmqt::Future<>(rmqt::Result<>())));
+    }
+
+    EXPECT_TRUE(consumer.updateTopologyAsync(rmqt::TopologyUpdate())
+                    .blockResult());
+}
@@ -0,0 +1,246 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_shardedproducer.h>
+
+#include <rmqtestmocks_mockproducer.h>
+
+#include <rmqp_producer.h>
+#include <rmqt_confirmresponse.h>
+#include <rmqt_message.h>
+#include <rmqt_result.h>
+#include <rmqt_topologyupdate.h>
+
+#include <bdlf_bind.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <bsl_algorithm.h>
+#include <bsl_memory.h>
+#include <bsl_string.h>
+#include <bsl_vector.h>
+
+using namespace BloombergLP;
+using namespace ::testing;
+using namespace bdlf::PlaceHolders;
+
+namespace {
+
+void noopConfirm(const rmqt::Message&,
+                 const bsl::string&,
+                 const rmqt::ConfirmResponse&)
+{
+}
+
+void countCall(int* calls) { ++(*calls); }
+
+void saveRoutingKey(bsl::string* saved,
+                    const rmqt::Message&,
+                    const bsl::string& routingKey,
+                    const rmqt::ConfirmResponse&)
+{
+    *saved = routingKey;
+}
+
+} // namespace
+
+class ShardedProducerTests : public Test {
+  protected:
+    bsl::vector<bsl::shared_ptr<rmqtestmocks::MockProducer> > d_mocks;
+    bsl::vector<bsl::shared_ptr<rmqp::Producer> > d_shards;
+    bsl::vector<rmqp::Producer::ConfirmationCallback> d_confirms;
+    rmqt::Message d_message;
+
+    ShardedProducerTests()
+    : d_mocks()
+    , d_shards()
+    , d_confirms()
+    , d_message(bsl::make_shared<bsl::vector<uint8_t> >(5))
+    {
+        for (int i = 0; i < 3; ++i) {
+            d_mocks.push_back(bsl::make_shared<rmqtestmocks::MockProducer>());
+            d_shards.push_back(d_mocks.back());
+        }
+    }
+
+    /// Save the confirm callback of each of the `times` messages `shard` sends
+    void captureSends(int shard, int times)
+    {
+        EXPECT_CALL(*d_mocks[shard], send(_, _, _, _, _))
+            .Times(times)
+            .WillRepeatedly(DoAll(
+                Invoke(this, &ShardedProducerTests::saveConfirm),
+                Return(rmqp::Producer::SENDING)));
+    }
+
+    void saveConfirm(const rmqt::Message&,
+                     const bsl::string&,
+                     rmqt::Mandatory::Value,
+                     const rmqp::Producer::ConfirmationCallback& confirm,
+                     const bsls::TimeInterval&)
+    {
+        d_confirms.push_back(confirm);
+    }
+
+    void confirm(bsl::size_t i)
+    {
+        d_confirms[i](d_message,
+                      "key",
+                      rmqt::ConfirmResponse(rmqt::ConfirmResponse::ACK));
+    }
+};
+
+TEST_F(ShardedProducerTests, RoutingKeyAlwaysUsesTheSameShard)
+{
+    rmqa::ShardedProducer producer(d_shards, 100, true);
+
+    int calls[3] = {0, 0, 0};
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_CALL(*d_mocks[i], send(_, _, _, _, _))
+            .WillRepeatedly(
+                DoAll(InvokeWithoutArgs(
+                          bdlf::BindUtil::bind(&countCall, &calls[i])),
+                      Return(rmqp::Producer::SENDING)));
+    }
+
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_THAT(producer.send(rmqt::Message(),
+                                  "key",
+                                  &noopConfirm,
+                                  bsls::TimeInterval()),
+                    Eq(rmqp::Producer::SENDING));
+    }
+
+    EXPECT_THAT(calls[0] + calls[1] + calls[2], Eq(10));
+    EXPECT_THAT(bsl::max(calls[0], bsl::max(calls[1], calls[2])), Eq(10));
+}
+
+TEST_F(ShardedProducerTests, UnorderedSendsUseShardsInTurn)
+{
+    rmqa::ShardedProducer producer(d_shards, 100, false);
+
+    for (int i = 0; i < 3; ++i) {
+        captureSends(i, 2);
+    }
+
+    for (int i = 0; i < 6; ++i) {
+        producer.send(
+            rmqt::Message(), "key", &noopConfirm, bsls::TimeInterval());
+    }
+}
+
+TEST_F(ShardedProducerTests, LimitCoversEveryShard)
+{
+    rmqa::ShardedProducer producer(d_shards, 2, false);
+
+    captureSends(0, 1);
+    captureSends(1, 1);
+    EXPECT_CALL(*d_mocks[2], trySend(_, _, _))
+        .WillOnce(Return(rmqp::Producer::SENDING));
+
+    producer.send(rmqt::Message(), "key", &noopConfirm, bsls::TimeInterval());
+    producer.send(rmqt::Message(), "key", &noopConfirm, bsls::TimeInterval());
+    EXPECT_THAT(producer.availableCredits(), Eq(0));
+
+    int writable = 0;
+    producer.setWritableCallback(bdlf::BindUtil::bind(&countCall, &writable),
+                                 1);
+    EXPECT_THAT(producer.trySend(rmqt::Message(), "key", &noopConfirm),
+                Eq(rmqp::Producer::INFLIGHT_LIMIT));
+
+    // A confirm from either shard frees credit for any of them
+    confirm(1);
+    EXPECT_THAT(writable, Eq(1));
+    EXPECT_THAT(producer.availableCredits(), Eq(1));
+    EXPECT_THAT(producer.trySend(rmqt::Message(), "key", &noopConfirm),
+                Eq(rmqp::Producer::SENDING));
+}
+
+TEST_F(ShardedProducerTests, RejectedSendReturnsItsCredit)
+{
+    rmqa::ShardedProducer producer(d_shards, 2, true);
+
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_CALL(*d_mocks[i], send(_, _, _, _, _))
+            .WillRepeatedly(Return(rmqp::Producer::DUPLICATE));
+    }
+
+    EXPECT_THAT(producer.send(rmqt::Message(),
+                              "key",
+                              &noopConfirm,
+                              bsls::TimeInterval()),
+                Eq(rmqp::Producer::DUPLICATE));
+    EXPECT_THAT(producer.availableCredits(), Eq(2));
+}
+
+TEST_F(ShardedProducerTests, WaitForConfirmsWaitsForEveryShard)
+{
+    rmqa::ShardedProducer producer(d_shards, 2, true);
+
+    EXPECT_CALL(*d_mocks[0], waitForConfirms(_))
+        .WillOnce(Return(rmqt::Result<>()));
+    EXPECT_CALL(*d_mocks[1], waitForConfirms(_))
+        .WillOnce(Return(rmqt::Result<>("Timed out")));
+    EXPECT_CALL(*d_mocks[2], waitForConfirms(_)).Times(0);
+
+    EXPECT_FALSE(producer.waitForConfirms(bsls::TimeInterval(1)));
+}
+
+TEST_F(ShardedProducerTests, TopologyUpdateAppliesToEveryShard)
+{
+    rmqa::ShardedProducer producer(d_shards, 2, true);
+
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_CALL(*d_mocks[i], updateTopologyAsync(_))
+            .WillOnce(Return(rmqt::Future<>(rmqt::Result<>())));
+    }
+
+    EXPECT_TRUE(producer.updateTopologyAsync(rmqt::TopologyUpdate())
+                    .blockResult());
+}
+
+TEST_F(ShardedProducerTests, PartitionKeyPicksThePartition)
+{
+    bsl::vector<bsl::string> partitionKeys;
+    partitionKeys.push_back("p0");
+    partitionKeys.push_back("p1");
+    partitionKeys.push_back("p2");
+    rmqa::ShardedProducer producer(d_shards, 100, partitionKeys);
+
+    // "order-42" hashes onto the second of three partitions
+    EXPECT_CALL(*d_mocks[0], send(_, _, _, _, _)).Times(0);
+    EXPECT_CALL(*d_mocks[2], send(_, _, _, _, _)).Times(0);
+    EXPECT_CALL(*d_mocks[1], send(_, "p1", _, _, _))
+        .WillOnce(DoAll(Invoke(this, &ShardedProducerTests::saveConfirm),
+                        Return(rmqp::Producer::SENDING)));
+
+    bsl::string confirmedKey;
+    EXPECT_THAT(producer.send(rmqt::Message(),
+                              "order-42",
+                              bdlf::BindUtil::bind(&saveRoutingKey,
+                                                   &confirmedKey,
+                                                   _1,
+                                                   _2,
+                                                   _3),
+                              bsls::TimeInterval()),
+                Eq(rmqp::Producer::SENDING));
+    EXPECT_THAT(producer.availableCredits(), Eq(99u));
+
+    // The confirm reports the partition key the message was sent with
+    confirm(0);
+    EXPECT_THAT(confirmedKey, Eq("order-42"));
+    EXPECT_THAT(producer.availableCredits(), Eq(100u));
+}
@@ -0,0 +1,161 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_sharedrabbitcontext.h>
+
+#include <rmqtestmocks_mockconnection.h>
+#include <rmqtestmocks_mockrabbitcontext.h>
+
+#include <rmqt_plaincredentials.h>
+#include <rmqt_simpleendpoint.h>
+#include <rmqt_vhostinfo.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <bdlf_bind.h>
+#include <bslma_managedptr.h>
+
+#include <bsl_memory.h>
+
+using namespace BloombergLP;
+using namespace ::testing;
+
+namespace {
+bsl::shared_ptr<rmqp::RabbitContext>
+makeContext(int* made,
+            const bsl::shared_ptr<rmqtestmocks::MockRabbitContext>& context)
+{
+    ++*made;
+    return context;
+}
+} // namespace
+
+class SharedRabbitContextTests : public Test {
+  protected:
+    int d_made;
+    bsl::shared_ptr<rmqtestmocks::MockRabbitContext> d_context;
+    bsl::shared_ptr<rmqt::Endpoint> d_endpoint;
+    bsl::shared_ptr<rmqt::Credentials> d_credentials;
+
+    SharedRabbitContextTests()
+    : d_made(0)
+    , d_context(bsl::make_shared<rmqtestmocks::MockRabbitContext>())
+    , d_endpoint(bsl::make_shared<rmqt::SimpleEndpoint>("localhost", "vh"))
+    , d_credentials(bsl::make_shared<rmqt::PlainCredentials>("user", "pw"))
+    {
+    }
+
+    bslma::ManagedPtr<rmqp::RabbitContext> acquire()
+    {
+        return rmqa::SharedRabbitContext::acquire(
+            bdlf::BindUtil::bind(&makeContext, &d_made, d_context));
+    }
+};
+
+TEST_F(SharedRabbitContextTests, HoldsShareOneContext)
+{
+    bslma::ManagedPtr<rmqp::RabbitContext> first  = acquire();
+    bslma::ManagedPtr<rmqp::RabbitContext> second = acquire();
+
+    EXPECT_EQ(d_made, 1);
+}
+
+TEST_F(SharedRabbitContextTests, MakesNewContextOnceAllHoldsReleased)
+{
+    acquire();
+    acquire();
+
+    EXPECT_EQ(d_made, 2);
+}
+
+TEST_F(SharedRabbitContextTests, SharesVHostsWithSameEndpointAndCredentials)
+{
+    bslma::ManagedPtr<rmqp::RabbitContext> first  = acquire();
+    bslma::ManagedPtr<rmqp::RabbitContext> second = acquire();
+
+    bsl::shared_ptr<rmqtestmocks::MockConnection> vhost =
+        bsl::make_shared<rmqtestmocks::MockConnection>();
+    EXPECT_CALL(*d_context, createVHostConnection("first", _))
+        .WillOnce(Return(vhost));
+
+    bsl::shared_ptr<rmqp::Connection> firstVHost =
+        first->createVHostConnection("first", d_endpoint, d_credentials);
+    bsl::shared_ptr<rmqp::Connection> secondVHost =
+        second->createVHostConnection(
+            "second",
+            rmqt::VHostInfo(
+                bsl::make_shared<rmqt::SimpleEndpoint>("localhost", "vh"),
+                bsl::make_shared<rmqt::PlainCredentials>("user", "pw")));
+
+    EXPECT_CALL(*vhost, close()).Times(0);
+    firstVHost.reset();
+    Mock::VerifyAndClearExpectations(vhost.get());
+
+    EXPECT_CALL(*vhost, close());
+    secondVHost.reset();
+}
+
+TEST_F(SharedRabbitContextTests, SeparatesVHostsWithOtherCredentials)
+{
+    bslma::ManagedPtr<rmqp::RabbitContext> context = acquire();
+
+    bsl::shared_ptr<rmqtestmocks::MockConnection> vhost =
+        bsl::make_shared<rmqtestmocks::MockConnection>();
+    bsl::shared_ptr<rmqtestmocks::MockConnection> otherVHost =
+        bsl::make_shared<rmqtestmocks::MockConnection>();
+    EXPECT_CALL(*d_context, createVHostConnection("first", _))
+        .WillOnce(Return(vhost));
+    EXPECT_CALL(*d_context, createVHostConnection("second", _))
+        .WillOnce(Return(otherVHost));
+
+    bsl::shared_ptr<rmqp::Connection> first =
+        context->createVHostConnection("first", d_endpoint, d_credentials);
+    bsl::shared_ptr<rmqp::Connection> second = context->createVHostConnection(
+        "second",
+        d_endpoint,
+        bsl::make_shared<rmqt::PlainCredentials>("user", "other"));
+}
+
+TEST_F(SharedRabbitContextTests, ClosesVHostOnlyOnceLastHoldReleased)
+{
+    bslma::ManagedPtr<rmqp::RabbitContext> context = acquire();
+
+    bsl::shared_ptr<rmqtestmocks::MockConnection> vhost =
+        bsl::make_shared<rmqtestmocks::MockConnection>();
+    EXPECT_CALL(*d_context, createVHostConnection(_, _))
+        .WillOnce(Return(vhost));
+
+    bsl::shared_ptr<rmqp::Connection> first =
+        context->createVHostConnection("first", d_endpoint, d_credentials);
+    bsl::shared_ptr<rmqp::Connection> second =
+        context->createVHostConnection("second", d_endpoint, d_credentials);
+
+    EXPECT_CALL(*vhost, close()).Times(0);
+    first->close();
+    first.reset();
+    Mock::VerifyAndClearExpectations(vhost.get());
+
+    EXPECT_CALL(*vhost, close());
+    second.reset();
+}
+
+TEST_F(SharedRabbitContextTests, RefusesToShutDown)
+{
+    bslma::ManagedPtr<rmqp::RabbitContext> context = acquire();
+
+    EXPECT_CALL(*d_context, shutdown(_)).Times(0);
+    EXPECT_FALSE(context->shutdown(bsls::TimeInterval(1)));
+}
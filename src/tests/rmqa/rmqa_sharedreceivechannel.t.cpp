@@ -0,0 +1,137 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_sharedreceivechannel.h>
+
+#include <rmqtestutil_mockchannel.t.h>
+#include <rmqtestutil_mockeventloop.t.h>
+
+#include <rmqt_consumerackqueue.h>
+#include <rmqt_consumerconfig.h>
+#include <rmqt_exchange.h>
+#include <rmqt_queue.h>
+#include <rmqt_queuebinding.h>
+#include <rmqt_topology.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <bsl_memory.h>
+
+using namespace BloombergLP;
+using namespace ::testing;
+
+class SharedReceiveChannelTests : public Test {
+  protected:
+    rmqtestutil::MockEventLoop d_eventLoop;
+    bsl::shared_ptr<rmqt::ConsumerAckQueue> d_ackQueue;
+    bsl::shared_ptr<rmqtestutil::MockReceiveChannel> d_channel;
+    bsl::shared_ptr<rmqt::Exchange> d_exchange;
+    bsl::shared_ptr<rmqt::Queue> d_queue;
+    bsl::shared_ptr<rmqt::Queue> d_otherQueue;
+    rmqt::Topology d_topology;
+    rmqt::ConsumerConfig d_config;
+
+    SharedReceiveChannelTests()
+    : d_eventLoop()
+    , d_ackQueue(bsl::make_shared<rmqt::ConsumerAckQueue>())
+    , d_channel(bsl::make_shared<rmqtestutil::MockReceiveChannel>(d_ackQueue))
+    , d_exchange(bsl::make_shared<rmqt::Exchange>("exchange"))
+    , d_queue(bsl::make_shared<rmqt::Queue>("queue"))
+    , d_otherQueue(bsl::make_shared<rmqt::Queue>("other-queue"))
+    , d_topology()
+    , d_config()
+    {
+        d_topology.exchanges.push_back(d_exchange);
+        d_topology.queues.push_back(d_queue);
+        d_topology.queues.push_back(d_otherQueue);
+        d_topology.queueBindings.push_back(
+            bsl::make_shared<rmqt::QueueBinding>(d_exchange, d_queue, "key"));
+
+        EXPECT_CALL(d_eventLoop, postImpl(_))
+            .WillRepeatedly(InvokeArgument<0>());
+    }
+
+    bsl::shared_ptr<rmqa::SharedReceiveChannel> makeShare()
+    {
+        return rmqa::SharedReceiveChannel::make(
+            d_channel, d_topology, d_config, d_ackQueue, d_eventLoop);
+    }
+};
+
+TEST_F(SharedReceiveChannelTests, CoversOnlyTopologyItDeclares)
+{
+    bsl::shared_ptr<rmqa::SharedReceiveChannel> share = makeShare();
+
+    EXPECT_TRUE(share->covers(d_topology, d_config));
+
+    rmqt::Topology otherQueueOnly;
+    otherQueueOnly.queues.push_back(d_otherQueue);
+    EXPECT_TRUE(share->covers(otherQueueOnly, d_config));
+
+    rmqt::Topology extraQueue(d_topology);
+    extraQueue.queues.push_back(bsl::make_shared<rmqt::Queue>("queue"));
+    EXPECT_FALSE(share->covers(extraQueue, d_config));
+
+    rmqt::Topology otherMode(d_topology);
+    otherMode.declareMode = rmqt::Topology::SKIP_DECLARE;
+    EXPECT_FALSE(share->covers(otherMode, d_config));
+}
+
+TEST_F(SharedReceiveChannelTests, CoversOnlyMatchingChannelSettings)
+{
+    bsl::shared_ptr<rmqa::SharedReceiveChannel> share = makeShare();
+
+    // Each consumer has its own tag and dispatch
+    rmqt::ConsumerConfig otherTag(d_config);
+    otherTag.setConsumerTag("other-tag");
+    otherTag.setDispatch(rmqt::ConsumerDispatch::ORDERED);
+    EXPECT_TRUE(share->covers(d_topology, otherTag));
+
+    rmqt::ConsumerConfig otherPrefetch(d_config);
+    otherPrefetch.setPrefetchCount(d_config.prefetchCount() + 1);
+    EXPECT_FALSE(share->covers(d_topology, otherPrefetch));
+
+    rmqt::ConsumerConfig noAck(d_config);
+    noAck.setNoAck();
+    EXPECT_FALSE(share->covers(d_topology, noAck));
+}
+
+TEST_F(SharedReceiveChannelTests, ClosesChannelWithLastRelease)
+{
+    bsl::shared_ptr<rmqa::SharedReceiveChannel> share = makeShare();
+    EXPECT_THAT(share->ackQueue(), Eq(d_ackQueue));
+
+    EXPECT_CALL(*d_channel, gracefulClose());
+    share.reset();
+}
+
+TEST_F(SharedReceiveChannelTests, RegistryForgetsReleasedChannels)
+{
+    rmqa::SharedReceiveChannel::Registry registry;
+
+    bsl::shared_ptr<rmqa::SharedReceiveChannel> share = makeShare();
+    registry.add(share);
+
+    EXPECT_THAT(registry.find(d_topology, d_config), Eq(share));
+
+    rmqt::ConsumerConfig otherPrefetch(d_config);
+    otherPrefetch.setPrefetchCount(d_config.prefetchCount() + 1);
+    EXPECT_FALSE(registry.find(d_topology, otherPrefetch));
+
+    EXPECT_CALL(*d_channel, gracefulClose());
+    share.reset();
+    EXPECT_FALSE(registry.find(d_topology, d_config));
+}
@@ -0,0 +1,81 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_sharedregistry.h>
+
+#include <gtest/gtest.h>
+
+#include <bdlf_bind.h>
+
+#include <bsl_memory.h>
+
+using namespace BloombergLP;
+using namespace ::testing;
+
+namespace {
+bsl::shared_ptr<int> makeInt(int* made, int value)
+{
+    ++*made;
+    return bsl::make_shared<int>(value);
+}
+} // namespace
+
+TEST(SharedRegistryTests, SharesObjectWhileHeld)
+{
+    rmqa::SharedRegistry<int> registry;
+    int made = 0;
+
+    bsl::shared_ptr<int> first =
+        registry.acquire("key", bdlf::BindUtil::bind(&makeInt, &made, 1));
+    bsl::shared_ptr<int> second =
+        registry.acquire("key", bdlf::BindUtil::bind(&makeInt, &made, 2));
+
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(*second, 1);
+    EXPECT_EQ(made, 1);
+    EXPECT_EQ(registry.size(), 1);
+}
+
+TEST(SharedRegistryTests, KeysHoldSeparateObjects)
+{
+    rmqa::SharedRegistry<int> registry;
+    int made = 0;
+
+    bsl::shared_ptr<int> first =
+        registry.acquire("key", bdlf::BindUtil::bind(&makeInt, &made, 1));
+    bsl::shared_ptr<int> other =
+        registry.acquire("other", bdlf::BindUtil::bind(&makeInt, &made, 2));
+
+    EXPECT_NE(first, other);
+    EXPECT_EQ(made, 2);
+    EXPECT_EQ(registry.size(), 2);
+}
+
+TEST(SharedRegistryTests, MakesNewObjectOnceReleased)
+{
+    rmqa::SharedRegistry<int> registry;
+    int made = 0;
+
+    bsl::shared_ptr<int> first =
+        registry.acquire("key", bdlf::BindUtil::bind(&makeInt, &made, 1));
+    first.reset();
+    EXPECT_EQ(registry.size(), 0);
+
+    bsl::shared_ptr<int> second =
+        registry.acquire("key", bdlf::BindUtil::bind(&makeInt, &made, 2));
+
+    EXPECT_EQ(*second, 2);
+    EXPECT_EQ(made, 2);
+}
@@ -0,0 +1,200 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_sharedsendchannel.h>
+
+#include <rmqamqp_messagewithroute.h>
+#include <rmqamqp_sendchannel.h>
+#include <rmqtestutil_mockchannel.t.h>
+#include <rmqtestutil_mockeventloop.t.h>
+
+#include <rmqt_confirmresponse.h>
+#include <rmqt_exchange.h>
+#include <rmqt_message.h>
+#include <rmqt_queue.h>
+#include <rmqt_queuebinding.h>
+#include <rmqt_topology.h>
+
+#include <bdlf_bind.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <bsl_memory.h>
+#include <bsl_vector.h>
+
+using namespace BloombergLP;
+using namespace ::testing;
+using namespace bdlf::PlaceHolders;
+
+namespace {
+
+void recordConfirms(
+    bsl::vector<bdlb::Guid>* received,
+    const bsl::shared_ptr<const rmqamqp::SendChannel::ConfirmationBatch>&
+        confirmations)
+{
+    for (bsl::size_t i = 0; i < confirmations->size(); ++i) {
+        received->push_back((*confirmations)[i].first.message().guid());
+    }
+}
+
+rmqamqp::SendChannel::Confirmation confirmation(const rmqt::Message& message)
+{
+    return bsl::make_pair(
+        rmqamqp::MessageWithRoute(
+            message, "key", rmqt::Mandatory::RETURN_UNROUTABLE),
+        rmqt::ConfirmResponse(rmqt::ConfirmResponse::ACK));
+}
+
+} // namespace
+
+class SharedSendChannelTests : public Test {
+  protected:
+    rmqtestutil::MockEventLoop d_eventLoop;
+    bsl::shared_ptr<rmqtestutil::MockSendChannel> d_channel;
+    bsl::shared_ptr<rmqt::Exchange> d_exchange;
+    bsl::shared_ptr<rmqt::Queue> d_queue;
+    rmqt::Topology d_topology;
+    rmqamqp::SendChannel::MessageBatchConfirmCallback d_onConfirms;
+
+    SharedSendChannelTests()
+    : d_eventLoop()
+    , d_channel(bsl::make_shared<rmqtestutil::MockSendChannel>())
+    , d_exchange(bsl::make_shared<rmqt::Exchange>("exchange"))
+    , d_queue(bsl::make_shared<rmqt::Queue>("queue"))
+    , d_topology()
+    , d_onConfirms()
+    {
+        d_topology.exchanges.push_back(d_exchange);
+        d_topology.queues.push_back(d_queue);
+        d_topology.queueBindings.push_back(
+            bsl::make_shared<rmqt::QueueBinding>(d_exchange, d_queue, "key"));
+
+        EXPECT_CALL(*d_channel, setBatchCallback(_))
+            .WillRepeatedly(SaveArg<0>(&d_onConfirms));
+        EXPECT_CALL(d_eventLoop, postImpl(_))
+            .WillRepeatedly(InvokeArgument<0>());
+    }
+
+    bsl::shared_ptr<rmqa::SharedSendChannel> makeShare()
+    {
+        return rmqa::SharedSendChannel::make(
+            d_channel, *d_exchange, d_topology, d_eventLoop);
+    }
+
+    void deliver(const bsl::vector<rmqt::Message>& messages)
+    {
+        bsl::shared_ptr<rmqamqp::SendChannel::ConfirmationBatch> batch =
+            bsl::make_shared<rmqamqp::SendChannel::ConfirmationBatch>();
+        for (bsl::size_t i = 0; i < messages.size(); ++i) {
+            batch->push_back(confirmation(messages[i]));
+        }
+        d_onConfirms(batch);
+    }
+};
+
+TEST_F(SharedSendChannelTests, ConfirmsReachTheProducerWhichSentThem)
+{
+    bsl::shared_ptr<rmqa::SharedSendChannel> share = makeShare();
+
+    bsl::vector<bdlb::Guid> first, second;
+    rmqa::SharedSendChannel::ProducerId firstId =
+        share->attach(bdlf::BindUtil::bind(&recordConfirms, &first, _1));
+    rmqa::SharedSendChannel::ProducerId secondId =
+        share->attach(bdlf::BindUtil::bind(&recordConfirms, &second, _1));
+
+    bsl::vector<rmqt::Message> messages;
+    for (int i = 0; i < 3; ++i) {
+        messages.push_back(
+            rmqt::Message(bsl::make_shared<bsl::vector<uint8_t> >(1)));
+    }
+    share->route(messages[0].guid(), firstId);
+    share->route(messages[1].guid(), secondId);
+    share->route(messages[2].guid(), firstId);
+
+    deliver(messages);
+
+    ASSERT_THAT(first.size(), Eq(2));
+    EXPECT_THAT(first[0], Eq(messages[0].guid()));
+    EXPECT_THAT(first[1], Eq(messages[2].guid()));
+    ASSERT_THAT(second.size(), Eq(1));
+    EXPECT_THAT(second[0], Eq(messages[1].guid()));
+
+    // Each confirm is delivered once
+    deliver(messages);
+    EXPECT_THAT(first.size(), Eq(2));
+    EXPECT_THAT(second.size(), Eq(1));
+}
+
+TEST_F(SharedSendChannelTests, DetachedProducerGetsNoConfirms)
+{
+    bsl::shared_ptr<rmqa::SharedSendChannel> share = makeShare();
+
+    bsl::vector<bdlb::Guid> first, second;
+    rmqa::SharedSendChannel::ProducerId firstId =
+        share->attach(bdlf::BindUtil::bind(&recordConfirms, &first, _1));
+    rmqa::SharedSendChannel::ProducerId secondId =
+        share->attach(bdlf::BindUtil::bind(&recordConfirms, &second, _1));
+
+    bsl::vector<rmqt::Message> messages;
+    for (int i = 0; i < 2; ++i) {
+        messages.push_back(
+            rmqt::Message(bsl::make_shared<bsl::vector<uint8_t> >(1)));
+    }
+    share->route(messages[0].guid(), firstId);
+    share->route(messages[1].guid(), secondId);
+
+    share->detach(firstId);
+    deliver(messages);
+
+    EXPECT_THAT(first.size(), Eq(0));
+    EXPECT_THAT(second.size(), Eq(1));
+}
+
+TEST_F(SharedSendChannelTests, CoversOnlyTopologyItDeclares)
+{
+    bsl::shared_ptr<rmqa::SharedSendChannel> share = makeShare();
+
+    EXPECT_TRUE(share->covers(*d_exchange, d_topology));
+
+    rmqt::Topology subset;
+    subset.exchanges.push_back(d_exchange);
+    EXPECT_TRUE(share->covers(*d_exchange, subset));
+
+    EXPECT_FALSE(share->covers(rmqt::Exchange("other"), d_topology));
+
+    rmqt::Topology extraQueue(d_topology);
+    extraQueue.queues.push_back(bsl::make_shared<rmqt::Queue>("queue"));
+    EXPECT_FALSE(share->covers(*d_exchange, extraQueue));
+
+    rmqt::Topology otherMode(d_topology);
+    otherMode.declareMode = rmqt::Topology::SKIP_DECLARE;
+    EXPECT_FALSE(share->covers(*d_exchange, otherMode));
+}
+
+TEST_F(SharedSendChannelTests, RegistryForgetsReleasedChannels)
+{
+    rmqa::SharedSendChannel::Registry registry;
+
+    bsl::shared_ptr<rmqa::SharedSendChannel> share = makeShare();
+    registry.add(share);
+
+    EXPECT_THAT(registry.find(*d_exchange, d_topology), Eq(share));
+    EXPECT_FALSE(registry.find(rmqt::Exchange("other"), d_topology));
+
+    share.reset();
+    EXPECT_FALSE(registry.find(*d_exchange, d_topology));
+}
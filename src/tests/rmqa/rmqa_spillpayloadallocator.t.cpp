@@ -0,0 +1,57 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_spillpayloadallocator.h>
+
+#include <bsls_platform.h>
+
+#include <bsl_cstdint.h>
+#include <bsl_cstring.h>
+#include <bsl_memory.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqa;
+using namespace ::testing;
+
+TEST(SpillPayloadAllocator, LeavesSmallBodiesInMemory)
+{
+    SpillPayloadAllocator allocator(4096, "/tmp");
+
+    EXPECT_FALSE(allocator(0));
+    EXPECT_FALSE(allocator(4096));
+}
+
+#ifdef BSLS_PLATFORM_OS_UNIX
+TEST(SpillPayloadAllocator, MapsLargeBodies)
+{
+    SpillPayloadAllocator allocator(4096, "/tmp");
+
+    bsl::shared_ptr<bsl::uint8_t> body = allocator(1024 * 1024);
+    ASSERT_TRUE(body);
+
+    bsl::memset(body.get(), 0xab, 1024 * 1024);
+    EXPECT_EQ(body.get()[1024 * 1024 - 1], 0xab);
+}
+#endif
+
+TEST(SpillPayloadAllocator, FallsBackToMemoryWithoutADirectory)
+{
+    SpillPayloadAllocator allocator(4096, "/nonexistent/rmqcpp");
+
+    EXPECT_FALSE(allocator(1024 * 1024));
+}
@@ -0,0 +1,143 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_startupbatch.h>
+
+#include <rmqa_topology.h>
+#include <rmqa_vhost.h>
+#include <rmqtestmocks_mockconsumer.h>
+#include <rmqtestmocks_mockproducer.h>
+#include <rmqtestmocks_mockvhost.h>
+
+#include <rmqp_connection.h>
+#include <rmqp_consumer.h>
+#include <rmqp_producer.h>
+#include <rmqt_future.h>
+#include <rmqt_result.h>
+
+#include <bslma_managedptr.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <bsl_memory.h>
+
+using namespace BloombergLP;
+using namespace ::testing;
+
+namespace {
+
+void onMessage(rmqp::MessageGuard&) {}
+
+bslma::ManagedPtr<rmqp::Connection>
+borrow(const bsl::shared_ptr<rmqtestmocks::MockVHost>& mock)
+{
+    return bslma::ManagedPtr<rmqp::Connection>(
+        mock.get(), NULL, bslma::ManagedPtrUtil::noOpDeleter);
+}
+
+} // namespace
+
+class StartupBatchTests : public Test {
+  protected:
+    bsl::shared_ptr<NiceMock<rmqtestmocks::MockVHost> > d_mockA;
+    bsl::shared_ptr<NiceMock<rmqtestmocks::MockVHost> > d_mockB;
+    rmqa::VHost d_vhostA;
+    rmqa::VHost d_vhostB;
+    rmqa::Topology d_topology;
+    rmqt::Future<rmqp::Producer>::Pair d_producer;
+    rmqt::Future<rmqp::Consumer>::Pair d_consumer;
+
+    StartupBatchTests()
+    : d_mockA(bsl::make_shared<NiceMock<rmqtestmocks::MockVHost> >())
+    , d_mockB(bsl::make_shared<NiceMock<rmqtestmocks::MockVHost> >())
+    , d_vhostA(borrow(d_mockA))
+    , d_vhostB(borrow(d_mockB))
+    , d_topology()
+    , d_producer(rmqt::Future<rmqp::Producer>::make())
+    , d_consumer(rmqt::Future<rmqp::Consumer>::make())
+    {
+        EXPECT_CALL(*d_mockA, createProducerAsync(_, _, _))
+            .WillOnce(Return(d_producer.second));
+        EXPECT_CALL(*d_mockB, createConsumerAsync(_, _, _, _))
+            .WillOnce(Return(d_consumer.second));
+    }
+
+    void addBoth(rmqa::StartupBatch* batch)
+    {
+        EXPECT_THAT(batch->addProducer(d_vhostA,
+                                       d_topology,
+                                       d_topology.defaultExchange(),
+                                       10),
+                    Eq(0u));
+        EXPECT_THAT(batch->addConsumer(d_vhostB,
+                                       d_topology,
+                                       d_topology.addQueue("queue"),
+                                       &onMessage),
+                    Eq(0u));
+    }
+};
+
+TEST_F(StartupBatchTests, CreatesEverythingBeforeWaiting)
+{
+    rmqa::StartupBatch batch;
+    addBoth(&batch);
+
+    // Both were requested before either was created
+    rmqt::Future<> ready = batch.whenReady();
+    EXPECT_THAT(ready.tryResult().returnCode(), Eq(rmqt::TIMEOUT));
+
+    d_consumer.first(rmqt::Result<rmqp::Consumer>(
+        bsl::make_shared<rmqtestmocks::MockConsumer>()));
+    EXPECT_THAT(ready.tryResult().returnCode(), Eq(rmqt::TIMEOUT));
+
+    d_producer.first(rmqt::Result<rmqp::Producer>(
+        bsl::make_shared<rmqtestmocks::MockProducer>()));
+    EXPECT_TRUE(ready.tryResult());
+
+    EXPECT_TRUE(batch.wait());
+    EXPECT_TRUE(batch.producer(0));
+    EXPECT_TRUE(batch.consumer(0));
+    EXPECT_THAT(batch.numProducers(), Eq(1u));
+    EXPECT_THAT(batch.numConsumers(), Eq(1u));
+}
+
+TEST_F(StartupBatchTests, ReportsTheFirstError)
+{
+    rmqa::StartupBatch batch;
+    addBoth(&batch);
+
+    d_producer.first(rmqt::Result<rmqp::Producer>(
+        bsl::make_shared<rmqtestmocks::MockProducer>()));
+    d_consumer.first(rmqt::Result<rmqp::Consumer>("Queue not found", 404));
+
+    rmqt::Result<> result = batch.wait();
+    EXPECT_FALSE(result);
+    EXPECT_THAT(result.returnCode(), Eq(404));
+    EXPECT_TRUE(batch.producer(0));
+    EXPECT_FALSE(batch.consumer(0));
+}
+
+TEST_F(StartupBatchTests, WaitTimesOut)
+{
+    rmqa::StartupBatch batch;
+    addBoth(&batch);
+
+    rmqt::Result<> result = batch.wait(bsls::TimeInterval(0, 1000000));
+    EXPECT_THAT(result.returnCode(), Eq(rmqt::TIMEOUT));
+
+    d_producer.first(rmqt::Result<rmqp::Producer>("Closed"));
+    d_consumer.first(rmqt::Result<rmqp::Consumer>("Closed"));
+}
@@ -0,0 +1,115 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_tracingsampler.h>
+
+#include <rmqt_fieldvalue.h>
+#include <rmqt_properties.h>
+
+#include <bsl_memory.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqa;
+using namespace ::testing;
+
+namespace {
+
+rmqt::Properties propertiesWithSampled(bool sampled)
+{
+    rmqt::Properties properties;
+    properties.headers = bsl::make_shared<rmqt::FieldTable>();
+    (*properties.headers)[TracingSampler::sampledHeader()] =
+        rmqt::FieldValue(sampled);
+    return properties;
+}
+
+} // namespace
+
+TEST(TracingSampler, SamplesOneInN)
+{
+    TracingSampler sampler(4, 0, false);
+
+    int sampled = 0;
+    for (int i = 0; i < 100; ++i) {
+        sampled += sampler.sampleSend();
+    }
+    EXPECT_THAT(sampled, Eq(25));
+}
+
+TEST(TracingSampler, LimitsSamplesPerSecond)
+{
+    TracingSampler sampler(1, 10, false);
+
+    int sampled = 0;
+    for (int i = 0; i < 100; ++i) {
+        sampled += sampler.sampleSend();
+    }
+    // The loop may straddle the start of a second
+    EXPECT_THAT(sampled, AllOf(Ge(10), Le(20)));
+}
+
+TEST(TracingSampler, MarksOnlyWhenPropagating)
+{
+    rmqt::Properties properties;
+
+    TracingSampler(1, 0, false).markSampled(&properties);
+    EXPECT_FALSE(properties.headers);
+
+    TracingSampler(1, 0, true).markSampled(&properties);
+    ASSERT_TRUE(properties.headers);
+    EXPECT_THAT(properties.headers->count(TracingSampler::sampledHeader()),
+                Eq(1));
+}
+
+TEST(TracingSampler, MarkingDoesNotChangeSharedHeaders)
+{
+    rmqt::Properties original;
+    original.headers = bsl::make_shared<rmqt::FieldTable>();
+
+    rmqt::Properties copy(original);
+    TracingSampler(1, 0, true).markSampled(&copy);
+
+    EXPECT_TRUE(original.headers->empty());
+    EXPECT_THAT(copy.headers->size(), Eq(1));
+}
+
+TEST(TracingSampler, DeliveriesFollowPropagatedDecision)
+{
+    TracingSampler sampler(1000, 0, true);
+
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_TRUE(sampler.sampleDelivery(propertiesWithSampled(true)));
+        EXPECT_FALSE(sampler.sampleDelivery(propertiesWithSampled(false)));
+    }
+}
+
+TEST(TracingSampler, DeliveriesIgnoreDecisionUnlessPropagating)
+{
+    TracingSampler sampler(2, 0, false);
+
+    EXPECT_TRUE(sampler.sampleDelivery(propertiesWithSampled(false)));
+    EXPECT_FALSE(sampler.sampleDelivery(propertiesWithSampled(true)));
+}
+
+TEST(TracingSampler, UnmarkedDeliveriesAreSampledLocally)
+{
+    TracingSampler sampler(2, 0, true);
+
+    EXPECT_TRUE(sampler.sampleDelivery(rmqt::Properties()));
+    EXPECT_FALSE(sampler.sampleDelivery(rmqt::Properties()));
+}
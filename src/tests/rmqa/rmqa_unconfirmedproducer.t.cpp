@@ -0,0 +1,150 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_unconfirmedproducer.h>
+
+#include <rmqamqp_sendchannel.h>
+#include <rmqtestutil_mockchannel.t.h>
+#include <rmqtestutil_mockeventloop.t.h>
+
+#include <rmqp_producer.h>
+#include <rmqt_message.h>
+#include <rmqt_properties.h>
+#include <rmqt_result.h>
+
+#include <bsls_timeinterval.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <bsl_memory.h>
+#include <bsl_string.h>
+#include <bsl_vector.h>
+
+using namespace BloombergLP;
+using namespace ::testing;
+
+class UnconfirmedProducerTests : public Test {
+  protected:
+    bdlmt::ThreadPool d_threadPool;
+    rmqtestutil::MockEventLoop d_eventLoop;
+    bsl::shared_ptr<StrictMock<rmqtestutil::MockSendChannel> >
+        d_mockSendChannel;
+    rmqt::Message d_message;
+    rmqp::Producer::ConfirmationCallback d_callback;
+
+    UnconfirmedProducerTests()
+    : d_threadPool(bslmt::ThreadAttributes(), 0, 5, 5)
+    , d_eventLoop()
+    , d_mockSendChannel(
+          bsl::make_shared<StrictMock<rmqtestutil::MockSendChannel> >())
+    , d_message(bsl::make_shared<bsl::vector<uint8_t> >(5))
+    , d_callback()
+    {
+        d_threadPool.start();
+
+        EXPECT_CALL(d_eventLoop, postImpl(_))
+            .WillRepeatedly(InvokeArgument<0>());
+    }
+
+    bsl::shared_ptr<rmqa::UnconfirmedProducer>
+    createProducer(uint16_t maxUnwrittenMessages)
+    {
+        return bsl::make_shared<rmqa::UnconfirmedProducer>(
+            maxUnwrittenMessages,
+            d_mockSendChannel,
+            bsl::ref(d_threadPool),
+            bsl::ref(d_eventLoop));
+    }
+};
+
+TEST_F(UnconfirmedProducerTests, SendPublishesWithoutConfirms)
+{
+    bsl::shared_ptr<rmqa::UnconfirmedProducer> producer = createProducer(5);
+
+    EXPECT_CALL(*d_mockSendChannel,
+                publishUnconfirmed(_,
+                                   bsl::string("routingKey"),
+                                   rmqt::Mandatory::RETURN_UNROUTABLE,
+                                   _));
+    EXPECT_THAT(producer->send(d_message,
+                               "routingKey",
+                               d_callback,
+                               bsls::TimeInterval()),
+                Eq(rmqp::Producer::SENDING));
+}
+
+TEST_F(UnconfirmedProducerTests, TrySendStopsAtTheUnwrittenLimit)
+{
+    bsl::shared_ptr<rmqa::UnconfirmedProducer> producer = createProducer(1);
+
+    rmqamqp::SendChannel::UnconfirmedPublishCallback onPublished;
+    EXPECT_CALL(*d_mockSendChannel, publishUnconfirmed(_, _, _, _))
+        .WillOnce(SaveArg<3>(&onPublished))
+        .WillOnce(Return());
+
+    EXPECT_THAT(producer->trySend(d_message, "key", d_callback),
+                Eq(rmqp::Producer::SENDING));
+    EXPECT_THAT(producer->availableCredits(), Eq(0));
+    EXPECT_THAT(producer->trySend(d_message, "key", d_callback),
+                Eq(rmqp::Producer::INFLIGHT_LIMIT));
+
+    // A dropped message makes room just as a written one does
+    ASSERT_TRUE(onPublished);
+    onPublished(false);
+
+    EXPECT_THAT(producer->availableCredits(), Eq(1));
+    EXPECT_THAT(producer->trySend(d_message, "key", d_callback),
+                Eq(rmqp::Producer::SENDING));
+}
+
+TEST_F(UnconfirmedProducerTests, WaitForConfirmsWaitsForWrites)
+{
+    bsl::shared_ptr<rmqa::UnconfirmedProducer> producer = createProducer(2);
+
+    rmqamqp::SendChannel::UnconfirmedPublishCallback onPublished;
+    EXPECT_CALL(*d_mockSendChannel, publishUnconfirmed(_, _, _, _))
+        .WillOnce(SaveArg<3>(&onPublished));
+
+    EXPECT_THAT(producer->send(
+                    d_message, "key", d_callback, bsls::TimeInterval()),
+                Eq(rmqp::Producer::SENDING));
+
+    rmqt::Result<> result =
+        producer->waitForConfirms(bsls::TimeInterval(0, 1000000));
+    EXPECT_FALSE(result);
+    EXPECT_THAT(result.returnCode(), Eq(rmqt::TIMEOUT));
+
+    onPublished(true);
+    EXPECT_TRUE(producer->waitForConfirms(bsls::TimeInterval(0, 1000000)));
+}
+
+TEST_F(UnconfirmedProducerTests, BatchLargerThanTheLimitIsRejected)
+{
+    bsl::shared_ptr<rmqa::UnconfirmedProducer> producer = createProducer(2);
+
+    bsl::vector<rmqt::Message> messages(3, d_message);
+    EXPECT_THAT(producer->sendBatch(
+                    messages, "key", d_callback, bsls::TimeInterval()),
+                Eq(rmqp::Producer::INFLIGHT_LIMIT));
+}
+
+TEST_F(UnconfirmedProducerTests, StreamsAreNotSupported)
+{
+    bsl::shared_ptr<rmqa::UnconfirmedProducer> producer = createProducer(2);
+
+    EXPECT_FALSE(producer->openStream(
+        d_message, 10, "key", d_callback, bsls::TimeInterval()));
+}
@@ -142,3 +142,38 @@ TEST_F(VHostTests, closeNormalCase)
 
     vhostImpl.close();
 }
+
+TEST_F(VHostTests, PooledChannelsGoToTheLeastLoadedConnection)
+{
+    rmqa::VHostImpl vhostImpl(connectionMakerFunc, 2);
+
+    // Both pooled connections are fresh mocks: reuse the two on hand
+    EXPECT_CALL(connectionMaker, create(bsl::string("producer-0")))
+        .WillOnce(Return(connectionMaker.producerConnection.success()));
+    EXPECT_CALL(connectionMaker, create(bsl::string("producer-1")))
+        .WillOnce(Return(connectionMaker.consumerConnection.success()));
+
+    rmqtestmocks::MockProducer* producer = &connectionMaker.producer;
+    EXPECT_CALL(connectionMaker.producerConnection,
+                createProducerAsync(_, _, _))
+        .Times(2)
+        .WillRepeatedly(InvokeWithoutArgs(
+            producer, &rmqtestmocks::MockProducer::successAsync));
+    EXPECT_CALL(connectionMaker.consumerConnection,
+                createProducerAsync(_, _, _))
+        .WillOnce(InvokeWithoutArgs(
+            producer, &rmqtestmocks::MockProducer::successAsync));
+
+    rmqt::Result<rmqp::Producer> first = vhostImpl.createProducer(
+        topology.topology(), exchange, maxOutstandingConfirms);
+    rmqt::Result<rmqp::Producer> second = vhostImpl.createProducer(
+        topology.topology(), exchange, maxOutstandingConfirms);
+    EXPECT_TRUE(first);
+    EXPECT_TRUE(second);
+
+    // Releasing the first producer frees its connection for the next one
+    first = rmqt::Result<rmqp::Producer>("released");
+    rmqt::Result<rmqp::Producer> third = vhostImpl.createProducer(
+        topology.topology(), exchange, maxOutstandingConfirms);
+    EXPECT_TRUE(third);
+}
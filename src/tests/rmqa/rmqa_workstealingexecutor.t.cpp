@@ -0,0 +1,192 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqa_workstealingexecutor.h>
+
+#include <bdlf_bind.h>
+#include <bslmt_latch.h>
+#include <bslmt_lockguard.h>
+#include <bslmt_mutex.h>
+#include <bslmt_threadattributes.h>
+#include <bsls_atomic.h>
+
+#include <bsl_algorithm.h>
+#include <bsl_memory.h>
+#include <bsl_vector.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqa;
+using namespace ::testing;
+
+namespace {
+const int k_JOBS = 2000;
+
+struct Recorder {
+    bslmt::Mutex d_mutex;
+    bsl::vector<int> d_order;
+    bsls::AtomicInt d_running;
+    bsls::AtomicInt d_overlaps;
+
+    Recorder()
+    : d_mutex()
+    , d_order()
+    , d_running(0)
+    , d_overlaps(0)
+    {
+    }
+
+    void record(int i)
+    {
+        if (d_running.add(1) != 1) {
+            d_overlaps.add(1);
+        }
+        {
+            bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+            d_order.push_back(i);
+        }
+        d_running.add(-1);
+    }
+};
+
+void count(bsls::AtomicInt* counter) { counter->add(1); }
+
+void block(bslmt::Latch* started, bslmt::Latch* release)
+{
+    started->arrive();
+    release->wait();
+}
+
+} // namespace
+
+TEST(WorkStealingExecutor, RunsEveryJob)
+{
+    WorkStealingExecutor executor(bslmt::ThreadAttributes(), 4, 8);
+    ASSERT_EQ(executor.start(), 0);
+
+    bsls::AtomicInt counter(0);
+    bsl::vector<bsl::shared_ptr<WorkStealingExecutor::Lane> > lanes;
+    for (int i = 0; i < 3; ++i) {
+        lanes.push_back(executor.createLane(executor.numWorkers()));
+    }
+    for (int i = 0; i < k_JOBS; ++i) {
+        EXPECT_EQ(executor.submit(lanes[i % lanes.size()],
+                                  bdlf::BindUtil::bind(&count, &counter)),
+                  0);
+    }
+    executor.stop();
+
+    EXPECT_EQ(counter.load(), k_JOBS);
+}
+
+TEST(WorkStealingExecutor, RunsASerialLaneInOrder)
+{
+    WorkStealingExecutor executor(bslmt::ThreadAttributes(), 4, 8);
+    ASSERT_EQ(executor.start(), 0);
+
+    Recorder recorder;
+    bsl::shared_ptr<WorkStealingExecutor::Lane> lane =
+        executor.createLane(1);
+    for (int i = 0; i < k_JOBS; ++i) {
+        executor.submit(lane,
+                        bdlf::BindUtil::bind(&Recorder::record, &recorder, i));
+    }
+    executor.stop();
+
+    ASSERT_EQ(recorder.d_order.size(), static_cast<bsl::size_t>(k_JOBS));
+    for (int i = 0; i < k_JOBS; ++i) {
+        EXPECT_EQ(recorder.d_order[i], i);
+    }
+    EXPECT_EQ(recorder.d_overlaps.load(), 0);
+}
+
+TEST(WorkStealingExecutor, QuotaLetsOtherLanesIn)
+{
+    WorkStealingExecutor executor(bslmt::ThreadAttributes(), 1, 2);
+    ASSERT_EQ(executor.start(), 0);
+
+    bslmt::Latch started(1);
+    bslmt::Latch release(1);
+    Recorder recorder;
+    bsl::shared_ptr<WorkStealingExecutor::Lane> busy = executor.createLane(1);
+    bsl::shared_ptr<WorkStealingExecutor::Lane> quiet =
+        executor.createLane(1);
+
+    // Hold the only worker until the burst and the other lane's job queue
+    executor.submit(busy,
+                    bdlf::BindUtil::bind(&block, &started, &release));
+    started.wait();
+    for (int i = 0; i < 10; ++i) {
+        executor.submit(busy,
+                        bdlf::BindUtil::bind(&Recorder::record, &recorder, i));
+    }
+    executor.submit(quiet,
+                    bdlf::BindUtil::bind(&Recorder::record, &recorder, -1));
+    release.arrive();
+    executor.stop();
+
+    ASSERT_EQ(recorder.d_order.size(), 11u);
+    const bsl::size_t quietAt =
+        bsl::find(recorder.d_order.begin(), recorder.d_order.end(), -1) -
+        recorder.d_order.begin();
+    EXPECT_LE(quietAt, 2u);
+}
+
+TEST(WorkStealingExecutor, RefusesJobsWhenStopped)
+{
+    WorkStealingExecutor executor(bslmt::ThreadAttributes(), 2, 8);
+    bsls::AtomicInt counter(0);
+    bsl::shared_ptr<WorkStealingExecutor::Lane> lane = executor.createLane(1);
+
+    EXPECT_NE(executor.submit(lane, bdlf::BindUtil::bind(&count, &counter)),
+              0);
+
+    ASSERT_EQ(executor.start(), 0);
+    executor.stop();
+
+    EXPECT_NE(executor.submit(lane, bdlf::BindUtil::bind(&count, &counter)),
+              0);
+    EXPECT_EQ(counter.load(), 0);
+}
+
+TEST(WorkStealingExecutor, ResizesWithinItsMaximum)
+{
+    WorkStealingExecutor executor(bslmt::ThreadAttributes(), 2, 8, 6);
+    ASSERT_EQ(executor.start(), 0);
+    EXPECT_EQ(executor.numWorkers(), 2u);
+    EXPECT_EQ(executor.maxWorkers(), 6u);
+
+    EXPECT_EQ(executor.resize(10), 0);
+    EXPECT_EQ(executor.numWorkers(), 6u);
+
+    EXPECT_EQ(executor.resize(1), 0);
+    EXPECT_EQ(executor.numWorkers(), 1u);
+
+    // Grows back, reaping the retired workers
+    EXPECT_EQ(executor.resize(4), 0);
+
+    bsls::AtomicInt counter(0);
+    bsl::shared_ptr<WorkStealingExecutor::Lane> lane =
+        executor.createLane(executor.maxWorkers());
+    for (int i = 0; i < k_JOBS; ++i) {
+        executor.submit(lane, bdlf::BindUtil::bind(&count, &counter));
+    }
+    executor.stop();
+
+    EXPECT_EQ(counter.load(), k_JOBS);
+    EXPECT_EQ(executor.stats().jobsRun, k_JOBS);
+    EXPECT_EQ(executor.stats().queuedJobs, 0);
+}
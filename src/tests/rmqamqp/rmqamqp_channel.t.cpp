@@ -453,6 +453,77 @@ TEST_F(ChannelTests, ResetWillTriggerTopologyDeclare)
     EXPECT_THAT(mockChannel->state(), Eq(rmqamqp::Channel::READY));
 }
 
+TEST_F(ChannelTests, RedeclareAfterResetIsPipelined)
+{
+    rmqt::Topology topology;
+    topology.queues.push_back(bsl::make_shared<rmqt::Queue>(
+        "test-queue-1", false, false, false, rmqt::FieldTable()));
+    topology.queues.push_back(bsl::make_shared<rmqt::Queue>(
+        "test-queue-2", false, false, false, rmqt::FieldTable()));
+
+    bsl::shared_ptr<ChannelTestImpl> mockChannel = makeOpeningChannel(topology);
+
+    rmqt::FieldTable args;
+    rmqamqpt::QueueDeclare queueDeclare1(
+        "test-queue-1", false, false, false, false, false, args);
+    rmqamqpt::QueueDeclare queueDeclare2(
+        "test-queue-2", false, false, false, false, false, args);
+    rmqamqpt::QueueDeclareOk declareOk1("test-queue-1", 0, 0);
+    rmqamqpt::QueueDeclareOk declareOk2("test-queue-2", 0, 0);
+    rmqamqpt::ChannelOpenOk openOkMethod;
+
+    // The first declaration waits for every reply
+    EXPECT_CALL(d_callback,
+                onAsyncWrite(::testing::Pointee(
+                                 MessageEq(rmqamqp::Message(rmqamqpt::Method(
+                                     rmqamqpt::QueueMethod(queueDeclare1))))),
+                             _));
+    EXPECT_CALL(d_callback,
+                onAsyncWrite(::testing::Pointee(
+                                 MessageEq(rmqamqp::Message(rmqamqpt::Method(
+                                     rmqamqpt::QueueMethod(queueDeclare2))))),
+                             _))
+        .Times(2);
+    mockChannel->processReceived(rmqamqp::Message(
+        rmqamqpt::Method(rmqamqpt::ChannelMethod(openOkMethod))));
+    mockChannel->processReceived(rmqamqp::Message(
+        rmqamqpt::Method(rmqamqpt::QueueMethod(declareOk1))));
+    mockChannel->processReceived(rmqamqp::Message(
+        rmqamqpt::Method(rmqamqpt::QueueMethod(declareOk2))));
+    EXPECT_THAT(mockChannel->state(), Eq(rmqamqp::Channel::READY));
+
+    EXPECT_CALL(
+        d_callback,
+        onAsyncWrite(
+            ::testing::Pointee(MessageEq(rmqamqp::Message(rmqamqpt::Method(
+                rmqamqpt::ChannelMethod(rmqamqpt::ChannelOpen()))))),
+            _))
+        .WillOnce(InvokeArgument<1>());
+    EXPECT_CALL(*d_retryHandler, retry(_)).WillOnce(InvokeArgument<0>());
+    EXPECT_CALL(*mockChannel, processFailures());
+
+    mockChannel->reset(true);
+    EXPECT_THAT(mockChannel->state(), Eq(rmqamqp::Channel::CHANNEL_OPEN_SENT));
+
+    // The redeclaration only waits for the reply to the final method
+    rmqamqpt::QueueDeclare pipelinedDeclare1(
+        "test-queue-1", false, false, false, false, true, args);
+    EXPECT_CALL(
+        d_callback,
+        onAsyncWrite(::testing::Pointee(MessageEq(rmqamqp::Message(
+                         rmqamqpt::Method(
+                             rmqamqpt::QueueMethod(pipelinedDeclare1))))),
+                     _));
+    mockChannel->processReceived(rmqamqp::Message(
+        rmqamqpt::Method(rmqamqpt::ChannelMethod(openOkMethod))));
+    EXPECT_THAT(mockChannel->state(), Eq(rmqamqp::Channel::DECLARING_TOPOLOGY));
+
+    EXPECT_THAT(mockChannel->processReceived(rmqamqp::Message(
+                    rmqamqpt::Method(rmqamqpt::QueueMethod(declareOk2)))),
+                Eq(rmqamqp::Channel::KEEP));
+    EXPECT_THAT(mockChannel->state(), Eq(rmqamqp::Channel::READY));
+}
+
 TEST_F(ChannelTests, EmptyTopologyProgresses)
 {
     rmqt::Topology emptyTopology;
@@ -948,6 +1019,51 @@ TEST_F(ChannelTests, sendBindAndUnbind)
     EXPECT_TRUE(future2.tryResult());
 }
 
+TEST_F(ChannelTests, topologyUpdatesArePipelined)
+{
+    rmqt::Topology emptyTopology;
+    bsl::shared_ptr<ChannelTestImpl> mockChannel =
+        makeOpeningChannel(emptyTopology);
+    mockChannel->setState(rmqamqp::Channel::READY);
+
+    bsl::shared_ptr<rmqt::Exchange> exchangePtr =
+        bsl::make_shared<rmqt::Exchange>("exchange");
+    bsl::shared_ptr<rmqt::Queue> queuePtr =
+        bsl::make_shared<rmqt::Queue>("queue");
+
+    rmqt::FieldTable args;
+    rmqamqpt::QueueBind queueBind("queue", "exchange", "bindKey", false, args);
+    EXPECT_CALL(
+        d_callback,
+        onAsyncWrite(::testing::Pointee(MessageEq(rmqamqp::Message(
+                         rmqamqpt::Method(rmqamqpt::QueueMethod(queueBind))))),
+                     _))
+        .Times(3);
+    bsl::shared_ptr<rmqt::QueueBinding> queueBindingPtr =
+        bsl::make_shared<rmqt::QueueBinding>(exchangePtr, queuePtr, "bindKey");
+    rmqt::TopologyUpdate topologyUpdate;
+    topologyUpdate.updates.push_back(
+        rmqt::TopologyUpdate::SupportedUpdate(queueBindingPtr));
+
+    bsl::vector<rmqt::Future<> > futures;
+    for (int i = 0; i < 3; ++i) {
+        futures.push_back(mockChannel->updateTopology(topologyUpdate));
+    }
+
+    // All three were written before any reply arrived
+    ::testing::Mock::VerifyAndClearExpectations(&d_callback);
+
+    rmqamqpt::QueueBindOk queueBindOkMethod;
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_FALSE(futures[i].tryResult());
+        EXPECT_THAT(
+            mockChannel->processReceived(rmqamqp::Message(rmqamqpt::Method(
+                rmqamqpt::QueueMethod(queueBindOkMethod)))),
+            Eq(rmqamqp::Channel::KEEP));
+        EXPECT_TRUE(futures[i].tryResult());
+    }
+}
+
 TEST_F(ChannelTests, onWriteCompleteCbValidity)
 {
     // Ensure that the onWriteComplete callback can be invoked after the Channel
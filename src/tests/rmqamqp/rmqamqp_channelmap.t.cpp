@@ -148,6 +148,24 @@ TEST(ChannelMap, ProcessReceivedCleanup)
     EXPECT_THAT(channel.use_count(), Eq(1));
 }
 
+TEST(ChannelMap, ProcessReceivedAfterRemove)
+{
+    rmqamqp::ChannelMap map;
+    EXPECT_THAT(map.assignId(), Eq(1));
+    EXPECT_THAT(map.assignId(), Eq(2));
+    bsl::shared_ptr<rmqtestutil::MockSendChannel> channel =
+        bsl::make_shared<rmqtestutil::MockSendChannel>();
+    map.associateChannel(2, bsl::shared_ptr<rmqamqp::SendChannel>(channel));
+    map.removeChannel(2);
+
+    EXPECT_CALL(*channel, processReceived(_)).Times(0);
+
+    rmqamqp::Message msg;
+    EXPECT_FALSE(map.processReceived(2, msg));
+    EXPECT_FALSE(map.processReceived(1, msg));
+    EXPECT_FALSE(map.processReceived(3, msg));
+}
+
 TEST(ChannelMap, RemoveChannel)
 {
     rmqamqp::ChannelMap map;
@@ -31,9 +31,10 @@
 #include <rmqio_serializedframe.h>
 #include <rmqp_metricpublisher.h>
 #include <rmqt_consumerack.h>
-#include <rmqt_consumerackbatch.h>
+#include <rmqt_consumerackqueue.h>
 #include <rmqt_consumerconfig.h>
 #include <rmqt_fieldvalue.h>
+#include <rmqt_localendpoint.h>
 #include <rmqt_plaincredentials.h>
 #include <rmqt_simpleendpoint.h>
 
@@ -78,7 +79,7 @@ rmqt::FieldTable generateDefaultClientProperties(
     bsl::shared_ptr<rmqt::FieldTable> capabilities =
         bsl::make_shared<rmqt::FieldTable>();
 
-    (*capabilities)["connection.blocked"]           = rmqt::FieldValue(false);
+    (*capabilities)["connection.blocked"]           = rmqt::FieldValue(true);
     (*capabilities)["authentication_failure_close"] = rmqt::FieldValue(true);
     (*capabilities)["consumer_cancel_notify"]       = rmqt::FieldValue(true);
     (*capabilities)["publisher_confirms"]           = rmqt::FieldValue(true);
@@ -1081,6 +1082,70 @@ TEST_F(ConnectionTests, ReopenConnectionIfServerCloses)
     d_eventLoop.run();
 }
 
+TEST_F(ConnectionTests, BlockedAndUnblockedByServer)
+{
+    expectFirstHandshakeFrames();
+
+    {
+        bsl::shared_ptr<rmqamqp::Connection> conn = createAndStartConnection();
+
+        // 1. Setup connection
+        d_eventLoop.run();
+        d_eventLoop.restart();
+
+        EXPECT_FALSE(conn->blocked());
+
+        Frame blockedFrame;
+        Framer::makeMethodFrame(
+            &blockedFrame,
+            0,
+            Method(ConnectionMethod(ConnectionBlocked("low on memory"))));
+        d_replayFrame.pushInbound(
+            bsl::make_shared<SerializedFrame>(blockedFrame));
+
+        EXPECT_CALL(*d_metricPublisher,
+                    publishGauge(bsl::string("connection_blocked"),
+                                 1,
+                                 d_vhostTag));
+
+        feedNextFrame();
+
+        // 2. Server blocks publishing
+        d_eventLoop.run();
+        d_eventLoop.restart();
+
+        EXPECT_TRUE(conn->blocked());
+        EXPECT_TRUE(conn->publishGate()->isClosed());
+        EXPECT_THAT(conn->publishGate()->reason(), Eq("low on memory"));
+
+        const ConnectionUnblocked unblockedMethod;
+        Frame unblockedFrame;
+        Framer::makeMethodFrame(
+            &unblockedFrame, 0, Method(ConnectionMethod(unblockedMethod)));
+        d_replayFrame.pushInbound(
+            bsl::make_shared<SerializedFrame>(unblockedFrame));
+
+        EXPECT_CALL(*d_metricPublisher,
+                    publishGauge(bsl::string("connection_blocked"),
+                                 0,
+                                 d_vhostTag));
+
+        feedNextFrame();
+
+        // 3. Server unblocks publishing
+        d_eventLoop.run();
+        d_eventLoop.restart();
+
+        EXPECT_FALSE(conn->blocked());
+        EXPECT_FALSE(conn->publishGate()->isClosed());
+
+        expectShutdownCalls();
+    }
+
+    // 4. Process shutdown
+    d_eventLoop.run();
+}
+
 class ConnectionHeartbeatTests : public ConnectionTests {};
 
 TEST_F(ConnectionHeartbeatTests, SendHeartbeat)
@@ -1344,6 +1409,21 @@ TEST_F(ConnectionTests, ConnectionDiesWhenDestructedMidConnection)
     EXPECT_FALSE(weakConn.lock());
 }
 
+TEST_F(ConnectionTests, LocalEndpointConnectsToItsSocket)
+{
+    EXPECT_CALL(*d_resolver, asyncConnect(_, _, _, _, _, _)).Times(0);
+    EXPECT_CALL(*d_resolver,
+                asyncLocalConnect(Eq("/var/run/rabbitmq.sock"), _, _, _, _))
+        .WillOnce(Return(bsl::shared_ptr<rmqio::Connection>()));
+
+    bsl::shared_ptr<rmqamqp::Connection> conn = d_factory->create(
+        bsl::make_shared<rmqt::LocalEndpoint>("/var/run/rabbitmq.sock",
+                                              TEST_VHOST),
+        d_credentials,
+        "test-connection");
+    conn->startFirstConnection(d_onConnectCb);
+}
+
 class TuneParamNegotiationTests : public ConnectionTests {};
 
 TEST_F(TuneParamNegotiationTests, ServerSendsZeroNegotiateToOurValue)
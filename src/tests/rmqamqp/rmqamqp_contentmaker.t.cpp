@@ -17,7 +17,12 @@
 
 #include <rmqt_message.h>
 
+#include <bslma_testallocator.h>
+
 #include <bsl_iostream.h>
+#include <bsl_memory.h>
+#include <bsl_string.h>
+#include <bsl_vector.h>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -25,6 +30,30 @@
 using namespace BloombergLP;
 using namespace ::testing;
 
+namespace {
+
+/// Return a read block holding one body frame with `size` bytes of `fill`
+bsl::shared_ptr<bsl::vector<uint8_t> > bodyFrameBlock(bsl::size_t size,
+                                                      uint8_t fill)
+{
+    const uint8_t header[] = {0x03,
+                              0x00,
+                              0x01,
+                              static_cast<uint8_t>(size >> 24),
+                              static_cast<uint8_t>(size >> 16),
+                              static_cast<uint8_t>(size >> 8),
+                              static_cast<uint8_t>(size)};
+
+    bsl::shared_ptr<bsl::vector<uint8_t> > block =
+        bsl::make_shared<bsl::vector<uint8_t> >(header,
+                                                header + sizeof(header));
+    block->resize(block->size() + size, fill);
+    block->push_back(0xCE);
+    return block;
+}
+
+} // namespace
+
 TEST(ContentMaker, HeaderOnlyDoneTrue)
 {
     rmqamqp::ContentMaker maker(rmqamqpt::ContentHeader(
@@ -35,3 +64,195 @@ TEST(ContentMaker, HeaderOnlyDoneTrue)
     EXPECT_FALSE(msg.payload());
     EXPECT_THAT(msg.payloadSize(), Eq(0));
 }
+
+TEST(ContentMaker, StitchesHeldBodyFrames)
+{
+    rmqamqp::ContentMaker maker(rmqamqpt::ContentHeader(
+        rmqamqpt::Constants::BASIC, 5, rmqamqpt::BasicProperties()));
+
+    // Two body frames sharing one read block: "abc" then "de"
+    const uint8_t bytes[] = {0x03, 0x00, 0x01, 0x00, 0x00, 0x00, 0x03, 'a',
+                             'b',  'c',  0xCE, 0x03, 0x00, 0x01, 0x00, 0x00,
+                             0x00, 0x02, 'd',  'e',  0xCE};
+    bsl::shared_ptr<bsl::vector<uint8_t> > block =
+        bsl::make_shared<bsl::vector<uint8_t> >(bytes, bytes + sizeof(bytes));
+
+    EXPECT_THAT(maker.appendContentFrame(rmqamqpt::Frame(
+                    rmqamqpt::Constants::BODY, 1, block, 0, 11)),
+                Eq(rmqamqp::ContentMaker::PARTIAL));
+    EXPECT_THAT(maker.appendContentFrame(rmqamqpt::Frame(
+                    rmqamqpt::Constants::BODY, 1, block, 11, 10)),
+                Eq(rmqamqp::ContentMaker::DONE));
+
+    rmqt::Message msg(maker.message());
+    ASSERT_THAT(msg.payloadSize(), Eq(5));
+    EXPECT_THAT(bsl::string(msg.payload(), msg.payload() + 5), Eq("abcde"));
+
+    // The frames are chained rather than copied
+    ASSERT_TRUE(msg.payloadSegments());
+    ASSERT_THAT(msg.payloadSegments()->numSegments(), Eq(2));
+    EXPECT_THAT(msg.payloadSegments()->segment(0).first, Eq(&(*block)[7]));
+    EXPECT_THAT(msg.payloadSegments()->segment(1).first, Eq(&(*block)[18]));
+}
+
+TEST(ContentMaker, CopiesSingleBodyFrame)
+{
+    rmqamqp::ContentMaker maker(rmqamqpt::ContentHeader(
+        rmqamqpt::Constants::BASIC, 2, rmqamqpt::BasicProperties()));
+
+    const uint8_t bytes[] = {
+        0x03, 0x00, 0x01, 0x00, 0x00, 0x00, 0x02, 'd', 'e', 0xCE};
+    bsl::shared_ptr<bsl::vector<uint8_t> > block =
+        bsl::make_shared<bsl::vector<uint8_t> >(bytes, bytes + sizeof(bytes));
+
+    EXPECT_THAT(maker.appendContentFrame(rmqamqpt::Frame(
+                    rmqamqpt::Constants::BODY, 1, block, 0, sizeof(bytes))),
+                Eq(rmqamqp::ContentMaker::DONE));
+
+    rmqt::Message msg(maker.message());
+    EXPECT_FALSE(msg.payloadSegments());
+    ASSERT_THAT(msg.payloadSize(), Eq(2));
+    EXPECT_THAT(bsl::string(msg.payload(), msg.payload() + 2), Eq("de"));
+}
+
+TEST(ContentMaker, TooMuchBodyInFrame)
+{
+    rmqamqp::ContentMaker maker(rmqamqpt::ContentHeader(
+        rmqamqpt::Constants::BASIC, 1, rmqamqpt::BasicProperties()));
+
+    const uint8_t bytes[] = {
+        0x03, 0x00, 0x01, 0x00, 0x00, 0x00, 0x02, 'd', 'e', 0xCE};
+    bsl::shared_ptr<bsl::vector<uint8_t> > block =
+        bsl::make_shared<bsl::vector<uint8_t> >(bytes, bytes + sizeof(bytes));
+
+    EXPECT_THAT(maker.appendContentFrame(rmqamqpt::Frame(
+                    rmqamqpt::Constants::BODY, 1, block, 0, sizeof(bytes))),
+                Eq(rmqamqp::ContentMaker::ERROR));
+}
+
+TEST(ContentMaker, PayloadComesFromSuppliedAllocator)
+{
+    bslma::TestAllocator allocator;
+
+    // Too large to be held inline in the message
+    const bsl::size_t size = rmqt::Message::INLINE_PAYLOAD_CAPACITY + 1;
+    bsl::shared_ptr<bsl::vector<uint8_t> > block = bodyFrameBlock(size, 7);
+
+    {
+        rmqt::Message msg;
+        {
+            rmqamqp::ContentMaker maker(
+                rmqamqpt::ContentHeader(rmqamqpt::Constants::BASIC,
+                                        size,
+                                        rmqamqpt::BasicProperties()),
+                &allocator);
+            EXPECT_THAT(
+                maker.appendContentFrame(rmqamqpt::Frame(
+                    rmqamqpt::Constants::BODY, 1, block, 0, block->size())),
+                Eq(rmqamqp::ContentMaker::DONE));
+            msg = maker.message();
+        }
+
+        // The maker is gone, the message still holds its payload
+        EXPECT_THAT(allocator.numBlocksInUse(), Gt(0));
+        ASSERT_THAT(msg.payloadSize(), Eq(size));
+        EXPECT_THAT(msg.payload()[size - 1], Eq(7));
+    }
+
+    EXPECT_THAT(allocator.numBlocksInUse(), Eq(0));
+}
+
+TEST(ContentMaker, AssemblesIntoSuppliedPayloadBuffer)
+{
+    rmqamqp::ContentMaker maker(rmqamqpt::ContentHeader(
+        rmqamqpt::Constants::BASIC, 5, rmqamqpt::BasicProperties()));
+
+    bsl::shared_ptr<bsl::vector<uint8_t> > storage =
+        bsl::make_shared<bsl::vector<uint8_t> >(5);
+    bsl::shared_ptr<uint8_t> buffer(storage, storage->data());
+    maker.setPayloadBuffer(buffer);
+
+    bsl::shared_ptr<bsl::vector<uint8_t> > first  = bodyFrameBlock(3, 'a');
+    bsl::shared_ptr<bsl::vector<uint8_t> > second = bodyFrameBlock(2, 'b');
+    EXPECT_THAT(maker.appendContentFrame(rmqamqpt::Frame(
+                    rmqamqpt::Constants::BODY, 1, first, 0, first->size())),
+                Eq(rmqamqp::ContentMaker::PARTIAL));
+    EXPECT_THAT(maker.appendContentFrame(rmqamqpt::Frame(
+                    rmqamqpt::Constants::BODY, 1, second, 0, second->size())),
+                Eq(rmqamqp::ContentMaker::DONE));
+
+    const rmqt::Message msg(maker.message());
+    maker.clear();
+
+    // The body was copied into the buffer, and neither frame is held
+    EXPECT_FALSE(msg.payloadSegments());
+    EXPECT_THAT(msg.payload(), Eq(buffer.get()));
+    EXPECT_THAT(bsl::string(msg.payload(), msg.payload() + 5), Eq("aaabb"));
+    EXPECT_THAT(first.use_count(), Eq(1));
+    EXPECT_THAT(second.use_count(), Eq(1));
+    EXPECT_THAT(buffer.use_count(), Gt(1));
+}
+
+TEST(ContentMaker, TooMuchBodyForPayloadBuffer)
+{
+    rmqamqp::ContentMaker maker(rmqamqpt::ContentHeader(
+        rmqamqpt::Constants::BASIC, 1, rmqamqpt::BasicProperties()));
+    maker.setPayloadBuffer(bsl::make_shared<uint8_t>(0));
+
+    bsl::shared_ptr<bsl::vector<uint8_t> > block = bodyFrameBlock(2, 'c');
+    EXPECT_THAT(maker.appendContentFrame(rmqamqpt::Frame(
+                    rmqamqpt::Constants::BODY, 1, block, 0, block->size())),
+                Eq(rmqamqp::ContentMaker::ERROR));
+}
+
+TEST(ContentMaker, SmallSingleBodyFrameIsHeldInline)
+{
+    bslma::TestAllocator allocator;
+
+    bsl::shared_ptr<bsl::vector<uint8_t> > block = bodyFrameBlock(10, 3);
+
+    rmqamqp::ContentMaker maker(
+        rmqamqpt::ContentHeader(
+            rmqamqpt::Constants::BASIC, 10, rmqamqpt::BasicProperties()),
+        &allocator);
+    EXPECT_THAT(maker.appendContentFrame(rmqamqpt::Frame(
+                    rmqamqpt::Constants::BODY, 1, block, 0, block->size())),
+                Eq(rmqamqp::ContentMaker::DONE));
+
+    const rmqt::Message msg(maker.message());
+    maker.clear();
+
+    EXPECT_THAT(allocator.numBlocksInUse(), Eq(0));
+    EXPECT_FALSE(msg.payloadOwner());
+    ASSERT_THAT(msg.payloadSize(), Eq(10));
+    EXPECT_THAT(msg.payload()[9], Eq(3));
+
+    // The read block is not held on to
+    EXPECT_THAT(block.use_count(), Eq(1));
+}
+
+TEST(ContentMaker, ResetStartsTheNextMessage)
+{
+    bsl::shared_ptr<bsl::vector<uint8_t> > first  = bodyFrameBlock(2, 1);
+    bsl::shared_ptr<bsl::vector<uint8_t> > second = bodyFrameBlock(3, 2);
+
+    rmqamqp::ContentMaker maker(rmqamqpt::ContentHeader(
+        rmqamqpt::Constants::BASIC, 2, rmqamqpt::BasicProperties()));
+    EXPECT_THAT(maker.appendContentFrame(rmqamqpt::Frame(
+                    rmqamqpt::Constants::BODY, 1, first, 0, first->size())),
+                Eq(rmqamqp::ContentMaker::DONE));
+    const rmqt::Message firstMsg(maker.message());
+
+    maker.reset(rmqamqpt::ContentHeader(
+        rmqamqpt::Constants::BASIC, 3, rmqamqpt::BasicProperties()));
+    EXPECT_FALSE(maker.done());
+    EXPECT_THAT(maker.appendContentFrame(rmqamqpt::Frame(
+                    rmqamqpt::Constants::BODY, 1, second, 0, second->size())),
+                Eq(rmqamqp::ContentMaker::DONE));
+    const rmqt::Message secondMsg(maker.message());
+
+    ASSERT_THAT(firstMsg.payloadSize(), Eq(2));
+    EXPECT_THAT(firstMsg.payload()[0], Eq(1));
+    ASSERT_THAT(secondMsg.payloadSize(), Eq(3));
+    EXPECT_THAT(secondMsg.payload()[0], Eq(2));
+}
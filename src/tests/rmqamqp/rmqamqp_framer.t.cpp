@@ -15,12 +15,24 @@
 
 #include <rmqamqp_framer.h>
 
+#include <rmqamqpt_basicack.h>
+#include <rmqamqpt_basicmethod.h>
+#include <rmqamqpt_basicnack.h>
+#include <rmqamqpt_basicproperties.h>
+#include <rmqamqpt_basicpublish.h>
 #include <rmqamqpt_connectionmethod.h>
 #include <rmqamqpt_connectionopen.h>
+#include <rmqamqpt_constants.h>
+#include <rmqamqpt_contentbody.h>
+#include <rmqamqpt_contentheader.h>
+#include <rmqamqpt_encodedmethod.h>
 #include <rmqamqpt_writer.h>
 #include <rmqio_serializedframe.h>
 #include <rmqt_fieldvalue.h>
 
+#include <bdlf_bind.h>
+#include <bdlf_placeholder.h>
+
 #include <boost/iostreams/device/back_inserter.hpp>
 #include <boost/iostreams/stream.hpp>
 
@@ -184,6 +196,24 @@ TEST(Framer, SerialiseMethod)
     // test frame.payload()[0..4] are as expected
 }
 
+TEST(Framer, EncodedMethodFramesAsMethod)
+{
+    const rmqamqpt::Method method(rmqamqpt::BasicMethod(
+        rmqamqpt::BasicPublish("exchange", "key", false, false)));
+    const rmqamqpt::EncodedMethod encoded(method);
+
+    rmqamqp::Framer framer;
+    bsl::vector<rmqamqpt::Frame> frames, encodedFrames;
+    framer.makeFrames(&frames, 3, rmqamqp::Message(method));
+    framer.makeFrames(&encodedFrames, 3, rmqamqp::Message(encoded));
+    EXPECT_THAT(encodedFrames, Eq(frames));
+
+    bsl::vector<bsl::shared_ptr<rmqio::SerializedFrame> > serialized;
+    framer.makeSerializedFrames(&serialized, 3, rmqamqp::Message(encoded));
+    ASSERT_THAT(serialized, SizeIs(1));
+    EXPECT_TRUE(*serialized[0] == rmqio::SerializedFrame(frames[0]));
+}
+
 TEST(Framer, MessageHeartbeatSerialize)
 {
     const rmqamqp::Message msg((rmqamqpt::Heartbeat()));
@@ -223,6 +253,59 @@ TEST(Framer, MakeHeartbeatEquivalentToSerialize)
     EXPECT_THAT(frames[0], Eq(rmqamqp::Framer::makeHeartbeatFrame()));
 }
 
+TEST(Framer, HeartbeatFramesShareABuffer)
+{
+    EXPECT_THAT(rmqamqp::Framer::makeHeartbeatFrame().serializedData(),
+                Eq(rmqamqp::Framer::makeHeartbeatFrame().serializedData()));
+}
+
+TEST(Framer, AckFramesMatchEncodedMethodFrames)
+{
+    const rmqamqpt::Method methods[] = {
+        rmqamqpt::Method(
+            rmqamqpt::BasicMethod(rmqamqpt::BasicAck(0x0102030405060708ULL,
+                                                     false))),
+        rmqamqpt::Method(rmqamqpt::BasicMethod(rmqamqpt::BasicAck(7, true))),
+        rmqamqpt::Method(
+            rmqamqpt::BasicMethod(rmqamqpt::BasicNack(9, false, false))),
+        rmqamqpt::Method(
+            rmqamqpt::BasicMethod(rmqamqpt::BasicNack(9, true, true))),
+    };
+
+    for (bsl::size_t i = 0; i < sizeof(methods) / sizeof(methods[0]); ++i) {
+        rmqamqpt::Frame frame;
+        rmqamqp::Framer::makeMethodFrame(&frame, 0x0304, methods[i]);
+
+        uint8_t ack[rmqamqp::Framer::k_ACK_FRAME_SIZE];
+        ASSERT_TRUE(rmqamqp::Framer::makeAckFrame(ack, 0x0304, methods[i]));
+        EXPECT_THAT(ack,
+                    ElementsAreArray(frame.serializedData()->data(),
+                                     frame.totalFrameSize()));
+
+        rmqamqp::Framer framer;
+        bsl::vector<bsl::shared_ptr<rmqio::SerializedFrame> > serialized;
+        framer.makeSerializedFrames(
+            &serialized, 0x0304, rmqamqp::Message(methods[i]));
+        ASSERT_THAT(serialized, SizeIs(1));
+        EXPECT_TRUE(*serialized[0] == rmqio::SerializedFrame(frame));
+    }
+}
+
+TEST(Framer, OtherMethodsHaveNoAckFrame)
+{
+    uint8_t ack[rmqamqp::Framer::k_ACK_FRAME_SIZE];
+    EXPECT_FALSE(rmqamqp::Framer::makeAckFrame(
+        ack,
+        1,
+        rmqamqpt::Method(rmqamqpt::BasicMethod(
+            rmqamqpt::BasicPublish("exchange", "key", false, false)))));
+    EXPECT_FALSE(rmqamqp::Framer::makeAckFrame(
+        ack,
+        1,
+        rmqamqpt::Method(
+            rmqamqpt::ConnectionMethod(rmqamqpt::ConnectionOpen()))));
+}
+
 TEST_F(ContentDecodeTests, ContentEncodeDecode)
 {
     rmqamqp::Message sendMessage(messageMaker("Hello World"));
@@ -266,6 +349,58 @@ TEST_F(ContentDecodeTests, ContentEncodeDecodeWithMessageHeaders)
                 Eq(sendMessage.the<rmqt::Message>()));
 }
 
+TEST_F(ContentDecodeTests, LazyHeadersAreKeptEncoded)
+{
+    bsl::shared_ptr<rmqt::FieldTable> headers(
+        bsl::make_shared<rmqt::FieldTable>());
+    (*headers)["this_test"] = rmqt::FieldValue(bsl::string("will pass"));
+    const rmqt::Message msg = messageMaker("Hello World", headers);
+    rmqamqp::Message receiveMessage;
+    uint16_t inboundChannel;
+
+    rmqamqp::Framer framer;
+    framer.setLazyHeaders(2, true);
+    // Lazy headers are configuration, which a new connection keeps
+    framer.reset();
+
+    bsl::vector<rmqamqpt::Frame> frames;
+    framer.makeFrames(&frames, 2, rmqamqp::Message(msg));
+
+    for (bsl::vector<rmqamqpt::Frame>::const_iterator frame = frames.begin();
+         framer.appendFrame(&inboundChannel, &receiveMessage, *frame) ==
+         rmqamqp::Framer::PARTIAL;
+         ++frame)
+        ;
+    ASSERT_TRUE(receiveMessage.is<rmqt::Message>());
+    const rmqt::Message& received = receiveMessage.the<rmqt::Message>();
+    EXPECT_FALSE(received.headers());
+    ASSERT_TRUE(received.headersView());
+    EXPECT_THAT(received.messageId(), Eq(msg.messageId()));
+
+    rmqt::FieldValue value;
+    EXPECT_TRUE(received.findHeader(&value, "this_test"));
+    EXPECT_THAT(value, Eq(rmqt::FieldValue(bsl::string("will pass"))));
+    ASSERT_TRUE(received.decodedHeaders());
+    EXPECT_THAT(*received.decodedHeaders(), Eq(*headers));
+
+    // Publishing the consumed message again sends its headers
+    bsl::vector<rmqamqpt::Frame> republished;
+    framer.makeFrames(&republished, 2, receiveMessage);
+    ASSERT_THAT(republished, Not(IsEmpty()));
+    EXPECT_THAT(republished[0], Eq(frames[0]));
+
+    // Other channels decode headers as before
+    frames.clear();
+    framer.makeFrames(&frames, 3, rmqamqp::Message(msg));
+    for (bsl::vector<rmqamqpt::Frame>::const_iterator frame = frames.begin();
+         framer.appendFrame(&inboundChannel, &receiveMessage, *frame) ==
+         rmqamqp::Framer::PARTIAL;
+         ++frame)
+        ;
+    EXPECT_FALSE(receiveMessage.the<rmqt::Message>().headersView());
+    EXPECT_THAT(receiveMessage.the<rmqt::Message>(), Eq(msg));
+}
+
 // No need to send extra byte to set delivery mode non-persistent.
 // Because broker has non-persistent by default.
 TEST_F(ContentDecodeTests, ContentEncodeDecodeWithoutDeliveryMode)
@@ -420,6 +555,68 @@ TEST_F(ContentDecodeTests, MultipleContentBody)
     EXPECT_EQ(memcmp(message.payload() + 5, data2, 5), 0);
 }
 
+namespace {
+
+/// Hands out `buffer`, recording the size asked for in `requested`
+bsl::shared_ptr<uint8_t>
+supplyBuffer(bsl::size_t* requested,
+             const bsl::shared_ptr<bsl::vector<uint8_t> >& buffer,
+             bsl::size_t bodySize)
+{
+    *requested = bodySize;
+    return bsl::shared_ptr<uint8_t>(buffer, buffer->data());
+}
+
+} // namespace
+
+TEST_F(ContentDecodeTests, PayloadAllocatorSuppliesTheBody)
+{
+    rmqamqpt::Frame frame;
+    uint16_t channel;
+    rmqamqp::Framer framer;
+    rmqamqp::Message received;
+
+    bsl::size_t requested = 0;
+    bsl::shared_ptr<bsl::vector<uint8_t> > buffer =
+        bsl::make_shared<bsl::vector<uint8_t> >(16);
+    framer.setPayloadAllocator(
+        2,
+        bdlf::BindUtil::bind(
+            &supplyBuffer, &requested, buffer, bdlf::PlaceHolders::_1));
+
+    rmqamqpt::ContentHeader contentHeader(
+        rmqamqpt::Constants::BASIC, 10, rmqamqpt::BasicProperties());
+    frame = makeHeaderFrame(rmqamqpt::Constants::HEADER, 2, contentHeader);
+    EXPECT_THAT(framer.appendFrame(&channel, &received, frame),
+                Eq(rmqamqp::Framer::PARTIAL));
+    EXPECT_THAT(requested, Eq(10));
+
+    const uint8_t* data1 = reinterpret_cast<const uint8_t*>("hello");
+    frame = makeBodyFrame(
+        rmqamqpt::Constants::BODY, 2, rmqamqpt::ContentBody(data1, 5));
+    EXPECT_THAT(framer.appendFrame(&channel, &received, frame),
+                Eq(rmqamqp::Framer::PARTIAL));
+
+    const uint8_t* data2 = reinterpret_cast<const uint8_t*>("world");
+    frame = makeBodyFrame(
+        rmqamqpt::Constants::BODY, 2, rmqamqpt::ContentBody(data2, 5));
+    EXPECT_THAT(framer.appendFrame(&channel, &received, frame),
+                Eq(rmqamqp::Framer::OK));
+
+    ASSERT_TRUE(received.is<rmqt::Message>());
+    const rmqt::Message message = received.the<rmqt::Message>();
+    ASSERT_THAT(message.payloadSize(), Eq(10));
+    EXPECT_THAT(message.payload(), Eq(buffer->data()));
+    EXPECT_EQ(memcmp(message.payload(), "helloworld", 10), 0);
+
+    // Other channels are unaffected
+    frame = makeHeaderFrame(rmqamqpt::Constants::HEADER, 3, contentHeader);
+    requested = 0;
+    EXPECT_THAT(framer.appendFrame(&channel, &received, frame),
+                Eq(rmqamqp::Framer::PARTIAL));
+    EXPECT_THAT(requested, Eq(0));
+}
+
 TEST_F(ContentDecodeTests, ClearChannelTest)
 {
     rmqamqpt::Frame frame;
@@ -442,6 +639,61 @@ TEST_F(ContentDecodeTests, ClearChannelTest)
     EXPECT_EQ(channel, 2);
 }
 
+TEST_F(ContentDecodeTests, InterleavedChannelsAreAssembledSeparately)
+{
+    uint16_t channel;
+    rmqamqp::Framer framer;
+    rmqamqp::Message received;
+
+    rmqamqpt::ContentHeader contentHeader(
+        rmqamqpt::Constants::BASIC, 5, rmqamqpt::BasicProperties());
+    EXPECT_THAT(framer.appendFrame(&channel,
+                                   &received,
+                                   makeHeaderFrame(rmqamqpt::Constants::HEADER,
+                                                   7,
+                                                   contentHeader)),
+                Eq(rmqamqp::Framer::PARTIAL));
+    EXPECT_THAT(framer.appendFrame(&channel,
+                                   &received,
+                                   makeHeaderFrame(rmqamqpt::Constants::HEADER,
+                                                   1,
+                                                   contentHeader)),
+                Eq(rmqamqp::Framer::PARTIAL));
+
+    const uint8_t* data1 = reinterpret_cast<const uint8_t*>("first");
+    EXPECT_THAT(framer.appendFrame(
+                    &channel,
+                    &received,
+                    makeBodyFrame(rmqamqpt::Constants::BODY,
+                                  1,
+                                  rmqamqpt::ContentBody(data1, 5))),
+                Eq(rmqamqp::Framer::OK));
+    EXPECT_EQ(channel, 1);
+    ASSERT_TRUE(received.is<rmqt::Message>());
+    EXPECT_EQ(memcmp(received.the<rmqt::Message>().payload(), data1, 5), 0);
+
+    const uint8_t* data7 = reinterpret_cast<const uint8_t*>("seven");
+    EXPECT_THAT(framer.appendFrame(
+                    &channel,
+                    &received,
+                    makeBodyFrame(rmqamqpt::Constants::BODY,
+                                  7,
+                                  rmqamqpt::ContentBody(data7, 5))),
+                Eq(rmqamqp::Framer::OK));
+    EXPECT_EQ(channel, 7);
+    ASSERT_TRUE(received.is<rmqt::Message>());
+    EXPECT_EQ(memcmp(received.the<rmqt::Message>().payload(), data7, 5), 0);
+
+    // The completed message is no longer in progress on the channel
+    EXPECT_THAT(framer.appendFrame(
+                    &channel,
+                    &received,
+                    makeBodyFrame(rmqamqpt::Constants::BODY,
+                                  7,
+                                  rmqamqpt::ContentBody(data7, 5))),
+                Eq(rmqamqp::Framer::CHANNEL_EXCEPTION));
+}
+
 TEST_F(ContentEncodeTests, ZeroBodySizeDoesNotProduceBodyFrame)
 {
     framer.makeFrames(&frames, 2, rmqamqp::Message(rmqt::Message()));
@@ -514,3 +766,174 @@ TEST_F(ContentEncodeTests, EncodeContentHeaderBodyFrames)
                 Eq(rmqamqp::Framer::OK));
     EXPECT_EQ(channel, 5);
 }
+
+TEST_F(ContentEncodeTests, SerializedFramesMatchCopiedFrames)
+{
+    const size_t messageBytes = 60;
+    bsl::shared_ptr<bsl::vector<uint8_t> > payload =
+        bsl::make_shared<bsl::vector<uint8_t> >(messageBytes);
+    for (size_t i = 0; i < messageBytes; ++i) {
+        (*payload)[i] = static_cast<uint8_t>(i);
+    }
+    const rmqamqp::Message theMessage((rmqt::Message(payload)));
+
+    framer.makeFrames(&frames, 2, theMessage);
+
+    bsl::vector<bsl::shared_ptr<rmqio::SerializedFrame> > serialized;
+    framer.makeSerializedFrames(&serialized, 2, theMessage);
+
+    ASSERT_THAT(serialized, SizeIs(frames.size()));
+    for (size_t i = 0; i < frames.size(); ++i) {
+        EXPECT_TRUE(*serialized[i] == rmqio::SerializedFrame(frames[i]));
+    }
+}
+
+TEST_F(ContentEncodeTests, SerializedBodyFramesReferencePayload)
+{
+    const size_t messageBytes = 60;
+    const size_t firstFrame =
+        MAX_FRAME_SIZE - rmqamqpt::Frame::frameOverhead();
+    const rmqt::Message msg(
+        bsl::make_shared<bsl::vector<uint8_t> >(messageBytes));
+
+    bsl::vector<bsl::shared_ptr<rmqio::SerializedFrame> > serialized;
+    framer.makeSerializedFrames(&serialized, 2, rmqamqp::Message(msg));
+
+    ASSERT_THAT(serialized, SizeIs(3));
+
+    // Header frame is contiguous and owned
+    EXPECT_THAT(serialized[0]->numSegments(), Eq(1));
+
+    // Body frames are header/payload/frame-end views
+    ASSERT_THAT(serialized[1]->numSegments(), Eq(3));
+    EXPECT_THAT(serialized[1]->segment(1).first, Eq(msg.payload()));
+    EXPECT_THAT(serialized[1]->segment(1).second, Eq(firstFrame));
+    EXPECT_THAT(serialized[2]->segment(1).first,
+                Eq(msg.payload() + firstFrame));
+    EXPECT_THAT(serialized[2]->frameLength(),
+                Eq(rmqamqpt::Frame::calculateFrameSize(messageBytes -
+                                                       firstFrame)));
+}
+
+TEST_F(ContentEncodeTests, ExternalPayloadIsHeldUntilItsFramesAreWritten)
+{
+    const size_t messageBytes = 60;
+    bsl::shared_ptr<bsl::vector<uint8_t> > slab =
+        bsl::make_shared<bsl::vector<uint8_t> >(messageBytes);
+    const uint8_t* data = slab->data();
+
+    bsl::vector<bsl::shared_ptr<rmqio::SerializedFrame> > serialized;
+    {
+        const rmqt::Message msg(data, messageBytes, slab, rmqt::Properties());
+        framer.makeSerializedFrames(&serialized, 2, rmqamqp::Message(msg));
+    }
+    bsl::weak_ptr<bsl::vector<uint8_t> > released(slab);
+    slab.reset();
+
+    ASSERT_THAT(serialized, SizeIs(3));
+    EXPECT_THAT(serialized[1]->segment(1).first, Eq(data));
+    EXPECT_FALSE(released.expired());
+
+    serialized.clear();
+    EXPECT_TRUE(released.expired());
+}
+
+TEST_F(ContentEncodeTests, InlinePayloadIsCopiedIntoItsFrame)
+{
+    const uint8_t data[] = {1, 2, 3, 4, 5};
+    const rmqamqp::Message theMessage(
+        rmqt::Message(data, sizeof(data), rmqt::Properties()));
+
+    framer.makeFrames(&frames, 2, theMessage);
+
+    bsl::vector<bsl::shared_ptr<rmqio::SerializedFrame> > serialized;
+    framer.makeSerializedFrames(&serialized, 2, theMessage);
+
+    // The message's inline storage may not outlive the frames
+    ASSERT_THAT(serialized, SizeIs(2));
+    EXPECT_THAT(serialized[1]->numSegments(), Eq(1));
+    EXPECT_TRUE(*serialized[1] == rmqio::SerializedFrame(frames[1]));
+}
+
+TEST_F(ContentEncodeTests, StreamedContentMatchesWholeMessage)
+{
+    // A header followed by body chunks frames the same as the whole message
+    const size_t messageBytes = 60;
+    bsl::shared_ptr<bsl::vector<uint8_t> > payload =
+        bsl::make_shared<bsl::vector<uint8_t> >(messageBytes);
+    for (size_t i = 0; i < messageBytes; ++i) {
+        (*payload)[i] = static_cast<uint8_t>(i);
+    }
+    const rmqt::Message msg(payload);
+    framer.makeFrames(&frames, 2, rmqamqp::Message(msg));
+
+    bsl::vector<rmqamqpt::Frame> streamed;
+    framer.makeFrames(
+        &streamed,
+        2,
+        rmqamqp::Message(rmqamqpt::ContentHeader(
+            rmqamqpt::Constants::BASIC,
+            messageBytes,
+            rmqamqpt::BasicProperties(msg.properties()))));
+    framer.makeFrames(&streamed,
+                      2,
+                      rmqamqp::Message(rmqamqpt::ContentBody(
+                          bsl::shared_ptr<const bsl::vector<uint8_t> >(
+                              payload))));
+
+    EXPECT_THAT(streamed, Eq(frames));
+}
+
+TEST_F(ContentEncodeTests, SerializedContentBodyReferencesChunk)
+{
+    const size_t chunkBytes = 60;
+    const size_t firstFrame =
+        MAX_FRAME_SIZE - rmqamqpt::Frame::frameOverhead();
+    const bsl::shared_ptr<const bsl::vector<uint8_t> > chunk =
+        bsl::make_shared<bsl::vector<uint8_t> >(chunkBytes);
+
+    bsl::vector<bsl::shared_ptr<rmqio::SerializedFrame> > serialized;
+    framer.makeSerializedFrames(
+        &serialized, 2, rmqamqp::Message(rmqamqpt::ContentBody(chunk)));
+
+    ASSERT_THAT(serialized, SizeIs(2));
+    EXPECT_THAT(serialized[0]->segment(1).first, Eq(chunk->data()));
+    EXPECT_THAT(serialized[0]->segment(1).second, Eq(firstFrame));
+    EXPECT_THAT(serialized[1]->segment(1).first,
+                Eq(chunk->data() + firstFrame));
+}
+
+TEST_F(ContentEncodeTests, RepeatedPropertiesEncodeAsWithoutTemplate)
+{
+    bsl::shared_ptr<rmqt::FieldTable> headers =
+        bsl::make_shared<rmqt::FieldTable>();
+    (*headers)["trace"] = rmqt::FieldValue(bsl::string("abc"));
+
+    const rmqt::Message first =
+        ContentDecodeTests::messageMaker("first", headers);
+    const rmqt::Message second =
+        ContentDecodeTests::messageMaker("second", headers);
+
+    framer.makeFrames(&frames, 2, rmqamqp::Message(first));
+    framer.makeFrames(&frames, 2, rmqamqp::Message(second));
+    ASSERT_THAT(frames, SizeIs(4));
+    EXPECT_THAT(frames[0],
+                Eq(rmqamqp::Framer::makeContentHeaderFrame(first, 2)));
+    EXPECT_THAT(frames[2],
+                Eq(rmqamqp::Framer::makeContentHeaderFrame(second, 2)));
+
+    // Modifying the table after publishing must not reuse a stale encoding
+    (*headers)["trace"] = rmqt::FieldValue(bsl::string("defgh"));
+    const rmqt::Message third =
+        ContentDecodeTests::messageMaker("third", headers);
+    const rmqt::Message fourth = ContentDecodeTests::messageMaker("fourth");
+
+    frames.clear();
+    framer.makeFrames(&frames, 2, rmqamqp::Message(third));
+    framer.makeFrames(&frames, 2, rmqamqp::Message(fourth));
+    ASSERT_THAT(frames, SizeIs(4));
+    EXPECT_THAT(frames[0],
+                Eq(rmqamqp::Framer::makeContentHeaderFrame(third, 2)));
+    EXPECT_THAT(frames[2],
+                Eq(rmqamqp::Framer::makeContentHeaderFrame(fourth, 2)));
+}
@@ -18,6 +18,8 @@
 #include <rmqtestutil_callcount.h>
 #include <rmqtestutil_mocktimerfactory.h>
 
+#include <bdlf_bind.h>
+
 #include <bsl_memory.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -39,6 +41,13 @@ class HeartbeatManager : public Test {
 
     bsl::shared_ptr<rmqtestutil::MockTimerFactory> d_timerFactory;
 
+    /// Time as stepped by the timer factory
+    rmqamqp::HeartbeatManagerImpl::Clock clock()
+    {
+        return bdlf::BindUtil::bind(&rmqtestutil::MockTimerFactory::now,
+                                    d_timerFactory);
+    }
+
     void tick(size_t seconds)
     {
         for (size_t i = 0; i < seconds; ++i) {
@@ -49,14 +58,14 @@ class HeartbeatManager : public Test {
 
 TEST_F(HeartbeatManager, Construct)
 {
-    rmqamqp::HeartbeatManagerImpl hbManager(d_timerFactory);
+    rmqamqp::HeartbeatManagerImpl hbManager(d_timerFactory, clock());
 }
 
 TEST_F(HeartbeatManager, HeartbeatSendTriggersFirst)
 {
     const uint32_t TIMEOUT_SEC = 4;
 
-    rmqamqp::HeartbeatManagerImpl hbManager(d_timerFactory);
+    rmqamqp::HeartbeatManagerImpl hbManager(d_timerFactory, clock());
     hbManager.start(TIMEOUT_SEC,
                     rmqtestutil::CallCount(&d_heartbeatCallCount),
                     rmqtestutil::CallCount(&d_connectionKilledCount));
@@ -72,7 +81,7 @@ TEST_F(HeartbeatManager, StopCancelsTimers)
 {
     const uint32_t TIMEOUT_SEC = 4;
 
-    rmqamqp::HeartbeatManagerImpl hbManager(d_timerFactory);
+    rmqamqp::HeartbeatManagerImpl hbManager(d_timerFactory, clock());
     hbManager.start(TIMEOUT_SEC,
                     rmqtestutil::CallCount(&d_heartbeatCallCount),
                     rmqtestutil::CallCount(&d_connectionKilledCount));
@@ -89,7 +98,7 @@ TEST_F(HeartbeatManager, DisconnectTriggersLateForFirstHeartbeat)
 {
     const uint32_t TIMEOUT_SEC = 4;
 
-    rmqamqp::HeartbeatManagerImpl hbManager(d_timerFactory);
+    rmqamqp::HeartbeatManagerImpl hbManager(d_timerFactory, clock());
     hbManager.start(TIMEOUT_SEC,
                     rmqtestutil::CallCount(&d_heartbeatCallCount),
                     rmqtestutil::CallCount(&d_connectionKilledCount));
@@ -109,7 +118,7 @@ TEST_F(HeartbeatManager, DisconnectTriggersAfterFirstHeartbeat)
 {
     const uint32_t TIMEOUT_SEC = 4;
 
-    rmqamqp::HeartbeatManagerImpl hbManager(d_timerFactory);
+    rmqamqp::HeartbeatManagerImpl hbManager(d_timerFactory, clock());
     hbManager.start(TIMEOUT_SEC,
                     rmqtestutil::CallCount(&d_heartbeatCallCount),
                     rmqtestutil::CallCount(&d_connectionKilledCount));
@@ -131,7 +140,7 @@ TEST_F(HeartbeatManager, NotifySendStopsSendHeartbeat)
 {
     const uint32_t TIMEOUT_SEC = 4;
 
-    rmqamqp::HeartbeatManagerImpl hbManager(d_timerFactory);
+    rmqamqp::HeartbeatManagerImpl hbManager(d_timerFactory, clock());
     // Trigger 3.7.11+ behaviour (disconnect after timeout*2)
     hbManager.start(TIMEOUT_SEC,
                     rmqtestutil::CallCount(&d_heartbeatCallCount),
@@ -161,7 +170,7 @@ TEST_F(HeartbeatManager, NotifyRecieveStopsDisconnect)
 {
     const uint32_t TIMEOUT_SEC = 4;
 
-    rmqamqp::HeartbeatManagerImpl hbManager(d_timerFactory);
+    rmqamqp::HeartbeatManagerImpl hbManager(d_timerFactory, clock());
     hbManager.start(TIMEOUT_SEC,
                     rmqtestutil::CallCount(&d_heartbeatCallCount),
                     rmqtestutil::CallCount(&d_connectionKilledCount));
@@ -181,3 +190,56 @@ TEST_F(HeartbeatManager, NotifyRecieveStopsDisconnect)
     EXPECT_THAT(d_heartbeatCallCount, Eq(3));
     EXPECT_THAT(d_connectionKilledCount, Eq(0));
 }
+
+TEST_F(HeartbeatManager, TrafficSuppressesHeartbeats)
+{
+    const uint32_t TIMEOUT_SEC = 60;
+
+    rmqamqp::HeartbeatManagerImpl hbManager(d_timerFactory, clock());
+    hbManager.start(TIMEOUT_SEC,
+                    rmqtestutil::CallCount(&d_heartbeatCallCount),
+                    rmqtestutil::CallCount(&d_connectionKilledCount));
+    hbManager.notifyHeartbeatReceived();
+
+    // Frames flowing both ways, several a second, for two minutes
+    for (int i = 0; i < 120; ++i) {
+        for (int j = 0; j < 10; ++j) {
+            hbManager.notifyMessageSent();
+            hbManager.notifyMessageReceived();
+        }
+        tick(1);
+    }
+
+    EXPECT_THAT(d_heartbeatCallCount, Eq(0));
+    EXPECT_THAT(d_connectionKilledCount, Eq(0));
+
+    // A heartbeat goes out half a timeout after the last frame sent, which
+    // was a second ago
+    tick(TIMEOUT_SEC / 2 - 2);
+    EXPECT_THAT(d_heartbeatCallCount, Eq(0));
+    tick(1);
+    EXPECT_THAT(d_heartbeatCallCount, Eq(1));
+}
+
+TEST_F(HeartbeatManager, PausedReadsSuspendDisconnect)
+{
+    const uint32_t TIMEOUT_SEC = 4;
+
+    rmqamqp::HeartbeatManagerImpl hbManager(d_timerFactory, clock());
+    hbManager.start(TIMEOUT_SEC,
+                    rmqtestutil::CallCount(&d_heartbeatCallCount),
+                    rmqtestutil::CallCount(&d_connectionKilledCount));
+    hbManager.notifyHeartbeatReceived();
+    hbManager.setReadsPaused(true);
+
+    tick(10);
+    EXPECT_THAT(d_heartbeatCallCount, Eq(5));
+    EXPECT_THAT(d_connectionKilledCount, Eq(0));
+
+    // The timeout restarts once reads resume
+    hbManager.setReadsPaused(false);
+    tick(4);
+    EXPECT_THAT(d_connectionKilledCount, Eq(0));
+    tick(1);
+    EXPECT_THAT(d_connectionKilledCount, Eq(1));
+}
@@ -0,0 +1,119 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqamqp_hostselector.h>
+
+#include <bsls_timeinterval.h>
+
+#include <bsl_cstddef.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqamqp;
+
+namespace {
+
+rmqt::Endpoint::HostList makeHosts()
+{
+    rmqt::Endpoint::HostList hosts;
+    hosts.push_back(rmqt::Endpoint::Host("host1", 5672));
+    hosts.push_back(rmqt::Endpoint::Host("host2", 5672));
+    hosts.push_back(rmqt::Endpoint::Host("host3", 5672));
+    return hosts;
+}
+
+} // namespace
+
+TEST(HostSelectorTests, RoundRobinVisitsEveryHost)
+{
+    const rmqt::Endpoint::HostList hosts = makeHosts();
+    HostSelector selector(rmqt::HostSelection::ROUND_ROBIN);
+
+    EXPECT_EQ(selector.select(hosts), 0u);
+    EXPECT_EQ(selector.select(hosts), 1u);
+    EXPECT_EQ(selector.select(hosts), 2u);
+    EXPECT_EQ(selector.select(hosts), 0u);
+}
+
+TEST(HostSelectorTests, SkipsFailedHostsDuringCooldown)
+{
+    const rmqt::Endpoint::HostList hosts = makeHosts();
+    HostSelector selector(rmqt::HostSelection::ROUND_ROBIN,
+                          bsls::TimeInterval(60));
+
+    selector.failed(hosts[1]);
+
+    EXPECT_EQ(selector.select(hosts), 0u);
+    EXPECT_EQ(selector.select(hosts), 2u);
+    EXPECT_EQ(selector.select(hosts), 0u);
+}
+
+TEST(HostSelectorTests, FallsBackToFailedHostsWhenAllFail)
+{
+    const rmqt::Endpoint::HostList hosts = makeHosts();
+    HostSelector selector(rmqt::HostSelection::ROUND_ROBIN,
+                          bsls::TimeInterval(60));
+
+    for (bsl::size_t i = 0; i < hosts.size(); ++i) {
+        selector.failed(hosts[i]);
+    }
+
+    EXPECT_LT(selector.select(hosts), hosts.size());
+}
+
+TEST(HostSelectorTests, ConnectingClearsFailure)
+{
+    const rmqt::Endpoint::HostList hosts = makeHosts();
+    HostSelector selector(rmqt::HostSelection::LEAST_CONNECTIONS,
+                          bsls::TimeInterval(60));
+
+    selector.failed(hosts[0]);
+    selector.connected(hosts[0], bsls::TimeInterval(0.1));
+    selector.disconnected(hosts[0]);
+
+    EXPECT_EQ(selector.select(hosts), 0u);
+}
+
+TEST(HostSelectorTests, LeastConnectionsPicksEmptiestHost)
+{
+    const rmqt::Endpoint::HostList hosts = makeHosts();
+    HostSelector selector(rmqt::HostSelection::LEAST_CONNECTIONS);
+
+    selector.connected(hosts[0], bsls::TimeInterval(0.1));
+    selector.connected(hosts[0], bsls::TimeInterval(0.1));
+    selector.connected(hosts[2], bsls::TimeInterval(0.1));
+
+    EXPECT_EQ(selector.select(hosts), 1u);
+
+    selector.connected(hosts[1], bsls::TimeInterval(0.1));
+    selector.connected(hosts[1], bsls::TimeInterval(0.1));
+
+    EXPECT_EQ(selector.select(hosts), 2u);
+}
+
+TEST(HostSelectorTests, LatencyWeightedPrefersFasterHost)
+{
+    const rmqt::Endpoint::HostList hosts = makeHosts();
+    HostSelector selector(rmqt::HostSelection::LATENCY_WEIGHTED);
+
+    selector.connected(hosts[0], bsls::TimeInterval(0.5));
+    selector.disconnected(hosts[0]);
+    selector.connected(hosts[1], bsls::TimeInterval(0.01));
+    selector.disconnected(hosts[1]);
+    selector.connected(hosts[2], bsls::TimeInterval(0.5));
+    selector.disconnected(hosts[2]);
+
+    EXPECT_EQ(selector.select(hosts), 1u);
+}
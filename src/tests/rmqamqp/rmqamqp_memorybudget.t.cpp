@@ -0,0 +1,92 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqamqp_memorybudget.h>
+
+#include <bdlf_bind.h>
+#include <bsls_timeinterval.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqamqp;
+using namespace ::testing;
+
+namespace {
+void count(int* calls) { ++*calls; }
+} // namespace
+
+TEST(MemoryBudget, ExhaustedOnceLimitReached)
+{
+    MemoryBudget budget(100);
+
+    budget.acquire(99);
+    EXPECT_FALSE(budget.exhausted());
+
+    budget.acquire(1);
+    EXPECT_TRUE(budget.exhausted());
+
+    // Deliveries are counted even over the limit
+    budget.acquire(50);
+    EXPECT_THAT(budget.used(), Eq(150));
+
+    budget.release(51);
+    EXPECT_FALSE(budget.exhausted());
+    EXPECT_THAT(budget.used(), Eq(99));
+}
+
+TEST(MemoryBudget, ReleaseNeverUnderflows)
+{
+    MemoryBudget budget(100);
+
+    budget.acquire(10);
+    budget.release(20);
+    EXPECT_THAT(budget.used(), Eq(0));
+}
+
+TEST(MemoryBudget, WaitForRoomTimesOut)
+{
+    MemoryBudget budget(10);
+
+    EXPECT_TRUE(budget.waitForRoom(bsls::TimeInterval(0.01)));
+
+    budget.acquire(10);
+    EXPECT_FALSE(budget.waitForRoom(bsls::TimeInterval(0.01)));
+}
+
+TEST(MemoryBudget, NotifiesOnceThereIsRoom)
+{
+    MemoryBudget budget(10);
+
+    int calls = 0;
+    budget.notifyWhenRoom(bdlf::BindUtil::bind(&count, &calls));
+    EXPECT_THAT(calls, Eq(1));
+
+    budget.acquire(20);
+    budget.notifyWhenRoom(bdlf::BindUtil::bind(&count, &calls));
+    EXPECT_THAT(calls, Eq(1));
+
+    budget.release(5);
+    EXPECT_THAT(calls, Eq(1));
+
+    budget.release(5);
+    EXPECT_THAT(calls, Eq(2));
+
+    // Only invoked once
+    budget.acquire(10);
+    budget.release(10);
+    EXPECT_THAT(calls, Eq(2));
+}
@@ -17,9 +17,11 @@
 
 #include <rmqt_message.h>
 
+#include <bdlf_bind.h>
 #include <bdlt_currenttime.h>
 #include <bdlt_epochutil.h>
 #include <bsl_iostream.h>
+#include <bsl_memory.h>
 
 #include <bsl_utility.h>
 #include <bsl_vector.h>
@@ -146,6 +148,13 @@ static bsls::TimeInterval s_time(0);
 
 static bsls::TimeInterval time() { return s_time; }
 
+static void collectTag(bsl::vector<uint64_t>* tags,
+                       uint64_t deliveryTag,
+                       const bsl::pair<rmqt::Message, bdlt::Datetime>&)
+{
+    tags->push_back(deliveryTag);
+}
+
 TEST(MessageStore, GetMessagesOlderThan)
 {
     bdlt::Datetime testTime = bdlt::CurrentTime::utc();
@@ -183,6 +192,38 @@ TEST(MessageStore, GetMessagesOlderThan)
     bdlt::CurrentTime::setCurrentTimeCallback(prev);
 }
 
+TEST(MessageStore, VisitMessagesOlderThanStopsAtFirstYoungMessage)
+{
+    bdlt::Datetime testTime = bdlt::CurrentTime::utc();
+    s_time                  = bsls::TimeInterval(
+        (testTime - bdlt::EpochUtil::epoch()).totalSecondsAsDouble());
+
+    bdlt::CurrentTime::CurrentTimeCallback prev =
+        bdlt::CurrentTime::setCurrentTimeCallback(time);
+
+    rmqamqp::MessageStore<rmqt::Message> msgStore;
+
+    // tags 1 and 2 at time 0, tag 3 at time 10
+    EXPECT_TRUE(msgStore.insert(1, rmqt::Message()));
+    EXPECT_TRUE(msgStore.insert(2, rmqt::Message()));
+    s_time += bsls::TimeInterval(10);
+    EXPECT_TRUE(msgStore.insert(3, rmqt::Message()));
+
+    testTime.addSeconds(9);
+
+    bsl::vector<uint64_t> tags;
+    EXPECT_THAT(msgStore.visitMessagesOlderThan(
+                    testTime,
+                    bdlf::BindUtil::bind(&collectTag,
+                                         &tags,
+                                         bdlf::PlaceHolders::_1,
+                                         bdlf::PlaceHolders::_2)),
+                Eq(2));
+    EXPECT_THAT(tags, ElementsAre(1, 2));
+
+    bdlt::CurrentTime::setCurrentTimeCallback(prev);
+}
+
 TEST(MessageStore, Swap)
 {
     rmqamqp::MessageStore<rmqt::Message> msgStore;
@@ -205,3 +246,34 @@ TEST(MessageStore, Swap)
     EXPECT_EQ(msgStore.count(), 0);
     EXPECT_EQ(msgStore2.count(), 1);
 }
+
+TEST(MessageStore, LookupByGuidBuildsIndexLazily)
+{
+    rmqamqp::MessageStore<rmqt::Message> msgStore;
+
+    rmqt::Message msg1(bsl::make_shared<bsl::vector<uint8_t> >(1, 'a'));
+    rmqt::Message msg2(bsl::make_shared<bsl::vector<uint8_t> >(1, 'b'));
+    rmqt::Message msg3(bsl::make_shared<bsl::vector<uint8_t> >(1, 'c'));
+
+    // Inserted and removed before the index exists
+    EXPECT_TRUE(msgStore.insert(1, msg1));
+    EXPECT_TRUE(msgStore.insert(2, msg2));
+    rmqt::Message removed;
+    bdlt::Datetime insertTime;
+    EXPECT_TRUE(msgStore.remove(1, &removed, &insertTime));
+
+    rmqt::Message msg;
+    uint64_t deliveryTag = 0;
+    EXPECT_FALSE(msgStore.lookup(msg1.guid(), &msg, &deliveryTag));
+    EXPECT_TRUE(msgStore.lookup(msg2.guid(), &msg, &deliveryTag));
+    EXPECT_EQ(deliveryTag, 2);
+
+    // Maintained once built
+    EXPECT_TRUE(msgStore.insert(3, msg3));
+    EXPECT_TRUE(msgStore.lookup(msg3.guid(), &msg, &deliveryTag));
+    EXPECT_EQ(deliveryTag, 3);
+
+    msgStore.removeUntil(3);
+    EXPECT_FALSE(msgStore.lookup(msg2.guid(), &msg, &deliveryTag));
+    EXPECT_FALSE(msgStore.lookup(msg3.guid(), &msg, &deliveryTag));
+}
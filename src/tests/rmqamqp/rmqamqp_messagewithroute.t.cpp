@@ -0,0 +1,71 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqamqp_messagewithroute.h>
+
+#include <rmqt_message.h>
+
+#include <bsl_cstdint.h>
+#include <bsl_memory.h>
+#include <bsl_string.h>
+#include <bsl_vector.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqamqp;
+using namespace ::testing;
+
+TEST(MessageWithRoute, HoldsTheMessageAndItsRoute)
+{
+    const rmqt::Message message(
+        bsl::make_shared<bsl::vector<bsl::uint8_t> >(10, 1));
+
+    const MessageWithRoute route(
+        message, "key", rmqt::Mandatory::DISCARD_UNROUTABLE);
+
+    EXPECT_THAT(route.message(), Eq(message));
+    EXPECT_THAT(route.guid(), Eq(message.guid()));
+    EXPECT_THAT(route.payloadSize(), Eq(10));
+    EXPECT_THAT(route.routingKey(), Eq("key"));
+    EXPECT_THAT(route.mandatory(), Eq(rmqt::Mandatory::DISCARD_UNROUTABLE));
+}
+
+TEST(MessageWithRoute, CopiesShareTheMessage)
+{
+    const MessageWithRoute route(
+        rmqt::Message(), "key", rmqt::Mandatory::RETURN_UNROUTABLE);
+
+    MessageWithRoute copy;
+    copy = route;
+
+    EXPECT_THAT(&copy.message(), Eq(&route.message()));
+    EXPECT_THAT(&copy.routingKey(), Eq(&route.routingKey()));
+}
+
+TEST(MessageWithRoute, RefersToASharedRoutingKey)
+{
+    const bsl::shared_ptr<const bsl::string> key =
+        bsl::make_shared<bsl::string>("key");
+
+    const MessageWithRoute first(
+        rmqt::Message(), key, rmqt::Mandatory::RETURN_UNROUTABLE);
+    const MessageWithRoute second(
+        rmqt::Message(), key, rmqt::Mandatory::RETURN_UNROUTABLE);
+
+    EXPECT_THAT(&first.routingKey(), Eq(key.get()));
+    EXPECT_THAT(&second.routingKey(), Eq(key.get()));
+}
@@ -0,0 +1,144 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqamqp_metricaggregator.h>
+
+#include <rmqtestutil_mockmetricpublisher.h>
+
+#include <bsl_memory.h>
+#include <bsl_string.h>
+#include <bsl_utility.h>
+#include <bsl_vector.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqamqp;
+using namespace ::testing;
+
+namespace {
+
+typedef StrictMock<rmqtestutil::MockMetricPublisher> MockPublisher;
+
+MetricAggregator::Tags vhostTags()
+{
+    return MetricAggregator::Tags(
+        1, bsl::make_pair(bsl::string("vhost"), bsl::string("test")));
+}
+
+class MetricAggregatorTests : public Test {
+  public:
+    MetricAggregatorTests()
+    : d_publisher(bsl::make_shared<MockPublisher>())
+    , d_aggregator(bsl::make_shared<MetricAggregator>(d_publisher))
+    {
+    }
+
+    bsl::shared_ptr<MockPublisher> d_publisher;
+    bsl::shared_ptr<MetricAggregator> d_aggregator;
+};
+
+} // namespace
+
+TEST_F(MetricAggregatorTests, CountersAccumulateUntilFlushed)
+{
+    MetricAggregator::Counter counter =
+        MetricAggregator::counter(d_aggregator, "sent", vhostTags());
+
+    counter.add(1);
+    counter.add(2);
+
+    EXPECT_CALL(*d_publisher, publishCounter("sent", 3, vhostTags()));
+    d_aggregator->flush();
+
+    // Nothing new to publish
+    d_aggregator->flush();
+}
+
+TEST_F(MetricAggregatorTests, RegistrationsWithTheSameTagsShareAMetric)
+{
+    MetricAggregator::Counter first =
+        MetricAggregator::counter(d_aggregator, "sent", vhostTags());
+    MetricAggregator::Counter second =
+        MetricAggregator::counter(d_aggregator, "sent", vhostTags());
+
+    first.add(1);
+    second.add(1);
+
+    EXPECT_CALL(*d_publisher, publishCounter("sent", 2, vhostTags()));
+    d_aggregator->flush();
+}
+
+TEST_F(MetricAggregatorTests, DistributionsAreFlushedAsBuckets)
+{
+    MetricAggregator::Distribution latency =
+        MetricAggregator::distribution(d_aggregator, "latency", vhostTags());
+
+    latency.record(0.001);
+    latency.record(0.001);
+    latency.record(2.0);
+
+    EXPECT_CALL(*d_publisher,
+                publishDistributionSamples(
+                    "latency", DoubleNear(0.001, 0.001 / 16), 2, vhostTags()));
+    EXPECT_CALL(*d_publisher,
+                publishDistributionSamples(
+                    "latency", DoubleNear(2.0, 2.0 / 16), 1, vhostTags()));
+    d_aggregator->flush();
+}
+
+TEST_F(MetricAggregatorTests, OtherMetricsPassStraightThrough)
+{
+    EXPECT_CALL(*d_publisher, publishGauge("prefetch", 10, vhostTags()));
+    d_aggregator->publishGauge("prefetch", 10, vhostTags());
+}
+
+TEST_F(MetricAggregatorTests, UpdatesAreNotLostWhenHandlesAreDestroyed)
+{
+    MetricAggregator::counter(d_aggregator, "sent", vhostTags()).add(5);
+
+    EXPECT_CALL(*d_publisher, publishCounter("sent", 5, vhostTags()));
+    d_aggregator->flush();
+
+    // The metric is forgotten once flushed, no handles remain
+    d_aggregator->flush();
+}
+
+TEST(MetricAggregator, HandlesPublishDirectlyWithoutAnAggregator)
+{
+    bsl::shared_ptr<MockPublisher> publisher =
+        bsl::make_shared<MockPublisher>();
+
+    MetricAggregator::Counter counter =
+        MetricAggregator::counter(publisher, "sent", vhostTags());
+    MetricAggregator::Distribution latency =
+        MetricAggregator::distribution(publisher, "latency", vhostTags());
+
+    EXPECT_CALL(*publisher, publishCounter("sent", 1, vhostTags()));
+    counter.add(1);
+
+    EXPECT_CALL(*publisher, publishDistribution("latency", 0.5, vhostTags()));
+    latency.record(0.5);
+}
+
+TEST(MetricAggregator, NullHandlesDropUpdates)
+{
+    MetricAggregator::Counter().add(1);
+    MetricAggregator::Distribution().record(1);
+    MetricAggregator::counter(
+        bsl::shared_ptr<rmqp::MetricPublisher>(), "sent", vhostTags())
+        .add(1);
+}
@@ -189,3 +189,207 @@ TEST_F(MultipleAckHandlerTests, DifferentTypes)
     expectAck(6, false);
     process();
 }
+
+TEST_F(MultipleAckHandlerTests, CoalescedAcksWaitForFlush)
+{
+    d_handler.setCoalescing(0);
+
+    ack(2);
+    ack(1);
+    process();
+    ack(3);
+    process();
+    EXPECT_THAT(d_handler.heldAcks(), Eq(3));
+
+    expectAck(3, true);
+    d_handler.flush();
+    EXPECT_THAT(d_handler.heldAcks(), Eq(0));
+}
+
+TEST_F(MultipleAckHandlerTests, CoalescedAcksFlushAtMaxHeld)
+{
+    d_handler.setCoalescing(4);
+
+    ack(1);
+    ack(2);
+    ack(3);
+    process();
+
+    ack(4);
+    expectAck(4, true);
+    process();
+}
+
+TEST_F(MultipleAckHandlerTests, CoalescedNacksSentImmediately)
+{
+    d_handler.setCoalescing(0);
+
+    ack(1);
+    nack(2, true);
+    ack(3);
+    expectNack(2, true, false);
+    process();
+
+    // The multi-ack covers the already-nacked tag
+    expectAck(3, true);
+    d_handler.flush();
+}
+
+TEST_F(MultipleAckHandlerTests, CoalescedNackRunSentAsMultiNack)
+{
+    d_handler.setCoalescing(0);
+
+    nack(1, true);
+    nack(2, true);
+    nack(3, true);
+    nack(4, false);
+    expectNack(3, true, true);
+    expectNack(4, false, false);
+    process();
+
+    nack(5, false);
+    nack(6, false);
+    expectNack(6, false, true);
+    process();
+}
+
+TEST_F(MultipleAckHandlerTests, CoalescedNackRunWaitsForHeldAcks)
+{
+    d_handler.setCoalescing(0);
+
+    // A multi-nack would also nack the held ack
+    ack(1);
+    nack(2, true);
+    nack(3, true);
+    expectNack(2, true, false);
+    expectNack(3, true, false);
+    process();
+
+    expectAck(3, true);
+    d_handler.flush();
+}
+
+TEST_F(MultipleAckHandlerTests, NackThroughIgnoresLaterAcks)
+{
+    ack(1);
+    ack(2);
+    expectAck(2, true);
+    process();
+
+    expectNack(5, true, true);
+    d_handler.nackThrough(5, true);
+
+    ack(4);
+    process();
+
+    ack(6);
+    expectAck(6, false);
+    process();
+}
+
+TEST_F(MultipleAckHandlerTests, CoalescedAcksBeyondGapSentIndividually)
+{
+    d_handler.setCoalescing(0);
+
+    ack(1);
+    ack(2);
+    ack(4);
+    ack(70);
+    process();
+
+    expectAck(2, true);
+    expectAck(4, false);
+    expectAck(70, false);
+    d_handler.flush();
+
+    // Filling the gap only needs the tags not yet sent
+    for (uint64_t tag = 3; tag < 70; ++tag) {
+        if (tag != 4) {
+            ack(tag);
+        }
+    }
+    ack(71);
+    process();
+
+    expectAck(71, true);
+    d_handler.flush();
+}
+
+TEST_F(MultipleAckHandlerTests, CoalescedRepeatedAckIgnored)
+{
+    d_handler.setCoalescing(0);
+
+    ack(1);
+    process();
+    expectAck(1, false);
+    d_handler.flush();
+
+    ack(1);
+    process();
+    EXPECT_THAT(d_handler.heldAcks(), Eq(0));
+    d_handler.flush();
+}
+
+TEST_F(MultipleAckHandlerTests, AckThroughIgnoresLaterAcks)
+{
+    ack(1);
+    expectAck(1, false);
+    process();
+
+    expectAck(5, true);
+    d_handler.ackThrough(5);
+
+    ack(3);
+    process();
+
+    ack(6);
+    expectAck(6, false);
+    process();
+}
+
+TEST_F(MultipleAckHandlerTests, AckThroughEndsOnOutstandingTag)
+{
+    ack(2);
+    ack(3);
+    expectAck(2, false);
+    expectAck(3, false);
+    process();
+
+    // Only tag 1 is outstanding, 3 is already settled at the broker
+    expectAck(1, false);
+    d_handler.ackThrough(3);
+
+    ack(4);
+    expectAck(4, false);
+    process();
+}
+
+TEST_F(MultipleAckHandlerTests, AckThroughNothingOutstanding)
+{
+    ack(1);
+    ack(2);
+    expectAck(2, true);
+    process();
+
+    EXPECT_CALL(d_cb, ack(_, _)).Times(0);
+    d_handler.ackThrough(2);
+}
+
+TEST_F(MultipleAckHandlerTests, CoalescedAckThroughSendsHeldAcksFirst)
+{
+    d_handler.setCoalescing(0);
+
+    ack(1);
+    ack(4);
+    process();
+
+    expectAck(1, false);
+    expectAck(4, false);
+    expectAck(3, true);
+    d_handler.ackThrough(3);
+
+    ack(5);
+    process();
+    expectAck(5, false);
+    d_handler.flush();
+}
@@ -0,0 +1,106 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqamqp_pipelinetiming.h>
+
+#include <rmqamqp_metrics.h>
+#include <rmqio_pipelineclock.h>
+
+#include <rmqtestutil_mockmetricpublisher.h>
+
+#include <bsl_memory.h>
+#include <bsl_string.h>
+#include <bsl_utility.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqamqp;
+using namespace ::testing;
+
+namespace {
+
+typedef StrictMock<rmqtestutil::MockMetricPublisher> MockPublisher;
+
+PipelineTiming::Tags vhostTags()
+{
+    return PipelineTiming::Tags(
+        1, bsl::make_pair(bsl::string("vhost"), bsl::string("test")));
+}
+
+PipelineTiming::Tags stageTags(const char* stage)
+{
+    PipelineTiming::Tags tags = vhostTags();
+    tags.push_back(bsl::make_pair(bsl::string(Metrics::PIPELINESTAGE_TAG),
+                                  bsl::string(stage)));
+    return tags;
+}
+
+class PipelineTimingTests : public Test {
+  public:
+    PipelineTimingTests()
+    : d_publisher(bsl::make_shared<MockPublisher>())
+    {
+    }
+
+    ~PipelineTimingTests() { rmqio::PipelineClock::setEnabled(false); }
+
+    bsl::shared_ptr<MockPublisher> d_publisher;
+};
+
+} // namespace
+
+TEST_F(PipelineTimingTests, RecordsNothingWhenDisabled)
+{
+    PipelineTiming timing(d_publisher, vhostTags());
+
+    timing.record(PipelineStage::DECODE, 1000, 2000);
+    timing.record(PipelineStage::CALLBACK, rmqio::PipelineClock::now());
+}
+
+TEST_F(PipelineTimingTests, RecordsStageDuration)
+{
+    rmqio::PipelineClock::setEnabled(true);
+    PipelineTiming timing(d_publisher, vhostTags());
+
+    EXPECT_CALL(*d_publisher,
+                publishDistribution(
+                    "pipeline_stage", DoubleEq(1.5e-6), stageTags("decode")));
+    timing.record(PipelineStage::DECODE, 1000, 2500);
+
+    EXPECT_CALL(*d_publisher,
+                publishDistribution(
+                    "pipeline_stage", Ge(0), stageTags("send_queue")));
+    timing.record(PipelineStage::SEND_QUEUE, rmqio::PipelineClock::now());
+}
+
+TEST_F(PipelineTimingTests, SkipsStagesWithoutAStart)
+{
+    rmqio::PipelineClock::setEnabled(true);
+    PipelineTiming timing(d_publisher, vhostTags());
+
+    timing.record(PipelineStage::WRITE, 0);
+    timing.record(PipelineStage::WRITE, 0, rmqio::PipelineClock::now());
+}
+
+TEST(PipelineStage, NamesEveryStage)
+{
+    for (int stage = 0; stage < PipelineStage::NUM_STAGES; ++stage) {
+        EXPECT_THAT(
+            PipelineStage::toString(static_cast<PipelineStage::Value>(stage)),
+            StrNe("unknown"));
+    }
+}
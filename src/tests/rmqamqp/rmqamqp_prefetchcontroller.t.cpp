@@ -0,0 +1,105 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <rmqamqp_prefetchcontroller.h>
+
+#include <bsl_optional.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqamqp;
+using namespace ::testing;
+
+namespace {
+void ackMany(PrefetchController& controller, double latencySeconds)
+{
+    for (int i = 0; i < 100; ++i) {
+        controller.onAck(latencySeconds);
+    }
+}
+} // namespace
+
+TEST(PrefetchController, InitialPrefetchClampedToBounds)
+{
+    EXPECT_THAT(PrefetchController(5, 10, 100).prefetch(), Eq(10));
+    EXPECT_THAT(PrefetchController(500, 10, 100).prefetch(), Eq(100));
+    EXPECT_THAT(PrefetchController(50, 10, 100).prefetch(), Eq(50));
+}
+
+TEST(PrefetchController, GrowsWhenMessagesDoNotWait)
+{
+    PrefetchController controller(100, 10, 1000);
+
+    // 10ms callbacks, messages handled 10.1ms after delivery
+    ackMany(controller, 0.0101);
+    EXPECT_THAT(controller.evaluate(0.01), Optional(Eq(150)));
+}
+
+TEST(PrefetchController, ShrinksWhenMessagesWaitLong)
+{
+    PrefetchController controller(100, 10, 1000);
+
+    // 10ms callbacks, messages handled a second after delivery
+    ackMany(controller, 1);
+    EXPECT_THAT(controller.evaluate(0.01), Optional(Eq(75)));
+}
+
+TEST(PrefetchController, HoldsInBetween)
+{
+    PrefetchController controller(100, 10, 1000);
+
+    // Messages wait two callbacks' worth
+    ackMany(controller, 0.03);
+    EXPECT_FALSE(controller.evaluate(0.01));
+    EXPECT_THAT(controller.prefetch(), Eq(100));
+}
+
+TEST(PrefetchController, StaysWithinBounds)
+{
+    PrefetchController controller(100, 90, 120);
+
+    ackMany(controller, 0.0101);
+    EXPECT_THAT(controller.evaluate(0.01), Optional(Eq(120)));
+    ackMany(controller, 0.0101);
+    EXPECT_FALSE(controller.evaluate(0.01));
+
+    ackMany(controller, 1);
+    EXPECT_THAT(controller.evaluate(0.01), Optional(Eq(90)));
+    ackMany(controller, 1);
+    EXPECT_FALSE(controller.evaluate(0.01));
+}
+
+TEST(PrefetchController, IgnoresQuietWindows)
+{
+    PrefetchController controller(100, 10, 1000);
+
+    controller.onAck(0.0101);
+    EXPECT_FALSE(controller.evaluate(0.01));
+}
+
+TEST(PrefetchController, DropsToMinimumWhileSaturated)
+{
+    PrefetchController controller(100, 10, 1000);
+
+    // However quickly messages are handled, and with no acks at all
+    ackMany(controller, 0.0101);
+    EXPECT_THAT(controller.evaluate(0.01, true), Optional(Eq(10)));
+    EXPECT_FALSE(controller.evaluate(0.01, true));
+
+    ackMany(controller, 0.0101);
+    EXPECT_THAT(controller.evaluate(0.01), Optional(Eq(15)));
+}
@@ -0,0 +1,74 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqamqp_publishgate.h>
+
+#include <bdlf_bind.h>
+#include <bsls_timeinterval.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqamqp;
+using namespace ::testing;
+
+namespace {
+void count(int* calls) { ++*calls; }
+} // namespace
+
+TEST(PublishGate, ClosedUntilOpened)
+{
+    PublishGate gate;
+    EXPECT_FALSE(gate.isClosed());
+
+    gate.close("low on memory");
+    EXPECT_TRUE(gate.isClosed());
+    EXPECT_THAT(gate.reason(), Eq("low on memory"));
+
+    gate.open();
+    EXPECT_FALSE(gate.isClosed());
+}
+
+TEST(PublishGate, WaitUntilOpenTimesOut)
+{
+    PublishGate gate;
+
+    EXPECT_TRUE(gate.waitUntilOpen(bsls::TimeInterval(0.01)));
+
+    gate.close("low on disk");
+    EXPECT_FALSE(gate.waitUntilOpen(bsls::TimeInterval(0.01)));
+}
+
+TEST(PublishGate, NotifiesOnceOpen)
+{
+    PublishGate gate;
+
+    int calls = 0;
+    gate.notifyWhenOpen(bdlf::BindUtil::bind(&count, &calls));
+    EXPECT_THAT(calls, Eq(1));
+
+    gate.close("low on memory");
+    gate.notifyWhenOpen(bdlf::BindUtil::bind(&count, &calls));
+    EXPECT_THAT(calls, Eq(1));
+
+    gate.open();
+    EXPECT_THAT(calls, Eq(2));
+
+    // Only invoked once
+    gate.close("low on memory");
+    gate.open();
+    EXPECT_THAT(calls, Eq(2));
+}
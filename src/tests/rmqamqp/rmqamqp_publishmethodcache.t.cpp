@@ -0,0 +1,89 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqamqp_publishmethodcache.h>
+
+#include <rmqamqpt_basicmethod.h>
+#include <rmqamqpt_basicpublish.h>
+#include <rmqamqpt_encodedmethod.h>
+#include <rmqamqpt_method.h>
+#include <rmqt_properties.h>
+
+#include <bsl_string.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqamqp;
+using namespace ::testing;
+
+namespace {
+const rmqt::Mandatory::Value DISCARD = rmqt::Mandatory::DISCARD_UNROUTABLE;
+const rmqt::Mandatory::Value RETURN  = rmqt::Mandatory::RETURN_UNROUTABLE;
+} // namespace
+
+TEST(PublishMethodCache, EncodesBasicPublish)
+{
+    PublishMethodCache cache("exchange");
+
+    const rmqamqpt::EncodedMethod expected(
+        rmqamqpt::Method(rmqamqpt::BasicMethod(
+            rmqamqpt::BasicPublish("exchange", "key", true, false))));
+
+    EXPECT_THAT(cache.get("key", RETURN).data(), Eq(expected.data()));
+}
+
+TEST(PublishMethodCache, ReusesEncodingForSameRoute)
+{
+    PublishMethodCache cache("exchange");
+
+    const rmqamqpt::EncodedMethod first = cache.get("key", DISCARD);
+    EXPECT_THAT(cache.get("key", DISCARD).buffer(), Eq(first.buffer()));
+    EXPECT_THAT(cache.size(), Eq(1));
+}
+
+TEST(PublishMethodCache, DistinguishesRoutingKeyAndMandatory)
+{
+    PublishMethodCache cache("exchange");
+
+    const rmqamqpt::EncodedMethod discard = cache.get("key", DISCARD);
+    const rmqamqpt::EncodedMethod ret     = cache.get("key", RETURN);
+    const rmqamqpt::EncodedMethod other   = cache.get("other", DISCARD);
+
+    EXPECT_THAT(ret.data(), Ne(discard.data()));
+    EXPECT_THAT(other.data(), Ne(discard.data()));
+    EXPECT_THAT(cache.size(), Eq(3));
+}
+
+TEST(PublishMethodCache, EvictsLeastRecentlyUsed)
+{
+    PublishMethodCache cache("exchange", 2);
+
+    // Copies keep the encodings alive, so a re-encoding cannot share their
+    // address
+    const rmqamqpt::EncodedMethod a = cache.get("a", DISCARD);
+    const rmqamqpt::EncodedMethod b = cache.get("b", DISCARD);
+
+    // Using `a` makes `b` the least recently used
+    EXPECT_THAT(cache.get("a", DISCARD).buffer(), Eq(a.buffer()));
+    cache.get("c", DISCARD);
+    EXPECT_THAT(cache.size(), Eq(2));
+
+    EXPECT_THAT(cache.get("a", DISCARD).buffer(), Eq(a.buffer()));
+    EXPECT_THAT(cache.get("b", DISCARD).buffer(), Ne(b.buffer()));
+    EXPECT_THAT(cache.get("b", DISCARD).data(), Eq(b.data()));
+    EXPECT_THAT(cache.size(), Eq(2));
+}
@@ -0,0 +1,117 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqamqp_ratelimiter.h>
+
+#include <rmqt_ratelimit.h>
+
+#include <bsls_timeinterval.h>
+
+#include <bsl_memory.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqamqp;
+
+namespace {
+
+// Slow enough that no token comes back during a test
+const double k_SLOW_RATE = 0.001;
+
+} // namespace
+
+TEST(RateLimiterTests, UnlimitedNeverWaits)
+{
+    RateLimiter limiter((rmqt::RateLimit()));
+
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(limiter.tryAcquire(1000), bsls::TimeInterval());
+    }
+    EXPECT_EQ(limiter.delay(1000), bsls::TimeInterval());
+}
+
+TEST(RateLimiterTests, MessageBurstThenWait)
+{
+    RateLimiter limiter(rmqt::RateLimit().setMessageRate(k_SLOW_RATE, 3));
+
+    EXPECT_EQ(limiter.available(), 3u);
+    EXPECT_EQ(limiter.tryAcquire(10), bsls::TimeInterval());
+    EXPECT_EQ(limiter.tryAcquire(10), bsls::TimeInterval());
+    EXPECT_EQ(limiter.tryAcquire(10), bsls::TimeInterval());
+
+    EXPECT_EQ(limiter.available(), 0u);
+    EXPECT_GT(limiter.tryAcquire(10), bsls::TimeInterval());
+    EXPECT_GT(limiter.delay(1), bsls::TimeInterval());
+    EXPECT_FALSE(limiter.acquire(10, bsls::TimeInterval(0.01)));
+}
+
+TEST(RateLimiterTests, ByteBurstThenWait)
+{
+    RateLimiter limiter(rmqt::RateLimit().setByteRate(k_SLOW_RATE, 100));
+
+    EXPECT_EQ(limiter.tryAcquire(60), bsls::TimeInterval());
+    EXPECT_GT(limiter.tryAcquire(60), bsls::TimeInterval());
+    EXPECT_EQ(limiter.tryAcquire(40), bsls::TimeInterval());
+    EXPECT_EQ(limiter.available(), 0u);
+}
+
+TEST(RateLimiterTests, OversizedMessageTakesWholeBurst)
+{
+    RateLimiter limiter(rmqt::RateLimit().setByteRate(k_SLOW_RATE, 100));
+
+    EXPECT_EQ(limiter.tryAcquire(1000), bsls::TimeInterval());
+    EXPECT_GT(limiter.tryAcquire(1), bsls::TimeInterval());
+}
+
+TEST(RateLimiterTests, ReleaseGivesTokensBack)
+{
+    RateLimiter limiter(rmqt::RateLimit().setMessageRate(k_SLOW_RATE, 1));
+
+    EXPECT_EQ(limiter.tryAcquire(0), bsls::TimeInterval());
+    EXPECT_GT(limiter.tryAcquire(0), bsls::TimeInterval());
+
+    limiter.release(0);
+
+    EXPECT_EQ(limiter.tryAcquire(0), bsls::TimeInterval());
+}
+
+TEST(RateLimiterTests, ParentLimitsChildren)
+{
+    bsl::shared_ptr<RateLimiter> parent = bsl::make_shared<RateLimiter>(
+        rmqt::RateLimit().setMessageRate(k_SLOW_RATE, 2));
+    RateLimiter first(rmqt::RateLimit().setMessageRate(k_SLOW_RATE, 2),
+                      parent);
+    RateLimiter second(rmqt::RateLimit().setMessageRate(k_SLOW_RATE, 2),
+                       parent);
+
+    EXPECT_EQ(first.tryAcquire(0), bsls::TimeInterval());
+    EXPECT_EQ(second.tryAcquire(0), bsls::TimeInterval());
+
+    EXPECT_EQ(first.available(), 0u);
+    EXPECT_GT(first.tryAcquire(0), bsls::TimeInterval());
+    EXPECT_GT(second.tryAcquire(0), bsls::TimeInterval());
+
+    // The refused sends took nothing from the children
+    parent->release(0);
+    EXPECT_EQ(first.tryAcquire(0), bsls::TimeInterval());
+}
+
+TEST(RateLimiterTests, AcquireWaitsForTokens)
+{
+    RateLimiter limiter(rmqt::RateLimit().setMessageRate(100, 1));
+
+    EXPECT_TRUE(limiter.acquire(0, bsls::TimeInterval(1)));
+    EXPECT_TRUE(limiter.acquire(0, bsls::TimeInterval(1)));
+}
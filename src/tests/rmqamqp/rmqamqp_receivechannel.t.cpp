@@ -17,6 +17,7 @@
 
 #include <rmqamqp_channeltests.t.h>
 #include <rmqamqp_framer.h>
+#include <rmqamqp_memorybudget.h>
 #include <rmqamqp_metrics.h>
 
 #include <rmqamqpt_basicconsumeok.h>
@@ -26,15 +27,18 @@
 #include <rmqamqpt_method.h>
 #include <rmqio_retryhandler.h>
 #include <rmqt_consumerack.h>
-#include <rmqt_consumerackbatch.h>
+#include <rmqt_consumerackqueue.h>
 #include <rmqt_consumerconfig.h>
 #include <rmqt_envelope.h>
 #include <rmqt_fieldvalue.h>
 #include <rmqt_message.h>
+#include <rmqt_streamoffset.h>
 #include <rmqt_topology.h>
 #include <rmqtestutil_mockmetricpublisher.h>
 
 #include <bdlf_bind.h>
+#include <bdlt_currenttime.h>
+#include <bdlt_datetimeinterval.h>
 
 #include <bsl_functional.h>
 #include <bsl_memory.h>
@@ -55,6 +59,11 @@ const char* TEST_VHOST = "vhostname";
 
 void noopHungTimerCallback(rmqio::Timer::InterruptReason) {}
 
+bool notDeliveryTag3(const MessageStore<rmqt::Message>::Entry& entry)
+{
+    return entry.first != 3;
+}
+
 template <typename MethodClassT, typename MethodTypeT>
 const MethodTypeT& MethodGetter(const bsl::shared_ptr<rmqamqp::Message>& msg)
 {
@@ -89,6 +98,20 @@ MATCHER_P(EXPECT_QOSPREFETCH_IS, pf, "Prefetch isn't " + PrintToString(pf))
     }
 }
 
+MATCHER_P(EXPECT_GLOBAL_QOSPREFETCH_IS,
+          pf,
+          "Global prefetch isn't " + PrintToString(pf))
+{
+    try {
+        const rmqamqpt::BasicQoS& qos =
+            MethodGetter<rmqamqpt::BasicMethod, rmqamqpt::BasicQoS>(arg);
+        return qos.global() && qos.prefetchCount() == pf;
+    }
+    catch (...) {
+        return false;
+    }
+}
+
 MATCHER_P(EXPECT_CONSUME_IS,
           consume,
           "Consume Isn't: " + PrintToString(consume))
@@ -115,6 +138,19 @@ MATCHER_P(EXPECT_CANCEL_IS, cancel, "Cancel Isn't: " + PrintToString(cancel))
 
 using namespace bdlf::PlaceHolders;
 
+void recordConsumerTag(bsl::vector<bsl::string>* tags,
+                       const rmqt::Envelope& envelope)
+{
+    tags->push_back(envelope.consumerTag());
+}
+
+void recordStreamOffset(bsl::vector<uint64_t>* offsets,
+                        const rmqt::Envelope& envelope)
+{
+    ASSERT_TRUE(envelope.streamOffset());
+    offsets->push_back(envelope.streamOffset().value());
+}
+
 class ReceiveChannelTests : public rmqamqp::ChannelTests {
   public:
     StrictMock<rmqamqp::ReceiveChannel::MessageCallback> d_onNewMessage;
@@ -140,10 +176,7 @@ class ReceiveChannelTests : public rmqamqp::ChannelTests {
                           const rmqt::Envelope& id,
                           rmqt::ConsumerAck::Type type)
     {
-        bsl::shared_ptr<rmqt::ConsumerAckBatch> batch =
-            bsl::make_shared<rmqt::ConsumerAckBatch>();
-        batch->addAck(rmqt::ConsumerAck(id, type));
-        d_ackQueue->pushBack(batch);
+        d_ackQueue->push(rmqt::ConsumerAck(id, type));
         rc.consumeAckBatchFromQueue();
     }
 
@@ -266,6 +299,12 @@ class ReceiveChannelTests : public rmqamqp::ChannelTests {
             rmqt::ConsumerConfig::generateConsumerTag(), prefetchCount);
         consumerConfig.setConsumerPriority(consumerPriority);
 
+        return makeReceiveChannel(consumerConfig);
+    }
+
+    bsl::shared_ptr<ReceiveChannel>
+    makeReceiveChannel(const rmqt::ConsumerConfig& consumerConfig)
+    {
         return bsl::make_shared<ReceiveChannel>(
             d_topology,
             d_onAsyncWrite,
@@ -308,6 +347,48 @@ TEST_F(ReceiveChannelTests, SetsQoSAfterTopologyLoaded)
     EXPECT_THAT(receiveChannel->state(), Eq(rmqamqp::Channel::READY));
 }
 
+TEST_F(ReceiveChannelTests, PipelinedOpenStartsConsumerWithoutWaiting)
+{
+    bsl::shared_ptr<ReceiveChannel> receiveChannel = makeReceiveChannel();
+    receiveChannel->setPipelinedOpen(true);
+    setupConsumerNoReply(*receiveChannel);
+
+    {
+        // Everything up to basic.consume is written before any reply
+        InSequence seq;
+        channelOpenExpectation();
+        EXPECT_CALL(
+            d_callback,
+            onAsyncWrite(Pointee(MethodMsgTypeEq(rmqamqpt::Method(
+                             rmqamqpt::QueueMethod(rmqamqpt::QueueDeclare())))),
+                         _))
+            .WillOnce(InvokeArgument<1>());
+        qosExpectations();
+        EXPECT_CALL(
+            d_callback,
+            onAsyncWrite(Pointee(MethodMsgTypeEq(rmqamqpt::Method(
+                             rmqamqpt::BasicMethod(rmqamqpt::BasicConsume())))),
+                         _))
+            .WillOnce(InvokeArgument<1>());
+    }
+    receiveChannel->open();
+
+    // The replies only advance the channel
+    EXPECT_CALL(d_callback, onAsyncWrite(_, _)).Times(0);
+
+    openOkReply(*receiveChannel);
+    EXPECT_THAT(receiveChannel->state(),
+                Eq(rmqamqp::Channel::DECLARING_TOPOLOGY));
+    queueDeclareReply(*receiveChannel);
+    EXPECT_THAT(receiveChannel->state(),
+                Eq(rmqamqp::Channel::AWAITING_REPLY));
+    qosOkReply(*receiveChannel);
+    EXPECT_THAT(receiveChannel->state(),
+                Eq(rmqamqp::Channel::AWAITING_REPLY));
+    consumerReply(*receiveChannel);
+    EXPECT_THAT(receiveChannel->state(), Eq(rmqamqp::Channel::READY));
+}
+
 TEST_F(ReceiveChannelTests, Consume)
 {
     int64_t consumerPriority = 5;
@@ -539,6 +620,263 @@ TEST_F(ReceiveChannelTests, AckMessage)
     EXPECT_THAT(receiveChannel->inFlight(), Eq(0));
 }
 
+TEST_F(ReceiveChannelTests, CoalescedAcksSentOnTimer)
+{
+    rmqt::ConsumerConfig consumerConfig(
+        rmqt::ConsumerConfig::generateConsumerTag(), 10);
+    consumerConfig.setAckCoalescingDelay(bsls::TimeInterval(1));
+
+    bsl::shared_ptr<ReceiveChannel> receiveChannel =
+        bsl::make_shared<ReceiveChannel>(
+            d_topology,
+            d_onAsyncWrite,
+            d_retryHandler,
+            d_metricPublisher,
+            consumerConfig,
+            TEST_VHOST,
+            d_ackQueue,
+            d_timerFactory->createWithCallback(&noopHungTimerCallback),
+            d_connErrorCb);
+    receiveChannel->enableAckCoalescing(*d_timerFactory);
+
+    makeReady(*receiveChannel);
+    setupConsumer(*receiveChannel, "consumer1");
+
+    for (uint64_t deliveryTag = 1; deliveryTag <= 2; ++deliveryTag) {
+        receiveMessage(*receiveChannel, deliveryTag, "consumer1");
+    }
+    for (uint64_t deliveryTag = 1; deliveryTag <= 2; ++deliveryTag) {
+        ackMessage(*receiveChannel,
+                   rmqt::Envelope(deliveryTag,
+                                  receiveChannel->lifetimeId(),
+                                  "consumer1",
+                                  "exchange",
+                                  "routing-key",
+                                  false));
+    }
+
+    // Held until the coalescing delay passes
+    EXPECT_THAT(receiveChannel->inFlight(), Eq(2));
+
+    ackExpectations(2, true);
+    d_timerFactory->step_time(bsls::TimeInterval(1));
+    EXPECT_THAT(receiveChannel->inFlight(), Eq(0));
+}
+
+TEST_F(ReceiveChannelTests, ExhaustedMemoryBudgetDropsPrefetch)
+{
+    bsl::shared_ptr<ReceiveChannel> receiveChannel = makeReceiveChannel(10);
+    bsl::shared_ptr<MemoryBudget> budget = bsl::make_shared<MemoryBudget>(8);
+    receiveChannel->setMemoryBudget(budget);
+
+    makeReady(*receiveChannel);
+    setupConsumer(*receiveChannel, "consumer1");
+
+    EXPECT_CALL(d_callback, onAsyncWrite(EXPECT_QOSPREFETCH_IS(1), _));
+    EXPECT_CALL(d_callback, onNewMessage(_));
+    receiveChannel->processReceived(rmqamqp::Message(
+        rmqamqpt::Method(rmqamqpt::BasicMethod(rmqamqpt::BasicDeliver(
+            "consumer1", 1, false, "exchange", "routing-key")))));
+    receiveChannel->processReceived(rmqamqp::Message(rmqt::Message(
+        bsl::make_shared<bsl::vector<uint8_t> >(10, 'x'))));
+
+    EXPECT_THAT(budget->used(), Eq(10));
+    EXPECT_TRUE(budget->exhausted());
+
+    ackExpectations(1);
+    EXPECT_CALL(d_callback, onAsyncWrite(EXPECT_QOSPREFETCH_IS(10), _));
+    ackMessage(*receiveChannel,
+               rmqt::Envelope(1,
+                              receiveChannel->lifetimeId(),
+                              "consumer1",
+                              "exchange",
+                              "routing-key",
+                              false));
+
+    EXPECT_THAT(budget->used(), Eq(0));
+}
+
+TEST_F(ReceiveChannelTests, PrefetchBytesPausesDeliveries)
+{
+    rmqt::ConsumerConfig consumerConfig(
+        rmqt::ConsumerConfig::generateConsumerTag(), 10);
+    consumerConfig.setPrefetchBytes(15);
+
+    bsl::shared_ptr<ReceiveChannel> receiveChannel =
+        bsl::make_shared<ReceiveChannel>(
+            d_topology,
+            d_onAsyncWrite,
+            d_retryHandler,
+            d_metricPublisher,
+            consumerConfig,
+            TEST_VHOST,
+            d_ackQueue,
+            d_timerFactory->createWithCallback(&noopHungTimerCallback),
+            d_connErrorCb);
+
+    makeReady(*receiveChannel);
+    setupConsumer(*receiveChannel, "consumer1");
+
+    EXPECT_CALL(d_callback, onNewMessage(_)).Times(2);
+    for (uint64_t deliveryTag = 1; deliveryTag <= 2; ++deliveryTag) {
+        if (deliveryTag == 2) {
+            EXPECT_CALL(d_callback,
+                        onAsyncWrite(EXPECT_QOSPREFETCH_IS(1), _));
+        }
+        receiveChannel->processReceived(rmqamqp::Message(
+            rmqamqpt::Method(rmqamqpt::BasicMethod(rmqamqpt::BasicDeliver(
+                "consumer1", deliveryTag, false, "exchange", "routing-key")))));
+        receiveChannel->processReceived(rmqamqp::Message(rmqt::Message(
+            bsl::make_shared<bsl::vector<uint8_t> >(10, 'x'))));
+    }
+
+    ackExpectations(1);
+    EXPECT_CALL(d_callback, onAsyncWrite(EXPECT_QOSPREFETCH_IS(10), _));
+    ackMessage(*receiveChannel,
+               rmqt::Envelope(1,
+                              receiveChannel->lifetimeId(),
+                              "consumer1",
+                              "exchange",
+                              "routing-key",
+                              false));
+    EXPECT_THAT(receiveChannel->inFlight(), Eq(1));
+}
+
+TEST_F(ReceiveChannelTests, SlowStartDoublesPrefetchPerAckedWindow)
+{
+    rmqt::ConsumerConfig consumerConfig(
+        rmqt::ConsumerConfig::generateConsumerTag(), 5);
+    consumerConfig.setSlowStartPrefetchCount(2);
+    bsl::shared_ptr<ReceiveChannel> receiveChannel =
+        makeReceiveChannel(consumerConfig);
+
+    openAndSendTopology(*receiveChannel);
+    EXPECT_CALL(d_callback, onAsyncWrite(EXPECT_QOSPREFETCH_IS(2), _))
+        .WillOnce(InvokeArgument<1>());
+    queueDeclareReply(*receiveChannel);
+    qosOkReply(*receiveChannel);
+    setupConsumer(*receiveChannel, "consumer1");
+
+    for (uint64_t deliveryTag = 1; deliveryTag <= 6; ++deliveryTag) {
+        receiveMessage(*receiveChannel, deliveryTag, "consumer1");
+
+        ackExpectations(deliveryTag);
+        if (deliveryTag == 2) {
+            EXPECT_CALL(d_callback,
+                        onAsyncWrite(EXPECT_QOSPREFETCH_IS(4), _));
+        }
+        else if (deliveryTag == 6) {
+            // Doubling again would pass the configured prefetch count
+            EXPECT_CALL(d_callback,
+                        onAsyncWrite(EXPECT_QOSPREFETCH_IS(5), _));
+        }
+        ackMessage(*receiveChannel,
+                   rmqt::Envelope(deliveryTag,
+                                  receiveChannel->lifetimeId(),
+                                  "consumer1",
+                                  "exchange",
+                                  "routing-key",
+                                  false));
+        Mock::VerifyAndClearExpectations(&d_callback);
+    }
+}
+
+TEST_F(ReceiveChannelTests, SlowStartRestartsOnReopen)
+{
+    rmqt::ConsumerConfig consumerConfig(
+        rmqt::ConsumerConfig::generateConsumerTag(), 4);
+    consumerConfig.setSlowStartPrefetchCount(2);
+    bsl::shared_ptr<ReceiveChannel> receiveChannel =
+        makeReceiveChannel(consumerConfig);
+
+    makeReady(*receiveChannel);
+    setupConsumer(*receiveChannel, "consumer1");
+
+    for (uint64_t deliveryTag = 1; deliveryTag <= 2; ++deliveryTag) {
+        receiveMessage(*receiveChannel, deliveryTag, "consumer1");
+        ackExpectations(deliveryTag);
+        if (deliveryTag == 2) {
+            EXPECT_CALL(d_callback,
+                        onAsyncWrite(EXPECT_QOSPREFETCH_IS(4), _));
+        }
+        ackMessage(*receiveChannel,
+                   rmqt::Envelope(deliveryTag,
+                                  receiveChannel->lifetimeId(),
+                                  "consumer1",
+                                  "exchange",
+                                  "routing-key",
+                                  false));
+    }
+    Mock::VerifyAndClearExpectations(&d_callback);
+
+    openExpectations();
+    EXPECT_CALL(d_callback, onAsyncWrite(EXPECT_QOSPREFETCH_IS(2), _))
+        .WillOnce(InvokeArgument<1>());
+    EXPECT_CALL(
+        d_callback,
+        onAsyncWrite(Pointee(MethodMsgTypeEq(rmqamqpt::Method(
+                         rmqamqpt::BasicMethod(rmqamqpt::BasicConsume())))),
+                     _))
+        .WillOnce(InvokeArgument<1>());
+    EXPECT_CALL(*d_retryHandler, retry(_)).WillOnce(InvokeArgument<0>());
+
+    receiveChannel->reset(true);
+
+    openOkReply(*receiveChannel);
+    queueDeclareReply(*receiveChannel);
+    qosOkReply(*receiveChannel);
+    consumerReply(*receiveChannel, "consumer1");
+    EXPECT_THAT(receiveChannel->state(), Eq(rmqamqp::Channel::READY));
+}
+
+TEST_F(ReceiveChannelTests, NoAckConsumerKeepsNoBookkeeping)
+{
+    rmqt::ConsumerConfig consumerConfig(
+        rmqt::ConsumerConfig::generateConsumerTag(), 10);
+    consumerConfig.setNoAck();
+
+    bsl::shared_ptr<ReceiveChannel> receiveChannel =
+        bsl::make_shared<ReceiveChannel>(
+            d_topology,
+            d_onAsyncWrite,
+            d_retryHandler,
+            d_metricPublisher,
+            consumerConfig,
+            TEST_VHOST,
+            d_ackQueue,
+            d_timerFactory->createWithCallback(&noopHungTimerCallback),
+            d_connErrorCb);
+    bsl::shared_ptr<MemoryBudget> budget = bsl::make_shared<MemoryBudget>(8);
+    receiveChannel->setMemoryBudget(budget);
+
+    makeReady(*receiveChannel);
+
+    const bool noLocal = false;
+    const bool noAck   = true;
+    EXPECT_CALL(d_callback,
+                onAsyncWrite(EXPECT_CONSUME_IS(rmqamqpt::BasicConsume(
+                                 "test-queue",
+                                 d_consumerTag,
+                                 rmqt::FieldTable(),
+                                 noLocal,
+                                 noAck)),
+                             _))
+        .WillOnce(InvokeArgument<1>());
+    setupConsumerNoReply(*receiveChannel);
+    consumerReply(*receiveChannel);
+
+    EXPECT_CALL(d_callback, onNewMessage(_));
+    receiveChannel->processReceived(rmqamqp::Message(
+        rmqamqpt::Method(rmqamqpt::BasicMethod(rmqamqpt::BasicDeliver(
+            d_consumerTag, 1, false, "exchange", "routing-key")))));
+    receiveChannel->processReceived(rmqamqp::Message(rmqt::Message(
+        bsl::make_shared<bsl::vector<uint8_t> >(10, 'x'))));
+
+    EXPECT_THAT(receiveChannel->inFlight(), Eq(0));
+    EXPECT_THAT(budget->used(), Eq(0));
+    EXPECT_THAT(receiveChannel->state(), Eq(rmqamqp::Channel::READY));
+}
+
 TEST_F(ReceiveChannelTests, NackMessage)
 {
     bsl::shared_ptr<ReceiveChannel> receiveChannel = makeReceiveChannel(1);
@@ -1039,7 +1377,7 @@ TEST_F(ReceiveChannelTests, CancelConsumerBeforeConsumerStarted)
     EXPECT_FALSE(receiveChannel->consumerIsActive());
 }
 
-TEST_F(ReceiveChannelTests, AckBatchesInFlightDuringResetGetLocked)
+TEST_F(ReceiveChannelTests, AcksInFlightDuringResetGetDropped)
 {
     bsl::shared_ptr<ReceiveChannel> receiveChannel = makeReceiveChannel(1);
 
@@ -1051,9 +1389,6 @@ TEST_F(ReceiveChannelTests, AckBatchesInFlightDuringResetGetLocked)
 
     const size_t lifetime_id = receiveChannel->lifetimeId();
 
-    bsl::shared_ptr<rmqt::ConsumerAckBatch> batch =
-        bsl::make_shared<rmqt::ConsumerAckBatch>();
-
     {
         // Ack one
 
@@ -1066,37 +1401,383 @@ TEST_F(ReceiveChannelTests, AckBatchesInFlightDuringResetGetLocked)
                               "routing-key",
                               false);
 
-        batch->addAck(rmqt::ConsumerAck(id_ack, rmqt::ConsumerAck::ACK));
-        d_ackQueue->pushBack(batch);
+        EXPECT_TRUE(d_ackQueue->push(
+            rmqt::ConsumerAck(id_ack, rmqt::ConsumerAck::ACK)));
     }
 
     receiveChannel->reset(true);
 
-    // This is actually a no-op, but demonstrates that this function must be
-    // called after onReset for this issue to present
+    EXPECT_THAT(receiveChannel->lifetimeId(), Ne(lifetime_id));
+
+    // The reset dropped the ack rather than leaving it to be filtered out
+    bsl::vector<rmqt::ConsumerAck> remaining;
+    d_ackQueue->drain(&remaining);
+    EXPECT_THAT(remaining, IsEmpty());
+
+    // Nothing left for the drain posted by the first ack
     receiveChannel->consumeAckBatchFromQueue();
 
-    EXPECT_THAT(receiveChannel->lifetimeId(), Ne(lifetime_id));
-    {
-        // Ack two
-        const uint64_t deliveryTag = 1;
+    EXPECT_THAT(receiveChannel->inFlight(), Eq(0));
+}
 
-        rmqt::Envelope id_ack(deliveryTag,
+TEST_F(ReceiveChannelTests, SharedChannelDispatchesByConsumerTag)
+{
+    bsl::shared_ptr<ReceiveChannel> receiveChannel = makeReceiveChannel(10);
+    makeReady(*receiveChannel);
+
+    // The prefetch count now covers every consumer on the channel
+    EXPECT_CALL(d_callback, onAsyncWrite(EXPECT_GLOBAL_QOSPREFETCH_IS(10), _))
+        .WillOnce(InvokeArgument<1>());
+    receiveChannel->shareBetweenConsumers();
+    qosOkReply(*receiveChannel);
+
+    setupConsumer(*receiveChannel, "consumer1");
+
+    bsl::vector<bsl::string> secondTags;
+    EXPECT_CALL(d_callback, onAsyncWrite(_, _)).WillOnce(InvokeArgument<1>());
+    EXPECT_TRUE(receiveChannel->consume(
+        d_queue,
+        bdlf::BindUtil::bind(&recordConsumerTag, &secondTags, _2),
+        "consumer2"));
+    consumerReply(*receiveChannel, "consumer2");
+    EXPECT_THAT(receiveChannel->state(), Eq(rmqamqp::Channel::READY));
+
+    EXPECT_FALSE(receiveChannel->consume(d_queue, d_onNewMessage, "consumer2"));
+
+    receiveMessage(*receiveChannel, 1, "consumer1");
+
+    receiveChannel->processReceived(rmqamqp::Message(
+        rmqamqpt::Method(rmqamqpt::BasicMethod(rmqamqpt::BasicDeliver(
+            "consumer2", 2, false, "exchange", "routing-key")))));
+    receiveChannel->processReceived(rmqamqp::Message(rmqt::Message()));
+
+    ASSERT_THAT(secondTags.size(), Eq(1));
+    EXPECT_THAT(secondTags[0], Eq("consumer2"));
+    EXPECT_THAT(receiveChannel->inFlight(), Eq(2));
+}
+
+TEST_F(ReceiveChannelTests, SharedChannelCancelsAndDrainsOneConsumer)
+{
+    bsl::shared_ptr<ReceiveChannel> receiveChannel = makeReceiveChannel(10);
+    receiveChannel->shareBetweenConsumers();
+    makeReady(*receiveChannel);
+
+    setupConsumer(*receiveChannel, "consumer1");
+    setupConsumer(*receiveChannel, "consumer2");
+
+    receiveMessage(*receiveChannel, 11, "consumer1");
+    receiveMessage(*receiveChannel, 13, "consumer2");
+
+    cancelExpectations();
+    rmqt::Future<> cancelled = receiveChannel->cancelConsumer("consumer1");
+    EXPECT_FALSE(cancelled.tryResult());
+    cancelOkReply(*receiveChannel, "consumer1");
+
+    EXPECT_TRUE(cancelled.tryResult());
+    EXPECT_TRUE(receiveChannel->consumerIsActive());
+
+    rmqt::Result<> notCancelled =
+        receiveChannel->drainConsumer("consumer2").tryResult();
+    EXPECT_FALSE(notCancelled);
+    EXPECT_THAT(notCancelled.returnCode(), Ne(rmqt::TIMEOUT));
+
+    rmqt::Future<> drained = receiveChannel->drainConsumer("consumer1");
+    EXPECT_THAT(drained.tryResult().returnCode(), Eq(rmqt::TIMEOUT));
+
+    ackExpectations(11);
+    ackMessage(*receiveChannel,
+               rmqt::Envelope(11,
                               receiveChannel->lifetimeId(),
                               "consumer1",
                               "exchange",
                               "routing-key",
-                              false);
+                              false));
 
-        // Attempt to add another ack to ensure the AckBatch created above is
-        // locked This indicates to the ConsumerImpl that it needs to create a
-        // new AckBatch.
-        EXPECT_THAT(
-            batch->addAck(rmqt::ConsumerAck(id_ack, rmqt::ConsumerAck::ACK)),
-            Eq(false));
-    }
+    EXPECT_TRUE(drained.tryResult());
+    EXPECT_THAT(receiveChannel->inFlight(), Eq(1));
+}
+
+TEST_F(ReceiveChannelTests, ReleasedConsumerDeliveriesAreRequeued)
+{
+    bsl::shared_ptr<ReceiveChannel> receiveChannel = makeReceiveChannel(10);
+    receiveChannel->shareBetweenConsumers();
+    makeReady(*receiveChannel);
+
+    setupConsumer(*receiveChannel, "consumer1");
+    setupConsumer(*receiveChannel, "consumer2");
+
+    receiveMessage(*receiveChannel, 21, "consumer1");
+    receiveMessage(*receiveChannel, 23, "consumer2");
+
+    cancelExpectations();
+    EXPECT_CALL(d_callback,
+                onAsyncWrite(::testing::Pointee(MessageEq(rmqamqp::Message(
+                                 rmqamqpt::Method(rmqamqpt::BasicMethod(
+                                     rmqamqpt::BasicNack(21, true)))))),
+                             _))
+        .WillOnce(InvokeArgument<1>());
+    receiveChannel->releaseConsumer("consumer1");
+    EXPECT_THAT(receiveChannel->inFlight(), Eq(1));
+
+    // Delivered before the broker processed the cancel: never dispatched
+    EXPECT_CALL(d_callback,
+                onAsyncWrite(::testing::Pointee(MessageEq(rmqamqp::Message(
+                                 rmqamqpt::Method(rmqamqpt::BasicMethod(
+                                     rmqamqpt::BasicNack(25, true)))))),
+                             _))
+        .WillOnce(InvokeArgument<1>());
+    receiveChannel->processReceived(rmqamqp::Message(
+        rmqamqpt::Method(rmqamqpt::BasicMethod(rmqamqpt::BasicDeliver(
+            "consumer1", 25, false, "exchange", "routing-key")))));
+    receiveChannel->processReceived(rmqamqp::Message(rmqt::Message()));
 
+    cancelOkReply(*receiveChannel, "consumer1");
+    EXPECT_TRUE(receiveChannel->consumerIsActive());
+    EXPECT_THAT(receiveChannel->inFlight(), Eq(1));
+}
+
+TEST_F(ReceiveChannelTests, NackAllOutstandingSendsOneNack)
+{
+    bsl::shared_ptr<ReceiveChannel> receiveChannel = makeReceiveChannel(10);
+    makeReady(*receiveChannel);
+    setupConsumer(*receiveChannel);
+
+    receiveMessage(*receiveChannel, 1);
+    receiveMessage(*receiveChannel, 2);
+    receiveMessage(*receiveChannel, 3);
+
+    // The ack already queued goes before the nack
+    d_ackQueue->push(rmqt::ConsumerAck(
+        rmqt::Envelope(1,
+                       receiveChannel->lifetimeId(),
+                       d_consumerTag,
+                       "exchange",
+                       "routing-key",
+                       false),
+        rmqt::ConsumerAck::ACK));
+    ackExpectations(1);
+    EXPECT_CALL(d_callback,
+                onAsyncWrite(::testing::Pointee(MessageEq(rmqamqp::Message(
+                                 rmqamqpt::Method(rmqamqpt::BasicMethod(
+                                     rmqamqpt::BasicNack(3, false, true)))))),
+                             _))
+        .WillOnce(InvokeArgument<1>());
+    EXPECT_TRUE(receiveChannel->nackAllOutstanding(false).tryResult());
     EXPECT_THAT(receiveChannel->inFlight(), Eq(0));
+
+    // A callback acking a nacked message afterwards sends nothing
+    ackMessage(*receiveChannel,
+               rmqt::Envelope(2,
+                              receiveChannel->lifetimeId(),
+                              d_consumerTag,
+                              "exchange",
+                              "routing-key",
+                              false));
+}
+
+TEST_F(ReceiveChannelTests, RequeuesMessagesPastAckDeadline)
+{
+    bsl::shared_ptr<ReceiveChannel> receiveChannel = makeReceiveChannel(10);
+    makeReady(*receiveChannel);
+    setupConsumer(*receiveChannel);
+
+    receiveMessage(*receiveChannel, 1);
+    receiveMessage(*receiveChannel, 2);
+    receiveMessage(*receiveChannel, 3);
+
+    // Already acked, so not requeued
+    ackExpectations(1);
+    ackMessage(*receiveChannel,
+               rmqt::Envelope(1,
+                              receiveChannel->lifetimeId(),
+                              d_consumerTag,
+                              "exchange",
+                              "routing-key",
+                              false));
+
+    // Left with the consumer by the filter
+    EXPECT_CALL(d_callback,
+                onAsyncWrite(::testing::Pointee(MessageEq(rmqamqp::Message(
+                                 rmqamqpt::Method(rmqamqpt::BasicMethod(
+                                     rmqamqpt::BasicNack(2, true)))))),
+                             _))
+        .WillOnce(InvokeArgument<1>());
+    const bdlt::Datetime cutoffTime =
+        bdlt::CurrentTime::utc() + bdlt::DatetimeInterval(1);
+    EXPECT_THAT(receiveChannel->requeueMessagesOlderThan(cutoffTime,
+                                                         &notDeliveryTag3),
+                Eq(1));
+    EXPECT_THAT(receiveChannel->inFlight(), Eq(1));
+
+    // Requeued only once
+    EXPECT_THAT(receiveChannel->requeueMessagesOlderThan(cutoffTime,
+                                                         &notDeliveryTag3),
+                Eq(0));
+
+    // The consumer's late ack of the requeued message sends nothing
+    ackMessage(*receiveChannel,
+               rmqt::Envelope(2,
+                              receiveChannel->lifetimeId(),
+                              d_consumerTag,
+                              "exchange",
+                              "routing-key",
+                              false));
+
+    ackExpectations(3);
+    ackMessage(*receiveChannel,
+               rmqt::Envelope(3,
+                              receiveChannel->lifetimeId(),
+                              d_consumerTag,
+                              "exchange",
+                              "routing-key",
+                              false));
+    EXPECT_THAT(receiveChannel->inFlight(), Eq(0));
+}
+
+TEST_F(ReceiveChannelTests, AckThroughSendsOneAck)
+{
+    bsl::shared_ptr<ReceiveChannel> receiveChannel = makeReceiveChannel(10);
+    makeReady(*receiveChannel);
+    setupConsumer(*receiveChannel);
+
+    receiveMessage(*receiveChannel, 1);
+    receiveMessage(*receiveChannel, 2);
+    receiveMessage(*receiveChannel, 3);
+
+    const rmqt::Envelope envelope(2,
+                                  receiveChannel->lifetimeId(),
+                                  d_consumerTag,
+                                  "exchange",
+                                  "routing-key",
+                                  false);
+    EXPECT_CALL(d_callback,
+                onAsyncWrite(::testing::Pointee(MessageEq(rmqamqp::Message(
+                                 rmqamqpt::Method(rmqamqpt::BasicMethod(
+                                     rmqamqpt::BasicAck(2, true)))))),
+                             _))
+        .WillOnce(InvokeArgument<1>());
+    EXPECT_TRUE(receiveChannel->ackThrough(envelope).tryResult());
+    EXPECT_THAT(receiveChannel->inFlight(), Eq(1));
+
+    // A guard of a covered message resolved afterwards sends nothing
+    ackMessage(*receiveChannel,
+               rmqt::Envelope(1,
+                              receiveChannel->lifetimeId(),
+                              d_consumerTag,
+                              "exchange",
+                              "routing-key",
+                              false));
+}
+
+TEST_F(ReceiveChannelTests, AckThroughStaleEnvelopeFails)
+{
+    bsl::shared_ptr<ReceiveChannel> receiveChannel = makeReceiveChannel(10);
+    makeReady(*receiveChannel);
+    setupConsumer(*receiveChannel);
+
+    receiveMessage(*receiveChannel, 1);
+
+    const rmqt::Envelope envelope(1,
+                                  receiveChannel->lifetimeId() + 1,
+                                  d_consumerTag,
+                                  "exchange",
+                                  "routing-key",
+                                  false);
+    rmqt::Result<> result = receiveChannel->ackThrough(envelope).tryResult();
+    EXPECT_FALSE(result);
+    EXPECT_THAT(result.error(), HasSubstr("redelivered"));
+}
+
+TEST_F(ReceiveChannelTests, PublishWithoutConsumerFails)
+{
+    bsl::shared_ptr<ReceiveChannel> receiveChannel = makeReceiveChannel();
+    makeReady(*receiveChannel);
+
+    EXPECT_FALSE(
+        receiveChannel->publish(rmqt::Message(), "exchange", "routing-key"));
+}
+
+TEST_F(ReceiveChannelTests, PublishHeldUntilConsumeOk)
+{
+    bsl::shared_ptr<ReceiveChannel> receiveChannel = makeReceiveChannel();
+    makeReady(*receiveChannel);
+
+    EXPECT_CALL(d_callback, onAsyncWrite(_, _)).WillOnce(InvokeArgument<1>());
+    setupConsumerNoReply(*receiveChannel);
+
+    // The broker refuses a direct reply-to publish before the consume is
+    // confirmed
+    EXPECT_TRUE(
+        receiveChannel->publish(rmqt::Message(), "exchange", "routing-key"));
+    Mock::VerifyAndClearExpectations(&d_callback);
+
+    // basic.publish then the message content
+    EXPECT_CALL(d_callback, onAsyncWrite(_, _))
+        .Times(2)
+        .WillRepeatedly(InvokeArgument<1>());
+    consumerReply(*receiveChannel);
+
+    EXPECT_CALL(d_callback, onAsyncWrite(_, _))
+        .Times(2)
+        .WillRepeatedly(InvokeArgument<1>());
+    EXPECT_TRUE(
+        receiveChannel->publish(rmqt::Message(), "exchange", "routing-key"));
+}
+
+TEST_F(ReceiveChannelTests, StreamConsumerResumesAfterLastDelivery)
+{
+    rmqt::ConsumerConfig config(d_consumerTag, 100);
+    config.setStreamOffset(rmqt::StreamOffset::first());
+    bsl::shared_ptr<ReceiveChannel> receiveChannel = makeReceiveChannel(config);
+    makeReady(*receiveChannel);
+
+    rmqt::FieldTable firstArguments;
+    firstArguments["x-stream-offset"] = rmqt::FieldValue(bsl::string("first"));
+    EXPECT_CALL(d_callback,
+                onAsyncWrite(EXPECT_CONSUME_IS(rmqamqpt::BasicConsume(
+                                 "test-queue", d_consumerTag, firstArguments)),
+                             _))
+        .WillOnce(InvokeArgument<1>());
+
+    bsl::vector<uint64_t> offsets;
+    EXPECT_TRUE(receiveChannel->consume(
+        d_queue,
+        bdlf::BindUtil::bind(&recordStreamOffset, &offsets, _2),
+        d_consumerTag));
+    consumerReply(*receiveChannel);
+
+    bsl::shared_ptr<rmqt::FieldTable> headers =
+        bsl::make_shared<rmqt::FieldTable>();
+    (*headers)["x-stream-offset"] = rmqt::FieldValue(int64_t(41));
+    receiveChannel->processReceived(rmqamqp::Message(
+        rmqamqpt::Method(rmqamqpt::BasicMethod(rmqamqpt::BasicDeliver(
+            d_consumerTag, 1, false, "", "test-queue")))));
+    receiveChannel->processReceived(rmqamqp::Message(
+        rmqt::Message(bsl::make_shared<bsl::vector<uint8_t> >(), "", headers)));
+
+    ASSERT_THAT(offsets.size(), Eq(1));
+    EXPECT_THAT(offsets[0], Eq(41));
+
+    openExpectations();
+    qosExpectations();
+
+    rmqt::FieldTable resumeArguments;
+    resumeArguments["x-stream-offset"] = rmqt::FieldValue(int64_t(42));
+    EXPECT_CALL(d_callback,
+                onAsyncWrite(EXPECT_CONSUME_IS(rmqamqpt::BasicConsume(
+                                 "test-queue", d_consumerTag, resumeArguments)),
+                             _))
+        .WillOnce(InvokeArgument<1>());
+
+    EXPECT_CALL(*d_retryHandler, retry(_)).WillOnce(InvokeArgument<0>());
+    receiveChannel->reset(true);
+
+    openOkReply(*receiveChannel);
+    queueDeclareReply(*receiveChannel);
+    qosOkReply(*receiveChannel);
+    consumerReply(*receiveChannel);
+
+    EXPECT_THAT(receiveChannel->state(), Eq(rmqamqp::Channel::READY));
 }
 
 class ReceiveChannelHungTests : public ReceiveChannelTests {};
@@ -0,0 +1,256 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqamqp_ringmessagestore.h>
+
+#include <rmqt_message.h>
+
+#include <bdlf_bind.h>
+#include <bdlt_currenttime.h>
+#include <bdlt_datetime.h>
+
+#include <bsl_vector.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace ::testing;
+
+namespace {
+typedef rmqamqp::RingMessageStore<rmqt::Message> Store;
+
+bool removeTag(Store& store, uint64_t tag)
+{
+    rmqt::Message msg;
+    bdlt::Datetime insertTime;
+    return store.remove(tag, &msg, &insertTime);
+}
+
+void collectTag(bsl::vector<uint64_t>* tags,
+                uint64_t deliveryTag,
+                const bsl::pair<rmqt::Message, bdlt::Datetime>&)
+{
+    tags->push_back(deliveryTag);
+}
+} // namespace
+
+TEST(RingMessageStore, InitialiseEmpty)
+{
+    Store msgStore;
+    EXPECT_THAT(msgStore.count(), Eq(0));
+    EXPECT_THAT(msgStore.lifetimeId(), Eq(0));
+    EXPECT_THAT(msgStore.oldestTagInStore(), Eq(0));
+    EXPECT_THAT(msgStore.latestTagInStore(), Eq(0));
+}
+
+TEST(RingMessageStore, InsertLookupRemove)
+{
+    Store msgStore;
+    rmqt::Message msg1;
+
+    EXPECT_TRUE(msgStore.insert(1, msg1));
+    EXPECT_FALSE(msgStore.insert(1, msg1));
+
+    rmqt::Message msg;
+    EXPECT_TRUE(msgStore.lookup(1, &msg));
+    EXPECT_FALSE(msgStore.lookup(2, &msg));
+
+    EXPECT_TRUE(removeTag(msgStore, 1));
+    EXPECT_FALSE(removeTag(msgStore, 1));
+    EXPECT_THAT(msgStore.count(), Eq(0));
+    EXPECT_THAT(msgStore.latestTagTilNow(), Eq(1));
+}
+
+TEST(RingMessageStore, OutOfOrderRemovalMovesBounds)
+{
+    Store msgStore;
+    for (uint64_t tag = 1; tag <= 5; ++tag) {
+        EXPECT_TRUE(msgStore.insert(tag, rmqt::Message()));
+    }
+
+    EXPECT_TRUE(removeTag(msgStore, 3));
+    EXPECT_THAT(msgStore.oldestTagInStore(), Eq(1));
+    EXPECT_THAT(msgStore.latestTagInStore(), Eq(5));
+
+    EXPECT_TRUE(removeTag(msgStore, 1));
+    EXPECT_TRUE(removeTag(msgStore, 2));
+    EXPECT_THAT(msgStore.oldestTagInStore(), Eq(4));
+
+    EXPECT_TRUE(removeTag(msgStore, 5));
+    EXPECT_THAT(msgStore.latestTagInStore(), Eq(4));
+    EXPECT_THAT(msgStore.count(), Eq(1));
+}
+
+TEST(RingMessageStore, GrowsBeyondInitialCapacity)
+{
+    Store msgStore;
+    const uint64_t k_NUM_MESSAGES = 1000;
+
+    // Leave the first message outstanding so the ring has to span every tag
+    for (uint64_t tag = 1; tag <= k_NUM_MESSAGES; ++tag) {
+        EXPECT_TRUE(msgStore.insert(tag, rmqt::Message()));
+        if (tag > 1 && tag % 2 == 0) {
+            EXPECT_TRUE(removeTag(msgStore, tag));
+        }
+    }
+
+    EXPECT_THAT(msgStore.count(), Eq(k_NUM_MESSAGES / 2));
+    EXPECT_THAT(msgStore.oldestTagInStore(), Eq(1));
+    EXPECT_THAT(msgStore.latestTagInStore(), Eq(k_NUM_MESSAGES - 1));
+
+    rmqt::Message msg;
+    for (uint64_t tag = 1; tag <= k_NUM_MESSAGES; ++tag) {
+        EXPECT_THAT(msgStore.lookup(tag, &msg), Eq(tag % 2 == 1));
+    }
+}
+
+TEST(RingMessageStore, ShrinkToFitAfterBurst)
+{
+    Store msgStore;
+    const uint64_t k_NUM_MESSAGES = 1000;
+    for (uint64_t tag = 1; tag <= k_NUM_MESSAGES; ++tag) {
+        EXPECT_TRUE(msgStore.insert(tag, rmqt::Message()));
+    }
+    const bsl::size_t burstBytes = msgStore.retainedBytes();
+
+    for (uint64_t tag = 1; tag < k_NUM_MESSAGES - 2; ++tag) {
+        EXPECT_TRUE(removeTag(msgStore, tag));
+    }
+    msgStore.shrinkToFit();
+
+    EXPECT_THAT(msgStore.retainedBytes(), Lt(burstBytes));
+    EXPECT_THAT(msgStore.count(), Eq(3));
+    rmqt::Message msg;
+    for (uint64_t tag = k_NUM_MESSAGES - 2; tag <= k_NUM_MESSAGES; ++tag) {
+        EXPECT_TRUE(msgStore.lookup(tag, &msg));
+    }
+    EXPECT_TRUE(msgStore.insert(k_NUM_MESSAGES + 1, rmqt::Message()));
+}
+
+TEST(RingMessageStore, InsertBelowOldestTag)
+{
+    Store msgStore;
+    EXPECT_TRUE(msgStore.insert(10, rmqt::Message()));
+    EXPECT_TRUE(msgStore.insert(3, rmqt::Message()));
+
+    EXPECT_THAT(msgStore.oldestTagInStore(), Eq(3));
+    EXPECT_THAT(msgStore.latestTagInStore(), Eq(10));
+    EXPECT_THAT(msgStore.latestTagTilNow(), Eq(10));
+}
+
+TEST(RingMessageStore, RemoveUntilSkipsTombstones)
+{
+    Store msgStore;
+    for (uint64_t tag = 2; tag <= 6; ++tag) {
+        EXPECT_TRUE(msgStore.insert(tag, rmqt::Message()));
+    }
+    EXPECT_TRUE(removeTag(msgStore, 3));
+
+    Store::MessageList removed = msgStore.removeUntil(4);
+    ASSERT_THAT(removed.size(), Eq(2));
+    EXPECT_THAT(removed[0].first, Eq(2));
+    EXPECT_THAT(removed[1].first, Eq(4));
+
+    EXPECT_THAT(msgStore.count(), Eq(2));
+    EXPECT_THAT(msgStore.oldestTagInStore(), Eq(5));
+
+    EXPECT_TRUE(msgStore.removeUntil(3).empty());
+    EXPECT_THAT(msgStore.count(), Eq(2));
+}
+
+TEST(RingMessageStore, VisitMessagesOlderThanSkipsTombstones)
+{
+    Store msgStore;
+    for (uint64_t tag = 1; tag <= 4; ++tag) {
+        EXPECT_TRUE(msgStore.insert(tag, rmqt::Message()));
+    }
+    EXPECT_TRUE(removeTag(msgStore, 2));
+
+    bsl::vector<uint64_t> tags;
+    EXPECT_THAT(msgStore.visitMessagesOlderThan(
+                    bdlt::CurrentTime::utc(),
+                    bdlf::BindUtil::bind(&collectTag,
+                                         &tags,
+                                         bdlf::PlaceHolders::_1,
+                                         bdlf::PlaceHolders::_2)),
+                Eq(3));
+    EXPECT_THAT(tags, ElementsAre(1, 3, 4));
+}
+
+TEST(RingMessageStore, UpdateHungVisitsEachMessageOnce)
+{
+    Store msgStore;
+    for (uint64_t tag = 1; tag <= 3; ++tag) {
+        EXPECT_TRUE(msgStore.insert(tag, rmqt::Message()));
+    }
+
+    bsl::vector<uint64_t> tags;
+    const Store::MessageVisitor visitor = bdlf::BindUtil::bind(
+        &collectTag, &tags, bdlf::PlaceHolders::_1, bdlf::PlaceHolders::_2);
+
+    EXPECT_THAT(msgStore.updateHung(bdlt::CurrentTime::utc(), visitor), Eq(3));
+    EXPECT_THAT(tags, ElementsAre(1, 2, 3));
+
+    EXPECT_TRUE(msgStore.insert(4, rmqt::Message()));
+    EXPECT_TRUE(removeTag(msgStore, 2));
+
+    tags.clear();
+    EXPECT_THAT(msgStore.updateHung(bdlt::CurrentTime::utc(), visitor), Eq(3));
+    EXPECT_THAT(tags, ElementsAre(4));
+
+    EXPECT_THAT(msgStore.removeUntil(3).size(), Eq(2));
+    EXPECT_THAT(msgStore.hungCount(), Eq(1));
+}
+
+TEST(RingMessageStore, UpdateHungStopsAtYoungerMessages)
+{
+    Store msgStore;
+    EXPECT_TRUE(msgStore.insert(1, rmqt::Message()));
+
+    bsl::vector<uint64_t> tags;
+    const Store::MessageVisitor visitor = bdlf::BindUtil::bind(
+        &collectTag, &tags, bdlf::PlaceHolders::_1, bdlf::PlaceHolders::_2);
+
+    const bdlt::Datetime longAgo(2000, 1, 1);
+    EXPECT_THAT(msgStore.updateHung(longAgo, visitor), Eq(0));
+    EXPECT_TRUE(tags.empty());
+}
+
+TEST(RingMessageStore, LookupByGuidFindsOldest)
+{
+    Store msgStore;
+    rmqt::Message msg1;
+    EXPECT_TRUE(msgStore.insert(7, msg1));
+    EXPECT_TRUE(msgStore.insert(8, rmqt::Message()));
+
+    rmqt::Message msg;
+    uint64_t deliveryTag = 0;
+    EXPECT_TRUE(msgStore.lookup(msg1.guid(), &msg, &deliveryTag));
+    EXPECT_THAT(deliveryTag, Eq(7));
+}
+
+TEST(RingMessageStore, Swap)
+{
+    Store msgStore;
+    EXPECT_TRUE(msgStore.insert(1, rmqt::Message()));
+
+    Store msgStore2;
+    msgStore.swap(msgStore2);
+
+    EXPECT_THAT(msgStore.lifetimeId(), Eq(1));
+    EXPECT_THAT(msgStore.count(), Eq(0));
+    EXPECT_THAT(msgStore2.count(), Eq(1));
+    EXPECT_THAT(msgStore2.oldestTagInStore(), Eq(1));
+}
@@ -0,0 +1,51 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqamqp_routingkeytable.h>
+
+#include <bsl_memory.h>
+#include <bsl_string.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqamqp;
+using namespace ::testing;
+
+TEST(RoutingKeyTable, SharesOneCopyOfEachKey)
+{
+    RoutingKeyTable table;
+
+    const bsl::shared_ptr<const bsl::string> first = table.intern("key");
+    EXPECT_THAT(*first, Eq("key"));
+    EXPECT_THAT(table.intern("key"), Eq(first));
+    EXPECT_THAT(table.intern("other"), Ne(first));
+    EXPECT_THAT(table.size(), Eq(2));
+}
+
+TEST(RoutingKeyTable, CopiesKeysOnceFull)
+{
+    RoutingKeyTable table(1);
+
+    const bsl::shared_ptr<const bsl::string> interned = table.intern("key");
+
+    const bsl::shared_ptr<const bsl::string> other = table.intern("other");
+    EXPECT_THAT(*other, Eq("other"));
+    EXPECT_THAT(table.intern("other"), Ne(other));
+    EXPECT_THAT(table.size(), Eq(1));
+
+    EXPECT_THAT(table.intern("key"), Eq(interned));
+}
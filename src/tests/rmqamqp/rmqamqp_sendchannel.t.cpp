@@ -18,6 +18,9 @@
 #include <rmqamqp_channeltests.t.h>
 #include <rmqamqp_framer.h>
 #include <rmqamqp_metrics.h>
+#include <rmqamqpt_basicproperties.h>
+#include <rmqamqpt_contentbody.h>
+#include <rmqamqpt_contentheader.h>
 #include <rmqamqpt_method.h>
 #include <rmqio_retryhandler.h>
 #include <rmqt_confirmresponse.h>
@@ -54,6 +57,37 @@ class MockConfirm {
                       const rmqt::ConfirmResponse&));
 };
 
+class MockBatchConfirm {
+  public:
+    MOCK_METHOD1(
+        conf,
+        void(const bsl::shared_ptr<
+             const rmqamqp::SendChannel::ConfirmationBatch>&));
+};
+
+class MockStreamFailure {
+  public:
+    MOCK_METHOD0(failed, void());
+};
+
+class MockUnconfirmedWrite {
+  public:
+    MOCK_METHOD1(published, void(bool written));
+};
+
+bsl::shared_ptr<const bsl::vector<uint8_t> > streamChunk(bsl::size_t size)
+{
+    return bsl::make_shared<bsl::vector<uint8_t> >(size, uint8_t(7));
+}
+
+class MockBatchWriter {
+  public:
+    MOCK_METHOD2(
+        write,
+        void(const bsl::shared_ptr<bsl::vector<rmqamqp::Message> >&,
+             const rmqio::Connection::SuccessWriteCallback&));
+};
+
 class SendChannelTestsBase : public rmqamqp::ChannelTests {
   public:
     bsl::shared_ptr<rmqt::Exchange> d_exchange;
@@ -281,6 +315,112 @@ TEST_F(SendChannelTests, PublishMessage)
     publishMessage(*d_sendChannel, message);
 }
 
+TEST_F(SendChannelTests, StatsCountPublishedMessages)
+{
+    startupExpectations(*d_sendChannel);
+
+    rmqt::Message message(bsl::make_shared<bsl::vector<uint8_t> >(10));
+    publishMessage(*d_sendChannel, message);
+    publishMessage(*d_sendChannel, message);
+
+    rmqt::ChannelStats stats;
+    d_sendChannel->loadStats(&stats);
+
+    EXPECT_THAT(stats.type, Eq(rmqt::ChannelStats::PRODUCER));
+    EXPECT_THAT(stats.messagesOut, Eq(2));
+    EXPECT_THAT(stats.bytesOut, Eq(20));
+    EXPECT_THAT(stats.inFlightConfirms, Eq(2));
+    EXPECT_THAT(stats.messagesIn, Eq(0));
+}
+
+TEST_F(SendChannelTests, PublishChannelMetricsReportsInFlight)
+{
+    startupExpectations(*d_sendChannel);
+
+    rmqt::Message message;
+    publishMessage(*d_sendChannel, message);
+    publishMessage(*d_sendChannel, message);
+
+    bsl::vector<bsl::pair<bsl::string, bsl::string> > tags(d_vhostTag);
+    tags.push_back(bsl::make_pair(bsl::string("rmqExchangeName"),
+                                  d_exchange->name()));
+
+    EXPECT_CALL(*d_metricPublisher, publishGauge(_, _, _))
+        .Times(AnyNumber());
+    EXPECT_CALL(*d_metricPublisher,
+                publishGauge(bsl::string("channel_in_flight"), 2, tags));
+    EXPECT_CALL(*d_metricPublisher,
+                publishGauge(bsl::string("channel_pending_messages"), 0, tags));
+
+    d_sendChannel->publishChannelMetrics();
+}
+
+TEST_F(SendChannelTests, PublishBatchWithoutBatchWriter)
+{
+    startupExpectations(*d_sendChannel);
+
+    rmqt::Message message;
+    expectMessages(message, 2);
+
+    d_sendChannel->publishMessages(bsl::vector<rmqt::Message>(2, message),
+                                   d_routingKey,
+                                   rmqt::Mandatory::RETURN_UNROUTABLE);
+
+    EXPECT_THAT(d_sendChannel->inFlight(), Eq(2));
+}
+
+TEST_F(SendChannelTests, PipelinedOpenSendsSetupInOneWrite)
+{
+    MockBatchWriter batchWriter;
+    d_sendChannel->setAsyncBatchWrite(
+        bdlf::BindUtil::bind(&MockBatchWriter::write,
+                             &batchWriter,
+                             bdlf::PlaceHolders::_1,
+                             bdlf::PlaceHolders::_2));
+    d_sendChannel->setPipelinedOpen(true);
+
+    // channel.open, queue.declare and confirm.select
+    EXPECT_CALL(batchWriter, write(Pointee(SizeIs(3)), _))
+        .WillOnce(InvokeArgument<1>());
+    EXPECT_CALL(d_callback, onAsyncWrite(_, _)).Times(0);
+
+    d_sendChannel->open();
+    EXPECT_THAT(d_sendChannel->state(),
+                Eq(rmqamqp::Channel::CHANNEL_OPEN_SENT));
+
+    openOkReply(*d_sendChannel);
+    EXPECT_THAT(d_sendChannel->state(),
+                Eq(rmqamqp::Channel::DECLARING_TOPOLOGY));
+    queueDeclareReply(*d_sendChannel);
+    EXPECT_THAT(d_sendChannel->state(),
+                Eq(rmqamqp::Channel::AWAITING_REPLY));
+    selectOkReply(*d_sendChannel);
+    EXPECT_THAT(d_sendChannel->state(), Eq(rmqamqp::Channel::READY));
+}
+
+TEST_F(SendChannelTests, PublishBatchUsesBatchWriter)
+{
+    startupExpectations(*d_sendChannel);
+
+    MockBatchWriter batchWriter;
+    d_sendChannel->setAsyncBatchWrite(
+        bdlf::BindUtil::bind(&MockBatchWriter::write,
+                             &batchWriter,
+                             bdlf::PlaceHolders::_1,
+                             bdlf::PlaceHolders::_2));
+
+    // A basic.publish and the content for each message, in one write
+    EXPECT_CALL(batchWriter, write(Pointee(SizeIs(6)), _))
+        .WillOnce(InvokeArgument<1>());
+    EXPECT_CALL(d_callback, onAsyncWrite(_, _)).Times(0);
+
+    d_sendChannel->publishMessages(bsl::vector<rmqt::Message>(3),
+                                   d_routingKey,
+                                   rmqt::Mandatory::RETURN_UNROUTABLE);
+
+    EXPECT_THAT(d_sendChannel->inFlight(), Eq(3));
+}
+
 TEST_F(SendChannelTests, AckReceivedRemovesMessageFromStore)
 {
     startupExpectations(*d_sendChannel);
@@ -302,6 +442,26 @@ TEST_F(SendChannelTests, AckReceivedRemovesMessageFromStore)
     EXPECT_THAT(d_sendChannel->inFlight(), Eq(0));
 }
 
+TEST_F(SendChannelTests, WaitForConfirmsResolvesOnceAllConfirmed)
+{
+    EXPECT_TRUE(d_sendChannel->waitForConfirms().tryResult());
+
+    startupExpectations(*d_sendChannel);
+
+    rmqt::Message msg1, msg2;
+    publishMessage(*d_sendChannel, msg1);
+    publishMessage(*d_sendChannel, msg2);
+
+    rmqt::Future<> confirmed = d_sendChannel->waitForConfirms();
+    EXPECT_CALL(d_mockConfirm, conf(_, _, _)).Times(2);
+
+    receiveAck(*d_sendChannel, 1);
+    EXPECT_FALSE(confirmed.tryResult());
+
+    receiveAck(*d_sendChannel, 2);
+    EXPECT_TRUE(confirmed.tryResult());
+}
+
 TEST_F(SendChannelTests, NAckReceivedRemovesMessageFromStore)
 {
     startupExpectations(*d_sendChannel);
@@ -486,6 +646,32 @@ TEST_F(SendChannelTests, MultiAckMixReceivedRemovesMessagesFromStore)
     EXPECT_THAT(d_sendChannel->inFlight(), Eq(12 - 8));
 }
 
+TEST_F(SendChannelTests, MultiAckDeliversOneConfirmationBatch)
+{
+    MockBatchConfirm batchConfirm;
+    d_sendChannel->setBatchCallback(bdlf::BindUtil::bind(
+        &MockBatchConfirm::conf, &batchConfirm, bdlf::PlaceHolders::_1));
+
+    startupExpectations(*d_sendChannel);
+
+    publishMessages(*d_sendChannel, 6);
+
+    bsl::shared_ptr<const rmqamqp::SendChannel::ConfirmationBatch> batch;
+    EXPECT_CALL(d_mockConfirm, conf(_, _, _)).Times(0);
+    EXPECT_CALL(batchConfirm, conf(_)).WillOnce(SaveArg<0>(&batch));
+
+    receiveAck(*d_sendChannel, 4, true);
+
+    ASSERT_TRUE(batch);
+    ASSERT_THAT(batch->size(), Eq(4));
+    for (bsl::size_t i = 0; i < batch->size(); ++i) {
+        EXPECT_THAT((*batch)[i].first.routingKey(), Eq(d_routingKey));
+        EXPECT_THAT((*batch)[i].second,
+                    Eq(rmqt::ConfirmResponse(rmqt::ConfirmResponse::ACK)));
+    }
+    EXPECT_THAT(d_sendChannel->inFlight(), Eq(6 - 4));
+}
+
 TEST_F(SendChannelTests, PublishPendingMessagesWhenChannelIsReady)
 {
     rmqt::Message message;
@@ -627,3 +813,296 @@ TEST_F(SendChannelTests, PublishMandatoryMessage)
     d_sendChannel->publishMessage(
         message, d_routingKey, rmqt::Mandatory::RETURN_UNROUTABLE);
 }
+
+TEST_F(SendChannelTests, StreamPublishesHeaderThenBodyChunks)
+{
+    startupExpectations(*d_sendChannel);
+    Mock::VerifyAndClearExpectations(&d_callback);
+
+    rmqt::Message message;
+    MockStreamFailure streamFailure;
+    EXPECT_CALL(streamFailure, failed()).Times(0);
+
+    {
+        InSequence s;
+        EXPECT_CALL(
+            d_callback,
+            onAsyncWrite(Pointee(rmqamqp::MessageEq(rmqamqp::Message(
+                             rmqamqpt::Method(rmqamqpt::BasicMethod(
+                                 rmqamqpt::BasicPublish(d_exchange->name(),
+                                                        d_routingKey,
+                                                        true,
+                                                        false)))))),
+                         _));
+        EXPECT_CALL(
+            d_callback,
+            onAsyncWrite(Pointee(rmqamqp::MessageEq(
+                             rmqamqp::Message(rmqamqpt::ContentHeader(
+                                 rmqamqpt::Constants::BASIC,
+                                 6,
+                                 rmqamqpt::BasicProperties(
+                                     message.properties()))))),
+                         _));
+        EXPECT_CALL(d_callback,
+                    onAsyncWrite(Pointee(rmqamqp::MessageEq(rmqamqp::Message(
+                                     rmqamqpt::ContentBody(streamChunk(4))))),
+                                 _));
+        EXPECT_CALL(d_callback,
+                    onAsyncWrite(Pointee(rmqamqp::MessageEq(rmqamqp::Message(
+                                     rmqamqpt::ContentBody(streamChunk(2))))),
+                                 _));
+    }
+
+    d_sendChannel->beginStream(
+        message,
+        6,
+        d_routingKey,
+        rmqt::Mandatory::RETURN_UNROUTABLE,
+        bdlf::BindUtil::bind(&MockStreamFailure::failed, &streamFailure));
+    d_sendChannel->publishStreamContent(streamChunk(4),
+                                        &noopHungCallback);
+    d_sendChannel->publishStreamContent(streamChunk(2),
+                                        &noopHungCallback);
+
+    EXPECT_CALL(d_mockConfirm, conf(message, d_routingKey, _));
+    receiveAck(*d_sendChannel, 1);
+}
+
+TEST_F(SendChannelTests, MessagesWaitForStreamToComplete)
+{
+    startupExpectations(*d_sendChannel);
+
+    MockStreamFailure streamFailure;
+    d_sendChannel->beginStream(
+        rmqt::Message(),
+        4,
+        d_routingKey,
+        rmqt::Mandatory::RETURN_UNROUTABLE,
+        bdlf::BindUtil::bind(&MockStreamFailure::failed, &streamFailure));
+
+    rmqt::Message message;
+    expectMessageNotPublished(message);
+    d_sendChannel->publishMessage(
+        message, d_routingKey, rmqt::Mandatory::RETURN_UNROUTABLE);
+    Mock::VerifyAndClearExpectations(&d_callback);
+
+    expectMessages(message, 1);
+    d_sendChannel->publishStreamContent(streamChunk(4), &noopHungCallback);
+}
+
+TEST_F(SendChannelTests, StreamFailsWhenChannelNotReady)
+{
+    MockStreamFailure streamFailure;
+    EXPECT_CALL(streamFailure, failed());
+    EXPECT_CALL(d_mockConfirm, conf(_, d_routingKey, _));
+
+    d_sendChannel->beginStream(
+        rmqt::Message(),
+        4,
+        d_routingKey,
+        rmqt::Mandatory::RETURN_UNROUTABLE,
+        bdlf::BindUtil::bind(&MockStreamFailure::failed, &streamFailure));
+}
+
+TEST_F(SendChannelTests, StreamIsRejectedRatherThanResent)
+{
+    startupExpectations(*d_sendChannel);
+
+    rmqt::Message message;
+    MockStreamFailure streamFailure;
+    d_sendChannel->beginStream(
+        message,
+        4,
+        d_routingKey,
+        rmqt::Mandatory::RETURN_UNROUTABLE,
+        bdlf::BindUtil::bind(&MockStreamFailure::failed, &streamFailure));
+    d_sendChannel->publishStreamContent(streamChunk(2), &noopHungCallback);
+
+    EXPECT_CALL(streamFailure, failed());
+    EXPECT_CALL(
+        d_mockConfirm,
+        conf(message,
+             d_routingKey,
+             rmqt::ConfirmResponse(rmqt::ConfirmResponse::REJECT)));
+    d_sendChannel->reset(true);
+    EXPECT_THAT(d_sendChannel->inFlight(), Eq(0));
+    Mock::VerifyAndClearExpectations(&d_callback);
+
+    // Nothing is left to resend after reconnecting
+    expectMessageNotPublished(message);
+    startupExpectations(*d_sendChannel);
+}
+
+TEST_F(SendChannelTests, PacedResendWritesOneBatchAtATime)
+{
+    d_sendChannel->enableResendPacing(2, *d_timerFactory);
+    startupExpectations(*d_sendChannel);
+
+    rmqt::Message message;
+    for (int i = 0; i < 3; ++i) {
+        d_sendChannel->publishMessage(
+            message, d_routingKey, rmqt::Mandatory::RETURN_UNROUTABLE);
+    }
+    d_sendChannel->reset(true);
+    Mock::VerifyAndClearExpectations(&d_callback);
+
+    MockBatchWriter batchWriter;
+    d_sendChannel->setAsyncBatchWrite(
+        bdlf::BindUtil::bind(&MockBatchWriter::write,
+                             &batchWriter,
+                             bdlf::PlaceHolders::_1,
+                             bdlf::PlaceHolders::_2));
+
+    // Two messages, each a basic.publish and its content
+    rmqio::Connection::SuccessWriteCallback written;
+    EXPECT_CALL(batchWriter, write(Pointee(SizeIs(4)), _))
+        .WillOnce(SaveArg<1>(&written));
+    startupExpectations(*d_sendChannel);
+    EXPECT_THAT(d_sendChannel->inFlight(), Eq(2));
+
+    // Published while resending, so it waits behind the backlog
+    expectMessageNotPublished(message);
+    d_sendChannel->publishMessage(
+        message, d_routingKey, rmqt::Mandatory::RETURN_UNROUTABLE);
+    Mock::VerifyAndClearExpectations(&d_callback);
+
+    EXPECT_CALL(batchWriter, write(Pointee(SizeIs(4)), _))
+        .WillOnce(SaveArg<1>(&written));
+    written();
+    EXPECT_THAT(d_sendChannel->inFlight(), Eq(4));
+
+    EXPECT_CALL(d_callback, onAsyncWrite(_, _))
+        .Times(2)
+        .WillRepeatedly(InvokeArgument<1>());
+    written();
+    d_sendChannel->publishMessage(
+        message, d_routingKey, rmqt::Mandatory::RETURN_UNROUTABLE);
+    EXPECT_THAT(d_sendChannel->inFlight(), Eq(5));
+}
+
+TEST_F(SendChannelTests, UrgentMessageIsPublishedAheadOfPending)
+{
+    rmqt::Message pending;
+    rmqt::Message urgent;
+    d_sendChannel->publishMessage(
+        pending, d_routingKey, rmqt::Mandatory::RETURN_UNROUTABLE);
+    d_sendChannel->publishUrgent(
+        urgent, d_routingKey, rmqt::Mandatory::RETURN_UNROUTABLE);
+    Mock::VerifyAndClearExpectations(&d_callback);
+
+    EXPECT_CALL(d_callback, onAsyncWrite(_, _))
+        .Times(AnyNumber())
+        .WillRepeatedly(InvokeArgument<1>());
+    Sequence seq;
+    EXPECT_CALL(
+        d_callback,
+        onAsyncWrite(Pointee(rmqamqp::MessageEq(rmqamqp::Message(urgent))), _))
+        .InSequence(seq)
+        .WillOnce(InvokeArgument<1>());
+    EXPECT_CALL(
+        d_callback,
+        onAsyncWrite(Pointee(rmqamqp::MessageEq(rmqamqp::Message(pending))),
+                     _))
+        .InSequence(seq)
+        .WillOnce(InvokeArgument<1>());
+
+    startupExpectations(*d_sendChannel);
+    EXPECT_THAT(d_sendChannel->inFlight(), Eq(2));
+}
+
+TEST_F(SendChannelTests, UrgentMessageOvertakesPacedResend)
+{
+    d_sendChannel->enableResendPacing(2, *d_timerFactory);
+    startupExpectations(*d_sendChannel);
+
+    rmqt::Message message;
+    for (int i = 0; i < 3; ++i) {
+        d_sendChannel->publishMessage(
+            message, d_routingKey, rmqt::Mandatory::RETURN_UNROUTABLE);
+    }
+    d_sendChannel->reset(true);
+    Mock::VerifyAndClearExpectations(&d_callback);
+
+    MockBatchWriter batchWriter;
+    d_sendChannel->setAsyncBatchWrite(
+        bdlf::BindUtil::bind(&MockBatchWriter::write,
+                             &batchWriter,
+                             bdlf::PlaceHolders::_1,
+                             bdlf::PlaceHolders::_2));
+
+    rmqio::Connection::SuccessWriteCallback written;
+    EXPECT_CALL(batchWriter, write(Pointee(SizeIs(4)), _))
+        .WillOnce(SaveArg<1>(&written));
+    startupExpectations(*d_sendChannel);
+    EXPECT_THAT(d_sendChannel->inFlight(), Eq(2));
+
+    // Written straight away, between two batches of the backlog
+    rmqt::Message urgent;
+    expectMessages(urgent, 1);
+    d_sendChannel->publishUrgent(
+        urgent, d_routingKey, rmqt::Mandatory::RETURN_UNROUTABLE);
+    EXPECT_THAT(d_sendChannel->inFlight(), Eq(3));
+
+    EXPECT_CALL(batchWriter, write(Pointee(SizeIs(2)), _))
+        .WillOnce(SaveArg<1>(&written));
+    written();
+    EXPECT_THAT(d_sendChannel->inFlight(), Eq(4));
+}
+
+TEST_F(SendChannelTests, UnconfirmedChannelSkipsConfirmSelect)
+{
+    d_sendChannel->setUnconfirmed();
+    openAndSendTopology(*d_sendChannel);
+
+    EXPECT_CALL(
+        d_callback,
+        onAsyncWrite(
+            Pointee(rmqamqp::MessageEq(rmqamqp::Message(rmqamqpt::Method(
+                rmqamqpt::ConfirmMethod(rmqamqpt::ConfirmSelect(false)))))),
+            _))
+        .Times(0);
+    queueDeclareReply(*d_sendChannel);
+
+    EXPECT_THAT(d_sendChannel->state(), Eq(rmqamqp::Channel::READY));
+}
+
+TEST_F(SendChannelTests, UnconfirmedPublishReportsTheWrite)
+{
+    d_sendChannel->setUnconfirmed();
+    openAndSendTopology(*d_sendChannel);
+    queueDeclareReply(*d_sendChannel);
+
+    rmqt::Message msg;
+    MockUnconfirmedWrite onPublished;
+    expectMessages(msg, 1);
+    EXPECT_CALL(onPublished, published(true));
+    d_sendChannel->publishUnconfirmed(
+        msg,
+        d_routingKey,
+        rmqt::Mandatory::RETURN_UNROUTABLE,
+        bdlf::BindUtil::bind(&MockUnconfirmedWrite::published,
+                             &onPublished,
+                             bdlf::PlaceHolders::_1));
+
+    // Nothing is kept to confirm or resend
+    EXPECT_THAT(d_sendChannel->inFlight(), Eq(0));
+}
+
+TEST_F(SendChannelTests, UnconfirmedPublishIsDroppedWhenNotReady)
+{
+    d_sendChannel->setUnconfirmed();
+
+    rmqt::Message msg;
+    MockUnconfirmedWrite onPublished;
+    expectMessageNotPublished(msg);
+    expectAnyCounterMetric("client_sent_messages");
+    expectCounterMetric("dropped_messages", 1);
+    EXPECT_CALL(onPublished, published(false));
+    d_sendChannel->publishUnconfirmed(
+        msg,
+        d_routingKey,
+        rmqt::Mandatory::RETURN_UNROUTABLE,
+        bdlf::BindUtil::bind(&MockUnconfirmedWrite::published,
+                             &onPublished,
+                             bdlf::PlaceHolders::_1));
+}
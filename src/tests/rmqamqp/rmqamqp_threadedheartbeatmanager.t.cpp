@@ -0,0 +1,196 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqamqp_threadedheartbeatmanager.h>
+
+#include <rmqtestutil_callcount.h>
+
+#include <bdlf_bind.h>
+#include <bdlf_placeholder.h>
+#include <bsls_timeinterval.h>
+
+#include <bsl_functional.h>
+#include <bsl_memory.h>
+#include <bsl_vector.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace ::testing;
+
+namespace {
+bsls::TimeInterval readClock(const bsls::TimeInterval* now) { return *now; }
+
+void queueItem(bsl::vector<bsl::function<void()> >* items,
+               const bsl::function<void()>& item)
+{
+    items->push_back(item);
+}
+} // namespace
+
+class ThreadedHeartbeatManagerTests : public Test {
+  public:
+    ThreadedHeartbeatManagerTests()
+    : d_heartbeatCallCount(0)
+    , d_connectionKilledCount(0)
+    , d_now(100)
+    , d_posted()
+    , d_hbManager(bsl::make_shared<rmqamqp::ThreadedHeartbeatManager>(
+          bsl::shared_ptr<bdlmt::EventScheduler>(),
+          bdlf::BindUtil::bind(&queueItem, &d_posted, bdlf::PlaceHolders::_1),
+          bdlf::BindUtil::bind(&readClock, &d_now)))
+    {
+    }
+
+    void start(uint32_t timeoutSeconds)
+    {
+        d_hbManager->start(timeoutSeconds,
+                           rmqtestutil::CallCount(&d_heartbeatCallCount),
+                           rmqtestutil::CallCount(&d_connectionKilledCount));
+    }
+
+    /// Step the clock a second at a time, polling after each step as the
+    /// timer thread would, without running the posted work
+    void poll(int seconds)
+    {
+        for (int i = 0; i < seconds; ++i) {
+            d_now += bsls::TimeInterval(1);
+            d_hbManager->poll();
+        }
+    }
+
+    /// Run the work posted to the event loop so far
+    void runLoop()
+    {
+        bsl::vector<bsl::function<void()> > items;
+        items.swap(d_posted);
+        for (bsl::size_t i = 0; i < items.size(); ++i) {
+            items[i]();
+        }
+    }
+
+    void tick(int seconds)
+    {
+        for (int i = 0; i < seconds; ++i) {
+            poll(1);
+            runLoop();
+        }
+    }
+
+    int d_heartbeatCallCount;
+    int d_connectionKilledCount;
+    bsls::TimeInterval d_now;
+    bsl::vector<bsl::function<void()> > d_posted;
+    bsl::shared_ptr<rmqamqp::ThreadedHeartbeatManager> d_hbManager;
+};
+
+TEST_F(ThreadedHeartbeatManagerTests, HeartbeatIsSentFromTheLoop)
+{
+    start(4);
+
+    poll(2);
+    EXPECT_THAT(d_heartbeatCallCount, Eq(0));
+    EXPECT_THAT(d_posted.size(), Eq(1));
+
+    runLoop();
+    EXPECT_THAT(d_heartbeatCallCount, Eq(1));
+    EXPECT_THAT(d_connectionKilledCount, Eq(0));
+}
+
+TEST_F(ThreadedHeartbeatManagerTests, DisconnectTriggersLateForFirstHeartbeat)
+{
+    start(4);
+
+    tick(8);
+    EXPECT_THAT(d_heartbeatCallCount, Eq(4));
+    EXPECT_THAT(d_connectionKilledCount, Eq(0));
+
+    tick(1);
+    EXPECT_THAT(d_connectionKilledCount, Eq(1));
+}
+
+TEST_F(ThreadedHeartbeatManagerTests, DisconnectTriggersAfterFirstHeartbeat)
+{
+    start(4);
+    d_hbManager->notifyHeartbeatReceived();
+
+    tick(4);
+    EXPECT_THAT(d_connectionKilledCount, Eq(0));
+
+    tick(1);
+    EXPECT_THAT(d_connectionKilledCount, Eq(1));
+}
+
+TEST_F(ThreadedHeartbeatManagerTests, FramesReadByABusyLoopKeepItAlive)
+{
+    start(4);
+    d_hbManager->notifyHeartbeatReceived();
+
+    // The timer thread finds the deadline passed while the loop is busy
+    poll(5);
+    EXPECT_THAT(d_posted.size(), Eq(3));
+
+    // but the loop had a frame waiting before the liveness check
+    d_hbManager->notifyMessageReceived();
+    runLoop();
+
+    EXPECT_THAT(d_connectionKilledCount, Eq(0));
+}
+
+TEST_F(ThreadedHeartbeatManagerTests, OneLivenessCheckPostedAtATime)
+{
+    start(4);
+    d_hbManager->notifyHeartbeatReceived();
+
+    poll(8);
+    runLoop();
+
+    EXPECT_THAT(d_connectionKilledCount, Eq(1));
+}
+
+TEST_F(ThreadedHeartbeatManagerTests, StopDropsPostedWork)
+{
+    start(4);
+
+    poll(10);
+    d_hbManager->stop();
+    runLoop();
+
+    EXPECT_THAT(d_heartbeatCallCount, Eq(0));
+    EXPECT_THAT(d_connectionKilledCount, Eq(0));
+}
+
+TEST_F(ThreadedHeartbeatManagerTests, PostedWorkOutlivingTheManagerIsDropped)
+{
+    start(4);
+
+    poll(10);
+    d_hbManager.reset();
+    runLoop();
+
+    EXPECT_THAT(d_heartbeatCallCount, Eq(0));
+    EXPECT_THAT(d_connectionKilledCount, Eq(0));
+}
+
+TEST_F(ThreadedHeartbeatManagerTests, PausedReadsDoNotKill)
+{
+    start(4);
+    d_hbManager->setReadsPaused(true);
+
+    tick(20);
+    EXPECT_THAT(d_connectionKilledCount, Eq(0));
+    EXPECT_THAT(d_heartbeatCallCount, Gt(0));
+}
@@ -0,0 +1,120 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqamqp_topologycache.h>
+
+#include <rmqt_exchange.h>
+#include <rmqt_queue.h>
+#include <rmqt_queuedelete.h>
+#include <rmqt_topology.h>
+#include <rmqt_topologyupdate.h>
+
+#include <bsl_memory.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqamqp;
+
+namespace {
+
+rmqt::Topology makeTopology()
+{
+    rmqt::Topology topology;
+    bsl::shared_ptr<rmqt::Queue> queue =
+        bsl::make_shared<rmqt::Queue>("queue");
+    bsl::shared_ptr<rmqt::Exchange> exchange =
+        bsl::make_shared<rmqt::Exchange>("exchange");
+    topology.queues.push_back(queue);
+    topology.exchanges.push_back(exchange);
+    topology.queueBindings.push_back(
+        bsl::make_shared<rmqt::QueueBinding>(exchange, queue, "key"));
+    return topology;
+}
+
+} // namespace
+
+TEST(TopologyCacheTests, EmptyCacheDeclaresEverything)
+{
+    TopologyCache cache;
+    rmqt::Topology topology = makeTopology();
+
+    rmqt::Topology undeclared = cache.undeclared(topology);
+
+    EXPECT_EQ(undeclared.queues.size(), 1);
+    EXPECT_EQ(undeclared.exchanges.size(), 1);
+    EXPECT_EQ(undeclared.queueBindings.size(), 1);
+}
+
+TEST(TopologyCacheTests, SkipsDeclaredEntitiesButKeepsBindings)
+{
+    TopologyCache cache;
+    cache.recordDeclared(makeTopology());
+    EXPECT_EQ(cache.size(), 2);
+
+    // Another channel's topology describing the same entities
+    rmqt::Topology undeclared = cache.undeclared(makeTopology());
+
+    EXPECT_EQ(undeclared.queues.size(), 0);
+    EXPECT_EQ(undeclared.exchanges.size(), 0);
+    EXPECT_EQ(undeclared.queueBindings.size(), 1);
+}
+
+TEST(TopologyCacheTests, DifferentPropertiesAreDeclared)
+{
+    TopologyCache cache;
+    cache.recordDeclared(makeTopology());
+
+    rmqt::Topology topology;
+    topology.queues.push_back(
+        bsl::make_shared<rmqt::Queue>("queue", false, false, false));
+    topology.exchanges.push_back(bsl::make_shared<rmqt::Exchange>(
+        "exchange", false, rmqt::ExchangeType::FANOUT));
+
+    rmqt::Topology undeclared = cache.undeclared(topology);
+
+    EXPECT_EQ(undeclared.queues.size(), 1);
+    EXPECT_EQ(undeclared.exchanges.size(), 1);
+}
+
+TEST(TopologyCacheTests, ServerNamedAndAutoDeleteAreNotCached)
+{
+    TopologyCache cache;
+
+    rmqt::Topology topology;
+    topology.queues.push_back(bsl::make_shared<rmqt::Queue>());
+    topology.queues.push_back(
+        bsl::make_shared<rmqt::Queue>("temporary", false, true));
+    cache.recordDeclared(topology);
+
+    EXPECT_EQ(cache.size(), 0);
+    EXPECT_EQ(cache.undeclared(topology).queues.size(), 2);
+}
+
+TEST(TopologyCacheTests, QueueDeleteAndClearForget)
+{
+    TopologyCache cache;
+    cache.recordDeclared(makeTopology());
+
+    rmqt::TopologyUpdate update;
+    update.updates.push_back(rmqt::TopologyUpdate::SupportedUpdate(
+        bsl::make_shared<rmqt::QueueDelete>("queue", false, false, false)));
+    cache.recordUpdate(update);
+
+    EXPECT_EQ(cache.size(), 1);
+    EXPECT_EQ(cache.undeclared(makeTopology()).queues.size(), 1);
+
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0);
+}
@@ -108,3 +108,50 @@ TEST_F(TopologyMergerTests, unbindExistingBind)
     EXPECT_EQ(1, topology.queueBindings.size());
     EXPECT_EQ("bindKey2", topology.queueBindings[0]->bindingKey());
 }
+
+TEST_F(TopologyMergerTests, indexingCollapsesDuplicateBinds)
+{
+    rmqt::Topology topology;
+    topology.queueBindings.push_back(
+        bsl::make_shared<rmqt::QueueBinding>(exchange, queue, "bindKey"));
+    topology.queueBindings.push_back(
+        bsl::make_shared<rmqt::QueueBinding>(exchange, queue, "bindKey2"));
+    topology.queueBindings.push_back(
+        bsl::make_shared<rmqt::QueueBinding>(exchange, queue, "bindKey"));
+
+    rmqamqp::TopologyMerger merger(&topology);
+
+    EXPECT_EQ(2, topology.queueBindings.size());
+    EXPECT_EQ("bindKey", topology.queueBindings[0]->bindingKey());
+    EXPECT_EQ("bindKey2", topology.queueBindings[1]->bindingKey());
+}
+
+TEST_F(TopologyMergerTests, indexStaysValidAcrossUpdates)
+{
+    rmqt::Topology topology;
+    rmqamqp::TopologyMerger merger(&topology);
+
+    rmqt::TopologyUpdate binds;
+    const char* keys[] = {"a", "b", "c", "d"};
+    for (size_t i = 0; i < 4; ++i) {
+        binds.updates.push_back(rmqt::TopologyUpdate::SupportedUpdate(
+            bsl::make_shared<rmqt::QueueBinding>(exchange, queue, keys[i])));
+    }
+    merger.apply(binds);
+    merger.apply(binds);
+    EXPECT_EQ(4, topology.queueBindings.size());
+
+    // Removing "a" moves "d" into its place, which must still be found
+    rmqt::TopologyUpdate unbinds;
+    unbinds.updates.push_back(rmqt::TopologyUpdate::SupportedUpdate(
+        bsl::make_shared<rmqt::QueueUnbinding>(exchange, queue, "a")));
+    unbinds.updates.push_back(rmqt::TopologyUpdate::SupportedUpdate(
+        bsl::make_shared<rmqt::QueueUnbinding>(exchange, queue, "d")));
+    unbinds.updates.push_back(rmqt::TopologyUpdate::SupportedUpdate(
+        bsl::make_shared<rmqt::QueueUnbinding>(exchange, queue, "missing")));
+    merger.apply(unbinds);
+
+    ASSERT_EQ(2, topology.queueBindings.size());
+    EXPECT_EQ("c", topology.queueBindings[0]->bindingKey());
+    EXPECT_EQ("b", topology.queueBindings[1]->bindingKey());
+}
@@ -0,0 +1,119 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqamqp_topologystore.h>
+
+#include <rmqt_exchange.h>
+#include <rmqt_queue.h>
+#include <rmqt_topology.h>
+
+#include <bdls_filesystemutil.h>
+
+#include <bsl_memory.h>
+#include <bsl_string.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqamqp;
+
+namespace {
+
+rmqt::Topology makeTopology()
+{
+    rmqt::Topology topology;
+    topology.queues.push_back(bsl::make_shared<rmqt::Queue>("queue"));
+    topology.exchanges.push_back(bsl::make_shared<rmqt::Exchange>("exchange"));
+    return topology;
+}
+
+class TopologyStoreTests : public ::testing::Test {
+  public:
+    TopologyStoreTests()
+    : d_directory()
+    {
+        bdls::FilesystemUtil::createTemporaryDirectory(&d_directory,
+                                                       "rmqtopologystore");
+    }
+
+    ~TopologyStoreTests() { bdls::FilesystemUtil::remove(d_directory, true); }
+
+    bsl::string d_directory;
+};
+
+} // namespace
+
+TEST_F(TopologyStoreTests, RecordsPerCluster)
+{
+    const rmqt::Topology topology = makeTopology();
+
+    TopologyStore store(d_directory, "vhost");
+    store.setClusterName("cluster-a");
+    EXPECT_FALSE(store.contains(topology));
+
+    store.record(topology);
+    EXPECT_TRUE(store.contains(topology));
+
+    // A new process finds the record, another cluster does not
+    TopologyStore restarted(d_directory, "vhost");
+    restarted.setClusterName("cluster-a");
+    EXPECT_TRUE(restarted.contains(topology));
+
+    restarted.setClusterName("cluster-b");
+    EXPECT_FALSE(restarted.contains(topology));
+
+    TopologyStore otherVHost(d_directory, "other");
+    otherVHost.setClusterName("cluster-a");
+    EXPECT_FALSE(otherVHost.contains(topology));
+}
+
+TEST_F(TopologyStoreTests, Forgets)
+{
+    const rmqt::Topology topology = makeTopology();
+
+    TopologyStore store(d_directory, "vhost");
+    store.setClusterName("cluster");
+    store.record(topology);
+    store.forget(topology);
+
+    EXPECT_FALSE(store.contains(topology));
+}
+
+TEST_F(TopologyStoreTests, KeepsNothingUntilClusterKnown)
+{
+    const rmqt::Topology topology = makeTopology();
+
+    TopologyStore store(d_directory, "vhost");
+    store.record(topology);
+    EXPECT_FALSE(store.contains(topology));
+}
+
+TEST(TopologyStore, FingerprintCoversProperties)
+{
+    const rmqt::Topology topology = makeTopology();
+    EXPECT_EQ(TopologyStore::fingerprint(topology),
+              TopologyStore::fingerprint(makeTopology()));
+    EXPECT_EQ(TopologyStore::fingerprint(topology).size(), 16u);
+
+    rmqt::Topology durability = makeTopology();
+    durability.queues[0] =
+        bsl::make_shared<rmqt::Queue>("queue", false, false, false);
+    EXPECT_NE(TopologyStore::fingerprint(topology),
+              TopologyStore::fingerprint(durability));
+
+    rmqt::Topology bigger = makeTopology();
+    bigger.queues.push_back(bsl::make_shared<rmqt::Queue>("queue2"));
+    EXPECT_NE(TopologyStore::fingerprint(topology),
+              TopologyStore::fingerprint(bigger));
+}
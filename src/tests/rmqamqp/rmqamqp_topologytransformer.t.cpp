@@ -375,6 +375,88 @@ TEST_F(TopologyTransformerTests, ExchangeBinding)
     EXPECT_TRUE(transformer.isDone());
 }
 
+TEST_F(TopologyTransformerTests, PipelinedTopologyWaitsForLastReply)
+{
+    bsl::shared_ptr<rmqt::Queue> q = bsl::make_shared<rmqt::Queue>(
+        "test-queue", false, false, false, rmqt::FieldTable());
+    bsl::shared_ptr<rmqt::Exchange> e =
+        bsl::make_shared<rmqt::Exchange>("test-exchange");
+    bsl::shared_ptr<rmqt::QueueBinding> b =
+        bsl::make_shared<rmqt::QueueBinding>(e, q, "k", rmqt::FieldTable());
+
+    d_topology.queues.push_back(q);
+    d_topology.exchanges.push_back(e);
+    d_topology.exchanges.push_back(bsl::make_shared<rmqt::Exchange>(""));
+    d_topology.queueBindings.push_back(b);
+
+    TopologyTransformer transformer(d_topology, true);
+
+    Message msg = transformer.getNextMessage();
+    assertQueueDeclare(msg);
+    EXPECT_TRUE(msg.the<rmqamqpt::Method>()
+                    .the<rmqamqpt::QueueMethod>()
+                    .the<rmqamqpt::QueueDeclare>()
+                    .noWait());
+
+    msg = transformer.getNextMessage();
+    assertExchangeDeclare(msg);
+    EXPECT_TRUE(msg.the<rmqamqpt::Method>()
+                    .the<rmqamqpt::ExchangeMethod>()
+                    .the<rmqamqpt::ExchangeDeclare>()
+                    .noWait());
+
+    msg = transformer.getNextMessage();
+    assertQueueBind(msg);
+    EXPECT_FALSE(msg.the<rmqamqpt::Method>()
+                     .the<rmqamqpt::QueueMethod>()
+                     .the<rmqamqpt::QueueBind>()
+                     .noWait());
+
+    EXPECT_FALSE(transformer.hasNext());
+    EXPECT_FALSE(transformer.isDone());
+
+    Message reply;
+    reply.assign<rmqamqpt::Method>(
+        rmqamqpt::Method(rmqamqpt::QueueMethod(rmqamqpt::QueueBindOk())));
+    EXPECT_TRUE(transformer.processReplyMessage(reply));
+    EXPECT_TRUE(transformer.isDone());
+}
+
+TEST_F(TopologyTransformerTests, PipelinedTopologyWaitsForServerNamedQueue)
+{
+    createQueue("");
+    createQueue("test-queue");
+    createQueue("test-queue-2");
+
+    TopologyTransformer transformer(d_topology, true);
+
+    Message msg1 = transformer.getNextMessage();
+    Message msg2 = transformer.getNextMessage();
+    Message msg3 = transformer.getNextMessage();
+    EXPECT_FALSE(msg1.the<rmqamqpt::Method>()
+                     .the<rmqamqpt::QueueMethod>()
+                     .the<rmqamqpt::QueueDeclare>()
+                     .noWait());
+    EXPECT_TRUE(msg2.the<rmqamqpt::Method>()
+                    .the<rmqamqpt::QueueMethod>()
+                    .the<rmqamqpt::QueueDeclare>()
+                    .noWait());
+    EXPECT_FALSE(msg3.the<rmqamqpt::Method>()
+                     .the<rmqamqpt::QueueMethod>()
+                     .the<rmqamqpt::QueueDeclare>()
+                     .noWait());
+
+    Message reply;
+    reply.assign<rmqamqpt::Method>(rmqamqpt::Method(rmqamqpt::QueueMethod(
+        rmqamqpt::QueueDeclareOk("amq.gen-1", 0, 0))));
+    EXPECT_TRUE(transformer.processReplyMessage(reply));
+    EXPECT_FALSE(transformer.isDone());
+    reply.assign<rmqamqpt::Method>(rmqamqpt::Method(rmqamqpt::QueueMethod(
+        rmqamqpt::QueueDeclareOk("test-queue-2", 0, 0))));
+    EXPECT_TRUE(transformer.processReplyMessage(reply));
+    EXPECT_TRUE(transformer.isDone());
+}
+
 TEST_F(TopologyTransformerTests, BindingUpdateTest)
 {
     bsl::shared_ptr<rmqt::Queue> q = bsl::make_shared<rmqt::Queue>(
@@ -540,3 +540,101 @@ TEST(Methods_BasicProperties, FromMessage)
     EXPECT_FALSE(basicProps.userId());
     EXPECT_FALSE(basicProps.appId());
 }
+
+TEST(Methods_BasicProperties, LazyHeadersDecode)
+{
+    rmqt::Properties properties;
+    properties.contentType  = "Content";
+    properties.headers      = bsl::make_shared<rmqt::FieldTable>();
+    properties.deliveryMode = rmqt::DeliveryMode::PERSISTENT;
+    properties.appId        = "app";
+    (*properties.headers)["trace"] = rmqt::FieldValue(bsl::string("abc"));
+
+    bsl::vector<uint8_t> data;
+    rmqamqpt::Writer writer(&data);
+    rmqamqpt::BasicProperties::encode(writer,
+                                      rmqamqpt::BasicProperties(properties));
+
+    rmqamqpt::BasicProperties basicProps;
+    EXPECT_TRUE(rmqamqpt::BasicProperties::decode(
+        &basicProps, data.data(), data.size(), true));
+
+    // The headers are kept encoded, the properties following them decoded
+    EXPECT_FALSE(basicProps.headers());
+    ASSERT_TRUE(basicProps.headersView());
+    EXPECT_THAT(basicProps.contentType(), Eq("Content"));
+    EXPECT_THAT(basicProps.deliveryMode().value(),
+                Eq(rmqt::DeliveryMode::PERSISTENT));
+    EXPECT_THAT(basicProps.appId(), Eq("app"));
+
+    rmqt::FieldValue value;
+    EXPECT_TRUE(basicProps.headersView()->find(&value, "trace"));
+    EXPECT_THAT(value, Eq(rmqt::FieldValue(bsl::string("abc"))));
+    ASSERT_TRUE(basicProps.headersView()->table());
+    EXPECT_THAT(*basicProps.headersView()->table(),
+                Eq(*properties.headers));
+}
+
+TEST(Methods_BasicProperties, DecodesOnlySelectedProperties)
+{
+    rmqt::Properties properties;
+    properties.contentType   = "Content";
+    properties.headers       = bsl::make_shared<rmqt::FieldTable>();
+    properties.deliveryMode  = rmqt::DeliveryMode::PERSISTENT;
+    properties.correlationId = "correlation";
+    properties.messageId     = "message";
+    properties.timestamp     = bdlt::Datetime(2020, 1, 2);
+    properties.userId        = "user";
+    properties.appId         = "app";
+    (*properties.headers)["trace"] = rmqt::FieldValue(bsl::string("abc"));
+
+    bsl::vector<uint8_t> data;
+    rmqamqpt::Writer writer(&data);
+    rmqamqpt::BasicProperties::encode(writer,
+                                      rmqamqpt::BasicProperties(properties));
+
+    rmqamqpt::BasicProperties basicProps;
+    EXPECT_TRUE(rmqamqpt::BasicProperties::decode(
+        &basicProps,
+        data.data(),
+        data.size(),
+        false,
+        rmqt::MessageProperty::MESSAGE_ID |
+            rmqt::MessageProperty::CORRELATION_ID |
+            rmqt::MessageProperty::APP_ID));
+
+    EXPECT_THAT(basicProps.messageId(), Eq("message"));
+    EXPECT_THAT(basicProps.correlationId(), Eq("correlation"));
+    EXPECT_THAT(basicProps.appId(), Eq("app"));
+
+    EXPECT_FALSE(basicProps.contentType());
+    EXPECT_FALSE(basicProps.deliveryMode());
+    EXPECT_FALSE(basicProps.timestamp());
+    EXPECT_FALSE(basicProps.userId());
+
+    // Headers not selected are kept encoded rather than dropped
+    EXPECT_FALSE(basicProps.headers());
+    ASSERT_TRUE(basicProps.headersView());
+    rmqt::FieldValue value;
+    EXPECT_TRUE(basicProps.headersView()->find(&value, "trace"));
+    EXPECT_THAT(value, Eq(rmqt::FieldValue(bsl::string("abc"))));
+}
+
+TEST(Methods_BasicProperties, SkippingTruncatedPropertyFails)
+{
+    rmqt::Properties properties;
+    properties.contentType = "Content";
+
+    bsl::vector<uint8_t> data;
+    rmqamqpt::Writer writer(&data);
+    rmqamqpt::BasicProperties::encode(writer,
+                                      rmqamqpt::BasicProperties(properties));
+
+    rmqamqpt::BasicProperties basicProps;
+    EXPECT_FALSE(rmqamqpt::BasicProperties::decode(
+        &basicProps,
+        data.data(),
+        data.size() - 1,
+        false,
+        rmqt::MessageProperty::MESSAGE_ID));
+}
@@ -0,0 +1,76 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqamqpt_connectionblocked.h>
+
+#include <rmqamqp_framer.h>
+#include <rmqamqpt_connectionmethod.h>
+#include <rmqamqpt_frame.h>
+#include <rmqamqpt_method.h>
+
+#include <bsl_cstdint.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace ::testing;
+
+TEST(ConnectionBlocked, BlockedEncodeDecode)
+{
+    rmqamqpt::ConnectionBlocked blockedMethod("low on memory");
+
+    rmqamqpt::Frame frame;
+    rmqamqp::Framer::makeMethodFrame(
+        &frame, 0, rmqamqpt::ConnectionMethod(blockedMethod));
+
+    rmqamqp::Framer framer;
+    uint16_t channel;
+    rmqamqp::Message received;
+    EXPECT_THAT(framer.appendFrame(&channel, &received, frame),
+                Eq(rmqamqp::Framer::OK));
+
+    ASSERT_TRUE(received.is<rmqamqpt::Method>());
+    const rmqamqpt::Method& m = received.the<rmqamqpt::Method>();
+
+    ASSERT_TRUE(m.is<rmqamqpt::ConnectionMethod>());
+    const rmqamqpt::ConnectionMethod& cm = m.the<rmqamqpt::ConnectionMethod>();
+
+    ASSERT_TRUE(cm.is<rmqamqpt::ConnectionBlocked>());
+    EXPECT_THAT(cm.the<rmqamqpt::ConnectionBlocked>().reason(),
+                Eq("low on memory"));
+}
+
+TEST(ConnectionBlocked, UnblockedEncodeDecode)
+{
+    rmqamqpt::ConnectionUnblocked unblockedMethod;
+
+    rmqamqpt::Frame frame;
+    rmqamqp::Framer::makeMethodFrame(
+        &frame, 0, rmqamqpt::ConnectionMethod(unblockedMethod));
+
+    rmqamqp::Framer framer;
+    uint16_t channel;
+    rmqamqp::Message received;
+    EXPECT_THAT(framer.appendFrame(&channel, &received, frame),
+                Eq(rmqamqp::Framer::OK));
+
+    ASSERT_TRUE(received.is<rmqamqpt::Method>());
+    const rmqamqpt::Method& m = received.the<rmqamqpt::Method>();
+
+    ASSERT_TRUE(m.is<rmqamqpt::ConnectionMethod>());
+    EXPECT_TRUE(m.the<rmqamqpt::ConnectionMethod>()
+                    .is<rmqamqpt::ConnectionUnblocked>());
+}
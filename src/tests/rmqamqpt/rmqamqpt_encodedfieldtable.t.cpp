@@ -0,0 +1,162 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqamqpt_encodedfieldtable.h>
+
+#include <rmqamqpt_types.h>
+#include <rmqamqpt_writer.h>
+
+#include <rmqt_fieldvalue.h>
+
+#include <bdlb_bigendian.h>
+#include <bdlt_datetime.h>
+
+#include <bsl_algorithm.h>
+#include <bsl_cstdint.h>
+#include <bsl_memory.h>
+#include <bsl_string.h>
+#include <bsl_vector.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace ::testing;
+
+namespace {
+
+rmqt::FieldTable makeTable()
+{
+    bsl::shared_ptr<rmqt::FieldTable> nested =
+        bsl::make_shared<rmqt::FieldTable>();
+    (*nested)["depth"] = rmqt::FieldValue(int32_t(2));
+
+    bsl::shared_ptr<rmqt::FieldArray> array =
+        bsl::make_shared<rmqt::FieldArray>();
+    array->push_back(rmqt::FieldValue(bsl::string("element")));
+    array->push_back(rmqt::FieldValue(true));
+
+    rmqt::FieldTable table;
+    table["a-array"]  = rmqt::FieldValue(array);
+    table["b-bytes"]  = rmqt::FieldValue(bsl::vector<uint8_t>(
+        static_cast<bsl::size_t>(3), static_cast<uint8_t>(7)));
+    table["c-double"] = rmqt::FieldValue(1.5);
+    table["d-nested"] = rmqt::FieldValue(nested);
+    table["e-short"]  = rmqt::FieldValue(int16_t(-3));
+    table["f-time"]   = rmqt::FieldValue(bdlt::Datetime(2023, 1, 2, 3, 4, 5));
+    table["g-trace"]  = rmqt::FieldValue(bsl::string("abc"));
+    return table;
+}
+
+bsl::vector<uint8_t> encode(const rmqt::FieldTable& table)
+{
+    bsl::vector<uint8_t> data;
+    rmqamqpt::Writer writer(&data);
+    rmqamqpt::Types::encodeFieldTable(writer, table);
+    return data;
+}
+
+} // namespace
+
+TEST(EncodedFieldTable, FindsEachKey)
+{
+    const rmqt::FieldTable table     = makeTable();
+    const bsl::vector<uint8_t> data = encode(table);
+    rmqamqpt::EncodedFieldTable view(data.data(), data.size());
+
+    // Every key is found by skipping over the values in front of it
+    for (rmqt::FieldTable::const_iterator it = table.begin();
+         it != table.end();
+         ++it) {
+        rmqt::FieldValue value;
+        EXPECT_TRUE(view.find(&value, it->first)) << it->first;
+        EXPECT_THAT(value, Eq(it->second)) << it->first;
+    }
+}
+
+TEST(EncodedFieldTable, MissingKey)
+{
+    const bsl::vector<uint8_t> data = encode(makeTable());
+    rmqamqpt::EncodedFieldTable view(data.data(), data.size());
+
+    rmqt::FieldValue value;
+    EXPECT_FALSE(view.find(&value, "missing"));
+    EXPECT_FALSE(view.find(&value, "g-trac"));
+    EXPECT_FALSE(view.find(&value, "g-tracer"));
+}
+
+TEST(EncodedFieldTable, EmptyTable)
+{
+    const bsl::vector<uint8_t> data = encode(rmqt::FieldTable());
+    rmqamqpt::EncodedFieldTable view(data.data(), data.size());
+
+    rmqt::FieldValue value;
+    EXPECT_FALSE(view.find(&value, "key"));
+    ASSERT_TRUE(view.table());
+    EXPECT_TRUE(view.table()->empty());
+}
+
+TEST(EncodedFieldTable, TableIsDecodedOnce)
+{
+    const rmqt::FieldTable table     = makeTable();
+    const bsl::vector<uint8_t> data = encode(table);
+    rmqamqpt::EncodedFieldTable view(data.data(), data.size());
+
+    const bsl::shared_ptr<rmqt::FieldTable> decoded = view.table();
+    ASSERT_TRUE(decoded);
+    EXPECT_THAT(*decoded, Eq(table));
+    EXPECT_THAT(view.table(), Eq(decoded));
+}
+
+TEST(EncodedFieldTable, DataIsCopied)
+{
+    bsl::vector<uint8_t> data = encode(makeTable());
+    rmqamqpt::EncodedFieldTable view(data.data(), data.size());
+    bsl::fill(data.begin(), data.end(), static_cast<uint8_t>(0));
+
+    rmqt::FieldValue value;
+    EXPECT_TRUE(view.find(&value, "g-trace"));
+    EXPECT_THAT(value, Eq(rmqt::FieldValue(bsl::string("abc"))));
+}
+
+TEST(EncodedFieldTable, FirstDuplicateWins)
+{
+    bsl::vector<uint8_t> data;
+    rmqamqpt::Writer writer(&data);
+    rmqamqpt::Types::write(writer, bdlb::BigEndianUint32::make(12));
+    rmqamqpt::Types::encodeShortString(writer, "key");
+    rmqamqpt::Types::encodeFieldValue(writer, rmqt::FieldValue(uint8_t(1)));
+    rmqamqpt::Types::encodeShortString(writer, "key");
+    rmqamqpt::Types::encodeFieldValue(writer, rmqt::FieldValue(uint8_t(2)));
+
+    rmqamqpt::EncodedFieldTable view(data.data(), data.size());
+
+    rmqt::FieldValue value;
+    EXPECT_TRUE(view.find(&value, "key"));
+    EXPECT_THAT(value, Eq(rmqt::FieldValue(uint8_t(1))));
+    ASSERT_TRUE(view.table());
+    EXPECT_THAT((*view.table())["key"], Eq(rmqt::FieldValue(uint8_t(1))));
+}
+
+TEST(EncodedFieldTable, TruncatedTable)
+{
+    bsl::vector<uint8_t> data = encode(makeTable());
+    data.resize(data.size() - 1);
+    rmqamqpt::EncodedFieldTable view(data.data(), data.size());
+
+    rmqt::FieldValue value;
+    EXPECT_FALSE(view.find(&value, "a-array"));
+    EXPECT_FALSE(view.table());
+}
@@ -0,0 +1,111 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqamqpt_method.h>
+
+#include <rmqamqpt_basicack.h>
+#include <rmqamqpt_basicdeliver.h>
+#include <rmqamqpt_basicmethod.h>
+#include <rmqamqpt_confirmmethod.h>
+#include <rmqamqpt_confirmselectok.h>
+#include <rmqamqpt_connectionmethod.h>
+#include <rmqamqpt_connectionstart.h>
+#include <rmqamqpt_writer.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <bsl_cstdint.h>
+#include <bsl_vector.h>
+
+using namespace BloombergLP;
+using namespace ::testing;
+
+namespace {
+
+bsl::vector<uint8_t> encode(const rmqamqpt::Method& method)
+{
+    bsl::vector<uint8_t> buffer;
+    rmqamqpt::Writer writer(&buffer);
+    rmqamqpt::Method::Util::encode(writer, method);
+    return buffer;
+}
+
+bool decode(rmqamqpt::Method* method, const bsl::vector<uint8_t>& buffer)
+{
+    return rmqamqpt::Method::Util::decode(
+        method, buffer.data(), buffer.size());
+}
+
+} // namespace
+
+TEST(Method, DecodesHotMethodsFromTheDispatchTable)
+{
+    const bsl::vector<uint8_t> deliver = encode(rmqamqpt::BasicMethod(
+        rmqamqpt::BasicDeliver("tag", 42, false, "exchange", "key")));
+
+    rmqamqpt::Method method;
+    ASSERT_TRUE(decode(&method, deliver));
+    ASSERT_TRUE(method.is<rmqamqpt::BasicMethod>());
+    ASSERT_TRUE(
+        method.the<rmqamqpt::BasicMethod>().is<rmqamqpt::BasicDeliver>());
+    EXPECT_THAT(method.the<rmqamqpt::BasicMethod>()
+                    .the<rmqamqpt::BasicDeliver>()
+                    .deliveryTag(),
+                Eq(42));
+
+    ASSERT_TRUE(decode(
+        &method,
+        encode(rmqamqpt::BasicMethod(rmqamqpt::BasicAck(7, true)))));
+    ASSERT_TRUE(method.the<rmqamqpt::BasicMethod>().is<rmqamqpt::BasicAck>());
+}
+
+TEST(Method, DecodesFirstAndLastTableEntries)
+{
+    rmqamqpt::Method method;
+    ASSERT_TRUE(decode(&method,
+                       encode(rmqamqpt::ConnectionMethod(
+                           rmqamqpt::ConnectionStart()))));
+    EXPECT_TRUE(method.the<rmqamqpt::ConnectionMethod>()
+                    .is<rmqamqpt::ConnectionStart>());
+
+    ASSERT_TRUE(decode(&method,
+                       encode(rmqamqpt::ConfirmMethod(
+                           rmqamqpt::ConfirmSelectOk()))));
+    EXPECT_TRUE(method.the<rmqamqpt::ConfirmMethod>()
+                    .is<rmqamqpt::ConfirmSelectOk>());
+}
+
+TEST(Method, UnknownMethodsFailToDecode)
+{
+    // basic.get (60, 70) and tx.select (90, 10) are not supported
+    const uint8_t basicGet[] = {0, 60, 0, 70};
+    const uint8_t txSelect[] = {0, 90, 0, 10};
+
+    rmqamqpt::Method method;
+    EXPECT_FALSE(rmqamqpt::Method::Util::decode(
+        &method, basicGet, sizeof(basicGet)));
+    EXPECT_FALSE(rmqamqpt::Method::Util::decode(
+        &method, txSelect, sizeof(txSelect)));
+}
+
+TEST(Method, TruncatedIdsFailToDecode)
+{
+    const uint8_t classIdOnly[] = {0, 60};
+
+    rmqamqpt::Method method;
+    EXPECT_FALSE(rmqamqpt::Method::Util::decode(
+        &method, classIdOnly, sizeof(classIdOnly)));
+}
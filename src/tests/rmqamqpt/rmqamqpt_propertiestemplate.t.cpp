@@ -0,0 +1,150 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqamqpt_propertiestemplate.h>
+
+#include <rmqamqpt_basicproperties.h>
+#include <rmqamqpt_writer.h>
+
+#include <rmqt_fieldvalue.h>
+#include <rmqt_properties.h>
+
+#include <bdlt_datetime.h>
+
+#include <bsl_memory.h>
+#include <bsl_string.h>
+#include <bsl_vector.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace ::testing;
+
+namespace {
+
+rmqt::Properties makeProperties()
+{
+    rmqt::Properties properties;
+    properties.contentType  = "application/json";
+    properties.headers      = bsl::make_shared<rmqt::FieldTable>();
+    properties.deliveryMode = 2;
+    properties.replyTo      = "reply-queue";
+    properties.messageId    = "id-1";
+    properties.timestamp    = bdlt::Datetime(2023, 1, 2, 3, 4, 5);
+    properties.appId        = "producer";
+
+    bsl::shared_ptr<rmqt::FieldTable> nested =
+        bsl::make_shared<rmqt::FieldTable>();
+    (*nested)["depth"] = rmqt::FieldValue(int32_t(2));
+
+    (*properties.headers)["trace"]  = rmqt::FieldValue(bsl::string("abc"));
+    (*properties.headers)["nested"] = rmqt::FieldValue(nested);
+    return properties;
+}
+
+bsl::vector<uint8_t> encode(const rmqt::Properties& properties)
+{
+    bsl::vector<uint8_t> data;
+    rmqamqpt::Writer writer(&data);
+    rmqamqpt::BasicProperties::encode(
+        writer, rmqamqpt::BasicProperties(properties));
+    return data;
+}
+
+bsl::vector<uint8_t> encode(const rmqamqpt::PropertiesTemplate& tmpl,
+                            const rmqt::Properties& properties)
+{
+    bsl::vector<uint8_t> data;
+    rmqamqpt::Writer writer(&data);
+    tmpl.encode(writer, properties);
+    return data;
+}
+
+} // namespace
+
+TEST(PropertiesTemplate, EncodesAsBasicProperties)
+{
+    rmqt::Properties properties = makeProperties();
+    rmqamqpt::PropertiesTemplate tmpl(properties);
+
+    EXPECT_THAT(encode(tmpl, properties), Eq(encode(properties)));
+    EXPECT_THAT(tmpl.encodedSize(properties),
+                Eq(rmqamqpt::BasicProperties(properties).encodedSize()));
+}
+
+TEST(PropertiesTemplate, PatchesIdAndTimestamp)
+{
+    rmqt::Properties properties = makeProperties();
+    rmqamqpt::PropertiesTemplate tmpl(properties);
+
+    properties.messageId = "a-much-longer-message-id";
+    properties.timestamp = bdlt::Datetime(2024, 6, 7, 8, 9, 10);
+    EXPECT_TRUE(tmpl.matches(properties));
+    EXPECT_THAT(encode(tmpl, properties), Eq(encode(properties)));
+    EXPECT_THAT(tmpl.encodedSize(properties),
+                Eq(encode(properties).size()));
+
+    properties.messageId.reset();
+    properties.timestamp.reset();
+    EXPECT_TRUE(tmpl.matches(properties));
+    EXPECT_THAT(encode(tmpl, properties), Eq(encode(properties)));
+    EXPECT_THAT(tmpl.encodedSize(properties),
+                Eq(encode(properties).size()));
+}
+
+TEST(PropertiesTemplate, EncodesEmptyProperties)
+{
+    const rmqt::Properties properties;
+    rmqamqpt::PropertiesTemplate tmpl(properties);
+
+    EXPECT_TRUE(tmpl.matches(properties));
+    EXPECT_THAT(encode(tmpl, properties), Eq(encode(properties)));
+}
+
+TEST(PropertiesTemplate, DoesNotMatchChangedStaticProperties)
+{
+    const rmqt::Properties properties = makeProperties();
+    rmqamqpt::PropertiesTemplate tmpl(properties);
+
+    rmqt::Properties changed = properties;
+    changed.appId            = "another-producer";
+    EXPECT_FALSE(tmpl.matches(changed));
+
+    changed         = properties;
+    changed.headers = bsl::shared_ptr<rmqt::FieldTable>();
+    EXPECT_FALSE(tmpl.matches(changed));
+
+    changed.headers = bsl::make_shared<rmqt::FieldTable>(*properties.headers);
+    EXPECT_TRUE(tmpl.matches(changed));
+
+    (*changed.headers)["trace"] = rmqt::FieldValue(bsl::string("def"));
+    EXPECT_FALSE(tmpl.matches(changed));
+}
+
+TEST(PropertiesTemplate, UnaffectedByLaterChangesToHeaders)
+{
+    rmqt::Properties properties = makeProperties();
+    rmqamqpt::PropertiesTemplate tmpl(properties);
+    const bsl::vector<uint8_t> encoded = encode(tmpl, properties);
+
+    properties.headers->at("nested")
+        .the<bsl::shared_ptr<rmqt::FieldTable> >()
+        ->insert(bsl::make_pair(bsl::string("extra"),
+                                rmqt::FieldValue(true)));
+
+    EXPECT_FALSE(tmpl.matches(properties));
+    EXPECT_THAT(encode(tmpl, properties), Eq(encoded));
+}
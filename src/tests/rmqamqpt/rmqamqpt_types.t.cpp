@@ -18,9 +18,12 @@
 
 #include <rmqamqpt_buffer.h>
 #include <rmqt_fieldvalue.h>
+#include <rmqt_flatfieldtable.h>
 
 #include <bdlb_bigendian.h>
 #include <bdlt_datetime.h>
+#include <bslma_defaultallocatorguard.h>
+#include <bslma_testallocator.h>
 
 #include <bsl_cstring.h>
 #include <bsl_iostream.h>
@@ -605,6 +608,171 @@ TEST(TypesEncoding, EmptyFieldTable)
     EXPECT_EQ(str[3], 0);
 }
 
+TEST(TypesEncoding, ShouldRoundTripLargeFieldTableCorrectly)
+{
+    rmqt::FieldTable table;
+    for (int i = 0; i < 60; ++i) {
+        bsl::string key("x-trace-header-");
+        key += static_cast<char>('A' + i % 26);
+        key += static_cast<char>('a' + i / 26);
+        switch (i % 4) {
+            case 0:
+                table[key] = rmqt::FieldValue(bsl::string(i, 'v'));
+                break;
+            case 1:
+                table[key] = rmqt::FieldValue(int64_t(i) << 40);
+                break;
+            case 2:
+                table[key] = rmqt::FieldValue(bsl::vector<uint8_t>(
+                    static_cast<bsl::size_t>(i), uint8_t(0xab)));
+                break;
+            default: {
+                bsl::shared_ptr<rmqt::FieldArray> array =
+                    bsl::make_shared<rmqt::FieldArray>();
+                array->push_back(rmqt::FieldValue(int32_t(i)));
+                array->push_back(rmqt::FieldValue(bsl::string("x")));
+                table[key] = rmqt::FieldValue(array);
+            }
+        }
+    }
+
+    BufferType storage;
+    rmqamqpt::Writer writer(&storage);
+    rmqamqpt::Types::encodeFieldTable(writer, table);
+
+    rmqt::FieldTable decoded;
+    Buffer buffer(storage.data(), storage.size());
+    EXPECT_TRUE(rmqamqpt::Types::decodeFieldTable(&decoded, &buffer));
+    EXPECT_THAT(buffer.available(), Eq(0));
+    EXPECT_THAT(decoded, Eq(table));
+}
+
+TEST(TypesEncoding, FlatFieldTableEncodesAsFieldTable)
+{
+    rmqt::FieldTable table;
+    table["zeta"]  = rmqt::FieldValue(bsl::string("last"));
+    table["alpha"] = rmqt::FieldValue(int32_t(-7));
+    table["mid"]   = rmqt::FieldValue(bsl::vector<uint8_t>(
+        static_cast<bsl::size_t>(5), uint8_t(0xab)));
+
+    BufferType expected;
+    rmqamqpt::Writer expectedWriter(&expected);
+    rmqamqpt::Types::encodeFieldTable(expectedWriter, table);
+
+    BufferType storage;
+    rmqamqpt::Writer writer(&storage);
+    rmqamqpt::Types::encodeFieldTable(writer, rmqt::FlatFieldTable(table));
+    EXPECT_THAT(storage, Eq(expected));
+
+    rmqt::FlatFieldTable decoded;
+    Buffer buffer(storage.data(), storage.size());
+    EXPECT_TRUE(rmqamqpt::Types::decodeFieldTable(&decoded, &buffer));
+    EXPECT_THAT(buffer.available(), Eq(0));
+    EXPECT_THAT(decoded, Eq(rmqt::FlatFieldTable(table)));
+}
+
+TEST(TypesEncoding, FlatFieldTableDecodesWithTableAllocator)
+{
+    rmqt::FieldTable table;
+    for (int i = 0; i < 20; ++i) {
+        bsl::string key("x-header-");
+        key += static_cast<char>('a' + i);
+        table[key] = i % 2 ? rmqt::FieldValue(bsl::string(40, 'v'))
+                           : rmqt::FieldValue(int64_t(i));
+    }
+
+    BufferType storage;
+    rmqamqpt::Writer writer(&storage);
+    rmqamqpt::Types::encodeFieldTable(writer, table);
+
+    bslma::TestAllocator defaultAllocator;
+    bslma::DefaultAllocatorGuard guard(&defaultAllocator);
+
+    bslma::TestAllocator tableAllocator;
+    rmqt::FlatFieldTable decoded(&tableAllocator);
+    Buffer buffer(storage.data(), storage.size());
+    EXPECT_TRUE(rmqamqpt::Types::decodeFieldTable(&decoded, &buffer));
+
+    EXPECT_THAT(decoded.size(), Eq(table.size()));
+    EXPECT_THAT(defaultAllocator.numAllocations(), Eq(0));
+    // One block for the entries, plus the long string values
+    EXPECT_THAT(tableAllocator.numAllocations(), Eq(1 + 10));
+}
+
+TEST(TypesFieldTableDecode, FlatFieldTableKeepsFirstDuplicate)
+{
+    BufferType storage;
+    rmqamqpt::Writer writer(&storage);
+    rmqamqpt::Types::write(writer, bdlb::BigEndianUint32::make(12));
+    rmqamqpt::Types::encodeShortString(writer, "key");
+    rmqamqpt::Types::encodeFieldValue(writer, rmqt::FieldValue(uint8_t(1)));
+    rmqamqpt::Types::encodeShortString(writer, "key");
+    rmqamqpt::Types::encodeFieldValue(writer, rmqt::FieldValue(uint8_t(2)));
+
+    rmqt::FlatFieldTable decoded;
+    Buffer buffer(storage.data(), storage.size());
+    EXPECT_TRUE(rmqamqpt::Types::decodeFieldTable(&decoded, &buffer));
+    ASSERT_THAT(decoded.size(), Eq(1));
+    EXPECT_THAT(*decoded.find("key"), Eq(rmqt::FieldValue(uint8_t(1))));
+}
+
+TEST(TypesEncoding, WriterOverwritesFromStartOffset)
+{
+    BufferType storage(4, 0xff);
+    rmqamqpt::Writer writer(&storage, 1);
+    rmqamqpt::Types::write(writer, bdlb::BigEndianUint16::make(0x0102));
+    rmqamqpt::Types::write(writer, bdlb::BigEndianUint16::make(0x0304));
+
+    const uint8_t expected[] = {0xff, 0x01, 0x02, 0x03, 0x04};
+    EXPECT_THAT(storage, ElementsAreArray(expected));
+}
+
+TEST(TypesEncoding, WriterFillsFixedBuffer)
+{
+    uint8_t buffer[6] = {0};
+    rmqamqpt::Writer writer(buffer, sizeof(buffer));
+    rmqamqpt::Types::write(writer, bdlb::BigEndianUint32::make(0));
+    rmqamqpt::Types::write(writer, bdlb::BigEndianUint16::make(0x0506));
+    EXPECT_THAT(writer.offset(), Eq(sizeof(buffer)));
+
+    const bdlb::BigEndianUint32 patch =
+        bdlb::BigEndianUint32::make(0x01020304);
+    writer.overwrite(
+        0, reinterpret_cast<const uint8_t*>(&patch), sizeof(patch));
+
+    const uint8_t expected[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06};
+    EXPECT_THAT(buffer, ElementsAreArray(expected));
+}
+
+TEST(TypesEncoding, EncodedTableSizeMatchesTruncatedKeys)
+{
+    rmqt::FieldTable inner;
+    inner[bsl::string(300, 'k')] = rmqt::FieldValue(bsl::string("v"));
+
+    rmqt::FieldTable table;
+    table["nested"] = rmqt::FieldValue(
+        bsl::make_shared<rmqt::FieldTable>(inner));
+
+    const bsl::size_t size = FieldValueUtil::encodedTableSize(table);
+
+    BufferType storage(sizeof(bdlb::BigEndianUint32) + size);
+    rmqamqpt::Writer writer(storage.data(), storage.size());
+    rmqamqpt::Types::encodeFieldTable(writer, table);
+    EXPECT_THAT(writer.offset(), Eq(storage.size()));
+
+    rmqt::FieldTable decoded;
+    Buffer buffer(storage.data(), storage.size());
+    EXPECT_TRUE(rmqamqpt::Types::decodeFieldTable(&decoded, &buffer));
+    EXPECT_THAT(buffer.available(), Eq(0));
+
+    rmqt::FieldTable truncated;
+    truncated[bsl::string(255, 'k')] = rmqt::FieldValue(bsl::string("v"));
+    rmqt::FieldTable expected;
+    expected["nested"] = rmqt::FieldValue(
+        bsl::make_shared<rmqt::FieldTable>(truncated));
+    EXPECT_THAT(decoded, Eq(expected));
+}
+
 TEST(TypesEncoding, Timestamp)
 {
     const bdlt::Datetime millennium(2000, 1, 1);
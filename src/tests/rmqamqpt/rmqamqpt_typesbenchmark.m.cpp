@@ -0,0 +1,130 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Microbenchmark for FieldTable encoding & decoding, for tables shaped like
+// the routing & tracing headers carried by headers-heavy messages.
+//
+// Usage: rmqamqpt_typesbenchmark [iterations]
+
+#include <rmqamqpt_buffer.h>
+#include <rmqamqpt_types.h>
+#include <rmqamqpt_writer.h>
+
+#include <rmqt_fieldvalue.h>
+#include <rmqt_flatfieldtable.h>
+
+#include <bdlma_localsequentialallocator.h>
+#include <bsls_stopwatch.h>
+
+#include <bsl_cstdint.h>
+#include <bsl_cstdlib.h>
+#include <bsl_iostream.h>
+#include <bsl_sstream.h>
+#include <bsl_string.h>
+#include <bsl_vector.h>
+
+using namespace BloombergLP;
+
+namespace {
+
+rmqt::FieldTable makeHeaders(int numHeaders)
+{
+    rmqt::FieldTable headers;
+    for (int i = 0; i < numHeaders; ++i) {
+        bsl::ostringstream key;
+        key << "x-header-" << i;
+        switch (i % 3) {
+            case 0:
+                headers[key.str()] = rmqt::FieldValue(
+                    bsl::string("00-4bf92f3577b34da6a3ce929d0e0e4736-01"));
+                break;
+            case 1:
+                headers[key.str()] = rmqt::FieldValue(int64_t(i) << 40);
+                break;
+            default:
+                headers[key.str()] = rmqt::FieldValue(int32_t(i));
+        }
+    }
+    return headers;
+}
+
+void benchmark(int numHeaders, int iterations)
+{
+    const rmqt::FieldTable headers = makeHeaders(numHeaders);
+
+    bsl::vector<uint8_t> encoded;
+    bsls::Stopwatch stopwatch;
+
+    stopwatch.start();
+    for (int i = 0; i < iterations; ++i) {
+        encoded.clear();
+        rmqamqpt::Writer writer(&encoded);
+        rmqamqpt::Types::encodeFieldTable(writer, headers);
+    }
+    stopwatch.stop();
+    const double encodeSeconds = stopwatch.elapsedTime();
+
+    stopwatch.reset();
+    stopwatch.start();
+    for (int i = 0; i < iterations; ++i) {
+        rmqt::FieldTable decoded;
+        rmqamqpt::Buffer buffer(encoded.data(), encoded.size());
+        if (!rmqamqpt::Types::decodeFieldTable(&decoded, &buffer)) {
+            bsl::cerr << "Failed to decode table\n";
+            bsl::exit(1);
+        }
+    }
+    stopwatch.stop();
+    const double decodeSeconds = stopwatch.elapsedTime();
+
+    stopwatch.reset();
+    stopwatch.start();
+    for (int i = 0; i < iterations; ++i) {
+        // Decode into a stack arena, as a consumer reading headers would
+        bdlma::LocalSequentialAllocator<16384> arena;
+        rmqt::FlatFieldTable decoded(&arena);
+        rmqamqpt::Buffer buffer(encoded.data(), encoded.size());
+        if (!rmqamqpt::Types::decodeFieldTable(&decoded, &buffer)) {
+            bsl::cerr << "Failed to decode flat table\n";
+            bsl::exit(1);
+        }
+    }
+    stopwatch.stop();
+    const double flatDecodeSeconds = stopwatch.elapsedTime();
+
+    bsl::cout << numHeaders << " headers (" << encoded.size()
+              << " bytes): encode " << encodeSeconds * 1e9 / iterations
+              << " ns, decode " << decodeSeconds * 1e9 / iterations
+              << " ns, flat decode " << flatDecodeSeconds * 1e9 / iterations
+              << " ns\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const int iterations = argc > 1 ? bsl::atoi(argv[1]) : 100000;
+    if (iterations <= 0) {
+        bsl::cerr << "Usage: " << argv[0] << " [iterations]\n";
+        return 1;
+    }
+
+    const int tableSizes[] = {1, 10, 30, 60};
+    for (bsl::size_t i = 0; i < sizeof(tableSizes) / sizeof(tableSizes[0]);
+         ++i) {
+        benchmark(tableSizes[i], iterations);
+    }
+    return 0;
+}
@@ -17,6 +17,7 @@
 
 #include <rmqio_asioeventloop.h>
 #include <rmqio_asiosocketwrapper.h>
+#include <rmqio_connectionoptions.h>
 
 #include <rmqt_result.h>
 
@@ -30,6 +31,7 @@
 #include <bsl_cstdio.h>
 #include <bsl_functional.h>
 #include <bsl_iostream.h>
+#include <bsl_limits.h>
 #include <bsl_memory.h>
 #include <bsl_vector.h>
 
@@ -84,12 +86,31 @@ class TestableAsioConnection : public AsioConnection<AsioSocket> {
     }
 
     bool proxyDoRead(size_t bytes_transferred)
+    {
+        prepareBuffer();
+        const bool success = doRead(bytes_transferred);
+        handReadFrames(bsl::numeric_limits<bsl::size_t>::max());
+        return success;
+    }
+
+    bool proxyDecodeOnly(size_t bytes_transferred)
     {
         prepareBuffer();
         return doRead(bytes_transferred);
     }
+
+    bool proxyHandReadFrames(bsl::size_t limit)
+    {
+        return handReadFrames(limit);
+    }
     void proxyDoClose(Connection::ReturnCode rc) { doClose(rc); }
 
+    void proxyHandDecodedFrames(const bsl::vector<rmqamqpt::Frame>& frames,
+                                bool success)
+    {
+        handDecodedFrames(frames, success);
+    }
+
     void proxyHandleReadError(const boost::system::error_code& error)
     {
         handleReadError(error);
@@ -234,6 +255,27 @@ TEST_F(TestConnection, MultipleReads)
         Eq(FRAME_COUNT * NUMBER_OF_READS)); // we passed all the frames upstream
 }
 
+TEST_F(TestConnection, HandsFramesOnWithinBudget)
+{
+    const bsl::size_t FRAME_COUNT = 5;
+
+    EXPECT_CALL(*d_decoder, appendBytes(_, _, _))
+        .WillOnce(
+            Invoke(d_decoder.ptr(), &MockDecoder::getVector<FRAME_COUNT>));
+
+    EXPECT_TRUE(d_connection->proxyDecodeOnly(50));
+    EXPECT_THAT(d_callbacks.consumeCount, Eq(0));
+
+    EXPECT_FALSE(d_connection->proxyHandReadFrames(2));
+    EXPECT_THAT(d_callbacks.consumeCount, Eq(2));
+
+    EXPECT_FALSE(d_connection->proxyHandReadFrames(2));
+    EXPECT_THAT(d_callbacks.consumeCount, Eq(4));
+
+    EXPECT_TRUE(d_connection->proxyHandReadFrames(2));
+    EXPECT_THAT(d_callbacks.consumeCount, Eq(FRAME_COUNT));
+}
+
 TEST_F(TestConnection, ShutdownOnBadFrame)
 {
 
@@ -255,6 +297,16 @@ TEST_F(TestConnection, SomeGoodFramesSomeBad)
                 Eq(1)); // we processed one frame before the decode error
 }
 
+TEST_F(TestConnection, HandsOnPoolDecodedFramesBeforeABadOne)
+{
+    d_connection->proxyHandDecodedFrames(bsl::vector<rmqamqpt::Frame>(3),
+                                         false);
+
+    EXPECT_THAT(d_callbacks.consumeCount, Eq(3));
+    EXPECT_THAT(d_callbacks.errorCount, Eq(1));
+    EXPECT_THAT(d_callbacks.lastErrorCode, Eq(Connection::FRAME_ERROR));
+}
+
 TEST_F(TestConnection, SocketSnap)
 {
     d_connection->proxyHandleReadError(boost::asio::error::make_error_code(
@@ -332,3 +384,67 @@ TEST_F(AsioConnectionTests, DestructSocketCountsAsGracefulClose)
     EXPECT_THAT(d_mockCallbacks.lastErrorCode,
                 Eq(rmqio::Connection::GRACEFUL_DISCONNECT));
 }
+
+TEST(ConnectionOptionsTests, DefaultsToAsioGatherLimits)
+{
+    ConnectionOptions options;
+
+    EXPECT_THAT(options.maxCoalescedWriteBuffers(),
+                Eq(ConnectionOptions::k_DEFAULT_MAX_COALESCED_WRITE_BUFFERS));
+    EXPECT_THAT(options.maxCoalescedWriteBytes(),
+                Eq(ConnectionOptions::k_DEFAULT_MAX_COALESCED_WRITE_BYTES));
+}
+
+TEST(ConnectionOptionsTests, SetWriteCoalescing)
+{
+    ConnectionOptions options;
+    options.setWriteCoalescing(4096, 1);
+
+    EXPECT_THAT(options.maxCoalescedWriteBytes(), Eq(4096));
+    EXPECT_THAT(options.maxCoalescedWriteBuffers(), Eq(1));
+}
+
+TEST(ConnectionOptionsTests, DeferWritesOffByDefault)
+{
+    ConnectionOptions options;
+    EXPECT_FALSE(options.deferWrites());
+
+    options.setDeferWrites(true);
+    EXPECT_TRUE(options.deferWrites());
+}
+
+TEST(ConnectionOptionsTests, ReadFrameBudgetUnboundedByDefault)
+{
+    ConnectionOptions options;
+    EXPECT_THAT(options.readFrameBudget(), Eq(0));
+
+    options.setReadFrameBudget(64);
+    EXPECT_THAT(options.readFrameBudget(), Eq(64));
+}
+
+TEST(ConnectionOptionsTests, BusyPollOffByDefault)
+{
+    ConnectionOptions options;
+    EXPECT_THAT(options.busyPollMicroseconds(), Eq(0));
+
+    options.setBusyPoll(50);
+    EXPECT_THAT(options.busyPollMicroseconds(), Eq(50));
+}
+
+TEST_F(AsioConnectionTests, ConstructWithConnectionOptions)
+{
+    ConnectionOptions options;
+    options.setWriteCoalescing(1024, 4);
+
+    rmqio::AsioConnection<AsioSocket> conn(
+        bsl::make_shared<AsioSocket>(d_eventLoop.get_executor()),
+        d_callbacks,
+        bslma::ManagedPtr<Decoder>(new MockDecoder()),
+        options);
+
+    conn.close(bdlf::BindUtil::bind(&TestConnection::Callbacks::doneCallback,
+                                    &d_mockCallbacks,
+                                    bdlf::PlaceHolders::_1));
+
+    EXPECT_THAT(d_mockCallbacks.doneCount, Eq(1));
+}
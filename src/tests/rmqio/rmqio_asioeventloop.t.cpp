@@ -22,9 +22,13 @@
 #include <bslmt_condition.h>
 #include <bslmt_lockguard.h>
 #include <bslmt_mutex.h>
+#include <bslmt_threadattributes.h>
+#include <bslmt_threadutil.h>
+#include <bsls_timeinterval.h>
 
 #include <bsl_iostream.h>
 #include <bsl_memory.h>
+#include <bsl_vector.h>
 
 using namespace BloombergLP;
 using namespace rmqio;
@@ -69,6 +73,217 @@ TEST(AsioEventLoop, ExecuteTask)
     EXPECT_EQ(true, bp);
 }
 
+TEST(AsioEventLoop, BusyPollExecutesTasks)
+{
+    bool first  = false;
+    bool second = false;
+
+    {
+        AsioEventLoop loop(bsls::TimeInterval(0, 1000 * 1000));
+        loop.post(bdlf::BindUtil::bind(&setBoolToTrue, bsl::ref(first)));
+        loop.start();
+        loop.postF<void>(bdlf::BindUtil::bind(&setBoolToTrue,
+                                              bsl::ref(second)))
+            .blockResult();
+
+        // Counters are final once the loop thread has exited
+        ASSERT_TRUE(loop.waitForEventLoopExit(5));
+        const EventLoop::BusyPollStats stats = loop.busyPollStats();
+        EXPECT_GE(stats.spinHandlers + stats.blockingWakeups, 2);
+    }
+
+    EXPECT_TRUE(first);
+    EXPECT_TRUE(second);
+}
+
+TEST(AsioEventLoop, BlockingLoopReportsNoBusyPollStats)
+{
+    AsioEventLoop loop;
+    loop.start();
+
+    const EventLoop::BusyPollStats stats = loop.busyPollStats();
+    EXPECT_EQ(0, stats.idleSpinNanoseconds);
+    EXPECT_EQ(0, stats.spinHandlers);
+    EXPECT_EQ(0, stats.blockingWakeups);
+}
+
+namespace {
+void runContext(boost::asio::io_context* context) { context->run(); }
+
+void checkDispatchRunsInline(AsioEventLoop* loop, bool* ranInline)
+{
+    bool ran = false;
+    loop->dispatch(bdlf::BindUtil::bind(&setBoolToTrue, bsl::ref(ran)));
+    *ranInline = ran;
+}
+} // namespace
+
+TEST(AsioEventLoop, RunsOnApplicationContext)
+{
+    boost::asio::io_context context;
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type>
+        workGuard(boost::asio::make_work_guard(context));
+    bslmt::ThreadUtil::Handle thread;
+    ASSERT_EQ(0,
+              bslmt::ThreadUtil::create(
+                  &thread, bdlf::BindUtil::bind(&runContext, &context)));
+
+    bool ranInline = false;
+    {
+        AsioEventLoop loop(context);
+        loop.start();
+        loop.postF<void>(bdlf::BindUtil::bind(
+                             &checkDispatchRunsInline, &loop, &ranInline))
+            .blockResult();
+        EXPECT_TRUE(loop.waitForEventLoopExit(5));
+    }
+    EXPECT_TRUE(ranInline);
+
+    // The context is still the application's to stop
+    EXPECT_FALSE(context.stopped());
+    workGuard.reset();
+    bslmt::ThreadUtil::join(thread);
+}
+
+TEST(AsioEventLoop, DrivenLoopRunsOnlyWhenPolled)
+{
+    bool first  = false;
+    bool second = false;
+
+    {
+        bsl::shared_ptr<AsioEventLoop> loop = AsioEventLoop::makeDriven();
+        loop->start();
+
+        loop->post(bdlf::BindUtil::bind(&setBoolToTrue, bsl::ref(first)));
+        EXPECT_FALSE(first);
+        EXPECT_GE(loop->poll(), 1u);
+        EXPECT_TRUE(first);
+
+        // Left for the destructor, which runs the loop until it is out of
+        // work
+        loop->post(bdlf::BindUtil::bind(&setBoolToTrue, bsl::ref(second)));
+    }
+
+    EXPECT_TRUE(second);
+}
+
+TEST(AsioEventLoop, ThreadedLoopCannotBePolled)
+{
+    AsioEventLoop loop;
+    loop.start();
+
+    EXPECT_EQ(0u, loop.poll());
+    EXPECT_EQ(0u, loop.runFor(bsls::TimeInterval(0, 1000)));
+}
+
+namespace {
+void appendValue(bsl::vector<int>& values, int value)
+{
+    values.push_back(value);
+}
+} // namespace
+
+TEST(AsioEventLoop, PostsStayInOrderWhenSubmissionQueueOverflows)
+{
+    bsl::vector<int> values;
+
+    {
+        // Capacity 2: most of these posts bypass the submission queue
+        AsioEventLoop loop(bsls::TimeInterval(), 2);
+        for (int i = 0; i < 10; ++i) {
+            loop.post(
+                bdlf::BindUtil::bind(&appendValue, bsl::ref(values), i));
+        }
+        loop.start();
+        for (int i = 10; i < 20; ++i) {
+            loop.post(
+                bdlf::BindUtil::bind(&appendValue, bsl::ref(values), i));
+        }
+    }
+
+    ASSERT_EQ(20, values.size());
+    for (int i = 0; i < 20; ++i) {
+        EXPECT_EQ(i, values[i]);
+    }
+}
+
+namespace {
+void sleepMicroseconds(int microseconds)
+{
+    bslmt::ThreadUtil::microSleep(microseconds);
+}
+} // namespace
+
+TEST(AsioEventLoop, TrackedLoopReportsLoad)
+{
+    AsioEventLoop loop(bsls::TimeInterval(),
+                       AsioEventLoop::k_DEFAULT_POST_QUEUE_CAPACITY,
+                       bsls::TimeInterval(),
+                       true);
+    loop.start();
+
+    bool done = false;
+    loop.post(bdlf::BindUtil::bind(&sleepMicroseconds, 2000));
+    loop.postF<void>(bdlf::BindUtil::bind(&setBoolToTrue, bsl::ref(done)))
+        .blockResult();
+    EXPECT_TRUE(done);
+
+    // Counters are final once the loop thread has exited
+    ASSERT_TRUE(loop.waitForEventLoopExit(5));
+    const EventLoop::LoadStats stats = loop.loadStats();
+    EXPECT_EQ(0, stats.pendingPosts);
+    EXPECT_GE(stats.iterations, 1);
+    EXPECT_GE(stats.postedNanoseconds, 2000 * 1000);
+
+    // The maximum is reset by each read
+    EXPECT_EQ(0, loop.loadStats().maxIterationNanoseconds);
+}
+
+TEST(AsioEventLoop, UntrackedLoopReportsNoLoad)
+{
+    AsioEventLoop loop;
+    loop.start();
+
+    const EventLoop::LoadStats stats = loop.loadStats();
+    EXPECT_EQ(0, stats.iterations);
+    EXPECT_EQ(0, stats.postedNanoseconds);
+    EXPECT_EQ(0, stats.ioNanoseconds);
+}
+
+TEST(AsioEventLoop, PostsWithoutSubmissionQueue)
+{
+    bool bp = false;
+
+    {
+        AsioEventLoop loop(bsls::TimeInterval(), 0);
+        loop.post(bdlf::BindUtil::bind(&setBoolToTrue, bsl::ref(bp)));
+        loop.start();
+    }
+
+    EXPECT_TRUE(bp);
+}
+
+TEST(AsioEventLoop, StartWithThreadAttributes)
+{
+    bool bp = false;
+
+    {
+        bslmt::ThreadAttributes attributes;
+        attributes.setStackSize(1024 * 1024);
+        attributes.setThreadName("TEST.EVENTLOOP");
+
+        bsl::vector<int> cpus;
+        cpus.push_back(0);
+
+        AsioEventLoop loop;
+        loop.post(bdlf::BindUtil::bind(&setBoolToTrue, bsl::ref(bp)));
+        loop.start(attributes, cpus);
+        EXPECT_TRUE(loop.isStarted());
+    }
+
+    EXPECT_TRUE(bp);
+}
+
 namespace {
 void waitForCondition(bslmt::Mutex& mutex, bslmt::Condition& condition)
 {
@@ -0,0 +1,76 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqio_coarseclock.h>
+
+#include <bdlt_currenttime.h>
+#include <bdlt_datetime.h>
+#include <bslmt_threadutil.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqio;
+using namespace ::testing;
+
+namespace {
+class CoarseClockTests : public ::testing::Test {
+  public:
+    ~CoarseClockTests() { CoarseClock::setEnabled(false); }
+};
+} // namespace
+
+TEST_F(CoarseClockTests, DisabledByDefault)
+{
+    EXPECT_FALSE(CoarseClock::isEnabled());
+}
+
+TEST_F(CoarseClockTests, DisabledReadsSystemClock)
+{
+    const bdlt::Datetime before = bdlt::CurrentTime::utc();
+    bslmt::ThreadUtil::microSleep(1000);
+    const bdlt::Datetime now = CoarseClock::utc();
+
+    EXPECT_THAT(now, Gt(before));
+}
+
+TEST_F(CoarseClockTests, EnabledHoldsUntilTick)
+{
+    const bdlt::Datetime before = bdlt::CurrentTime::utc();
+    CoarseClock::setEnabled(true);
+
+    const bdlt::Datetime first = CoarseClock::utc();
+    EXPECT_THAT(first, Ge(before));
+
+    bslmt::ThreadUtil::microSleep(2000);
+    EXPECT_THAT(CoarseClock::utc(), Eq(first));
+
+    CoarseClock::tick();
+    EXPECT_THAT(CoarseClock::utc(), Gt(first));
+}
+
+TEST_F(CoarseClockTests, TickIsMonotonic)
+{
+    CoarseClock::setEnabled(true);
+
+    bdlt::Datetime last = CoarseClock::utc();
+    for (int i = 0; i < 100; ++i) {
+        CoarseClock::tick();
+        const bdlt::Datetime now = CoarseClock::utc();
+        EXPECT_THAT(now, Ge(last));
+        last = now;
+    }
+}
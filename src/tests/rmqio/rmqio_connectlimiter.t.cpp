@@ -0,0 +1,58 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqio_connectlimiter.h>
+
+#include <bsls_timeinterval.h>
+
+#include <bsl_algorithm.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqio;
+using namespace ::testing;
+
+TEST(ConnectLimiter, HandsOutAtMostMaxConcurrentPermits)
+{
+    ConnectLimiter limiter(2);
+
+    EXPECT_TRUE(limiter.tryAcquire());
+    EXPECT_TRUE(limiter.tryAcquire());
+    EXPECT_FALSE(limiter.tryAcquire());
+    EXPECT_THAT(limiter.inProgress(), Eq(2));
+
+    limiter.release();
+    EXPECT_THAT(limiter.inProgress(), Eq(1));
+    EXPECT_TRUE(limiter.tryAcquire());
+    EXPECT_FALSE(limiter.tryAcquire());
+}
+
+TEST(ConnectLimiter, RetryIntervalsAreSpreadOut)
+{
+    ConnectLimiter limiter(1);
+
+    bsls::TimeInterval lowest(1);
+    bsls::TimeInterval highest;
+    for (int i = 0; i < 100; ++i) {
+        const bsls::TimeInterval interval = limiter.retryInterval();
+        EXPECT_THAT(interval, Ge(bsls::TimeInterval(0.1)));
+        EXPECT_THAT(interval, Lt(bsls::TimeInterval(0.3)));
+        lowest  = bsl::min(lowest, interval);
+        highest = bsl::max(highest, interval);
+    }
+    EXPECT_THAT(highest, Gt(lowest));
+}
@@ -0,0 +1,166 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <rmqio_connectrace.h>
+
+#include <bdlf_bind.h>
+#include <bsls_timeinterval.h>
+
+#include <boost/asio.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <bsl_vector.h>
+
+using namespace BloombergLP;
+using namespace rmqio;
+using namespace ::testing;
+
+namespace {
+
+typedef boost::asio::ip::tcp tcp;
+
+void recordResult(boost::system::error_code* errorOut,
+                  ConnectRace::Endpoints::iterator* endpointOut,
+                  int* calls,
+                  const boost::system::error_code& error,
+                  ConnectRace::Endpoints::iterator endpoint)
+{
+    *errorOut    = error;
+    *endpointOut = endpoint;
+    ++*calls;
+}
+
+class ConnectRaceTests : public ::testing::Test {
+  public:
+    ConnectRaceTests()
+    : d_context()
+    , d_socket(d_context)
+    , d_error()
+    , d_endpoint()
+    , d_calls(0)
+    {
+    }
+
+    /// Return an endpoint refusing connections: a port which was just
+    /// listened on and closed again
+    tcp::endpoint refusing()
+    {
+        tcp::acceptor acceptor(
+            d_context,
+            tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 0));
+        const tcp::endpoint endpoint = acceptor.local_endpoint();
+        acceptor.close();
+        return endpoint;
+    }
+
+    tcp::endpoint listening(tcp::acceptor* acceptor)
+    {
+        acceptor->open(tcp::v4());
+        acceptor->bind(
+            tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 0));
+        acceptor->listen();
+        return acceptor->local_endpoint();
+    }
+
+    ConnectRace::Endpoints endpoints(const bsl::vector<tcp::endpoint>& list)
+    {
+        return ConnectRace::Endpoints::create(
+            list.begin(), list.end(), "broker", "5672");
+    }
+
+    void race(const ConnectRace::Endpoints& candidates)
+    {
+        ConnectRace::start(d_socket,
+                           candidates,
+                           bsls::TimeInterval(10),
+                           bdlf::BindUtil::bind(&recordResult,
+                                                &d_error,
+                                                &d_endpoint,
+                                                &d_calls,
+                                                bdlf::PlaceHolders::_1,
+                                                bdlf::PlaceHolders::_2));
+        d_context.run();
+    }
+
+  protected:
+    boost::asio::io_context d_context;
+    tcp::socket d_socket;
+    boost::system::error_code d_error;
+    ConnectRace::Endpoints::iterator d_endpoint;
+    int d_calls;
+};
+
+} // namespace
+
+TEST_F(ConnectRaceTests, ConnectsToFirstEndpoint)
+{
+    tcp::acceptor acceptor(d_context);
+    bsl::vector<tcp::endpoint> list(1, listening(&acceptor));
+
+    const ConnectRace::Endpoints candidates = endpoints(list);
+    race(candidates);
+
+    EXPECT_THAT(d_calls, Eq(1));
+    EXPECT_FALSE(d_error);
+    ASSERT_TRUE(d_endpoint != candidates.end());
+    EXPECT_THAT(d_endpoint->endpoint(), Eq(list[0]));
+    EXPECT_TRUE(d_socket.is_open());
+    EXPECT_THAT(d_socket.remote_endpoint(), Eq(list[0]));
+}
+
+TEST_F(ConnectRaceTests, RefusedEndpointMovesOnWithoutWaiting)
+{
+    tcp::acceptor acceptor(d_context);
+    bsl::vector<tcp::endpoint> list;
+    list.push_back(refusing());
+    list.push_back(listening(&acceptor));
+
+    // The stagger is 10 seconds: only an immediate failover finishes
+    // within the test timeout
+    const ConnectRace::Endpoints candidates = endpoints(list);
+    race(candidates);
+
+    EXPECT_THAT(d_calls, Eq(1));
+    EXPECT_FALSE(d_error);
+    ASSERT_TRUE(d_endpoint != candidates.end());
+    EXPECT_THAT(d_endpoint->endpoint(), Eq(list[1]));
+    EXPECT_THAT(d_socket.remote_endpoint(), Eq(list[1]));
+}
+
+TEST_F(ConnectRaceTests, AllRefusedReportsLastError)
+{
+    bsl::vector<tcp::endpoint> list;
+    list.push_back(refusing());
+    list.push_back(refusing());
+
+    const ConnectRace::Endpoints candidates = endpoints(list);
+    race(candidates);
+
+    EXPECT_THAT(d_calls, Eq(1));
+    EXPECT_THAT(d_error, Eq(boost::asio::error::connection_refused));
+    EXPECT_TRUE(d_endpoint == candidates.end());
+    EXPECT_FALSE(d_socket.is_open());
+}
+
+TEST_F(ConnectRaceTests, NoEndpointsIsNotFound)
+{
+    const ConnectRace::Endpoints candidates =
+        endpoints(bsl::vector<tcp::endpoint>());
+    race(candidates);
+
+    EXPECT_THAT(d_calls, Eq(1));
+    EXPECT_THAT(d_error, Eq(boost::asio::error::not_found));
+}
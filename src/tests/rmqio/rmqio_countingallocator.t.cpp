@@ -0,0 +1,58 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqio_countingallocator.h>
+
+#include <bslma_testallocator.h>
+
+#include <bsl_vector.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqio;
+using namespace ::testing;
+
+TEST(CountingAllocator, CountsAllocationsAndBytes)
+{
+    bslma::TestAllocator upstream;
+    CountingAllocator allocator(&upstream);
+
+    void* first  = allocator.allocate(10);
+    void* second = allocator.allocate(32);
+    EXPECT_THAT(allocator.allocations(), Eq(2));
+    EXPECT_THAT(allocator.bytesAllocated(), Eq(42));
+    EXPECT_THAT(upstream.numBlocksInUse(), Eq(2));
+
+    allocator.deallocate(first);
+    allocator.deallocate(second);
+    allocator.deallocate(0);
+    EXPECT_THAT(allocator.deallocations(), Eq(2));
+    EXPECT_THAT(upstream.numBlocksInUse(), Eq(0));
+}
+
+TEST(CountingAllocator, CountsContainerAllocations)
+{
+    bslma::TestAllocator upstream;
+    CountingAllocator allocator(&upstream);
+
+    {
+        bsl::vector<int> values(&allocator);
+        values.reserve(100);
+    }
+    EXPECT_THAT(allocator.allocations(), Eq(1));
+    EXPECT_THAT(allocator.bytesAllocated(), Ge(100 * sizeof(int)));
+    EXPECT_THAT(allocator.deallocations(), Eq(1));
+}
@@ -0,0 +1,82 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <rmqio_decodepool.h>
+
+#include <bdlf_bind.h>
+#include <bslmt_latch.h>
+#include <bslmt_threadattributes.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <bsl_vector.h>
+
+using namespace BloombergLP;
+using namespace rmqio;
+using namespace ::testing;
+
+namespace {
+
+void record(bsl::vector<int>* order, int value, bslmt::Latch* done)
+{
+    order->push_back(value);
+    done->arrive();
+}
+
+} // namespace
+
+TEST(DecodePoolTests, RunsAQueuesJobsInOrder)
+{
+    DecodePool pool(bslmt::ThreadAttributes(), 4);
+    ASSERT_EQ(pool.start(), 0);
+
+    const int queue = pool.createQueue();
+    ASSERT_NE(queue, 0);
+
+    const int numJobs = 100;
+    bsl::vector<int> order;
+    bslmt::Latch done(numJobs);
+    for (int i = 0; i < numJobs; ++i) {
+        ASSERT_EQ(pool.enqueue(queue,
+                               bdlf::BindUtil::bind(&record, &order, i, &done)),
+                  0);
+    }
+    done.wait();
+
+    ASSERT_THAT(order.size(), Eq(bsl::size_t(numJobs)));
+    for (int i = 0; i < numJobs; ++i) {
+        EXPECT_THAT(order[i], Eq(i));
+    }
+
+    pool.deleteQueue(queue);
+}
+
+TEST(DecodePoolTests, RejectsJobsOnceShutDown)
+{
+    DecodePool pool(bslmt::ThreadAttributes(), 1);
+    ASSERT_EQ(pool.start(), 0);
+    const int queue = pool.createQueue();
+
+    pool.shutdown();
+
+    bsl::vector<int> order;
+    bslmt::Latch done(1);
+    EXPECT_NE(
+        pool.enqueue(queue, bdlf::BindUtil::bind(&record, &order, 1, &done)),
+        0);
+    EXPECT_TRUE(order.empty());
+}
@@ -17,6 +17,7 @@
 
 #include <bsl_cstdint.h>
 #include <bsl_cstdio.h>
+#include <bsl_memory.h>
 #include <bsl_vector.h>
 
 #include <gmock/gmock.h>
@@ -128,3 +129,94 @@ TEST_F(DecoderTests, DecodeError)
     EXPECT_THAT(rc, Eq(Decoder::DECODE_ERROR));
     EXPECT_THAT(frames.size(), Eq(0));
 }
+
+TEST_F(DecoderTests, InPlaceFramesShareBlock)
+{
+    Decoder decoder(MAX_FRAME, Decoder::IN_PLACE);
+    bsl::vector<rmqamqpt::Frame> frames;
+
+    bsl::shared_ptr<bsl::vector<bsl::uint8_t> > block =
+        bsl::make_shared<bsl::vector<bsl::uint8_t> >(d_exactFrame);
+    block->insert(block->end(), d_exactFrame.begin(), d_exactFrame.end());
+
+    const Decoder::ReturnCode rc =
+        decoder.decodeInPlace(&frames, block, block->size());
+
+    EXPECT_THAT(rc, Eq(Decoder::OK));
+    ASSERT_THAT(frames.size(), Eq(2));
+    EXPECT_THAT(frames[0].rawData(), Eq(block->data()));
+    EXPECT_THAT(frames[1].rawData(), Eq(block->data() + d_exactFrame.size()));
+    EXPECT_THAT(frames[1].totalFrameSize(), Eq(d_exactFrame.size()));
+    EXPECT_THAT(frames[1].type(), Eq(0x08));
+}
+
+TEST_F(DecoderTests, InPlaceFrameSplitAcrossBlocks)
+{
+    Decoder decoder(MAX_FRAME, Decoder::IN_PLACE);
+    bsl::vector<rmqamqpt::Frame> frames;
+
+    // 1.5 frames then 0.5 frames + 1 frame
+    bsl::shared_ptr<bsl::vector<bsl::uint8_t> > first =
+        bsl::make_shared<bsl::vector<bsl::uint8_t> >(d_exactFrame);
+    first->insert(first->end(), d_exactFrame.begin(), d_exactFrame.begin() + 3);
+
+    bsl::shared_ptr<bsl::vector<bsl::uint8_t> > second =
+        bsl::make_shared<bsl::vector<bsl::uint8_t> >(d_exactFrame.begin() + 3,
+                                                     d_exactFrame.end());
+    second->insert(second->end(), d_exactFrame.begin(), d_exactFrame.end());
+
+    EXPECT_THAT(decoder.decodeInPlace(&frames, first, first->size()),
+                Eq(Decoder::OK));
+    EXPECT_THAT(frames.size(), Eq(1));
+
+    frames.clear();
+    EXPECT_THAT(decoder.decodeInPlace(&frames, second, second->size()),
+                Eq(Decoder::OK));
+    ASSERT_THAT(frames.size(), Eq(2));
+
+    // The split frame is copied, the following one references the block
+    EXPECT_TRUE(frames[0] == frames[1]);
+    EXPECT_THAT(frames[0].serializedData(), Ne(second));
+    EXPECT_THAT(frames[1].serializedData(), Eq(second));
+    EXPECT_THAT(frames[1].dataOffset(), Eq(5));
+}
+
+TEST_F(DecoderTests, InPlaceDecodeError)
+{
+    Decoder decoder(MAX_FRAME, Decoder::IN_PLACE);
+    bsl::vector<rmqamqpt::Frame> frames;
+
+    bsl::shared_ptr<bsl::vector<bsl::uint8_t> > block =
+        bsl::make_shared<bsl::vector<bsl::uint8_t> >(d_exactFrame);
+    block->back() = 0xFF; // corrupt the frame end marker
+
+    EXPECT_THAT(decoder.decodeInPlace(&frames, block, block->size()),
+                Eq(Decoder::DECODE_ERROR));
+    EXPECT_THAT(frames.size(), Eq(0));
+}
+
+TEST_F(DecoderTests, TrimKeepsPartialFrame)
+{
+    Decoder decoder(MAX_FRAME);
+    bsl::vector<rmqamqpt::Frame> frames;
+
+    bsl::vector<bsl::uint8_t> burst;
+    for (int i = 0; i < 10; ++i) {
+        burst.insert(burst.end(), d_exactFrame.begin(), d_exactFrame.end());
+    }
+    burst.insert(burst.end(), d_exactFrame.begin(), d_exactFrame.begin() + 4);
+
+    EXPECT_THAT(decoder.appendBytes(&frames, &burst[0], burst.size()),
+                Eq(Decoder::OK));
+    EXPECT_THAT(frames.size(), Eq(10));
+
+    decoder.trim();
+    EXPECT_THAT(decoder.bufferCapacity(), Le(4));
+
+    frames.clear();
+    EXPECT_THAT(decoder.appendBytes(&frames,
+                                    &d_exactFrame[4],
+                                    d_exactFrame.size() - 4),
+                Eq(Decoder::OK));
+    EXPECT_THAT(frames.size(), Eq(1));
+}
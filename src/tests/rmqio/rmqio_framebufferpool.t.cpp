@@ -0,0 +1,90 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqio_framebufferpool.h>
+
+#include <rmqio_serializedframe.h>
+
+#include <bsl_memory.h>
+#include <bsl_vector.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqio;
+using namespace ::testing;
+
+TEST(FrameBufferPool, CountsAllocations)
+{
+    bsl::shared_ptr<FrameBufferPool> pool = FrameBufferPool::create();
+
+    void* block = pool->allocate(64);
+    EXPECT_THAT(pool->stats().allocations, Eq(1));
+    EXPECT_THAT(pool->stats().deallocations, Eq(0));
+
+    pool->deallocate(block);
+    EXPECT_THAT(pool->stats().deallocations, Eq(1));
+}
+
+TEST(FrameBufferPool, SteadyStateDoesNotAllocateUpstream)
+{
+    bsl::shared_ptr<FrameBufferPool> pool = FrameBufferPool::create();
+
+    const uint8_t data[] = {1, 2, 3, 4, 5, 6, 7, 8};
+
+    // Warm up
+    for (int i = 0; i < 10; ++i) {
+        bsl::allocate_shared<SerializedFrame>(pool.get(), data, sizeof(data));
+    }
+
+    const FrameBufferPool::Stats warm = pool->stats();
+
+    for (int i = 0; i < 1000; ++i) {
+        bsl::allocate_shared<SerializedFrame>(pool.get(), data, sizeof(data));
+    }
+
+    const FrameBufferPool::Stats steady = pool->stats();
+    EXPECT_THAT(steady.allocations, Gt(warm.allocations));
+    EXPECT_THAT(steady.upstreamAllocations, Eq(warm.upstreamAllocations));
+}
+
+TEST(FrameBufferPool, OutlivesHandleWhileBlocksOutstanding)
+{
+    bsl::shared_ptr<FrameBufferPool> pool = FrameBufferPool::create();
+
+    const uint8_t data[] = {1, 2, 3, 4};
+    bsl::shared_ptr<SerializedFrame> frame =
+        bsl::allocate_shared<SerializedFrame>(pool.get(), data, sizeof(data));
+
+    pool.reset();
+
+    // The pool is still alive until the frame is released
+    EXPECT_THAT(frame->frameLength(), Eq(sizeof(data)));
+    EXPECT_THAT(frame->serialized()[3], Eq(4));
+    frame.reset();
+}
+
+TEST(FrameBufferPool, TracksUpstreamBytesOutstanding)
+{
+    bsl::shared_ptr<FrameBufferPool> pool = FrameBufferPool::create();
+    EXPECT_THAT(pool->stats().upstreamBytesOutstanding, Eq(0));
+
+    void* block = pool->allocate(64);
+    EXPECT_THAT(pool->stats().upstreamBytesOutstanding, Gt(0));
+
+    // Freed blocks stay pooled until the pool goes
+    pool->deallocate(block);
+    EXPECT_THAT(pool->stats().upstreamBytesOutstanding, Gt(0));
+}
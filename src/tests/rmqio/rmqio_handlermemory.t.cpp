@@ -0,0 +1,92 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqio_handlermemory.h>
+
+#include <bsl_memory.h>
+#include <bsl_vector.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqio;
+using namespace ::testing;
+
+namespace {
+
+struct CountingHandler {
+    int* d_calls;
+
+    void operator()(int, bsl::size_t) { ++*d_calls; }
+};
+
+} // namespace
+
+TEST(HandlerMemory, ReusesFreedSlots)
+{
+    HandlerMemory memory;
+
+    void* first = memory.allocate(100);
+    memory.deallocate(first);
+    void* second = memory.allocate(200);
+    EXPECT_THAT(second, Eq(first));
+    memory.deallocate(second);
+}
+
+TEST(HandlerMemory, FallsBackToTheHeapWhenFull)
+{
+    HandlerMemory memory;
+
+    bsl::vector<void*> slots;
+    for (bsl::size_t i = 0; i < HandlerMemory::k_NUM_SLOTS; ++i) {
+        slots.push_back(memory.allocate(HandlerMemory::k_SLOT_SIZE));
+    }
+
+    void* overflow = memory.allocate(16);
+    void* large    = memory.allocate(HandlerMemory::k_SLOT_SIZE + 1);
+    EXPECT_THAT(slots, Not(Contains(overflow)));
+    EXPECT_THAT(slots, Not(Contains(large)));
+
+    memory.deallocate(overflow);
+    memory.deallocate(large);
+    for (bsl::size_t i = 0; i < slots.size(); ++i) {
+        memory.deallocate(slots[i]);
+    }
+}
+
+TEST(HandlerMemory, AllocatingHandlerAllocatesFromItsMemory)
+{
+    bsl::shared_ptr<HandlerMemory> memory =
+        bsl::make_shared<HandlerMemory>();
+
+    int calls               = 0;
+    CountingHandler counter = {&calls};
+    AllocatingHandler<CountingHandler> handler =
+        makeAllocatingHandler(memory, counter);
+
+    HandlerAllocator<double> allocator(handler.get_allocator());
+    EXPECT_THAT(allocator, Eq(HandlerAllocator<int>(memory.get())));
+
+    double* value = allocator.allocate(1);
+    allocator.deallocate(value, 1);
+
+    void* reused = memory->allocate(sizeof(double));
+    EXPECT_THAT(reused, Eq(static_cast<void*>(value)));
+    memory->deallocate(reused);
+
+    handler(0, 0);
+    EXPECT_THAT(calls, Eq(1));
+}
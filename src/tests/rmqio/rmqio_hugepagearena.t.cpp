@@ -0,0 +1,112 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqio_hugepagearena.h>
+
+#include <rmqio_countingallocator.h>
+
+#include <bsl_cstring.h>
+#include <bsl_memory.h>
+#include <bsl_vector.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqio;
+using namespace ::testing;
+
+TEST(HugePageArena, ReusesFreedBlocks)
+{
+    bsl::shared_ptr<HugePageArena> arena =
+        HugePageArena::create(HugePageArena::k_HUGE_PAGE_SIZE);
+
+    void* first = arena->allocate(100);
+    bsl::memset(first, 1, 100);
+    arena->deallocate(first);
+
+    const HugePageArena::Stats warm = arena->stats();
+    void* second                     = arena->allocate(128);
+    EXPECT_THAT(second, Eq(first));
+    EXPECT_THAT(arena->stats().regionBytesUsed, Eq(warm.regionBytesUsed));
+    arena->deallocate(second);
+}
+
+TEST(HugePageArena, FallsBackOnceRegionIsUsedUp)
+{
+    CountingAllocator fallback;
+    bsl::shared_ptr<HugePageArena> arena = HugePageArena::create(
+        1, HugePageArena::Mode::e_TRANSPARENT, &fallback);
+
+    bsl::vector<void*> blocks;
+    for (int i = 0; i < 4; ++i) {
+        blocks.push_back(arena->allocate(HugePageArena::k_HUGE_PAGE_SIZE / 2));
+    }
+
+    // The region, if there is one, holds fewer than four half-page blocks
+    EXPECT_THAT(arena->stats().regionBytesUsed,
+                Le(arena->stats().regionBytes));
+    EXPECT_THAT(arena->stats().fallbackAllocations, Ge(1u));
+    EXPECT_THAT(fallback.allocations(),
+                Eq(bsls::Types::Int64(
+                    arena->stats().fallbackAllocations)));
+
+    for (bsl::size_t i = 0; i < blocks.size(); ++i) {
+        bsl::memset(blocks[i], 0xff, HugePageArena::k_HUGE_PAGE_SIZE / 2);
+        arena->deallocate(blocks[i]);
+    }
+    EXPECT_THAT(fallback.deallocations(), Eq(fallback.allocations()));
+}
+
+TEST(HugePageArena, LargeBlocksBypassThePools)
+{
+    CountingAllocator fallback;
+    bsl::shared_ptr<HugePageArena> arena = HugePageArena::create(
+        4 * HugePageArena::k_HUGE_PAGE_SIZE,
+        HugePageArena::Mode::e_TRANSPARENT,
+        &fallback);
+
+    void* block = arena->allocate(HugePageArena::k_HUGE_PAGE_SIZE);
+    EXPECT_THAT(arena->stats().regionBytesUsed, Eq(0u));
+    EXPECT_THAT(fallback.allocations(), Eq(1));
+    arena->deallocate(block);
+    EXPECT_THAT(fallback.deallocations(), Eq(1));
+}
+
+TEST(HugePageArena, ExplicitModeFallsBackToTransparent)
+{
+    // Most hosts reserve no huge pages, in which case the region is still
+    // mapped, just without them
+    bsl::shared_ptr<HugePageArena> arena = HugePageArena::create(
+        HugePageArena::k_HUGE_PAGE_SIZE, HugePageArena::Mode::e_EXPLICIT);
+
+    void* block = arena->allocate(64);
+    bsl::memset(block, 0, 64);
+    arena->deallocate(block);
+}
+
+TEST(HugePageArena, OutlivesHandleWhileBlocksOutstanding)
+{
+    bsl::shared_ptr<HugePageArena> arena =
+        HugePageArena::create(HugePageArena::k_HUGE_PAGE_SIZE);
+
+    bsl::shared_ptr<bsl::vector<uint8_t> > buffer =
+        bsl::allocate_shared<bsl::vector<uint8_t> >(arena.get(), 4096);
+    arena.reset();
+
+    // The region is still mapped until the buffer is released
+    (*buffer)[4095] = 1;
+    EXPECT_THAT((*buffer)[4095], Eq(1));
+    buffer.reset();
+}
@@ -0,0 +1,106 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqio_jitteredretrystrategy.h>
+
+#include <bdlf_bind.h>
+#include <bsls_timeinterval.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqio;
+using namespace ::testing;
+
+namespace {
+
+double fixedRandom(double value) { return value; }
+
+JitteredRetryStrategy::UniformRandom returns(double value)
+{
+    return bdlf::BindUtil::bind(&fixedRandom, value);
+}
+
+} // namespace
+
+TEST(JitteredRetryStrategy, FirstRetryWaitsUpToMinWait)
+{
+    JitteredRetryStrategy strategy(
+        bsls::TimeInterval(2), bsls::TimeInterval(60), returns(0.25));
+
+    EXPECT_THAT(strategy.getNextRetryInterval(),
+                Eq(bsls::TimeInterval(0.5)));
+}
+
+TEST(JitteredRetryStrategy, WaitsGrowFromMinWaitToThreeTimesTheLast)
+{
+    JitteredRetryStrategy strategy(
+        bsls::TimeInterval(1), bsls::TimeInterval(60), returns(0.5));
+
+    EXPECT_THAT(strategy.getNextRetryInterval(),
+                Eq(bsls::TimeInterval(0.5)));
+    strategy.attempt();
+
+    // Between 1 and 3 * 1
+    EXPECT_THAT(strategy.getNextRetryInterval(), Eq(bsls::TimeInterval(2)));
+    strategy.attempt();
+
+    // Between 1 and 3 * 2
+    EXPECT_THAT(strategy.getNextRetryInterval(),
+                Eq(bsls::TimeInterval(3.5)));
+}
+
+TEST(JitteredRetryStrategy, WaitsAreCappedAtMaxWait)
+{
+    JitteredRetryStrategy strategy(
+        bsls::TimeInterval(1), bsls::TimeInterval(10), returns(0.99));
+
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_THAT(strategy.getNextRetryInterval(),
+                    Le(bsls::TimeInterval(10)));
+        strategy.attempt();
+    }
+    EXPECT_THAT(strategy.getNextRetryInterval(), Eq(bsls::TimeInterval(10)));
+}
+
+TEST(JitteredRetryStrategy, SuccessStartsAgainFromMinWait)
+{
+    JitteredRetryStrategy strategy(
+        bsls::TimeInterval(1), bsls::TimeInterval(60), returns(0.5));
+
+    for (int i = 0; i < 5; ++i) {
+        strategy.getNextRetryInterval();
+        strategy.attempt();
+    }
+    strategy.success();
+
+    EXPECT_THAT(strategy.getNextRetryInterval(),
+                Eq(bsls::TimeInterval(0.5)));
+}
+
+TEST(JitteredRetryStrategy, DefaultRandomStaysWithinBounds)
+{
+    JitteredRetryStrategy strategy(bsls::TimeInterval(1),
+                                   bsls::TimeInterval(30));
+
+    EXPECT_THAT(strategy.getNextRetryInterval(), Le(bsls::TimeInterval(1)));
+    for (int i = 0; i < 100; ++i) {
+        strategy.attempt();
+        const bsls::TimeInterval wait = strategy.getNextRetryInterval();
+        EXPECT_THAT(wait, Ge(bsls::TimeInterval(1)));
+        EXPECT_THAT(wait, Le(bsls::TimeInterval(30)));
+    }
+}
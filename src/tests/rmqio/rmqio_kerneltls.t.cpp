@@ -0,0 +1,52 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <rmqio_kerneltls.h>
+
+#include <openssl/ssl.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace BloombergLP;
+using namespace rmqio;
+using namespace ::testing;
+
+TEST(KernelTls, SessionWithoutHandshakeIsNotOffloaded)
+{
+    SSL_CTX* context = SSL_CTX_new(TLS_client_method());
+    ASSERT_TRUE(context);
+    SSL* ssl = SSL_new(context);
+    ASSERT_TRUE(ssl);
+
+    int fds[2];
+    ASSERT_THAT(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), Eq(0));
+
+    EXPECT_THAT(KernelTls::install(ssl, fds[0]), Eq(KernelTls::NONE));
+
+    // The socket is left usable as it was
+    const char data = 'x';
+    char received   = 0;
+    EXPECT_THAT(write(fds[0], &data, 1), Eq(1));
+    EXPECT_THAT(read(fds[1], &received, 1), Eq(1));
+    EXPECT_THAT(received, Eq(data));
+
+    close(fds[0]);
+    close(fds[1]);
+    SSL_free(ssl);
+    SSL_CTX_free(context);
+}
@@ -0,0 +1,134 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqio_mpscqueue.h>
+
+#include <bdlf_bind.h>
+#include <bslmt_threadutil.h>
+
+#include <bsl_vector.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqio;
+using namespace ::testing;
+
+namespace {
+const int k_ITEMS_PER_PRODUCER = 10000;
+
+void produce(MpscQueue<int>* queue, int producer)
+{
+    for (int i = 0; i < k_ITEMS_PER_PRODUCER;) {
+        if (queue->tryPush(producer * k_ITEMS_PER_PRODUCER + i)) {
+            ++i;
+        }
+        else {
+            bslmt::ThreadUtil::yield();
+        }
+    }
+}
+} // namespace
+
+TEST(MpscQueue, PopsInPushOrder)
+{
+    MpscQueue<int> queue(4);
+
+    EXPECT_TRUE(queue.tryPush(1));
+    EXPECT_TRUE(queue.tryPush(2));
+    EXPECT_TRUE(queue.tryPush(3));
+
+    int item = 0;
+    EXPECT_TRUE(queue.tryPop(&item));
+    EXPECT_THAT(item, Eq(1));
+    EXPECT_TRUE(queue.tryPop(&item));
+    EXPECT_THAT(item, Eq(2));
+    EXPECT_TRUE(queue.tryPop(&item));
+    EXPECT_THAT(item, Eq(3));
+    EXPECT_FALSE(queue.tryPop(&item));
+}
+
+TEST(MpscQueue, PushFailsWhenFull)
+{
+    MpscQueue<int> queue(2);
+
+    EXPECT_TRUE(queue.tryPush(1));
+    EXPECT_TRUE(queue.tryPush(2));
+    EXPECT_FALSE(queue.tryPush(3));
+
+    int item = 0;
+    EXPECT_TRUE(queue.tryPop(&item));
+    EXPECT_TRUE(queue.tryPush(3));
+}
+
+TEST(MpscQueue, EmptyUntilPushed)
+{
+    MpscQueue<int> queue(2);
+    EXPECT_TRUE(queue.empty());
+
+    EXPECT_TRUE(queue.tryPush(1));
+    EXPECT_FALSE(queue.empty());
+
+    int item = 0;
+    EXPECT_TRUE(queue.tryPop(&item));
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(MpscQueue, WrapsAround)
+{
+    MpscQueue<int> queue(2);
+
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_TRUE(queue.tryPush(i));
+
+        int item = -1;
+        EXPECT_TRUE(queue.tryPop(&item));
+        EXPECT_THAT(item, Eq(i));
+    }
+    EXPECT_THAT(queue.capacity(), Eq(2));
+}
+
+TEST(MpscQueue, ManyProducersKeepPerProducerOrder)
+{
+    const int k_NUM_PRODUCERS = 4;
+
+    MpscQueue<int> queue(64);
+
+    bsl::vector<bslmt::ThreadUtil::Handle> threads(k_NUM_PRODUCERS);
+    for (int p = 0; p < k_NUM_PRODUCERS; ++p) {
+        ASSERT_THAT(bslmt::ThreadUtil::create(
+                        &threads[p], bdlf::BindUtil::bind(&produce, &queue, p)),
+                    Eq(0));
+    }
+
+    bsl::vector<int> lastSeen(k_NUM_PRODUCERS, -1);
+    int received = 0;
+    while (received < k_NUM_PRODUCERS * k_ITEMS_PER_PRODUCER) {
+        int item = 0;
+        if (!queue.tryPop(&item)) {
+            bslmt::ThreadUtil::yield();
+            continue;
+        }
+        const int producer = item / k_ITEMS_PER_PRODUCER;
+        const int sequence = item % k_ITEMS_PER_PRODUCER;
+        EXPECT_THAT(sequence, Gt(lastSeen[producer]));
+        lastSeen[producer] = sequence;
+        ++received;
+    }
+
+    for (int p = 0; p < k_NUM_PRODUCERS; ++p) {
+        bslmt::ThreadUtil::join(threads[p]);
+    }
+}
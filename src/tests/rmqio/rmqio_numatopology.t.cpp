@@ -0,0 +1,59 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqio_numatopology.h>
+
+#include <bsl_vector.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqio;
+using namespace ::testing;
+
+TEST(NumaTopology, ParsesRangesAndSingleCpus)
+{
+    bsl::vector<int> cpus;
+    EXPECT_EQ(NumaTopology::parseCpuList(&cpus, "0-3,8,10-11"), 0);
+
+    EXPECT_THAT(cpus, ElementsAre(0, 1, 2, 3, 8, 10, 11));
+}
+
+TEST(NumaTopology, ParsesTrailingNewline)
+{
+    bsl::vector<int> cpus;
+    EXPECT_EQ(NumaTopology::parseCpuList(&cpus, "4-5\n"), 0);
+
+    EXPECT_THAT(cpus, ElementsAre(4, 5));
+}
+
+TEST(NumaTopology, RejectsMalformedLists)
+{
+    bsl::vector<int> cpus;
+
+    EXPECT_NE(NumaTopology::parseCpuList(&cpus, "0-"), 0);
+    EXPECT_NE(NumaTopology::parseCpuList(&cpus, "3-1"), 0);
+    EXPECT_NE(NumaTopology::parseCpuList(&cpus, "0,,1"), 0);
+    EXPECT_NE(NumaTopology::parseCpuList(&cpus, "a"), 0);
+}
+
+TEST(NumaTopology, NodesHaveCpus)
+{
+    const bsl::vector<bsl::vector<int> > nodes = NumaTopology::nodeCpus();
+
+    for (bsl::size_t i = 0; i < nodes.size(); ++i) {
+        EXPECT_FALSE(nodes[i].empty());
+    }
+}
@@ -0,0 +1,49 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqio_pipelineclock.h>
+
+#include <bslmt_threadutil.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqio;
+using namespace ::testing;
+
+namespace {
+class PipelineClockTests : public ::testing::Test {
+  public:
+    ~PipelineClockTests() { PipelineClock::setEnabled(false); }
+};
+} // namespace
+
+TEST_F(PipelineClockTests, DisabledByDefault)
+{
+    EXPECT_FALSE(PipelineClock::isEnabled());
+    EXPECT_THAT(PipelineClock::now(), Eq(0));
+}
+
+TEST_F(PipelineClockTests, EnabledAdvances)
+{
+    PipelineClock::setEnabled(true);
+
+    const bsls::Types::Int64 first = PipelineClock::now();
+    EXPECT_THAT(first, Ne(0));
+
+    bslmt::ThreadUtil::microSleep(1000);
+    EXPECT_THAT(PipelineClock::now() - first, Ge(1000 * 1000));
+}
@@ -0,0 +1,96 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqio_readsizer.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqio;
+using namespace ::testing;
+
+TEST(ReadSizer, StartsAtOneFrame)
+{
+    ReadSizer sizer(128, 1024);
+    EXPECT_THAT(sizer.size(), Eq(128));
+}
+
+TEST(ReadSizer, GrowsWhileReadsFillTheBuffer)
+{
+    ReadSizer sizer(128, 1024);
+
+    sizer.record(128);
+    EXPECT_THAT(sizer.size(), Eq(256));
+    sizer.record(256);
+    sizer.record(512);
+    EXPECT_THAT(sizer.size(), Eq(1024));
+    sizer.record(1024);
+    EXPECT_THAT(sizer.size(), Eq(1024));
+}
+
+TEST(ReadSizer, ShrinksAfterRunOfSmallReads)
+{
+    ReadSizer sizer(128, 1024);
+    sizer.record(128);
+    sizer.record(256);
+    ASSERT_THAT(sizer.size(), Eq(512));
+
+    for (unsigned i = 1; i < ReadSizer::k_SHRINK_AFTER; ++i) {
+        sizer.record(10);
+    }
+    EXPECT_THAT(sizer.size(), Eq(512));
+    sizer.record(10);
+    EXPECT_THAT(sizer.size(), Eq(256));
+
+    for (unsigned i = 0; i < 10 * ReadSizer::k_SHRINK_AFTER; ++i) {
+        sizer.record(10);
+    }
+    EXPECT_THAT(sizer.size(), Eq(128));
+}
+
+TEST(ReadSizer, ModerateReadInterruptsShrinking)
+{
+    ReadSizer sizer(128, 1024);
+    sizer.record(128);
+    ASSERT_THAT(sizer.size(), Eq(256));
+
+    for (unsigned i = 1; i < ReadSizer::k_SHRINK_AFTER; ++i) {
+        sizer.record(10);
+    }
+    sizer.record(200);
+    sizer.record(10);
+    EXPECT_THAT(sizer.size(), Eq(256));
+}
+
+TEST(ReadSizer, FixedWhenMaximumIsNotLarger)
+{
+    ReadSizer sizer(128, 0);
+    sizer.record(128);
+    EXPECT_THAT(sizer.size(), Eq(128));
+}
+
+TEST(ReadSizer, ResetReturnsToOneFrame)
+{
+    ReadSizer sizer(128, 1024);
+    sizer.record(128);
+    sizer.record(256);
+    ASSERT_THAT(sizer.size(), Eq(512));
+
+    sizer.reset();
+    EXPECT_THAT(sizer.size(), Eq(128));
+    sizer.record(128);
+    EXPECT_THAT(sizer.size(), Eq(256));
+}
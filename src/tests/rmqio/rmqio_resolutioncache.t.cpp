@@ -0,0 +1,103 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <rmqio_resolutioncache.h>
+
+#include <bdlf_bind.h>
+#include <bsls_timeinterval.h>
+
+#include <boost/asio.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqio;
+using namespace ::testing;
+
+namespace {
+
+bsls::TimeInterval readClock(const bsls::TimeInterval* now) { return *now; }
+
+class ResolutionCacheTests : public ::testing::Test {
+  public:
+    ResolutionCacheTests()
+    : d_now(100)
+    , d_cache(bsls::TimeInterval(30),
+              bdlf::BindUtil::bind(&readClock, &d_now))
+    {
+    }
+
+    ResolutionCache::Results results(const char* address)
+    {
+        boost::asio::ip::tcp::endpoint endpoint(
+            boost::asio::ip::make_address(address), 5672);
+        return ResolutionCache::Results::create(
+            endpoint, "broker", "5672");
+    }
+
+  protected:
+    bsls::TimeInterval d_now;
+    ResolutionCache d_cache;
+};
+
+} // namespace
+
+TEST_F(ResolutionCacheTests, MissUntilStored)
+{
+    ResolutionCache::Results found;
+    EXPECT_FALSE(d_cache.lookup("broker", "5672", &found));
+
+    d_cache.store("broker", "5672", results("10.0.0.1"));
+
+    ASSERT_TRUE(d_cache.lookup("broker", "5672", &found));
+    ASSERT_THAT(found.size(), Eq(1));
+    EXPECT_THAT(found.begin()->endpoint().address().to_string(),
+                Eq("10.0.0.1"));
+}
+
+TEST_F(ResolutionCacheTests, KeyedByHostAndPort)
+{
+    d_cache.store("broker", "5672", results("10.0.0.1"));
+
+    ResolutionCache::Results found;
+    EXPECT_FALSE(d_cache.lookup("broker", "5671", &found));
+    EXPECT_FALSE(d_cache.lookup("other", "5672", &found));
+}
+
+TEST_F(ResolutionCacheTests, ExpiresAfterTtl)
+{
+    d_cache.store("broker", "5672", results("10.0.0.1"));
+
+    ResolutionCache::Results found;
+    d_now += bsls::TimeInterval(29);
+    EXPECT_TRUE(d_cache.lookup("broker", "5672", &found));
+
+    d_now += bsls::TimeInterval(1);
+    EXPECT_FALSE(d_cache.lookup("broker", "5672", &found));
+    EXPECT_THAT(d_cache.size(), Eq(0));
+}
+
+TEST_F(ResolutionCacheTests, StoreReplacesAndRestartsTtl)
+{
+    d_cache.store("broker", "5672", results("10.0.0.1"));
+    d_now += bsls::TimeInterval(20);
+    d_cache.store("broker", "5672", results("10.0.0.2"));
+    d_now += bsls::TimeInterval(20);
+
+    ResolutionCache::Results found;
+    ASSERT_TRUE(d_cache.lookup("broker", "5672", &found));
+    EXPECT_THAT(found.begin()->endpoint().address().to_string(),
+                Eq("10.0.0.2"));
+}
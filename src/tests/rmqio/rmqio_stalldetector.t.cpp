@@ -0,0 +1,107 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqio_stalldetector.h>
+
+#include <rmqio_asioeventloop.h>
+
+#include <bdlf_bind.h>
+#include <bdlf_placeholder.h>
+#include <bslmt_lockguard.h>
+#include <bslmt_mutex.h>
+#include <bslmt_threadutil.h>
+#include <bsls_timeinterval.h>
+
+#include <bsl_vector.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqio;
+using namespace ::testing;
+
+namespace {
+
+class StallRecorder {
+  public:
+    void record(const StallDetector::Stall& stall)
+    {
+        bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+        d_stalls.push_back(stall);
+    }
+
+    bsl::vector<StallDetector::Stall> stalls()
+    {
+        bslmt::LockGuard<bslmt::Mutex> guard(&d_mutex);
+        return d_stalls;
+    }
+
+  private:
+    bslmt::Mutex d_mutex;
+    bsl::vector<StallDetector::Stall> d_stalls;
+};
+
+void block(int milliseconds)
+{
+    bslmt::ThreadUtil::microSleep(milliseconds * 1000);
+}
+
+} // namespace
+
+TEST(StallDetector, Breathing)
+{
+    AsioEventLoop loop;
+    loop.start();
+
+    StallRecorder recorder;
+    StallDetector detector(
+        loop,
+        bsls::TimeInterval(1),
+        bdlf::BindUtil::bind(
+            &StallRecorder::record, &recorder, bdlf::PlaceHolders::_1));
+    EXPECT_EQ(0, detector.start());
+    detector.stop();
+
+    EXPECT_TRUE(recorder.stalls().empty());
+}
+
+TEST(StallDetector, ReportsBlockedLoop)
+{
+    AsioEventLoop loop;
+    loop.start();
+
+    StallRecorder recorder;
+    StallDetector detector(
+        loop,
+        bsls::TimeInterval(0, 50 * 1000 * 1000),
+        bdlf::BindUtil::bind(
+            &StallRecorder::record, &recorder, bdlf::PlaceHolders::_1));
+    ASSERT_EQ(0, detector.start());
+
+    loop.post(bdlf::BindUtil::bind(&block, 400));
+
+    for (int i = 0; i < 500 && recorder.stalls().size() < 2; ++i) {
+        block(10);
+    }
+    detector.stop();
+
+    const bsl::vector<StallDetector::Stall> stalls = recorder.stalls();
+    ASSERT_EQ(2u, stalls.size());
+    EXPECT_TRUE(stalls[0].ongoing);
+    EXPECT_GE(stalls[0].duration, bsls::TimeInterval(0, 50 * 1000 * 1000));
+    EXPECT_FALSE(stalls[1].ongoing);
+    EXPECT_GE(stalls[1].duration, stalls[0].duration);
+}
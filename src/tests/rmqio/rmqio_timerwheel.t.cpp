@@ -0,0 +1,202 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqio_timerwheel.h>
+
+#include <rmqio_asioeventloop.h>
+
+#include <rmqtestutil_timeoverride.h>
+
+#include <bdlf_bind.h>
+#include <boost/asio.hpp>
+#include <bsls_timeinterval.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <bsl_memory.h>
+#include <bsl_vector.h>
+
+using namespace BloombergLP;
+using namespace rmqio;
+using namespace ::testing;
+
+namespace {
+typedef rmqio::basic_TimerWheelFactory<boost::asio::deadline_timer::time_type,
+                                       rmqtestutil::TimeOverride>
+    FakeTimerWheelFactory;
+
+bsls::TimeInterval ticks(bsl::size_t count)
+{
+    bsls::TimeInterval interval;
+    interval.addMilliseconds(100 * count);
+    return interval;
+}
+
+const bsls::TimeInterval k_TICK = ticks(1);
+
+void stepTime(const bsls::TimeInterval& interval)
+{
+    rmqtestutil::TimeOverride::step_time(
+        boost::posix_time::milliseconds(interval.totalMilliseconds()));
+}
+
+void count(int* counter, Timer::InterruptReason reason)
+{
+    if (reason == Timer::EXPIRE) {
+        ++*counter;
+    }
+}
+
+void resetOnFirstExpiry(int* counter,
+                        bsl::weak_ptr<Timer>* timer,
+                        Timer::InterruptReason reason)
+{
+    if (reason == Timer::EXPIRE && ++*counter == 1) {
+        timer->lock()->reset(bsls::TimeInterval(1));
+    }
+}
+} // namespace
+
+class MockCallback {
+  public:
+    MOCK_METHOD1(callback, void(Timer::InterruptReason));
+};
+
+class TimerWheelTests : public Test {
+  public:
+    MockCallback d_mockCallback;
+    Timer::Callback d_callback;
+    AsioEventLoop d_io;
+    FakeTimerWheelFactory d_factory;
+    bsl::shared_ptr<Timer> d_timer;
+
+    TimerWheelTests()
+    : d_mockCallback()
+    , d_callback(bdlf::BindUtil::bind(&MockCallback::callback,
+                                      &d_mockCallback,
+                                      bdlf::PlaceHolders::_1))
+    , d_io()
+    , d_factory(d_io, k_TICK)
+    , d_timer(d_factory.createWithTimeout(bsls::TimeInterval(10)))
+    {
+    }
+};
+
+TEST_F(TimerWheelTests, BreathingTest)
+{
+    // Timer constructed in fixture
+}
+
+TEST_F(TimerWheelTests, CallbackWhenExpires)
+{
+    EXPECT_CALL(d_mockCallback, callback(Timer::EXPIRE)).Times(1);
+    d_timer->start(d_callback);
+    stepTime(bsls::TimeInterval(10) + k_TICK);
+    EXPECT_THAT(d_io.context().run_one(), Eq(1));
+}
+
+TEST_F(TimerWheelTests, DoesNotExpireEarly)
+{
+    EXPECT_CALL(d_mockCallback, callback(_)).Times(0);
+    d_timer->start(d_callback);
+    stepTime(bsls::TimeInterval(9));
+    d_io.context().poll();
+}
+
+TEST_F(TimerWheelTests, Cancel)
+{
+    EXPECT_CALL(d_mockCallback, callback(Timer::CANCEL)).Times(1);
+    d_timer->start(d_callback);
+    d_timer->cancel();
+    EXPECT_THAT(d_io.context().poll_one(), Eq(1));
+}
+
+TEST_F(TimerWheelTests, Reset)
+{
+    {
+        InSequence s;
+        EXPECT_CALL(d_mockCallback, callback(Timer::CANCEL)).Times(1);
+        EXPECT_CALL(d_mockCallback, callback(Timer::EXPIRE)).Times(1);
+    }
+    d_timer->start(d_callback);
+    d_timer->reset(bsls::TimeInterval(10));
+    stepTime(bsls::TimeInterval(10) + k_TICK);
+    EXPECT_THAT(d_io.context().run_one(), Eq(1));
+    EXPECT_THAT(d_io.context().run_one(), Eq(1));
+}
+
+TEST_F(TimerWheelTests, CancelIsSilentlyIgnoredOnDestruction)
+{
+    EXPECT_CALL(d_mockCallback, callback(_)).Times(0);
+    {
+        bsl::shared_ptr<Timer> timer =
+            d_factory.createWithTimeout(bsls::TimeInterval(10));
+        timer->start(d_callback);
+    }
+    stepTime(bsls::TimeInterval(10) + k_TICK);
+    d_io.context().run_one();
+}
+
+TEST_F(TimerWheelTests, TimersShareOneTick)
+{
+    int expired = 0;
+    bsl::vector<bsl::shared_ptr<Timer> > timers;
+    for (int i = 0; i < 1000; ++i) {
+        timers.push_back(d_factory.createWithTimeout(
+            bsls::TimeInterval(0, i * 1000 * 1000))); // i ms
+        timers.back()->start(
+            bdlf::BindUtil::bind(&count, &expired, bdlf::PlaceHolders::_1));
+    }
+
+    stepTime(bsls::TimeInterval(1) + k_TICK);
+    EXPECT_THAT(d_io.context().run_one(), Eq(1));
+    EXPECT_THAT(expired, Eq(1000));
+}
+
+TEST_F(TimerWheelTests, ExpiresAfterMoreThanOneRevolution)
+{
+    int expired = 0;
+    bsl::shared_ptr<Timer> timer = d_factory.createWithTimeout(
+        ticks(FakeTimerWheelFactory::Wheel::k_DEFAULT_SLOTS + 3));
+    timer->start(
+        bdlf::BindUtil::bind(&count, &expired, bdlf::PlaceHolders::_1));
+
+    // The timer's slot comes round before it is due
+    stepTime(ticks(5));
+    EXPECT_THAT(d_io.context().run_one(), Eq(1));
+    EXPECT_THAT(expired, Eq(0));
+
+    stepTime(ticks(FakeTimerWheelFactory::Wheel::k_DEFAULT_SLOTS));
+    EXPECT_THAT(d_io.context().run_one(), Eq(1));
+    EXPECT_THAT(expired, Eq(1));
+}
+
+TEST_F(TimerWheelTests, RearmFromCallback)
+{
+    int expired = 0;
+    bsl::weak_ptr<Timer> weakTimer(d_timer);
+    d_timer->start(bdlf::BindUtil::bind(&resetOnFirstExpiry,
+                                        &expired,
+                                        &weakTimer,
+                                        bdlf::PlaceHolders::_1));
+
+    stepTime(bsls::TimeInterval(10) + k_TICK);
+    EXPECT_THAT(d_io.context().run_one(), Eq(1));
+    EXPECT_THAT(expired, Eq(1));
+
+    stepTime(bsls::TimeInterval(1) + k_TICK);
+    EXPECT_THAT(d_io.context().run_one(), Eq(1));
+    EXPECT_THAT(expired, Eq(2));
+}
@@ -0,0 +1,117 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqio_tlshandshakepool.h>
+
+#include <rmqio_asiosocketwrapper.h>
+
+#include <bdlf_bind.h>
+#include <bdlf_placeholder.h>
+#include <bslmt_threadattributes.h>
+#include <bsls_timeinterval.h>
+
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <bsl_memory.h>
+
+using namespace BloombergLP;
+using namespace rmqio;
+using namespace ::testing;
+
+namespace {
+
+void recordOutcome(boost::system::error_code* out,
+                   bool* called,
+                   const boost::system::error_code& error)
+{
+    *out    = error;
+    *called = true;
+}
+
+class TlsHandshakePoolTests : public Test {
+  protected:
+    TlsHandshakePoolTests()
+    : d_context()
+    , d_work(d_context.get_executor())
+    , d_sslContext(bsl::make_shared<boost::asio::ssl::context>(
+          boost::asio::ssl::context::tls_client))
+    , d_socket(bsl::make_shared<AsioSecureSocketWrapper>(
+          d_context.get_executor(), d_sslContext))
+    , d_error()
+    , d_called(false)
+    {
+    }
+
+    TlsHandshakePool::HandshakeCallback callback()
+    {
+        return bdlf::BindUtil::bind(
+            &recordOutcome, &d_error, &d_called, bdlf::PlaceHolders::_1);
+    }
+
+    void runUntilCalled()
+    {
+        while (!d_called) {
+            d_context.run_one_for(boost::asio::chrono::seconds(5));
+        }
+    }
+
+    boost::asio::io_context d_context;
+    /// Keeps `d_context` waiting for the pool's completions
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type>
+        d_work;
+    bsl::shared_ptr<boost::asio::ssl::context> d_sslContext;
+    bsl::shared_ptr<AsioSecureSocketWrapper> d_socket;
+    boost::system::error_code d_error;
+    bool d_called;
+};
+
+} // namespace
+
+TEST_F(TlsHandshakePoolTests, PostsFailureBackToTheSocketsExecutor)
+{
+    TlsHandshakePool pool(bslmt::ThreadAttributes(), 1, bsls::TimeInterval());
+    ASSERT_EQ(pool.start(), 0);
+
+    // Never connected, so the handshake fails straight away
+    pool.handshake(d_socket, callback());
+    runUntilCalled();
+
+    EXPECT_TRUE(d_error);
+}
+
+TEST_F(TlsHandshakePoolTests, ShutsDownHandshakesWhichTimeOut)
+{
+    boost::asio::ip::tcp::acceptor acceptor(
+        d_context,
+        boost::asio::ip::tcp::endpoint(boost::asio::ip::address_v4::loopback(),
+                                       0));
+    boost::asio::ip::tcp::socket server(d_context);
+    d_socket->lowest_layer().connect(acceptor.local_endpoint());
+    acceptor.accept(server);
+
+    // The server never answers the client hello
+    TlsHandshakePool pool(
+        bslmt::ThreadAttributes(), 1, bsls::TimeInterval(0, 50 * 1000 * 1000));
+    ASSERT_EQ(pool.start(), 0);
+
+    pool.handshake(d_socket, callback());
+    runUntilCalled();
+
+    EXPECT_TRUE(d_error);
+}
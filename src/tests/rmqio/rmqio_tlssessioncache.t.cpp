@@ -0,0 +1,171 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <rmqio_tlssessioncache.h>
+
+#include <openssl/evp.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <bsl_memory.h>
+#include <bsl_string.h>
+
+using namespace BloombergLP;
+using namespace rmqio;
+using namespace ::testing;
+
+namespace {
+
+EVP_PKEY* makeKey()
+{
+    EVP_PKEY* key     = NULL;
+    EVP_PKEY_CTX* ctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, NULL);
+    EVP_PKEY_keygen_init(ctx);
+    EVP_PKEY_CTX_set_ec_paramgen_curve_nid(ctx, NID_X9_62_prime256v1);
+    EVP_PKEY_keygen(ctx, &key);
+    EVP_PKEY_CTX_free(ctx);
+    return key;
+}
+
+X509* makeCertificate(EVP_PKEY* key)
+{
+    X509* cert = X509_new();
+    ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+    X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+    X509_gmtime_adj(X509_getm_notAfter(cert), 3600);
+    X509_set_pubkey(cert, key);
+    X509_NAME* name = X509_get_subject_name(cert);
+    X509_NAME_add_entry_by_txt(name,
+                               "CN",
+                               MBSTRING_ASC,
+                               (const unsigned char*)"broker",
+                               -1,
+                               -1,
+                               0);
+    X509_set_issuer_name(cert, name);
+    X509_sign(cert, key, EVP_sha256());
+    return cert;
+}
+
+class TlsSessionCacheTests : public ::testing::Test {
+  public:
+    TlsSessionCacheTests()
+    : d_cache(bsl::make_shared<TlsSessionCache>())
+    , d_server(SSL_CTX_new(TLS_server_method()))
+    {
+        EVP_PKEY* key = makeKey();
+        X509* cert    = makeCertificate(key);
+        SSL_CTX_use_certificate(d_server, cert);
+        SSL_CTX_use_PrivateKey(d_server, key);
+        X509_free(cert);
+        EVP_PKEY_free(key);
+
+        static const unsigned char k_CONTEXT[] = "rmqio";
+        SSL_CTX_set_session_id_context(
+            d_server, k_CONTEXT, sizeof(k_CONTEXT));
+    }
+
+    ~TlsSessionCacheTests() { SSL_CTX_free(d_server); }
+
+    /// Run a handshake as a new connection to `endpoint` would, with its
+    /// own client context. Return `true` if the session was resumed.
+    bool connect(const bsl::string& endpoint)
+    {
+        SSL_CTX* clientContext = SSL_CTX_new(TLS_client_method());
+        TlsSessionCache::enable(clientContext);
+
+        SSL* client = SSL_new(clientContext);
+        SSL* server = SSL_new(d_server);
+        BIO* clientBio;
+        BIO* serverBio;
+        BIO_new_bio_pair(&clientBio, 0, &serverBio, 0);
+        SSL_set_bio(client, clientBio, clientBio);
+        SSL_set_bio(server, serverBio, serverBio);
+        SSL_set_connect_state(client);
+        SSL_set_accept_state(server);
+
+        d_cache->prepare(client, endpoint);
+
+        bool clientDone = false;
+        bool serverDone = false;
+        for (int i = 0; i < 10 && !(clientDone && serverDone); ++i) {
+            clientDone = clientDone || SSL_do_handshake(client) == 1;
+            serverDone = serverDone || SSL_do_handshake(server) == 1;
+        }
+        EXPECT_TRUE(clientDone && serverDone);
+
+        // TLS 1.3 tickets follow the handshake, as the first thing read
+        char byte;
+        SSL_read(client, &byte, 1);
+
+        d_cache->recordHandshake(client);
+        const bool resumed = SSL_session_reused(client);
+
+        SSL_free(server);
+        SSL_free(client);
+        SSL_CTX_free(clientContext);
+        return resumed;
+    }
+
+  protected:
+    bsl::shared_ptr<TlsSessionCache> d_cache;
+    SSL_CTX* d_server;
+};
+
+} // namespace
+
+TEST_F(TlsSessionCacheTests, NothingOfferedBeforeFirstHandshake)
+{
+    SSL_CTX* context = SSL_CTX_new(TLS_client_method());
+    SSL* ssl         = SSL_new(context);
+
+    EXPECT_FALSE(d_cache->prepare(ssl, "127.0.0.1:5671"));
+    EXPECT_THAT(d_cache->size(), Eq(0));
+
+    SSL_free(ssl);
+    SSL_CTX_free(context);
+}
+
+TEST_F(TlsSessionCacheTests, ReconnectResumesSession)
+{
+    EXPECT_FALSE(connect("127.0.0.1:5671"));
+    EXPECT_THAT(d_cache->size(), Eq(1));
+
+    EXPECT_TRUE(connect("127.0.0.1:5671"));
+
+    const TlsSessionCache::Stats stats = d_cache->stats();
+    EXPECT_THAT(stats.fullHandshakes, Eq(1));
+    EXPECT_THAT(stats.resumedHandshakes, Eq(1));
+}
+
+TEST_F(TlsSessionCacheTests, ReconnectResumesTls12Session)
+{
+    SSL_CTX_set_max_proto_version(d_server, TLS1_2_VERSION);
+
+    EXPECT_FALSE(connect("127.0.0.1:5671"));
+    EXPECT_TRUE(connect("127.0.0.1:5671"));
+}
+
+TEST_F(TlsSessionCacheTests, SessionsAreKeptPerEndpoint)
+{
+    EXPECT_FALSE(connect("127.0.0.1:5671"));
+    EXPECT_FALSE(connect("127.0.0.2:5671"));
+    EXPECT_THAT(d_cache->size(), Eq(2));
+
+    EXPECT_TRUE(connect("127.0.0.1:5671"));
+    EXPECT_TRUE(connect("127.0.0.2:5671"));
+}
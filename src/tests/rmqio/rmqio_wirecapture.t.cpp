@@ -0,0 +1,108 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqio_wirecapture.h>
+
+#include <rmqio_serializedframe.h>
+
+#include <bsl_cstdint.h>
+#include <bsl_cstring.h>
+#include <bsl_memory.h>
+#include <bsl_sstream.h>
+#include <bsl_string.h>
+#include <bsl_vector.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqio;
+using namespace ::testing;
+
+namespace {
+bsl::vector<bsl::uint8_t> bytes(const char* text)
+{
+    return bsl::vector<bsl::uint8_t>(text, text + bsl::strlen(text));
+}
+} // namespace
+
+TEST(WireCaptureTests, RecordsReadBack)
+{
+    bsl::shared_ptr<bsl::stringstream> stream =
+        bsl::make_shared<bsl::stringstream>();
+    WireCapture capture(stream);
+
+    const bsl::uint32_t first  = capture.newStream();
+    const bsl::uint32_t second = capture.newStream();
+    EXPECT_THAT(first, Ne(second));
+
+    const bsl::vector<bsl::uint8_t> in = bytes("inbound");
+    capture.record(first, WireCapture::INBOUND, in.data(), in.size());
+
+    const bsl::vector<bsl::uint8_t> out1 = bytes("out");
+    const bsl::vector<bsl::uint8_t> out2 = bytes("bound");
+    bsl::vector<bsl::shared_ptr<SerializedFrame> > frames;
+    frames.push_back(
+        bsl::make_shared<SerializedFrame>(out1.data(), out1.size()));
+    frames.push_back(
+        bsl::make_shared<SerializedFrame>(out2.data(), out2.size()));
+    capture.record(second, frames);
+    capture.flush();
+
+    WireCapture::Reader reader(*stream);
+    ASSERT_TRUE(reader.isValid());
+
+    WireCapture::Record record;
+    ASSERT_TRUE(reader.next(&record));
+    EXPECT_THAT(record.stream, Eq(first));
+    EXPECT_THAT(record.direction, Eq(WireCapture::INBOUND));
+    EXPECT_THAT(record.timestampNs, Gt(0));
+    EXPECT_THAT(record.bytes, Eq(in));
+
+    ASSERT_TRUE(reader.next(&record));
+    EXPECT_THAT(record.stream, Eq(second));
+    EXPECT_THAT(record.direction, Eq(WireCapture::OUTBOUND));
+    EXPECT_THAT(record.bytes, Eq(bytes("outbound")));
+
+    EXPECT_FALSE(reader.next(&record));
+}
+
+TEST(WireCaptureTests, TruncatedRecordEndsTheCapture)
+{
+    bsl::shared_ptr<bsl::stringstream> stream =
+        bsl::make_shared<bsl::stringstream>();
+    WireCapture capture(stream);
+
+    const bsl::vector<bsl::uint8_t> in = bytes("inbound");
+    capture.record(capture.newStream(), WireCapture::INBOUND, in.data(), 7);
+    capture.flush();
+
+    const bsl::string full = stream->str();
+    bsl::istringstream cut(full.substr(0, full.size() - 1));
+
+    WireCapture::Reader reader(cut);
+    ASSERT_TRUE(reader.isValid());
+
+    WireCapture::Record record;
+    EXPECT_FALSE(reader.next(&record));
+}
+
+TEST(WireCaptureTests, RejectsOtherFiles)
+{
+    bsl::istringstream input("not a capture at all");
+
+    WireCapture::Reader reader(input);
+    EXPECT_FALSE(reader.isValid());
+}
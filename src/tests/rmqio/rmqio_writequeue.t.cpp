@@ -0,0 +1,247 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqio_writequeue.h>
+
+#include <rmqamqpt_constants.h>
+#include <rmqio_serializedframe.h>
+
+#include <bdlf_bind.h>
+
+#include <bsl_cstdint.h>
+#include <bsl_memory.h>
+#include <bsl_vector.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqio;
+using namespace ::testing;
+
+namespace {
+
+const bsl::size_t k_NO_LIMIT = 1024 * 1024;
+
+class WriteQueueTests : public Test {
+  protected:
+    WriteQueueTests()
+    : d_payload(bsl::make_shared<bsl::vector<bsl::uint8_t> >(100, 0))
+    , d_written()
+    {
+    }
+
+    bsl::shared_ptr<SerializedFrame> frame(bsl::uint8_t type,
+                                           bsl::uint16_t channel)
+    {
+        return bsl::make_shared<SerializedFrame>(
+            type,
+            channel,
+            d_payload->data(),
+            type == rmqamqpt::Constants::HEARTBEAT ? 0 : d_payload->size(),
+            d_payload);
+    }
+
+    WriteQueue::Frames method(bsl::uint16_t channel)
+    {
+        return WriteQueue::Frames(1,
+                                  frame(rmqamqpt::Constants::METHOD, channel));
+    }
+
+    WriteQueue::Frames publish(bsl::uint16_t channel, int bodies = 1)
+    {
+        WriteQueue::Frames frames = method(channel);
+        frames.push_back(frame(rmqamqpt::Constants::HEADER, channel));
+        for (int i = 0; i < bodies; ++i) {
+            frames.push_back(frame(rmqamqpt::Constants::BODY, channel));
+        }
+        return frames;
+    }
+
+    WriteQueue::Frames heartbeat()
+    {
+        return WriteQueue::Frames(1,
+                                  frame(rmqamqpt::Constants::HEARTBEAT, 0));
+    }
+
+    void push(WriteQueue* queue, const WriteQueue::Frames& frames, int id)
+    {
+        queue->push(frames,
+                    bdlf::BindUtil::bind(&WriteQueueTests::onWritten,
+                                         this,
+                                         id));
+    }
+
+    /// Pop a batch and invoke its callbacks
+    WriteQueue::Batch pop(WriteQueue* queue,
+                          bsl::size_t maxBytes = k_NO_LIMIT)
+    {
+        WriteQueue::Batch batch;
+        queue->pop(&batch, maxBytes, k_NO_LIMIT);
+        for (bsl::size_t i = 0; i < batch.completed.size(); ++i) {
+            batch.completed[i]();
+        }
+        return batch;
+    }
+
+    void onWritten(int id) { d_written.push_back(id); }
+
+    /// The channel of each frame in `batch`
+    static bsl::vector<int> channels(const WriteQueue::Batch& batch)
+    {
+        bsl::vector<int> result;
+        for (bsl::size_t i = 0; i < batch.frames.size(); ++i) {
+            const bsl::uint8_t* header = batch.frames[i]->segment(0).first;
+            result.push_back((header[1] << 8) | header[2]);
+        }
+        return result;
+    }
+
+    bsl::shared_ptr<bsl::vector<bsl::uint8_t> > d_payload;
+    bsl::vector<int> d_written;
+};
+
+} // namespace
+
+TEST_F(WriteQueueTests, ClassifiesContentFrames)
+{
+    EXPECT_FALSE(
+        WriteQueue::isContent(*frame(rmqamqpt::Constants::METHOD, 1)));
+    EXPECT_TRUE(WriteQueue::isContent(*frame(rmqamqpt::Constants::HEADER, 1)));
+    EXPECT_TRUE(WriteQueue::isContent(*frame(rmqamqpt::Constants::BODY, 1)));
+    EXPECT_FALSE(
+        WriteQueue::isContent(*frame(rmqamqpt::Constants::HEARTBEAT, 0)));
+}
+
+TEST_F(WriteQueueTests, ControlOvertakesQueuedPublishes)
+{
+    WriteQueue queue;
+    push(&queue, publish(1), 1);
+    push(&queue, method(2), 2);
+    push(&queue, heartbeat(), 3);
+    EXPECT_THAT(queue.entries(), Eq(3));
+
+    const WriteQueue::Batch batch = pop(&queue);
+    EXPECT_THAT(batch.frames.size(), Eq(5));
+    EXPECT_THAT(d_written, ElementsAre(2, 3, 1));
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST_F(WriteQueueTests, KeepsOrderOnAChannel)
+{
+    WriteQueue queue;
+    push(&queue, publish(1), 1);
+    push(&queue, method(1), 2);
+
+    pop(&queue);
+    EXPECT_THAT(d_written, ElementsAre(1, 2));
+}
+
+TEST_F(WriteQueueTests, ConnectionMethodsWaitForAllPublishes)
+{
+    WriteQueue queue;
+    push(&queue, publish(1), 1);
+    push(&queue, method(0), 2);
+    push(&queue, method(3), 3);
+    push(&queue, heartbeat(), 4);
+    EXPECT_THAT(queue.entries(), Eq(4));
+
+    pop(&queue);
+    EXPECT_THAT(d_written, ElementsAre(4, 1, 2, 3));
+}
+
+TEST_F(WriteQueueTests, ControlInterleavesALargePublishAtFrameBoundaries)
+{
+    // Each frame is 108 bytes, so two fit in a write
+    WriteQueue queue;
+    push(&queue, publish(1, 4), 1);
+
+    WriteQueue::Batch batch = pop(&queue, 250);
+    EXPECT_THAT(batch.frames.size(), Eq(2));
+    EXPECT_THAT(batch.bytes, Eq(216));
+    EXPECT_THAT(d_written, IsEmpty());
+    EXPECT_THAT(queue.entries(), Eq(1));
+
+    push(&queue, heartbeat(), 2);
+    push(&queue, method(2), 3);
+
+    batch = pop(&queue, 250);
+    EXPECT_THAT(batch.frames.size(), Eq(3));
+    EXPECT_THAT(d_written, ElementsAre(2, 3));
+
+    batch = pop(&queue, 250);
+    EXPECT_THAT(batch.frames.size(), Eq(2));
+    EXPECT_THAT(d_written, ElementsAre(2, 3));
+
+    batch = pop(&queue, 250);
+    EXPECT_THAT(batch.frames.size(), Eq(1));
+    EXPECT_THAT(d_written, ElementsAre(2, 3, 1));
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST_F(WriteQueueTests, ChannelIsReleasedOncePublishIsHandedOut)
+{
+    WriteQueue queue;
+    push(&queue, publish(1), 1);
+    pop(&queue);
+
+    push(&queue, publish(2), 2);
+    push(&queue, method(1), 3);
+
+    pop(&queue);
+    EXPECT_THAT(d_written, ElementsAre(1, 3, 2));
+}
+
+TEST_F(WriteQueueTests, ChannelsTakeTurnsAFrameAtATime)
+{
+    WriteQueue queue;
+    push(&queue, publish(1, 2), 1);
+    push(&queue, publish(2, 2), 2);
+
+    const WriteQueue::Batch batch = pop(&queue);
+    EXPECT_THAT(channels(batch), ElementsAre(1, 2, 1, 2, 1, 2, 1, 2));
+    EXPECT_THAT(d_written, ElementsAre(1, 2));
+}
+
+TEST_F(WriteQueueTests, SmallPublishDoesNotWaitForALargeOne)
+{
+    WriteQueue queue;
+    push(&queue, publish(1, 100), 1);
+    push(&queue, publish(2), 2);
+
+    // Three frames of each channel fit
+    pop(&queue, 6 * 108);
+    EXPECT_THAT(d_written, ElementsAre(2));
+    EXPECT_THAT(queue.entries(), Eq(1));
+}
+
+TEST_F(WriteQueueTests, WeightGivesAChannelMoreFramesPerTurn)
+{
+    WriteQueue queue;
+    queue.setWeight(1, 4);
+    EXPECT_THAT(queue.weight(1), Eq(4));
+    EXPECT_THAT(queue.weight(2), Eq(1));
+
+    push(&queue, publish(1, 6), 1);
+    push(&queue, publish(2, 2), 2);
+
+    const WriteQueue::Batch batch = pop(&queue);
+    EXPECT_THAT(channels(batch),
+                ElementsAre(1, 1, 1, 1, 2, 1, 1, 1, 1, 2, 2, 2));
+    EXPECT_THAT(d_written, ElementsAre(1, 2));
+
+    queue.setWeight(1, 0);
+    EXPECT_THAT(queue.weight(1), Eq(1));
+}
@@ -0,0 +1,112 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqt_awaitable.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#ifdef RMQT_AWAITABLE_SUPPORTED
+
+#include <rmqt_future.h>
+#include <rmqt_result.h>
+
+#include <bsl_functional.h>
+#include <bsl_memory.h>
+#include <bsl_vector.h>
+
+#include <exception>
+
+using namespace BloombergLP;
+using namespace rmqt;
+using namespace ::testing;
+
+namespace {
+
+/// Fire-and-forget coroutine which runs to completion on its own
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() { return Detached(); }
+        std::suspend_never initial_suspend() { return std::suspend_never(); }
+        std::suspend_never final_suspend() noexcept
+        {
+            return std::suspend_never();
+        }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+Detached awaitInline(Future<int> future, bsl::shared_ptr<int> out)
+{
+    Result<int> result = co_await future;
+    *out               = *result.value();
+}
+
+Detached awaitOnExecutor(Future<int> future,
+                         Awaitable<int>::Executor executor,
+                         bsl::shared_ptr<int> out)
+{
+    Result<int> result = co_await Awaitable<int>(future, executor);
+    *out               = *result.value();
+}
+
+void queueJob(bsl::vector<bsl::function<void()> >* jobs,
+              const bsl::function<void()>& job)
+{
+    jobs->push_back(job);
+}
+
+} // namespace
+
+TEST(Awaitable, ResolvedFutureDoesNotSuspend)
+{
+    bsl::shared_ptr<int> out = bsl::make_shared<int>(0);
+    awaitInline(Future<int>(Result<int>(bsl::make_shared<int>(7))), out);
+    EXPECT_THAT(*out, Eq(7));
+}
+
+TEST(Awaitable, ResumesWhenTheFutureResolves)
+{
+    Future<int>::Pair pair   = Future<int>::make();
+    bsl::shared_ptr<int> out = bsl::make_shared<int>(0);
+
+    awaitInline(pair.second, out);
+    EXPECT_THAT(*out, Eq(0));
+
+    pair.first(Result<int>(bsl::make_shared<int>(3)));
+    EXPECT_THAT(*out, Eq(3));
+}
+
+TEST(Awaitable, ResumesThroughTheExecutor)
+{
+    Future<int>::Pair pair   = Future<int>::make();
+    bsl::shared_ptr<int> out = bsl::make_shared<int>(0);
+    bsl::vector<bsl::function<void()> > jobs;
+
+    awaitOnExecutor(
+        pair.second,
+        bdlf::BindUtil::bind(&queueJob, &jobs, bdlf::PlaceHolders::_1),
+        out);
+
+    pair.first(Result<int>(bsl::make_shared<int>(5)));
+    ASSERT_THAT(jobs.size(), Eq(1u));
+    EXPECT_THAT(*out, Eq(0));
+
+    jobs[0]();
+    EXPECT_THAT(*out, Eq(5));
+}
+
+#endif
@@ -0,0 +1,112 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <rmqt_consumerackqueue.h>
+
+#include <rmqt_consumerack.h>
+#include <rmqt_envelope.h>
+
+#include <bdlf_bind.h>
+#include <bslmt_threadutil.h>
+
+#include <bsl_vector.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqt;
+using namespace ::testing;
+
+namespace {
+const int k_ACKS_PER_THREAD = 10000;
+
+ConsumerAck makeAck(uint64_t deliveryTag)
+{
+    return ConsumerAck(
+        Envelope(deliveryTag, 1, "consumer", "exchange", "key", false),
+        ConsumerAck::ACK);
+}
+
+void pushAcks(ConsumerAckQueue* queue, int thread)
+{
+    for (int i = 0; i < k_ACKS_PER_THREAD; ++i) {
+        queue->push(makeAck(thread * k_ACKS_PER_THREAD + i));
+    }
+}
+} // namespace
+
+TEST(ConsumerAckQueue, OnlyFirstPushAsksForDrain)
+{
+    ConsumerAckQueue queue;
+
+    EXPECT_TRUE(queue.push(makeAck(1)));
+    EXPECT_FALSE(queue.push(makeAck(2)));
+
+    bsl::vector<ConsumerAck> acks;
+    queue.drain(&acks);
+    ASSERT_THAT(acks, SizeIs(2));
+    EXPECT_THAT(acks[0].envelope().deliveryTag(), Eq(1u));
+    EXPECT_THAT(acks[1].envelope().deliveryTag(), Eq(2u));
+
+    // Idle again after the drain
+    EXPECT_TRUE(queue.push(makeAck(3)));
+}
+
+TEST(ConsumerAckQueue, ClearDropsQueuedAcks)
+{
+    ConsumerAckQueue queue;
+
+    queue.push(makeAck(1));
+    queue.clear();
+
+    bsl::vector<ConsumerAck> acks;
+    queue.drain(&acks);
+    EXPECT_THAT(acks, IsEmpty());
+}
+
+TEST(ConsumerAckQueue, ConcurrentPushesAreAllDrained)
+{
+    ConsumerAckQueue queue;
+
+    const int k_THREADS = 4;
+    bsl::vector<bslmt::ThreadUtil::Handle> threads(k_THREADS);
+    for (int i = 0; i < k_THREADS; ++i) {
+        ASSERT_THAT(
+            bslmt::ThreadUtil::create(
+                &threads[i], bdlf::BindUtil::bind(&pushAcks, &queue, i)),
+            Eq(0));
+    }
+
+    bsl::vector<ConsumerAck> acks;
+    while (acks.size() <
+           static_cast<bsl::size_t>(k_THREADS * k_ACKS_PER_THREAD)) {
+        queue.drain(&acks);
+    }
+
+    for (int i = 0; i < k_THREADS; ++i) {
+        bslmt::ThreadUtil::join(threads[i]);
+    }
+
+    // Each thread's acks stay in the order it pushed them
+    bsl::vector<uint64_t> next(k_THREADS);
+    for (int i = 0; i < k_THREADS; ++i) {
+        next[i] = i * k_ACKS_PER_THREAD;
+    }
+    for (bsl::size_t i = 0; i < acks.size(); ++i) {
+        const uint64_t tag = acks[i].envelope().deliveryTag();
+        EXPECT_THAT(tag, Eq(next[tag / k_ACKS_PER_THREAD]++));
+    }
+}
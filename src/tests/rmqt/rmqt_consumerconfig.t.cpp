@@ -15,13 +15,20 @@
 
 #include <rmqt_consumerconfig.h>
 
+#include <rmqt_envelope.h>
+#include <rmqt_fieldvalue.h>
+#include <rmqt_message.h>
 #include <rmqt_properties.h>
+#include <rmqt_streamoffset.h>
 
 #include <bdlmt_threadpool.h>
 #include <bslmt_threadattributes.h>
 
 #include <gtest/gtest.h>
 
+#include <bsl_memory.h>
+#include <bsl_vector.h>
+
 using namespace BloombergLP;
 using namespace ::testing;
 
@@ -63,3 +70,86 @@ TEST(ConsumerConfig, SetConsumerPriority)
     EXPECT_TRUE(config.consumerPriority());
     EXPECT_EQ(config.consumerPriority(), 5);
 }
+
+TEST(ConsumerConfig, SetLazyHeaders)
+{
+    rmqt::ConsumerConfig config;
+
+    EXPECT_FALSE(config.lazyHeaders());
+
+    config.setLazyHeaders();
+
+    EXPECT_TRUE(config.lazyHeaders());
+}
+
+TEST(ConsumerConfig, SetDecodedProperties)
+{
+    rmqt::ConsumerConfig config;
+
+    EXPECT_EQ(config.decodedProperties(), rmqt::MessageProperty::ALL);
+
+    config.setDecodedProperties(rmqt::MessageProperty::MESSAGE_ID |
+                                rmqt::MessageProperty::CORRELATION_ID);
+
+    EXPECT_EQ(config.decodedProperties(),
+              rmqt::MessageProperty::MESSAGE_ID |
+                  rmqt::MessageProperty::CORRELATION_ID);
+}
+
+TEST(ConsumerConfig, SetNoAck)
+{
+    rmqt::ConsumerConfig config;
+
+    EXPECT_FALSE(config.noAck());
+
+    config.setNoAck();
+
+    EXPECT_TRUE(config.noAck());
+}
+
+TEST(ConsumerConfig, SetPartitionKeyHeader)
+{
+    rmqt::ConsumerConfig config;
+
+    EXPECT_EQ(config.partitions(), bsl::size_t(0));
+    EXPECT_FALSE(config.partitionKey());
+
+    config.setPartitions(8).setPartitionKeyHeader("account");
+
+    EXPECT_EQ(config.partitions(), bsl::size_t(8));
+    ASSERT_TRUE(config.partitionKey());
+
+    rmqt::FieldTable headers;
+    headers["account"] = rmqt::FieldValue(bsl::string("1234"));
+    rmqt::Message withHeader(bsl::make_shared<bsl::vector<uint8_t> >(),
+                             "message-id",
+                             bsl::make_shared<rmqt::FieldTable>(headers));
+    rmqt::Message withoutHeader(bsl::make_shared<bsl::vector<uint8_t> >());
+    const rmqt::Envelope envelope(1, 0, "tag", "exchange", "key", false);
+
+    EXPECT_EQ(config.partitionKey()(withHeader, envelope),
+              config.partitionKey()(withHeader, envelope));
+    EXPECT_NE(config.partitionKey()(withHeader, envelope),
+              config.partitionKey()(withoutHeader, envelope));
+    EXPECT_EQ(config.partitionKey()(withoutHeader, envelope), "");
+}
+
+TEST(ConsumerConfig, ForStream)
+{
+    const rmqt::ConsumerConfig config = rmqt::ConsumerConfig::forStream(
+        rmqt::StreamOffset::offset(100), "tag");
+
+    EXPECT_EQ(config.consumerTag(), "tag");
+    ASSERT_TRUE(config.streamOffset());
+    EXPECT_EQ(config.streamOffset().value(), rmqt::StreamOffset::offset(100));
+    EXPECT_EQ(config.prefetchCount(),
+              rmqt::ConsumerConfig::s_defaultStreamPrefetchCount);
+    EXPECT_GT(config.ackCoalescingDelay(), bsls::TimeInterval());
+    EXPECT_GT(config.ackCoalescingTags(), bsl::size_t(0));
+    EXPECT_FALSE(config.noAck());
+}
+
+TEST(ConsumerConfig, NoStreamOffsetByDefault)
+{
+    EXPECT_FALSE(rmqt::ConsumerConfig().streamOffset());
+}
@@ -18,6 +18,7 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <bsl_memory.h>
 #include <bsl_sstream.h>
 #include <bsl_string.h>
 
@@ -50,3 +51,45 @@ TEST(EnvelopeTests, StreamOut)
     EXPECT_THAT(output, HasSubstr("myRoutingKey"));
     EXPECT_THAT(output, HasSubstr("true"));
 }
+
+TEST(EnvelopeTests, SharesConsumerTagAndExchange)
+{
+    const bsl::shared_ptr<const bsl::string> consumerTag =
+        bsl::make_shared<const bsl::string>("consumerTag");
+    const bsl::shared_ptr<const bsl::string> exchange =
+        bsl::make_shared<const bsl::string>("exchange");
+
+    rmqt::Envelope first(1, 2, consumerTag, exchange, "first", false);
+    rmqt::Envelope second(2, 2, consumerTag, exchange, "second", true);
+
+    EXPECT_THAT(&first.consumerTag(), Eq(consumerTag.get()));
+    EXPECT_THAT(&second.exchange(), Eq(&first.exchange()));
+    EXPECT_THAT(second.routingKey(), Eq("second"));
+
+    const rmqt::Envelope copy(second);
+    EXPECT_THAT(&copy.consumerTag(), Eq(consumerTag.get()));
+    EXPECT_THAT(copy.deliveryTag(), Eq(2));
+}
+
+TEST(EnvelopeTests, EmptyStringsAreShared)
+{
+    rmqt::Envelope first(1, 2, "", "", "", false);
+    rmqt::Envelope second(1, 2, "consumerTag", "", "", false);
+
+    EXPECT_THAT(first.exchange(), Eq(""));
+    EXPECT_THAT(&second.exchange(), Eq(&first.consumerTag()));
+}
+
+TEST(EnvelopeTests, StreamOffset)
+{
+    rmqt::Envelope envelope(1, 2, "consumerTag", "", "", false);
+    EXPECT_FALSE(envelope.streamOffset());
+
+    envelope.setStreamOffset(77);
+    ASSERT_TRUE(envelope.streamOffset());
+    EXPECT_THAT(envelope.streamOffset().value(), Eq(77));
+
+    bsl::ostringstream output;
+    output << envelope;
+    EXPECT_THAT(output.str(), HasSubstr("streamOffset: 77"));
+}
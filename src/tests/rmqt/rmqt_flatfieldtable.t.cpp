@@ -0,0 +1,146 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqt_flatfieldtable.h>
+
+#include <rmqt_fieldvalue.h>
+
+#include <bslma_testallocator.h>
+
+#include <bsl_memory.h>
+#include <bsl_sstream.h>
+#include <bsl_string.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace ::testing;
+
+TEST(FlatFieldTable, Breathing)
+{
+    rmqt::FlatFieldTable table;
+    EXPECT_TRUE(table.empty());
+    EXPECT_THAT(table.size(), Eq(0));
+    EXPECT_FALSE(table.find("key"));
+    EXPECT_FALSE(table.erase("key"));
+}
+
+TEST(FlatFieldTable, KeepsKeysSorted)
+{
+    rmqt::FlatFieldTable table;
+    EXPECT_TRUE(table.insert("b", rmqt::FieldValue(int32_t(2))));
+    EXPECT_TRUE(table.insert("c", rmqt::FieldValue(int32_t(3))));
+    EXPECT_TRUE(table.insert("a", rmqt::FieldValue(int32_t(1))));
+
+    ASSERT_THAT(table.size(), Eq(3));
+    rmqt::FlatFieldTable::const_iterator it = table.begin();
+    EXPECT_THAT(it->first, Eq("a"));
+    EXPECT_THAT((++it)->first, Eq("b"));
+    EXPECT_THAT((++it)->first, Eq("c"));
+
+    ASSERT_TRUE(table.find("b"));
+    EXPECT_THAT(*table.find("b"), Eq(rmqt::FieldValue(int32_t(2))));
+}
+
+TEST(FlatFieldTable, InsertDoesNotOverwrite)
+{
+    rmqt::FlatFieldTable table;
+    EXPECT_TRUE(table.insert("key", rmqt::FieldValue(int32_t(1))));
+    EXPECT_FALSE(table.insert("key", rmqt::FieldValue(int32_t(2))));
+    EXPECT_FALSE(table.emplace("key"));
+    EXPECT_THAT(*table.find("key"), Eq(rmqt::FieldValue(int32_t(1))));
+
+    table.set("key", rmqt::FieldValue(int32_t(3)));
+    table.set("other", rmqt::FieldValue(true));
+    EXPECT_THAT(table.size(), Eq(2));
+    EXPECT_THAT(*table.find("key"), Eq(rmqt::FieldValue(int32_t(3))));
+    EXPECT_THAT(*table.find("other"), Eq(rmqt::FieldValue(true)));
+}
+
+TEST(FlatFieldTable, Erase)
+{
+    rmqt::FlatFieldTable table;
+    table.set("a", rmqt::FieldValue(int32_t(1)));
+    table.set("b", rmqt::FieldValue(int32_t(2)));
+
+    EXPECT_TRUE(table.erase("a"));
+    EXPECT_FALSE(table.erase("a"));
+    EXPECT_FALSE(table.find("a"));
+    EXPECT_TRUE(table.find("b"));
+    EXPECT_THAT(table.size(), Eq(1));
+}
+
+TEST(FlatFieldTable, ConvertsToAndFromFieldTable)
+{
+    bsl::shared_ptr<rmqt::FieldTable> nested =
+        bsl::make_shared<rmqt::FieldTable>();
+    (*nested)["depth"] = rmqt::FieldValue(int32_t(2));
+
+    rmqt::FieldTable table;
+    table["trace"]  = rmqt::FieldValue(bsl::string("abc"));
+    table["nested"] = rmqt::FieldValue(nested);
+    table["flag"]   = rmqt::FieldValue(false);
+
+    const rmqt::FlatFieldTable flat(table);
+    EXPECT_THAT(flat.size(), Eq(table.size()));
+    EXPECT_THAT(*flat.find("nested"), Eq(rmqt::FieldValue(nested)));
+
+    const bsl::shared_ptr<rmqt::FieldTable> converted = flat.toFieldTable();
+    ASSERT_TRUE(converted);
+    EXPECT_THAT(*converted, Eq(table));
+}
+
+TEST(FlatFieldTable, Equality)
+{
+    rmqt::FlatFieldTable lhs;
+    lhs.set("a", rmqt::FieldValue(int32_t(1)));
+    rmqt::FlatFieldTable rhs(lhs);
+    EXPECT_TRUE(lhs == rhs);
+
+    rhs.set("a", rmqt::FieldValue(int32_t(2)));
+    EXPECT_TRUE(lhs != rhs);
+
+    rhs = lhs;
+    rhs.set("b", rmqt::FieldValue(int32_t(2)));
+    EXPECT_TRUE(lhs != rhs);
+}
+
+TEST(FlatFieldTable, UsesTableAllocator)
+{
+    bslma::TestAllocator allocator;
+    {
+        rmqt::FlatFieldTable table(&allocator);
+        table.reserve(2);
+        table.set("a-long-key-which-is-not-short",
+                  rmqt::FieldValue(bsl::string(40, 'v')));
+
+        EXPECT_THAT(table.allocator(), Eq(&allocator));
+        // The entries, the key and the string value
+        EXPECT_THAT(allocator.numBlocksInUse(), Eq(3));
+    }
+    EXPECT_THAT(allocator.numBlocksInUse(), Eq(0));
+}
+
+TEST(FlatFieldTable, Print)
+{
+    rmqt::FlatFieldTable table;
+    table.set("b", rmqt::FieldValue(bsl::string("x")));
+    table.set("a", rmqt::FieldValue(int32_t(1)));
+
+    bsl::ostringstream oss;
+    oss << table;
+    EXPECT_THAT(oss.str(), Eq(" [ a = 1, b = \"x\" ]"));
+}
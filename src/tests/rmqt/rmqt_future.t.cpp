@@ -405,6 +405,33 @@ TEST_F(FutureTesting, thenFutureAfterResolve)
     EXPECT_THAT(*thirdFuture.blockResult().value(), Eq(44));
 }
 
+TEST_F(FutureTesting, severalThensOnOneFuture)
+{
+    rmqt::Future<int>::Pair resultMaker = rmqt::Future<int>::make();
+
+    // The first continuation is held inline, the rest are allocated
+    rmqt::Future<double> first  = resultMaker.second.then<double>(&convert);
+    rmqt::Future<double> second = resultMaker.second.then<double>(&convert);
+    rmqt::Future<int> third =
+        resultMaker.second.thenFuture<int>(&asyncIncrement);
+
+    resultMaker.first(rmqt::Result<int>(bsl::make_shared<int>(1)));
+
+    EXPECT_THAT(*first.tryResult().value(), Eq(2.0));
+    EXPECT_THAT(*second.tryResult().value(), Eq(2.0));
+    EXPECT_THAT(*third.blockResult().value(), Eq(2));
+}
+
+TEST_F(FutureTesting, onlyTheFirstResultIsKept)
+{
+    rmqt::Future<int>::Pair resultMaker = rmqt::Future<int>::make();
+
+    resultMaker.first(rmqt::Result<int>(bsl::make_shared<int>(1)));
+    resultMaker.first(rmqt::Result<int>(bsl::make_shared<int>(2)));
+
+    EXPECT_THAT(*resultMaker.second.tryResult().value(), Eq(1));
+}
+
 TEST_F(FutureTesting, chainAfterMade)
 {
     rmqt::Future<int>::Pair resultMaker = rmqt::Future<int>::make();
@@ -706,3 +733,41 @@ TEST_F(FutureTesting, flattenWithReallyLongMakeCleansUp)
     EXPECT_FALSE(flattenedFuture->tryResult());
     flattenedFuture.reset();
 }
+
+TEST_F(FutureTesting, whenAllWaitsForEveryFuture)
+{
+    rmqt::Future<>::Pair first  = rmqt::Future<>::make();
+    rmqt::Future<>::Pair second = rmqt::Future<>::make();
+
+    bsl::vector<rmqt::Future<> > futures;
+    futures.push_back(first.second);
+    futures.push_back(second.second);
+    rmqt::Future<> all = rmqt::FutureUtil::whenAll(futures);
+
+    second.first(rmqt::Result<>());
+    EXPECT_FALSE(all.tryResult());
+
+    first.first(rmqt::Result<>());
+    EXPECT_TRUE(all.tryResult());
+}
+
+TEST_F(FutureTesting, whenAllResolvesWithTheFirstError)
+{
+    rmqt::Future<>::Pair first  = rmqt::Future<>::make();
+    rmqt::Future<>::Pair second = rmqt::Future<>::make();
+
+    bsl::vector<rmqt::Future<> > futures;
+    futures.push_back(first.second);
+    futures.push_back(second.second);
+    rmqt::Future<> all = rmqt::FutureUtil::whenAll(futures);
+
+    first.first(rmqt::Result<>("Fail"));
+    second.first(rmqt::Result<>());
+    EXPECT_THAT(all.blockResult().error(), Eq("Fail"));
+}
+
+TEST_F(FutureTesting, whenAllOfNothingSucceeds)
+{
+    EXPECT_TRUE(
+        rmqt::FutureUtil::whenAll(bsl::vector<rmqt::Future<> >()).tryResult());
+}
@@ -0,0 +1,46 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <rmqt_localendpoint.h>
+#include <rmqt_simpleendpoint.h>
+
+using namespace BloombergLP;
+using namespace rmqt;
+
+TEST(LocalEndpoint, FormatAddress)
+{
+    LocalEndpoint e("/var/run/rabbitmq.sock", "rmq-testing");
+    ASSERT_EQ("amqp+unix:///var/run/rabbitmq.sock/rmq-testing",
+              e.formatAddress());
+}
+
+TEST(LocalEndpoint, HostIsTheSocketPath)
+{
+    LocalEndpoint e("/var/run/rabbitmq.sock", "rmq-testing");
+    EXPECT_EQ("/var/run/rabbitmq.sock", e.localPath());
+    EXPECT_EQ(Endpoint::HostList(
+                  1, Endpoint::Host("/var/run/rabbitmq.sock", 0)),
+              e.hosts());
+    EXPECT_EQ("rmq-testing", e.vhost());
+}
+
+TEST(LocalEndpoint, NetworkEndpointsHaveNoPath)
+{
+    SimpleEndpoint e("test.example.com", "rmq-testing");
+    EXPECT_TRUE(e.localPath().empty());
+}
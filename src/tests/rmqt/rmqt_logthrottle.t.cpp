@@ -0,0 +1,112 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqt_logthrottle.h>
+
+#include <bsls_timeinterval.h>
+
+#include <bsl_sstream.h>
+
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqt;
+
+namespace {
+
+class LogThrottleTests : public ::testing::Test {
+  public:
+    LogThrottleTests()
+    : d_messages(LogThrottle::messageLimit())
+    , d_window(LogThrottle::window())
+    , d_now(1000, 0)
+    {
+        LogThrottle::setLimit(3, bsls::TimeInterval(10, 0));
+    }
+
+    ~LogThrottleTests() { LogThrottle::setLimit(d_messages, d_window); }
+
+  protected:
+    int d_messages;
+    bsls::TimeInterval d_window;
+    bsls::TimeInterval d_now;
+};
+
+} // namespace
+
+TEST_F(LogThrottleTests, PermitsUpToTheLimitPerWindow)
+{
+    LogThrottle throttle;
+    int suppressed = -1;
+
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_TRUE(throttle.permit(&suppressed, d_now));
+        EXPECT_EQ(0, suppressed);
+    }
+    EXPECT_FALSE(throttle.permit(&suppressed, d_now));
+    EXPECT_FALSE(throttle.permit(&suppressed, d_now + bsls::TimeInterval(9)));
+}
+
+TEST_F(LogThrottleTests, ReportsSuppressedOnceTheWindowPasses)
+{
+    LogThrottle throttle;
+    int suppressed = 0;
+
+    for (int i = 0; i < 10; ++i) {
+        throttle.permit(&suppressed, d_now);
+    }
+
+    EXPECT_TRUE(throttle.permit(&suppressed, d_now + bsls::TimeInterval(10)));
+    EXPECT_EQ(7, suppressed);
+
+    EXPECT_TRUE(throttle.permit(&suppressed, d_now + bsls::TimeInterval(10)));
+    EXPECT_EQ(0, suppressed);
+}
+
+TEST_F(LogThrottleTests, ZeroLimitTurnsThrottlingOff)
+{
+    LogThrottle::setLimit(0, bsls::TimeInterval(10, 0));
+    LogThrottle throttle;
+    int suppressed = 0;
+
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_TRUE(throttle.permit(&suppressed, d_now));
+    }
+}
+
+TEST_F(LogThrottleTests, SameSiteSharesAThrottle)
+{
+    const char* file = __FILE__;
+    EXPECT_EQ(&LogThrottle::forSite(file, 10),
+              &LogThrottle::forSite(file, 10));
+}
+
+TEST_F(LogThrottleTests, PermitIsTakenOnceAndPrintsTheSummary)
+{
+    LogThrottle throttle;
+    int suppressed = 0;
+    for (int i = 0; i < 5; ++i) {
+        throttle.permit(&suppressed, bsls::TimeInterval(0, 0));
+    }
+    LogThrottle::setLimit(3, bsls::TimeInterval(0, 0));
+
+    LogPermit permit(throttle);
+    EXPECT_TRUE(permit.take());
+    EXPECT_FALSE(permit.take());
+
+    bsl::ostringstream os;
+    os << permit;
+    EXPECT_EQ("(2 similar messages suppressed) ", os.str());
+}
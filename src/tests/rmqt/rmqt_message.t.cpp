@@ -15,6 +15,13 @@
 
 #include <rmqt_message.h>
 
+#include <rmqt_fieldtableview.h>
+#include <rmqt_fieldvalue.h>
+
+#include <bslma_defaultallocatorguard.h>
+#include <bslma_testallocator.h>
+#include <bsls_keyword.h>
+
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
@@ -26,6 +33,51 @@
 using namespace BloombergLP;
 using namespace ::testing;
 
+namespace {
+
+/// Counts releases of an externally owned payload
+class CountRelease {
+  public:
+    explicit CountRelease(int* releases)
+    : d_releases(releases)
+    {
+    }
+
+    void operator()(const uint8_t*) const { ++*d_releases; }
+
+  private:
+    int* d_releases;
+};
+
+class StubTableView : public rmqt::FieldTableView {
+  public:
+    explicit StubTableView(const bsl::shared_ptr<rmqt::FieldTable>& table)
+    : d_table(table)
+    {
+    }
+
+    bool find(rmqt::FieldValue* value,
+              const bsl::string& key) const BSLS_KEYWORD_OVERRIDE
+    {
+        rmqt::FieldTable::const_iterator it = d_table->find(key);
+        if (it == d_table->end()) {
+            return false;
+        }
+        *value = it->second;
+        return true;
+    }
+
+    bsl::shared_ptr<rmqt::FieldTable> table() const BSLS_KEYWORD_OVERRIDE
+    {
+        return d_table;
+    }
+
+  private:
+    bsl::shared_ptr<rmqt::FieldTable> d_table;
+};
+
+} // namespace
+
 TEST(MessageTests, Breathing)
 {
     rmqt::Message msg;
@@ -81,3 +133,182 @@ TEST(MessageTests, UpdateProperties)
     msg.updateMessagePriority(priority_1);
     EXPECT_THAT(msg.properties().priority.value(), Eq(priority_1));
 }
+
+TEST(MessageTests, CopiesSharePropertiesUntilChanged)
+{
+    rmqt::Properties properties;
+    properties.messageId   = "id-1";
+    properties.contentType = "a content type too long to be held inline";
+    const rmqt::Message msg(
+        bsl::make_shared<bsl::vector<uint8_t> >(), properties);
+
+    bslma::TestAllocator allocator;
+    {
+        bslma::DefaultAllocatorGuard guard(&allocator);
+        rmqt::Message copy(msg);
+        const rmqt::Message& constCopy = copy;
+        EXPECT_THAT(&constCopy.properties(), Eq(&msg.properties()));
+        EXPECT_THAT(allocator.numAllocations(), Eq(0));
+
+        copy.updateMessagePriority(3);
+        EXPECT_THAT(&constCopy.properties(), Ne(&msg.properties()));
+    }
+    EXPECT_FALSE(msg.properties().priority);
+    EXPECT_THAT(msg.properties().contentType.value(),
+                Eq("a content type too long to be held inline"));
+}
+
+TEST(MessageTests, WithNewGuidSharesPayloadAndProperties)
+{
+    const rmqt::Message msg(
+        bsl::make_shared<bsl::vector<uint8_t> >(2000, 'a'));
+
+    const rmqt::Message copy = msg.withNewGuid();
+
+    EXPECT_THAT(copy.guid(), Ne(msg.guid()));
+    EXPECT_THAT(copy.messageId(), Eq(msg.messageId()));
+    EXPECT_THAT(copy.payload(), Eq(msg.payload()));
+    EXPECT_THAT(&copy.properties(), Eq(&msg.properties()));
+}
+
+TEST(MessageTests, SegmentedPayload)
+{
+    bsl::shared_ptr<bsl::vector<uint8_t> > first =
+        bsl::make_shared<bsl::vector<uint8_t> >(3, 'a');
+    bsl::shared_ptr<bsl::vector<uint8_t> > second =
+        bsl::make_shared<bsl::vector<uint8_t> >(2, 'b');
+
+    bsl::shared_ptr<rmqt::SegmentedPayload> payload =
+        bsl::make_shared<rmqt::SegmentedPayload>();
+    payload->append(first->data(), first->size(), first);
+    payload->append(second->data(), second->size(), second);
+
+    rmqt::Message msg(bsl::shared_ptr<const rmqt::SegmentedPayload>(payload),
+                      rmqt::Properties());
+    EXPECT_FALSE(msg.messageId().empty());
+    EXPECT_THAT(msg.payloadSize(), Eq(5));
+    ASSERT_TRUE(msg.payloadSegments());
+    EXPECT_THAT(msg.payloadSegments()->numSegments(), Eq(2));
+
+    bsl::vector<uint8_t> streamed;
+    for (rmqt::SegmentedPayload::const_iterator it =
+             msg.payloadSegments()->begin();
+         it != msg.payloadSegments()->end();
+         ++it) {
+        streamed.insert(streamed.end(), it->first, it->first + it->second);
+    }
+    EXPECT_THAT(bsl::string(streamed.begin(), streamed.end()), Eq("aaabb"));
+
+    // Flattening happens once and is shared between copies
+    rmqt::Message copy(msg);
+    ASSERT_TRUE(msg.payload());
+    EXPECT_THAT(bsl::string(msg.payload(), msg.payload() + 5), Eq("aaabb"));
+    EXPECT_THAT(copy.payload(), Eq(msg.payload()));
+}
+
+TEST(MessageTests, SingleSegmentIsNotCopied)
+{
+    bsl::shared_ptr<bsl::vector<uint8_t> > data =
+        bsl::make_shared<bsl::vector<uint8_t> >(4, 'x');
+
+    bsl::shared_ptr<rmqt::SegmentedPayload> payload =
+        bsl::make_shared<rmqt::SegmentedPayload>();
+    payload->append(data->data(), data->size(), data);
+
+    rmqt::Message msg(bsl::shared_ptr<const rmqt::SegmentedPayload>(payload),
+                      rmqt::Properties());
+    EXPECT_THAT(msg.payload(), Eq(data->data()));
+}
+
+TEST(MessageTests, ExternalPayloadIsReleasedWithTheLastReference)
+{
+    const uint8_t slab[] = {'a', 'b', 'c', 'd'};
+    int releases         = 0;
+    {
+        rmqt::Message copy;
+        {
+            rmqt::Message msg(slab,
+                              sizeof(slab),
+                              bsl::shared_ptr<const void>(
+                                  slab, CountRelease(&releases)),
+                              rmqt::Properties());
+            EXPECT_THAT(msg.payload(), Eq(slab));
+            EXPECT_THAT(msg.payloadSize(), Eq(sizeof(slab)));
+            copy = msg;
+        }
+        EXPECT_THAT(releases, Eq(0));
+        EXPECT_THAT(copy.payload(), Eq(slab));
+    }
+    EXPECT_THAT(releases, Eq(1));
+}
+
+TEST(MessageTests, SmallPayloadIsHeldInline)
+{
+    const uint8_t data[] = {'h', 'e', 'l', 'l', 'o'};
+    rmqt::Properties properties;
+    properties.messageId = "id-1";
+    const rmqt::Message msg(data, sizeof(data), properties);
+
+    bslma::TestAllocator allocator;
+    bslma::DefaultAllocatorGuard guard(&allocator);
+    {
+        rmqt::Message copy(msg);
+        rmqt::Message assigned;
+        assigned = copy;
+
+        EXPECT_FALSE(msg.payloadOwner());
+        EXPECT_THAT(msg.payloadSize(), Eq(sizeof(data)));
+        EXPECT_THAT(bsl::string(assigned.payload(),
+                                assigned.payload() + assigned.payloadSize()),
+                    Eq("hello"));
+        EXPECT_THAT(copy.payload(), Ne(msg.payload()));
+    }
+    EXPECT_THAT(allocator.numAllocations(), Eq(0));
+}
+
+TEST(MessageTests, LargePayloadIsCopiedToTheHeap)
+{
+    const bsl::vector<uint8_t> data(rmqt::Message::INLINE_PAYLOAD_CAPACITY + 1,
+                                    'x');
+    const rmqt::Message msg(data.data(), data.size(), rmqt::Properties());
+
+    EXPECT_TRUE(msg.payloadOwner());
+    EXPECT_THAT(msg.payloadSize(), Eq(data.size()));
+    EXPECT_THAT(bsl::vector<uint8_t>(msg.payload(),
+                                     msg.payload() + msg.payloadSize()),
+                Eq(data));
+}
+
+TEST(MessageTests, FindHeader)
+{
+    bsl::shared_ptr<rmqt::FieldTable> headers =
+        bsl::make_shared<rmqt::FieldTable>();
+    (*headers)["trace"] = rmqt::FieldValue(bsl::string("abc"));
+    rmqt::Message msg(bsl::make_shared<bsl::vector<uint8_t> >(), "", headers);
+
+    rmqt::FieldValue value;
+    EXPECT_TRUE(msg.findHeader(&value, "trace"));
+    EXPECT_THAT(value, Eq(rmqt::FieldValue(bsl::string("abc"))));
+    EXPECT_FALSE(msg.findHeader(&value, "missing"));
+    EXPECT_THAT(msg.decodedHeaders(), Eq(headers));
+
+    EXPECT_FALSE(rmqt::Message().findHeader(&value, "trace"));
+}
+
+TEST(MessageTests, FindLazyHeader)
+{
+    bsl::shared_ptr<rmqt::FieldTable> headers =
+        bsl::make_shared<rmqt::FieldTable>();
+    (*headers)["trace"] = rmqt::FieldValue(bsl::string("abc"));
+    rmqt::Message msg(bsl::make_shared<bsl::vector<uint8_t> >());
+    msg.setHeadersView(bsl::make_shared<StubTableView>(headers));
+
+    EXPECT_FALSE(msg.headers());
+    EXPECT_TRUE(msg.headersView());
+
+    rmqt::FieldValue value;
+    EXPECT_TRUE(msg.findHeader(&value, "trace"));
+    EXPECT_THAT(value, Eq(rmqt::FieldValue(bsl::string("abc"))));
+    EXPECT_FALSE(msg.findHeader(&value, "missing"));
+    EXPECT_THAT(msg.decodedHeaders(), Eq(headers));
+}
@@ -0,0 +1,75 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqt_messageguidutil.h>
+
+#include <rmqt_message.h>
+
+#include <bdlb_guid.h>
+#include <bdlb_guidutil.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <bsl_memory.h>
+#include <bsl_set.h>
+#include <bsl_vector.h>
+
+using namespace BloombergLP;
+using namespace ::testing;
+
+namespace {
+
+class MessageGuidUtilTests : public Test {
+  public:
+    ~MessageGuidUtilTests()
+    {
+        rmqt::MessageGuidUtil::setMode(rmqt::MessageGuidMode::RANDOM);
+    }
+};
+
+} // namespace
+
+TEST_F(MessageGuidUtilTests, RandomByDefault)
+{
+    EXPECT_THAT(rmqt::MessageGuidUtil::mode(),
+                Eq(rmqt::MessageGuidMode::RANDOM));
+}
+
+TEST_F(MessageGuidUtilTests, CounterGuidsAreUnique)
+{
+    rmqt::MessageGuidUtil::setMode(rmqt::MessageGuidMode::COUNTER);
+
+    bsl::set<bdlb::Guid> guids;
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(guids.insert(rmqt::MessageGuidUtil::generate()).second);
+    }
+}
+
+TEST_F(MessageGuidUtilTests, MessagesUseTheCounter)
+{
+    rmqt::MessageGuidUtil::setMode(rmqt::MessageGuidMode::COUNTER);
+
+    const rmqt::Message first(bsl::make_shared<bsl::vector<uint8_t> >());
+    const rmqt::Message second(bsl::make_shared<bsl::vector<uint8_t> >());
+
+    EXPECT_THAT(first.guid(), Ne(second.guid()));
+    EXPECT_THAT(first.messageId(),
+                Eq(bdlb::GuidUtil::guidToString(first.guid())));
+
+    // Same thread, so same prefix
+    EXPECT_THAT(bdlb::GuidUtil::getMostSignificantBits(first.guid()),
+                Eq(bdlb::GuidUtil::getMostSignificantBits(second.guid())));
+}
@@ -0,0 +1,79 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqt_payloadwriter.h>
+
+#include <rmqt_message.h>
+#include <rmqt_properties.h>
+
+#include <bslma_testallocator.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <bsl_cstring.h>
+#include <bsl_string.h>
+
+using namespace BloombergLP;
+using namespace ::testing;
+
+TEST(PayloadWriter, CommitsTheWrittenBytesWithoutCopying)
+{
+    rmqt::PayloadWriter writer(16);
+    ASSERT_TRUE(writer.data());
+    EXPECT_THAT(writer.capacity(), Eq(16));
+
+    bsl::uint8_t* data = writer.data();
+    bsl::memcpy(data, "hello", 5);
+
+    rmqt::Properties properties;
+    properties.messageId = "message-id";
+    const rmqt::Message message = writer.commit(5, properties);
+
+    EXPECT_THAT(message.payloadSize(), Eq(5));
+    EXPECT_THAT(message.payload(), Eq(data));
+    EXPECT_THAT(bsl::string(reinterpret_cast<const char*>(message.payload()),
+                            message.payloadSize()),
+                Eq("hello"));
+    EXPECT_THAT(message.messageId(), Eq("message-id"));
+
+    EXPECT_FALSE(writer.data());
+    EXPECT_THAT(writer.capacity(), Eq(0));
+}
+
+TEST(PayloadWriter, BufferComesFromTheAllocatorAndLivesWithTheMessage)
+{
+    bslma::TestAllocator allocator;
+    {
+        rmqt::Message message;
+        {
+            rmqt::PayloadWriter writer(64, &allocator);
+            EXPECT_THAT(allocator.numBytesInUse(), Ge(64));
+            message = writer.commit(10);
+        }
+        EXPECT_THAT(allocator.numBytesInUse(), Ge(64));
+        EXPECT_THAT(message.payloadSize(), Eq(10));
+    }
+    EXPECT_THAT(allocator.numBytesInUse(), Eq(0));
+}
+
+TEST(PayloadWriter, UncommittedBufferIsReleased)
+{
+    bslma::TestAllocator allocator;
+    {
+        rmqt::PayloadWriter writer(64, &allocator);
+    }
+    EXPECT_THAT(allocator.numBytesInUse(), Eq(0));
+}
@@ -0,0 +1,39 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqt_ratelimit.h>
+
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqt;
+
+TEST(RateLimit, DefaultsToUnlimited)
+{
+    RateLimit limit;
+    EXPECT_EQ(0, limit.messagesPerSecond());
+    EXPECT_EQ(0, limit.bytesPerSecond());
+}
+
+TEST(RateLimit, BurstIsAtLeastOne)
+{
+    RateLimit limit;
+    limit.setMessageRate(100, 0).setByteRate(1000, 0);
+
+    EXPECT_EQ(100, limit.messagesPerSecond());
+    EXPECT_EQ(1u, limit.messageBurst());
+    EXPECT_EQ(1000, limit.bytesPerSecond());
+    EXPECT_EQ(1u, limit.byteBurst());
+}
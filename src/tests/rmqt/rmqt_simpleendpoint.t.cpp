@@ -31,3 +31,17 @@ TEST(SimpleEndpoint, SelectedPort)
     SimpleEndpoint e("test.example.com", "rmq-testing", 12345);
     ASSERT_EQ("amqp://test.example.com:12345/rmq-testing", e.formatAddress());
 }
+
+TEST(SimpleEndpoint, MultipleHosts)
+{
+    Endpoint::HostList hosts;
+    hosts.push_back(Endpoint::Host("rabbit1", 5672));
+    hosts.push_back(Endpoint::Host("rabbit2", 5673));
+    SimpleEndpoint e(hosts, "rmq-testing");
+
+    ASSERT_EQ("amqp://rabbit1:5672,rabbit2:5673/rmq-testing",
+              e.formatAddress());
+    EXPECT_EQ("rabbit1", e.hostname());
+    EXPECT_EQ(5672, e.port());
+    EXPECT_EQ(hosts, e.hosts());
+}
@@ -0,0 +1,66 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqt_socketoptions.h>
+
+#include <bsls_timeinterval.h>
+
+#include <bsl_sstream.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace BloombergLP;
+using namespace rmqt;
+using namespace ::testing;
+
+TEST(SocketOptions, DefaultsMatchPreviousBehaviour)
+{
+    SocketOptions options;
+    EXPECT_TRUE(options.noDelay());
+    EXPECT_TRUE(options.keepAlive());
+    EXPECT_FALSE(options.quickAck());
+    EXPECT_THAT(options.sendBufferSize(), Eq(0));
+    EXPECT_THAT(options.receiveBufferSize(), Eq(0));
+    EXPECT_THAT(options.busyPollMicroseconds(), Eq(0));
+    EXPECT_THAT(options.userTimeout(), Eq(bsls::TimeInterval()));
+}
+
+TEST(SocketOptions, SettersChain)
+{
+    SocketOptions options;
+    options.setNoDelay(false)
+        .setSendBufferSize(4 << 20)
+        .setReceiveBufferSize(8 << 20)
+        .setQuickAck(true)
+        .setBusyPoll(50)
+        .setUserTimeout(bsls::TimeInterval(30))
+        .setKeepAliveProbes(
+            bsls::TimeInterval(60), bsls::TimeInterval(10), 5);
+
+    EXPECT_FALSE(options.noDelay());
+    EXPECT_THAT(options.sendBufferSize(), Eq(4 << 20));
+    EXPECT_THAT(options.receiveBufferSize(), Eq(8 << 20));
+    EXPECT_TRUE(options.quickAck());
+    EXPECT_THAT(options.busyPollMicroseconds(), Eq(50));
+    EXPECT_THAT(options.userTimeout(), Eq(bsls::TimeInterval(30)));
+    EXPECT_THAT(options.keepAliveIdle(), Eq(bsls::TimeInterval(60)));
+    EXPECT_THAT(options.keepAliveInterval(), Eq(bsls::TimeInterval(10)));
+    EXPECT_THAT(options.keepAliveCount(), Eq(5));
+
+    bsl::ostringstream oss;
+    oss << options;
+    EXPECT_THAT(oss.str(), HasSubstr("sendBufferSize: 4194304"));
+}
@@ -0,0 +1,76 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqt_streamoffset.h>
+
+#include <rmqt_fieldvalue.h>
+
+#include <bdlt_datetime.h>
+
+#include <gtest/gtest.h>
+
+#include <bsl_sstream.h>
+#include <bsl_string.h>
+
+using namespace BloombergLP;
+using namespace ::testing;
+
+TEST(StreamOffset, DefaultsToNext)
+{
+    EXPECT_EQ(rmqt::StreamOffset().type(), rmqt::StreamOffset::NEXT);
+    EXPECT_EQ(rmqt::StreamOffset(), rmqt::StreamOffset::next());
+}
+
+TEST(StreamOffset, NamedOffsetsAreStrings)
+{
+    EXPECT_EQ(rmqt::StreamOffset::first().toFieldValue(),
+              rmqt::FieldValue(bsl::string("first")));
+    EXPECT_EQ(rmqt::StreamOffset::last().toFieldValue(),
+              rmqt::FieldValue(bsl::string("last")));
+    EXPECT_EQ(rmqt::StreamOffset::next().toFieldValue(),
+              rmqt::FieldValue(bsl::string("next")));
+}
+
+TEST(StreamOffset, OffsetIsALong)
+{
+    const rmqt::StreamOffset offset = rmqt::StreamOffset::offset(1234);
+
+    EXPECT_EQ(offset.type(), rmqt::StreamOffset::OFFSET);
+    EXPECT_EQ(offset.offsetValue(), 1234u);
+    EXPECT_EQ(offset.toFieldValue(), rmqt::FieldValue(int64_t(1234)));
+}
+
+TEST(StreamOffset, TimestampIsATimestamp)
+{
+    const bdlt::Datetime time(2023, 6, 1, 12, 30, 0);
+    const rmqt::StreamOffset offset = rmqt::StreamOffset::timestamp(time);
+
+    EXPECT_EQ(offset.type(), rmqt::StreamOffset::TIMESTAMP);
+    EXPECT_EQ(offset.toFieldValue(), rmqt::FieldValue(time));
+}
+
+TEST(StreamOffset, Equality)
+{
+    EXPECT_EQ(rmqt::StreamOffset::offset(5), rmqt::StreamOffset::offset(5));
+    EXPECT_NE(rmqt::StreamOffset::offset(5), rmqt::StreamOffset::offset(6));
+    EXPECT_NE(rmqt::StreamOffset::first(), rmqt::StreamOffset::last());
+}
+
+TEST(StreamOffset, Prints)
+{
+    bsl::ostringstream os;
+    os << rmqt::StreamOffset::offset(42);
+    EXPECT_EQ(os.str(), "offset 42");
+}
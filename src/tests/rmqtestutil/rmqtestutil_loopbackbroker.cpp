@@ -0,0 +1,926 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqtestutil_loopbackbroker.h>
+
+#include <rmqamqp_framer.h>
+#include <rmqamqp_message.h>
+#include <rmqamqpt_basicmethod.h>
+#include <rmqamqpt_channelmethod.h>
+#include <rmqamqpt_confirmmethod.h>
+#include <rmqamqpt_connectionmethod.h>
+#include <rmqamqpt_exchangemethod.h>
+#include <rmqamqpt_frame.h>
+#include <rmqamqpt_method.h>
+#include <rmqamqpt_queuemethod.h>
+#include <rmqt_fieldvalue.h>
+#include <rmqt_plaincredentials.h>
+#include <rmqt_simpleendpoint.h>
+
+#include <ball_log.h>
+#include <bdlf_bind.h>
+#include <bdlf_placeholder.h>
+#include <bslmt_latch.h>
+#include <bslmt_lockguard.h>
+#include <bslmt_mutex.h>
+#include <bslmt_threadutil.h>
+#include <bsls_atomic.h>
+
+#include <boost/asio.hpp>
+
+#include <bsl_algorithm.h>
+#include <bsl_cstring.h>
+#include <bsl_iterator.h>
+#include <bsl_map.h>
+#include <bsl_set.h>
+#include <bsl_string.h>
+
+namespace BloombergLP {
+namespace rmqtestutil {
+namespace {
+
+BALL_LOG_SET_NAMESPACE_CATEGORY("RMQTESTUTIL.LOOPBACKBROKER")
+
+typedef boost::asio::ip::tcp tcp;
+
+const uint8_t k_PROTOCOL_HEADER[] = {'A', 'M', 'Q', 'P', 0, 0, 9, 1};
+
+const bsl::uint16_t k_CHANNEL_MAX   = 2047;
+const bsl::uint32_t k_FRAME_MAX     = 131072;
+const bsl::uint16_t k_HEARTBEAT_SEC = 60;
+
+const bsl::size_t k_READ_SIZE = 64 * 1024;
+
+// Deliveries stop being queued for writing beyond this, so that consumers
+// without a prefetch limit are paced by the socket
+const bsl::size_t k_MAX_QUEUED_BYTES = 1024 * 1024;
+
+rmqt::FieldTable serverProperties()
+{
+    bsl::shared_ptr<rmqt::FieldTable> capabilities =
+        bsl::make_shared<rmqt::FieldTable>();
+    (*capabilities)["publisher_confirms"]         = rmqt::FieldValue(true);
+    (*capabilities)["basic.nack"]                 = rmqt::FieldValue(true);
+    (*capabilities)["consumer_cancel_notify"]     = rmqt::FieldValue(true);
+    (*capabilities)["exchange_exchange_bindings"] = rmqt::FieldValue(true);
+
+    rmqt::FieldTable properties;
+    properties["capabilities"] = rmqt::FieldValue(capabilities);
+    properties["product"] = rmqt::FieldValue(bsl::string("LoopbackBroker"));
+    properties["cluster_name"] = rmqt::FieldValue(bsl::string("loopback"));
+    return properties;
+}
+
+void runContext(boost::asio::io_context* context) { context->run(); }
+
+} // namespace
+
+class LoopbackBroker::Impl {
+  public:
+    Impl()
+    : d_context()
+    , d_acceptor(d_context)
+    , d_thread()
+    , d_running(false)
+    , d_mutex()
+    , d_deliveries()
+    , d_deliveryCount(0)
+    , d_published(0)
+    , d_delivered(0)
+    , d_acked(0)
+    , d_methods(0)
+    , d_declares(0)
+    , d_sessions()
+    {
+    }
+
+    void accept();
+    void handleAccept(const bsl::shared_ptr<tcp::socket>& socket,
+                      const boost::system::error_code& error);
+
+    /// Close the acceptor and every connection, so that the context runs
+    /// out of work
+    void shutdown();
+
+    /// Close every connection, then arrive at `done` unless it is null
+    void closeSessions(bslmt::Latch* done);
+
+    boost::asio::io_context d_context;
+    tcp::acceptor d_acceptor;
+    bslmt::ThreadUtil::Handle d_thread;
+    bool d_running;
+
+    bslmt::Mutex d_mutex; // protects the deliveries
+    bsl::vector<rmqt::Message> d_deliveries;
+    bsl::uint64_t d_deliveryCount;
+
+    bsls::AtomicUint64 d_published;
+    bsls::AtomicUint64 d_delivered;
+    bsls::AtomicUint64 d_acked;
+    bsls::AtomicUint64 d_methods;
+    bsls::AtomicUint64 d_declares;
+
+    // Only used from the context's thread
+    bsl::vector<bsl::weak_ptr<Session> > d_sessions;
+};
+
+/// One client connection
+class LoopbackBroker::Session
+: public bsl::enable_shared_from_this<LoopbackBroker::Session> {
+  public:
+    Session(Impl& broker, const bsl::shared_ptr<tcp::socket>& socket);
+
+    void start() { readMore(); }
+
+    void close();
+
+  private:
+    class MethodHandler;
+
+    /// A slice of a buffer to be written
+    struct Chunk {
+        bsl::shared_ptr<const bsl::vector<uint8_t> > buffer;
+        bsl::size_t offset;
+        bsl::size_t length;
+    };
+
+    struct ChannelState {
+        ChannelState()
+        : confirming(false)
+        , published(0)
+        , confirmed(0)
+        , prefetch(0)
+        , consuming(false)
+        , noAck(false)
+        , consumerTag()
+        , queue()
+        , lastDeliveryTag(0)
+        , remaining(0)
+        , unacked()
+        , contents()
+        , nextContent(0)
+        {
+        }
+
+        bool confirming;
+        bsl::uint64_t published;
+        bsl::uint64_t confirmed;
+
+        bsl::uint16_t prefetch;
+        bool consuming;
+        bool noAck;
+        bsl::string consumerTag;
+        bsl::string queue;
+        bsl::uint64_t lastDeliveryTag;
+        bsl::int64_t remaining; // negative for without end
+        bsl::set<bsl::uint64_t> unacked;
+        // Content header and body frames of each message to deliver
+        bsl::vector<bsl::shared_ptr<const bsl::vector<uint8_t> > > contents;
+        bsl::size_t nextContent;
+    };
+
+    void readMore();
+    void handleRead(const boost::system::error_code& error,
+                    bsl::size_t bytes);
+    void handleWrite(const boost::system::error_code& error,
+                     bsl::size_t bytes);
+
+    /// Process the frames in `d_readBuffer`, return false on a protocol
+    /// error
+    bool processFrames();
+    void handleMessage(bsl::uint16_t channel,
+                       const rmqamqp::Message& message);
+
+    void startConsuming(bsl::uint16_t channel,
+                        const rmqamqpt::BasicConsume& consume);
+    void acknowledge(bsl::uint16_t channel,
+                     bsl::uint64_t deliveryTag,
+                     bool multiple);
+    void confirmPublishes();
+    void deliver();
+    bool canDeliver(const ChannelState& state) const;
+
+    void sendMethod(bsl::uint16_t channel, const rmqamqpt::Method& method);
+    void sendFrame(const rmqamqpt::Frame& frame);
+    void queue(const Chunk& chunk);
+    void flush();
+
+    Impl& d_broker;
+    bsl::shared_ptr<tcp::socket> d_socket;
+    rmqamqp::Framer d_framer;
+    bsl::vector<uint8_t> d_readChunk;
+    bsl::vector<uint8_t> d_readBuffer;
+    bool d_headerReceived;
+    bsl::map<bsl::uint16_t, ChannelState> d_channels;
+
+    bsl::vector<Chunk> d_queued;
+    bsl::vector<Chunk> d_writing;
+    bsl::size_t d_queuedBytes;
+    bool d_closeAfterWrite;
+};
+
+class LoopbackBroker::Session::MethodHandler {
+  public:
+    MethodHandler(Session& session, bsl::uint16_t channel)
+    : d_session(session)
+    , d_channel(channel)
+    {
+    }
+
+    void operator()(const rmqamqpt::ConnectionStartOk&) const
+    {
+        send(rmqamqpt::ConnectionMethod(rmqamqpt::ConnectionTune(
+            k_CHANNEL_MAX, k_FRAME_MAX, k_HEARTBEAT_SEC)));
+    }
+
+    void operator()(const rmqamqpt::ConnectionTuneOk& tuneOk) const
+    {
+        if (tuneOk.frameMax()) {
+            d_session.d_framer.setMaxFrameSize(tuneOk.frameMax());
+        }
+    }
+
+    void operator()(const rmqamqpt::ConnectionOpen&) const
+    {
+        send(rmqamqpt::ConnectionMethod(rmqamqpt::ConnectionOpenOk()));
+    }
+
+    void operator()(const rmqamqpt::ConnectionClose&) const
+    {
+        send(rmqamqpt::ConnectionMethod(rmqamqpt::ConnectionCloseOk()));
+        d_session.d_closeAfterWrite = true;
+    }
+
+    void operator()(const rmqamqpt::ChannelOpen&) const
+    {
+        d_session.d_channels[d_channel] = ChannelState();
+        send(rmqamqpt::ChannelMethod(rmqamqpt::ChannelOpenOk()));
+    }
+
+    void operator()(const rmqamqpt::ChannelClose&) const
+    {
+        d_session.d_channels.erase(d_channel);
+        d_session.d_framer.clearChannel(d_channel);
+        send(rmqamqpt::ChannelMethod(rmqamqpt::ChannelCloseOk()));
+    }
+
+    void operator()(const rmqamqpt::ExchangeDeclare& declare) const
+    {
+        ++d_session.d_broker.d_declares;
+        if (!declare.noWait()) {
+            send(rmqamqpt::ExchangeMethod(rmqamqpt::ExchangeDeclareOk()));
+        }
+    }
+
+    void operator()(const rmqamqpt::ExchangeBind& bind) const
+    {
+        ++d_session.d_broker.d_declares;
+        if (!bind.noWait()) {
+            send(rmqamqpt::ExchangeMethod(rmqamqpt::ExchangeBindOk()));
+        }
+    }
+
+    void operator()(const rmqamqpt::QueueDeclare& declare) const
+    {
+        ++d_session.d_broker.d_declares;
+        if (!declare.noWait()) {
+            send(rmqamqpt::QueueMethod(
+                rmqamqpt::QueueDeclareOk(declare.name(), 0, 0)));
+        }
+    }
+
+    void operator()(const rmqamqpt::QueueBind& bind) const
+    {
+        ++d_session.d_broker.d_declares;
+        if (!bind.noWait()) {
+            send(rmqamqpt::QueueMethod(rmqamqpt::QueueBindOk()));
+        }
+    }
+
+    void operator()(const rmqamqpt::QueueUnbind&) const
+    {
+        send(rmqamqpt::QueueMethod(rmqamqpt::QueueUnbindOk()));
+    }
+
+    void operator()(const rmqamqpt::QueueDelete& deleteMethod) const
+    {
+        if (!deleteMethod.noWait()) {
+            send(rmqamqpt::QueueMethod(rmqamqpt::QueueDeleteOk(0)));
+        }
+    }
+
+    void operator()(const rmqamqpt::ConfirmSelect& select) const
+    {
+        d_session.d_channels[d_channel].confirming = true;
+        if (!select.noWait()) {
+            send(rmqamqpt::ConfirmMethod(rmqamqpt::ConfirmSelectOk()));
+        }
+    }
+
+    void operator()(const rmqamqpt::BasicQoS& qos) const
+    {
+        d_session.d_channels[d_channel].prefetch = qos.prefetchCount();
+        send(rmqamqpt::BasicMethod(rmqamqpt::BasicQoSOk()));
+    }
+
+    void operator()(const rmqamqpt::BasicConsume& consume) const
+    {
+        d_session.startConsuming(d_channel, consume);
+    }
+
+    void operator()(const rmqamqpt::BasicCancel& cancel) const
+    {
+        d_session.d_channels[d_channel].consuming = false;
+        if (!cancel.noWait()) {
+            send(rmqamqpt::BasicMethod(
+                rmqamqpt::BasicCancelOk(cancel.consumerTag())));
+        }
+    }
+
+    void operator()(const rmqamqpt::BasicAck& ack) const
+    {
+        d_session.acknowledge(d_channel, ack.deliveryTag(), ack.multiple());
+    }
+
+    void operator()(const rmqamqpt::BasicNack& nack) const
+    {
+        d_session.acknowledge(d_channel, nack.deliveryTag(), nack.multiple());
+    }
+
+    void operator()(const rmqamqpt::BasicPublish&) const
+    {
+        // Counted once its content arrives
+    }
+
+    template <typename T>
+    void operator()(const T& method) const
+    {
+        BALL_LOG_WARN << "Ignoring unexpected method on channel " << d_channel
+                      << ": " << method;
+    }
+
+    void operator()(const BloombergLP::bslmf::Nil) const {}
+
+  private:
+    void send(const rmqamqpt::Method& method) const
+    {
+        d_session.sendMethod(d_channel, method);
+    }
+
+    Session& d_session;
+    bsl::uint16_t d_channel;
+};
+
+LoopbackBroker::Session::Session(Impl& broker,
+                                 const bsl::shared_ptr<tcp::socket>& socket)
+: d_broker(broker)
+, d_socket(socket)
+, d_framer()
+, d_readChunk(k_READ_SIZE)
+, d_readBuffer()
+, d_headerReceived(false)
+, d_channels()
+, d_queued()
+, d_writing()
+, d_queuedBytes(0)
+, d_closeAfterWrite(false)
+{
+    boost::system::error_code ignored;
+    d_socket->set_option(tcp::no_delay(true), ignored);
+}
+
+void LoopbackBroker::Session::close()
+{
+    boost::system::error_code ignored;
+    d_socket->close(ignored);
+}
+
+void LoopbackBroker::Session::readMore()
+{
+    d_socket->async_read_some(
+        boost::asio::buffer(d_readChunk.data(), d_readChunk.size()),
+        bdlf::BindUtil::bind(&Session::handleRead,
+                             shared_from_this(),
+                             bdlf::PlaceHolders::_1,
+                             bdlf::PlaceHolders::_2));
+}
+
+void LoopbackBroker::Session::handleRead(
+    const boost::system::error_code& error,
+    bsl::size_t bytes)
+{
+    if (error) {
+        return;
+    }
+
+    d_readBuffer.insert(d_readBuffer.end(),
+                        d_readChunk.begin(),
+                        d_readChunk.begin() + bytes);
+
+    if (!processFrames()) {
+        close();
+        return;
+    }
+
+    // One confirm per read covers every publish in it
+    confirmPublishes();
+    deliver();
+    flush();
+
+    if (!d_closeAfterWrite) {
+        readMore();
+    }
+}
+
+bool LoopbackBroker::Session::processFrames()
+{
+    bsl::size_t offset = 0;
+
+    if (!d_headerReceived) {
+        if (d_readBuffer.size() < sizeof(k_PROTOCOL_HEADER)) {
+            return true;
+        }
+        if (bsl::memcmp(d_readBuffer.data(),
+                        k_PROTOCOL_HEADER,
+                        sizeof(k_PROTOCOL_HEADER)) != 0) {
+            BALL_LOG_ERROR << "Unsupported protocol header";
+            return false;
+        }
+
+        offset           = sizeof(k_PROTOCOL_HEADER);
+        d_headerReceived = true;
+
+        bsl::vector<bsl::string> mechanisms(1, "PLAIN");
+        bsl::vector<bsl::string> locales(1, "en_US");
+        sendMethod(0,
+                   rmqamqpt::ConnectionMethod(rmqamqpt::ConnectionStart(
+                       0, 9, serverProperties(), mechanisms, locales)));
+    }
+
+    while (offset < d_readBuffer.size()) {
+        rmqamqpt::Frame frame;
+        bsl::size_t readBytes    = 0;
+        bsl::size_t missingBytes = 0;
+
+        const rmqamqpt::Frame::ReturnCode rc =
+            rmqamqpt::Frame::decode(&frame,
+                                    &readBytes,
+                                    &missingBytes,
+                                    d_readBuffer.data() + offset,
+                                    d_readBuffer.size() - offset);
+        if (rc == rmqamqpt::Frame::PARTIAL) {
+            break;
+        }
+        if (rc != rmqamqpt::Frame::OK) {
+            BALL_LOG_ERROR << "Failed to decode frame";
+            return false;
+        }
+        offset += readBytes;
+
+        bsl::uint16_t channel;
+        rmqamqp::Message message;
+        const rmqamqp::Framer::ReturnCode framerRc =
+            d_framer.appendFrame(&channel, &message, frame);
+        if (framerRc == rmqamqp::Framer::OK) {
+            handleMessage(channel, message);
+        }
+        else if (framerRc != rmqamqp::Framer::PARTIAL) {
+            BALL_LOG_ERROR << "Failed to decode message on channel "
+                           << channel;
+            return false;
+        }
+    }
+
+    d_readBuffer.erase(d_readBuffer.begin(), d_readBuffer.begin() + offset);
+    return true;
+}
+
+void LoopbackBroker::Session::handleMessage(bsl::uint16_t channel,
+                                            const rmqamqp::Message& message)
+{
+    if (message.is<rmqt::Message>()) {
+        ++d_channels[channel].published;
+        ++d_broker.d_published;
+        return;
+    }
+
+    if (message.is<rmqamqpt::Heartbeat>()) {
+        // Echoed so that the client sees traffic while it is idle
+        sendFrame(rmqamqp::Framer::makeHeartbeatFrame());
+        return;
+    }
+
+    if (!message.is<rmqamqpt::Method>()) {
+        return;
+    }
+
+    ++d_broker.d_methods;
+    const rmqamqpt::Method& method = message.the<rmqamqpt::Method>();
+    MethodHandler handler(*this, channel);
+    if (method.is<rmqamqpt::ConnectionMethod>()) {
+        method.the<rmqamqpt::ConnectionMethod>().apply(handler);
+    }
+    else if (method.is<rmqamqpt::ChannelMethod>()) {
+        method.the<rmqamqpt::ChannelMethod>().apply(handler);
+    }
+    else if (method.is<rmqamqpt::ExchangeMethod>()) {
+        method.the<rmqamqpt::ExchangeMethod>().apply(handler);
+    }
+    else if (method.is<rmqamqpt::QueueMethod>()) {
+        method.the<rmqamqpt::QueueMethod>().apply(handler);
+    }
+    else if (method.is<rmqamqpt::ConfirmMethod>()) {
+        method.the<rmqamqpt::ConfirmMethod>().apply(handler);
+    }
+    else if (method.is<rmqamqpt::BasicMethod>()) {
+        method.the<rmqamqpt::BasicMethod>().apply(handler);
+    }
+}
+
+void LoopbackBroker::Session::startConsuming(
+    bsl::uint16_t channel,
+    const rmqamqpt::BasicConsume& consume)
+{
+    ChannelState& state = d_channels[channel];
+    state.consuming     = true;
+    state.noAck         = consume.noAck();
+    state.consumerTag   = consume.consumerTag();
+    state.queue         = consume.queue();
+    state.contents.clear();
+    state.nextContent = 0;
+
+    {
+        bslmt::LockGuard<bslmt::Mutex> guard(&d_broker.d_mutex);
+        state.remaining = d_broker.d_deliveryCount
+                              ? static_cast<bsl::int64_t>(
+                                    d_broker.d_deliveryCount)
+                              : -1;
+
+        // Encoded once, so that delivering costs a method frame and a write
+        for (bsl::vector<rmqt::Message>::const_iterator it =
+                 d_broker.d_deliveries.begin();
+             it != d_broker.d_deliveries.end();
+             ++it) {
+            bsl::vector<rmqamqpt::Frame> frames;
+            d_framer.makeFrames(&frames, channel, rmqamqp::Message(*it));
+
+            bsl::shared_ptr<bsl::vector<uint8_t> > content =
+                bsl::make_shared<bsl::vector<uint8_t> >();
+            for (bsl::vector<rmqamqpt::Frame>::const_iterator frame =
+                     frames.begin();
+                 frame != frames.end();
+                 ++frame) {
+                content->insert(content->end(),
+                                frame->rawData(),
+                                frame->rawData() + frame->totalFrameSize());
+            }
+            state.contents.push_back(content);
+        }
+    }
+
+    if (!consume.noWait()) {
+        sendMethod(channel,
+                   rmqamqpt::BasicMethod(
+                       rmqamqpt::BasicConsumeOk(consume.consumerTag())));
+    }
+}
+
+void LoopbackBroker::Session::acknowledge(bsl::uint16_t channel,
+                                          bsl::uint64_t deliveryTag,
+                                          bool multiple)
+{
+    bsl::set<bsl::uint64_t>& unacked = d_channels[channel].unacked;
+
+    bsl::set<bsl::uint64_t>::iterator first = unacked.begin();
+    bsl::set<bsl::uint64_t>::iterator last  = unacked.upper_bound(deliveryTag);
+    if (!multiple) {
+        first = unacked.find(deliveryTag);
+        if (first == unacked.end()) {
+            return;
+        }
+        last = first;
+        ++last;
+    }
+
+    d_broker.d_acked += bsl::distance(first, last);
+    unacked.erase(first, last);
+}
+
+void LoopbackBroker::Session::confirmPublishes()
+{
+    for (bsl::map<bsl::uint16_t, ChannelState>::iterator it =
+             d_channels.begin();
+         it != d_channels.end();
+         ++it) {
+        ChannelState& state = it->second;
+        if (state.confirming && state.published > state.confirmed) {
+            sendMethod(it->first,
+                       rmqamqpt::BasicMethod(
+                           rmqamqpt::BasicAck(state.published, true)));
+            state.confirmed = state.published;
+        }
+    }
+}
+
+bool LoopbackBroker::Session::canDeliver(const ChannelState& state) const
+{
+    return state.consuming && !state.contents.empty() &&
+           state.remaining != 0 &&
+           (state.noAck || state.prefetch == 0 ||
+            state.unacked.size() < state.prefetch);
+}
+
+void LoopbackBroker::Session::deliver()
+{
+    // Round robin across consumers until each is at its prefetch, or enough
+    // is queued to keep the socket busy
+    bool progress = true;
+    while (progress && d_queuedBytes < k_MAX_QUEUED_BYTES) {
+        progress = false;
+        for (bsl::map<bsl::uint16_t, ChannelState>::iterator it =
+                 d_channels.begin();
+             it != d_channels.end();
+             ++it) {
+            ChannelState& state = it->second;
+            if (!canDeliver(state)) {
+                continue;
+            }
+
+            const bsl::uint64_t tag = ++state.lastDeliveryTag;
+            if (!state.noAck) {
+                state.unacked.insert(state.unacked.end(), tag);
+            }
+            if (state.remaining > 0) {
+                --state.remaining;
+            }
+
+            sendMethod(it->first,
+                       rmqamqpt::BasicMethod(rmqamqpt::BasicDeliver(
+                           state.consumerTag, tag, false, "", state.queue)));
+
+            const bsl::shared_ptr<const bsl::vector<uint8_t> >& content =
+                state.contents[state.nextContent];
+            state.nextContent = (state.nextContent + 1) %
+                                state.contents.size();
+
+            Chunk chunk;
+            chunk.buffer = content;
+            chunk.offset = 0;
+            chunk.length = content->size();
+            queue(chunk);
+
+            ++d_broker.d_delivered;
+            progress = true;
+        }
+    }
+}
+
+void LoopbackBroker::Session::sendMethod(bsl::uint16_t channel,
+                                         const rmqamqpt::Method& method)
+{
+    rmqamqpt::Frame frame;
+    rmqamqp::Framer::makeMethodFrame(&frame, channel, method);
+    sendFrame(frame);
+}
+
+void LoopbackBroker::Session::sendFrame(const rmqamqpt::Frame& frame)
+{
+    Chunk chunk;
+    chunk.buffer = frame.serializedData();
+    chunk.offset = frame.dataOffset();
+    chunk.length = frame.totalFrameSize();
+    queue(chunk);
+}
+
+void LoopbackBroker::Session::queue(const Chunk& chunk)
+{
+    d_queued.push_back(chunk);
+    d_queuedBytes += chunk.length;
+}
+
+void LoopbackBroker::Session::flush()
+{
+    if (!d_writing.empty() || d_queued.empty()) {
+        return;
+    }
+
+    d_writing.swap(d_queued);
+
+    bsl::vector<boost::asio::const_buffer> buffers;
+    buffers.reserve(d_writing.size());
+    for (bsl::vector<Chunk>::const_iterator it = d_writing.begin();
+         it != d_writing.end();
+         ++it) {
+        buffers.push_back(
+            boost::asio::buffer(it->buffer->data() + it->offset, it->length));
+    }
+
+    boost::asio::async_write(*d_socket,
+                             buffers,
+                             bdlf::BindUtil::bind(&Session::handleWrite,
+                                                  shared_from_this(),
+                                                  bdlf::PlaceHolders::_1,
+                                                  bdlf::PlaceHolders::_2));
+}
+
+void LoopbackBroker::Session::handleWrite(
+    const boost::system::error_code& error,
+    bsl::size_t bytes)
+{
+    d_writing.clear();
+    d_queuedBytes -= bsl::min(bytes, d_queuedBytes);
+
+    if (error) {
+        close();
+        return;
+    }
+
+    if (d_closeAfterWrite && d_queued.empty()) {
+        close();
+        return;
+    }
+
+    // Keep the socket busy for consumers without a prefetch limit
+    deliver();
+    flush();
+}
+
+void LoopbackBroker::Impl::accept()
+{
+    bsl::shared_ptr<tcp::socket> socket =
+        bsl::make_shared<tcp::socket>(d_context);
+    d_acceptor.async_accept(*socket,
+                            bdlf::BindUtil::bind(&Impl::handleAccept,
+                                                 this,
+                                                 socket,
+                                                 bdlf::PlaceHolders::_1));
+}
+
+void LoopbackBroker::Impl::handleAccept(
+    const bsl::shared_ptr<tcp::socket>& socket,
+    const boost::system::error_code& error)
+{
+    if (error) {
+        return;
+    }
+
+    bsl::shared_ptr<Session> session =
+        bsl::make_shared<Session>(*this, socket);
+    d_sessions.push_back(session);
+    session->start();
+
+    accept();
+}
+
+void LoopbackBroker::Impl::shutdown()
+{
+    boost::system::error_code ignored;
+    d_acceptor.close(ignored);
+
+    closeSessions(0);
+}
+
+void LoopbackBroker::Impl::closeSessions(bslmt::Latch* done)
+{
+    for (bsl::vector<bsl::weak_ptr<Session> >::iterator it =
+             d_sessions.begin();
+         it != d_sessions.end();
+         ++it) {
+        bsl::shared_ptr<Session> session = it->lock();
+        if (session) {
+            session->close();
+        }
+    }
+    d_sessions.clear();
+
+    if (done) {
+        done->arrive();
+    }
+}
+
+LoopbackBroker::LoopbackBroker()
+: d_impl(bsl::make_shared<Impl>())
+{
+}
+
+LoopbackBroker::~LoopbackBroker() { stop(); }
+
+void LoopbackBroker::setDeliveries(const bsl::vector<rmqt::Message>& messages,
+                                   bsl::uint64_t count)
+{
+    bslmt::LockGuard<bslmt::Mutex> guard(&d_impl->d_mutex);
+    d_impl->d_deliveries    = messages;
+    d_impl->d_deliveryCount = count;
+}
+
+int LoopbackBroker::start()
+{
+    if (d_impl->d_running) {
+        return 0;
+    }
+
+    boost::system::error_code error;
+    const tcp::endpoint endpoint(boost::asio::ip::make_address("127.0.0.1"),
+                                 0);
+    d_impl->d_acceptor.open(endpoint.protocol(), error);
+    if (!error) {
+        d_impl->d_acceptor.bind(endpoint, error);
+    }
+    if (!error) {
+        d_impl->d_acceptor.listen(
+            boost::asio::socket_base::max_listen_connections, error);
+    }
+    if (error) {
+        BALL_LOG_ERROR << "Failed to listen on loopback: " << error.message();
+        return -1;
+    }
+
+    d_impl->accept();
+
+    if (bslmt::ThreadUtil::create(
+            &d_impl->d_thread,
+            bdlf::BindUtil::bind(&runContext, &d_impl->d_context)) != 0) {
+        BALL_LOG_ERROR << "Failed to start the loopback broker thread";
+        return -1;
+    }
+    d_impl->d_running = true;
+
+    BALL_LOG_INFO << "Loopback broker listening on port " << port();
+    return 0;
+}
+
+void LoopbackBroker::stop()
+{
+    if (!d_impl->d_running) {
+        return;
+    }
+
+    boost::asio::post(d_impl->d_context,
+                      bdlf::BindUtil::bind(&Impl::shutdown, d_impl.get()));
+    bslmt::ThreadUtil::join(d_impl->d_thread);
+    d_impl->d_running = false;
+}
+
+void LoopbackBroker::dropConnections()
+{
+    if (!d_impl->d_running) {
+        return;
+    }
+
+    bslmt::Latch done(1);
+    boost::asio::post(
+        d_impl->d_context,
+        bdlf::BindUtil::bind(&Impl::closeSessions, d_impl.get(), &done));
+    done.wait();
+}
+
+bsl::uint16_t LoopbackBroker::port() const
+{
+    boost::system::error_code error;
+    const tcp::endpoint endpoint = d_impl->d_acceptor.local_endpoint(error);
+    return error ? 0 : endpoint.port();
+}
+
+bsl::shared_ptr<rmqt::Endpoint> LoopbackBroker::endpoint() const
+{
+    return bsl::make_shared<rmqt::SimpleEndpoint>("127.0.0.1", "/", port());
+}
+
+bsl::shared_ptr<rmqt::Credentials> LoopbackBroker::credentials() const
+{
+    return bsl::make_shared<rmqt::PlainCredentials>("guest", "guest");
+}
+
+bsl::uint64_t LoopbackBroker::published() const
+{
+    return d_impl->d_published;
+}
+
+bsl::uint64_t LoopbackBroker::delivered() const
+{
+    return d_impl->d_delivered;
+}
+
+bsl::uint64_t LoopbackBroker::acked() const { return d_impl->d_acked; }
+
+bsl::uint64_t LoopbackBroker::methods() const { return d_impl->d_methods; }
+
+bsl::uint64_t LoopbackBroker::declares() const
+{
+    return d_impl->d_declares;
+}
+
+} // namespace rmqtestutil
+} // namespace BloombergLP
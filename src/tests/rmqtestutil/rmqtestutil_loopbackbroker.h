@@ -0,0 +1,108 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RMQTESTUTIL_LOOPBACKBROKER
+#define INCLUDED_RMQTESTUTIL_LOOPBACKBROKER
+
+#include <rmqt_credentials.h>
+#include <rmqt_endpoint.h>
+#include <rmqt_message.h>
+
+#include <bsl_cstdint.h>
+#include <bsl_memory.h>
+#include <bsl_vector.h>
+
+//@PURPOSE: Serve AMQP 0-9-1 clients from memory over a loopback socket
+//
+//@CLASSES:
+//  rmqtestutil::LoopbackBroker: A minimal in-process broker for
+//  benchmarking and testing the client without a RabbitMQ server
+
+namespace BloombergLP {
+namespace rmqtestutil {
+
+/// \brief Responds to AMQP 0-9-1 clients on an ephemeral 127.0.0.1 port
+///
+/// Accepts any credentials and vhost, and answers every declare, bind and
+/// qos without keeping any topology. Publishes are counted and dropped, and
+/// confirmed (when the channel is in confirm mode) once per read from the
+/// socket, with `multiple` set. Each consumer is delivered the messages
+/// given to `setDeliveries`, as fast as its prefetch and the socket allow.
+///
+/// Connections are served from a single background thread, so that its
+/// cost stays out of the client's way as far as possible.
+class LoopbackBroker {
+  public:
+    LoopbackBroker();
+
+    /// Stops the broker
+    ~LoopbackBroker();
+
+    /// Deliver `count` messages to each consumer which starts from now on,
+    /// cycling through `messages`. A `count` of 0 delivers without end.
+    void setDeliveries(const bsl::vector<rmqt::Message>& messages,
+                       bsl::uint64_t count);
+
+    /// Listen on an ephemeral port and start serving connections. Return 0
+    /// on success.
+    int start();
+
+    /// Close every connection and stop serving. Called by the destructor.
+    void stop();
+
+    /// Close every client connection without a connection.close, as a
+    /// broker crash or a network fault would, and go on accepting new ones.
+    /// Returns once they are closed.
+    void dropConnections();
+
+    /// The port listened on, 0 before `start`
+    bsl::uint16_t port() const;
+
+    /// An endpoint connecting to this broker
+    bsl::shared_ptr<rmqt::Endpoint> endpoint() const;
+
+    /// Credentials this broker accepts (as it accepts any)
+    bsl::shared_ptr<rmqt::Credentials> credentials() const;
+
+    /// Number of messages published to this broker
+    bsl::uint64_t published() const;
+
+    /// Number of messages delivered to consumers
+    bsl::uint64_t delivered() const;
+
+    /// Number of deliveries acknowledged (or rejected) by consumers
+    bsl::uint64_t acked() const;
+
+    /// Number of methods received from clients, of any class
+    bsl::uint64_t methods() const;
+
+    /// Number of exchange and queue declares and binds received, which are
+    /// redone for every reconnect unless the client skips them
+    bsl::uint64_t declares() const;
+
+  private:
+    LoopbackBroker(const LoopbackBroker&);
+    LoopbackBroker& operator=(const LoopbackBroker&);
+
+    class Impl;
+    class Session;
+
+    bsl::shared_ptr<Impl> d_impl;
+};
+
+} // namespace rmqtestutil
+} // namespace BloombergLP
+
+#endif
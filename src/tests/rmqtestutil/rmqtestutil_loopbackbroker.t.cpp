@@ -0,0 +1,163 @@
+// Copyright 2020-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rmqtestutil_loopbackbroker.h>
+
+#include <rmqa_consumer.h>
+#include <rmqa_producer.h>
+#include <rmqa_rabbitcontext.h>
+#include <rmqa_topology.h>
+#include <rmqa_vhost.h>
+#include <rmqp_messageguard.h>
+#include <rmqt_confirmresponse.h>
+#include <rmqt_message.h>
+#include <rmqt_result.h>
+
+#include <bdlf_bind.h>
+#include <bdlf_placeholder.h>
+#include <bslmt_threadutil.h>
+#include <bsls_atomic.h>
+#include <bsls_systemtime.h>
+#include <bsls_timeinterval.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <bsl_memory.h>
+#include <bsl_vector.h>
+
+using namespace BloombergLP;
+using namespace rmqtestutil;
+using namespace ::testing;
+
+namespace {
+
+void noopConfirm(const rmqt::Message&,
+                 const bsl::string&,
+                 const rmqt::ConfirmResponse&)
+{
+}
+
+void ackAndCount(bsls::AtomicInt* received, rmqp::MessageGuard& guard)
+{
+    ++*received;
+    guard.ack();
+}
+
+/// Poll `value` until it reaches `expected`, for up to 10 seconds
+template <typename T>
+bool waitFor(const T& value, bsl::uint64_t expected)
+{
+    const bsls::TimeInterval deadline =
+        bsls::SystemTime::nowMonotonicClock() + bsls::TimeInterval(10, 0);
+    while (static_cast<bsl::uint64_t>(value()) < expected) {
+        if (bsls::SystemTime::nowMonotonicClock() > deadline) {
+            return false;
+        }
+        bslmt::ThreadUtil::microSleep(10 * 1000);
+    }
+    return true;
+}
+
+class LoopbackBrokerTests : public ::testing::Test {
+  public:
+    LoopbackBrokerTests()
+    : d_broker()
+    , d_context()
+    , d_vhost()
+    , d_topology()
+    , d_queue(d_topology.addQueue("loopback-queue"))
+    {
+        EXPECT_THAT(d_broker.start(), Eq(0));
+        d_vhost = d_context.createVHostConnection(
+            "loopback", d_broker.endpoint(), d_broker.credentials());
+    }
+
+  protected:
+    LoopbackBroker d_broker;
+    rmqa::RabbitContext d_context;
+    bsl::shared_ptr<rmqa::VHost> d_vhost;
+    rmqa::Topology d_topology;
+    rmqt::QueueHandle d_queue;
+};
+
+} // namespace
+
+TEST_F(LoopbackBrokerTests, ListensOnAnEphemeralPort)
+{
+    EXPECT_THAT(d_broker.port(), Ne(0));
+}
+
+TEST_F(LoopbackBrokerTests, ConfirmsEveryPublish)
+{
+    rmqt::Result<rmqa::Producer> result =
+        d_vhost->createProducer(d_topology, d_topology.defaultExchange(), 10);
+    ASSERT_TRUE(result);
+    bsl::shared_ptr<rmqa::Producer> producer = result.value();
+
+    const bsl::uint64_t k_COUNT = 100;
+    for (bsl::uint64_t i = 0; i < k_COUNT; ++i) {
+        rmqt::Message message(
+            bsl::make_shared<bsl::vector<uint8_t> >(64, 'a'));
+        EXPECT_THAT(producer->send(message, "loopback-queue", &noopConfirm),
+                    Eq(rmqp::Producer::SENDING));
+    }
+
+    EXPECT_TRUE(producer->waitForConfirms(bsls::TimeInterval(10, 0)));
+    EXPECT_THAT(d_broker.published(), Eq(k_COUNT));
+}
+
+TEST_F(LoopbackBrokerTests, DeliversPreGeneratedMessagesUntilAcked)
+{
+    const bsl::uint64_t k_COUNT = 500;
+    d_broker.setDeliveries(
+        bsl::vector<rmqt::Message>(
+            1,
+            rmqt::Message(bsl::make_shared<bsl::vector<uint8_t> >(128, 'b'))),
+        k_COUNT);
+
+    bsls::AtomicInt received(0);
+    rmqt::Result<rmqa::Consumer> consumer = d_vhost->createConsumer(
+        d_topology,
+        d_queue,
+        bdlf::BindUtil::bind(&ackAndCount, &received, bdlf::PlaceHolders::_1),
+        rmqt::ConsumerConfig().setPrefetchCount(50));
+    ASSERT_TRUE(consumer);
+
+    EXPECT_TRUE(waitFor(
+        bdlf::BindUtil::bind(&LoopbackBroker::acked, &d_broker), k_COUNT));
+    EXPECT_THAT(received.load(), Eq(static_cast<int>(k_COUNT)));
+    EXPECT_THAT(d_broker.delivered(), Eq(k_COUNT));
+}
+
+TEST_F(LoopbackBrokerTests, RedeclaresTopologyAfterDroppedConnection)
+{
+    rmqt::Result<rmqa::Producer> result =
+        d_vhost->createProducer(d_topology, d_topology.defaultExchange(), 10);
+    ASSERT_TRUE(result);
+    bsl::shared_ptr<rmqa::Producer> producer = result.value();
+
+    const bsl::uint64_t declaresBefore = d_broker.declares();
+    EXPECT_THAT(declaresBefore, Ge(1u));
+    EXPECT_THAT(d_broker.methods(), Gt(declaresBefore));
+
+    d_broker.dropConnections();
+
+    rmqt::Message message(bsl::make_shared<bsl::vector<uint8_t> >(64, 'a'));
+    EXPECT_THAT(producer->send(message, "loopback-queue", &noopConfirm),
+                Eq(rmqp::Producer::SENDING));
+    EXPECT_TRUE(producer->waitForConfirms(bsls::TimeInterval(10, 0)));
+    EXPECT_THAT(d_broker.declares(), Ge(2 * declaresBefore));
+}
@@ -108,6 +108,8 @@ class MockReceiveChannel : public rmqamqp::ReceiveChannel {
     {
         ON_CALL(*this, consume(testing::_, testing::_, testing::_))
             .WillByDefault(testing::Return(rmqt::Result<>()));
+        ON_CALL(*this, publish(testing::_, testing::_, testing::_))
+            .WillByDefault(testing::Return(rmqt::Result<>()));
     }
 
     MOCK_METHOD0(waitForReady, rmqt::Future<>());
@@ -125,12 +127,32 @@ class MockReceiveChannel : public rmqamqp::ReceiveChannel {
                  rmqt::Result<>(const rmqt::QueueHandle&,
                                 const MessageCallback& onNewMessage,
                                 const bsl::string&));
+    MOCK_METHOD3(publish,
+                 rmqt::Result<>(const rmqt::Message&,
+                                const bsl::string&,
+                                const bsl::string&));
     MOCK_METHOD0(consumeAckBatchFromQueue, void());
+    MOCK_METHOD0(publishChannelMetrics, void());
     MOCK_METHOD0(cancel, rmqt::Future<>());
+    MOCK_METHOD1(cancelConsumer, rmqt::Future<>(const bsl::string&));
+    MOCK_METHOD1(releaseConsumer, void(const bsl::string&));
     MOCK_METHOD0(drain, rmqt::Future<>());
+    MOCK_METHOD1(drainConsumer, rmqt::Future<>(const bsl::string&));
     MOCK_CONST_METHOD1(getMessagesOlderThan,
                        rmqamqp::MessageStore<rmqt::Message>::MessageList(
                            const bdlt::Datetime&));
+    MOCK_CONST_METHOD2(
+        visitMessagesOlderThan,
+        bsl::size_t(
+            const bdlt::Datetime&,
+            const rmqamqp::MessageStore<rmqt::Message>::MessageVisitor&));
+    MOCK_METHOD2(
+        visitNewlyHungMessages,
+        bsl::size_t(
+            const bdlt::Datetime&,
+            const rmqamqp::MessageStore<rmqt::Message>::MessageVisitor&));
+    MOCK_METHOD2(requeueMessagesOlderThan,
+                 bsl::size_t(const bdlt::Datetime&, const ExpiryFilter&));
 
     bsl::shared_ptr<rmqtestutil::MockTimerFactory> d_timerFactory;
 };
@@ -198,7 +220,37 @@ class MockSendChannel : public rmqamqp::SendChannel {
                  void(const rmqt::Message&,
                       const bsl::string&,
                       rmqt::Mandatory::Value));
+    MOCK_METHOD3(publishMessages,
+                 void(const bsl::vector<rmqt::Message>&,
+                      const bsl::string&,
+                      rmqt::Mandatory::Value));
+    MOCK_METHOD3(publishUrgent,
+                 void(const rmqt::Message&,
+                      const bsl::string&,
+                      rmqt::Mandatory::Value));
+    MOCK_METHOD3(publishToMany,
+                 void(const bsl::vector<rmqt::Message>&,
+                      const bsl::vector<bsl::string>&,
+                      rmqt::Mandatory::Value));
+    MOCK_METHOD4(publishUnconfirmed,
+                 void(const rmqt::Message&,
+                      const bsl::string&,
+                      rmqt::Mandatory::Value,
+                      const UnconfirmedPublishCallback&));
     MOCK_METHOD1(setCallback, void(const MessageConfirmCallback&));
+    MOCK_METHOD1(setBatchCallback, void(const MessageBatchConfirmCallback&));
+    MOCK_METHOD5(beginStream,
+                 void(const rmqt::Message&,
+                      bsl::size_t,
+                      const bsl::string&,
+                      rmqt::Mandatory::Value,
+                      const StreamFailureCallback&));
+    MOCK_METHOD2(
+        publishStreamContent,
+        void(const bsl::shared_ptr<const bsl::vector<uint8_t> >&,
+             const rmqio::Connection::SuccessWriteCallback&));
+    MOCK_METHOD0(abortStream, void());
+    MOCK_METHOD1(setWriteWeight, void(unsigned));
 
     bsl::shared_ptr<rmqtestutil::MockTimerFactory> d_timerFactory;
 };
@@ -50,7 +50,9 @@ class MockEventLoop : public rmqio::EventLoop {
     MOCK_METHOD1(postImpl, void(const bsl::function<void()>&));
     MOCK_METHOD1(dispatchImpl, void(const bsl::function<void()>&));
     MOCK_METHOD0(onThreadStarted, void());
-    MOCK_METHOD1(resolver, bsl::shared_ptr<rmqio::Resolver>(bool));
+    MOCK_METHOD2(resolver,
+                 bsl::shared_ptr<rmqio::Resolver>(
+                     bool, const rmqio::ConnectionOptions&));
     MOCK_METHOD0(timerFactory, bsl::shared_ptr<rmqio::TimerFactory>());
     MOCK_CONST_METHOD0(isStarted, bool());
     MOCK_METHOD1(waitForEventLoopExit, bool(int64_t));
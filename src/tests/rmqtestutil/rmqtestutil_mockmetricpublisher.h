@@ -47,6 +47,12 @@ class MockMetricPublisher : public rmqp::MetricPublisher {
         void(const bsl::string&,
              double,
              const bsl::vector<bsl::pair<bsl::string, bsl::string> >&));
+    MOCK_METHOD4(
+        publishDistributionSamples,
+        void(const bsl::string&,
+             double,
+             bsl::size_t,
+             const bsl::vector<bsl::pair<bsl::string, bsl::string> >&));
 };
 } // namespace rmqtestutil
 } // namespace BloombergLP
@@ -51,6 +51,13 @@ class MockResolver : public rmqio::Resolver {
                      const rmqio::Connection::Callbacks&,
                      const NewConnectionCallback&,
                      const ErrorCallback&));
+    MOCK_METHOD5(
+        asyncLocalConnect,
+        bsl::shared_ptr<rmqio::Connection>(const bsl::string&,
+                                           size_t,
+                                           const rmqio::Connection::Callbacks&,
+                                           const NewConnectionCallback&,
+                                           const ErrorCallback&));
 };
 
 } // namespace rmqtestutil
@@ -61,6 +61,9 @@ class MockTimerFactory : public rmqio::TimerFactory,
 
     void step_time(const bsls::TimeInterval& timeout);
 
+    /// The time stepped to so far, starting from zero
+    bsls::TimeInterval now() const { return d_now; }
+
     bsl::shared_ptr<rmqio::Timer>
     createWithTimeout(const bsls::TimeInterval& timeout) BSLS_KEYWORD_OVERRIDE;
 